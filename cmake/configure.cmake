@@ -81,6 +81,10 @@ if(WITH_ARM_BRPC)
   add_definitions(-DPADDLE_WITH_ARM_BRPC)
 endif()
 
+if(WITH_BRPC_RDMA)
+  add_definitions(-DPADDLE_WITH_BRPC_RDMA)
+endif()
+
 if(WITH_FLPS)
   add_definitions(-DPADDLE_WITH_FLPS)
 endif()
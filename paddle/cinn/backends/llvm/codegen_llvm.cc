@@ -50,6 +50,10 @@
 #include "paddle/cinn/runtime/cinn_runtime.h"
 #include "paddle/cinn/runtime/intrinsic.h"
 #include "paddle/cinn/utils/string.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_bool(cinn_llvm_loop_vectorize);
+PD_DECLARE_int32(cinn_llvm_prefer_vector_width);
 
 namespace cinn {
 namespace backends {
@@ -627,45 +631,69 @@ llvm::Value *CodeGenLLVM::CreateSerialFor(const ir::For *op, int stride) {
   llvm::BranchInst *back_branch = Br(header_bb);
 
   // Add loop metadata
+  if (FLAGS_cinn_llvm_loop_vectorize) {
+    AddLoopMetadata(op, back_branch);
+  }
+
+  if (old_var) {
+    SetVar(op->loop_var->name, old_var);
+  } else {
+    symbol_table_->Erase(op->loop_var->name);
+  }
+
+  b_->SetInsertPoint(exit_bb);
+  return nullptr;
+}
+
+void CodeGenLLVM::AddLoopMetadata(const ir::For *op,
+                                  llvm::BranchInst *back_branch) {
   decltype(auto) ctx = b_->getContext();
+  const auto BoolHint = [&](const char *name, bool value) -> llvm::Metadata * {
+    return llvm::MDNode::get(
+        ctx,
+        {llvm::MDString::get(ctx, name),
+         llvm::ConstantAsMetadata::get(value ? b_->getTrue()
+                                             : b_->getFalse())});
+  };
   std::vector<llvm::Metadata *> loop_metadata;
   auto temp_node = llvm::MDNode::getTemporary(ctx, llvm::None);
   loop_metadata.push_back(temp_node.get());
 
-  // TODO(fc500110): Loop vectorize
-  // auto *vectorization = op->metadata.vectorization ? b_->getTrue() :
-  // b_->getFalse(); loop_metadata.push_back(llvm::MDNode::get(
-  //        ctx, {llvm::MDString::get(ctx, "llvm.loop.vectorize.enable"),
-  //        llvm::ConstantAsMetadata::get(b_->getFalse())}));
+  // Only the innermost loops are vectorized by llvm, it picks the width for
+  // the features of the host. The tail is folded into masked vector ops
+  // rather than left to a scalar epilogue loop.
+  loop_metadata.push_back(
+      BoolHint("llvm.loop.vectorize.enable", op->metadata.vectorization));
+  if (op->metadata.vectorization) {
+    loop_metadata.push_back(
+        BoolHint("llvm.loop.vectorize.predicate.enable", true));
+  }
 
-  // Loop unroll
-  std::string llvm_unroll_metadata{"llvm.loop.unroll."};
   switch (op->metadata.unroll_mode) {
     case ir::LLVMForLoopMeta::FullyUnroll:
-      llvm_unroll_metadata += "full";
+      loop_metadata.push_back(llvm::MDNode::get(
+          ctx, {llvm::MDString::get(ctx, "llvm.loop.unroll.full")}));
       break;
     case ir::LLVMForLoopMeta::NoUnroll:
-      llvm_unroll_metadata += "disable";
+      loop_metadata.push_back(llvm::MDNode::get(
+          ctx, {llvm::MDString::get(ctx, "llvm.loop.unroll.disable")}));
       break;
     default:
-      llvm_unroll_metadata += "enable";
+      break;
   }
 
-  /*
-  loop_metadata.push_back(llvm::MDNode::get(ctx, {llvm::MDString::get(ctx,
-  llvm_unroll_metadata)})); auto loop_id = llvm::MDNode::get(ctx,
-  loop_metadata); loop_id->replaceOperandWith(0, loop_id);
+  auto *loop_id = llvm::MDNode::get(ctx, loop_metadata);
+  loop_id->replaceOperandWith(0, loop_id);
   back_branch->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
-  */
+}
 
-  if (old_var) {
-    SetVar(op->loop_var->name, old_var);
-  } else {
-    symbol_table_->Erase(op->loop_var->name);
+void CodeGenLLVM::AddVectorWidthAttr(llvm::Function *f) {
+  // llvm prefers 256 bit vectors on the AVX-512 CPUs even so, to avoid the
+  // frequency drop of the wider ones.
+  if (FLAGS_cinn_llvm_prefer_vector_width > 0) {
+    f->addFnAttr("prefer-vector-width",
+                 std::to_string(FLAGS_cinn_llvm_prefer_vector_width));
   }
-
-  b_->SetInsertPoint(exit_bb);
-  return nullptr;
 }
 
 llvm::Value *CodeGenLLVM::Visit(const ir::For *op) {
@@ -1107,6 +1135,7 @@ llvm::Value *CodeGenLLVM::Visit(const ir::_LoweredFunc_ *op) {
       /*Module=*/m_);
   f_->setCallingConv(llvm::CallingConv::C);
   f_->setHasUWTable();  // GDB
+  AddVectorWidthAttr(f_);
 
   std::vector<llvm::Value *> args;
   args.reserve(f_->arg_size());
@@ -244,6 +244,13 @@ class CodeGenLLVM : public LLVMIRVisitor, public IrBuilderMixin<CodeGenLLVM> {
   llvm::Value *DenseVectorLoad(const ir::Load *load);
   llvm::Value *CreateSerialFor(const ir::For *op, int stride = 1);
 
+  /**
+   * Hint the loop vectorizer and unroller of llvm with the metadata of a
+   * serial loop.
+   */
+  void AddLoopMetadata(const ir::For *op, llvm::BranchInst *back_branch);
+  void AddVectorWidthAttr(llvm::Function *f);
+
   /**
    * Mark a load or store with type-based-alias-analysis metadata so that LLVM
    * can optimize by reordering loads and stores across different buffers.
@@ -21,8 +21,11 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include "paddle/cinn/backends/cuda_util.h"
 #include "paddle/cinn/backends/nvrtc/header_generator.h"
@@ -34,6 +37,7 @@ PD_DECLARE_string(cinn_nvcc_cmd_path);
 PD_DECLARE_string(nvidia_package_dir);
 PD_DECLARE_bool(nvrtc_compile_to_cubin);
 PD_DECLARE_bool(cinn_nvrtc_cubin_with_fmad);
+PD_DECLARE_string(cinn_nvrtc_cache_dir);
 
 namespace cinn {
 namespace backends {
@@ -65,6 +69,76 @@ static std::vector<std::string> GetNvidiaAllIncludePath(
   return include_paths;
 }
 
+// The path of the kernel in FLAGS_cinn_nvrtc_cache_dir, empty if the cache is
+// disabled. The key is the FNV-1a hash and the size of the source code, with
+// the compile options and the nvrtc version, which cover the target arch.
+static std::string NvrtcCachePath(const std::string& code,
+                                  const std::vector<std::string>& options,
+                                  bool compile_to_cubin) {
+  if (FLAGS_cinn_nvrtc_cache_dir.empty()) {
+    return "";
+  }
+  int major = 0, minor = 0;
+  NVRTC_CALL(nvrtcVersion(&major, &minor));
+  uint64_t hash = 14695981039346656037ULL;
+  auto update = [&hash](const std::string& str) {
+    for (unsigned char c : str) {
+      hash = (hash ^ c) * 1099511628211ULL;
+    }
+    hash = (hash ^ 0xff) * 1099511628211ULL;
+  };
+  update(code);
+  for (const auto& option : options) {
+    update(option);
+  }
+  update(std::to_string(major) + "." + std::to_string(minor));
+  std::stringstream ss;
+  ss << FLAGS_cinn_nvrtc_cache_dir << "/" << std::hex << std::setw(16)
+     << std::setfill('0') << hash << std::dec << "_" << code.size()
+     << (compile_to_cubin ? ".cubin" : ".ptx");
+  return ss.str();
+}
+
+static bool ReadNvrtcCache(const std::string& path, std::string* data) {
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  if (!ifs.good() && !ifs.eof()) {
+    return false;
+  }
+  *data = ss.str();
+  return !data->empty();
+}
+
+// Written to a temporary file and renamed, so the other processes never read
+// a partial kernel.
+static void WriteNvrtcCache(const std::string& path, const std::string& data) {
+  if (!TryLocatePath(FLAGS_cinn_nvrtc_cache_dir) &&
+      mkdir(FLAGS_cinn_nvrtc_cache_dir.c_str(), 0755) != 0 &&
+      !TryLocatePath(FLAGS_cinn_nvrtc_cache_dir)) {
+    LOG(WARNING) << "Fail to create the nvrtc cache dir "
+                 << FLAGS_cinn_nvrtc_cache_dir;
+    return;
+  }
+  std::string tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::out | std::ios::binary);
+    ofs.write(data.data(), data.size());
+    if (!ofs.good()) {
+      LOG(WARNING) << "Fail to write the nvrtc cache " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Fail to write the nvrtc cache " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
 std::string Compiler::operator()(const std::string& code,
                                  bool include_headers) {
   if (runtime::CanUseNvccCompiler()) {
@@ -172,6 +246,15 @@ std::string Compiler::CompileCudaSource(const std::string& code,
     param_cstrings.push_back(option.c_str());
   }
   VLOG(3) << "compile options: " << utils::Join(compile_options, " ");
+
+  std::string cache_path =
+      NvrtcCachePath(code, compile_options, compile_to_cubin_);
+  std::string data;
+  if (!cache_path.empty() && ReadNvrtcCache(cache_path, &data)) {
+    VLOG(3) << "Load the compiled kernel from " << cache_path;
+    return data;
+  }
+
   NVRTC_CALL(nvrtcCreateProgram(&prog,
                                 code.c_str(),
                                 nullptr,
@@ -193,7 +276,6 @@ std::string Compiler::CompileCudaSource(const std::string& code,
   }
 
   size_t size;
-  std::string data;
   if (compile_to_cubin_) {
     NVRTC_CALL(nvrtcGetCUBINSize(prog, &size));
     data.resize(size);
@@ -205,6 +287,9 @@ std::string Compiler::CompileCudaSource(const std::string& code,
   }
 
   NVRTC_CALL(nvrtcDestroyProgram(&prog));
+  if (!cache_path.empty()) {
+    WriteNvrtcCache(cache_path, data);
+  }
   return data;
 }
 
@@ -14,7 +14,13 @@
 
 #include "paddle/cinn/backends/nvrtc/nvrtc_util.h"
 
+#include <dirent.h>
 #include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "paddle/common/flags.h"
+
+PD_DECLARE_string(cinn_nvrtc_cache_dir);
 
 namespace cinn {
 namespace backends {
@@ -85,6 +91,50 @@ void cast_fp32_to_bf16_cuda_kernel(const float* input, const int num, bfloat16*
   LOG(INFO) << "ptx:\n" << ptx;
 }
 
+static int CountFiles(const std::string& dir) {
+  DIR* handle = opendir(dir.c_str());
+  if (handle == nullptr) {
+    return 0;
+  }
+  int count = 0;
+  while (dirent* entry = readdir(handle)) {
+    if (entry->d_name[0] != '.') {
+      ++count;
+    }
+  }
+  closedir(handle);
+  return count;
+}
+
+TEST(Compiler, cache) {
+  std::string cache_dir =
+      "./nvrtc_cache_test_" + std::to_string(static_cast<int>(getpid()));
+  FLAGS_cinn_nvrtc_cache_dir = cache_dir;
+
+  std::string source_code = R"ROC(
+extern "C" __global__
+void scale(float a, float *x, float *out, size_t n)
+{
+  size_t tid = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tid < n) {
+    out[tid] = a * x[tid];
+  }
+}
+)ROC";
+
+  Compiler compiler;
+  auto compiled = compiler(source_code);
+  ASSERT_EQ(CountFiles(cache_dir), 1);
+  // loaded from the cache
+  Compiler other_compiler;
+  ASSERT_EQ(other_compiler(source_code), compiled);
+  ASSERT_EQ(CountFiles(cache_dir), 1);
+  compiler(source_code + "\n");
+  ASSERT_EQ(CountFiles(cache_dir), 2);
+
+  FLAGS_cinn_nvrtc_cache_dir = "";
+}
+
 }  // namespace nvrtc
 }  // namespace backends
 }  // namespace cinn
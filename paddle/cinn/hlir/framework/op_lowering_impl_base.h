@@ -33,6 +33,8 @@ struct BucketLoweredFuncsWrapper {
   ir::LoweredFunc infer_shape_func;
   std::vector<std::pair<ir::SymbolicPredicate, ir::LoweredFunc>>
       predicate2funcsCX86;
+  // the time spent in the group schedule, a part of the lowering
+  float schedule_time_ms{0.f};
 };
 
 template <typename T>
@@ -22,6 +22,7 @@
 #include "paddle/cinn/hlir/framework/op_lowering.h"
 #include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/cinn/utils/timer.h"
 #include "paddle/common/enforce.h"
 namespace cinn {
 namespace hlir {
@@ -152,12 +153,16 @@ std::shared_ptr<pir::CompilationResult> CompilationTask::operator()() {
 
 void CompilationTask::Lowering() {
   VLOG(5) << "Begin to lowering group: " << *context_->group_;
+  utils::Timer timer;
+  timer.Start();
   auto op_lowerer = CreateOpLowerer<pir::OpLoweringGroupPtr>(context_->target_);
-  context_->SetLoweredFuncs(
+  BucketLoweredFuncsWrapper funcs =
       op_lowerer.BucketLower(context_->group_,
                              /* apply op schedule = */ false,
                              /* apply group schedule = */ true,
-                             /* apply pass = */ true));
+                             /* apply pass = */ true);
+  const float schedule_ms = funcs.schedule_time_ms;
+  context_->SetLoweredFuncs(std::move(funcs));
 
   if (context_->group_->IsBroadcastLeaf()) {
     const auto& broadcast_condition_dimexprs =
@@ -200,13 +205,18 @@ void CompilationTask::Lowering() {
 
     context_->broadcast_condition_ = ChangeBroadcastConditionToExpr();
   }
+  context_->compile_time_.schedule_ms = schedule_ms;
+  context_->compile_time_.lowering_ms = timer.Stop() - schedule_ms;
   VLOG(5) << "End to lowering: " << context_->PrintPredicate2Funcs();
 }
 
 std::shared_ptr<pir::CompilationResult> CompilationTask::CodegenAndJit() {
+  utils::Timer timer;
+  timer.Start();
   context_->PrepareModuleBuilder();
   ir::Module ir_module = context_->module_builder_.Build();
   ir::Module ir_moduleCX86 = context_->CX86_module_builder_.Build();
+  context_->compile_time_.codegen_ms = timer.Stop();
   return BuildPirCINNKernelInfo(ir_module, ir_moduleCX86);
 }
 
@@ -220,9 +230,14 @@ std::shared_ptr<pir::CompilationResult> CompilationTask::BuildPirCINNKernelInfo(
       context_->group_->FuncName() + "_infer_shape",
       context_->group_->int_args_map());
   VLOG(5) << "Start to compile module into cuda kernel...";
+  utils::Timer timer;
+  timer.Start();
   backend_resource->GetBackendCompiler()->Build(module, "");
   backend_resource->GetBackendCompiler()->AppendCX86(CX86module);
+  context_->compile_time_.codegen_ms += timer.Stop();
+  timer.Start();
   backend_resource->GetBackendCompiler()->EndCompile();
+  context_->compile_time_.backend_ms += timer.Stop();
   compilation_result->SetBackendResource(backend_resource);
   VLOG(5) << "End to compile module into cuda kernel.";
   return compilation_result;
@@ -242,6 +257,8 @@ CompilationTask::CompileBroadcastModules(
 
   std::vector<std::string> case_func_names;
   std::vector<ir::Expr> broadcast_conditions;
+  utils::Timer timer;
+  timer.Start();
   for (auto& context : *leaf_group_contexts) {
     context.PrepareModuleBuilder();
     case_func_names.emplace_back(context.group_->FuncName());
@@ -260,7 +277,10 @@ CompilationTask::CompileBroadcastModules(
           symbolic_shape_var_index));
   backend_resource->GetBackendCompiler()->AppendBroadcastSwitchModule(
       wrapper_module);
+  context_->compile_time_.codegen_ms = timer.Stop();
+  timer.Start();
   backend_resource->GetBackendCompiler()->EndCompile();
+  context_->compile_time_.backend_ms = timer.Stop();
   compilation_result->SetBackendResource(backend_resource);
   VLOG(5) << "End to compile module into cuda kernel.";
   return compilation_result;
@@ -26,6 +26,19 @@ namespace hlir {
 namespace framework {
 class CompilationTask;
 
+// The time in ms spent in each phase of the compilation of a group.
+struct GroupCompileTime {
+  float lowering_ms{0.f};
+  float schedule_ms{0.f};
+  float codegen_ms{0.f};
+  // nvrtc for the device code and llvm for the host code
+  float backend_ms{0.f};
+
+  float total_ms() const {
+    return lowering_ms + schedule_ms + codegen_ms + backend_ms;
+  }
+};
+
 class GroupCompilationContext {
  public:
   GroupCompilationContext(const Target& target,
@@ -39,6 +52,9 @@ class GroupCompilationContext {
   void SetLoweredFuncs(BucketLoweredFuncsWrapper&& funcs);
   void PrepareModuleBuilder();
   std::string PrintPredicate2Funcs() const;
+  const pir::OpLoweringGroupPtr& group() const { return group_; }
+  const GroupCompileTime& compile_time() const { return compile_time_; }
+  GroupCompileTime* mutable_compile_time() { return &compile_time_; }
 
  private:
   friend class CompilationTask;
@@ -57,6 +73,7 @@ class GroupCompilationContext {
   ir::LoweredFunc infer_shape_lowered_func_;
   ir::Module::Builder module_builder_;
   ir::Module::Builder CX86_module_builder_;
+  GroupCompileTime compile_time_;
 };
 
 class CompilationTask {
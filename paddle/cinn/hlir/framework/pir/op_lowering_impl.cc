@@ -40,6 +40,7 @@
 #include "paddle/cinn/optim/rearrange_load_instruction.h"
 #include "paddle/cinn/optim/schedule_block_dce.h"
 #include "paddle/cinn/optim/transform_gpu_forloop.h"
+#include "paddle/cinn/utils/timer.h"
 #include "paddle/common/ddim.h"
 #include "paddle/common/enforce.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
@@ -229,6 +230,7 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   ir_sch.MergeExprs();
   std::vector<std::pair<ir::SymbolicPredicate, ir::Expr>> cond2func_bodies;
   std::vector<int> priorities;
+  float schedule_time_ms = 0.f;
   VLOG(3) << "After lower, ir is: \n" << ir_sch.GetModule().GetExprs().at(0);
 
   if (FLAGS_cinn_check_tensor_buffer_map) {
@@ -261,7 +263,10 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
                                  group_info);
 
     VLOG(4) << "Start apply group_scheduler->Schedule()";
+    cinn::utils::Timer schedule_timer;
+    schedule_timer.Start();
     group_scheduler->Schedule();
+    schedule_time_ms = schedule_timer.Stop();
     VLOG(4) << "End   apply group_scheduler->Schedule()";
 
     cond2func_bodies = group_scheduler->GetIRs();
@@ -334,6 +339,7 @@ BucketLoweredFuncsWrapper OpLowererImpl::BucketLower(
   }
   funcs_wrapper.infer_shape_func =
       GenerateInferShapeFunc(group, infer_shape_tensor_args, group_func_args);
+  funcs_wrapper.schedule_time_ms = schedule_time_ms;
 
   VLOG(4) << "End This function.";
   return funcs_wrapper;
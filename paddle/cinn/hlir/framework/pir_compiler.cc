@@ -13,16 +13,22 @@
 // limitations under the License.
 
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/runtime/arch_device.h"
 #include "paddle/cinn/utils/multi_threading.h"
+#include "paddle/cinn/utils/timer.h"
 #include "paddle/common/enforce.h"
 #include "paddle/common/flags.h"
 
 PD_DECLARE_bool(enable_cinn_compile_cache);
 PD_DECLARE_int64(cinn_compile_thread_num);
+PD_DECLARE_bool(cinn_report_compile_time);
 
 namespace cinn::hlir::framework {
 class CompilationContextMapper {
@@ -55,7 +61,11 @@ class CompilationContextMapper {
 };
 
 static size_t GetThreadNum(size_t task_size) {
-  size_t thread_size = task_size;
+  // The groups are lowered and compiled by one thread each, more threads than
+  // the cores would only contend for them.
+  const size_t core_num =
+      std::max<size_t>(1, std::thread::hardware_concurrency());
+  size_t thread_size = std::min(task_size, core_num);
   if (!FLAGS_enable_cinn_compile_cache) {
     thread_size = 1;
   } else if (FLAGS_cinn_compile_thread_num > 0) {
@@ -64,6 +74,15 @@ static size_t GetThreadNum(size_t task_size) {
   return thread_size;
 }
 
+static void ReportCompileTime(const GroupCompilationContext& context) {
+  const GroupCompileTime& time = context.compile_time();
+  LOG(INFO) << "Compiled group " << context.group()->FuncName() << " in "
+            << time.total_ms() << " ms: lowering " << time.lowering_ms
+            << " ms, schedule " << time.schedule_ms << " ms, codegen "
+            << time.codegen_ms << " ms, nvrtc/llvm " << time.backend_ms
+            << " ms";
+}
+
 std::vector<pir::CINNKernelInfo> PirCompiler::Build(
     const std::vector<pir::OpLoweringGroupPtr>& groups) {
   CompilationContextMapper ctx_mapper(target_, groups);
@@ -85,11 +104,29 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
       CompilationTask task(&group_compilation_contexts[index]);
       compilation_results[index] = task();
       // Triggering llvm compilation in thread
+      utils::Timer timer;
+      timer.Start();
       compilation_results[index]->GetKernelInfo();
+      group_compilation_contexts[index].mutable_compile_time()->backend_ms +=
+          timer.Stop();
     };
+    utils::Timer build_timer;
+    build_timer.Start();
     utils::parallel_run(worker_fn,
                         utils::SequenceDispatcher(0, task_size),
                         /*thread_num=*/thread_size);
+    const float wall_ms = build_timer.Stop();
+    if (FLAGS_cinn_report_compile_time) {
+      // reported in the order of the groups whatever the order they finished
+      float total_ms = 0.f;
+      for (const auto& context : group_compilation_contexts) {
+        ReportCompileTime(context);
+        total_ms += context.compile_time().total_ms();
+      }
+      LOG(INFO) << "Compiled " << task_size << " groups with " << thread_size
+                << " threads in " << wall_ms << " ms, " << total_ms
+                << " ms in total";
+    }
   }
   VLOG(5) << "Finished compiling " << task_size << " Cinn Kernel info.";
   ctx_mapper.SetFinalize(true);
@@ -137,8 +174,20 @@ pir::CINNKernelInfo PirCompiler::BuildBroadcastTree(
     runtime::SetArchDevice(target_, device_id);
     auto result = compilation_task.CompileBroadcastModules(
         &group_compilation_contexts, shape_idx);
+    utils::Timer timer;
+    timer.Start();
     const auto kernel_info = result->GetKernelInfo();
+    GroupCompileTime* time = origin_group_ctx.mutable_compile_time();
+    time->backend_ms += timer.Stop();
     CompilationCache::Instance().Insert(fusion_info, result);
+    if (FLAGS_cinn_report_compile_time) {
+      // the leaves are lowered in parallel and compiled as one module
+      for (const auto& context : group_compilation_contexts) {
+        time->lowering_ms += context.compile_time().lowering_ms;
+        time->schedule_ms += context.compile_time().schedule_ms;
+      }
+      ReportCompileTime(origin_group_ctx);
+    }
     return kernel_info;
   };
 
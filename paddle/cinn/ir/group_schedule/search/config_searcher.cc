@@ -15,6 +15,10 @@
 #pragma once
 
 #include "paddle/cinn/ir/group_schedule/search/config_searcher.h"
+
+#include <climits>
+#include <cmath>
+
 #include "paddle/cinn/common/target.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 #include "paddle/cinn/utils/string.h"
@@ -114,6 +118,63 @@ ScoreType WeightedSamplingTrailObjectiveFunc::operator()(
   return score;
 }
 
+AnalyticalCostModelFunc::AnalyticalCostModelFunc(
+    const common::Target& target, const BucketInfo& bucket_info)
+    : sm_count_(std::max(1, target.get_multi_processor_count())),
+      max_threads_per_sm_(std::max(1, target.get_max_threads_per_sm())),
+      max_blocks_per_sm_(std::max(1, target.get_max_blocks_per_sm())) {
+  // An unbounded dimension is taken at its lower bound, a bounded one at the
+  // middle of the bucket.
+  for (const BucketInfo::Dimension& dim : bucket_info.space) {
+    int64_t extent = dim.upper_bound == INT_MAX
+                         ? dim.lower_bound
+                         : (static_cast<int64_t>(dim.lower_bound) +
+                            dim.upper_bound) /
+                               2;
+    extent = std::max<int64_t>(1, extent);
+    if (dim.iter_type == "R") {
+      reduce_numel_ *= extent;
+    } else {
+      spatial_numel_ *= extent;
+    }
+  }
+}
+
+ScoreType AnalyticalCostModelFunc::operator()(const CandidateType& candidate) {
+  PADDLE_ENFORCE_EQ(candidate.size(),
+                    3,
+                    ::common::errors::InvalidArgument(
+                        "The tile config candidate should be {warp_num, "
+                        "tree_reduce_num, spatial_inner_num}."));
+  constexpr int64_t kThreadsPerWarp = 32;
+  // the cost of a warp shuffle and of a block sync relative to a load
+  constexpr double kShuffleCost = 2.0;
+  constexpr double kSyncCost = 16.0;
+
+  const int64_t threads = candidate[0] * kThreadsPerWarp;
+  const int64_t tree_reduce = std::max<int64_t>(1, candidate[1]);
+  const int64_t spatial_inner = std::max<int64_t>(1, candidate[2]);
+  const int64_t rows_per_block =
+      std::max<int64_t>(1, threads / tree_reduce * spatial_inner);
+  const int64_t blocks =
+      (spatial_numel_ + rows_per_block - 1) / rows_per_block;
+  const int64_t blocks_per_sm = std::max<int64_t>(
+      1,
+      std::min<int64_t>(max_blocks_per_sm_, max_threads_per_sm_ / threads));
+  const int64_t blocks_per_wave = sm_count_ * blocks_per_sm;
+  const int64_t waves = (blocks + blocks_per_wave - 1) / blocks_per_wave;
+
+  const double loads =
+      static_cast<double>((reduce_numel_ + tree_reduce - 1) / tree_reduce) *
+      spatial_inner;
+  const double steps = std::log2(static_cast<double>(tree_reduce));
+  double reduce_cost = kShuffleCost * std::min(steps, 5.0);
+  if (tree_reduce > kThreadsPerWarp) {
+    reduce_cost += kSyncCost * (steps - 5.0);
+  }
+  return static_cast<ScoreType>(waves * (loads + reduce_cost));
+}
+
 CandidateGenerator::CandidateGenerator(
     const std::vector<std::pair<int, int>>& candidate_range,
     const std::vector<ConstraintFunc>& constraints)
@@ -200,10 +261,39 @@ bool CandidateGenerator::IsValid(const CandidateType& candidate) const {
 ScheduleConfigSearcher::ScheduleConfigSearcher(
     std::unique_ptr<BaseObjectiveFunc> objective_func,
     const std::vector<std::pair<int, int>>& candidate_range,
-    const std::vector<ConstraintFunc>& contraints)
+    const std::vector<ConstraintFunc>& contraints,
+    std::unique_ptr<BaseObjectiveFunc> cost_model,
+    int top_k)
     : objective_func_(std::move(objective_func)),
       candidate_range_(candidate_range),
-      contraints_(contraints) {}
+      contraints_(contraints),
+      cost_model_(std::move(cost_model)),
+      top_k_(top_k) {
+  PADDLE_ENFORCE_GT(top_k_,
+                    0,
+                    ::common::errors::InvalidArgument(
+                        "The number of the candidates to measure should be "
+                        "greater than 0, but received %d.",
+                        top_k_));
+}
+
+std::vector<CandidateType> ScheduleConfigSearcher::RankByCostModel(
+    const std::vector<CandidateType>& candidates) const {
+  std::vector<std::pair<ScoreType, size_t>> costs;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    costs.emplace_back((*cost_model_)(candidates[i]), i);
+  }
+  std::stable_sort(costs.begin(), costs.end());
+  std::vector<CandidateType> top_candidates;
+  for (size_t i = 0; i < costs.size() && i < static_cast<size_t>(top_k_);
+       ++i) {
+    VLOG(6) << "Rank " << i << ": ["
+            << utils::Join<int64_t>(candidates[costs[i].second], ", ")
+            << "], cost = " << costs[i].first;
+    top_candidates.push_back(candidates[costs[i].second]);
+  }
+  return top_candidates;
+}
 
 std::pair<ScoreType, CandidateType> ScheduleConfigSearcher::Search(
     bool is_search_minimun) {
@@ -211,13 +301,17 @@ std::pair<ScoreType, CandidateType> ScheduleConfigSearcher::Search(
   CandidateGenerator candidate_generator(candidate_range_, contraints_);
   std::vector<CandidateType> candidates = candidate_generator.Candidates();
   VLOG(6) << "Candidate num = " << candidates.size();
+  if (cost_model_ != nullptr) {
+    candidates = RankByCostModel(candidates);
+    VLOG(6) << "Measure the top " << candidates.size() << " candidates";
+  }
   for (const auto& candidate : candidates) {
     ScoreType score = (*objective_func_)(candidate);
     VLOG(6) << "Candidate: [" << utils::Join<int64_t>(candidate, ", ") << "]";
     VLOG(6) << "Score = " << score;
     records_[score] = candidate;
   }
-  return is_search_minimun ? *records_.begin() : *(records_.end()--);
+  return is_search_minimun ? *records_.begin() : *records_.rbegin();
 }
 
 }  // namespace search
@@ -19,6 +19,7 @@
 #include <map>
 #include <vector>
 
+#include "paddle/cinn/common/target.h"
 #include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
 #include "paddle/cinn/ir/group_schedule/search/measurer.h"
 #include "paddle/cinn/utils/random_engine.h"
@@ -34,6 +35,7 @@ using ConstraintFunc = std::function<bool(const CandidateType&)>;
 
 class BaseObjectiveFunc {
  public:
+  virtual ~BaseObjectiveFunc() = default;
   virtual ScoreType operator()(const CandidateType& candidate) = 0;
 };
 
@@ -64,6 +66,28 @@ class WeightedSamplingTrailObjectiveFunc : public BaseObjectiveFunc {
   utils::LinearRandomEngine::StateType rand_seed_ = 1;
 };
 
+/**
+ * An analytical estimate of the time of a reduce kernel of the
+ * representative shape of a bucket, for the tile config candidates
+ * {warp_num, tree_reduce_num, spatial_inner_num}. It counts the waves of the
+ * blocks over the SMs and the serial loads and reduce steps of a thread, so
+ * it is only good to rank the candidates, not to predict the time.
+ */
+class AnalyticalCostModelFunc : public BaseObjectiveFunc {
+ public:
+  AnalyticalCostModelFunc(const common::Target& target,
+                          const BucketInfo& bucket_info);
+
+  ScoreType operator()(const CandidateType& candidate) override;
+
+ private:
+  int64_t spatial_numel_{1};
+  int64_t reduce_numel_{1};
+  int sm_count_;
+  int max_threads_per_sm_;
+  int max_blocks_per_sm_;
+};
+
 class CandidateGenerator {
  public:
   CandidateGenerator(const std::vector<std::pair<int, int>>& candidate_range,
@@ -82,17 +106,26 @@ class CandidateGenerator {
 
 class ScheduleConfigSearcher {
  public:
+  // If a cost model is given, the candidates are ranked by it and only the
+  // top_k of them are measured by the objective function.
   ScheduleConfigSearcher(
       std::unique_ptr<BaseObjectiveFunc> objective_func,
       const std::vector<std::pair<int, int>>& candidate_range,
-      const std::vector<ConstraintFunc>& contraints = {});
+      const std::vector<ConstraintFunc>& contraints = {},
+      std::unique_ptr<BaseObjectiveFunc> cost_model = nullptr,
+      int top_k = 8);
 
   std::pair<ScoreType, CandidateType> Search(bool is_search_minimun = true);
 
  private:
+  std::vector<CandidateType> RankByCostModel(
+      const std::vector<CandidateType>& candidates) const;
+
   std::unique_ptr<BaseObjectiveFunc> objective_func_;
   std::vector<ConstraintFunc> contraints_;
   std::vector<std::pair<int, int>> candidate_range_;
+  std::unique_ptr<BaseObjectiveFunc> cost_model_;
+  int top_k_;
 
   std::map<ScoreType, CandidateType> records_;
 };
@@ -69,10 +69,35 @@ PD_DEFINE_int32(cinn_parallel_compile_thread,
                              (std::thread::hardware_concurrency() >> 1)),
                 "How much thread the parallel compile used.");
 
+PD_DEFINE_bool(cinn_report_compile_time,
+               BoolFromEnv("FLAGS_cinn_report_compile_time", false),
+               "Whether to report the time of the lowering, schedule, codegen "
+               "and nvrtc/llvm compilation of each group.");
+
+PD_DEFINE_bool(cinn_llvm_loop_vectorize,
+               BoolFromEnv("FLAGS_cinn_llvm_loop_vectorize", false),
+               "Whether to hint llvm to vectorize the innermost loops of the "
+               "host kernels with masked tails.");
+
+PD_DEFINE_int32(cinn_llvm_prefer_vector_width,
+                Int32FromEnv("FLAGS_cinn_llvm_prefer_vector_width", 0),
+                "The vector width in bits preferred by llvm for the host "
+                "kernels, e.g. 512 for AVX-512. 0 leaves it to llvm.");
+
 PD_DEFINE_bool(cinn_measure_kernel_time,
                BoolFromEnv("FLAGS_cinn_measure_kernel_time", false),
                "Whether to enable schedule config search mode.");
 
+PD_DEFINE_bool(cinn_jit_cuda_graph,
+               BoolFromEnv("FLAGS_cinn_jit_cuda_graph", false),
+               "Whether to capture the launches of consecutive cinn jit "
+               "instructions into a cuda graph and replay it as one node.");
+
+PD_DEFINE_int32(cinn_jit_cuda_graph_max_group_size,
+                Int32FromEnv("FLAGS_cinn_jit_cuda_graph_max_group_size", 16),
+                "The max number of cinn jit instructions captured into one "
+                "cuda graph.");
+
 PD_DEFINE_bool(cinn_use_op_fusion,
                BoolFromEnv("FLAGS_cinn_use_op_fusion", true),
                "Whether to use op fusion pass.");
@@ -173,6 +198,14 @@ PD_DEFINE_bool(
     "technique which contract fp multiplication and addition/subtraction into "
     "multiply-add operation. It may result in different fp precision.");
 
+PD_DEFINE_string(
+    cinn_nvrtc_cache_dir,
+    StringFromEnv("FLAGS_cinn_nvrtc_cache_dir", ""),
+    "Specify the directory to cache the kernels compiled by nvrtc, keyed by "
+    "the source code, the compile options and the nvrtc version. It may be "
+    "shared by the processes and the replicas on a shared file system, so "
+    "the kernels are not compiled again after a restart.");
+
 // FLAGS for performance analysis and accuracy debug
 PD_DEFINE_bool(cinn_sync_run,
                BoolFromEnv("FLAGS_cinn_sync_run", false),
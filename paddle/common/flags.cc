@@ -198,6 +198,26 @@ PHI_DEFINE_EXPORTED_int64(
     0,
     "The times of exhaustive search for cuBlasLt matmul with/without "
     " epilogue algorithms, default is 0, means disabling exhaustive search.");
+
+/**
+ * CUDA related FLAG
+ * Name: FLAGS_cublaslt_skinny_gemm_max_m
+ * Since Version: 3.0.0
+ * Value Range: int64_t, default=16
+ * Example: FLAGS_cublaslt_skinny_gemm_max_m=0 would disable the search of the
+ *          skinny GEMMs.
+ * Note: The cuBlasLt matmuls whose M is not larger than it, such as the ones
+ *       of decoding with small batch sizes, time the heuristic algorithms
+ *       together with their split-K variants on the first run of each shape,
+ *       and cache the fastest one, even if autotune is disabled. The default
+ *       heuristic algorithm of these shapes launches too few tiles to occupy
+ *       all the SMs when K is large.
+ */
+PHI_DEFINE_EXPORTED_int64(
+    cublaslt_skinny_gemm_max_m,
+    16,
+    "The max M of the cuBlasLt matmuls which search the split-K algorithms "
+    "on the first run, default is 16, 0 means disabling the search.");
 #endif
 
 /*
@@ -239,7 +259,10 @@ PHI_DEFINE_EXPORTED_bool(
  * Note: whether to use deterministic algorithm in embedding op.
  *       If it is 1, it will use the optimized deterministic CUDA kernel in
  *       embedding op. If it is 2, it will use the legacy deterministic
- *       CUDA kernel in embedding op.
+ *       CUDA kernel in embedding op. If it is 3, it will sort the ids and
+ *       sum the grads of each unique id without atomics, which is faster
+ *       when a few ids are hit many times, and the sparse grad of embedding
+ *       has the unique rows.
  */
 PHI_DEFINE_EXPORTED_int64(
     embedding_deterministic,
@@ -248,6 +271,72 @@ PHI_DEFINE_EXPORTED_int64(
     "operator. The deterministic algorithm may be slower. If "
     "it is larger than 0, the algorithm is deterministic.");
 
+/**
+ * CUDA related FLAG
+ * Name: FLAGS_unique_hash_min_numel
+ * Since Version: 3.0.0
+ * Value Range: int64, default=4194304
+ * Example:
+ * Note: the least number of the elements of the integer input of the
+ *       flattened unique on GPU to try the hash path, which gathers the
+ *       distinct values by a hash table instead of sorting the whole input.
+ *       A negative value disables the hash path.
+ */
+PHI_DEFINE_EXPORTED_int64(unique_hash_min_numel,
+                          4194304,
+                          "The least number of the elements of the input of "
+                          "unique to try the hash path on GPU, -1 disables "
+                          "it.");
+
+/**
+ * CUDA related FLAG
+ * Name: FLAGS_unique_hash_max_distinct_ratio
+ * Since Version: 3.0.0
+ * Value Range: double, default=0.05
+ * Example:
+ * Note: the hash path of unique on GPU is taken when the number of the
+ *       distinct values estimated from a sample of the input is at most this
+ *       ratio of the elements.
+ */
+PHI_DEFINE_EXPORTED_double(unique_hash_max_distinct_ratio,
+                           0.05,
+                           "The largest estimated ratio of the distinct values "
+                           "to the elements of the input of unique for the "
+                           "hash path on GPU.");
+
+/**
+ * Sparse conv related FLAG
+ * Name: FLAGS_sparse_conv_auto_cache_rulebook
+ * Since Version: 3.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: Whether the sparse subm convs without a key save their rulebooks by
+ *       a key of their kernel sizes and dilations, so that the following subm
+ *       convs over the same indices reuse them instead of producing them
+ *       again.
+ */
+PHI_DEFINE_EXPORTED_bool(sparse_conv_auto_cache_rulebook,
+                         true,
+                         "Whether to share the rulebooks of the sparse subm "
+                         "convs without a key over the same indices.");
+
+/**
+ * FFT related FLAG
+ * Name: FLAGS_fft_plan_cache_workspace_limit_in_mb
+ * Since Version: 3.0
+ * Value Range: uint64, default=1024 (MB)
+ * Example:
+ * Note: The limit of the sum of the workspace sizes of the cuFFT plans cached
+ *       on one device. The least recently used plans are destroyed once the
+ *       limit is exceeded, so that a spike of new shapes does not hold the
+ *       memory of their plans. 0 means no limit.
+ */
+PHI_DEFINE_EXPORTED_uint64(fft_plan_cache_workspace_limit_in_mb,
+                           1024,
+                           "The limit of the workspace sizes of the cuFFT "
+                           "plans cached on one device in MB, 0 means no "
+                           "limit.");
+
 /**
  * CUDNN related FLAG
  * Name: FLAGS_cudnn_exhaustive_search
@@ -374,6 +463,56 @@ PHI_DEFINE_EXPORTED_bool(
 PHI_DEFINE_EXPORTED_int32(communicator_send_queue_size,
                           20,
                           "queue size to recv gradient before send");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_geo_adaptive
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: In geo mode, push every round only the sparse keys of the largest
+ *       deltas and adapt the number of batches merged into a round, up to
+ *       communicator_max_merge_var_num, to the time left by the push.
+ */
+PHI_DEFINE_EXPORTED_bool(communicator_geo_adaptive,
+                         false,
+                         "push the sparse keys of the largest deltas in geo "
+                         "mode, at an interval adapted to the network");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_geo_top_ratio
+ * Since Version: 3.0.0
+ * Value Range: double, (0, 1], default=0.25
+ * Example:
+ * Note: The fraction of the touched sparse keys of the largest deltas pushed
+ *       every round in the adaptive geo mode.
+ */
+PHI_DEFINE_EXPORTED_double(communicator_geo_top_ratio,
+                           0.25,
+                           "fraction of the keys pushed by the adaptive geo");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_geo_delta_threshold
+ * Since Version: 3.0.0
+ * Value Range: double, default=1e-3
+ * Example:
+ * Note: In the adaptive geo mode, the sparse keys whose delta has a larger
+ *       L2 norm are pushed besides the top ones.
+ */
+PHI_DEFINE_EXPORTED_double(communicator_geo_delta_threshold,
+                           1e-3,
+                           "delta norm above which the adaptive geo pushes");
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_communicator_geo_max_delay
+ * Since Version: 3.0.0
+ * Value Range: int32, default=8
+ * Example:
+ * Note: The number of rounds the adaptive geo mode may hold back the delta
+ *       of a sparse key before pushing it anyway.
+ */
+PHI_DEFINE_EXPORTED_int32(communicator_geo_max_delay,
+                          8,
+                          "rounds the adaptive geo holds back a key at most");
 #endif
 
 /**
@@ -644,6 +783,40 @@ PHI_DEFINE_EXPORTED_uint64(
     "The real chunk size is max(request_size, "
     "FLAGS_auto_growth_chunk_size_in_mb).");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_auto_growth_slab_max_size_in_kb
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=0 (KB)
+ * Example: FLAGS_auto_growth_slab_max_size_in_kb=64 caches the GPU
+ *          allocations not larger than 64KB per thread.
+ * Note: If larger than 0, the small GPU allocations of the auto_growth
+ *       allocator are rounded up to size classes and cached per thread after
+ *       being freed, so that they can be allocated again without the lock of
+ *       the auto_growth allocator. 0 disables the cache.
+ */
+PHI_DEFINE_EXPORTED_uint64(
+    auto_growth_slab_max_size_in_kb,
+    0ul,
+    "The maximum size of the GPU allocations cached per thread in front of "
+    "the auto_growth allocator. 0 disables the cache.");
+
+/**
+ * Memory related FLAG
+ * Name: FLAGS_auto_growth_slab_thread_cache_size_in_mb
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=64 (MB)
+ * Example:
+ * Note: The maximum size of the GPU memory cached by each thread when
+ *       FLAGS_auto_growth_slab_max_size_in_kb is larger than 0. The freed
+ *       allocations beyond it are returned to the auto_growth allocator.
+ */
+PHI_DEFINE_EXPORTED_uint64(
+    auto_growth_slab_thread_cache_size_in_mb,
+    64ul,
+    "The maximum size of the GPU memory cached by each thread in front of "
+    "the auto_growth allocator.");
+
 PHI_DEFINE_EXPORTED_bool(custom_device_mem_record,
                          false,
                          "Enable mem record event on custom device");
@@ -904,6 +1077,21 @@ PHI_DEFINE_EXPORTED_double(graph_neighbor_size_percent,
                            1.0,
                            "It controls whether precent of neighbor_size.");
 
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_graph_alias_sampler_degree_threshold
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1024
+ * Example:
+ * Note: With the sample type "alias" of GraphTable, the nodes of at least this
+ *       degree are sampled by the alias method, the others by the
+ *       WeightedSampler tree.
+ */
+PHI_DEFINE_EXPORTED_int32(graph_alias_sampler_degree_threshold,
+                          1024,
+                          "the min degree of the nodes sampled by the alias "
+                          "method with the sample type alias.");
+
 /**
  * Distributed related FLAG
  * Name: FLAGS_graph_metapath_split_opt
@@ -918,6 +1106,23 @@ PHI_DEFINE_EXPORTED_bool(graph_metapath_split_opt,
                          "It controls whether load graph node and edge with "
                          "multi threads parallelly.");
 
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_graph_prefetch_batch
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: Control whether the graph data feed generates the next batch into a
+ *       second set of tensors while the current batch is trained, so that the
+ *       sampling and the feature filling of the next batch overlap the
+ *       training step. It is ignored in the multi node mode, whose batches
+ *       are generated in lockstep with the other nodes.
+ */
+PHI_DEFINE_EXPORTED_bool(graph_prefetch_batch,
+                         false,
+                         "It controls whether the graph data feed generates "
+                         "the next batch while the current one is trained.");
+
 /**
  * Distributed related FLAG
  * Name: FLAGS_graph_get_neighbor_id
@@ -1003,6 +1208,56 @@ PHI_DEFINE_EXPORTED_bool(allreduce_record_one_event,
                          "events. Currently, only fuse allreduce supports "
                          "this. Otherwise, the precision may be wrong.");
 
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_eager_reducer_rebuild_groups
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_eager_reducer_rebuild_groups=false keeps the groups of the
+ *          DataParallel gradients as they are built from the parameters.
+ * Note: The EagerReducer observes the order and the time the gradients are
+ *       ready in the first backward passes, and rebuilds its groups once to
+ *       follow them. It is not done with find_unused_parameters=True.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_reducer_rebuild_groups,
+                         true,
+                         "Whether the EagerReducer rebuilds its groups by the "
+                         "order the gradients are ready in the first steps.");
+
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_eager_reducer_first_bucket_size
+ * Since Version: 3.0.0
+ * Value Range: int64, default=1048576
+ * Example: FLAGS_eager_reducer_first_bucket_size=4194304 makes the first
+ *          group allreduced in the rebuilt groups of 4MB.
+ * Note: The size in bytes of the first group of the rebuilt groups. A small
+ *       one starts the communication early in the backward pass, 0 means the
+ *       size of the other groups.
+ */
+PHI_DEFINE_EXPORTED_int64(eager_reducer_first_bucket_size,
+                          1048576,
+                          "The size in bytes of the first group of the "
+                          "rebuilt groups of the EagerReducer.");
+
+/**
+ * Distributed related FLAG
+ * Name: FLAGS_eager_reducer_contiguous_grads
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_eager_reducer_contiguous_grads=true keeps the gradients of
+ *          DataParallel in one contiguous buffer per group.
+ * Note: The dense gradients are views of the buffer of their group, they are
+ *       accumulated in place and the buffer is allreduced directly, without
+ *       the concat and split of the gradients in each step. The gradients are
+ *       zeros instead of None before the first backward pass. It is read when
+ *       the DataParallel is built.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_reducer_contiguous_grads,
+                         false,
+                         "Whether the dense gradients of the EagerReducer are "
+                         "views of one contiguous buffer per group.");
+
 #ifdef PADDLE_WITH_CINN
 /*
  * CINN related FLAG
@@ -1118,6 +1373,35 @@ PHI_DEFINE_EXPORTED_bool(new_executor_use_cuda_graph,
                          false,
                          "Use CUDA Graph in new executor");
 
+/*
+ * New executor related FLAG
+ * Name: FLAGS_new_executor_fused_data_transfer
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_new_executor_fused_data_transfer=false would make the new
+ * executor insert memcpy_h2d, transfer_layout and cast ops one by one instead
+ * of a fused_data_transfer op when an input needs more than one of them.
+ */
+PHI_DEFINE_EXPORTED_bool(new_executor_fused_data_transfer,
+                         true,
+                         "Fuse the data transfers of an input of the new "
+                         "executor into one op on the GPU");
+
+/*
+ * New executor related FLAG
+ * Name: FLAGS_new_executor_xpu_copy_stream
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_new_executor_xpu_copy_stream=false would make the new
+ * executor run the memcpy_h2d and memcpy_d2h ops of an XPU place on its
+ * compute stream, after all the work queued on the device.
+ */
+PHI_DEFINE_EXPORTED_bool(new_executor_xpu_copy_stream,
+                         true,
+                         "Run the memcpy_h2d and memcpy_d2h ops of the new "
+                         "executor on XPU copy streams synchronized with "
+                         "events, overlapping them with the compute");
+
 /*
  * CUDA Graph / Allocator related FLAG
  * Name: FLAGS_use_cuda_malloc_async_allocator
@@ -1195,6 +1479,64 @@ PD_DEFINE_bool(enable_slotrecord_reset_shrink,  // NOLINT
 PD_DEFINE_bool(enable_ins_parser_file,  // NOLINT
                false,
                "enable parser ins file, default false");
+PD_DEFINE_bool(enable_slotrecord_gpu_resident_pass,  // NOLINT
+               false,
+               "upload the records of a pass to the device once and assemble "
+               "the batches by the kernels, instead of packing each batch on "
+               "the host, default false");
+
+/**
+ * Data related FLAG
+ * Name: FLAGS_hdfs_native_library
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example: FLAGS_hdfs_native_library="libhdfs.so"
+ * Note: The libhdfs loaded to read the hdfs and afs files without the hadoop
+ *       command, empty means the files are read by the hadoop command pipes.
+ */
+PHI_DEFINE_EXPORTED_string(hdfs_native_library,
+                           "",
+                           "the libhdfs to read the hdfs files natively, "
+                           "empty means reading by the hadoop command");
+
+/**
+ * Data related FLAG
+ * Name: FLAGS_hdfs_native_chunk_size
+ * Since Version: 3.0.0
+ * Value Range: int64, default=8388608
+ * Example:
+ * Note: The bytes of a ranged read of the native hdfs reader.
+ */
+PHI_DEFINE_EXPORTED_int64(hdfs_native_chunk_size,
+                          8 << 20,
+                          "the bytes of a ranged read of the native hdfs "
+                          "reader.");
+
+/**
+ * Data related FLAG
+ * Name: FLAGS_hdfs_native_read_ahead
+ * Since Version: 3.0.0
+ * Value Range: int32, default=4
+ * Example:
+ * Note: The chunks of a file read in parallel ahead of the reading position.
+ */
+PHI_DEFINE_EXPORTED_int32(hdfs_native_read_ahead,
+                          4,
+                          "the chunks of a file read ahead by the native hdfs "
+                          "reader.");
+
+/**
+ * Data related FLAG
+ * Name: FLAGS_hdfs_native_thread_num
+ * Since Version: 3.0.0
+ * Value Range: int32, default=16
+ * Example:
+ * Note: The threads doing the ranged reads of all the native hdfs files.
+ */
+PHI_DEFINE_EXPORTED_int32(hdfs_native_thread_num,
+                          16,
+                          "the threads of the ranged reads of the native hdfs "
+                          "reader.");
 PHI_DEFINE_EXPORTED_bool(
     gpugraph_enable_hbm_table_collision_stat,
     false,
@@ -1247,6 +1589,23 @@ PHI_DEFINE_EXPORTED_bool(enable_all2all_use_fp16,
 PHI_DEFINE_EXPORTED_bool(enable_sparse_inner_gather,
                          false,
                          "enable sparse inner gather, default false");
+PHI_DEFINE_EXPORTED_bool(
+    enable_sparse_inner_gather_auto,
+    false,
+    "choose the sparse inner gather of the multi-node pulls and pushes from "
+    "the share of the keys of a node duplicated across its gpus, measured "
+    "every sparse_inner_gather_probe_interval pulls, default false");
+PHI_DEFINE_EXPORTED_int32(sparse_inner_gather_probe_interval,
+                          100,
+                          "the pulls between two measures of the duplicated "
+                          "keys of the automatic sparse inner gather, "
+                          "default 100");
+PHI_DEFINE_EXPORTED_double(
+    sparse_inner_gather_min_dedup_ratio,
+    0.2,
+    "the share of the keys of a node duplicated across its gpus, above which "
+    "the automatic sparse inner gather dedups them in the node before the "
+    "all2all between the nodes, default 0.2");
 PHI_DEFINE_EXPORTED_bool(gpugraph_debug_gpu_memory,
                          false,
                          "enable debug gpu memory, default false");
@@ -1265,6 +1624,24 @@ PHI_DEFINE_EXPORTED_bool(multi_node_sample_use_gpu_table,
                          true,
                          "Control whether to use gpu table in sample multi "
                          "machine in gpu graph mode");
+PHI_DEFINE_EXPORTED_bool(
+    gpups_double_buffer_build_task,
+    false,
+    "build the gpu table of the next pass into a second table while the "
+    "current pass trains, and swap them in BeginPass. It needs the hbm of "
+    "two tables, default false");
+PHI_DEFINE_EXPORTED_int64(
+    gpugraph_neighbor_cache_size,
+    0,
+    "the number of neighbor ids of each gpu and edge type cached in hbm for "
+    "the nodes not in the gpu graph tables. If it is greater than 0, the "
+    "neighbor sampling queries the cpu graph table for those nodes, and caches "
+    "the adjacency lists of the most queried ones, default 0");
+PHI_DEFINE_EXPORTED_int32(
+    gpugraph_neighbor_cache_admit_count,
+    2,
+    "the number of the cpu queries of a node before its adjacency list is "
+    "cached in hbm, see gpugraph_neighbor_cache_size, default 2");
 
 /**
  * ProcessGroupNCCL related FLAG
@@ -1285,6 +1662,115 @@ PHI_DEFINE_EXPORTED_bool(benchmark_nccl,
                          "enable nccl debug mode to synchronize nccl comm");
 #endif
 
+/**
+ * ProcessGroupNCCL related FLAG
+ * Name: nccl_hierarchical_allreduce
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_nccl_hierarchical_allreduce=true
+ * Note: Run the all_reduce of a group over several nodes in two levels, a
+ *       reduce_scatter in the nodes, an all_reduce of the slices across the
+ *       nodes, and an all_gather in the nodes. The nodes are found by the
+ *       host names of the ranks, they must hold the same number of ranks.
+ */
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+PHI_DEFINE_EXPORTED_bool(nccl_hierarchical_allreduce,
+                         false,
+                         "Whether to run the all_reduce across the nodes in "
+                         "the hierarchical way.");
+
+/**
+ * ProcessGroupNCCL related FLAG
+ * Name: nccl_hierarchical_allreduce_min_size
+ * Since Version: 3.0.0
+ * Value Range: int64, default=1048576
+ * Example: FLAGS_nccl_hierarchical_allreduce_min_size=0
+ * Note: The size in bytes from which the all_reduce is hierarchical, the
+ *       smaller ones are bound by the latency and run flat.
+ */
+PHI_DEFINE_EXPORTED_int64(nccl_hierarchical_allreduce_min_size,
+                          1048576,
+                          "The size in bytes from which the all_reduce is "
+                          "hierarchical.");
+
+/**
+ * ProcessGroupNCCL related FLAG
+ * Name: nccl_hierarchical_allreduce_compress
+ * Since Version: 3.0.0
+ * Value Range: string, default="", float16 or bfloat16
+ * Example: FLAGS_nccl_hierarchical_allreduce_compress=bfloat16
+ * Note: The float32 slices of the sum of the hierarchical all_reduce are sent
+ *       across the nodes in float16 or bfloat16, which halves the traffic of
+ *       the links between the nodes at the cost of the precision.
+ */
+PHI_DEFINE_EXPORTED_string(nccl_hierarchical_allreduce_compress,
+                           "",
+                           "The dtype the float32 slices are sent across the "
+                           "nodes in the hierarchical all_reduce.");
+#endif
+
+/**
+ * ProcessGroupGloo related FLAG
+ * Name: gloo_shm_collective
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_gloo_shm_collective=false
+ * Note: Run the all_reduce, broadcast and all_gather of the ranks on the same
+ *       host through a shared memory segment, and across the hosts by Gloo
+ *       between one rank of every host. The groups whose hosts hold a single
+ *       or different numbers of ranks keep the Gloo collectives.
+ */
+PHI_DEFINE_EXPORTED_bool(gloo_shm_collective,
+                         true,
+                         "Whether the gloo collectives of the ranks on the "
+                         "same host go through the shared memory.");
+
+/**
+ * ProcessGroupGloo related FLAG
+ * Name: gloo_shm_buffer_size
+ * Since Version: 3.0.0
+ * Value Range: int64, default=4194304
+ * Example: FLAGS_gloo_shm_buffer_size=16777216
+ * Note: The size in bytes of the chunks the shared memory collectives move
+ *       the data in, the segment of a host holds local ranks + 2 of them.
+ */
+PHI_DEFINE_EXPORTED_int64(gloo_shm_buffer_size,
+                          4194304,
+                          "The size in bytes of the chunks of the shared "
+                          "memory gloo collectives.");
+
+/**
+ * Auto parallel related FLAG
+ * Name: reshard_use_planner
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example: FLAGS_reshard_use_planner=false
+ * Note: Reshard the tensors on the same nd mesh by the cheapest sequence of
+ *       the 1-D reshard steps on the mesh axes, e.g. an all_to_all instead of
+ *       an all_gather and a slice, or a reduce_scatter of the partial tensor
+ *       instead of an all_gather of its shards first. The sequences are only
+ *       used when they are cheaper than the steps of the same nd mesh reshard.
+ */
+PHI_DEFINE_EXPORTED_bool(reshard_use_planner,
+                         true,
+                         "Whether to plan the reshard on the same nd mesh by "
+                         "the cost of its communications.");
+
+/**
+ * Auto parallel related FLAG
+ * Name: reshard_mesh_bandwidth
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example: FLAGS_reshard_mesh_bandwidth="25,200"
+ * Note: The comma separated bandwidths of the links of the mesh axes, in any
+ *       unit, for the cost of the reshard plans. The axes after the last
+ *       given one have its bandwidth, all of them are the same by default.
+ */
+PHI_DEFINE_EXPORTED_string(reshard_mesh_bandwidth,
+                           "",
+                           "The bandwidths of the mesh axes for the cost of "
+                           "the reshard plans.");
+
 PHI_DEFINE_EXPORTED_bool(
     benchmark,
     false,
@@ -1302,6 +1788,37 @@ PHI_DEFINE_EXPORTED_bool(
  */
 PHI_DEFINE_EXPORTED_bool(use_autotune, false, "Whether enable autotune.");
 
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_layout_autotune_by_cost
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_layout_autotune_by_cost=true
+ * Note: If true, the layout autotune of the eager mode picks the layout by
+ * the measured time instead of the dtype of the first conv2d. It observes
+ * the ops for FLAGS_layout_autotune_cost_window conv2d calls, summing the
+ * time the convs save in the other layout and the time of the transposes
+ * that layout needs, and switches only if the total is a saving.
+ */
+PHI_DEFINE_EXPORTED_bool(layout_autotune_by_cost,
+                         false,
+                         "Whether layout autotune picks the layout by the "
+                         "measured kernel time.");
+
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_layout_autotune_cost_window
+ * Since Version: 3.0.0
+ * Value Range: int32, default=64
+ * Example: FLAGS_layout_autotune_cost_window=128
+ * Note: The number of the conv2d calls the cost based layout autotune
+ * observes before it picks the layout, which shall cover a training step.
+ */
+PHI_DEFINE_EXPORTED_int32(layout_autotune_cost_window,
+                          64,
+                          "The number of the conv2d calls observed by the "
+                          "cost based layout autotune.");
+
 /**
  * CINN training related FLAG
  * Name: FLAGS_disable_dyshape_in_train
@@ -1333,6 +1850,19 @@ PHI_DEFINE_EXPORTED_bool(enable_fuse_parallel_matmul_pass,
                          true,
                          "Whether enable fuse_parallel_matmul_pass in cinn.");
 
+/**
+ * CINN fuse gemm epilogue related FLAG
+ * Name: FLAGS_enable_fuse_gemm_epilogue_in_cinn
+ * Since Version: 3.0 beta
+ * Value Range: bool, default=false
+ * Note: The fused_gemm_epilogue kernel needs CUDA 11.6 or later.
+ */
+PHI_DEFINE_EXPORTED_bool(
+    enable_fuse_gemm_epilogue_in_cinn,
+    false,
+    "Whether to fuse the bias add and the relu/gelu following a matmul into "
+    "the cublasLt fused_gemm_epilogue before the cinn clustering.");
+
 /**
  * CINN fallback fusion ops FLAG
  * Name: FLAGS_enable_fusion_fallback
@@ -1354,6 +1884,22 @@ PHI_DEFINE_EXPORTED_int32(search_cache_max_number,
                           1000000,
                           "search_cache_max_number.");
 
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_cache_file
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example: FLAGS_autotune_cache_file=/path/to/autotune_cache.txt
+ * Note: If not empty, the conv algorithms searched exhaustively by cuDNN are
+ * loaded from the file when the autotune cache is created, and saved to it,
+ * merged with the algorithms already in it, at exit. The algorithms are kept
+ * per device arch and driver, CUDA and cuDNN versions, so the file can be
+ * shared by the jobs on different machines.
+ */
+PHI_DEFINE_EXPORTED_string(autotune_cache_file,
+                           "",
+                           "The file to persist the autotune cache in.");
+
 /**
  * Performance related FLAG
  * Name: einsum_opt
@@ -1383,6 +1929,22 @@ PHI_DEFINE_EXPORTED_string(jit_engine_type,
                            "Predictor",
                            "Choose default function type in JitLayer.");
 
+/**
+ * JitLayer related FLAG
+ * Name: FLAGS_jit_predictor_pool_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_jit_predictor_pool_size=4
+ * Note: If positive and FLAGS_jit_engine_type is Predictor, each function of
+ * the loaded JitLayer runs on a pool of this many predictors, so that the
+ * requests, e.g. by Function::RunAsync, run concurrently. On GPU each
+ * predictor of the pool runs on a stream of its own.
+ */
+PHI_DEFINE_EXPORTED_int32(jit_predictor_pool_size,
+                          0,
+                          "The number of the predictors to run each function "
+                          "of JitLayer concurrently, 0 means no pool.");
+
 /**
  * Custom Device NPU related FLAG
  * Name: FLAGS_npu_storage_format
@@ -1457,6 +2019,23 @@ PHI_DEFINE_EXPORTED_bool(dataloader_use_file_descriptor,
                          false,
                          "Use file descriptor in mmap_allocator.");
 
+/**
+ * mmap_allocator related FLAG
+ * Name: dataloader_use_shared_memory_ring
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_dataloader_use_shared_memory_ring=true makes each worker of
+ * DataLoader write the batches into a ring of shared memory slots.
+ * Note: The main process maps the batches in the slots as tensors without
+ * copies, and the slots are reused once the tensors are released, instead of
+ * creating a shared memory file for each tensor. The batches which can not be
+ * written into the ring, e.g. the tensors with LoD, are sent as before.
+ */
+PHI_DEFINE_EXPORTED_bool(dataloader_use_shared_memory_ring,
+                         false,
+                         "Whether the DataLoader workers send the batches "
+                         "in the slots of a shared memory ring");
+
 /**
  * Tensor operants related FLAG
  * Name: tensor_operants_mode
@@ -1527,6 +2106,20 @@ PHI_DEFINE_EXPORTED_bool(logging_pir_py_code_dump_symbolic_dims,
  */
 PHI_DEFINE_EXPORTED_bool(enable_pir_api, false, "Enable PIR API in Python");
 
+/**
+ * Apply fused_conv_bn_act_pass to the programs of dy2st mode FLAG
+ * Name: enable_fused_conv_bn_act_pass
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the conv2d + batch_norm + relu chains of the NHWC fp16
+ * training programs, as the residual units of ResNet, are fused into the cuDNN
+ * frontend fused ops, on Ampere or later GPUs with cuDNN 8.9 or later.
+ */
+PHI_DEFINE_EXPORTED_bool(enable_fused_conv_bn_act_pass,
+                         false,
+                         "Fuse conv2d + batch_norm + relu in dy2st mode");
+
 /**
  * Using PIR in executor FLAG
  * Name: enable_pir_in_executor_trace_run
@@ -1540,6 +2133,101 @@ PHI_DEFINE_EXPORTED_bool(enable_pir_in_executor_trace_run,
                          false,
                          "Enable PIR in executor");
 
+/**
+ * Executor related FLAG
+ * Name: pir_interpreter_static_memory_plan
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the PirInterpreter running in trace mode on a single stream
+ * learns the lifetime and the size of the intermediate tensors in the first
+ * step, and then places them at fixed offsets inside one preallocated arena,
+ * so that no allocator call is needed for them in the following steps.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_interpreter_static_memory_plan,
+                         false,
+                         "Place the intermediate tensors of PirInterpreter in "
+                         "a statically planned memory arena");
+
+/**
+ * Executor related FLAG
+ * Name: pir_interpreter_infer_meta_cache
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, PhiKernelInstruction skips InferMeta when the metas of its
+ * dense tensor inputs and outputs are the same as those after the last
+ * InferMeta. The ops with tensor attributes, e.g. the shape of reshape given
+ * by a tensor, always run InferMeta.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_interpreter_infer_meta_cache,
+                         false,
+                         "Skip InferMeta of PhiKernelInstruction when the "
+                         "metas of inputs are unchanged");
+
+/**
+ * Executor related FLAG
+ * Name: pir_interpreter_infer_meta_cache_check
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, InferMeta is still run when the cache of
+ * FLAGS_pir_interpreter_infer_meta_cache hits, and an error is raised if its
+ * results differ from the cached ones. Used for debug.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_interpreter_infer_meta_cache_check,
+                         false,
+                         "Check the results of the InferMeta cache");
+
+/**
+ * Executor related FLAG
+ * Name: pir_instruction_profiler_sample_interval
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_pir_instruction_profiler_sample_interval=100 samples one in
+ * every 100 instruction runs of each thread.
+ * Note: If positive, the host time of wait_event, infer_meta, share_buffer,
+ * kernel, gc and record_event of the sampled instruction runs are recorded
+ * into per-thread ring buffers. A report of the most host-bound instructions
+ * is logged when a PirInterpreter is destroyed.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_instruction_profiler_sample_interval,
+                          0,
+                          "Sample one in every N instruction runs to profile "
+                          "their host overhead, 0 means disabled");
+
+/**
+ * Executor related FLAG
+ * Name: pir_instruction_profiler_path
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example:
+ * Note: If not empty, the records of the instruction profiler are also
+ * exported to this chrome tracing file.
+ */
+PHI_DEFINE_EXPORTED_string(pir_instruction_profiler_path,
+                           "",
+                           "The chrome tracing file the instruction profiler "
+                           "exports to");
+
+/**
+ * Executor related FLAG
+ * Name: pir_interpreter_cuda_graph_pool_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example:
+ * Note: If positive, the PirInterpreter running in trace mode on GPU captures
+ * one CUDA Graph for each shape signature of the feed tensors, and replays it
+ * in the following runs with the same shapes. A signature is run eagerly the
+ * first time it is seen, and at most this number of signatures are kept, the
+ * least recently used one is evicted together with its memory pool.
+ */
+PHI_DEFINE_EXPORTED_int32(pir_interpreter_cuda_graph_pool_size,
+                          0,
+                          "The max number of CUDA Graphs captured by "
+                          "PirInterpreter for different feed shapes, 0 means "
+                          "disabled");
+
 /**
  * Apply inplace pass to PIR FLAG
  * Name: pir_apply_inplace_pass
@@ -1553,6 +2241,50 @@ PHI_DEFINE_EXPORTED_bool(pir_apply_inplace_pass,
                          "Whether to apply inplace pass on lowering "
                          "::pir::Program to Kernel Dialect");
 
+/**
+ * Eager related FLAG
+ * Name: FLAGS_eager_lazy_mode
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_eager_lazy_mode=true records the dygraph ops which don't
+ *          require grad into a PIR segment instead of running them.
+ * Note: The segment is run by the PirInterpreter when one of its outputs is
+ *       read, by numpy() or by an op which is not recorded, and the compiled
+ *       segments are reused when the same ops are recorded again.
+ */
+PHI_DEFINE_EXPORTED_bool(eager_lazy_mode,
+                         false,
+                         "Whether to record the dygraph ops into PIR segments "
+                         "and run them lazily.");
+
+/**
+ * Eager related FLAG
+ * Name: FLAGS_eager_lazy_max_segment_ops
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1024
+ * Example: FLAGS_eager_lazy_max_segment_ops=256 flushes the lazy segment once
+ *          256 ops are recorded.
+ */
+PHI_DEFINE_EXPORTED_int32(eager_lazy_max_segment_ops,
+                          1024,
+                          "The max number of ops recorded in a lazy segment.");
+
+/**
+ * Eager related FLAG
+ * Name: FLAGS_eager_backward_num_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_eager_backward_num_threads=4 runs the independent grad nodes
+ *          of backward() on 4 threads, each with its own stream on GPU.
+ * Note: 0 or 1 runs the grad nodes one by one. The grads summed from several
+ *       branches may differ in the last bits, as the order of the sum follows
+ *       the order the branches finish.
+ */
+PHI_DEFINE_EXPORTED_int32(eager_backward_num_threads,
+                          0,
+                          "The number of threads the eager backward runs the "
+                          "grad nodes on.");
+
 PHI_DEFINE_EXPORTED_string(
     ir_inplace_kernel_blacklist,
     "",
@@ -1649,11 +2381,57 @@ PHI_DEFINE_EXPORTED_bool(enable_async_trace,
 
 PHI_DEFINE_EXPORTED_int32(async_trace_count, 5, "collective async trace count");
 
+/**
+ * ProcessGroupNCCL related FLAG
+ * Name: comm_flight_recorder_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_comm_flight_recorder_size=2048
+ * Note: The number of the recent collectives whose op, numel and time on the
+ *       device are kept per rank, 0 disables it. It needs
+ *       FLAGS_enable_async_trace, the record is logged on the hangs and can be
+ *       aggregated across the ranks to find the late rank.
+ */
+PHI_DEFINE_EXPORTED_int32(comm_flight_recorder_size,
+                          0,
+                          "The number of the recent collectives kept in the "
+                          "comm flight record.");
+
 PHI_DEFINE_EXPORTED_bool(
     use_auto_growth_pinned_allocator,
     false,
     "Whether to use the auto_growth CUDA pinned allocator.");
 
+/**
+ * Memory related FLAG
+ * Name: FLAGS_use_numa_pinned_allocator
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the CUDA pinned memory is allocated on the NUMA node of the
+ *       current GPU and pooled per NUMA node, and the copies between the
+ *       pageable host memory and the GPU larger than 64KB are staged through
+ *       it, so that they do not cross the inter-socket link.
+ */
+PHI_DEFINE_EXPORTED_bool(
+    use_numa_pinned_allocator,
+    false,
+    "Whether to use the NUMA-local pooled CUDA pinned allocator.");
+
+/**
+ * Memory related FLAG
+ * Name: FLAGS_numa_pinned_pool_size_in_mb
+ * Since Version: 3.0.0
+ * Value Range: uint64, default=1024 (MB)
+ * Example:
+ * Note: The maximum size of the freed pinned memory kept by each NUMA node
+ *       when FLAGS_use_numa_pinned_allocator is True.
+ */
+PHI_DEFINE_EXPORTED_uint64(
+    numa_pinned_pool_size_in_mb,
+    1024ul,
+    "The maximum size of the pinned memory pooled by each NUMA node.");
+
 PHI_DEFINE_EXPORTED_bool(
     sync_after_alloc,
     false,
@@ -1681,6 +2459,48 @@ PHI_DEFINE_EXPORTED_int64(
     32,
     "Maximum number of broadcast nodes allowed in a tree");
 
+/**
+ * Incremental pattern rewrite of PIR FLAG
+ * Name: pir_incremental_pattern_rewrite
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the pattern rewrite passes only revisit the ops affected by
+ * the rewrites instead of rescanning the whole region after each iteration.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_incremental_pattern_rewrite,
+                         false,
+                         "Whether to only revisit the ops affected by the "
+                         "rewrites in the pattern rewrite passes");
+
+/**
+ * Pattern rewrite statistics of PIR FLAG
+ * Name: pir_pattern_rewrite_statistics
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the pattern rewrite passes log the number of the matches and
+ * the time of the attempts of each of their patterns.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_pattern_rewrite_statistics,
+                         false,
+                         "Whether to log the matches and the time of each "
+                         "pattern in the pattern rewrite passes");
+
+/**
+ * Operation arena of PIR FLAG
+ * Name: pir_use_operation_arena
+ * Since Version: 3.0.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: If True, the operations built into a program are allocated from an
+ * arena owned by the program instead of one by one from the heap.
+ */
+PHI_DEFINE_EXPORTED_bool(pir_use_operation_arena,
+                         true,
+                         "Whether to allocate the operations of a program "
+                         "from an arena owned by the program");
+
 PHI_DEFINE_EXPORTED_string(
     nvidia_package_dir,  // NOLINT
     "",
@@ -1892,3 +2712,101 @@ PHI_DEFINE_EXPORTED_bool(
     pinned_memory_as_cpu_backend,
     false,
     "Whether use CPU backend, when tensor is pinned_memory.");
+
+/**
+ * Profiler related FLAG
+ * Name: continuous_tracing_buffer_size
+ * Since Version: 3.0.0
+ * Value Range: int32, default=65536
+ * Example: FLAGS_continuous_tracing_buffer_size=1048576 keeps the last 1M
+ * events of each thread.
+ * Note: The number of the host events kept by the ring buffer of each thread
+ * for the continuous tracing, which is rounded up to a power of 2. Each event
+ * takes 24 bytes.
+ */
+PHI_DEFINE_EXPORTED_int32(continuous_tracing_buffer_size,
+                          65536,
+                          "The number of the host events kept for each "
+                          "thread by the continuous tracing");
+
+/**
+ * IO related FLAG
+ * Name: save_combine_data_alignment
+ * Since Version: 3.0.0
+ * Value Range: int32, [0, 128], default=64
+ * Example: FLAGS_save_combine_data_alignment=0 saves the parameters without
+ * padding.
+ * Note: The data of each tensor saved by save_combine starts at a multiple of
+ * it in the file, so that load_combine can use the data of the mapped file in
+ * place. The padding is skipped by the readers, so the files are still
+ * readable by the former versions.
+ */
+PHI_DEFINE_EXPORTED_int32(save_combine_data_alignment,
+                          64,
+                          "The alignment of the data of the tensors in the "
+                          "files saved by save_combine");
+
+/**
+ * IO related FLAG
+ * Name: load_combine_use_mmap
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_load_combine_use_mmap=true maps the parameter files instead
+ * of reading them.
+ * Note: The CPU tensors loaded by load_combine share the mapped data if it is
+ * aligned, so the file should not be overwritten while they are used. The
+ * data of the GPU tensors is copied in chunks, overlapping the reads of the
+ * file with the copies.
+ */
+PHI_DEFINE_EXPORTED_bool(load_combine_use_mmap,
+                         false,
+                         "Whether load_combine maps the parameter file "
+                         "instead of reading it");
+
+/**
+ * IO related FLAG
+ * Name: cipher_decrypt_num_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=0
+ * Example: FLAGS_cipher_decrypt_num_threads=8 decrypts the models encrypted by
+ * AES_CTR_NoPadding with 8 threads.
+ * Note: 0 means the number of the hardware threads. The ciphertext of CTR is
+ * split into the chunks of at least 1MB, which are decrypted in parallel.
+ */
+PHI_DEFINE_EXPORTED_int32(cipher_decrypt_num_threads,
+                          0,
+                          "The number of the threads to decrypt the "
+                          "ciphertext of AES_CTR_NoPadding");
+
+/**
+ * Inference related FLAG
+ * Name: naive_executor_cache_kernel_context
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_naive_executor_cache_kernel_context=true makes NaiveExecutor
+ * run the cached kernels of the ops after the first run.
+ * Note: The first run selects the phi kernels and builds their contexts as
+ * usual, which are cached by the ops. The later runs call the cached kernels
+ * directly, the shapes are inferred only if the dims of the inputs change.
+ */
+PHI_DEFINE_EXPORTED_bool(naive_executor_cache_kernel_context,
+                         false,
+                         "Whether NaiveExecutor runs the cached kernels and "
+                         "contexts of the ops after the first run");
+
+/**
+ * Inference related FLAG
+ * Name: naive_executor_num_threads
+ * Since Version: 3.0.0
+ * Value Range: int32, default=1
+ * Example: FLAGS_naive_executor_num_threads=4 runs the independent ops of the
+ * CPU programs by 4 threads.
+ * Note: It only works with FLAGS_naive_executor_cache_kernel_context, and
+ * without the hooks or the memory reuse of NaiveExecutor. The ops are grouped
+ * into the levels of the ops without dependencies between them, and the ops
+ * of each level run in parallel.
+ */
+PHI_DEFINE_EXPORTED_int32(naive_executor_num_threads,
+                          1,
+                          "The number of the threads to run the independent "
+                          "ops in NaiveExecutor");
@@ -0,0 +1,595 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/collective/gloo_shm_comm.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <random>
+#include <thread>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/distributed/comm_context_manager.h"
+#include "paddle/phi/core/enforce.h"
+
+COMMON_DECLARE_bool(gloo_shm_collective);
+COMMON_DECLARE_int64(gloo_shm_buffer_size);
+
+namespace paddle {
+namespace distributed {
+
+constexpr size_t kCacheLine = 64;
+
+struct alignas(kCacheLine) GlooShmHeader {
+  uint64_t token;
+  int64_t local_size;
+  int64_t buffer_size;
+};
+
+// Every counter in a cache line of its own, so that the spinning ranks do not
+// slow down the one which bumps it.
+struct alignas(kCacheLine) GlooShmFlag {
+  std::atomic<uint64_t> seq{0};
+};
+
+namespace {
+
+inline size_t AlignUp(size_t n, size_t align) {
+  return (n + align - 1) / align * align;
+}
+
+inline float ToFloat(float x) { return x; }
+
+inline float ToFloat(uint16_t x) {
+  uint32_t bits = static_cast<uint32_t>(x) << 16;
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+inline void FromFloat(float x, float* y) { *y = x; }
+
+// rounds to the nearest even as phi::dtype::bfloat16, and keeps the nans
+inline void FromFloat(float x, uint16_t* y) {
+  uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  const uint32_t rounded = bits + 0x7fff + ((bits >> 16) & 1);
+  *y = (bits & 0x7fffffff) > 0x7f800000
+           ? static_cast<uint16_t>((bits >> 16) | 0x40)
+           : static_cast<uint16_t>(rounded >> 16);
+}
+
+struct SumFunctor {
+  float operator()(float a, float b) const { return a + b; }
+};
+
+struct MaxFunctor {
+  float operator()(float a, float b) const { return a < b ? b : a; }
+};
+
+struct MinFunctor {
+  float operator()(float a, float b) const { return b < a ? b : a; }
+};
+
+struct ProdFunctor {
+  float operator()(float a, float b) const { return a * b; }
+};
+
+// Reduces the n elements at srcs into dst, in blocks of float32 held in the
+// cache: the loops over a block are plain enough for the compilers to
+// vectorize, and the bfloat16 are added up in float32 as in the kernels.
+template <typename T, typename Functor>
+void ReduceInto(char* dst,
+                const std::vector<const char*>& srcs,
+                size_t n,
+                Functor functor) {
+  constexpr size_t kBlock = 256;
+  float acc[kBlock];
+  T* out = reinterpret_cast<T*>(dst);
+  for (size_t i = 0; i < n; i += kBlock) {
+    const size_t m = std::min(kBlock, n - i);
+    const T* src = reinterpret_cast<const T*>(srcs[0]) + i;
+    for (size_t j = 0; j < m; ++j) {
+      acc[j] = ToFloat(src[j]);
+    }
+    for (size_t r = 1; r < srcs.size(); ++r) {
+      src = reinterpret_cast<const T*>(srcs[r]) + i;
+      for (size_t j = 0; j < m; ++j) {
+        acc[j] = functor(acc[j], ToFloat(src[j]));
+      }
+    }
+    for (size_t j = 0; j < m; ++j) {
+      FromFloat(acc[j], out + i + j);
+    }
+  }
+}
+
+template <typename T>
+void ReduceInto(char* dst,
+                const std::vector<const char*>& srcs,
+                size_t n,
+                ReduceOp reduce_op) {
+  switch (reduce_op) {
+    case ReduceOp::SUM:
+      ReduceInto<T>(dst, srcs, n, SumFunctor());
+      break;
+    case ReduceOp::MAX:
+      ReduceInto<T>(dst, srcs, n, MaxFunctor());
+      break;
+    case ReduceOp::MIN:
+      ReduceInto<T>(dst, srcs, n, MinFunctor());
+      break;
+    case ReduceOp::PRODUCT:
+      ReduceInto<T>(dst, srcs, n, ProdFunctor());
+      break;
+    default:
+      PADDLE_THROW(phi::errors::InvalidArgument(
+          "Unsupported reduce op %d of the shared memory all_reduce.",
+          static_cast<int>(reduce_op)));
+  }
+}
+
+// a tensor on the memory of the segment, for the collectives across the nodes
+phi::DenseTensor ShmTensor(void* data, phi::DataType dtype, int64_t numel) {
+  const size_t bytes = numel * phi::SizeOf(dtype);
+  return phi::DenseTensor(
+      std::make_shared<phi::Allocation>(data, bytes, phi::CPUPlace()),
+      phi::DenseTensorMeta(dtype, common::make_ddim({numel})));
+}
+
+inline bool IsCPU(const phi::DenseTensor& tensor) {
+  return tensor.place().GetType() == phi::AllocationType::CPU;
+}
+
+}  // namespace
+
+GlooShmComm::GlooShmComm(int rank, int size, int64_t timeout)
+    : rank_(rank), size_(size), timeout_(timeout) {}
+
+GlooShmComm::~GlooShmComm() {
+#ifndef _WIN32
+  if (addr_ != nullptr) {
+    munmap(addr_, segment_size_);
+  }
+#endif
+}
+
+std::unique_ptr<GlooShmComm> GlooShmComm::Create(
+    const std::shared_ptr<phi::distributed::Store>& store,
+    int rank,
+    int size,
+    int gid) {
+#ifdef _WIN32
+  return nullptr;
+#else
+  if (!FLAGS_gloo_shm_collective || size < 2) {
+    return nullptr;
+  }
+
+  char host_name[256] = {0};
+  PADDLE_ENFORCE_EQ(
+      gethostname(host_name, sizeof(host_name) - 1),
+      0,
+      phi::errors::External("Failed to get the host name of rank %d.", rank));
+  const std::string prefix = "gloo_shm/" + std::to_string(gid) + "/";
+  const std::string host(host_name);
+  store->set(prefix + "host/" + std::to_string(rank),
+             std::vector<uint8_t>(host.begin(), host.end()));
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < size; ++i) {
+    keys.emplace_back(prefix + "host/" + std::to_string(i));
+  }
+  const auto rank_hosts = store->multi_get(keys);
+
+  std::unique_ptr<GlooShmComm> comm(
+      new GlooShmComm(rank, size, store->timeout()));
+  std::vector<std::string> nodes;
+  std::vector<int> node_sizes;
+  for (int i = 0; i < size; ++i) {
+    const std::string rank_host(rank_hosts[i].begin(), rank_hosts[i].end());
+    auto iter = std::find(nodes.begin(), nodes.end(), rank_host);
+    const int index = static_cast<int>(iter - nodes.begin());
+    if (iter == nodes.end()) {
+      nodes.push_back(rank_host);
+      node_sizes.push_back(0);
+    }
+    comm->rank_nodes_.push_back(index);
+    comm->rank_local_ranks_.push_back(node_sizes[index]++);
+  }
+  comm->num_nodes_ = static_cast<int>(nodes.size());
+  comm->node_index_ = comm->rank_nodes_[rank];
+  comm->local_rank_ = comm->rank_local_ranks_[rank];
+  comm->local_size_ = node_sizes[comm->node_index_];
+  if (comm->local_size_ < 2 ||
+      std::count(node_sizes.begin(), node_sizes.end(), comm->local_size_) !=
+          comm->num_nodes_) {
+    VLOG(3) << "The collectives of the gloo group " << gid
+            << " skip the shared memory, it needs several ranks on every node "
+            << "and the same number of them.";
+    return nullptr;
+  }
+
+  // The leader creates the segment of the node under a name of its own, with
+  // a token which the other ranks check, and unlinks it once all the ranks
+  // mapped it or failed to, so that no segment outlives the group.
+  const std::string segment_key =
+      prefix + "segment/" + std::to_string(comm->node_index_);
+  std::string name;
+  bool ok = false;
+  if (comm->local_rank_ == 0) {
+    std::random_device random_device;
+    const uint64_t token =
+        (static_cast<uint64_t>(random_device()) << 32) | random_device();
+    name = "/paddle_gloo_shm_" + std::to_string(getpid()) + "_" +
+           std::to_string(gid) + "_" + std::to_string(token);
+    ok = comm->CreateSegment(name, token);
+    std::vector<uint8_t> value(sizeof(token));
+    std::memcpy(value.data(), &token, sizeof(token));
+    if (ok) {
+      value.insert(value.end(), name.begin(), name.end());
+    }
+    store->set(segment_key, value);
+  } else {
+    const auto value = store->get(segment_key);
+    if (value.size() > sizeof(uint64_t)) {
+      uint64_t token;
+      std::memcpy(&token, value.data(), sizeof(token));
+      name.assign(value.begin() + sizeof(token), value.end());
+      ok = comm->OpenSegment(name, token);
+    }
+  }
+
+  store->set(prefix + "status/" + std::to_string(rank),
+             std::vector<uint8_t>{static_cast<uint8_t>(ok)});
+  keys.clear();
+  for (int i = 0; i < size; ++i) {
+    keys.emplace_back(prefix + "status/" + std::to_string(i));
+  }
+  const auto statuses = store->multi_get(keys);
+  if (comm->local_rank_ == 0 && ok) {
+    shm_unlink(name.c_str());
+  }
+  for (const auto& status : statuses) {
+    if (status.empty() || status[0] == 0) {
+      LOG(WARNING) << "The collectives of the gloo group " << gid
+                   << " skip the shared memory, some ranks failed to map the "
+                   << "segments of their nodes.";
+      return nullptr;
+    }
+  }
+
+  if (comm->num_nodes_ > 1 && comm->local_rank_ == 0) {
+    comm->inter_key_ = prefix + "inter";
+    phi::distributed::CommContextManager::CreateGlooCommContext(
+        store, comm->inter_key_, comm->node_index_, comm->num_nodes_);
+  }
+  VLOG(3) << "The collectives of the gloo group " << gid
+          << " go through the shared memory on " << comm->num_nodes_
+          << " node(s) of " << comm->local_size_ << " ranks.";
+  return comm;
+#endif
+}
+
+bool GlooShmComm::CreateSegment(const std::string& name, uint64_t token) {
+#ifdef _WIN32
+  return false;
+#else
+  buffer_size_ = AlignUp(FLAGS_gloo_shm_buffer_size, kCacheLine);
+  segment_size_ = sizeof(GlooShmHeader) +
+                  sizeof(GlooShmFlag) * (local_size_ + 1) +
+                  buffer_size_ * (local_size_ + 2);
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    LOG(WARNING) << "Failed to create the shared memory segment " << name
+                 << ": " << std::strerror(errno);
+    return false;
+  }
+  // allocates the pages now, a /dev/shm too small for the segment would
+  // otherwise kill the ranks by a SIGBUS in the first collective
+  int ret = ftruncate(fd, static_cast<off_t>(segment_size_)) == 0 ? 0 : errno;
+#ifdef __linux__
+  if (ret == 0) {
+    ret = posix_fallocate(fd, 0, static_cast<off_t>(segment_size_));
+  }
+#endif
+  void* addr = ret == 0 ? mmap(nullptr,
+                               segment_size_,
+                               PROT_READ | PROT_WRITE,
+                               MAP_SHARED,
+                               fd,
+                               0)
+                        : MAP_FAILED;
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG(WARNING) << "Failed to map the shared memory segment " << name
+                 << " of " << segment_size_
+                 << " bytes: " << std::strerror(ret != 0 ? ret : errno);
+    shm_unlink(name.c_str());
+    return false;
+  }
+  name_ = name;
+  MapSegment(addr);
+  for (int i = 0; i <= local_size_; ++i) {
+    new (flags_ + i) GlooShmFlag();
+  }
+  new (header_) GlooShmHeader{
+      token, local_size_, static_cast<int64_t>(buffer_size_)};
+  return true;
+#endif
+}
+
+bool GlooShmComm::OpenSegment(const std::string& name, uint64_t token) {
+#ifdef _WIN32
+  return false;
+#else
+  buffer_size_ = AlignUp(FLAGS_gloo_shm_buffer_size, kCacheLine);
+  segment_size_ = sizeof(GlooShmHeader) +
+                  sizeof(GlooShmFlag) * (local_size_ + 1) +
+                  buffer_size_ * (local_size_ + 2);
+  const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    LOG(WARNING) << "Failed to open the shared memory segment " << name
+                 << ": " << std::strerror(errno);
+    return false;
+  }
+  void* addr = mmap(
+      nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    LOG(WARNING) << "Failed to map the shared memory segment " << name << ": "
+                 << std::strerror(errno);
+    return false;
+  }
+  name_ = name;
+  MapSegment(addr);
+  // a segment of the same name on another host, or of another buffer size
+  if (header_->token != token || header_->local_size != local_size_ ||
+      header_->buffer_size != static_cast<int64_t>(buffer_size_)) {
+    LOG(WARNING) << "The shared memory segment " << name
+                 << " is not the one of the leader of the node.";
+    munmap(addr_, segment_size_);
+    addr_ = nullptr;
+    return false;
+  }
+  return true;
+#endif
+}
+
+void GlooShmComm::MapSegment(void* addr) {
+  addr_ = addr;
+  header_ = static_cast<GlooShmHeader*>(addr);
+  flags_ = reinterpret_cast<GlooShmFlag*>(header_ + 1);
+  slots_ = reinterpret_cast<char*>(flags_ + local_size_ + 1);
+  buffers_ = slots_ + buffer_size_ * local_size_;
+}
+
+char* GlooShmComm::Slot(int local_rank) const {
+  return slots_ + buffer_size_ * local_rank;
+}
+
+char* GlooShmComm::NextBuffer() {
+  char* buffer = buffers_ + buffer_size_ * buffer_index_;
+  buffer_index_ ^= 1;
+  return buffer;
+}
+
+void GlooShmComm::LocalBarrier() {
+  ++seq_;
+  flags_[local_rank_].seq.store(seq_, std::memory_order_release);
+  for (int i = 0; i < local_size_; ++i) {
+    Wait(flags_[i]);
+  }
+}
+
+void GlooShmComm::InterDone() {
+  flags_[local_size_].seq.store(seq_, std::memory_order_release);
+}
+
+void GlooShmComm::WaitInter() const { Wait(flags_[local_size_]); }
+
+void GlooShmComm::Wait(const GlooShmFlag& flag) const {
+  constexpr int64_t kSpins = 1024;
+  const auto start = std::chrono::steady_clock::now();
+  for (int64_t spins = 1; flag.seq.load(std::memory_order_acquire) < seq_;
+       ++spins) {
+    if (spins < kSpins) {
+      continue;
+    }
+    std::this_thread::yield();
+    if (spins % kSpins == 0 &&
+        std::chrono::steady_clock::now() - start >
+            std::chrono::seconds(timeout_)) {
+      PADDLE_THROW(phi::errors::ExecutionTimeout(
+          "Rank %d waited more than %d seconds for the other ranks of its "
+          "node in a shared memory collective.",
+          rank_,
+          timeout_));
+    }
+  }
+}
+
+phi::distributed::GlooCommContext* GlooShmComm::InterCommContext() const {
+  auto* comm_context = static_cast<phi::distributed::GlooCommContext*>(
+      phi::distributed::CommContextManager::GetInstance().Get(inter_key_));
+  PADDLE_ENFORCE_NOT_NULL(comm_context,
+                          phi::errors::Unavailable(
+                              "The GlooCommContext across the nodes of the "
+                              "shared memory collectives is nullptr."));
+  return comm_context;
+}
+
+bool GlooShmComm::CanAllReduce(const phi::DenseTensor& out_tensor,
+                               const phi::DenseTensor& in_tensor,
+                               ReduceOp reduce_op) const {
+  const auto dtype = in_tensor.dtype();
+  return (dtype == phi::DataType::FLOAT32 ||
+          dtype == phi::DataType::BFLOAT16) &&
+         out_tensor.dtype() == dtype &&
+         out_tensor.numel() == in_tensor.numel() && IsCPU(in_tensor) &&
+         IsCPU(out_tensor) &&
+         (reduce_op == ReduceOp::SUM || reduce_op == ReduceOp::MAX ||
+          reduce_op == ReduceOp::MIN || reduce_op == ReduceOp::PRODUCT);
+}
+
+bool GlooShmComm::CanBroadcast(const phi::DenseTensor& out_tensor,
+                               const phi::DenseTensor& in_tensor) const {
+  return out_tensor.dtype() == in_tensor.dtype() &&
+         out_tensor.numel() == in_tensor.numel() && IsCPU(in_tensor) &&
+         IsCPU(out_tensor);
+}
+
+bool GlooShmComm::CanAllGather(const phi::DenseTensor& out_tensor,
+                               const phi::DenseTensor& in_tensor) const {
+  // the buffer holds a piece of every rank, of whole cache lines
+  return buffer_size_ / size_ >= kCacheLine &&
+         out_tensor.dtype() == in_tensor.dtype() &&
+         out_tensor.numel() == in_tensor.numel() * size_ && IsCPU(in_tensor) &&
+         IsCPU(out_tensor);
+}
+
+void GlooShmComm::AllReduce(phi::DenseTensor* out_tensor,
+                            const phi::DenseTensor& in_tensor,
+                            ReduceOp reduce_op,
+                            uint32_t tag) {
+  const auto dtype = in_tensor.dtype();
+  const size_t elem_size = phi::SizeOf(dtype);
+  const size_t numel = in_tensor.numel();
+  const size_t chunk = buffer_size_ / elem_size;
+  const char* in_data = static_cast<const char*>(in_tensor.data());
+  char* out_data = static_cast<char*>(out_tensor->data());
+  std::vector<const char*> srcs(local_size_);
+  for (size_t offset = 0; offset < numel; offset += chunk) {
+    const size_t n = std::min(chunk, numel - offset);
+    std::memcpy(Slot(local_rank_), in_data + offset * elem_size, n * elem_size);
+    char* buffer = NextBuffer();
+    LocalBarrier();
+
+    // every rank reduces a slice of the chunk of all the ranks into the
+    // buffer, the slices are of whole cache lines
+    const size_t slice = AlignUp((n + local_size_ - 1) / local_size_,
+                                 kCacheLine / elem_size);
+    const size_t begin = std::min(n, slice * local_rank_);
+    const size_t end = std::min(n, begin + slice);
+    if (begin < end) {
+      for (int i = 0; i < local_size_; ++i) {
+        srcs[i] = Slot(i) + begin * elem_size;
+      }
+      if (dtype == phi::DataType::FLOAT32) {
+        ReduceInto<float>(
+            buffer + begin * elem_size, srcs, end - begin, reduce_op);
+      } else {
+        ReduceInto<uint16_t>(
+            buffer + begin * elem_size, srcs, end - begin, reduce_op);
+      }
+    }
+    LocalBarrier();
+
+    if (num_nodes_ > 1) {
+      if (local_rank_ == 0) {
+        auto tensor = ShmTensor(buffer, dtype, static_cast<int64_t>(n));
+        InterCommContext()->AllReduce(
+            &tensor, tensor, static_cast<int>(reduce_op), tag);
+        InterDone();
+      } else {
+        WaitInter();
+      }
+    }
+    std::memcpy(out_data + offset * elem_size, buffer, n * elem_size);
+  }
+}
+
+void GlooShmComm::Broadcast(phi::DenseTensor* out_tensor,
+                            const phi::DenseTensor& in_tensor,
+                            int root,
+                            uint32_t tag) {
+  const size_t bytes = out_tensor->numel() * phi::SizeOf(out_tensor->dtype());
+  const char* in_data =
+      rank_ == root ? static_cast<const char*>(in_tensor.data()) : nullptr;
+  char* out_data = static_cast<char*>(out_tensor->data());
+  for (size_t offset = 0; offset < bytes; offset += buffer_size_) {
+    const size_t n = std::min(buffer_size_, bytes - offset);
+    char* buffer = NextBuffer();
+    if (rank_ == root) {
+      std::memcpy(buffer, in_data + offset, n);
+    }
+    LocalBarrier();
+
+    if (num_nodes_ > 1) {
+      if (local_rank_ == 0) {
+        auto tensor = ShmTensor(
+            buffer, phi::DataType::UINT8, static_cast<int64_t>(n));
+        InterCommContext()->Broadcast(&tensor, tensor, rank_nodes_[root], tag);
+        InterDone();
+      } else {
+        WaitInter();
+      }
+    }
+    if (out_data != in_data) {
+      std::memcpy(out_data + offset, buffer, n);
+    }
+  }
+}
+
+void GlooShmComm::AllGather(phi::DenseTensor* out_tensor,
+                            const phi::DenseTensor& in_tensor,
+                            uint32_t tag) {
+  // the pieces of the ranks are in the buffer in the order of the nodes, so
+  // that each leader sends the ones of its node in a row
+  const size_t bytes = in_tensor.numel() * phi::SizeOf(in_tensor.dtype());
+  const size_t piece = buffer_size_ / size_ / kCacheLine * kCacheLine;
+  const char* in_data = static_cast<const char*>(in_tensor.data());
+  char* out_data = static_cast<char*>(out_tensor->data());
+  auto position = [this](int rank) {
+    return rank_nodes_[rank] * local_size_ + rank_local_ranks_[rank];
+  };
+  for (size_t offset = 0; offset < bytes; offset += piece) {
+    const size_t n = std::min(piece, bytes - offset);
+    char* buffer = NextBuffer();
+    std::memcpy(buffer + position(rank_) * n, in_data + offset, n);
+    LocalBarrier();
+
+    if (num_nodes_ > 1) {
+      if (local_rank_ == 0) {
+        const size_t node_bytes = local_size_ * n;
+        auto in = ShmTensor(buffer + node_index_ * node_bytes,
+                            phi::DataType::UINT8,
+                            static_cast<int64_t>(node_bytes));
+        auto out = ShmTensor(
+            buffer, phi::DataType::UINT8, static_cast<int64_t>(size_ * n));
+        InterCommContext()->AllGather(&out, in, tag);
+        InterDone();
+      } else {
+        WaitInter();
+      }
+    }
+    for (int i = 0; i < size_; ++i) {
+      std::memcpy(out_data + i * bytes + offset, buffer + position(i) * n, n);
+    }
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
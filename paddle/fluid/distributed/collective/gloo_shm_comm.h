@@ -0,0 +1,130 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/distributed/gloo_comm_context.h"
+#include "paddle/phi/core/distributed/store/store.h"
+#include "paddle/phi/core/distributed/types.h"
+
+namespace paddle {
+namespace distributed {
+
+using phi::distributed::ReduceOp;
+
+struct GlooShmHeader;
+struct GlooShmFlag;
+
+// The all_reduce, broadcast and all_gather of a ProcessGroupGloo in two
+// levels: the ranks of a node, the ones of the same host name, exchange the
+// data through a shared memory segment instead of the tcp loopback, and only
+// one rank of every node, its leader, runs the Gloo collective across the
+// nodes on the data of the whole node. The data go through the segment in
+// chunks of FLAGS_gloo_shm_buffer_size bytes, between the steps of a chunk
+// the ranks of a node wait for each other on the counters in the segment.
+class GlooShmComm {
+ public:
+  // Returns nullptr when the collectives are better left to Gloo: the shared
+  // memory is disabled by FLAGS_gloo_shm_collective, the nodes hold a single
+  // or different numbers of ranks, or a rank fails to map the segment of its
+  // node. Every rank of the group calls it and gets the same answer.
+  static std::unique_ptr<GlooShmComm> Create(
+      const std::shared_ptr<phi::distributed::Store>& store,
+      int rank,
+      int size,
+      int gid);
+
+  ~GlooShmComm();
+
+  // The all_reduce of the float32 and bfloat16 tensors, reduced in float32
+  // in the nodes.
+  bool CanAllReduce(const phi::DenseTensor& out_tensor,
+                    const phi::DenseTensor& in_tensor,
+                    ReduceOp reduce_op) const;
+  bool CanBroadcast(const phi::DenseTensor& out_tensor,
+                    const phi::DenseTensor& in_tensor) const;
+  bool CanAllGather(const phi::DenseTensor& out_tensor,
+                    const phi::DenseTensor& in_tensor) const;
+
+  void AllReduce(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor,
+                 ReduceOp reduce_op,
+                 uint32_t tag);
+  void Broadcast(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor,
+                 int root,
+                 uint32_t tag);
+  void AllGather(phi::DenseTensor* out_tensor,
+                 const phi::DenseTensor& in_tensor,
+                 uint32_t tag);
+
+ private:
+  GlooShmComm(int rank, int size, int64_t timeout);
+
+  bool CreateSegment(const std::string& name, uint64_t token);
+  bool OpenSegment(const std::string& name, uint64_t token);
+  void MapSegment(void* addr);
+
+  char* Slot(int local_rank) const;
+  // The one of the two buffers of the current step, which alternate so that
+  // a rank fills one while the slower ones still copy out of the other.
+  char* NextBuffer();
+
+  // Marks the end of the current step of the rank, and waits for the ends of
+  // the step of all the ranks of the node.
+  void LocalBarrier();
+  // The leader marks the end of its collective across the nodes on the
+  // buffer, which the other ranks of the node wait for.
+  void InterDone();
+  void WaitInter() const;
+  void Wait(const GlooShmFlag& flag) const;
+
+  phi::distributed::GlooCommContext* InterCommContext() const;
+
+  int rank_;
+  int size_;
+  int64_t timeout_;  // in seconds
+
+  // the ranks of a node are numbered in the order of the ranks, and so are
+  // the nodes
+  int local_rank_ = 0;
+  int local_size_ = 0;
+  int node_index_ = 0;
+  int num_nodes_ = 0;
+  std::vector<int> rank_nodes_;
+  std::vector<int> rank_local_ranks_;
+  std::string inter_key_;
+
+  std::string name_;
+  void* addr_ = nullptr;
+  size_t segment_size_ = 0;
+  size_t buffer_size_ = 0;
+  GlooShmHeader* header_ = nullptr;
+  GlooShmFlag* flags_ = nullptr;  // the local ranks and the leader
+  char* slots_ = nullptr;
+  char* buffers_ = nullptr;
+
+  uint64_t seq_ = 0;
+  int buffer_index_ = 0;
+};
+
+}  // namespace distributed
+}  // namespace paddle
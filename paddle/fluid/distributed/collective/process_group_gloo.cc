@@ -162,11 +162,13 @@ ProcessGroupGloo::ProcessGroupGloo(
       _store(new GlooStore(store)) {
   _context = std::make_shared<gloo::rendezvous::Context>(rank, world_size);
   _context->connectFullMesh(*_store, options->device);
+  _shm_comm = GlooShmComm::Create(store, rank, world_size, gid);
 }
 
 class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   BroadcastGlooTask(phi::distributed::GlooCommContext* comm_context,
+                    GlooShmComm* shm_comm,
                     std::vector<phi::DenseTensor>& inputs,   // NOLINT
                     std::vector<phi::DenseTensor>& outputs,  // NOLINT
                     int rank,
@@ -174,6 +176,7 @@ class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
                     uint32_t tag)
       : ProcessGroupGloo::GlooTask(rank, inputs, CommType::BROADCAST),
         _comm_context(comm_context),
+        _shm_comm(shm_comm),
         _root(root),
         _inputs(inputs),
         _outputs(outputs),
@@ -183,12 +186,17 @@ class BroadcastGlooTask : public ProcessGroupGloo::GlooTask {
 
  private:
   phi::distributed::GlooCommContext* _comm_context;
+  GlooShmComm* _shm_comm;
   const int _root;
   std::vector<phi::DenseTensor> _inputs{};
   std::vector<phi::DenseTensor> _outputs{};
   const uint32_t _tag;
 
   void _do_broadcast(phi::DenseTensor& in, phi::DenseTensor& out) {  // NOLINT
+    if (_shm_comm != nullptr && _shm_comm->CanBroadcast(out, in)) {
+      _shm_comm->Broadcast(&(out), in, _root, _tag);
+      return;
+    }
     _comm_context->Broadcast(&(out), in, _root, _tag);
   }
 };
@@ -224,7 +232,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::Broadcast(
   auto tag = next_tag();
   auto comm_context = this->GetCommContext();
   task = std::make_unique<BroadcastGlooTask>(
-      comm_context, inputs, outputs, rank_, root, tag);
+      comm_context, _shm_comm.get(), inputs, outputs, rank_, root, tag);
   task->Run();
   return task;
 }
@@ -322,12 +330,14 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   AllreduceGlooTask(int rank,
                     phi::distributed::GlooCommContext* comm_context,
+                    GlooShmComm* shm_comm,
                     std::vector<phi::DenseTensor>& inputs,   // NOLINT
                     std::vector<phi::DenseTensor>& outputs,  // NOLINT
                     ReduceOp reduce_op,
                     uint32_t tag)
       : ProcessGroupGloo::GlooTask(rank, inputs, CommType::ALLREDUCE),
         _comm_context(comm_context),
+        _shm_comm(shm_comm),
         _inputs(inputs),
         _outputs(outputs),
         _reduce_op(reduce_op),
@@ -337,6 +347,7 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
 
  private:
   phi::distributed::GlooCommContext* _comm_context;
+  GlooShmComm* _shm_comm;
   std::vector<phi::DenseTensor> _inputs;
   std::vector<phi::DenseTensor> _outputs;
   const ReduceOp _reduce_op;
@@ -344,6 +355,11 @@ class AllreduceGlooTask : public ProcessGroupGloo::GlooTask {
 
   void _do_allreduce(std::vector<phi::DenseTensor>& ins,     // NOLINT
                      std::vector<phi::DenseTensor>& outs) {  // NOLINT
+    if (_shm_comm != nullptr &&
+        _shm_comm->CanAllReduce(outs[0], ins[0], _reduce_op)) {
+      _shm_comm->AllReduce(&(outs[0]), ins[0], _reduce_op, _tag);
+      return;
+    }
     _comm_context->AllReduce(
         &(outs[0]), ins[0], static_cast<int>(_reduce_op), _tag);
   }
@@ -377,8 +393,13 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllReduce(
   auto tag = next_tag();
   std::shared_ptr<GlooTask> task;
   auto comm_context = this->GetCommContext();
-  task = std::make_shared<AllreduceGlooTask>(
-      rank_, comm_context, inputs, outputs, opts.reduce_op, tag);
+  task = std::make_shared<AllreduceGlooTask>(rank_,
+                                             comm_context,
+                                             _shm_comm.get(),
+                                             inputs,
+                                             outputs,
+                                             opts.reduce_op,
+                                             tag);
   task->Run();
   return task;
 }
@@ -411,11 +432,13 @@ class AllgatherGlooTask : public ProcessGroupGloo::GlooTask {
  public:
   AllgatherGlooTask(int rank,
                     phi::distributed::GlooCommContext* comm_context,
+                    GlooShmComm* shm_comm,
                     std::vector<phi::DenseTensor>& inputs,   // NOLINT
                     std::vector<phi::DenseTensor>& outputs,  // NOLINT
                     uint32_t tag)
       : ProcessGroupGloo::GlooTask(rank, inputs, CommType::ALLGATHER),
         _comm_context(comm_context),
+        _shm_comm(shm_comm),
         _inputs(inputs),
         _outputs(outputs),
         _tag(tag) {}
@@ -424,12 +447,17 @@ class AllgatherGlooTask : public ProcessGroupGloo::GlooTask {
 
  private:
   phi::distributed::GlooCommContext* _comm_context;
+  GlooShmComm* _shm_comm;
   std::vector<phi::DenseTensor> _inputs;
   std::vector<phi::DenseTensor> _outputs;
   uint32_t _tag;
 
   void _do_allgather(std::vector<phi::DenseTensor>& in,     // NOLINT
                      std::vector<phi::DenseTensor>& out) {  // NOLINT
+    if (_shm_comm != nullptr && _shm_comm->CanAllGather(out[0], in[0])) {
+      _shm_comm->AllGather(&(out[0]), in[0], _tag);
+      return;
+    }
     _comm_context->AllGather(&(out[0]), in[0], _tag);
   }
 };
@@ -461,7 +489,7 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupGloo::AllGather(
   auto tag = next_tag();
   auto comm_context = this->GetCommContext();
   task = std::make_shared<AllgatherGlooTask>(
-      rank_, comm_context, in_tensors, out_tensors, tag);
+      rank_, comm_context, _shm_comm.get(), in_tensors, out_tensors, tag);
   task->Run();
   return task;
 }
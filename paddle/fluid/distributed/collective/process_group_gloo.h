@@ -18,6 +18,7 @@
 #include <memory>
 #include <mutex>
 
+#include "paddle/fluid/distributed/collective/gloo_shm_comm.h"
 #include "paddle/fluid/distributed/collective/process_group.h"
 #include "paddle/fluid/distributed/collective/process_group_without_stream.h"
 #include "paddle/phi/core/distributed/gloo_comm_context.h"
@@ -239,6 +240,8 @@ class ProcessGroupGloo : public ProcessGroupWithoutStream {
   uint32_t _tag;
   std::shared_ptr<gloo::rendezvous::Context> _context;
   std::shared_ptr<::gloo::rendezvous::Store> _store;
+  // nullptr when the all_reduce, broadcast and all_gather are left to Gloo
+  std::unique_ptr<GlooShmComm> _shm_comm;
 };
 
 }  // namespace distributed
@@ -13,8 +13,14 @@
 // limitations under the License.
 
 #include "paddle/fluid/distributed/collective/process_group_nccl.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/collective/common.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #include "paddle/fluid/platform/device/gpu/nccl_helper.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
@@ -29,6 +35,7 @@
 #include "paddle/phi/core/distributed/utils.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/utils/data_type.h"
+#include "paddle/phi/kernels/cast_kernel.h"
 
 COMMON_DECLARE_bool(benchmark);
 COMMON_DECLARE_bool(benchmark_nccl);
@@ -36,6 +43,9 @@ COMMON_DECLARE_bool(nccl_blocking_wait);
 COMMON_DECLARE_bool(use_stream_safe_cuda_allocator);
 COMMON_DECLARE_bool(use_cuda_malloc_async_allocator);
 COMMON_DECLARE_bool(enable_async_trace);
+COMMON_DECLARE_bool(nccl_hierarchical_allreduce);
+COMMON_DECLARE_int64(nccl_hierarchical_allreduce_min_size);
+COMMON_DECLARE_string(nccl_hierarchical_allreduce_compress);
 
 // set this flag to `true` and recompile to enable dynamic checks
 constexpr bool FLAGS_enable_nccl_dynamic_check = false;
@@ -243,6 +253,11 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::AllReduce(
   CheckTensorContiguous(in_tensor);
   CheckTensorContiguous(*out_tensor);
 
+  if (FLAGS_nccl_hierarchical_allreduce && !hierarchical_comms_created_) {
+    CreateHierarchicalComms(in_tensor.place());
+  }
+  const bool hierarchical = UseHierarchicalAllReduce(in_tensor);
+
   return Collective(
       [&](phi::distributed::NCCLCommContext* comm_context, gpuStream_t stream) {
         VLOG(3) << "[ncclAllReduce] "
@@ -255,9 +270,22 @@ std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::AllReduce(
                 << ", ncclcomm: " << comm_context->GetNcclComm()
                 << ", stream: " << stream << ", rank_in_group: " << rank_
                 << ", nranks: " << size_ << ", sync_op: " << sync_op
-                << ", use_calc_stream: " << use_calc_stream << ", "
+                << ", use_calc_stream: " << use_calc_stream
+                << ", hierarchical: " << hierarchical << ", "
                 << GetGroupMessage();
 
+        if (hierarchical) {
+          const auto& key = GetKeyFromPlace(in_tensor.place());
+          auto* ctx = use_calc_stream ? place_to_calc_ctx_.at(key)
+                                      : place_to_comm_ctx_.at(key).get();
+          HierarchicalAllReduce(comm_context,
+                                ctx,
+                                out_tensor,
+                                in_tensor,
+                                opts.reduce_op,
+                                stream);
+          return;
+        }
         comm_context->AllReduce(
             out_tensor, in_tensor, ToNCCLRedType(opts.reduce_op), stream);
       },
@@ -748,6 +776,10 @@ void ProcessGroupNCCL::CreateNCCLEnvCache(const Place& place,
 
   auto comm_ctx = std::make_unique<phi::GPUContext>(place);
   comm_ctx->set_nccl_comm(nccl_comm_ctx->GetNcclComm());
+  // for the casts of the hierarchical all_reduce on the comm stream
+  comm_ctx->SetAllocator(memory::allocation::AllocatorFacade::Instance()
+                             .GetAllocator(place, comm_ctx->stream())
+                             .get());
 
   if (FLAGS_enable_async_trace) {
     // gather global ranks in current group
@@ -816,6 +848,170 @@ void ProcessGroupNCCL::SyncCalcStream(const Place& place,
   calc_event.Wait(platform::Place2DeviceType(place), comm_ctx);
 }
 
+void ProcessGroupNCCL::CreateHierarchicalComms(const Place& place) {
+  hierarchical_comms_created_ = true;
+
+  // the ranks of a node are the ones of the same host name, they are numbered
+  // in the order of the ranks, and so are the nodes
+  char host_name[256] = {0};
+  PADDLE_ENFORCE_EQ(
+      gethostname(host_name, sizeof(host_name) - 1),
+      0,
+      phi::errors::External("Failed to get the host name of rank %d.", rank_));
+  const std::string prefix = "nccl_hierarchical/" + std::to_string(gid_) + "/";
+  const std::string host(host_name);
+  store_->set(prefix + std::to_string(rank_),
+              std::vector<uint8_t>(host.begin(), host.end()));
+
+  std::vector<std::string> keys;
+  for (int rank = 0; rank < size_; ++rank) {
+    keys.emplace_back(prefix + std::to_string(rank));
+  }
+  const auto rank_hosts = store_->multi_get(keys);
+
+  std::vector<std::string> nodes;
+  std::vector<int> node_sizes;
+  int node_index = 0;
+  int local_rank = 0;
+  for (int rank = 0; rank < size_; ++rank) {
+    const auto& rank_host = rank_hosts[rank];
+    auto iter = std::find(nodes.begin(),
+                          nodes.end(),
+                          std::string(rank_host.begin(), rank_host.end()));
+    const int index = static_cast<int>(iter - nodes.begin());
+    if (iter == nodes.end()) {
+      nodes.emplace_back(rank_host.begin(), rank_host.end());
+      node_sizes.push_back(0);
+    }
+    if (rank == rank_) {
+      node_index = index;
+      local_rank = node_sizes[index];
+    }
+    ++node_sizes[index];
+  }
+
+  const int num_nodes = static_cast<int>(nodes.size());
+  const int local_size = node_sizes[node_index];
+  if (num_nodes < 2 || local_size < 2 ||
+      std::count(node_sizes.begin(), node_sizes.end(), local_size) !=
+          num_nodes) {
+    LOG(WARNING) << "The all_reduce of the group " << gid_
+                 << " is flat, the hierarchical one needs several nodes of "
+                 << "the same number of ranks, but the group has "
+                 << num_nodes << " node(s) of "
+                 << string::join_strings(node_sizes, ',') << " rank(s).";
+    return;
+  }
+
+  platform::CUDADeviceGuard cuda_guard(place);
+  hierarchical_intra_key_ = prefix + "intra/" + std::to_string(node_index);
+  hierarchical_inter_key_ = prefix + "inter/" + std::to_string(local_rank);
+  phi::distributed::P2POption intra_opts(
+      {true, local_rank, local_size, local_rank});
+  phi::distributed::CommContextManager::CreateNCCLCommContext(
+      store_,
+      hierarchical_intra_key_,
+      local_rank,
+      local_size,
+      "",
+      &intra_opts,
+      nccl_comm_init_option_);
+  phi::distributed::P2POption inter_opts(
+      {true, node_index, num_nodes, node_index});
+  phi::distributed::CommContextManager::CreateNCCLCommContext(
+      store_,
+      hierarchical_inter_key_,
+      node_index,
+      num_nodes,
+      "",
+      &inter_opts,
+      nccl_comm_init_option_);
+
+  hierarchical_local_rank_ = local_rank;
+  hierarchical_local_size_ = local_size;
+  VLOG(3) << "The hierarchical all_reduce of the group " << gid_ << " runs on "
+          << num_nodes << " nodes of " << local_size
+          << " ranks, the local rank is " << local_rank << " of node "
+          << node_index;
+}
+
+bool ProcessGroupNCCL::UseHierarchicalAllReduce(
+    const phi::DenseTensor& tensor) const {
+  // the comms are created out of the nccl groups, and the coalesced ops run
+  // in one group
+  return FLAGS_nccl_hierarchical_allreduce && hierarchical_local_size_ > 1 &&
+         s_group_call_counter == 0 && !is_coalescing_ &&
+         tensor.numel() >= hierarchical_local_size_ &&
+         static_cast<int64_t>(tensor.numel() * phi::SizeOf(tensor.dtype())) >=
+             FLAGS_nccl_hierarchical_allreduce_min_size;
+}
+
+void ProcessGroupNCCL::HierarchicalAllReduce(
+    phi::distributed::NCCLCommContext* comm_context,
+    phi::GPUContext* ctx,
+    phi::DenseTensor* out_tensor,
+    const phi::DenseTensor& in_tensor,
+    ReduceOp reduce_op,
+    gpuStream_t stream) {
+  auto* intra_comm_context = GetCommContext(&hierarchical_intra_key_);
+  auto* inter_comm_context = GetCommContext(&hierarchical_inter_key_);
+  const auto nccl_red_type = ToNCCLRedType(reduce_op);
+
+  // The slice of the local rank is reduced in the node, then across the nodes,
+  // and gathered in the node. The tail which is not divided by the local size
+  // is of less than local size elements, it is reduced flat.
+  const int64_t numel = in_tensor.numel();
+  const int64_t slice_numel = numel / hierarchical_local_size_;
+  const int64_t sliced_numel = slice_numel * hierarchical_local_size_;
+  phi::DenseTensor in_sliced = GetPartialTensor(in_tensor, 0, sliced_numel);
+  phi::DenseTensor out_sliced = GetPartialTensor(*out_tensor, 0, sliced_numel);
+  phi::DenseTensor slice = GetPartialTensor(
+      *out_tensor, hierarchical_local_rank_ * slice_numel, slice_numel);
+
+  intra_comm_context->ReduceScatter(&slice, in_sliced, nccl_red_type, stream);
+
+  phi::DataType wire_dtype = in_tensor.dtype();
+  const auto& compress = FLAGS_nccl_hierarchical_allreduce_compress;
+  if (!compress.empty() && in_tensor.dtype() == phi::DataType::FLOAT32 &&
+      (reduce_op == ReduceOp::SUM || reduce_op == ReduceOp::AVG)) {
+    PADDLE_ENFORCE_EQ(
+        compress == "float16" || compress == "bfloat16",
+        true,
+        phi::errors::InvalidArgument(
+            "FLAGS_nccl_hierarchical_allreduce_compress must be float16 or "
+            "bfloat16, but got %s.",
+            compress));
+    wire_dtype = compress == "float16" ? phi::DataType::FLOAT16
+                                       : phi::DataType::BFLOAT16;
+  }
+  if (wire_dtype == in_tensor.dtype()) {
+    inter_comm_context->AllReduce(&slice, slice, nccl_red_type, stream);
+  } else {
+    phi::DenseTensor wire;
+    phi::CastKernel<float>(*ctx, slice, wire_dtype, &wire);
+    inter_comm_context->AllReduce(&wire, wire, nccl_red_type, stream);
+    if (wire_dtype == phi::DataType::FLOAT16) {
+      phi::CastKernel<phi::dtype::float16>(
+          *ctx, wire, phi::DataType::FLOAT32, &slice);
+    } else {
+      phi::CastKernel<phi::dtype::bfloat16>(
+          *ctx, wire, phi::DataType::FLOAT32, &slice);
+    }
+  }
+
+  intra_comm_context->AllGather(&out_sliced, slice, stream);
+
+  if (sliced_numel < numel) {
+    phi::DenseTensor out_tail =
+        GetPartialTensor(*out_tensor, sliced_numel, numel - sliced_numel);
+    comm_context->AllReduce(
+        &out_tail,
+        GetPartialTensor(in_tensor, sliced_numel, numel - sliced_numel),
+        nccl_red_type,
+        stream);
+  }
+}
+
 std::shared_ptr<ProcessGroup::Task> ProcessGroupNCCL::Collective(
     std::function<void(phi::distributed::NCCLCommContext*, gpuStream_t)> fn,
     const phi::DenseTensor& tensor,
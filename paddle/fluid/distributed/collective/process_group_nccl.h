@@ -201,6 +201,17 @@ class ProcessGroupNCCL final : public ProcessGroupWithStream {
 
   void SyncCalcStream(const Place& place, const std::string& place_key);
 
+  void CreateHierarchicalComms(const Place& place);
+
+  bool UseHierarchicalAllReduce(const phi::DenseTensor& tensor) const;
+
+  void HierarchicalAllReduce(phi::distributed::NCCLCommContext* comm_context,
+                             phi::GPUContext* ctx,
+                             phi::DenseTensor* out_tensor,
+                             const phi::DenseTensor& in_tensor,
+                             ReduceOp reduce_op,
+                             gpuStream_t stream);
+
   std::shared_ptr<ProcessGroup::Task> Collective(
       std::function<void(phi::distributed::NCCLCommContext*, gpuStream_t)> fn,
       const phi::DenseTensor& tensor,
@@ -267,6 +278,15 @@ class ProcessGroupNCCL final : public ProcessGroupWithStream {
   bool is_coalescing_{false};
   std::vector<std::shared_ptr<phi::DenseTensor>> colaescing_tensors_;
   std::vector<std::string> colaescing_place_keys_;
+
+  // The communicators of the hierarchical all_reduce, among the ranks of the
+  // node and among the ranks of the same local rank across the nodes. The
+  // local size is 1 if the all_reduce is flat.
+  bool hierarchical_comms_created_{false};
+  int hierarchical_local_rank_{0};
+  int hierarchical_local_size_{1};
+  std::string hierarchical_intra_key_;
+  std::string hierarchical_inter_key_;
 };
 
 }  //  namespace distributed
@@ -13,22 +13,45 @@
 // limitations under the License.
 
 #include "paddle/fluid/distributed/collective/reducer.h"
+
+#include <numeric>
+
 #include "paddle/common/flags.h"
 #include "paddle/phi/api/lib/data_transform.h"
 #include "paddle/phi/backends/device_guard.h"
 #include "paddle/phi/backends/device_manager.h"
+#include "paddle/phi/core/tensor_utils.h"
 
 PD_DECLARE_bool(use_stream_safe_cuda_allocator);
 COMMON_DECLARE_string(allocator_strategy);
+COMMON_DECLARE_bool(eager_reducer_rebuild_groups);
+COMMON_DECLARE_int64(eager_reducer_first_bucket_size);
+COMMON_DECLARE_bool(eager_reducer_contiguous_grads);
 
 namespace paddle {
 namespace distributed {
 
+// The groups are rebuilt after the steps. The time the gradients are ready in
+// the first one is blurred by the allocations and the autotune of the kernels.
+static constexpr size_t kRebuildObservedSteps = 2;
+// A pause of the gradients longer than the ratio of the backward closes the
+// groups.
+static constexpr double kRebuildPauseRatio = 0.1;
+
 static bool IsStreamSafeAllocator() {
   return (FLAGS_allocator_strategy == "auto_growth" &&
           FLAGS_use_stream_safe_cuda_allocator);
 }
 
+// The grad of a var of the shape dims, sharing the memory of its view in the
+// contiguous grad buffer of its group.
+static std::shared_ptr<phi::DenseTensor> GradViewOfGroupTensor(
+    const phi::DenseTensor &group_tensor, const phi::DDim &dims) {
+  auto grad_view = std::make_shared<phi::DenseTensor>();
+  grad_view->ShareDataWith(group_tensor).Resize(dims);
+  return grad_view;
+}
+
 static Backend TransToBackend(phi::Place place) {
   static const std::map<phi::AllocationType, Backend> type_backend = {
       {phi::AllocationType::GPU, Backend::GPU},
@@ -498,6 +521,7 @@ EagerReducer::EagerReducer(
   VLOG(3) << "Start construct the Reducer ...";
 
   nranks_ = process_group_->GetSize();
+  use_contiguous_grads_ = FLAGS_eager_reducer_contiguous_grads;
 
   // initialize groups
   InitializeGroups(group_indices);
@@ -517,12 +541,16 @@ EagerReducer::EagerReducer(
         std::dynamic_pointer_cast<egr::GradNodeAccumulation>(grad_node);
     accumulation_grad_node->RegisterReduceHook(
         std::make_shared<egr::CppVoidHook>(reduce_hook));
+    if (use_contiguous_grads_ && !is_sparse_gradient_[global_var_index]) {
+      accumulation_grad_node->SetAccumulateInplace(true);
+    }
 
     gradnode_index_map_[grad_node.get()] = global_var_index;
   }
 
   vars_marked_ready_.resize(tensors_.size(), false);
   local_used_vars_.resize(tensors_.size(), 0);
+  rebuild_ready_times_.resize(tensors_.size(), 0.0);
 
   if (find_unused_vars_each_step_) {
     global_used_vars_ = paddle::experimental::empty(
@@ -636,6 +664,89 @@ void EagerReducer::InitializeDenseGroups(
     }
   }
   p_group->all_length_ = all_length;
+
+  if (use_contiguous_grads_) {
+    InitializeContiguousGrads(tensor_indices_, p_group);
+  }
+}
+
+void EagerReducer::InitializeContiguousGrads(
+    const std::vector<size_t> &tensor_indices_, EagerGroup *p_group) {
+  VLOG(3) << "InitializeContiguousGrads.";
+  // The grads are zeros until the first backward pass. When the groups are
+  // rebuilt, the grads of the last pass are copied into the new buffer and
+  // the old one is released with the old groups.
+  p_group->dense_contents_ = paddle::experimental::full(
+      IntArray({p_group->all_length_}), 0.0, p_group->dtype_, inner_place_);
+  const auto &contents = *std::dynamic_pointer_cast<phi::DenseTensor>(
+      p_group->dense_contents_.impl());
+
+  int64_t offset = 0;
+  for (size_t index = 0; index < tensor_indices_.size(); ++index) {
+    const auto length = p_group->length_[index];
+    p_group->dense_tensors_[index] = contents.Slice(offset, offset + length);
+    offset += length;
+
+    const auto var_index = tensor_indices_[index];
+    if (HasGrad(var_index)) {
+      KeepGradInGroup(var_index, *p_group, index);
+    } else {
+      egr::EagerUtils::mutable_grad(tensors_[var_index])
+          ->set_impl(GradViewOfGroupTensor(p_group->dense_tensors_[index],
+                                           tensors_[var_index].dims()));
+    }
+  }
+}
+
+void EagerReducer::KeepGradInGroup(size_t var_index,
+                                   const EagerGroup &group,
+                                   size_t inside_group_index) {
+  const auto &group_tensor = group.dense_tensors_[inside_group_index];
+  auto *grad_tensor = egr::EagerUtils::mutable_grad(tensors_[var_index]);
+  PADDLE_ENFORCE_EQ(
+      grad_tensor->is_dense_tensor(),
+      true,
+      phi::errors::PreconditionNotMet(
+          "The grad of Tensor %s must be a DenseTensor to be kept in the "
+          "contiguous grad buffer.",
+          tensors_[var_index].name()));
+  auto dense_tensor =
+      std::dynamic_pointer_cast<phi::DenseTensor>(grad_tensor->impl());
+  if (dense_tensor->IsSharedBufferWith(group_tensor) &&
+      dense_tensor->offset() == group_tensor.offset()) {
+    return;
+  }
+
+  // The grad is released by clear_gradients(set_to_zero=False), or replaced
+  // by a hook, it is copied back into the buffer.
+  VLOG(3) << "Copy the grad of Tensor[" << tensors_[var_index].name()
+          << "] into the contiguous grad buffer";
+  PADDLE_ENFORCE_EQ(
+      dense_tensor->dtype(),
+      group.dtype_,
+      phi::errors::PreconditionNotMet(
+          "The grad of Tensor %s is %s, but its contiguous grad buffer is %s.",
+          tensors_[var_index].name(),
+          dense_tensor->dtype(),
+          group.dtype_));
+  PADDLE_ENFORCE_EQ(
+      dense_tensor->numel(),
+      group_tensor.numel(),
+      phi::errors::PreconditionNotMet(
+          "The grad of Tensor %s has %d elements, but its view of the "
+          "contiguous grad buffer has %d.",
+          tensors_[var_index].name(),
+          dense_tensor->numel(),
+          group_tensor.numel()));
+  if (!dense_tensor->meta().is_contiguous()) {
+    dense_tensor = std::make_shared<phi::DenseTensor>(
+        paddle::experimental::Trans2Contiguous(*dense_tensor));
+  }
+  auto grad_view = GradViewOfGroupTensor(group_tensor, dense_tensor->dims());
+  auto *dev_ctx = phi::DeviceContextPool::Instance().Get(inner_place_);
+  phi::Copy(*dev_ctx, *dense_tensor, inner_place_, false, grad_view.get());
+  grad_view->Resize(tensors_[var_index].dims());
+  grad_tensor->set_impl(grad_view);
 }
 
 void EagerReducer::TraverseBackwardGraph(const std::vector<Tensor> &outputs) {
@@ -765,6 +876,13 @@ void EagerReducer::AddDistHook(size_t var_index) {
     auto &group = groups_[group_index];
     auto &group_tensor = group.dense_tensors_[inside_group_index];
 
+    if (use_contiguous_grads_ && !group.is_sparse_) {
+      if (HasGrad(var_index)) {
+        KeepGradInGroup(var_index, group, inside_group_index);
+      }
+      return;
+    }
+
     auto *autograd_meta = tensors_[var_index].get_autograd_meta();
     auto &grad_tensor = static_cast<egr::AutogradMeta *>(autograd_meta)->Grad();
 
@@ -829,6 +947,9 @@ void EagerReducer::MarkVarReady(const size_t var_index,
                       phi::errors::PreconditionNotMet(error_info));
   } else {
     vars_marked_ready_[var_index] = true;
+    if (NeedRebuildGroups()) {
+      RecordReadyVar(var_index);
+    }
   }
   groups_need_finalize_ = true;
 
@@ -838,7 +959,18 @@ void EagerReducer::MarkVarReady(const size_t var_index,
 
   auto &group = groups_[group_index];
 
-  if (!group.is_sparse_) {
+  if (!group.is_sparse_ && use_contiguous_grads_) {
+    // The grad is accumulated in its view of dense_contents_ already.
+    if (HasGrad(var_index)) {
+      KeepGradInGroup(var_index, group, inside_group_index);
+    } else {
+      VLOG(3) << "Tensor[" << tensors_[var_index].name()
+              << "] doesn't have grad";
+      auto *dev_ctx = phi::DeviceContextPool::Instance().Get(inner_place_);
+      phi::funcs::set_constant(
+          *dev_ctx, &group.dense_tensors_[inside_group_index], 0.0f);
+    }
+  } else if (!group.is_sparse_) {
     auto &group_tensor = group.dense_tensors_[inside_group_index];
     const auto length = group.length_[inside_group_index];
     if (is_used_var) {
@@ -1048,10 +1180,15 @@ void EagerReducer::ProcessUnusedDenseVars() {
           GetGradNodeFromTensor(&tensors_[var_index]))
           ->SetFakeEmpty(false);
 
-      Tensor grad_value(std::make_shared<phi::DenseTensor>(src_tensor));
-
       auto dest_var_base = tensors_[var_index];
       auto grad_tensor = egr::EagerUtils::mutable_grad(dest_var_base);
+      if (use_contiguous_grads_) {
+        grad_tensor->set_impl(
+            GradViewOfGroupTensor(src_tensor, dest_var_base.dims()));
+        continue;
+      }
+
+      Tensor grad_value(std::make_shared<phi::DenseTensor>(src_tensor));
       grad_tensor->copy_(grad_value, inner_place_, true);
       grad_tensor->reshape(dest_var_base.shape());
     }
@@ -1064,7 +1201,7 @@ void EagerReducer::FinalizeBackward() {
   for (auto &group : groups_) {
     if (!group.is_sparse_) {
       group.task->Synchronize();
-      if (!IsStreamSafeAllocator()) {
+      if (!IsStreamSafeAllocator() && !use_contiguous_grads_) {
         auto *default_ctx =
             phi::DeviceContextPool::Instance().Get(inner_place_);
         group.SplitTensors(*default_ctx);
@@ -1079,19 +1216,174 @@ void EagerReducer::FinalizeBackward() {
     VLOG(3) << "ProcessUnusedDenseVars is finished.";
   }
 
+  if (NeedRebuildGroups()) {
+    rebuild_ready_vars_ = 0;
+    if (++rebuild_steps_ == kRebuildObservedSteps) {
+      VLOG(3) << "Start rebuilding the groups";
+      RebuildGroups();
+    }
+  }
+
   VLOG(3) << "In the batch, Reducer is finished.";
 }
 
+bool EagerReducer::NeedRebuildGroups() const {
+  return FLAGS_eager_reducer_rebuild_groups && !has_rebuilt_groups_ &&
+         !find_unused_vars_each_step_ && nranks_ > 1;
+}
+
+void EagerReducer::RecordReadyVar(size_t var_index) {
+  auto now = std::chrono::steady_clock::now();
+  if (rebuild_ready_vars_++ == 0) {
+    backward_begin_ = now;
+  }
+  rebuild_ready_times_[var_index] +=
+      std::chrono::duration<double, std::micro>(now - backward_begin_).count();
+}
+
+std::vector<std::vector<size_t>> EagerReducer::RebuildGroupIndices() {
+  // the vars in the order they are ready on average in the observed steps
+  std::vector<size_t> order(tensors_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](size_t x, size_t y) {
+    return rebuild_ready_times_[x] < rebuild_ready_times_[y];
+  });
+  VLOG(3) << "The order of parameter arrival: "
+          << string::join_strings(order, ',');
+
+  auto var_bytes = [this](size_t var_index) -> size_t {
+    const auto &var = tensors_[var_index];
+    if (is_sparse_gradient_[var_index] || !var.is_dense_tensor()) {
+      return 0;
+    }
+    return phi::SizeOf(var.dtype()) * var.numel();
+  };
+  // the bytes of the vars ready from the i-th one on
+  std::vector<size_t> remaining_bytes(order.size() + 1, 0);
+  for (size_t i = order.size(); i > 0; --i) {
+    remaining_bytes[i - 1] = remaining_bytes[i] + var_bytes(order[i - 1]);
+  }
+
+  // The first group is small to start the allreduce early, and the last ones,
+  // whose allreduce is left after the backward, hold at most
+  // group_size_limits_[0], i.e. the last_comm_buffer_size of DataParallel.
+  // The groups are also closed at a long pause of the gradients, the
+  // allreduce of the ready ones is then overlapped with the pause.
+  const size_t group_limit = group_size_limits_.back();
+  const size_t last_group_limit = group_size_limits_.front();
+  const size_t first_group_limit =
+      FLAGS_eager_reducer_first_bucket_size > 0
+          ? static_cast<size_t>(FLAGS_eager_reducer_first_bucket_size)
+          : group_limit;
+  const double span = rebuild_ready_times_[order.back()] -
+                      rebuild_ready_times_[order.front()];
+
+  std::vector<std::vector<size_t>> res;
+  std::map<phi::DataType, std::pair<std::vector<size_t>, size_t>> next_group;
+  bool has_dense_group = false;
+  bool in_last_groups = false;
+  auto close_group = [&](std::pair<std::vector<size_t>, size_t> *group_info) {
+    if (group_info->first.empty()) return;
+    res.emplace_back(std::move(group_info->first));
+    *group_info = std::pair<std::vector<size_t>, size_t>();
+    has_dense_group = true;
+  };
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    const auto var_index = order[i];
+    if (is_sparse_gradient_[var_index]) {
+      // we keep sparse var a single group
+      res.push_back({var_index});
+      continue;
+    }
+    const auto &var = tensors_[var_index];
+    if (!var.is_dense_tensor()) {
+      continue;
+    }
+
+    if (!in_last_groups && remaining_bytes[i] <= last_group_limit) {
+      in_last_groups = true;
+      for (auto &it : next_group) {
+        close_group(&it.second);
+      }
+    }
+
+    auto &group_info = next_group[var.dtype()];
+    group_info.first.push_back(var_index);
+    group_info.second += var_bytes(var_index);
+
+    const size_t limit = has_dense_group ? group_limit : first_group_limit;
+    const bool before_pause =
+        i + 1 < order.size() &&
+        rebuild_ready_times_[order[i + 1]] - rebuild_ready_times_[var_index] >
+            kRebuildPauseRatio * span;
+    if (group_info.second >= limit || (!in_last_groups && before_pause)) {
+      close_group(&group_info);
+    }
+  }
+  for (auto &it : next_group) {
+    close_group(&it.second);
+  }
+  return res;
+}
+
+void EagerReducer::RebuildGroups() {
+  auto group_indices = RebuildGroupIndices();
+
+  // The ranks see their own ready time of the vars, all of them follow the
+  // groups of rank 0 to allreduce the same tensors. They are sent as the vars
+  // of the groups followed by the index of their groups.
+  std::vector<int64_t> groups_info(2 * tensors_.size(), -1);
+  size_t pos = 0;
+  for (size_t group_index = 0; group_index < group_indices.size();
+       ++group_index) {
+    for (const auto var_index : group_indices[group_index]) {
+      groups_info[pos] = static_cast<int64_t>(var_index);
+      groups_info[tensors_.size() + pos] = static_cast<int64_t>(group_index);
+      ++pos;
+    }
+  }
+
+  const auto *dev_ctx = phi::DeviceContextPool::Instance().Get(inner_place_);
+  phi::DenseTensor groups_tensor;
+  framework::TensorFromVector<int64_t>(groups_info, *dev_ctx, &groups_tensor);
+  distributed::BroadcastOptions opts;
+  opts.source_rank = 0;
+  std::vector<phi::DenseTensor> in_out = {groups_tensor};
+  process_group_->Broadcast(in_out, in_out, opts)->Synchronize();
+  framework::TensorToVector<int64_t>(in_out.front(), *dev_ctx, &groups_info);
+  dev_ctx->Wait();
+
+  group_indices.clear();
+  for (size_t i = 0; i < tensors_.size() && groups_info[i] >= 0; ++i) {
+    const auto group_index =
+        static_cast<size_t>(groups_info[tensors_.size() + i]);
+    if (group_index == group_indices.size()) {
+      group_indices.emplace_back();
+    }
+    group_indices.back().push_back(static_cast<size_t>(groups_info[i]));
+  }
+
+  has_rebuilt_groups_ = true;
+  group_indices_ = std::move(group_indices);
+  InitializeGroups(group_indices_);
+  VLOG(3) << "The groups are rebuilt to " << group_indices_.size()
+          << " groups";
+}
+
 void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
                                           const int curr_group_index) {
-  // The overall timeline: concat > div_nranks > allreduce > split
+  // The overall timeline: concat > div_nranks > allreduce > split, the
+  // contiguous grads are reduced in place without concat and split.
   distributed::AllreduceOptions opts;
   opts.reduce_op = ReduceOp::SUM;
 
   VLOG(3) << "group [" << curr_group_index << "] start fused_allreduce.";
 
   // concat tensors
-  group->ConcatTensors(inner_place_);
+  if (!use_contiguous_grads_) {
+    group->ConcatTensors(inner_place_);
+  }
 
   // div nranks
   paddle::experimental::scale_(
@@ -1113,7 +1405,9 @@ void EagerReducer::FusedAllReduceSchedule(EagerGroup *group,
     // insecure. In the Split operator, additional memory will be applied for
     // calculation, and if it is asynchronous, an illegal memory access may be
     // encountered.
-    group->SplitTensors(*context);
+    if (!use_contiguous_grads_) {
+      group->SplitTensors(*context);
+    }
     group->task->UpdateWaitChain(*context);
   }
 }
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <vector>
 
@@ -50,7 +51,7 @@ class EagerGroup {
   Tensor sparse_contents_;
   bool is_sparse_ = false;
 
-  // for concat kernel
+  // for concat kernel, or the views of dense_contents_ with contiguous grads
   std::vector<phi::DenseTensor> dense_tensors_;
   std::vector<int64_t> length_;
   int64_t all_length_{0};
@@ -102,6 +103,11 @@ class EagerReducer {
   void InitializeGroups(const std::vector<std::vector<size_t>> &group_indices);
   void InitializeDenseGroups(const std::vector<size_t> &tensor_indices_,
                              EagerGroup *p_group);
+  void InitializeContiguousGrads(const std::vector<size_t> &tensor_indices_,
+                                 EagerGroup *p_group);
+  void KeepGradInGroup(size_t var_index,
+                       const EagerGroup &group,
+                       size_t inside_group_index);
   void PrepareForBackward(const std::vector<Tensor> &outputs);
   void AddDistHook(size_t var_index);
   void MarkVarReady(const size_t var_index, const bool is_used_var);
@@ -112,6 +118,10 @@ class EagerReducer {
   void TraverseBackwardGraph(const std::vector<Tensor> &outputs);
   void ProcessUnusedDenseVars();
   bool HasGrad(size_t var_index);
+  bool NeedRebuildGroups() const;
+  void RecordReadyVar(size_t var_index);
+  std::vector<std::vector<size_t>> RebuildGroupIndices();
+  void RebuildGroups();
 
  private:
   std::vector<Tensor> tensors_;
@@ -128,6 +138,11 @@ class EagerReducer {
 
   bool grad_need_hooks_{false};
 
+  // The grads of the dense groups are the views of dense_contents_, which is
+  // allreduced in place. It is FLAGS_eager_reducer_contiguous_grads when the
+  // reducer is built.
+  bool use_contiguous_grads_{false};
+
   std::vector<bool> vars_marked_ready_;
   std::vector<int32_t> local_used_vars_;
 
@@ -139,6 +154,15 @@ class EagerReducer {
   bool find_unused_vars_once_{true};
   bool groups_need_finalize_{false};
   Tensor global_used_vars_;
+
+  // Following variables are to help rebuild groups by the order and the time
+  // the gradients are ready in the first steps
+  bool has_rebuilt_groups_{false};
+  size_t rebuild_steps_{0};
+  size_t rebuild_ready_vars_{0};
+  std::chrono::steady_clock::time_point backward_begin_;
+  // the sum of the ready time of the vars in the steps, in us
+  std::vector<double> rebuild_ready_times_;
 };
 
 }  //  namespace distributed
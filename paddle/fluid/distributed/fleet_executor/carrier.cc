@@ -15,6 +15,7 @@
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 
 #include <algorithm>
+#include <chrono>
 #include <vector>
 
 #include "paddle/common/flags.h"
@@ -34,6 +35,12 @@ PHI_DEFINE_EXPORTED_bool(
     "Use standalone executor to run ops. Temporary FLAGS, will be removed "
     "after all fleet executor cases are modified to run ops with standalone "
     "executor.");
+PHI_DEFINE_EXPORTED_bool(
+    fleet_executor_bubble_ratio,
+    false,
+    "Log the bubble ratio of the pipeline stage of each rank after each step. "
+    "It waits for the device after the ops of each interceptor run, to time "
+    "them.");
 COMMON_DECLARE_bool(cache_inference_while_scope);
 
 namespace paddle {
@@ -104,6 +111,11 @@ void Carrier::Init(
   thread_pool_.Start();
 
   CreateInterceptors(inference_root_scope_vars);
+  schedule_ =
+      BuildPipelineSchedule(interceptor_id_to_node_, rank_, num_micro_batches);
+  for (const auto& step : schedule_) {
+    scheduled_ids_.insert(step.first);
+  }
   is_init_ = true;
 }
 
@@ -186,6 +198,9 @@ void Carrier::Start() {
       is_init_,
       true,
       phi::errors::PreconditionNotMet("Using carrier before initialized."));
+  schedule_pos_ = 0;
+  busy_ms_ = 0.;
+  auto start_time = std::chrono::steady_clock::now();
   InterceptorMessage start_msg;
   start_msg.set_dst_id(SOURCE_ID);
   start_msg.set_src_id(SOURCE_ID);
@@ -194,6 +209,15 @@ void Carrier::Start() {
   // TODO(wangxi): async step
   Wait();
   dev_ctx_->Wait();
+  if (FLAGS_fleet_executor_bubble_ratio) {
+    double step_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start_time)
+                         .count();
+    LOG(INFO) << "The pipeline stage of rank " << rank_ << " is busy for "
+              << busy_ms_ << " ms of the step of " << step_ms
+              << " ms, the bubble ratio is "
+              << (step_ms > 0 ? 1. - busy_ms_ / step_ms : 0.);
+  }
   if (!FLAGS_cache_inference_while_scope) {
     // don't drop_kids when cache_inference_while_scope
     for (auto* micro_scope : microbatch_scopes_) {
@@ -247,6 +271,32 @@ bool Carrier::Send(const InterceptorMessage& msg) {
   return GlobalVal<MessageBus>::Get()->Send(dst_rank, msg);
 }
 
+bool Carrier::IsScheduled(int64_t interceptor_id, int64_t scope_id) const {
+  if (scheduled_ids_.find(interceptor_id) == scheduled_ids_.end()) {
+    return true;
+  }
+  return schedule_pos_ < schedule_.size() &&
+         schedule_[schedule_pos_] == std::make_pair(interceptor_id, scope_id);
+}
+
+void Carrier::FinishScheduled(int64_t interceptor_id) {
+  if (scheduled_ids_.find(interceptor_id) == scheduled_ids_.end()) {
+    return;
+  }
+  ++schedule_pos_;
+  if (schedule_pos_ < schedule_.size() &&
+      schedule_[schedule_pos_].first != interceptor_id) {
+    VLOG(3) << "Interceptor " << interceptor_id
+            << " wakes the next interceptor " << schedule_[schedule_pos_].first
+            << " of the pipeline schedule up.";
+    InterceptorMessage msg;
+    msg.set_src_id(interceptor_id);
+    msg.set_dst_id(schedule_[schedule_pos_].first);
+    msg.set_message_type(SCHEDULE_READY);
+    Send(msg);
+  }
+}
+
 Interceptor* Carrier::SetInterceptor(int64_t interceptor_id,
                                      std::unique_ptr<Interceptor> interceptor) {
   auto iter = interceptor_idx_to_interceptor_.find(interceptor_id);
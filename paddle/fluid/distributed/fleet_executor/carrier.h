@@ -20,6 +20,8 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "paddle/common/errors.h"
@@ -89,6 +91,15 @@ class Carrier final {
 
   bool Send(const InterceptorMessage& msg);
 
+  // Whether it's the turn of the interceptor to run the scope in the pipeline
+  // schedule, always true for the interceptors not in the schedule.
+  bool IsScheduled(int64_t interceptor_id, int64_t scope_id) const;
+  // Move the pipeline schedule to the next step, and wake its interceptor up.
+  void FinishScheduled(int64_t interceptor_id);
+  // The time the interceptors of this rank run their ops in the step, for the
+  // bubble ratio of the pipeline stage.
+  void AddBusyTime(double ms) { busy_ms_ += ms; }
+
  private:
   DISABLE_COPY_AND_ASSIGN(Carrier);
   Carrier() = delete;
@@ -119,6 +130,12 @@ class Carrier final {
   int thread_num_;
   TaskLoopThreadPool thread_pool_;
   std::unordered_set<int64_t> interceptor_ids_;
+
+  // only accessed by the interceptors on the single task loop of the carrier
+  std::vector<std::pair<int64_t, int64_t>> schedule_;
+  std::unordered_set<int64_t> scheduled_ids_;
+  size_t schedule_pos_{0};
+  double busy_ms_{0.};
 };
 
 }  // namespace distributed
@@ -14,13 +14,18 @@
 
 #include "paddle/fluid/distributed/fleet_executor/compute_interceptor.h"
 
+#include <chrono>
+
 #include "paddle/common/errors.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
 #include "paddle/fluid/framework/executor_gc_helper.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/jit/serializer.h"
 
+COMMON_DECLARE_bool(fleet_executor_bubble_ratio);
+
 namespace paddle {
 namespace distributed {
 
@@ -320,11 +325,21 @@ void ComputeInterceptor::RunOps() {
 }
 
 void ComputeInterceptor::Run() {
-  while (IsInputReady() && CanWriteOutput()) {
+  while (IsInputReady() && CanWriteOutput() &&
+         carrier_->IsScheduled(interceptor_id_, cur_scope_id_)) {
     VLOG(3) << "id=" << GetInterceptorId()
             << " ComputeInterceptor running in scope " << cur_scope_id_;
 
-    RunOps();
+    if (FLAGS_fleet_executor_bubble_ratio) {
+      auto start_time = std::chrono::steady_clock::now();
+      RunOps();
+      phi::DeviceContextPool::Instance().Get(place_)->Wait();
+      carrier_->AddBusyTime(std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start_time)
+                                .count());
+    } else {
+      RunOps();
+    }
 
     if (!gen_step_to_scope_id_to_finish_flag_.empty()) {
       auto iter = gen_step_to_scope_id_to_finish_flag_.begin();
@@ -357,6 +372,8 @@ void ComputeInterceptor::Run() {
         lod_tensor_arr->clear();
       }
     }
+    // wake the next interceptor of the pipeline schedule up
+    carrier_->FinishScheduled(interceptor_id_);
   }
 }
 
@@ -393,6 +410,10 @@ void ComputeInterceptor::Compute(const InterceptorMessage& msg) {
     gen_step_to_scope_id_to_finish_flag_[gen_step].emplace(msg.scope_idx(),
                                                            false);
     Run();
+  } else if (msg.message_type() == SCHEDULE_READY) {
+    VLOG(3) << "Compute interceptor " << interceptor_id_
+            << " receive schedule_ready " << msg.src_id();
+    Run();
   }
 }
 
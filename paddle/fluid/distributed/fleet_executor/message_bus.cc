@@ -14,15 +14,28 @@
 
 #include "paddle/fluid/distributed/fleet_executor/message_bus.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <set>
 #include <thread>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/fleet_executor/carrier.h"
 #include "paddle/fluid/distributed/fleet_executor/global.h"
 #include "paddle/fluid/platform/gen_comm_id_helper.h"
 
+PHI_DEFINE_EXPORTED_bool(
+    fleet_executor_use_shm,
+    false,
+    "Send the interceptor messages between the ranks on the same host by "
+    "shared memory instead of brpc.");
+PHI_DEFINE_EXPORTED_int64(
+    fleet_executor_shm_queue_size,
+    16 << 20,
+    "The bytes of the shared memory ring buffer each rank receives the "
+    "interceptor messages of the other ranks on the same host from.");
+
 namespace paddle::distributed {
 
 void MessageBus::Init(
@@ -65,6 +78,9 @@ void MessageBus::Init(
 #endif
 
   ListenPort();
+#if !defined(_WIN32)
+  ListenShm();
+#endif
 }
 
 bool MessageBus::IsInit() const { return is_init_; }
@@ -92,6 +108,22 @@ bool MessageBus::Send(int64_t dst_rank,
       true,
       phi::errors::PreconditionNotMet(
           "Using message bus since it has not been initialized."));
+#if !defined(_WIN32)
+  if (FLAGS_fleet_executor_use_shm && IsLocalRank(dst_rank)) {
+    int retry_time = 0;  // wait 10 seconds for the queue of dst to be created
+    while (retry_time < 10) {
+      ++retry_time;
+      if (SendShm(dst_rank, interceptor_message)) {
+        return true;
+      }
+      VLOG(3) << "Message bus waits for the shm message queue of rank "
+              << dst_rank << ", retry after 1 seconds.";
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    }
+    VLOG(3) << "Message bus sends by shm fail after 10 times retries.";
+    return false;
+  }
+#endif
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
   int retry_time = 0;  // message bus will retry sending for 10 times
   while (retry_time < 10) {
@@ -205,6 +237,59 @@ void MessageBus::ListenPort() {
 #endif
 }
 
+#if !defined(_WIN32)
+static std::string GetShmName(const std::string& addr) {
+  std::string name = "/paddle_fleet_executor_" + addr;
+  std::replace(name.begin() + 1, name.end(), ':', '_');
+  return name;
+}
+
+static std::string GetHost(const std::string& addr) {
+  return addr.substr(0, addr.rfind(':'));
+}
+
+void MessageBus::ListenShm() {
+  if (!FLAGS_fleet_executor_use_shm || addr_.empty()) {
+    return;
+  }
+  shm_queue_ = ShmMessageQueue::Create(
+      GetShmName(addr_),
+      static_cast<size_t>(FLAGS_fleet_executor_shm_queue_size),
+      [this](const InterceptorMessage& interceptor_message) {
+        if (interceptor_message.ctrl_message()) {
+          IncreaseBarrierCount();
+        } else {
+          DispatchMsgToCarrier(interceptor_message);
+        }
+      });
+  LOG(INFO) << "Message bus receives the messages of the ranks on the same "
+               "host by shared memory.";
+}
+
+bool MessageBus::IsLocalRank(int64_t rank) const {
+  return !addr_.empty() && GetHost(GetAddr(rank)) == GetHost(addr_);
+}
+
+bool MessageBus::SendShm(int64_t dst_rank,
+                         const InterceptorMessage& interceptor_message) {
+  ShmMessageQueue* queue = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(shm_mutex_);
+    auto& dst_queue = rank_to_shm_queue_[dst_rank];
+    if (dst_queue == nullptr) {
+      dst_queue = ShmMessageQueue::Open(GetShmName(GetAddr(dst_rank)));
+    }
+    queue = dst_queue.get();
+  }
+  if (queue == nullptr) {
+    return false;
+  }
+  queue->Push(interceptor_message);
+  VLOG(3) << "Message bus: shm sends to rank " << dst_rank << " success.";
+  return true;
+}
+#endif
+
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
 bool MessageBus::SendInterRank(int64_t dst_rank,
                                const InterceptorMessage& interceptor_message) {
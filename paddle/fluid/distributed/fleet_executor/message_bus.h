@@ -15,6 +15,7 @@
 #pragma once
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -29,6 +30,7 @@
 #include "paddle/common/errors.h"
 #include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+#include "paddle/fluid/distributed/fleet_executor/shm_message_queue.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -63,6 +65,16 @@ class MessageBus final {
 
   const std::string& GetAddr(int64_t rank) const;
 
+#if !defined(_WIN32)
+  // create the shm message queue of this rank
+  void ListenShm();
+  // whether the rank is on the same host with this one
+  bool IsLocalRank(int64_t rank) const;
+  // send the message to the rank on the same host by the shm message queue,
+  // false if the queue of the rank isn't created yet
+  bool SendShm(int64_t dst_rank, const InterceptorMessage& interceptor_message);
+#endif
+
 #if defined(PADDLE_WITH_DISTRIBUTE) && !defined(PADDLE_WITH_PSLIB)
   // send the message inter rank (dst is different rank with src)
   bool SendInterRank(int64_t dst_rank,
@@ -89,6 +101,14 @@ class MessageBus final {
   std::mutex mutex_;
   std::condition_variable cv_;
   int count_{0};
+
+#if !defined(_WIN32)
+  std::mutex shm_mutex_;
+  std::unordered_map<int64_t, std::unique_ptr<ShmMessageQueue>>
+      rank_to_shm_queue_;
+  // destroyed first, since its thread dispatches the messages by this bus
+  std::unique_ptr<ShmMessageQueue> shm_queue_;
+#endif
 };
 
 }  // namespace distributed
@@ -14,10 +14,140 @@
 
 #include "paddle/fluid/distributed/fleet_executor/runtime_graph.h"
 
+#include <algorithm>
+#include <map>
+
 #include "paddle/fluid/distributed/fleet_executor/task_node.h"
+#include "paddle/fluid/platform/enforce.h"
 
 namespace paddle::distributed {
 
+std::vector<PipelineScheduleStep> Interleaved1F1BSchedule(
+    int64_t num_stages,
+    int64_t stage,
+    int64_t num_chunks,
+    int64_t num_micro_batches) {
+  PADDLE_ENFORCE_EQ(
+      stage >= 0 && stage < num_stages,
+      true,
+      phi::errors::InvalidArgument(
+          "The pipeline stage must in [0, %ld), but received %ld",
+          num_stages,
+          stage));
+  PADDLE_ENFORCE_GE(num_chunks,
+                    1,
+                    phi::errors::InvalidArgument(
+                        "The number of the pipeline chunks must >= 1, but "
+                        "received %ld",
+                        num_chunks));
+  if (num_chunks > 1) {
+    PADDLE_ENFORCE_EQ(
+        num_micro_batches % num_stages,
+        0,
+        phi::errors::InvalidArgument(
+            "The interleaved 1F1B schedule needs the number of the micro "
+            "batches to be a multiple of the pipeline stages, but they are "
+            "%ld and %ld",
+            num_micro_batches,
+            num_stages));
+  }
+
+  // The micro batches go through the chunks in groups of num_stages, the
+  // backward steps go through the chunks in the reverse order.
+  auto get_step = [&](int64_t k, bool is_forward) {
+    int64_t chunk = (k / num_stages) % num_chunks;
+    if (!is_forward) {
+      chunk = num_chunks - 1 - chunk;
+    }
+    int64_t micro_step =
+        k / (num_stages * num_chunks) * num_stages + k % num_stages;
+    return PipelineScheduleStep{chunk, is_forward, micro_step};
+  };
+
+  int64_t num_steps = num_chunks * num_micro_batches;
+  int64_t num_warmup = num_stages - stage - 1;
+  if (num_chunks > 1) {
+    num_warmup = num_warmup * 2 + (num_chunks - 1) * num_stages;
+  }
+  num_warmup = std::min(num_warmup, num_steps);
+
+  std::vector<PipelineScheduleStep> schedule;
+  schedule.reserve(num_steps * 2);
+  int64_t num_forward = 0;
+  int64_t num_backward = 0;
+  while (num_forward < num_warmup) {
+    schedule.emplace_back(get_step(num_forward++, true));
+  }
+  while (num_forward < num_steps) {
+    schedule.emplace_back(get_step(num_forward++, true));
+    schedule.emplace_back(get_step(num_backward++, false));
+  }
+  while (num_backward < num_steps) {
+    schedule.emplace_back(get_step(num_backward++, false));
+  }
+  return schedule;
+}
+
+std::vector<std::pair<int64_t, int64_t>> BuildPipelineSchedule(
+    const std::unordered_map<int64_t, TaskNode*>& interceptor_id_to_node,
+    int64_t rank,
+    int64_t num_micro_batches) {
+  // (chunk, is_forward)-->interceptor_id
+  std::map<std::pair<int64_t, bool>, int64_t> chunk_to_interceptor_id;
+  int64_t num_stages = -1;
+  int64_t stage = -1;
+  int64_t num_chunks = 0;
+  for (const auto& item : interceptor_id_to_node) {
+    TaskNode* node = item.second;
+    if (node->rank() != rank || node->pipeline_chunk() < 0) {
+      continue;
+    }
+    if (num_stages == -1) {
+      num_stages = node->num_pipeline_stages();
+      stage = node->pipeline_stage();
+    }
+    PADDLE_ENFORCE_EQ(
+        num_stages == node->num_pipeline_stages() &&
+            stage == node->pipeline_stage(),
+        true,
+        phi::errors::InvalidArgument(
+            "The task nodes of rank %ld are in different pipeline stages.",
+            rank));
+    bool is_forward =
+        !(node->role() & static_cast<int32_t>(framework::OpRole::kBackward));
+    PADDLE_ENFORCE_EQ(
+        chunk_to_interceptor_id
+            .emplace(std::make_pair(node->pipeline_chunk(), is_forward),
+                     item.first)
+            .second,
+        true,
+        phi::errors::AlreadyExists(
+            "There are more than one %s task node of the pipeline chunk %ld.",
+            is_forward ? "forward" : "backward",
+            node->pipeline_chunk()));
+    num_chunks = std::max(num_chunks, node->pipeline_chunk() + 1);
+  }
+  if (chunk_to_interceptor_id.empty()) {
+    return {};
+  }
+  PADDLE_ENFORCE_EQ(
+      static_cast<int64_t>(chunk_to_interceptor_id.size()),
+      num_chunks * 2,
+      phi::errors::InvalidArgument(
+          "Every pipeline chunk of rank %ld needs one forward and one "
+          "backward task node.",
+          rank));
+
+  std::vector<std::pair<int64_t, int64_t>> schedule;
+  for (const auto& step : Interleaved1F1BSchedule(
+           num_stages, stage, num_chunks, num_micro_batches)) {
+    schedule.emplace_back(
+        chunk_to_interceptor_id.at(std::make_pair(step.chunk, step.is_forward)),
+        step.micro_step);
+  }
+  return schedule;
+}
+
 std::string RuntimeGraph::DebugString() const {
   std::ostringstream os;
   os << "\nRuntime Graph Debug: \n";
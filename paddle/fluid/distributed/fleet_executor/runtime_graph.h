@@ -16,6 +16,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/common/macros.h"
@@ -26,6 +27,30 @@ namespace paddle {
 namespace distributed {
 class TaskNode;
 
+struct PipelineScheduleStep {
+  int64_t chunk;
+  bool is_forward;
+  int64_t micro_step;
+};
+
+// The order of the forward and backward steps of a pipeline stage in the
+// interleaved 1F1B schedule, in which every stage runs num_chunks virtual
+// stages of the model, so that the warmup and cooldown bubbles shrink by
+// num_chunks. num_chunks == 1 is the plain 1F1B schedule.
+std::vector<PipelineScheduleStep> Interleaved1F1BSchedule(
+    int64_t num_stages,
+    int64_t stage,
+    int64_t num_chunks,
+    int64_t num_micro_batches);
+
+// The (interceptor_id, scope_id) order in which the forward and backward nodes
+// of the rank, set by TaskNode::SetPipelineStage, run in a step. Empty if the
+// rank has no such node.
+std::vector<std::pair<int64_t, int64_t>> BuildPipelineSchedule(
+    const std::unordered_map<int64_t, TaskNode*>& interceptor_id_to_node,
+    int64_t rank,
+    int64_t num_micro_batches);
+
 class RuntimeGraph final {
  public:
   RuntimeGraph() = default;
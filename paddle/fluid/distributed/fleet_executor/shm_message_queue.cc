@@ -0,0 +1,245 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if !defined(_WIN32)
+#include "paddle/fluid/distributed/fleet_executor/shm_message_queue.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#include "paddle/common/errors.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle::distributed {
+
+constexpr uint64_t kShmQueueMagic = 0x50444D5351554555;  // PDMSQUEU
+// marks the end of the ring is skipped, since a record doesn't fit in it
+constexpr uint64_t kSkipRecord = std::numeric_limits<uint64_t>::max();
+
+// The records in the ring are [size][message], aligned to 8 bytes. head and
+// tail are the bytes read and written in total, guarded by the mutex.
+struct ShmRingHeader {
+  pthread_mutex_t mutex;
+  pthread_cond_t not_empty;
+  pthread_cond_t not_full;
+  uint64_t capacity;
+  uint64_t head;
+  uint64_t tail;
+  bool stop;
+  // set when the header is initialized
+  std::atomic<uint64_t> magic;
+};
+
+static uint64_t RecordSize(uint64_t msg_size) {
+  return sizeof(uint64_t) + (msg_size + 7) / 8 * 8;
+}
+
+ShmMessageQueue::ShmMessageQueue(const std::string& name,
+                                 void* addr,
+                                 size_t size,
+                                 bool is_owner)
+    : name_(name),
+      addr_(addr),
+      size_(size),
+      is_owner_(is_owner),
+      header_(static_cast<ShmRingHeader*>(addr)),
+      ring_(static_cast<char*>(addr) + sizeof(ShmRingHeader)) {}
+
+std::unique_ptr<ShmMessageQueue> ShmMessageQueue::Create(
+    const std::string& name, size_t capacity, MsgHandle handle) {
+  capacity = capacity / 8 * 8;
+  size_t size = sizeof(ShmRingHeader) + capacity;
+  // remove the queue left by a killed process
+  shm_unlink(name.c_str());
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  PADDLE_ENFORCE_NE(fd,
+                    -1,
+                    phi::errors::Unavailable(
+                        "Create the shared memory %s failed, %s.",
+                        name,
+                        strerror(errno)));
+  PADDLE_ENFORCE_EQ(ftruncate(fd, static_cast<off_t>(size)),
+                    0,
+                    phi::errors::Unavailable(
+                        "Set the size of the shared memory %s to %ld failed, "
+                        "%s.",
+                        name,
+                        size,
+                        strerror(errno)));
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(addr,
+                    MAP_FAILED,
+                    phi::errors::Unavailable("Map the shared memory %s failed.",
+                                             name));
+
+  auto* header = static_cast<ShmRingHeader*>(addr);
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutex_init(&header->mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  pthread_cond_init(&header->not_empty, &cond_attr);
+  pthread_cond_init(&header->not_full, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+  header->capacity = capacity;
+  header->head = 0;
+  header->tail = 0;
+  header->stop = false;
+  header->magic.store(kShmQueueMagic, std::memory_order_release);
+
+  std::unique_ptr<ShmMessageQueue> queue(
+      new ShmMessageQueue(name, addr, size, /*is_owner=*/true));
+  queue->handle_ = std::move(handle);
+  queue->receive_thread_ = std::thread([self = queue.get()] {
+    self->Receive();
+  });
+  VLOG(3) << "Create the shm message queue " << name << " of " << capacity
+          << " bytes.";
+  return queue;
+}
+
+std::unique_ptr<ShmMessageQueue> ShmMessageQueue::Open(
+    const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd == -1) {
+    return nullptr;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) <= sizeof(ShmRingHeader)) {
+    close(fd);
+    return nullptr;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return nullptr;
+  }
+  auto* header = static_cast<ShmRingHeader*>(addr);
+  if (header->magic.load(std::memory_order_acquire) != kShmQueueMagic) {
+    munmap(addr, size);
+    return nullptr;
+  }
+  return std::unique_ptr<ShmMessageQueue>(
+      new ShmMessageQueue(name, addr, size, /*is_owner=*/false));
+}
+
+ShmMessageQueue::~ShmMessageQueue() {
+  if (is_owner_) {
+    pthread_mutex_lock(&header_->mutex);
+    header_->stop = true;
+    pthread_cond_broadcast(&header_->not_empty);
+    pthread_mutex_unlock(&header_->mutex);
+    if (receive_thread_.joinable()) {
+      receive_thread_.join();
+    }
+    shm_unlink(name_.c_str());
+  }
+  munmap(addr_, size_);
+}
+
+void ShmMessageQueue::Push(const InterceptorMessage& interceptor_message) {
+  uint64_t msg_size = interceptor_message.ByteSizeLong();
+  uint64_t record_size = RecordSize(msg_size);
+  uint64_t capacity = header_->capacity;
+  PADDLE_ENFORCE_LE(
+      record_size,
+      capacity,
+      phi::errors::OutOfRange(
+          "The message of %ld bytes is larger than the shm message queue %s "
+          "of %ld bytes, please disable FLAGS_fleet_executor_use_shm.",
+          msg_size,
+          name_,
+          capacity));
+
+  pthread_mutex_lock(&header_->mutex);
+  uint64_t offset = header_->tail % capacity;
+  uint64_t skip = offset + record_size > capacity ? capacity - offset : 0;
+  while (capacity - (header_->tail - header_->head) < skip + record_size) {
+    pthread_cond_wait(&header_->not_full, &header_->mutex);
+    offset = header_->tail % capacity;
+    skip = offset + record_size > capacity ? capacity - offset : 0;
+  }
+  if (skip > 0) {
+    *reinterpret_cast<uint64_t*>(ring_ + offset) = kSkipRecord;
+    header_->tail += skip;
+    offset = 0;
+  }
+  *reinterpret_cast<uint64_t*>(ring_ + offset) = msg_size;
+  interceptor_message.SerializeWithCachedSizesToArray(
+      reinterpret_cast<uint8_t*>(ring_ + offset + sizeof(uint64_t)));
+  header_->tail += record_size;
+  pthread_cond_signal(&header_->not_empty);
+  pthread_mutex_unlock(&header_->mutex);
+}
+
+void ShmMessageQueue::Receive() {
+  uint64_t capacity = header_->capacity;
+  while (true) {
+    pthread_mutex_lock(&header_->mutex);
+    while (header_->head == header_->tail && !header_->stop) {
+      pthread_cond_wait(&header_->not_empty, &header_->mutex);
+    }
+    if (header_->head == header_->tail) {
+      pthread_mutex_unlock(&header_->mutex);
+      break;
+    }
+    uint64_t offset = header_->head % capacity;
+    pthread_mutex_unlock(&header_->mutex);
+
+    // the senders only write the free space, so the record is read out of
+    // the lock
+    uint64_t msg_size = *reinterpret_cast<uint64_t*>(ring_ + offset);
+    uint64_t record_size = capacity - offset;
+    InterceptorMessage interceptor_message;
+    bool has_message = msg_size != kSkipRecord;
+    if (has_message) {
+      record_size = RecordSize(msg_size);
+      PADDLE_ENFORCE_EQ(
+          interceptor_message.ParseFromArray(ring_ + offset + sizeof(uint64_t),
+                                             static_cast<int>(msg_size)),
+          true,
+          phi::errors::InvalidArgument(
+              "Parse the message from the shm message queue %s failed.",
+              name_));
+    }
+
+    pthread_mutex_lock(&header_->mutex);
+    header_->head += record_size;
+    pthread_cond_broadcast(&header_->not_full);
+    pthread_mutex_unlock(&header_->mutex);
+
+    if (has_message) {
+      VLOG(3) << "Shm message queue receives a message from interceptor "
+              << interceptor_message.src_id() << " to interceptor "
+              << interceptor_message.dst_id();
+      handle_(interceptor_message);
+    }
+  }
+}
+
+}  // namespace paddle::distributed
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#if !defined(_WIN32)
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/distributed/fleet_executor/interceptor_message.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+struct ShmRingHeader;
+
+// A ring buffer of InterceptorMessages in the shared memory, which the message
+// bus uses between the ranks on the same host instead of brpc. The receiver
+// creates the queue and handles its messages on a thread, the senders of the
+// other processes open it by name and serialize their messages into the ring
+// directly, so the vars of the messages are copied once.
+class ShmMessageQueue final {
+ public:
+  using MsgHandle = std::function<void(const InterceptorMessage&)>;
+
+  ~ShmMessageQueue();
+
+  // Create the queue of the receiver with a ring of capacity bytes.
+  static std::unique_ptr<ShmMessageQueue> Create(const std::string& name,
+                                                 size_t capacity,
+                                                 MsgHandle handle);
+  // Open the queue of a receiver, nullptr if it isn't created yet.
+  static std::unique_ptr<ShmMessageQueue> Open(const std::string& name);
+
+  // Blocks while the ring is full.
+  void Push(const InterceptorMessage& interceptor_message);
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ShmMessageQueue);
+  ShmMessageQueue(const std::string& name,
+                  void* addr,
+                  size_t size,
+                  bool is_owner);
+
+  // the loop of the receiver thread
+  void Receive();
+
+  std::string name_;
+  void* addr_;
+  size_t size_;
+  bool is_owner_;
+  ShmRingHeader* header_;
+  char* ring_;
+
+  MsgHandle handle_{nullptr};
+  std::thread receive_thread_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
+#endif
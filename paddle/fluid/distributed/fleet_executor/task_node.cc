@@ -186,5 +186,29 @@ void TaskNode::SetSendDownPerSteps(int64_t value) {
   send_down_per_steps_ = value;
 }
 
+void TaskNode::SetPipelineStage(int64_t num_stages,
+                                int64_t stage,
+                                int64_t chunk) {
+  PADDLE_ENFORCE_GE(
+      num_stages,
+      1,
+      phi::errors::InvalidArgument(
+          "num_pipeline_stages must >= 1, but received %ld", num_stages));
+  PADDLE_ENFORCE_EQ(
+      stage >= 0 && stage < num_stages,
+      true,
+      phi::errors::InvalidArgument(
+          "pipeline_stage must in [0, %ld), but received %ld",
+          num_stages,
+          stage));
+  PADDLE_ENFORCE_GE(chunk,
+                    0,
+                    phi::errors::InvalidArgument(
+                        "pipeline_chunk must >= 0, but received %ld", chunk));
+  num_pipeline_stages_ = num_stages;
+  pipeline_stage_ = stage;
+  pipeline_chunk_ = chunk;
+}
+
 }  // namespace distributed
 }  // namespace paddle
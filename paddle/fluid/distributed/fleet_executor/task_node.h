@@ -67,6 +67,9 @@ class TaskNode final {
   int64_t run_at_offset() const { return run_at_offset_; }
   int64_t reply_up_per_steps() const { return reply_up_per_steps_; }
   int64_t send_down_per_steps() const { return send_down_per_steps_; }
+  int64_t num_pipeline_stages() const { return num_pipeline_stages_; }
+  int64_t pipeline_stage() const { return pipeline_stage_; }
+  int64_t pipeline_chunk() const { return pipeline_chunk_; }
   const std::string& cond_var() const { return cond_var_; }
   const std::unordered_map<int64_t, int64_t>& upstream() const {
     return upstream_;
@@ -98,6 +101,7 @@ class TaskNode final {
   void SetRunAtOffset(int64_t value);
   void SetReplyUpPerSteps(int64_t value);
   void SetSendDownPerSteps(int64_t value);
+  void SetPipelineStage(int64_t num_stages, int64_t stage, int64_t chunk);
   void SetType(const std::string& type) { type_ = type; }
   void SetUnusedVars(
       const std::unordered_map<const OperatorBase*, std::vector<std::string>>&
@@ -156,6 +160,12 @@ class TaskNode final {
   // one output need multi times input
   int64_t send_down_per_steps_{1};
 
+  // the pipeline stage and the virtual chunk of the stage the node runs,
+  // -1 if the node isn't in the pipeline schedule
+  int64_t num_pipeline_stages_{-1};
+  int64_t pipeline_stage_{-1};
+  int64_t pipeline_chunk_{-1};
+
   std::string type_;
   std::map<std::string, std::string> vars_to_dtype_;
   std::map<std::string, std::vector<int64_t>> vars_to_shape_;
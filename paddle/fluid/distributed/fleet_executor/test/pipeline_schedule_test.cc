@@ -0,0 +1,74 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/fleet_executor/runtime_graph.h"
+#include "paddle/fluid/distributed/fleet_executor/task_node.h"
+
+namespace paddle {
+namespace distributed {
+
+std::string ScheduleToString(const std::vector<PipelineScheduleStep>& steps) {
+  std::string str;
+  for (const auto& step : steps) {
+    str += (step.is_forward ? "F" : "B") + std::to_string(step.chunk) + "." +
+           std::to_string(step.micro_step) + " ";
+  }
+  return str;
+}
+
+TEST(PipelineSchedule, Plain1F1B) {
+  EXPECT_EQ(ScheduleToString(Interleaved1F1BSchedule(4, 0, 1, 4)),
+            "F0.0 F0.1 F0.2 F0.3 B0.0 B0.1 B0.2 B0.3 ");
+  EXPECT_EQ(ScheduleToString(Interleaved1F1BSchedule(4, 2, 1, 4)),
+            "F0.0 F0.1 B0.0 F0.2 B0.1 F0.3 B0.2 B0.3 ");
+  EXPECT_EQ(ScheduleToString(Interleaved1F1BSchedule(4, 3, 1, 4)),
+            "F0.0 B0.0 F0.1 B0.1 F0.2 B0.2 F0.3 B0.3 ");
+}
+
+TEST(PipelineSchedule, Interleaved1F1B) {
+  EXPECT_EQ(ScheduleToString(Interleaved1F1BSchedule(2, 0, 2, 2)),
+            "F0.0 F0.1 F1.0 F1.1 B1.0 B1.1 B0.0 B0.1 ");
+  EXPECT_EQ(ScheduleToString(Interleaved1F1BSchedule(2, 1, 2, 4)),
+            "F0.0 F0.1 F1.0 B1.0 F1.1 B1.1 F0.2 B0.0 "
+            "F0.3 B0.1 F1.2 B1.2 F1.3 B1.3 B0.2 B0.3 ");
+}
+
+TEST(PipelineSchedule, BuildPipelineSchedule) {
+  int32_t forward = static_cast<int32_t>(framework::OpRole::kForward);
+  int32_t backward = static_cast<int32_t>(framework::OpRole::kBackward);
+  // role, rank, task_id, max_run_times
+  TaskNode fwd0(forward, 0, 0, 2);
+  TaskNode fwd1(forward, 0, 1, 2);
+  TaskNode bwd1(backward, 0, 2, 2);
+  TaskNode bwd0(backward, 0, 3, 2);
+  TaskNode opt(static_cast<int32_t>(framework::OpRole::kOptimize), 0, 4, 2);
+  fwd0.SetPipelineStage(2, 1, 0);
+  fwd1.SetPipelineStage(2, 1, 1);
+  bwd1.SetPipelineStage(2, 1, 1);
+  bwd0.SetPipelineStage(2, 1, 0);
+  std::unordered_map<int64_t, TaskNode*> nodes = {
+      {0, &fwd0}, {1, &fwd1}, {2, &bwd1}, {3, &bwd0}, {4, &opt}};
+
+  std::vector<std::pair<int64_t, int64_t>> expected = {
+      {0, 0}, {0, 1}, {1, 0}, {2, 0}, {1, 1}, {2, 1}, {3, 0}, {3, 1}};
+  EXPECT_EQ(BuildPipelineSchedule(nodes, 0, 2), expected);
+  EXPECT_TRUE(BuildPipelineSchedule(nodes, 1, 2).empty());
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -11,6 +11,7 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/index_dataset/index_wrapper.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <thread>
@@ -91,6 +92,14 @@ int TreeIndex::Load(const std::string filename) {
   }
   total_nodes_num_ = data_.size();
   max_code_ += 1;
+
+  code_ids_.assign(max_code_, 0);
+  code_flags_.assign(max_code_, 0);
+  for (auto& item : data_) {
+    code_ids_[item.first] = item.second.id();
+    code_flags_[item.first] =
+        kValidCode | (item.second.is_leaf() ? kLeafCode : 0);
+  }
   return 0;
 }
 
@@ -188,6 +197,110 @@ std::vector<uint64_t> TreeIndex::GetTravelCodes(uint64_t id, int start_level) {
   return res;
 }
 
+TreeIndex::BeamSearchResult TreeIndex::BeamSearch(
+    int query_num, int beam_size, int topk, const BeamScoreFunc& score_func) {
+  PADDLE_ENFORCE_GT(
+      beam_size,
+      0,
+      phi::errors::InvalidArgument(
+          "beam_size should be positive, but received %d.", beam_size));
+  PADDLE_ENFORCE_EQ(
+      topk > 0 && topk <= beam_size,
+      true,
+      phi::errors::InvalidArgument(
+          "topk should be in [1, beam_size], but received topk %d and "
+          "beam_size %d.",
+          topk,
+          beam_size));
+
+  struct Candidate {
+    uint64_t code;
+    float score;
+  };
+  auto greater = [](const Candidate& lhs, const Candidate& rhs) {
+    return lhs.score > rhs.score;
+  };
+
+  uint64_t branch = meta_.branch();
+  std::vector<std::vector<Candidate>> beams(query_num);
+  if (CheckIsValid(0)) {
+    for (auto& beam : beams) {
+      beam.push_back({0, 0.0f});
+    }
+  }
+  std::vector<std::vector<Candidate>> next_beams(query_num);
+  std::vector<int> queries;
+  std::vector<uint64_t> codes;
+  std::vector<uint64_t> node_ids;
+  std::vector<float> scores;
+  for (int level = 1; level < meta_.height(); ++level) {
+    queries.clear();
+    codes.clear();
+    node_ids.clear();
+    for (int query = 0; query < query_num; ++query) {
+      next_beams[query].clear();
+      for (auto& candidate : beams[query]) {
+        if (code_flags_[candidate.code] & kLeafCode) {
+          next_beams[query].push_back(candidate);
+          continue;
+        }
+        for (uint64_t i = 1; i <= branch; ++i) {
+          uint64_t child = candidate.code * branch + i;
+          if (child < max_code_ && (code_flags_[child] & kValidCode)) {
+            queries.push_back(query);
+            codes.push_back(child);
+            node_ids.push_back(code_ids_[child]);
+          }
+        }
+      }
+    }
+    if (codes.empty()) {
+      break;
+    }
+
+    scores.assign(codes.size(), 0.0f);
+    score_func(level, queries, node_ids, &scores);
+    PADDLE_ENFORCE_EQ(
+        scores.size(),
+        codes.size(),
+        phi::errors::InvalidArgument(
+            "The score function should give %d scores for level %d, but it "
+            "gives %d.",
+            codes.size(),
+            level,
+            scores.size()));
+    for (size_t i = 0; i < codes.size(); ++i) {
+      next_beams[queries[i]].push_back({codes[i], scores[i]});
+    }
+    for (auto& beam : next_beams) {
+      if (beam.size() > static_cast<size_t>(beam_size)) {
+        std::nth_element(
+            beam.begin(), beam.begin() + beam_size - 1, beam.end(), greater);
+        beam.resize(beam_size);
+      }
+    }
+    beams.swap(next_beams);
+  }
+
+  BeamSearchResult result;
+  result.first.resize(query_num);
+  result.second.resize(query_num);
+  for (int query = 0; query < query_num; ++query) {
+    auto& beam = beams[query];
+    std::sort(beam.begin(), beam.end(), greater);
+    for (auto& candidate : beam) {
+      if (result.first[query].size() == static_cast<size_t>(topk)) {
+        break;
+      }
+      if (code_flags_[candidate.code] & kLeafCode) {
+        result.first[query].push_back(code_ids_[candidate.code]);
+        result.second[query].push_back(candidate.score);
+      }
+    }
+  }
+  return result;
+}
+
 std::vector<IndexNode> TreeIndex::GetAllLeafs() {
   std::vector<IndexNode> res;
   res.reserve(id_codes_map_.size());
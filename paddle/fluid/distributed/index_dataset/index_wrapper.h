@@ -11,6 +11,7 @@ limitations under the License. */
 
 #pragma once
 #include <cmath>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -35,6 +36,19 @@ class TreeIndex : public Index {
   TreeIndex() {}
   ~TreeIndex() {}
 
+  // Scores the candidate nodes of a level for all the queries in one call,
+  // node_ids[i] is a child of a node in the beam of the query queries[i], and
+  // its score is written into (*scores)[i]. Scoring a level at once lets the
+  // model run one batch for it, e.g. on GPU.
+  using BeamScoreFunc =
+      std::function<void(int level,
+                         const std::vector<int>& queries,
+                         const std::vector<uint64_t>& node_ids,
+                         std::vector<float>* scores)>;
+  // The ids and scores of the best leaves of each query.
+  using BeamSearchResult = std::pair<std::vector<std::vector<uint64_t>>,
+                                     std::vector<std::vector<float>>>;
+
   int Height() { return meta_.height(); }
   int Branch() { return meta_.branch(); }
   uint64_t TotalNodeNums() { return total_nodes_num_; }
@@ -57,6 +71,15 @@ class TreeIndex : public Index {
   std::vector<uint64_t> GetTravelCodes(uint64_t id, int start_level);
   std::vector<IndexNode> GetAllLeafs();
 
+  // Searches the tree layer by layer from the root for query_num queries,
+  // keeps the beam_size best nodes of each query in each layer, and returns
+  // the topk best leaves of each query. The leaves above the last layer stay
+  // in the beam with their scores.
+  BeamSearchResult BeamSearch(int query_num,
+                              int beam_size,
+                              int topk,
+                              const BeamScoreFunc& score_func);
+
   std::unordered_map<uint64_t, IndexNode> data_;
   std::unordered_map<uint64_t, uint64_t> id_codes_map_;
   uint64_t total_nodes_num_;
@@ -64,6 +87,15 @@ class TreeIndex : public Index {
   uint64_t max_id_;
   uint64_t max_code_;
   IndexNode fake_node_;
+
+ private:
+  static constexpr uint8_t kValidCode = 1;
+  static constexpr uint8_t kLeafCode = 2;
+
+  // the ids and the flags of the nodes indexed by their codes, so that the
+  // beam search walks the tree without hashing
+  std::vector<uint64_t> code_ids_;
+  std::vector<uint8_t> code_flags_;
 };
 
 using TreePtr = std::shared_ptr<TreeIndex>;
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "paddle/fluid/distributed/ps/service/coordinator_client.h"
+#include "paddle/fluid/distributed/ps/service/dense_gradient_codec.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/utils/string/split.h"
 
@@ -78,6 +79,26 @@ PD_DEFINE_int32(pserver_sparse_merge_thread,
                 1,
                 "pserver sparse merge thread num");
 
+PD_DEFINE_int32(pserver_dense_gradient_compress_type,
+                0,
+                "the encoding of the pushed dense gradients, fp32:0 fp16:1 "
+                "bf16:2 topk:3, see DenseGradientCompressType");
+
+PD_DEFINE_double(pserver_dense_gradient_topk_ratio,
+                 0.01,
+                 "the ratio of the values of a dense gradient pushed by the "
+                 "topk encoding, the others are accumulated for the next push");
+
+PD_DEFINE_int32(pserver_client_sparse_cache_capacity,
+                0,
+                "the max number of the hot keys of a sparse table cached by "
+                "PullSparse of a client, 0 to disable the cache");
+
+PD_DEFINE_int32(pserver_client_sparse_cache_max_staleness,
+                10,
+                "the number of the pulls of a sparse table a cached value is "
+                "served for before being pulled again");
+
 PD_DEFINE_int32(pserver_sparse_table_shard_num,
                 1000,
                 "sparse table shard for save & load");
@@ -91,6 +112,69 @@ inline size_t get_sparse_shard(uint32_t shard_num,
   return (key % shard_num) / local_shard_num;
 }
 
+// Serializes the pull sparse request of a shard, whose keys are sorted, as
+// |is_training|unique keys|counts of the keys| into one buffer, which the
+// attachment takes without copying. Returns the number of the unique keys.
+static uint32_t SerializePullSparseRequest(
+    const std::vector<std::pair<uint64_t, float *>> &sorted_kvs,
+    bool is_training,
+    butil::IOBuf *request_buffer) {
+  size_t kv_size = sorted_kvs.size();
+  uint32_t kv_request_count = 0;
+  for (size_t kv_idx = 0; kv_idx < kv_size; ++kv_idx) {
+    if (kv_idx == 0 ||
+        sorted_kvs[kv_idx].first != sorted_kvs[kv_idx - 1].first) {
+      ++kv_request_count;
+    }
+  }
+  if (kv_request_count == 0) {
+    return 0;
+  }
+
+  size_t size = sizeof(bool) + (sizeof(uint64_t) + sizeof(uint32_t)) *
+                                   static_cast<size_t>(kv_request_count);
+  char *data = static_cast<char *>(malloc(size));
+  memcpy(data, &is_training, sizeof(bool));
+  char *key_ptr = data + sizeof(bool);
+  char *counter_ptr = key_ptr + sizeof(uint64_t) * kv_request_count;
+  for (size_t kv_idx = 0; kv_idx < kv_size;) {
+    uint64_t key = sorted_kvs[kv_idx].first;
+    uint32_t keys = 0;
+    while (kv_idx < kv_size && sorted_kvs[kv_idx].first == key) {
+      ++kv_idx;
+      ++keys;
+    }
+    memcpy(key_ptr, &key, sizeof(uint64_t));
+    key_ptr += sizeof(uint64_t);
+    memcpy(counter_ptr, &keys, sizeof(uint32_t));
+    counter_ptr += sizeof(uint32_t);
+  }
+  request_buffer->append_user_data(data, size, free);
+  return kv_request_count;
+}
+
+// Returns the buffer to serialize the push sparse data of a request into.
+// The data is sent by the attachment without compression, which takes the
+// buffer without copying, so it is neither copied by the serialization of the
+// request on the client nor by the parsing on the server. Otherwise it is
+// PsRequestMessage.data, which is compressed with the request.
+static char *GetPushSparseBuffer(PsRequestMessage *request, size_t size) {
+  if (FLAGS_pserver_communicate_compress_type == 0) {
+    return size == 0 ? nullptr : static_cast<char *>(malloc(size));
+  }
+  auto *push_data = request->mutable_data();
+  push_data->resize(size);
+  return const_cast<char *>(push_data->data());
+}
+
+static void AttachPushSparseBuffer(brpc::Controller *cntl,
+                                   char *data,
+                                   size_t size) {
+  if (FLAGS_pserver_communicate_compress_type == 0 && size != 0) {
+    cntl->request_attachment().append_user_data(data, size, free);
+  }
+}
+
 void DownpourPsClientService::service(
     ::google::protobuf::RpcController *controller,
     const PsRequestMessage *request,
@@ -345,6 +429,15 @@ int32_t BrpcPsClient::Initialize() {
       _push_sparse_task_queue_map[table_id] =
           ::paddle::framework::MakeChannel<SparseAsyncTask *>();
       _push_sparse_merge_count_map[table_id] = 0;
+      if (FLAGS_pserver_client_sparse_cache_capacity > 0 &&
+          FLAGS_pserver_client_sparse_cache_max_staleness > 0) {
+        size_t value_dim =
+            GetTableAccessor(table_id)->GetAccessorInfo().select_dim;
+        _sparse_pull_caches[table_id].reset(new SparsePullCache(
+            FLAGS_pserver_client_sparse_cache_capacity,
+            FLAGS_pserver_client_sparse_cache_max_staleness,
+            value_dim));
+      }
     }
   }
 
@@ -442,7 +535,29 @@ int FlClientBrpcClosure::check_response(size_t request_idx, int cmd_id) {
   return 0;
 }
 
+SparsePullCache *BrpcPsClient::GetSparsePullCache(uint32_t table_id) {
+  auto itr = _sparse_pull_caches.find(table_id);
+  return itr == _sparse_pull_caches.end() ? nullptr : itr->second.get();
+}
+
+void BrpcPsClient::ClearSparsePullCache(uint32_t table_id) {
+  for (auto &itr : _sparse_pull_caches) {
+    if (table_id == static_cast<uint32_t>(-1) || itr.first == table_id) {
+      itr.second->Clear();
+    }
+  }
+}
+
 std::future<int32_t> BrpcPsClient::PrintTableStat(uint32_t table_id) {
+  auto *cache = GetSparsePullCache(table_id);
+  if (cache != nullptr) {
+    std::cout << "table id: " << table_id
+              << ", client cache size: " << cache->Size()
+              << ", hits: " << cache->hits()
+              << ", misses: " << cache->misses()
+              << ", hit ratio: " << cache->HitRatio()
+              << ", rejected: " << cache->rejected() << std::endl;
+  }
   size_t request_call_num = _server_channels.size();
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
       request_call_num, [request_call_num, table_id](void *done) {
@@ -559,16 +674,19 @@ std::future<int32_t> BrpcPsClient::SendSaveCmd(
 
 std::future<int32_t> BrpcPsClient::Shrink(uint32_t table_id,
                                           const std::string threshold) {
+  ClearSparsePullCache(table_id);
   return SendCmd(table_id, PS_SHRINK_TABLE, {threshold});
 }
 
 std::future<int32_t> BrpcPsClient::Load(const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparsePullCache(-1);
   return SendCmd(-1, PS_LOAD_ALL_TABLE, {epoch, mode});
 }
 std::future<int32_t> BrpcPsClient::Load(uint32_t table_id,
                                         const std::string &epoch,
                                         const std::string &mode) {
+  ClearSparsePullCache(table_id);
   return SendCmd(table_id, PS_LOAD_ONE_TABLE, {epoch, mode});
 }
 
@@ -666,13 +784,16 @@ std::future<int32_t> BrpcPsClient::GetCacheThreshold(uint32_t table_id,
 }
 
 std::future<int32_t> BrpcPsClient::Clear() {
+  ClearSparsePullCache(-1);
   return SendCmd(-1, PS_CLEAR_ALL_TABLE, {});
 }
 std::future<int32_t> BrpcPsClient::Clear(uint32_t table_id) {
+  ClearSparsePullCache(table_id);
   return SendCmd(table_id, PS_CLEAR_ONE_TABLE, {});
 }
 
 std::future<int32_t> BrpcPsClient::Revert() {
+  ClearSparsePullCache(-1);
   return SendCmd(-1, PS_REVERT, {});
 }
 
@@ -680,6 +801,191 @@ std::future<int32_t> BrpcPsClient::CheckSavePrePatchDone() {
   return SendCmd(-1, PS_CHECK_SAVE_PRE_PATCH_DONE, {});
 }
 
+std::shared_ptr<const SparseShardRoute> BrpcPsClient::GetSparseShardRoute(
+    uint32_t table_id) {
+  std::lock_guard<std::mutex> lock(_sparse_shard_route_mutex);
+  auto itr = _sparse_shard_routes.find(table_id);
+  return itr == _sparse_shard_routes.end() ? nullptr : itr->second;
+}
+
+int32_t BrpcPsClient::SendServerCmd(size_t server_id,
+                                    uint32_t table_id,
+                                    int cmd_id,
+                                    const std::vector<std::string> &params,
+                                    const std::string &data,
+                                    std::string *resp) {
+  DownpourBrpcClosure *closure =
+      new DownpourBrpcClosure(1, [cmd_id, resp](void *done) {
+        auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+        int ret = 0;
+        if (closure->check_response(0, cmd_id) != 0) {
+          ret = -1;
+        } else if (resp != nullptr) {
+          *resp = closure->get_response(0, cmd_id);
+        }
+        closure->set_promise_value(ret);
+      });
+  auto promise = std::make_shared<std::promise<int32_t>>();
+  closure->add_promise(promise);
+  std::future<int> fut = promise->get_future();
+  closure->request(0)->set_cmd_id(cmd_id);
+  closure->request(0)->set_table_id(table_id);
+  closure->request(0)->set_client_id(_client_id);
+  for (const auto &param : params) {
+    closure->request(0)->add_params(param);
+  }
+  if (!data.empty()) {
+    closure->request(0)->set_data(data);
+  }
+  PsService_Stub rpc_stub(GetCmdChannel(server_id));
+  closure->cntl(0)->set_timeout_ms(
+      10800000);  // cmd msg don't limit timeout for save/load
+  rpc_stub.service(
+      closure->cntl(0), closure->request(0), closure->response(0), closure);
+  return fut.get();
+}
+
+std::future<int32_t> BrpcPsClient::RebalanceSparseTable(uint32_t table_id,
+                                                        double max_imbalance,
+                                                        size_t max_swaps) {
+  auto promise = std::make_shared<std::promise<int32_t>>();
+  std::future<int> fut = promise->get_future();
+  size_t server_num = _server_channels.size();
+
+  // the loads of the shards since the last rebalance, and the route of now
+  std::vector<std::vector<SparseShardLoad>> server_loads(server_num);
+  for (size_t i = 0; i < server_num; ++i) {
+    std::string resp;
+    if (SendServerCmd(i, table_id, PS_QUERY_SHARD_LOAD, {}, "", &resp) != 0) {
+      LOG(ERROR) << "RebalanceSparseTable query shard load of server " << i
+                 << " failed";
+      promise->set_value(-1);
+      return fut;
+    }
+    ::paddle::framework::BinaryArchive ar;
+    ar.SetReadBuffer(const_cast<char *>(resp.c_str()), resp.length(), nullptr);
+    server_loads[i].resize(ar.Get<uint64_t>());
+    for (auto &load : server_loads[i]) {
+      load.shard_id = ar.Get<uint32_t>();
+      load.access_num = ar.Get<uint64_t>();
+      load.key_num = ar.Get<uint64_t>();
+    }
+  }
+  std::string route_data;
+  SparseShardRoute route;
+  if (SendServerCmd(
+          0, table_id, PS_PULL_SHARD_ROUTE, {}, "", &route_data) != 0 ||
+      !route.Deserialize(route_data)) {
+    LOG(ERROR) << "RebalanceSparseTable pull shard route failed";
+    promise->set_value(-1);
+    return fut;
+  }
+
+  // copies both of the shards of a swap to the other servers, then switches
+  // them, so that a failed copy leaves the table as it was
+  int ret = 0;
+  auto swaps = PlanSparseShardSwaps(server_loads, max_imbalance, max_swaps);
+  for (auto &swap : swaps) {
+    std::string data_a, data_b;
+    std::string shard_a = std::to_string(swap.shard_a);
+    std::string shard_b = std::to_string(swap.shard_b);
+    if (SendServerCmd(swap.server_a,
+                      table_id,
+                      PS_EXPORT_SHARD,
+                      {shard_a},
+                      "",
+                      &data_a) != 0 ||
+        SendServerCmd(swap.server_b,
+                      table_id,
+                      PS_EXPORT_SHARD,
+                      {shard_b},
+                      "",
+                      &data_b) != 0) {
+      ret = -1;
+      break;
+    }
+    if (SendServerCmd(swap.server_b,
+                      table_id,
+                      PS_IMPORT_SHARD,
+                      {shard_a},
+                      data_a,
+                      nullptr) != 0 ||
+        SendServerCmd(swap.server_a,
+                      table_id,
+                      PS_IMPORT_SHARD,
+                      {shard_b},
+                      data_b,
+                      nullptr) != 0) {
+      // the empty imports drop the copies
+      SendServerCmd(
+          swap.server_b, table_id, PS_IMPORT_SHARD, {shard_a}, "", nullptr);
+      SendServerCmd(
+          swap.server_a, table_id, PS_IMPORT_SHARD, {shard_b}, "", nullptr);
+      ret = -1;
+      break;
+    }
+    if (SendServerCmd(swap.server_a,
+                      table_id,
+                      PS_SWITCH_SHARD,
+                      {shard_a, shard_b},
+                      "",
+                      nullptr) != 0 ||
+        SendServerCmd(swap.server_b,
+                      table_id,
+                      PS_SWITCH_SHARD,
+                      {shard_b, shard_a},
+                      "",
+                      nullptr) != 0) {
+      LOG(ERROR) << "RebalanceSparseTable switch shard " << swap.shard_a
+                 << " of server " << swap.server_a << " and shard "
+                 << swap.shard_b << " of server " << swap.server_b
+                 << " failed, the table is inconsistent";
+      ret = -1;
+      break;
+    }
+    route.Swap(swap);
+    VLOG(0) << "RebalanceSparseTable table " << table_id << " swap shard "
+            << swap.shard_a << " of server " << swap.server_a << " and shard "
+            << swap.shard_b << " of server " << swap.server_b;
+  }
+
+  // the route of the swaps done, even if a later one failed
+  route_data = route.Serialize();
+  for (size_t i = 0; i < server_num; ++i) {
+    if (SendServerCmd(
+            i, table_id, PS_PUSH_SHARD_ROUTE, {}, route_data, nullptr) != 0) {
+      ret = -1;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(_sparse_shard_route_mutex);
+    _sparse_shard_routes[table_id] =
+        std::make_shared<const SparseShardRoute>(route);
+  }
+  VLOG(0) << "RebalanceSparseTable table " << table_id << " done "
+          << swaps.size() << " swaps, route version " << route.Version();
+  promise->set_value(ret);
+  return fut;
+}
+
+std::future<int32_t> BrpcPsClient::PullSparseShardRoute(uint32_t table_id) {
+  auto promise = std::make_shared<std::promise<int32_t>>();
+  std::future<int> fut = promise->get_future();
+  std::string route_data;
+  auto route = std::make_shared<SparseShardRoute>();
+  if (SendServerCmd(
+          0, table_id, PS_PULL_SHARD_ROUTE, {}, "", &route_data) != 0 ||
+      !route->Deserialize(route_data)) {
+    LOG(ERROR) << "PullSparseShardRoute table " << table_id << " failed";
+    promise->set_value(-1);
+    return fut;
+  }
+  std::lock_guard<std::mutex> lock(_sparse_shard_route_mutex);
+  _sparse_shard_routes[table_id] = route;
+  promise->set_value(0);
+  return fut;
+}
+
 std::future<int32_t> BrpcPsClient::Flush() {
   VLOG(0) << "BrpcPsClient::flush begin";
   _flushing = true;
@@ -1033,8 +1339,12 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     }
   }
 
+  auto route = GetSparseShardRoute(table_id);
   for (size_t i = 0; i < num; ++i) {
-    size_t pserver_idx = get_sparse_shard(shard_num, request_call_num, keys[i]);
+    size_t pserver_idx =
+        route != nullptr
+            ? route->Server(keys[i])
+            : get_sparse_shard(shard_num, request_call_num, keys[i]);
     ids[pserver_idx].push_back(keys[i]);
     value_ptrs[pserver_idx].push_back(update_values[i]);
   }
@@ -1052,9 +1362,9 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
     push_request->set_table_id(table_id);
     push_request->set_client_id(_client_id);
     push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
-    auto *push_data = push_request->mutable_data();
-    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
+    size_t push_size = kv_size * (sizeof(uint64_t) + value_size);
+    char *push_buffer = GetPushSparseBuffer(push_request, push_size);
+    char *push_data_ptr = push_buffer;
     memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
     push_data_ptr += kv_size * sizeof(uint64_t);
 
@@ -1062,6 +1372,7 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
       memcpy(push_data_ptr, value_ptr[i], value_size);
       push_data_ptr += value_size;
     }
+    AttachPushSparseBuffer(closure->cntl(shard_idx), push_buffer, push_size);
     PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
     closure->cntl(shard_idx)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -1090,14 +1401,8 @@ std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(table_id);
     closure->request(i)->set_client_id(_client_id);
-    auto *push_data = closure->request(i)->mutable_data();
-    push_data->clear();
-    push_data->resize(sizeof(uint32_t) + num_per_shard * sizeof(float));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, &num_per_shard, sizeof(uint32_t));
-    memcpy(push_data_ptr + sizeof(uint32_t),
-           total_send_data + i * num_per_shard,
-           num_per_shard * sizeof(float));
+    SerializePushDenseRequest(
+        table_id, total_send_data, num_per_shard, i, closure->request(i));
     // closure->cntl(i)->set_request_compress_type(
     //     (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     PsService_Stub rpc_stub(GetDenseChannel(i));
@@ -1160,8 +1465,18 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
     }
   }
 
+  // the hot keys cached are served locally, and only the others are pulled
+  auto *cache = GetSparsePullCache(table_id);
+  uint64_t step = cache != nullptr ? cache->NextStep() : 0;
+  auto route = GetSparseShardRoute(table_id);
   for (size_t i = 0; i < num; ++i) {
-    size_t shard_id = get_sparse_shard(shard_num, request_call_num, keys[i]);
+    if (cache != nullptr && cache->Lookup(keys[i], step, select_values[i])) {
+      continue;
+    }
+    size_t shard_id =
+        route != nullptr
+            ? route->Server(keys[i])
+            : get_sparse_shard(shard_num, request_call_num, keys[i]);
     shard_sorted_kvs->at(shard_id).push_back({keys[i], select_values[i]});
   }
 
@@ -1170,7 +1485,8 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
   size_t value_size = accessor->GetAccessorInfo().select_size;
 
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num,
+      [shard_sorted_kvs, value_size, cache, step](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
@@ -1200,6 +1516,9 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
                 ret = -1;
                 break;
               }
+              if (cache != nullptr) {
+                cache->Insert(last_key, step, last_value_data);
+              }
             }
           }
         }
@@ -1219,31 +1538,8 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
                 return k1.first < k2.first;
               });
 
-    uint64_t last_key = UINT64_MAX;
-    uint32_t kv_request_count = 0;
-    size_t sorted_kv_size = sorted_kvs.size();
-    auto &request_buffer = closure->cntl(i)->request_attachment();
-
-    request_buffer.append(reinterpret_cast<void *>(&is_training), sizeof(bool));
-    std::vector<uint32_t> keys_counter;
-    keys_counter.reserve(sorted_kv_size);
-
-    for (size_t kv_idx = 0; kv_idx < sorted_kv_size; ++kv_idx) {
-      ++kv_request_count;
-      uint32_t keys = 1;
-      last_key = sorted_kvs[kv_idx].first;
-      request_buffer.append(reinterpret_cast<void *>(&last_key),
-                            sizeof(uint64_t));
-      while (kv_idx < sorted_kv_size - 1 &&
-             last_key == sorted_kvs[kv_idx + 1].first) {
-        ++kv_idx;
-        ++keys;
-      }
-      keys_counter.push_back(keys);
-    }
-
-    request_buffer.append(reinterpret_cast<void *>(keys_counter.data()),
-                          sizeof(uint32_t) * keys_counter.size());
+    uint32_t kv_request_count = SerializePullSparseRequest(
+        sorted_kvs, is_training, &closure->cntl(i)->request_attachment());
 
     if (kv_request_count == 0) {
       closure->Run();
@@ -1334,31 +1630,8 @@ std::future<int32_t> BrpcPsClient::PullSparseParam(float **select_values,
                 return k1.first < k2.first;
               });
 
-    uint64_t last_key = UINT64_MAX;
-    uint32_t kv_request_count = 0;
-    size_t sorted_kv_size = sorted_kvs.size();
-    auto &request_buffer = closure->cntl(i)->request_attachment();
-
-    request_buffer.append(reinterpret_cast<void *>(&is_training), sizeof(bool));
-    std::vector<uint32_t> keys_counter;
-    keys_counter.reserve(sorted_kv_size);
-
-    for (size_t kv_idx = 0; kv_idx < sorted_kv_size; ++kv_idx) {
-      ++kv_request_count;
-      uint32_t keys = 1;
-      last_key = sorted_kvs[kv_idx].first;
-      request_buffer.append(reinterpret_cast<void *>(&last_key),
-                            sizeof(uint64_t));
-      while (kv_idx < sorted_kv_size - 1 &&
-             last_key == sorted_kvs[kv_idx + 1].first) {
-        ++kv_idx;
-        ++keys;
-      }
-      keys_counter.push_back(keys);
-    }
-
-    request_buffer.append(reinterpret_cast<void *>(keys_counter.data()),
-                          sizeof(uint32_t) * keys_counter.size());
+    uint32_t kv_request_count = SerializePullSparseRequest(
+        sorted_kvs, is_training, &closure->cntl(i)->request_attachment());
 
     if (kv_request_count == 0) {
       closure->Run();
@@ -1423,15 +1696,16 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradientPartial(
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
   push_request->add_params((char *)&num, sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
-  push_data->resize(num * (sizeof(uint64_t) + value_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
+  size_t push_size = num * (sizeof(uint64_t) + value_size);
+  char *push_buffer = GetPushSparseBuffer(push_request, push_size);
+  char *push_data_ptr = push_buffer;
   memcpy(push_data_ptr, keys, num * sizeof(uint64_t));
   push_data_ptr += num * sizeof(uint64_t);
   for (uint32_t i = 0; i < num; ++i) {
     memcpy(push_data_ptr, update_values[i], value_size);
     push_data_ptr += value_size;
   }
+  AttachPushSparseBuffer(closure->cntl(0), push_buffer, push_size);
   PsService_Stub rpc_stub(GetSparseChannel(pserver_idx));
   closure->cntl(0)->set_request_compress_type(
       (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -1559,8 +1833,12 @@ std::future<int32_t> BrpcPsClient::PushSparse(size_t table_id,
       break;
     }
   }
+  auto route = GetSparseShardRoute(table_id);
   for (size_t i = 0; i < num; ++i) {
-    size_t shard_id = get_sparse_shard(shard_num, request_call_num, keys[i]);
+    size_t shard_id =
+        route != nullptr
+            ? route->Server(keys[i])
+            : get_sparse_shard(shard_num, request_call_num, keys[i]);
     shard_sorted_kv_list[shard_id].push_back({keys[i], update_values[i]});
   }
   auto sparse_task_data = _sparse_task_pool.get();
@@ -1857,10 +2135,10 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   push_request->set_client_id(_client_id);
   push_request->add_params(reinterpret_cast<char *>(&merged_kv_count),
                            sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
   int update_size = accessor->GetAccessorInfo().update_size;
-  push_data->resize(merged_kv_count * (sizeof(uint64_t) + update_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
+  size_t push_size = merged_kv_count * (sizeof(uint64_t) + update_size);
+  char *push_buffer = GetPushSparseBuffer(push_request, push_size);
+  char *push_data_ptr = push_buffer;
   memcpy(push_data_ptr,
          merged_key_list.data(),
          merged_kv_count * sizeof(uint64_t));
@@ -1873,6 +2151,7 @@ int BrpcPsClient::PushSparseAsyncShardPush(
            update_size);
     push_data_ptr += update_size;
   }
+  AttachPushSparseBuffer(closure->cntl(shard_idx), push_buffer, push_size);
   PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
   closure->cntl(shard_idx)->set_request_compress_type(
       (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -2033,6 +2312,33 @@ void BrpcPsClient::PushDenseTaskConsume() {
   }
 }
 
+void BrpcPsClient::SerializePushDenseRequest(uint32_t table_id,
+                                             const float *total_send_data,
+                                             uint32_t num_per_shard,
+                                             size_t shard_idx,
+                                             PsRequestMessage *request) {
+  auto type = static_cast<DenseGradientCompressType>(
+      FLAGS_pserver_dense_gradient_compress_type);
+  float *residual = nullptr;
+  std::unique_lock<std::mutex> lock(_dense_gradient_residual_mutex,
+                                    std::defer_lock);
+  if (type == DENSE_GRADIENT_TOPK) {
+    lock.lock();
+    auto &table_residual = _dense_gradient_residuals[table_id];
+    table_residual.resize(num_per_shard * _server_channels.size(), 0);
+    residual = table_residual.data() + shard_idx * num_per_shard;
+  }
+  EncodeDenseGradient(type,
+                      total_send_data + shard_idx * num_per_shard,
+                      num_per_shard,
+                      FLAGS_pserver_dense_gradient_topk_ratio,
+                      residual,
+                      request->mutable_data());
+  if (type != DENSE_GRADIENT_FP32) {
+    request->add_params(std::to_string(type));
+  }
+}
+
 void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
                                         float *total_send_data,
                                         size_t total_send_data_size,
@@ -2050,14 +2356,11 @@ void BrpcPsClient::PushDenseRawGradient(std::shared_ptr<DenseAsyncTask> &task,
     closure->request(i)->set_cmd_id(PS_PUSH_DENSE_TABLE);
     closure->request(i)->set_table_id(task->table_id());
     closure->request(i)->set_client_id(_client_id);
-    auto *push_data = closure->request(i)->mutable_data();
-    push_data->clear();
-    push_data->resize(sizeof(uint32_t) + num_per_shard * sizeof(float));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, &num_per_shard, sizeof(uint32_t));
-    memcpy(push_data_ptr + sizeof(uint32_t),
-           total_send_data + i * num_per_shard,
-           num_per_shard * sizeof(float));
+    SerializePushDenseRequest(task->table_id(),
+                              total_send_data,
+                              num_per_shard,
+                              i,
+                              closure->request(i));
     closure->cntl(i)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
     PsService_Stub rpc_stub(GetDenseChannel(i));
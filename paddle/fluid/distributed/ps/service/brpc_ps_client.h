@@ -17,6 +17,7 @@
 #include <ThreadPool.h>
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
 
@@ -27,6 +28,8 @@
 #include "paddle/fluid/distributed/ps/service/brpc_utils.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_shard_route.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
@@ -237,6 +240,11 @@ class BrpcPsClient : public PSClient {
   std::future<int32_t> Revert() override;
   std::future<int32_t> CheckSavePrePatchDone() override;
 
+  std::future<int32_t> RebalanceSparseTable(uint32_t table_id,
+                                            double max_imbalance,
+                                            size_t max_swaps) override;
+  std::future<int32_t> PullSparseShardRoute(uint32_t table_id) override;
+
   std::future<int32_t> StopServer() override;
 
   std::future<int32_t> StartProfiler() override;
@@ -360,9 +368,45 @@ class BrpcPsClient : public PSClient {
   std::unordered_map<uint32_t, paddle::framework::Channel<SparseAsyncTask *>>
       _push_sparse_task_queue_map;
   std::unordered_map<uint32_t, uint32_t> _push_sparse_merge_count_map;
+  // the caches of the hot keys of the sparse tables for PullSparse, enabled
+  // by FLAGS_pserver_client_sparse_cache_capacity
+  std::unordered_map<uint32_t, std::unique_ptr<SparsePullCache>>
+      _sparse_pull_caches;
+  // the routes of the sparse tables rebalanced, the others are routed by
+  // get_sparse_shard
+  std::mutex _sparse_shard_route_mutex;
+  std::unordered_map<uint32_t, std::shared_ptr<const SparseShardRoute>>
+      _sparse_shard_routes;
+
+  // the error feedback of the topk encoding of the dense gradients, the
+  // values not pushed yet of every table
+  std::mutex _dense_gradient_residual_mutex;
+  std::unordered_map<uint32_t, std::vector<float>> _dense_gradient_residuals;
 
   std::thread _print_thread;
 
+  // encodes a shard of a dense gradient into the request by
+  // FLAGS_pserver_dense_gradient_compress_type
+  void SerializePushDenseRequest(uint32_t table_id,
+                                 const float *total_send_data,
+                                 uint32_t num_per_shard,
+                                 size_t shard_idx,
+                                 PsRequestMessage *request);
+
+  SparsePullCache *GetSparsePullCache(uint32_t table_id);
+  std::shared_ptr<const SparseShardRoute> GetSparseShardRoute(
+      uint32_t table_id);
+  // sends a cmd of a table to one server and waits for it, and keeps the data
+  // of the response in resp if it is not null
+  int32_t SendServerCmd(size_t server_id,
+                        uint32_t table_id,
+                        int cmd_id,
+                        const std::vector<std::string> &params,
+                        const std::string &data,
+                        std::string *resp);
+  // drops the cached values of a table, or all the tables if table_id is -1
+  void ClearSparsePullCache(uint32_t table_id);
+
   int PushSparseAsyncShardMerge(
       std::vector<std::shared_ptr<SparseAsyncTask>> &task_list,  // NOLINT
       std::vector<int> &request_kv_num,                          // NOLINT
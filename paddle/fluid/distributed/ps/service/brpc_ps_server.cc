@@ -18,6 +18,7 @@
 
 #include "butil/object_pool.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/service/dense_gradient_codec.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/framework/archive.h"
@@ -217,6 +218,13 @@ int32_t BrpcPsService::Initialize() {
   _service_handler_map[PS_REVERT] = &BrpcPsService::Revert;
   _service_handler_map[PS_CHECK_SAVE_PRE_PATCH_DONE] =
       &BrpcPsService::CheckSavePrePatchDone;
+  // for the swaps of the sparse shards
+  _service_handler_map[PS_QUERY_SHARD_LOAD] = &BrpcPsService::QueryShardLoad;
+  _service_handler_map[PS_EXPORT_SHARD] = &BrpcPsService::ExportShard;
+  _service_handler_map[PS_IMPORT_SHARD] = &BrpcPsService::ImportShard;
+  _service_handler_map[PS_SWITCH_SHARD] = &BrpcPsService::SwitchShard;
+  _service_handler_map[PS_PUSH_SHARD_ROUTE] = &BrpcPsService::PushShardRoute;
+  _service_handler_map[PS_PULL_SHARD_ROUTE] = &BrpcPsService::PullShardRoute;
 
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_server_pull_dense");
@@ -382,6 +390,7 @@ int32_t BrpcPsService::PushDense(Table *table,
   Push Content:
   |--num--|---valuesData---|
   |--4B---|----------------|
+  or encoded by params(0), see DenseGradientCompressType
   */
   uint32_t num = *(const uint32_t *)(request.data().data());
   TableContext table_context;
@@ -389,6 +398,19 @@ int32_t BrpcPsService::PushDense(Table *table,
   table_context.push_context.values =
       (const float *)(request.data().data() + sizeof(uint32_t));
   table_context.num = num;
+  thread_local std::vector<float> decoded_values;
+  if (request.params_size() > 0) {
+    auto type =
+        static_cast<DenseGradientCompressType>(std::stoi(request.params(0)));
+    if (DecodeDenseGradient(type,
+                            request.data().data(),
+                            req_buffer_size,
+                            &decoded_values) != 0) {
+      set_response_code(response, -1, "push dense data is not in format");
+      return 0;
+    }
+    table_context.push_context.values = decoded_values.data();
+  }
   // const float *values = (const float *)(request.data().data() +
   // sizeof(uint32_t));
   if (table->Push(table_context) != 0) {
@@ -534,18 +556,18 @@ int32_t BrpcPsService::PullSparse(Table *table,
 
   value.DeserializeFromBytes(const_cast<void *>(data));
 
-  auto res_data = butil::get_object<std::vector<float>>();
-  res_data->resize(num * dim);
+  // the values are pulled into the buffer which the attachment takes
+  // without copying
+  size_t res_size = static_cast<size_t>(num) * dim * sizeof(float);
+  float *res_data = static_cast<float *>(malloc(res_size));
   TableContext table_context;
   table_context.value_type = Sparse;
   table_context.pull_context.pull_value = value;
-  table_context.pull_context.values = res_data->data();
+  table_context.pull_context.values = res_data;
   table->Pull(table_context);
   // table->PullSparse(res_data->data(), value);
 
-  cntl->response_attachment().append(reinterpret_cast<char *>(res_data->data()),
-                                     res_data->size() * sizeof(float));
-  butil::return_object(res_data);
+  cntl->response_attachment().append_user_data(res_data, res_size, free);
   return 0;
 }
 
@@ -556,8 +578,11 @@ int32_t BrpcPsService::PushSparse(Table *table,
   platform::RecordEvent record_event(
       "PsService->PushSparse", platform::TracerEventType::Communication, 1);
   CHECK_TABLE_EXIST(table, request, response)
+  // the data is sent by the attachment if it is not compressed, see
+  // GetPushSparseBuffer of BrpcPsClient
   auto &push_data = request.data();
-  if (push_data.empty()) {
+  auto &req_io_buffer = cntl->request_attachment();
+  if (push_data.empty() && req_io_buffer.empty()) {
     // set_response_code(response, 0, "push sparse data is empty");
     return 0;
   }
@@ -571,6 +596,21 @@ int32_t BrpcPsService::PushSparse(Table *table,
   CostTimer timer("pserver_server_push_sparse");
   const uint32_t num =
       *(reinterpret_cast<const uint32_t *>(request.params(0).c_str()));
+  const char *data = push_data.data();
+  size_t data_size = push_data.size();
+  if (push_data.empty()) {
+    // parsed in place if the attachment is contiguous
+    thread_local std::string req_buffer;
+    data_size = req_io_buffer.size();
+    req_buffer.resize(data_size);
+    data = reinterpret_cast<const char *>(
+        req_io_buffer.fetch(const_cast<char *>(req_buffer.data()), data_size));
+  }
+  size_t update_size = table->GetValueAccessor()->GetAccessorInfo().update_size;
+  if (data_size != num * (sizeof(uint64_t) + update_size)) {
+    set_response_code(response, -1, "push sparse data is not in format");
+    return 0;
+  }
   /*
   Push Content:
   |---keysData---|---valuesData---|
@@ -578,9 +618,9 @@ int32_t BrpcPsService::PushSparse(Table *table,
   */
   TableContext table_context;
   table_context.value_type = Sparse;
-  table_context.push_context.keys = (const uint64_t *)push_data.data();
+  table_context.push_context.keys = (const uint64_t *)data;
   table_context.push_context.values =
-      (const float *)(push_data.data() + sizeof(uint64_t) * num);
+      (const float *)(data + sizeof(uint64_t) * num);
   table_context.num = num;
   // const uint64_t *keys = (const uint64_t *)push_data.data();
   // const float *values = (const float *)(push_data.data() + sizeof(uint64_t) *
@@ -795,6 +835,113 @@ int32_t BrpcPsService::CheckSavePrePatchDone(Table *table,
   return 0;
 }
 
+int32_t BrpcPsService::QueryShardLoad(Table *table,
+                                      const PsRequestMessage &request,
+                                      PsResponseMessage &response,
+                                      brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  std::vector<SparseShardLoad> loads;
+  if (table->QueryShardLoad(&loads) != 0) {
+    set_response_code(response, -1, "table query shard load failed");
+    return -1;
+  }
+  ::paddle::framework::BinaryArchive ar;
+  ar << static_cast<uint64_t>(loads.size());
+  for (auto &load : loads) {
+    ar << load.shard_id << load.access_num << load.key_num;
+  }
+  response.set_data(std::string(ar.Buffer(), ar.Length()));
+  return 0;
+}
+
+int32_t BrpcPsService::ExportShard(Table *table,
+                                   const PsRequestMessage &request,
+                                   PsResponseMessage &response,
+                                   brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  if (request.params_size() < 1) {
+    set_response_code(
+        response, -1, "PsRequestMessage.datas is required at least 1, shard");
+    return -1;
+  }
+  std::string data;
+  if (table->ExportShard(std::stoul(request.params(0)), &data) != 0) {
+    set_response_code(response, -1, "table export shard failed");
+    return -1;
+  }
+  response.set_data(std::move(data));
+  return 0;
+}
+
+int32_t BrpcPsService::ImportShard(Table *table,
+                                   const PsRequestMessage &request,
+                                   PsResponseMessage &response,
+                                   brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  if (request.params_size() < 1) {
+    set_response_code(
+        response, -1, "PsRequestMessage.datas is required at least 1, shard");
+    return -1;
+  }
+  if (table->ImportShard(std::stoul(request.params(0)), request.data()) != 0) {
+    set_response_code(response, -1, "table import shard failed");
+    return -1;
+  }
+  return 0;
+}
+
+int32_t BrpcPsService::SwitchShard(Table *table,
+                                   const PsRequestMessage &request,
+                                   PsResponseMessage &response,
+                                   brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  if (request.params_size() < 2) {
+    set_response_code(response,
+                      -1,
+                      "PsRequestMessage.datas is required at least 2 for "
+                      "shard_out & shard_in");
+    return -1;
+  }
+  table->Flush();
+  if (table->SwitchShard(std::stoul(request.params(0)),
+                         std::stoul(request.params(1))) != 0) {
+    set_response_code(response, -1, "table switch shard failed");
+    return -1;
+  }
+  return 0;
+}
+
+int32_t BrpcPsService::PushShardRoute(Table *table,
+                                      const PsRequestMessage &request,
+                                      PsResponseMessage &response,
+                                      brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  SparseShardRoute route;
+  if (!route.Deserialize(request.data())) {
+    set_response_code(response, -1, "shard route is broken");
+    return -1;
+  }
+  if (table->SetShardRoute(route) != 0) {
+    set_response_code(response, -1, "table set shard route failed");
+    return -1;
+  }
+  return 0;
+}
+
+int32_t BrpcPsService::PullShardRoute(Table *table,
+                                      const PsRequestMessage &request,
+                                      PsResponseMessage &response,
+                                      brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  SparseShardRoute route;
+  if (table->GetShardRoute(&route) != 0) {
+    set_response_code(response, -1, "table get shard route failed");
+    return -1;
+  }
+  response.set_data(route.Serialize());
+  return 0;
+}
+
 int32_t BrpcPsService::ShrinkTable(Table *table,
                                    const PsRequestMessage &request,
                                    PsResponseMessage &response,
@@ -197,6 +197,36 @@ class BrpcPsService : public PsBaseService {
                                 PsResponseMessage &response,  // NOLINT
                                 brpc::Controller *cntl);
 
+  int32_t QueryShardLoad(Table *table,
+                         const PsRequestMessage &request,
+                         PsResponseMessage &response,  // NOLINT
+                         brpc::Controller *cntl);
+
+  int32_t ExportShard(Table *table,
+                      const PsRequestMessage &request,
+                      PsResponseMessage &response,  // NOLINT
+                      brpc::Controller *cntl);
+
+  int32_t ImportShard(Table *table,
+                      const PsRequestMessage &request,
+                      PsResponseMessage &response,  // NOLINT
+                      brpc::Controller *cntl);
+
+  int32_t SwitchShard(Table *table,
+                      const PsRequestMessage &request,
+                      PsResponseMessage &response,  // NOLINT
+                      brpc::Controller *cntl);
+
+  int32_t PushShardRoute(Table *table,
+                         const PsRequestMessage &request,
+                         PsResponseMessage &response,  // NOLINT
+                         brpc::Controller *cntl);
+
+  int32_t PullShardRoute(Table *table,
+                         const PsRequestMessage &request,
+                         PsResponseMessage &response,  // NOLINT
+                         brpc::Controller *cntl);
+
   bool _is_initialize_shard_info;
   std::mutex _initialize_shard_mutex;
   std::unordered_map<int32_t, serviceHandlerFunc> _service_handler_map;
@@ -18,7 +18,16 @@ limitations under the License. */
 #include <netdb.h>
 
 #include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/enforce.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#endif
+
+PD_DEFINE_bool(heter_use_rdma,
+               false,
+               "Whether to exchange the variables of the heter pipeline over "
+               "RDMA, only works when brpc is built with RDMA.");
 
 namespace paddle::framework {
 class Variable;
@@ -30,6 +39,24 @@ class DenseTensor;
 
 namespace paddle::distributed {
 
+#ifdef PADDLE_WITH_CUDA
+namespace {
+
+// Returns a page-locked buffer of at least size bytes owned by the calling
+// thread. The device tensors are staged through it, so that the copies run
+// at the DMA bandwidth and no host buffer is allocated per variable.
+void* PinnedStagingBuffer(size_t size) {
+  thread_local phi::Allocator::AllocationPtr holder;
+  if (holder == nullptr || holder->size() < size) {
+    holder.reset();
+    holder = memory::Alloc(phi::GPUPinnedPlace(), size);
+  }
+  return holder->ptr();
+}
+
+}  // namespace
+#endif
+
 framework::proto::VarType::Type VarMessageToVarType(
     VariableMessage::Type type) {
   switch (type) {
@@ -113,21 +140,18 @@ void SerializeLodTensor(framework::Variable* var,
     iobuf->append(reinterpret_cast<const char*>(tensor->data()), data_len);
   } else {
 #ifdef PADDLE_WITH_CUDA
-    char* temp_ptr =
-        new char[tensor->numel() * phi::SizeOf(tensor->dtype())];  // NOLINT
-    auto stream = reinterpret_cast<const phi::GPUContext&>(ctx).stream();
-    memory::Copy(
-        phi::CPUPlace(),
-        temp_ptr,
-        tensor->place(),
-        tensor->data(),
-        tensor->numel() * framework::SizeOfType(
-                              framework::TransToProtoVarType(tensor->dtype())),
-        stream);
     auto data_len = tensor->numel() * phi::SizeOf(tensor->dtype());
+    void* temp_ptr = PinnedStagingBuffer(data_len);
+    auto stream = reinterpret_cast<const phi::GPUContext&>(ctx).stream();
+    memory::Copy(phi::GPUPinnedPlace(),
+                 temp_ptr,
+                 tensor->place(),
+                 tensor->data(),
+                 data_len,
+                 stream);
+    platform::GpuStreamSync(stream);
     iobuf->append(reinterpret_cast<const char*>(&data_len), 8);
-    iobuf->append(reinterpret_cast<const char*>(temp_ptr), data_len);
-    delete[] temp_ptr;
+    iobuf->append(temp_ptr, data_len);
 #endif
   }
 }
@@ -160,21 +184,18 @@ void SerializeSelectedRows(framework::Variable* var,
     iobuf->append(reinterpret_cast<const char*>(tensor->data()), data_len);
   } else {
 #ifdef PADDLE_WITH_CUDA
-    char* temp_ptr =
-        new char[tensor->numel() * phi::SizeOf(tensor->dtype())];  // NOLINT
-    auto stream = reinterpret_cast<const phi::GPUContext&>(ctx).stream();
-    memory::Copy(
-        phi::CPUPlace(),
-        temp_ptr,
-        tensor->place(),
-        tensor->data(),
-        tensor->numel() * framework::SizeOfType(
-                              framework::TransToProtoVarType(tensor->dtype())),
-        stream);
     auto data_len = tensor->numel() * phi::SizeOf(tensor->dtype());
+    void* temp_ptr = PinnedStagingBuffer(data_len);
+    auto stream = reinterpret_cast<const phi::GPUContext&>(ctx).stream();
+    memory::Copy(phi::GPUPinnedPlace(),
+                 temp_ptr,
+                 tensor->place(),
+                 tensor->data(),
+                 data_len,
+                 stream);
+    platform::GpuStreamSync(stream);
     iobuf->append(reinterpret_cast<const char*>(&data_len), 8);
-    iobuf->append(reinterpret_cast<const char*>(temp_ptr), data_len);
-    delete[] temp_ptr;
+    iobuf->append(temp_ptr, data_len);
 #endif
   }
 }
@@ -219,6 +240,35 @@ void DeserializeFromMultiVarMsgAndIOBuf(const MultiVarMsg& multi_msg,
   }
 }
 
+void DeserializeVarFromMultiVarMsgAndIOBuf(const MultiVarMsg& multi_msg,
+                                           const butil::IOBuf* iobuf,
+                                           const std::string& varname,
+                                           const phi::DeviceContext& ctx,
+                                           framework::Scope* scope) {
+  butil::IOBufBytesIterator io_buffer_itr(*iobuf);
+  for (int recv_var_index = 0; recv_var_index < multi_msg.send_var_names_size();
+       ++recv_var_index) {
+    const auto& msg = multi_msg.var_messages(recv_var_index);
+    if (msg.varname() != varname) {
+      unsigned long data_len;                                 // NOLINT
+      io_buffer_itr.copy_and_forward((void*)(&data_len), 8);  // NOLINT
+      io_buffer_itr.forward(data_len);
+      continue;
+    }
+    auto* var = scope->Var(msg.varname());
+    if (msg.type() == ::paddle::distributed::LOD_TENSOR) {
+      DeserializeLodTensor(var, msg, io_buffer_itr, ctx);
+    } else if (msg.type() == ::paddle::distributed::SELECTED_ROWS) {
+      DeserializeSelectedRows(var, msg, io_buffer_itr, ctx);
+    }
+    return;
+  }
+  PADDLE_THROW(phi::errors::NotFound(
+      "Not find variable %s in the message %s.",
+      varname,
+      multi_msg.message_name()));
+}
+
 void DeserializeLodTensor(framework::Variable* var,
                           const VarMsg& msg,
                           butil::IOBufBytesIterator& io_buffer_itr,  // NOLINT
@@ -252,19 +302,19 @@ void DeserializeLodTensor(framework::Variable* var,
     io_buffer_itr.copy_and_forward(tensor_data, data_len);
   } else if (phi::is_gpu_place(place)) {
 #ifdef PADDLE_WITH_CUDA
-    unsigned long data_len;  // NOLINT
-    char* temp_ptr =
-        new char[tensor->numel() * phi::SizeOf(tensor->dtype())];  // NOLINT
-    io_buffer_itr.copy_and_forward((void*)(&data_len), 8);         // NOLINT
-    io_buffer_itr.copy_and_forward((void*)temp_ptr, data_len);     // NOLINT
+    unsigned long data_len;                                 // NOLINT
+    io_buffer_itr.copy_and_forward((void*)(&data_len), 8);  // NOLINT
+    void* temp_ptr = PinnedStagingBuffer(data_len);
+    io_buffer_itr.copy_and_forward(temp_ptr, data_len);
     auto stream = reinterpret_cast<const phi::GPUContext&>(ctx).stream();
     memory::Copy(place,
                  tensor_data,
-                 phi::CPUPlace(),
-                 (void*)temp_ptr,  // NOLINT
+                 phi::GPUPinnedPlace(),
+                 temp_ptr,
                  tensor->numel() * phi::SizeOf(tensor->dtype()),
                  stream);
-    delete[] temp_ptr;
+    // the staging buffer is reused by the next variable
+    platform::GpuStreamSync(stream);
 #endif
   }
 }
@@ -296,19 +346,19 @@ void DeserializeSelectedRows(
     io_buffer_itr.copy_and_forward(tensor_data, data_len);
   } else if (phi::is_gpu_place(place)) {
 #ifdef PADDLE_WITH_CUDA
-    char* temp_ptr =
-        new char[tensor->numel() * phi::SizeOf(tensor->dtype())];  // NOLINT
-    unsigned long data_len;                                        // NOLINT
-    io_buffer_itr.copy_and_forward((void*)(&data_len), 8);         // NOLINT
+    unsigned long data_len;                                 // NOLINT
+    io_buffer_itr.copy_and_forward((void*)(&data_len), 8);  // NOLINT
+    void* temp_ptr = PinnedStagingBuffer(data_len);
     io_buffer_itr.copy_and_forward(temp_ptr, data_len);
     auto stream = reinterpret_cast<const phi::GPUContext&>(ctx).stream();
     memory::Copy(place,
                  tensor_data,
-                 phi::CPUPlace(),
+                 phi::GPUPinnedPlace(),
                  temp_ptr,
                  tensor->numel() * phi::SizeOf(tensor->dtype()),
                  stream);
-    delete[] temp_ptr;
+    // the staging buffer is reused by the next variable
+    platform::GpuStreamSync(stream);
 #endif
   }
 }
@@ -21,6 +21,7 @@ limitations under the License. */
 #include <vector>
 
 #include "brpc/channel.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -30,6 +31,8 @@ limitations under the License. */
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/phi/common/port.h"
 
+PD_DECLARE_bool(heter_use_rdma);
+
 namespace butil {
 class IOBuf;
 class IOBufBytesIterator;
@@ -76,6 +79,14 @@ void DeserializeFromMultiVarMsgAndIOBuf(const MultiVarMsg& multi_msg,
                                         const phi::DeviceContext& ctx,
                                         framework::Scope* scope);
 
+// Deserializes only the variable varname of the message into scope, the
+// data of the other variables are skipped without being copied.
+void DeserializeVarFromMultiVarMsgAndIOBuf(const MultiVarMsg& multi_msg,
+                                           const butil::IOBuf* iobuf,
+                                           const std::string& varname,
+                                           const phi::DeviceContext& ctx,
+                                           framework::Scope* scope);
+
 // Deserialize for Client
 void DeserializeFromMultiVarMsgAndIOBuf(const MultiVarMsg& multi_msg,
                                         const butil::IOBuf* iobuf,
@@ -92,6 +103,19 @@ void DeserializeSelectedRows(framework::Variable* var,
                              butil::IOBufBytesIterator& iobuf,  // NOLINT
                              const phi::DeviceContext& ctx);
 
+// Sends the traffic of the channel or the server over RDMA when
+// FLAGS_heter_use_rdma is set, which needs brpc built with RDMA.
+template <typename Options>
+void SetRdmaOptions(Options* options) {
+#ifdef PADDLE_WITH_BRPC_RDMA
+  options->use_rdma = FLAGS_heter_use_rdma;
+#else
+  LOG_IF(WARNING, FLAGS_heter_use_rdma)
+      << "heter_use_rdma is ignored since brpc is not built with RDMA, "
+         "please build with WITH_BRPC_RDMA=ON.";
+#endif
+}
+
 std::string GetIntTypeEndpoint(const std::string& ip, const uint32_t& port);
 
 }  // namespace distributed
@@ -1107,6 +1107,15 @@ void GeoCommunicator::InitImpl(const RpcCtxMap &send_varname_to_ctx,
               splited_var,
               ::paddle::framework::MakeChannel<
                   std::shared_ptr<std::vector<int64_t>>>(send_queue_size_)));
+      if (FLAGS_communicator_geo_adaptive) {
+        delta_recorders_.emplace(
+            splited_var,
+            std::make_unique<GeoDeltaRecorder>(
+                static_cast<float>(FLAGS_communicator_geo_top_ratio),
+                static_cast<float>(FLAGS_communicator_geo_delta_threshold),
+                FLAGS_communicator_geo_max_delay));
+        merge_nums_.emplace(splited_var, max_merge_var_num_);
+      }
     }
   }
   send_threadpool_ = std::make_unique<ThreadPool>(thread_pool_size_);
@@ -1297,8 +1306,11 @@ std::vector<int64_t> GeoCommunicator::MergeSparseIds(
                                      1);
   size_t merge_num = 0, wait_times = 0;
   std::unordered_set<int64_t> sparse_ids;
-  while (merge_num <
-         static_cast<size_t>(max_merge_var_num_)) {  // -> geo_step: 100
+  // the merge_nums_ only get written by the task of their own var
+  size_t max_merge_num = static_cast<size_t>(
+      FLAGS_communicator_geo_adaptive ? merge_nums_.at(send_varname)
+                                      : max_merge_var_num_);
+  while (merge_num < max_merge_num) {  // -> geo_step: 100
     VLOG(3) << "Merge Number of " << send_varname << " = " << merge_num;
     if (sparse_id_queues_.at(send_varname)->Size() > 0) {
       wait_times = 0;
@@ -1356,6 +1368,27 @@ void GeoCommunicator::SendSparse(const std::string &varname,
 
   auto dims1 = t_latest.dims()[1];
   phi::CPUContext cpu_ctx;
+  float coefficient = 1.0 / static_cast<float>(trainers_);
+
+  if (FLAGS_communicator_geo_adaptive) {
+    auto &recorder = delta_recorders_.at(varname);
+    recorder->Merge(&sparse_ids);
+    std::vector<float> magnitudes(sparse_ids.size());
+    for (size_t j = 0; j < sparse_ids.size(); ++j) {
+      const float *latest = t_latest.data<float>() + sparse_ids[j] * dims1;
+      const float *old = t_old->data<float>() + sparse_ids[j] * dims1;
+      float norm = 0;
+      for (int64_t k = 0; k < dims1; ++k) {
+        float delta = (latest[k] - old[k]) * coefficient;
+        norm += delta * delta;
+      }
+      magnitudes[j] = std::sqrt(norm);
+    }
+    recorder->Select(&sparse_ids, magnitudes);
+    if (sparse_ids.empty()) {
+      return;
+    }
+  }
 
   auto *var_delta = delta_scope_->Var(varname);
   auto *t_delta = var_delta->GetMutable<phi::SelectedRows>();
@@ -1367,7 +1400,6 @@ void GeoCommunicator::SendSparse(const std::string &varname,
   t_delta->set_height(t_latest.dims()[0]);
 
   auto blas = phi::funcs::GetBlas<phi::CPUContext, float>(cpu_ctx);
-  float coefficient = 1.0 / static_cast<float>(trainers_);
 
   std::vector<float *> push_g_vec;
   for (auto j = 0; j < static_cast<int>(sparse_ids.size()); ++j) {
@@ -1460,6 +1492,25 @@ void GeoCommunicator::RecvSparse(const std::string &varname,
   VLOG(1) << "Finish Recv Sparse " << param << ", table_id: " << table_id;
 }
 
+void GeoCommunicator::AdaptMergeNum(const std::string &varname,
+                                    double merge_us,
+                                    double send_recv_us) {
+  // The trainer fills the queue of the next push while the communicator
+  // pushes and pulls. With the network idle most of the round, pushes come
+  // more often, for fresher params, and when the push and the pull take
+  // longer than the merge, the rounds grow back to the geo step.
+  int &merge_num = merge_nums_.at(varname);
+  if (send_recv_us > merge_us) {
+    merge_num = std::min(max_merge_var_num_,
+                         merge_num + std::max(1, merge_num / 2));
+  } else if (send_recv_us * 2 < merge_us) {
+    merge_num = std::max(1, merge_num - 1);
+  }
+  VLOG(2) << "GeoCommunicator " << varname << " merge " << merge_us
+          << " us, send and recv " << send_recv_us << " us, merges "
+          << merge_num << " batches into the next push";
+}
+
 void GeoCommunicator::MainThread() {
   VLOG(3) << "MainThread start and wait";
 
@@ -1490,9 +1541,16 @@ void GeoCommunicator::MainThread() {
             auto splited_varname =
                 ctx.splited_varnames[ep_idx];  // embedding_0.w_0.block0
                                                // embedding_1.w_0.block0
+            auto before_merge = GetCurrentUS();
             auto sparse_ids = MergeSparseIds(splited_varname);
+            auto before_send = GetCurrentUS();
             SendSparse(splited_varname, sparse_ids, table_id, ep_idx);
             RecvSparse(splited_varname, table_id, ep_idx);
+            if (FLAGS_communicator_geo_adaptive) {
+              AdaptMergeNum(splited_varname,
+                            before_send - before_merge,
+                            GetCurrentUS() - before_send);
+            }
           };
           tasks.emplace_back(
               send_threadpool_->enqueue(std::move(send_recv_task)));
@@ -33,6 +33,7 @@ limitations under the License. */
 #include "paddle/fluid/distributed/ps/service/communicator/communicator_common.h"
 #include "paddle/fluid/distributed/ps/service/coordinator_client.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
+#include "paddle/fluid/distributed/ps/table/depends/geo_recorder.h"
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/variable.h"
@@ -53,6 +54,10 @@ struct CommContext;
 }  // namespace paddle
 
 COMMON_DECLARE_bool(communicator_is_sgd_optimizer);
+COMMON_DECLARE_bool(communicator_geo_adaptive);
+COMMON_DECLARE_double(communicator_geo_top_ratio);
+COMMON_DECLARE_double(communicator_geo_delta_threshold);
+COMMON_DECLARE_int32(communicator_geo_max_delay);
 
 namespace paddle {
 namespace distributed {
@@ -613,6 +618,12 @@ class GeoCommunicator : public AsyncCommunicator {
                   int ep_idx);
   void RecvSparse(const std::string &varname, int table_id, int ep_idx);
 
+  // Adapts the number of batches merged into a push of the splited var to
+  // the time the push and the pull of the last round took out of it.
+  void AdaptMergeNum(const std::string &varname,
+                     double merge_us,
+                     double send_recv_us);
+
   void MainThread() override;
 
   virtual void InitEnvs() {
@@ -661,6 +672,12 @@ class GeoCommunicator : public AsyncCommunicator {
       std::string,
       ::paddle::framework::Channel<std::shared_ptr<std::vector<int64_t>>>>
       sparse_id_queues_;
+
+  // the adaptive geo mode, FLAGS_communicator_geo_adaptive: the keys held
+  // back and the number of batches merged into a push of every splited var
+  std::unordered_map<std::string, std::unique_ptr<GeoDeltaRecorder>>
+      delta_recorders_;
+  std::unordered_map<std::string, int> merge_nums_;
 };
 
 class FLCommunicator : public GeoCommunicator {
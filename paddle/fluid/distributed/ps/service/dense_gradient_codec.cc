@@ -0,0 +1,160 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/dense_gradient_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+void EncodeDenseGradient(DenseGradientCompressType type,
+                         const float* values,
+                         uint32_t num,
+                         double topk_ratio,
+                         float* residual,
+                         std::string* out) {
+  out->clear();
+  switch (type) {
+    case DENSE_GRADIENT_FP16:
+    case DENSE_GRADIENT_BF16: {
+      out->resize(sizeof(uint32_t) + num * sizeof(uint16_t));
+      char* data = const_cast<char*>(out->data());
+      memcpy(data, &num, sizeof(uint32_t));
+      uint16_t* half = reinterpret_cast<uint16_t*>(data + sizeof(uint32_t));
+      for (uint32_t i = 0; i < num; ++i) {
+        half[i] = type == DENSE_GRADIENT_FP16
+                      ? phi::dtype::float16(values[i]).x
+                      : phi::dtype::bfloat16(values[i]).x;
+      }
+      return;
+    }
+    case DENSE_GRADIENT_TOPK: {
+      uint32_t k = static_cast<uint32_t>(std::ceil(num * topk_ratio));
+      k = std::min(num, std::max(k, static_cast<uint32_t>(1)));
+      thread_local std::vector<float> accumulated;
+      thread_local std::vector<uint32_t> indices;
+      accumulated.assign(values, values + num);
+      if (residual != nullptr) {
+        for (uint32_t i = 0; i < num; ++i) {
+          accumulated[i] += residual[i];
+        }
+      }
+      indices.resize(num);
+      std::iota(indices.begin(), indices.end(), 0);
+      std::nth_element(indices.begin(),
+                       indices.begin() + k,
+                       indices.end(),
+                       [](uint32_t a, uint32_t b) {
+                         return std::fabs(accumulated[a]) >
+                                std::fabs(accumulated[b]);
+                       });
+      // in the order of the values for the locality of the servers
+      std::sort(indices.begin(), indices.begin() + k);
+
+      out->resize(2 * sizeof(uint32_t) +
+                  k * (sizeof(uint32_t) + sizeof(float)));
+      char* data = const_cast<char*>(out->data());
+      memcpy(data, &num, sizeof(uint32_t));
+      memcpy(data + sizeof(uint32_t), &k, sizeof(uint32_t));
+      uint32_t* sent_indices =
+          reinterpret_cast<uint32_t*>(data + 2 * sizeof(uint32_t));
+      float* sent_values = reinterpret_cast<float*>(sent_indices + k);
+      for (uint32_t i = 0; i < k; ++i) {
+        sent_indices[i] = indices[i];
+        sent_values[i] = accumulated[indices[i]];
+        accumulated[indices[i]] = 0;
+      }
+      if (residual != nullptr) {
+        memcpy(residual, accumulated.data(), num * sizeof(float));
+      }
+      return;
+    }
+    default:
+      out->resize(sizeof(uint32_t) + num * sizeof(float));
+      char* data = const_cast<char*>(out->data());
+      memcpy(data, &num, sizeof(uint32_t));
+      memcpy(data + sizeof(uint32_t), values, num * sizeof(float));
+      return;
+  }
+}
+
+int DecodeDenseGradient(DenseGradientCompressType type,
+                        const char* data,
+                        size_t size,
+                        std::vector<float>* values) {
+  if (size < sizeof(uint32_t)) {
+    return -1;
+  }
+  uint32_t num = *reinterpret_cast<const uint32_t*>(data);
+  data += sizeof(uint32_t);
+  size -= sizeof(uint32_t);
+  switch (type) {
+    case DENSE_GRADIENT_FP16:
+    case DENSE_GRADIENT_BF16: {
+      if (size != num * sizeof(uint16_t)) {
+        return -1;
+      }
+      values->resize(num);
+      const uint16_t* half = reinterpret_cast<const uint16_t*>(data);
+      for (uint32_t i = 0; i < num; ++i) {
+        if (type == DENSE_GRADIENT_FP16) {
+          (*values)[i] =
+              static_cast<float>(phi::dtype::raw_uint16_to_float16(half[i]));
+        } else {
+          uint32_t bits = static_cast<uint32_t>(half[i]) << 16;
+          memcpy(values->data() + i, &bits, sizeof(float));
+        }
+      }
+      return 0;
+    }
+    case DENSE_GRADIENT_TOPK: {
+      if (size < sizeof(uint32_t)) {
+        return -1;
+      }
+      uint32_t k = *reinterpret_cast<const uint32_t*>(data);
+      data += sizeof(uint32_t);
+      size -= sizeof(uint32_t);
+      if (k > num || size != k * (sizeof(uint32_t) + sizeof(float))) {
+        return -1;
+      }
+      values->assign(num, 0);
+      const uint32_t* indices = reinterpret_cast<const uint32_t*>(data);
+      const float* sent_values = reinterpret_cast<const float*>(indices + k);
+      for (uint32_t i = 0; i < k; ++i) {
+        if (indices[i] >= num) {
+          return -1;
+        }
+        (*values)[indices[i]] = sent_values[i];
+      }
+      return 0;
+    }
+    default:
+      if (size != num * sizeof(float)) {
+        return -1;
+      }
+      values->resize(num);
+      memcpy(values->data(), data, num * sizeof(float));
+      return 0;
+  }
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,63 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// The encodings of the dense gradients pushed by PS_PUSH_DENSE_TABLE. The
+// client sets the type as params(0) of the request, and the servers decode
+// the requests without it as DENSE_GRADIENT_FP32, so the clients and the
+// servers of different versions still work together.
+//
+// Push Content:
+//  * FP32:       |--num--|---values: num * 4B---|
+//  * FP16, BF16: |--num--|---values: num * 2B---|
+//  * TOPK:       |--num--|--k--|---indices: k * 4B---|---values: k * 4B---|
+enum DenseGradientCompressType {
+  DENSE_GRADIENT_FP32 = 0,
+  DENSE_GRADIENT_FP16 = 1,
+  DENSE_GRADIENT_BF16 = 2,
+  // the k values of the largest magnitude, k = ceil(num * topk_ratio)
+  DENSE_GRADIENT_TOPK = 3,
+};
+
+// Encodes the num values of a shard of a dense gradient into out.
+//
+// With residual, the error feedback of DENSE_GRADIENT_TOPK: the residual of
+// the shard, num floats, is added to the values before the selection, and
+// the values not sent are kept in it for the next push, so every gradient is
+// sent eventually. It is ignored by the other types.
+void EncodeDenseGradient(DenseGradientCompressType type,
+                         const float* values,
+                         uint32_t num,
+                         double topk_ratio,
+                         float* residual,
+                         std::string* out);
+
+// Decodes the data of a request into values. Returns -1 if the data is not
+// in the format of type.
+int DecodeDenseGradient(DenseGradientCompressType type,
+                        const char* data,
+                        size_t size,
+                        std::vector<float>* values);
+
+}  // namespace distributed
+}  // namespace paddle
@@ -15,6 +15,8 @@
 #include "paddle/fluid/distributed/ps/service/graph_brpc_client.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -28,6 +30,16 @@
 #include "paddle/utils/string/string_helper.h"
 namespace paddle::distributed {
 
+PD_DEFINE_int32(pserver_graph_sample_coalesce_window_us,
+                0,
+                "coalesce the concurrent batch_sample_neighbors requests to "
+                "the same server within the window, 0 to disable");
+
+PD_DEFINE_int32(pserver_graph_sample_coalesce_max_nodes,
+                65536,
+                "send the coalesced batch_sample_neighbors request before "
+                "the window ends once it has so many nodes");
+
 void GraphPsService_Stub::service(
     ::google::protobuf::RpcController *controller,
     const ::paddle::distributed::PsRequestMessage *request,
@@ -398,6 +410,10 @@ std::future<int32_t> GraphBrpcClient::batch_sample_neighbors(
         closure->cntl(0), closure->request(0), closure->response(0), closure);
     return fut;
   }
+  if (FLAGS_pserver_graph_sample_coalesce_window_us > 0) {
+    return coalesce_sample_neighbors(
+        table_id, idx_, node_ids, sample_size, res, res_weight, need_weight);
+  }
   std::vector<int> request2server;
   std::vector<int> server2request(server_size, -1);
   res.clear();
@@ -508,6 +524,205 @@ std::future<int32_t> GraphBrpcClient::batch_sample_neighbors(
 
   return fut;
 }
+std::future<int32_t> GraphBrpcClient::coalesce_sample_neighbors(
+    uint32_t table_id,
+    int idx_,
+    const std::vector<int64_t> &node_ids,
+    int sample_size,
+    std::vector<std::vector<int64_t>> &res,
+    std::vector<std::vector<float>> &res_weight,
+    bool need_weight) {
+  res.clear();
+  res_weight.clear();
+  res.resize(node_ids.size());
+  if (need_weight) {
+    res_weight.resize(node_ids.size());
+  }
+  auto call = std::make_shared<SampleCall>();
+  call->res = &res;
+  call->res_weight = &res_weight;
+  call->fail_num = 0;
+  std::future<int> fut = call->promise.get_future();
+
+  std::map<int, SamplePart> server2part;
+  for (size_t query_idx = 0; query_idx < node_ids.size(); ++query_idx) {
+    auto &part = server2part[get_server_index_by_id(node_ids[query_idx])];
+    part.node_ids.push_back(node_ids[query_idx]);
+    part.query_idx.push_back(query_idx);
+  }
+  call->part_num = server2part.size();
+  call->waiting_num = server2part.size();
+  if (server2part.empty()) {
+    call->promise.set_value(0);
+    return fut;
+  }
+
+  std::vector<std::pair<SampleBatchKey, std::vector<SamplePart>>> full_batches;
+  {
+    std::lock_guard<std::mutex> lock(_sample_mutex);
+    if (!_sample_coalescing) {
+      _sample_coalescing = true;
+      _sample_coalesce_thread =
+          std::thread(&GraphBrpcClient::SampleCoalesceConsume, this);
+    }
+    for (auto &item : server2part) {
+      SampleBatchKey key(table_id, idx_, sample_size, need_weight, item.first);
+      auto &batch = _sample_batches[key];
+      if (batch.parts.empty()) {
+        batch.deadline_us = butil::gettimeofday_us() +
+                            FLAGS_pserver_graph_sample_coalesce_window_us;
+      }
+      batch.node_num += item.second.node_ids.size();
+      item.second.call = call;
+      batch.parts.push_back(std::move(item.second));
+      if (batch.node_num >=
+          static_cast<size_t>(FLAGS_pserver_graph_sample_coalesce_max_nodes)) {
+        full_batches.emplace_back(key, std::move(batch.parts));
+        _sample_batches.erase(key);
+      }
+    }
+  }
+  _sample_cv.notify_one();
+  for (auto &item : full_batches) {
+    SendSampleBatch(item.first, std::move(item.second));
+  }
+  return fut;
+}
+
+void GraphBrpcClient::SampleCoalesceConsume() {
+  std::unique_lock<std::mutex> lock(_sample_mutex);
+  while (true) {
+    _sample_cv.wait(lock, [this] {
+      return !_sample_coalescing || !_sample_batches.empty();
+    });
+    if (_sample_batches.empty()) {
+      break;
+    }
+    // the pending batches are all sent once the coalescing is stopped
+    int64_t now_us = butil::gettimeofday_us();
+    int64_t next_deadline_us = std::numeric_limits<int64_t>::max();
+    std::vector<std::pair<SampleBatchKey, std::vector<SamplePart>>> due_batches;
+    for (auto it = _sample_batches.begin(); it != _sample_batches.end();) {
+      if (!_sample_coalescing || it->second.deadline_us <= now_us) {
+        due_batches.emplace_back(it->first, std::move(it->second.parts));
+        it = _sample_batches.erase(it);
+      } else {
+        next_deadline_us = std::min(next_deadline_us, it->second.deadline_us);
+        ++it;
+      }
+    }
+    if (due_batches.empty()) {
+      _sample_cv.wait_for(
+          lock, std::chrono::microseconds(next_deadline_us - now_us));
+      continue;
+    }
+    lock.unlock();
+    for (auto &item : due_batches) {
+      SendSampleBatch(item.first, std::move(item.second));
+    }
+    lock.lock();
+  }
+}
+
+void GraphBrpcClient::SendSampleBatch(const SampleBatchKey &key,
+                                      std::vector<SamplePart> parts) {
+  uint32_t table_id = std::get<0>(key);
+  int idx_ = std::get<1>(key);
+  int sample_size = std::get<2>(key);
+  bool need_weight = std::get<3>(key);
+  int server_index = std::get<4>(key);
+
+  auto batch_parts =
+      std::make_shared<std::vector<SamplePart>>(std::move(parts));
+  std::vector<int64_t> node_ids;
+  for (auto &part : *batch_parts) {
+    node_ids.insert(node_ids.end(), part.node_ids.begin(), part.node_ids.end());
+  }
+  size_t batch_node_num = node_ids.size();
+
+  DownpourBrpcClosure *closure = new DownpourBrpcClosure(
+      1, [batch_parts, batch_node_num, need_weight](void *done) {
+        auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
+        bool success =
+            closure->check_response(0, PS_GRAPH_BATCH_SAMPLE_NEIGHBORS) == 0;
+        auto &res_io_buffer = closure->cntl(0)->response_attachment();
+        butil::IOBufBytesIterator io_buffer_itr(res_io_buffer);
+        uint64_t node_num = 0;
+        if (success) {
+          io_buffer_itr.copy_and_forward(reinterpret_cast<void *>(&node_num),
+                                         sizeof(uint64_t));
+          success = node_num == batch_node_num;
+        }
+        if (success) {
+          // the neighbor numbers of the nodes, followed by the ids of all the
+          // neighbors and then their weights
+          std::vector<int> neighbor_nums(node_num);
+          io_buffer_itr.copy_and_forward(
+              reinterpret_cast<void *>(neighbor_nums.data()),
+              sizeof(int) * node_num);
+          size_t node_idx = 0;
+          for (auto &part : *batch_parts) {
+            for (int query_idx : part.query_idx) {
+              auto &ids = (*part.call->res)[query_idx];
+              ids.resize(neighbor_nums[node_idx++]);
+              io_buffer_itr.copy_and_forward(
+                  reinterpret_cast<void *>(ids.data()),
+                  sizeof(int64_t) * ids.size());
+            }
+          }
+          if (need_weight) {
+            node_idx = 0;
+            for (auto &part : *batch_parts) {
+              for (int query_idx : part.query_idx) {
+                auto &weights = (*part.call->res_weight)[query_idx];
+                weights.resize(neighbor_nums[node_idx++]);
+                io_buffer_itr.copy_and_forward(
+                    reinterpret_cast<void *>(weights.data()),
+                    sizeof(float) * weights.size());
+              }
+            }
+          }
+        }
+        for (auto &part : *batch_parts) {
+          auto &call = part.call;
+          if (!success) {
+            ++call->fail_num;
+          }
+          if (call->waiting_num.fetch_sub(1) == 1) {
+            call->promise.set_value(call->fail_num == call->part_num ? -1 : 0);
+          }
+        }
+      });
+
+  closure->request(0)->set_cmd_id(PS_GRAPH_BATCH_SAMPLE_NEIGHBORS);
+  closure->request(0)->set_table_id(table_id);
+  closure->request(0)->set_client_id(_client_id);
+  closure->request(0)->add_params(reinterpret_cast<char *>(&idx_),
+                                  sizeof(int));
+  closure->request(0)->add_params(reinterpret_cast<char *>(node_ids.data()),
+                                  sizeof(int64_t) * node_ids.size());
+  closure->request(0)->add_params(reinterpret_cast<char *>(&sample_size),
+                                  sizeof(int));
+  closure->request(0)->add_params(reinterpret_cast<char *>(&need_weight),
+                                  sizeof(bool));
+  GraphPsService_Stub rpc_stub = getServiceStub(GetCmdChannel(server_index));
+  closure->cntl(0)->set_log_id(butil::gettimeofday_ms());
+  rpc_stub.service(
+      closure->cntl(0), closure->request(0), closure->response(0), closure);
+}
+
+void GraphBrpcClient::StopSampleCoalescing() {
+  {
+    std::lock_guard<std::mutex> lock(_sample_mutex);
+    if (!_sample_coalescing) {
+      return;
+    }
+    _sample_coalescing = false;
+  }
+  _sample_cv.notify_one();
+  _sample_coalesce_thread.join();
+}
+
 std::future<int32_t> GraphBrpcClient::random_sample_nodes(
     uint32_t table_id,
     int type_id,
@@ -717,4 +932,10 @@ int32_t GraphBrpcClient::Initialize() {
   local_channel = nullptr;
   return 0;
 }
+
+void GraphBrpcClient::FinalizeWorker() {
+  // sends the pending samplings before the server of the client stops
+  StopSampleCoalescing();
+  BrpcPsClient::FinalizeWorker();
+}
 }  // namespace paddle::distributed
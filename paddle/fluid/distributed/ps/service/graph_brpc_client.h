@@ -16,8 +16,15 @@
 
 #include <ThreadPool.h>
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <future>  // NOLINT
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -25,6 +32,7 @@
 #include "brpc/channel.h"
 #include "brpc/controller.h"
 #include "brpc/server.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
 #include "paddle/fluid/distributed/ps/service/graph_brpc_server.h"
 #include "paddle/fluid/distributed/ps/service/ps_client.h"
@@ -36,6 +44,9 @@
 namespace paddle {
 namespace distributed {
 
+PD_DECLARE_int32(pserver_graph_sample_coalesce_window_us);
+PD_DECLARE_int32(pserver_graph_sample_coalesce_max_nodes);
+
 class GraphPsService_Stub : public PsService_Stub {
  public:
   GraphPsService_Stub(::google::protobuf::RpcChannel* channel,
@@ -64,8 +75,11 @@ class GraphPsService_Stub : public PsService_Stub {
 class GraphBrpcClient : public BrpcPsClient {
  public:
   GraphBrpcClient() {}
-  virtual ~GraphBrpcClient() {}
-  // given a batch of nodes, sample graph_neighbors for each of them
+  virtual ~GraphBrpcClient() { StopSampleCoalescing(); }
+  // given a batch of nodes, sample graph_neighbors for each of them.
+  // When FLAGS_pserver_graph_sample_coalesce_window_us is positive, the
+  // nodes of the concurrent calls to the same server are coalesced into one
+  // request within the window.
   virtual std::future<int32_t> batch_sample_neighbors(
       uint32_t table_id,
       int idx,
@@ -119,6 +133,7 @@ class GraphBrpcClient : public BrpcPsClient {
       int idx_,
       std::vector<int64_t>& node_id_list);  // NOLINT
   virtual int32_t Initialize();
+  void FinalizeWorker() override;
   int get_shard_num() { return shard_num; }
   void set_shard_num(int shard_num) { this->shard_num = shard_num; }
   int get_server_index_by_id(int64_t id);
@@ -135,10 +150,54 @@ class GraphBrpcClient : public BrpcPsClient {
   }
 
  private:
+  // a call of batch_sample_neighbors, which is done when the nodes of all
+  // its parts are sampled
+  struct SampleCall {
+    std::vector<std::vector<int64_t>>* res;
+    std::vector<std::vector<float>>* res_weight;
+    int part_num;
+    std::atomic<int> waiting_num;
+    std::atomic<int> fail_num;
+    std::promise<int32_t> promise;
+  };
+  // the nodes of a call that are sampled by the same server
+  struct SamplePart {
+    std::shared_ptr<SampleCall> call;
+    std::vector<int64_t> node_ids;
+    std::vector<int> query_idx;
+  };
+  // the parts waiting to be sent in one request
+  struct SampleBatch {
+    std::vector<SamplePart> parts;
+    size_t node_num = 0;
+    int64_t deadline_us = 0;
+  };
+  // table_id, idx, sample_size, need_weight and server_index
+  using SampleBatchKey = std::tuple<uint32_t, int, int, bool, int>;
+
+  std::future<int32_t> coalesce_sample_neighbors(
+      uint32_t table_id,
+      int idx,
+      const std::vector<int64_t>& node_ids,
+      int sample_size,
+      std::vector<std::vector<int64_t>>& res,       // NOLINT
+      std::vector<std::vector<float>>& res_weight,  // NOLINT
+      bool need_weight);
+  void SampleCoalesceConsume();
+  void SendSampleBatch(const SampleBatchKey& key,
+                       std::vector<SamplePart> parts);
+  void StopSampleCoalescing();
+
   int shard_num;
   size_t server_size;
   ::google::protobuf::RpcChannel* local_channel;
   GraphBrpcService* graph_service;
+
+  std::mutex _sample_mutex;
+  std::condition_variable _sample_cv;
+  std::map<SampleBatchKey, SampleBatch> _sample_batches;
+  bool _sample_coalescing = false;
+  std::thread _sample_coalesce_thread;
 };
 
 }  // namespace distributed
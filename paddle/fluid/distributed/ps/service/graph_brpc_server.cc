@@ -205,6 +205,8 @@ int32_t GraphBrpcService::Initialize() {
   _service_handler_map[PS_PULL_GRAPH_LIST] = &GraphBrpcService::pull_graph_list;
   _service_handler_map[PS_GRAPH_SAMPLE_NEIGHBORS] =
       &GraphBrpcService::graph_random_sample_neighbors;
+  _service_handler_map[PS_GRAPH_BATCH_SAMPLE_NEIGHBORS] =
+      &GraphBrpcService::graph_batch_sample_neighbors;
   _service_handler_map[PS_GRAPH_SAMPLE_NODES] =
       &GraphBrpcService::graph_random_sample_nodes;
   _service_handler_map[PS_GRAPH_GET_NODE_FEAT] =
@@ -428,6 +430,68 @@ int32_t GraphBrpcService::graph_random_sample_neighbors(
   }
   return 0;
 }
+int32_t GraphBrpcService::graph_batch_sample_neighbors(
+    Table *table,
+    const PsRequestMessage &request,
+    PsResponseMessage &response,
+    brpc::Controller *cntl) {
+  CHECK_TABLE_EXIST(table, request, response)
+  if (request.params_size() < 4) {
+    set_response_code(
+        response,
+        -1,
+        "graph_batch_sample_neighbors request requires at least 4 arguments");
+    return 0;
+  }
+  int idx_ = *reinterpret_cast<const int *>(request.params(0).c_str());
+  uint64_t node_num = request.params(1).size() / sizeof(uint64_t);
+  uint64_t *node_data = (uint64_t *)(request.params(1).c_str());  // NOLINT
+  const int sample_size =
+      *reinterpret_cast<const int *>(request.params(2).c_str());
+  const bool need_weight =
+      *reinterpret_cast<const bool *>(request.params(3).c_str());
+  std::vector<std::shared_ptr<char>> buffers(node_num);
+  std::vector<int> actual_sizes(node_num, 0);
+  (reinterpret_cast<GraphTable *>(table))
+      ->random_sample_neighbors(
+          idx_, node_data, sample_size, buffers, actual_sizes, need_weight);
+
+  size_t neighbor_bytes =
+      GraphNode::id_size + (need_weight ? GraphNode::weight_size : 0);
+  std::vector<int> neighbor_nums(node_num);
+  size_t total_num = 0;
+  for (size_t idx = 0; idx < node_num; ++idx) {
+    neighbor_nums[idx] = actual_sizes[idx] / neighbor_bytes;
+    total_num += neighbor_nums[idx];
+  }
+  std::vector<int64_t> ids;
+  std::vector<float> weights;
+  ids.reserve(total_num);
+  if (need_weight) {
+    weights.reserve(total_num);
+  }
+  for (size_t idx = 0; idx < node_num; ++idx) {
+    const char *buffer = buffers[idx].get();
+    for (int i = 0; i < neighbor_nums[idx]; ++i) {
+      const char *neighbor = buffer + i * neighbor_bytes;
+      ids.push_back(*reinterpret_cast<const int64_t *>(neighbor));
+      if (need_weight) {
+        weights.push_back(*reinterpret_cast<const float *>(
+            neighbor + GraphNode::id_size));
+      }
+    }
+  }
+
+  cntl->response_attachment().append(&node_num, sizeof(uint64_t));
+  cntl->response_attachment().append(neighbor_nums.data(),
+                                     sizeof(int) * node_num);
+  cntl->response_attachment().append(ids.data(), sizeof(int64_t) * total_num);
+  if (need_weight) {
+    cntl->response_attachment().append(weights.data(),
+                                       sizeof(float) * total_num);
+  }
+  return 0;
+}
 int32_t GraphBrpcService::graph_random_sample_nodes(
     Table *table,
     const PsRequestMessage &request,
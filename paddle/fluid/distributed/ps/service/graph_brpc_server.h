@@ -86,6 +86,13 @@ class GraphBrpcService : public PsBaseService {
                                         const PsRequestMessage &request,
                                         PsResponseMessage &response,  // NOLINT
                                         brpc::Controller *cntl);
+  // samples the coalesced nodes of many clients' calls, the response holds
+  // the neighbor numbers followed by the ids and the weights of all the
+  // neighbors, so that the client copies them without parsing each node
+  int32_t graph_batch_sample_neighbors(Table *table,
+                                       const PsRequestMessage &request,
+                                       PsResponseMessage &response,  // NOLINT
+                                       brpc::Controller *cntl);
   int32_t graph_random_sample_nodes(Table *table,
                                     const PsRequestMessage &request,
                                     PsResponseMessage &response,  // NOLINT
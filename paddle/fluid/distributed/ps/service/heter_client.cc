@@ -78,6 +78,7 @@ void HeterClient::CreateClient2XpuConnection() {
   options.protocol = "baidu_std";
   options.connection_type = "single";
   options.timeout_ms = FLAGS_pserver_timeout_ms;
+  SetRdmaOptions(&options);
 
   xpu_channels_.resize(xpu_list_.size());
   for (size_t i = 0; i < xpu_list_.size(); ++i) {
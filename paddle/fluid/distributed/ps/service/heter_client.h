@@ -91,6 +91,7 @@ class HeterClient {
     options.protocol = "baidu_std";
     options.connection_type = "single";
     options.timeout_ms = FLAGS_pserver_timeout_ms;
+    SetRdmaOptions(&options);
     std::vector<std::shared_ptr<brpc::Channel>>* client_channels = nullptr;
     if (peer_role == PEER_ROLE_IS_SWITCH) {
 #ifdef PADDLE_WITH_ARM_BRPC
@@ -31,6 +31,7 @@ void HeterServer::RegisterServiceHandler(std::string message_name,
 void HeterServer::StartHeterService(bool need_encrypt) {
   server_.AddService(&service_, brpc::SERVER_DOESNT_OWN_SERVICE);
   brpc::ServerOptions options;
+  SetRdmaOptions(&options);
   if (need_encrypt) {
     options.mutable_ssl_options()->default_cert.certificate = "/cert.pem";
     options.mutable_ssl_options()->default_cert.private_key = "/key.pem";
@@ -66,6 +67,7 @@ void HeterServer::StartHeterService(bool need_encrypt) {
 void HeterServer::StartHeterInterService(bool need_encrypt) {
   server_inter_.AddService(&service_, brpc::SERVER_DOESNT_OWN_SERVICE);
   brpc::ServerOptions options;
+  SetRdmaOptions(&options);
   if (need_encrypt) {
     options.mutable_ssl_options()->default_cert.certificate = "/cert.pem";
     options.mutable_ssl_options()->default_cert.private_key = "/key.pem";
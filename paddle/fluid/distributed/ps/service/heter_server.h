@@ -226,8 +226,13 @@ class SendAndRecvVariableHandler final : public ServiceHandlerBase {
     auto message_name = request->message_name();
     auto& request_io_buffer = cntl->request_attachment();
 
-    distributed::DeserializeFromMultiVarMsgAndIOBuf(
-        *request, &request_io_buffer, cpu_dev_ctx, &local_scope);
+    // only the micro id is needed to find the micro scope, the other
+    // variables are deserialized into the micro scope directly
+    distributed::DeserializeVarFromMultiVarMsgAndIOBuf(*request,
+                                                       &request_io_buffer,
+                                                       "microbatch_id",
+                                                       cpu_dev_ctx,
+                                                       &local_scope);
 
     auto* var = local_scope.FindVar("microbatch_id");
     PADDLE_ENFORCE_NE(var,
@@ -291,7 +296,7 @@ class SendAndRecvVariableHandler final : public ServiceHandlerBase {
                                                 response_var_names,
                                                 empty_var_names,
                                                 *dev_ctx_,
-                                                &local_scope,
+                                                micro_scope,
                                                 response,
                                                 &response_io_buffer);
     VLOG(4) << "Handle over";
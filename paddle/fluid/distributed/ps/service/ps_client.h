@@ -350,6 +350,30 @@ class PSClient {
     promise.set_value(-1);
     return fut;
   }
+  // Swaps the hot shards of a sparse table on the busy servers for the cold
+  // ones on the idle servers, until the busiest server has at most
+  // max_imbalance times the mean load or max_swaps swaps are done, and routes
+  // the keys of the table by the new layout. Called by one client while no
+  // client pulls or pushes the table, like Save and Shrink.
+  virtual std::future<int32_t> RebalanceSparseTable(
+      uint32_t table_id UNUSED,
+      double max_imbalance UNUSED,
+      size_t max_swaps UNUSED) {
+    VLOG(0) << "Did not implement";
+    std::promise<int32_t> promise;
+    std::future<int> fut = promise.get_future();
+    promise.set_value(-1);
+    return fut;
+  }
+  // Routes the keys of a sparse table by the layout on the servers, for the
+  // clients other than the one rebalancing the table.
+  virtual std::future<int32_t> PullSparseShardRoute(uint32_t table_id UNUSED) {
+    VLOG(0) << "Did not implement";
+    std::promise<int32_t> promise;
+    std::future<int> fut = promise.get_future();
+    promise.set_value(-1);
+    return fut;
+  }
   // add
   virtual std::shared_ptr<SparseShardValues> TakePassSparseReferedValues(
       const size_t &table_id UNUSED,
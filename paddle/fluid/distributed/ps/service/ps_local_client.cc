@@ -13,16 +13,31 @@
 // limitations under the License.
 
 #include "paddle/fluid/distributed/ps/service/ps_local_client.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/shm_sparse_table.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 
+PD_DEFINE_bool(pslocal_client_use_shm,
+               false,
+               "the trainers on a host share the MemorySparseTables in the "
+               "shared memory, which are created by the trainer 0");
+
 namespace paddle::distributed {
 int32_t PsLocalClient::Initialize() {
   const auto& downpour_param = _config.server_param().downpour_server_param();
   TableManager::Instance().Initialize();
   for (int i = 0; i < downpour_param.downpour_table_param_size(); ++i) {
-    auto* table = CREATE_PSCORE_CLASS(
-        Table, downpour_param.downpour_table_param(i).table_class());
+    std::string table_class =
+        downpour_param.downpour_table_param(i).table_class();
+    if (FLAGS_pslocal_client_use_shm && table_class == "MemorySparseTable") {
+      table_class = "ShmSparseTable";
+    }
+    auto* table = CREATE_PSCORE_CLASS(Table, table_class);
     table->SetShard(0, 1);
+    auto* shm_table = dynamic_cast<ShmSparseTable*>(table);
+    if (shm_table != nullptr) {
+      shm_table->SetOwner(_client_id == 0);
+    }
     table->Initialize(downpour_param.downpour_table_param(i),
                       _config.fs_client_param());
     _table_map[downpour_param.downpour_table_param(i).table_id()].reset(table);
@@ -223,6 +238,39 @@ int32_t PsLocalClient::Initialize() {
   return done();
 }
 
+::std::future<int32_t> PsLocalClient::PullSparse(float** select_values,
+                                                 size_t table_id,
+                                                 const uint64_t* keys,
+                                                 size_t num,
+                                                 bool is_training) {
+  auto* accessor = GetTableAccessor(table_id);
+  auto* table_ptr = GetTable(table_id);
+  size_t dim = accessor->GetAccessorInfo().select_dim;
+
+  std::vector<float> pull_buffer(num * dim);
+  PullSparseValue pull_value(num, dim);
+  pull_value.feasigns_ = const_cast<uint64_t*>(keys);
+  std::vector<uint32_t> frequencies(num, 1);
+  pull_value.frequencies_ = frequencies.data();
+  pull_value.is_training_ = is_training;
+
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = pull_value;
+  table_context.pull_context.values = pull_buffer.data();
+  table_context.num = num;
+  table_context.use_ptr = false;
+  int32_t ret = table_ptr->Pull(table_context);
+  for (size_t i = 0; i < num; ++i) {
+    memcpy(select_values[i], pull_buffer.data() + i * dim, dim * sizeof(float));
+  }
+
+  std::promise<int32_t> prom;
+  std::future<int32_t> fut = prom.get_future();
+  prom.set_value(ret);
+  return fut;
+}
+
 ::std::future<int32_t> PsLocalClient::PullSparsePtr(
     int shard_id,
     char** select_values,
@@ -0,0 +1,182 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/depends/sparse_tiering_policy.h"
+
+namespace paddle {
+namespace distributed {
+
+// A cache of the pulled values of the hot keys of a sparse table on a client,
+// so the pulls of the skewed keys are served without the servers:
+//  * Staleness: every pull of the table is a step, and a value pulled at step
+//    s is served until step s + max_staleness, then pulled again. So a cached
+//    value misses the pushes of at most max_staleness pulls.
+//  * Admission (TinyLFU) and eviction (CLOCK), as SparseTieringPolicy: a
+//    pulled key is cached if its shard is not full, or it is looked up more
+//    often than the key which the clock hand points to, which is replaced.
+//
+// It is thread safe. The keys are sharded, and each shard has its own lock.
+class SparsePullCache {
+ public:
+  SparsePullCache(size_t capacity, uint64_t max_staleness, size_t value_dim)
+      : _max_staleness(max_staleness), _value_dim(value_dim) {
+    size_t shard_capacity = capacity / kShardNum + 1;
+    for (auto& shard : _shards) {
+      shard.reset(new Shard(shard_capacity));
+    }
+  }
+
+  // Returns the step of a pull, which its Lookup and Insert are called with.
+  uint64_t NextStep() { return ++_step; }
+
+  // Copies the value of key into value and returns true if it is cached and
+  // not stale at step.
+  bool Lookup(uint64_t key, uint64_t step, float* value) {
+    auto& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.sketch.Increment(key);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end() ||
+        step >= shard.steps[it->second] + _max_staleness) {
+      ++_misses;
+      return false;
+    }
+    size_t slot = it->second;
+    shard.referenced[slot] = 1;
+    memcpy(value,
+           shard.values.data() + slot * _value_dim,
+           _value_dim * sizeof(float));
+    ++_hits;
+    return true;
+  }
+
+  // Caches the value of key pulled from the servers at step.
+  void Insert(uint64_t key, uint64_t step, const float* value) {
+    auto& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size_t slot = 0;
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      slot = it->second;
+      // the value of a later pull is already cached
+      if (step < shard.steps[slot]) {
+        return;
+      }
+    } else if (shard.keys.size() < shard.capacity) {
+      slot = shard.keys.size();
+      shard.keys.push_back(key);
+      shard.steps.push_back(0);
+      shard.referenced.push_back(0);
+      shard.values.resize(shard.values.size() + _value_dim);
+      shard.index[key] = slot;
+    } else {
+      // the reference bits are cleared as the hand passes them
+      while (shard.referenced[shard.hand]) {
+        shard.referenced[shard.hand] = 0;
+        shard.hand = (shard.hand + 1) % shard.capacity;
+      }
+      slot = shard.hand;
+      if (shard.sketch.Estimate(key) <=
+          shard.sketch.Estimate(shard.keys[slot])) {
+        ++_rejected;
+        return;
+      }
+      shard.hand = (shard.hand + 1) % shard.capacity;
+      shard.index.erase(shard.keys[slot]);
+      shard.keys[slot] = key;
+      shard.referenced[slot] = 0;
+      shard.index[key] = slot;
+    }
+    shard.steps[slot] = step;
+    memcpy(shard.values.data() + slot * _value_dim,
+           value,
+           _value_dim * sizeof(float));
+  }
+
+  // Drops all the cached values, e.g. after the table is loaded or cleared
+  // on the servers.
+  void Clear() {
+    for (auto& shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      shard->index.clear();
+      shard->keys.clear();
+      shard->steps.clear();
+      shard->referenced.clear();
+      shard->values.clear();
+      shard->hand = 0;
+    }
+  }
+
+  size_t Size() {
+    size_t size = 0;
+    for (auto& shard : _shards) {
+      std::lock_guard<std::mutex> lock(shard->mutex);
+      size += shard->keys.size();
+    }
+    return size;
+  }
+
+  uint64_t hits() const { return _hits; }
+  uint64_t misses() const { return _misses; }
+  // the pulled keys not cached by the admission
+  uint64_t rejected() const { return _rejected; }
+  double HitRatio() const {
+    uint64_t total = _hits + _misses;
+    return total == 0 ? 0 : static_cast<double>(_hits) / total;
+  }
+
+ private:
+  static constexpr size_t kShardNum = 16;
+
+  struct Shard {
+    explicit Shard(size_t capacity) : capacity(capacity), sketch(capacity) {}
+
+    std::mutex mutex;
+    size_t capacity;
+    size_t hand{0};
+    FrequencySketch sketch;
+    // key -> slot, and the key, the step, the reference bit and the value of
+    // the slots
+    std::unordered_map<uint64_t, size_t> index;
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> steps;
+    std::vector<uint8_t> referenced;
+    std::vector<float> values;
+  };
+
+  Shard& GetShard(uint64_t key) {
+    return *_shards[(key * 0x9E3779B97F4A7C15ULL) >> 60];
+  }
+
+  uint64_t _max_staleness;
+  size_t _value_dim;
+  std::atomic<uint64_t> _step{0};
+  std::atomic<uint64_t> _hits{0};
+  std::atomic<uint64_t> _misses{0};
+  std::atomic<uint64_t> _rejected{0};
+  std::unique_ptr<Shard> _shards[kShardNum];
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -839,6 +839,24 @@ int32_t GraphTable::dump_edges_to_ssd(int idx) {
   for (size_t i = 0; i < tasks.size(); i++) total_memory_cost += tasks[i].get();
   return 0;
 }
+int32_t GraphTable::dump_csr_graph(int idx, const std::string &path) {
+  std::vector<Node *> nodes;
+  for (auto &shard : edge_shards[idx]) {
+    std::vector<Node *> &bucket = shard->get_bucket();
+    nodes.insert(nodes.end(), bucket.begin(), bucket.end());
+  }
+  return CsrGraph::dump(nodes, is_weighted_, path);
+}
+
+int32_t GraphTable::load_csr_graph(int idx, const std::string &path) {
+  auto csr_graph = std::make_shared<CsrGraph>();
+  if (csr_graph->load(path) != 0) {
+    return -1;
+  }
+  csr_graphs_[idx] = csr_graph;
+  return 0;
+}
+
 int32_t GraphTable::make_complementary_graph(int idx, int64_t byte_size) {
   VLOG(0) << "make_complementary_graph";
   const size_t fixed_size = byte_size / 8;
@@ -1837,6 +1855,37 @@ Node *GraphShard::find_node(uint64_t id) {
   return iter == node_location.end() ? nullptr : bucket[iter->second];
 }
 
+void GraphShard::sample_neighbors(const uint64_t *ids,
+                                  size_t num,
+                                  int k,
+                                  const std::shared_ptr<std::mt19937_64> &rng,
+                                  std::vector<uint64_t> *neighbors,
+                                  std::vector<int> *actual_sizes) {
+  // find the nodes first to size the output once
+  std::vector<Node *> nodes(num);
+  size_t total_size = 0;
+  for (size_t i = 0; i < num; i++) {
+    nodes[i] = find_node(ids[i]);
+    if (nodes[i] != nullptr) {
+      total_size +=
+          std::min(static_cast<size_t>(k), nodes[i]->get_neighbor_size());
+    }
+  }
+  neighbors->clear();
+  neighbors->reserve(total_size);
+  actual_sizes->assign(num, 0);
+  for (size_t i = 0; i < num; i++) {
+    if (nodes[i] == nullptr || nodes[i]->get_neighbor_size() == 0) {
+      continue;
+    }
+    std::vector<int> res = nodes[i]->sample_k(k, rng);
+    for (int x : res) {
+      neighbors->push_back(nodes[i]->get_neighbor_id(x));
+    }
+    (*actual_sizes)[i] = res.size();
+  }
+}
+
 GraphTable::~GraphTable() {  // NOLINT
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   clear_graph();
@@ -2802,6 +2851,7 @@ int32_t GraphTable::random_sample_neighbors(
       std::vector<SampleResult> sample_res;
       std::vector<SampleKey> sample_keys;
       auto &rng = _shards_task_rng_pool[i];
+      CsrGraph *csr_graph = csr_graphs_[idx].get();
       for (size_t k = 0; k < id_list[i].size(); k++) {
         if (index < r.size() &&
             r[index].first.node_key == id_list[i][k].node_key) {
@@ -2829,6 +2879,17 @@ int32_t GraphTable::random_sample_neighbors(
             }
 #endif
             actual_size = 0;
+            if (csr_graph != nullptr) {
+              int64_t csr_index = csr_graph->find(node_id);
+              if (csr_index >= 0) {
+                char *buffer_addr = nullptr;
+                actual_size = csr_graph->sample(
+                    csr_index, sample_size, need_weight, rng, &buffer_addr);
+                if (actual_size != 0) {
+                  buffers[idy].reset(buffer_addr, char_del);
+                }
+              }
+            }
             continue;
           }
           std::shared_ptr<char> &buffer = buffers[idy];
@@ -3548,6 +3609,7 @@ int32_t GraphTable::Initialize(const GraphParameter &graph) {
   VLOG(0) << "in init graph table shard idx = " << _shard_idx << " shard_start "
           << shard_start << " shard_end " << shard_end;
   edge_shards.resize(id_to_edge.size());
+  csr_graphs_.resize(id_to_edge.size());
   node_weight.resize(2);
   node_weight[0].resize(id_to_edge.size());
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
@@ -41,6 +41,7 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/distributed/ps/thirdparty/round_robin.h"
 #include "paddle/phi/core/utils/rw_lock.h"
@@ -126,6 +127,15 @@ class GraphShard {
                                 bool is_overlap = true,
                                 int float_fea_num = 0);
   Node *find_node(uint64_t id);
+  // Samples k neighbors of each of the num nodes of ids in one call. The
+  // neighbor ids of the nodes go one after another into neighbors, and their
+  // numbers into actual_sizes, 0 for the nodes not in the shard.
+  void sample_neighbors(const uint64_t *ids,
+                        size_t num,
+                        int k,
+                        const std::shared_ptr<std::mt19937_64> &rng,
+                        std::vector<uint64_t> *neighbors,
+                        std::vector<int> *actual_sizes);
   void delete_node(uint64_t id);
   void clear();
   void add_neighbor(uint64_t id, uint64_t dst_id, float weight);
@@ -740,6 +750,11 @@ class GraphTable : public Table {
                                         std::vector<uint64_t> &ids);  // NOLINT
   int32_t make_complementary_graph(int idx, int64_t byte_size);
   int32_t dump_edges_to_ssd(int idx);
+  // Writes the neighbors of the edge type idx in the compressed csr format.
+  int32_t dump_csr_graph(int idx, const std::string &path);
+  // Maps the csr file of the edge type idx, the nodes not loaded in the
+  // shards are sampled from it.
+  int32_t load_csr_graph(int idx, const std::string &path);
   int32_t get_partition_num(int idx) { return partitions[idx].size(); }
   std::vector<int> slot_feature_num_map() const {
     return slot_feature_num_map_;
@@ -795,6 +810,7 @@ class GraphTable : public Table {
 
   std::vector<std::vector<GraphShard *>> edge_shards, feature_shards,
       node_shards;
+  std::vector<std::shared_ptr<CsrGraph>> csr_graphs_;
   size_t shard_start, shard_end, server_num, shard_num_per_server, shard_num;
   int task_pool_size_ = 64;
   int load_thread_num_ = 160;
@@ -0,0 +1,283 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/ctr_compressed_accessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "glog/logging.h"
+#include "paddle/fluid/distributed/common/local_random.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+uint16_t StochasticRoundToBFloat16(float x) {
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  // adding a random number below the dropped bits rounds up with the
+  // probability of their value
+  uint32_t noise = local_random_engine()() & 0xFFFF;
+  if ((bits & 0x7F800000) != 0x7F800000) {
+    bits += noise;
+  }
+  return static_cast<uint16_t>(bits >> 16);
+}
+
+}  // namespace
+
+int EmbeddingCodec::Dim() const {
+  switch (_type) {
+    case EMBEDDING_FP16:
+    case EMBEDDING_BF16:
+      return (_dim + 1) / 2;
+    case EMBEDDING_INT8:
+      return 1 + (_dim + 3) / 4;
+    default:
+      return _dim;
+  }
+}
+
+void EmbeddingCodec::Encode(const float* src,
+                            float* dst,
+                            bool stochastic_rounding) const {
+  switch (_type) {
+    case EMBEDDING_FP16: {
+      uint16_t* data = reinterpret_cast<uint16_t*>(dst);
+      for (int i = 0; i < _dim; ++i) {
+        data[i] = phi::dtype::float16(src[i]).x;
+      }
+      if (_dim % 2) {
+        data[_dim] = 0;
+      }
+      return;
+    }
+    case EMBEDDING_BF16: {
+      uint16_t* data = reinterpret_cast<uint16_t*>(dst);
+      for (int i = 0; i < _dim; ++i) {
+        data[i] = stochastic_rounding ? StochasticRoundToBFloat16(src[i])
+                                      : phi::dtype::bfloat16(src[i]).x;
+      }
+      if (_dim % 2) {
+        data[_dim] = 0;
+      }
+      return;
+    }
+    case EMBEDDING_INT8: {
+      float max_abs = 0;
+      for (int i = 0; i < _dim; ++i) {
+        max_abs = std::max(max_abs, std::fabs(src[i]));
+      }
+      float scale = max_abs / 127;
+      dst[0] = scale;
+      int8_t* data = reinterpret_cast<int8_t*>(dst + 1);
+      memset(data, 0, (Dim() - 1) * sizeof(float));
+      if (scale == 0) {
+        return;
+      }
+      for (int i = 0; i < _dim; ++i) {
+        float q = src[i] / scale;
+        q = stochastic_rounding ? std::floor(q + uniform_real<float>())
+                                : std::round(q);
+        data[i] = static_cast<int8_t>(std::min(127.0f, std::max(-127.0f, q)));
+      }
+      return;
+    }
+    default:
+      memcpy(dst, src, _dim * sizeof(float));
+      return;
+  }
+}
+
+void EmbeddingCodec::Decode(const float* src, float* dst) const {
+  switch (_type) {
+    case EMBEDDING_FP16: {
+      const uint16_t* data = reinterpret_cast<const uint16_t*>(src);
+      for (int i = 0; i < _dim; ++i) {
+        dst[i] =
+            static_cast<float>(phi::dtype::raw_uint16_to_float16(data[i]));
+      }
+      return;
+    }
+    case EMBEDDING_BF16: {
+      const uint16_t* data = reinterpret_cast<const uint16_t*>(src);
+      for (int i = 0; i < _dim; ++i) {
+        uint32_t bits = static_cast<uint32_t>(data[i]) << 16;
+        memcpy(dst + i, &bits, sizeof(float));
+      }
+      return;
+    }
+    case EMBEDDING_INT8: {
+      float scale = src[0];
+      const int8_t* data = reinterpret_cast<const int8_t*>(src + 1);
+      for (int i = 0; i < _dim; ++i) {
+        dst[i] = data[i] * scale;
+      }
+      return;
+    }
+    default:
+      memcpy(dst, src, _dim * sizeof(float));
+      return;
+  }
+}
+
+int CtrCompressedAccessor::Initialize() {
+  // the optimizer states, e.g. the moments of adam, span a range too wide for
+  // a scale per row
+  PADDLE_ENFORCE_NE(
+      _config.ctr_accessor_param().embedx_sgd_storage_type(),
+      EMBEDDING_INT8,
+      phi::errors::InvalidArgument(
+          "embedx_sgd_storage_type of CtrCompressedAccessor can not be "
+          "EMBEDDING_INT8, use EMBEDDING_FP16 or EMBEDDING_BF16 instead."));
+  CtrCommonAccessor::Initialize();
+  VLOG(0) << "CtrCompressedAccessor value dim: "
+          << compressed_feature_value.Dim()
+          << ", fp32 value dim: " << common_feature_value.Dim();
+  return 0;
+}
+
+void CtrCompressedAccessor::InitAccessorInfo() {
+  CtrCommonAccessor::InitAccessorInfo();
+  compressed_feature_value.embed_sgd_dim = common_feature_value.embed_sgd_dim;
+  compressed_feature_value.embedx_codec =
+      EmbeddingCodec(_config.ctr_accessor_param().embedx_storage_type(),
+                     common_feature_value.embedx_dim);
+  int compressible_dim = _embedx_sgd_rule->CompressibleDim();
+  compressed_feature_value.embedx_sgd_codec =
+      EmbeddingCodec(_config.ctr_accessor_param().embedx_sgd_storage_type(),
+                     compressible_dim);
+  compressed_feature_value.embedx_sgd_fp32_dim =
+      common_feature_value.embedx_sgd_dim - compressible_dim;
+
+  _accessor_info.dim = compressed_feature_value.Dim();
+  _accessor_info.size = compressed_feature_value.Size();
+  _accessor_info.mf_size = (compressed_feature_value.Dim() -
+                            compressed_feature_value.EmbedxWIndex()) *
+                           sizeof(float);
+}
+
+bool CtrCompressedAccessor::HasMF(int size) {
+  return size > compressed_feature_value.EmbedxWIndex();
+}
+
+void CtrCompressedAccessor::Decompress(const float* value,
+                                       size_t size,
+                                       float* fp32_value) {
+  size_t header_dim = compressed_feature_value.EmbedxWIndex();
+  memcpy(fp32_value, value, header_dim * sizeof(float));
+  if (size <= header_dim) {
+    return;
+  }
+  compressed_feature_value.embedx_codec.Decode(
+      value + compressed_feature_value.EmbedxWIndex(),
+      fp32_value + common_feature_value.EmbedxWIndex());
+  compressed_feature_value.embedx_sgd_codec.Decode(
+      value + compressed_feature_value.EmbedxG2SumIndex(),
+      fp32_value + common_feature_value.EmbedxG2SumIndex());
+  memcpy(fp32_value + common_feature_value.Dim() -
+             compressed_feature_value.embedx_sgd_fp32_dim,
+         value + compressed_feature_value.EmbedxSGDFp32Index(),
+         compressed_feature_value.embedx_sgd_fp32_dim * sizeof(float));
+}
+
+void CtrCompressedAccessor::Compress(const float* fp32_value,
+                                     size_t size,
+                                     float* value,
+                                     bool stochastic_rounding) {
+  size_t header_dim = compressed_feature_value.EmbedxWIndex();
+  memcpy(value, fp32_value, header_dim * sizeof(float));
+  if (size <= header_dim) {
+    return;
+  }
+  compressed_feature_value.embedx_codec.Encode(
+      fp32_value + common_feature_value.EmbedxWIndex(),
+      value + compressed_feature_value.EmbedxWIndex(),
+      stochastic_rounding);
+  compressed_feature_value.embedx_sgd_codec.Encode(
+      fp32_value + common_feature_value.EmbedxG2SumIndex(),
+      value + compressed_feature_value.EmbedxG2SumIndex(),
+      stochastic_rounding);
+  memcpy(value + compressed_feature_value.EmbedxSGDFp32Index(),
+         fp32_value + common_feature_value.Dim() -
+             compressed_feature_value.embedx_sgd_fp32_dim,
+         compressed_feature_value.embedx_sgd_fp32_dim * sizeof(float));
+}
+
+int32_t CtrCompressedAccessor::Create(float** values, size_t num) {
+  size_t dim = compressed_feature_value.Dim();
+  float fp32_value[common_feature_value.Dim()];  // NOLINT
+  float* fp32_value_ptr = fp32_value;
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    CtrCommonAccessor::Create(&fp32_value_ptr, 1);
+    Compress(fp32_value, dim, values[value_item], false);
+  }
+  return 0;
+}
+
+// from CompressedFeatureValue to CtrCommonPullValue
+int32_t CtrCompressedAccessor::Select(float** select_values,
+                                      const float** values,
+                                      size_t num) {
+  size_t dim = compressed_feature_value.Dim();
+  float fp32_value[common_feature_value.Dim()];  // NOLINT
+  const float* fp32_value_ptr = fp32_value;
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    Decompress(values[value_item], dim, fp32_value);
+    CtrCommonAccessor::Select(select_values + value_item, &fp32_value_ptr, 1);
+  }
+  return 0;
+}
+
+// from CtrCommonPushValue to CompressedFeatureValue
+int32_t CtrCompressedAccessor::Update(float** update_values,
+                                      const float** push_values,
+                                      size_t num) {
+  size_t dim = compressed_feature_value.Dim();
+  float fp32_value[common_feature_value.Dim()];  // NOLINT
+  float* fp32_value_ptr = fp32_value;
+  for (size_t value_item = 0; value_item < num; ++value_item) {
+    Decompress(update_values[value_item], dim, fp32_value);
+    CtrCommonAccessor::Update(&fp32_value_ptr, push_values + value_item, 1);
+    Compress(fp32_value, dim, update_values[value_item], true);
+  }
+  return 0;
+}
+
+std::string CtrCompressedAccessor::ParseToString(const float* v, int param) {
+  float fp32_value[common_feature_value.Dim()];  // NOLINT
+  Decompress(v, param, fp32_value);
+  if (HasMF(param)) {
+    param = common_feature_value.Dim();
+  }
+  return CtrCommonAccessor::ParseToString(fp32_value, param);
+}
+
+int CtrCompressedAccessor::ParseFromString(const std::string& str,
+                                           float* value) {
+  float fp32_value[common_feature_value.Dim()];  // NOLINT
+  int ret = CtrCommonAccessor::ParseFromString(str, fp32_value);
+  if (HasMF(ret)) {
+    ret = compressed_feature_value.Dim();
+  }
+  Compress(fp32_value, ret, value, false);
+  return ret;
+}
+
+}  // namespace paddle::distributed
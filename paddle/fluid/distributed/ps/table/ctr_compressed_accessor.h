@@ -0,0 +1,126 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stdint.h>
+
+#include <string>
+
+#include "paddle/fluid/distributed/ps/table/ctr_accessor.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle {
+namespace distributed {
+
+// Packs a row of dim floats into the floats of a feature value:
+//  * EMBEDDING_FP32: dim floats, as is.
+//  * EMBEDDING_FP16 / EMBEDDING_BF16: 2 values per float.
+//  * EMBEDDING_INT8: a fp32 scale, max(|x|) / 127, followed by 4 values per
+//    float.
+// With stochastic rounding, a value is rounded up with the probability of its
+// distance to the lower one, so the small updates of the sgd rules are kept
+// in expectation instead of being rounded away. It is used by bf16 and int8,
+// whose precision is too low for the updates; fp16 is rounded to nearest.
+class EmbeddingCodec {
+ public:
+  EmbeddingCodec() = default;
+  EmbeddingCodec(EmbeddingStorageType type, int dim)
+      : _type(type), _dim(dim) {}
+
+  EmbeddingStorageType type() const { return _type; }
+  // the number of floats of the encoded row
+  int Dim() const;
+  void Encode(const float* src, float* dst, bool stochastic_rounding) const;
+  void Decode(const float* src, float* dst) const;
+
+ private:
+  EmbeddingStorageType _type = EMBEDDING_FP32;
+  int _dim = 0;
+};
+
+// CtrCommonAccessor with the embedx values, embedx_w and optionally the
+// states of the embedx sgd rule per dimension, compressed by
+// embedx_storage_type and embedx_sgd_storage_type of CtrAccessorParameter.
+// The other fields are kept in fp32 at the same indices, so Shrink, Save and
+// the others are inherited.
+//
+// The values are decompressed into a fp32 CtrCommonFeatureValue for Select
+// and Update, and compressed again after Update. The text format of
+// ParseToString / ParseFromString is that of CtrCommonAccessor, so a model
+// saved by either accessor can be loaded by the other.
+//
+// NOTE: PullSparsePtr hands the stored values to the client directly, so the
+// tables using it, e.g. those of the gpu ps, can not use this accessor.
+class CtrCompressedAccessor : public CtrCommonAccessor {
+ public:
+  struct CtrCompressedFeatureValue {
+    /*
+       float slot;
+       float unseen_days;
+       float delta_score;
+       float show;
+       float click;
+       float embed_w;
+       std::vector<float> embed_g2sum;
+       encoded embedx_w;
+       encoded embedx_g2sum[compressible_dim];
+       std::vector<float> embedx_g2sum[embedx_sgd_dim - compressible_dim];
+       */
+
+    int Dim() { return EmbedxSGDFp32Index() + embedx_sgd_fp32_dim; }
+    int Size() { return Dim() * sizeof(float); }
+    int EmbedxWIndex() { return 6 + embed_sgd_dim; }
+    int EmbedxG2SumIndex() { return EmbedxWIndex() + embedx_codec.Dim(); }
+    // the states of the embedx sgd rule kept in fp32
+    int EmbedxSGDFp32Index() {
+      return EmbedxG2SumIndex() + embedx_sgd_codec.Dim();
+    }
+
+    int embed_sgd_dim;
+    int embedx_sgd_fp32_dim;
+    EmbeddingCodec embedx_codec;
+    // the compressible states of the embedx sgd rule, see
+    // SparseValueSGDRule::CompressibleDim
+    EmbeddingCodec embedx_sgd_codec;
+  };
+
+  CtrCompressedAccessor() {}
+  virtual ~CtrCompressedAccessor() {}
+  int Initialize() override;
+  void InitAccessorInfo() override;
+  bool HasMF(int size) override;
+  int32_t Create(float** value, size_t num) override;
+  int32_t Select(float** select_values,
+                 const float** values,
+                 size_t num) override;
+  int32_t Update(float** values,
+                 const float** update_values,
+                 size_t num) override;
+  std::string ParseToString(const float* value, int param) override;
+  int32_t ParseFromString(const std::string& str, float* v) override;
+
+  // Converts between a compressed value of size floats and a fp32
+  // CtrCommonFeatureValue. The embedx values are converted only if size
+  // includes them.
+  void Decompress(const float* value, size_t size, float* fp32_value);
+  void Compress(const float* fp32_value,
+                size_t size,
+                float* value,
+                bool stochastic_rounding);
+
+  CtrCompressedFeatureValue compressed_feature_value;
+};
+
+}  // namespace distributed
+}  // namespace paddle
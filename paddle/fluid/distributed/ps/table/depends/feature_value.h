@@ -14,12 +14,15 @@
 
 #pragma once
 
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <mct/hash-map.hpp>
 
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/chunk_allocator.h"
+#include "paddle/fluid/distributed/ps/table/depends/flat_hash_map.h"
 
 namespace paddle {
 namespace distributed {
@@ -27,6 +30,10 @@ namespace distributed {
 static const int CTR_SPARSE_SHARD_BUCKET_NUM_BITS = 6;
 static const size_t CTR_SPARSE_SHARD_BUCKET_NUM =
     static_cast<size_t>(1) << CTR_SPARSE_SHARD_BUCKET_NUM_BITS;
+// How many keys ahead of the current one a batched lookup prefetches.
+static const size_t CTR_SPARSE_SHARD_PREFETCH_DISTANCE = 8;
+// How many in place updates of a push are handed to the accessor at once.
+static const size_t CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE = 64;
 
 class FixedFeatureValue {
  public:
@@ -41,11 +48,23 @@ class FixedFeatureValue {
   std::vector<float> _data;
 };
 
-template <class KEY, class VALUE>
+template <class MAP, class = void>
+struct IsPrefetchableMap : std::false_type {};
+
+template <class MAP>
+struct IsPrefetchableMap<MAP,
+                         std::void_t<decltype(std::declval<const MAP&>()
+                                                  .prefetch_with_hash(0))>>
+    : std::true_type {};
+
+// MAP is the hash map of each bucket from KEY to the pointer of VALUE, which
+// has the interface of mct::closed_hash_map used below.
+template <class KEY,
+          class VALUE,
+          class MAP = mct::closed_hash_map<KEY, mct::Pointer, std::hash<KEY>>>
 struct alignas(64) SparseTableShard {
  public:
-  typedef typename mct::closed_hash_map<KEY, mct::Pointer, std::hash<KEY>>
-      map_type;
+  typedef MAP map_type;
   struct iterator {
     typename map_type::iterator it;
     size_t bucket;
@@ -185,6 +204,14 @@ struct alignas(64) SparseTableShard {
     quick_erase(it);
     return 1;
   }
+  // Prefetches the slots of key, so that the cache misses of a batch of
+  // lookups overlap. It does nothing if the map can not prefetch.
+  void prefetch(const KEY& key) {
+    if constexpr (IsPrefetchableMap<map_type>::value) {
+      size_t hash = _hasher(key);
+      _buckets[compute_bucket(hash)].prefetch_with_hash(hash);
+    }
+  }
   size_t compute_bucket(size_t hash) {
     if (CTR_SPARSE_SHARD_BUCKET_NUM == 1) {
       return 0;
@@ -199,5 +226,11 @@ struct alignas(64) SparseTableShard {
   std::hash<KEY> _hasher;
 };
 
+// The shard whose buckets are FlatHashMap, which keeps the keys and the value
+// pointers of a bucket in one array and probes them by the control bytes.
+template <class KEY, class VALUE>
+using FlatSparseTableShard =
+    SparseTableShard<KEY, VALUE, FlatHashMap<KEY, mct::Pointer>>;
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,374 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace paddle {
+namespace distributed {
+
+// An open addressing hash map whose slots are kept in one contiguous array.
+// Each slot has a control byte, which is kEmpty, kDeleted or the low 7 bits
+// of the hash of its key. A lookup compares the control bytes of a group of
+// 16 slots at once, by SSE2 if available, and only compares the keys of the
+// slots whose control bytes match, so a hit usually touches one cache line of
+// the control bytes and one of the slots.
+//
+// It provides the subset of the interface of mct::closed_hash_map used by
+// SparseTableShard. The hash passed to find_with_hash and insert_with_hash
+// must be HASH()(key). Like mct::closed_hash_map, an insertion invalidates
+// the iterators and the references when it grows the map.
+template <class KEY,
+          class VALUE,
+          class HASH = std::hash<KEY>,
+          class ALLOC = std::allocator<std::pair<KEY, VALUE>>>
+class FlatHashMap {
+ public:
+  typedef KEY key_type;
+  typedef VALUE mapped_type;
+  typedef std::pair<KEY, VALUE> value_type;
+
+  static constexpr size_t kGroupWidth = 16;
+
+  class iterator {
+   public:
+    iterator() = default;
+    value_type& operator*() const { return *slot_; }
+    value_type* operator->() const { return slot_; }
+    iterator& operator++() {
+      ++ctrl_;
+      ++slot_;
+      SkipEmptySlots();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.slot_ == b.slot_;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return a.slot_ != b.slot_;
+    }
+
+   private:
+    friend class FlatHashMap;
+    iterator(const int8_t* ctrl, value_type* slot, const int8_t* ctrl_end)
+        : ctrl_(ctrl), slot_(slot), ctrl_end_(ctrl_end) {}
+    void SkipEmptySlots() {
+      while (ctrl_ != ctrl_end_ && *ctrl_ < 0) {
+        ++ctrl_;
+        ++slot_;
+      }
+    }
+
+    const int8_t* ctrl_{nullptr};
+    value_type* slot_{nullptr};
+    const int8_t* ctrl_end_{nullptr};
+  };
+
+  FlatHashMap() = default;
+  FlatHashMap(const FlatHashMap&) = delete;
+  FlatHashMap& operator=(const FlatHashMap&) = delete;
+  ~FlatHashMap() { Release(); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t bucket_count() const { return capacity_; }
+  // The bytes of the control bytes and the slots.
+  size_t memory_size() const {
+    return capacity_ * (sizeof(int8_t) + sizeof(value_type));
+  }
+
+  void max_load_factor(float x) {
+    max_load_factor_ = x < 0.25f ? 0.25f : (x > 0.9375f ? 0.9375f : x);
+    size_t max_load = MaxLoad(capacity_);
+    growth_left_ =
+        max_load > size_ + deleted_ ? max_load - size_ - deleted_ : 0;
+  }
+
+  iterator begin() {
+    iterator it(ctrl_, slots_, ctrl_ + capacity_);
+    it.SkipEmptySlots();
+    return it;
+  }
+  iterator end() {
+    return iterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_);
+  }
+
+  iterator find(const KEY& key) { return find_with_hash(key, hasher_(key)); }
+
+  iterator find_with_hash(const KEY& key, size_t hash) {
+    if (capacity_ == 0) {
+      return end();
+    }
+    size_t mixed = Mix(hash);
+    int8_t h2 = H2(mixed);
+    size_t group_mask = capacity_ / kGroupWidth - 1;
+    size_t group = H1(mixed) & group_mask;
+    for (size_t step = 1;; ++step) {
+      size_t offset = group * kGroupWidth;
+      uint32_t match = MatchByte(ctrl_ + offset, h2);
+      while (match != 0) {
+        size_t index = offset + CountTrailingZeros(match);
+        if (slots_[index].first == key) {
+          return MakeIterator(index);
+        }
+        match &= match - 1;
+      }
+      if (MatchByte(ctrl_ + offset, kEmpty) != 0 || step > group_mask) {
+        return end();
+      }
+      // the triangular probing visits all the groups
+      group = (group + step) & group_mask;
+    }
+  }
+
+  // Prefetches the first group of the slots of hash.
+  void prefetch_with_hash(size_t hash) const {
+#if defined(__GNUC__)
+    if (capacity_ != 0) {
+      size_t offset =
+          (H1(Mix(hash)) & (capacity_ / kGroupWidth - 1)) * kGroupWidth;
+      __builtin_prefetch(ctrl_ + offset);
+      __builtin_prefetch(slots_ + offset);
+    }
+#endif
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return insert_with_hash(value, hasher_(value.first));
+  }
+
+  std::pair<iterator, bool> insert_with_hash(const value_type& value,
+                                             size_t hash) {
+    auto it = find_with_hash(value.first, hash);
+    if (it != end()) {
+      return {it, false};
+    }
+    if (growth_left_ == 0) {
+      Grow();
+    }
+    size_t mixed = Mix(hash);
+    size_t index = FindInsertSlot(mixed);
+    if (ctrl_[index] == kEmpty) {
+      --growth_left_;
+    } else {
+      --deleted_;
+    }
+    ctrl_[index] = H2(mixed);
+    SlotTraits::construct(slot_alloc_, slots_ + index, value);
+    ++size_;
+    return {MakeIterator(index), true};
+  }
+
+  iterator erase(iterator it) {
+    iterator next = it;
+    ++next;
+    quick_erase(it);
+    return next;
+  }
+
+  void quick_erase(iterator it) {
+    size_t index = it.slot_ - slots_;
+    SlotTraits::destroy(slot_alloc_, slots_ + index);
+    --size_;
+    // A lookup stops at the first group having an empty slot, so the slot can
+    // be emptied only if its group has not been full, otherwise the keys
+    // probed past the group would be lost.
+    size_t offset = index / kGroupWidth * kGroupWidth;
+    if (MatchByte(ctrl_ + offset, kEmpty) != 0) {
+      ctrl_[index] = kEmpty;
+      ++growth_left_;
+    } else {
+      ctrl_[index] = kDeleted;
+      ++deleted_;
+    }
+  }
+
+  size_t erase(const KEY& key) {
+    auto it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    quick_erase(it);
+    return 1;
+  }
+
+  void clear() { Release(); }
+
+ private:
+  typedef std::allocator_traits<ALLOC> SlotTraits;
+  typedef typename SlotTraits::template rebind_alloc<int8_t> CtrlAlloc;
+  typedef std::allocator_traits<CtrlAlloc> CtrlTraits;
+
+  static constexpr int8_t kEmpty = -128;
+  static constexpr int8_t kDeleted = -2;
+
+  // The hash of std::hash<uint64_t> is the key itself, and SparseTableShard
+  // selects the bucket by its highest bits, so the hash is mixed here.
+  static size_t Mix(size_t hash) {
+    uint64_t h = hash;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+  static size_t H1(size_t mixed) { return mixed >> 7; }
+  static int8_t H2(size_t mixed) { return static_cast<int8_t>(mixed & 0x7F); }
+
+  static uint32_t CountTrailingZeros(uint32_t x) {
+    return static_cast<uint32_t>(__builtin_ctz(x));
+  }
+
+  // Returns the bit mask of the control bytes equal to byte in the group.
+  static uint32_t MatchByte(const int8_t* group, int8_t byte) {
+#if defined(__SSE2__)
+    __m128i ctrl =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));  // NOLINT
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(byte), ctrl)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+  }
+
+  // Returns the bit mask of the kEmpty and kDeleted control bytes, whose sign
+  // bits are set, in the group.
+  static uint32_t MatchEmptyOrDeleted(const int8_t* group) {
+#if defined(__SSE2__)
+    __m128i ctrl =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));  // NOLINT
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint32_t>(group[i] < 0) << i;
+    }
+    return mask;
+#endif
+  }
+
+  size_t MaxLoad(size_t capacity) const {
+    return static_cast<size_t>(capacity * max_load_factor_);
+  }
+
+  iterator MakeIterator(size_t index) {
+    return iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_);
+  }
+
+  size_t FindInsertSlot(size_t mixed) const {
+    size_t group_mask = capacity_ / kGroupWidth - 1;
+    size_t group = H1(mixed) & group_mask;
+    for (size_t step = 1;; ++step) {
+      size_t offset = group * kGroupWidth;
+      uint32_t match = MatchEmptyOrDeleted(ctrl_ + offset);
+      if (match != 0) {
+        return offset + CountTrailingZeros(match);
+      }
+      group = (group + step) & group_mask;
+    }
+  }
+
+  // Doubles the capacity, or rehashes at the same capacity to drop the
+  // deleted slots if most of the used slots are deleted.
+  void Grow() {
+    size_t capacity = capacity_ == 0 ? kGroupWidth : capacity_ * 2;
+    if (capacity_ != 0 && size_ * 2 <= MaxLoad(capacity_)) {
+      capacity = capacity_;
+    }
+    while (MaxLoad(capacity) <= size_) {
+      capacity *= 2;
+    }
+    Rehash(capacity);
+  }
+
+  void Rehash(size_t capacity) {
+    int8_t* old_ctrl = ctrl_;
+    value_type* old_slots = slots_;
+    size_t old_capacity = capacity_;
+
+    ctrl_ = CtrlTraits::allocate(ctrl_alloc_, capacity);
+    slots_ = SlotTraits::allocate(slot_alloc_, capacity);
+    std::memset(ctrl_, kEmpty, capacity);
+    capacity_ = capacity;
+    deleted_ = 0;
+    growth_left_ = MaxLoad(capacity) - size_;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] < 0) {
+        continue;
+      }
+      size_t mixed = Mix(hasher_(old_slots[i].first));
+      size_t index = FindInsertSlot(mixed);
+      ctrl_[index] = H2(mixed);
+      SlotTraits::construct(
+          slot_alloc_, slots_ + index, std::move(old_slots[i]));
+      SlotTraits::destroy(slot_alloc_, old_slots + i);
+    }
+    if (old_capacity != 0) {
+      CtrlTraits::deallocate(ctrl_alloc_, old_ctrl, old_capacity);
+      SlotTraits::deallocate(slot_alloc_, old_slots, old_capacity);
+    }
+  }
+
+  void Release() {
+    if (capacity_ == 0) {
+      return;
+    }
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] >= 0) {
+        SlotTraits::destroy(slot_alloc_, slots_ + i);
+      }
+    }
+    CtrlTraits::deallocate(ctrl_alloc_, ctrl_, capacity_);
+    SlotTraits::deallocate(slot_alloc_, slots_, capacity_);
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    deleted_ = 0;
+    growth_left_ = 0;
+  }
+
+  int8_t* ctrl_{nullptr};
+  value_type* slots_{nullptr};
+  size_t capacity_{0};  // a power of 2, and a multiple of kGroupWidth
+  size_t size_{0};
+  size_t deleted_{0};
+  // the number of the empty slots which can be used before growing
+  size_t growth_left_{0};
+  float max_load_factor_{0.875f};
+  HASH hasher_;
+  ALLOC slot_alloc_;
+  CtrlAlloc ctrl_alloc_;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -16,11 +16,16 @@
 
 #include <ThreadPool.h>
 
+#include <algorithm>
+#include <cmath>
 #include <future>  // NOLINT
 #include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "glog/logging.h"
+
 namespace paddle {
 namespace distributed {
 
@@ -87,5 +92,84 @@ class GeoRecorder {
   std::vector<std::unique_ptr<ConcurrentSet>> trainer_rows_;
 };
 
+// The trainer side of the adaptive geo mode. Every round a trainer pushes
+// the deltas of the keys of the largest ones, top_ratio of the candidates,
+// of those above threshold and of those held back for max_delay rounds. The
+// others wait for a later round, their deltas keep accumulating in the
+// trainer meanwhile.
+class GeoDeltaRecorder {
+ public:
+  GeoDeltaRecorder(float top_ratio, float threshold, int max_delay)
+      : top_ratio_(top_ratio), threshold_(threshold), max_delay_(max_delay) {}
+
+  ~GeoDeltaRecorder() = default;
+
+  // Adds the keys held back to the ones touched in the round.
+  void Merge(std::vector<int64_t>* ids) const {
+    std::unordered_set<int64_t> touched(ids->begin(), ids->end());
+    for (auto& iter : held_) {
+      if (touched.count(iter.first) == 0) {
+        ids->push_back(iter.first);
+      }
+    }
+  }
+
+  // Keeps in ids the keys to push, given the magnitudes of their deltas, and
+  // holds back the others. The keys with no delta are dropped.
+  void Select(std::vector<int64_t>* ids,
+              const std::vector<float>& magnitudes) {
+    size_t num = ids->size();
+    size_t top_num =
+        std::min(num, static_cast<size_t>(std::ceil(top_ratio_ * num)));
+    std::vector<bool> top(num, false);
+    if (top_num == num) {
+      top.assign(num, true);
+    } else if (top_num > 0) {
+      std::vector<size_t> order(num);
+      for (size_t i = 0; i < num; ++i) {
+        order[i] = i;
+      }
+      std::nth_element(order.begin(),
+                       order.begin() + top_num - 1,
+                       order.end(),
+                       [&magnitudes](size_t a, size_t b) {
+                         return magnitudes[a] > magnitudes[b];
+                       });
+      for (size_t i = 0; i < top_num; ++i) {
+        top[order[i]] = true;
+      }
+    }
+
+    size_t pushed = 0;
+    for (size_t i = 0; i < num; ++i) {
+      int64_t id = (*ids)[i];
+      auto iter = held_.find(id);
+      int delay = iter == held_.end() ? 0 : iter->second;
+      if (magnitudes[i] > 0 &&
+          (top[i] || magnitudes[i] > threshold_ || delay + 1 >= max_delay_)) {
+        (*ids)[pushed++] = id;
+      } else if (magnitudes[i] > 0) {
+        held_[id] = delay + 1;
+        continue;
+      }
+      if (iter != held_.end()) {
+        held_.erase(iter);
+      }
+    }
+    VLOG(3) << "GeoDeltaRecorder pushes " << pushed << " of " << num
+            << " keys, holds back " << held_.size();
+    ids->resize(pushed);
+  }
+
+  size_t HeldSize() const { return held_.size(); }
+
+ private:
+  const float top_ratio_;
+  const float threshold_;
+  const int max_delay_;
+  // the keys held back and the numbers of rounds they were
+  std::unordered_map<int64_t, int> held_;
+};
+
 }  // namespace distributed
 }  // namespace paddle
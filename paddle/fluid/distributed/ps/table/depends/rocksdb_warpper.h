@@ -20,13 +20,20 @@
 #include <rocksdb/options.h>
 #include <rocksdb/perf_context.h>
 #include <rocksdb/perf_level.h>
+#include <rocksdb/rate_limiter.h>
 #include <rocksdb/slice.h>
 #include <rocksdb/slice_transform.h>
 #include <rocksdb/table.h>
 #include <rocksdb/write_batch.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace paddle {
 namespace distributed {
@@ -80,79 +87,128 @@ class RocksDBCtx {
   int cur_index;
 };
 
+// The knobs of the rocksdb behind a sparse table.
+struct RocksDBOptions {
+  // the block cache shared by all the shards, and the part of it kept for
+  // the index and filter blocks, which are looked up by every read
+  int64_t block_cache_mb{512};
+  double filter_cache_ratio{0.2};
+  // the bytes per second of the compactions and flushes: the max one when
+  // there is no pull, going down to the min one as the keys read per second
+  // by the pulls go up to pull_peak_keys_per_sec. 0 disables the limit.
+  int64_t compaction_max_mb_per_sec{256};
+  int64_t compaction_min_mb_per_sec{16};
+  int64_t pull_peak_keys_per_sec{1000000};
+  int64_t rate_window_ms{1000};
+};
+
+// The shards of a table are the column families of one db, which share its
+// block cache, its background threads and the rate limiter of their
+// compactions.
 class RocksDBHandler {
  public:
   RocksDBHandler() {}
-  ~RocksDBHandler() {}
+  ~RocksDBHandler() { close(); }
 
   static RocksDBHandler* GetInstance() {
     static RocksDBHandler handler;
     return &handler;
   }
 
-  int initialize(const std::string& db_path, const int colnum) {
+  int initialize(const std::string& db_path,
+                 const int colnum,
+                 const RocksDBOptions& db_options = RocksDBOptions()) {
     VLOG(0) << "db path: " << db_path << " colnum: " << colnum;
-    _dbs.resize(colnum);
-    for (int i = 0; i < colnum; i++) {
-      rocksdb::Options options;
-      options.comparator = &_comparator;
-      rocksdb::BlockBasedTableOptions bbto;
-      // options.memtable_factory.reset(rocksdb::NewHashSkipListRepFactory(65536));
-      // options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(2));
-      bbto.format_version = 5;
-      bbto.use_delta_encoding = false;
-      bbto.block_size = 4 * 1024;
-      bbto.block_restart_interval = 6;
-      bbto.block_cache = rocksdb::NewLRUCache(64 * 1024 * 1024);
-      // bbto.block_cache_compressed = rocksdb::NewLRUCache(64 * 1024 * 1024);
-      bbto.cache_index_and_filter_blocks = false;
-      bbto.filter_policy.reset(rocksdb::NewBloomFilterPolicy(15, false));
-      bbto.whole_key_filtering = true;
-      options.statistics = rocksdb::CreateDBStatistics();
-      options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbto));
+    close();
+    _db_options = db_options;
+    rocksdb::Options options;
+    options.comparator = &_comparator;
+    rocksdb::BlockBasedTableOptions bbto;
+    // options.memtable_factory.reset(rocksdb::NewHashSkipListRepFactory(65536));
+    // the keys start with a uint64 feasign, on which the memtables and the
+    // sst files keep a prefix bloom filter
+    options.prefix_extractor.reset(
+        rocksdb::NewFixedPrefixTransform(sizeof(uint64_t)));
+    bbto.format_version = 5;
+    bbto.use_delta_encoding = false;
+    bbto.block_size = 4 * 1024;
+    bbto.block_restart_interval = 6;
+    bbto.block_cache =
+        rocksdb::NewLRUCache(db_options.block_cache_mb * 1024 * 1024,
+                             -1,
+                             false,
+                             db_options.filter_cache_ratio);
+    // bbto.block_cache_compressed = rocksdb::NewLRUCache(64 * 1024 * 1024);
+    bbto.cache_index_and_filter_blocks = true;
+    bbto.cache_index_and_filter_blocks_with_high_priority = true;
+    bbto.pin_l0_filter_and_index_blocks_in_cache = true;
+    bbto.filter_policy.reset(rocksdb::NewBloomFilterPolicy(15, false));
+    bbto.whole_key_filtering = true;
+    options.statistics = rocksdb::CreateDBStatistics();
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbto));
 
-      // options.IncreaseParallelism();
-      options.OptimizeLevelStyleCompaction();
-      options.keep_log_file_num = 100;
-      // options.db_log_dir = "./log/rocksdb";
-      options.max_log_file_size = 50 * 1024 * 1024;  // 50MB
-      // options.threads = 8;
-      options.create_if_missing = true;
-      options.use_direct_reads = true;
-      options.max_background_flushes = 37;
-      options.max_background_compactions = 64;
-      options.base_background_compactions = 10;
-      options.write_buffer_size = 256 * 1024 * 1024;  // 256MB
-      options.max_write_buffer_number = 8;
-      options.max_bytes_for_level_base =
-          options.max_write_buffer_number * options.write_buffer_size;
-      options.min_write_buffer_number_to_merge = 1;
-      options.target_file_size_base = 1024 * 1024 * 1024;  // 1024MB
-      // options.verify_checksums_in_compaction = false;
-      // options.disable_auto_compactions = true;
-      options.memtable_prefix_bloom_size_ratio = 0.02;
-      options.num_levels = 4;
-      options.max_open_files = -1;
+    // options.IncreaseParallelism();
+    options.OptimizeLevelStyleCompaction();
+    options.keep_log_file_num = 100;
+    // options.db_log_dir = "./log/rocksdb";
+    options.max_log_file_size = 50 * 1024 * 1024;  // 50MB
+    // options.threads = 8;
+    options.create_if_missing = true;
+    options.create_missing_column_families = true;
+    options.use_direct_reads = true;
+    options.max_background_flushes = 37;
+    options.max_background_compactions = 64;
+    options.base_background_compactions = 10;
+    options.write_buffer_size = 256 * 1024 * 1024;  // 256MB
+    options.max_write_buffer_number = 8;
+    options.max_bytes_for_level_base =
+        options.max_write_buffer_number * options.write_buffer_size;
+    options.min_write_buffer_number_to_merge = 1;
+    options.target_file_size_base = 1024 * 1024 * 1024;  // 1024MB
+    // options.verify_checksums_in_compaction = false;
+    // options.disable_auto_compactions = true;
+    options.memtable_prefix_bloom_size_ratio = 0.02;
+    options.num_levels = 4;
+    options.max_open_files = -1;
 
-      options.compression = rocksdb::kNoCompression;
-      // options.compaction_options_fifo = rocksdb::CompactionOptionsFIFO();
-      // options.compaction_style =
-      // rocksdb::CompactionStyle::kCompactionStyleFIFO;
-      options.level0_file_num_compaction_trigger = 5;
-      options.level0_slowdown_writes_trigger =
-          1.8 * options.level0_file_num_compaction_trigger;
-      options.level0_stop_writes_trigger =
-          3.6 * options.level0_file_num_compaction_trigger;
+    options.compression = rocksdb::kNoCompression;
+    // options.compaction_options_fifo = rocksdb::CompactionOptionsFIFO();
+    // options.compaction_style =
+    // rocksdb::CompactionStyle::kCompactionStyleFIFO;
+    options.level0_file_num_compaction_trigger = 5;
+    options.level0_slowdown_writes_trigger =
+        1.8 * options.level0_file_num_compaction_trigger;
+    options.level0_stop_writes_trigger =
+        3.6 * options.level0_file_num_compaction_trigger;
 
-      std::string shard_path = db_path + "_" + std::to_string(i);
-      if (!shard_path.empty()) {
-        std::string rm_cmd = "rm -rf " + shard_path;
-        system(rm_cmd.c_str());
-      }
+    if (db_options.compaction_max_mb_per_sec > 0) {
+      _rate_limiter.reset(rocksdb::NewGenericRateLimiter(
+          db_options.compaction_max_mb_per_sec * 1024 * 1024));
+      options.rate_limiter = _rate_limiter;
+    }
+    _pull_keys = 0;
+    _rate_window_begin = now_us();
 
-      rocksdb::Status s = rocksdb::DB::Open(options, shard_path, &_dbs[i]);
-      assert(s.ok());
+    if (!db_path.empty()) {
+      std::string rm_cmd = "rm -rf " + db_path;
+      system(rm_cmd.c_str());
+    }
+    std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
+    column_families.emplace_back(rocksdb::kDefaultColumnFamilyName, options);
+    for (int i = 0; i < colnum; i++) {
+      // the sst files of the shard are written here before their ingestion
+      std::string shard_path = db_path + "_" + std::to_string(i);
+      std::string cmd = "rm -rf " + shard_path + " && mkdir -p " + shard_path;
+      system(cmd.c_str());
+      column_families.emplace_back("shard_" + std::to_string(i), options);
     }
+
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    rocksdb::Status s = rocksdb::DB::Open(
+        rocksdb::DBOptions(options), db_path, column_families, &handles, &_db);
+    assert(s.ok());
+    _default_handle = handles[0];
+    _handles.assign(handles.begin() + 1, handles.end());
     VLOG(0) << "DB initialize success, colnum:" << colnum;
     return 0;
   }
@@ -161,9 +217,10 @@ class RocksDBHandler {
       int id, const char* key, int key_len, const char* value, int value_len) {
     rocksdb::WriteOptions options;
     options.disableWAL = true;
-    rocksdb::Status s = _dbs[id]->Put(options,
-                                      rocksdb::Slice(key, key_len),
-                                      rocksdb::Slice(value, value_len));
+    rocksdb::Status s = _db->Put(options,
+                                 _handles[id],
+                                 rocksdb::Slice(key, key_len),
+                                 rocksdb::Slice(value, value_len));
     assert(s.ok());
     return 0;
   }
@@ -176,17 +233,20 @@ class RocksDBHandler {
     options.disableWAL = true;
     rocksdb::WriteBatch batch(n * 128);
     for (int i = 0; i < n; i++) {
-      batch.Put(rocksdb::Slice(ssd_keys[i].first, ssd_keys[i].second),
+      batch.Put(_handles[id],
+                rocksdb::Slice(ssd_keys[i].first, ssd_keys[i].second),
                 rocksdb::Slice(ssd_values[i].first, ssd_values[i].second));
     }
-    rocksdb::Status s = _dbs[id]->Write(options, &batch);
+    rocksdb::Status s = _db->Write(options, &batch);
     assert(s.ok());
     return 0;
   }
 
   int get(int id, const char* key, int key_len, std::string& value) {  // NOLINT
-    rocksdb::Status s = _dbs[id]->Get(
-        rocksdb::ReadOptions(), rocksdb::Slice(key, key_len), &value);
+    rocksdb::Status s = _db->Get(rocksdb::ReadOptions(),
+                                 _handles[id],
+                                 rocksdb::Slice(key, key_len),
+                                 &value);
     if (s.IsNotFound()) {
       return 1;
     }
@@ -200,36 +260,41 @@ class RocksDBHandler {
                  rocksdb::PinnableSlice* values,
                  rocksdb::Status* status,
                  const bool sorted_input = true) {
-    rocksdb::ColumnFamilyHandle* handle = _dbs[id]->DefaultColumnFamily();
     auto read_opt = rocksdb::ReadOptions();
     read_opt.fill_cache = false;
-    _dbs[id]->MultiGet(
-        read_opt, handle, num_keys, keys, values, status, sorted_input);
+    _db->MultiGet(
+        read_opt, _handles[id], num_keys, keys, values, status, sorted_input);
+    _pull_keys.fetch_add(num_keys, std::memory_order_relaxed);
+    adjust_compaction_rate();
   }
 
   int del_data(int id, const char* key, int key_len) {
     rocksdb::WriteOptions options;
     options.disableWAL = true;
-    rocksdb::Status s = _dbs[id]->Delete(options, rocksdb::Slice(key, key_len));
+    rocksdb::Status s =
+        _db->Delete(options, _handles[id], rocksdb::Slice(key, key_len));
     assert(s.ok());
     return 0;
   }
 
   int flush(int id) {
-    rocksdb::Status s = _dbs[id]->Flush(rocksdb::FlushOptions());
+    rocksdb::Status s = _db->Flush(rocksdb::FlushOptions(), _handles[id]);
     assert(s.ok());
     return 0;
   }
 
   rocksdb::Iterator* get_iterator(int id) {
-    return _dbs[id]->NewIterator(rocksdb::ReadOptions());
+    // the scans go across the prefixes
+    rocksdb::ReadOptions read_opt;
+    read_opt.total_order_seek = true;
+    return _db->NewIterator(read_opt, _handles[id]);
   }
 
   int get_estimate_key_num(uint64_t& num_keys) {  // NOLINT
     num_keys = 0;
-    for (size_t i = 0; i < _dbs.size(); i++) {
+    for (auto* handle : _handles) {
       uint64_t cur_keys = 0;
-      _dbs[i]->GetAggregatedIntProperty("rocksdb.estimate-num-keys", &cur_keys);
+      _db->GetIntProperty(handle, "rocksdb.estimate-num-keys", &cur_keys);
       num_keys += cur_keys;
     }
     return 0;
@@ -241,16 +306,113 @@ class RocksDBHandler {
                            const std::vector<std::string>& sst_filelist) {
     rocksdb::IngestExternalFileOptions ifo;
     ifo.move_files = true;
-    rocksdb::Status s = _dbs[id]->IngestExternalFile(sst_filelist, ifo);
+    rocksdb::Status s =
+        _db->IngestExternalFile(_handles[id], sst_filelist, ifo);
     assert(s.ok());
     return 0;
   }
 
+  // Compacts all the shards, meant for the windows without pulls, after a
+  // save or a shrink. The compaction starts at the max rate, which goes down
+  // again when the pulls come back. An async call returns at once, and is
+  // skipped when the last one is still running.
+  int manual_compaction(bool async) {
+    if (_compacting.exchange(true)) {
+      VLOG(0) << "DB manual compaction is still running, skip this one";
+      return 1;
+    }
+    if (_compaction_thread.joinable()) {
+      _compaction_thread.join();
+    }
+    if (_rate_limiter) {
+      _rate_limiter->SetBytesPerSecond(
+          _db_options.compaction_max_mb_per_sec * 1024 * 1024);
+    }
+    auto compact = [this]() {
+      rocksdb::CompactRangeOptions cro;
+      cro.exclusive_manual_compaction = false;
+      for (size_t i = 0; i < _handles.size(); i++) {
+        rocksdb::Status s =
+            _db->CompactRange(cro, _handles[i], nullptr, nullptr);
+        if (!s.ok()) {
+          LOG(WARNING) << "DB compaction of shard " << i
+                       << " failed: " << s.ToString();
+        }
+      }
+      VLOG(0) << "DB manual compaction done, colnum:" << _handles.size();
+      _compacting = false;
+    };
+    if (async) {
+      _compaction_thread = std::thread(compact);
+    } else {
+      compact();
+    }
+    return 0;
+  }
+
+  // The bytes per second allowed to the compactions now, 0 without a limit.
+  int64_t compaction_rate() const {
+    return _rate_limiter ? _rate_limiter->GetBytesPerSecond() : 0;
+  }
+
  private:
+  static int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Moves the compaction rate between its max and min ones after the keys
+  // read by the pulls in the last window, so that the compactions give the
+  // ssd bandwidth back to the pulls at their peak.
+  void adjust_compaction_rate() {
+    if (!_rate_limiter) return;
+    int64_t now = now_us();
+    int64_t begin = _rate_window_begin.load(std::memory_order_relaxed);
+    int64_t elapsed = now - begin;
+    if (elapsed < _db_options.rate_window_ms * 1000 ||
+        !_rate_window_begin.compare_exchange_strong(begin, now)) {
+      return;
+    }
+    double keys_per_sec =
+        _pull_keys.exchange(0) * 1e6 / std::max<int64_t>(elapsed, 1);
+    double load = std::min(
+        keys_per_sec /
+            std::max<int64_t>(_db_options.pull_peak_keys_per_sec, 1),
+        1.0);
+    double max_rate = _db_options.compaction_max_mb_per_sec;
+    double min_rate =
+        std::min<double>(_db_options.compaction_min_mb_per_sec, max_rate);
+    int64_t rate = static_cast<int64_t>(
+        (max_rate - (max_rate - min_rate) * load) * 1024 * 1024);
+    _rate_limiter->SetBytesPerSecond(std::max<int64_t>(rate, 1));
+  }
+
+  void close() {
+    if (_compaction_thread.joinable()) {
+      _compaction_thread.join();
+    }
+    if (_db == nullptr) return;
+    for (auto* handle : _handles) {
+      _db->DestroyColumnFamilyHandle(handle);
+    }
+    _db->DestroyColumnFamilyHandle(_default_handle);
+    _handles.clear();
+    delete _db;
+    _db = nullptr;
+  }
+
+  // one per shard
   std::vector<rocksdb::ColumnFamilyHandle*> _handles;
-  // rocksdb::DB* _db;
-  std::vector<rocksdb::DB*> _dbs;
+  rocksdb::ColumnFamilyHandle* _default_handle{nullptr};
+  rocksdb::DB* _db{nullptr};
   Uint64Comparator _comparator;
+  RocksDBOptions _db_options;
+  std::shared_ptr<rocksdb::RateLimiter> _rate_limiter;
+  std::atomic<uint64_t> _pull_keys{0};
+  std::atomic<int64_t> _rate_window_begin{0};
+  std::atomic<bool> _compacting{false};
+  std::thread _compaction_thread;
 };
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,192 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// The load of a shard of a sparse table on a server since the last query.
+struct SparseShardLoad {
+  uint32_t shard_id = 0;
+  uint64_t access_num = 0;  // the keys pulled and pushed
+  uint64_t key_num = 0;
+};
+
+// Two shards of a sparse table on two servers, which trade places.
+struct SparseShardSwap {
+  uint32_t server_a = 0;
+  uint32_t shard_a = 0;
+  uint32_t server_b = 0;
+  uint32_t shard_b = 0;
+};
+
+// The server of every shard of a sparse table. It starts as the assignment of
+// MemorySparseTable::get_sparse_shard, where the server i keeps the next
+// ceil(shard_num / server_num) shards from the shard i * that, and changes by
+// the swaps of the shards between two servers, so every server keeps as many
+// shards as at startup. The version increases with every swap.
+class SparseShardRoute {
+ public:
+  SparseShardRoute() {}
+  SparseShardRoute(uint32_t shard_num, uint32_t server_num)
+      : _owners(shard_num) {
+    uint32_t local_shard_num =
+        server_num == 0 ? shard_num : (shard_num + server_num - 1) / server_num;
+    for (uint32_t i = 0; i < shard_num; ++i) {
+      _owners[i] = i / local_shard_num;
+    }
+  }
+
+  uint64_t Version() const { return _version; }
+  size_t ShardNum() const { return _owners.size(); }
+  uint32_t Owner(uint32_t shard_id) const { return _owners[shard_id]; }
+  uint32_t Server(uint64_t key) const { return _owners[key % _owners.size()]; }
+
+  void Swap(const SparseShardSwap& swap) {
+    std::swap(_owners[swap.shard_a], _owners[swap.shard_b]);
+    ++_version;
+  }
+
+  // |version: 8B|shard num: 4B|owners: 4B * shard num|
+  std::string Serialize() const {
+    uint32_t shard_num = static_cast<uint32_t>(_owners.size());
+    std::string data;
+    data.append(reinterpret_cast<const char*>(&_version), sizeof(_version));
+    data.append(reinterpret_cast<const char*>(&shard_num), sizeof(shard_num));
+    data.append(reinterpret_cast<const char*>(_owners.data()),
+                shard_num * sizeof(uint32_t));
+    return data;
+  }
+
+  bool Deserialize(const std::string& data) {
+    uint64_t version = 0;
+    uint32_t shard_num = 0;
+    const size_t header_size = sizeof(version) + sizeof(shard_num);
+    if (data.size() < header_size) {
+      return false;
+    }
+    memcpy(&version, data.data(), sizeof(version));
+    memcpy(&shard_num, data.data() + sizeof(version), sizeof(shard_num));
+    if (data.size() != header_size + shard_num * sizeof(uint32_t)) {
+      return false;
+    }
+    _version = version;
+    _owners.resize(shard_num);
+    memcpy(_owners.data(),
+           data.data() + header_size,
+           shard_num * sizeof(uint32_t));
+    return true;
+  }
+
+ private:
+  uint64_t _version = 0;
+  std::vector<uint32_t> _owners;
+};
+
+// Plans at most max_swaps swaps of the shards, which move the load from the
+// busiest server to the idlest one until the busiest one has at most
+// max_imbalance times the mean load. server_loads[i] are the loads of the
+// shards on the server i. Every swap trades a shard of the busiest server
+// for a lighter one of the idlest server, whose difference in load is the
+// closest to half of the gap between the two servers and less than the gap,
+// so neither of them ends up busier than the busiest one was. A shard is
+// swapped at most once in a plan.
+inline std::vector<SparseShardSwap> PlanSparseShardSwaps(
+    std::vector<std::vector<SparseShardLoad>> server_loads,
+    double max_imbalance,
+    size_t max_swaps) {
+  std::vector<SparseShardSwap> swaps;
+  const size_t server_num = server_loads.size();
+  if (server_num < 2) {
+    return swaps;
+  }
+  std::vector<uint64_t> totals(server_num, 0);
+  std::vector<std::vector<bool>> swapped(server_num);
+  uint64_t total = 0;
+  for (size_t i = 0; i < server_num; ++i) {
+    for (auto& load : server_loads[i]) {
+      totals[i] += load.access_num;
+    }
+    total += totals[i];
+    swapped[i].resize(server_loads[i].size(), false);
+  }
+  const double mean = static_cast<double>(total) / server_num;
+
+  while (swaps.size() < max_swaps) {
+    size_t busiest = std::max_element(totals.begin(), totals.end()) -
+                     totals.begin();
+    size_t idlest = std::min_element(totals.begin(), totals.end()) -
+                    totals.begin();
+    if (totals[busiest] <= max_imbalance * mean ||
+        totals[busiest] == totals[idlest]) {
+      break;
+    }
+    const uint64_t gap = totals[busiest] - totals[idlest];
+    const auto& busy_shards = server_loads[busiest];
+    const auto& idle_shards = server_loads[idlest];
+    double best_distance = std::numeric_limits<double>::max();
+    size_t best_a = busy_shards.size();
+    size_t best_b = idle_shards.size();
+    for (size_t a = 0; a < busy_shards.size(); ++a) {
+      if (swapped[busiest][a]) {
+        continue;
+      }
+      for (size_t b = 0; b < idle_shards.size(); ++b) {
+        if (swapped[idlest][b] ||
+            busy_shards[a].access_num <= idle_shards[b].access_num) {
+          continue;
+        }
+        uint64_t diff = busy_shards[a].access_num - idle_shards[b].access_num;
+        if (diff >= gap) {
+          continue;
+        }
+        double distance = std::abs(static_cast<double>(diff) - gap / 2.0);
+        if (distance < best_distance) {
+          best_distance = distance;
+          best_a = a;
+          best_b = b;
+        }
+      }
+    }
+    if (best_a == busy_shards.size()) {
+      break;
+    }
+    uint64_t diff =
+        busy_shards[best_a].access_num - idle_shards[best_b].access_num;
+    swaps.push_back({static_cast<uint32_t>(busiest),
+                     busy_shards[best_a].shard_id,
+                     static_cast<uint32_t>(idlest),
+                     idle_shards[best_b].shard_id});
+    totals[busiest] -= diff;
+    totals[idlest] += diff;
+    // the swapped shards trade places in the loads too, for the next swaps
+    std::swap(server_loads[busiest][best_a], server_loads[idlest][best_b]);
+    swapped[busiest][best_a] = true;
+    swapped[idlest][best_b] = true;
+  }
+  return swaps;
+}
+
+}  // namespace distributed
+}  // namespace paddle
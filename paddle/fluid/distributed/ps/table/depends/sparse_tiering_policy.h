@@ -0,0 +1,199 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <future>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+
+namespace paddle {
+namespace distributed {
+
+// A count-min sketch of 4 rows of 4-bit counters, which estimates how often
+// a key is accessed recently. All the counters are halved after 10 * width
+// increments, so the old accesses fade out.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t capacity) {
+    _width = 64;
+    while (_width < capacity) {
+      _width <<= 1;
+    }
+    _table.assign(kRows * _width / kCountersPerWord, 0);
+    _sample_size = 10 * _width;
+  }
+
+  void Increment(uint64_t key) {
+    bool incremented = false;
+    for (size_t row = 0; row < kRows; ++row) {
+      size_t index = Index(key, row);
+      uint64_t& word = _table[index / kCountersPerWord];
+      size_t shift = (index % kCountersPerWord) * 4;
+      if (((word >> shift) & 0xF) != 0xF) {
+        word += static_cast<uint64_t>(1) << shift;
+        incremented = true;
+      }
+    }
+    if (incremented && ++_size >= _sample_size) {
+      for (auto& word : _table) {
+        word = (word >> 1) & 0x7777777777777777ULL;
+      }
+      _size /= 2;
+    }
+  }
+
+  uint32_t Estimate(uint64_t key) const {
+    uint32_t estimate = 0xF;
+    for (size_t row = 0; row < kRows; ++row) {
+      size_t index = Index(key, row);
+      uint64_t word = _table[index / kCountersPerWord];
+      uint32_t count = (word >> ((index % kCountersPerWord) * 4)) & 0xF;
+      estimate = count < estimate ? count : estimate;
+    }
+    return estimate;
+  }
+
+ private:
+  static constexpr size_t kRows = 4;
+  static constexpr size_t kCountersPerWord = 16;
+
+  size_t Index(uint64_t key, size_t row) const {
+    static const uint64_t kSeeds[kRows] = {0x9E3779B97F4A7C15ULL,
+                                           0xC2B2AE3D27D4EB4FULL,
+                                           0x165667B19E3779F9ULL,
+                                           0xD6E8FEB86659FD93ULL};
+    uint64_t h = (key + row) * kSeeds[row];
+    h ^= h >> 32;
+    return row * _width + (h & (_width - 1));
+  }
+
+  size_t _width;
+  size_t _sample_size;
+  size_t _size{0};
+  std::vector<uint64_t> _table;
+};
+
+struct SparseTieringStat {
+  std::atomic<uint64_t> mem_hits{0};
+  std::atomic<uint64_t> ssd_hits{0};
+  // the keys neither in the memory nor in the ssd
+  std::atomic<uint64_t> misses{0};
+  // the ssd hits moved into the memory or not
+  std::atomic<uint64_t> admitted{0};
+  std::atomic<uint64_t> rejected{0};
+  std::atomic<uint64_t> demoted{0};
+};
+
+// The tiering policy of the memory of a shard of SSDSparseTable, which keeps
+// the frequently and recently accessed keys in the memory and the others in
+// the ssd:
+//  * Admission (TinyLFU): a key read from the ssd is moved into the memory
+//    if the memory is not full, or it is accessed more often than the key
+//    which the clock hand points to, which is the next to be demoted.
+//  * Eviction (CLOCK): the hand sweeps the buckets of the shard and demotes
+//    the keys not accessed since the hand passed them last time, until the
+//    memory is below the low watermark. The reference bits are hashed by the
+//    keys into a bitmap of 8 bits per key of the capacity, so they cost no
+//    memory in the shard, and a collision only gives a key a second chance.
+//
+// It is not thread safe. It is used by the task thread of its shard only.
+class SparseTieringPolicy {
+ public:
+  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+
+  explicit SparseTieringPolicy(size_t mem_capacity)
+      : _mem_capacity(mem_capacity), _sketch(mem_capacity) {
+    _reference_bits.assign(mem_capacity / 8 + 1, 0);
+  }
+
+  size_t mem_capacity() const { return _mem_capacity; }
+  SparseTieringStat& stat() { return _stat; }
+
+  void RecordAccess(uint64_t key) {
+    _sketch.Increment(key);
+    size_t bit = ReferenceBit(key);
+    _reference_bits[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+  }
+
+  bool Admit(uint64_t key, shard_type* shard) {
+    if (shard->size() < _mem_capacity) {
+      return true;
+    }
+    for (size_t i = 0; i < shard->bucket_count(); ++i) {
+      size_t bucket = (_hand + i) % shard->bucket_count();
+      if (shard->bucket_size(bucket) != 0) {
+        return _sketch.Estimate(key) >
+               _sketch.Estimate(shard->begin(bucket).key());
+      }
+    }
+    return true;
+  }
+
+  bool NeedDemote(size_t mem_size) const { return mem_size > _mem_capacity; }
+
+  // Demotes the keys by demote(key, value) and erases them from the shard
+  // until its size is below the low watermark, 90% of the capacity. Returns
+  // the number of the keys demoted.
+  template <class DEMOTE_FUNC>
+  size_t Demote(shard_type* shard, DEMOTE_FUNC demote) {
+    size_t low_watermark = _mem_capacity / 10 * 9;
+    size_t count = 0;
+    // all the reference bits are cleared in the first round
+    for (size_t i = 0;
+         i < 2 * shard->bucket_count() && shard->size() > low_watermark;
+         ++i) {
+      size_t bucket = _hand;
+      _hand = (_hand + 1) % shard->bucket_count();
+      for (auto it = shard->begin(bucket);
+           it != shard->end(bucket) && shard->size() > low_watermark;) {
+        size_t bit = ReferenceBit(it.key());
+        uint64_t mask = static_cast<uint64_t>(1) << (bit % 64);
+        if (_reference_bits[bit / 64] & mask) {
+          _reference_bits[bit / 64] &= ~mask;
+          ++it;
+        } else {
+          demote(it.key(), it.value());
+          it = shard->erase(bucket, it);
+          ++count;
+        }
+      }
+    }
+    _stat.demoted += count;
+    return count;
+  }
+
+  // Set on the shard thread when a demotion is scheduled, and reset when it
+  // is done. The table waits for it before being destroyed.
+  bool demotion_pending{false};
+  std::future<int> demotion;
+
+ private:
+  size_t ReferenceBit(uint64_t key) const {
+    uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    return (h ^ (h >> 29)) % (_reference_bits.size() * 64);
+  }
+
+  size_t _mem_capacity;
+  size_t _hand{0};
+  FrequencySketch _sketch;
+  std::vector<uint64_t> _reference_bits;
+  SparseTieringStat _stat;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,297 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+void put_varint(uint64_t value, std::vector<uint8_t> *bytes) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<uint8_t>(value));
+}
+
+const uint8_t *get_varint(const uint8_t *p, uint64_t *value) {
+  uint64_t result = 0;
+  int shift = 0;
+  while (*p & 0x80) {
+    result |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+    shift += 7;
+  }
+  *value = result | (static_cast<uint64_t>(*p++) << shift);
+  return p;
+}
+
+bool write_all(FILE *fp, const void *data, size_t size) {
+  return size == 0 || fwrite(data, 1, size, fp) == size;
+}
+
+}  // namespace
+
+CsrGraph::~CsrGraph() { release(); }
+
+void CsrGraph::release() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  ids_ = edge_offsets_ = byte_offsets_ = nullptr;
+  weights_ = nullptr;
+  bytes_ = nullptr;
+}
+
+int32_t CsrGraph::dump(std::vector<Node *> nodes,
+                       bool is_weighted,
+                       const std::string &path) {
+  nodes.erase(std::remove(nodes.begin(), nodes.end(), nullptr), nodes.end());
+  std::sort(nodes.begin(), nodes.end(), [](Node *a, Node *b) {
+    return a->get_id() < b->get_id();
+  });
+  Header header;
+  memset(&header, 0, sizeof(Header));
+  header.magic = kMagic;
+  header.node_num = nodes.size();
+  header.is_weighted = is_weighted;
+
+  std::vector<uint64_t> ids(nodes.size());
+  std::vector<uint64_t> edge_offsets(nodes.size() + 1, 0);
+  std::vector<uint64_t> byte_offsets(nodes.size() + 1, 0);
+  std::vector<float> weights;
+  std::vector<uint8_t> bytes;
+  std::vector<std::pair<uint64_t, float>> neighbors;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    Node *node = nodes[i];
+    ids[i] = node->get_id();
+    size_t neighbor_size = node->get_neighbor_size();
+    neighbors.resize(neighbor_size);
+    for (size_t j = 0; j < neighbor_size; j++) {
+      neighbors[j].first = node->get_neighbor_id(j);
+      neighbors[j].second = is_weighted ? node->get_neighbor_weight(j) : 1.0;
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    uint64_t last = 0;
+    for (auto &neighbor : neighbors) {
+      put_varint(neighbor.first - last, &bytes);
+      last = neighbor.first;
+      if (is_weighted) {
+        weights.push_back(neighbor.second);
+      }
+    }
+    edge_offsets[i + 1] = edge_offsets[i] + neighbor_size;
+    byte_offsets[i + 1] = bytes.size();
+  }
+  header.edge_num = edge_offsets.back();
+  header.data_size = bytes.size();
+
+  FILE *fp = fopen(path.c_str(), "wb");
+  if (fp == nullptr) {
+    VLOG(0) << "Fail to open csr graph file " << path;
+    return -1;
+  }
+  bool ok = write_all(fp, &header, sizeof(Header)) &&
+            write_all(fp, ids.data(), ids.size() * sizeof(uint64_t)) &&
+            write_all(fp,
+                      edge_offsets.data(),
+                      edge_offsets.size() * sizeof(uint64_t)) &&
+            write_all(fp,
+                      byte_offsets.data(),
+                      byte_offsets.size() * sizeof(uint64_t)) &&
+            write_all(fp, weights.data(), weights.size() * sizeof(float)) &&
+            write_all(fp, bytes.data(), bytes.size());
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok) {
+    VLOG(0) << "Fail to write csr graph file " << path;
+    return -1;
+  }
+  VLOG(0) << "dump csr graph " << path << ", node_num " << header.node_num
+          << ", edge_num " << header.edge_num << ", data_size "
+          << header.data_size;
+  return 0;
+}
+
+int32_t CsrGraph::load(const std::string &path) {
+  release();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    VLOG(0) << "Fail to open csr graph file " << path;
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    VLOG(0) << "Fail to read the header of csr graph file " << path;
+    close(fd);
+    return -1;
+  }
+  size_t size = st.st_size;
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    VLOG(0) << "Fail to mmap csr graph file " << path;
+    return -1;
+  }
+  data_ = data;
+  size_ = size;
+  header_ = reinterpret_cast<const Header *>(data);
+  const Header &header = *header_;
+  size_t expected_size = 0;
+  if (header.magic == kMagic) {
+    expected_size = sizeof(Header) +
+                    (3 * header.node_num + 2) * sizeof(uint64_t) +
+                    (header.is_weighted ? header.edge_num * sizeof(float) : 0) +
+                    header.data_size;
+  }
+  if (expected_size != size) {
+    VLOG(0) << "Invalid csr graph file " << path;
+    release();
+    return -1;
+  }
+  ids_ = reinterpret_cast<const uint64_t *>(header_ + 1);
+  edge_offsets_ = ids_ + header.node_num;
+  byte_offsets_ = edge_offsets_ + header.node_num + 1;
+  const char *end =
+      reinterpret_cast<const char *>(byte_offsets_ + header.node_num + 1);
+  if (header.is_weighted) {
+    weights_ = reinterpret_cast<const float *>(end);
+    end += header.edge_num * sizeof(float);
+  }
+  bytes_ = reinterpret_cast<const uint8_t *>(end);
+  if (edge_offsets_[header.node_num] != header.edge_num ||
+      byte_offsets_[header.node_num] != header.data_size) {
+    VLOG(0) << "Invalid offsets in csr graph file " << path;
+    release();
+    return -1;
+  }
+  // the sampling reads the neighbors of random nodes
+  madvise(data_, size_, MADV_RANDOM);
+  VLOG(0) << "load csr graph " << path << ", node_num " << header.node_num
+          << ", edge_num " << header.edge_num;
+  return 0;
+}
+
+int64_t CsrGraph::find(uint64_t id) const {
+  if (header_ == nullptr) {
+    return -1;
+  }
+  const uint64_t *end = ids_ + header_->node_num;
+  const uint64_t *p = std::lower_bound(ids_, end, id);
+  if (p == end || *p != id) {
+    return -1;
+  }
+  return p - ids_;
+}
+
+void CsrGraph::get_neighbors(int64_t index,
+                             std::vector<uint64_t> *ids,
+                             std::vector<float> *weights) const {
+  size_t neighbor_size = degree(index);
+  ids->resize(neighbor_size);
+  const uint8_t *p = bytes_ + byte_offsets_[index];
+  uint64_t last = 0, delta;
+  for (size_t i = 0; i < neighbor_size; i++) {
+    p = get_varint(p, &delta);
+    last += delta;
+    (*ids)[i] = last;
+  }
+  if (weights != nullptr) {
+    if (weights_ != nullptr) {
+      const float *begin = weights_ + edge_offsets_[index];
+      weights->assign(begin, begin + neighbor_size);
+    } else {
+      weights->assign(neighbor_size, 1.0);
+    }
+  }
+}
+
+int CsrGraph::sample(int64_t index,
+                     int k,
+                     bool need_weight,
+                     const std::shared_ptr<std::mt19937_64> &rng,
+                     char **buffer) const {
+  thread_local std::vector<uint64_t> neighbor_ids;
+  thread_local std::vector<int> sampled;
+  size_t neighbor_size = degree(index);
+  if (neighbor_size == 0 || k <= 0) {
+    *buffer = nullptr;
+    return 0;
+  }
+  get_neighbors(index, &neighbor_ids, nullptr);
+  size_t sample_size = std::min(neighbor_size, static_cast<size_t>(k));
+  sampled.resize(neighbor_size);
+  std::iota(sampled.begin(), sampled.end(), 0);
+  const float *weights =
+      weights_ == nullptr ? nullptr : weights_ + edge_offsets_[index];
+  if (sample_size < neighbor_size) {
+    std::uniform_real_distribution<double> distrib(0, 1);
+    if (weights != nullptr) {
+      // the k largest keys of log(u) / w, by Efraimidis and Spirakis
+      thread_local std::vector<double> keys;
+      keys.resize(neighbor_size);
+      for (size_t i = 0; i < neighbor_size; i++) {
+        keys[i] = weights[i] > 0 ? std::log(distrib(*rng)) / weights[i]
+                                 : -HUGE_VAL;
+      }
+      std::nth_element(
+          sampled.begin(),
+          sampled.begin() + sample_size,
+          sampled.end(),
+          [](int a, int b) { return keys[a] > keys[b]; });
+    } else {
+      for (size_t i = 0; i < sample_size; i++) {
+        std::uniform_int_distribution<size_t> pick(i, neighbor_size - 1);
+        std::swap(sampled[i], sampled[pick(*rng)]);
+      }
+    }
+  }
+
+  size_t item_size =
+      need_weight ? Node::id_size + Node::weight_size : Node::id_size;
+  int actual_size = sample_size * item_size;
+  char *buffer_addr = new char[actual_size];
+  char *p = buffer_addr;
+  for (size_t i = 0; i < sample_size; i++) {
+    int x = sampled[i];
+    memcpy(p, &neighbor_ids[x], Node::id_size);
+    p += Node::id_size;
+    if (need_weight) {
+      float weight = weights == nullptr ? 1.0 : weights[x];
+      memcpy(p, &weight, Node::weight_size);
+      p += Node::weight_size;
+    }
+  }
+  *buffer = buffer_addr;
+  return actual_size;
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+
+namespace paddle {
+namespace distributed {
+
+// The neighbors of an edge type in the compressed sparse row format. The
+// neighbors of a node are sorted and stored as the varint encoded deltas, and
+// the weights are kept in an array of their own. The file is mapped read only,
+// so the graph servers of a host share its pages, and the nodes are sampled
+// without building the Node objects.
+//
+// The file holds the header, the sorted node ids, the edge offsets and the
+// byte offsets of the nodes (node_num + 1 each), the weights (edge_num, only
+// in a weighted graph) and the varint data.
+class CsrGraph {
+ public:
+  CsrGraph() {}
+  ~CsrGraph();
+  CsrGraph(const CsrGraph &) = delete;
+  CsrGraph &operator=(const CsrGraph &) = delete;
+
+  // Writes the neighbors of the nodes to path, returns 0 on success.
+  static int32_t dump(std::vector<Node *> nodes,
+                      bool is_weighted,
+                      const std::string &path);
+  // Maps the file written by dump, returns 0 on success.
+  int32_t load(const std::string &path);
+
+  uint64_t node_num() const { return header_ ? header_->node_num : 0; }
+  uint64_t edge_num() const { return header_ ? header_->edge_num : 0; }
+  bool is_weighted() const { return header_ && header_->is_weighted; }
+  // The index of the node, or -1 if it has no neighbors in the graph.
+  int64_t find(uint64_t id) const;
+  size_t degree(int64_t index) const {
+    return edge_offsets_[index + 1] - edge_offsets_[index];
+  }
+  // Decodes the neighbors of the node at index, weights may be nullptr.
+  void get_neighbors(int64_t index,
+                     std::vector<uint64_t> *ids,
+                     std::vector<float> *weights) const;
+  // Samples k neighbors of the node at index without replacement, by the
+  // weights in a weighted graph. The ids, followed by the weights if
+  // need_weight, are written to a new buffer as random_sample_neighbors lays
+  // them out, and its size is returned.
+  int sample(int64_t index,
+             int k,
+             bool need_weight,
+             const std::shared_ptr<std::mt19937_64> &rng,
+             char **buffer) const;
+
+ private:
+  struct Header {
+    uint64_t magic;
+    uint64_t node_num;
+    uint64_t edge_num;
+    uint64_t data_size;
+    uint32_t is_weighted;
+    uint32_t reserved;
+  };
+  static constexpr uint64_t kMagic = 0x3130475253434450ULL;  // "PDCSRG01"
+
+  void release();
+
+  void *data_ = nullptr;
+  size_t size_ = 0;
+  const Header *header_ = nullptr;
+  const uint64_t *ids_ = nullptr;
+  const uint64_t *edge_offsets_ = nullptr;
+  const uint64_t *byte_offsets_ = nullptr;
+  const float *weights_ = nullptr;
+  const uint8_t *bytes_ = nullptr;
+};
+
+}  // namespace distributed
+}  // namespace paddle
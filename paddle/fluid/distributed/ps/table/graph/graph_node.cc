@@ -15,6 +15,11 @@
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 
 #include <cstring>
+
+#include "paddle/common/flags.h"
+
+COMMON_DECLARE_int32(graph_alias_sampler_degree_threshold);
+
 namespace paddle::distributed {
 
 GraphNode::~GraphNode() {
@@ -72,6 +77,15 @@ void GraphNode::build_sampler(std::string sample_type) {
     sampler = new RandomSampler();
   } else if (sample_type == "weighted") {
     sampler = new WeightedSampler();
+  } else if (sample_type == "alias") {
+    // the tree is cheaper to build and small for the low degree nodes
+    if (edges != nullptr &&
+        edges->size() >= static_cast<size_t>(
+                             FLAGS_graph_alias_sampler_degree_threshold)) {
+      sampler = new AliasSampler();
+    } else {
+      sampler = new WeightedSampler();
+    }
   }
   if (sampler != nullptr) {
     sampler->build(edges);
@@ -14,7 +14,11 @@
 
 #include "paddle/fluid/distributed/ps/table/graph/graph_weighted_sampler.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 
@@ -165,4 +169,118 @@ int WeightedSampler::sample(
   subtract_count_map[this]++;
   return return_idx;
 }
+
+void AliasSampler::build(GraphEdgeBlob *edges) {
+  this->edges = edges;
+  prob.clear();
+  alias.clear();
+}
+
+void AliasSampler::build_table() {
+  int n = edges->size();
+  double total = 0;
+  std::vector<double> scaled(n);
+  for (int i = 0; i < n; i++) {
+    float weight = edges->get_weight(i);
+    scaled[i] = std::max(weight, 0.0f);
+    total += scaled[i];
+  }
+  std::vector<int> small, large;
+  for (int i = 0; i < n; i++) {
+    scaled[i] = total > 0 ? scaled[i] * n / total : 1.0;
+    if (scaled[i] < 1.0) {
+      small.push_back(i);
+    } else {
+      large.push_back(i);
+    }
+  }
+  prob.resize(n);
+  alias.resize(n);
+  while (!small.empty() && !large.empty()) {
+    int s = small.back(), l = large.back();
+    small.pop_back();
+    prob[s] = scaled[s];
+    alias[s] = l;
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // the rest are 1 up to the rounding errors
+  for (int l : large) {
+    prob[l] = 1.0;
+    alias[l] = l;
+  }
+  for (int s : small) {
+    prob[s] = 1.0;
+    alias[s] = s;
+  }
+}
+
+std::vector<int> AliasSampler::sample_k(
+    int k, const std::shared_ptr<std::mt19937_64> rng) {
+  int n = edges->size();
+  std::vector<int> sample_result;
+  if (k >= n) {
+    sample_result.reserve(n);
+    for (int i = 0; i < n; i++) {
+      sample_result.push_back(i);
+    }
+    return sample_result;
+  }
+  std::call_once(built, [this]() { build_table(); });
+  sample_result.reserve(k);
+  std::unordered_set<int> chosen;
+  chosen.reserve(k);
+  std::uniform_real_distribution<double> distrib(0, 1.0);
+  // the slot and the coin of a draw from one number
+  int max_draws = 4 * k + 32;
+  for (int draws = 0;
+       static_cast<int>(sample_result.size()) < k && draws < max_draws;
+       draws++) {
+    double query = distrib(*rng) * n;
+    int slot = std::min(static_cast<int>(query), n - 1);
+    int x = query - slot < prob[slot] ? slot : alias[slot];
+    if (chosen.insert(x).second) {
+      sample_result.push_back(x);
+    }
+  }
+  if (static_cast<int>(sample_result.size()) < k) {
+    sample_remaining(
+        k - sample_result.size(), rng.get(), &chosen, &sample_result);
+  }
+  return sample_result;
+}
+
+// Chooses k of the neighbors not chosen by the keys log(u) / weight of
+// Efraimidis and Spirakis, the top k of which are a weighted sample without
+// replacement.
+void AliasSampler::sample_remaining(int k,
+                                    std::mt19937_64 *rng,
+                                    std::unordered_set<int> *chosen,
+                                    std::vector<int> *sample_result) {
+  int n = edges->size();
+  std::uniform_real_distribution<double> distrib(0, 1.0);
+  std::vector<std::pair<double, int>> keys;
+  keys.reserve(n - chosen->size());
+  for (int i = 0; i < n; i++) {
+    if (chosen->count(i)) {
+      continue;
+    }
+    float weight = edges->get_weight(i);
+    double key = weight > 0 ? std::log(distrib(*rng)) / weight
+                            : -std::numeric_limits<double>::infinity();
+    keys.emplace_back(key, i);
+  }
+  k = std::min(k, static_cast<int>(keys.size()));
+  std::nth_element(keys.begin(),
+                   keys.begin() + k,
+                   keys.end(),
+                   std::greater<std::pair<double, int>>());
+  for (int i = 0; i < k; i++) {
+    chosen->insert(keys[i].second);
+    sample_result->push_back(keys[i].second);
+  }
+}
 }  // namespace paddle::distributed
@@ -41,7 +41,128 @@ PD_DEFINE_int32(pserver_table_save_max_retry,
 
 namespace paddle::distributed {
 
-int32_t MemorySparseTable::Initialize() {
+namespace {
+
+constexpr uint32_t kSparseDeltaMagic = 0x50534454;
+constexpr uint32_t kSparseDeltaVersion = 1;
+constexpr uint32_t kSparseDeltaEnd = UINT32_MAX;
+
+bool WriteDeltaHeader(FsWriteChannel *channel) {
+  uint32_t header[2] = {kSparseDeltaMagic, kSparseDeltaVersion};
+  return channel->write(reinterpret_cast<const char *>(header),
+                        sizeof(header)) == 0;
+}
+
+bool WriteDeltaRecord(FsWriteChannel *channel,
+                      uint64_t key,
+                      const float *data,
+                      uint32_t size) {
+  return channel->write(reinterpret_cast<const char *>(&key), sizeof(key)) ==
+             0 &&
+         channel->write(reinterpret_cast<const char *>(&size), sizeof(size)) ==
+             0 &&
+         (size == 0 || channel->write(reinterpret_cast<const char *>(data),
+                                      size * sizeof(float)) == 0);
+}
+
+// the end record keeps the record count, so that a truncated file is found
+bool WriteDeltaEnd(FsWriteChannel *channel, uint64_t record_num) {
+  uint32_t end = kSparseDeltaEnd;
+  return channel->write(reinterpret_cast<const char *>(&record_num),
+                        sizeof(record_num)) == 0 &&
+         channel->write(reinterpret_cast<const char *>(&end), sizeof(end)) ==
+             0;
+}
+
+bool ReadDeltaBytes(FsReadChannel *channel, void *data, size_t size) {
+  return channel->read(reinterpret_cast<char *>(data), size) ==
+         static_cast<int>(size);
+}
+
+// Calls visit(key, data, size) on each record of the delta file, returns the
+// number of the records, or -1 if the file is broken or truncated.
+template <typename Visitor>
+int64_t ReadDelta(FsReadChannel *channel, Visitor &&visit) {
+  uint32_t header[2] = {0, 0};
+  if (!ReadDeltaBytes(channel, header, sizeof(header)) ||
+      header[0] != kSparseDeltaMagic || header[1] != kSparseDeltaVersion) {
+    return -1;
+  }
+  std::vector<float> data;
+  int64_t record_num = 0;
+  while (true) {
+    uint64_t key = 0;
+    uint32_t size = 0;
+    if (!ReadDeltaBytes(channel, &key, sizeof(key)) ||
+        !ReadDeltaBytes(channel, &size, sizeof(size))) {
+      return -1;
+    }
+    if (size == kSparseDeltaEnd) {
+      return key == static_cast<uint64_t>(record_num) ? record_num : -1;
+    }
+    data.resize(size);
+    if (size > 0 &&
+        !ReadDeltaBytes(channel, data.data(), size * sizeof(float))) {
+      return -1;
+    }
+    visit(key, data.data(), size);
+    ++record_num;
+  }
+}
+
+}  // namespace
+
+int64_t MergeSparseTableDeltas(AfsClient *fs_client,
+                               const std::vector<std::string> &delta_paths,
+                               const std::string &output_path) {
+  // an empty value is the tombstone of the erased key
+  std::unordered_map<uint64_t, std::vector<float>> merged;
+  for (auto &path : delta_paths) {
+    FsChannelConfig channel_config = {};
+    channel_config.path = path;
+    int err_no = 0;
+    auto read_channel = fs_client->open_r(channel_config, 0, &err_no);
+    int64_t record_num =
+        ReadDelta(read_channel.get(),
+                  [&merged](uint64_t key, const float *data, uint32_t size) {
+                    merged[key].assign(data, data + size);
+                  });
+    read_channel->close();
+    if (record_num < 0 || err_no == -1) {
+      LOG(ERROR) << "MergeSparseTableDeltas read failed, path:" << path;
+      return -1;
+    }
+  }
+
+  FsChannelConfig channel_config = {};
+  channel_config.path = output_path;
+  int err_no = 0;
+  auto write_channel =
+      fs_client->open_w(channel_config, 1024 * 1024 * 40, &err_no);
+  bool is_write_failed = !WriteDeltaHeader(write_channel.get());
+  for (auto it = merged.begin(); !is_write_failed && it != merged.end();
+       ++it) {
+    is_write_failed = !WriteDeltaRecord(write_channel.get(),
+                                        it->first,
+                                        it->second.data(),
+                                        it->second.size());
+  }
+  is_write_failed =
+      is_write_failed || !WriteDeltaEnd(write_channel.get(), merged.size());
+  write_channel->close();
+  if (is_write_failed || err_no == -1) {
+    LOG(ERROR) << "MergeSparseTableDeltas write failed, path:" << output_path;
+    fs_client->remove(output_path);
+    return -1;
+  }
+  LOG(INFO) << "MergeSparseTableDeltas merge " << delta_paths.size()
+            << " files into " << output_path
+            << ", record size: " << merged.size();
+  return static_cast<int64_t>(merged.size());
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Initialize() {
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_sparse_update_all");
   profiler.register_profiler("pserver_sparse_select_all");
@@ -54,7 +175,8 @@ int32_t MemorySparseTable::Initialize() {
   return 0;
 }
 
-int32_t MemorySparseTable::InitializeValue() {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::InitializeValue() {
   _sparse_table_shard_num = static_cast<int>(_config.shard_num());
   _avg_local_shard_num =
       sparse_local_shard_num(_sparse_table_shard_num, _shard_num);
@@ -77,6 +199,18 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _use_gpu_graph:" << _use_gpu_graph;
 
   _local_shards.reset(new shard_type[_real_local_shard_num]);
+  _local_shard_ids.reset(new std::atomic<int>[_sparse_table_shard_num]);
+  for (int i = 0; i < _sparse_table_shard_num; ++i) {
+    _local_shard_ids[i] = i % _avg_local_shard_num;
+  }
+  _global_shard_ids.resize(_real_local_shard_num);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    _global_shard_ids[i] = _shard_idx * _avg_local_shard_num + i;
+    _local_shard_ids[_global_shard_ids[i]] = i;
+  }
+  _shard_access_nums.reset(
+      new std::atomic<uint64_t>[_real_local_shard_num]());  // NOLINT
+  _shard_route = SparseShardRoute(_sparse_table_shard_num, _shard_num);
 
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
@@ -102,11 +236,16 @@ int32_t MemorySparseTable::InitializeValue() {
               << "]";
     _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
   }
+  if (_config.enable_delta_save()) {
+    _delta_keys.reset(
+        new std::unordered_set<uint64_t>[_real_local_shard_num]);  // NOLINT
+  }
   return 0;
 }
 
-int32_t MemorySparseTable::Load(const std::string &path,
-                                const std::string &param) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Load(const std::string &path,
+                                                const std::string &param) {
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
 
@@ -130,6 +269,9 @@ int32_t MemorySparseTable::Load(const std::string &path,
   if (load_param == 5) {
     return LoadPatch(file_list, load_param);
   }
+  if (load_param == 6) {
+    return LoadDelta(file_list);
+  }
 
   size_t file_start_idx = _shard_idx * _avg_local_shard_num;
 
@@ -150,7 +292,8 @@ int32_t MemorySparseTable::Load(const std::string &path,
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
     FsChannelConfig channel_config = {};
-    channel_config.path = file_list[file_start_idx + i];
+    // the files are sorted by the global shards, see ShardFilePath
+    channel_config.path = file_list[_global_shard_ids[i]];
     VLOG(1) << "MemorySparseTable::load begin load " << channel_config.path
             << " into local shard " << i;
     channel_config.converter = _value_accessor->Converter(load_param).converter;
@@ -196,6 +339,9 @@ int32_t MemorySparseTable::Load(const std::string &path,
         exit(-1);
       }
     } while (is_read_failed);
+    if (_delta_keys != nullptr) {
+      _delta_keys[i].clear();
+    }
   }
   LOG(INFO) << "MemorySparseTable load success, path from "
             << file_list[file_start_idx] << " to "
@@ -203,8 +349,66 @@ int32_t MemorySparseTable::Load(const std::string &path,
   return 0;
 }
 
-int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
-                                     int load_param) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::LoadDelta(
+    const std::vector<std::string> &file_list) {
+  size_t file_start_idx = _shard_idx * _avg_local_shard_num;
+  if (file_start_idx >= file_list.size()) {
+    return 0;
+  }
+  int thread_num = _real_local_shard_num < 15 ? _real_local_shard_num : 15;
+
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    FsChannelConfig channel_config = {};
+    channel_config.path = file_list[_global_shard_ids[i]];
+    auto &shard = _local_shards[i];
+    bool is_read_failed = false;
+    int retry_num = 0;
+    int err_no = 0;
+    do {
+      // applying a delta again gives the same values, so it is retried as
+      // a whole
+      is_read_failed = false;
+      err_no = 0;
+      auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+      int64_t record_num = ReadDelta(
+          read_channel.get(),
+          [&shard](uint64_t key, const float *data, uint32_t size) {
+            if (size == 0) {
+              shard.erase(key);
+            } else {
+              auto &value = shard[key];
+              value.resize(size);
+              memcpy(value.data(), data, size * sizeof(float));
+            }
+          });
+      read_channel->close();
+      if (record_num < 0 || err_no == -1) {
+        ++retry_num;
+        is_read_failed = true;
+        LOG(ERROR) << "MemorySparseTable load delta failed, retry it! path:"
+                   << channel_config.path << " , retry_num=" << retry_num;
+      }
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR) << "MemorySparseTable load delta failed reach max limit!";
+        exit(-1);
+      }
+    } while (is_read_failed);
+    if (_delta_keys != nullptr) {
+      _delta_keys[i].clear();
+    }
+  }
+  LOG(INFO) << "MemorySparseTable load delta success, path from "
+            << file_list[file_start_idx] << " to "
+            << file_list[file_start_idx + _real_local_shard_num - 1];
+  return 0;
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::LoadPatch(
+    const std::vector<std::string> &file_list, int load_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
     return 0;
@@ -303,18 +507,21 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
   return 0;
 }
 
-void MemorySparseTable::Revert() {
+template <class SHARD_TYPE>
+void MemorySparseTableImpl<SHARD_TYPE>::Revert() {
   for (int i = 0; i < _real_local_shard_num; ++i) {
     _local_shards_new[i].clear();
   }
 }
 
-void MemorySparseTable::CheckSavePrePatchDone() {
+template <class SHARD_TYPE>
+void MemorySparseTableImpl<SHARD_TYPE>::CheckSavePrePatchDone() {
   _save_patch_model_thread.join();
 }
 
-int32_t MemorySparseTable::Save(const std::string &dirname,
-                                const std::string &param) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Save(const std::string &dirname,
+                                                const std::string &param) {
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   // gpu graph mode
   if (_use_gpu_graph) {
@@ -337,22 +544,33 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
     _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
-    _save_patch_model_thread = std::thread(std::bind(
-        &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
+    _save_patch_model_thread =
+        std::thread(std::bind(&MemorySparseTableImpl<SHARD_TYPE>::SavePatch,
+                              this,
+                              std::string(dirname),
+                              save_param));
     return 0;
   }
 
+  // delta checkpoint
+  if (save_param == 6) {
+    return SaveDelta(dirname);
+  }
+
   // cache model
   int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
   TopkCalculator tk(_real_local_shard_num, tk_size);
 
   std::string table_path = TableDir(dirname);
-  _afs_client.remove(::paddle::string::format_string(
-      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  // the other servers write the files of the shards swapped out, so only the
+  // files of the local shards are removed then
+  const bool shards_swapped = ShardsSwapped();
+  if (!shards_swapped) {
+    _afs_client.remove(::paddle::string::format_string(
+        "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  }
   std::atomic<uint32_t> feasign_size_all{0};
 
-  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
-
 #ifdef PADDLE_WITH_HETERPS
   int thread_num = _real_local_shard_num;
 #else
@@ -362,18 +580,15 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 #pragma omp parallel for schedule(dynamic)
   for (int i = 0; i < _real_local_shard_num; ++i) {
     FsChannelConfig channel_config = {};
-    if (_config.compress_in_save() && (save_param == 0 || save_param == 3)) {
-      channel_config.path =
-          ::paddle::string::format_string("%s/part-%03d-%05d.gz",
-                                          table_path.c_str(),
-                                          _shard_idx,
-                                          file_start_idx + i);
-    } else {
-      channel_config.path = ::paddle::string::format_string("%s/part-%03d-%05d",
-                                                            table_path.c_str(),
-                                                            _shard_idx,
-                                                            file_start_idx + i);
+    uint32_t shard_id = _global_shard_ids[i];
+    if (shards_swapped) {
+      _afs_client.remove(ShardFilePath(table_path, shard_id, false));
+      _afs_client.remove(ShardFilePath(table_path, shard_id, true));
     }
+    channel_config.path = ShardFilePath(
+        table_path,
+        shard_id,
+        _config.compress_in_save() && (save_param == 0 || save_param == 3));
     channel_config.converter = _value_accessor->Converter(save_param).converter;
     channel_config.deconverter =
         _value_accessor->Converter(save_param).deconverter;
@@ -436,6 +651,10 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
       }
     } while (is_write_failed);
     feasign_size_all += feasign_size;
+    // the following delta checkpoints are based on this one
+    if (save_param == 0 && _delta_keys != nullptr) {
+      _delta_keys[i].clear();
+    }
     if (!_use_gpu_graph) {
       for (auto it = shard.begin(); it != shard.end(); ++it) {
         _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
@@ -454,8 +673,9 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 }
 
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
-int32_t MemorySparseTable::Save_v2(const std::string &dirname,
-                                   const std::string &param) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Save_v2(const std::string &dirname,
+                                                   const std::string &param) {
   if (_real_local_shard_num == 0) {
     _local_show_threshold = -1;
     return 0;
@@ -469,11 +689,19 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
     _local_shards_new.reset(new shard_type[_real_local_shard_num]);
-    _save_patch_model_thread = std::thread(std::bind(
-        &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
+    _save_patch_model_thread =
+        std::thread(std::bind(&MemorySparseTableImpl<SHARD_TYPE>::SavePatch,
+                              this,
+                              std::string(dirname),
+                              save_param));
     return 0;
   }
 
+  // delta checkpoint
+  if (save_param == 6) {
+    return SaveDelta(dirname);
+  }
+
   // cache model
   int64_t tk_size = LocalSize() * _config.sparse_table_cache_rate();
   TopkCalculator tk(_real_local_shard_num, tk_size);
@@ -635,6 +863,10 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
 
     feasign_size_all += feasign_size;
     feasign_size_all_for_slot_feature += feasign_size_for_slot_feature;
+    // the following delta checkpoints are based on this one
+    if (save_param == 0 && _delta_keys != nullptr) {
+      _delta_keys[i].clear();
+    }
     if (!_use_gpu_graph) {
       for (auto it = shard.begin(); it != shard.end(); ++it) {
         _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
@@ -655,7 +887,9 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
 }
 #endif
 
-int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::SavePatch(const std::string &path,
+                                                     int save_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
     return 0;
@@ -744,7 +978,89 @@ int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
   return 0;
 }
 
-int64_t MemorySparseTable::CacheShuffle(
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::SaveDelta(const std::string &path) {
+  if (_delta_keys == nullptr) {
+    LOG(WARNING) << "MemorySparseTable should be enabled delta save.";
+    return -1;
+  }
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  std::string table_path = TableDir(path);
+  _afs_client.remove(::paddle::string::format_string(
+      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+  // the files ending with .gz are compressed by the fs
+  const char *suffix = _config.compress_in_save() ? ".delta.gz" : ".delta";
+
+  std::atomic<uint32_t> feasign_size_all{0};
+
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    FsChannelConfig channel_config = {};
+    channel_config.path =
+        ::paddle::string::format_string("%s/part-%03d-%05d%s",
+                                        table_path.c_str(),
+                                        _shard_idx,
+                                        file_start_idx + i,
+                                        suffix);
+    auto &shard = _local_shards[i];
+    auto &delta_keys = _delta_keys[i];
+    bool is_write_failed = false;
+    int feasign_size = 0;
+    int retry_num = 0;
+    int err_no = 0;
+    do {
+      err_no = 0;
+      feasign_size = 0;
+      auto write_channel =
+          _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+      is_write_failed = !WriteDeltaHeader(write_channel.get());
+      for (auto key_it = delta_keys.begin();
+           !is_write_failed && key_it != delta_keys.end();
+           ++key_it) {
+        // the keys erased since the last checkpoint are written as tombstones
+        auto it = shard.find(*key_it);
+        if (it == shard.end()) {
+          is_write_failed =
+              !WriteDeltaRecord(write_channel.get(), *key_it, nullptr, 0);
+        } else {
+          is_write_failed = !WriteDeltaRecord(write_channel.get(),
+                                              *key_it,
+                                              it.value().data(),
+                                              it.value().size());
+        }
+        ++feasign_size;
+      }
+      is_write_failed = is_write_failed ||
+                        !WriteDeltaEnd(write_channel.get(), feasign_size);
+      write_channel->close();
+      if (is_write_failed || err_no == -1) {
+        ++retry_num;
+        is_write_failed = true;
+        LOG(ERROR) << "MemorySparseTable save delta failed, retry it! path:"
+                   << channel_config.path << " , retry_num=" << retry_num;
+        _afs_client.remove(channel_config.path);
+      }
+      if (retry_num > FLAGS_pserver_table_save_max_retry) {
+        LOG(ERROR) << "MemorySparseTable save delta failed reach max limit!";
+        exit(-1);
+      }
+    } while (is_write_failed);
+    delta_keys.clear();
+    feasign_size_all += feasign_size;
+  }
+  LOG(INFO) << "MemorySparseTable save delta success, path:"
+            << ::paddle::string::format_string(
+                   "%s/part-%03d-", table_path.c_str(), _shard_idx)
+            << " from " << file_start_idx << " to "
+            << file_start_idx + _real_local_shard_num - 1
+            << ", feasign size: " << feasign_size_all;
+  return 0;
+}
+
+template <class SHARD_TYPE>
+int64_t MemorySparseTableImpl<SHARD_TYPE>::CacheShuffle(
     const std::string &path,
     const std::string &param,
     double cache_threshold,
@@ -857,7 +1173,8 @@ int64_t MemorySparseTable::CacheShuffle(
   return 0;
 }
 
-int32_t MemorySparseTable::SaveCache(
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::SaveCache(
     const std::string &path,
     const std::string &param,
     ::paddle::framework::Channel<std::pair<uint64_t, std::string>>
@@ -906,7 +1223,8 @@ int32_t MemorySparseTable::SaveCache(
   return feasign_size;
 }
 
-int64_t MemorySparseTable::LocalSize() {
+template <class SHARD_TYPE>
+int64_t MemorySparseTableImpl<SHARD_TYPE>::LocalSize() {
   int64_t local_size = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     local_size += _local_shards[i].size();
@@ -914,7 +1232,8 @@ int64_t MemorySparseTable::LocalSize() {
   return local_size;
 }
 
-int64_t MemorySparseTable::LocalMFSize() {
+template <class SHARD_TYPE>
+int64_t MemorySparseTableImpl<SHARD_TYPE>::LocalMFSize() {
   std::vector<int64_t> size_arr(_real_local_shard_num, 0);
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   int64_t ret_size = 0;
@@ -941,13 +1260,16 @@ int64_t MemorySparseTable::LocalMFSize() {
   return ret_size;
 }
 
-std::pair<int64_t, int64_t> MemorySparseTable::PrintTableStat() {
+template <class SHARD_TYPE>
+std::pair<int64_t, int64_t>
+MemorySparseTableImpl<SHARD_TYPE>::PrintTableStat() {
   int64_t feasign_size = LocalSize();
   int64_t mf_size = LocalMFSize();
   return {feasign_size, mf_size};
 }
 
-int32_t MemorySparseTable::Pull(TableContext &context) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Pull(TableContext &context) {
   CHECK(context.value_type == Sparse);
   if (context.use_ptr) {
     char **pull_values = context.pull_context.ptr_values;
@@ -961,7 +1283,8 @@ int32_t MemorySparseTable::Pull(TableContext &context) {
   }
 }
 
-int32_t MemorySparseTable::Push(TableContext &context) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Push(TableContext &context) {
   CHECK(context.value_type == Sparse);
   if (!context.use_ptr) {
     return PushSparse(
@@ -973,8 +1296,9 @@ int32_t MemorySparseTable::Push(TableContext &context) {
   }
 }
 
-int32_t MemorySparseTable::PullSparse(float *pull_values,
-                                      const PullSparseValue &pull_value) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::PullSparse(
+    float *pull_values, const PullSparseValue &pull_value) {
   CostTimer timer("pserver_sparse_select_all");
   std::vector<std::future<int>> tasks(_real_local_shard_num);
 
@@ -990,10 +1314,13 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
       _real_local_shard_num);
   size_t num = pull_value.numel_;
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (pull_value.feasigns_[i] % _sparse_table_shard_num) %
-                   _avg_local_shard_num;
+    int shard_id = LocalShardId(pull_value.feasigns_[i]);
+    if (shard_id < 0) {
+      return RejectNonLocalKey(pull_value.feasigns_[i]);
+    }
     task_keys[shard_id].push_back({pull_value.feasigns_[i], i});
   }
+  CountShardAccess(task_keys);
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
     tasks[shard_id] =
         _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
@@ -1009,7 +1336,13 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
               float *data_buffer_ptr = data_buffer;
 
               auto &keys = task_keys[shard_id];
-              for (auto &item : keys) {
+              for (size_t i = 0; i < keys.size(); ++i) {
+                // overlap the cache misses of the following keys
+                if (i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE < keys.size()) {
+                  local_shard.prefetch(
+                      keys[i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE].first);
+                }
+                auto &item = keys[i];
                 uint64_t key = item.first;
                 auto itr = local_shard.find(key);
                 size_t data_size = value_size - mf_value_size;
@@ -1024,6 +1357,7 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
                     _value_accessor->Create(&data_buffer_ptr, 1);
                     memcpy(
                         data_ptr, data_buffer_ptr, data_size * sizeof(float));
+                    MarkDelta(shard_id, key);
                   }
                 } else {
                   data_size = itr.value().size();
@@ -1050,11 +1384,13 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
   return 0;
 }
 
-int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
-                                         char **pull_values,
-                                         const uint64_t *keys,
-                                         size_t num,
-                                         uint16_t pass_id) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::PullSparsePtr(
+    int shard_id,  // fake num
+    char **pull_values,
+    const uint64_t *keys,
+    size_t num,
+    uint16_t pass_id) {
   CostTimer timer("pscore_sparse_select_all");
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
@@ -1064,9 +1400,13 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    int shard_id = LocalShardId(keys[i]);
+    if (shard_id < 0) {
+      return RejectNonLocalKey(keys[i]);
+    }
     task_keys[shard_id].push_back({keys[i], i});
   }
+  CountShardAccess(task_keys);
   // std::atomic<uint32_t> missed_keys{0};
   for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
     tasks[shard_id] =
@@ -1081,7 +1421,12 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
               auto &local_shard = _local_shards[shard_id];
               float data_buffer[value_size];  // NOLINT
               float *data_buffer_ptr = data_buffer;
-              for (auto &item : keys) {
+              for (size_t i = 0; i < keys.size(); ++i) {
+                if (i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE < keys.size()) {
+                  local_shard.prefetch(
+                      keys[i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE].first);
+                }
+                auto &item = keys[i];
                 uint64_t key = item.first;
                 auto itr = local_shard.find(key);
                 size_t data_size = value_size - mf_value_size;
@@ -1097,6 +1442,8 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
                 } else {
                   ret = itr.value_ptr();
                 }
+                // the values are updated through the pointers by the caller
+                MarkDelta(shard_id, key);
                 int pull_data_idx = item.second;
                 pull_values[pull_data_idx] = reinterpret_cast<char *>(ret);
               }
@@ -1109,17 +1456,22 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
   return 0;
 }
 
-int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
-                                      const float *values,
-                                      size_t num) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::PushSparse(const uint64_t *keys,
+                                                      const float *values,
+                                                      size_t num) {
   CostTimer timer("pserver_sparse_update_all");
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    int shard_id = LocalShardId(keys[i]);
+    if (shard_id < 0) {
+      return RejectNonLocalKey(keys[i]);
+    }
     task_keys[shard_id].push_back({keys[i], i});
   }
+  CountShardAccess(task_keys);
 
   const size_t value_col =
       _value_accessor->GetAccessorInfo().size / sizeof(float);
@@ -1142,7 +1494,24 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
           auto &local_shard_new = _local_shards_new[shard_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
-          for (auto &item : keys) {
+          // the values updated in place are handed to the accessor in
+          // batches, unless each of them is copied right after its update
+          // for revert; their data stays in place while the shard grows
+          const bool batch_update = !_config.enable_revert();
+          float *batch_values[CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE];
+          const float *batch_update_data[CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE];
+          size_t batch_size = 0;
+          for (size_t i = 0; i < keys.size(); ++i) {
+            if (i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE < keys.size()) {
+              local_shard.prefetch(
+                  keys[i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE].first);
+            }
+            if (batch_size == CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE) {
+              _value_accessor->Update(
+                  batch_values, batch_update_data, batch_size);
+              batch_size = 0;
+            }
+            auto &item = keys[i];
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
             const float *update_data =
@@ -1168,7 +1537,13 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
             size_t value_size = feature_value.size();
 
             if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
+              if (batch_update) {
+                batch_values[batch_size] = value_data;
+                batch_update_data[batch_size] = update_data;
+                ++batch_size;
+              } else {
+                _value_accessor->Update(&value_data, &update_data, 1);
+              }
             } else {
               // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
               memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
@@ -1189,6 +1564,11 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                      value_data,
                      new_size * sizeof(float));
             }
+            MarkDelta(shard_id, key);
+          }
+          if (batch_size > 0) {
+            _value_accessor->Update(
+                batch_values, batch_update_data, batch_size);
           }
           return 0;
         });
@@ -1200,16 +1580,21 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
-int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
-                                      const float **values,
-                                      size_t num) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::PushSparse(const uint64_t *keys,
+                                                      const float **values,
+                                                      size_t num) {
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
   for (size_t i = 0; i < num; ++i) {
-    int shard_id = (keys[i] % _sparse_table_shard_num) % _avg_local_shard_num;
+    int shard_id = LocalShardId(keys[i]);
+    if (shard_id < 0) {
+      return RejectNonLocalKey(keys[i]);
+    }
     task_keys[shard_id].push_back({keys[i], i});
   }
+  CountShardAccess(task_keys);
 
   size_t value_col = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_col =
@@ -1222,7 +1607,12 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
           auto &local_shard = _local_shards[shard_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
-          for (auto &item : keys) {
+          for (size_t i = 0; i < keys.size(); ++i) {
+            if (i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE < keys.size()) {
+              local_shard.prefetch(
+                  keys[i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE].first);
+            }
+            auto &item = keys[i];
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
             const float *update_data = values[push_data_idx];
@@ -1257,6 +1647,7 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
               }
               memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             }
+            MarkDelta(shard_id, key);
           }
           return 0;
         });
@@ -1268,9 +1659,236 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
-int32_t MemorySparseTable::Flush() { return 0; }
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::RejectNonLocalKey(uint64_t key) {
+  LOG(ERROR) << "MemorySparseTable key " << key << " of shard "
+             << key % _sparse_table_shard_num << " is not kept by server "
+             << _shard_idx << ", the shard route of the client is stale";
+  return -1;
+}
+
+template <class SHARD_TYPE>
+bool MemorySparseTableImpl<SHARD_TYPE>::ShardSwappable() {
+  return !_config.enable_revert() && _delta_keys == nullptr &&
+         !_use_gpu_graph;
+}
+
+template <class SHARD_TYPE>
+bool MemorySparseTableImpl<SHARD_TYPE>::ShardsSwapped() {
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    if (_global_shard_ids[i] !=
+        static_cast<uint32_t>(_shard_idx * _avg_local_shard_num + i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class SHARD_TYPE>
+std::string MemorySparseTableImpl<SHARD_TYPE>::ShardFilePath(
+    const std::string &table_path, uint32_t shard_id, bool compress) {
+  // named after the startup layout, so that the sorted files stay in the
+  // order of the shards for Load, whichever servers save them
+  uint32_t owner = shard_id / _avg_local_shard_num;
+  return ::paddle::string::format_string(compress ? "%s/part-%03d-%05d.gz"
+                                                  : "%s/part-%03d-%05d",
+                                         table_path.c_str(),
+                                         owner,
+                                         shard_id);
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::QueryShardLoad(
+    std::vector<SparseShardLoad> *loads) {
+  loads->resize(_real_local_shard_num);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    auto &load = (*loads)[i];
+    load.shard_id = _global_shard_ids[i];
+    load.access_num = _shard_access_nums[i].exchange(0);
+    load.key_num = _local_shards[i].size();
+  }
+  return 0;
+}
+
+// |key num: 8B|[key: 8B|value size: 4B|value: 4B * size] * key num|
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::ExportShard(uint32_t shard_id,
+                                                       std::string *data) {
+  if (!ShardSwappable()) {
+    LOG(ERROR) << "MemorySparseTable shard swap is not supported with revert, "
+                  "delta checkpoints, the gpu graph or the ssd";
+    return -1;
+  }
+  if (!IsLocalShard(shard_id)) {
+    LOG(ERROR) << "MemorySparseTable shard " << shard_id
+               << " to export is not kept by server " << _shard_idx;
+    return -1;
+  }
+  int local_shard_id = _local_shard_ids[shard_id];
+  // in the task thread of the shard, after the pulls and pushes enqueued
+  _shards_task_pool[local_shard_id % _shards_task_pool.size()]
+      ->enqueue([this, local_shard_id, data]() -> int {
+        auto &local_shard = _local_shards[local_shard_id];
+        uint64_t key_num = local_shard.size();
+        data->clear();
+        data->append(reinterpret_cast<const char *>(&key_num),
+                     sizeof(key_num));
+        for (auto it = local_shard.begin(); it != local_shard.end(); ++it) {
+          uint64_t key = it.key();
+          uint32_t size = it.value().size();
+          data->append(reinterpret_cast<const char *>(&key), sizeof(key));
+          data->append(reinterpret_cast<const char *>(&size), sizeof(size));
+          data->append(reinterpret_cast<const char *>(it.value().data()),
+                       size * sizeof(float));
+        }
+        return 0;
+      })
+      .wait();
+  VLOG(0) << "MemorySparseTable export shard " << shard_id << " of server "
+          << _shard_idx << ", size " << data->size();
+  return 0;
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::ImportShard(
+    uint32_t shard_id, const std::string &data) {
+  if (!ShardSwappable()) {
+    LOG(ERROR) << "MemorySparseTable shard swap is not supported with revert, "
+                  "delta checkpoints, the gpu graph or the ssd";
+    return -1;
+  }
+  if (shard_id >= static_cast<uint32_t>(_sparse_table_shard_num) ||
+      IsLocalShard(shard_id)) {
+    LOG(ERROR) << "MemorySparseTable shard " << shard_id
+               << " to import is kept by server " << _shard_idx
+               << " already or out of range";
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(_shard_route_mutex);
+  if (data.empty()) {
+    _imported_shards.erase(shard_id);
+    return 0;
+  }
+  // checks the records, so that SwitchShard can not fail halfway
+  uint64_t key_num = 0;
+  if (data.size() < sizeof(key_num)) {
+    LOG(ERROR) << "MemorySparseTable shard " << shard_id << " data is broken";
+    return -1;
+  }
+  memcpy(&key_num, data.data(), sizeof(key_num));
+  size_t pos = sizeof(key_num);
+  for (uint64_t i = 0; i < key_num; ++i) {
+    uint32_t size = 0;
+    if (pos + sizeof(uint64_t) + sizeof(size) > data.size()) {
+      pos = data.size() + 1;
+      break;
+    }
+    memcpy(&size, data.data() + pos + sizeof(uint64_t), sizeof(size));
+    pos += sizeof(uint64_t) + sizeof(size) + size * sizeof(float);
+  }
+  if (pos != data.size()) {
+    LOG(ERROR) << "MemorySparseTable shard " << shard_id << " data is broken";
+    return -1;
+  }
+  _imported_shards[shard_id] = data;
+  return 0;
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::SwitchShard(uint32_t shard_out,
+                                                       uint32_t shard_in) {
+  if (!IsLocalShard(shard_out)) {
+    LOG(ERROR) << "MemorySparseTable shard " << shard_out
+               << " to switch out is not kept by server " << _shard_idx;
+    return -1;
+  }
+  std::string data;
+  {
+    std::lock_guard<std::mutex> lock(_shard_route_mutex);
+    auto it = _imported_shards.find(shard_in);
+    if (it == _imported_shards.end()) {
+      LOG(ERROR) << "MemorySparseTable shard " << shard_in
+                 << " to switch in is not imported to server " << _shard_idx;
+      return -1;
+    }
+    data.swap(it->second);
+    _imported_shards.erase(it);
+  }
+  int local_shard_id = _local_shard_ids[shard_out];
+  _shards_task_pool[local_shard_id % _shards_task_pool.size()]
+      ->enqueue([this, local_shard_id, &data]() -> int {
+        auto &local_shard = _local_shards[local_shard_id];
+        local_shard.clear();
+        uint64_t key_num = 0;
+        memcpy(&key_num, data.data(), sizeof(key_num));
+        const char *pos = data.data() + sizeof(key_num);
+        for (uint64_t i = 0; i < key_num; ++i) {
+          uint64_t key = 0;
+          uint32_t size = 0;
+          memcpy(&key, pos, sizeof(key));
+          memcpy(&size, pos + sizeof(key), sizeof(size));
+          pos += sizeof(key) + sizeof(size);
+          auto &value = local_shard[key];
+          value.resize(size);
+          memcpy(value.data(), pos, size * sizeof(float));
+          pos += size * sizeof(float);
+        }
+        return 0;
+      })
+      .wait();
+  if (!ShardsSwapped()) {
+    // the keys of the other servers are rejected from the first swap on
+    for (int i = 0; i < _sparse_table_shard_num; ++i) {
+      if (!IsLocalShard(i)) {
+        _local_shard_ids[i] = -1;
+      }
+    }
+  }
+  _local_shard_ids[shard_out] = -1;
+  _local_shard_ids[shard_in] = local_shard_id;
+  _global_shard_ids[local_shard_id] = shard_in;
+  _shard_access_nums[local_shard_id] = 0;
+  VLOG(0) << "MemorySparseTable server " << _shard_idx << " switch shard "
+          << shard_out << " for shard " << shard_in;
+  return 0;
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::SetShardRoute(
+    const SparseShardRoute &route) {
+  if (route.ShardNum() != static_cast<size_t>(_sparse_table_shard_num)) {
+    LOG(ERROR) << "MemorySparseTable shard route has " << route.ShardNum()
+               << " shards, but the table has " << _sparse_table_shard_num;
+    return -1;
+  }
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    if (route.Owner(_global_shard_ids[i]) !=
+        static_cast<uint32_t>(_shard_idx)) {
+      LOG(ERROR) << "MemorySparseTable shard route maps shard "
+                 << _global_shard_ids[i] << " to server "
+                 << route.Owner(_global_shard_ids[i]) << ", but server "
+                 << _shard_idx << " keeps it";
+      return -1;
+    }
+  }
+  std::lock_guard<std::mutex> lock(_shard_route_mutex);
+  _shard_route = route;
+  return 0;
+}
 
-int32_t MemorySparseTable::Shrink(const std::string &param) {
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::GetShardRoute(
+    SparseShardRoute *route) {
+  std::lock_guard<std::mutex> lock(_shard_route_mutex);
+  *route = _shard_route;
+  return 0;
+}
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Flush() { return 0; }
+
+template <class SHARD_TYPE>
+int32_t MemorySparseTableImpl<SHARD_TYPE>::Shrink(const std::string &param) {
   VLOG(0) << "MemorySparseTable::Shrink";
   std::atomic<uint32_t> shrink_size_all{0};
   int thread_num = _real_local_shard_num;
@@ -1282,6 +1900,7 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
     auto &shard = _local_shards[shard_id];
     for (auto it = shard.begin(); it != shard.end();) {
       if (_value_accessor->Shrink(it.value().data())) {
+        MarkDelta(shard_id, it.key());
         it = shard.erase(it);
         ++feasign_size;
       } else {
@@ -1295,6 +1914,14 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
   return 0;
 }
 
-void MemorySparseTable::Clear() { VLOG(0) << "clear coming soon"; }
+template <class SHARD_TYPE>
+void MemorySparseTableImpl<SHARD_TYPE>::Clear() {
+  VLOG(0) << "clear coming soon";
+}
+
+template class MemorySparseTableImpl<
+    SparseTableShard<uint64_t, FixedFeatureValue>>;
+template class MemorySparseTableImpl<
+    FlatSparseTableShard<uint64_t, FixedFeatureValue>>;
 
 }  // namespace paddle::distributed
@@ -18,10 +18,12 @@
 #include <assert.h>
 #include <pthread.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -36,11 +38,13 @@
 namespace paddle {
 namespace distributed {
 
-class MemorySparseTable : public Table {
+// The sparse table kept in the memory, whose local shards are SHARD_TYPE.
+template <class SHARD_TYPE>
+class MemorySparseTableImpl : public Table {
  public:
-  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
-  MemorySparseTable() {}
-  virtual ~MemorySparseTable() {}
+  typedef SHARD_TYPE shard_type;
+  MemorySparseTableImpl() {}
+  virtual ~MemorySparseTableImpl() {}
 
   // unused method end
   static int32_t sparse_local_shard_num(uint32_t shard_num,
@@ -114,10 +118,66 @@ class MemorySparseTable : public Table {
   virtual void Revert();
   virtual void CheckSavePrePatchDone();
 
+  // The swaps of the shards are not supported with revert, delta checkpoints,
+  // the gpu graph or the ssd, whose local shards are tied to the global ones.
+  int32_t QueryShardLoad(std::vector<SparseShardLoad>* loads) override;
+  int32_t ExportShard(uint32_t shard_id, std::string* data) override;
+  int32_t ImportShard(uint32_t shard_id, const std::string& data) override;
+  int32_t SwitchShard(uint32_t shard_out, uint32_t shard_in) override;
+  int32_t SetShardRoute(const SparseShardRoute& route) override;
+  int32_t GetShardRoute(SparseShardRoute* route) override;
+
  protected:
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
+  // Writes the values changed since the last checkpoint of the local shards
+  // into the binary delta files, see MergeSparseTableDeltas for the format.
+  virtual int32_t SaveDelta(const std::string& path);
+  virtual int32_t LoadDelta(const std::vector<std::string>& file_list);
+
+  // Records the key whose value is created, updated or erased in the local
+  // shard since the last checkpoint.
+  inline void MarkDelta(int shard_id, uint64_t key) {
+    if (_delta_keys != nullptr) {
+      _delta_keys[shard_id].insert(key);
+    }
+  }
+
+  // The local shard of the key, or -1 if the server does not keep the key
+  // after a swap of the shards. Before any swap every key maps to a local
+  // shard as (key % shard_num) % avg_local_shard_num.
+  inline int LocalShardId(uint64_t key) {
+    return _local_shard_ids[key % _sparse_table_shard_num].load(
+        std::memory_order_relaxed);
+  }
+  inline bool IsLocalShard(uint32_t shard_id) {
+    if (shard_id >= static_cast<uint32_t>(_sparse_table_shard_num)) {
+      return false;
+    }
+    int local_shard_id = _local_shard_ids[shard_id];
+    return local_shard_id >= 0 && _global_shard_ids[local_shard_id] == shard_id;
+  }
+  // Logs the key of a shard on another server, which the client routes by a
+  // stale route, and returns -1.
+  int32_t RejectNonLocalKey(uint64_t key);
+  inline void CountShardAccess(
+      const std::vector<std::vector<std::pair<uint64_t, int>>>& task_keys) {
+    for (size_t i = 0; i < task_keys.size(); ++i) {
+      if (!task_keys[i].empty()) {
+        _shard_access_nums[i].fetch_add(task_keys[i].size(),
+                                        std::memory_order_relaxed);
+      }
+    }
+  }
+  virtual bool ShardSwappable();
+  // Whether any local shard has been swapped for a shard of another server.
+  bool ShardsSwapped();
+  // The path of the file of a shard in the checkpoints, which is named after
+  // the server which keeps the shard at startup.
+  std::string ShardFilePath(const std::string& table_path,
+                            uint32_t shard_id,
+                            bool compress);
 
   int _task_pool_size = 24;
   int _avg_local_shard_num;
@@ -125,6 +185,17 @@ class MemorySparseTable : public Table {
   int _sparse_table_shard_num;
   std::vector<std::shared_ptr<::ThreadPool>> _shards_task_pool;
   std::unique_ptr<shard_type[]> _local_shards;
+  // the local shard of every global shard, see LocalShardId, the global
+  // shard of every local one and the keys pulled and pushed of every local
+  // one since the last QueryShardLoad
+  std::unique_ptr<std::atomic<int>[]> _local_shard_ids;
+  std::vector<uint32_t> _global_shard_ids;
+  std::unique_ptr<std::atomic<uint64_t>[]> _shard_access_nums;
+  // the route of the whole table for the clients, and the shards imported
+  // from the other servers for SwitchShard
+  std::mutex _shard_route_mutex;
+  SparseShardRoute _shard_route;
+  std::unordered_map<uint32_t, std::string> _imported_shards;
 
   // for patch model
   int _m_avg_local_shard_num;
@@ -137,7 +208,38 @@ class MemorySparseTable : public Table {
   std::unique_ptr<shard_type[]> _local_shards_patch_model;
   std::thread _save_patch_model_thread;
   bool _use_gpu_graph = false;
+
+  // for delta checkpoint, the changed keys of each local shard, which are
+  // looked up on save so that the erased ones are written as tombstones
+  std::unique_ptr<std::unordered_set<uint64_t>[]> _delta_keys;
 };
 
+extern template class MemorySparseTableImpl<
+    SparseTableShard<uint64_t, FixedFeatureValue>>;
+extern template class MemorySparseTableImpl<
+    FlatSparseTableShard<uint64_t, FixedFeatureValue>>;
+
+typedef MemorySparseTableImpl<SparseTableShard<uint64_t, FixedFeatureValue>>
+    MemorySparseTable;
+// It is selected by table_class "MemoryFlatSparseTable" in TableParameter.
+// Its shards keep the keys in open addressing hash maps, which take less
+// memory per key and fewer cache misses per lookup than those of
+// MemorySparseTable, for the tables of billions of keys.
+typedef MemorySparseTableImpl<FlatSparseTableShard<uint64_t, FixedFeatureValue>>
+    MemoryFlatSparseTable;
+
+// Merges the delta files of one shard saved by the successive delta
+// checkpoints, from the oldest to the newest, into a single delta file, so
+// that a table can be restored by loading the last full checkpoint and then
+// one delta instead of the whole chain. A delta file is binary:
+//   uint32 magic, uint32 version
+//   records of uint64 key, uint32 size, float[size], where a record of size
+//   0 erases the key
+//   uint64 record count, uint32 0xFFFFFFFF as the end of the file
+// Returns the number of the records written, or -1 if any file is broken.
+int64_t MergeSparseTableDeltas(AfsClient* fs_client,
+                               const std::vector<std::string>& delta_paths,
+                               const std::string& output_path);
+
 }  // namespace distributed
 }  // namespace paddle
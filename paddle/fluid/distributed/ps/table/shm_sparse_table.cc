@@ -0,0 +1,635 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/shm_sparse_table.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <omp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/utils/string/string_helper.h"
+
+PD_DEFINE_string(pserver_shm_sparse_table_name,
+                 "paddle_ps",
+                 "the prefix of the shared memory segments of the "
+                 "ShmSparseTables, which should be unique for every job on a "
+                 "host");
+PD_DEFINE_int64(pserver_shm_sparse_table_capacity,
+                1 << 22,
+                "the entries of a ShmSparseTable of all the shards, at most "
+                "90% of which are filled by the keys");
+PD_DEFINE_int32(pserver_shm_sparse_table_open_timeout_s,
+                300,
+                "the seconds the trainers wait for the trainer 0 to create "
+                "the ShmSparseTables");
+PD_DECLARE_bool(pserver_create_value_when_push);
+PD_DECLARE_bool(pserver_enable_create_feasign_randomly);
+
+namespace paddle::distributed {
+
+constexpr uint64_t kShmSparseTableMagic = 0x5044534D54424C45;  // PDSMTBLE
+
+// set when the segment is initialized, the other fields are checked against
+// the config of the table which opens it
+struct ShmSparseTableHeader {
+  uint64_t shard_num;
+  uint64_t shard_capacity;
+  uint64_t entry_size;
+  pid_t owner_pid;
+  std::atomic<uint64_t> magic;
+};
+
+struct alignas(64) ShmSparseShardHeader {
+  pthread_mutex_t mutex;
+  uint64_t size;  // the keys
+};
+
+static size_t AlignUp(size_t size, size_t align) {
+  return (size + align - 1) / align * align;
+}
+
+static size_t ShardsOffset() {
+  return AlignUp(sizeof(ShmSparseTableHeader), alignof(ShmSparseShardHeader));
+}
+
+ShmSparseTable::~ShmSparseTable() {
+  if (_addr != nullptr) {
+    munmap(_addr, _size);
+    if (_is_owner) {
+      shm_unlink(_name.c_str());
+    }
+  }
+}
+
+int32_t ShmSparseTable::Initialize() {
+  const auto &info = _value_accessor->GetAccessorInfo();
+  _value_col = info.size / sizeof(float);
+  _mf_value_col = info.mf_size / sizeof(float);
+  _select_value_col = info.select_size / sizeof(float);
+  _update_value_col = info.update_size / sizeof(float);
+  _shard_num_all = _config.shard_num();
+  if (_shard_num_all == 0) {
+    LOG(ERROR) << "ShmSparseTable shard_num is 0";
+    return -1;
+  }
+  size_t capacity =
+      (FLAGS_pserver_shm_sparse_table_capacity + _shard_num_all - 1) /
+      _shard_num_all;
+  _shard_capacity = 16;
+  while (_shard_capacity < capacity) {
+    _shard_capacity <<= 1;
+  }
+  _entry_size = AlignUp(sizeof(Entry) + _value_col * sizeof(float), 8);
+  _size = ShardsOffset() + _shard_num_all * sizeof(ShmSparseShardHeader) +
+          _shard_num_all * _shard_capacity * _entry_size;
+  _name = "/" + FLAGS_pserver_shm_sparse_table_name + "_" +
+          std::to_string(_config.table_id());
+  int32_t ret = _is_owner ? CreateSegment() : OpenSegment();
+  if (ret != 0) {
+    return ret;
+  }
+  _shards = reinterpret_cast<ShmSparseShardHeader *>(
+      static_cast<char *>(_addr) + ShardsOffset());
+  _entries = reinterpret_cast<char *>(_shards + _shard_num_all);
+  VLOG(0) << "ShmSparseTable " << _name << (_is_owner ? " created" : " opened")
+          << ", shard_num: " << _shard_num_all
+          << ", shard_capacity: " << _shard_capacity << ", size: " << _size;
+  return 0;
+}
+
+int32_t ShmSparseTable::CreateSegment() {
+  // remove the segment left by a killed job
+  shm_unlink(_name.c_str());
+  int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd == -1) {
+    LOG(ERROR) << "ShmSparseTable create the shared memory " << _name
+               << " failed, " << strerror(errno);
+    return -1;
+  }
+  if (ftruncate(fd, static_cast<off_t>(_size)) != 0) {
+    LOG(ERROR) << "ShmSparseTable set the size of the shared memory " << _name
+               << " to " << _size << " failed, " << strerror(errno);
+    close(fd);
+    shm_unlink(_name.c_str());
+    return -1;
+  }
+  _addr = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (_addr == MAP_FAILED) {
+    _addr = nullptr;
+    LOG(ERROR) << "ShmSparseTable map the shared memory " << _name
+               << " failed, " << strerror(errno);
+    shm_unlink(_name.c_str());
+    return -1;
+  }
+
+  // the entries are zeros, so empty, after ftruncate
+  _header = static_cast<ShmSparseTableHeader *>(_addr);
+  auto *shards = reinterpret_cast<ShmSparseShardHeader *>(
+      static_cast<char *>(_addr) + ShardsOffset());
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  // a trainer killed in a pull or push does not lock the others out
+  pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+  for (size_t i = 0; i < _shard_num_all; ++i) {
+    pthread_mutex_init(&shards[i].mutex, &mutex_attr);
+    shards[i].size = 0;
+  }
+  pthread_mutexattr_destroy(&mutex_attr);
+  _header->shard_num = _shard_num_all;
+  _header->shard_capacity = _shard_capacity;
+  _header->entry_size = _entry_size;
+  _header->owner_pid = getpid();
+  _header->magic.store(kShmSparseTableMagic, std::memory_order_release);
+  return 0;
+}
+
+int32_t ShmSparseTable::OpenSegment() {
+  auto deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::seconds(FLAGS_pserver_shm_sparse_table_open_timeout_s);
+  while (true) {
+    int fd = shm_open(_name.c_str(), O_RDWR, 0600);
+    struct stat st;
+    if (fd != -1 && fstat(fd, &st) == 0 &&
+        static_cast<size_t>(st.st_size) == _size) {
+      void *addr =
+          mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (addr != MAP_FAILED) {
+        auto *header = static_cast<ShmSparseTableHeader *>(addr);
+        // a segment of a dead owner is left by a killed job, so the owner
+        // of this job will replace it
+        if (header->magic.load(std::memory_order_acquire) ==
+                kShmSparseTableMagic &&
+            (kill(header->owner_pid, 0) == 0 || errno == EPERM)) {
+          close(fd);
+          if (header->shard_num != _shard_num_all ||
+              header->shard_capacity != _shard_capacity ||
+              header->entry_size != _entry_size) {
+            LOG(ERROR) << "ShmSparseTable the shared memory " << _name
+                       << " is created by another config";
+            munmap(addr, _size);
+            return -1;
+          }
+          _addr = addr;
+          _header = header;
+          return 0;
+        }
+        munmap(addr, _size);
+      }
+    }
+    if (fd != -1) {
+      close(fd);
+    }
+    if (std::chrono::steady_clock::now() > deadline) {
+      LOG(ERROR) << "ShmSparseTable open the shared memory " << _name
+                 << " timeout, is the trainer 0 started?";
+      return -1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+ShmSparseTable::Entry *ShmSparseTable::EntryAt(size_t shard_id,
+                                               size_t slot) const {
+  return reinterpret_cast<Entry *>(
+      _entries + (shard_id * _shard_capacity + slot) * _entry_size);
+}
+
+static inline size_t HomeSlot(uint64_t key, size_t shard_num, size_t mask) {
+  // the keys of a shard are congruent modulo shard_num
+  uint64_t hash = (key / shard_num) * 0x9E3779B97F4A7C15ULL;
+  return (hash ^ (hash >> 29)) & mask;
+}
+
+ShmSparseTable::Entry *ShmSparseTable::Find(size_t shard_id,
+                                            uint64_t key,
+                                            bool create,
+                                            bool *created) {
+  const size_t mask = _shard_capacity - 1;
+  for (size_t slot = HomeSlot(key, _shard_num_all, mask);;
+       slot = (slot + 1) & mask) {
+    Entry *entry = EntryAt(shard_id, slot);
+    if (entry->size != 0) {
+      if (entry->key == key) {
+        return entry;
+      }
+      continue;
+    }
+    // the shards are at most 90% full, so an empty entry ends every probe
+    auto &shard = _shards[shard_id];
+    if (!create || (shard.size + 1) * 10 > _shard_capacity * 9) {
+      return nullptr;
+    }
+    ++shard.size;
+    entry->key = key;
+    *created = true;
+    return entry;
+  }
+}
+
+void ShmSparseTable::Erase(size_t shard_id, Entry *entry) {
+  const size_t mask = _shard_capacity - 1;
+  size_t hole =
+      (reinterpret_cast<char *>(entry) - reinterpret_cast<char *>(EntryAt(
+                                             shard_id, 0))) /
+      _entry_size;
+  entry->size = 0;
+  --_shards[shard_id].size;
+  for (size_t slot = (hole + 1) & mask;; slot = (slot + 1) & mask) {
+    Entry *next = EntryAt(shard_id, slot);
+    if (next->size == 0) {
+      return;
+    }
+    // moves the entry into the hole if the hole is in its probe
+    size_t home = HomeSlot(next->key, _shard_num_all, mask);
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      memcpy(EntryAt(shard_id, hole), next, _entry_size);
+      next->size = 0;
+      hole = slot;
+    }
+  }
+}
+
+void ShmSparseTable::LockShard(size_t shard_id) {
+  if (pthread_mutex_lock(&_shards[shard_id].mutex) == EOWNERDEAD) {
+    LOG(WARNING) << "ShmSparseTable " << _name << " shard " << shard_id
+                 << " is recovered from a dead trainer";
+    pthread_mutex_consistent(&_shards[shard_id].mutex);
+  }
+}
+
+void ShmSparseTable::UnlockShard(size_t shard_id) {
+  pthread_mutex_unlock(&_shards[shard_id].mutex);
+}
+
+void ShmSparseTable::SortByShard(
+    const uint64_t *keys,
+    size_t num,
+    std::vector<std::pair<uint32_t, uint32_t>> *order) const {
+  order->resize(num);
+  for (size_t i = 0; i < num; ++i) {
+    (*order)[i] = {static_cast<uint32_t>(ShardId(keys[i])),
+                   static_cast<uint32_t>(i)};
+  }
+  std::sort(order->begin(), order->end());
+}
+
+int32_t ShmSparseTable::Pull(TableContext &context) {
+  CHECK(context.value_type == Sparse);
+  if (context.use_ptr) {
+    LOG(ERROR) << "ShmSparseTable does not support the pull of the pointers "
+                  "of the values";
+    return -1;
+  }
+  return PullSparse(context.pull_context.values,
+                    context.pull_context.pull_value);
+}
+
+int32_t ShmSparseTable::Push(TableContext &context) {
+  CHECK(context.value_type == Sparse);
+  if (context.use_ptr) {
+    const float **values = context.push_context.ptr_values;
+    return PushSparse(
+        context.push_context.keys,
+        [values](size_t i) { return values[i]; },
+        context.num);
+  }
+  const float *values = context.push_context.values;
+  size_t update_value_col = _update_value_col;
+  return PushSparse(
+      context.push_context.keys,
+      [values, update_value_col](size_t i) {
+        return values + i * update_value_col;
+      },
+      context.num);
+}
+
+int32_t ShmSparseTable::PullSparse(float *pull_values,
+                                   const PullSparseValue &pull_value) {
+  std::vector<std::pair<uint32_t, uint32_t>> order;
+  SortByShard(pull_value.feasigns_, pull_value.numel_, &order);
+  std::vector<float> data_buffer(_value_col);
+  float *data_buffer_ptr = data_buffer.data();
+  const size_t data_size = _value_col - _mf_value_col;
+  bool is_full = false;
+  for (size_t begin = 0; begin < order.size();) {
+    size_t shard_id = order[begin].first;
+    size_t end = begin;
+    LockShard(shard_id);
+    for (; end < order.size() && order[end].first == shard_id; ++end) {
+      size_t offset = order[end].second;
+      uint64_t key = pull_value.feasigns_[offset];
+      bool created = false;
+      Entry *entry =
+          Find(shard_id, key, !FLAGS_pserver_create_value_when_push, &created);
+      if (entry == nullptr) {
+        is_full = is_full || !FLAGS_pserver_create_value_when_push;
+        memset(data_buffer_ptr, 0, sizeof(float) * _value_col);
+      } else {
+        if (created) {
+          _value_accessor->Create(&data_buffer_ptr, 1);
+          memcpy(EntryData(entry), data_buffer_ptr, data_size * sizeof(float));
+          entry->size = data_size;
+        }
+        memcpy(data_buffer_ptr, EntryData(entry), entry->size * sizeof(float));
+        for (size_t mf_idx = entry->size; mf_idx < _value_col; ++mf_idx) {
+          data_buffer[mf_idx] = 0.0;
+        }
+      }
+      float *select_data = pull_values + _select_value_col * offset;
+      _value_accessor->Select(
+          &select_data, (const float **)&data_buffer_ptr, 1);
+    }
+    UnlockShard(shard_id);
+    begin = end;
+  }
+  if (is_full) {
+    LOG(ERROR) << "ShmSparseTable " << _name << " is full, please increase "
+               << "FLAGS_pserver_shm_sparse_table_capacity";
+    return -1;
+  }
+  return 0;
+}
+
+int32_t ShmSparseTable::PushSparse(
+    const uint64_t *keys,
+    const std::function<const float *(size_t)> &update_values,
+    size_t num) {
+  std::vector<std::pair<uint32_t, uint32_t>> order;
+  SortByShard(keys, num, &order);
+  std::vector<float> data_buffer(_value_col);
+  float *data_buffer_ptr = data_buffer.data();
+  // the values updated in place are handed to the accessor in batches, the
+  // entries stay in place while the lock of the shard is held
+  float *batch_values[CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE];
+  const float *batch_update_data[CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE];
+  size_t batch_size = 0;
+  bool is_full = false;
+  for (size_t begin = 0; begin < order.size();) {
+    size_t shard_id = order[begin].first;
+    size_t end = begin;
+    LockShard(shard_id);
+    for (; end < order.size() && order[end].first == shard_id; ++end) {
+      if (batch_size == CTR_SPARSE_SHARD_UPDATE_BATCH_SIZE) {
+        _value_accessor->Update(batch_values, batch_update_data, batch_size);
+        batch_size = 0;
+      }
+      size_t offset = order[end].second;
+      uint64_t key = keys[offset];
+      const float *update_data = update_values(offset);
+      Entry *entry = Find(shard_id, key, false, nullptr);
+      if (entry == nullptr) {
+        if (FLAGS_pserver_enable_create_feasign_randomly &&
+            !_value_accessor->CreateValue(1, update_data)) {
+          continue;
+        }
+        bool created = false;
+        entry = Find(shard_id, key, true, &created);
+        if (entry == nullptr) {
+          is_full = true;
+          continue;
+        }
+        size_t value_size = _value_col - _mf_value_col;
+        _value_accessor->Create(&data_buffer_ptr, 1);
+        memcpy(EntryData(entry), data_buffer_ptr, value_size * sizeof(float));
+        entry->size = value_size;
+      }
+
+      float *value_data = EntryData(entry);
+      size_t value_size = entry->size;
+      if (value_size == _value_col) {
+        batch_values[batch_size] = value_data;
+        batch_update_data[batch_size] = update_data;
+        ++batch_size;
+      } else {
+        // updates a copy, whose mf is created in the entry if it is needed
+        memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+        _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+        if (_value_accessor->NeedExtendMF(data_buffer_ptr)) {
+          entry->size = _value_col;
+          _value_accessor->Create(&value_data, 1);
+        }
+        memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+      }
+    }
+    if (batch_size > 0) {
+      _value_accessor->Update(batch_values, batch_update_data, batch_size);
+      batch_size = 0;
+    }
+    UnlockShard(shard_id);
+    begin = end;
+  }
+  if (is_full) {
+    LOG(ERROR) << "ShmSparseTable " << _name << " is full, please increase "
+               << "FLAGS_pserver_shm_sparse_table_capacity";
+    return -1;
+  }
+  return 0;
+}
+
+int32_t ShmSparseTable::Load(const std::string &path,
+                             const std::string &param) {
+  if (!_is_owner) {
+    return 0;
+  }
+  std::string table_path = TableDir(path);
+  auto file_list = _afs_client.list(table_path);
+  std::sort(file_list.begin(), file_list.end());
+  if (file_list.size() != _shard_num_all) {
+    LOG(WARNING) << "ShmSparseTable file_size:" << file_list.size()
+                 << " not equal to shard_num:" << _shard_num_all;
+    return -1;
+  }
+  int load_param = atoi(param.c_str());
+  std::atomic<uint32_t> failed_num{0};
+  omp_set_num_threads(std::min<int>(_shard_num_all, 15));
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < _shard_num_all; ++i) {
+    FsChannelConfig channel_config = {};
+    channel_config.path = file_list[i];
+    channel_config.converter = _value_accessor->Converter(load_param).converter;
+    channel_config.deconverter =
+        _value_accessor->Converter(load_param).deconverter;
+    int err_no = 0;
+    auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+    std::string line_data;
+    char *end = nullptr;
+    LockShard(i);
+    while (read_channel->read_line(line_data) == 0 && line_data.size() > 1) {
+      uint64_t key = std::strtoul(line_data.data(), &end, 10);
+      bool created = false;
+      Entry *entry = Find(ShardId(key), key, true, &created);
+      if (ShardId(key) != i || entry == nullptr) {
+        ++failed_num;
+        break;
+      }
+      entry->size = _value_accessor->ParseFromString(++end, EntryData(entry));
+    }
+    UnlockShard(i);
+    read_channel->close();
+    if (err_no == -1) {
+      ++failed_num;
+    }
+  }
+  if (failed_num > 0) {
+    LOG(ERROR) << "ShmSparseTable load " << path << " failed, the files are "
+               << "broken or the table is full";
+    return -1;
+  }
+  VLOG(0) << "ShmSparseTable load success, path:" << path;
+  return 0;
+}
+
+int32_t ShmSparseTable::Save(const std::string &path,
+                             const std::string &param) {
+  if (!_is_owner) {
+    return 0;
+  }
+  int save_param = atoi(param.c_str());
+  std::string table_path = TableDir(path);
+  _afs_client.remove(::paddle::string::format_string(
+      "%s/part-%03d-*", table_path.c_str(), _shard_idx));
+  std::atomic<uint32_t> feasign_size_all{0};
+  std::atomic<uint32_t> failed_num{0};
+  omp_set_num_threads(std::min<int>(_shard_num_all, 20));
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < _shard_num_all; ++i) {
+    // the same files as MemorySparseTable on one server
+    FsChannelConfig channel_config = {};
+    channel_config.path = ::paddle::string::format_string(
+        _config.compress_in_save() && (save_param == 0 || save_param == 3)
+            ? "%s/part-%03d-%05d.gz"
+            : "%s/part-%03d-%05d",
+        table_path.c_str(),
+        _shard_idx,
+        i);
+    channel_config.converter = _value_accessor->Converter(save_param).converter;
+    channel_config.deconverter =
+        _value_accessor->Converter(save_param).deconverter;
+    int err_no = 0;
+    auto write_channel =
+        _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+    LockShard(i);
+    for (size_t slot = 0; slot < _shard_capacity; ++slot) {
+      Entry *entry = EntryAt(i, slot);
+      if (entry->size == 0 ||
+          !_value_accessor->Save(EntryData(entry), save_param)) {
+        continue;
+      }
+      std::string format_value =
+          _value_accessor->ParseToString(EntryData(entry), entry->size);
+      if (0 != write_channel->write_line(::paddle::string::format_string(
+                   "%lu %s", entry->key, format_value.c_str()))) {
+        ++failed_num;
+        break;
+      }
+      ++feasign_size_all;
+    }
+    for (size_t slot = 0; slot < _shard_capacity; ++slot) {
+      Entry *entry = EntryAt(i, slot);
+      if (entry->size != 0) {
+        _value_accessor->UpdateStatAfterSave(EntryData(entry), save_param);
+      }
+    }
+    UnlockShard(i);
+    write_channel->close();
+    if (err_no == -1) {
+      ++failed_num;
+    }
+  }
+  if (failed_num > 0) {
+    LOG(ERROR) << "ShmSparseTable save " << path << " failed";
+    return -1;
+  }
+  VLOG(0) << "ShmSparseTable save success, feasign size:" << feasign_size_all;
+  return 0;
+}
+
+int32_t ShmSparseTable::Shrink(const std::string &param UNUSED) {
+  if (!_is_owner) {
+    return 0;
+  }
+  std::atomic<uint32_t> shrink_size_all{0};
+  omp_set_num_threads(std::min<int>(_shard_num_all, 20));
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < _shard_num_all; ++i) {
+    // the erases move the entries, so the keys are collected first, and
+    // every value is shrunk once
+    std::vector<uint64_t> keys;
+    LockShard(i);
+    for (size_t slot = 0; slot < _shard_capacity; ++slot) {
+      Entry *entry = EntryAt(i, slot);
+      if (entry->size != 0 && _value_accessor->Shrink(EntryData(entry))) {
+        keys.push_back(entry->key);
+      }
+    }
+    for (auto key : keys) {
+      Erase(i, Find(i, key, false, nullptr));
+    }
+    UnlockShard(i);
+    shrink_size_all += keys.size();
+  }
+  VLOG(0) << "ShmSparseTable::Shrink success, shrink size:" << shrink_size_all;
+  return 0;
+}
+
+void ShmSparseTable::Clear() {
+  if (!_is_owner) {
+    return;
+  }
+  for (size_t i = 0; i < _shard_num_all; ++i) {
+    LockShard(i);
+    for (size_t slot = 0; slot < _shard_capacity; ++slot) {
+      EntryAt(i, slot)->size = 0;
+    }
+    _shards[i].size = 0;
+    UnlockShard(i);
+  }
+}
+
+std::pair<int64_t, int64_t> ShmSparseTable::PrintTableStat() {
+  int64_t feasign_size = 0;
+  int64_t mf_size = 0;
+  for (size_t i = 0; i < _shard_num_all; ++i) {
+    LockShard(i);
+    for (size_t slot = 0; slot < _shard_capacity; ++slot) {
+      Entry *entry = EntryAt(i, slot);
+      if (entry->size != 0) {
+        ++feasign_size;
+        if (entry->size == _value_col) {
+          ++mf_size;
+        }
+      }
+    }
+    UnlockShard(i);
+  }
+  return {feasign_size, mf_size};
+}
+
+}  // namespace paddle::distributed
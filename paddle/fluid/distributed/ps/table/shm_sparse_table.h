@@ -0,0 +1,122 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/accessor.h"
+#include "paddle/fluid/distributed/ps/table/common_table.h"
+#include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+
+namespace paddle {
+namespace distributed {
+
+struct ShmSparseTableHeader;
+struct ShmSparseShardHeader;
+
+// A sparse table in a shared memory segment, which all the trainer processes
+// on a host pull and push directly through PsLocalClient, without the pserver
+// and its rpc. The values are kept as in MemorySparseTable, so the two tables
+// share the accessors and the checkpoints, but every shard is a fixed size
+// hash table with linear probing, guarded by its own process shared mutex.
+// The owner, the trainer 0, creates the segment of the table and does the
+// Save, Load, Shrink and Clear, and the other trainers open it by name.
+class ShmSparseTable : public Table {
+ public:
+  ShmSparseTable() {}
+  virtual ~ShmSparseTable();
+
+  // Called before Initialize.
+  void SetOwner(bool is_owner) { _is_owner = is_owner; }
+
+  int32_t Initialize() override;
+  int32_t InitializeShard() override { return 0; }
+
+  int32_t Pull(TableContext& context) override;
+  int32_t Push(TableContext& context) override;
+
+  int32_t Load(const std::string& path, const std::string& param) override;
+  int32_t Save(const std::string& path, const std::string& param) override;
+#if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
+  int32_t Save_v2(const std::string& path, const std::string& param) override {
+    return Save(path, param);
+  }
+#endif
+  int32_t Flush() override { return 0; }
+  int32_t Shrink(const std::string& param) override;
+  void Clear() override;
+
+  void* GetShard(size_t shard_idx UNUSED) override { return nullptr; }
+  std::pair<int64_t, int64_t> PrintTableStat() override;
+
+  int32_t PullSparse(float* pull_values, const PullSparseValue& pull_value);
+  // update_values(i) is the push value of keys[i]
+  int32_t PushSparse(const uint64_t* keys,
+                     const std::function<const float*(size_t)>& update_values,
+                     size_t num);
+
+ protected:
+  struct Entry {
+    uint64_t key;
+    uint32_t size;  // the floats of the value, 0 for an empty entry
+    uint32_t reserved;
+  };
+  static inline float* EntryData(Entry* entry) {
+    return reinterpret_cast<float*>(entry + 1);
+  }
+
+  inline size_t ShardId(uint64_t key) const { return key % _shard_num_all; }
+  Entry* EntryAt(size_t shard_id, size_t slot) const;
+  // The entry of the key, nullptr if it is missing and create is false or
+  // the shard is full. Called with the lock of the shard.
+  Entry* Find(size_t shard_id, uint64_t key, bool create, bool* created);
+  // Removes the entry and shifts the following ones back to keep the probes
+  // short. Called with the lock of the shard.
+  void Erase(size_t shard_id, Entry* entry);
+  void LockShard(size_t shard_id);
+  void UnlockShard(size_t shard_id);
+  // Groups the indices of keys by the shards, so that every shard is locked
+  // once in a pull or push.
+  void SortByShard(const uint64_t* keys,
+                   size_t num,
+                   std::vector<std::pair<uint32_t, uint32_t>>* order) const;
+
+  int32_t CreateSegment();
+  int32_t OpenSegment();
+
+  bool _is_owner = false;
+  std::string _name;
+  void* _addr = nullptr;
+  size_t _size = 0;
+  ShmSparseTableHeader* _header = nullptr;
+  ShmSparseShardHeader* _shards = nullptr;
+  char* _entries = nullptr;
+
+  size_t _shard_num_all = 0;
+  size_t _shard_capacity = 0;  // a power of 2
+  size_t _entry_size = 0;
+  size_t _value_col = 0;
+  size_t _mf_value_col = 0;
+  size_t _select_value_col = 0;
+  size_t _update_value_col = 0;
+};
+
+}  // namespace distributed
+}  // namespace paddle
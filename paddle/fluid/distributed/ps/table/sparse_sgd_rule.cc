@@ -14,6 +14,10 @@
 
 #include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
 #include "glog/logging.h"
 
 #include "paddle/common/flags.h"
@@ -22,6 +26,80 @@ PD_DEFINE_bool(enable_show_scale_gradient, true, "enable show scale gradient");
 
 namespace paddle::distributed {
 
+namespace {
+
+constexpr size_t kFloatsPerCacheLine = 64 / sizeof(float);
+
+// Prefetches the n floats from p for writing, one cache line at a time.
+inline void PrefetchFloats(const float *p, size_t n) {
+  for (size_t i = 0; i < n; i += kFloatsPerCacheLine) {
+    __builtin_prefetch(p + i, 1);
+  }
+}
+
+#if defined(__AVX512F__)
+#define PS_SGD_RULE_USE_SIMD
+typedef __m512 VecF;
+constexpr size_t kVecBlock = 16;
+inline VecF VecSet1(float v) { return _mm512_set1_ps(v); }
+inline VecF VecLoad(const float *p) { return _mm512_loadu_ps(p); }
+inline void VecStore(float *p, VecF v) { _mm512_storeu_ps(p, v); }
+inline VecF VecAdd(VecF a, VecF b) { return _mm512_add_ps(a, b); }
+inline VecF VecSub(VecF a, VecF b) { return _mm512_sub_ps(a, b); }
+inline VecF VecMul(VecF a, VecF b) { return _mm512_mul_ps(a, b); }
+inline VecF VecDiv(VecF a, VecF b) { return _mm512_div_ps(a, b); }
+inline VecF VecSqrt(VecF a) { return _mm512_sqrt_ps(a); }
+inline VecF VecMin(VecF a, VecF b) { return _mm512_min_ps(a, b); }
+inline VecF VecMax(VecF a, VecF b) { return _mm512_max_ps(a, b); }
+inline float VecReduceSum(VecF v) { return _mm512_reduce_add_ps(v); }
+#elif defined(__AVX__)
+#define PS_SGD_RULE_USE_SIMD
+typedef __m256 VecF;
+constexpr size_t kVecBlock = 8;
+inline VecF VecSet1(float v) { return _mm256_set1_ps(v); }
+inline VecF VecLoad(const float *p) { return _mm256_loadu_ps(p); }
+inline void VecStore(float *p, VecF v) { _mm256_storeu_ps(p, v); }
+inline VecF VecAdd(VecF a, VecF b) { return _mm256_add_ps(a, b); }
+inline VecF VecSub(VecF a, VecF b) { return _mm256_sub_ps(a, b); }
+inline VecF VecMul(VecF a, VecF b) { return _mm256_mul_ps(a, b); }
+inline VecF VecDiv(VecF a, VecF b) { return _mm256_div_ps(a, b); }
+inline VecF VecSqrt(VecF a) { return _mm256_sqrt_ps(a); }
+inline VecF VecMin(VecF a, VecF b) { return _mm256_min_ps(a, b); }
+inline VecF VecMax(VecF a, VecF b) { return _mm256_max_ps(a, b); }
+inline float VecReduceSum(VecF v) {
+  __m128 sum =
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  return _mm_cvtss_f32(sum);
+}
+#endif
+
+#ifdef PS_SGD_RULE_USE_SIMD
+// Same as SparseValueSGDRule::BoundValue, which also takes nan to the lower
+// bound, since max_ps returns its second operand when either one is nan.
+inline VecF VecBound(VecF w, VecF min_bound, VecF max_bound) {
+  return VecMin(VecMax(w, min_bound), max_bound);
+}
+#endif
+
+}  // namespace
+
+void SparseValueSGDRule::UpdateValuesWork(float **w,
+                                          float **sgd,
+                                          const float **push_values,
+                                          const float *scales,
+                                          size_t num) {
+  const size_t sgd_dim = Dim();
+  for (size_t k = 0; k < num; ++k) {
+    if (k + 1 < num) {
+      PrefetchFloats(w[k + 1], _embedding_dim);
+      PrefetchFloats(sgd[k + 1], sgd_dim);
+    }
+    UpdateValueWork(w[k], sgd[k], push_values[k], scales[k]);
+  }
+}
+
 void SparseNaiveSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
                                     size_t emb_dim) {
   _embedding_dim = emb_dim;
@@ -105,6 +183,50 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
   g2sum += add_g2sum / _embedding_dim;
 }
 
+void SparseAdaGradSGDRule::UpdateValuesWork(float **w,
+                                            float **sgd,
+                                            const float **push_values,
+                                            const float *scales,
+                                            size_t num) {
+#ifdef PS_SGD_RULE_USE_SIMD
+  const VecF min_bound = VecSet1(_min_bound);
+  const VecF max_bound = VecSet1(_max_bound);
+#endif
+  for (size_t k = 0; k < num; ++k) {
+    if (k + 1 < num) {
+      PrefetchFloats(w[k + 1], _embedding_dim);
+      PrefetchFloats(sgd[k + 1], Dim());
+    }
+    float *value = w[k];
+    const float *grad = push_values[k];
+    const float scale = scales[k];
+    float &g2sum = sgd[k][G2SumIndex()];
+    const float ratio =
+        learning_rate_ * sqrt(_initial_g2sum / (_initial_g2sum + g2sum));
+    double add_g2sum = 0;
+    size_t i = 0;
+#ifdef PS_SGD_RULE_USE_SIMD
+    const VecF inv_scale = VecSet1(1.0f / scale);
+    const VecF lr_ratio = VecSet1(ratio);
+    VecF sum = VecSet1(0.0f);
+    for (; i + kVecBlock <= _embedding_dim; i += kVecBlock) {
+      VecF scaled_grad = VecMul(VecLoad(grad + i), inv_scale);
+      VecF new_w = VecSub(VecLoad(value + i), VecMul(lr_ratio, scaled_grad));
+      VecStore(value + i, VecBound(new_w, min_bound, max_bound));
+      sum = VecAdd(sum, VecMul(scaled_grad, scaled_grad));
+    }
+    add_g2sum = VecReduceSum(sum);
+#endif
+    for (; i < _embedding_dim; ++i) {
+      double scaled_grad = grad[i] / scale;
+      value[i] -= ratio * scaled_grad;
+      BoundValue(value[i]);
+      add_g2sum += scaled_grad * scaled_grad;
+    }
+    g2sum += add_g2sum / _embedding_dim;
+  }
+}
+
 void SparseAdaGradSGDRule::InitValueWork(float *value,
                                          float *sgd,
                                          bool zero_init) {
@@ -158,6 +280,50 @@ void StdAdaGradSGDRule::UpdateValueWork(float *w,
   }
 }
 
+void StdAdaGradSGDRule::UpdateValuesWork(float **w,
+                                         float **sgd,
+                                         const float **push_values,
+                                         const float *scales,
+                                         size_t num) {
+#ifdef PS_SGD_RULE_USE_SIMD
+  const VecF min_bound = VecSet1(_min_bound);
+  const VecF max_bound = VecSet1(_max_bound);
+  const VecF lr = VecSet1(learning_rate_);
+  const VecF initial_g2sum = VecSet1(_initial_g2sum);
+#endif
+  for (size_t k = 0; k < num; ++k) {
+    if (k + 1 < num) {
+      PrefetchFloats(w[k + 1], _embedding_dim);
+      PrefetchFloats(sgd[k + 1], Dim());
+    }
+    float *value = w[k];
+    float *g2sum = sgd[k] + G2SumIndex();
+    const float *grad = push_values[k];
+    const float scale = scales[k];
+    size_t i = 0;
+#ifdef PS_SGD_RULE_USE_SIMD
+    const VecF inv_scale = VecSet1(1.0f / scale);
+    for (; i + kVecBlock <= _embedding_dim; i += kVecBlock) {
+      VecF scaled_grad = VecMul(VecLoad(grad + i), inv_scale);
+      VecF old_g2sum = VecLoad(g2sum + i);
+      VecF ratio =
+          VecSqrt(VecDiv(initial_g2sum, VecAdd(initial_g2sum, old_g2sum)));
+      VecF new_w = VecSub(VecLoad(value + i),
+                          VecMul(lr, VecMul(scaled_grad, ratio)));
+      VecStore(value + i, VecBound(new_w, min_bound, max_bound));
+      VecStore(g2sum + i, VecAdd(old_g2sum, VecMul(scaled_grad, scaled_grad)));
+    }
+#endif
+    for (; i < _embedding_dim; ++i) {
+      double scaled_grad = grad[i] / scale;
+      value[i] -= learning_rate_ * scaled_grad *
+                  sqrt(_initial_g2sum / (_initial_g2sum + g2sum[i]));
+      BoundValue(value[i]);
+      g2sum[i] += scaled_grad * scaled_grad;
+    }
+  }
+}
+
 void StdAdaGradSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -226,6 +392,60 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+void SparseAdamSGDRule::UpdateValuesWork(float **w,
+                                         float **sgd,
+                                         const float **push_values,
+                                         const float *scales,
+                                         size_t num) {
+#ifdef PS_SGD_RULE_USE_SIMD
+  const VecF min_bound = VecSet1(_min_bound);
+  const VecF max_bound = VecSet1(_max_bound);
+  const VecF beta1 = VecSet1(_beta1_decay_rate);
+  const VecF beta2 = VecSet1(_beta2_decay_rate);
+  const VecF one_minus_beta1 = VecSet1(1 - _beta1_decay_rate);
+  const VecF one_minus_beta2 = VecSet1(1 - _beta2_decay_rate);
+  const VecF epsilon = VecSet1(_ada_epsilon);
+#endif
+  for (size_t k = 0; k < num; ++k) {
+    if (k + 1 < num) {
+      PrefetchFloats(w[k + 1], _embedding_dim);
+      PrefetchFloats(sgd[k + 1], Dim());
+    }
+    float *value = w[k];
+    float *gsum = sgd[k] + GSumIndex();
+    float *g2sum = sgd[k] + G2SumIndex();
+    float *beta1_pow = sgd[k] + Beta1PowIndex();
+    float *beta2_pow = sgd[k] + Beta2PowIndex();
+    const float *g = push_values[k];
+    const float lr = learning_rate_ * sqrt(1 - *beta2_pow) / (1 - *beta1_pow);
+    size_t i = 0;
+#ifdef PS_SGD_RULE_USE_SIMD
+    const VecF lr_t = VecSet1(lr);
+    for (; i + kVecBlock <= _embedding_dim; i += kVecBlock) {
+      VecF grad = VecLoad(g + i);
+      VecF new_gsum = VecAdd(VecMul(beta1, VecLoad(gsum + i)),
+                             VecMul(one_minus_beta1, grad));
+      VecF new_g2sum = VecAdd(VecMul(beta2, VecLoad(g2sum + i)),
+                              VecMul(one_minus_beta2, VecMul(grad, grad)));
+      VecF step = VecDiv(new_gsum, VecAdd(VecSqrt(new_g2sum), epsilon));
+      VecF new_w = VecSub(VecLoad(value + i), VecMul(lr_t, step));
+      VecStore(value + i, VecBound(new_w, min_bound, max_bound));
+      VecStore(gsum + i, new_gsum);
+      VecStore(g2sum + i, new_g2sum);
+    }
+#endif
+    for (; i < _embedding_dim; ++i) {
+      gsum[i] = _beta1_decay_rate * gsum[i] + (1 - _beta1_decay_rate) * g[i];
+      g2sum[i] =
+          _beta2_decay_rate * g2sum[i] + (1 - _beta2_decay_rate) * g[i] * g[i];
+      value[i] = value[i] - lr * (gsum[i] / (sqrt(g2sum[i]) + _ada_epsilon));
+      BoundValue(value[i]);
+    }
+    (*beta1_pow) *= _beta1_decay_rate;
+    (*beta2_pow) *= _beta2_decay_rate;
+  }
+}
+
 void SparseAdamSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
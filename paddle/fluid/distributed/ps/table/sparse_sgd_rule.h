@@ -39,8 +39,20 @@ class SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale) = 0;
+  // Updates the values of num keys one after another, by default through
+  // UpdateValueWork, while prefetching the values of the next key. The rules
+  // override it to vectorize the update over the embedding.
+  virtual void UpdateValuesWork(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init) = 0;
   virtual size_t Dim() = 0;
+  // The number of the leading states, one or more per dimension, e.g. the
+  // moments of adam, which may be stored in a lower precision. The others,
+  // e.g. the powers of the decay rates, are kept in fp32.
+  virtual size_t CompressibleDim() { return 0; }
   const std::string& GetName() const { return _name; }
   void InitValue(float* value, float* sgd, bool zero_init = true) {
     InitValueWork(value, sgd, zero_init);
@@ -51,6 +63,13 @@ class SparseValueSGDRule {
                    float scale = 1) {
     UpdateValueWork(w, sgd, push_value, scale);
   }
+  void UpdateValues(float** w,
+                    float** sgd,
+                    const float** push_values,
+                    const float* scales,
+                    size_t num) {
+    UpdateValuesWork(w, sgd, push_values, scales, num);
+  }
   template <class T>
   void BoundValue(T& w) {  // NOLINT
     if (!(w >= _min_bound)) {
@@ -97,6 +116,11 @@ class SparseAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValuesWork(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -134,8 +158,14 @@ class StdAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValuesWork(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim; }
+  virtual size_t CompressibleDim() { return _embedding_dim; }
   size_t G2SumIndex() { return 0; }
 
  private:
@@ -151,8 +181,14 @@ class SparseAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValuesWork(float** w,
+                                float** sgd,
+                                const float** push_values,
+                                const float* scales,
+                                size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim * 2 + 2; }
+  virtual size_t CompressibleDim() { return _embedding_dim * 2; }
   size_t GSumIndex() { return 0; }
   size_t G2SumIndex() { return GSumIndex() + _embedding_dim; }
   size_t Beta1PowIndex() { return G2SumIndex() + _embedding_dim; }
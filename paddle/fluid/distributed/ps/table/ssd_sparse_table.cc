@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
@@ -28,6 +31,43 @@ PD_DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
 PHI_DEFINE_EXPORTED_string(rocksdb_path,
                            "database",
                            "path of sparse table rocksdb file");
+PD_DEFINE_int32(pserver_ssd_read_batch_size,
+                256,
+                "the max number of the keys read from the ssd by a multiget "
+                "when pulling");
+PD_DEFINE_int32(pserver_ssd_read_thread_num,
+                8,
+                "the number of the threads reading the ssd for the pulls");
+PD_DEFINE_int64(pserver_ssd_mem_capacity_per_shard,
+                0,
+                "the max number of the keys of a shard of ssd sparse table "
+                "kept in the memory, the cold keys are moved to the ssd in "
+                "the background when exceeding it. 0 means no limit, and the "
+                "keys are moved to the ssd only when updating the table");
+PD_DEFINE_int64(pserver_rocksdb_block_cache_mb,
+                512,
+                "the size of the rocksdb block cache shared by the shards of "
+                "ssd sparse table, in MB");
+PD_DEFINE_double(pserver_rocksdb_filter_cache_ratio,
+                 0.2,
+                 "the part of the rocksdb block cache kept for the index and "
+                 "bloom filter blocks");
+PD_DEFINE_int64(pserver_rocksdb_compaction_max_mb_per_sec,
+                256,
+                "the rate limit of the rocksdb compactions without pulls, in "
+                "MB/s. 0 means no limit");
+PD_DEFINE_int64(pserver_rocksdb_compaction_min_mb_per_sec,
+                16,
+                "the rate limit of the rocksdb compactions at the peak of the "
+                "pulls, in MB/s");
+PD_DEFINE_int64(pserver_rocksdb_pull_peak_keys_per_sec,
+                1000000,
+                "the keys read from the ssd per second by the pulls, at which "
+                "the rocksdb compactions get their min rate");
+PD_DEFINE_bool(pserver_rocksdb_compact_after_save,
+               true,
+               "compact the rocksdb of ssd sparse table in the background "
+               "after a save or a shrink");
 
 namespace paddle {
 namespace distributed {
@@ -35,7 +75,24 @@ namespace distributed {
 int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = ::paddle::distributed::RocksDBHandler::GetInstance();
-  _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  RocksDBOptions db_options;
+  db_options.block_cache_mb = FLAGS_pserver_rocksdb_block_cache_mb;
+  db_options.filter_cache_ratio = FLAGS_pserver_rocksdb_filter_cache_ratio;
+  db_options.compaction_max_mb_per_sec =
+      FLAGS_pserver_rocksdb_compaction_max_mb_per_sec;
+  db_options.compaction_min_mb_per_sec =
+      FLAGS_pserver_rocksdb_compaction_min_mb_per_sec;
+  db_options.pull_peak_keys_per_sec =
+      FLAGS_pserver_rocksdb_pull_peak_keys_per_sec;
+  _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num, db_options);
+  _ssd_read_pool = std::make_shared<::ThreadPool>(
+      std::max(FLAGS_pserver_ssd_read_thread_num, 1));
+  if (FLAGS_pserver_ssd_mem_capacity_per_shard > 0) {
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _tiering_policies.emplace_back(std::make_unique<SparseTieringPolicy>(
+          FLAGS_pserver_ssd_mem_capacity_per_shard));
+    }
+  }
   VLOG(0) << "initialize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
@@ -78,12 +135,6 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                                    const uint64_t* keys,
                                    size_t num) {
   CostTimer timer("pserver_downpour_sparse_select_all");
-  size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
-  size_t mf_value_size =
-      _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
-  size_t select_value_size =
-      _value_accessor->GetAccessorInfo().select_size / sizeof(float);
-
   {  // 从table取值 or create
     std::vector<std::future<int>> tasks(_real_local_shard_num);
     std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
@@ -97,74 +148,11 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
     for (int shard_id = 0; shard_id < _real_local_shard_num; ++shard_id) {
       tasks[shard_id] =
           _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
-              [this,
-               shard_id,
-               &task_keys,
-               value_size,
-               mf_value_size,
-               select_value_size,
-               pull_values,
-               &missed_keys]() -> int {
-                auto& keys = task_keys[shard_id];
-                auto& local_shard = _local_shards[shard_id];
-                float data_buffer[value_size];  // NOLINT
-                float* data_buffer_ptr = data_buffer;
-                for (size_t i = 0; i < keys.size(); ++i) {
-                  uint64_t key = keys[i].first;
-                  auto itr = local_shard.find(key);
-                  size_t data_size = value_size - mf_value_size;
-                  if (itr == local_shard.end()) {
-                    // pull rocksdb
-                    std::string tmp_string("");
-                    if (_db->get(shard_id,
-                                 reinterpret_cast<char*>(&key),
-                                 sizeof(uint64_t),
-                                 tmp_string) > 0) {
-                      ++missed_keys;
-                      if (FLAGS_pserver_create_value_when_push) {
-                        memset(data_buffer, 0, sizeof(float) * data_size);
-                      } else {
-                        auto& feature_value = local_shard[key];
-                        feature_value.resize(data_size);
-                        float* data_ptr =
-                            const_cast<float*>(feature_value.data());
-                        _value_accessor->Create(&data_buffer_ptr, 1);
-                        memcpy(data_ptr,
-                               data_buffer_ptr,
-                               data_size * sizeof(float));
-                      }
-                    } else {
-                      data_size = tmp_string.size() / sizeof(float);
-                      memcpy(data_buffer_ptr,
-                             ::paddle::string::str_to_float(tmp_string),
-                             data_size * sizeof(float));
-                      // from rocksdb to mem
-                      auto& feature_value = local_shard[key];
-                      feature_value.resize(data_size);
-                      memcpy(const_cast<float*>(feature_value.data()),
-                             data_buffer_ptr,
-                             data_size * sizeof(float));
-                      _db->del_data(shard_id,
-                                    reinterpret_cast<char*>(&key),
-                                    sizeof(uint64_t));
-                    }
-                  } else {
-                    data_size = itr.value().size();
-                    memcpy(data_buffer_ptr,
-                           itr.value().data(),
-                           data_size * sizeof(float));
-                  }
-                  for (size_t mf_idx = data_size; mf_idx < value_size;
-                       ++mf_idx) {
-                    data_buffer[mf_idx] = 0.0;
-                  }
-                  int pull_data_idx = keys[i].second;
-                  float* select_data =
-                      pull_values + pull_data_idx * select_value_size;
-                  _value_accessor->Select(
-                      &select_data, (const float**)&data_buffer_ptr, 1);
-                }
-                return 0;
+              [this, shard_id, &task_keys, pull_values, &missed_keys]() {
+                return PullSparseShard(shard_id,
+                                       task_keys[shard_id],
+                                       pull_values,
+                                       &missed_keys);
               });
     }
     for (int i = 0; i < _real_local_shard_num; ++i) {
@@ -178,12 +166,151 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
   return 0;
 }
 
+int32_t SSDSparseTable::PullSparseShard(
+    int shard_id,
+    const std::vector<std::pair<uint64_t, int>>& keys,
+    float* pull_values,
+    std::atomic<uint32_t>* missed_keys) {
+  size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
+  size_t mf_value_size =
+      _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
+  size_t select_value_size =
+      _value_accessor->GetAccessorInfo().select_size / sizeof(float);
+  auto& local_shard = _local_shards[shard_id];
+  SparseTieringPolicy* policy =
+      _tiering_policies.empty() ? nullptr : _tiering_policies[shard_id].get();
+  float data_buffer[value_size];  // NOLINT
+  float* data_buffer_ptr = data_buffer;
+  auto select = [&](size_t i, size_t data_size) {
+    for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+      data_buffer[mf_idx] = 0.0;
+    }
+    float* select_data = pull_values + keys[i].second * select_value_size;
+    _value_accessor->Select(&select_data, (const float**)&data_buffer_ptr, 1);
+  };
+
+  // The memory hits are selected while the misses are read from rocksdb by
+  // the read threads in batches.
+  std::vector<std::unique_ptr<RocksDBItem>> batches;
+  std::vector<std::future<int>> reads;
+  RocksDBItem* batch = nullptr;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    uint64_t key = keys[i].first;
+    auto itr = local_shard.find(key);
+    if (policy != nullptr) {
+      policy->RecordAccess(key);
+    }
+    if (itr != local_shard.end()) {
+      if (policy != nullptr) {
+        ++policy->stat().mem_hits;
+      }
+      size_t data_size = itr.value().size();
+      memcpy(data_buffer_ptr, itr.value().data(), data_size * sizeof(float));
+      select(i, data_size);
+      continue;
+    }
+    if (batch == nullptr) {
+      batches.emplace_back(std::make_unique<RocksDBItem>());
+      batch = batches.back().get();
+    }
+    batch->batch_index.push_back(i);
+    batch->batch_keys.emplace_back(
+        reinterpret_cast<const char*>(&keys[i].first), sizeof(uint64_t));
+    if (batch->batch_keys.size() >=
+        static_cast<size_t>(FLAGS_pserver_ssd_read_batch_size)) {
+      reads.push_back(SubmitSSDRead(shard_id, batch));
+      batch = nullptr;
+    }
+  }
+  if (batch != nullptr) {
+    reads.push_back(SubmitSSDRead(shard_id, batch));
+  }
+
+  for (size_t b = 0; b < batches.size(); ++b) {
+    reads[b].wait();
+    batch = batches[b].get();
+    for (size_t idx = 0; idx < batch->batch_keys.size(); ++idx) {
+      size_t i = batch->batch_index[idx];
+      uint64_t key = keys[i].first;
+      size_t data_size = value_size - mf_value_size;
+      // the key repeated in the request may be moved into the memory already
+      auto itr = local_shard.find(key);
+      if (itr != local_shard.end()) {
+        data_size = itr.value().size();
+        memcpy(data_buffer_ptr, itr.value().data(), data_size * sizeof(float));
+      } else if (batch->status[idx].IsNotFound()) {
+        ++(*missed_keys);
+        if (policy != nullptr) {
+          ++policy->stat().misses;
+        }
+        if (FLAGS_pserver_create_value_when_push) {
+          memset(data_buffer, 0, sizeof(float) * data_size);
+        } else {
+          auto& feature_value = local_shard[key];
+          feature_value.resize(data_size);
+          _value_accessor->Create(&data_buffer_ptr, 1);
+          memcpy(feature_value.data(),
+                 data_buffer_ptr,
+                 data_size * sizeof(float));
+        }
+      } else {
+        data_size = batch->batch_values[idx].size() / sizeof(float);
+        memcpy(data_buffer_ptr,
+               batch->batch_values[idx].data(),
+               data_size * sizeof(float));
+        bool admitted = policy == nullptr || policy->Admit(key, &local_shard);
+        if (policy != nullptr) {
+          ++policy->stat().ssd_hits;
+          ++(admitted ? policy->stat().admitted : policy->stat().rejected);
+        }
+        if (admitted) {
+          // from rocksdb to mem
+          auto& feature_value = local_shard[key];
+          feature_value.resize(data_size);
+          memcpy(
+              feature_value.data(), data_buffer_ptr, data_size * sizeof(float));
+          _db->del_data(
+              shard_id, reinterpret_cast<char*>(&key), sizeof(uint64_t));
+        }
+      }
+      select(i, data_size);
+    }
+  }
+  if (policy != nullptr) {
+    ScheduleDemotion(shard_id);
+  }
+  return 0;
+}
+
+std::future<int> SSDSparseTable::SubmitSSDRead(int shard_id,
+                                               RocksDBItem* batch) {
+  batch->batch_values.resize(batch->batch_keys.size());
+  batch->status.resize(batch->batch_keys.size());
+  return _ssd_read_pool->enqueue([this, shard_id, batch]() -> int {
+    // the keys are in the order of the request rather than rocksdb
+    _db->multi_get(shard_id,
+                   batch->batch_keys.size(),
+                   batch->batch_keys.data(),
+                   batch->batch_values.data(),
+                   batch->status.data(),
+                   false);
+    return 0;
+  });
+}
+
 int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                                       char** pull_values,
                                       const uint64_t* pull_keys,
                                       size_t num,
                                       uint16_t pass_id) {
   CostTimer timer("pserver_ssd_sparse_select_all");
+  PADDLE_ENFORCE_EQ(
+      _tiering_policies.empty(),
+      true,
+      phi::errors::Unimplemented(
+          "The pointers of the values pulled may be invalidated by the "
+          "demotion, so the tiering of SSDSparseTable can not be used. Please "
+          "set FLAGS_pserver_ssd_mem_capacity_per_shard to 0."));
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
       _value_accessor->GetAccessorInfo().mf_size / sizeof(float);
@@ -359,6 +486,7 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                &task_keys]() -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                bool use_tiering = !_tiering_policies.empty();
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
@@ -367,6 +495,11 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                   const float* update_data =
                       values + push_data_idx * update_value_col;
                   auto itr = local_shard.find(key);
+                  // the key rejected by the admission is still in the ssd
+                  if (itr == local_shard.end() && use_tiering &&
+                      LoadFromSSD(shard_id, key)) {
+                    itr = local_shard.find(key);
+                  }
                   if (itr == local_shard.end()) {
                     if (FLAGS_pserver_enable_create_feasign_randomly &&
                         !_value_accessor->CreateValue(1, update_data)) {
@@ -404,6 +537,9 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                if (use_tiering) {
+                  ScheduleDemotion(shard_id);
+                }
                 return 0;
               });
     }
@@ -460,6 +596,7 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                   -> int {
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
+                bool use_tiering = !_tiering_policies.empty();
                 float data_buffer[value_col];  // NOLINT
                 float* data_buffer_ptr = data_buffer;
                 for (size_t i = 0; i < keys.size(); ++i) {
@@ -467,6 +604,11 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                   uint64_t push_data_idx = keys[i].second;
                   const float* update_data = values[push_data_idx];
                   auto itr = local_shard.find(key);
+                  // the key rejected by the admission is still in the ssd
+                  if (itr == local_shard.end() && use_tiering &&
+                      LoadFromSSD(shard_id, key)) {
+                    itr = local_shard.find(key);
+                  }
                   if (itr == local_shard.end()) {
                     if (FLAGS_pserver_enable_create_feasign_randomly &&
                         !_value_accessor->CreateValue(1, update_data)) {
@@ -504,6 +646,9 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                            value_size * sizeof(float));
                   }
                 }
+                if (use_tiering) {
+                  ScheduleDemotion(shard_id);
+                }
                 return 0;
               });
     }
@@ -514,6 +659,49 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
   return 0;
 }
 
+bool SSDSparseTable::LoadFromSSD(int shard_id, uint64_t key) {
+  std::string value;
+  if (_db->get(shard_id,
+               reinterpret_cast<char*>(&key),
+               sizeof(uint64_t),
+               value) > 0) {
+    return false;
+  }
+  auto& feature_value = _local_shards[shard_id][key];
+  feature_value.resize(value.size() / sizeof(float));
+  memcpy(feature_value.data(),
+         ::paddle::string::str_to_float(value),
+         value.size());
+  _db->del_data(shard_id, reinterpret_cast<char*>(&key), sizeof(uint64_t));
+  return true;
+}
+
+void SSDSparseTable::ScheduleDemotion(int shard_id) {
+  auto& policy = _tiering_policies[shard_id];
+  if (policy->demotion_pending ||
+      !policy->NeedDemote(_local_shards[shard_id].size())) {
+    return;
+  }
+  policy->demotion_pending = true;
+  policy->demotion =
+      _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+          [this, shard_id]() -> int {
+            auto& policy = _tiering_policies[shard_id];
+            policy->Demote(&_local_shards[shard_id],
+                           [this, shard_id](uint64_t key,
+                                            FixedFeatureValue& value) {
+                             _db->put(shard_id,
+                                      reinterpret_cast<const char*>(&key),
+                                      sizeof(uint64_t),
+                                      reinterpret_cast<const char*>(
+                                          value.data()),
+                                      value.size() * sizeof(float));
+                           });
+            policy->demotion_pending = false;
+            return 0;
+          });
+}
+
 int32_t SSDSparseTable::Shrink(const std::string& param) {
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
   omp_set_num_threads(thread_num);
@@ -551,6 +739,9 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
               << mem_count << "] SSD[" << ssd_count << "]";
     // _db->flush(i);
   }
+  if (FLAGS_pserver_rocksdb_compact_after_save) {
+    _db->manual_compaction(true);
+  }
   return 0;
 }
 
@@ -606,11 +797,14 @@ int32_t SSDSparseTable::Save(const std::string& path,
   } else {
     ret = SaveWithBinary(path, param);  // batch_model:0  xbox:1
   }
-  return ret;
 #else
   // CPUPS PSCORE
-  return SaveWithString(path, param);  // batch_model:0  xbox:1
+  int32_t ret = SaveWithString(path, param);  // batch_model:0  xbox:1
 #endif
+  if (FLAGS_pserver_rocksdb_compact_after_save) {
+    _db->manual_compaction(true);
+  }
+  return ret;
 }
 
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
@@ -625,11 +819,14 @@ int32_t SSDSparseTable::Save_v2(const std::string& path,
   } else {
     ret = SaveWithBinary_v2(path, param);  // batch_model:0  xbox:1
   }
-  return ret;
 #else
   // CPUPS PSCORE
-  return SaveWithString(path, param);  // batch_model:0  xbox:1
+  int32_t ret = SaveWithString(path, param);  // batch_model:0  xbox:1
 #endif
+  if (FLAGS_pserver_rocksdb_compact_after_save) {
+    _db->manual_compaction(true);
+  }
+  return ret;
 }
 #endif
 
@@ -2762,6 +2959,8 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
         auto& shard = _local_shards[shard_idx];
         rocksdb::Options options;
         options.comparator = _db->get_comparator();
+        options.prefix_extractor.reset(
+            rocksdb::NewFixedPrefixTransform(sizeof(uint64_t)));
         rocksdb::BlockBasedTableOptions bbto;
         bbto.format_version = 5;
         bbto.use_delta_encoding = false;
@@ -2942,6 +3141,23 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
 
 std::pair<int64_t, int64_t> SSDSparseTable::PrintTableStat() {
   int64_t feasign_size = LocalSize();
+  if (!_tiering_policies.empty()) {
+    uint64_t mem_hits = 0, ssd_hits = 0, misses = 0;
+    uint64_t admitted = 0, rejected = 0, demoted = 0;
+    for (auto& policy : _tiering_policies) {
+      mem_hits += policy->stat().mem_hits;
+      ssd_hits += policy->stat().ssd_hits;
+      misses += policy->stat().misses;
+      admitted += policy->stat().admitted;
+      rejected += policy->stat().rejected;
+      demoted += policy->stat().demoted;
+    }
+    double total = std::max<double>(mem_hits + ssd_hits + misses, 1);
+    LOG(INFO) << "SSDSparseTable tiering: mem hit rate " << mem_hits / total
+              << ", ssd hit rate " << ssd_hits / total << ", miss rate "
+              << misses / total << ", admitted " << admitted << ", rejected "
+              << rejected << ", demoted " << demoted;
+  }
   return {feasign_size, -1};
 }
 
@@ -2976,6 +3192,8 @@ int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
         [shard_id, this, &count, show_threshold, pass_id]() -> int {
           rocksdb::Options options;
           options.comparator = _db->get_comparator();
+          options.prefix_extractor.reset(
+              rocksdb::NewFixedPrefixTransform(sizeof(uint64_t)));
           rocksdb::BlockBasedTableOptions bbto;
           bbto.format_version = 5;
           bbto.use_delta_encoding = false;
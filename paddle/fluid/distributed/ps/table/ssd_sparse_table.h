@@ -16,6 +16,7 @@
 
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_tiering_policy.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
 
 namespace paddle {
@@ -60,7 +61,13 @@ class SSDSparseTable : public MemorySparseTable {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   SSDSparseTable() {}
-  virtual ~SSDSparseTable() {}
+  virtual ~SSDSparseTable() {
+    for (auto& policy : _tiering_policies) {
+      if (policy->demotion.valid()) {
+        policy->demotion.wait();
+      }
+    }
+  }
 
   int32_t Initialize() override;
   int32_t InitializeShard() override;
@@ -130,13 +137,35 @@ class SSDSparseTable : public MemorySparseTable {
 
   void SetDayId(int day_id) override;
 
+ protected:
+  // the values on the ssd are not in the local shards
+  bool ShardSwappable() override { return false; }
+
  private:
+  // Pulls the keys of the shard on its task thread.
+  int32_t PullSparseShard(int shard_id,
+                          const std::vector<std::pair<uint64_t, int>>& keys,
+                          float* pull_values,
+                          std::atomic<uint32_t>* missed_keys);
+  // Reads the keys of the batch from the ssd by a read thread.
+  std::future<int> SubmitSSDRead(int shard_id, RocksDBItem* batch);
+  // Moves the value of key from the ssd to the memory. Returns false if it is
+  // not in the ssd.
+  bool LoadFromSSD(int shard_id, uint64_t key);
+  // Schedules the demotion of the cold keys of the shard to the ssd on its
+  // task thread, if the memory exceeds the capacity. Called on the thread.
+  void ScheduleDemotion(int shard_id);
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
   std::mutex _table_mutex;
   int _day_id = 0;
+  // the tiering policies of the local shards, empty if
+  // FLAGS_pserver_ssd_mem_capacity_per_shard is 0
+  std::vector<std::unique_ptr<SparseTieringPolicy>> _tiering_policies;
+  std::shared_ptr<::ThreadPool> _ssd_read_pool;
 };
 
 }  // namespace distributed
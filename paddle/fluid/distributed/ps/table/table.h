@@ -25,6 +25,7 @@
 #include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/common/afs_warpper.h"
 #include "paddle/fluid/distributed/ps/table/accessor.h"
+#include "paddle/fluid/distributed/ps/table/depends/sparse_shard_route.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/framework/channel.h"
@@ -163,6 +164,32 @@ class Table {
   virtual void Revert() {}
   virtual void CheckSavePrePatchDone() {}
 
+  // for the swaps of the shards between the servers, see SparseShardRoute
+  // the loads of the local shards since the last query
+  virtual int32_t QueryShardLoad(std::vector<SparseShardLoad> *loads UNUSED) {
+    return -1;
+  }
+  // copies the keys and the values of a local shard
+  virtual int32_t ExportShard(uint32_t shard_id UNUSED,
+                              std::string *data UNUSED) {
+    return -1;
+  }
+  // keeps the exported data of a shard on another server for SwitchShard,
+  // or drops the kept one if data is empty
+  virtual int32_t ImportShard(uint32_t shard_id UNUSED,
+                              const std::string &data UNUSED) {
+    return -1;
+  }
+  // replaces the local shard shard_out with the imported shard_in
+  virtual int32_t SwitchShard(uint32_t shard_out UNUSED,
+                              uint32_t shard_in UNUSED) {
+    return -1;
+  }
+  virtual int32_t SetShardRoute(const SparseShardRoute &route UNUSED) {
+    return -1;
+  }
+  virtual int32_t GetShardRoute(SparseShardRoute *route UNUSED) { return -1; }
+
   virtual void SetDayId(int day_id) {}
 
  protected:
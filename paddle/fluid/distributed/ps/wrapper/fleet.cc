@@ -741,6 +741,27 @@ void FleetWrapper::PrintTableStat(const uint64_t table_id) {
   }
 }
 
+void FleetWrapper::RebalanceSparseTable(const uint64_t table_id,
+                                        double max_imbalance,
+                                        size_t max_swaps) {
+  auto ret =
+      worker_ptr_->RebalanceSparseTable(table_id, max_imbalance, max_swaps);
+  ret.wait();
+  int32_t err_code = ret.get();
+  if (err_code == -1) {
+    LOG(ERROR) << "rebalance sparse table failed";
+  }
+}
+
+void FleetWrapper::PullSparseShardRoute(const uint64_t table_id) {
+  auto ret = worker_ptr_->PullSparseShardRoute(table_id);
+  ret.wait();
+  int32_t err_code = ret.get();
+  if (err_code == -1) {
+    LOG(ERROR) << "pull sparse shard route failed";
+  }
+}
+
 void FleetWrapper::SaveCacheTable(const uint64_t table_id,
                                   uint16_t pass_id,
                                   size_t threshold) {
@@ -242,6 +242,13 @@ class FleetWrapper {
   void BarrierWithTable(uint32_t barrier_type);
 
   void PrintTableStat(const uint64_t table_id);
+  // swaps the shards of a sparse table between the servers by their loads,
+  // called by one trainer between barriers, after which the other trainers
+  // call PullSparseShardRoute
+  void RebalanceSparseTable(const uint64_t table_id,
+                            double max_imbalance,
+                            size_t max_swaps);
+  void PullSparseShardRoute(const uint64_t table_id);
   void SaveCacheTable(const uint64_t table_id,
                       uint16_t pass_id,
                       size_t threshold);
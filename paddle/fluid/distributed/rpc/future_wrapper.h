@@ -30,7 +30,7 @@ namespace distributed {
 class FutureWrapper {
  public:
   FutureWrapper() {}
-  explicit FutureWrapper(std::future<std::string> fut) : fut_(std::move(fut)) {}
+  explicit FutureWrapper(std::future<RpcMessage> fut) : fut_(std::move(fut)) {}
   py::object wait() {
     // GIL must be released, otherwise fut_.get() blocking will cause the
     // service to fail to process RPC requests, leading to deadlock
@@ -41,17 +41,17 @@ class FutureWrapper {
             "GIL must be released before fut.wait(), otherwise fut_.get() "
             "blocking will cause the service to fail to "
             "process RPC requests, leading to deadlock"));
-    auto s = fut_.get();
+    auto msg = fut_.get();
     py::gil_scoped_acquire ag;
     std::shared_ptr<PythonRpcHandler> python_handler =
         PythonRpcHandler::GetInstance();
-    py::object obj = python_handler->Deserialize(py::bytes(s));
+    py::object obj = python_handler->DeserializeWithTensors(msg);
     return obj;
   }
 
  private:
   DISABLE_COPY_AND_ASSIGN(FutureWrapper);
-  std::future<std::string> fut_;
+  std::future<RpcMessage> fut_;
 };
 }  // namespace distributed
 }  // namespace paddle
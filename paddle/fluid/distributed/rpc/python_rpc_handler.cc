@@ -29,6 +29,10 @@ PythonRpcHandler::PythonRpcHandler() {
   py_run_function_ = getFunction(rpc_internal, "_run_py_func");
   py_serialize_ = getFunction(rpc_internal, "_serialize");
   py_deserialize_ = getFunction(rpc_internal, "_deserialize");
+  py_serialize_with_tensors_ =
+      getFunction(rpc_internal, "_serialize_with_tensors");
+  py_deserialize_with_tensors_ =
+      getFunction(rpc_internal, "_deserialize_with_tensors");
 }
 
 py::object PythonRpcHandler::RunPythonFunc(const py::object& python_func) {
@@ -47,6 +51,20 @@ py::object PythonRpcHandler::Deserialize(const std::string& obj) {
   return py_deserialize_(py::bytes(obj));
 }
 
+RpcMessage PythonRpcHandler::SerializeWithTensors(const py::object& obj) {
+  py::gil_scoped_acquire ag;
+  py::tuple res = py_serialize_with_tensors_(obj);
+  RpcMessage msg;
+  msg.payload = res[0].cast<std::string>();
+  msg.tensors = res[1].cast<std::vector<phi::DenseTensor>>();
+  return msg;
+}
+
+py::object PythonRpcHandler::DeserializeWithTensors(const RpcMessage& msg) {
+  py::gil_scoped_acquire ag;
+  return py_deserialize_with_tensors_(py::bytes(msg.payload), msg.tensors);
+}
+
 std::shared_ptr<PythonRpcHandler> PythonRpcHandler::python_rpc_handler_ =
     nullptr;
 std::mutex PythonRpcHandler::lock_;
@@ -15,12 +15,14 @@
 #pragma once
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 #include <memory>
 #include <mutex>
 #include <string>
 
 #include "paddle/common/macros.h"
+#include "paddle/fluid/distributed/rpc/tensor_payload.h"
 
 namespace py = pybind11;
 
@@ -41,6 +43,14 @@ class PYBIND11_EXPORT PythonRpcHandler {
   // Deserialize a string into a py::object
   py::object Deserialize(const std::string& obj);
 
+  // Serialize a py::object into a string, the tensors in obj are taken out
+  // of the pickle, so that they are sent without being pickled
+  RpcMessage SerializeWithTensors(const py::object& obj);
+
+  // Deserialize a string and the tensors taken out of its pickle into a
+  // py::object
+  py::object DeserializeWithTensors(const RpcMessage& msg);
+
  private:
   DISABLE_COPY_AND_ASSIGN(PythonRpcHandler);
 
@@ -54,6 +64,12 @@ class PYBIND11_EXPORT PythonRpcHandler {
   // Ref to `paddle.distributed.rpc.internal.deserialize`.
   py::object py_deserialize_;
 
+  // Ref to `paddle.distributed.rpc.internal._serialize_with_tensors`.
+  py::object py_serialize_with_tensors_;
+
+  // Ref to `paddle.distributed.rpc.internal._deserialize_with_tensors`.
+  py::object py_deserialize_with_tensors_;
+
   // Lock to protect initialization.
   static std::mutex lock_;
 };
@@ -93,18 +93,30 @@ int RpcAgent::Stop() {
 void OnRpcDone::Run() {
   // delete this after Run
   std::unique_ptr<OnRpcDone> self_guard(this);
-  PADDLE_ENFORCE_EQ(
-      cntl_.Failed(), false, phi::errors::Fatal(cntl_.ErrorText()));
-  promise_->set_value(response_.message());
+  try {
+    PADDLE_ENFORCE_EQ(
+        cntl_.Failed(), false, phi::errors::Fatal(cntl_.ErrorText()));
+    RpcMessage result;
+    result.tensors =
+        DeserializeTensors(response_.tensors(), &cntl_.response_attachment());
+    result.payload = response_.message();
+    promise_->set_value(std::move(result));
+  } catch (...) {
+    // rethrown by the waiter of the future instead of the brpc thread
+    promise_->set_exception(std::current_exception());
+    return;
+  }
   VLOG(2) << "Received response from " << cntl_.remote_side() << " to "
           << cntl_.local_side() << " (attached=" << cntl_.response_attachment()
           << ")"
           << " latency=" << cntl_.latency_us() << "us";
 }
 
-std::future<std::string> RpcAgent::InvokeRpc(const std::string &py_func,
-                                             const std::string &to,
-                                             int timeout_ms = kTimeoutMs) {
+std::future<RpcMessage> RpcAgent::InvokeRpc(
+    const std::string &py_func,
+    const std::vector<phi::DenseTensor> &tensors,
+    const std::string &to,
+    int timeout_ms = kTimeoutMs) {
   auto it = name_to_infos_.find(to);
   PADDLE_ENFORCE_NE(it,
                     name_to_infos_.end(),
@@ -116,7 +128,10 @@ std::future<std::string> RpcAgent::InvokeRpc(const std::string &py_func,
   OnRpcDone *done = new OnRpcDone;
   done->cntl_.set_timeout_ms(timeout_ms);
   done->request_.set_message(py_func);
-  std::future<std::string> fut = done->GetFuture();
+  SerializeTensors(tensors,
+                   done->request_.mutable_tensors(),
+                   &done->cntl_.request_attachment());
+  std::future<RpcMessage> fut = done->GetFuture();
   RpcBaseService_Stub stub(channel.get());
   stub.InvokeRpc(&done->cntl_, &done->request_, &done->response_, done);
   return fut;
@@ -26,6 +26,7 @@
 #include "paddle/fluid/distributed/rpc/python_rpc_handler.h"
 #include "paddle/fluid/distributed/rpc/rpc.pb.h"
 #include "paddle/fluid/distributed/rpc/rpc_service.h"
+#include "paddle/fluid/distributed/rpc/tensor_payload.h"
 
 namespace paddle {
 namespace distributed {
@@ -47,16 +48,17 @@ struct WorkerInfo {
 
 class OnRpcDone : public google::protobuf::Closure {
  public:
-  OnRpcDone() { promise_ = std::make_shared<std::promise<std::string>>(); }
-  // process callback of response
+  OnRpcDone() { promise_ = std::make_shared<std::promise<RpcMessage>>(); }
+  // process callback of response, the tensors of the response are restored
+  // in the brpc thread without the GIL
   void Run();
-  std::future<std::string> GetFuture() {
-    return std::future<std::string>(promise_->get_future());
+  std::future<RpcMessage> GetFuture() {
+    return std::future<RpcMessage>(promise_->get_future());
   }
   RpcResponse response_;
   RpcRequest request_;
   brpc::Controller cntl_;
-  std::shared_ptr<std::promise<std::string>> promise_;
+  std::shared_ptr<std::promise<RpcMessage>> promise_;
 };
 
 class RpcAgent {
@@ -91,9 +93,13 @@ class RpcAgent {
   int StartClient();
   int Stop();
 
-  std::future<std::string> InvokeRpc(const std::string &msg,
-                                     const std::string &to,
-                                     int timeout_ms);
+  // Sends the pickled function msg with the tensors taken out of its
+  // pickle, whose data are carried in the attachment of the request.
+  std::future<RpcMessage> InvokeRpc(
+      const std::string &msg,
+      const std::vector<phi::DenseTensor> &tensors,
+      const std::string &to,
+      int timeout_ms);
 
  private:
   DISABLE_COPY_AND_ASSIGN(RpcAgent);
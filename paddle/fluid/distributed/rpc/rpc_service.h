@@ -20,6 +20,7 @@
 
 #include "paddle/fluid/distributed/rpc/python_rpc_handler.h"
 #include "paddle/fluid/distributed/rpc/rpc.pb.h"
+#include "paddle/fluid/distributed/rpc/tensor_payload.h"
 
 namespace paddle {
 namespace distributed {
@@ -41,15 +42,25 @@ class RpcService : public RpcBaseService {
             << "] from " << cntl->remote_side() << " to " << cntl->local_side()
             << ": "
             << " (attached=" << cntl->request_attachment() << ")";
-    std::string py_func_str = request->message();
+    RpcMessage py_func;
+    py_func.payload = request->message();
+    // the tensors are restored before the GIL is acquired
+    py_func.tensors =
+        DeserializeTensors(request->tensors(), &cntl->request_attachment());
     std::shared_ptr<PythonRpcHandler> python_handler =
         PythonRpcHandler::GetInstance();
-    // acquire gil, because native Python objects are used
-    py::gil_scoped_acquire ag;
-    py::object py_func_obj = python_handler->Deserialize(py_func_str);
-    py::object res = python_handler->RunPythonFunc(py_func_obj);
-    std::string res_str = python_handler->Serialize(res);
-    response->set_message(res_str);
+    RpcMessage res;
+    {
+      // acquire gil, because native Python objects are used
+      py::gil_scoped_acquire ag;
+      py::object py_func_obj = python_handler->DeserializeWithTensors(py_func);
+      py::object res_obj = python_handler->RunPythonFunc(py_func_obj);
+      res = python_handler->SerializeWithTensors(res_obj);
+    }
+    response->set_message(res.payload);
+    SerializeTensors(res.tensors,
+                     response->mutable_tensors(),
+                     &cntl->response_attachment());
   }
 };
 }  // namespace distributed
@@ -0,0 +1,170 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/rpc/tensor_payload.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#endif
+
+namespace paddle::distributed {
+
+namespace {
+
+// The allocations referenced by the IOBufs, brpc releases the user data by
+// its address only.
+struct AppendedHolders {
+  std::mutex mutex;
+  std::unordered_multimap<const void*, std::shared_ptr<phi::Allocation>>
+      holders;
+};
+
+AppendedHolders& GetAppendedHolders() {
+  static AppendedHolders* appended = new AppendedHolders();
+  return *appended;
+}
+
+void ReleaseAppendedHolder(void* data) {
+  auto& appended = GetAppendedHolders();
+  std::lock_guard<std::mutex> guard(appended.mutex);
+  auto it = appended.holders.find(data);
+  if (it != appended.holders.end()) {
+    appended.holders.erase(it);
+  }
+}
+
+void AppendWithHolder(std::shared_ptr<phi::Allocation> holder,
+                      const void* data,
+                      size_t size,
+                      butil::IOBuf* iobuf) {
+  auto& appended = GetAppendedHolders();
+  {
+    std::lock_guard<std::mutex> guard(appended.mutex);
+    appended.holders.emplace(data, std::move(holder));
+  }
+  if (iobuf->append_user_data(
+          const_cast<void*>(data), size, ReleaseAppendedHolder) != 0) {
+    iobuf->append(data, size);
+    ReleaseAppendedHolder(const_cast<void*>(data));
+  }
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+gpuStream_t GetStream(const phi::Place& place) {
+  return static_cast<phi::GPUContext*>(
+             phi::DeviceContextPool::Instance().Get(place))
+      ->stream();
+}
+#endif
+
+}  // namespace
+
+void SerializeTensors(const std::vector<phi::DenseTensor>& tensors,
+                      TensorMetas* metas,
+                      butil::IOBuf* iobuf) {
+  for (const auto& tensor : tensors) {
+    auto* meta = metas->Add();
+    meta->set_dtype(static_cast<int32_t>(tensor.dtype()));
+    for (auto dim : common::vectorize(tensor.dims())) {
+      meta->add_dims(dim);
+    }
+    size_t bytes = tensor.numel() * phi::SizeOf(tensor.dtype());
+    meta->set_bytes(bytes);
+    if (bytes == 0) {
+      continue;
+    }
+    if (phi::is_cpu_place(tensor.place())) {
+      AppendWithHolder(tensor.Holder(), tensor.data(), bytes, iobuf);
+    } else if (phi::is_gpu_place(tensor.place())) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+      meta->set_on_gpu(true);
+      std::shared_ptr<phi::Allocation> pinned =
+          memory::AllocShared(phi::GPUPinnedPlace(), bytes);
+      auto stream = GetStream(tensor.place());
+      memory::Copy(phi::GPUPinnedPlace(),
+                   pinned->ptr(),
+                   tensor.place(),
+                   tensor.data(),
+                   bytes,
+                   stream);
+      platform::GpuStreamSync(stream);
+      AppendWithHolder(pinned, pinned->ptr(), bytes, iobuf);
+#endif
+    } else {
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Only the tensors on cpu or gpu can be sent by rpc, but received "
+          "a tensor on %s.",
+          tensor.place()));
+    }
+  }
+}
+
+std::vector<phi::DenseTensor> DeserializeTensors(const TensorMetas& metas,
+                                                 butil::IOBuf* iobuf) {
+  std::vector<phi::DenseTensor> tensors(metas.size());
+  for (int i = 0; i < metas.size(); ++i) {
+    const auto& meta = metas.Get(i);
+    auto dtype = static_cast<phi::DataType>(meta.dtype());
+    auto& tensor = tensors[i];
+    tensor.Resize(common::make_ddim(
+        std::vector<int64_t>(meta.dims().begin(), meta.dims().end())));
+    PADDLE_ENFORCE_EQ(
+        meta.bytes(),
+        tensor.numel() * phi::SizeOf(dtype),
+        phi::errors::InvalidArgument(
+            "The size of the %d-th tensor in the rpc message is %d bytes, "
+            "which does not match its shape [%s].",
+            i,
+            meta.bytes(),
+            tensor.dims()));
+    PADDLE_ENFORCE_LE(meta.bytes(),
+                      iobuf->size(),
+                      phi::errors::InvalidArgument(
+                          "The attachment of the rpc message is truncated."));
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if (meta.on_gpu() && platform::GetGPUDeviceCount() > 0) {
+      phi::GPUPlace place(platform::GetCurrentDeviceId());
+      void* data = tensor.mutable_data(place, dtype);
+      if (meta.bytes() == 0) {
+        continue;
+      }
+      auto pinned = memory::Alloc(phi::GPUPinnedPlace(), meta.bytes());
+      iobuf->cutn(pinned->ptr(), meta.bytes());
+      auto stream = GetStream(place);
+      memory::Copy(place,
+                   data,
+                   phi::GPUPinnedPlace(),
+                   pinned->ptr(),
+                   meta.bytes(),
+                   stream);
+      platform::GpuStreamSync(stream);
+      continue;
+    }
+#endif
+    void* data = tensor.mutable_data(phi::CPUPlace(), dtype);
+    iobuf->cutn(data, meta.bytes());
+  }
+  return tensors;
+}
+
+}  // namespace paddle::distributed
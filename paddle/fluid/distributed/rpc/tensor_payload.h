@@ -0,0 +1,50 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "paddle/fluid/distributed/rpc/rpc.pb.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace distributed {
+
+using TensorMetas = google::protobuf::RepeatedPtrField<TensorMeta>;
+
+// A pickled python object whose tensors are carried out of the pickle, in
+// the attachment of the brpc message.
+struct RpcMessage {
+  std::string payload;
+  std::vector<phi::DenseTensor> tensors;
+};
+
+// Appends the data of the tensors to iobuf and their metas to metas. The
+// data of the cpu tensors are referenced by iobuf without being copied, the
+// gpu tensors are copied into pinned buffers that iobuf references.
+void SerializeTensors(const std::vector<phi::DenseTensor>& tensors,
+                      TensorMetas* metas,
+                      butil::IOBuf* iobuf);
+
+// Cuts the tensors described by metas from the front of iobuf. The gpu
+// tensors are restored on the current device when it is available, and on
+// cpu otherwise.
+std::vector<phi::DenseTensor> DeserializeTensors(const TensorMetas& metas,
+                                                 butil::IOBuf* iobuf);
+
+}  // namespace distributed
+}  // namespace paddle
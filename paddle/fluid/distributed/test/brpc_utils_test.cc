@@ -122,6 +122,21 @@ void RunMultiVarMsg(phi::Place place) {
   int tensor_numel3 = 564 * 128;
   for (int i = 0; i < tensor_numel3; ++i)
     EXPECT_FLOAT_EQ(tensor_data3[i], 32.7);
+
+  // deserialize a single variable
+  framework::Scope scope_single;
+  ::paddle::distributed::DeserializeVarFromMultiVarMsgAndIOBuf(
+      multi_msg, &io_buf, "x2", ctx, &scope_single);
+  EXPECT_EQ(scope_single.FindVar("x1"), nullptr);
+  EXPECT_EQ(scope_single.FindVar("x3"), nullptr);
+  auto* single_tensor =
+      scope_single.FindVar("x2")->GetMutable<phi::DenseTensor>();
+  EXPECT_EQ(single_tensor->dims(), common::make_ddim({1000, 64}));
+  auto* single_data = single_tensor->data<int>();
+  for (int i = 0; i < tensor_numel2; ++i) EXPECT_EQ(single_data[i], 100);
+  EXPECT_THROW(::paddle::distributed::DeserializeVarFromMultiVarMsgAndIOBuf(
+                   multi_msg, &io_buf, "x4", ctx, &scope_single),
+               ::common::enforce::EnforceNotMet);
 }
 
 TEST(MultiVarMsgCPU, Run) {
@@ -0,0 +1,207 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/ctr_compressed_accessor.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/common/registerer.h"
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle::distributed {
+REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseAdaGradSGDRule);
+REGISTER_PSCORE_CLASS(SparseValueSGDRule, StdAdaGradSGDRule);
+REGISTER_PSCORE_CLASS(SparseValueSGDRule, SparseAdamSGDRule);
+
+TableAccessorParameter gen_param(EmbeddingStorageType embedx_storage_type,
+                                 EmbeddingStorageType embedx_sgd_storage_type) {
+  TableAccessorParameter param;
+  param.set_accessor_class("CtrCompressedAccessor");
+  param.set_fea_dim(11);
+  param.set_embedx_dim(8);
+  param.set_embedx_threshold(0);
+  param.mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  param.mutable_ctr_accessor_param()->set_click_coeff(1);
+  param.mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  param.mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  param.mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  param.mutable_ctr_accessor_param()->set_show_click_decay_rate(0.99);
+  param.mutable_ctr_accessor_param()->set_embedx_storage_type(
+      embedx_storage_type);
+  param.mutable_ctr_accessor_param()->set_embedx_sgd_storage_type(
+      embedx_sgd_storage_type);
+
+  param.mutable_embed_sgd_param()->set_name("StdAdaGradSGDRule");
+  auto* adagrad_param = param.mutable_embed_sgd_param()->mutable_adagrad();
+  adagrad_param->set_learning_rate(0.1);
+  adagrad_param->set_initial_range(0.3);
+  adagrad_param->set_initial_g2sum(0.0);
+  adagrad_param->add_weight_bounds(-10.0);
+  adagrad_param->add_weight_bounds(10.0);
+
+  param.mutable_embedx_sgd_param()->set_name("SparseAdamSGDRule");
+  auto* adam_param = param.mutable_embedx_sgd_param()->mutable_adam();
+  adam_param->set_learning_rate(0.01);
+  adam_param->set_initial_range(0.3);
+  adam_param->set_beta1_decay_rate(0.9);
+  adam_param->set_beta2_decay_rate(0.999);
+  adam_param->set_ada_epsilon(1e-8);
+  adam_param->add_weight_bounds(-10.0);
+  adam_param->add_weight_bounds(10.0);
+
+  return param;
+}
+
+TEST(EmbeddingCodec, test_round_trip) {
+  std::vector<float> src = {0.5, -0.25, 0.125, 1.0, -1.0, 0.0, 0.3};
+  int dim = static_cast<int>(src.size());
+  for (auto type : {EMBEDDING_FP32,
+                    EMBEDDING_FP16,
+                    EMBEDDING_BF16,
+                    EMBEDDING_INT8}) {
+    EmbeddingCodec codec(type, dim);
+    std::vector<float> encoded(codec.Dim());
+    std::vector<float> decoded(dim);
+    codec.Encode(src.data(), encoded.data(), false);
+    codec.Decode(encoded.data(), decoded.data());
+    float tolerance = type == EMBEDDING_INT8 ? 1.0 / 127 : 1.0 / 128;
+    for (int i = 0; i < dim; ++i) {
+      ASSERT_NEAR(src[i], decoded[i], tolerance) << "type " << type;
+    }
+  }
+  ASSERT_EQ(EmbeddingCodec(EMBEDDING_FP32, 8).Dim(), 8);
+  ASSERT_EQ(EmbeddingCodec(EMBEDDING_FP16, 7).Dim(), 4);
+  ASSERT_EQ(EmbeddingCodec(EMBEDDING_BF16, 8).Dim(), 4);
+  ASSERT_EQ(EmbeddingCodec(EMBEDDING_INT8, 8).Dim(), 3);
+}
+
+TEST(EmbeddingCodec, test_stochastic_rounding) {
+  // 1 + 2^-10 is between two bf16 values, and rounded to 1 by the nearest
+  // rounding, while the stochastic rounding keeps it in expectation
+  std::vector<float> src(1024, 1.0f + 1.0f / 1024);
+  EmbeddingCodec codec(EMBEDDING_BF16, src.size());
+  std::vector<float> encoded(codec.Dim());
+  std::vector<float> decoded(src.size());
+  codec.Encode(src.data(), encoded.data(), true);
+  codec.Decode(encoded.data(), decoded.data());
+  double sum = 0;
+  for (auto x : decoded) {
+    sum += x;
+  }
+  ASSERT_NEAR(sum / src.size(), src[0], 1.0 / 2048);
+}
+
+TEST(CtrCompressedAccessor, test_init) {
+  for (auto type : {EMBEDDING_FP16, EMBEDDING_BF16, EMBEDDING_INT8}) {
+    CtrCompressedAccessor acc;
+    acc.Configure(gen_param(type, EMBEDDING_BF16));
+    acc.Initialize();
+    CtrCommonAccessor common_acc;
+    common_acc.Configure(gen_param(type, EMBEDDING_BF16));
+    common_acc.Initialize();
+
+    auto info = acc.GetAccessorInfo();
+    auto common_info = common_acc.GetAccessorInfo();
+    // embedx_w 8, adam moments 2 * 8 in bf16, beta powers 2 in fp32
+    int embedx_dim = type == EMBEDDING_INT8 ? 3 : 4;
+    ASSERT_EQ(info.dim, 6 + 1 + embedx_dim + 8 + 2);
+    ASSERT_EQ(info.size, info.dim * sizeof(float));
+    ASSERT_EQ(info.mf_size, (embedx_dim + 8 + 2) * sizeof(float));
+    ASSERT_EQ(common_info.dim, 6 + 1 + 8 + 18);
+    ASSERT_EQ(info.select_dim, common_info.select_dim);
+    ASSERT_EQ(info.update_dim, common_info.update_dim);
+  }
+
+  CtrCompressedAccessor acc;
+  acc.Configure(gen_param(EMBEDDING_INT8, EMBEDDING_INT8));
+  ASSERT_ANY_THROW(acc.Initialize());
+}
+
+TEST(CtrCompressedAccessor, test_update) {
+  CtrCompressedAccessor acc;
+  acc.Configure(gen_param(EMBEDDING_INT8, EMBEDDING_BF16));
+  acc.Initialize();
+  CtrCommonAccessor common_acc;
+  common_acc.Configure(gen_param(EMBEDDING_INT8, EMBEDDING_BF16));
+  common_acc.Initialize();
+
+  size_t dim = acc.GetAccessorInfo().dim;
+  size_t common_dim = common_acc.GetAccessorInfo().dim;
+  size_t update_dim = acc.GetAccessorInfo().update_dim;
+  size_t select_dim = acc.GetAccessorInfo().select_dim;
+  std::vector<float> value(dim);
+  float* value_ptr = value.data();
+  acc.Create(&value_ptr, 1);
+  // the fp32 reference starts from the same values
+  std::vector<float> common_value(common_dim);
+  acc.Decompress(value.data(), dim, common_value.data());
+  float* common_value_ptr = common_value.data();
+
+  std::vector<float> push(update_dim);
+  for (size_t i = 0; i < update_dim; ++i) {
+    push[i] = 0.1 * (i % 3) - 0.1;
+  }
+  push[CtrCommonAccessor::CtrCommonPushValue::SlotIndex()] = 1;
+  push[CtrCommonAccessor::CtrCommonPushValue::ShowIndex()] = 1;
+  const float* push_ptr = push.data();
+  for (int step = 0; step < 10; ++step) {
+    acc.Update(&value_ptr, &push_ptr, 1);
+    common_acc.Update(&common_value_ptr, &push_ptr, 1);
+  }
+
+  std::vector<float> pull(select_dim);
+  std::vector<float> common_pull(select_dim);
+  float* pull_ptr = pull.data();
+  float* common_pull_ptr = common_pull.data();
+  acc.Select(&pull_ptr, const_cast<const float**>(&value_ptr), 1);
+  common_acc.Select(
+      &common_pull_ptr, const_cast<const float**>(&common_value_ptr), 1);
+  for (size_t i = 0; i < select_dim; ++i) {
+    ASSERT_NEAR(pull[i], common_pull[i], 0.02) << "index " << i;
+  }
+}
+
+TEST(CtrCompressedAccessor, test_string_related) {
+  CtrCompressedAccessor acc;
+  acc.Configure(gen_param(EMBEDDING_FP16, EMBEDDING_FP16));
+  acc.Initialize();
+  CtrCommonAccessor common_acc;
+  common_acc.Configure(gen_param(EMBEDDING_FP16, EMBEDDING_FP16));
+  common_acc.Initialize();
+
+  size_t dim = acc.GetAccessorInfo().dim;
+  size_t common_dim = common_acc.GetAccessorInfo().dim;
+  std::vector<float> common_value(common_dim);
+  for (size_t i = 0; i < common_dim; ++i) {
+    common_value[i] = 0.5;
+  }
+  // the models saved by CtrCommonAccessor are loaded without loss
+  std::string str = common_acc.ParseToString(common_value.data(), common_dim);
+  std::vector<float> value(dim);
+  ASSERT_EQ(acc.ParseFromString(str, value.data()), static_cast<int>(dim));
+  ASSERT_EQ(acc.ParseToString(value.data(), dim), str);
+
+  // the values without the embedx
+  size_t header_dim = acc.compressed_feature_value.EmbedxWIndex();
+  str = common_acc.ParseToString(common_value.data(), header_dim);
+  ASSERT_EQ(acc.ParseFromString(str, value.data()),
+            static_cast<int>(header_dim));
+  ASSERT_FALSE(acc.HasMF(header_dim));
+  ASSERT_TRUE(acc.HasMF(dim));
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,103 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/dense_gradient_codec.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TEST(DenseGradientCodec, test_cast) {
+  std::vector<float> values = {0.5, -0.25, 1e-3, 3.0, -7.5, 0.0, 0.1};
+  uint32_t num = values.size();
+  for (auto type :
+       {DENSE_GRADIENT_FP32, DENSE_GRADIENT_FP16, DENSE_GRADIENT_BF16}) {
+    std::string data;
+    EncodeDenseGradient(type, values.data(), num, 0, nullptr, &data);
+    size_t value_size = type == DENSE_GRADIENT_FP32 ? 4 : 2;
+    ASSERT_EQ(data.size(), sizeof(uint32_t) + num * value_size);
+
+    std::vector<float> decoded;
+    ASSERT_EQ(DecodeDenseGradient(type, data.data(), data.size(), &decoded),
+              0);
+    ASSERT_EQ(decoded.size(), values.size());
+    for (uint32_t i = 0; i < num; ++i) {
+      ASSERT_NEAR(decoded[i], values[i], std::fabs(values[i]) / 128)
+          << "type " << type;
+    }
+    // the size is checked against num
+    ASSERT_EQ(
+        DecodeDenseGradient(type, data.data(), data.size() - 2, &decoded), -1);
+  }
+}
+
+TEST(DenseGradientCodec, test_topk_error_feedback) {
+  uint32_t num = 100;
+  std::vector<float> values(num);
+  for (uint32_t i = 0; i < num; ++i) {
+    values[i] = (i % 2 ? 0.01 : -0.01) * (i + 1);
+  }
+  std::vector<float> residual(num, 0);
+  std::vector<float> total(num, 0);
+  std::string data;
+  std::vector<float> decoded;
+
+  EncodeDenseGradient(
+      DENSE_GRADIENT_TOPK, values.data(), num, 0.1, residual.data(), &data);
+  ASSERT_EQ(data.size(), 2 * sizeof(uint32_t) + 10 * 8);
+  ASSERT_EQ(DecodeDenseGradient(
+                DENSE_GRADIENT_TOPK, data.data(), data.size(), &decoded),
+            0);
+  // the 10 values of the largest magnitude are sent, and the others are kept
+  for (uint32_t i = 0; i < num; ++i) {
+    if (i >= 90) {
+      ASSERT_FLOAT_EQ(decoded[i], values[i]);
+      ASSERT_FLOAT_EQ(residual[i], 0.0f);
+    } else {
+      ASSERT_FLOAT_EQ(decoded[i], 0.0f);
+      ASSERT_FLOAT_EQ(residual[i], values[i]);
+    }
+    total[i] += decoded[i];
+  }
+
+  // with zero gradients, the residual is sent in 9 pushes
+  std::vector<float> zeros(num, 0);
+  for (int step = 0; step < 9; ++step) {
+    EncodeDenseGradient(
+        DENSE_GRADIENT_TOPK, zeros.data(), num, 0.1, residual.data(), &data);
+    ASSERT_EQ(DecodeDenseGradient(
+                  DENSE_GRADIENT_TOPK, data.data(), data.size(), &decoded),
+              0);
+    for (uint32_t i = 0; i < num; ++i) {
+      total[i] += decoded[i];
+    }
+  }
+  for (uint32_t i = 0; i < num; ++i) {
+    ASSERT_FLOAT_EQ(total[i], values[i]);
+    ASSERT_FLOAT_EQ(residual[i], 0.0f);
+  }
+
+  // k is checked against num
+  std::string bad = data;
+  reinterpret_cast<uint32_t*>(const_cast<char*>(bad.data()))[0] = 5;
+  ASSERT_EQ(DecodeDenseGradient(
+                DENSE_GRADIENT_TOPK, bad.data(), bad.size(), &decoded),
+            -1);
+}
+
+}  // namespace paddle::distributed
@@ -14,12 +14,71 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 
 namespace paddle::distributed {
 
+static size_t allocated_map_bytes = 0;
+
+// Counts the bytes allocated by the hash maps of the shards.
+template <class T>
+struct CountingAllocator : public std::allocator<T> {
+  template <class U>
+  struct rebind {
+    typedef CountingAllocator<U> other;
+  };
+  CountingAllocator() = default;
+  template <class U>
+  CountingAllocator(const CountingAllocator<U>&) {}  // NOLINT
+  T* allocate(size_t n, const void* = nullptr) {
+    allocated_map_bytes += n * sizeof(T);
+    return std::allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    allocated_map_bytes -= n * sizeof(T);
+    std::allocator<T>::deallocate(p, n);
+  }
+};
+
+template <class SHARD>
+void BenchmarkShard(const std::string& name,
+                    const std::vector<uint64_t>& keys) {
+  size_t base_bytes = allocated_map_bytes;
+  auto shard = std::make_unique<SHARD>();
+  for (auto key : keys) {
+    (*shard)[key];
+  }
+  double bytes_per_key =
+      static_cast<double>(allocated_map_bytes - base_bytes) / keys.size();
+
+  std::vector<uint64_t> pull_keys(keys);
+  std::shuffle(pull_keys.begin(), pull_keys.end(), std::mt19937_64(1));
+  size_t found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < pull_keys.size(); ++i) {
+    if (i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE < pull_keys.size()) {
+      shard->prefetch(pull_keys[i + CTR_SPARSE_SHARD_PREFETCH_DISTANCE]);
+    }
+    found += shard->find(pull_keys[i]) != shard->end();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  ASSERT_EQ(found, keys.size());
+  LOG(INFO) << name << ": " << keys.size() << " keys, " << bytes_per_key
+            << " bytes of the hash map per key, "
+            << pull_keys.size() / seconds << " pulls per second";
+}
+
 TEST(BENCHMARK, LargeScaleKV) {
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   shard_type shard;
@@ -45,4 +104,84 @@ TEST(BENCHMARK, LargeScaleKV) {
   ASSERT_FLOAT_EQ(value_data[3], 0.3);
 }
 
+TEST(FlatSparseTableShard, Consistency) {
+  typedef FlatSparseTableShard<uint64_t, FixedFeatureValue> shard_type;
+  shard_type shard;
+  std::unordered_map<uint64_t, float> expected;
+  std::mt19937_64 rng(0);
+  for (int i = 0; i < 200000; ++i) {
+    // a small key space so that the keys are erased and inserted again
+    uint64_t key = rng() % 50000;
+    if (rng() % 4 == 0) {
+      ASSERT_EQ(shard.erase(key), expected.erase(key));
+    } else {
+      auto res = shard.emplace(key);
+      ASSERT_EQ(res.second, expected.count(key) == 0);
+      if (res.second) {
+        res.first.value().resize(1);
+        res.first.value().data()[0] = static_cast<float>(i);
+        expected[key] = static_cast<float>(i);
+      }
+    }
+  }
+  ASSERT_EQ(shard.size(), expected.size());
+
+  size_t num = 0;
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    ASSERT_EQ(expected.count(it.key()), 1UL);
+    ASSERT_FLOAT_EQ(it.value().data()[0], expected[it.key()]);
+    ++num;
+  }
+  ASSERT_EQ(num, expected.size());
+
+  num = 0;
+  for (size_t bucket = 0; bucket < shard.bucket_count(); ++bucket) {
+    num += shard.bucket_size(bucket);
+  }
+  ASSERT_EQ(num, expected.size());
+
+  for (auto it = shard.begin(); it != shard.end();) {
+    if (it.key() % 2 == 0) {
+      expected.erase(it.key());
+      it = shard.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto& [key, value] : expected) {
+    auto it = shard.find(key);
+    ASSERT_TRUE(it != shard.end());
+    ASSERT_FLOAT_EQ(it.value().data()[0], value);
+  }
+  ASSERT_EQ(shard.size(), expected.size());
+  shard.clear();
+  ASSERT_TRUE(shard.find(1) == shard.end());
+}
+
+TEST(BENCHMARK, SparseTableShardLayout) {
+  std::vector<uint64_t> keys(1 << 20);
+  std::mt19937_64 rng(0);
+  for (auto& key : keys) {
+    key = rng();
+  }
+  BenchmarkShard<SparseTableShard<
+      uint64_t,
+      FixedFeatureValue,
+      mct::closed_hash_map<uint64_t,
+                           mct::Pointer,
+                           std::hash<uint64_t>,
+                           std::equal_to<uint64_t>,
+                           CountingAllocator<std::pair<const uint64_t,
+                                                       mct::Pointer>>>>>(
+      "SparseTableShard", keys);
+  BenchmarkShard<SparseTableShard<
+      uint64_t,
+      FixedFeatureValue,
+      FlatHashMap<uint64_t,
+                  mct::Pointer,
+                  std::hash<uint64_t>,
+                  CountingAllocator<std::pair<uint64_t, mct::Pointer>>>>>(
+      "FlatSparseTableShard", keys);
+}
+
 }  // namespace paddle::distributed
@@ -0,0 +1,62 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/table/depends/geo_recorder.h"
+
+namespace paddle::distributed {
+
+TEST(GeoDeltaRecorder, Select) {
+  GeoDeltaRecorder recorder(0.25, 1.0, 3);
+  std::vector<int64_t> ids;
+  std::vector<float> magnitudes;
+  for (int64_t id = 0; id < 8; ++id) {
+    ids.push_back(id);
+    magnitudes.push_back(0.01 * id);
+  }
+  // a large delta out of the top ones, and a key with no delta
+  magnitudes[1] = 2.0;
+  magnitudes[0] = 0;
+  recorder.Select(&ids, magnitudes);
+  std::sort(ids.begin(), ids.end());
+  ASSERT_EQ(ids, std::vector<int64_t>({1, 7}));
+  ASSERT_EQ(recorder.HeldSize(), 5UL);
+
+  // the keys held back come back with the touched ones
+  ids = {7, 8};
+  recorder.Merge(&ids);
+  ASSERT_EQ(ids.size(), 7UL);
+  std::sort(ids.begin(), ids.end());
+  ASSERT_EQ(ids, std::vector<int64_t>({2, 3, 4, 5, 6, 7, 8}));
+
+  // the top two, 7 and 8, are pushed, the others are held back a second
+  // time, and are all pushed in the third round
+  magnitudes.assign(ids.size(), 0.01);
+  magnitudes[5] = magnitudes[6] = 0.5;
+  recorder.Select(&ids, magnitudes);
+  std::sort(ids.begin(), ids.end());
+  ASSERT_EQ(ids, std::vector<int64_t>({7, 8}));
+
+  ids.clear();
+  recorder.Merge(&ids);
+  magnitudes.assign(ids.size(), 0.01);
+  recorder.Select(&ids, magnitudes);
+  ASSERT_EQ(ids.size(), 5UL);
+  ASSERT_EQ(recorder.HeldSize(), 0UL);
+}
+
+}  // namespace paddle::distributed
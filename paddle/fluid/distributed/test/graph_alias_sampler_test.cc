@@ -0,0 +1,97 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <memory>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/common_graph_table.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_weighted_sampler.h"
+
+COMMON_DECLARE_int32(graph_alias_sampler_degree_threshold);
+
+namespace paddle::distributed {
+
+TEST(AliasSampler, test_sample_k) {
+  int n = 100;
+  WeightedGraphEdgeBlob edges;
+  for (int i = 0; i < n; i++) {
+    // the neighbor 0 takes half of the weight
+    edges.add_edge(i, i == 0 ? n - 1 : 1);
+  }
+  AliasSampler sampler;
+  sampler.build(&edges);
+  auto rng = std::make_shared<std::mt19937_64>(0);
+
+  // all the neighbors
+  ASSERT_EQ(sampler.sample_k(n, rng).size(), static_cast<size_t>(n));
+
+  int rounds = 20000, hits = 0;
+  for (int round = 0; round < rounds; round++) {
+    std::vector<int> res = sampler.sample_k(1, rng);
+    ASSERT_EQ(res.size(), 1UL);
+    hits += res[0] == 0;
+  }
+  ASSERT_NEAR(static_cast<double>(hits) / rounds, 0.5, 0.02);
+
+  // without replacement, with the remaining ones chosen by the keys
+  for (int k : {10, 90, 99}) {
+    std::vector<int> res = sampler.sample_k(k, rng);
+    ASSERT_EQ(res.size(), static_cast<size_t>(k));
+    std::unordered_set<int> unique(res.begin(), res.end());
+    ASSERT_EQ(unique.size(), static_cast<size_t>(k));
+    for (int x : res) {
+      ASSERT_GE(x, 0);
+      ASSERT_LT(x, n);
+    }
+  }
+}
+
+TEST(AliasSampler, test_shard_sample_neighbors) {
+  // the node 3 of 60 neighbors is sampled by the alias method
+  FLAGS_graph_alias_sampler_degree_threshold = 50;
+  GraphShard shard;
+  for (uint64_t id = 1; id <= 3; id++) {
+    GraphNode *node = shard.add_graph_node(id);
+    node->build_edges(true);
+    for (uint64_t j = 0; j < 20 * id; j++) {
+      node->add_edge(100 * id + j, 1.0 + j);
+    }
+    node->build_sampler(id == 3 ? "alias" : "weighted");
+  }
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  std::vector<uint64_t> ids = {1, 4, 3, 2};
+  std::vector<uint64_t> neighbors;
+  std::vector<int> actual_sizes;
+  shard.sample_neighbors(
+      ids.data(), ids.size(), 30, rng, &neighbors, &actual_sizes);
+  ASSERT_EQ(actual_sizes, std::vector<int>({20, 0, 30, 30}));
+  ASSERT_EQ(neighbors.size(), 80UL);
+  size_t offset = 0;
+  for (size_t i = 0; i < ids.size(); i++) {
+    std::unordered_set<uint64_t> unique;
+    for (int j = 0; j < actual_sizes[i]; j++) {
+      uint64_t neighbor = neighbors[offset + j];
+      ASSERT_EQ(neighbor / 100, ids[i]);
+      unique.insert(neighbor);
+    }
+    ASSERT_EQ(unique.size(), static_cast<size_t>(actual_sizes[i]));
+    offset += actual_sizes[i];
+  }
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,107 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TEST(CsrGraph, test_dump_load_sample) {
+  // the node i has the neighbors i * 1000 + j * j, in a reversed order
+  std::vector<std::unique_ptr<GraphNode>> nodes;
+  std::vector<Node *> node_ptrs;
+  for (uint64_t id : {7, 3, 1000000007, 5}) {
+    nodes.emplace_back(new GraphNode(id));
+    GraphNode *node = nodes.back().get();
+    node->build_edges(true);
+    uint64_t degree = id % 100;
+    for (uint64_t j = degree; j > 0; j--) {
+      node->add_edge(id * 1000 + j * j, j == 1 ? 100.0 : 0.01);
+    }
+    node_ptrs.push_back(node);
+  }
+  std::string path = "./graph_csr_test.csr";
+  ASSERT_EQ(CsrGraph::dump(node_ptrs, true, path), 0);
+
+  CsrGraph graph;
+  ASSERT_EQ(graph.load(path), 0);
+  ASSERT_EQ(graph.node_num(), 4UL);
+  ASSERT_EQ(graph.edge_num(), 22UL);
+  ASSERT_TRUE(graph.is_weighted());
+  ASSERT_EQ(graph.find(4), -1);
+
+  std::vector<uint64_t> ids;
+  std::vector<float> weights;
+  for (uint64_t id : {3, 5, 7, 1000000007}) {
+    int64_t index = graph.find(id);
+    ASSERT_GE(index, 0);
+    uint64_t degree = id % 100;
+    ASSERT_EQ(graph.degree(index), degree);
+    graph.get_neighbors(index, &ids, &weights);
+    for (uint64_t j = 1; j <= degree; j++) {
+      ASSERT_EQ(ids[j - 1], id * 1000 + j * j);
+      ASSERT_NEAR(weights[j - 1], j == 1 ? 100.0 : 0.01, 1e-3);
+    }
+  }
+
+  auto rng = std::make_shared<std::mt19937_64>(0);
+  int64_t index = graph.find(7);
+  int item_size = Node::id_size + Node::weight_size;
+  for (int k : {3, 7, 10}) {
+    char *buffer = nullptr;
+    int size = graph.sample(index, k, true, rng, &buffer);
+    int sample_size = std::min(k, 7);
+    ASSERT_EQ(size, sample_size * item_size);
+    std::unordered_set<uint64_t> unique;
+    bool heavy = false;
+    for (int i = 0; i < sample_size; i++) {
+      uint64_t neighbor;
+      float weight;
+      memcpy(&neighbor, buffer + i * item_size, Node::id_size);
+      memcpy(&weight,
+             buffer + i * item_size + Node::id_size,
+             Node::weight_size);
+      ASSERT_EQ(neighbor / 1000, 7UL);
+      unique.insert(neighbor);
+      heavy |= neighbor == 7001;
+    }
+    ASSERT_EQ(unique.size(), static_cast<size_t>(sample_size));
+    // the neighbor of the largest weight is almost always sampled
+    ASSERT_TRUE(heavy);
+    delete[] buffer;
+  }
+
+  // a truncated file is rejected
+  FILE *fp = fopen(path.c_str(), "r+");
+  ASSERT_NE(fp, nullptr);
+  ASSERT_EQ(ftruncate(fileno(fp), 64), 0);
+  fclose(fp);
+  CsrGraph truncated;
+  ASSERT_EQ(truncated.load(path), -1);
+  ASSERT_EQ(truncated.find(7), -1);
+  remove(path.c_str());
+}
+
+}  // namespace paddle::distributed
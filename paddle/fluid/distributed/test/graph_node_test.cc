@@ -578,6 +578,26 @@ void RunBrpcPushSparse() {
       std::string("user2item"), node_ids, 4, true, false);
 
   ASSERT_EQ(res.first[1].size(), 1UL);
+
+  // the concurrent samplings are coalesced into one request per server
+  paddle::distributed::FLAGS_pserver_graph_sample_coalesce_window_us = 1000;
+  std::vector<std::thread> sample_threads;
+  std::vector<size_t> sample_sizes(4);
+  for (size_t i = 0; i < sample_sizes.size(); ++i) {
+    sample_threads.emplace_back([&, i] {
+      auto sample_res = client1.batch_sample_neighbors(
+          std::string("user2item"), node_ids, 4, true, false);
+      sample_sizes[i] = sample_res.first[0].size();
+    });
+  }
+  for (auto& t : sample_threads) {
+    t.join();
+  }
+  paddle::distributed::FLAGS_pserver_graph_sample_coalesce_window_us = 0;
+  for (auto sample_size : sample_sizes) {
+    ASSERT_EQ(sample_size, 4UL);
+  }
+
   std::vector<int64_t> nodes_ids = client2.random_sample_nodes("user", 0, 6);
   ASSERT_EQ(nodes_ids.size(), 2UL);
   ASSERT_EQ(true,
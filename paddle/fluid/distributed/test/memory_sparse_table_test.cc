@@ -152,5 +152,186 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+Table *CreateNaiveSGDTable(int emb_dim,
+                           int shard_num,
+                           bool enable_delta_save,
+                           int shard_idx,
+                           int server_num) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(shard_num);
+  table_config.set_compress_in_save(false);
+  table_config.set_enable_delta_save(enable_delta_save);
+  FsClientParameter fs_config;
+  Table *table = new MemorySparseTable();
+  table->SetShard(shard_idx, server_num);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(emb_dim + 3);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(5);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+Table *CreateDeltaSaveTable(int emb_dim) {
+  return CreateNaiveSGDTable(emb_dim, 10, true, 0, 1);
+}
+
+void PushDeltaSaveTable(Table *table,
+                        std::vector<uint64_t> keys,
+                        int emb_dim,
+                        float grad) {
+  std::vector<float> push_values(keys.size() * (emb_dim + 4), grad);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = push_values.data();
+  table_context.num = keys.size();
+  table->Push(table_context);
+}
+
+std::vector<float> PullDeltaSaveTable(Table *table,
+                                      std::vector<uint64_t> keys,
+                                      int emb_dim) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  std::vector<float> pull_values(keys.size() * (emb_dim + 3));
+  auto value = PullSparseValue(keys, fres, emb_dim);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values.data();
+  table->Pull(table_context);
+  return pull_values;
+}
+
+TEST(MemorySparseTable, DeltaSave) {
+  int emb_dim = 8;
+  std::string dirname = "./memory_sparse_table_delta_save";
+  std::vector<uint64_t> keys = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 12, 20};
+
+  Table *table = CreateDeltaSaveTable(emb_dim);
+  PushDeltaSaveTable(table, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, emb_dim, 0.1);
+  ASSERT_EQ(table->Save(dirname + "/base", "0"), 0);
+  PushDeltaSaveTable(table, {1, 3, 12}, emb_dim, 0.2);
+  ASSERT_EQ(table->Save(dirname + "/delta_1", "6"), 0);
+  PushDeltaSaveTable(table, {3, 20}, emb_dim, 0.3);
+  ASSERT_EQ(table->Save(dirname + "/delta_2", "6"), 0);
+  auto expected = PullDeltaSaveTable(table, keys, emb_dim);
+
+  // the base checkpoint is text, so its values are rounded
+  Table *restored = CreateDeltaSaveTable(emb_dim);
+  ASSERT_EQ(restored->Load(dirname + "/base", "0"), 0);
+  ASSERT_EQ(restored->Load(dirname + "/delta_1", "6"), 0);
+  ASSERT_EQ(restored->Load(dirname + "/delta_2", "6"), 0);
+  auto values = PullDeltaSaveTable(restored, keys, emb_dim);
+  ASSERT_EQ(values.size(), expected.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_NEAR(values[i], expected[i], 1e-4);
+  }
+
+  // restore from the base and the merged deltas
+  AfsClient fs_client;
+  for (int i = 0; i < 10; ++i) {
+    std::string file_name =
+        ::paddle::string::format_string("/000/part-000-%05d.delta", i);
+    ASSERT_GE(MergeSparseTableDeltas(&fs_client,
+                                     {dirname + "/delta_1" + file_name,
+                                      dirname + "/delta_2" + file_name},
+                                     dirname + "/merged" + file_name),
+              0);
+  }
+  Table *merged = CreateDeltaSaveTable(emb_dim);
+  ASSERT_EQ(merged->Load(dirname + "/base", "0"), 0);
+  ASSERT_EQ(merged->Load(dirname + "/merged", "6"), 0);
+  EXPECT_EQ(PullDeltaSaveTable(merged, keys, emb_dim), values);
+
+  delete table;
+  delete restored;
+  delete merged;
+}
+
+TEST(MemorySparseTable, ShardSwap) {
+  int emb_dim = 8;
+  std::string dirname = "./memory_sparse_table_shard_swap";
+  // 4 shards on 2 servers, the server 0 keeps the shards 0 and 1
+  Table *server_0 = CreateNaiveSGDTable(emb_dim, 4, false, 0, 2);
+  Table *server_1 = CreateNaiveSGDTable(emb_dim, 4, false, 1, 2);
+  PushDeltaSaveTable(server_0, {0, 4, 1}, emb_dim, 0.1);
+  PushDeltaSaveTable(server_1, {2, 6, 3}, emb_dim, 0.2);
+  auto expected_0 = PullDeltaSaveTable(server_0, {0, 4}, emb_dim);
+  auto expected_2 = PullDeltaSaveTable(server_1, {2, 6}, emb_dim);
+
+  std::vector<SparseShardLoad> loads;
+  ASSERT_EQ(server_0->QueryShardLoad(&loads), 0);
+  ASSERT_EQ(loads.size(), 2UL);
+  EXPECT_EQ(loads[0].shard_id, 0U);
+  EXPECT_EQ(loads[0].access_num, 4UL);
+  EXPECT_EQ(loads[0].key_num, 2UL);
+  EXPECT_EQ(loads[1].access_num, 1UL);
+
+  // the shard 0 of the server 0 is swapped for the shard 2 of the server 1
+  std::string data_0, data_2;
+  ASSERT_EQ(server_0->ExportShard(0, &data_0), 0);
+  ASSERT_EQ(server_1->ExportShard(2, &data_2), 0);
+  EXPECT_NE(server_0->ExportShard(2, &data_2), 0);
+  EXPECT_NE(server_0->ImportShard(1, data_2), 0);
+  EXPECT_NE(server_1->ImportShard(0, data_0.substr(1)), 0);
+  ASSERT_EQ(server_1->ImportShard(0, data_0), 0);
+  ASSERT_EQ(server_0->ImportShard(2, data_2), 0);
+  ASSERT_EQ(server_0->SwitchShard(0, 2), 0);
+  ASSERT_EQ(server_1->SwitchShard(2, 0), 0);
+  EXPECT_EQ(PullDeltaSaveTable(server_1, {0, 4}, emb_dim), expected_0);
+  EXPECT_EQ(PullDeltaSaveTable(server_0, {2, 6}, emb_dim), expected_2);
+
+  // the keys of the shards swapped out are rejected
+  std::vector<uint64_t> keys = {0};
+  std::vector<float> values(emb_dim + 4, 0.1);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = values.data();
+  table_context.num = keys.size();
+  EXPECT_EQ(server_0->Push(table_context), -1);
+
+  SparseShardRoute route(4, 2);
+  EXPECT_NE(server_0->SetShardRoute(route), 0);
+  route.Swap({0, 0, 1, 2});
+  ASSERT_EQ(server_0->SetShardRoute(route), 0);
+  SparseShardRoute server_route;
+  ASSERT_EQ(server_0->GetShardRoute(&server_route), 0);
+  EXPECT_EQ(server_route.Version(), 1UL);
+  EXPECT_EQ(server_route.Server(4), 1U);
+
+  // a restart restores the layout of the startup from the checkpoints
+  ASSERT_EQ(server_0->Save(dirname, "0"), 0);
+  ASSERT_EQ(server_1->Save(dirname, "0"), 0);
+  Table *restored_0 = CreateNaiveSGDTable(emb_dim, 4, false, 0, 2);
+  Table *restored_1 = CreateNaiveSGDTable(emb_dim, 4, false, 1, 2);
+  ASSERT_EQ(restored_0->Load(dirname, "0"), 0);
+  ASSERT_EQ(restored_1->Load(dirname, "0"), 0);
+  auto values_0 = PullDeltaSaveTable(restored_0, {0, 4}, emb_dim);
+  auto values_2 = PullDeltaSaveTable(restored_1, {2, 6}, emb_dim);
+  for (size_t i = 0; i < values_0.size(); ++i) {
+    EXPECT_NEAR(values_0[i], expected_0[i], 1e-4);
+    EXPECT_NEAR(values_2[i], expected_2[i], 1e-4);
+  }
+
+  delete server_0;
+  delete server_1;
+  delete restored_0;
+  delete restored_1;
+}
+
 }  // namespace distributed
 }  // namespace paddle
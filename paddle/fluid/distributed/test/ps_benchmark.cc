@@ -0,0 +1,522 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// A load generator for the sparse tables of the parameter server. It drives
+// PullSparse and PushSparse from N client threads, with the keys drawn from a
+// Zipf distribution over the key space, either on the tables in process
+// (--ps_bench_mode=table) or through BrpcPsClient on M BrpcPsServers over the
+// loopback (--ps_bench_mode=brpc), and reports the QPS, the latency
+// percentiles, the memory per key and the CPU time per request, e.g.
+//
+//   ./ps_benchmark --ps_bench_table=SSDSparseTable --ps_bench_zipf=1.1 \
+//       --ps_bench_key_space=100000000 --ps_bench_threads=16
+//
+// The servers share the process with the clients in the brpc mode, so the
+// CPU time per request covers both of them.
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_client.h"
+#include "paddle/fluid/distributed/ps/service/brpc_ps_server.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+PD_DEFINE_string(ps_bench_mode,
+                 "table",
+                 "table: drive the tables in process, brpc: drive the "
+                 "BrpcPsServers through BrpcPsClient.");
+PD_DEFINE_string(ps_bench_table,
+                 "MemorySparseTable",
+                 "The table class, e.g. MemorySparseTable, "
+                 "MemoryFlatSparseTable or SSDSparseTable.");
+PD_DEFINE_string(ps_bench_accessor,
+                 "CtrCommonAccessor",
+                 "The accessor class of the table.");
+PD_DEFINE_int32(ps_bench_embedx_dim, 8, "The embedx dim of the values.");
+PD_DEFINE_int32(ps_bench_shard_num, 16, "The shard num of the table.");
+PD_DEFINE_int64(ps_bench_key_space, 100000, "The number of distinct keys.");
+PD_DEFINE_double(ps_bench_zipf,
+                 0.99,
+                 "The skew of the Zipf distribution of the keys, 0 draws "
+                 "the keys uniformly.");
+PD_DEFINE_int32(ps_bench_batch_size, 256, "The keys of each request.");
+PD_DEFINE_int32(ps_bench_threads, 4, "The client threads.");
+PD_DEFINE_int32(ps_bench_servers, 1, "The servers, or the tables in process.");
+PD_DEFINE_int32(ps_bench_requests, 100, "The requests of each thread.");
+PD_DEFINE_double(ps_bench_push_ratio,
+                 0.5,
+                 "The fraction of the requests which push the gradients.");
+PD_DEFINE_int32(ps_bench_port, 4300, "The first port of the brpc servers.");
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+// Samples the ranks 0..n-1 with the probability proportional to
+// 1 / (rank + 1)^s, by the rejection-inversion of Hormann and Derflinger,
+// which takes O(1) time and memory for any key space.
+class ZipfSampler {
+ public:
+  ZipfSampler(uint64_t n, double s)
+      : n_(static_cast<double>(n)),
+        s_(s),
+        h_x1_(H(1.5) - 1.0),
+        h_n_(H(n_ + 0.5)),
+        threshold_(2.0 - HInverse(H(2.5) - h(2.0))) {}
+
+  uint64_t operator()(std::mt19937_64* engine) {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    while (true) {
+      double u = h_n_ + dist(*engine) * (h_x1_ - h_n_);
+      double x = HInverse(u);
+      double k = std::min(std::max(std::floor(x + 0.5), 1.0), n_);
+      if (k - x <= threshold_ || u >= H(k + 0.5) - h(k)) {
+        return static_cast<uint64_t>(k) - 1;
+      }
+    }
+  }
+
+ private:
+  double h(double x) const { return std::exp(-s_ * std::log(x)); }
+
+  double H(double x) const {
+    double log_x = std::log(x);
+    return ExpM1OverX((1.0 - s_) * log_x) * log_x;
+  }
+
+  double HInverse(double x) const {
+    double t = std::max(x * (1.0 - s_), -1.0);
+    return std::exp(Log1POverX(t) * x);
+  }
+
+  static double Log1POverX(double x) {
+    if (std::abs(x) > 1e-8) return std::log1p(x) / x;
+    return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+  }
+
+  static double ExpM1OverX(double x) {
+    if (std::abs(x) > 1e-8) return std::expm1(x) / x;
+    return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+  }
+
+  double n_;
+  double s_;
+  double h_x1_;
+  double h_n_;
+  double threshold_;
+};
+
+// The hot ranks are scattered over the shards by the bijective splitmix64
+// finalizer, so the distinct ranks stay distinct keys.
+uint64_t RankToKey(uint64_t rank) {
+  uint64_t z = rank + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+int64_t ResidentMemoryKB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return std::stoll(line.substr(6));
+    }
+  }
+  return 0;
+}
+
+double CpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double Percentile(std::vector<double>* values, double p) {
+  if (values->empty()) return 0;
+  size_t idx = std::min(values->size() - 1,
+                        static_cast<size_t>(p * values->size()));
+  std::nth_element(values->begin(), values->begin() + idx, values->end());
+  return (*values)[idx];
+}
+
+void GetTableProto(TableParameter* table_proto) {
+  table_proto->set_table_id(0);
+  table_proto->set_table_class(FLAGS_ps_bench_table);
+  table_proto->set_shard_num(FLAGS_ps_bench_shard_num);
+  auto* accessor_config = table_proto->mutable_accessor();
+  accessor_config->set_accessor_class(FLAGS_ps_bench_accessor);
+  accessor_config->set_fea_dim(FLAGS_ps_bench_embedx_dim + 3);
+  accessor_config->set_embedx_dim(FLAGS_ps_bench_embedx_dim);
+  accessor_config->set_embedx_threshold(0);
+  auto* ctr_param = accessor_config->mutable_ctr_accessor_param();
+  ctr_param->set_nonclk_coeff(0.1);
+  ctr_param->set_click_coeff(1);
+  ctr_param->set_base_threshold(0.5);
+  ctr_param->set_delta_threshold(0.2);
+  ctr_param->set_delta_keep_days(16);
+  ctr_param->set_show_click_decay_rate(0.98);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseAdaGradSGDRule");
+    auto* adagrad_param = sgd_param->mutable_adagrad();
+    adagrad_param->set_learning_rate(0.05);
+    adagrad_param->set_initial_g2sum(3.0);
+    adagrad_param->set_initial_range(0.0001);
+    adagrad_param->add_weight_bounds(-10.0);
+    adagrad_param->add_weight_bounds(10.0);
+  }
+}
+
+PSParameter GetPsProto(bool is_worker) {
+  PSParameter ps_proto;
+  auto* server_proto = ps_proto.mutable_server_param();
+  auto* downpour_server_proto = server_proto->mutable_downpour_server_param();
+  auto* service_proto = downpour_server_proto->mutable_service_param();
+  service_proto->set_service_class("BrpcPsService");
+  service_proto->set_server_class("BrpcPsServer");
+  service_proto->set_client_class("BrpcPsClient");
+  service_proto->set_start_server_port(0);
+  service_proto->set_server_thread_num(12);
+  GetTableProto(downpour_server_proto->add_downpour_table_param());
+  if (is_worker) {
+    GetTableProto(ps_proto.mutable_worker_param()
+                      ->mutable_downpour_worker_param()
+                      ->add_downpour_table_param());
+  }
+  return ps_proto;
+}
+
+// Pulls and pushes a batch of keys, the values of the keys are laid out
+// contiguously with the select dim and the update dim of the accessor.
+class PsDriver {
+ public:
+  virtual ~PsDriver() {}
+  virtual void Pull(const std::vector<uint64_t>& keys, float* values) = 0;
+  virtual void Push(const std::vector<uint64_t>& keys,
+                    const float* values) = 0;
+  virtual int64_t KeyNum() = 0;
+
+  AccessorInfo info;
+};
+
+// Calls Pull and Push of the tables directly, where the keys are split over
+// the tables like BrpcPsClient splits them over the servers.
+class TableDriver : public PsDriver {
+ public:
+  TableDriver() {
+    TableParameter table_proto;
+    GetTableProto(&table_proto);
+    FsClientParameter fs_config;
+    for (int i = 0; i < FLAGS_ps_bench_servers; ++i) {
+      tables_.emplace_back(CREATE_PSCORE_CLASS(Table, FLAGS_ps_bench_table));
+      PADDLE_ENFORCE_NOT_NULL(
+          tables_.back(),
+          common::errors::NotFound("Table %s is not registered.",
+                                   FLAGS_ps_bench_table));
+      tables_.back()->SetShard(i, FLAGS_ps_bench_servers);
+      PADDLE_ENFORCE_EQ(
+          tables_.back()->Initialize(table_proto, fs_config),
+          0,
+          common::errors::External("Failed to initialize table %s.",
+                                   FLAGS_ps_bench_table));
+    }
+    info = tables_[0]->GetValueAccessor()->GetAccessorInfo();
+  }
+
+  void Pull(const std::vector<uint64_t>& keys, float* values) override {
+    thread_local std::vector<std::vector<uint64_t>> shard_keys;
+    Split(keys, &shard_keys);
+    for (size_t i = 0; i < tables_.size(); ++i) {
+      std::vector<uint32_t> fres(shard_keys[i].size(), 1);
+      TableContext context;
+      context.value_type = Sparse;
+      context.pull_context.pull_value =
+          PullSparseValue(shard_keys[i], fres, info.select_dim);
+      context.pull_context.values = values;
+      tables_[i]->Pull(context);
+      values += shard_keys[i].size() * info.select_dim;
+    }
+  }
+
+  void Push(const std::vector<uint64_t>& keys, const float* values) override {
+    thread_local std::vector<std::vector<uint64_t>> shard_keys;
+    Split(keys, &shard_keys);
+    for (size_t i = 0; i < tables_.size(); ++i) {
+      TableContext context;
+      context.value_type = Sparse;
+      context.push_context.keys = shard_keys[i].data();
+      context.push_context.values = values;
+      context.num = shard_keys[i].size();
+      tables_[i]->Push(context);
+      values += shard_keys[i].size() * info.update_dim;
+    }
+  }
+
+  int64_t KeyNum() override {
+    int64_t num = 0;
+    for (auto& table : tables_) {
+      num += table->PrintTableStat().first;
+    }
+    return num;
+  }
+
+ private:
+  void Split(const std::vector<uint64_t>& keys,
+             std::vector<std::vector<uint64_t>>* shard_keys) {
+    shard_keys->resize(tables_.size());
+    for (auto& shard : *shard_keys) {
+      shard.clear();
+    }
+    for (auto key : keys) {
+      (*shard_keys)[MemorySparseTable::get_sparse_shard(
+                        FLAGS_ps_bench_shard_num, tables_.size(), key)]
+          .push_back(key);
+    }
+  }
+
+  std::vector<std::unique_ptr<Table>> tables_;
+};
+
+// Starts the servers on the loopback in the threads of this process and
+// drives them through one BrpcPsClient shared by the client threads.
+class BrpcDriver : public PsDriver {
+ public:
+  BrpcDriver() {
+    setenv("http_proxy", "", 1);
+    setenv("https_proxy", "", 1);
+    for (int i = 0; i < FLAGS_ps_bench_servers; ++i) {
+      host_sign_list_.push_back(
+          PSHost("127.0.0.1", FLAGS_ps_bench_port + i, i).SerializeToString());
+    }
+    for (int i = 0; i < FLAGS_ps_bench_servers; ++i) {
+      servers_.emplace_back(PSServerFactory::Create(GetPsProto(false)));
+    }
+    for (int i = 0; i < FLAGS_ps_bench_servers; ++i) {
+      server_threads_.emplace_back([this, i] {
+        PaddlePSEnvironment env;
+        env.SetPsServers(&host_sign_list_, host_sign_list_.size());
+        std::vector<framework::ProgramDesc> programs(1);
+        servers_[i]->Configure(GetPsProto(false), env, i, programs);
+        servers_[i]->Start("127.0.0.1", FLAGS_ps_bench_port + i);
+      });
+    }
+    sleep(1);
+
+    client_env_.SetPsServers(&host_sign_list_, host_sign_list_.size());
+    std::map<uint64_t, std::vector<Region>> dense_regions;
+    client_.reset(PSClientFactory::Create(GetPsProto(true)));
+    client_->Configure(GetPsProto(true), dense_regions, client_env_, 0);
+    info = client_->GetTableAccessor(0)->GetAccessorInfo();
+  }
+
+  ~BrpcDriver() override {
+    client_->StopServer().wait();
+    client_->FinalizeWorker();
+    for (auto& thread : server_threads_) {
+      thread.join();
+    }
+  }
+
+  void Pull(const std::vector<uint64_t>& keys, float* values) override {
+    thread_local std::vector<float*> value_ptrs;
+    value_ptrs.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      value_ptrs[i] = values + i * info.select_dim;
+    }
+    client_->PullSparse(value_ptrs.data(), 0, keys.data(), keys.size(), true)
+        .wait();
+  }
+
+  void Push(const std::vector<uint64_t>& keys, const float* values) override {
+    thread_local std::vector<const float*> value_ptrs;
+    value_ptrs.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      value_ptrs[i] = values + i * info.update_dim;
+    }
+    size_t server_num = servers_.size();
+    auto* closure =
+        new DownpourBrpcClosure(server_num, [server_num](void* done) {
+          auto* closure = reinterpret_cast<DownpourBrpcClosure*>(done);
+          int ret = 0;
+          for (size_t i = 0; i < server_num; ++i) {
+            if (closure->check_response(i, PS_PUSH_SPARSE_TABLE) != 0) {
+              ret = -1;
+              break;
+            }
+          }
+          closure->set_promise_value(ret);
+        });
+    client_
+        ->PushSparseRawGradient(
+            0, keys.data(), value_ptrs.data(), keys.size(), closure)
+        .wait();
+  }
+
+  int64_t KeyNum() override {
+    int64_t num = 0;
+    for (auto& server : servers_) {
+      num += server->GetTable(0)->PrintTableStat().first;
+    }
+    return num;
+  }
+
+ private:
+  std::vector<std::string> host_sign_list_;
+  std::vector<std::unique_ptr<PSServer>> servers_;
+  std::vector<std::thread> server_threads_;
+  PaddlePSEnvironment client_env_;
+  std::unique_ptr<PSClient> client_;
+};
+
+}  // namespace
+
+TEST(PsBenchmark, Run) {
+  int64_t rss_before_kb = ResidentMemoryKB();
+  std::unique_ptr<PsDriver> driver;
+  if (FLAGS_ps_bench_mode == "brpc") {
+    driver = std::make_unique<BrpcDriver>();
+  } else {
+    PADDLE_ENFORCE_EQ(FLAGS_ps_bench_mode == "table",
+                      true,
+                      common::errors::InvalidArgument(
+                          "Unsupported ps_bench_mode %s, expected table or "
+                          "brpc.",
+                          FLAGS_ps_bench_mode));
+    driver = std::make_unique<TableDriver>();
+  }
+  const AccessorInfo info = driver->info;
+  const int threads = FLAGS_ps_bench_threads;
+  const int requests = FLAGS_ps_bench_requests;
+  const size_t batch_size = FLAGS_ps_bench_batch_size;
+
+  // The keys and the kinds of the requests are drawn before the timing.
+  std::vector<std::vector<std::vector<uint64_t>>> batches(threads);
+  std::vector<std::vector<bool>> is_push(threads);
+  for (int t = 0; t < threads; ++t) {
+    std::mt19937_64 engine(t);
+    ZipfSampler zipf(FLAGS_ps_bench_key_space, FLAGS_ps_bench_zipf);
+    std::uniform_int_distribution<uint64_t> uniform(
+        0, FLAGS_ps_bench_key_space - 1);
+    std::bernoulli_distribution push(FLAGS_ps_bench_push_ratio);
+    batches[t].resize(requests);
+    for (int r = 0; r < requests; ++r) {
+      auto& keys = batches[t][r];
+      keys.resize(batch_size);
+      for (auto& key : keys) {
+        key = RankToKey(FLAGS_ps_bench_zipf > 0 ? zipf(&engine)
+                                                : uniform(engine));
+      }
+      is_push[t].push_back(push(engine));
+    }
+  }
+
+  std::vector<std::vector<double>> pull_us(threads);
+  std::vector<std::vector<double>> push_us(threads);
+  double cpu_before = CpuSeconds();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::vector<float> pull_values(batch_size * info.select_dim);
+      std::vector<float> push_values(batch_size * info.update_dim, 0.01f);
+      for (size_t i = 0; i < batch_size; ++i) {
+        // slot, show and click lead the push values of the ctr accessors.
+        push_values[i * info.update_dim] = 1;
+        push_values[i * info.update_dim + 1] = 1;
+        push_values[i * info.update_dim + 2] = i % 10 == 0 ? 1 : 0;
+      }
+      for (int r = 0; r < requests; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        if (is_push[t][r]) {
+          driver->Push(batches[t][r], push_values.data());
+        } else {
+          driver->Pull(batches[t][r], pull_values.data());
+        }
+        double us = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - begin)
+                        .count();
+        (is_push[t][r] ? push_us[t] : pull_us[t]).push_back(us);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  double cpu_seconds = CpuSeconds() - cpu_before;
+
+  std::vector<double> all_pull_us;
+  std::vector<double> all_push_us;
+  for (int t = 0; t < threads; ++t) {
+    all_pull_us.insert(all_pull_us.end(), pull_us[t].begin(), pull_us[t].end());
+    all_push_us.insert(all_push_us.end(), push_us[t].begin(), push_us[t].end());
+  }
+  int64_t total_requests = static_cast<int64_t>(threads) * requests;
+  int64_t key_num = driver->KeyNum();
+  int64_t rss_kb = ResidentMemoryKB() - rss_before_kb;
+
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(2) << "{\"mode\": \""
+     << FLAGS_ps_bench_mode << "\", \"table\": \"" << FLAGS_ps_bench_table
+     << "\", \"accessor\": \"" << FLAGS_ps_bench_accessor
+     << "\", \"threads\": " << threads
+     << ", \"servers\": " << FLAGS_ps_bench_servers
+     << ", \"zipf\": " << FLAGS_ps_bench_zipf
+     << ", \"qps\": " << total_requests / seconds
+     << ", \"keys_per_second\": " << total_requests * batch_size / seconds;
+  for (auto* kind : {"pull", "push"}) {
+    auto* us = std::string(kind) == "pull" ? &all_pull_us : &all_push_us;
+    for (const auto& p : std::vector<std::pair<std::string, double>>{
+             {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}}) {
+      os << ", \"" << kind << "_" << p.first
+         << "_us\": " << Percentile(us, p.second);
+    }
+  }
+  os << ", \"keys\": " << key_num << ", \"bytes_per_key\": "
+     << (key_num > 0 ? rss_kb * 1024.0 / key_num : 0)
+     << ", \"cpu_us_per_request\": " << cpu_seconds * 1e6 / total_requests
+     << "}";
+  LOG(INFO) << os.str();
+
+  EXPECT_GT(key_num, 0);
+  EXPECT_EQ(all_pull_us.size() + all_push_us.size(),
+            static_cast<size_t>(total_requests));
+}
+
+}  // namespace distributed
+}  // namespace paddle
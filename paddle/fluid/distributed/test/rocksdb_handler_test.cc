@@ -0,0 +1,121 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+void PutKeys(RocksDBHandler* db, int shard, uint64_t begin, uint64_t end) {
+  for (uint64_t key = begin; key < end; ++key) {
+    float value = static_cast<float>(key);
+    db->put(shard,
+            reinterpret_cast<const char*>(&key),
+            sizeof(uint64_t),
+            reinterpret_cast<const char*>(&value),
+            sizeof(float));
+  }
+}
+
+}  // namespace
+
+TEST(RocksDBHandler, ShardsAreColumnFamilies) {
+  RocksDBHandler db;
+  db.initialize("./rocksdb_handler_test_db", 2);
+  PutKeys(&db, 0, 0, 100);
+  PutKeys(&db, 1, 100, 150);
+
+  std::string value;
+  uint64_t key = 7;
+  ASSERT_EQ(
+      db.get(0, reinterpret_cast<const char*>(&key), sizeof(key), value), 0);
+  ASSERT_EQ(*reinterpret_cast<const float*>(value.data()), 7.0f);
+  // the shards do not see the keys of each other
+  ASSERT_EQ(
+      db.get(1, reinterpret_cast<const char*>(&key), sizeof(key), value), 1);
+
+  db.del_data(0, reinterpret_cast<const char*>(&key), sizeof(key));
+  ASSERT_EQ(
+      db.get(0, reinterpret_cast<const char*>(&key), sizeof(key), value), 1);
+
+  // a scan goes across all the prefixes, in the order of the keys
+  db.flush(0);
+  auto* it = db.get_iterator(0);
+  int count = 0;
+  uint64_t last = 0;
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    uint64_t cur = *reinterpret_cast<const uint64_t*>(it->key().data());
+    if (count > 0) {
+      ASSERT_GT(cur, last);
+    }
+    last = cur;
+    ++count;
+  }
+  delete it;
+  ASSERT_EQ(count, 99);
+
+  std::vector<uint64_t> keys = {120, 3, 149};
+  std::vector<rocksdb::Slice> slices;
+  for (auto& k : keys) {
+    slices.emplace_back(reinterpret_cast<const char*>(&k), sizeof(uint64_t));
+  }
+  std::vector<rocksdb::PinnableSlice> values(keys.size());
+  std::vector<rocksdb::Status> status(keys.size());
+  db.multi_get(
+      1, keys.size(), slices.data(), values.data(), status.data(), false);
+  ASSERT_TRUE(status[0].ok());
+  ASSERT_TRUE(status[1].IsNotFound());
+  ASSERT_TRUE(status[2].ok());
+  ASSERT_EQ(*reinterpret_cast<const float*>(values[2].data()), 149.0f);
+}
+
+TEST(RocksDBHandler, CompactionRateFollowsPulls) {
+  RocksDBOptions options;
+  options.compaction_max_mb_per_sec = 64;
+  options.compaction_min_mb_per_sec = 8;
+  options.pull_peak_keys_per_sec = 1;
+  options.rate_window_ms = 0;
+  RocksDBHandler db;
+  db.initialize("./rocksdb_handler_rate_test_db", 1, options);
+  ASSERT_EQ(db.compaction_rate(), 64 * 1024 * 1024);
+  PutKeys(&db, 0, 0, 10);
+
+  // far above the peak, the compactions get their min rate
+  std::vector<uint64_t> keys(64);
+  std::vector<rocksdb::Slice> slices;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = i;
+    slices.emplace_back(reinterpret_cast<const char*>(&keys[i]),
+                        sizeof(uint64_t));
+  }
+  std::vector<rocksdb::PinnableSlice> values(keys.size());
+  std::vector<rocksdb::Status> status(keys.size());
+  db.multi_get(0, keys.size(), slices.data(), values.data(), status.data());
+  ASSERT_EQ(db.compaction_rate(), 8 * 1024 * 1024);
+
+  // a manual compaction runs at the max rate
+  ASSERT_EQ(db.manual_compaction(false), 0);
+  ASSERT_EQ(db.compaction_rate(), 64 * 1024 * 1024);
+  uint64_t num_keys = 0;
+  db.get_estimate_key_num(num_keys);
+  ASSERT_EQ(num_keys, 10U);
+}
+
+}  // namespace paddle::distributed
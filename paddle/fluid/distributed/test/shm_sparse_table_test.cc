@@ -0,0 +1,179 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/shm_sparse_table.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+PD_DECLARE_string(pserver_shm_sparse_table_name);
+PD_DECLARE_int64(pserver_shm_sparse_table_capacity);
+
+namespace paddle {
+namespace distributed {
+
+const int kEmbDim = 8;
+
+// the owner is created first, the others, also in the forked trainers, open
+// its segment by the name
+Table *CreateShmTable(Table *table, bool is_owner) {
+  if (is_owner) {
+    FLAGS_pserver_shm_sparse_table_name =
+        "shm_sparse_table_test_" + std::to_string(getpid());
+  }
+  FLAGS_pserver_shm_sparse_table_capacity = 1 << 12;
+  TableParameter table_config;
+  table_config.set_table_class("ShmSparseTable");
+  table_config.set_shard_num(10);
+  table_config.set_compress_in_save(false);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+  auto *shm_table = dynamic_cast<ShmSparseTable *>(table);
+  if (shm_table != nullptr) {
+    shm_table->SetOwner(is_owner);
+  }
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kEmbDim + 3);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(5);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+int32_t PushShmTable(Table *table, std::vector<uint64_t> keys, float grad) {
+  // slot, show, click, embed_g and embedx_g
+  std::vector<float> push_values(keys.size() * (kEmbDim + 4), grad);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    push_values[i * (kEmbDim + 4) + 1] = 1.0;
+  }
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.push_context.keys = keys.data();
+  table_context.push_context.values = push_values.data();
+  table_context.num = keys.size();
+  return table->Push(table_context);
+}
+
+std::vector<float> PullShmTable(Table *table, std::vector<uint64_t> keys) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  std::vector<float> pull_values(keys.size() * (kEmbDim + 3));
+  auto value = PullSparseValue(keys, fres, kEmbDim + 3);
+  TableContext table_context;
+  table_context.value_type = Sparse;
+  table_context.pull_context.pull_value = value;
+  table_context.pull_context.values = pull_values.data();
+  EXPECT_EQ(table->Pull(table_context), 0);
+  return pull_values;
+}
+
+// the checkpoints keep 6 significant digits
+void ExpectValuesNear(const std::vector<float> &a,
+                      const std::vector<float> &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    ASSERT_NEAR(a[i], b[i], 1e-5 * std::max(1.0f, std::abs(b[i])));
+  }
+}
+
+TEST(ShmSparseTable, Share) {
+  std::unique_ptr<Table> owner(CreateShmTable(new ShmSparseTable(), true));
+  std::unique_ptr<Table> other(CreateShmTable(new ShmSparseTable(), false));
+  std::vector<uint64_t> keys = {0, 1, 2, 13, 27, 1000001};
+
+  ASSERT_EQ(PushShmTable(other.get(), keys, 0.5), 0);
+  ASSERT_EQ(PushShmTable(owner.get(), keys, 0.5), 0);
+  auto owner_values = PullShmTable(owner.get(), keys);
+  auto other_values = PullShmTable(other.get(), keys);
+  ASSERT_EQ(owner_values, other_values);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    // the shows of the two pushes
+    ASSERT_FLOAT_EQ(owner_values[i * (kEmbDim + 3)], 2.0);
+  }
+  ASSERT_EQ(owner->PrintTableStat().first, static_cast<int64_t>(keys.size()));
+
+  // a trainer process opens the segment of the owner
+  pid_t pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    std::unique_ptr<Table> child(CreateShmTable(new ShmSparseTable(), false));
+    int ret = PushShmTable(child.get(), keys, 0.5);
+    _exit(ret == 0 ? 0 : 1);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  owner_values = PullShmTable(other.get(), keys);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_FLOAT_EQ(owner_values[i * (kEmbDim + 3)], 3.0);
+  }
+
+  // only the owner shrinks and clears the table
+  other->Clear();
+  ASSERT_EQ(owner->PrintTableStat().first, static_cast<int64_t>(keys.size()));
+  owner->Clear();
+  ASSERT_EQ(other->PrintTableStat().first, 0);
+}
+
+TEST(ShmSparseTable, SaveLoad) {
+  std::unique_ptr<Table> owner(CreateShmTable(new ShmSparseTable(), true));
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 500; ++key) {
+    keys.push_back(key * 7);
+  }
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(PushShmTable(owner.get(), keys, 0.1), 0);
+  }
+  auto shm_values = PullShmTable(owner.get(), keys);
+
+  std::string path = "/tmp/shm_sparse_table_test_" + std::to_string(getpid());
+  ASSERT_EQ(owner->Save(path, "0"), 0);
+
+  // the checkpoint of the shm table is the one of MemorySparseTable
+  std::unique_ptr<Table> memory(CreateShmTable(new MemorySparseTable(), true));
+  ASSERT_EQ(memory->Load(path, "0"), 0);
+  ExpectValuesNear(PullShmTable(memory.get(), keys), shm_values);
+
+  owner->Clear();
+  ASSERT_EQ(owner->Load(path, "0"), 0);
+  ExpectValuesNear(PullShmTable(owner.get(), keys), shm_values);
+  ASSERT_EQ(owner->PrintTableStat(), memory->PrintTableStat());
+  ASSERT_EQ(system(("rm -rf " + path).c_str()), 0);
+}
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,107 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_pull_cache.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TEST(SparsePullCache, Staleness) {
+  SparsePullCache cache(1024, 3, 4);
+  std::vector<float> value = {1, 2, 3, 4};
+  std::vector<float> pulled(4, 0);
+
+  uint64_t step = cache.NextStep();
+  ASSERT_FALSE(cache.Lookup(1, step, pulled.data()));
+  cache.Insert(1, step, value.data());
+  // served in the next max_staleness - 1 pulls
+  for (int i = 0; i < 2; ++i) {
+    step = cache.NextStep();
+    ASSERT_TRUE(cache.Lookup(1, step, pulled.data()));
+    ASSERT_EQ(pulled, value);
+  }
+  step = cache.NextStep();
+  ASSERT_FALSE(cache.Lookup(1, step, pulled.data()));
+
+  // refreshed by the pull, and a pull of an earlier step is dropped
+  value = {5, 6, 7, 8};
+  cache.Insert(1, step, value.data());
+  std::vector<float> old_value = {0, 0, 0, 0};
+  cache.Insert(1, step - 1, old_value.data());
+  ASSERT_TRUE(cache.Lookup(1, step, pulled.data()));
+  ASSERT_EQ(pulled, value);
+
+  ASSERT_EQ(cache.hits(), 3U);
+  ASSERT_EQ(cache.misses(), 2U);
+  ASSERT_DOUBLE_EQ(cache.HitRatio(), 0.6);
+
+  cache.Clear();
+  ASSERT_EQ(cache.Size(), 0U);
+  ASSERT_FALSE(cache.Lookup(1, step, pulled.data()));
+}
+
+TEST(SparsePullCache, Admission) {
+  // a slot per shard
+  SparsePullCache cache(0, 1000, 1);
+  float value = 1;
+  float pulled = 0;
+  uint64_t hot_key = 1;
+  for (int i = 0; i < 10; ++i) {
+    cache.Lookup(hot_key, cache.NextStep(), &pulled);
+  }
+  cache.Insert(hot_key, cache.NextStep(), &value);
+  ASSERT_EQ(cache.Size(), 1U);
+
+  // the keys of the shard of hot_key pulled once do not replace it
+  for (uint64_t key = 2; key < 1000; ++key) {
+    uint64_t step = cache.NextStep();
+    if (!cache.Lookup(key, step, &pulled)) {
+      cache.Insert(key, step, &value);
+    }
+  }
+  ASSERT_GT(cache.rejected(), 0U);
+  ASSERT_TRUE(cache.Lookup(hot_key, cache.NextStep(), &pulled));
+  ASSERT_LE(cache.Size(), 16U);
+}
+
+TEST(SparsePullCache, MultiThread) {
+  SparsePullCache cache(256, 10, 2);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache, t] {
+      for (int i = 0; i < 10000; ++i) {
+        uint64_t key = (i * 7 + t) % 512;
+        float value[2] = {static_cast<float>(key), static_cast<float>(key)};
+        float pulled[2];
+        uint64_t step = cache.NextStep();
+        if (cache.Lookup(key, step, pulled)) {
+          ASSERT_EQ(pulled[0], static_cast<float>(key));
+        } else {
+          cache.Insert(key, step, value);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(cache.hits() + cache.misses(), 40000U);
+  ASSERT_LE(cache.Size(), 256U + 16U);
+}
+
+}  // namespace paddle::distributed
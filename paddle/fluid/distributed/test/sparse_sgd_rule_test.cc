@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <cmath>
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -205,5 +206,76 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+
+// The batched update of the rules is vectorized over the embedding, which
+// reorders the float operations, so it only matches the per key one closely.
+template <class Rule>
+void CheckUpdateValues(const SparseCommonSGDRuleParameter& param) {
+  const size_t embed_dim = 35;  // whole blocks of avx or avx512 and a rest
+  const size_t key_num = 5;
+  Rule rule;
+  rule.LoadConfig(param, embed_dim);
+  const size_t value_dim = embed_dim + rule.Dim();
+
+  std::vector<float> expected(key_num * value_dim);
+  std::vector<float> grads(key_num * embed_dim);
+  std::vector<float> scales(key_num);
+  for (size_t k = 0; k < key_num; ++k) {
+    rule.InitValue(&expected[k * value_dim],
+                   &expected[k * value_dim + embed_dim],
+                   false);
+    for (size_t i = 0; i < embed_dim; ++i) {
+      grads[k * embed_dim + i] = std::sin(k * embed_dim + i);
+    }
+    scales[k] = k + 1;
+  }
+  std::vector<float> values(expected);
+
+  std::vector<float*> w(key_num);
+  std::vector<float*> sgd(key_num);
+  std::vector<const float*> push_values(key_num);
+  for (int step = 0; step < 3; ++step) {
+    for (size_t k = 0; k < key_num; ++k) {
+      float* value = &expected[k * value_dim];
+      rule.UpdateValue(
+          value, value + embed_dim, &grads[k * embed_dim], scales[k]);
+      w[k] = &values[k * value_dim];
+      sgd[k] = w[k] + embed_dim;
+      push_values[k] = &grads[k * embed_dim];
+    }
+    rule.UpdateValues(
+        w.data(), sgd.data(), push_values.data(), scales.data(), key_num);
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_NEAR(values[i], expected[i], 1e-5 * (1 + std::abs(expected[i])))
+        << "at " << i;
+  }
+}
+
+TEST(sparse_sgd_rule_test, update_values) {
+  SparseCommonSGDRuleParameter adagrad;
+  auto* adagrad_param = adagrad.mutable_adagrad();
+  adagrad_param->set_learning_rate(0.1);
+  adagrad_param->set_initial_g2sum(3.0);
+  adagrad_param->set_initial_range(0.3);
+  adagrad_param->add_weight_bounds(-0.2);
+  adagrad_param->add_weight_bounds(0.2);
+  CheckUpdateValues<SparseAdaGradSGDRule>(adagrad);
+  CheckUpdateValues<StdAdaGradSGDRule>(adagrad);
+  CheckUpdateValues<SparseAdaGradV2SGDRule>(adagrad);
+
+  SparseCommonSGDRuleParameter adam;
+  auto* adam_param = adam.mutable_adam();
+  adam_param->set_learning_rate(0.1);
+  adam_param->set_initial_range(0.3);
+  adam_param->set_beta1_decay_rate(0.9);
+  adam_param->set_beta2_decay_rate(0.999);
+  adam_param->set_ada_epsilon(1e-08);
+  adam_param->add_weight_bounds(-0.2);
+  adam_param->add_weight_bounds(0.2);
+  CheckUpdateValues<SparseAdamSGDRule>(adam);
+  CheckUpdateValues<SparseSharedAdamSGDRule>(adam);
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,104 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/sparse_shard_route.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+std::vector<uint64_t> ServerLoads(
+    const std::vector<std::vector<SparseShardLoad>>& server_loads,
+    const std::vector<SparseShardSwap>& swaps) {
+  std::vector<uint64_t> shard_loads;
+  SparseShardRoute route(8, 2);
+  for (auto& loads : server_loads) {
+    for (auto& load : loads) {
+      if (shard_loads.size() <= load.shard_id) {
+        shard_loads.resize(load.shard_id + 1);
+      }
+      shard_loads[load.shard_id] = load.access_num;
+    }
+  }
+  for (auto& swap : swaps) {
+    route.Swap(swap);
+  }
+  std::vector<uint64_t> totals(server_loads.size(), 0);
+  for (size_t i = 0; i < shard_loads.size(); ++i) {
+    totals[route.Owner(i)] += shard_loads[i];
+  }
+  return totals;
+}
+
+TEST(SparseShardRoute, Route) {
+  // the layout of get_sparse_shard, 4 shards on the first 2 servers and the
+  // other 2 on the last one
+  SparseShardRoute route(10, 3);
+  EXPECT_EQ(route.ShardNum(), 10UL);
+  EXPECT_EQ(route.Owner(3), 0U);
+  EXPECT_EQ(route.Owner(4), 1U);
+  EXPECT_EQ(route.Owner(9), 2U);
+  EXPECT_EQ(route.Server(13), 0U);
+  EXPECT_EQ(route.Version(), 0UL);
+
+  route.Swap({0, 3, 2, 9});
+  EXPECT_EQ(route.Owner(3), 2U);
+  EXPECT_EQ(route.Owner(9), 0U);
+  EXPECT_EQ(route.Server(13), 2U);
+  EXPECT_EQ(route.Version(), 1UL);
+
+  SparseShardRoute restored;
+  std::string data = route.Serialize();
+  ASSERT_TRUE(restored.Deserialize(data));
+  EXPECT_EQ(restored.Version(), 1UL);
+  for (uint32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(restored.Owner(i), route.Owner(i));
+  }
+  EXPECT_FALSE(restored.Deserialize(data.substr(0, data.size() - 1)));
+  EXPECT_FALSE(restored.Deserialize(""));
+}
+
+TEST(SparseShardRoute, PlanSwaps) {
+  // the server 0 keeps the shards 0 to 3, and the server 1 the shards 4 to 7
+  std::vector<std::vector<SparseShardLoad>> server_loads = {
+      {{0, 100, 1}, {1, 90, 1}, {2, 10, 1}, {3, 10, 1}},
+      {{4, 10, 1}, {5, 10, 1}, {6, 5, 1}, {7, 5, 1}}};
+  auto swaps = PlanSparseShardSwaps(server_loads, 1.1, 10);
+  ASSERT_FALSE(swaps.empty());
+  for (auto& swap : swaps) {
+    EXPECT_EQ(swap.server_a, 0U);
+    EXPECT_EQ(swap.server_b, 1U);
+    EXPECT_LT(swap.shard_a, 4U);
+    EXPECT_GE(swap.shard_b, 4U);
+  }
+  // 210 against 30, and even after swapping the shards 0 and 4
+  ASSERT_EQ(swaps.size(), 1UL);
+  auto totals = ServerLoads(server_loads, swaps);
+  EXPECT_EQ(totals[0], 120UL);
+  EXPECT_EQ(totals[1], 120UL);
+
+  // a plan is limited by max_swaps, and nothing to do for a balanced table
+  EXPECT_EQ(PlanSparseShardSwaps(server_loads, 1.0, 0).size(), 0UL);
+  server_loads = {{{0, 10, 1}, {1, 10, 1}}, {{2, 10, 1}, {3, 11, 1}}};
+  EXPECT_EQ(PlanSparseShardSwaps(server_loads, 1.1, 10).size(), 0UL);
+  // nor for a single hot shard, which is busier than the mean load itself
+  server_loads = {{{0, 100, 1}, {1, 0, 1}}, {{2, 0, 1}, {3, 0, 1}}};
+  EXPECT_EQ(PlanSparseShardSwaps(server_loads, 1.1, 10).size(), 0UL);
+  EXPECT_EQ(PlanSparseShardSwaps({}, 1.1, 10).size(), 0UL);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,85 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/sparse_tiering_policy.h"
+
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+TEST(FrequencySketch, Estimate) {
+  FrequencySketch sketch(1024);
+  for (int i = 0; i < 10; ++i) {
+    sketch.Increment(1);
+  }
+  sketch.Increment(2);
+  ASSERT_GE(sketch.Estimate(1), 10U);
+  ASSERT_GE(sketch.Estimate(2), 1U);
+  ASSERT_LT(sketch.Estimate(2), sketch.Estimate(1));
+  // the counters saturate at 15
+  for (int i = 0; i < 100; ++i) {
+    sketch.Increment(1);
+  }
+  ASSERT_EQ(sketch.Estimate(1), 15U);
+}
+
+TEST(SparseTieringPolicy, AdmitAndDemote) {
+  SparseTieringPolicy::shard_type shard;
+  SparseTieringPolicy policy(1000);
+  for (uint64_t key = 0; key < 1000; ++key) {
+    shard[key].resize(1);
+    policy.RecordAccess(key);
+  }
+  // the hot keys are accessed again after the demotion of the first round
+  std::unordered_map<uint64_t, float> demoted;
+  auto demote = [&demoted](uint64_t key, FixedFeatureValue& value) {
+    demoted[key] = value.data()[0];
+  };
+  for (uint64_t key = 1000; key < 1200; ++key) {
+    shard[key].resize(1);
+  }
+  ASSERT_TRUE(policy.NeedDemote(shard.size()));
+  policy.Demote(&shard, demote);
+  ASSERT_EQ(shard.size(), 900UL);
+  ASSERT_EQ(demoted.size(), 300UL);
+  ASSERT_EQ(policy.stat().demoted, 300UL);
+  // the keys not accessed are demoted first, except those whose reference
+  // bits collide with the accessed keys
+  size_t cold_demoted = 0;
+  for (uint64_t key = 1000; key < 1200; ++key) {
+    cold_demoted += demoted.count(key);
+  }
+  ASSERT_GE(cold_demoted, 160UL);
+
+  // a key accessed once is not admitted into the full memory in place of a
+  // key accessed more often
+  for (uint64_t key = 0; key < 1000; ++key) {
+    policy.RecordAccess(key);
+  }
+  for (uint64_t key = 2000; key < 2100; ++key) {
+    shard[key].resize(1);
+    policy.RecordAccess(key);
+    policy.RecordAccess(key);
+  }
+  policy.RecordAccess(5000);
+  ASSERT_FALSE(policy.Admit(5000, &shard));
+  for (int i = 0; i < 10; ++i) {
+    policy.RecordAccess(6000);
+  }
+  ASSERT_TRUE(policy.Admit(6000, &shard));
+}
+
+}  // namespace paddle::distributed
@@ -48,12 +48,12 @@ static void CopyOrAddTensor(paddle::Tensor* tensor,
           if (t.is_custom_device()) {
             auto* dev_ctx =
                 phi::DeviceContextPool::Instance().Get(tensor->place());
-            auto kernel_result =
-                phi::KernelFactory::Instance().SelectKernelOrThrowError(
-                    "add",
-                    phi::KernelKey(phi::TransToPhiBackend(tensor->place()),
-                                   phi::DataLayout::ALL_LAYOUT,
-                                   tensor->dtype()));
+            static thread_local phi::KernelSelectionCache
+                kernel_selection_cache("add");
+            auto kernel_result = kernel_selection_cache.Select(
+                phi::KernelKey(phi::TransToPhiBackend(tensor->place()),
+                               phi::DataLayout::ALL_LAYOUT,
+                               tensor->dtype()));
             const auto& kernel = kernel_result.kernel;
             using kernel_signature = void (*)(const phi::DeviceContext&,
                                               const phi::DenseTensor&,
@@ -91,12 +91,12 @@ static void CopyOrAddTensor(paddle::Tensor* tensor,
           if (t.is_custom_device()) {
             auto* dev_ctx =
                 phi::DeviceContextPool::Instance().Get(tensor->place());
-            auto kernel_result =
-                phi::KernelFactory::Instance().SelectKernelOrThrowError(
-                    "add_coo_coo",
-                    phi::KernelKey(phi::TransToPhiBackend(tensor->place()),
-                                   phi::DataLayout::ALL_LAYOUT,
-                                   tensor->dtype()));
+            static thread_local phi::KernelSelectionCache
+                kernel_selection_cache("add_coo_coo");
+            auto kernel_result = kernel_selection_cache.Select(
+                phi::KernelKey(phi::TransToPhiBackend(tensor->place()),
+                               phi::DataLayout::ALL_LAYOUT,
+                               tensor->dtype()));
             const auto& kernel = kernel_result.kernel;
             using kernel_signature = void (*)(const phi::DeviceContext&,
                                               const phi::SparseCooTensor&,
@@ -179,7 +179,10 @@ GradNodeAccumulation::operator()(
     auto grad = weak_grad_.lock();
     if (grad_out.defined() &&
         (grad_out.is_dist_tensor() || grad_out.initialized())) {
-      CopyOrAddTensor(grad.get(), grad_out, is_fake_empty_);
+      // The fake empty grad is filled with zeros, adding to it keeps its
+      // memory.
+      CopyOrAddTensor(
+          grad.get(), grad_out, is_fake_empty_ && !accumulate_inplace_);
     }
     // else { do nothing since there is no valid value in grad out tensor }
     is_fake_empty_ = false;
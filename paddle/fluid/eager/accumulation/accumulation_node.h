@@ -67,9 +67,17 @@ class TEST_API GradNodeAccumulation : public GradNodeBase {
 
   void SetFakeEmpty(bool is_fake_empty) { is_fake_empty_ = is_fake_empty; }
 
+  // Keeps the memory of the grad: a grad zeroed by clear_gradients is added
+  // to instead of being replaced, e.g. when it is a view of the contiguous
+  // grad buffer of the EagerReducer.
+  void SetAccumulateInplace(bool accumulate_inplace) {
+    accumulate_inplace_ = accumulate_inplace;
+  }
+
  private:
   // TODO(Jiabin): remove this when we make our clear gradient really cleared;
   bool is_fake_empty_ = {false};
+  bool accumulate_inplace_ = {false};
   std::weak_ptr<paddle::Tensor> weak_grad_;
   std::vector<std::shared_ptr<VoidHook>> reduce_hooks_;
   std::function<paddle::Tensor(const paddle::Tensor&)> retain_grad_hook_;
@@ -76,6 +76,14 @@ paddle::Tensor conv2d_ad_func(const paddle::Tensor& input,
     auto op_name = phi::TransToFluidOpName("conv2d");
     auto transformer = egr::EagerLayoutAutotune<std::string>(
         op_name, tensors_vector, &data_format);
+    egr::EagerObserveConv2dLayoutCost(input,
+                                      filter,
+                                      strides,
+                                      paddings,
+                                      padding_algorithm,
+                                      dilations,
+                                      groups,
+                                      data_format);
     auto new_input = transformer->TransInTensor("input", input);
     bool need_tune = egr::Controller::Instance().UseLayoutAutoTune();
     egr::Controller::Instance().DisableLayoutAutoTune();
@@ -39,6 +39,7 @@ bool check_if_support_elementwise_mul_mem_opt(const std::string& device_type) {
 paddle::Tensor multiply_ad_func(const paddle::Tensor& x,
                                 const paddle::Tensor& y) {
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << "Running AD API: "
           << "multiply";
   // Dygraph Record Event
@@ -237,6 +238,7 @@ paddle::Tensor multiply_ad_func(const paddle::Tensor& x,
 paddle::Tensor& multiply__ad_func(paddle::Tensor& x,  // NOLINT
                                   const paddle::Tensor& y) {
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << "Running AD API: "
           << "multiply_";
   // Dygraph Record Event
@@ -409,6 +411,7 @@ namespace sparse {
 paddle::Tensor multiply_ad_func(const paddle::Tensor& x,
                                 const paddle::Tensor& y) {
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << "Running AD API: "
           << "multiply";
   // Dygraph Record Event
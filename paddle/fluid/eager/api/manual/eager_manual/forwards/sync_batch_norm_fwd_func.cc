@@ -43,6 +43,7 @@ sync_batch_norm__ad_func(const paddle::Tensor& x,
                          bool use_global_stats,
                          bool trainable_statistics) {
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << "Running AD API: "
           << "sync_batch_norm_";
   // Dygraph Record Event
@@ -385,6 +386,7 @@ sync_batch_norm__ad_func(const paddle::Tensor& x,
                          bool use_global_stats,
                          bool trainable_statistics) {
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << "Running AD API: "
           << "sync_batch_norm_";
   // Dygraph Record Event
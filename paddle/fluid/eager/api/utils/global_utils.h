@@ -141,6 +141,20 @@ class Controller {
   TEST_API void SetIsInBackward(bool is_in_backward);
   TEST_API bool GetIsInBackward() const;
 
+  // For the lazy mode, the hook runs the recorded segment, see LazyTracer
+  void SetLazyFlushHook(const std::function<void()>& hook) {
+    lazy_flush_hook_ = hook;
+  }
+  void SetHasLazySegment(bool has_lazy_segment) {
+    has_lazy_segment_ = has_lazy_segment;
+  }
+  bool HasLazySegment() const { return has_lazy_segment_; }
+  void FlushLazySegment() {
+    if (has_lazy_segment_) {
+      lazy_flush_hook_();
+    }
+  }
+
  private:
   Controller() = default;
   static Controller* controller_;
@@ -155,6 +169,8 @@ class Controller {
   std::vector<std::shared_ptr<VoidHook>> final_backward_hooks_;
   std::queue<GradNodeBase*> force_sequential_nodes_;
   bool is_in_backward_{false};
+  std::function<void()> lazy_flush_hook_;
+  bool has_lazy_segment_{false};
   DISABLE_COPY_AND_ASSIGN(Controller);
 };
 
@@ -64,6 +64,15 @@ black_ops_list = [
 ]
 
 
+# 4-D ops tuned by their data_format by layout autotune
+heavily_first_ops_list = [
+    "pool2d",
+    "depthwise_conv2d",
+    "conv2d_transpose",
+    "depthwise_conv2d_transpose",
+]
+
+
 # white ops list whose kernel can be deleted after performance analysis
 # original kernel and its derivative kernel can be deleted when composite_grad
 # kernel performs same to it.
@@ -200,13 +209,13 @@ def ParseArguments():
 # Code Gen Templates #
 ######################
 SET_PLAIN_TENSOR_WRAPPER_TEMPLATE = """  void SetTensorWrapper_{}(const paddle::Tensor& {}) {{
-    {} = egr::TensorWrapper({}, {});
+    {} = egr::TensorWrapper({}, {}, "{}");
   }}
 """
 
 SET_VECTOR_TENSOR_WRAPPER_TEMPLATE = """  void SetTensorWrapper_{}(const std::vector<paddle::Tensor>& {}) {{
     for(const auto& eager_tensor : {}) {{
-      {}.emplace_back(egr::TensorWrapper(eager_tensor, {}));
+      {}.emplace_back(egr::TensorWrapper(eager_tensor, {}, "{}"));
     }};
   }}
 """
@@ -321,6 +330,7 @@ paddle::small_vector<std::vector<paddle::Tensor>, egr::kSlotSmallVectorSize> {}:
 FORWARD_FUNCTION_TEMPLATE = """
 TEST_API {} {}({}) {{
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << \"Running AD API: \" << \"{}\";
 {}
   // Dygraph Record Event
@@ -398,6 +408,7 @@ STRIDED_FLAGS_CHECK_TEMPLATE = """
 FORWARD_ONLY_FUNCTION_TEMPLATE = """
 TEST_API {} {}({}) {{
   FLAGS_tensor_operants_mode = "eager";
+  egr::Controller::Instance().FlushLazySegment();
   VLOG(3) << \"Running AD API: \" << \"{}\";
 {}
   // Dygraph Record Event
@@ -1474,6 +1485,15 @@ class DygraphForwardFunctionGenerator(DygraphFunctionGeneratorBase):
                         layout_autotune_attr.append(name)
                         layout_autotune_attr_type_list.append(atype)
                         heavily_flag = True
+        # The spatial attrs of these 4-D ops like paddings follow their
+        # data_format, so they run in the tuned layout by the data_format
+        # instead of transposing back at the lightly sensitive attrs.
+        if forward_api_name in heavily_first_ops_list:
+            for name, atype, default_val, pos in forward_attrs_list:
+                if name in heavily_sensitive_attr:
+                    layout_autotune_attr = [name]
+                    layout_autotune_attr_type_list = [atype]
+                    break
         if len(layout_autotune_attr) == 0:
             layout_autotune_attr_code_list.append(
                 "auto transformer = egr::EagerLayoutAutotune(op_name, tensors_vector);\n"
@@ -2304,7 +2324,12 @@ class DygraphNodeGenerator(DygraphFunctionGeneratorBase):
             if IsPlainTensorType(ttype):
                 set_tensor_wrapper_methods_str += (
                     SET_PLAIN_TENSOR_WRAPPER_TEMPLATE.format(
-                        tname, tname, tensor_wrapper_name, tname, no_need_buffer
+                        tname,
+                        tname,
+                        tensor_wrapper_name,
+                        tname,
+                        no_need_buffer,
+                        forward_op_name,
                     )
                 )
 
@@ -2320,7 +2345,12 @@ class DygraphNodeGenerator(DygraphFunctionGeneratorBase):
                 assert IsVectorTensorType(ttype)
                 set_tensor_wrapper_methods_str += (
                     SET_VECTOR_TENSOR_WRAPPER_TEMPLATE.format(
-                        tname, tname, tname, tensor_wrapper_name, no_need_buffer
+                        tname,
+                        tname,
+                        tname,
+                        tensor_wrapper_name,
+                        no_need_buffer,
+                        forward_op_name,
                     )
                 )
 
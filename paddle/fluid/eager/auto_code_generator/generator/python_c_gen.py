@@ -111,6 +111,7 @@ RETURN_INPLACE_PYOBJECT_TEMPLATE = """
 PYTHON_C_FUNCTION_TEMPLATE = """
 PyObject * eager_api_{}(PyObject *self, PyObject *args, PyObject *kwargs) {{
   {}
+{}
   PyThreadState *tstate = nullptr;
   try {{
     VLOG(6) << "Running Eager Final State API: {}";
@@ -140,6 +141,15 @@ PyObject * eager_api_{}(PyObject *self, PyObject *args, PyObject *kwargs) {{
 }}
 """
 
+LAZY_OP_FUNCTION_TEMPLATE = """
+  if (InLazyMode()) {{
+    PyObject *lazy_outputs = nullptr;
+    if (RecordLazyOp("{}", self, args, kwargs, &lazy_outputs)) {{
+      return lazy_outputs;
+    }}
+  }}"""
+
+
 NOAMP_DYGRAPH_FUNCTION_TEMPLATE = "decltype({}({})) out = {}({});"
 
 
@@ -194,6 +204,7 @@ PYTHON_C_WRAPPER_TEMPLATE = """
 #include "paddle/fluid/pybind/eager_custom_python_api.h"
 #include "paddle/fluid/pybind/eager.h"
 #include "paddle/fluid/pybind/eager_op_function.h"
+#include "paddle/fluid/pybind/lazy_op_function.h"
 namespace paddle {{
 namespace pybind {{
 
@@ -514,9 +525,16 @@ class PythonCSingleFunctionGenerator(FunctionGeneratorBase):
         )
 
         # Generate Python-C Function Definition
+        # Only the dense ops are recorded in the lazy mode
+        lazy_op_function_str = (
+            LAZY_OP_FUNCTION_TEMPLATE.format(forward_api_name)
+            if self.namespace == ""
+            else ""
+        )
         self.python_c_function_str = PYTHON_C_FUNCTION_TEMPLATE.format(
             forward_api_name,
             pythonc_record_event_str,
+            lazy_op_function_str,
             forward_api_name,
             get_eager_tensor_str,
             parse_attributes_str,
@@ -574,6 +592,7 @@ class PythonCSingleFunctionGenerator(FunctionGeneratorBase):
             python_c_inplace_func_str = PYTHON_C_FUNCTION_TEMPLATE.format(
                 inplaced_forward_api_name,
                 pythonc_record_event_str,
+                "",
                 inplaced_forward_api_name,
                 get_eager_tensor_str,
                 parse_attributes_str,
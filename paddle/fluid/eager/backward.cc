@@ -15,6 +15,8 @@
 #include "paddle/fluid/eager/backward.h"
 
 #include "paddle/fluid/eager/general_grad.h"
+#include "paddle/fluid/eager/parallel_backward.h"
+#include "paddle/fluid/imperative/amp_auto_cast.h"
 #include "paddle/fluid/memory/stats.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
 
@@ -123,6 +125,10 @@ std::vector<paddle::Tensor> RunBackward(
   bool is_general_grad = !inputs.empty();
   if (is_general_grad) GeneralGrad::Instance().Clear();
 
+  // The optimizer updates the parameters after backward without bumping
+  // their inplace versions, so their casted copies are dropped here.
+  paddle::imperative::AmpCastCache::Instance().Clear();
+
   /* --- Initialization --- */
   // 1. Init queue with starting nodes
   // 2. Prepare initial input buffers
@@ -243,6 +249,19 @@ std::vector<paddle::Tensor> RunBackward(
 
   VLOG(5) << "Startup_ops's size is " << queue.size();
 
+  // The general grad prunes the graph while running it, and the nodes forced
+  // sequential are run one by one, both stay in the serial loop below.
+  if (UseParallelBackward() && !is_general_grad &&
+      force_sequential_nodes_set.empty()) {
+    RunBackwardInParallel(queue,
+                          &node_input_buffers_dict,
+                          &node_in_degree_map,
+                          retain_graph,
+                          create_graph,
+                          place);
+    queue.clear();
+  }
+
   /* --- Topological Visit --- */
   // 1. Pop queue
   // 2. Run node
@@ -24,8 +24,9 @@ inline bool NeedTransLayout(
                                kSlotSmallVectorSize>& tensors_vector,
     const phi::DataLayout& layout) {
   for (size_t i = 0; i < tensors_vector.size(); i++) {
-    for (size_t idx = 0; idx < tensors_vector[0].size(); idx++) {
-      if (layout != tensors_vector[i][idx].layout()) {
+    for (size_t idx = 0; idx < tensors_vector[i].size(); idx++) {
+      if (layout != tensors_vector[i][idx].layout() &&
+          !IsLayoutFreeTensor(tensors_vector[i][idx])) {
         return true;
       }
     }
@@ -33,19 +34,49 @@ inline bool NeedTransLayout(
   return false;
 }
 
+// The layout of the first input that is not layout free.
+inline phi::DataLayout FirstInputLayout(
+    const paddle::small_vector<std::vector<paddle::Tensor>,
+                               kSlotSmallVectorSize>& tensors_vector) {
+  for (const auto& tensors : tensors_vector) {
+    for (const auto& tensor : tensors) {
+      if (!IsLayoutFreeTensor(tensor)) {
+        return tensor.layout();
+      }
+    }
+  }
+  return tensors_vector[0][0].layout();
+}
+
+// The transformer of an op run before the layout is picked.
+inline std::shared_ptr<EagerLayoutTransformer> EagerUnstartedLayoutTransformer(
+    const std::string& op_name,
+    const paddle::small_vector<std::vector<paddle::Tensor>,
+                               kSlotSmallVectorSize>& tensors_vector,
+    const phi::DataLayout& layout,
+    EagerLayoutCostObserver::OpKind kind) {
+  if (paddle::imperative::LayoutAutoTune::Instance().IsObserving()) {
+    return std::make_shared<EagerLayoutCostObserver>(
+        op_name, tensors_vector, layout, kind);
+  }
+  return std::make_shared<EagerLayoutTransformer>(
+      op_name, tensors_vector, layout);
+}
+
 inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune(
     const std::string& op_name,
     const paddle::small_vector<std::vector<paddle::Tensor>,
                                kSlotSmallVectorSize>& tensors_vector) {
   // For agnostic op like add, relu, exp
-  auto first_layout = tensors_vector[0][0].layout();
+  auto first_layout = FirstInputLayout(tensors_vector);
   auto desired_layout = DesiredLayout();
   bool is_started = !(desired_layout == phi::DataLayout::UNDEFINED);
   if (is_started && NeedTransLayout(tensors_vector, first_layout)) {
     bool need_trans_back = false;
     for (size_t i = 0; i < tensors_vector.size(); i++) {
-      for (size_t idx = 0; idx < tensors_vector[0].size(); idx++) {
-        if (4 != tensors_vector[i][idx].shape().size()) {
+      for (size_t idx = 0; idx < tensors_vector[i].size(); idx++) {
+        if (4 != tensors_vector[i][idx].shape().size() &&
+            !IsLayoutFreeTensor(tensors_vector[i][idx])) {
           need_trans_back = true;
         }
       }
@@ -56,6 +87,13 @@ inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune(
     return std::make_shared<EagerLayoutTransformer>(
         op_name, tensors_vector, final_layout);
   }
+  if (!is_started) {
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        first_layout,
+        EagerLayoutCostObserver::OpKind::kAgnostic);
+  }
   return std::make_shared<EagerLayoutTransformer>(
       op_name, tensors_vector, first_layout);
 }
@@ -69,8 +107,11 @@ inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune(
   // For lightly op like reduce
   if ((DesiredLayout() == phi::DataLayout::UNDEFINED)) {
     VLOG(4) << "LayoutAutotune was unstarted. Current op :" << op_name;
-    return std::make_shared<EagerLayoutTransformer>(
-        op_name, tensors_vector, tensors_vector[0][0].layout());
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        tensors_vector[0][0].layout(),
+        EagerLayoutCostObserver::OpKind::kLightly);
   }
   return std::make_shared<EagerLightlyLayoutSensitiveOpTransformer>(op_name);
 }
@@ -95,8 +136,11 @@ inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune(
   // for pad
   if ((DesiredLayout() == phi::DataLayout::UNDEFINED)) {
     VLOG(4) << "LayoutAutotune was unstarted. Current op :" << op_name;
-    return std::make_shared<EagerLayoutTransformer>(
-        op_name, tensors_vector, tensors_vector[0][0].layout());
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        tensors_vector[0][0].layout(),
+        EagerLayoutCostObserver::OpKind::kLightly);
   }
   return std::make_shared<EagerLightlyLayoutSensitiveOpTransformer>(op_name);
 }
@@ -110,6 +154,26 @@ inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune(
   auto transposer = std::make_shared<EagerLayoutTransformer>(
       op_name, tensors_vector, tensors_vector[0][0].layout());
   if (DesiredLayout() == phi::DataLayout::UNDEFINED) {
+    auto& tuner = paddle::imperative::LayoutAutoTune::Instance();
+    const auto& in = tensors_vector[0][0];
+    if (op_name == "conv2d" && tuner.UseCostModel() && !tuner.IsObserving() &&
+        in.shape().size() == 4 && phi::is_gpu_place(in.place()) &&
+        (*attr == "NCHW" || *attr == "NHWC")) {
+      auto default_layout = common::StringToDataLayout(*attr);
+      tuner.StartObserving(default_layout,
+                           default_layout == phi::DataLayout::NCHW
+                               ? phi::DataLayout::NHWC
+                               : phi::DataLayout::NCHW);
+    }
+    if (tuner.IsObserving()) {
+      return std::make_shared<EagerLayoutCostObserver>(
+          op_name,
+          tensors_vector,
+          in.layout(),
+          tuner.IsHeavilyLayoutSensitive(op_name)
+              ? EagerLayoutCostObserver::OpKind::kHeavily
+              : EagerLayoutCostObserver::OpKind::kLightly);
+    }
     // Layout autotune only supports model with convolutional layers
     if (op_name != "conv2d") {
       VLOG(4) << "LayoutAutotune was unstarted. Current op :" << op_name;
@@ -161,8 +225,11 @@ inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune(
   // lightly  transpose
   if (DesiredLayout() == phi::DataLayout::UNDEFINED) {
     VLOG(4) << "LayoutAutotune was unstarted. Current op :" << op_name;
-    return std::make_shared<EagerLayoutTransformer>(
-        op_name, tensors_vector, tensors_vector[0][0].layout());
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        tensors_vector[0][0].layout(),
+        EagerLayoutCostObserver::OpKind::kLightly);
   }
 
   if ((op_name == "transpose2" || op_name == "trans_layout") &&
@@ -186,8 +253,11 @@ EagerLayoutAutotune<paddle::experimental::Scalar, bool>(
     bool* keep_dim) {
   if (DesiredLayout() == phi::DataLayout::UNDEFINED) {
     VLOG(4) << "LayoutAutotune was unstarted. Current op :" << op_name;
-    return std::make_shared<EagerLayoutTransformer>(
-        op_name, tensors_vector, tensors_vector[0][0].layout());
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        tensors_vector[0][0].layout(),
+        EagerLayoutCostObserver::OpKind::kLightly);
   }
 
   if (op_name == "argmax" &&
@@ -210,8 +280,11 @@ inline std::shared_ptr<EagerLayoutTransformer> EagerLayoutAutotune<int, int>(
     int* stop_axis) {
   if (DesiredLayout() == phi::DataLayout::UNDEFINED) {
     VLOG(4) << "Optimize Layout was not started" << op_name;
-    return std::make_shared<EagerLayoutTransformer>(
-        op_name, tensors_vector, tensors_vector[0][0].layout());
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        tensors_vector[0][0].layout(),
+        EagerLayoutCostObserver::OpKind::kLightly);
   }
 
   bool no_transpose = tensors_vector[0][0].layout() == DesiredLayout();
@@ -233,8 +306,11 @@ EagerLayoutAutotune<paddle::experimental::Scalar>(
     paddle::experimental::Scalar* axis) {
   if (DesiredLayout() == phi::DataLayout::UNDEFINED) {
     VLOG(4) << "Optimize Layout was not started" << op_name;
-    return std::make_shared<EagerLayoutTransformer>(
-        op_name, tensors_vector, tensors_vector[0][0].layout());
+    return EagerUnstartedLayoutTransformer(
+        op_name,
+        tensors_vector,
+        tensors_vector[0][0].layout(),
+        EagerLayoutCostObserver::OpKind::kLightly);
   }
 
   auto desired_layout = DesiredLayout();
@@ -253,4 +329,66 @@ EagerLayoutAutotune<paddle::experimental::Scalar>(
   return std::make_shared<EagerLightlyLayoutSensitiveOpTransformer>(op_name);
 }
 
+// Measures the conv2d in the default and the candidate layouts for the cost
+// based layout autotune, once per shape and attributes.
+inline void EagerObserveConv2dLayoutCost(const paddle::Tensor& input,
+                                         const paddle::Tensor& filter,
+                                         const std::vector<int>& strides,
+                                         const std::vector<int>& paddings,
+                                         const std::string& padding_algorithm,
+                                         const std::vector<int>& dilations,
+                                         int groups,
+                                         const std::string& data_format) {
+  auto& tuner = paddle::imperative::LayoutAutoTune::Instance();
+  if (!tuner.IsObserving() || input.shape().size() != 4) {
+    return;
+  }
+  auto candidate_layout = tuner.CandidateLayout();
+  auto candidate_format = common::DataLayoutToString(candidate_layout);
+  size_t key = phi::autotune::GenKey(std::string("conv2d"),
+                                     input.shape(),
+                                     filter.shape(),
+                                     strides,
+                                     paddings,
+                                     padding_algorithm,
+                                     dilations,
+                                     groups,
+                                     static_cast<int64_t>(input.dtype()));
+  size_t default_key = phi::autotune::GenKey(key, data_format);
+  size_t candidate_key = phi::autotune::GenKey(key, candidate_format);
+
+  float default_us = 0.f;
+  if (!tuner.FindKernelTime(default_key, &default_us)) {
+    default_us = tuner.MeasureKernelTime(default_key, input.place(), [&]() {
+      paddle::experimental::conv2d(input,
+                                   filter,
+                                   strides,
+                                   paddings,
+                                   padding_algorithm,
+                                   dilations,
+                                   groups,
+                                   data_format);
+    });
+  }
+  float candidate_us = 0.f;
+  if (!tuner.FindKernelTime(candidate_key, &candidate_us)) {
+    std::vector<int> perm = candidate_layout == phi::DataLayout::NHWC
+                                ? std::vector<int>{0, 2, 3, 1}
+                                : std::vector<int>{0, 3, 1, 2};
+    auto candidate_input = paddle::experimental::transpose(input, perm);
+    candidate_us =
+        tuner.MeasureKernelTime(candidate_key, input.place(), [&]() {
+          paddle::experimental::conv2d(candidate_input,
+                                       filter,
+                                       strides,
+                                       paddings,
+                                       padding_algorithm,
+                                       dilations,
+                                       groups,
+                                       candidate_format);
+        });
+  }
+  tuner.AddConvTime(default_us, candidate_us);
+}
+
 }  // namespace egr
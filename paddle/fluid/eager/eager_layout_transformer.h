@@ -18,6 +18,7 @@
 #include "paddle/fluid/imperative/layout_autotune.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/autotune/cache_base.h"
 namespace egr {
 inline paddle::Tensor EagerTraceTransposeOp(const phi::DataLayout layout,
                                             const paddle::Tensor& in) {
@@ -39,6 +40,31 @@ inline paddle::Tensor EagerTraceTransposeOp(const phi::DataLayout layout,
   return out_tensor;
 }
 
+// A tensor of one element broadcasts in the same way in any layout, so it
+// never needs a transpose.
+inline bool IsLayoutFreeTensor(const paddle::Tensor& tensor) {
+  return tensor.numel() == 1;
+}
+
+// Adds the time of transposing in between NCHW and NHWC to the cost based
+// layout autotune. The time is measured once per shape and dtype.
+inline void AddTransposeCost(const paddle::Tensor& in) {
+  if (in.shape().size() != 4 || !in.is_dense_tensor()) {
+    return;
+  }
+  auto& tuner = paddle::imperative::LayoutAutoTune::Instance();
+  size_t key = phi::autotune::GenKey(std::string("transpose"),
+                                     in.shape(),
+                                     static_cast<int64_t>(in.dtype()));
+  float us = 0.f;
+  if (!tuner.FindKernelTime(key, &us)) {
+    us = tuner.MeasureKernelTime(key, in.place(), [&in]() {
+      paddle::experimental::transpose(in, {0, 2, 3, 1});
+    });
+  }
+  tuner.AddTransposeTime(us);
+}
+
 inline phi::DataLayout DesiredLayout() {
   return paddle::imperative::LayoutAutoTune::Instance().GetDesiredLayout();
 }
@@ -128,7 +154,8 @@ class EagerLayoutTransformer {
     // update in shape size
     dim_size_ = in.shape().size();
     bool need_trans =
-        !(final_layout_ == Layout::UNDEFINED || final_layout_ == in.layout());
+        !(final_layout_ == Layout::UNDEFINED || final_layout_ == in.layout() ||
+          IsLayoutFreeTensor(in));
     // This is for Agnostic op when layout is different
     if (need_trans) {
       auto out_tensor = EagerTraceTransposeOp(final_layout_, in);
@@ -194,6 +221,91 @@ class EagerLayoutTransformer {
   int dim_size_;
 };
 
+// Used while the cost based layout autotune observes the ops. It runs the op
+// as it is, but follows whether the output would be in the candidate layout
+// and adds the transposes the candidate layout needs for the inputs.
+class EagerLayoutCostObserver : public EagerLayoutTransformer {
+ public:
+  enum class OpKind { kAgnostic, kLightly, kHeavily };
+
+  EagerLayoutCostObserver(
+      const std::string& op_name,
+      const paddle::small_vector<std::vector<paddle::Tensor>,
+                                 kSlotSmallVectorSize>& tensors_vector,
+      const phi::DataLayout final_layout,
+      OpKind kind)
+      : EagerLayoutTransformer(op_name, tensors_vector, final_layout) {
+    auto& tuner = paddle::imperative::LayoutAutoTune::Instance();
+    if (kind == OpKind::kHeavily) {
+      // runs in the candidate layout, the input enters it if not yet in it
+      const auto& in = tensors_vector[0][0];
+      if (in.shape().size() == 4) {
+        if (!tuner.IsCandidate(in.impl().get())) {
+          AddTransposeCost(in);
+        }
+        out_in_candidate_ = true;
+      }
+      return;
+    }
+
+    std::vector<const paddle::Tensor*> candidate_ins;
+    std::vector<const paddle::Tensor*> other_ins;
+    bool all_4d = true;
+    for (const auto& tensors : tensors_vector) {
+      for (const auto& tensor : tensors) {
+        if (!tensor.defined() || IsLayoutFreeTensor(tensor)) {
+          continue;
+        }
+        all_4d = all_4d && tensor.shape().size() == 4;
+        if (tuner.IsCandidate(tensor.impl().get())) {
+          candidate_ins.push_back(&tensor);
+        } else {
+          other_ins.push_back(&tensor);
+        }
+      }
+    }
+    if (candidate_ins.empty()) {
+      return;
+    }
+    if (kind == OpKind::kAgnostic && all_4d) {
+      // the candidate layout propagates through the op
+      for (const auto* tensor : other_ins) {
+        AddTransposeCost(*tensor);
+      }
+      out_in_candidate_ = true;
+    } else {
+      // the candidate layout leaves at the op
+      for (const auto* tensor : candidate_ins) {
+        AddTransposeCost(*tensor);
+      }
+    }
+  }
+
+  void SetOutTensorLayout(paddle::Tensor* out_tensor) {
+    EagerLayoutTransformer::SetOutTensorLayout(out_tensor);
+    MarkCandidate(*out_tensor);
+  }
+
+  void SetOutTensorLayout(std::vector<paddle::Tensor>* out_tensor) {
+    EagerLayoutTransformer::SetOutTensorLayout(out_tensor);
+    for (const auto& tensor : *out_tensor) {
+      MarkCandidate(tensor);
+    }
+  }
+
+ private:
+  void MarkCandidate(const paddle::Tensor& out) {
+    auto& tuner = paddle::imperative::LayoutAutoTune::Instance();
+    // The observation may have finished within the op.
+    if (out_in_candidate_ && tuner.IsObserving() && out.defined() &&
+        out.shape().size() == 4) {
+      tuner.MarkCandidate(out.impl().get());
+    }
+  }
+
+  bool out_in_candidate_{false};
+};
+
 class EagerHeavilyLayoutSensitiveOpTransformer : public EagerLayoutTransformer {
  public:
   explicit EagerHeavilyLayoutSensitiveOpTransformer(const std::string& op_name,
@@ -0,0 +1,267 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/lazy_tracer.h"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/framework/executor_cache.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/builtin_type.h"
+#include "paddle/pir/include/core/ir_context.h"
+
+COMMON_DECLARE_int32(eager_lazy_max_segment_ops);
+
+namespace egr {
+
+namespace {
+
+// The compiled segments are dropped all together beyond this number, the
+// segments of a model are few and repeated.
+constexpr size_t kMaxCachedSegments = 256;
+
+std::string InputName(size_t i) { return "lazy_in_" + std::to_string(i); }
+
+std::string OutputName(size_t i) { return "lazy_out_" + std::to_string(i); }
+
+}  // namespace
+
+LazyTracer& LazyTracer::Instance() {
+  static LazyTracer tracer;
+  return tracer;
+}
+
+LazyTracer::LazyTracer() {
+  pir::IrContext::Instance()
+      ->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  Controller::Instance().SetLazyFlushHook([this]() { Flush(); });
+}
+
+pir::Program* LazyTracer::program() {
+  if (program_ == nullptr) {
+    program_ = std::make_unique<pir::Program>(pir::IrContext::Instance());
+  }
+  return program_.get();
+}
+
+pir::Value LazyTracer::GetValue(const paddle::Tensor& tensor) {
+  const phi::TensorBase* impl = tensor.impl().get();
+  if (IsPlaceholder(tensor)) {
+    return outputs_[output_ids_.at(impl)].value;
+  }
+  auto input = input_values_.find(impl);
+  if (input != input_values_.end()) {
+    return input->second;
+  }
+
+  PADDLE_ENFORCE_EQ(
+      tensor.initialized() && tensor.is_dense_tensor(),
+      true,
+      phi::errors::InvalidArgument(
+          "The input %s of the lazy segment must be an initialized "
+          "DenseTensor.",
+          tensor.name()));
+  pir::Builder builder(pir::IrContext::Instance(), program()->block());
+  pir::Value value =
+      builder
+          .Build<paddle::dialect::DataOp>(InputName(inputs_.size()),
+                                          common::vectorize(tensor.dims()),
+                                          tensor.dtype(),
+                                          tensor.place())
+          .out();
+  inputs_.push_back(tensor);
+  input_values_[impl] = value;
+  return value;
+}
+
+bool LazyTracer::IsPlaceholder(const paddle::Tensor& tensor) const {
+  // The address of a released placeholder may be reused by a new tensor.
+  auto it = output_ids_.find(tensor.impl().get());
+  return it != output_ids_.end() &&
+         outputs_[it->second].tensor.lock() == tensor.impl();
+}
+
+paddle::Tensor LazyTracer::AddOutput(pir::Value value) {
+  PADDLE_ENFORCE_EQ(value.type().isa<pir::DenseTensorType>(),
+                    true,
+                    phi::errors::InvalidArgument(
+                        "The outputs of the lazy segment must be "
+                        "DenseTensors."));
+  auto type = value.type().dyn_cast<pir::DenseTensorType>();
+  auto placeholder = std::make_shared<phi::DenseTensor>(
+      std::shared_ptr<phi::Allocation>(),
+      phi::DenseTensorMeta(paddle::dialect::TransToPhiDataType(type.dtype()),
+                           type.dims(),
+                           type.data_layout()));
+  output_ids_[placeholder.get()] = outputs_.size();
+  outputs_.push_back({placeholder, value});
+  Controller::Instance().SetHasLazySegment(true);
+  return paddle::Tensor(placeholder,
+                        Controller::Instance().GenerateUniqueName("lazy_out"));
+}
+
+void LazyTracer::OnOpRecorded() {
+  if (++num_ops_ >= FLAGS_eager_lazy_max_segment_ops) {
+    Flush();
+  }
+}
+
+void LazyTracer::Rollback(size_t num_ops) {
+  pir::Block* block = program()->block();
+  while (block->size() > num_ops) {
+    block->pop_back();
+  }
+}
+
+std::string LazyTracer::Signature(const pir::Program& program) {
+  // The attributes and the types are uniqued by the IrContext, so their
+  // storages stand for their contents.
+  std::ostringstream os;
+  std::unordered_map<pir::Value, size_t> value_ids;
+  for (const auto& op : *program.block()) {
+    os << op.name() << "(";
+    for (size_t i = 0; i < op.num_operands(); ++i) {
+      pir::Value operand = op.operand_source(i);
+      auto it = value_ids.find(operand);
+      os << (it == value_ids.end() ? -1 : static_cast<int64_t>(it->second))
+         << ",";
+    }
+    os << "){";
+    std::set<std::string> attr_names;
+    for (const auto& attr : op.attributes()) {
+      attr_names.insert(attr.first);
+    }
+    for (const auto& name : attr_names) {
+      os << name << ":" << op.attributes().at(name).hash() << ",";
+    }
+    os << "}->";
+    for (size_t i = 0; i < op.num_results(); ++i) {
+      pir::Value result = op.result(i);
+      value_ids.emplace(result, value_ids.size());
+      os << result.type().hash() << ",";
+    }
+    os << ";";
+  }
+  return os.str();
+}
+
+void LazyTracer::Reset() {
+  program_.reset();
+  inputs_.clear();
+  input_values_.clear();
+  outputs_.clear();
+  output_ids_.clear();
+  num_ops_ = 0;
+  Controller::Instance().SetHasLazySegment(false);
+}
+
+void LazyTracer::Flush() {
+  if (num_ops_ == 0) {
+    Reset();
+    return;
+  }
+  paddle::platform::RecordEvent record_event(
+      "lazy_segment_flush", paddle::platform::TracerEventType::UserDefined, 1);
+
+  // The segment is taken out first, the ops recorded while it runs, if any,
+  // go to a new segment.
+  std::unique_ptr<pir::Program> program = std::move(program_);
+  std::vector<paddle::Tensor> inputs = std::move(inputs_);
+  std::vector<Output> outputs = std::move(outputs_);
+  int num_ops = num_ops_;
+  Reset();
+
+  // Only the placeholders alive are fetched.
+  std::vector<std::pair<std::shared_ptr<phi::TensorBase>, std::string>>
+      fetches;
+  pir::Builder builder(pir::IrContext::Instance(), program->block());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto tensor = outputs[i].tensor.lock();
+    if (tensor != nullptr) {
+      builder.Build<pir::ShadowOutputOp>(outputs[i].value, OutputName(i));
+      fetches.emplace_back(tensor, OutputName(i));
+    }
+  }
+
+  auto place = Controller::Instance().GetExpectedPlace();
+  std::string signature = Signature(*program);
+  auto it = segments_.find(signature);
+  if (it == segments_.end()) {
+    VLOG(4) << "Compile a lazy segment of " << num_ops << " ops";
+    if (segments_.size() >= kMaxCachedSegments) {
+      segments_.clear();
+    }
+    auto segment = std::make_unique<CompiledSegment>();
+    segment->scope = std::make_unique<paddle::framework::Scope>();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      segment->scope->Var(InputName(i))->GetMutable<phi::DenseTensor>();
+    }
+    segment->kernel_program =
+        paddle::framework::ApplyIrPass(program.get(), place);
+    paddle::framework::interpreter::ExecutionConfig execution_config;
+    execution_config.create_local_scope = false;
+    execution_config.used_for_jit = true;
+    segment->core = std::make_shared<paddle::framework::InterpreterCore>(
+        place,
+        std::vector<std::string>{},
+        segment->kernel_program->block(),
+        segment->scope.get(),
+        execution_config);
+    std::set<std::string> skip_gc_vars;
+    for (const auto& fetch : fetches) {
+      skip_gc_vars.insert(fetch.second);
+    }
+    segment->core->SetSkipGcVars(skip_gc_vars);
+    it = segments_.emplace(signature, std::move(segment)).first;
+  } else {
+    VLOG(6) << "Reuse the compiled lazy segment of " << num_ops << " ops";
+  }
+
+  CompiledSegment* segment = it->second.get();
+  paddle::framework::Scope* scope = segment->scope.get();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    *scope->Var(InputName(i))->GetMutable<phi::DenseTensor>() =
+        *static_cast<phi::DenseTensor*>(inputs[i].impl().get());
+  }
+  segment->core->Run({}, /*need_fetch=*/false);
+
+  for (const auto& fetch : fetches) {
+    auto* var = scope->FindVar(fetch.second);
+    PADDLE_ENFORCE_NOT_NULL(
+        var,
+        phi::errors::NotFound("The output %s of the lazy segment is not found.",
+                              fetch.second));
+    auto* out = var->GetMutable<phi::DenseTensor>();
+    *static_cast<phi::DenseTensor*>(fetch.first.get()) = *out;
+  }
+  // The memory is not held by the cached scope, or the next run could write
+  // to the outputs of this one.
+  for (auto* var : scope->LocalVars()) {
+    if (var != nullptr && var->IsType<phi::DenseTensor>()) {
+      var->GetMutable<phi::DenseTensor>()->MoveMemoryHolder();
+    }
+  }
+}
+
+}  // namespace egr
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/macros.h"
+#include "paddle/fluid/framework/new_executor/interpretercore.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/core/value.h"
+
+namespace egr {
+
+/**
+ * LazyTracer records the dygraph ops into a segment, a pir::Program, instead
+ * of running them one by one, with FLAGS_eager_lazy_mode. The ops are built
+ * by the static APIs of PIR, see paddle/fluid/pybind/lazy_op_function.h.
+ *
+ * The outputs of the recorded ops are placeholder DenseTensors, which have
+ * the meta but no memory. The segment is flushed before any of them is read,
+ * i.e. by numpy() or by an op which is not recorded: it is lowered to the
+ * kernel dialect and run by an InterpreterCore, then the placeholders share
+ * the outputs. The compiled segments are cached by the signature of their
+ * ops, so a segment which records the same ops on the inputs of the same
+ * meta is only run again.
+ **/
+class LazyTracer {
+ public:
+  static LazyTracer& Instance();
+
+  // The program the recorded ops are built in.
+  pir::Program* program();
+
+  // The value of tensor in the segment, the input of the segment if it is not
+  // a placeholder of the segment.
+  pir::Value GetValue(const paddle::Tensor& tensor);
+
+  bool IsPlaceholder(const paddle::Tensor& tensor) const;
+
+  // The placeholder of the value recorded by an op.
+  paddle::Tensor AddOutput(pir::Value value);
+
+  // Called after an op is recorded, flushes the segment once it has
+  // FLAGS_eager_lazy_max_segment_ops ops.
+  void OnOpRecorded();
+
+  // Removes the ops after the first num_ops ops of the segment, for an op
+  // which fails to be recorded.
+  void Rollback(size_t num_ops);
+
+  // Runs the recorded ops and clears the segment.
+  void Flush();
+
+ private:
+  struct Output {
+    std::weak_ptr<phi::TensorBase> tensor;
+    pir::Value value;
+  };
+
+  struct CompiledSegment {
+    std::unique_ptr<pir::Program> kernel_program;
+    std::unique_ptr<paddle::framework::Scope> scope;
+    std::shared_ptr<paddle::framework::InterpreterCore> core;
+  };
+
+  LazyTracer();
+
+  void Reset();
+
+  static std::string Signature(const pir::Program& program);
+
+  std::unique_ptr<pir::Program> program_;
+  // inputs_[i] is fed to the data op "lazy_in_<i>"
+  std::vector<paddle::Tensor> inputs_;
+  std::unordered_map<const phi::TensorBase*, pir::Value> input_values_;
+  std::vector<Output> outputs_;
+  std::unordered_map<const phi::TensorBase*, size_t> output_ids_;
+  int num_ops_{0};
+
+  std::unordered_map<std::string, std::unique_ptr<CompiledSegment>> segments_;
+
+  DISABLE_COPY_AND_ASSIGN(LazyTracer);
+};
+
+}  // namespace egr
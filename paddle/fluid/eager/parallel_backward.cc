@@ -0,0 +1,467 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/parallel_backward.h"
+
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/accumulation/accumulation_node.h"
+#include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/imperative/tracer.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/device_event.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/phi/api/include/context_pool.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/threadpool.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#endif
+
+COMMON_DECLARE_int32(eager_backward_num_threads);
+
+namespace egr {
+
+namespace {
+
+using DeviceEvent = paddle::platform::DeviceEvent;
+using ApiDeviceContextMap =
+    paddle::experimental::DeviceContextPool::DeviceContextMap;
+
+// The device contexts of a thread, which has its own stream on GPU.
+struct WorkerContexts {
+  std::map<phi::Place, std::shared_future<std::unique_ptr<phi::DeviceContext>>>
+      contexts;
+  ApiDeviceContextMap api_contexts;
+  const phi::DeviceContext* dev_ctx{nullptr};
+};
+
+bool UseWorkerStreams(const phi::Place& place) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  return phi::is_gpu_place(place);
+#else
+  return false;
+#endif
+}
+
+// The contexts are created once for each thread and kept for the later
+// backward passes, as creating the streams is not cheap.
+WorkerContexts* GetWorkerContexts(const phi::Place& place, int worker) {
+  static std::mutex mutex;
+  static std::map<std::pair<phi::Place, int>, std::unique_ptr<WorkerContexts>>
+      worker_contexts;
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& contexts = worker_contexts[std::make_pair(place, worker)];
+  if (contexts == nullptr) {
+    contexts = std::make_unique<WorkerContexts>();
+    paddle::platform::EmplaceDeviceContexts(
+        &contexts->contexts,
+        {place},
+        /*disable_setting_default_stream_for_allocator=*/true,
+        /*stream_priority=*/0);
+    contexts->dev_ctx = contexts->contexts.at(place).get().get();
+    contexts->api_contexts[place] = contexts->dev_ctx;
+  }
+  return contexts.get();
+}
+
+phi::ThreadPool* GetThreadPool(int num_threads) {
+  static std::unique_ptr<phi::ThreadPool> pool;
+  static int pool_threads = 0;
+  if (pool == nullptr || pool_threads != num_threads) {
+    pool = std::make_unique<phi::ThreadPool>(num_threads);
+    pool_threads = num_threads;
+  }
+  return pool.get();
+}
+
+// The thread local states of the dygraph mode are copied into the threads the
+// grad nodes run on, as the nodes may trace ops with create_graph.
+struct TracerState {
+  std::shared_ptr<paddle::imperative::Tracer> tracer;
+  bool has_grad;
+  paddle::imperative::AmpLevel amp_level;
+  std::string amp_dtype;
+  bool use_promote;
+
+  static TracerState Current() {
+    const auto& tracer = paddle::imperative::GetCurrentTracer();
+    if (tracer == nullptr) {
+      return {nullptr, false, paddle::imperative::AmpLevel::O0, "", true};
+    }
+    return {tracer,
+            tracer->HasGrad(),
+            tracer->GetAmpLevel(),
+            tracer->GetAmpDtype(),
+            tracer->GetUsePromote()};
+  }
+
+  void Apply() const {
+    paddle::imperative::SetCurrentTracer(tracer);
+    if (tracer != nullptr) {
+      tracer->SetHasGrad(has_grad);
+      tracer->SetAmpLevel(amp_level);
+      tracer->SetAmpDtype(amp_dtype);
+      tracer->SetUsePromote(use_promote);
+    }
+  }
+};
+
+std::shared_ptr<DeviceEvent> RecordDeviceEvent(
+    const phi::Place& place, const phi::DeviceContext* dev_ctx) {
+  auto event = std::make_shared<DeviceEvent>(
+      place, paddle::platform::GenerateDeviceEventFlag());
+  event->Record(dev_ctx);
+  return event;
+}
+
+class ParallelBackward {
+ public:
+  ParallelBackward(
+      std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+          node_input_buffers_dict,
+      std::unordered_map<GradNodeBase*, int>* node_in_degree_map,
+      bool retain_graph,
+      bool create_graph,
+      const phi::Place& place)
+      : node_input_buffers_dict_(node_input_buffers_dict),
+        node_in_degree_map_(node_in_degree_map),
+        retain_graph_(retain_graph),
+        create_graph_(create_graph),
+        place_(place),
+        use_streams_(UseWorkerStreams(place)) {}
+
+  void Run(const std::deque<GradNodeBase*>& queue);
+
+ private:
+  void RunWorker(int worker, const TracerState& tracer_state);
+
+  // Runs node on the stream of dev_ctx, then sums its outputs into the
+  // GradTensorHolders of the next nodes.
+  void RunNode(GradNodeBase* node,
+               std::unique_ptr<GradTensorHolder> node_input_buffer,
+               const std::vector<std::shared_ptr<DeviceEvent>>& input_events,
+               const phi::DeviceContext* dev_ctx);
+
+  void Schedule(GradNodeBase* node);
+
+  std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+      node_input_buffers_dict_;
+  std::unordered_map<GradNodeBase*, int>* node_in_degree_map_;
+  bool retain_graph_;
+  bool create_graph_;
+  phi::Place place_;
+  bool use_streams_;
+
+  // mutex_ guards all the members below and the maps above.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<GradNodeBase*> ready_nodes_;
+  int num_running_nodes_{0};
+  std::exception_ptr exception_;
+  // The events recorded after the nodes which feed the GradTensorHolder of a
+  // node, the node waits for them before it runs.
+  std::unordered_map<GradNodeBase*, std::vector<std::shared_ptr<DeviceEvent>>>
+      input_events_;
+  std::shared_ptr<DeviceEvent> start_event_;
+  std::vector<std::shared_ptr<DeviceEvent>> finish_events_;
+};
+
+void ParallelBackward::Schedule(GradNodeBase* node) {
+  // Same as the serial backward, the accumulation nodes go first to release
+  // the grads of the leaf tensors early.
+  if (dynamic_cast<egr::GradNodeAccumulation*>(node)) {
+    ready_nodes_.push_front(node);
+  } else {
+    ready_nodes_.push_back(node);
+  }
+}
+
+void ParallelBackward::Run(const std::deque<GradNodeBase*>& queue) {
+  std::unordered_set<GradNodeBase*> scheduled;
+  for (auto* node : queue) {
+    // The startup nodes reached by others wait for their in degree.
+    if ((*node_in_degree_map_)[node] == 0 && scheduled.insert(node).second) {
+      Schedule(node);
+    }
+  }
+
+  int num_threads = FLAGS_eager_backward_num_threads;
+  const phi::DeviceContext* default_dev_ctx = nullptr;
+  if (use_streams_) {
+    // The grad nodes read the outputs of the forward ops on the default
+    // stream.
+    default_dev_ctx = phi::DeviceContextPool::Instance().Get(place_);
+    start_event_ = RecordDeviceEvent(place_, default_dev_ctx);
+    finish_events_.resize(num_threads);
+  }
+
+  TracerState tracer_state = TracerState::Current();
+  auto* pool = GetThreadPool(num_threads);
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    futures.emplace_back(
+        pool->Run([this, i, &tracer_state]() { RunWorker(i, tracer_state); }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+
+  if (use_streams_) {
+    // The ops after backward on the default stream read the grads.
+    for (const auto& event : finish_events_) {
+      if (event != nullptr) {
+        event->Wait(paddle::platform::Place2DeviceType(place_),
+                    default_dev_ctx);
+      }
+    }
+  }
+  if (exception_) {
+    std::rethrow_exception(exception_);
+  }
+}
+
+void ParallelBackward::RunWorker(int worker, const TracerState& tracer_state) {
+  tracer_state.Apply();
+  const phi::DeviceContext* dev_ctx = nullptr;
+  if (use_streams_) {
+    auto* contexts = GetWorkerContexts(place_, worker);
+    dev_ctx = contexts->dev_ctx;
+    phi::DeviceContextPool::SetDeviceContexts(&contexts->contexts);
+    paddle::experimental::DeviceContextPool::SetThreadLocalContexts(
+        &contexts->api_contexts);
+    start_event_->Wait(paddle::platform::Place2DeviceType(place_), dev_ctx);
+  }
+
+  while (true) {
+    GradNodeBase* node = nullptr;
+    std::unique_ptr<GradTensorHolder> node_input_buffer;
+    std::vector<std::shared_ptr<DeviceEvent>> input_events;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() {
+        return exception_ || !ready_nodes_.empty() || num_running_nodes_ == 0;
+      });
+      if (exception_ || ready_nodes_.empty()) {
+        break;
+      }
+      node = ready_nodes_.front();
+      ready_nodes_.pop_front();
+      ++num_running_nodes_;
+
+      auto iter = node_input_buffers_dict_->find(node);
+      PADDLE_ENFORCE_NE(
+          iter,
+          node_input_buffers_dict_->end(),
+          phi::errors::Fatal(
+              "Unable to find next node in the GradTensorHolder \n"
+              "Trying to run Node without configuring its GradTensorHolder."));
+      node_input_buffer = std::move(iter->second);
+      node_input_buffers_dict_->erase(iter);
+      auto events = input_events_.find(node);
+      if (events != input_events_.end()) {
+        input_events = std::move(events->second);
+        input_events_.erase(events);
+      }
+    }
+
+    try {
+      RunNode(node, std::move(node_input_buffer), input_events, dev_ctx);
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (!exception_) {
+        exception_ = std::current_exception();
+      }
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      --num_running_nodes_;
+    }
+    cv_.notify_all();
+  }
+
+  if (use_streams_) {
+    finish_events_[worker] = RecordDeviceEvent(place_, dev_ctx);
+    phi::DeviceContextPool::SetDeviceContexts(nullptr);
+    paddle::experimental::DeviceContextPool::SetThreadLocalContexts(nullptr);
+  }
+  TracerState{nullptr, false, paddle::imperative::AmpLevel::O0, "", true}
+      .Apply();
+}
+
+void ParallelBackward::RunNode(
+    GradNodeBase* node,
+    std::unique_ptr<GradTensorHolder> node_input_buffer,
+    const std::vector<std::shared_ptr<DeviceEvent>>& input_events,
+    const phi::DeviceContext* dev_ctx) {
+  VLOG(3) << "Preparing GradNode:" << node->name() << " addr:" << node;
+  PADDLE_ENFORCE_NE(
+      node->IsTensorWrappersCleared(),
+      true,
+      phi::errors::Fatal(
+          "The TensorWrappers of %s do not exist. This may be because:\n"
+          "You calculate backward twice for the same subgraph without "
+          "setting retain_graph=True. Please set retain_graph=True in the "
+          "first backward/grad call.\n",
+          node->name()));
+
+  if (dev_ctx != nullptr) {
+    for (const auto& event : input_events) {
+      event->Wait(paddle::platform::Place2DeviceType(place_), dev_ctx);
+    }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    // The grads may be allocated on the streams of other threads, and must
+    // not be reused there before this stream reads them.
+    auto stream = static_cast<const phi::GPUContext*>(dev_ctx)->stream();
+    for (const auto& tensors : node_input_buffer->Buffers()) {
+      for (const auto& tensor : tensors) {
+        if (tensor.initialized() && tensor.is_dense_tensor() &&
+            phi::is_gpu_place(tensor.place())) {
+          auto* dense_tensor =
+              static_cast<phi::DenseTensor*>(tensor.impl().get());
+          paddle::memory::RecordStream(dense_tensor->Holder(), stream);
+        }
+      }
+    }
+#endif
+  }
+
+  paddle::small_vector<std::vector<paddle::Tensor>, kSlotSmallVectorSize>
+      grad_output_tensors;
+  {
+    paddle::platform::RecordEvent grad_node_record_event(
+        "Global_" + std::string(node->name()),
+        paddle::platform::TracerEventType::Operator,
+        1);
+    grad_output_tensors = (*node)(node_input_buffer->Buffers(), create_graph_);
+  }
+  if (!retain_graph_) {
+    node->ClearTensorWrappers();
+  }
+  // Recorded after the grads are summed into the next GradTensorHolders, and
+  // before the lock is released, i.e. before the next nodes can wait for it.
+  std::shared_ptr<DeviceEvent> output_event =
+      dev_ctx != nullptr
+          ? std::make_shared<DeviceEvent>(
+                place_, paddle::platform::GenerateDeviceEventFlag())
+          : nullptr;
+
+  const paddle::small_vector<std::vector<GradSlotMeta>, kSlotSmallVectorSize>&
+      metas = node->OutputMeta();
+  PADDLE_ENFORCE(metas.size() == grad_output_tensors.size() || metas.empty(),
+                 phi::errors::Fatal(
+                     "Number of edges should be either empty ( for leaf node "
+                     ") or the same as number of output grad tensors, but we "
+                     "got edges size is: %d, grad_output size is: %d",
+                     metas.size(),
+                     grad_output_tensors.size()));
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (size_t i = 0; i < metas.size(); i++) {
+    for (size_t j = 0; j < metas[i].size(); j++) {
+      const Edge& edge = metas[i][j].GetEdge();
+      if (!edge.IsInitialized()) {
+        continue;
+      }
+      auto next_node_shared = edge.GetMutableGradNode();
+      if (!next_node_shared || !next_node_shared.get() ||
+          grad_output_tensors[i].empty()) {
+        continue;
+      }
+      PADDLE_ENFORCE_LT(
+          j,
+          grad_output_tensors[i].size(),
+          phi::errors::Fatal(
+              "Rank of grad_output_tensors should be less than "
+              "grad_output_tensors[i].size(), which is: %d. This error may "
+              "indicate autoprune or autograd api error. ",
+              grad_output_tensors.size()));
+
+      auto* next_node = next_node_shared.get();
+      auto& next_input_buffer = (*node_input_buffers_dict_)[next_node];
+      if (next_input_buffer == nullptr) {
+        next_input_buffer =
+            std::make_unique<GradTensorHolder>(next_node->InputMeta());
+      }
+      auto& next_input_events = input_events_[next_node];
+      if (dev_ctx != nullptr) {
+        // The grads already in the holder are summed on this stream.
+        for (const auto& event : next_input_events) {
+          event->Wait(paddle::platform::Place2DeviceType(place_), dev_ctx);
+        }
+        next_input_events.push_back(output_event);
+      }
+      auto edge_rank = edge.GetEdgeRankInfo();
+      next_input_buffer->add(edge_rank.first,
+                             edge_rank.second,
+                             grad_output_tensors[i][j],
+                             create_graph_);
+
+      int& in_degree = (*node_in_degree_map_)[next_node];
+      --in_degree;
+      PADDLE_ENFORCE(
+          in_degree >= 0,
+          phi::errors::Fatal(
+              "Detected in-degree value smaller than zero. For Node: %s"
+              "Node's in-degree cannot be negative.",
+              next_node->name()));
+      if (in_degree == 0) {
+        Schedule(next_node);
+      }
+    }
+  }
+  if (output_event != nullptr) {
+    output_event->Record(dev_ctx);
+  }
+  paddle::memory::LogDeviceMemoryStats(place_, std::string(node->name()));
+}
+
+}  // namespace
+
+bool UseParallelBackward() { return FLAGS_eager_backward_num_threads > 1; }
+
+void RunBackwardInParallel(
+    const std::deque<GradNodeBase*>& queue,
+    std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+        node_input_buffers_dict,
+    std::unordered_map<GradNodeBase*, int>* node_in_degree_map,
+    bool retain_graph,
+    bool create_graph,
+    const phi::Place& place) {
+  // The threads and their streams are shared by the backward passes.
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> guard(mutex);
+  VLOG(3) << "Run backward on " << FLAGS_eager_backward_num_threads
+          << " threads";
+  ParallelBackward(node_input_buffers_dict,
+                   node_in_degree_map,
+                   retain_graph,
+                   create_graph,
+                   place)
+      .Run(queue);
+}
+
+}  // namespace egr
@@ -0,0 +1,51 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include "paddle/fluid/eager/grad_node_info.h"
+#include "paddle/fluid/eager/grad_tensor_holder.h"
+
+namespace egr {
+
+// Whether the grad nodes of backward() are run by RunBackwardInParallel, i.e.
+// FLAGS_eager_backward_num_threads is larger than 1.
+bool UseParallelBackward();
+
+/**
+ * Runs the grad nodes from queue on FLAGS_eager_backward_num_threads threads.
+ * A node is ready once its in degree in node_in_degree_map drops to zero, so
+ * the independent branches of the backward graph, e.g. the towers of a model,
+ * run at the same time.
+ *
+ * On GPU, each thread launches the kernels on its own stream. A node waits for
+ * the events recorded after the nodes which feed its GradTensorHolder, and the
+ * default stream waits for all the threads before this returns. The grads are
+ * summed into the GradTensorHolders under a lock, in the order the feeding
+ * nodes finish.
+ **/
+void RunBackwardInParallel(
+    const std::deque<GradNodeBase*>& queue,
+    std::unordered_map<GradNodeBase*, std::unique_ptr<GradTensorHolder>>*
+        node_input_buffers_dict,
+    std::unordered_map<GradNodeBase*, int>* node_in_degree_map,
+    bool retain_graph,
+    bool create_graph,
+    const phi::Place& place);
+
+}  // namespace egr
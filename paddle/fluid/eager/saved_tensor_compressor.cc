@@ -0,0 +1,182 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/saved_tensor_compressor.h"
+
+#include <cfloat>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/api/include/api.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/utils/string/string_helper.h"
+
+PHI_DEFINE_EXPORTED_string(
+    eager_compress_saved_tensors,
+    "",
+    "The forward ops whose tensors saved for backward are compressed, and "
+    "the compression methods, in the form of op:method separated by commas, "
+    "e.g. relu:mask,conv2d:bf16. The methods are bf16, fp16, fp8 and mask.");
+
+namespace egr {
+
+namespace {
+
+using Method = SavedTensorCompressor::Method;
+
+// The largest finite value of float8_e4m3fn.
+constexpr float kFloat8E4M3Max = 448.0f;
+constexpr float kMinAbsMax = 1e-12f;
+
+Method ParseMethod(const std::string& name) {
+  static const std::unordered_map<std::string, Method> methods = {
+      {"bf16", Method::kBFloat16},
+      {"fp16", Method::kFloat16},
+      {"fp8", Method::kFloat8},
+      {"mask", Method::kMask}};
+  auto iter = methods.find(name);
+  PADDLE_ENFORCE_NE(
+      iter,
+      methods.end(),
+      phi::errors::InvalidArgument(
+          "The compression method of the saved tensors should be one of bf16, "
+          "fp16, fp8 and mask, but received %s.",
+          name));
+  return iter->second;
+}
+
+// The methods of the ops in FLAGS_eager_compress_saved_tensors, parsed again
+// only when the flag changes.
+const std::unordered_map<std::string, Method>& OpMethods() {
+  static std::mutex mutex;
+  static std::string parsed_flag;
+  static std::unordered_map<std::string, Method> op_methods;
+  std::lock_guard<std::mutex> guard(mutex);
+  if (parsed_flag != FLAGS_eager_compress_saved_tensors) {
+    op_methods.clear();
+    for (const auto& item : paddle::string::split_string<std::string>(
+             FLAGS_eager_compress_saved_tensors, ",")) {
+      if (item.empty()) {
+        continue;
+      }
+      auto pair = paddle::string::split_string<std::string>(item, ":");
+      PADDLE_ENFORCE_EQ(pair.size(),
+                        2UL,
+                        phi::errors::InvalidArgument(
+                            "The items of FLAGS_eager_compress_saved_tensors "
+                            "should be op:method, but received %s.",
+                            item));
+      op_methods[pair[0]] = ParseMethod(pair[1]);
+    }
+    parsed_flag = FLAGS_eager_compress_saved_tensors;
+  }
+  return op_methods;
+}
+
+bool IsFloating(phi::DataType dtype) {
+  return dtype == phi::DataType::FLOAT32 || dtype == phi::DataType::FLOAT16 ||
+         dtype == phi::DataType::BFLOAT16;
+}
+
+bool CanCompress(Method method, phi::DataType dtype) {
+  switch (method) {
+    case Method::kBFloat16:
+    case Method::kFloat16:
+      return dtype == phi::DataType::FLOAT32;
+    case Method::kFloat8:
+    case Method::kMask:
+      return IsFloating(dtype);
+  }
+  return false;
+}
+
+}  // namespace
+
+std::shared_ptr<SavedTensorCompressor> SavedTensorCompressor::Create(
+    const char* op_name, const paddle::Tensor& tensor) {
+  if (op_name == nullptr || FLAGS_eager_compress_saved_tensors.empty() ||
+      !tensor.initialized() || !tensor.is_dense_tensor()) {
+    return nullptr;
+  }
+  const auto& op_methods = OpMethods();
+  auto iter = op_methods.find(op_name);
+  if (iter == op_methods.end() || !CanCompress(iter->second, tensor.dtype())) {
+    return nullptr;
+  }
+  return std::make_shared<SavedTensorCompressor>(iter->second, tensor.dtype());
+}
+
+SavedTensorCompressor::SavedTensorCompressor(Method method,
+                                             phi::DataType dtype)
+    : method_(method), dtype_(dtype) {}
+
+std::shared_ptr<phi::TensorBase> SavedTensorCompressor::Compress(
+    const paddle::Tensor& tensor) {
+  paddle::Tensor compressed;
+  switch (method_) {
+    case Method::kBFloat16:
+      compressed = paddle::experimental::cast(tensor, phi::DataType::BFLOAT16);
+      break;
+    case Method::kFloat16:
+      compressed = paddle::experimental::cast(tensor, phi::DataType::FLOAT16);
+      break;
+    case Method::kFloat8: {
+      // The scale is computed in float32, out of the range of float16.
+      paddle::Tensor x = tensor;
+      if (dtype_ != phi::DataType::FLOAT32) {
+        x = paddle::experimental::cast(tensor, phi::DataType::FLOAT32);
+      }
+      auto amax =
+          paddle::experimental::max(paddle::experimental::abs(x), {}, false);
+      // A tensor of zeros keeps the scale finite.
+      amax = paddle::experimental::clip(amax, kMinAbsMax, FLT_MAX);
+      scale_ = paddle::experimental::divide(
+          paddle::experimental::full(
+              {}, kFloat8E4M3Max, phi::DataType::FLOAT32, x.place()),
+          amax);
+      compressed = paddle::experimental::cast(
+          paddle::experimental::multiply(x, scale_),
+          phi::DataType::FLOAT8_E4M3FN);
+      break;
+    }
+    case Method::kMask:
+      compressed = paddle::experimental::greater_than(
+          tensor,
+          paddle::experimental::full({}, 0, tensor.dtype(), tensor.place()));
+      break;
+  }
+  static_cast<phi::DenseTensor*>(compressed.impl().get())
+      ->ShareInplaceVersionCounterWith(
+          *static_cast<phi::DenseTensor*>(tensor.impl().get()));
+  VLOG(6) << "Compress a saved tensor of " << dtype_ << " to "
+          << compressed.dtype();
+  return compressed.impl();
+}
+
+std::shared_ptr<phi::TensorBase> SavedTensorCompressor::Decompress(
+    const paddle::Tensor& compressed) const {
+  if (method_ == Method::kFloat8) {
+    auto x = paddle::experimental::divide(
+        paddle::experimental::cast(compressed, phi::DataType::FLOAT32), scale_);
+    return dtype_ == phi::DataType::FLOAT32
+               ? x.impl()
+               : paddle::experimental::cast(x, dtype_).impl();
+  }
+  return paddle::experimental::cast(compressed, dtype_).impl();
+}
+
+}  // namespace egr
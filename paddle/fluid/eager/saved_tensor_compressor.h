@@ -0,0 +1,69 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/common/data_type.h"
+
+namespace egr {
+
+/**
+ * SavedTensorCompressor keeps a tensor saved for backward in a smaller form
+ * and restores its dtype when the tensor is recovered for backward, chosen
+ * per forward op by FLAGS_eager_compress_saved_tensors, e.g.
+ * "relu:mask,conv2d:bf16,matmul:fp8".
+ *
+ * - bf16 / fp16: a float32 tensor is cast down to bfloat16 / float16.
+ * - fp8: a floating tensor is scaled by its max absolute value into the range
+ *   of float8_e4m3fn and cast down.
+ * - mask: only whether the elements are positive is kept, as a bool tensor,
+ *   which is lossless for the ops whose grads only read the sign of the saved
+ *   tensor, e.g. the out of relu.
+ *
+ * All the methods but mask are lossy. The TensorWrapper holds the compressed
+ * tensor only, so the memory of the forward tensor is released once the
+ * forward ops are done with it.
+ **/
+class SavedTensorCompressor {
+ public:
+  enum class Method { kBFloat16, kFloat16, kFloat8, kMask };
+
+  // Returns nullptr if the tensors saved by op_name are not compressed, or
+  // the method does not apply to tensor.
+  static std::shared_ptr<SavedTensorCompressor> Create(
+      const char* op_name, const paddle::Tensor& tensor);
+
+  SavedTensorCompressor(Method method, phi::DataType dtype);
+
+  // The compressed tensor of tensor, which shares the inplace version counter
+  // with tensor.
+  std::shared_ptr<phi::TensorBase> Compress(const paddle::Tensor& tensor);
+
+  // The tensor restored from compressed, of the dtype of the tensor saved.
+  std::shared_ptr<phi::TensorBase> Decompress(
+      const paddle::Tensor& compressed) const;
+
+  Method method() const { return method_; }
+
+ private:
+  Method method_;
+  phi::DataType dtype_;
+  // The scale of kFloat8, a 0-D tensor.
+  paddle::Tensor scale_;
+};
+
+}  // namespace egr
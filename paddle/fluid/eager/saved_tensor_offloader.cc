@@ -0,0 +1,132 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/eager/saved_tensor_offloader.h"
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/device_context.h"
+
+PHI_DEFINE_EXPORTED_uint64(
+    eager_offload_saved_tensor_min_size_in_mb,
+    0,
+    "The GPU tensors saved for backward no smaller than this size are "
+    "offloaded to the pinned host memory when the GPU is out of memory, and "
+    "copied back when they are used by backward. 0 means no offloading.");
+
+namespace egr {
+
+std::shared_ptr<SavedTensorOffloader> SavedTensorOffloader::Create(
+    const paddle::Tensor& tensor) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (FLAGS_eager_offload_saved_tensor_min_size_in_mb == 0 ||
+      !tensor.initialized() || !tensor.is_dense_tensor() ||
+      !tensor.is_gpu()) {
+    return nullptr;
+  }
+  auto* dense_tensor = static_cast<phi::DenseTensor*>(tensor.impl().get());
+  if (dense_tensor->Holder()->size() <
+      (FLAGS_eager_offload_saved_tensor_min_size_in_mb << 20)) {
+    return nullptr;
+  }
+  auto saved_tensor = std::make_shared<phi::DenseTensor>();
+  saved_tensor->ShareDataWith(*dense_tensor);
+  saved_tensor->ShareInplaceVersionCounterWith(*dense_tensor);
+  return std::make_shared<SavedTensorOffloader>(std::move(saved_tensor));
+#else
+  return nullptr;
+#endif
+}
+
+SavedTensorOffloader::SavedTensorOffloader(
+    std::shared_ptr<phi::DenseTensor> tensor)
+    : tensor_(std::move(tensor)), place_(tensor_->place()) {
+  paddle::memory::allocation::MemoryOffloadRegistry::Instance().Register(
+      place_, this);
+}
+
+SavedTensorOffloader::~SavedTensorOffloader() {
+  paddle::memory::allocation::MemoryOffloadRegistry::Instance().Unregister(
+      this);
+}
+
+size_t SavedTensorOffloader::Offload() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // the allocation is still used by others
+  if (offloaded_ || tensor_->Holder().use_count() != 1) {
+    return 0;
+  }
+  paddle::platform::RecordEvent record("SavedTensorOffloader::Offload",
+                                       paddle::platform::TracerEventType::
+                                           UserDefined,
+                                       2 /*level*/);
+  const auto& holder = tensor_->Holder();
+  size_t size = holder->size();
+  auto host_holder = paddle::memory::AllocShared(phi::GPUPinnedPlace(), size);
+  auto* dev_ctx = static_cast<phi::GPUContext*>(
+      phi::DeviceContextPool::Instance().Get(place_));
+  paddle::memory::Copy(host_holder->place(),
+                       host_holder->ptr(),
+                       place_,
+                       holder->ptr(),
+                       size,
+                       dev_ctx->stream());
+  dev_ctx->Wait();
+  tensor_->ResetHolder(host_holder);
+  offloaded_ = true;
+  VLOG(4) << "Offload a saved tensor of " << size << " bytes from " << place_;
+  return size;
+#else
+  return 0;
+#endif
+}
+
+void SavedTensorOffloader::Reload() {
+  // the tensor is going to be used by backward, and should not be offloaded
+  // any more
+  paddle::memory::allocation::MemoryOffloadRegistry::Instance().Unregister(
+      this);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (!offloaded_) {
+    return;
+  }
+  paddle::platform::RecordEvent record("SavedTensorOffloader::Reload",
+                                       paddle::platform::TracerEventType::
+                                           UserDefined,
+                                       2 /*level*/);
+  // the host memory is held until the copy is done
+  std::shared_ptr<phi::Allocation> host_holder = tensor_->Holder();
+  size_t size = host_holder->size();
+  auto* dev_ctx = static_cast<phi::GPUContext*>(
+      phi::DeviceContextPool::Instance().Get(place_));
+  auto device_holder = paddle::memory::AllocShared(
+      place_,
+      size,
+      phi::Stream(reinterpret_cast<phi::StreamId>(dev_ctx->stream())));
+  paddle::memory::Copy(place_,
+                       device_holder->ptr(),
+                       host_holder->place(),
+                       host_holder->ptr(),
+                       size,
+                       dev_ctx->stream());
+  dev_ctx->AddStreamCallback([host_holder]() {});
+  tensor_->ResetHolder(device_holder);
+  offloaded_ = false;
+  VLOG(4) << "Reload a saved tensor of " << size << " bytes to " << place_;
+#endif
+}
+
+}  // namespace egr
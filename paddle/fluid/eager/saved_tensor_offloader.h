@@ -0,0 +1,63 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "paddle/fluid/memory/allocation/memory_offload.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace egr {
+
+/**
+ * SavedTensorOffloader moves a large GPU tensor saved for backward to the
+ * pinned host memory when the GPU is out of memory, and copies it back
+ * asynchronously on the compute stream when the tensor is recovered for
+ * backward.
+ *
+ * The TensorWrapper saves a private DenseTensor sharing the allocation with
+ * the forward tensor, and the tensor is only offloaded when the allocation is
+ * held by no one else, i.e. the forward tensor has been released, so the
+ * offloading is invisible to the users.
+ **/
+class SavedTensorOffloader : public paddle::memory::allocation::Offloadable {
+ public:
+  // Returns nullptr if the tensor should not be offloaded, see
+  // FLAGS_eager_offload_saved_tensor_min_size_in_mb.
+  static std::shared_ptr<SavedTensorOffloader> Create(
+      const paddle::Tensor& tensor);
+
+  explicit SavedTensorOffloader(std::shared_ptr<phi::DenseTensor> tensor);
+
+  ~SavedTensorOffloader() override;
+
+  const std::shared_ptr<phi::DenseTensor>& tensor() const { return tensor_; }
+
+  bool offloaded() const { return offloaded_; }
+
+  size_t Offload() override;
+
+  // Copies the tensor back to the device if it is offloaded, and the tensor
+  // is not offloaded any more after that.
+  void Reload();
+
+ private:
+  std::shared_ptr<phi::DenseTensor> tensor_;
+  phi::Place place_;
+  bool offloaded_{false};
+};
+
+}  // namespace egr
@@ -27,6 +27,8 @@
 #pragma once
 #include "paddle/fluid/eager/autograd_meta.h"
 #include "paddle/fluid/eager/grad_node_info.h"
+#include "paddle/fluid/eager/saved_tensor_compressor.h"
+#include "paddle/fluid/eager/saved_tensor_offloader.h"
 #include "paddle/fluid/eager/utils.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
 #ifndef PADDLE_NO_PYTHON
@@ -39,8 +41,10 @@ namespace egr {
 class TensorWrapper {
  public:
   TensorWrapper() = default;
+  // op_name is the forward op saving the tensor, for SavedTensorCompressor.
   explicit TensorWrapper(const paddle::Tensor& tensor,
-                         bool no_need_buffer = false) {
+                         bool no_need_buffer = false,
+                         const char* op_name = nullptr) {
     // set inplace_version_snapshot_ according to tensor's current inplace
     // version.
     if (tensor.initialized() && tensor.is_dense_tensor()) {
@@ -122,7 +126,17 @@ class TensorWrapper {
         packed_value_ = (*pack_hook)(tensor);
       } else {
 #endif
-        intermidiate_tensor_.set_impl(tensor.impl());
+        compressor_ = SavedTensorCompressor::Create(op_name, tensor);
+        if (compressor_) {
+          intermidiate_tensor_.set_impl(compressor_->Compress(tensor));
+        } else {
+          offloader_ = SavedTensorOffloader::Create(tensor);
+          if (offloader_) {
+            intermidiate_tensor_.set_impl(offloader_->tensor());
+          } else {
+            intermidiate_tensor_.set_impl(tensor.impl());
+          }
+        }
 #ifndef PADDLE_NO_PYTHON
       }
 #endif
@@ -186,11 +200,17 @@ class TensorWrapper {
     } else {
 #endif
       check_inplace_version();
+      if (offloader_) {
+        offloader_->Reload();
+      }
 #ifndef PADDLE_NO_PYTHON
     }
 #endif
 
     paddle::Tensor recovered_tensor = intermidiate_tensor_;
+    if (compressor_) {
+      recovered_tensor.set_impl(compressor_->Decompress(intermidiate_tensor_));
+    }
 
     std::shared_ptr<GradNodeBase> new_grad_node = weak_grad_node_.lock();
     if (new_grad_node) {
@@ -216,7 +236,11 @@ class TensorWrapper {
 
   paddle::Tensor get_intermidiate_tensor() { return intermidiate_tensor_; }
 
-  void clear() { intermidiate_tensor_.reset(); }
+  void clear() {
+    intermidiate_tensor_.reset();
+    offloader_.reset();
+    compressor_.reset();
+  }
 
  private:
   void check_inplace_version() {
@@ -270,6 +294,8 @@ class TensorWrapper {
   paddle::Tensor intermidiate_tensor_;
   std::weak_ptr<egr::GradNodeBase> weak_grad_node_;
   uint32_t inplace_version_snapshot_ = 0;
+  std::shared_ptr<SavedTensorOffloader> offloader_;
+  std::shared_ptr<SavedTensorCompressor> compressor_;
 #ifndef PADDLE_NO_PYTHON
   std::shared_ptr<egr::PyObjectHolderBase> packed_value_;
   std::shared_ptr<egr::UnPackHookBase> unpack_hook_;
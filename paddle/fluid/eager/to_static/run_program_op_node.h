@@ -162,6 +162,27 @@ static void CheckOutputVarStatus(const paddle::framework::Variable &src_var,
   }
 }
 
+static void ShareTensorIntoVar(const Tensor &tensor,
+                               paddle::framework::Variable *var) {
+  CheckInputVarStatus(tensor);
+  // share tensor
+  auto tensor_base = tensor.impl();
+  if (phi::DenseTensor::classof(tensor_base.get())) {
+    auto *dst_tensor = var->GetMutable<phi::DenseTensor>();
+    auto t = std::dynamic_pointer_cast<phi::DenseTensor>(tensor_base);
+    *dst_tensor = *t;
+  } else if (phi::SelectedRows::classof(tensor_base.get())) {
+    auto *dst_tensor = var->GetMutable<phi::SelectedRows>();
+    auto t = std::dynamic_pointer_cast<phi::SelectedRows>(tensor_base);
+    *dst_tensor = *t;
+  } else if (paddle::framework::VariableRefArray::classof(tensor_base.get())) {
+    auto *dst_tensor = var->GetMutable<paddle::framework::VariableRefArray>();
+    auto t = std::dynamic_pointer_cast<paddle::framework::VariableRefArray>(
+        tensor_base);
+    *dst_tensor = *t;
+  }
+}
+
 static void ShareTensorsIntoScopeWithName(
     const std::vector<Tensor> &tensors,
     const std::vector<std::string> &tensor_names,
@@ -174,24 +195,7 @@ static void ShareTensorsIntoScopeWithName(
       continue;
     }
     auto *var = scope->Var(name);
-    CheckInputVarStatus(tensors[i]);
-    // share tensor
-    auto tensor_base = tensors[i].impl();
-    if (phi::DenseTensor::classof(tensor_base.get())) {
-      auto *dst_tensor = var->GetMutable<phi::DenseTensor>();
-      auto t = std::dynamic_pointer_cast<phi::DenseTensor>(tensor_base);
-      *dst_tensor = *t;
-    } else if (phi::SelectedRows::classof(tensor_base.get())) {
-      auto *dst_tensor = var->GetMutable<phi::SelectedRows>();
-      auto t = std::dynamic_pointer_cast<phi::SelectedRows>(tensor_base);
-      *dst_tensor = *t;
-    } else if (paddle::framework::VariableRefArray::classof(
-                   tensor_base.get())) {
-      auto *dst_tensor = var->GetMutable<paddle::framework::VariableRefArray>();
-      auto t = std::dynamic_pointer_cast<paddle::framework::VariableRefArray>(
-          tensor_base);
-      *dst_tensor = *t;
-    }
+    ShareTensorIntoVar(tensors[i], var);
   }
 }
 
@@ -217,6 +221,35 @@ static void ShareTensorsIntoScopeByValue(
   ShareTensorsIntoScopeWithName(tensors, names, scope);
 }
 
+static void ShareTensorFromVar(const paddle::framework::Variable &var,
+                               Tensor *tensor) {
+  CheckOutputVarStatus(var, *tensor);
+  // share tensor
+  if (var.IsType<phi::DenseTensor>()) {
+    auto &src_tensor = var.Get<phi::DenseTensor>();
+    auto *dst_tensor = const_cast<phi::DenseTensor *>(
+        dynamic_cast<const phi::DenseTensor *>(tensor->impl().get()));
+    VLOG(2) << "actually do sharing " << tensor->name() << " from scope";
+    *dst_tensor = src_tensor;
+  } else if (var.IsType<phi::SelectedRows>()) {
+    auto &src_tensor = var.Get<phi::SelectedRows>();
+    auto *dst_tensor = const_cast<phi::SelectedRows *>(
+        dynamic_cast<const phi::SelectedRows *>(tensor->impl().get()));
+    *dst_tensor = src_tensor;
+  } else if (var.IsType<paddle::framework::VariableRefArray>()) {
+    auto &src_tensor = var.Get<paddle::framework::VariableRefArray>();
+    auto *dst_tensor = const_cast<paddle::framework::VariableRefArray *>(
+        dynamic_cast<const paddle::framework::VariableRefArray *>(
+            tensor->impl().get()));
+    *dst_tensor = src_tensor;
+  } else {
+    PADDLE_THROW(phi::errors::InvalidArgument(
+        "The RunProgram(Grad)Op only support output "
+        "variable of type DenseTensor, SelectedRows or VariableRefArray",
+        tensor->name()));
+  }
+}
+
 static void ShareTensorsFromScopeByValue(
     const std::vector<Tensor *> &tensors,
     const std::vector<::pir::Value> &values,
@@ -238,30 +271,48 @@ static void ShareTensorsFromScopeByValue(
                               "RunProgram(Grad)Op'"
                               "s internal scope.",
                               name));
-    CheckOutputVarStatus(*var, *tensors[i]);
-    // share tensor
-    if (var->IsType<phi::DenseTensor>()) {
-      auto &src_tensor = var->Get<phi::DenseTensor>();
-      auto *dst_tensor = const_cast<phi::DenseTensor *>(
-          dynamic_cast<const phi::DenseTensor *>(tensors[i]->impl().get()));
-      VLOG(2) << "actually do sharing " << name << " from scope";
-      *dst_tensor = src_tensor;
-    } else if (var->IsType<phi::SelectedRows>()) {
-      auto &src_tensor = var->Get<phi::SelectedRows>();
-      auto *dst_tensor = const_cast<phi::SelectedRows *>(
-          dynamic_cast<const phi::SelectedRows *>(tensors[i]->impl().get()));
-      *dst_tensor = src_tensor;
-    } else if (var->IsType<paddle::framework::VariableRefArray>()) {
-      auto &src_tensor = var->Get<paddle::framework::VariableRefArray>();
-      auto *dst_tensor = const_cast<paddle::framework::VariableRefArray *>(
-          dynamic_cast<const paddle::framework::VariableRefArray *>(
-              tensors[i]->impl().get()));
-      *dst_tensor = src_tensor;
+    ShareTensorFromVar(*var, tensors[i]);
+  }
+}
+
+// Appends the variables of the values in the scope to vars, nullptr for the
+// values which are skipped in sharing, after the values have been shared by
+// name once.
+static void BindVarsByValue(const std::vector<::pir::Value> &values,
+                            paddle::framework::Scope *scope,
+                            std::vector<paddle::framework::Variable *> *vars) {
+  auto names = GetNameFromValue(values);
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (values[i].impl() == nullptr ||
+        names[i] == paddle::framework::kFakeVarName ||
+        names[i] == paddle::framework::kEmptyVarName) {
+      vars->push_back(nullptr);
     } else {
-      PADDLE_THROW(phi::errors::InvalidArgument(
-          "The RunProgram(Grad)Op only support output "
-          "variable of type DenseTensor, SelectedRows or VariableRefArray",
-          name));
+      vars->push_back(scope->FindVar(names[i]));
+    }
+  }
+}
+
+// Shares the tensors into the bound variables from vars[offset].
+static void ShareTensorsIntoVars(
+    const std::vector<Tensor> &tensors,
+    const std::vector<paddle::framework::Variable *> &vars,
+    size_t offset) {
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    if (vars[offset + i] != nullptr) {
+      ShareTensorIntoVar(tensors[i], vars[offset + i]);
+    }
+  }
+}
+
+// Shares the tensors from the bound variables from vars[offset].
+static void ShareTensorsFromVars(
+    const std::vector<Tensor *> &tensors,
+    const std::vector<paddle::framework::Variable *> &vars,
+    size_t offset) {
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    if (vars[offset + i] != nullptr) {
+      ShareTensorFromVar(*vars[offset + i], tensors[i]);
     }
   }
 }
@@ -407,18 +458,16 @@ inline void PirRunProgramAPI(
 
   VLOG(4) << "global_inner_scope:" << global_inner_scope;
 
-  auto input_values =
+  const auto &input_values =
       PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("fx"));
-  auto output_values =
+  const auto &output_values =
       PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("fo"));
-  auto middle_values =
-      PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("fm"));
-  auto param_values =
+  const auto &param_values =
       PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("fp"));
 
-  std::shared_ptr<::pir::Program> forward_program = PADDLE_GET_CONST(
+  const auto &forward_program = PADDLE_GET_CONST(
       std::shared_ptr<::pir::Program>, attrs.at("forward_program"));
-  std::shared_ptr<::pir::Program> backward_program = PADDLE_GET_CONST(
+  const auto &backward_program = PADDLE_GET_CONST(
       std::shared_ptr<::pir::Program>, attrs.at("backward_program"));
 
   if (FLAGS_print_ir) {
@@ -439,11 +488,12 @@ inline void PirRunProgramAPI(
   auto &cache = paddle::framework::InterpreterCoreInfoCache::Instance();
   std::shared_ptr<paddle::framework::InterpreterCore> interpreter_core =
       nullptr;
-  if (!cache.Has(program_id,
-                 global_inner_scope,
-                 place_hash_key,
-                 /*is_grad=*/false,
-                 /*in_pir_mode=*/true)) {
+  auto *cached_value = cache.Find(program_id,
+                                  global_inner_scope,
+                                  place_hash_key,
+                                  /*is_grad=*/false,
+                                  /*in_pir_mode=*/true);
+  if (cached_value == nullptr) {
     paddle::platform::RecordEvent record_event(
         "create_new_interpretercore",
         paddle::platform::TracerEventType::UserDefined,
@@ -495,6 +545,17 @@ inline void PirRunProgramAPI(
     details::print_collection(skip_names_set);
     interpreter_core->SetSkipGcVars(skip_names_set);
 
+    // Step 4. bind the shared inputs & parameters for the cached runs
+    cached_value = &cache.GetMutable(program_id,
+                                     global_inner_scope,
+                                     place_hash_key,
+                                     /*is_grad=*/false,
+                                     /*in_pir_mode=*/true);
+    details::BindVarsByValue(
+        input_values, global_inner_scope, &cached_value->input_vars_);
+    details::BindVarsByValue(
+        param_values, global_inner_scope, &cached_value->input_vars_);
+
     // std::set<std::string> input_vars;
     // input_vars.insert(input_names.begin(), input_names.end());
     // interpreter_core->SetJitInputVars(input_vars);
@@ -508,16 +569,11 @@ inline void PirRunProgramAPI(
         1);
     VLOG(2) << "Get interpretercore cache by program:" << program_id;
     // Step 1. get cache interpretercore
-    auto &cached_value = cache.GetMutable(program_id,
-                                          global_inner_scope,
-                                          place_hash_key,
-                                          /*is_grad=*/false,
-                                          /*in_pir_mode=*/true);
-    interpreter_core = cached_value.core_;
-    // Step 2. update scope for cache interpretercore
-    details::ShareTensorsIntoScopeByValue(x, input_values, global_inner_scope);
-    details::ShareTensorsIntoScopeByValue(
-        params, param_values, global_inner_scope);
+    interpreter_core = cached_value->core_;
+    // Step 2. update scope for cache interpretercore by the bound variables
+    details::ShareTensorsIntoVars(x, cached_value->input_vars_, 0);
+    details::ShareTensorsIntoVars(
+        params, cached_value->input_vars_, input_values.size());
     // TODO(xiongkun): new ir how to build scope.
     // if (interpreter_core->GetVariableScope()->GetMutableScope() !=
     // global_inner_scope) {
@@ -540,9 +596,17 @@ inline void PirRunProgramAPI(
   {
     paddle::platform::RecordEvent record_event(
         "fetch_and_gc", paddle::platform::TracerEventType::UserDefined, 1);
-    // Get Output, and Middle Outputs
-    details::ShareTensorsFromScopeByValue(
-        out, output_values, global_inner_scope);
+    // Get Output, and Middle Outputs, which exist in scope after the first
+    // run
+    if (cached_value->output_vars_.size() != output_values.size()) {
+      details::ShareTensorsFromScopeByValue(
+          out, output_values, global_inner_scope);
+      cached_value->output_vars_.clear();
+      details::BindVarsByValue(
+          output_values, global_inner_scope, &cached_value->output_vars_);
+    } else {
+      details::ShareTensorsFromVars(out, cached_value->output_vars_, 0);
+    }
 
     VLOG(3) << paddle::framework::GenScopeTreeDebugInfo(out_scope_vec->front());
 
@@ -981,38 +1045,31 @@ inline void PirRunProgramGradAPI(
 
   VLOG(4) << "global_inner_scope:" << global_inner_scope;
 
-  std::shared_ptr<::pir::Program> backward_program = PADDLE_GET_CONST(
+  const auto &backward_program = PADDLE_GET_CONST(
       std::shared_ptr<::pir::Program>, attrs.at("backward_program"));
 
-  auto output_grad_values =
+  const auto &output_grad_values =
       PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bo_g"));
-  auto forward_input_values =
-      PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bx"));
-  auto forward_middle_values =
-      PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bm"));
-  auto parameter_values =
-      PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bp"));
-  auto forward_output_values =
-      PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bo"));
-  auto x_grad_values =
+  const auto &x_grad_values =
       PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bx_g"));
-  auto p_grad_values =
+  const auto &p_grad_values =
       PADDLE_GET_CONST(std::vector<::pir::Value>, attrs.at("bp_g"));
 
   details::Trans2ContiguousTensorsInplace(out_grad);
 
-  // share x, param, middles, output_grads, out into scope.
-  details::ShareTensorsIntoScopeByValue(
-      out_grad, output_grad_values, global_inner_scope);
-
   auto &cache = paddle::framework::InterpreterCoreInfoCache::Instance();
   std::shared_ptr<paddle::framework::InterpreterCore> interpreter_core =
       nullptr;
-  if (!cache.Has(program_id,
-                 global_inner_scope,
-                 place_hash_key,
-                 /*is_grad=*/true,
-                 /*in_pir_mode=*/true)) {
+  auto *cached_value = cache.Find(program_id,
+                                  global_inner_scope,
+                                  place_hash_key,
+                                  /*is_grad=*/true,
+                                  /*in_pir_mode=*/true);
+  if (cached_value == nullptr) {
+    // share x, param, middles, output_grads, out into scope.
+    details::ShareTensorsIntoScopeByValue(
+        out_grad, output_grad_values, global_inner_scope);
+
     paddle::platform::RecordEvent record_event(
         "create_new_interpretercore",
         paddle::platform::TracerEventType::UserDefined,
@@ -1042,18 +1099,13 @@ inline void PirRunProgramGradAPI(
     // share threadpool
     // NOTE(zhiqiu): this only works interpreter_core is executed strictly
     // after the related fwd_interpreter_core.
-    if (cache.Has(program_id,
-                  global_inner_scope,
-                  place_hash_key,
-                  /*is_grad=*/false,
-                  /*in_pir_mode=*/true)) {
-      auto fwd_interpreter_core = cache
-                                      .GetMutable(program_id,
-                                                  global_inner_scope,
-                                                  place_hash_key,
-                                                  /*is_grad=*/false,
-                                                  /*in_pir_mode=*/true)
-                                      .core_;
+    auto *fwd_cached_value = cache.Find(program_id,
+                                        global_inner_scope,
+                                        place_hash_key,
+                                        /*is_grad=*/false,
+                                        /*in_pir_mode=*/true);
+    if (fwd_cached_value != nullptr) {
+      auto fwd_interpreter_core = fwd_cached_value->core_;
       interpreter_core->ShareWorkQueueFrom(fwd_interpreter_core);
       VLOG(4) << "Share workqueue from " << fwd_interpreter_core.get() << " to "
               << interpreter_core.get();
@@ -1074,18 +1126,23 @@ inline void PirRunProgramGradAPI(
                                     skip_eager_delete_vars);
     VLOG(2) << "Get skip GC vars size is: " << skip_eager_delete_vars.size();
     details::print_collection(skip_eager_delete_vars);
+
+    // bind the shared output_grads for the cached runs
+    cached_value = &cache.GetMutable(program_id,
+                                     global_inner_scope,
+                                     place_hash_key,
+                                     /*is_grad=*/true,
+                                     /*in_pir_mode=*/true);
+    details::BindVarsByValue(
+        output_grad_values, global_inner_scope, &cached_value->input_vars_);
   } else {
     paddle::platform::RecordEvent record_event(
         "get_interpretercore_cache",
         paddle::platform::TracerEventType::UserDefined,
         1);
     VLOG(2) << "Get interpretercore cache by program:" << program_id;
-    auto &cached_value = cache.GetMutable(program_id,
-                                          global_inner_scope,
-                                          place_hash_key,
-                                          /*is_grad=*/true,
-                                          /*in_pir_mode=*/true);
-    interpreter_core = cached_value.core_;
+    interpreter_core = cached_value->core_;
+    details::ShareTensorsIntoVars(out_grad, cached_value->input_vars_, 0);
 
     if (interpreter_core->GetVariableScope()->GetMutableScope() !=
         global_inner_scope) {
@@ -1110,11 +1167,23 @@ inline void PirRunProgramGradAPI(
   {
     paddle::platform::RecordEvent record_event(
         "fetch_and_gc", paddle::platform::TracerEventType::UserDefined, 1);
-    // Step 4. get outputs
-    details::ShareTensorsFromScopeByValue(
-        x_grad, x_grad_values, global_inner_scope);
-    details::ShareTensorsFromScopeByValue(
-        params_grad, p_grad_values, global_inner_scope);
+    // Step 4. get outputs, which exist in scope after the first run
+    if (cached_value->output_vars_.size() !=
+        x_grad_values.size() + p_grad_values.size()) {
+      details::ShareTensorsFromScopeByValue(
+          x_grad, x_grad_values, global_inner_scope);
+      details::ShareTensorsFromScopeByValue(
+          params_grad, p_grad_values, global_inner_scope);
+      cached_value->output_vars_.clear();
+      details::BindVarsByValue(
+          x_grad_values, global_inner_scope, &cached_value->output_vars_);
+      details::BindVarsByValue(
+          p_grad_values, global_inner_scope, &cached_value->output_vars_);
+    } else {
+      details::ShareTensorsFromVars(x_grad, cached_value->output_vars_, 0);
+      details::ShareTensorsFromVars(
+          params_grad, cached_value->output_vars_, x_grad_values.size());
+    }
     VLOG(4) << "after backward gc all vars";
     global_inner_scope->SetCanReused(true);
     details::GcScope(global_inner_scope);
@@ -0,0 +1,343 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// A bounded multi-producer multi-consumer channel on a ring of cells, which
+// has the blocking Read/Write interface of ChannelObject. A batch claims its
+// cells with one compare-and-swap on the write or the read position and the
+// cells are handed over by their sequence numbers, so the readers and the
+// writers of a busy channel do not serialize on a mutex. A waiting side
+// retries spin_count times before it sleeps on a condition variable, the
+// mutex is only taken to sleep and to wake the sleepers.
+//
+// Unlike ChannelObject its capacity is fixed at construction time and is
+// rounded up to a power of two.
+template <class T>
+class BoundedChannelObject {
+ public:
+  explicit BoundedChannelObject(size_t capacity, size_t spin_count = 1024)
+      : spin_count_(spin_count) {
+    CHECK(capacity >= 1) << "capacity must be >= 1";
+    capacity_ = 1;
+    while (capacity_ < capacity) {
+      capacity_ <<= 1;
+    }
+    mask_ = capacity_ - 1;
+    cells_.reset(new Cell[capacity_]);
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+  size_t BlockSize() { return block_size_; }
+
+  void SetBlockSize(size_t x) {
+    CHECK(x >= 1) << "block size must be >= 1";
+    block_size_ = x;
+  }
+
+  size_t SpinCount() { return spin_count_; }
+
+  void SetSpinCount(size_t x) { spin_count_ = x; }
+
+  bool Closed() { return closed_.load(std::memory_order_acquire); }
+
+  // open channel, then data can be write() to channel
+  void Open() {
+    closed_.store(false, std::memory_order_release);
+    NotifyAll();
+  }
+
+  // close channel, then no more data can be write() to channel
+  void Close() {
+    closed_.store(true, std::memory_order_release);
+    NotifyAll();
+  }
+
+  // the number of the elements claimed by the writers and not yet claimed by
+  // the readers
+  size_t Size() {
+    size_t read_pos = read_pos_.load(std::memory_order_acquire);
+    size_t write_pos = write_pos_.load(std::memory_order_acquire);
+    return write_pos > read_pos ? write_pos - read_pos : 0;
+  }
+
+  bool Empty() { return Size() == 0; }
+
+  // blocking operation
+  bool Get(T& val) { return Read(1, &val) != 0; }  // NOLINT
+
+  // blocking operation
+  // returns 0 if the channel is closed and empty
+  size_t Read(size_t n, T* p) { return Read(n, p, false); }
+
+  // blocking operation
+  bool Put(T&& val) { return WriteMove(1, &val) != 0; }
+
+  // blocking operation
+  bool Put(const T& val) { return Write(1, &val) != 0; }
+
+  // blocking operation
+  // returns value less than n if the channel is closed
+  size_t Write(size_t n, const T* p) {
+    return Write(n, [p](size_t i) -> const T& { return p[i]; });
+  }
+
+  // WriteMove() will clear original contents of input array
+  size_t WriteMove(size_t n, T* p) {
+    return Write(n, [p](size_t i) -> T&& { return std::move(p[i]); });
+  }
+
+  // read data of block size from channel to vector
+  size_t Read(std::vector<T>& p) {  // NOLINT
+    p.resize(block_size_);
+    size_t finished = Read(p.size(), p.data());
+    p.resize(finished);
+    return finished;
+  }
+
+  // read once only
+  size_t ReadOnce(std::vector<T>& p, size_t size) {  // NOLINT
+    p.resize(size);
+    size_t finished = Read(size, p.data(), true);
+    p.resize(finished);
+    return finished;
+  }
+
+  size_t ReadAll(std::vector<T>& p) {  // NOLINT
+    p.clear();
+    size_t finished = 0;
+    size_t n = 0;
+    do {
+      n = block_size_;
+      p.resize(finished + n);
+      n = Read(n, &p[finished]);
+      finished += n;
+    } while (n != 0);
+    p.resize(finished);
+    return finished;
+  }
+
+  // write data from vector to channel
+  size_t Write(const std::vector<T>& p) { return Write(p.size(), p.data()); }
+
+  // write data from vector to channel
+  size_t Write(std::vector<T>&& p) { return WriteMove(p.size(), p.data()); }
+
+ private:
+  struct Cell {
+    // equals to the position of the cell when it can be written, and to the
+    // position + 1 when it can be read
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  size_t capacity_ = 1;
+  size_t mask_ = 0;
+  size_t block_size_ = 1024;
+  size_t spin_count_;
+  std::unique_ptr<Cell[]> cells_;
+  std::atomic<bool> closed_{false};
+
+  alignas(64) std::atomic<size_t> write_pos_{0};
+  alignas(64) std::atomic<size_t> read_pos_{0};
+
+  alignas(64) std::mutex mutex_;
+  std::atomic<int> empty_waiters_{0};
+  std::atomic<int> full_waiters_{0};
+  std::condition_variable empty_cond_;
+  std::condition_variable full_cond_;
+
+  // claims at most n cells to write, returns the number of the cells claimed
+  // and their first position
+  size_t ClaimWrite(size_t n, size_t* pos) {
+    size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      size_t read_pos = read_pos_.load(std::memory_order_acquire);
+      if (read_pos > write_pos) {
+        // write_pos is stale
+        write_pos = write_pos_.load(std::memory_order_relaxed);
+        continue;
+      }
+      size_t size = write_pos - read_pos;
+      if (size >= capacity_) {
+        return 0;
+      }
+      size_t m = (std::min)(n, capacity_ - size);
+      if (write_pos_.compare_exchange_weak(write_pos,
+                                           write_pos + m,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+        *pos = write_pos;
+        return m;
+      }
+    }
+  }
+
+  // claims at most n cells to read, returns the number of the cells claimed
+  // and their first position
+  size_t ClaimRead(size_t n, size_t* pos) {
+    size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      size_t write_pos = write_pos_.load(std::memory_order_acquire);
+      if (write_pos <= read_pos) {
+        return 0;
+      }
+      size_t m = (std::min)(n, write_pos - read_pos);
+      if (read_pos_.compare_exchange_weak(read_pos,
+                                          read_pos + m,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed)) {
+        *pos = read_pos;
+        return m;
+      }
+    }
+  }
+
+  // the claimed cell is released by the other side shortly, since the
+  // positions are claimed before the cells are handed over
+  static void WaitForSeq(const Cell& cell, size_t seq) {
+    while (cell.seq.load(std::memory_order_acquire) != seq) {
+      std::this_thread::yield();
+    }
+  }
+
+  template <class Getter>
+  size_t Write(size_t n, Getter&& get) {
+    size_t finished = 0;
+    size_t spins = 0;
+    while (finished < n && !Closed()) {
+      size_t pos = 0;
+      size_t m = ClaimWrite(n - finished, &pos);
+      if (m == 0) {
+        if (spins++ < spin_count_) {
+          std::this_thread::yield();
+          continue;
+        }
+        spins = 0;
+        Wait(&full_waiters_, &full_cond_, [this] {
+          return Size() < capacity_ || Closed();
+        });
+        continue;
+      }
+      for (size_t i = 0; i < m; ++i) {
+        Cell& cell = cells_[(pos + i) & mask_];
+        WaitForSeq(cell, pos + i);
+        cell.value = get(finished + i);
+        cell.seq.store(pos + i + 1, std::memory_order_release);
+      }
+      finished += m;
+      spins = 0;
+      Notify(&empty_waiters_, &empty_cond_);
+    }
+    return finished;
+  }
+
+  size_t Read(size_t n, T* p, bool once) {
+    size_t finished = 0;
+    size_t spins = 0;
+    while (finished < n) {
+      size_t pos = 0;
+      size_t m = ClaimRead(n - finished, &pos);
+      if (m == 0) {
+        if (Closed() && Empty()) {
+          break;
+        }
+        if (spins++ < spin_count_) {
+          std::this_thread::yield();
+          continue;
+        }
+        spins = 0;
+        Wait(&empty_waiters_, &empty_cond_, [this] {
+          return !Empty() || Closed();
+        });
+        continue;
+      }
+      for (size_t i = 0; i < m; ++i) {
+        Cell& cell = cells_[(pos + i) & mask_];
+        WaitForSeq(cell, pos + i + 1);
+        p[finished + i] = std::move(cell.value);
+        cell.seq.store(pos + i + capacity_, std::memory_order_release);
+      }
+      finished += m;
+      spins = 0;
+      Notify(&full_waiters_, &full_cond_);
+      if (once) {
+        break;
+      }
+    }
+    if (!Empty()) {
+      // the elements left may be waited by the other readers
+      Notify(&empty_waiters_, &empty_cond_);
+    }
+    return finished;
+  }
+
+  template <class Pred>
+  void Wait(std::atomic<int>* waiters,
+            std::condition_variable* cond,
+            Pred&& pred) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters->fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cond->wait(lock, pred);
+    waiters->fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void Notify(std::atomic<int>* waiters, std::condition_variable* cond) {
+    // pairs with the increment of the waiters, so that either the waiter
+    // sees the cells handed over or the notifier sees the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters->load(std::memory_order_relaxed) != 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cond->notify_one();
+    }
+  }
+
+  void NotifyAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    empty_cond_.notify_all();
+    full_cond_.notify_all();
+  }
+};  // NOLINT
+
+template <class T>
+using BoundedChannel = std::shared_ptr<BoundedChannelObject<T>>;
+
+template <class T>
+BoundedChannel<T> MakeBoundedChannel(size_t capacity,
+                                     size_t spin_count = 1024) {
+  return std::make_shared<BoundedChannelObject<T>>(capacity, spin_count);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -19,7 +19,10 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_feed.h"
 
+#include <limits>
+
 #include "paddle/fluid/framework/fleet/ps_gpu_wrapper.h"
+#include "paddle/fluid/framework/slot_parser.h"
 #ifdef _LINUX
 #include <stdio_ext.h>
 #include <sys/mman.h>
@@ -31,6 +34,8 @@ limitations under the License. */
 
 USE_INT_STAT(STAT_total_feasign_num_in_mem);
 COMMON_DECLARE_bool(enable_ins_parser_file);
+COMMON_DECLARE_bool(enable_slotrecord_gpu_resident_pass);
+COMMON_DECLARE_bool(graph_prefetch_batch);
 namespace paddle::framework {
 
 DLManager& global_dlmanager_pool() {
@@ -54,10 +59,12 @@ class BufferedLineFileReader {
 
  public:
   typedef std::function<bool(const std::string&)> LineFunc;
+  // the line is not nul terminated when it points into the read buffer
+  typedef std::function<bool(const char*, size_t)> LineViewFunc;
 
  private:
   template <typename T>
-  int read_lines(T* reader, LineFunc func, int skip_lines) {
+  int read_lines(T* reader, LineViewFunc func, int skip_lines) {
     int lines = 0;
     size_t ret = 0;
     char* ptr = nullptr;
@@ -66,24 +73,31 @@ class BufferedLineFileReader {
     error_line_ = 0;
 
     SampleFunc spfunc = get_sample_func();
+    // the line across two reads, the others are passed in place
     std::string x;
     while (!is_error() && (ret = reader->read(buff_, MAX_FILE_BUFF_SIZE)) > 0) {
       total_len_ += ret;
       ptr = buff_;
       eol = reinterpret_cast<char*>(memchr(ptr, '\n', ret));
       while (eol != nullptr) {
-        int size = static_cast<int>((eol - ptr) + 1);
-        x.append(ptr, size - 1);
+        size_t size = eol - ptr;
         ++lines;
         if (lines > skip_lines && spfunc()) {
-          if (!func(x)) {
+          bool ok = false;
+          if (x.empty()) {
+            ok = func(ptr, size);
+          } else {
+            x.append(ptr, size);
+            ok = func(x.data(), x.size());
+          }
+          if (!ok) {
             ++error_line_;
           }
         }
 
         x.clear();
-        ptr += size;
-        ret -= size;
+        ptr += size + 1;
+        ret -= size + 1;
         eol = reinterpret_cast<char*>(memchr(ptr, '\n', ret));
       }
       if (ret > 0) {
@@ -93,7 +107,7 @@ class BufferedLineFileReader {
     if (!is_error() && !x.empty()) {
       ++lines;
       if (lines > skip_lines && spfunc()) {
-        if (!func(x)) {
+        if (!func(x.data(), x.size())) {
           ++error_line_;
         }
       }
@@ -113,6 +127,17 @@ class BufferedLineFileReader {
   ~BufferedLineFileReader() { free(buff_); }  // NOLINT
 
   int read_file(FILE* fp, LineFunc func, int skip_lines) {
+    FILEReader reader(fp);
+    std::string line;
+    return read_lines<FILEReader>(
+        &reader,
+        [&line, &func](const char* str, size_t len) {
+          line.assign(str, len);
+          return func(line);
+        },
+        skip_lines);
+  }
+  int read_file(FILE* fp, LineViewFunc func, int skip_lines) {
     FILEReader reader(fp);
     return read_lines<FILEReader>(&reader, func, skip_lines);
   }
@@ -2129,6 +2154,7 @@ void SlotRecordInMemoryDataFeed::Init(const DataFeedDesc& data_feed_desc) {
   pipe_command_ = data_feed_desc.pipe_command();
   finish_init_ = true;
   input_type_ = data_feed_desc.input_type();
+  binary_format_ = data_feed_desc.binary_format();
   size_t pos = pipe_command_.find(".so");
   if (pos != std::string::npos) {  // NOLINT
     pos = pipe_command_.rfind('|');
@@ -2171,7 +2197,9 @@ void SlotRecordInMemoryDataFeed::InitGraphTrainResource() {
 
 void SlotRecordInMemoryDataFeed::LoadIntoMemory() {
   VLOG(3) << "SlotRecord LoadIntoMemory() begin, thread_id=" << thread_id_;
-  if (!so_parser_name_.empty()) {
+  if (binary_format_) {
+    LoadIntoMemoryByBinary();
+  } else if (!so_parser_name_.empty()) {
     LoadIntoMemoryByLib();
   } else {
     LoadIntoMemoryByCommand();
@@ -2380,12 +2408,14 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
 
       lines = line_reader.read_file(
           this->fp_.get(),
-          [this, &record_vec, &offset, &filename](const std::string& line) {
-            if (ParseOneInstance(line, &record_vec[offset])) {
+          [this, &record_vec, &offset, &filename](const char* str,
+                                                  size_t len) {
+            if (ParseOneInstance(str, len, &record_vec[offset])) {
               ++offset;
             } else {
               LOG(WARNING) << "read file:[" << filename
-                           << "] item error, line:[" << line << "]";
+                           << "] item error, line:[" << std::string(str, len)
+                           << "]";
               return false;
             }
             if (offset >= OBJPOOL_BLOCK_SIZE) {
@@ -2421,6 +2451,49 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
 #endif
 }
 
+void SlotRecordInMemoryDataFeed::LoadIntoMemoryByBinary() {
+#ifdef _LINUX
+  std::string filename;
+  while (this->PickOneFile(&filename)) {
+    VLOG(3) << "PickOneFile, filename=" << filename
+            << ", thread_id=" << thread_id_;
+    platform::Timer timeline;
+    timeline.Start();
+    int err_no = 0;
+    this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_, true);
+    CHECK(this->fp_ != nullptr);
+    __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
+    size_t records = 0;
+    SlotRecordBlockHeader header;
+    while (ReadSlotRecordBlockHeader(this->fp_.get(), &header)) {
+      std::vector<SlotRecord> record_vec;
+      bool is_ok = header.record_num > 0;
+      if (is_ok) {
+        SlotRecordPool().get(&record_vec, header.record_num);
+        is_ok = ReadSlotRecordBlock(this->fp_.get(), header, &record_vec[0]);
+        if (!is_ok) {
+          SlotRecordPool().put(&record_vec);
+        }
+      }
+      PADDLE_ENFORCE_EQ(is_ok,
+                        true,
+                        common::errors::InvalidArgument(
+                            "Invalid slot record block in file %s after %d "
+                            "records.",
+                            filename,
+                            records));
+      records += header.record_num;
+      input_channel_->Write(std::move(record_vec));
+    }
+    timeline.Pause();
+    VLOG(3) << "LoadIntoMemoryByBinary() read all blocks, file=" << filename
+            << ", records=" << records
+            << ", cost time=" << timeline.ElapsedSec()
+            << " seconds, thread_id=" << thread_id_;
+  }
+#endif
+}
+
 static void parser_log_key(const std::string& log_key,
                            uint64_t* search_id,
                            uint32_t* cmatch,
@@ -2436,11 +2509,17 @@ static void parser_log_key(const std::string& log_key,
 
 bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
                                                   SlotRecord* ins) {
+  return ParseOneInstance(line.data(), line.size(), ins);
+}
+
+bool SlotRecordInMemoryDataFeed::ParseOneInstance(const char* str,
+                                                  size_t len,
+                                                  SlotRecord* ins) {
   SlotRecord& rec = (*ins);
   // parse line
-  const char* str = line.c_str();
-  char* endptr = const_cast<char*>(str);
-  int pos = 0;
+  const char* end = str + len;
+  const char* p = str;
+  uint64_t num = 0;
 
   thread_local std::vector<std::vector<float>> slot_float_feasigns;
   thread_local std::vector<std::vector<uint64_t>> slot_uint64_feasigns;
@@ -2448,26 +2527,21 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   slot_uint64_feasigns.resize(uint64_use_slot_size_);
 
   if (parse_ins_id_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
-    CHECK(num == 1);  // NOLINT
-    pos = static_cast<int>(endptr - str + 1);
-    size_t len = 0;
-    while (str[pos + len] != ' ') {
-      ++len;
-    }
-    rec->ins_id_ = std::string(str + pos, len);
-    pos += static_cast<int>(len + 1);
+    p = ParseSlotUint64(p, end, &num);
+    CHECK(p != nullptr && num == 1);  // NOLINT
+    const char* token = SkipSlotSpaces(p, end);
+    p = SkipSlotTokens(p, end, 1);
+    CHECK(p != nullptr);  // NOLINT
+    rec->ins_id_.assign(token, p - token);
   }
   if (parse_logkey_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
-    CHECK(num == 1);  // NOLINT
-    pos = static_cast<int>(endptr - str + 1);
-    size_t len = 0;
-    while (str[pos + len] != ' ') {
-      ++len;
-    }
+    p = ParseSlotUint64(p, end, &num);
+    CHECK(p != nullptr && num == 1);  // NOLINT
+    const char* token = SkipSlotSpaces(p, end);
+    p = SkipSlotTokens(p, end, 1);
+    CHECK(p != nullptr);  // NOLINT
     // parse_logkey
-    std::string log_key = std::string(str + pos, len);
+    std::string log_key(token, p - token);
     uint64_t search_id = 0;
     uint32_t cmatch = 0;
     uint32_t rank = 0;
@@ -2477,26 +2551,32 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
     rec->search_id = search_id;
     rec->cmatch = cmatch;
     rec->rank = rank;
-    pos += static_cast<int>(len + 1);
   }
 
   int float_total_slot_num = 0;
   int uint64_total_slot_num = 0;
 
   for (auto& info : all_slots_info_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    p = ParseSlotUint64(p, end, &num);
+    if (p == nullptr) {
+      return false;
+    }
     PADDLE_ENFORCE(num,
                    "The number of ids can not be zero, you need padding "
                    "it in data generator; or if there is something wrong with "
                    "the data, please check if the data contains unresolvable "
                    "characters.\nplease check this error line: %s",
-                   str);
+                   std::string(str, len));
     if (info.used_idx != -1) {
       if (info.type[0] == 'f') {  // float
         auto& slot_fea = slot_float_feasigns[info.slot_value_idx];
         slot_fea.clear();
-        for (int j = 0; j < num; ++j) {
-          float feasign = strtof(endptr, &endptr);
+        for (uint64_t j = 0; j < num; ++j) {
+          float feasign = 0;
+          p = ParseSlotFloat(p, end, &feasign);
+          if (p == nullptr) {
+            return false;
+          }
           if (fabs(feasign) < 1e-6 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
@@ -2506,20 +2586,20 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
       } else if (info.type[0] == 'u') {  // uint64
         auto& slot_fea = slot_uint64_feasigns[info.slot_value_idx];
         slot_fea.clear();
-        for (int j = 0; j < num; ++j) {
-          uint64_t feasign =
-              static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
+        for (uint64_t j = 0; j < num; ++j) {
+          uint64_t feasign = 0;
+          p = ParseSlotUint64(p, end, &feasign);
+          if (p == nullptr) {
+            return false;
+          }
           slot_fea.push_back(feasign);
           ++uint64_total_slot_num;
         }
       }
-      pos = static_cast<int>(endptr - str);
     } else {
-      for (int j = 0; j <= num; ++j) {
-        // pos = line.find_first_of(' ', pos + 1);
-        while (line[pos + 1] != ' ') {
-          pos++;
-        }
+      p = SkipSlotTokens(p, end, num);
+      if (p == nullptr) {
+        return false;
       }
     }
   }
@@ -2531,6 +2611,171 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   return (uint64_total_slot_num > 0);
 }
 
+template <typename T>
+static uint32_t GetSlotNum(const SlotValues<T>& values) {
+  return values.slot_offsets.empty()
+             ? 0
+             : static_cast<uint32_t>(values.slot_offsets.size() - 1);
+}
+
+template <typename T>
+static void AppendSlotColumns(const SlotValues<T>& values,
+                              std::vector<uint32_t>* sizes,
+                              std::vector<T>* column) {
+  const auto& offsets = values.slot_offsets;
+  for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+    sizes->push_back(offsets[i + 1] - offsets[i]);
+  }
+  if (!offsets.empty()) {
+    column->insert(column->end(),
+                   values.slot_values.begin(),
+                   values.slot_values.begin() + offsets.back());
+  }
+}
+
+template <typename T>
+static void FillSlotValues(uint32_t slot_num,
+                           const uint32_t** sizes,
+                           const T** column,
+                           SlotValues<T>* values) {
+  auto& offsets = values->slot_offsets;
+  offsets.resize(slot_num + 1);
+  offsets[0] = 0;
+  for (uint32_t i = 0; i < slot_num; ++i) {
+    offsets[i + 1] = offsets[i] + (*sizes)[i];
+  }
+  values->slot_values.assign(*column, *column + offsets[slot_num]);
+  *sizes += slot_num;
+  *column += offsets[slot_num];
+}
+
+template <typename T>
+static bool WriteColumn(FILE* fp, const T* data, size_t num) {
+  return num == 0 || fwrite(data, sizeof(T), num, fp) == num;
+}
+
+template <typename T>
+static bool ReadColumn(FILE* fp, size_t num, std::vector<T>* column) {
+  column->resize(num);
+  return num == 0 || fread(column->data(), sizeof(T), num, fp) == num;
+}
+
+static uint64_t SumSizes(const std::vector<uint32_t>& sizes) {
+  uint64_t sum = 0;
+  for (uint32_t size : sizes) {
+    sum += size;
+  }
+  return sum;
+}
+
+bool WriteSlotRecordBlock(FILE* fp, const SlotRecord* records, int num) {
+  if (num <= 0) {
+    return true;
+  }
+  SlotRecordBlockHeader header;
+  memset(&header, 0, sizeof(SlotRecordBlockHeader));
+  header.magic = SLOT_RECORD_BLOCK_MAGIC;
+  header.record_num = num;
+  header.uint64_slot_num = GetSlotNum(records[0]->slot_uint64_feasigns_);
+  header.float_slot_num = GetSlotNum(records[0]->slot_float_feasigns_);
+  thread_local std::vector<uint32_t> uint64_sizes, float_sizes, ins_id_sizes;
+  thread_local std::vector<uint64_t> uint64_values, search_ids;
+  thread_local std::vector<float> float_values;
+  thread_local std::vector<uint32_t> ranks, cmatches;
+  thread_local std::string ins_ids;
+  uint64_sizes.clear();
+  float_sizes.clear();
+  ins_id_sizes.clear();
+  uint64_values.clear();
+  search_ids.clear();
+  float_values.clear();
+  ranks.clear();
+  cmatches.clear();
+  ins_ids.clear();
+  for (int i = 0; i < num; ++i) {
+    const SlotRecord& rec = records[i];
+    if (GetSlotNum(rec->slot_uint64_feasigns_) != header.uint64_slot_num ||
+        GetSlotNum(rec->slot_float_feasigns_) != header.float_slot_num) {
+      return false;
+    }
+    AppendSlotColumns(
+        rec->slot_uint64_feasigns_, &uint64_sizes, &uint64_values);
+    AppendSlotColumns(rec->slot_float_feasigns_, &float_sizes, &float_values);
+    ins_id_sizes.push_back(static_cast<uint32_t>(rec->ins_id_.size()));
+    ins_ids.append(rec->ins_id_);
+    search_ids.push_back(rec->search_id);
+    ranks.push_back(rec->rank);
+    cmatches.push_back(rec->cmatch);
+  }
+  header.uint64_value_num = uint64_values.size();
+  header.float_value_num = float_values.size();
+  header.ins_id_bytes = ins_ids.size();
+  return WriteColumn(fp, &header, 1) &&
+         WriteColumn(fp, uint64_sizes.data(), uint64_sizes.size()) &&
+         WriteColumn(fp, uint64_values.data(), uint64_values.size()) &&
+         WriteColumn(fp, float_sizes.data(), float_sizes.size()) &&
+         WriteColumn(fp, float_values.data(), float_values.size()) &&
+         WriteColumn(fp, ins_id_sizes.data(), ins_id_sizes.size()) &&
+         WriteColumn(fp, ins_ids.data(), ins_ids.size()) &&
+         WriteColumn(fp, search_ids.data(), search_ids.size()) &&
+         WriteColumn(fp, ranks.data(), ranks.size()) &&
+         WriteColumn(fp, cmatches.data(), cmatches.size());
+}
+
+bool ReadSlotRecordBlockHeader(FILE* fp, SlotRecordBlockHeader* header) {
+  return fread(header, sizeof(SlotRecordBlockHeader), 1, fp) == 1;
+}
+
+bool ReadSlotRecordBlock(FILE* fp,
+                         const SlotRecordBlockHeader& header,
+                         SlotRecord* records) {
+  if (header.magic != SLOT_RECORD_BLOCK_MAGIC || header.record_num == 0) {
+    return false;
+  }
+  size_t num = header.record_num;
+  thread_local std::vector<uint32_t> uint64_sizes, float_sizes, ins_id_sizes;
+  thread_local std::vector<uint64_t> uint64_values, search_ids;
+  thread_local std::vector<float> float_values;
+  thread_local std::vector<uint32_t> ranks, cmatches;
+  thread_local std::vector<char> ins_ids;
+  bool is_ok =
+      ReadColumn(fp, num * header.uint64_slot_num, &uint64_sizes) &&
+      ReadColumn(fp, header.uint64_value_num, &uint64_values) &&
+      ReadColumn(fp, num * header.float_slot_num, &float_sizes) &&
+      ReadColumn(fp, header.float_value_num, &float_values) &&
+      ReadColumn(fp, num, &ins_id_sizes) &&
+      ReadColumn(fp, header.ins_id_bytes, &ins_ids) &&
+      ReadColumn(fp, num, &search_ids) && ReadColumn(fp, num, &ranks) &&
+      ReadColumn(fp, num, &cmatches);
+  if (!is_ok || SumSizes(uint64_sizes) != header.uint64_value_num ||
+      SumSizes(float_sizes) != header.float_value_num ||
+      SumSizes(ins_id_sizes) != header.ins_id_bytes) {
+    return false;
+  }
+  const uint32_t* uint64_size = uint64_sizes.data();
+  const uint32_t* float_size = float_sizes.data();
+  const uint64_t* uint64_value = uint64_values.data();
+  const float* float_value = float_values.data();
+  const char* ins_id = ins_ids.data();
+  for (size_t i = 0; i < num; ++i) {
+    SlotRecord& rec = records[i];
+    FillSlotValues(header.uint64_slot_num,
+                   &uint64_size,
+                   &uint64_value,
+                   &rec->slot_uint64_feasigns_);
+    FillSlotValues(header.float_slot_num,
+                   &float_size,
+                   &float_value,
+                   &rec->slot_float_feasigns_);
+    rec->ins_id_.assign(ins_id, ins_id_sizes[i]);
+    ins_id += ins_id_sizes[i];
+    rec->search_id = search_ids[i];
+    rec->rank = ranks[i];
+    rec->cmatch = cmatches[i];
+  }
+  return true;
+}
+
 void SlotRecordInMemoryDataFeed::AssignFeedVar(const Scope& scope) {
   CheckInit();
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
@@ -2721,6 +2966,7 @@ bool SlotRecordInMemoryDataFeed::Start() {
   this->finish_start_ = true;
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
   CHECK(phi::is_gpu_place(this->place_));
+  BuildRecordBlock();
   for (int i = 0; i < pack_thread_num_ + 1; i++) {
     auto pack = BatchGpuPackMgr().get(this->GetPlace(), used_slots_info_);
     pack_vec_.push_back(pack);
@@ -2749,7 +2995,13 @@ bool SlotRecordInMemoryDataFeed::Start() {
         auto batch_size = batch.second;
 
         paddle::platform::SetDeviceId(place_.GetDeviceId());
-        pack->pack_instance(&records_[offset], batch_size);
+        if (record_block_ != nullptr) {
+          pack->pack_from_block(record_block_.get(),
+                                block_batch_begins_[offset_index],
+                                batch_size);
+        } else {
+          pack->pack_instance(&records_[offset], batch_size);
+        }
         this->BuildSlotBatchGPU(batch_size, pack);
         using_pack_queue_.Push(pack);
       }
@@ -2758,9 +3010,21 @@ bool SlotRecordInMemoryDataFeed::Start() {
 #endif
 #if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
   if (gpu_graph_mode_) {
+    WaitGraphPrefetch();
     gpu_graph_data_generator_.SetFeedVec(feed_vec_);
     // adapt for dense feature
     gpu_graph_data_generator_.SetFeedInfo(&used_slots_info_);
+    for (size_t i = 0; i < graph_feed_buffers_.size(); ++i) {
+      graph_feed_buffers_[i].resize(feed_vec_.size());
+      graph_feed_buffer_ptrs_[i].assign(feed_vec_.size(), nullptr);
+      for (size_t j = 0; j < feed_vec_.size(); ++j) {
+        if (feed_vec_[j] != nullptr) {
+          graph_feed_buffer_ptrs_[i][j] = &graph_feed_buffers_[i][j];
+        }
+      }
+    }
+    graph_feed_buffer_idx_ = 0;
+    graph_prefetch_end_ = false;
   }
 #endif
   return true;
@@ -2785,6 +3049,9 @@ int SlotRecordInMemoryDataFeed::Next() {
       bool is_end = pack_is_end_.load();
       if (is_end) {
         if (using_pack_queue_.Size() == 0) {
+          // the batches are copied out of the block once they are packed
+          record_block_.reset();
+          block_records_.clear();
           return 0;
         }
       }
@@ -2812,7 +3079,7 @@ int SlotRecordInMemoryDataFeed::Next() {
   } else {
     VLOG(3) << "datafeed in gpu graph mode";
 #if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
-    this->batch_size_ = gpu_graph_data_generator_.GenerateBatch();
+    this->batch_size_ = NextGraphBatch();
 #endif
   }
 
@@ -2825,9 +3092,55 @@ int SlotRecordInMemoryDataFeed::Next() {
 #if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
 void SlotRecordInMemoryDataFeed::DoWalkandSage() {
   if (gpu_graph_mode_) {
+    WaitGraphPrefetch();
     gpu_graph_data_generator_.DoWalkandSage();
   }
 }
+
+int SlotRecordInMemoryDataFeed::NextGraphBatch() {
+  if (!FLAGS_graph_prefetch_batch ||
+      gpu_graph_data_generator_.GetMultiNodeMode()) {
+    return gpu_graph_data_generator_.GenerateBatch();
+  }
+  if (!graph_prefetch_future_.valid()) {
+    if (graph_prefetch_end_) {
+      return 0;
+    }
+    PrefetchGraphBatch();
+  }
+  int batch_size = graph_prefetch_future_.get();
+  // the feed tensors of the last batch are not used once Next is called, and
+  // the kernels reading them run before the next batch on the train stream
+  auto& staged = graph_feed_buffers_[graph_feed_buffer_idx_];
+  for (size_t i = 0; i < feed_vec_.size(); ++i) {
+    if (feed_vec_[i] != nullptr && staged[i].IsInitialized()) {
+      feed_vec_[i]->ShareDataWith(staged[i]);
+      feed_vec_[i]->set_lod(staged[i].lod());
+    }
+  }
+  graph_feed_buffer_idx_ ^= 1;
+  if (batch_size > 0) {
+    PrefetchGraphBatch();
+  } else {
+    graph_prefetch_end_ = true;
+  }
+  return batch_size;
+}
+
+void SlotRecordInMemoryDataFeed::PrefetchGraphBatch() {
+  gpu_graph_data_generator_.SetFeedVec(
+      graph_feed_buffer_ptrs_[graph_feed_buffer_idx_]);
+  graph_prefetch_future_ = std::async(std::launch::async, [this] {
+    return gpu_graph_data_generator_.GenerateBatch();
+  });
+}
+
+void SlotRecordInMemoryDataFeed::WaitGraphPrefetch() {
+  if (graph_prefetch_future_.valid()) {
+    // the batch generated ahead is dropped with the state of the pass
+    graph_prefetch_future_.get();
+  }
+}
 #endif
 
 void SlotRecordInMemoryDataFeed::DumpWalkPath(std::string dump_path,
@@ -2854,21 +3167,62 @@ void SlotRecordInMemoryDataFeed::DumpSampleNeighbors(std::string dump_path) {
 }
 
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
+void SlotRecordInMemoryDataFeed::BuildRecordBlock() {
+  record_block_.reset();
+  block_records_.clear();
+  block_batch_begins_.clear();
+  if (!FLAGS_enable_slotrecord_gpu_resident_pass || batch_offsets_.empty()) {
+    return;
+  }
+  size_t uint64_total_num = 0;
+  size_t float_total_num = 0;
+  block_batch_begins_.reserve(batch_offsets_.size());
+  for (auto& batch : batch_offsets_) {
+    block_batch_begins_.push_back(static_cast<int>(block_records_.size()));
+    for (int i = 0; i < batch.second; ++i) {
+      SlotRecord r = records_[batch.first + i];
+      uint64_total_num += r->slot_uint64_feasigns_.slot_values.size();
+      float_total_num += r->slot_float_feasigns_.slot_values.size();
+      block_records_.push_back(r);
+    }
+  }
+  // the block is indexed by int as the batches
+  size_t max_index = std::numeric_limits<int>::max();
+  size_t max_cols = std::max(uint64_use_slot_size_, float_use_slot_size_) + 1;
+  if (block_records_.empty() || uint64_total_num > max_index ||
+      float_total_num > max_index ||
+      block_records_.size() * max_cols > max_index) {
+    VLOG(0) << "Pack the batches on the host since the " << uint64_total_num
+            << " uint64 and " << float_total_num << " float feasigns of "
+            << block_records_.size() << " records do not fit in a block";
+    block_records_.clear();
+    block_batch_begins_.clear();
+    return;
+  }
+  record_block_ = std::make_unique<MiniBatchGpuPack>(
+      this->GetPlace(), used_slots_info_, 0);
+  record_block_->pack_block(block_records_.data(),
+                            static_cast<int>(block_records_.size()));
+  VLOG(3) << "Upload " << block_records_.size() << " records of "
+          << batch_offsets_.size() << " batches with " << uint64_total_num
+          << " uint64 and " << float_total_num << " float feasigns to "
+          << this->GetPlace();
+}
+
 void SlotRecordInMemoryDataFeed::BuildSlotBatchGPU(const int ins_num,
                                                    MiniBatchGpuPack* pack) {
   int offset_cols_size = (ins_num + 1);
   size_t slot_total_num = (use_slot_size_ * offset_cols_size);
   pack->resize_gpu_slot_offsets(slot_total_num * sizeof(size_t));
 
-  auto& value = pack->value();
   const UsedSlotGpuType* used_slot_gpu_types =
       static_cast<const UsedSlotGpuType*>(pack->get_gpu_slots());
   FillSlotValueOffset(ins_num,
                       use_slot_size_,
                       reinterpret_cast<size_t*>(pack->gpu_slot_offsets()),
-                      value.d_uint64_offset.data(),
+                      pack->uint64_offsets(),
                       uint64_use_slot_size_,
-                      value.d_float_offset.data(),
+                      pack->float_offsets(),
                       float_use_slot_size_,
                       used_slot_gpu_types,
                       pack->get_stream());
@@ -2954,13 +3308,13 @@ void SlotRecordInMemoryDataFeed::BuildSlotBatchGPU(const int ins_num,
                 use_slot_size_,
                 dest_gpu_p,
                 (const size_t*)pack->gpu_slot_offsets(),
-                (const uint64_t*)value.d_uint64_keys.data(),
-                (const int*)value.d_uint64_offset.data(),
-                (const int*)value.d_uint64_lens.data(),
+                pack->uint64_keys(),
+                pack->uint64_offsets(),
+                pack->uint64_lens(),
                 uint64_use_slot_size_,
-                (const float*)value.d_float_keys.data(),
-                (const int*)value.d_float_offset.data(),
-                (const int*)value.d_float_lens.data(),
+                pack->float_keys(),
+                pack->float_offsets(),
+                pack->float_lens(),
                 float_use_slot_size_,
                 used_slot_gpu_types,
                 pack->get_stream());
@@ -3251,6 +3605,8 @@ void MiniBatchGpuPack::pack_float_data(const SlotRecord* ins_vec, int num) {
 void MiniBatchGpuPack::pack_instance(const SlotRecord* ins_vec, int num) {
   ins_num_ = num;
   batch_ins_ = ins_vec;
+  block_ = nullptr;
+  block_begin_ = 0;
   CHECK(used_uint64_num_ > 0 || used_float_num_ > 0);
   // uint64 and float
   if (used_uint64_num_ > 0 && used_float_num_ > 0) {
@@ -3264,6 +3620,24 @@ void MiniBatchGpuPack::pack_instance(const SlotRecord* ins_vec, int num) {
   transfer_to_gpu();
 }
 
+void MiniBatchGpuPack::pack_block(const SlotRecord* ins_vec, int num) {
+  pack_instance(ins_vec, num);
+  // only the lens are used on the host to size the batches
+  buf_.h_uint64_keys.clear();
+  buf_.h_uint64_offset.clear();
+  buf_.h_float_keys.clear();
+  buf_.h_float_offset.clear();
+}
+
+void MiniBatchGpuPack::pack_from_block(MiniBatchGpuPack* block,
+                                       int begin,
+                                       int num) {
+  ins_num_ = num;
+  batch_ins_ = block->batch_ins_ + begin;
+  block_ = block;
+  block_begin_ = begin;
+}
+
 void MiniBatchGpuPack::transfer_to_gpu() {
   copy_host2device(&value_.d_uint64_lens, buf_.h_uint64_lens);
   copy_host2device(&value_.d_uint64_keys, buf_.h_uint64_keys);
@@ -19,6 +19,8 @@ limitations under the License. */
 #define _LINUX
 #endif
 
+#include <array>
+#include <cstdio>
 #include <fstream>
 #include <future>  // NOLINT
 #include <memory>
@@ -37,6 +39,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/channel.h"
 #include "paddle/fluid/framework/data_feed.pb.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/framework/fleet/heter_ps/hashtable_fwd.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable.h"
@@ -62,8 +65,6 @@ class Scope;
 class Variable;
 class NeighborSampleResult;
 class NodeQueryResult;
-template <typename KeyType, typename ValType>
-class HashTable;
 }  // namespace framework
 }  // namespace paddle
 
@@ -385,6 +386,33 @@ inline SlotObjPool& SlotRecordPool() {
   static SlotObjPool pool;
   return pool;
 }
+
+// The binary format of the parsed SlotRecords, which the data feed loads
+// without parsing them again. A file is a sequence of blocks, each block has
+// the header and the columns of its records: the slot sizes and the values of
+// the uint64 slots, the slot sizes and the values of the float slots, the
+// ins id sizes and bytes, and the search ids, ranks and cmatches. The blocks
+// are independent, so the files can be split and shuffled by the blocks.
+static const uint32_t SLOT_RECORD_BLOCK_MAGIC = 0x42525350;  // "PSRB"
+struct SlotRecordBlockHeader {
+  uint32_t magic;
+  uint32_t record_num;
+  uint32_t uint64_slot_num;
+  uint32_t float_slot_num;
+  uint64_t uint64_value_num;
+  uint64_t float_value_num;
+  uint64_t ins_id_bytes;
+};
+// Writes the records as a block, returns false on a write error or if the
+// records have different slot numbers.
+bool WriteSlotRecordBlock(FILE* fp, const SlotRecord* records, int num);
+// Reads the header of the next block, returns false at the end of the file.
+bool ReadSlotRecordBlockHeader(FILE* fp, SlotRecordBlockHeader* header);
+// Reads the block of the header into header.record_num records, returns false
+// if the block is truncated or corrupted.
+bool ReadSlotRecordBlock(FILE* fp,
+                         const SlotRecordBlockHeader& header,
+                         SlotRecord* records);
 struct PvInstanceObject {
   std::vector<Record*> ads;
   void merge_instance(Record* ins) { ads.push_back(ins); }
@@ -554,6 +582,13 @@ class MiniBatchGpuPack {
   void set_use_flag(bool is_use) { is_using_ = is_use; }
   void reset(const phi::Place& place);
   void pack_instance(const SlotRecord* ins_vec, int num);
+  // Packs the records of all the batches of a pass into the device memory
+  // once, the host copies of the feasigns are released after the upload.
+  void pack_block(const SlotRecord* ins_vec, int num);
+  // Refers to the records [begin, begin + num) of a block packed by
+  // pack_block instead of packing them on the host. The block should live
+  // until the batch is consumed.
+  void pack_from_block(MiniBatchGpuPack* block, int begin, int num);
   int ins_num() { return ins_num_; }
   int pv_num() { return pv_num_; }
   BatchGPUValue& value() { return value_; }
@@ -563,16 +598,55 @@ class MiniBatchGpuPack {
   }
   SlotRecord* get_records(void) { return &ins_vec_[0]; }
 
+  // the feasigns of the packed records on the device, the lens are the
+  // positions of the first feasigns of each record in the keys
+  const uint64_t* uint64_keys() {
+    return block_ ? block_->value_.d_uint64_keys.data()
+                  : value_.d_uint64_keys.data();
+  }
+  const int* uint64_lens() {
+    return block_ ? block_offset(block_->value_.d_uint64_lens.data(), 1)
+                  : value_.d_uint64_lens.data();
+  }
+  const int* uint64_offsets() {
+    return block_ ? block_offset(block_->value_.d_uint64_offset.data(),
+                                 used_uint64_num_ + 1)
+                  : value_.d_uint64_offset.data();
+  }
+  const float* float_keys() {
+    return block_ ? block_->value_.d_float_keys.data()
+                  : value_.d_float_keys.data();
+  }
+  const int* float_lens() {
+    return block_ ? block_offset(block_->value_.d_float_lens.data(), 1)
+                  : value_.d_float_lens.data();
+  }
+  const int* float_offsets() {
+    return block_ ? block_offset(block_->value_.d_float_offset.data(),
+                                 used_float_num_ + 1)
+                  : value_.d_float_offset.data();
+  }
+  int uint64_total_len() {
+    auto& lens = block_ ? block_->buf_.h_uint64_lens : buf_.h_uint64_lens;
+    return block_ ? lens[block_begin_ + ins_num_] - lens[block_begin_]
+                  : lens.back();
+  }
+  int float_total_len() {
+    auto& lens = block_ ? block_->buf_.h_float_lens : buf_.h_float_lens;
+    return block_ ? lens[block_begin_ + ins_num_] - lens[block_begin_]
+                  : lens.back();
+  }
+
   // tensor gpu memory reused
   void resize_tensor(void) {
     if (used_float_num_ > 0) {
-      int float_total_len = buf_.h_float_lens.back();
+      int float_total_len = this->float_total_len();
       if (float_total_len > 0) {
         float_tensor_.mutable_data<float>({float_total_len, 1}, this->place_);
       }
     }
     if (used_uint64_num_ > 0) {
-      int uint64_total_len = buf_.h_uint64_lens.back();
+      int uint64_total_len = this->uint64_total_len();
       if (uint64_total_len > 0) {
         uint64_tensor_.mutable_data<int64_t>({uint64_total_len, 1},
                                              this->place_);
@@ -619,6 +693,11 @@ class MiniBatchGpuPack {
   void pack_uint64_data(const SlotRecord* ins_vec, int num);
   void pack_float_data(const SlotRecord* ins_vec, int num);
 
+  template <typename T>
+  const T* block_offset(const T* data, int cols) {
+    return data == nullptr ? nullptr : data + block_begin_ * cols;
+  }
+
  public:
   template <typename T>
   void copy_host2device(CudaBuffer<T>* buf, const T* val, size_t size) {
@@ -653,6 +732,9 @@ class MiniBatchGpuPack {
   std::vector<UsedSlotGpuType> gpu_used_slots_;
   std::vector<SlotRecord> ins_vec_;
   const SlotRecord* batch_ins_ = nullptr;
+  // the block of the records referred by pack_from_block
+  MiniBatchGpuPack* block_ = nullptr;
+  int block_begin_ = 0;
 
   // uint64 tensor
   phi::DenseTensor uint64_tensor_;
@@ -1988,10 +2070,14 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   virtual void LoadIntoMemoryByLib(void);
   virtual void LoadIntoMemoryByLine(void);
   virtual void LoadIntoMemoryByFile(void);
+  // loads the files written by SlotRecordDataset::DumpIntoBinary
+  virtual void LoadIntoMemoryByBinary(void);
   void SetInputChannel(void* channel) override {
     input_channel_ = static_cast<ChannelObject<SlotRecord>*>(channel);
   }
   bool ParseOneInstance(const std::string& line, SlotRecord* rec);
+  // Parses a line in place, str is not required to be nul terminated.
+  bool ParseOneInstance(const char* str, size_t len, SlotRecord* rec);
   void PutToFeedVec(const SlotRecord* ins_vec, int num) override;
   void AssignFeedVar(const Scope& scope) override;
   std::vector<std::string> GetInputVarNames() override {
@@ -2003,6 +2089,7 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   }
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
   void BuildSlotBatchGPU(const int ins_num, MiniBatchGpuPack* pack);
+  void BuildRecordBlock();
 
   virtual MiniBatchGpuPack* get_pack(MiniBatchGpuPack* last_pack);
 
@@ -2038,6 +2125,12 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   virtual void InitGraphResource(void);
   virtual void InitGraphTrainResource(void);
   virtual void DoWalkandSage();
+  // Returns the next graph batch, which is generated into the staging
+  // tensors while the previous batch is trained if FLAGS_graph_prefetch_batch
+  // is set.
+  int NextGraphBatch();
+  void PrefetchGraphBatch();
+  void WaitGraphPrefetch();
   void SetInsIdVec(MiniBatchGpuPack* pack) override {
     if (parse_ins_id_) {
       size_t ins_num = pack->ins_num();
@@ -2053,6 +2146,7 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   void DumpSampleNeighbors(std::string dump_path) override;
 
   float sample_rate_ = 1.0f;
+  bool binary_format_ = false;
   int use_slot_size_ = 0;
   int float_use_slot_size_ = 0;
   int uint64_use_slot_size_ = 0;
@@ -2074,9 +2168,26 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   std::atomic<int> thread_count_{0};
   std::mutex pack_mutex_;
 
+  // the records of the batches uploaded once per pass, and the position in
+  // the block of the first record of each batch, see
+  // FLAGS_enable_slotrecord_gpu_resident_pass
+  std::unique_ptr<MiniBatchGpuPack> record_block_;
+  std::vector<SlotRecord> block_records_;
+  std::vector<int> block_batch_begins_;
+
   // async infershape
   std::map<const Scope*, std::vector<phi::DenseTensor*>> scope_feed_vec_;
 #endif
+
+#if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
+  // the two sets of the staging tensors, one of which is shared by the feed
+  // tensors while the next batch is generated into the other one
+  std::array<std::vector<phi::DenseTensor>, 2> graph_feed_buffers_;
+  std::array<std::vector<phi::DenseTensor*>, 2> graph_feed_buffer_ptrs_;
+  int graph_feed_buffer_idx_{0};
+  bool graph_prefetch_end_{false};
+  std::future<int> graph_prefetch_future_;
+#endif
 };
 
 class PaddleBoxDataFeed : public MultiSlotInMemoryDataFeed {
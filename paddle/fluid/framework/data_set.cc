@@ -133,6 +133,7 @@ void DatasetImpl<T>::SetHdfsConfig(const std::string& fs_name,
   cmd += " -D hadoop.job.ugi=" + fs_ugi;
   cmd += " -Ddfs.client.block.write.retries=15 -Ddfs.rpc.timeout=500000";
   paddle::framework::dataset_hdfs_set_command(cmd);
+  paddle::framework::dataset_hdfs_set_config(fs_name, fs_ugi);
 }
 
 template <typename T>
@@ -580,6 +581,9 @@ void DatasetImpl<T>::LoadIntoMemory() {
             << "]";
 #endif
   } else {
+    if (streaming_shuffle_) {
+      StartStreamingShuffle();
+    }
     std::vector<std::thread> load_threads;
     for (int64_t i = 0; i < thread_num_; ++i) {
       load_threads.emplace_back(&paddle::framework::DataFeed::LoadIntoMemory,
@@ -590,6 +594,9 @@ void DatasetImpl<T>::LoadIntoMemory() {
     }
   }
   input_channel_->Close();
+  if (streaming_shuffle_ && !gpu_graph_mode_) {
+    FinishStreamingShuffle();
+  }
   int64_t in_chan_size = input_channel_->Size();
   input_channel_->SetBlockSize(in_chan_size / thread_num_ + 1);
 
@@ -602,6 +609,9 @@ void DatasetImpl<T>::LoadIntoMemory() {
 template <typename T>
 void DatasetImpl<T>::PreLoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::PreLoadIntoMemory() begin";
+  if (streaming_shuffle_) {
+    StartStreamingShuffle();
+  }
   if (preload_thread_num_ != 0) {
     CHECK(static_cast<size_t>(preload_thread_num_) == preload_readers_.size());
     preload_threads_.clear();
@@ -628,6 +638,9 @@ void DatasetImpl<T>::WaitPreLoadDone() {
     t.join();
   }
   input_channel_->Close();
+  if (streaming_shuffle_) {
+    FinishStreamingShuffle();
+  }
   int64_t in_chan_size = input_channel_->Size();
   input_channel_->SetBlockSize(in_chan_size / thread_num_ + 1);
   VLOG(3) << "DatasetImpl<T>::WaitPreLoadDone() end";
@@ -768,6 +781,13 @@ void DatasetImpl<T>::DumpSampleNeighbors(std::string dump_path) {
 #endif
 }
 
+template <typename T>
+void DatasetImpl<T>::DumpIntoBinary(const std::string& path UNUSED,
+                                    int file_num UNUSED) {
+  PADDLE_THROW(common::errors::Unimplemented(
+      "DumpIntoBinary is only supported by SlotRecordDataset."));
+}
+
 // do tdm sample
 void MultiSlotDataset::TDMSample(const std::string tree_name,
                                  const std::string tree_path,
@@ -876,71 +896,14 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
   VLOG(3) << "MultiSlotDataset::GlobalShuffle() input_channel_ size "
           << input_channel_->Size();
 
-  auto get_client_id = [this, fleet_ptr](const Record& data) -> size_t {
-    if (this->merge_by_insid_) {
-      return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
-             this->trainer_num_;
-    } else if (this->shuffle_by_uid_) {
-      return XXH64(data.uid_.data(), data.uid_.length(), 0) %
-             this->trainer_num_;
-    } else {
-      return fleet_ptr->LocalRandomEngine()() % this->trainer_num_;
-    }
-  };
-
-  auto global_shuffle_func = [this, get_client_id]() {
-#ifdef PADDLE_WITH_PSCORE
-    auto fleet_ptr = distributed::FleetWrapper::GetInstance();
-#else
-    auto fleet_ptr = framework::FleetWrapper::GetInstance();
-#endif
-    // auto fleet_ptr = framework::FleetWrapper::GetInstance();
-    std::vector<Record> data;
-    while (this->input_channel_->Read(data)) {
-      std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
-      for (auto& t : data) {
-        auto client_id = get_client_id(t);
-        ars[client_id] << t;
-      }
-      std::vector<std::future<int32_t>> total_status;
-      std::vector<int> send_index(this->trainer_num_);
-      for (int i = 0; i < this->trainer_num_; ++i) {
-        send_index[i] = i;
-      }
-      std::shuffle(
-          send_index.begin(), send_index.end(), fleet_ptr->LocalRandomEngine());
-      for (int index = 0; index < this->trainer_num_; ++index) {
-        int i = send_index[index];
-        if (ars[i].Length() == 0) {
-          continue;
-        }
-        std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
-        total_status.push_back(std::move(ret));
-      }
-      for (auto& t : total_status) {
-        t.wait();
-      }
-      ars.clear();
-      ars.shrink_to_fit();
-      data.clear();
-      data.shrink_to_fit();
-      // currently we find bottleneck is server not able to handle large data
-      // in time, so we can remove this sleep and set fleet_send_batch_size to
-      // 1024, and set server thread to 24.
-      if (fleet_send_sleep_seconds_ != 0) {
-        sleep(this->fleet_send_sleep_seconds_);
-      }
-    }
-  };
-
   std::vector<std::thread> global_shuffle_threads;
   if (thread_num == -1) {
     thread_num = thread_num_;
   }
   VLOG(3) << "start global shuffle threads, num = " << thread_num;
   for (int i = 0; i < thread_num; ++i) {
-    global_shuffle_threads.emplace_back(global_shuffle_func);
+    global_shuffle_threads.emplace_back(&MultiSlotDataset::GlobalShuffleSend,
+                                        this);
   }
   for (std::thread& t : global_shuffle_threads) {
     t.join();
@@ -953,6 +916,88 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
           << timeline.ElapsedSec() << " seconds";
 }
 
+size_t MultiSlotDataset::GetShuffleClientId(const Record& data) {
+  if (merge_by_insid_) {
+    return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) % trainer_num_;
+  } else if (shuffle_by_uid_) {
+    return XXH64(data.uid_.data(), data.uid_.length(), 0) % trainer_num_;
+  } else {
+#ifdef PADDLE_WITH_PSCORE
+    auto fleet_ptr = distributed::FleetWrapper::GetInstance();
+#else
+    auto fleet_ptr = framework::FleetWrapper::GetInstance();
+#endif
+    return fleet_ptr->LocalRandomEngine()() % trainer_num_;
+  }
+}
+
+void MultiSlotDataset::GlobalShuffleSend() {
+#ifdef PADDLE_WITH_PSCORE
+  auto fleet_ptr = distributed::FleetWrapper::GetInstance();
+#else
+  auto fleet_ptr = framework::FleetWrapper::GetInstance();
+#endif
+  std::vector<Record> data;
+  while (input_channel_->Read(data)) {
+    std::vector<paddle::framework::BinaryArchive> ars(trainer_num_);
+    for (auto& t : data) {
+      auto client_id = GetShuffleClientId(t);
+      ars[client_id] << t;
+    }
+    // the records are serialized, release them before sending
+    data.clear();
+    data.shrink_to_fit();
+    std::vector<std::future<int32_t>> total_status;
+    std::vector<int> send_index(trainer_num_);
+    for (int i = 0; i < trainer_num_; ++i) {
+      send_index[i] = i;
+    }
+    std::shuffle(
+        send_index.begin(), send_index.end(), fleet_ptr->LocalRandomEngine());
+    for (int index = 0; index < trainer_num_; ++index) {
+      int i = send_index[index];
+      if (ars[i].Length() == 0) {
+        continue;
+      }
+      WaitForSendQuota(ars[i].Length());
+      std::string msg(ars[i].Buffer(), ars[i].Length());
+      auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
+      total_status.push_back(std::move(ret));
+    }
+    for (auto& t : total_status) {
+      t.wait();
+    }
+    ars.clear();
+    ars.shrink_to_fit();
+    // currently we find bottleneck is server not able to handle large data
+    // in time, so we can remove this sleep and set fleet_send_batch_size to
+    // 1024, and set server thread to 24.
+    if (fleet_send_sleep_seconds_ != 0) {
+      sleep(fleet_send_sleep_seconds_);
+    }
+  }
+}
+
+void MultiSlotDataset::StartStreamingShuffle() {
+  VLOG(3) << "MultiSlotDataset::StartStreamingShuffle() begin";
+  // the records are sent in blocks as soon as the readers write them
+  input_channel_->SetBlockSize(fleet_send_batch_size_);
+  streaming_shuffle_threads_.clear();
+  for (int i = 0; i < thread_num_; ++i) {
+    streaming_shuffle_threads_.emplace_back(
+        &MultiSlotDataset::GlobalShuffleSend, this);
+  }
+}
+
+void MultiSlotDataset::FinishStreamingShuffle() {
+  for (std::thread& t : streaming_shuffle_threads_) {
+    t.join();
+  }
+  streaming_shuffle_threads_.clear();
+  input_channel_->Clear();
+  VLOG(3) << "MultiSlotDataset::FinishStreamingShuffle() end";
+}
+
 template <typename T>
 void DatasetImpl<T>::DynamicAdjustChannelNum(int channel_num,
                                              bool discard_remaining_ins) {
@@ -1090,6 +1135,37 @@ void DatasetImpl<T>::SetFleetSendSleepSeconds(int seconds) {
   fleet_send_sleep_seconds_ = seconds;
 }
 
+template <typename T>
+void DatasetImpl<T>::SetFleetSendBytesPerSecond(int64_t bytes_per_second) {
+  fleet_send_bytes_per_second_ = bytes_per_second;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetStreamingShuffle(bool streaming_shuffle) {
+  streaming_shuffle_ = streaming_shuffle;
+}
+
+// the send threads share the bandwidth, each message reserves the time it
+// takes at the limit and waits for the messages reserved before it
+template <typename T>
+void DatasetImpl<T>::WaitForSendQuota(size_t bytes) {
+  if (fleet_send_bytes_per_second_ <= 0) {
+    return;
+  }
+  std::chrono::steady_clock::time_point send_time;
+  {
+    std::lock_guard<std::mutex> lock(fleet_send_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (fleet_send_time_ < now) {
+      fleet_send_time_ = now;
+    }
+    send_time = fleet_send_time_;
+    fleet_send_time_ += std::chrono::microseconds(
+        static_cast<int64_t>(bytes) * 1000000 / fleet_send_bytes_per_second_);
+  }
+  std::this_thread::sleep_until(send_time);
+}
+
 template <typename T>
 void DatasetImpl<T>::CreateReaders() {
   VLOG(3) << "Calling CreateReaders()";
@@ -2019,6 +2095,67 @@ void SlotRecordDataset::PrepareTrain() {
   return;
 }
 
+void SlotRecordDataset::DumpIntoBinary(const std::string& path, int file_num) {
+  VLOG(3) << "SlotRecordDataset::DumpIntoBinary() begin, path=" << path;
+  platform::Timer timeline;
+  timeline.Start();
+  // the records are in the channel after LoadIntoMemory, and in
+  // input_records_ after PrepareTrain
+  std::vector<SlotRecord> data;
+  bool from_channel = input_records_.empty();
+  if (from_channel) {
+    if (!input_channel_ || input_channel_->Size() == 0) {
+      VLOG(3) << "SlotRecordDataset::DumpIntoBinary() end, no data to dump";
+      return;
+    }
+    input_channel_->Close();
+    input_channel_->ReadAll(data);
+  }
+  const std::vector<SlotRecord>& records = from_channel ? data : input_records_;
+  file_num = std::max(1, std::min(file_num, static_cast<int>(records.size())));
+  size_t file_records = (records.size() + file_num - 1) / file_num;
+  std::vector<std::string> errors(file_num);
+  std::vector<std::thread> dump_threads;
+  for (int i = 0; i < file_num; ++i) {
+    dump_threads.push_back(std::thread([&, i]() {
+      size_t begin = i * file_records;
+      size_t end = std::min(records.size(), begin + file_records);
+      std::string filename =
+          string::format_string("%s/part-%05d", path.c_str(), i);
+      int err_no = 0;
+      std::shared_ptr<FILE> fp = fs_open_write(filename, &err_no, "");
+      if (fp == nullptr) {
+        errors[i] = "Cannot open file " + filename;
+        return;
+      }
+      for (size_t j = begin; j < end; j += OBJPOOL_BLOCK_SIZE) {
+        int num = static_cast<int>(
+            std::min(end - j, static_cast<size_t>(OBJPOOL_BLOCK_SIZE)));
+        if (!WriteSlotRecordBlock(fp.get(), &records[j], num)) {
+          errors[i] = "Failed to write file " + filename;
+          return;
+        }
+      }
+    }));
+  }
+  for (std::thread& t : dump_threads) {
+    t.join();
+  }
+  if (from_channel) {
+    input_channel_->Open();
+    input_channel_->Write(std::move(data));
+    input_channel_->Close();
+  }
+  for (auto& error : errors) {
+    PADDLE_ENFORCE_EQ(
+        error.empty(), true, common::errors::Unavailable("%s", error));
+  }
+  timeline.Pause();
+  VLOG(3) << "SlotRecordDataset::DumpIntoBinary() end, records="
+          << records.size() << ", files=" << file_num
+          << ", cost time=" << timeline.ElapsedSec() << " seconds";
+}
+
 void SlotRecordDataset::DynamicAdjustBatchNum() {
   VLOG(3) << "dynamic adjust batch num of graph in multi node";
 #if defined(PADDLE_WITH_PSCORE) && defined(PADDLE_WITH_HETERPS)
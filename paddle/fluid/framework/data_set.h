@@ -16,6 +16,7 @@
 
 #include <ThreadPool.h>
 
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -164,6 +165,11 @@ class Dataset {
   virtual void DynamicAdjustReadersNum(int thread_num) = 0;
   // set fleet send sleep seconds
   virtual void SetFleetSendSleepSeconds(int seconds) = 0;
+  // set the max bytes sent per second in global shuffle, 0 means no limit
+  virtual void SetFleetSendBytesPerSecond(int64_t bytes_per_second) = 0;
+  // send the records to the other trainers while they are being loaded,
+  // instead of in global shuffle after the whole dataset is in memory
+  virtual void SetStreamingShuffle(bool streaming_shuffle) = 0;
 
   virtual std::vector<std::string> GetSlots() = 0;
 
@@ -177,6 +183,9 @@ class Dataset {
 
   virtual void DumpWalkPath(std::string dump_path, size_t dump_rate) = 0;
   virtual void DumpSampleNeighbors(std::string dump_path) = 0;
+  // dump the records in memory into file_num files of the slot record blocks
+  // under path, which are loaded with the binary_format of the data feed
+  virtual void DumpIntoBinary(const std::string& path, int file_num) = 0;
   virtual const std::vector<uint64_t>& GetGpuGraphTotalKeys() = 0;
   virtual const std::vector<std::vector<uint64_t>*>& GetPassKeysVec() = 0;
   virtual const std::vector<std::vector<uint32_t>*>& GetPassRanksVec() = 0;
@@ -275,11 +284,14 @@ class DatasetImpl : public Dataset {
                                        bool discard_remaining_ins = false);
   virtual void DynamicAdjustReadersNum(int thread_num);
   virtual void SetFleetSendSleepSeconds(int seconds);
+  virtual void SetFleetSendBytesPerSecond(int64_t bytes_per_second);
+  virtual void SetStreamingShuffle(bool streaming_shuffle);
   virtual std::vector<std::string> GetSlots();
   virtual bool GetEpochFinish();
   virtual void ClearSampleState();
   virtual void DumpWalkPath(std::string dump_path, size_t dump_rate);
   virtual void DumpSampleNeighbors(std::string dump_path);
+  virtual void DumpIntoBinary(const std::string& path, int file_num);
 
   std::vector<paddle::framework::Channel<T>>& GetMultiOutputChannel() {
     return multi_output_channel_;
@@ -316,6 +328,12 @@ class DatasetImpl : public Dataset {
     // TODO(yaoxuefeng) for SlotRecordDataset
     return -1;
   }
+  // start the threads sending the records of input_channel_ while it is
+  // being loaded, and join them after it is closed
+  virtual void StartStreamingShuffle() {}
+  virtual void FinishStreamingShuffle() {}
+  // wait until bytes can be sent under fleet_send_bytes_per_second_
+  void WaitForSendQuota(size_t bytes);
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers_;
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> preload_readers_;
   paddle::framework::Channel<T> input_channel_;
@@ -346,6 +364,12 @@ class DatasetImpl : public Dataset {
   std::string fs_ugi_;
   int64_t fleet_send_batch_size_;
   int64_t fleet_send_sleep_seconds_;
+  int64_t fleet_send_bytes_per_second_ = 0;
+  std::mutex fleet_send_mutex_;
+  // the time when the next message may be sent
+  std::chrono::steady_clock::time_point fleet_send_time_;
+  bool streaming_shuffle_ = false;
+  std::vector<std::thread> streaming_shuffle_threads_;
   std::vector<std::thread> preload_threads_;
   std::thread* release_thread_ = nullptr;
   bool merge_by_insid_;
@@ -423,6 +447,11 @@ class MultiSlotDataset : public DatasetImpl<Record> {
   virtual int ReceiveFromClient(int msg_type,
                                 int client_id,
                                 const std::string& msg);
+  virtual void StartStreamingShuffle();
+  virtual void FinishStreamingShuffle();
+  // send the records read from input_channel_ until it is closed and empty
+  void GlobalShuffleSend();
+  size_t GetShuffleClientId(const Record& data);
 };
 class SlotRecordDataset : public DatasetImpl<SlotRecord> {
  public:
@@ -440,6 +469,7 @@ class SlotRecordDataset : public DatasetImpl<SlotRecord> {
   virtual void PrepareTrain();
   virtual void DynamicAdjustReadersNum(int thread_num);
   void DynamicAdjustBatchNum();
+  virtual void DumpIntoBinary(const std::string& path, int file_num);
 
  protected:
   bool enable_heterps_ = true;
@@ -415,6 +415,19 @@ class DownpourWorker : public HogwildWorker {
   std::vector<float> nid_show_;
   // std::map<uint64_t, uint64_t> table_dependency_;
   // std::vector<std::pair<uint64_t, uint64_t>> copy_dense_tables_;
+
+  // prefetch: the next batch is read into prefetch_scope_ and its sparse
+  // values are pulled while the current batch is computed
+  void InitPrefetch();
+  int PrefetchNextBatch();
+  void SwapPrefetchedBatch();
+  bool prefetch_sparse_;
+  std::unique_ptr<Scope> prefetch_scope_;
+  // the sparse_key_names_ of the slots with embedding
+  std::map<uint64_t, std::vector<std::string>> prefetch_key_names_;
+  std::map<uint64_t, std::vector<uint64_t>> prefetch_features_;
+  std::map<uint64_t, std::vector<std::vector<float>>> prefetch_feature_values_;
+  std::vector<::std::future<int32_t>> prefetch_status_;
 };
 
 // Based on DownpourWorker, remove push pull code into operator
@@ -97,6 +97,7 @@ void DownpourWorker::Initialize(const TrainerDesc& desc) {
       desc.scale_sparse_gradient_with_batch_size();
   scale_datanorm_ = desc.scale_datanorm();
   dump_slot_ = desc.dump_slot();
+  prefetch_sparse_ = desc.prefetch_next_batch_sparse();
   adjust_ins_weight_config_ = desc.adjust_ins_weight_config();
   for (int i = 0; i < desc.check_nan_var_names_size(); ++i) {
     check_nan_var_names_.push_back(desc.check_nan_var_names(i));
@@ -800,13 +801,99 @@ inline void AddAucMonitor(const Scope* scope, const phi::Place& place) {
 }
 #endif
 
+void DownpourWorker::InitPrefetch() {
+  if (need_dump_field_) {
+    // the fields of the instances dumped are those of the last batch read
+    LOG(WARNING) << "prefetch_next_batch_sparse is disabled with dump_fields";
+    prefetch_sparse_ = false;
+    return;
+  }
+  // not a kid of thread_scope_, which drops its kids after every batch
+  prefetch_scope_ = std::make_unique<Scope>();
+  for (auto& name : device_reader_->GetUseSlotAlias()) {
+    prefetch_scope_->Var(name)->GetMutable<phi::DenseTensor>();
+  }
+  device_reader_->AssignFeedVar(*prefetch_scope_);
+  for (auto& it : sparse_key_names_) {
+    uint64_t tid = it.first;
+    prefetch_key_names_[tid].clear();
+    for (size_t i = 0; i < it.second.size(); ++i) {
+      // skip slots which do not have embedding, as PullSparseVarsSync
+      if (thread_scope_->FindVar(sparse_value_names_[tid][i]) != nullptr) {
+        prefetch_key_names_[tid].push_back(it.second[i]);
+      }
+    }
+  }
+}
+
+int DownpourWorker::PrefetchNextBatch() {
+  int batch_size = device_reader_->Next();
+  if (batch_size <= 0) {
+    return batch_size;
+  }
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    TableParameter table;
+    for (auto const& j : param_.sparse_table()) {
+      if (j.table_id() == tid) {
+        table = j;
+        break;
+      }
+    }
+    prefetch_status_.push_back(
+        fleet_ptr_->PullSparseVarsAsync(*prefetch_scope_,
+                                        tid,
+                                        prefetch_key_names_[tid],
+                                        &prefetch_features_[tid],
+                                        &prefetch_feature_values_[tid],
+                                        table.fea_dim()));
+  }
+  return batch_size;
+}
+
+void DownpourWorker::SwapPrefetchedBatch() {
+  for (auto& t : prefetch_status_) {
+    if (!t.valid()) {
+      continue;
+    }
+    auto status = t.get();
+    if (status != 0) {
+      LOG(ERROR) << "fleet pull sparse failed, status[" << status << "]";
+      sleep(1);
+      exit(-1);
+    }
+  }
+  prefetch_status_.resize(0);
+  for (auto& name : device_reader_->GetUseSlotAlias()) {
+    std::swap(*thread_scope_->FindVar(name)->GetMutable<phi::DenseTensor>(),
+              *prefetch_scope_->FindVar(name)->GetMutable<phi::DenseTensor>());
+  }
+  for (auto& it : prefetch_key_names_) {
+    features_[it.first].swap(prefetch_features_[it.first]);
+    feature_values_[it.first].swap(prefetch_feature_values_[it.first]);
+  }
+}
+
 void DownpourWorker::TrainFiles() {
   VLOG(3) << "Begin to train files";
   platform::SetNumThreads(1);
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch = 0;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  if (prefetch_sparse_) {
+    InitPrefetch();
+  }
+  // with prefetch, the sparse values of batch i + 1 are pulled before the
+  // gradients of batch i are pushed, so they are stale by one batch at most
+  cur_batch = prefetch_sparse_ ? PrefetchNextBatch() : device_reader_->Next();
+  while (cur_batch > 0) {
+    int next_batch = 0;
+    if (prefetch_sparse_) {
+      SwapPrefetchedBatch();
+      next_batch = PrefetchNextBatch();
+    }
     if (copy_table_config_.need_copy()) {
       if (batch_cnt % copy_table_config_.batch_num() == 0) {
         CopySparseTable();
@@ -826,13 +913,15 @@ void DownpourWorker::TrainFiles() {
           break;
         }
       }
-      fleet_ptr_->PullSparseVarsSync(*thread_scope_,
-                                     tid,
-                                     sparse_key_names_[tid],
-                                     &features_[tid],
-                                     &feature_values_[tid],
-                                     table.fea_dim(),
-                                     sparse_value_names_[tid]);
+      if (!prefetch_sparse_) {
+        fleet_ptr_->PullSparseVarsSync(*thread_scope_,
+                                       tid,
+                                       sparse_key_names_[tid],
+                                       &features_[tid],
+                                       &feature_values_[tid],
+                                       table.fea_dim(),
+                                       sparse_value_names_[tid]);
+      }
       CollectLabelInfo(i);
       FillSparseValue(i);
       auto nid_iter = std::find(sparse_value_names_[tid].begin(),
@@ -1072,6 +1161,10 @@ void DownpourWorker::TrainFiles() {
     PrintFetchVars();
     thread_scope_->DropKids();
     ++batch_cnt;
+    cur_batch = prefetch_sparse_ ? next_batch : device_reader_->Next();
+  }
+  if (prefetch_sparse_) {
+    device_reader_->AssignFeedVar(*thread_scope_);
   }
   if (need_dump_field_ || need_dump_param_) {
     writer_.Flush();
@@ -64,6 +64,12 @@ class InterpreterCoreInfo {
     std::shared_ptr<InterpreterCore> core_{nullptr};
     std::set<std::string> skip_eager_delete_vars_;
     std::unique_ptr<::pir::Program> ir_prog_{nullptr};
+    // The variables of the inputs and outputs of the program in the scope of
+    // the core, in the order of the values of run_program. They are looked
+    // up by name on the first run, and the later runs share the tensors with
+    // them by index. A missing variable is a value to skip.
+    std::vector<Variable*> input_vars_;
+    std::vector<Variable*> output_vars_;
   };
 
   bool IsAvailable(bool is_grad) {
@@ -111,6 +117,24 @@ class InterpreterCoreInfoCache {
     return info_map_[program_id].GetMutable(is_grad);
   }
 
+  // The cached value with an available core, or nullptr, by one lookup.
+  InterpreterCoreInfo::CacheValue* Find(int64_t program_id,
+                                        const framework::Scope* scope,
+                                        const int64_t& place_hash_key,
+                                        bool is_grad,
+                                        bool in_pir_mode) {
+    if (in_pir_mode) {
+      int64_t scope_i = reinterpret_cast<int64_t>(scope);
+      program_id = hash_with_seed(program_id, scope_i);
+      program_id = hash_with_seed(program_id, place_hash_key);
+    }
+    auto iter = info_map_.find(program_id);
+    if (iter == info_map_.end() || !iter->second.IsAvailable(is_grad)) {
+      return nullptr;
+    }
+    return &iter->second.GetMutable(is_grad);
+  }
+
   void UpdateSkipEagerDeleteVars(int64_t program_id,
                                  const framework::Scope* scope,
                                  const int64_t& place_hash_key,
@@ -97,6 +97,49 @@ class BasicAucCalculator {
     _local_pred += pred;
     _table[label][pos]++;
   }
+  // add batch data in CPU, locks once for the batch, the instances whose mask
+  // is not 1 are skipped
+  void add_batch_data(const float* pred,
+                      const int64_t* label,
+                      const int64_t* mask,
+                      size_t batch_size) {
+    std::lock_guard<std::mutex> lock(_table_mutex);
+    double* table[2] = {_table[0].data(), _table[1].data()};  // NOLINT
+    double abserr = 0;
+    double sqrerr = 0;
+    double pred_sum = 0;
+    size_t i = 0;
+    for (; i < batch_size; ++i) {
+      if (mask != nullptr && mask[i] != 1) {
+        continue;
+      }
+      double cur_pred = pred[i];
+      int64_t cur_label = label[i];
+      if (!(cur_pred >= 0.0 && cur_pred <= 1.0) ||
+          (cur_label != 0 && cur_label != 1)) {
+        break;
+      }
+      int pos =
+          std::min(static_cast<int>(cur_pred * _table_size), _table_size - 1);
+      double err = cur_pred - cur_label;
+      abserr += fabs(err);
+      sqrerr += err * err;
+      pred_sum += cur_pred;
+      table[cur_label][pos]++;
+    }
+    _local_abserr += abserr;
+    _local_sqrerr += sqrerr;
+    _local_pred += pred_sum;
+    PADDLE_ENFORCE_EQ(
+        i,
+        batch_size,
+        common::errors::PreconditionNotMet(
+            "pred should be in [0, 1] and label must be equal to 0 or 1, but "
+            "the pred and label of the %d-th instance are %f and %d",
+            i,
+            i < batch_size ? pred[i] : 0.0,
+            i < batch_size ? label[i] : 0));
+  }
   void compute();
   int table_size() const { return _table_size; }
   double bucket_error() const { return _bucket_error; }
@@ -573,11 +616,13 @@ class BoxWrapper {
       get_data<int64_t>(exe_scope, label_varname_, &label_data);
       std::vector<float> pred_data;
       get_data<float>(exe_scope, pred_varname_, &pred_data);
-      auto cal = GetCalculator();
-      auto batch_size = label_data.size();
-      for (size_t i = 0; i < batch_size; ++i) {
-        cal->add_data(pred_data[i], label_data[i]);
-      }
+      PADDLE_ENFORCE_EQ(label_data.size(),
+                        pred_data.size(),
+                        common::errors::PreconditionNotMet(
+                            "the predict data length should be consistent with "
+                            "the label data length"));
+      GetCalculator()->add_batch_data(
+          pred_data.data(), label_data.data(), nullptr, label_data.size());
     }
     template <class T = float>
     static void get_data(const Scope* exe_scope,
@@ -793,13 +838,20 @@ class BoxWrapper {
       get_data<float>(exe_scope, pred_varname_, &pred_data);
       std::vector<int64_t> mask_data;
       get_data<int64_t>(exe_scope, mask_varname_, &mask_data);
-      auto cal = GetCalculator();
-      auto batch_size = label_data.size();
-      for (size_t i = 0; i < batch_size; ++i) {
-        if (mask_data[i] == 1) {
-          cal->add_data(pred_data[i], label_data[i]);
-        }
-      }
+      PADDLE_ENFORCE_EQ(label_data.size(),
+                        pred_data.size(),
+                        common::errors::PreconditionNotMet(
+                            "the predict data length should be consistent with "
+                            "the label data length"));
+      PADDLE_ENFORCE_EQ(label_data.size(),
+                        mask_data.size(),
+                        common::errors::PreconditionNotMet(
+                            "the mask data length should be consistent with "
+                            "the label data length"));
+      GetCalculator()->add_batch_data(pred_data.data(),
+                                      label_data.data(),
+                                      mask_data.data(),
+                                      label_data.size());
     }
 
    protected:
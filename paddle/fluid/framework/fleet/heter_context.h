@@ -33,6 +33,7 @@ limitations under the License. */
 
 #include "paddle/fluid/distributed/ps/thirdparty/round_robin.h"
 #include "paddle/fluid/framework/fleet/heter_ps/feature_value.h"
+#include "paddle/fluid/framework/fleet/heter_ps/hashtable_fwd.h"
 #include "paddle/fluid/framework/scope.h"
 
 #ifdef PADDLE_WITH_PSLIB
@@ -46,9 +47,6 @@ limitations under the License. */
 namespace paddle {
 namespace framework {
 
-template <typename KeyType, typename ValType>
-class HashTable;
-
 class HeterContext {
  public:
   virtual ~HeterContext() {
@@ -92,6 +90,9 @@ class HeterContext {
   std::vector<std::vector<FeatureValue>> device_values_;
   std::vector<std::vector<FeatureKey>> device_keys_;
   std::vector<std::vector<std::vector<FeatureKey>>> device_dim_keys_;
+  // the number of the keys of device_dim_keys_ at the front which are also
+  // in the pass trained while this task is built, see BuildNextTask
+  std::vector<std::vector<size_t>> shared_dim_keys_num_;
   std::vector<std::mutex*> mutex_;
   std::vector<std::vector<std::mutex*>> dim_mutex_;
   int multi_mf_dim_ = 0;
@@ -194,6 +195,7 @@ class HeterContext {
           device_dim_ptr_[i][j].clear();
         }
       }
+      shared_dim_keys_num_.clear();
     }
 
     for (auto& item : keys2rank_map_vec_) {
@@ -0,0 +1,424 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#if defined(PADDLE_WITH_CUDA)
+#include <thrust/pair.h>
+
+#include <cstdio>
+#include <iostream>
+
+#include "paddle/fluid/framework/fleet/heter_ps/cudf/concurrent_unordered_map.cuh.h"
+
+namespace paddle {
+namespace framework {
+
+// A bucketized cuckoo hash map with the interface of concurrent_unordered_map,
+// so it can be the container of HashTable, see CuckooTableBackend:
+//  * A key is in one of the two buckets of its two hashes, kBucketSize slots
+//    each, so a find probes at most 2 * kBucketSize slots at any load. The
+//    threads of a warp probe the slots of a bucket together, one key after
+//    another, so a probe of a bucket is one coalesced load.
+//  * An insert takes the locks of the two buckets of the key. If both are
+//    full, the keys along a random cuckoo path are moved to their other
+//    bucket from the end of the path, so a key is always in one of its
+//    buckets, and the insert is tried again. It works to ~90% load.
+//
+// As concurrent_unordered_map, it supports concurrent inserts, but not inserts
+// concurrent with finds. The locks need the independent thread scheduling of
+// Volta and later.
+template <typename Key,
+          typename Element,
+          Key unused_key,
+          typename Allocator = managed_allocator<thrust::pair<Key, Element>>>
+class BucketizedCuckooMap : public managed {
+ public:
+  using size_type = size_t;
+  using allocator_type = Allocator;
+  using key_type = Key;
+  using value_type = thrust::pair<Key, Element>;
+  using mapped_type = Element;
+  using iterator = cycle_iterator_adapter<value_type*>;
+  using const_iterator = const cycle_iterator_adapter<value_type*>;
+
+  static constexpr int kBucketSize = 16;
+  static constexpr int kMaxPathLength = 32;
+  static constexpr int kMaxInsertAttempts = 64;
+
+  BucketizedCuckooMap(const BucketizedCuckooMap&) = delete;
+  BucketizedCuckooMap& operator=(const BucketizedCuckooMap&) = delete;
+  BucketizedCuckooMap(cudaStream_t stream,
+                      size_type n,
+                      const mapped_type unused_element,
+                      const allocator_type& a = allocator_type())
+      : m_allocator(a),
+        m_unused_element(unused_element),
+        m_enable_collision_stat(false),
+        m_insert_times(0),
+        m_insert_moves(0),
+        m_query_times(0) {
+    m_num_buckets = (n + kBucketSize - 1) / kBucketSize;
+    if (m_num_buckets == 0) {
+      m_num_buckets = 1;
+    }
+    m_hashtbl_size = m_num_buckets * kBucketSize;
+    m_hashtbl_values = m_allocator.allocate(m_hashtbl_size);
+    CUDA_RT_CALL(cudaMalloc(reinterpret_cast<void**>(&m_locks),
+                            m_num_buckets * sizeof(int)));
+    cudaPointerAttributes hashtbl_values_ptr_attributes;
+    cudaError_t status = cudaPointerGetAttributes(
+        &hashtbl_values_ptr_attributes, m_hashtbl_values);
+    if (cudaSuccess == status &&
+        hashtbl_values_ptr_attributes.type == cudaMemoryTypeManaged) {
+      int dev_id = 0;
+      CUDA_RT_CALL(cudaGetDevice(&dev_id));
+      CUDA_RT_CALL(cudaMemPrefetchAsync(m_hashtbl_values,
+                                        m_hashtbl_size * sizeof(value_type),
+                                        dev_id,
+                                        stream));
+    }
+    clear_async(stream);
+    CUDA_RT_CALL(cudaStreamSynchronize(stream));
+    CUDA_RT_CALL(cudaGetLastError());
+    m_enable_collision_stat = FLAGS_gpugraph_enable_hbm_table_collision_stat;
+  }
+
+  ~BucketizedCuckooMap() {
+    m_allocator.deallocate(m_hashtbl_values, m_hashtbl_size);
+    cudaFree(m_locks);
+  }
+
+  __host__ __device__ iterator begin() {
+    return iterator(
+        m_hashtbl_values, m_hashtbl_values + m_hashtbl_size, m_hashtbl_values);
+  }
+  __host__ __device__ const_iterator begin() const {
+    return const_iterator(
+        m_hashtbl_values, m_hashtbl_values + m_hashtbl_size, m_hashtbl_values);
+  }
+  __host__ __device__ iterator end() {
+    return iterator(m_hashtbl_values,
+                    m_hashtbl_values + m_hashtbl_size,
+                    m_hashtbl_values + m_hashtbl_size);
+  }
+  __host__ __device__ const_iterator end() const {
+    return const_iterator(m_hashtbl_values,
+                          m_hashtbl_values + m_hashtbl_size,
+                          m_hashtbl_values + m_hashtbl_size);
+  }
+  // the number of the slots, the keys of the unused slots are unused_key
+  __host__ __device__ size_type size() const { return m_hashtbl_size; }
+  __host__ __device__ value_type* data() const { return m_hashtbl_values; }
+
+  __forceinline__ static constexpr __host__ __device__ key_type
+  get_unused_key() {
+    return unused_key;
+  }
+
+  template <typename aggregation_type>
+  __forceinline__ __device__ iterator insert(const value_type& x,
+                                             aggregation_type op,
+                                             uint64_t* local_count = NULL) {
+    const key_type key = x.first;
+    size_type b1 = 0;
+    size_type b2 = 0;
+    bucket_pair(key, &b1, &b2);
+    for (int attempt = 0; attempt < kMaxInsertAttempts; ++attempt) {
+      lock_buckets(b1, b2);
+      value_type* slot = find_locked(b1, key);
+      if (slot == NULL) {
+        slot = find_locked(b2, key);
+      }
+      bool is_new = false;
+      if (slot == NULL) {
+        slot = find_locked(b1, unused_key);
+        if (slot == NULL) {
+          slot = find_locked(b2, unused_key);
+        }
+        is_new = slot != NULL;
+      }
+      if (slot != NULL) {
+        slot->second = is_new ? x.second : op(x.second, slot->second);
+        *reinterpret_cast<volatile key_type*>(&slot->first) = key;
+        unlock_buckets(b1, b2);
+        if (is_new && local_count != NULL) {
+          atomicAdd(local_count, 1);
+        }
+        if (m_enable_collision_stat) {
+          atomicAdd(&m_insert_times, 1);
+        }
+        return iterator(
+            m_hashtbl_values, m_hashtbl_values + m_hashtbl_size, slot);
+      }
+      unlock_buckets(b1, b2);
+      // both buckets are full, free a slot of one of them
+      move_along_path(key, (attempt & 1) ? b2 : b1, attempt);
+    }
+    return end();
+  }
+
+  __forceinline__ __device__ const_iterator find(const key_type& k) {
+    const unsigned mask = __activemask();
+    const int lane = lane_id();
+    const int rank = __popc(mask & ((1u << lane) - 1));
+    const int group_size = __popc(mask);
+    value_type* found = m_hashtbl_values + m_hashtbl_size;
+    // the keys of the active threads, one after another
+    unsigned pending = mask;
+    while (pending) {
+      const int src = __ffs(pending) - 1;
+      pending &= pending - 1;
+      const key_type key = __shfl_sync(mask, k, src);
+      value_type* slot = probe(key, mask, rank, group_size);
+      if (lane == src) {
+        found = slot;
+      }
+    }
+    if (m_enable_collision_stat) {
+      atomicAdd(&m_query_times, 1);
+    }
+    return const_iterator(
+        m_hashtbl_values, m_hashtbl_values + m_hashtbl_size, found);
+  }
+
+  void clear_async(cudaStream_t stream = 0) {
+    constexpr int block_size = 128;
+    init_hashtbl<<<((m_hashtbl_size - 1) / block_size) + 1,
+                   block_size,
+                   0,
+                   stream>>>(
+        m_hashtbl_values, m_hashtbl_size, unused_key, m_unused_element);
+    CUDA_RT_CALL(
+        cudaMemsetAsync(m_locks, 0, m_num_buckets * sizeof(int), stream));
+    if (m_enable_collision_stat) {
+      m_insert_times = 0;
+      m_insert_moves = 0;
+      m_query_times = 0;
+    }
+  }
+
+  unsigned long long get_num_collisions() const {  // NOLINT
+    return m_insert_moves;
+  }
+
+  void print() {
+    for (size_type i = 0; i < 5; ++i) {
+      std::cout << i << ": " << m_hashtbl_values[i].first << ","
+                << m_hashtbl_values[i].second << std::endl;
+    }
+  }
+
+  int prefetch(const int dev_id, cudaStream_t stream = 0) {
+    cudaPointerAttributes hashtbl_values_ptr_attributes;
+    cudaError_t status = cudaPointerGetAttributes(
+        &hashtbl_values_ptr_attributes, m_hashtbl_values);
+    if (cudaSuccess == status &&
+        hashtbl_values_ptr_attributes.type == cudaMemoryTypeManaged) {
+      CUDA_RT_CALL(cudaMemPrefetchAsync(m_hashtbl_values,
+                                        m_hashtbl_size * sizeof(value_type),
+                                        dev_id,
+                                        stream));
+    }
+    CUDA_RT_CALL(cudaMemPrefetchAsync(this, sizeof(*this), dev_id, stream));
+    return 0;
+  }
+
+  __host__ void print_collision(int id) {
+    if (m_enable_collision_stat) {
+      printf(
+          "collision stat for cuckoo hbm table %d, insert(%lu), moves(%lu), "
+          "query(%lu)\n",
+          id,
+          m_insert_times,
+          m_insert_moves,
+          m_query_times);
+    }
+  }
+
+ private:
+  __forceinline__ __device__ static int lane_id() {
+    int lane = 0;
+    asm volatile("mov.u32 %0, %%laneid;" : "=r"(lane));
+    return lane;
+  }
+
+  __forceinline__ __device__ static uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  __forceinline__ __device__ void bucket_pair(const key_type& key,
+                                              size_type* b1,
+                                              size_type* b2) const {
+    uint64_t h = mix(static_cast<uint64_t>(key));
+    *b1 = h % m_num_buckets;
+    *b2 = mix(h ^ 0x9e3779b97f4a7c15ULL) % m_num_buckets;
+    if (*b2 == *b1) {
+      *b2 = (*b1 + 1) % m_num_buckets;
+    }
+  }
+
+  // the other bucket of key, which is in bucket
+  __forceinline__ __device__ size_type alternate_bucket(const key_type& key,
+                                                        size_type bucket) {
+    size_type b1 = 0;
+    size_type b2 = 0;
+    bucket_pair(key, &b1, &b2);
+    return bucket == b1 ? b2 : b1;
+  }
+
+  // the warp probes the slots of the two buckets of key together
+  __forceinline__ __device__ value_type* probe(const key_type& key,
+                                               unsigned mask,
+                                               int rank,
+                                               int group_size) {
+    size_type buckets[2];
+    bucket_pair(key, &buckets[0], &buckets[1]);
+    for (int b = 0; b < 2; ++b) {
+      value_type* bucket = m_hashtbl_values + buckets[b] * kBucketSize;
+      for (int base = 0; base < kBucketSize; base += group_size) {
+        const int slot = base + rank;
+        const bool hit = slot < kBucketSize && bucket[slot].first == key;
+        const unsigned hits = __ballot_sync(mask, hit);
+        if (hits) {
+          const int owner = __ffs(hits) - 1;
+          return bucket + base + __popc(mask & ((1u << owner) - 1));
+        }
+      }
+    }
+    return m_hashtbl_values + m_hashtbl_size;
+  }
+
+  // the slot of key in bucket, read past the l1 cache, with the lock of
+  // the bucket
+  __forceinline__ __device__ value_type* find_locked(size_type bucket,
+                                                     const key_type& key) {
+    value_type* slots = m_hashtbl_values + bucket * kBucketSize;
+    for (int i = 0; i < kBucketSize; ++i) {
+      if (*reinterpret_cast<volatile key_type*>(&slots[i].first) == key) {
+        return slots + i;
+      }
+    }
+    return NULL;
+  }
+
+  __forceinline__ __device__ void lock_buckets(size_type a, size_type b) {
+    if (a > b) {
+      size_type t = a;
+      a = b;
+      b = t;
+    }
+    while (atomicCAS(m_locks + a, 0, 1) != 0) {
+    }
+    if (b != a) {
+      while (atomicCAS(m_locks + b, 0, 1) != 0) {
+      }
+    }
+    __threadfence();
+  }
+
+  __forceinline__ __device__ void unlock_buckets(size_type a, size_type b) {
+    __threadfence();
+    atomicExch(m_locks + a, 0);
+    if (b != a) {
+      atomicExch(m_locks + b, 0);
+    }
+  }
+
+  // Walks a random path of the keys from bucket to a bucket with a free
+  // slot, then moves the keys to their other buckets from the end of the
+  // path, each with the locks of its two buckets. A move is skipped if the
+  // path was changed by another insert. Returns whether bucket has a free
+  // slot.
+  __device__ bool move_along_path(const key_type& key,
+                                  size_type bucket,
+                                  int seed) {
+    if (m_num_buckets == 1) {
+      return false;
+    }
+    size_type path_buckets[kMaxPathLength + 1];
+    int path_slots[kMaxPathLength];
+    key_type path_keys[kMaxPathLength];
+    uint64_t rand = mix(static_cast<uint64_t>(key) + seed + 1);
+    int depth = 0;
+    bool found = false;
+    path_buckets[0] = bucket;
+    while (depth < kMaxPathLength && !found) {
+      size_type current = path_buckets[depth];
+      int slot = rand % kBucketSize;
+      rand = mix(rand);
+      key_type victim = *reinterpret_cast<volatile key_type*>(
+          &m_hashtbl_values[current * kBucketSize + slot].first);
+      if (victim == unused_key) {
+        // a slot was freed by another insert
+        return true;
+      }
+      size_type next = alternate_bucket(victim, current);
+      path_slots[depth] = slot;
+      path_keys[depth] = victim;
+      path_buckets[depth + 1] = next;
+      ++depth;
+      found = find_locked(next, unused_key) != NULL;
+    }
+    if (!found) {
+      return false;
+    }
+    for (int d = depth - 1; d >= 0; --d) {
+      size_type from = path_buckets[d];
+      size_type to = path_buckets[d + 1];
+      lock_buckets(from, to);
+      value_type* src = m_hashtbl_values + from * kBucketSize + path_slots[d];
+      value_type* dst = find_locked(to, unused_key);
+      bool valid =
+          *reinterpret_cast<volatile key_type*>(&src->first) == path_keys[d] &&
+          dst != NULL;
+      if (valid) {
+        // the key is in its new slot before it leaves the old one
+        dst->second = src->second;
+        __threadfence();
+        *reinterpret_cast<volatile key_type*>(&dst->first) = path_keys[d];
+        *reinterpret_cast<volatile key_type*>(&src->first) = unused_key;
+        src->second = m_unused_element;
+      }
+      unlock_buckets(from, to);
+      if (!valid) {
+        return false;
+      }
+    }
+    if (m_enable_collision_stat) {
+      atomicAdd(&m_insert_moves, static_cast<uint64_t>(depth));
+    }
+    return true;
+  }
+
+  allocator_type m_allocator;
+  const mapped_type m_unused_element;
+  size_type m_num_buckets;
+  size_type m_hashtbl_size;
+  value_type* m_hashtbl_values;
+  int* m_locks;
+
+  bool m_enable_collision_stat;
+  uint64_t m_insert_times;
+  uint64_t m_insert_moves;
+  uint64_t m_query_times;
+};
+
+}  // end namespace framework
+}  // end namespace paddle
+#endif
@@ -16,6 +16,8 @@
 #include <thrust/host_vector.h>
 
 #include <chrono>
+#include <mutex>
+#include <unordered_map>
 
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/common_graph_table.h"
@@ -28,12 +30,30 @@
 
 COMMON_DECLARE_double(gpugraph_hbm_table_load_factor);
 COMMON_DECLARE_bool(multi_node_sample_use_gpu_table);
+COMMON_DECLARE_int64(gpugraph_neighbor_cache_size);
 
 namespace paddle {
 namespace framework {
 
 typedef paddle::distributed::GraphTableType GraphTableType;
 
+// The hbm cache of the adjacency lists of the nodes sampled from the cpu graph
+// table, of a gpu and an edge type, see FLAGS_gpugraph_neighbor_cache_size.
+struct GpuPsNeighborCache {
+  // node id -> the GpuPsNodeInfo of its neighbors in neighbor_list
+  HashTable<uint64_t, uint64_t> *table = nullptr;
+  uint64_t *neighbor_list = nullptr;
+  int64_t node_size = 0, node_capacity = 0;
+  int64_t neighbor_size = 0, neighbor_capacity = 0;
+  // the cpu queries of the nodes not cached, UINT32_MAX if not to be cached
+  std::unordered_map<uint64_t, uint32_t> query_count;
+  // pinned host memory mapped into the device, the kernels read the cpu
+  // sample results from it without a copy
+  uint64_t *host_buffer = nullptr;
+  size_t host_buffer_size = 0;
+  std::mutex mutex;
+};
+
 class GpuPsGraphTable
     : public HeterComm<uint64_t, uint64_t, int, CommonFeatureValueAccessor> {
  public:
@@ -102,6 +122,8 @@ class GpuPsGraphTable
         gpu_rank_fea_list_.push_back(GpuPsCommRankFea());
       }
     }
+    neighbor_caches_ = std::vector<GpuPsNeighborCache *>(
+        gpu_num * graph_table_num_, NULL);
     cpu_table_status = -1;
     device_mutex_.resize(gpu_num);
     for (int i = 0; i < gpu_num; i++) {
@@ -109,6 +131,11 @@ class GpuPsGraphTable
     }
   }
   ~GpuPsGraphTable() {
+    for (int i = 0; i < gpu_num; ++i) {
+      for (int j = 0; j < graph_table_num_; ++j) {
+        clear_neighbor_cache(i, j);
+      }
+    }
     for (size_t i = 0; i < device_mutex_.size(); ++i) {
       delete device_mutex_[i];
     }
@@ -121,6 +148,7 @@ class GpuPsGraphTable
   void build_rank_fea_on_single_gpu(const GpuPsCommRankFea &g, int gpu_id);
   void clear_graph_info(int gpu_id, int index);
   void clear_graph_info(int index);
+  void clear_neighbor_cache(int gpu_id, int idx);
   void reset_feature_info(int gpu_id, size_t capacity, size_t feature_size);
   void reset_rank_info(int gpu_id, size_t capacity, size_t feature_size);
   void reset_float_feature_info(int gpu_id,
@@ -211,6 +239,22 @@ class GpuPsGraphTable
                          uint64_t random_seed,
                          float *weight_array,
                          bool return_weight);
+  GpuPsNeighborCache *neighbor_cache(int gpu_id, int idx);
+  int sample_from_neighbor_cache(int gpu_id,
+                                 int idx,
+                                 uint64_t *key,
+                                 int len,
+                                 int sample_size,
+                                 int neighbor_size_limit,
+                                 uint64_t *val,
+                                 int *actual_sample_size,
+                                 uint64_t *cpu_keys,
+                                 int *cpu_index,
+                                 int number_on_cpu);
+  void update_neighbor_cache(int gpu_id,
+                             int idx,
+                             const uint64_t *cpu_keys,
+                             int number_on_cpu);
   std::vector<std::shared_ptr<phi::Allocation>> get_edge_type_graph(
       int gpu_id, int edge_type_len);
   std::shared_ptr<phi::Allocation> get_node_degree(int gpu_id,
@@ -360,6 +404,7 @@ class GpuPsGraphTable
   bool infer_mode_ = false;
   using RankTable = HashTable<uint64_t, uint32_t>;
   std::vector<RankTable *> rank_tables_;
+  std::vector<GpuPsNeighborCache *> neighbor_caches_;
 };
 
 };  // namespace framework
@@ -32,6 +32,7 @@
 
 COMMON_DECLARE_bool(enable_neighbor_list_use_uva);
 COMMON_DECLARE_bool(enable_graph_multi_node_sampling);
+COMMON_DECLARE_int32(gpugraph_neighbor_cache_admit_count);
 
 namespace paddle {
 namespace framework {
@@ -89,6 +90,32 @@ __global__ void copy_buffer_ac_to_final_place(uint64_t* gpu_buffer,
   }
 }
 
+template <int WARP_SIZE, int BLOCK_WARPS, int TILE_SIZE>
+__global__ void copy_cache_sample_to_final_place(uint64_t* cache_val,
+                                                 int* cache_ac,
+                                                 uint64_t* val,
+                                                 int* actual_sample_size,
+                                                 int* index,
+                                                 int number_on_cpu,
+                                                 int sample_size) {
+  assert(blockDim.x == WARP_SIZE);
+  assert(blockDim.y == BLOCK_WARPS);
+
+  int i = blockIdx.x * TILE_SIZE + threadIdx.y;
+  const int last_idx =
+      min(static_cast<int>(blockIdx.x + 1) * TILE_SIZE, number_on_cpu);
+  while (i < last_idx) {
+    // cache_ac is -1 for the nodes not in the cache
+    if (cache_ac[i] != -1) {
+      actual_sample_size[index[i]] = cache_ac[i];
+      for (int j = threadIdx.x; j < cache_ac[i]; j += WARP_SIZE) {
+        val[index[i] * sample_size + j] = cache_val[i * sample_size + j];
+      }
+    }
+    i += BLOCK_WARPS;
+  }
+}
+
 __global__ void get_features_size(GpuPsFeaInfo* fea_info_array,
                                   uint32_t* feature_size,
                                   int n) {
@@ -1590,6 +1617,7 @@ void GpuPsGraphTable::reset_rank_info(int gpu_id,
 
 void GpuPsGraphTable::clear_graph_info(int gpu_id, int idx) {
   if (idx >= graph_table_num_) return;
+  clear_neighbor_cache(gpu_id, idx);
   platform::CUDADeviceGuard guard(resource_->dev_id(gpu_id));
   int offset = get_table_offset(gpu_id, GraphTableType::EDGE_TABLE, idx);
   if (offset < tables_.size()) {
@@ -1609,6 +1637,266 @@ void GpuPsGraphTable::clear_graph_info(int gpu_id, int idx) {
 void GpuPsGraphTable::clear_graph_info(int idx) {
   for (int i = 0; i < gpu_num; i++) clear_graph_info(i, idx);
 }
+
+void GpuPsGraphTable::clear_neighbor_cache(int gpu_id, int idx) {
+  int offset = get_graph_list_offset(gpu_id, idx);
+  GpuPsNeighborCache* cache = neighbor_caches_[offset];
+  if (cache == NULL) {
+    return;
+  }
+  platform::CUDADeviceGuard guard(resource_->dev_id(gpu_id));
+  delete cache->table;
+  cudaFree(cache->neighbor_list);
+  if (cache->host_buffer != nullptr) {
+    cudaFreeHost(cache->host_buffer);
+  }
+  delete cache;
+  neighbor_caches_[offset] = NULL;
+}
+
+GpuPsNeighborCache* GpuPsGraphTable::neighbor_cache(int gpu_id, int idx) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int offset = get_graph_list_offset(gpu_id, idx);
+  if (neighbor_caches_[offset] != NULL) {
+    return neighbor_caches_[offset];
+  }
+  PADDLE_ENFORCE_LT(
+      FLAGS_gpugraph_neighbor_cache_size,
+      static_cast<int64_t>(UINT32_MAX),
+      common::errors::InvalidArgument(
+          "gpugraph_neighbor_cache_size should be less than 2^32, since the "
+          "neighbor offsets are 32bit, but got %ld.",
+          FLAGS_gpugraph_neighbor_cache_size));
+  platform::CUDADeviceGuard guard(resource_->dev_id(gpu_id));
+  auto stream = get_local_stream(gpu_id);
+  GpuPsNeighborCache* cache = new GpuPsNeighborCache();
+  cache->neighbor_capacity = FLAGS_gpugraph_neighbor_cache_size;
+  // the table is sized for a mean degree of 8 of the cached nodes
+  cache->node_capacity =
+      std::max(cache->neighbor_capacity / 8, static_cast<int64_t>(1));
+  cache->table = new HashTable<uint64_t, uint64_t>(
+      cache->node_capacity / load_factor_, stream);
+  cudaError_t status =
+      cudaMalloc(&cache->neighbor_list,
+                 cache->neighbor_capacity * sizeof(uint64_t));
+  PADDLE_ENFORCE_EQ(status,
+                    cudaSuccess,
+                    common::errors::ResourceExhausted(
+                        "failed to allocate the neighbor cache on gpu %d",
+                        resource_->dev_id(gpu_id)));
+  VLOG(0) << "allocate the neighbor cache of " << cache->neighbor_capacity
+          << " neighbors, " << cache->node_capacity << " nodes on gpu "
+          << resource_->dev_id(gpu_id) << ", edge_idx " << idx;
+  neighbor_caches_[offset] = cache;
+  return cache;
+}
+
+// Grows the pinned host buffer of cache to size ids at least.
+static void reserve_neighbor_cache_host_buffer(GpuPsNeighborCache* cache,
+                                               size_t size) {
+  if (cache->host_buffer_size >= size) {
+    return;
+  }
+  if (cache->host_buffer != nullptr) {
+    CUDA_CHECK(cudaFreeHost(cache->host_buffer));
+  }
+  size = std::max(size, cache->host_buffer_size * 2);
+  CUDA_CHECK(cudaHostAlloc(reinterpret_cast<void**>(&cache->host_buffer),
+                           size * sizeof(uint64_t),
+                           cudaHostAllocMapped));
+  cache->host_buffer_size = size;
+}
+
+/*
+Samples the number_on_cpu nodes of cpu_keys, collected by get_cpu_id_index,
+which are in the neighbor cache of gpu_id, and collects the nodes not cached
+into cpu_keys and cpu_index again. Returns the number of them.
+*/
+int GpuPsGraphTable::sample_from_neighbor_cache(int gpu_id,
+                                                int idx,
+                                                uint64_t* key,
+                                                int len,
+                                                int sample_size,
+                                                int neighbor_size_limit,
+                                                uint64_t* val,
+                                                int* actual_sample_size,
+                                                uint64_t* cpu_keys,
+                                                int* cpu_index,
+                                                int number_on_cpu) {
+  GpuPsNeighborCache* cache = neighbor_cache(gpu_id, idx);
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  if (cache->node_size == 0) {
+    return number_on_cpu;
+  }
+  phi::GPUPlace place = phi::GPUPlace(resource_->dev_id(gpu_id));
+  platform::CUDADeviceGuard guard(resource_->dev_id(gpu_id));
+  auto stream = resource_->local_stream(gpu_id, 0);
+  auto node_info =
+      memory::Alloc(place,
+                    number_on_cpu * sizeof(uint64_t),
+                    phi::Stream(reinterpret_cast<phi::StreamId>(stream)));
+  auto cache_ac =
+      memory::Alloc(place,
+                    number_on_cpu * sizeof(int),
+                    phi::Stream(reinterpret_cast<phi::StreamId>(stream)));
+  auto cache_val =
+      memory::Alloc(place,
+                    number_on_cpu * sample_size * sizeof(uint64_t),
+                    phi::Stream(reinterpret_cast<phi::StreamId>(stream)));
+  uint64_t* node_info_ptr = reinterpret_cast<uint64_t*>(node_info->ptr());
+  int* cache_ac_ptr = reinterpret_cast<int*>(cache_ac->ptr());
+  uint64_t* cache_val_ptr = reinterpret_cast<uint64_t*>(cache_val->ptr());
+
+  // If not found, the neighbor size is 0, and the actual sample size is -1.
+  CUDA_CHECK(cudaMemsetAsync(
+      node_info_ptr, 0, number_on_cpu * sizeof(uint64_t), stream));
+  cache->table->get(cpu_keys, node_info_ptr, number_on_cpu, stream);
+
+  GpuPsCommGraph graph;
+  graph.neighbor_list = cache->neighbor_list;
+  graph.neighbor_size = cache->neighbor_size;
+  constexpr int WARP_SIZE = 32;
+  constexpr int BLOCK_WARPS = 128 / WARP_SIZE;
+  constexpr int TILE_SIZE = BLOCK_WARPS * 16;
+  const dim3 block(WARP_SIZE, BLOCK_WARPS);
+  const dim3 grid((number_on_cpu + TILE_SIZE - 1) / TILE_SIZE);
+  neighbor_sample_kernel_walking<WARP_SIZE, BLOCK_WARPS, TILE_SIZE>
+      <<<grid, block, 0, stream>>>(
+          graph,
+          reinterpret_cast<GpuPsNodeInfo*>(node_info_ptr),
+          cache_ac_ptr,
+          cache_val_ptr,
+          sample_size,
+          number_on_cpu,
+          neighbor_size_limit,
+          -1);
+  copy_cache_sample_to_final_place<WARP_SIZE, BLOCK_WARPS, TILE_SIZE>
+      <<<grid, block, 0, stream>>>(cache_val_ptr,
+                                   cache_ac_ptr,
+                                   val,
+                                   actual_sample_size,
+                                   cpu_index + 1,
+                                   number_on_cpu,
+                                   sample_size);
+
+  int grid_size = (len - 1) / block_size_ + 1;
+  CUDA_CHECK(cudaMemsetAsync(cpu_index, 0, sizeof(int), stream));
+  get_cpu_id_index<<<grid_size, block_size_, 0, stream>>>(
+      key, actual_sample_size, cpu_keys, cpu_index, cpu_index + 1, len);
+  int number_not_cached = 0;
+  CUDA_CHECK(cudaMemcpyAsync(&number_not_cached,
+                             cpu_index,
+                             sizeof(int),
+                             cudaMemcpyDeviceToHost,
+                             stream));
+  CUDA_CHECK(cudaStreamSynchronize(stream));
+  VLOG(2) << "neighbor cache of gpu " << gpu_id << ", edge_idx " << idx
+          << ": " << number_on_cpu - number_not_cached << " of "
+          << number_on_cpu << " cpu nodes hit";
+  return number_not_cached;
+}
+
+/*
+Counts the cpu queries of the nodes of cpu_keys, and caches the adjacency lists
+of the ones queried FLAGS_gpugraph_neighbor_cache_admit_count times while the
+cache has room. The nodes without neighbors are not cached, since they are
+misses of the cache table as well.
+*/
+void GpuPsGraphTable::update_neighbor_cache(int gpu_id,
+                                            int idx,
+                                            const uint64_t* cpu_keys,
+                                            int number_on_cpu) {
+  GpuPsNeighborCache* cache = neighbor_cache(gpu_id, idx);
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  if (cache->node_size >= cache->node_capacity ||
+      cache->neighbor_size >= cache->neighbor_capacity) {
+    return;
+  }
+  std::vector<uint64_t> admitted_keys;
+  int64_t node_room = cache->node_capacity - cache->node_size;
+  for (int i = 0; i < number_on_cpu; ++i) {
+    uint32_t& count = cache->query_count[cpu_keys[i]];
+    if (count == UINT32_MAX) {
+      continue;
+    }
+    if (++count >= static_cast<uint32_t>(
+                       FLAGS_gpugraph_neighbor_cache_admit_count) &&
+        static_cast<int64_t>(admitted_keys.size()) < node_room) {
+      admitted_keys.push_back(cpu_keys[i]);
+      count = UINT32_MAX;
+    }
+  }
+  if (admitted_keys.empty()) {
+    return;
+  }
+
+  // the adjacency lists of all the admitted nodes in one batch
+  GpuPsCommGraph graph =
+      cpu_graph_table_->make_gpu_ps_graph(idx, admitted_keys);
+  reserve_neighbor_cache_host_buffer(
+      cache, std::max(graph.neighbor_size, static_cast<int64_t>(1)));
+  std::vector<uint64_t> keys;
+  std::vector<GpuPsNodeInfo> node_infos;
+  int64_t neighbor_size = 0;
+  for (int64_t i = 0; i < graph.node_size; ++i) {
+    const GpuPsNodeInfo& info = graph.node_info_list[i];
+    if (info.neighbor_size == 0 ||
+        cache->neighbor_size + neighbor_size + info.neighbor_size >
+            cache->neighbor_capacity) {
+      continue;
+    }
+    memcpy(cache->host_buffer + neighbor_size,
+           graph.neighbor_list + info.neighbor_offset,
+           info.neighbor_size * sizeof(uint64_t));
+    GpuPsNodeInfo cached_info;
+    cached_info.neighbor_size = info.neighbor_size;
+    cached_info.neighbor_offset = cache->neighbor_size + neighbor_size;
+    keys.push_back(graph.node_list[i]);
+    node_infos.push_back(cached_info);
+    neighbor_size += info.neighbor_size;
+  }
+  graph.release_on_cpu();
+  if (keys.empty()) {
+    return;
+  }
+
+  phi::GPUPlace place = phi::GPUPlace(resource_->dev_id(gpu_id));
+  platform::CUDADeviceGuard guard(resource_->dev_id(gpu_id));
+  auto stream = resource_->local_stream(gpu_id, 0);
+  auto d_keys =
+      memory::Alloc(place,
+                    keys.size() * sizeof(uint64_t),
+                    phi::Stream(reinterpret_cast<phi::StreamId>(stream)));
+  auto d_node_infos =
+      memory::Alloc(place,
+                    node_infos.size() * sizeof(GpuPsNodeInfo),
+                    phi::Stream(reinterpret_cast<phi::StreamId>(stream)));
+  CUDA_CHECK(cudaMemcpyAsync(cache->neighbor_list + cache->neighbor_size,
+                             cache->host_buffer,
+                             neighbor_size * sizeof(uint64_t),
+                             cudaMemcpyHostToDevice,
+                             stream));
+  CUDA_CHECK(cudaMemcpyAsync(d_keys->ptr(),
+                             keys.data(),
+                             keys.size() * sizeof(uint64_t),
+                             cudaMemcpyHostToDevice,
+                             stream));
+  CUDA_CHECK(cudaMemcpyAsync(d_node_infos->ptr(),
+                             node_infos.data(),
+                             node_infos.size() * sizeof(GpuPsNodeInfo),
+                             cudaMemcpyHostToDevice,
+                             stream));
+  cache->table->insert(reinterpret_cast<uint64_t*>(d_keys->ptr()),
+                       reinterpret_cast<uint64_t*>(d_node_infos->ptr()),
+                       keys.size(),
+                       stream);
+  CUDA_CHECK(cudaStreamSynchronize(stream));
+  cache->node_size += keys.size();
+  cache->neighbor_size += neighbor_size;
+  VLOG(2) << "neighbor cache of gpu " << gpu_id << ", edge_idx " << idx
+          << ": cache " << keys.size() << " nodes, " << cache->node_size
+          << " nodes, " << cache->neighbor_size << " neighbors in all";
+}
 /*
 the parameter std::vector<GpuPsCommGraph> cpu_graph_list is generated by cpu.
 it saves the graph to be saved on each gpu.
@@ -2002,6 +2290,10 @@ void GpuPsGraphTable::build_graph_from_cpu(
 
 NeighborSampleResult GpuPsGraphTable::graph_neighbor_sample_v3(
     NeighborSampleQuery q, bool cpu_switch, bool compress, bool weighted) {
+  // the nodes not in the gpu tables are sampled from the cpu table and cached
+  if (FLAGS_gpugraph_neighbor_cache_size > 0) {
+    cpu_switch = true;
+  }
   if (multi_node_ && FLAGS_enable_graph_multi_node_sampling) {
     // multi node mode
     if (q.sample_step == 1) {
@@ -2441,6 +2733,26 @@ NeighborSampleResult GpuPsGraphTable::graph_neighbor_sample_v2(
                           thrust::raw_pointer_cast(t_index.data()),
                           sizeof(int),
                           cudaMemcpyDeviceToHost));
+    // The neighbor cache keeps the neighbor ids only, so the weighted
+    // sampling always queries the cpu table.
+    GpuPsNeighborCache* cache = nullptr;
+    if (FLAGS_gpugraph_neighbor_cache_size > 0 && !weighted) {
+      cache = neighbor_cache(gpu_id, idx);
+    }
+    if (number_on_cpu > 0 && cache != nullptr) {
+      number_on_cpu = sample_from_neighbor_cache(
+          gpu_id,
+          idx,
+          key,
+          len,
+          sample_size,
+          neighbor_size_limit,
+          val,
+          actual_sample_size,
+          thrust::raw_pointer_cast(t_cpu_keys.data()),
+          thrust::raw_pointer_cast(t_index.data()),
+          number_on_cpu);
+    }
     if (number_on_cpu > 0) {
       uint64_t* cpu_keys = new uint64_t[number_on_cpu];
       CUDA_CHECK(cudaMemcpy(cpu_keys,
@@ -2457,8 +2769,18 @@ NeighborSampleResult GpuPsGraphTable::graph_neighbor_sample_v2(
       int total_cpu_sample_size = std::accumulate(ac.begin(), ac.end(), 0);
       total_cpu_sample_size /= sizeof(uint64_t);
 
-      // Merge buffers into one uint64_t vector.
-      uint64_t* merge_buffers = new uint64_t[total_cpu_sample_size];
+      // Merge buffers into one uint64_t vector. With the neighbor cache, it
+      // is the pinned buffer of the cache, which the kernels read directly.
+      std::unique_lock<std::mutex> cache_lock;
+      uint64_t* merge_buffers = nullptr;
+      if (cache != nullptr) {
+        cache_lock = std::unique_lock<std::mutex>(cache->mutex);
+        reserve_neighbor_cache_host_buffer(
+            cache, std::max(total_cpu_sample_size, 1));
+        merge_buffers = cache->host_buffer;
+      } else {
+        merge_buffers = new uint64_t[total_cpu_sample_size];
+      }
       int start = 0;
       for (int j = 0; j < number_on_cpu; j++) {
         memcpy(merge_buffers + start,
@@ -2468,15 +2790,22 @@ NeighborSampleResult GpuPsGraphTable::graph_neighbor_sample_v2(
       }
 
       // Copy merge_buffers to gpu.
-      thrust::device_vector<uint64_t> gpu_buffers(total_cpu_sample_size);
+      thrust::device_vector<uint64_t> gpu_buffers;
       thrust::device_vector<int> gpu_ac(number_on_cpu);
-      uint64_t* gpu_buffers_ptr = thrust::raw_pointer_cast(gpu_buffers.data());
+      uint64_t* gpu_buffers_ptr = nullptr;
       int* gpu_ac_ptr = thrust::raw_pointer_cast(gpu_ac.data());
-      CUDA_CHECK(cudaMemcpyAsync(gpu_buffers_ptr,
-                                 merge_buffers,
-                                 total_cpu_sample_size * sizeof(uint64_t),
-                                 cudaMemcpyHostToDevice,
-                                 stream));
+      if (cache != nullptr) {
+        CUDA_CHECK(cudaHostGetDevicePointer(
+            reinterpret_cast<void**>(&gpu_buffers_ptr), merge_buffers, 0));
+      } else {
+        gpu_buffers.resize(total_cpu_sample_size);
+        gpu_buffers_ptr = thrust::raw_pointer_cast(gpu_buffers.data());
+        CUDA_CHECK(cudaMemcpyAsync(gpu_buffers_ptr,
+                                   merge_buffers,
+                                   total_cpu_sample_size * sizeof(uint64_t),
+                                   cudaMemcpyHostToDevice,
+                                   stream));
+      }
       CUDA_CHECK(cudaMemcpyAsync(gpu_ac_ptr,
                                  ac.data(),
                                  number_on_cpu * sizeof(int),
@@ -2511,7 +2840,13 @@ NeighborSampleResult GpuPsGraphTable::graph_neighbor_sample_v2(
               number_on_cpu,
               sample_size);
 
-      delete[] merge_buffers;
+      if (cache != nullptr) {
+        CUDA_CHECK(cudaStreamSynchronize(stream));
+        cache_lock.unlock();
+        update_neighbor_cache(gpu_id, idx, cpu_keys, number_on_cpu);
+      } else {
+        delete[] merge_buffers;
+      }
       delete[] cpu_keys;
     }
     CUDA_CHECK(cudaStreamSynchronize(stream));
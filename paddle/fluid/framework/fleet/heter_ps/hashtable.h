@@ -28,9 +28,11 @@ limitations under the License. */
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
 #endif
 #include "paddle/fluid/framework/fleet/heter_ps/feature_value.h"
+#include "paddle/fluid/framework/fleet/heter_ps/hashtable_fwd.h"
 #include "paddle/phi/core/utils/rw_lock.h"
 
 #if defined(PADDLE_WITH_CUDA)
+#include "paddle/fluid/framework/fleet/heter_ps/bucketized_cuckoo_map.cuh.h"
 #include "paddle/fluid/framework/fleet/heter_ps/cudf/concurrent_unordered_map.cuh.h"
 #include "paddle/fluid/framework/fleet/heter_ps/mem_pool.h"
 #include "paddle/fluid/platform/device/gpu/gpu_types.h"
@@ -61,6 +63,32 @@ class TableContainer
                                  std::numeric_limits<KeyType>::max()>(
             stream, capacity, ValType()) {}
 };
+
+template <typename KeyType, typename ValType>
+class CuckooTableContainer
+    : public BucketizedCuckooMap<KeyType,
+                                 ValType,
+                                 std::numeric_limits<KeyType>::max()> {
+ public:
+  CuckooTableContainer(size_t capacity, cudaStream_t stream)
+      : BucketizedCuckooMap<KeyType,
+                            ValType,
+                            std::numeric_limits<KeyType>::max()>(
+            stream, capacity, ValType()) {}
+};
+
+template <typename KeyType, typename ValType, typename Backend>
+struct TableContainerType;
+
+template <typename KeyType, typename ValType>
+struct TableContainerType<KeyType, ValType, DefaultTableBackend> {
+  using type = TableContainer<KeyType, ValType>;
+};
+
+template <typename KeyType, typename ValType>
+struct TableContainerType<KeyType, ValType, CuckooTableBackend> {
+  using type = CuckooTableContainer<KeyType, ValType>;
+};
 #elif defined(PADDLE_WITH_XPU_KP)
 template <typename KeyType, typename ValType>
 class XPUCacheArray {
@@ -110,7 +138,8 @@ class XPUCacheArray {
 };
 #endif
 
-template <typename KeyType, typename ValType>
+// Backend selects the device container, see hashtable_fwd.h.
+template <typename KeyType, typename ValType, typename Backend>
 class HashTable {
  public:
 #if defined(PADDLE_WITH_CUDA)
@@ -241,7 +270,9 @@ class HashTable {
 
  private:
 #if defined(PADDLE_WITH_CUDA)
-  TableContainer<KeyType, ValType>* container_;
+  using Container =
+      typename TableContainerType<KeyType, ValType, Backend>::type;
+  Container* container_;
   cudaStream_t stream_ = 0;
 #elif defined(PADDLE_WITH_XPU_KP)
   XPUCacheArray<KeyType, ValType>* container_;
@@ -0,0 +1,34 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+namespace paddle {
+namespace framework {
+
+// The device containers of HashTable, see hashtable.h:
+//  * DefaultTableBackend: the cudf concurrent_unordered_map with linear
+//    probing on cuda, XPUCacheArray on xpu.
+//  * CuckooTableBackend: BucketizedCuckooMap, the lookups of which probe two
+//    buckets at any load, on cuda.
+struct DefaultTableBackend {};
+struct CuckooTableBackend {};
+
+template <typename KeyType,
+          typename ValType,
+          typename Backend = DefaultTableBackend>
+class HashTable;
+
+}  // end namespace framework
+}  // end namespace paddle
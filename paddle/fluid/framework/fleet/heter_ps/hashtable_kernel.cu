@@ -310,10 +310,11 @@ __global__ void get_key_values_kernel(Table* table,
   }
 }
 
-template <typename KeyType, typename ValType>
-HashTable<KeyType, ValType>::HashTable(size_t capacity, cudaStream_t stream) {
+template <typename KeyType, typename ValType, typename Backend>
+HashTable<KeyType, ValType, Backend>::HashTable(size_t capacity,
+                                                cudaStream_t stream) {
   stream_ = stream;
-  container_ = new TableContainer<KeyType, ValType>(capacity, stream);
+  container_ = new Container(capacity, stream);
   CUDA_RT_CALL(cudaMalloc(reinterpret_cast<void**>(&device_optimizer_config_),
                           sizeof(OptimizerConfig)));
   CUDA_RT_CALL(
@@ -326,14 +327,14 @@ HashTable<KeyType, ValType>::HashTable(size_t capacity, cudaStream_t stream) {
   rwlock_.reset(new phi::RWLock);
 }
 
-template <typename KeyType, typename ValType>
-HashTable<KeyType, ValType>::~HashTable() {
+template <typename KeyType, typename ValType, typename Backend>
+HashTable<KeyType, ValType, Backend>::~HashTable() {
   delete container_;
   cudaFree(device_optimizer_config_);
 }
 
-template <typename KeyType, typename ValType>
-void HashTable<KeyType, ValType>::set_sparse_sgd(
+template <typename KeyType, typename ValType, typename Backend>
+void HashTable<KeyType, ValType, Backend>::set_sparse_sgd(
     const OptimizerConfig& optimizer_config) {
   host_optimizer_config_.set_sparse_sgd(optimizer_config);
   cudaMemcpyAsync(device_optimizer_config_,
@@ -344,8 +345,8 @@ void HashTable<KeyType, ValType>::set_sparse_sgd(
   cudaStreamSynchronize(stream_);
 }
 
-template <typename KeyType, typename ValType>
-void HashTable<KeyType, ValType>::set_embedx_sgd(
+template <typename KeyType, typename ValType, typename Backend>
+void HashTable<KeyType, ValType, Backend>::set_embedx_sgd(
     const OptimizerConfig& optimizer_config) {
   host_optimizer_config_.set_embedx_sgd(optimizer_config);
   cudaMemcpyAsync(device_optimizer_config_,
@@ -356,17 +357,17 @@ void HashTable<KeyType, ValType>::set_embedx_sgd(
   cudaStreamSynchronize(stream_);
 }
 
-template <typename KeyType, typename ValType>
-void HashTable<KeyType, ValType>::show() {
+template <typename KeyType, typename ValType, typename Backend>
+void HashTable<KeyType, ValType, Backend>::show() {
   container_->print();
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::get(const KeyType* d_keys,
-                                      ValType* d_vals,
-                                      size_t len,
-                                      StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::get(const KeyType* d_keys,
+                                               ValType* d_vals,
+                                               size_t len,
+                                               StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -375,13 +376,13 @@ void HashTable<KeyType, ValType>::get(const KeyType* d_keys,
       container_, d_keys, d_vals, len);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType, typename GPUAccessor>
-void HashTable<KeyType, ValType>::get(const KeyType* d_keys,
-                                      char* d_vals,
-                                      size_t len,
-                                      StreamType stream,
-                                      const GPUAccessor& fv_accessor) {
+void HashTable<KeyType, ValType, Backend>::get(const KeyType* d_keys,
+                                               char* d_vals,
+                                               size_t len,
+                                               StreamType stream,
+                                               const GPUAccessor& fv_accessor) {
   if (len == 0) {
     return;
   }
@@ -396,12 +397,12 @@ void HashTable<KeyType, ValType>::get(const KeyType* d_keys,
   }
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::get_ranks(const KeyType* d_keys,
-                                            ValType* d_vals,
-                                            size_t len,
-                                            StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::get_ranks(const KeyType* d_keys,
+                                                     ValType* d_vals,
+                                                     size_t len,
+                                                     StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -410,13 +411,13 @@ void HashTable<KeyType, ValType>::get_ranks(const KeyType* d_keys,
       container_, d_keys, d_vals, len);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
-                                         size_t len,
-                                         uint64_t* global_num,
-                                         int dft_val,
-                                         StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::insert(const KeyType* d_keys,
+                                                  size_t len,
+                                                  uint64_t* global_num,
+                                                  int dft_val,
+                                                  StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -425,13 +426,13 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
       container_, d_keys, len, dft_val, global_num);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
-                                         const ValType* d_vals,
-                                         size_t len,
-                                         uint64_t* global_num,
-                                         StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::insert(const KeyType* d_keys,
+                                                  const ValType* d_vals,
+                                                  size_t len,
+                                                  uint64_t* global_num,
+                                                  StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -440,12 +441,12 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
       container_, d_keys, d_vals, len, global_num);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
-                                         const ValType* d_vals,
-                                         size_t len,
-                                         StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::insert(const KeyType* d_keys,
+                                                  const ValType* d_vals,
+                                                  size_t len,
+                                                  StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -454,11 +455,11 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
       container_, d_keys, d_vals, len);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::get_keys(KeyType* d_out,
-                                           uint64_t* global_cursor,
-                                           StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::get_keys(KeyType* d_out,
+                                                    uint64_t* global_cursor,
+                                                    StreamType stream) {
   size_t len = container_->size();
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
   KeyType unuse_key = std::numeric_limits<KeyType>::max();
@@ -467,12 +468,13 @@ void HashTable<KeyType, ValType>::get_keys(KeyType* d_out,
       container_, d_out, global_cursor, unuse_key);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::get_key_values(KeyType* d_keys,
-                                                 ValType* d_vals,
-                                                 uint64_t* global_cursor,
-                                                 StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::get_key_values(
+    KeyType* d_keys,
+    ValType* d_vals,
+    uint64_t* global_cursor,
+    StreamType stream) {
   const int BLOCK_SIZE = 128;
   size_t len = container_->size();
   const int grid_size = (len - 1) / BLOCK_SIZE_ + 1;
@@ -482,14 +484,14 @@ void HashTable<KeyType, ValType>::get_key_values(KeyType* d_keys,
       container_, d_keys, d_vals, global_cursor, unuse_key);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
-                                         size_t len,
-                                         char* pool,
-                                         size_t feature_value_size,
-                                         size_t start_index,
-                                         StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::insert(const KeyType* d_keys,
+                                                  size_t len,
+                                                  char* pool,
+                                                  size_t feature_value_size,
+                                                  size_t start_index,
+                                                  StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -501,19 +503,20 @@ void HashTable<KeyType, ValType>::insert(const KeyType* d_keys,
       container_, d_keys, len, pool, feature_value_size, start_index);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename StreamType>
-void HashTable<KeyType, ValType>::dump_to_cpu(int devid, StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::dump_to_cpu(int devid,
+                                                       StreamType stream) {
   container_->prefetch(cudaCpuDeviceId, stream);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename Sgd, typename StreamType>
-void HashTable<KeyType, ValType>::update(const KeyType* d_keys,
-                                         const float* d_grads,
-                                         size_t len,
-                                         Sgd sgd,
-                                         StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::update(const KeyType* d_keys,
+                                                  const float* d_grads,
+                                                  size_t len,
+                                                  Sgd sgd,
+                                                  StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -522,13 +525,13 @@ void HashTable<KeyType, ValType>::update(const KeyType* d_keys,
       container_, *device_optimizer_config_, d_keys, d_grads, len, sgd);
 }
 
-template <typename KeyType, typename ValType>
+template <typename KeyType, typename ValType, typename Backend>
 template <typename Sgd, typename StreamType>
-void HashTable<KeyType, ValType>::update(const KeyType* d_keys,
-                                         const char* d_grads,
-                                         size_t len,
-                                         Sgd sgd,
-                                         StreamType stream) {
+void HashTable<KeyType, ValType, Backend>::update(const KeyType* d_keys,
+                                                  const char* d_grads,
+                                                  size_t len,
+                                                  Sgd sgd,
+                                                  StreamType stream) {
   if (len == 0) {
     return;
   }
@@ -732,6 +735,21 @@ template void HashTable<uint64_t, float*>::update<
                   SparseAdamSharedOptimizer<CommonFeatureValueAccessor> sgd,
                   cudaStream_t stream);
 
+template class HashTable<uint64_t, uint64_t, CuckooTableBackend>;
+template class HashTable<uint64_t, float*, CuckooTableBackend>;
+
+template void HashTable<uint64_t, uint64_t, CuckooTableBackend>::get<
+    cudaStream_t>(const uint64_t* d_keys,
+                  uint64_t* d_vals,
+                  size_t len,
+                  cudaStream_t stream);
+
+template void HashTable<uint64_t, uint64_t, CuckooTableBackend>::insert<
+    cudaStream_t>(const uint64_t* d_keys,
+                  const uint64_t* d_vals,
+                  size_t len,
+                  cudaStream_t stream);
+
 // template void HashTable<uint64_t,
 // paddle::framework::FeatureValue>::update<
 //    Optimizer<paddle::framework::FeatureValue,
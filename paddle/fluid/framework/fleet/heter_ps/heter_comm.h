@@ -438,6 +438,14 @@ class HeterComm {
     size_t total_keys_ = 0;
     size_t local_keys_ = 0;
     size_t remote_keys_ = 0;
+
+    // the automatic sparse inner gather: its mode, the pulls so far, and the
+    // keys and the unique keys after the inner gather of the last probe
+    bool use_inner_gather_ = false;
+    size_t pull_count_ = 0;
+    size_t probe_keys_ = 0;
+    size_t probe_uniq_keys_ = 0;
+    std::shared_ptr<memory::Allocation> d_probe_buf = nullptr;
   };
 
   void init_path();
@@ -580,6 +588,16 @@ class HeterComm {
                                      const size_t& value_bytes,
                                      void* d_tmp_vals,
                                      const cudaStream_t& stream);
+  // Whether the pulls and pushes of the gpu gather the keys of its node
+  // first, by FLAGS_enable_sparse_inner_gather or by the last probe.
+  bool use_inner_gather(const int& gpu_id) const;
+  // Sums the keys and the unique keys of a probe over all the gpus of all the
+  // nodes, and sets the inner gather mode of the following pulls and pushes
+  // from them, the same on every gpu.
+  void update_inner_gather_mode(const int& gpu_id,
+                                const size_t& fea_num,
+                                const size_t& uniq_num,
+                                const cudaStream_t& stream);
   void recalc_local_and_remote_size(const int& gpu_id,
                                     const size_t& pull_size,
                                     const size_t& node_num,
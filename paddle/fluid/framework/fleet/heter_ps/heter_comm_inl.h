@@ -35,6 +35,9 @@ COMMON_DECLARE_int32(gpugraph_dedup_pull_push_mode);
 COMMON_DECLARE_bool(enable_tracker_all2all);
 COMMON_DECLARE_bool(enable_all2all_use_fp16);
 COMMON_DECLARE_bool(enable_sparse_inner_gather);
+COMMON_DECLARE_bool(enable_sparse_inner_gather_auto);
+COMMON_DECLARE_int32(sparse_inner_gather_probe_interval);
+COMMON_DECLARE_double(sparse_inner_gather_min_dedup_ratio);
 COMMON_DECLARE_bool(graph_embedding_split_infer_mode);
 
 namespace paddle {
@@ -227,7 +230,29 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::init_path() {
       }
     }
   } else {
-    VLOG(0) << "init path with topo aware";
+    // the routes by the bandwidths of the links detected, or relayed by the
+    // device of (dev_id + 4) % device_num_ between the groups of 4 devices
+    std::vector<std::vector<std::vector<int>>> routes;
+#if defined(PADDLE_WITH_CUDA)
+    const auto &link_bandwidth = rdma_checker_->link_bandwidth();
+    if (!link_bandwidth.empty()) {
+      std::vector<std::vector<double>> bandwidth(
+          total_device, std::vector<double>(total_device, 0));
+      for (int i = 0; i < total_device; ++i) {
+        for (int j = 0; j < total_device; ++j) {
+          size_t from = resource_->dev_id(i);
+          size_t to = resource_->dev_id(j);
+          if (from < link_bandwidth.size() && to < link_bandwidth.size()) {
+            bandwidth[i][j] = link_bandwidth[from][to];
+          }
+        }
+      }
+      // a relay waits for the copy to it, about the copy of a 100GB/s link
+      routes = ComputeLinkRoutes(bandwidth, 0.01);
+    }
+#endif
+    VLOG(0) << "init path with topo aware, "
+            << (routes.empty() ? "fixed relay" : "detected link bandwidth");
     for (int i = 0; i < total_device; ++i) {
       path_[i].resize(total_device);
       for (int j = 0; j < total_device; ++j) {
@@ -235,17 +260,28 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::init_path() {
         int from = resource_->dev_id(i);
         int to = resource_->dev_id(j);
 
+        std::vector<int> relays;
+        if (!routes.empty()) {
+          relays = routes[i][j];
+        } else if (need_transfer(from, to)) {
+          relays.push_back(
+              resource_->get_index_by_devid(get_transfer_devid(from)));
+        }
         int transfer_id = i;
-        if (need_transfer(from, to)) {
-          transfer_id = resource_->get_index_by_devid(get_transfer_devid(from));
+        for (int relay : relays) {
           nodes.push_back(Node());
           Node &node = nodes.back();
-          node.in_stream = resource_->remote_stream(i, transfer_id);
-          node.out_stream = resource_->remote_stream(transfer_id, i);
+          node.in_stream = resource_->remote_stream(transfer_id, relay);
+          node.out_stream = resource_->remote_stream(relay, transfer_id);
           node.key_storage = NULL;
           node.val_storage = NULL;
           node.sync = 1;
-          node.dev_num = transfer_id;
+          node.dev_num = relay;
+          transfer_id = relay;
+        }
+        if (relays.size() > 0) {
+          VLOG(3) << "path from device " << from << " to " << to << " with "
+                  << relays.size() << " relays";
         }
         nodes.push_back(Node());
         Node &node = nodes.back();
@@ -2377,6 +2413,70 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::pull_one_table(
         (gpu_id == 0));
   }
 }
+template <typename KeyType,
+          typename ValType,
+          typename GradType,
+          typename GPUAccessor>
+bool HeterComm<KeyType, ValType, GradType, GPUAccessor>::use_inner_gather(
+    const int &gpu_id) const {
+  return FLAGS_enable_sparse_inner_gather ||
+         (FLAGS_enable_sparse_inner_gather_auto &&
+          storage_[gpu_id].use_inner_gather_);
+}
+template <typename KeyType,
+          typename ValType,
+          typename GradType,
+          typename GPUAccessor>
+void HeterComm<KeyType, ValType, GradType, GPUAccessor>::
+    update_inner_gather_mode(const int &gpu_id,
+                             const size_t &fea_num,
+                             const size_t &uniq_num,
+                             const cudaStream_t &stream) {
+  auto &loc = storage_[gpu_id];
+  loc.probe_keys_ = fea_num;
+  loc.probe_uniq_keys_ = uniq_num;
+  // the keys of the node, and the unique ones of its disjoint shards
+  barrier_.wait();
+  uint64_t h_counts[2] = {0, 0};
+  for (int i = 0; i < device_num_; ++i) {
+    h_counts[0] += storage_[i].probe_keys_;
+    h_counts[1] += storage_[i].probe_uniq_keys_;
+  }
+  barrier_.wait();
+
+  // every node takes the same mode, the all2all of the pulls and the pushes
+  // differ between the two
+  uint64_t *d_counts = loc.template alloc_cache<uint64_t>(2, loc.d_probe_buf);
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(d_counts,
+                                             h_counts,
+                                             2 * sizeof(uint64_t),
+                                             cudaMemcpyHostToDevice,
+                                             stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+  auto &comm = nccl_inter_comms_[gpu_id];
+  auto nccl_stream = resource_->comm_stream(gpu_id, 0);
+  PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::ncclAllReduce(
+      d_counts, d_counts, 2, ncclUint64, ncclSum, comm, nccl_stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpyAsync(h_counts,
+                                             d_counts,
+                                             2 * sizeof(uint64_t),
+                                             cudaMemcpyDeviceToHost,
+                                             nccl_stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(nccl_stream));
+
+  double dedup_ratio =
+      h_counts[0] == 0
+          ? 0.0
+          : 1.0 - static_cast<double>(h_counts[1]) / h_counts[0];
+  bool use_inner_gather =
+      dedup_ratio >= FLAGS_sparse_inner_gather_min_dedup_ratio;
+  if (gpu_id == 0 && use_inner_gather != loc.use_inner_gather_) {
+    VLOG(0) << "sparse inner gather " << (use_inner_gather ? "on" : "off")
+            << ", keys: " << h_counts[0] << ", unique in the nodes: "
+            << h_counts[1] << ", dedup ratio: " << dedup_ratio;
+  }
+  loc.use_inner_gather_ = use_inner_gather;
+}
 template <typename KeyType,
           typename ValType,
           typename GradType,
@@ -2392,13 +2492,23 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::pull_sparse_all2all(
   size_t pull_size = 0;
   size_t value_bytes = pull_type_size_;
   loc.all2all_span_.Resume();
+  // the automatic mode measures the keys its inner gather dedups every
+  // sparse_inner_gather_probe_interval pulls, by doing it
+  bool probe = !FLAGS_enable_sparse_inner_gather &&
+               FLAGS_enable_sparse_inner_gather_auto &&
+               loc.pull_count_++ %
+                       std::max(FLAGS_sparse_inner_gather_probe_interval, 1) ==
+                   0;
   // enable inner gather
-  if (FLAGS_enable_sparse_inner_gather) {
+  if (probe || use_inner_gather(gpu_id)) {
     loc.inner_span_.Resume();
     // gather keys of all gpu and select shard key
     gather_inner_size =
         gather_inner_keys_by_copy(gpu_id, fea_num, d_keys, stream);
     loc.inner_span_.Pause();
+    if (probe) {
+      update_inner_gather_mode(gpu_id, fea_num, gather_inner_size, stream);
+    }
 
     loc.node_span_.Resume();
     // all2all mode begins. init resource, partition keys, pull vals by all2all
@@ -3435,8 +3545,9 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::push_sparse_all2all(
   size_t inter_push_len = 0;
   size_t node_push_len = 0;
   size_t value_bytes = grad_type_size_;
+  bool inner_gather = use_inner_gather(gpu_id);
   // enable inner gather
-  if (FLAGS_enable_sparse_inner_gather) {
+  if (inner_gather) {
     my_cache.inner_span_.Resume();
     inter_push_len =
         gather_inner_gradient_by_copy(gpu_id,
@@ -3562,7 +3673,7 @@ void HeterComm<KeyType, ValType, GradType, GPUAccessor>::push_sparse_all2all(
         stream,
         (gpu_id == 0));
   }
-  if (FLAGS_enable_sparse_inner_gather) {
+  if (inner_gather) {
     // update all grad
     update_one_table(gpu_id,
                      my_cache.d_merged_keys,
@@ -15,6 +15,12 @@ limitations under the License. */
 #ifdef PADDLE_WITH_HETERPS
 #include "paddle/fluid/framework/fleet/heter_ps/heter_resource.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #endif
@@ -141,6 +147,75 @@ static std::string execute_cmd_result(const std::string &cmd) {
   fprintf(stderr, "cmd: %s, ret:\n%s\n", cmd.c_str(), out.c_str());
   return paddle::string::trim_spaces(out);
 }
+// the estimated bandwidth of a link of nvidia-smi topo -m, e.g. NV12 is 12
+// bonded nvlinks, and SYS crosses the interconnect between the numa nodes
+static double gpu_link_bandwidth(const std::string &tag) {
+  if (strncmp(tag.c_str(), "NV", 2) == 0) {
+    return 25.0 * std::max(atoi(tag.c_str() + 2), 1);
+  }
+  if (tag == "PIX") {
+    return 16.0;
+  }
+  if (tag == "PXB") {
+    return 12.0;
+  }
+  if (tag == "PHB") {
+    return 10.0;
+  }
+  if (tag == "NODE") {
+    return 8.0;
+  }
+  return 4.0;
+}
+
+std::vector<std::vector<std::vector<int>>> ComputeLinkRoutes(
+    const std::vector<std::vector<double>> &bandwidth, double relay_cost) {
+  size_t n = bandwidth.size();
+  const double kInf = std::numeric_limits<double>::infinity();
+  // floyd-warshall on the cost, next[i][j] is the next device from i to j
+  std::vector<std::vector<double>> cost(n, std::vector<double>(n, kInf));
+  std::vector<std::vector<int>> next(n, std::vector<int>(n, -1));
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      if (i == j) {
+        cost[i][j] = 0;
+        next[i][j] = j;
+      } else if (bandwidth[i][j] > 0) {
+        cost[i][j] = 1.0 / bandwidth[i][j];
+        next[i][j] = j;
+      }
+    }
+  }
+  for (size_t k = 0; k < n; ++k) {
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < n; ++j) {
+        if (i == k || j == k) {
+          continue;
+        }
+        double relay = cost[i][k] + cost[k][j] + relay_cost;
+        if (relay < cost[i][j]) {
+          cost[i][j] = relay;
+          next[i][j] = next[i][k];
+        }
+      }
+    }
+  }
+  std::vector<std::vector<std::vector<int>>> routes(
+      n, std::vector<std::vector<int>>(n));
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      // the devices not linked at all are copied directly
+      if (next[i][j] < 0) {
+        continue;
+      }
+      for (int k = next[i][j]; k != static_cast<int>(j); k = next[k][j]) {
+        routes[i][j].push_back(k);
+      }
+    }
+  }
+  return routes;
+}
+
 #if defined(PADDLE_WITH_CUDA)
 static std::shared_ptr<GpuRDMAChecker> g_checker = nullptr;
 GpuRDMAChecker *GpuRDMAChecker::get(int device_num) {
@@ -186,12 +261,28 @@ bool GpuRDMAChecker::check_device_status(const int &device_count,
   std::vector<std::string> gpu_mlxs;
   gpu_status->resize(device_count, 0);
   gpu_mlxs.resize(device_count);
+  std::vector<std::vector<double>> link_bandwidth(
+      device_count, std::vector<double>(device_count, 0));
+  int gpu_rows = 0;
   for (auto line : lines) {
     std::vector<std::string> tags = paddle::string::split_string(line);
     if (tags.size() < static_cast<size_t>(device_count + 1)) {
       continue;
     }
     std::string &card_name = tags[0];
+    // GPU1  NV12  X  NV12 ..., and not the header line GPU0  GPU1 ...
+    if (strncmp(card_name.c_str(), "GPU", 3) == 0 &&
+        strncmp(tags[1].c_str(), "GPU", 3) != 0) {
+      int row = atoi(card_name.c_str() + 3);
+      if (row >= 0 && row < device_count) {
+        for (int j = 0; j < device_count; ++j) {
+          if (j != row) {
+            link_bandwidth[row][j] = gpu_link_bandwidth(tags[j + 1]);
+          }
+        }
+        ++gpu_rows;
+      }
+    }
     if (strncmp(card_name.c_str(), "GPU0", 4) == 0) {
       // check topo_aware
       topo_aware_ = false;
@@ -220,6 +311,9 @@ bool GpuRDMAChecker::check_device_status(const int &device_count,
       gpu_mlxs[j].append(card_name);
     }
   }
+  if (gpu_rows == device_count) {
+    link_bandwidth_ = link_bandwidth;
+  }
   int not_trans_cnt = 0;
   int need_trans_cnt = 0;
   // check all rdma
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <memory>
 #include <vector>
 
+#include "paddle/fluid/framework/fleet/heter_ps/hashtable_fwd.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #endif
@@ -111,6 +112,11 @@ class GpuRDMAChecker {
   int device_num(void) { return device_num_; }
   // topo_aware
   bool topo_aware(void) { return topo_aware_; }
+  // the estimated bandwidths, GB/s, between the gpus by nvidia-smi topo -m,
+  // empty if the topo is not detected
+  const std::vector<std::vector<double>>& link_bandwidth(void) {
+    return link_bandwidth_;
+  }
 
  private:
   bool check_device_status(const int& device_count,
@@ -119,14 +125,19 @@ class GpuRDMAChecker {
  private:
   int device_num_ = 0;
   bool topo_aware_ = false;
+  std::vector<std::vector<double>> link_bandwidth_;
   // rdma
   bool rdma_trans_ = false;
   std::vector<int> rdma_status_;
 };
 #endif
 
-template <typename KeyType, typename ValType>
-class HashTable;
+// Computes the routes between the devices linked with bandwidth[i][j], GB/s.
+// The hops of a path are copied one after another, so a route minimizes the
+// sum of 1 / bandwidth of its hops plus relay_cost for each relay device.
+// routes[i][j] is the relay devices from i to j, empty for the direct link.
+std::vector<std::vector<std::vector<int>>> ComputeLinkRoutes(
+    const std::vector<std::vector<double>>& bandwidth, double relay_cost);
 
 class HeterPsResource {
  public:
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/framework/fleet/heter_ps/feature_value.h"
+#include "paddle/fluid/framework/fleet/heter_ps/hashtable.h"
 #include "paddle/fluid/framework/fleet/heter_ps/heter_comm.h"
 #include "paddle/fluid/framework/fleet/heter_ps/heter_resource.h"
 #include "paddle/fluid/framework/fleet/heter_ps/optimizer.cuh.h"
@@ -112,3 +113,79 @@ TEST(TEST_FLEET, heter_comm) {
   cudaFree(push_keys);
   cudaFree(push_vals);
 }
+
+// the table throughputs of insert, get and update, in million keys per second
+template <typename Backend>
+void BenchmarkHashTable(size_t capacity, double load_factor) {
+  size_t len = static_cast<size_t>(capacity * load_factor);
+  std::vector<uint64_t> h_keys(len);
+  std::vector<uint64_t> h_vals(len);
+  for (size_t i = 0; i < len; ++i) {
+    h_keys[i] = i * 2654435761ULL + 1;
+    h_vals[i] = i;
+  }
+  cudaStream_t stream;
+  cudaStreamCreate(&stream);
+  uint64_t* d_keys;
+  uint64_t* d_vals;
+  cudaMalloc(&d_keys, len * sizeof(uint64_t));
+  cudaMalloc(&d_vals, len * sizeof(uint64_t));
+  cudaMemcpy(
+      d_keys, h_keys.data(), len * sizeof(uint64_t), cudaMemcpyHostToDevice);
+  cudaMemcpy(
+      d_vals, h_vals.data(), len * sizeof(uint64_t), cudaMemcpyHostToDevice);
+
+  HashTable<uint64_t, uint64_t, Backend> table(capacity, stream);
+  cudaEvent_t start, stop;
+  cudaEventCreate(&start);
+  cudaEventCreate(&stop);
+  float insert_ms = 0, get_ms = 0, update_ms = 0;
+
+  cudaEventRecord(start, stream);
+  table.insert(d_keys, d_vals, len, stream);
+  cudaEventRecord(stop, stream);
+  cudaEventSynchronize(stop);
+  cudaEventElapsedTime(&insert_ms, start, stop);
+
+  cudaEventRecord(start, stream);
+  table.get(d_keys, d_vals, len, stream);
+  cudaEventRecord(stop, stream);
+  cudaEventSynchronize(stop);
+  cudaEventElapsedTime(&get_ms, start, stop);
+
+  std::vector<uint64_t> result(len);
+  cudaMemcpy(
+      result.data(), d_vals, len * sizeof(uint64_t), cudaMemcpyDeviceToHost);
+  for (size_t i = 0; i < len; ++i) {
+    ASSERT_EQ(result[i], h_vals[i]);
+  }
+
+  // the keys are all in the table, so the inserts replace the values
+  cudaEventRecord(start, stream);
+  table.insert(d_keys, d_vals, len, stream);
+  cudaEventRecord(stop, stream);
+  cudaEventSynchronize(stop);
+  cudaEventElapsedTime(&update_ms, start, stop);
+
+  std::cout << "load factor " << load_factor << ": insert "
+            << len / insert_ms / 1000 << ", get " << len / get_ms / 1000
+            << ", update " << len / update_ms / 1000 << " Mkeys/s"
+            << std::endl;
+
+  cudaEventDestroy(start);
+  cudaEventDestroy(stop);
+  cudaFree(d_keys);
+  cudaFree(d_vals);
+  cudaStreamDestroy(stream);
+}
+
+TEST(TEST_FLEET, hashtable_backends) {
+  paddle::platform::CUDADeviceGuard guard(0);
+  size_t capacity = 1 << 24;
+  for (double load_factor : {0.5, 0.75, 0.9}) {
+    std::cout << "default backend, ";
+    BenchmarkHashTable<DefaultTableBackend>(capacity, load_factor);
+    std::cout << "cuckoo backend, ";
+    BenchmarkHashTable<CuckooTableBackend>(capacity, load_factor);
+  }
+}
@@ -26,6 +26,11 @@ namespace framework {
 
 std::shared_ptr<Metric> Metric::s_instance_ = nullptr;
 
+uint64_t BasicAucCalculator::next_id() {
+  static std::atomic<uint64_t> id{0};
+  return id++;
+}
+
 void BasicAucCalculator::init(int table_size) {
   set_table_size(table_size);
 
@@ -33,6 +38,12 @@ void BasicAucCalculator::init(int table_size) {
   for (auto& item : _table) {
     item = std::vector<double>();
   }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  {
+    std::lock_guard<std::mutex> lock(_device_tables_mutex);
+    _device_tables.clear();
+  }
+#endif
 
   // reset
   reset();
@@ -46,22 +57,119 @@ void BasicAucCalculator::reset() {
   _local_abserr = 0;
   _local_sqrerr = 0;
   _local_pred = 0;
+  {
+    std::lock_guard<std::mutex> lock(_local_tables_mutex);
+    for (auto& local : _local_tables) {
+      for (auto& item : local->table) {
+        item.assign(_table_size, 0.0);
+      }
+      local->abserr = 0;
+      local->sqrerr = 0;
+      local->pred = 0;
+    }
+  }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  reset_device_tables();
+#endif
+}
+
+BasicAucCalculator::LocalTable* BasicAucCalculator::local_table() {
+  thread_local std::unordered_map<uint64_t, LocalTable*> tables;
+  auto iter = tables.find(_id);
+  if (iter != tables.end()) {
+    return iter->second;
+  }
+  auto local = std::make_unique<LocalTable>();
+  for (auto& item : local->table) {
+    item.assign(_table_size, 0.0);
+  }
+  LocalTable* table = local.get();
+  {
+    std::lock_guard<std::mutex> lock(_local_tables_mutex);
+    _local_tables.push_back(std::move(local));
+  }
+  tables.emplace(_id, table);
+  return table;
+}
+
+void BasicAucCalculator::add_unlock_batch_data(LocalTable* table,
+                                               const float* pred,
+                                               const int64_t* label,
+                                               const int64_t* mask,
+                                               int batch_size) {
+  double* buckets[2] = {table->table[0].data(),  // NOLINT
+                        table->table[1].data()};
+  double abserr = 0;
+  double sqrerr = 0;
+  double pred_sum = 0;
+  int invalid = -1;
+  for (int i = 0; i < batch_size; ++i) {
+    if (mask != nullptr && !mask[i]) {
+      continue;
+    }
+    double cur_pred = pred[i];
+    int64_t cur_label = label[i];
+    if (!(cur_pred >= 0.0 && cur_pred <= 1.0) ||
+        (cur_label != 0 && cur_label != 1)) {
+      invalid = i;
+      break;
+    }
+    int pos =
+        std::min(static_cast<int>(cur_pred * _table_size), _table_size - 1);
+    double err = cur_pred - cur_label;
+    abserr += fabs(err);
+    sqrerr += err * err;
+    pred_sum += cur_pred;
+    ++buckets[cur_label][pos];
+  }
+  table->abserr += abserr;
+  table->sqrerr += sqrerr;
+  table->pred += pred_sum;
+  PADDLE_ENFORCE_LT(
+      invalid,
+      0,
+      common::errors::PreconditionNotMet(
+          "pred should be in [0, 1] and label must be equal to 0 or 1, but "
+          "the pred and label of the %d-th instance are %f and %d",
+          invalid,
+          invalid < 0 ? 0.0 : pred[invalid],
+          invalid < 0 ? 0 : label[invalid]));
+}
+
+void BasicAucCalculator::merge_local_tables() {
+  std::lock_guard<std::mutex> lock(_local_tables_mutex);
+  for (auto& local : _local_tables) {
+    for (int label = 0; label < 2; ++label) {
+      auto& src = local->table[label];
+      auto& dst = _table[label];
+      for (int i = 0; i < _table_size; ++i) {
+        dst[i] += src[i];
+      }
+      src.assign(_table_size, 0.0);
+    }
+    _local_abserr += local->abserr;
+    _local_sqrerr += local->sqrerr;
+    _local_pred += local->pred;
+    local->abserr = 0;
+    local->sqrerr = 0;
+    local->pred = 0;
+  }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  merge_device_tables();
+#endif
 }
 
 void BasicAucCalculator::add_data(const float* d_pred,
                                   const int64_t* d_label,
                                   int batch_size,
                                   const phi::Place& place) {
-  thread_local std::vector<float> h_pred;
-  thread_local std::vector<int64_t> h_label;
-  h_pred.resize(batch_size);
-  h_label.resize(batch_size);
-  memcpy(h_pred.data(), d_pred, sizeof(float) * batch_size);
-  memcpy(h_label.data(), d_label, sizeof(int64_t) * batch_size);
-  std::lock_guard<std::mutex> lock(_table_mutex);
-  for (int i = 0; i < batch_size; ++i) {
-    add_unlock_data(h_pred[i], h_label[i]);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (phi::is_gpu_place(place)) {
+    add_gpu_data(d_pred, d_label, nullptr, batch_size, place);
+    return;
   }
+#endif
+  add_unlock_batch_data(local_table(), d_pred, d_label, nullptr, batch_size);
 }
 
 void BasicAucCalculator::add_unlock_data(double pred, int label) {
@@ -101,26 +209,17 @@ void BasicAucCalculator::add_mask_data(const float* d_pred,
                                        const int64_t* d_mask,
                                        int batch_size,
                                        const phi::Place& place) {
-  thread_local std::vector<float> h_pred;
-  thread_local std::vector<int64_t> h_label;
-  thread_local std::vector<int64_t> h_mask;
-  h_pred.resize(batch_size);
-  h_label.resize(batch_size);
-  h_mask.resize(batch_size);
-
-  memcpy(h_pred.data(), d_pred, sizeof(float) * batch_size);
-  memcpy(h_label.data(), d_label, sizeof(int64_t) * batch_size);
-  memcpy(h_mask.data(), d_mask, sizeof(int64_t) * batch_size);
-
-  std::lock_guard<std::mutex> lock(_table_mutex);
-  for (int i = 0; i < batch_size; ++i) {
-    if (h_mask[i]) {
-      add_unlock_data(h_pred[i], h_label[i]);
-    }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (phi::is_gpu_place(place)) {
+    add_gpu_data(d_pred, d_label, d_mask, batch_size, place);
+    return;
   }
+#endif
+  add_unlock_batch_data(local_table(), d_pred, d_label, d_mask, batch_size);
 }
 
 void BasicAucCalculator::compute() {
+  merge_local_tables();
 #if defined(PADDLE_WITH_GLOO)
   double area = 0;
   double fp = 0;
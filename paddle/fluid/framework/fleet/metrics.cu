@@ -0,0 +1,171 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/fluid/framework/fleet/metrics.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
+#include "paddle/phi/core/device_context.h"
+
+#if defined(PADDLE_WITH_PSLIB) || defined(PADDLE_WITH_PSCORE)
+namespace paddle {
+namespace framework {
+
+namespace {
+
+// the sums of abserr, sqrerr, pred and the number of the invalid instances
+// after the buckets
+constexpr int kDeviceStatNum = 4;
+
+size_t DeviceTableBytes(int table_size) {
+  return sizeof(double) * (2 * table_size + kDeviceStatNum);
+}
+
+// Bucketizes the predictions into the table on the device. The stats are
+// summed in the shared memory of each block first, so that each block only
+// adds them to the global memory once.
+__global__ void BucketizeAucKernel(const float* pred,
+                                   const int64_t* label,
+                                   const int64_t* mask,
+                                   int batch_size,
+                                   int table_size,
+                                   double* table) {
+  __shared__ double block_stats[kDeviceStatNum];
+  if (threadIdx.x < kDeviceStatNum) {
+    block_stats[threadIdx.x] = 0;
+  }
+  __syncthreads();
+
+  double abserr = 0;
+  double sqrerr = 0;
+  double pred_sum = 0;
+  double invalid = 0;
+  CUDA_KERNEL_LOOP(i, batch_size) {
+    if (mask != nullptr && !mask[i]) {
+      continue;
+    }
+    double cur_pred = pred[i];
+    int64_t cur_label = label[i];
+    if (!(cur_pred >= 0.0 && cur_pred <= 1.0) ||
+        (cur_label != 0 && cur_label != 1)) {
+      invalid += 1;
+      continue;
+    }
+    int pos = min(static_cast<int>(cur_pred * table_size), table_size - 1);
+    phi::CudaAtomicAdd(&table[cur_label * table_size + pos], 1.0);
+    double err = cur_pred - cur_label;
+    abserr += fabs(err);
+    sqrerr += err * err;
+    pred_sum += cur_pred;
+  }
+  phi::CudaAtomicAdd(&block_stats[0], abserr);
+  phi::CudaAtomicAdd(&block_stats[1], sqrerr);
+  phi::CudaAtomicAdd(&block_stats[2], pred_sum);
+  phi::CudaAtomicAdd(&block_stats[3], invalid);
+  __syncthreads();
+
+  if (threadIdx.x < kDeviceStatNum) {
+    phi::CudaAtomicAdd(&table[2 * table_size + threadIdx.x],
+                       block_stats[threadIdx.x]);
+  }
+}
+
+phi::GPUContext* GetGPUContext(const phi::Place& place) {
+  return static_cast<phi::GPUContext*>(
+      phi::DeviceContextPool::Instance().Get(place));
+}
+
+}  // namespace
+
+double* BasicAucCalculator::device_table(const phi::Place& place,
+                                         gpuStream_t stream) {
+  std::lock_guard<std::mutex> lock(_device_tables_mutex);
+  auto& holder = _device_tables[place.GetDeviceId()];
+  if (holder == nullptr) {
+    holder = memory::AllocShared(place, DeviceTableBytes(_table_size));
+    platform::GpuMemsetAsync(
+        holder->ptr(), 0, DeviceTableBytes(_table_size), stream);
+  }
+  return reinterpret_cast<double*>(holder->ptr());
+}
+
+void BasicAucCalculator::add_gpu_data(const float* d_pred,
+                                      const int64_t* d_label,
+                                      const int64_t* d_mask,
+                                      int batch_size,
+                                      const phi::Place& place) {
+  if (batch_size <= 0) {
+    return;
+  }
+  auto* dev_ctx = GetGPUContext(place);
+  auto stream = dev_ctx->stream();
+  double* table = device_table(place, stream);
+  int threads = phi::PADDLE_CUDA_NUM_THREADS;
+  int blocks = std::min((batch_size + threads - 1) / threads,
+                        dev_ctx->GetMaxPhysicalThreadCount() / threads);
+  BucketizeAucKernel<<<std::max(blocks, 1), threads, 0, stream>>>(
+      d_pred, d_label, d_mask, batch_size, _table_size, table);
+}
+
+void BasicAucCalculator::merge_device_tables() {
+  std::lock_guard<std::mutex> lock(_device_tables_mutex);
+  std::vector<double> h_table(2 * _table_size + kDeviceStatNum);
+  for (auto& item : _device_tables) {
+    auto stream = GetGPUContext(item.second->place())->stream();
+    platform::GpuMemcpyAsync(h_table.data(),
+                             item.second->ptr(),
+                             DeviceTableBytes(_table_size),
+                             gpuMemcpyDeviceToHost,
+                             stream);
+    platform::GpuMemsetAsync(
+        item.second->ptr(), 0, DeviceTableBytes(_table_size), stream);
+    platform::GpuStreamSync(stream);
+
+    const double* stats = h_table.data() + 2 * _table_size;
+    PADDLE_ENFORCE_EQ(
+        stats[3],
+        0,
+        common::errors::PreconditionNotMet(
+            "pred should be in [0, 1] and label must be equal to 0 or 1, but "
+            "%d instances on %s are not",
+            static_cast<int64_t>(stats[3]),
+            item.second->place()));
+    for (int label = 0; label < 2; ++label) {
+      const double* buckets = h_table.data() + label * _table_size;
+      for (int i = 0; i < _table_size; ++i) {
+        _table[label][i] += buckets[i];
+      }
+    }
+    _local_abserr += stats[0];
+    _local_sqrerr += stats[1];
+    _local_pred += stats[2];
+  }
+}
+
+void BasicAucCalculator::reset_device_tables() {
+  std::lock_guard<std::mutex> lock(_device_tables_mutex);
+  for (auto& item : _device_tables) {
+    auto stream = GetGPUContext(item.second->place())->stream();
+    platform::GpuMemsetAsync(
+        item.second->ptr(), 0, DeviceTableBytes(_table_size), stream);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
+#endif
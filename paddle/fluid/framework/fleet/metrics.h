@@ -66,7 +66,10 @@ class BasicAucCalculator {
   // add single data in CPU with LOCK, deprecated
   void add_unlock_data(double pred, int label);
   void add_uid_unlock_data(double pred, int label, uint64_t uid);
-  // add batch data
+  // add batch data, the data is in the memory of place. The instances are
+  // bucketized into the tables of the calling thread without locks or, for
+  // the data on GPU, into the tables on the device without copying the data
+  // back, and all the tables are merged at compute.
   void add_data(const float* d_pred,
                 const int64_t* d_label,
                 int batch_size,
@@ -84,6 +87,7 @@ class BasicAucCalculator {
                     int batch_size,
                     const phi::Place& place);
 
+  // Not thread safe with add_data, call it after all the data is added.
   void compute();
   void computeWuAuc();
   WuaucRocData computeSingleUserAuc(const std::vector<WuaucRecord>& records);
@@ -103,6 +107,32 @@ class BasicAucCalculator {
   std::mutex& table_mutex(void) { return _table_mutex; }
 
  private:
+  // the bucket tables of one thread
+  struct LocalTable {
+    std::vector<double> table[2];
+    double abserr = 0;
+    double sqrerr = 0;
+    double pred = 0;
+  };
+
+  static uint64_t next_id();
+  LocalTable* local_table();
+  void add_unlock_batch_data(LocalTable* table,
+                             const float* pred,
+                             const int64_t* label,
+                             const int64_t* mask,
+                             int batch_size);
+  void merge_local_tables();
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  double* device_table(const phi::Place& place, gpuStream_t stream);
+  void add_gpu_data(const float* d_pred,
+                    const int64_t* d_label,
+                    const int64_t* d_mask,
+                    int batch_size,
+                    const phi::Place& place);
+  void merge_device_tables();
+  void reset_device_tables();
+#endif
   void calculate_bucket_error();
 
  protected:
@@ -129,6 +159,16 @@ class BasicAucCalculator {
   static constexpr double kRelativeErrorBound = 0.05;
   static constexpr double kMaxSpan = 0.01;
   std::mutex _table_mutex;
+  // the id keys the tables cached by the threads, it is never reused
+  const uint64_t _id = next_id();
+  std::mutex _local_tables_mutex;
+  std::vector<std::unique_ptr<LocalTable>> _local_tables;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // the tables on each device in doubles, 2 * table_size buckets followed by
+  // the sums of abserr, sqrerr, pred and the number of the invalid instances
+  std::mutex _device_tables_mutex;
+  std::map<int, std::shared_ptr<phi::Allocation>> _device_tables;
+#endif
 };
 
 class Metric {
@@ -156,7 +196,8 @@ class Metric {
     BasicAucCalculator* GetCalculator() { return calculator; }
 
     // add_data
-    virtual void add_data(const Scope* exe_scope, const phi::Place& place) {
+    virtual void add_data(const Scope* exe_scope,
+                          const phi::Place& place UNUSED) {
       int label_len = 0;
       const int64_t* label_data = NULL;
       int pred_len = 0;
@@ -168,7 +209,20 @@ class Metric {
                         common::errors::PreconditionNotMet(
                             "the predict data length should be consistent with "
                             "the label data length"));
-      calculator->add_data(pred_data, label_data, label_len, place);
+      calculator->add_data(pred_data,
+                           label_data,
+                           label_len,
+                           get_place(exe_scope, pred_varname_));
+    }
+
+    static phi::Place get_place(const Scope* exe_scope,
+                                const std::string& varname) {
+      auto* var = exe_scope->FindVar(varname.c_str());
+      PADDLE_ENFORCE_NOT_NULL(
+          var,
+          common::errors::NotFound("Error: var %s is not found in scope.",
+                                   varname.c_str()));
+      return var->Get<phi::DenseTensor>().place();
     }
 
     // get_data
@@ -438,7 +492,8 @@ class Metric {
       calculator->init(bucket_size);
     }
     virtual ~MaskMetricMsg() {}
-    void add_data(const Scope* exe_scope, const phi::Place& place) override {
+    void add_data(const Scope* exe_scope,
+                  const phi::Place& place UNUSED) override {
       int label_len = 0;
       const int64_t* label_data = NULL;
       get_data<int64_t>(exe_scope, label_varname_, &label_data, &label_len);
@@ -456,7 +511,11 @@ class Metric {
                             "the predict data length should be consistent with "
                             "the label data length"));
       auto cal = GetCalculator();
-      cal->add_mask_data(pred_data, label_data, mask_data, label_len, place);
+      cal->add_mask_data(pred_data,
+                         label_data,
+                         mask_data,
+                         label_len,
+                         get_place(exe_scope, pred_varname_));
     }
 
    protected:
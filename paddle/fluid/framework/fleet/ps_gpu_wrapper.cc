@@ -48,6 +48,7 @@ COMMON_DECLARE_int32(gpugraph_dedup_pull_push_mode);
 COMMON_DECLARE_int32(gpugraph_storage_mode);
 COMMON_DECLARE_bool(query_dest_rank_by_multi_node);
 COMMON_DECLARE_string(graph_edges_split_mode);
+COMMON_DECLARE_bool(gpups_double_buffer_build_task);
 
 namespace paddle {
 namespace framework {
@@ -1705,7 +1706,10 @@ void PSGPUWrapper::PrepareGPUTask(std::shared_ptr<HeterContext> gpu_task) {
           << " seconds.";
 }
 
-void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
+void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task,
+                                bool build_next) {
+  HeterPsBase*& heter_ps = build_next ? HeterPs_next_ : HeterPs_;
+  auto& hbm_pools = build_next ? next_hbm_pools_ : hbm_pools_;
   int device_num = heter_devices_.size();
   platform::Timer stagetime;
   stagetime.Start();
@@ -1735,15 +1739,18 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
 
   auto accessor_wrapper_ptr =
       GlobalAccessorFactory::GetInstance().GetAccessorWrapper();
-  if (HeterPs_ == NULL) {
-    HeterPs_ = HeterPsBase::get_instance(
+  if (heter_ps == NULL) {
+    heter_ps = HeterPsBase::get_instance(
         size_max, resource_, fleet_config_, accessor_class_, optimizer_type_);
 #ifdef PADDLE_WITH_CUDA
-    HeterPs_->set_nccl_comm_and_size(
+    heter_ps->set_nccl_comm_and_size(
         inner_comms_, inter_comms_, node_size_, rank_id_);
-    HeterPs_->set_sparse_sgd(optimizer_config_);
-    HeterPs_->set_embedx_sgd(optimizer_config_);
+    heter_ps->set_sparse_sgd(optimizer_config_);
+    heter_ps->set_embedx_sgd(optimizer_config_);
 #endif
+    if (build_next) {
+      heter_ps->set_mode(infer_mode_);
+    }
   }
   stagetime.Pause();
   VLOG(1) << "passid=" << gpu_task->pass_id_ << ", card: "
@@ -1806,14 +1813,16 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
   auto build_dymf_hbm_pool = [this,
                               &gpu_task,
                               &accessor_wrapper_ptr,
-                              &feature_keys_count](int i) {
+                              &feature_keys_count,
+                              heter_ps,
+                              &hbm_pools](int i) {
     platform::CUDADeviceGuard guard(resource_->dev_id(i));
 
     platform::Timer stagetime;
     platform::Timer timer;
     timer.Start();
     // reset table
-    this->HeterPs_->reset_table(i,
+    heter_ps->reset_table(i,
                                 feature_keys_count[i],
                                 optimizer_config_,
                                 optimizer_config_,
@@ -1826,12 +1835,11 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
       int mf_dim = this->index_dim_vec_[j];
       size_t feature_value_size =
           accessor_wrapper_ptr->GetFeatureValueSize(mf_dim);
-      this->hbm_pools_[i * this->multi_mf_dim_ + j]->reset(len,
-                                                           feature_value_size);
-      this->HeterPs_->build_ps(
+      hbm_pools[i * this->multi_mf_dim_ + j]->reset(len, feature_value_size);
+      heter_ps->build_ps(
           i,
           device_dim_keys.data(),
-          this->hbm_pools_[i * this->multi_mf_dim_ + j]->mem(),
+          hbm_pools[i * this->multi_mf_dim_ + j]->mem(),
           len,
           feature_value_size,
           4 * 1024 * 1024,
@@ -1840,7 +1848,7 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
         VLOG(3) << "show table: " << i
                 << " table kv size: " << device_dim_keys.size()
                 << "dim: " << this->index_dim_vec_[j] << " len: " << len;
-        HeterPs_->show_one_table(i);
+        heter_ps->show_one_table(i);
       }
     }
 
@@ -1882,9 +1890,9 @@ void PSGPUWrapper::BuildGPUTask(std::shared_ptr<HeterContext> gpu_task) {
     struct task_info task;
     auto stream = resource_->local_stream(i, 0);
     while (cpu_reday_channels_[i]->Get(task)) {
-      auto hbm = this->hbm_pools_[task.device_id * this->multi_mf_dim_ +
-                                  task.multi_mf_dim]
-                     ->mem();
+      auto hbm =
+          hbm_pools[task.device_id * this->multi_mf_dim_ + task.multi_mf_dim]
+              ->mem();
       int mf_dim = this->index_dim_vec_[task.multi_mf_dim];
       size_t feature_value_size =
           accessor_wrapper_ptr->GetFeatureValueSize(mf_dim);
@@ -2038,11 +2046,160 @@ void PSGPUWrapper::build_pull_thread() {
     VLOG(0) << "passid=" << gpu_task->pass_id_
             << ", thread BuildPull end, cost time: " << timer.ElapsedSec()
             << "s";
+    if (FLAGS_gpups_double_buffer_build_task && BuildNextTask(gpu_task)) {
+      continue;
+    }
     buildpull_ready_channel_->Put(gpu_task);
   }
   VLOG(3) << "build cpu thread end";
 }
 
+bool PSGPUWrapper::BuildNextTask(std::shared_ptr<HeterContext> gpu_task) {
+  {
+    std::lock_guard<std::mutex> lock(next_task_mutex_);
+    // only while a pass trains, and one task ahead
+    if (current_task_ == nullptr || next_task_ != nullptr || pass_ending_ ||
+        gpu_graph_mode_ || !multi_mf_dim_) {
+      return false;
+    }
+    next_task_building_ = true;
+  }
+  platform::Timer timer;
+  timer.Start();
+  MergePull(gpu_task);
+  divide_to_device(gpu_task);
+  MarkSharedKeys(gpu_task);
+  BuildGPUTask(gpu_task, true);
+  timer.Pause();
+  VLOG(0) << "passid=" << gpu_task->pass_id_
+          << ", BuildNextTask end while passid=" << current_task_->pass_id_
+          << " trains, cost time: " << timer.ElapsedSec() << "s";
+  {
+    std::lock_guard<std::mutex> lock(next_task_mutex_);
+    next_task_ = gpu_task;
+    next_task_building_ = false;
+  }
+  next_task_cond_.notify_all();
+  return true;
+}
+
+bool PSGPUWrapper::SwapNextTask() {
+  std::lock_guard<std::mutex> lock(next_task_mutex_);
+  if (next_task_ == nullptr) {
+    return false;
+  }
+  std::swap(HeterPs_, HeterPs_next_);
+  hbm_pools_.swap(next_hbm_pools_);
+  current_task_ = next_task_;
+  next_task_ = nullptr;
+  return true;
+}
+
+void PSGPUWrapper::MarkSharedKeys(std::shared_ptr<HeterContext> gpu_task) {
+  platform::Timer timeline;
+  timeline.Start();
+  int device_num = heter_devices_.size();
+  gpu_task->shared_dim_keys_num_.assign(
+      device_num, std::vector<size_t>(multi_mf_dim_, 0));
+  // the keys of a device are the same in both passes, see divide_to_device,
+  // and the shared keys are moved to the front, so they are built again in
+  // one copy after the current pass is dumped
+  auto mark_func = [this, &gpu_task](int i, int j) {
+    auto& keys = gpu_task->device_dim_keys_[i][j];
+    auto& ptrs = gpu_task->device_dim_ptr_[i][j];
+    auto& current_keys = this->current_task_->device_dim_keys_[i][j];
+    robin_hood::unordered_set<uint64_t> current_set;
+    current_set.reserve(current_keys.size());
+    for (auto key : current_keys) {
+      current_set.insert(key);
+    }
+    size_t shared = 0;
+    for (size_t k = 0; k < keys.size(); ++k) {
+      if (current_set.count(keys[k]) > 0) {
+        std::swap(keys[k], keys[shared]);
+        std::swap(ptrs[k], ptrs[shared]);
+        ++shared;
+      }
+    }
+    gpu_task->shared_dim_keys_num_[i][j] = shared;
+  };
+  std::vector<std::future<void>> task_futures;
+  for (int i = 0; i < device_num; i++) {
+    for (int j = 0; j < multi_mf_dim_; j++) {
+      task_futures.emplace_back(cpu_work_pool_[i]->enqueue(mark_func, i, j));
+    }
+  }
+  for (auto& f : task_futures) {
+    f.wait();
+  }
+  timeline.Pause();
+  VLOG(1) << "passid=" << gpu_task->pass_id_
+          << ", MarkSharedKeys cost " << timeline.ElapsedSec() << " s.";
+}
+
+void PSGPUWrapper::RefreshSharedKeys(std::shared_ptr<HeterContext> gpu_task) {
+  auto accessor_wrapper_ptr =
+      GlobalAccessorFactory::GetInstance().GetAccessorWrapper();
+  auto refresh_func = [this, &gpu_task, &accessor_wrapper_ptr](int i) {
+    platform::CUDADeviceGuard guard(resource_->dev_id(i));
+    auto stream = resource_->local_stream(i, 0);
+    std::vector<std::shared_ptr<char>> build_values_vec;
+    size_t total_len = 0;
+    for (int j = 0; j < this->multi_mf_dim_; j++) {
+      size_t len = gpu_task->shared_dim_keys_num_[i][j];
+      if (len == 0) {
+        continue;
+      }
+      auto& device_dim_ptrs = gpu_task->device_dim_ptr_[i][j];
+      int mf_dim = this->index_dim_vec_[j];
+      size_t feature_value_size =
+          accessor_wrapper_ptr->GetFeatureValueSize(mf_dim);
+      std::shared_ptr<char> build_values(new char[feature_value_size * len],
+                                         [](char* p) { delete[] p; });
+      for (size_t k = 0; k < len; k++) {
+#ifdef PADDLE_WITH_PSCORE
+        void* val = reinterpret_cast<float*>(build_values.get() +
+                                             k * feature_value_size);
+        accessor_wrapper_ptr->BuildFill(
+            val, device_dim_ptrs[k], cpu_table_accessor_, mf_dim);
+#endif
+#ifdef PADDLE_WITH_PSLIB
+        float* val = reinterpret_cast<float*>(build_values.get() +
+                                              k * feature_value_size);
+        accessor_wrapper_ptr->BuildFill(val,
+                                        device_dim_ptrs[k],
+                                        cpu_table_accessor_,
+                                        mf_dim,
+                                        accessor_class_);
+#endif
+      }
+      // the shared keys are at the front of the pool of the table
+      CUDA_CHECK(cudaMemcpyAsync(
+          this->next_hbm_pools_[i * this->multi_mf_dim_ + j]->mem(),
+          build_values.get(),
+          len * feature_value_size,
+          cudaMemcpyHostToDevice,
+          stream));
+      build_values_vec.push_back(build_values);
+      total_len += len;
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+    VLOG(1) << "card: " << i << " RefreshSharedKeys feasign: " << total_len;
+  };
+  platform::Timer timer;
+  timer.Start();
+  std::vector<std::future<void>> task_futures;
+  for (size_t i = 0; i < heter_devices_.size(); i++) {
+    task_futures.emplace_back(hbm_thread_pool_[i]->enqueue(refresh_func, i));
+  }
+  for (auto& f : task_futures) {
+    f.wait();
+  }
+  timer.Pause();
+  VLOG(0) << "passid=" << gpu_task->pass_id_
+          << ", RefreshSharedKeys cost time: " << timer.ElapsedSec() << "s";
+}
+
 void PSGPUWrapper::build_task() {
   // build_task: build_pull + build_gputask
   std::shared_ptr<HeterContext> gpu_task = nullptr;
@@ -2067,6 +2224,7 @@ void PSGPUWrapper::build_task() {
           << ", PrepareGPUTask + BuildGPUTask end, cost time: "
           << timer.ElapsedSec() << "s";
 
+  std::lock_guard<std::mutex> lock(next_task_mutex_);
   current_task_ = gpu_task;
 }
 
@@ -2085,7 +2243,10 @@ void PSGPUWrapper::BeginPass() {
   }
 
   debug_gpu_memory_info("befor build task");
-  build_task();
+  // the table of this pass may be built while the last pass trained
+  if (!SwapNextTask()) {
+    build_task();
+  }
   debug_gpu_memory_info("after build task");
   timer.Pause();
 
@@ -2114,6 +2275,14 @@ void PSGPUWrapper::EndPass() {
   if (current_task_ == nullptr) {
     return;
   }
+  {
+    // the table of the next pass is built with the channels and the pools
+    // used by the dump
+    std::unique_lock<std::mutex> lock(next_task_mutex_);
+    pass_ending_ = true;
+    next_task_cond_.wait(lock, [this] { return !next_task_building_; });
+  }
+  bool trained = grad_push_count_ > 0;
   platform::Timer stagetime;
   stagetime.Start();
   HbmToSparseTable();
@@ -2121,9 +2290,18 @@ void PSGPUWrapper::EndPass() {
   VLOG(0) << "passid=" << current_task_->pass_id_
           << ", EndPass HbmToSparseTable cost time: " << stagetime.ElapsedSec()
           << "s";
+  // the next table read the values of the shared keys before this pass
+  // was dumped
+  if (next_task_ != nullptr && trained) {
+    RefreshSharedKeys(next_task_);
+  }
 
   gpu_task_pool_.Push(current_task_);
-  current_task_ = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(next_task_mutex_);
+    current_task_ = nullptr;
+    pass_ending_ = false;
+  }
   // fleet_ptr->pslib_ptr_->_worker_ptr->release_table_mutex(this->table_id_);
 }
 
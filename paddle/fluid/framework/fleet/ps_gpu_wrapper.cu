@@ -82,7 +82,10 @@ __global__ void PushCopy(FeaturePushValue* dest,
   }
 }
 
-PSGPUWrapper::~PSGPUWrapper() { delete HeterPs_; }
+PSGPUWrapper::~PSGPUWrapper() {
+  delete HeterPs_;
+  delete HeterPs_next_;
+}
 
 void PSGPUWrapper::CopyKeys(const phi::Place& place,
                             uint64_t** origin_keys,
@@ -17,6 +17,7 @@ limitations under the License. */
 
 #include <google/protobuf/text_format.h>
 #include <atomic>
+#include <condition_variable>  // NOLINT
 #include <ctime>
 #include <map>
 #include <memory>
@@ -204,7 +205,9 @@ class PSGPUWrapper {
 
   void divide_to_device(std::shared_ptr<HeterContext> gpu_task);
   void add_slot_feature(std::shared_ptr<HeterContext> gpu_task);
-  void BuildGPUTask(std::shared_ptr<HeterContext> gpu_task);
+  // With build_next, builds into HeterPs_next_ and next_hbm_pools_ instead.
+  void BuildGPUTask(std::shared_ptr<HeterContext> gpu_task,
+                    bool build_next = false);
   void PreBuildTask(std::shared_ptr<HeterContext> gpu_task,
                     Dataset* dataset_for_pull);
   void BuildPull(std::shared_ptr<HeterContext> gpu_task);
@@ -222,6 +225,14 @@ class PSGPUWrapper {
   void AddSparseKeys();
   void build_pull_thread();
   void build_task();
+  // The double buffered build of FLAGS_gpups_double_buffer_build_task: the
+  // table of the next pass is built while the current pass trains, and the
+  // values of the keys trained in both passes are built again after the
+  // current pass is dumped.
+  bool BuildNextTask(std::shared_ptr<HeterContext> gpu_task);
+  bool SwapNextTask();
+  void MarkSharedKeys(std::shared_ptr<HeterContext> gpu_task);
+  void RefreshSharedKeys(std::shared_ptr<HeterContext> gpu_task);
   void DumpToMem();
   void MergePull(std::shared_ptr<HeterContext> gpu_task);
   void MergeKeys(std::shared_ptr<HeterContext> gpu_task);
@@ -237,6 +248,9 @@ class PSGPUWrapper {
     if (HeterPs_ != NULL) {
       HeterPs_->set_mode(infer_mode);
     }
+    if (HeterPs_next_ != NULL) {
+      HeterPs_next_->set_mode(infer_mode);
+    }
     VLOG(0) << "set infer mode=" << infer_mode;
   }
 
@@ -258,9 +272,16 @@ class PSGPUWrapper {
       }
     }
 #endif
+    {
+      std::unique_lock<std::mutex> lock(next_task_mutex_);
+      next_task_cond_.wait(lock, [this] { return !next_task_building_; });
+    }
     for (size_t i = 0; i < hbm_pools_.size(); i++) {
       delete hbm_pools_[i];
     }
+    for (size_t i = 0; i < next_hbm_pools_.size(); i++) {
+      delete next_hbm_pools_[i];
+    }
     buildcpu_ready_channel_->Close();
     buildpull_ready_channel_->Close();
     running_ = false;
@@ -273,6 +294,10 @@ class PSGPUWrapper {
       delete HeterPs_;
       HeterPs_ = NULL;
     }
+    if (HeterPs_next_ != NULL) {
+      delete HeterPs_next_;
+      HeterPs_next_ = NULL;
+    }
     if (device_caches_ != nullptr) {
       delete[] device_caches_;
       device_caches_ = nullptr;
@@ -880,6 +905,10 @@ class PSGPUWrapper {
     for (size_t i = 0; i < hbm_pools_.size(); i++) {
       hbm_pools_[i] = new HBMMemoryPoolFix();
     }
+    next_hbm_pools_.resize(hbm_pools_.size());
+    for (size_t i = 0; i < next_hbm_pools_.size(); i++) {
+      next_hbm_pools_[i] = new HBMMemoryPoolFix();
+    }
 
     mem_pools_.resize(resource_->total_device() * num_of_dim);
     max_mf_dim_ = index_dim_vec_.back();
@@ -952,6 +981,8 @@ class PSGPUWrapper {
       std::vector<std::unordered_map<uint64_t, std::vector<float>>>>
       local_tables_;
   HeterPsBase* HeterPs_ = NULL;
+  // the table of the next pass, built by BuildNextTask
+  HeterPsBase* HeterPs_next_ = NULL;
   // std::vector<LoDTensor> keys_tensor;  // Cache for pull_sparse
   std::vector<phi::DenseTensor> keys_tensor;  // Cache for pull_sparse
   std::shared_ptr<HeterPsResource> resource_;
@@ -1019,6 +1050,7 @@ class PSGPUWrapper {
   std::vector<MemoryPool*> mem_pools_;
   std::vector<HBMMemoryPoolFix*> hbm_pools_;  // in multi mfdim, one table need
                                               // hbm pools of total dims number
+  std::vector<HBMMemoryPoolFix*> next_hbm_pools_;
 #endif
 
   std::shared_ptr<
@@ -1032,6 +1064,14 @@ class PSGPUWrapper {
   std::vector<std::shared_ptr<paddle::framework::ChannelObject<task_info>>>
       cpu_reday_channels_;
   std::shared_ptr<HeterContext> current_task_ = nullptr;
+  // the task built by BuildNextTask, which BeginPass swaps in
+  std::shared_ptr<HeterContext> next_task_ = nullptr;
+  // guards current_task_ and next_task_ between the build pull thread and
+  // BeginPass/EndPass
+  std::mutex next_task_mutex_;
+  std::condition_variable next_task_cond_;
+  bool next_task_building_ = false;
+  bool pass_ending_ = false;
   std::thread buildpull_threads_;
   bool running_ = false;
   std::vector<std::shared_ptr<::ThreadPool>> pull_thread_pool_;
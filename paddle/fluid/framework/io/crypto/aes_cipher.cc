@@ -22,12 +22,19 @@
 #include <cryptopp/modes.h>
 #include <cryptopp/smartptr.h>
 
+#include <algorithm>
+#include <fstream>
 #include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/io/crypto/cipher_utils.h"
 #include "paddle/fluid/platform/enforce.h"
 
+COMMON_DECLARE_int32(cipher_decrypt_num_threads);
+
 namespace paddle::framework {
 
 void AESCipher::Init(const std::string& cipher_name,
@@ -128,36 +135,78 @@ std::string AESCipher::AuthenticatedEncryptInternal(
   return ciphertext;
 }
 
-std::string AESCipher::AuthenticatedDecryptInternal(
-    const std::string& ciphertext, const std::string& key) {
-  CryptoPP::member_ptr<CryptoPP::AuthenticatedSymmetricCipher> m_cipher;
-  CryptoPP::member_ptr<CryptoPP::AuthenticatedDecryptionFilter> m_filter;
-  bool need_iv = false;
+bool AESCipher::CanDecryptInPlace() const {
+  return aes_cipher_name_ == "AES_CTR_NoPadding" ||
+         aes_cipher_name_ == "AES_GCM_NoPadding";
+}
+
+size_t AESCipher::DecryptInPlace(const std::string& key,
+                                 const std::string& iv,
+                                 char* data,
+                                 size_t size) {
   const unsigned char* key_char =
-      reinterpret_cast<const unsigned char*>(&(key.at(0)));
-  BuildAuthDecCipher(&need_iv, &m_cipher, &m_filter);
-  int ciphertext_beg = 0;
-  if (need_iv) {
-    iv_ = ciphertext.substr(0, iv_size_ / 8);
-    ciphertext_beg = iv_size_ / 8;
-    m_cipher->SetKeyWithIV(key_char,
-                           key.size(),
-                           reinterpret_cast<const unsigned char*>(&(iv_.at(0))),
-                           iv_.size());
-  } else {
-    m_cipher->SetKey(key_char, key.size());
+      reinterpret_cast<const unsigned char*>(key.data());
+  const unsigned char* iv_char =
+      reinterpret_cast<const unsigned char*>(iv.data());
+  unsigned char* buffer = reinterpret_cast<unsigned char*>(data);
+  if (is_authenticated_cipher_) {
+    size_t tag_bytes = tag_size_ / 8;
+    PADDLE_ENFORCE_GE(size,
+                      tag_bytes,
+                      common::errors::InvalidArgument(
+                          "Integrity check failed. The ciphertext is shorter "
+                          "than the tag of %d bytes.",
+                          tag_bytes));
+    size_t plaintext_size = size - tag_bytes;
+    CryptoPP::GCM<CryptoPP::AES>::Decryption decryption;
+    decryption.SetKeyWithIV(key_char, key.size(), iv_char, iv.size());
+    // the tag follows the ciphertext
+    bool verified = decryption.DecryptAndVerify(buffer,
+                                                buffer + plaintext_size,
+                                                tag_bytes,
+                                                iv_char,
+                                                static_cast<int>(iv.size()),
+                                                nullptr,
+                                                0,
+                                                buffer,
+                                                plaintext_size);
+    PADDLE_ENFORCE_EQ(
+        verified,
+        true,
+        common::errors::InvalidArgument("Integrity check failed. "
+                                        "Invalid ciphertext input."));
+    return plaintext_size;
   }
-  std::string plaintext;
-  m_filter->Attach(new CryptoPP::StringSink(plaintext));
-  CryptoPP::Redirector* filter_redirector = new CryptoPP::Redirector(*m_filter);
-  CryptoPP::StringSource ss(
-      ciphertext.substr(ciphertext_beg), true, filter_redirector);
-  PADDLE_ENFORCE_EQ(
-      m_filter->GetLastResult(),
-      true,
-      common::errors::InvalidArgument("Integrity check failed. "
-                                      "Invalid ciphertext input."));
-  return plaintext;
+
+  // the chunks start at the blocks, so that each thread seeks to the counter
+  // of its chunk
+  constexpr size_t kMinChunkSize = 1 << 20;
+  size_t num_threads = FLAGS_cipher_decrypt_num_threads > 0
+                           ? FLAGS_cipher_decrypt_num_threads
+                           : std::thread::hardware_concurrency();
+  size_t chunk_num = std::max<size_t>(
+      1, std::min(num_threads, (size + kMinChunkSize - 1) / kMinChunkSize));
+  size_t chunk_size = (size + chunk_num - 1) / chunk_num;
+  chunk_size = (chunk_size + CryptoPP::AES::BLOCKSIZE - 1) /
+               CryptoPP::AES::BLOCKSIZE * CryptoPP::AES::BLOCKSIZE;
+  auto decrypt_chunk = [&](size_t begin) {
+    size_t length = std::min(size - begin, chunk_size);
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption decryption;
+    decryption.SetKeyWithIV(key_char, key.size(), iv_char, iv.size());
+    decryption.Seek(begin);
+    decryption.ProcessData(buffer + begin, buffer + begin, length);
+  };
+  std::vector<std::thread> threads;
+  for (size_t begin = chunk_size; begin < size; begin += chunk_size) {
+    threads.emplace_back(decrypt_chunk, begin);
+  }
+  if (size > 0) {
+    decrypt_chunk(0);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return size;
 }
 
 void AESCipher::BuildCipher(
@@ -223,27 +272,6 @@ void AESCipher::BuildAuthEncCipher(
   }
 }
 
-void AESCipher::BuildAuthDecCipher(
-    bool* need_iv,
-    CryptoPP::member_ptr<CryptoPP::AuthenticatedSymmetricCipher>* m_cipher,
-    CryptoPP::member_ptr<CryptoPP::AuthenticatedDecryptionFilter>* m_filter) {
-  if (aes_cipher_name_ == "AES_GCM_NoPadding") {
-    m_cipher->reset(new CryptoPP::GCM<CryptoPP::AES>::Decryption);
-    *need_iv = true;
-    m_filter->reset(new CryptoPP::AuthenticatedDecryptionFilter(
-        **m_cipher,
-        nullptr,
-        CryptoPP::AuthenticatedDecryptionFilter::DEFAULT_FLAGS,
-        tag_size_ / 8,
-        CryptoPP::BlockPaddingSchemeDef::NO_PADDING));
-  } else {
-    PADDLE_THROW(common::errors::Unimplemented(
-        "Create cipher error. "
-        "Cipher name %s is error, or has not been implemented.",
-        aes_cipher_name_));
-  }
-}
-
 std::string AESCipher::Encrypt(const std::string& plaintext,
                                const std::string& key) {
   return is_authenticated_cipher_ ? AuthenticatedEncryptInternal(plaintext, key)
@@ -252,9 +280,19 @@ std::string AESCipher::Encrypt(const std::string& plaintext,
 
 std::string AESCipher::Decrypt(const std::string& ciphertext,
                                const std::string& key) {
-  return is_authenticated_cipher_
-             ? AuthenticatedDecryptInternal(ciphertext, key)
-             : DecryptInternal(ciphertext, key);
+  if (!CanDecryptInPlace()) {
+    return DecryptInternal(ciphertext, key);
+  }
+  size_t iv_bytes = iv_size_ / 8;
+  PADDLE_ENFORCE_GE(ciphertext.size(),
+                    iv_bytes,
+                    common::errors::InvalidArgument(
+                        "The ciphertext is shorter than the iv of %d bytes.",
+                        iv_bytes));
+  iv_ = ciphertext.substr(0, iv_bytes);
+  std::string plaintext = ciphertext.substr(iv_bytes);
+  plaintext.resize(DecryptInPlace(key, iv_, &plaintext[0], plaintext.size()));
+  return plaintext;
 }
 
 void AESCipher::EncryptToFile(const std::string& plaintext,
@@ -268,11 +306,36 @@ void AESCipher::EncryptToFile(const std::string& plaintext,
 
 std::string AESCipher::DecryptFromFile(const std::string& key,
                                        const std::string& filename) {
-  std::ifstream fin(filename, std::ios::binary);
-  std::string ciphertext{std::istreambuf_iterator<char>(fin),
-                         std::istreambuf_iterator<char>()};
+  std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+  PADDLE_ENFORCE_EQ(
+      fin.is_open(),
+      true,
+      common::errors::NotFound("Cannot open the encrypted file %s.", filename));
+  size_t size = fin.tellg();
+  fin.seekg(0);
+  if (!CanDecryptInPlace()) {
+    std::string ciphertext(size, '\0');
+    fin.read(&ciphertext[0], size);  // NOLINT
+    fin.close();
+    return Decrypt(ciphertext, key);
+  }
+
+  // read the ciphertext into the plaintext, which is decrypted there
+  size_t iv_bytes = iv_size_ / 8;
+  PADDLE_ENFORCE_GE(size,
+                    iv_bytes,
+                    common::errors::InvalidArgument(
+                        "The ciphertext in %s is shorter than the iv of %d "
+                        "bytes.",
+                        filename,
+                        iv_bytes));
+  iv_.resize(iv_bytes);
+  fin.read(&iv_[0], iv_bytes);  // NOLINT
+  std::string plaintext(size - iv_bytes, '\0');
+  fin.read(&plaintext[0], plaintext.size());  // NOLINT
   fin.close();
-  return Decrypt(ciphertext, key);
+  plaintext.resize(DecryptInPlace(key, iv_, &plaintext[0], plaintext.size()));
+  return plaintext;
 }
 
 }  // namespace paddle::framework
@@ -23,7 +23,6 @@ namespace CryptoPP {
 class StreamTransformationFilter;
 class SymmetricCipher;
 class AuthenticatedSymmetricCipher;
-class AuthenticatedDecryptionFilter;
 class AuthenticatedEncryptionFilter;
 template <class CryptoppCipher>
 class member_ptr;
@@ -60,8 +59,17 @@ class AESCipher : public Cipher {
 
   std::string AuthenticatedEncryptInternal(const std::string& plaintext,
                                            const std::string& key);
-  std::string AuthenticatedDecryptInternal(const std::string& ciphertext,
-                                           const std::string& key);
+
+  // AES_CTR_NoPadding and AES_GCM_NoPadding decrypt the ciphertext following
+  // the iv in place, without the copies of the filters of Crypto++, and CTR
+  // decrypts the chunks of it in parallel.
+  bool CanDecryptInPlace() const;
+  // Returns the size of the plaintext, which is shorter than the ciphertext
+  // by the tag of GCM.
+  size_t DecryptInPlace(const std::string& key,
+                        const std::string& iv,
+                        char* data,
+                        size_t size);
 
   void BuildCipher(
       bool for_encrypt,
@@ -74,11 +82,6 @@ class AESCipher : public Cipher {
       CryptoPP::member_ptr<CryptoPP::AuthenticatedSymmetricCipher>* m_cipher,
       CryptoPP::member_ptr<CryptoPP::AuthenticatedEncryptionFilter>* m_filter);
 
-  void BuildAuthDecCipher(
-      bool* need_iv,
-      CryptoPP::member_ptr<CryptoPP::AuthenticatedSymmetricCipher>* m_cipher,
-      CryptoPP::member_ptr<CryptoPP::AuthenticatedDecryptionFilter>* m_filter);
-
   std::string aes_cipher_name_;
   int iv_size_;
   int tag_size_;
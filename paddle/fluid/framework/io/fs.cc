@@ -17,8 +17,10 @@ limitations under the License. */
 #include <sys/stat.h>
 
 #include <memory>
+#include <utility>
 
 #include "glog/logging.h"
+#include "paddle/fluid/framework/io/hdfs_native.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -262,6 +264,17 @@ void dataset_hdfs_set_command(const std::string& x) {
   dataset_hdfs_command_internal() = x;
 }
 
+// the fs name and ugi of dataset_hdfs_command for the native reader
+static std::pair<std::string, std::string>& dataset_hdfs_config_internal() {
+  static std::pair<std::string, std::string> x;
+  return x;
+}
+
+void dataset_hdfs_set_config(const std::string& fs_name,
+                             const std::string& fs_ugi) {
+  dataset_hdfs_config_internal() = std::make_pair(fs_name, fs_ugi);
+}
+
 static std::string& customized_download_cmd_internal() {
   static std::string x = "";
   return x;
@@ -277,6 +290,21 @@ std::shared_ptr<FILE> hdfs_open_read(std::string path,
                                      int* err_no,
                                      const std::string& converter,
                                      bool read_data) {
+  // the native reader has no converter, the gzip files and the paths it can
+  // not open, e.g. a glob, are read by the hadoop command
+  if (download_cmd().empty() && (converter.empty() || converter == "cat") &&
+      !fs_end_with_internal(path, ".gz") && hdfs_native_enabled()) {
+    std::shared_ptr<FILE> fp = nullptr;
+    if (read_data) {
+      const auto& config = dataset_hdfs_config_internal();
+      fp = hdfs_native_open_read(path, err_no, config.first, config.second);
+    } else {
+      fp = hdfs_native_open_read(path, err_no, "", "");
+    }
+    if (fp != nullptr) {
+      return fp;
+    }
+  }
   if (!download_cmd().empty()) {  // use customized download command
     path = string::format_string(
         "%s \"%s\"", download_cmd().c_str(), path.c_str());
@@ -68,6 +68,9 @@ extern const std::string& dataset_hdfs_command();
 
 extern void dataset_hdfs_set_command(const std::string& x);
 
+extern void dataset_hdfs_set_config(const std::string& fs_name,
+                                    const std::string& fs_ugi);
+
 extern const std::string& download_cmd();
 
 extern void set_download_command(const std::string& x);
@@ -0,0 +1,345 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/hdfs_native.h"
+
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(PADDLE_ARM)
+#include <ThreadPool.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#endif
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/macros.h"
+
+COMMON_DECLARE_string(hdfs_native_library);
+COMMON_DECLARE_int64(hdfs_native_chunk_size);
+COMMON_DECLARE_int32(hdfs_native_read_ahead);
+COMMON_DECLARE_int32(hdfs_native_thread_num);
+
+namespace paddle {
+namespace framework {
+
+#if defined(_WIN32) || defined(__APPLE__) || defined(PADDLE_ARM)
+
+bool hdfs_native_enabled() { return false; }
+
+std::shared_ptr<FILE> hdfs_native_open_read(const std::string& path UNUSED,
+                                            int* err_no UNUSED,
+                                            const std::string& fs_name UNUSED,
+                                            const std::string& fs_ugi UNUSED) {
+  return nullptr;
+}
+
+#else
+
+namespace {
+
+// the part of the libhdfs api in hdfs.h used by the reader
+typedef struct hdfs_internal* hdfsFS;
+typedef struct hdfsFile_internal* hdfsFile;
+struct hdfsBuilder;
+typedef int32_t tSize;
+typedef int64_t tOffset;
+typedef time_t tTime;
+typedef enum tObjectKind {
+  kObjectKindFile = 'F',
+  kObjectKindDirectory = 'D',
+} tObjectKind;
+typedef struct {
+  tObjectKind mKind;
+  char* mName;
+  tTime mLastMod;
+  tOffset mSize;
+  short mReplication;  // NOLINT
+  tOffset mBlockSize;
+  char* mOwner;
+  char* mGroup;
+  short mPermissions;  // NOLINT
+  tTime mLastAccess;
+} hdfsFileInfo;
+
+struct LibHdfs {
+  hdfsBuilder* (*NewBuilder)();
+  void (*BuilderSetNameNode)(hdfsBuilder*, const char*);
+  void (*BuilderSetUserName)(hdfsBuilder*, const char*);
+  int (*BuilderConfSetStr)(hdfsBuilder*, const char*, const char*);
+  hdfsFS (*BuilderConnect)(hdfsBuilder*);
+  hdfsFile (*OpenFile)(hdfsFS, const char*, int, int, short, tSize);  // NOLINT
+  int (*CloseFile)(hdfsFS, hdfsFile);
+  tSize (*Pread)(hdfsFS, hdfsFile, tOffset, void*, tSize);
+  hdfsFileInfo* (*GetPathInfo)(hdfsFS, const char*);
+  void (*FreeFileInfo)(hdfsFileInfo*, int);
+};
+
+template <typename F>
+bool LoadSymbol(void* handle, const char* name, F* func) {
+  *func = reinterpret_cast<F>(dlsym(handle, name));
+  if (*func == nullptr) {
+    LOG(WARNING) << "Fail to find " << name << " in "
+                 << FLAGS_hdfs_native_library;
+  }
+  return *func != nullptr;
+}
+
+const LibHdfs* GetLibHdfs() {
+  static const LibHdfs* lib = []() -> const LibHdfs* {
+    if (FLAGS_hdfs_native_library.empty()) {
+      return nullptr;
+    }
+    void* handle =
+        dlopen(FLAGS_hdfs_native_library.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if (handle == nullptr) {
+      LOG(WARNING) << "Fail to load " << FLAGS_hdfs_native_library << ": "
+                   << dlerror() << ", the files are read by the hadoop command";
+      return nullptr;
+    }
+    auto* lib = new LibHdfs;
+    bool ok = LoadSymbol(handle, "hdfsNewBuilder", &lib->NewBuilder) &&
+              LoadSymbol(
+                  handle, "hdfsBuilderSetNameNode", &lib->BuilderSetNameNode) &&
+              LoadSymbol(
+                  handle, "hdfsBuilderSetUserName", &lib->BuilderSetUserName) &&
+              LoadSymbol(
+                  handle, "hdfsBuilderConfSetStr", &lib->BuilderConfSetStr) &&
+              LoadSymbol(handle, "hdfsBuilderConnect", &lib->BuilderConnect) &&
+              LoadSymbol(handle, "hdfsOpenFile", &lib->OpenFile) &&
+              LoadSymbol(handle, "hdfsCloseFile", &lib->CloseFile) &&
+              LoadSymbol(handle, "hdfsPread", &lib->Pread) &&
+              LoadSymbol(handle, "hdfsGetPathInfo", &lib->GetPathInfo) &&
+              LoadSymbol(handle, "hdfsFreeFileInfo", &lib->FreeFileInfo);
+    if (!ok) {
+      delete lib;
+      return nullptr;
+    }
+    VLOG(0) << "read the hdfs files by " << FLAGS_hdfs_native_library;
+    return lib;
+  }();
+  return lib;
+}
+
+::ThreadPool* GetReadThreadPool() {
+  static ::ThreadPool* pool =
+      new ::ThreadPool(std::max(FLAGS_hdfs_native_thread_num, 1));
+  return pool;
+}
+
+// "hdfs://host:port/a/b" -> "hdfs://host:port", the paths like "afs:/a/b"
+// have no name node.
+std::string GetNameNode(const std::string& path) {
+  size_t begin = path.find("://");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  return path.substr(0, path.find('/', begin + 3));
+}
+
+// The connections are never closed, libhdfs shares them between the threads.
+hdfsFS Connect(const std::string& name_node, const std::string& ugi) {
+  static std::mutex mutex;
+  static std::map<std::pair<std::string, std::string>, hdfsFS> connections;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto key = std::make_pair(name_node, ugi);
+  auto iter = connections.find(key);
+  if (iter != connections.end()) {
+    return iter->second;
+  }
+  const LibHdfs* lib = GetLibHdfs();
+  hdfsBuilder* builder = lib->NewBuilder();
+  lib->BuilderSetNameNode(builder,
+                          name_node.empty() ? "default" : name_node.c_str());
+  // the ugi is "user,password"
+  std::string user = ugi.substr(0, ugi.find(','));
+  if (!user.empty()) {
+    lib->BuilderSetUserName(builder, user.c_str());
+    lib->BuilderConfSetStr(builder, "hadoop.job.ugi", ugi.c_str());
+  }
+  // the builder is freed by the connect
+  hdfsFS fs = lib->BuilderConnect(builder);
+  if (fs == nullptr) {
+    LOG(WARNING) << "Fail to connect to the name node " << name_node;
+    return nullptr;
+  }
+  connections[key] = fs;
+  return fs;
+}
+
+class NativeHdfsReader {
+ public:
+  struct Chunk {
+    std::vector<char> data;
+    bool ok = true;
+  };
+
+  NativeHdfsReader(hdfsFS fs,
+                   hdfsFile file,
+                   int64_t file_size,
+                   const std::string& path)
+      : fs_(fs), file_(file), file_size_(file_size), path_(path) {
+    Prefetch();
+  }
+
+  ~NativeHdfsReader() {
+    // the chunks in flight read the file
+    for (auto& chunk : chunks_) {
+      chunk.wait();
+    }
+    GetLibHdfs()->CloseFile(fs_, file_);
+  }
+
+  bool failed() const { return failed_; }
+
+  ssize_t Read(char* buffer, size_t size) {
+    if (failed_) {
+      return -1;
+    }
+    size_t done = 0;
+    while (done < size) {
+      if (pos_ == current_.data.size()) {
+        if (chunks_.empty()) {
+          break;
+        }
+        current_ = chunks_.front().get();
+        chunks_.pop_front();
+        pos_ = 0;
+        Prefetch();
+        if (!current_.ok) {
+          LOG(WARNING) << "Fail to read " << path_;
+          failed_ = true;
+          return -1;
+        }
+        continue;
+      }
+      size_t n = std::min(size - done, current_.data.size() - pos_);
+      memcpy(buffer + done, current_.data.data() + pos_, n);
+      pos_ += n;
+      done += n;
+    }
+    return done;
+  }
+
+ private:
+  void Prefetch() {
+    int64_t chunk_size = std::max<int64_t>(FLAGS_hdfs_native_chunk_size, 1);
+    size_t read_ahead = std::max(FLAGS_hdfs_native_read_ahead, 1);
+    while (chunks_.size() < read_ahead && offset_ < file_size_) {
+      int64_t length = std::min(chunk_size, file_size_ - offset_);
+      chunks_.push_back(GetReadThreadPool()->enqueue(
+          &NativeHdfsReader::ReadChunk, fs_, file_, offset_, length));
+      offset_ += length;
+    }
+  }
+
+  static Chunk ReadChunk(hdfsFS fs,
+                         hdfsFile file,
+                         int64_t offset,
+                         int64_t length) {
+    Chunk chunk;
+    chunk.data.resize(length);
+    int64_t done = 0;
+    while (done < length) {
+      // the positioned reads of a file are thread safe
+      tSize n = GetLibHdfs()->Pread(
+          fs, file, offset + done, chunk.data.data() + done, length - done);
+      if (n <= 0) {
+        chunk.ok = false;
+        break;
+      }
+      done += n;
+    }
+    return chunk;
+  }
+
+  hdfsFS fs_;
+  hdfsFile file_;
+  int64_t file_size_;
+  std::string path_;
+  int64_t offset_ = 0;
+  std::deque<std::future<Chunk>> chunks_;
+  Chunk current_;
+  size_t pos_ = 0;
+  bool failed_ = false;
+};
+
+ssize_t ReaderRead(void* cookie, char* buffer, size_t size) {
+  return static_cast<NativeHdfsReader*>(cookie)->Read(buffer, size);
+}
+
+int ReaderClose(void* cookie) {
+  auto* reader = static_cast<NativeHdfsReader*>(cookie);
+  bool failed = reader->failed();
+  delete reader;
+  return failed ? -1 : 0;
+}
+
+}  // namespace
+
+bool hdfs_native_enabled() { return GetLibHdfs() != nullptr; }
+
+std::shared_ptr<FILE> hdfs_native_open_read(const std::string& path,
+                                            int* err_no,
+                                            const std::string& fs_name,
+                                            const std::string& fs_ugi) {
+  const LibHdfs* lib = GetLibHdfs();
+  if (lib == nullptr) {
+    return nullptr;
+  }
+  hdfsFS fs = Connect(fs_name.empty() ? GetNameNode(path) : fs_name, fs_ugi);
+  if (fs == nullptr) {
+    return nullptr;
+  }
+  hdfsFileInfo* info = lib->GetPathInfo(fs, path.c_str());
+  if (info == nullptr) {
+    return nullptr;
+  }
+  bool is_file = info->mKind == kObjectKindFile;
+  int64_t file_size = info->mSize;
+  lib->FreeFileInfo(info, 1);
+  if (!is_file) {
+    return nullptr;
+  }
+  hdfsFile file = lib->OpenFile(fs, path.c_str(), O_RDONLY, 0, 0, 0);
+  if (file == nullptr) {
+    return nullptr;
+  }
+  auto* reader = new NativeHdfsReader(fs, file, file_size, path);
+  cookie_io_functions_t funcs = {ReaderRead, nullptr, nullptr, ReaderClose};
+  FILE* fp = fopencookie(reader, "r", funcs);
+  if (fp == nullptr) {
+    delete reader;
+    return nullptr;
+  }
+  VLOG(3) << "Opening native hdfs file[" << path << "], size " << file_size;
+  return {fp, [path, err_no](FILE* fp) {
+            VLOG(3) << "Closing native hdfs file[" << path << "]";
+            if (fclose(fp) != 0 && err_no != nullptr) {
+              *err_no = -1;
+            }
+          }};
+}
+
+#endif
+
+}  // namespace framework
+}  // namespace paddle
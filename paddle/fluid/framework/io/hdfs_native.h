@@ -0,0 +1,45 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+namespace paddle {
+namespace framework {
+
+// The native reader of the hdfs and afs files. It calls the libhdfs of
+// FLAGS_hdfs_native_library, which is loaded at runtime, so there is no jvm
+// started and no pipe per file. A file is read by the ranged reads of
+// FLAGS_hdfs_native_chunk_size, the next FLAGS_hdfs_native_read_ahead of them
+// are read in parallel on the threads shared by all the files, and the
+// connections are reused by the name node and the ugi.
+
+// Whether FLAGS_hdfs_native_library is set and loaded.
+extern bool hdfs_native_enabled();
+
+// Opens the file for reading, or returns nullptr if it can not be read
+// natively, e.g. a directory or a glob which the hadoop command expands.
+// fs_name is the name node, the one of path is used if it is empty. Like the
+// pipes of shell_popen, *err_no is set to -1 on close if a read failed.
+extern std::shared_ptr<FILE> hdfs_native_open_read(const std::string& path,
+                                                   int* err_no,
+                                                   const std::string& fs_name,
+                                                   const std::string& fs_ugi);
+
+}  // namespace framework
+}  // namespace paddle
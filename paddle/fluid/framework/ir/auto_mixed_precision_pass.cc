@@ -37,8 +37,7 @@ bool PhiKernelSupportPrecision(
     phi::Backend backend,
     phi::DataType data_type,
     phi::DataLayout layout = phi::DataLayout::ALL_LAYOUT) {
-  const auto& kernels = phi::KernelFactory::Instance().kernels();
-  if (kernels.count(op_type) == 0) {
+  if (phi::KernelFactory::Instance().FindKernels(op_type) == nullptr) {
     return false;
   }
   phi::KernelKey kernel_key(backend, layout, data_type);
@@ -43,6 +43,15 @@ PHI_DEFINE_EXPORTED_int32(
     "the number of parameters' gradient. If the fuse_parameter_groups_size is "
     "-1, it means that there are only one group. The default value is 3, it is "
     "an experimental value.");
+PHI_DEFINE_EXPORTED_bool(
+    fuse_parameter_group_by_dtype,
+    false,
+    "fuse_parameter_group_by_dtype controls whether the gradients are "
+    "bucketed per dtype in the order they are produced by the backward, and "
+    "a bucket is closed once it reaches fuse_parameter_memory_size, as the "
+    "reducer of dygraph does. Otherwise the gradients of different dtypes "
+    "are grouped together and split by dtype afterwards, which leaves many "
+    "small groups under AMP.");
 
 namespace paddle::framework::ir {
 // unit of the FLAGS_fuse_parameter_memory_size.
@@ -269,6 +278,10 @@ class CoalesceGradTensorPass : public ir::Pass {
       auto &result_param_grads = (*group_params_grads)[0];
       result_param_grads = params_grads;
       std::sort(result_param_grads.begin(), result_param_grads.end());
+    } else if (FLAGS_fuse_parameter_group_by_dtype &&
+               GetFuseParameterMemorySize() > 0) {
+      SetGroupAccordingToDtypeAndMemorySize(
+          vars_info, params_grads, group_params_grads);
     } else {
       SetGroupAccordingToLayers(vars_info, params_grads, group_params_grads);
       SetGroupAccordingToMemorySize(vars_info, group_params_grads);
@@ -399,6 +412,54 @@ class CoalesceGradTensorPass : public ir::Pass {
     }
   }
 
+  // Buckets the gradients of each dtype in the order they are produced by
+  // the backward, so that the buckets are not split by dtype afterwards and
+  // the first bucket is ready to be reduced as early as possible.
+  void SetGroupAccordingToDtypeAndMemorySize(
+      const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
+      const details::ParamsAndGrads &params_grads,
+      details::GroupParamsAndGrads *group_params_grads) const {
+    const double group_memory_size = GetFuseParameterMemorySize();
+    const int group_params_size = GetFuseParameterGroupsSize();
+    // the open group and its memory size of each dtype
+    std::map<proto::VarType::Type, std::pair<size_t, size_t>> open_groups;
+
+    for (size_t i = 0; i < params_grads.size(); ++i) {
+      auto var_desc = GetVarDescFromVarsInfo(vars_info, params_grads[i].second);
+      auto dtype = var_desc->GetDataType();
+      size_t size = framework::SizeOfType(dtype);
+      auto shape = var_desc->GetShape();
+      std::for_each(shape.begin(), shape.end(), [&size](const int64_t &n) {
+        size *= n;
+      });
+
+      auto iter = open_groups.find(dtype);
+      if (iter == open_groups.end()) {
+        group_params_grads->emplace_back();
+        size_t group_idx = group_params_grads->size() - 1;
+        iter = open_groups.emplace(dtype, std::make_pair(group_idx, size_t{0}))
+                   .first;
+      }
+      auto &group_p_g = group_params_grads->at(iter->second.first);
+      group_p_g.emplace_back(params_grads[i]);
+      iter->second.second += size;
+
+      if (static_cast<double>(iter->second.second) / kMB >= group_memory_size ||
+          (group_params_size > 1 &&
+           group_p_g.size() >= static_cast<size_t>(group_params_size))) {
+        open_groups.erase(iter);
+      }
+    }
+
+    if (VLOG_IS_ON(10)) {
+      VLOG(10) << string::Sprintf(
+          "SetGroupAccordingToDtypeAndMemorySize(memory_size: %f MB, %d):",
+          group_memory_size,
+          group_params_size);
+      PrintGroupInfo(vars_info, group_params_grads);
+    }
+  }
+
   void ReGroupByDtype(
       const std::unordered_map<std::string, std::vector<ir::Node *>> &vars_info,
       details::GroupParamsAndGrads *group_params_grads) const {
@@ -420,6 +420,15 @@ void DetachDeletedNodes(framework::ir::Graph *graph) {
 
 void SubGraphFuser::ReplaceNodesWithSubGraphs() {
   auto subgraphs = SubgraphDetector(graph_, node_inside_subgraph_teller_)();
+  if (partitioner_) {
+    std::vector<std::vector<Node *>> candidates;
+    for (auto &subgraph : subgraphs) {
+      if (subgraph.size() > static_cast<size_t>(min_subgraph_size_)) {
+        candidates.push_back(std::move(subgraph));
+      }
+    }
+    subgraphs = partitioner_(std::move(candidates));
+  }
   for (auto &subgraph : subgraphs) {
     if (subgraph.size() <= static_cast<size_t>(min_subgraph_size_)) continue;
 
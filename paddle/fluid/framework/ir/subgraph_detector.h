@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -67,6 +68,9 @@ class SubgraphDetector {
 class SubGraphFuser {
  public:
   using NodeInsideSubgraphTeller = SubgraphDetector::NodeInsideSubgraphTeller;
+  // Chooses the sub-graphs to fuse out of the detected ones.
+  using SubgraphPartitioner = std::function<std::vector<std::vector<Node *>>(
+      std::vector<std::vector<Node *>>)>;
 
   SubGraphFuser(Graph *graph,
                 const NodeInsideSubgraphTeller &teller,
@@ -82,6 +86,12 @@ class SubGraphFuser {
   // The main method which run all the logic.
   void operator()();
 
+  // Without a partitioner every sub-graph larger than min_subgraph_size is
+  // fused, with one only those it keeps of them.
+  void SetPartitioner(const SubgraphPartitioner &partitioner) {
+    partitioner_ = partitioner;
+  }
+
  protected:
   // Remove the nodes inside sub-graphs and replace with the SubGraphNode.
   void ReplaceNodesWithSubGraphs();
@@ -92,6 +102,7 @@ class SubGraphFuser {
   int min_subgraph_size_;
   std::vector<std::string> trt_exclude_var_names_;
   const std::string name_;
+  SubgraphPartitioner partitioner_;
 };
 
 struct NodeWrapper {
@@ -14,10 +14,21 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/lod_tensor.h"
 
+#include <array>
 #include <cstdint>
+#include <cstring>
 
 #include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_types.h"
+#endif
 
 namespace paddle::framework {
 
@@ -204,7 +215,8 @@ LoDAndOffset GetSubLoDAndAbsoluteOffset(const LoD &lod,
 
 void SerializeToStream(std::ostream &os,
                        const phi::DenseTensor &tensor,
-                       const phi::DeviceContext &dev_ctx) {
+                       const phi::DeviceContext &dev_ctx,
+                       size_t data_alignment) {
   {  // the 1st field, uint32_t version for DenseTensor
     os.write(
         reinterpret_cast<const char *>(&paddle::framework::kCurTensorVersion),
@@ -229,7 +241,7 @@ void SerializeToStream(std::ostream &os,
   }
   // the 3st field, Tensor
   paddle::framework::TensorToStream(
-      os, static_cast<phi::DenseTensor>(tensor), dev_ctx);
+      os, static_cast<phi::DenseTensor>(tensor), dev_ctx, data_alignment);
 }
 
 void SerializeToStream(std::ostream &os, const phi::DenseTensor &tensor) {
@@ -319,6 +331,205 @@ void DeserializeFromStream(std::istream &is,
       is, static_cast<phi::DenseTensor *>(tensor), dev_ctx);
 }
 
+#ifndef _WIN32
+namespace {
+
+// Reads the fields serialized into a mapped file.
+class MappedFileReader {
+ public:
+  MappedFileReader(const char *data, size_t size, const std::string &path)
+      : data_(data), size_(size), path_(path) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Skip(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  // Returns the current position, and moves size bytes forward.
+  const char *Skip(size_t size) {
+    PADDLE_ENFORCE_LE(
+        size,
+        size_ - pos_,
+        common::errors::Unavailable(
+            "An error occurred while loading model parameters from %s. "
+            "Please check whether the model file is complete or damaged.",
+            path_));
+    const char *data = data_ + pos_;
+    pos_ += size;
+    return data;
+  }
+
+  size_t pos() const { return pos_; }
+
+  bool eof() const { return pos_ == size_; }
+
+ private:
+  const char *data_;
+  size_t size_;
+  size_t pos_{0};
+  const std::string &path_;
+};
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+// Copies the data of a mapped file to the GPU in chunks through 2 pinned
+// buffers, so that reading a chunk from the file overlaps the copy of the
+// previous one.
+class ChunkedHostToDeviceCopier {
+ public:
+  explicit ChunkedHostToDeviceCopier(const phi::GPUContext &dev_ctx)
+      : dev_ctx_(dev_ctx) {
+    for (auto &event : events_) {
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          phi::gpuEventCreateWithFlags(&event, phi::gpuEventDisableTiming));
+    }
+  }
+
+  ~ChunkedHostToDeviceCopier() {
+    for (auto &event : events_) {
+      phi::gpuEventDestroy(event);
+    }
+  }
+
+  void Copy(void *dst, const char *src, size_t size) {
+    auto *dst_data = static_cast<char *>(dst);
+    while (size > 0) {
+      size_t chunk_size = std::min(size, kChunkSize);
+      size_t i = next_;
+      next_ = 1 - next_;
+      if (buffers_[i] == nullptr) {
+        buffers_[i] = memory::Alloc(phi::GPUPinnedPlace(), kChunkSize);
+      } else {
+        // the buffer is reused once its last copy is done
+        PADDLE_ENFORCE_GPU_SUCCESS(phi::gpuEventSynchronize(events_[i]));
+      }
+      std::memcpy(buffers_[i]->ptr(), src, chunk_size);
+      memory::Copy(dev_ctx_.GetPlace(),
+                   dst_data,
+                   phi::GPUPinnedPlace(),
+                   buffers_[i]->ptr(),
+                   chunk_size,
+                   dev_ctx_.stream());
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          phi::gpuEventRecord(events_[i], dev_ctx_.stream()));
+      src += chunk_size;
+      dst_data += chunk_size;
+      size -= chunk_size;
+    }
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 16 << 20;  // 16MB
+
+  const phi::GPUContext &dev_ctx_;
+  std::array<memory::AllocationPtr, 2> buffers_;
+  std::array<phi::gpuEvent_t, 2> events_;
+  size_t next_{0};
+};
+#endif
+
+}  // namespace
+#endif
+
+void DeserializeFromMappedFile(const std::string &path,
+                               const std::vector<phi::DenseTensor *> &tensors,
+                               const phi::DeviceContext &dev_ctx) {
+#ifdef _WIN32
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Loading the parameters by mapping file %s is not supported on "
+      "Windows.",
+      path));
+#else
+  auto mapping = memory::allocation::AllocateMappedFileAllocation(path);
+  MappedFileReader reader(
+      static_cast<const char *>(mapping->ptr()), mapping->size(), path);
+  const auto &place = dev_ctx.GetPlace();
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  std::unique_ptr<ChunkedHostToDeviceCopier> copier;
+  if (phi::is_gpu_place(place)) {
+    copier = std::make_unique<ChunkedHostToDeviceCopier>(
+        static_cast<const phi::GPUContext &>(dev_ctx));
+  }
+#endif
+
+  for (auto *tensor : tensors) {
+    {  // the 1st field, uint32_t version for DenseTensor
+      auto version = reader.Read<uint32_t>();
+      PADDLE_ENFORCE_EQ(
+          version,
+          0U,
+          common::errors::InvalidArgument(
+              "Deserialize to tensor failed, maybe the loaded file is "
+              "not a paddle model(expected file format: 0, but %u found).",
+              version));
+    }
+    LoD lod;
+    {  // the 2nd field, LoD information
+      auto lod_level = reader.Read<uint64_t>();
+      lod.resize(lod_level);
+      for (uint64_t i = 0; i < lod_level; ++i) {
+        auto size = reader.Read<uint64_t>();
+        std::vector<size_t> tmp(size / sizeof(size_t));
+        std::memcpy(tmp.data(), reader.Skip(size), size);
+        lod[i] = tmp;
+      }
+    }
+    // the 3rd field, Tensor
+    auto version = reader.Read<uint32_t>();
+    PADDLE_ENFORCE_EQ(
+        version,
+        0U,
+        common::errors::InvalidArgument(
+            "tensor version %u is not supported, Only version 0 is supported",
+            version));
+    proto::VarType::TensorDesc desc;
+    auto desc_size = reader.Read<int32_t>();
+    PADDLE_ENFORCE_EQ(
+        desc_size >= 0 &&
+            desc.ParseFromArray(reader.Skip(desc_size), desc_size),
+        true,
+        common::errors::InvalidArgument("Cannot parse tensor desc"));
+    std::vector<int64_t> dims(desc.dims().begin(), desc.dims().end());
+    phi::DenseTensorMeta meta(framework::TransToPhiDataType(desc.data_type()),
+                              common::make_ddim(dims));
+    meta.offset = reader.pos();
+    size_t size = meta.dims.size() > 0 ? common::product(meta.dims) : 1;
+    size *= phi::SizeOf(meta.dtype);
+    const char *data = reader.Skip(size);
+
+    if (phi::is_cpu_place(place) &&
+        reinterpret_cast<uintptr_t>(data) %
+                memory::allocation::mmap_alignment ==
+            0) {
+      *tensor = phi::DenseTensor(mapping, meta);
+    } else if (phi::is_cpu_place(place)) {
+      tensor->Resize(meta.dims);
+      std::memcpy(dev_ctx.Alloc(tensor, meta.dtype), data, size);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    } else if (copier != nullptr) {
+      tensor->Resize(meta.dims);
+      copier->Copy(dev_ctx.Alloc(tensor, meta.dtype), data, size);
+#endif
+    } else {
+      framework::TensorCopy(
+          phi::DenseTensor(mapping, meta), place, dev_ctx, tensor);
+    }
+    tensor->set_lod(lod);
+  }
+  PADDLE_ENFORCE_EQ(
+      reader.eof(),
+      true,
+      common::errors::Unavailable("Not allowed to load partial data via "
+                                  "load_combine_op, please use load_op "
+                                  "instead."));
+  // the mapping and the pinned buffers are released after the copies
+  if (!phi::is_cpu_place(place)) {
+    dev_ctx.Wait();
+  }
+#endif
+}
+
 LoD ConvertToOffsetBasedLoD(const LoD &length_lod) {
   LoD offset_lod;
   offset_lod.reserve(length_lod.size());
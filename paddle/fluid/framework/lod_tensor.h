@@ -174,7 +174,8 @@ TEST_API std::pair<LoD, std::pair<size_t, size_t>> GetSubLoDAndAbsoluteOffset(
  */
 void SerializeToStream(std::ostream& os,
                        const phi::DenseTensor& tensor,
-                       const phi::DeviceContext& dev_ctx);
+                       const phi::DeviceContext& dev_ctx,
+                       size_t data_alignment = 0);
 void DeserializeFromStream(std::istream& is,
                            phi::DenseTensor* tensor,
                            const phi::DeviceContext& dev_ctx);
@@ -184,6 +185,18 @@ void DeserializeFromStream(std::istream& is,
                            const size_t& seek,
                            const std::vector<int64_t>& shape);
 
+/*
+ * Deserialize the DenseTensors serialized one after another into the file
+ * at path, e.g. by save_combine, by mapping the file instead of reading it.
+ * The CPU tensors share the mapped data if it is aligned, see the
+ * data_alignment of TensorToStream, and the data of the GPU tensors is
+ * copied in chunks through pinned buffers, so that reading the file overlaps
+ * the copies to the device.
+ */
+void DeserializeFromMappedFile(const std::string& path,
+                               const std::vector<phi::DenseTensor*>& tensors,
+                               const phi::DeviceContext& dev_ctx);
+
 TEST_API LoD ConvertToOffsetBasedLoD(const LoD& length_lod);
 
 void SerializeToStream(std::ostream& os, const phi::DenseTensor& tensor);
@@ -14,15 +14,20 @@
 
 #include "paddle/fluid/framework/naive_executor.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/new_executor/pir_interpreter.h"
+#include "paddle/fluid/framework/op_call_stack.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/platform/denormal.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
 #ifdef PADDLE_WITH_DNNL
 #include "paddle/fluid/platform/onednn_helper.h"
 #endif
@@ -33,6 +38,9 @@
 #include "paddle/fluid/platform/device/gpu/cuda/cuda_profiler.h"
 #endif
 
+COMMON_DECLARE_bool(naive_executor_cache_kernel_context);
+COMMON_DECLARE_int32(naive_executor_num_threads);
+
 namespace paddle::framework {
 void NaiveExecutor::Prepare(Scope *scope,
                             const ProgramDesc &program_desc,
@@ -98,62 +106,210 @@ void NaiveExecutor::Run() {
 #ifdef PADDLE_WITH_NVTX
   platform::CudaNvtxRangePush("model", platform::NvtxRangeColor::Yellow);
 #endif
-  for (auto &op : ops_) {
-    VLOG(4) << std::this_thread::get_id() << " run "
-            << op->DebugStringEx(scope_) << " on scope " << scope_;
-    op->SetIsCalledByExecutor(false);
-
-    for (auto &func : input_hookfuncs_) {
-      func(op.get(), scope_);
+  if (!ops_cached_) {
+    for (size_t i = 0; i < ops_.size(); ++i) {
+      RunOp(i);
     }
-
-    if (op->Type() == "while" || op->Type() == "conditional_block") {
-      op->SetOutputHooks(output_hookfuncs_);
-      op->SetInputHooks(input_hookfuncs_);
+    if (FLAGS_naive_executor_cache_kernel_context) {
+      PrepareCachedOps();
     }
+  } else if (!op_levels_.empty()) {
+    RunOpLevels();
+  } else {
+    for (size_t i = 0; i < ops_.size(); ++i) {
+      RunOp(i);
+    }
+  }
+#ifdef PADDLE_WITH_NVTX
+  platform::CudaNvtxRangePop();
+#endif
+}
+
+void NaiveExecutor::RunOp(size_t op_idx) {
+  auto &op = ops_[op_idx];
+  VLOG(4) << std::this_thread::get_id() << " run "
+          << op->DebugStringEx(scope_) << " on scope " << scope_;
+  op->SetIsCalledByExecutor(false);
+
+  for (auto &func : input_hookfuncs_) {
+    func(op.get(), scope_);
+  }
+
+  if (op->Type() == "while" || op->Type() == "conditional_block") {
+    op->SetOutputHooks(output_hookfuncs_);
+    op->SetInputHooks(input_hookfuncs_);
+  }
 
 #ifdef PADDLE_WITH_NVTX
-    platform::CudaNvtxRangePush(op->Type() + "|" + op->OutputVars(true).front(),
-                                platform::NvtxRangeColor::Green);
+  platform::CudaNvtxRangePush(op->Type() + "|" + op->OutputVars(true).front(),
+                              platform::NvtxRangeColor::Green);
 #endif
+  if (ops_cached_ && cached_ops_[op_idx] != nullptr) {
+    // skips the kernel selection and the contexts building of op->Run
+    try {
+      platform::RecordEvent op_record_event(
+          op->Type(), platform::TracerEventType::Operator, 1);
+      cached_ops_[op_idx]->RunCachedKernel();
+    } catch (platform::EnforceNotMet &exception) {
+      framework::InsertCallStackInfo(op->Type(), op->Attrs(), &exception);
+      throw exception;
+    }
+  } else {
     op->Run(*scope_, place_);
+  }
 #ifdef PADDLE_WITH_NVTX
-    platform::CudaNvtxRangePop();
+  platform::CudaNvtxRangePop();
 #endif
 
-    // Update the shared_holder so that only records the max one.
-    if (reuse_cache_.count(op.get())) {
-      for (auto &it : reuse_cache_[op.get()]) {
-        if (it.first->memory_size() >
-            cluster_buffer_[it.second]->memory_size()) {
-          cluster_buffer_[it.second] = it.first;
-          int updated_cluster_id = it.second;
-
-          // cluster_buffer_[it.second] has been updated to be a new
-          // phi::DenseTensor*, we need change all phi::DenseTensor's
-          // shared_holder in this cluster. The following two loops code looks
-          // ugly, it does work. The following two loops seem time-consuming,
-          // but once the memory reaches its peak, the cluster will not update,
-          // so it's ok.
-          for (auto &op_map : reuse_cache_) {
-            // op_map.second is std::unordered_map<phi::DenseTensor*, int>.
-            for (auto &it2 : op_map.second) {
-              if (it2.second == updated_cluster_id) {
-                it2.first->ShareBufferWith(*cluster_buffer_[it2.second], true);
-              }
+  // Update the shared_holder so that only records the max one.
+  if (reuse_cache_.count(op.get())) {
+    for (auto &it : reuse_cache_[op.get()]) {
+      if (it.first->memory_size() >
+          cluster_buffer_[it.second]->memory_size()) {
+        cluster_buffer_[it.second] = it.first;
+        int updated_cluster_id = it.second;
+
+        // cluster_buffer_[it.second] has been updated to be a new
+        // phi::DenseTensor*, we need change all phi::DenseTensor's
+        // shared_holder in this cluster. The following two loops code looks
+        // ugly, it does work. The following two loops seem time-consuming,
+        // but once the memory reaches its peak, the cluster will not update,
+        // so it's ok.
+        for (auto &op_map : reuse_cache_) {
+          // op_map.second is std::unordered_map<phi::DenseTensor*, int>.
+          for (auto &it2 : op_map.second) {
+            if (it2.second == updated_cluster_id) {
+              it2.first->ShareBufferWith(*cluster_buffer_[it2.second], true);
             }
           }
         }
       }
     }
+  }
 
-    for (auto &func : output_hookfuncs_) {
-      func(op.get(), scope_);
+  for (auto &func : output_hookfuncs_) {
+    func(op.get(), scope_);
+  }
+}
+
+void NaiveExecutor::PrepareCachedOps() {
+  cached_ops_.assign(ops_.size(), nullptr);
+  size_t num_cached = 0;
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto *op = dynamic_cast<const OperatorWithKernel *>(ops_[i].get());
+    if (op != nullptr && op->HasCachedKernelContext()) {
+      cached_ops_[i] = op;
+      ++num_cached;
     }
   }
-#ifdef PADDLE_WITH_NVTX
-  platform::CudaNvtxRangePop();
+  ops_cached_ = true;
+  VLOG(3) << "NaiveExecutor caches the kernels of " << num_cached << " of "
+          << ops_.size() << " ops";
+
+  // the hooks and the shared buffers of the memory reuse are not known to
+  // the dependencies of the variables
+  if (FLAGS_naive_executor_num_threads <= 1 || !phi::is_cpu_place(place_) ||
+      !input_hookfuncs_.empty() || !output_hookfuncs_.empty() ||
+      !reuse_cache_.empty()) {
+    return;
+  }
+  // the level of each op is after the writers of its inputs, the writers and
+  // readers of its outputs, and the ops running alone, e.g. the control flow
+  // ops without cached kernels
+  auto run_alone = [this](size_t i) {
+    if (cached_ops_[i] == nullptr) {
+      return true;
+    }
+#ifdef PADDLE_WITH_DNNL
+    // the oneDNN caches are keyed by the executor of the current thread
+    auto &op = ops_[i];
+    if (op->HasAttr("use_mkldnn") && op->Attr<bool>("use_mkldnn")) {
+      return true;
+    }
 #endif
+    return false;
+  };
+  std::unordered_map<std::string, size_t> writer_levels;
+  std::unordered_map<std::string, size_t> reader_levels;
+  size_t barrier_level = 0;
+  size_t max_level = 0;
+  std::vector<size_t> levels(ops_.size(), 0);
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto &op = ops_[i];
+    size_t level = barrier_level;
+    bool alone = run_alone(i);
+    if (alone) {
+      level = max_level + 1;
+    } else {
+      for (auto &name : op->InputVars()) {
+        auto iter = writer_levels.find(name);
+        if (iter != writer_levels.end()) {
+          level = std::max(level, iter->second + 1);
+        }
+      }
+      for (auto &name : op->OutputVars(true)) {
+        auto iter = writer_levels.find(name);
+        if (iter != writer_levels.end()) {
+          level = std::max(level, iter->second + 1);
+        }
+        iter = reader_levels.find(name);
+        if (iter != reader_levels.end()) {
+          level = std::max(level, iter->second + 1);
+        }
+      }
+    }
+    for (auto &name : op->InputVars()) {
+      reader_levels[name] = std::max(reader_levels[name], level);
+    }
+    for (auto &name : op->OutputVars(true)) {
+      writer_levels[name] = level;
+    }
+    if (alone) {
+      barrier_level = level + 1;
+    }
+    levels[i] = level;
+    max_level = std::max(max_level, level);
+  }
+
+  op_levels_.assign(max_level + 1, {});
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    op_levels_[levels[i]].push_back(i);
+  }
+  op_thread_pool_ =
+      std::make_unique<ThreadPool>(FLAGS_naive_executor_num_threads - 1);
+  VLOG(3) << "NaiveExecutor runs " << ops_.size() << " ops in "
+          << op_levels_.size() << " levels by "
+          << FLAGS_naive_executor_num_threads << " threads";
+}
+
+void NaiveExecutor::RunOpLevels() {
+  using ExceptionFuture =
+      std::future<std::unique_ptr<common::enforce::EnforceNotMet>>;
+  std::vector<ExceptionFuture> futures;
+  for (auto &level : op_levels_) {
+    // the first op runs on the current thread
+    futures.clear();
+    for (size_t i = 1; i < level.size(); ++i) {
+      size_t op_idx = level[i];
+      futures.emplace_back(op_thread_pool_->RunAndGetException(
+          [this, op_idx] { RunOp(op_idx); }));
+    }
+    std::unique_ptr<common::enforce::EnforceNotMet> exception;
+    try {
+      RunOp(level.front());
+    } catch (platform::EnforceNotMet &ex) {
+      exception = std::make_unique<common::enforce::EnforceNotMet>(ex);
+    }
+    for (auto &future : futures) {
+      auto ex = future.get();
+      if (exception == nullptr && ex != nullptr) {
+        exception = std::move(ex);
+      }
+    }
+    if (exception != nullptr) {
+      throw *exception;
+    }
+  }
 }
 
 void NaiveExecutor::CreateVariables(const ProgramDesc &desc,
@@ -202,6 +358,9 @@ void NaiveExecutor::CreateVariables(const ProgramDesc &desc,
 }
 
 void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id) {
+  ops_cached_ = false;
+  cached_ops_.clear();
+  op_levels_.clear();
   for (const auto &op_desc : desc.Block(block_id).AllOps()) {
     if (op_desc->Type() == "feed" || op_desc->Type() == "fetch") {
       LOG(INFO) << "---  skip [" << op_desc->Input("X")[0] << "], "
@@ -209,6 +368,12 @@ void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id) {
       continue;
     }
     ops_.emplace_back(OpRegistry::CreateOp(*op_desc));
+    if (FLAGS_naive_executor_cache_kernel_context) {
+      auto *op = dynamic_cast<OperatorWithKernel *>(ops_.back().get());
+      if (op != nullptr) {
+        op->EnableCacheRuntimeContext();
+      }
+    }
   }
 }
 
@@ -224,8 +389,47 @@ phi::DenseTensor *NaiveExecutor::FindTensor(const std::string &name) {
   return tensor;
 }
 
+std::unordered_map<phi::Allocation *, std::pair<size_t, size_t>>
+NaiveExecutor::GetHolderLiveRanges() const {
+  std::unordered_map<phi::Allocation *, std::pair<size_t, size_t>> live_ranges;
+  if (interpreter_core_) {
+    auto *pir_interpreter =
+        dynamic_cast<const PirInterpreter *>(interpreter_core_->Impl());
+    if (pir_interpreter != nullptr) {
+      live_ranges = pir_interpreter->HolderLiveRanges();
+    }
+    return live_ranges;
+  }
+  // the ops of the same level run in any order
+  if (scope_ == nullptr || !op_levels_.empty()) {
+    return live_ranges;
+  }
+  for (size_t pos = 0; pos < ops_.size(); ++pos) {
+    for (auto *vars : {&ops_[pos]->Inputs(), &ops_[pos]->Outputs()}) {
+      for (auto &item : *vars) {
+        for (auto &name : item.second) {
+          auto *var = scope_->FindVar(name);
+          if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+            continue;
+          }
+          auto &holder = var->Get<phi::DenseTensor>().Holder();
+          if (holder == nullptr) {
+            continue;
+          }
+          auto iter =
+              live_ranges.emplace(holder.get(), std::make_pair(pos, pos)).first;
+          iter->second.first = std::min(iter->second.first, pos);
+          iter->second.second = std::max(iter->second.second, pos);
+        }
+      }
+    }
+  }
+  return live_ranges;
+}
+
 void NaiveExecutor::RegisterOutputHook(const HookFunc &hookfunc) {
   output_hookfuncs_.push_back(hookfunc);
+  op_levels_.clear();
   if (interpreter_core_) {
     interpreter_core_->SetOutputHooks(output_hookfuncs_);
   }
@@ -233,6 +437,7 @@ void NaiveExecutor::RegisterOutputHook(const HookFunc &hookfunc) {
 
 void NaiveExecutor::RegisterInputHook(const HookFunc &hookfunc) {
   input_hookfuncs_.push_back(hookfunc);
+  op_levels_.clear();
   if (interpreter_core_) {
     interpreter_core_->SetInputHooks(input_hookfuncs_);
   }
@@ -259,6 +464,8 @@ void NaiveExecutor::MakeReusePlan(
     clusters[it.second].insert(it.first);
   }
 
+  // the ops sharing the buffers can not run in parallel
+  op_levels_.clear();
   std::vector<std::string> cluster_names;
   for (auto &it : clusters) {
     cluster_names.push_back(it.first);
@@ -23,6 +23,7 @@
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/phi/common/place.h"
 
@@ -90,6 +91,11 @@ class NaiveExecutor {
 
   Scope* GetScope() { return scope_; }
 
+  // The [first, last] positions in the execution order of the ops accessing
+  // the dense tensors of each holder, observed after a run.
+  std::unordered_map<phi::Allocation*, std::pair<size_t, size_t>>
+  GetHolderLiveRanges() const;
+
   void MakeReusePlan(
       const std::unordered_map<std::string, std::string>& reuse_table);
 
@@ -103,6 +109,14 @@ class NaiveExecutor {
  private:
   void CreateOps(const ProgramDesc& desc, int block_id);
 
+  void RunOp(size_t op_idx);
+
+  // Records the ops whose kernels and contexts are cached by the first run,
+  // and groups the ops into levels to run in parallel if required.
+  void PrepareCachedOps();
+
+  void RunOpLevels();
+
  private:
   const phi::Place place_;
   // Catch the required resource to avoid recreate.
@@ -120,6 +134,15 @@ class NaiveExecutor {
       reuse_cache_;
   std::vector<phi::DenseTensor*> cluster_buffer_;
 
+  // The ops with the cached kernels, nullptr for the others, see
+  // FLAGS_naive_executor_cache_kernel_context.
+  bool ops_cached_{false};
+  std::vector<const OperatorWithKernel*> cached_ops_;
+  // The indices of the ops of each level, no op depends on the ops of the
+  // same level.
+  std::vector<std::vector<size_t>> op_levels_;
+  std::unique_ptr<ThreadPool> op_thread_pool_;
+
   std::unique_ptr<framework::InterpreterCore> interpreter_core_;
 };
 
@@ -22,8 +22,10 @@
 #include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/cinn/runtime/cinn_runtime.h"
+#include "paddle/phi/backends/gpu/cuda/cuda_graph_with_memory_pool.h"
 #endif
 PD_DECLARE_bool(cinn_bucket_compile);
+PD_DECLARE_bool(cinn_jit_cuda_graph);
 PD_DECLARE_bool(cinn_measure_kernel_time);
 PD_DECLARE_string(tile_config_policy);
 PD_DECLARE_string(cinn_kernel_execution_label);
@@ -41,25 +43,47 @@ class CinnJitInstruction::FnPtrImpl {
   explicit FnPtrImpl(const CINNKernelInfo& cinn_kernel_info)
       : cinn_kernel_info_(cinn_kernel_info) {}
 
-  void Run(const std::vector<phi::DenseTensor*>& kernel_args,
-           void* stream,
-           bool is_gpu) {
-    VLOG(6) << "Start Run: " << cinn_kernel_info_.fn_name;
-    func_args_.clear();
-
-    // 1. Convert the phi::DenseTensor type to cinn_pod_value_t
-    for (size_t i = 0; i < kernel_args.size(); ++i) {
-      auto* buffer = new cinn_buffer_t();
-      buffer->memory = reinterpret_cast<uint8_t*>(kernel_args[i]->data());
-      func_args_.emplace_back(buffer);
+  // Binds the dims of kernel_args to the int args. The buffers of the
+  // tensor args and func_args_ are built on the first call and reused by
+  // the later ones.
+  void PackDims(const std::vector<phi::DenseTensor*>& kernel_args) {
+    if (buffers_.size() != kernel_args.size()) {
+      buffers_.assign(kernel_args.size(), cinn_buffer_t());
+      func_args_.clear();
+      for (auto& buffer : buffers_) {
+        func_args_.emplace_back(&buffer);
+      }
+      func_args_.resize(buffers_.size() +
+                        cinn_kernel_info_.int_args_map.size());
     }
-    // 2. Convert arg's data about shape of Tensor to cinn_pod_value_t
+    size_t idx = buffers_.size();
     for (const auto& int_arg_mp : cinn_kernel_info_.int_args_map) {
-      func_args_.emplace_back(static_cast<int64_t>(
+      func_args_[idx++] = cinn_pod_value_t(static_cast<int64_t>(
           kernel_args[int_arg_mp.second.arg_idx]->dims().at(
               int_arg_mp.second.dim_idx)));
     }
+  }
+
+  // Binds the data of kernel_args, which must be allocated, to the buffers.
+  void PackData(const std::vector<phi::DenseTensor*>& kernel_args) {
+    for (size_t i = 0; i < kernel_args.size(); ++i) {
+      buffers_[i].memory = reinterpret_cast<uint8_t*>(kernel_args[i]->data());
+    }
+  }
+
+  // The data pointers and the dims of the packed args, which a launch
+  // captured into a cuda graph depends on.
+  void AppendLaunchKey(std::vector<int64_t>* key) const {
+    for (const auto& buffer : buffers_) {
+      key->push_back(reinterpret_cast<int64_t>(buffer.memory));
+    }
+    for (size_t i = buffers_.size(); i < func_args_.size(); ++i) {
+      key->push_back(static_cast<int64_t>(func_args_[i]));
+    }
+  }
 
+  void Run(void* stream, bool is_gpu) {
+    VLOG(6) << "Start Run: " << cinn_kernel_info_.fn_name;
     if (VLOG_IS_ON(4)) {
       VLOG(4) << "Run func_args_ size: " << func_args_.size();
       for (const auto& args : func_args_) {
@@ -67,7 +91,7 @@ class CinnJitInstruction::FnPtrImpl {
       }
     }
 
-    // 3. Launch host kernel
+    // Launch host kernel
     if (FLAGS_cinn_measure_kernel_time ||
         FLAGS_tile_config_policy == "search") {
       VLOG(3) << "enter searching config branch";
@@ -116,22 +140,11 @@ class CinnJitInstruction::FnPtrImpl {
                   int32_t input_tensor_size,
                   int32_t output_tensor_size) {
     VLOG(6) << "Start InferShape: " << cinn_kernel_info_.fn_name;
-    func_args_.clear();
-
-    // 1. Convert the phi::DenseTensor type to cinn_pod_value_t
-    for (size_t i = 0; i < kernel_args.size(); ++i) {
-      auto* buffer = new cinn_buffer_t();
-      func_args_.emplace_back(buffer);
-    }
-
-    // 2. Convert arg's data about shape of Tensor to cinn_pod_value_t
-    for (const auto& int_arg_mp : cinn_kernel_info_.int_args_map) {
-      func_args_.emplace_back(static_cast<int64_t>(
-          kernel_args[int_arg_mp.second.arg_idx]->dims().at(
-              int_arg_mp.second.dim_idx)));
-    }
+    // 1. Convert arg's data about shape of Tensor to cinn_pod_value_t, the
+    // infer shape function does not read the buffers.
+    PackDims(kernel_args);
 
-    // 3. Define an array of Pointers to hold the output tensor shape
+    // 2. Define an array of Pointers to hold the output tensor shape
     std::vector<int64_t*> output_tensor_shapes(output_tensor_size);
     for (int i = 0; i < output_tensor_size; ++i) {
       output_tensor_shapes[i] = reinterpret_cast<int64_t*>(
@@ -146,13 +159,13 @@ class CinnJitInstruction::FnPtrImpl {
       }
     }
 
-    // 4. Launch infer_shape_fn_ptr to infer shape of output tensor
+    // 3. Launch infer_shape_fn_ptr to infer shape of output tensor
     ((infer_shape_func_ptr_g)cinn_kernel_info_.infer_shape_fn_ptr)(
         static_cast<void*>(func_args_.data()),
         func_args_.size(),
         output_tensor_shapes.data());
 
-    // 5. Resize shape of output tensor
+    // 4. Resize shape of output tensor
     for (int i = 0; i < output_tensor_size; ++i) {
       DDim dim(output_tensor_shapes[i],
                kernel_args[input_tensor_size + i]->dims().size());
@@ -165,9 +178,112 @@ class CinnJitInstruction::FnPtrImpl {
  private:
   CINNKernelInfo cinn_kernel_info_;
 
+  // func_args_ points to the buffers, so they are never reallocated once
+  // func_args_ is built.
+  std::vector<cinn_buffer_t> buffers_;
   std::vector<cinn_pod_value_t> func_args_;
 };
 
+// The launches of consecutive cinn jit instructions on one stream. They are
+// captured into a cuda graph, which is replayed as long as the data pointers
+// and the dims of the args stay the same and captured again otherwise.
+class CinnJitInstruction::LaunchGroup {
+ public:
+  explicit LaunchGroup(CinnJitInstruction* leader) : instrs_({leader}) {}
+
+  ~LaunchGroup() { DestroyGraph(); }
+
+  void Add(CinnJitInstruction* instr) { instrs_.push_back(instr); }
+
+  size_t size() const { return instrs_.size(); }
+
+  void Run() {
+    for (auto* instr : instrs_) {
+      instr->PrepareLaunch();
+    }
+    if (!UseGraph()) {
+      LaunchAll();
+      return;
+    }
+    auto stream = static_cast<cudaStream_t>(instrs_.front()->RunningStream());
+    key_.clear();
+    for (auto* instr : instrs_) {
+      instr->fn_ptr_impl_->AppendLaunchKey(&key_);
+    }
+    if (graph_exec_ != nullptr && key_ == graph_key_) {
+      captures_without_replay_ = 0;
+    } else if (!Capture(stream)) {
+      LaunchAll();
+      return;
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaGraphLaunch(graph_exec_, stream));
+  }
+
+ private:
+  // A group whose args change on every run is not worth capturing.
+  static constexpr int kMaxCapturesWithoutReplay = 4;
+
+  bool UseGraph() const {
+    return FLAGS_cinn_jit_cuda_graph && !disabled_ &&
+           !FLAGS_cinn_measure_kernel_time &&
+           FLAGS_tile_config_policy != "search" &&
+           !phi::backends::gpu::IsCUDAGraphCapturing();
+  }
+
+  void LaunchAll() {
+    for (auto* instr : instrs_) {
+      instr->Launch();
+    }
+  }
+
+  bool Capture(cudaStream_t stream) {
+    DestroyGraph();
+    if (++captures_without_replay_ > kMaxCapturesWithoutReplay) {
+      VLOG(3) << "The args of the launch group of " << instrs_.size()
+              << " cinn jit instructions keep changing, stop capturing it.";
+      disabled_ = true;
+      return false;
+    }
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+    LaunchAll();
+    cudaGraph_t graph = nullptr;
+    cudaError_t result = cudaStreamEndCapture(stream, &graph);
+    if (result == cudaSuccess) {
+      result = cudaGraphInstantiate(&graph_exec_, graph, nullptr, nullptr, 0);
+      cudaGraphDestroy(graph);
+    }
+    if (result != cudaSuccess) {
+      // Some kernel of the group is not capturable, e.g. it synchronizes
+      // the stream, so the group goes back to the direct launches.
+      cudaGetLastError();
+      graph_exec_ = nullptr;
+      disabled_ = true;
+      VLOG(3) << "Failed to capture the launch group of " << instrs_.size()
+              << " cinn jit instructions: " << cudaGetErrorString(result);
+      return false;
+    }
+    VLOG(6) << "Captured the launch group of " << instrs_.size()
+            << " cinn jit instructions.";
+    graph_key_ = key_;
+    return true;
+  }
+
+  void DestroyGraph() {
+    if (graph_exec_ != nullptr) {
+      cudaGraphExecDestroy(graph_exec_);
+      graph_exec_ = nullptr;
+    }
+  }
+
+  std::vector<CinnJitInstruction*> instrs_;  // not owned
+  std::vector<int64_t> key_;
+  std::vector<int64_t> graph_key_;
+  cudaGraphExec_t graph_exec_{nullptr};
+  int captures_without_replay_{0};
+  bool disabled_{false};
+};
+
 CinnJitInstruction::CinnJitInstruction(
     size_t id,
     const phi::Place& place,
@@ -225,17 +341,36 @@ CinnJitInstruction::CinnJitInstruction(
   }
 }
 
-void CinnJitInstruction::Run() {
-#if defined(PADDLE_WITH_CUDA)
-  void* running_stream = nullptr;
-  bool is_gpu = false;
+bool CinnJitInstruction::CanLaunchWith(const CinnJitInstruction& other) const {
+  return place_.GetType() == phi::AllocationType::GPU &&
+         other.place_ == place_ && other.dev_ctx_ == dev_ctx_;
+}
 
+void CinnJitInstruction::JoinLaunchGroup(CinnJitInstruction* leader) {
+  PADDLE_ENFORCE_EQ(
+      leader->CanLaunchWith(*this),
+      true,
+      common::errors::PreconditionNotMet(
+          "The cinn jit instructions of a launch group must run on the same "
+          "gpu stream."));
+  if (leader->launch_group_ == nullptr) {
+    leader->launch_group_ = std::make_shared<LaunchGroup>(leader);
+    leader->is_group_leader_ = true;
+  }
+  leader->launch_group_->Add(this);
+  launch_group_ = leader->launch_group_;
+  is_group_leader_ = false;
+}
+
+void* CinnJitInstruction::RunningStream() const {
   if (place_.GetType() == phi::AllocationType::GPU) {
-    is_gpu = true;
-    running_stream =
-        static_cast<void*>(static_cast<phi::GPUContext*>(dev_ctx_)->stream());
+    return static_cast<void*>(
+        static_cast<phi::GPUContext*>(dev_ctx_)->stream());
   }
+  return nullptr;
+}
 
+void CinnJitInstruction::PrepareLaunch() {
   if (FLAGS_cinn_bucket_compile && need_update_shape) {
     fn_ptr_impl_->InferShape(
         tensor_args_, input_tensor_size, output_tensor_size);
@@ -243,9 +378,26 @@ void CinnJitInstruction::Run() {
   for (size_t i = 0; i < tensor_args_.size(); ++i) {
     dev_ctx_->Alloc(tensor_args_[i], tensor_args_[i]->dtype());
   }
+  fn_ptr_impl_->PackDims(tensor_args_);
+  fn_ptr_impl_->PackData(tensor_args_);
+}
+
+void CinnJitInstruction::Launch() {
+  fn_ptr_impl_->Run(RunningStream(),
+                    place_.GetType() == phi::AllocationType::GPU);
+}
 
-  // 2. exexute kernel
-  fn_ptr_impl_->Run(tensor_args_, running_stream, is_gpu);
+void CinnJitInstruction::Run() {
+#if defined(PADDLE_WITH_CUDA)
+  if (launch_group_ != nullptr) {
+    // The kernels of the group are all launched by its leader.
+    if (is_group_leader_) {
+      launch_group_->Run();
+    }
+    return;
+  }
+  PrepareLaunch();
+  Launch();
 #else
   VLOG(0) << "Not Supported: cinn jit instruction currently does not "
              "support non-CUDA kernel";
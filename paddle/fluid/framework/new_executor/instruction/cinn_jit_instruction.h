@@ -40,11 +40,32 @@ class CinnJitInstruction : public InstructionBase {
 
   ::pir::Operation* Operation() const override { return op_; }
 
+  // Whether other can be launched right after this instruction in one cuda
+  // graph, i.e. both of them run on the same gpu stream.
+  bool CanLaunchWith(const CinnJitInstruction& other) const;
+
+  // Appends this instruction to the launch group of leader. The leader
+  // launches the whole group in its Run and the Run of the others is empty,
+  // so the caller must make sure that the inputs of this instruction are
+  // ready when the leader runs.
+  void JoinLaunchGroup(CinnJitInstruction* leader);
+
  private:
   class FnPtrImpl;
+  class LaunchGroup;
+
+  void* RunningStream() const;
+
+  // Infers the shapes, allocates the outputs and packs the launch args.
+  void PrepareLaunch();
+
+  void Launch();
 
   std::shared_ptr<FnPtrImpl> fn_ptr_impl_{nullptr};
 
+  std::shared_ptr<LaunchGroup> launch_group_{nullptr};
+  bool is_group_leader_{false};
+
   phi::Place place_;
 
   phi::DeviceContext* dev_ctx_;
@@ -0,0 +1,272 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/instruction/instruction_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <list>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/platform/profiler/chrometracing_logger.h"
+#include "paddle/fluid/platform/profiler/event_node.h"
+#include "paddle/fluid/platform/profiler/trace_event.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace paddle::framework {
+
+namespace {
+
+// the state of the instruction run on the current thread
+thread_local bool current_sampled = false;
+thread_local uint32_t current_name_id = 0;
+thread_local uint64_t run_counter = 0;
+
+constexpr size_t kPhaseNum = static_cast<size_t>(InstructionPhase::kPhaseNum);
+
+}  // namespace
+
+const char* InstructionPhaseName(InstructionPhase phase) {
+  switch (phase) {
+    case InstructionPhase::kInstruction:
+      return "instruction";
+    case InstructionPhase::kWaitEvent:
+      return "wait_event";
+    case InstructionPhase::kInferMeta:
+      return "infer_meta";
+    case InstructionPhase::kShareBuffer:
+      return "share_buffer";
+    case InstructionPhase::kKernel:
+      return "kernel";
+    case InstructionPhase::kGC:
+      return "gc";
+    case InstructionPhase::kRecordEvent:
+      return "record_event";
+    default:
+      return "unknown";
+  }
+}
+
+InstructionProfiler& InstructionProfiler::Instance() {
+  static InstructionProfiler profiler;
+  return profiler;
+}
+
+InstructionProfiler::RunScope::RunScope(const InstructionBase* instr)
+    : prev_sampled_(current_sampled), prev_name_id_(current_name_id) {
+  int32_t interval = FLAGS_pir_instruction_profiler_sample_interval;
+  current_sampled = interval > 0 && (run_counter++ % interval) == 0;
+  if (current_sampled) {
+    current_name_id = InstructionProfiler::Instance().NameId(instr->Name());
+    start_ns_ = phi::PosixInNsec();
+  }
+}
+
+InstructionProfiler::RunScope::~RunScope() {
+  if (current_sampled) {
+    InstructionProfiler::Instance().Record(
+        InstructionPhase::kInstruction, start_ns_, phi::PosixInNsec());
+  }
+  current_sampled = prev_sampled_;
+  current_name_id = prev_name_id_;
+}
+
+InstructionProfiler::PhaseGuard::PhaseGuard(InstructionPhase phase)
+    : phase_(phase) {
+  if (current_sampled) {
+    start_ns_ = phi::PosixInNsec();
+  }
+}
+
+InstructionProfiler::PhaseGuard::~PhaseGuard() {
+  if (current_sampled) {
+    InstructionProfiler::Instance().Record(
+        phase_, start_ns_, phi::PosixInNsec());
+  }
+}
+
+uint32_t InstructionProfiler::NameId(const std::string& name) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = name_ids_.find(name);
+  if (iter != name_ids_.end()) {
+    return iter->second;
+  }
+  uint32_t name_id = static_cast<uint32_t>(names_.size());
+  names_.push_back(name);
+  name_ids_.emplace(name, name_id);
+  return name_id;
+}
+
+const std::string& InstructionProfiler::Name(uint32_t name_id) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return names_.at(name_id);
+}
+
+InstructionProfiler::ThreadBuffer* InstructionProfiler::CurrentThreadBuffer() {
+  // the buffer is shared with the profiler so that its records outlive the
+  // thread
+  thread_local std::shared_ptr<ThreadBuffer> buffer = [this] {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->thread_id = phi::GetCurrentThreadSysId();
+    buffer->records.resize(kRingBufferSize);
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers_.push_back(buffer);
+    return buffer;
+  }();
+  return buffer.get();
+}
+
+void InstructionProfiler::Record(InstructionPhase phase,
+                                 uint64_t start_ns,
+                                 uint64_t end_ns) {
+  ThreadBuffer* buffer = CurrentThreadBuffer();
+  uint64_t written = buffer->written.load(std::memory_order_relaxed);
+  InstructionPhaseRecord& record =
+      buffer->records[written & (kRingBufferSize - 1)];
+  record.name_id = current_name_id;
+  record.phase = phase;
+  record.start_ns = start_ns;
+  record.end_ns = end_ns;
+  buffer->written.store(written + 1, std::memory_order_release);
+}
+
+std::vector<InstructionPhaseRecord> InstructionProfiler::Records() const {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers = buffers_;
+  }
+  std::vector<InstructionPhaseRecord> records;
+  for (auto& buffer : buffers) {
+    uint64_t written = buffer->written.load(std::memory_order_acquire);
+    uint64_t begin = written > kRingBufferSize ? written - kRingBufferSize : 0;
+    for (uint64_t i = begin; i < written; ++i) {
+      records.push_back(buffer->records[i & (kRingBufferSize - 1)]);
+    }
+  }
+  return records;
+}
+
+void InstructionProfiler::ExportChromeTracing(const std::string& path) const {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers = buffers_;
+  }
+  uint64_t process_id = phi::GetProcessId();
+  std::list<platform::HostTraceEvent> host_events;
+  for (auto& buffer : buffers) {
+    uint64_t written = buffer->written.load(std::memory_order_acquire);
+    uint64_t begin = written > kRingBufferSize ? written - kRingBufferSize : 0;
+    for (uint64_t i = begin; i < written; ++i) {
+      const InstructionPhaseRecord& record =
+          buffer->records[i & (kRingBufferSize - 1)];
+      if (record.phase == InstructionPhase::kInstruction) {
+        host_events.emplace_back(Name(record.name_id),
+                                 platform::TracerEventType::Operator,
+                                 record.start_ns,
+                                 record.end_ns,
+                                 process_id,
+                                 buffer->thread_id);
+      } else {
+        host_events.emplace_back(InstructionPhaseName(record.phase),
+                                 platform::TracerEventType::UserDefined,
+                                 record.start_ns,
+                                 record.end_ns,
+                                 process_id,
+                                 buffer->thread_id);
+      }
+    }
+  }
+
+  platform::ChromeTracingLogger logger(path);
+  logger.LogMetaInfo(std::string("1.0.2"), 0);
+  platform::NodeTrees tree(host_events, {}, {}, {}, {});
+  tree.LogMe(&logger);
+  VLOG(1) << "Export " << host_events.size()
+          << " instruction profiler records to " << path;
+}
+
+std::string InstructionProfiler::Report(size_t top_n) const {
+  struct Stat {
+    uint32_t name_id{0};
+    uint64_t samples{0};
+    std::array<uint64_t, kPhaseNum> phase_ns{};
+  };
+  std::unordered_map<uint32_t, Stat> stats;
+  for (auto& record : Records()) {
+    Stat& stat = stats[record.name_id];
+    stat.name_id = record.name_id;
+    stat.phase_ns[static_cast<size_t>(record.phase)] +=
+        record.end_ns - record.start_ns;
+    if (record.phase == InstructionPhase::kInstruction) {
+      ++stat.samples;
+    }
+  }
+
+  std::vector<Stat> sorted;
+  for (auto& item : stats) {
+    if (item.second.samples > 0) {
+      sorted.push_back(item.second);
+    }
+  }
+  auto TotalNs = [](const Stat& stat) {
+    return stat.phase_ns[static_cast<size_t>(InstructionPhase::kInstruction)];
+  };
+  std::sort(sorted.begin(), sorted.end(), [&](const Stat& a, const Stat& b) {
+    return TotalNs(a) > TotalNs(b);
+  });
+  if (sorted.size() > top_n) {
+    sorted.resize(top_n);
+  }
+
+  // the host time of each phase per sample in us, "other" is the time of the
+  // instruction not covered by the phases
+  std::stringstream ss;
+  ss << std::left << std::setw(48) << "instruction" << std::right
+     << std::setw(10) << "samples" << std::setw(12) << "total(us)";
+  for (size_t phase = 1; phase < kPhaseNum; ++phase) {
+    ss << std::setw(14)
+       << InstructionPhaseName(static_cast<InstructionPhase>(phase));
+  }
+  ss << std::setw(12) << "other" << "\n";
+  ss << std::fixed << std::setprecision(2);
+  for (auto& stat : sorted) {
+    double samples = static_cast<double>(stat.samples);
+    uint64_t covered_ns = 0;
+    ss << std::left << std::setw(48) << Name(stat.name_id) << std::right
+       << std::setw(10) << stat.samples << std::setw(12)
+       << TotalNs(stat) / samples / 1000.0;
+    for (size_t phase = 1; phase < kPhaseNum; ++phase) {
+      covered_ns += stat.phase_ns[phase];
+      ss << std::setw(14) << stat.phase_ns[phase] / samples / 1000.0;
+    }
+    uint64_t other_ns = TotalNs(stat) > covered_ns ? TotalNs(stat) - covered_ns
+                                                   : 0;
+    ss << std::setw(12) << other_ns / samples / 1000.0 << "\n";
+  }
+  return ss.str();
+}
+
+void InstructionProfiler::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto& buffer : buffers_) {
+    buffer->written.store(0, std::memory_order_release);
+  }
+}
+
+}  // namespace paddle::framework
@@ -0,0 +1,143 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/common/macros.h"
+
+COMMON_DECLARE_int32(pir_instruction_profiler_sample_interval);
+
+namespace paddle {
+namespace framework {
+
+class InstructionBase;
+
+// The host side phases of running an instruction. kInstruction covers the
+// whole run and the others are nested in it.
+enum class InstructionPhase : uint8_t {
+  kInstruction = 0,
+  kWaitEvent,
+  kInferMeta,
+  kShareBuffer,
+  kKernel,
+  kGC,
+  kRecordEvent,
+  kPhaseNum,
+};
+
+const char* InstructionPhaseName(InstructionPhase phase);
+
+struct InstructionPhaseRecord {
+  uint32_t name_id{0};
+  InstructionPhase phase{InstructionPhase::kInstruction};
+  uint64_t start_ns{0};
+  uint64_t end_ns{0};
+};
+
+// A sampling profiler of the host overhead of instructions. One run in every
+// FLAGS_pir_instruction_profiler_sample_interval runs of each thread is
+// sampled, and its phases are recorded into a ring buffer owned by the
+// thread, so that recording needs neither locks nor allocations. The records
+// can be exported as a chrome tracing file and aggregated into a report of
+// the most host-bound instructions.
+//
+// NOTE: Export and Report read the ring buffers without synchronizing with
+// the writers, call them when no instruction is running.
+class InstructionProfiler {
+ public:
+  static constexpr size_t kRingBufferSize = 1 << 16;
+
+  static InstructionProfiler& Instance();
+
+  static bool Enabled() {
+    return FLAGS_pir_instruction_profiler_sample_interval > 0;
+  }
+
+  // Samples the runs of instructions in its scope on the current thread.
+  class RunScope {
+   public:
+    explicit RunScope(const InstructionBase* instr);
+    ~RunScope();
+
+   private:
+    bool prev_sampled_;
+    uint32_t prev_name_id_;
+    uint64_t start_ns_{0};
+
+    DISABLE_COPY_AND_ASSIGN(RunScope);
+  };
+
+  // Records a phase if the current instruction run is sampled.
+  class PhaseGuard {
+   public:
+    explicit PhaseGuard(InstructionPhase phase);
+    ~PhaseGuard();
+
+   private:
+    InstructionPhase phase_;
+    uint64_t start_ns_{0};
+
+    DISABLE_COPY_AND_ASSIGN(PhaseGuard);
+  };
+
+  // Writes the records into a chrome tracing file.
+  void ExportChromeTracing(const std::string& path) const;
+
+  // Returns a table of the top_n instructions with the most host time.
+  std::string Report(size_t top_n) const;
+
+  // Returns all the records in the ring buffers.
+  std::vector<InstructionPhaseRecord> Records() const;
+
+  const std::string& Name(uint32_t name_id) const;
+
+  void Clear();
+
+ private:
+  struct ThreadBuffer {
+    uint64_t thread_id{0};
+    std::vector<InstructionPhaseRecord> records;
+    // the number of records ever written, only the last kRingBufferSize of
+    // them are kept
+    std::atomic<uint64_t> written{0};
+  };
+
+  InstructionProfiler() = default;
+
+  uint32_t NameId(const std::string& name);
+
+  void Record(InstructionPhase phase, uint64_t start_ns, uint64_t end_ns);
+
+  ThreadBuffer* CurrentThreadBuffer();
+
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::deque<std::string> names_;
+
+  DISABLE_COPY_AND_ASSIGN(InstructionProfiler);
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -34,6 +34,11 @@
 #include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/pir/include/core/block_argument.h"
+#ifdef PADDLE_WITH_XPU
+#include "paddle/common/flags.h"
+#include "paddle/phi/backends/xpu/xpu_context.h"
+COMMON_DECLARE_bool(new_executor_xpu_copy_stream);
+#endif
 #if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
 #include "paddle/common/flags.h"
 #include "paddle/fluid/platform/collective_helper.h"
@@ -158,6 +163,30 @@ phi::DeviceContext* ParseDeviceContext(pir::Operation* op,
 #endif
   }
 
+#ifdef PADDLE_WITH_XPU
+  // The memcpy kernels of xpu wait on the host for the stream of their
+  // context only, so on streams of their own they overlap with the compute.
+  if (phi::is_xpu_place(place) && FLAGS_new_executor_xpu_copy_stream &&
+      execution_stream == kDefaultStream) {
+    const char* copy_stream = nullptr;
+    if (op_name.compare(paddle::dialect::MemcpyD2hOp::name()) == 0) {
+      copy_stream = kD2HStream;
+    } else if (op_name.compare(paddle::dialect::MemcpyH2dOp::name()) == 0) {
+      copy_stream = kH2DStream;
+    }
+    if (copy_stream != nullptr) {
+      dev_ctx =
+          ctx_manager.Get(std::string(copy_stream), place, stream_priority)
+              .get()
+              .get();
+      // the contexts of the manager start on the default stream
+      static_cast<phi::XPUContext*>(dev_ctx)->CreateStream();
+      interpreter::SetDeviceCommContext(op, dev_ctx);
+      return dev_ctx;
+    }
+  }
+#endif
+
   if (origin_dev_ctx != nullptr) {
     interpreter::SetDeviceCommContext(op, origin_dev_ctx);
   }
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/new_executor/instruction/legacy_kernel_instruction.h"
 
+#include "paddle/fluid/framework/new_executor/instruction/instruction_profiler.h"
 #include "paddle/fluid/framework/new_executor/instruction/instruction_util.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
 #include "paddle/fluid/framework/new_executor/interpreter/stream_analyzer.h"
@@ -188,12 +189,17 @@ LegacyKernelInstruction::~LegacyKernelInstruction() {
 void LegacyKernelInstruction::Run() {
   VLOG(6) << "Run op " << legacy_op_name_ << " infer meta.";
   if (infer_meta_interface_) {
+    InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kInferMeta);
     infer_meta_interface_->infer_meta_(&(infer_meta_context_));
   }
-  for (auto& pair : this->InplaceInfo()) {
-    ShareVarBuffer(pair.first, pair.second);
+  {
+    InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kShareBuffer);
+    for (auto& pair : this->InplaceInfo()) {
+      ShareVarBuffer(pair.first, pair.second);
+    }
   }
   VLOG(6) << "Run op " << legacy_op_name_ << " kernel.";
+  InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kKernel);
   (*(phi_kernel_))((kernel_context_));
 }
 }  // namespace paddle::framework
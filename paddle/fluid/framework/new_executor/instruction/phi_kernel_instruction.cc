@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/new_executor/instruction/phi_kernel_instruction.h"
 
+#include "paddle/fluid/framework/new_executor/instruction/instruction_profiler.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
 #include "paddle/fluid/framework/new_executor/interpreter/stream_analyzer.h"
 #include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
@@ -33,6 +34,10 @@
 #include "paddle/pir/include/core/value.h"
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_util.h"
+
+COMMON_DECLARE_bool(pir_interpreter_infer_meta_cache);
+COMMON_DECLARE_bool(pir_interpreter_infer_meta_cache_check);
+
 namespace paddle {
 namespace framework {
 
@@ -160,6 +165,29 @@ PhiKernelInstruction::PhiKernelInstruction(
 
   kernel_context_.SetDeviceContext(dev_ctx);
   VLOG(6) << "finish process kernel context";
+
+  if (infer_meta_interface_) {
+    infer_meta_cacheable_ = true;
+    for (auto& attr_name : yaml_info_parser.AttrParams(false)) {
+      if (yaml_info_parser.InputName2Id().count(attr_name)) {
+        infer_meta_cacheable_ = false;
+      }
+    }
+    for (size_t i = 0; i < kernel_context_.InputsSize(); ++i) {
+      const phi::TensorBase* input = kernel_context_.MutableIutputAt(i);
+      if (input != nullptr && !phi::DenseTensor::classof(input)) {
+        infer_meta_cacheable_ = false;
+      }
+    }
+    for (size_t i = 0; i < kernel_context_.OutputsSize(); ++i) {
+      phi::TensorBase* output = kernel_context_.MutableOutputAt(i);
+      if (output != nullptr && !phi::DenseTensor::classof(output)) {
+        infer_meta_cacheable_ = false;
+      }
+    }
+    VLOG(6) << "infer meta of " << phi_op_name_
+            << " is cacheable: " << infer_meta_cacheable_;
+  }
   if (op->attributes().count("is_inplace") != 0 &&
       op->attributes().at("is_inplace").dyn_cast<pir::BoolAttribute>().data()) {
     HandleForInplaceOp(op, value_exec_info_, this);
@@ -178,23 +206,114 @@ PhiKernelInstruction::PhiKernelInstruction(
 
 PhiKernelInstruction::~PhiKernelInstruction() { delete phi_kernel_; }
 
+bool PhiKernelInstruction::InferMetaCacheHit() const {
+  if (!infer_meta_cache_valid_) {
+    return false;
+  }
+  static const phi::DenseTensorMeta kNullMeta;
+  for (size_t i = 0; i < kernel_context_.InputsSize(); ++i) {
+    const phi::TensorBase* input = kernel_context_.MutableIutputAt(i);
+    const phi::DenseTensorMeta& meta =
+        input ? static_cast<const phi::DenseTensor*>(input)->meta()
+              : kNullMeta;
+    if (!(meta == infer_meta_cache_inputs_[i])) {
+      return false;
+    }
+  }
+  // the outputs are checked as well, since they may be reset by others, e.g.
+  // the inplace ops sharing them
+  for (size_t i = 0; i < kernel_context_.OutputsSize(); ++i) {
+    const phi::TensorBase* output =
+        const_cast<phi::KernelContext&>(kernel_context_).MutableOutputAt(i);
+    const phi::DenseTensorMeta& meta =
+        output ? static_cast<const phi::DenseTensor*>(output)->meta()
+               : kNullMeta;
+    if (!(meta == infer_meta_cache_outputs_[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PhiKernelInstruction::UpdateInferMetaCache() {
+  infer_meta_cache_inputs_.resize(kernel_context_.InputsSize());
+  for (size_t i = 0; i < kernel_context_.InputsSize(); ++i) {
+    const phi::TensorBase* input = kernel_context_.MutableIutputAt(i);
+    infer_meta_cache_inputs_[i] =
+        input ? static_cast<const phi::DenseTensor*>(input)->meta()
+              : phi::DenseTensorMeta();
+  }
+  infer_meta_cache_outputs_.resize(kernel_context_.OutputsSize());
+  for (size_t i = 0; i < kernel_context_.OutputsSize(); ++i) {
+    const phi::TensorBase* output = kernel_context_.MutableOutputAt(i);
+    infer_meta_cache_outputs_[i] =
+        output ? static_cast<const phi::DenseTensor*>(output)->meta()
+               : phi::DenseTensorMeta();
+  }
+  infer_meta_cache_valid_ = true;
+}
+
+void PhiKernelInstruction::CheckInferMetaCache() const {
+  std::vector<phi::DenseTensorMeta> cached_outputs = infer_meta_cache_outputs_;
+  infer_meta_interface_->infer_meta_(
+      const_cast<phi::InferMetaContext*>(&infer_meta_context_));
+  for (size_t i = 0; i < kernel_context_.OutputsSize(); ++i) {
+    const phi::TensorBase* output =
+        const_cast<phi::KernelContext&>(kernel_context_).MutableOutputAt(i);
+    if (output == nullptr) {
+      continue;
+    }
+    const phi::DenseTensorMeta& meta =
+        static_cast<const phi::DenseTensor*>(output)->meta();
+    PADDLE_ENFORCE_EQ(
+        meta == cached_outputs[i],
+        true,
+        common::errors::PreconditionNotMet(
+            "The cached infer meta of output %d of %s is inconsistent with "
+            "InferMeta, cached dims [%s] vs [%s], cached dtype %s vs %s.",
+            i,
+            phi_op_name_,
+            cached_outputs[i].dims,
+            meta.dims,
+            cached_outputs[i].dtype,
+            meta.dtype));
+  }
+}
+
 void PhiKernelInstruction::Run() {
   VLOG(6) << "Begin run op " << phi_op_name_ << " infer meta.";
   if (infer_meta_interface_) {
     platform::RecordEvent record_event("PhiKernelInstruction::infermeta",
                                        platform::TracerEventType::UserDefined,
                                        1);
-    infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+    InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kInferMeta);
+    bool use_cache = FLAGS_pir_interpreter_infer_meta_cache &&
+                     infer_meta_cacheable_;
+    if (use_cache && InferMetaCacheHit()) {
+      VLOG(6) << "Skip infer meta of " << phi_op_name_;
+      if (FLAGS_pir_interpreter_infer_meta_cache_check) {
+        CheckInferMetaCache();
+      }
+    } else {
+      infer_meta_interface_->infer_meta_(&(infer_meta_context_));
+      if (use_cache) {
+        UpdateInferMetaCache();
+      }
+    }
   }
   VLOG(6) << "End run op " << phi_op_name_ << " infer meta.";
-  for (auto& pair : this->InplaceInfo()) {
-    ShareVarBuffer(pair.first, pair.second);
+  {
+    InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kShareBuffer);
+    for (auto& pair : this->InplaceInfo()) {
+      ShareVarBuffer(pair.first, pair.second);
+    }
   }
   VLOG(6) << "Begin run op " << phi_op_name_ << " kernel.";
   {
     platform::RecordEvent record_event("PhiKernelInstruction::kernel launch",
                                        platform::TracerEventType::UserDefined,
                                        1);
+    InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kKernel);
     (*(phi_kernel_))(&(kernel_context_));
   }
 
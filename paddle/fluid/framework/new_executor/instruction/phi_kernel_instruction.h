@@ -15,6 +15,7 @@
 #pragma once
 
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/phi/core/dense_tensor.h"
 
 namespace pir {
 class Operation;
@@ -53,11 +54,26 @@ class PhiKernelInstruction : public InstructionBase {
   const std::string& Name() const override { return phi_op_name_; }
 
  private:
+  // whether the metas of the inputs and the outputs are the same as those
+  // after the last InferMeta, see FLAGS_pir_interpreter_infer_meta_cache
+  bool InferMetaCacheHit() const;
+
+  void UpdateInferMetaCache();
+
+  void CheckInferMetaCache() const;
+
   paddle::dialect::InferMetaInterface::Concept* infer_meta_interface_{
       nullptr};  // not owned
 
   phi::InferMetaContext infer_meta_context_;
 
+  // InferMeta can be skipped only if it depends on nothing but the metas of
+  // dense tensors, i.e. no tensor attribute and no other tensor type
+  bool infer_meta_cacheable_{false};
+  bool infer_meta_cache_valid_{false};
+  std::vector<phi::DenseTensorMeta> infer_meta_cache_inputs_;
+  std::vector<phi::DenseTensorMeta> infer_meta_cache_outputs_;
+
   phi::KernelContext kernel_context_;
 
   phi::Kernel* phi_kernel_{nullptr};  // not owned
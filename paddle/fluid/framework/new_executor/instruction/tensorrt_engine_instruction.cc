@@ -172,6 +172,21 @@ TensorRTEngineInstruction::TensorRTEngineInstruction(
 
   InitInputsOutputsIds(op, *value_exec_info_);
   VLOG(6) << "finish process inputs outputs index";
+
+  // The new values of the parameters are pushed into the refittable engine
+  // by AnalysisPredictor::UpdateParams.
+  if (trt_engine_->IsRefittable()) {
+    auto stream = reinterpret_cast<const phi::GPUContext *>(dev_ctx_)->stream();
+    paddle::inference::Singleton<paddle::platform::TRTRefitManager>::Global()
+        .Register(trt_engine_.get(), value_exec_info_->GetScope(), stream);
+  }
+}
+
+TensorRTEngineInstruction::~TensorRTEngineInstruction() {
+  if (trt_engine_ && trt_engine_->IsRefittable()) {
+    paddle::inference::Singleton<paddle::platform::TRTRefitManager>::Global()
+        .Unregister(trt_engine_.get());
+  }
 }
 
 static void RuntimeDynamicShapeCheck(
@@ -35,6 +35,8 @@ class TensorRTEngineInstruction : public InstructionBase {
                             ::pir::Operation* op,
                             const ValueExecutionInfo* value_exec_info);
 
+  ~TensorRTEngineInstruction() override;
+
   ::pir::Operation* Operation() const override { return op_; }
 
   void Run() override;
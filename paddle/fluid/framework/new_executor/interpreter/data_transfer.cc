@@ -26,8 +26,58 @@
 #include "paddle/phi/backends/onednn/onednn_context.h"
 #endif
 
+COMMON_DECLARE_bool(new_executor_fused_data_transfer);
+
 namespace paddle::framework::interpreter {
 
+namespace {
+
+bool IsFusedTransferDtype(phi::DataType dtype) {
+  return dtype == phi::DataType::FLOAT32 || dtype == phi::DataType::FLOAT64 ||
+         dtype == phi::DataType::FLOAT16 || dtype == phi::DataType::BFLOAT16 ||
+         dtype == phi::DataType::INT32 || dtype == phi::DataType::INT64;
+}
+
+bool IsFusedTransferLayout(DataLayout layout) {
+  return layout == DataLayout::kNCHW || layout == DataLayout::kNHWC;
+}
+
+}  // namespace
+
+bool DataTransferHelper::CanFuse(const phi::KernelKey& kernel_type_for_var,
+                                 const phi::KernelKey& expected_kernel_key,
+                                 const phi::DenseTensor* tensor,
+                                 const std::string& var_name,
+                                 bool need_layout,
+                                 bool need_device) const {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (!FLAGS_new_executor_fused_data_transfer || !phi::is_gpu_place(place_)) {
+    return false;
+  }
+  // the fused op runs on the gpu of place_ and writes its output there
+  const auto& src_place = tensor->place();
+  phi::Place dst_place =
+      need_device ? phi::TransToPhiPlace(expected_kernel_key.backend())
+                  : src_place;
+  if (!phi::is_same_place(dst_place, place_) ||
+      !(phi::is_cpu_place(src_place) || phi::is_cuda_pinned_place(src_place) ||
+        phi::is_same_place(src_place, place_))) {
+    return false;
+  }
+  if (need_layout && (!IsFusedTransferLayout(kernel_type_for_var.layout()) ||
+                      !IsFusedTransferLayout(expected_kernel_key.layout()) ||
+                      tensor->dims().size() != 4)) {
+    return false;
+  }
+  auto* var = scope_->FindVar(var_name);
+  return var != nullptr && var->IsType<phi::DenseTensor>() &&
+         IsFusedTransferDtype(tensor->dtype()) &&
+         IsFusedTransferDtype(expected_kernel_key.dtype());
+#else
+  return false;
+#endif
+}
+
 bool DataTransferHelper::apply(const phi::KernelKey& kernel_type_for_var,
                                const phi::KernelKey& expected_kernel_key,
                                const phi::DenseTensor* tensor,
@@ -40,8 +90,55 @@ bool DataTransferHelper::apply(const phi::KernelKey& kernel_type_for_var,
   bool is_transferred = false;
   auto* src_var_name = &var_name;
 
+  // 0. fused transform when more than one of the following is needed, which
+  // saves the intermediate tensors and the host side layout and dtype
+  // transforms before an h2d copy
+  bool need_layout =
+      need_layout_transform(kernel_type_for_var, expected_kernel_key);
+  bool need_dtype =
+      need_dtype_transform(kernel_type_for_var, expected_kernel_key);
+  bool need_device = need_device_transform(
+      kernel_type_for_var, tensor, expected_kernel_key.backend());
+  if (need_layout + need_dtype + need_device >= 2 &&
+      CanFuse(kernel_type_for_var,
+              expected_kernel_key,
+              tensor,
+              var_name,
+              need_layout,
+              need_device)) {
+    auto* var_desc =
+        var_scope_->HasVar(var_name) ? var_scope_->VarDesc(var_name) : nullptr;
+    bool cached = cache_persistable_ && !static_build && var_desc != nullptr &&
+                  var_desc->Persistable();
+    auto in_layout =
+        need_layout ? kernel_type_for_var.layout() : tensor->layout();
+    auto out_layout = need_layout ? expected_kernel_key.layout() : in_layout;
+    auto out_dtype = need_dtype ? expected_kernel_key.dtype() : tensor->dtype();
+    auto op = TransferFused(var_name,
+                            new_var_name,
+                            in_layout,
+                            out_layout,
+                            framework::TransToProtoVarType(tensor->dtype()),
+                            framework::TransToProtoVarType(out_dtype),
+                            place_,
+                            var_scope_,
+                            scope_,
+                            cached);
+    if (op) {
+      if (cached) {
+        // run it once here, the following runs read the cached output
+        std::vector<OpFuncNode> once;
+        RunAndConstructOpFuncNode(op, var_name, *new_var_name, &once);
+      } else {
+        RunAndConstructOpFuncNode(
+            op, var_name, *new_var_name, op_func_nodes, static_build);
+      }
+    }
+    return true;
+  }
+
   // 1. layout transform
-  if (need_layout_transform(kernel_type_for_var, expected_kernel_key)) {
+  if (need_layout) {
     auto op = TransferLayout(*src_var_name,
                              new_var_name,
                              kernel_type_for_var.layout(),
@@ -59,7 +156,7 @@ bool DataTransferHelper::apply(const phi::KernelKey& kernel_type_for_var,
   }
 
   // 2. dtype transform
-  if (need_dtype_transform(kernel_type_for_var, expected_kernel_key)) {
+  if (need_dtype) {
     auto op = TransferDtype(
         *src_var_name,
         new_var_name,
@@ -77,10 +174,9 @@ bool DataTransferHelper::apply(const phi::KernelKey& kernel_type_for_var,
   }
 
   // 3. device transform
-  phi::Backend expected_backend = expected_kernel_key.backend();
-  if (need_device_transform(kernel_type_for_var, tensor, expected_backend)) {
+  if (need_device) {
     auto src_place = tensor->place();
-    auto dst_place = phi::TransToPhiPlace(expected_backend);
+    auto dst_place = phi::TransToPhiPlace(expected_kernel_key.backend());
 
     auto op = TransferDevice(
         *src_var_name, new_var_name, src_place, dst_place, var_scope_, scope_);
@@ -445,6 +541,68 @@ std::shared_ptr<OperatorBase> TransferDevice(const std::string& var_name,
   return op;
 }
 
+std::shared_ptr<OperatorBase> TransferFused(const std::string& var_name,
+                                            std::string* new_var_name,
+                                            DataLayout in_layout,
+                                            DataLayout out_layout,
+                                            proto::VarType::Type in_dtype,
+                                            proto::VarType::Type out_dtype,
+                                            const phi::Place& dst_place,
+                                            VariableScope* var_scope,
+                                            framework::Scope* local_scope,
+                                            bool cached) {
+  // 1. Generate new_var_name and Initialize it
+  *new_var_name = var_name + "_fused_" +
+                  std::to_string(static_cast<int>(in_layout)) + "_" +
+                  std::to_string(static_cast<int>(out_layout)) + "_" +
+                  std::to_string(static_cast<int>(in_dtype)) + "_" +
+                  std::to_string(static_cast<int>(out_dtype)) + "_" +
+                  dst_place.DebugString();
+
+  if (var_scope->HasVar(*new_var_name) &&
+      IsTensorOfVarInitialized(local_scope->FindVar(*new_var_name))) {
+    // already has same var
+    VLOG(4) << "Use cached variable: " << *new_var_name;
+    return nullptr;
+  }
+
+  auto* ptr = local_scope->Var(*new_var_name);
+  auto var_type = local_scope->FindVar(var_name)->Type();
+  InitializeVariable(ptr, static_cast<proto::VarType::Type>(var_type));
+  VLOG(3) << "Create Variable " << *new_var_name
+          << " locally, which pointer is " << ptr << "Variable Type "
+          << var_type;
+  if (!cached) {
+    var_scope->MutableDataTransferAddedVars().emplace_back(*new_var_name,
+                                                           var_type);
+  }
+  var_scope->AddVar(*new_var_name, nullptr);
+
+  // 2. Construct VariableNameMap
+  VariableNameMap in_name_map = {{"X", {var_name}}};
+  VariableNameMap out_name_map = {{"Out", {*new_var_name}}};
+  AttributeMap attr_map = {{"src_layout", static_cast<int>(in_layout)},
+                           {"dst_layout", static_cast<int>(out_layout)},
+                           {"out_dtype", static_cast<int>(out_dtype)}};
+
+  // 3. Create fused_data_transfer op
+  std::string op_type("fused_data_transfer");
+  auto& op_info = OpInfoMap::Instance().Get(op_type);
+  auto op = std::shared_ptr<OperatorBase>(
+      op_info.Creator()(op_type, in_name_map, out_name_map, attr_map));
+
+  VLOG(3) << string::Sprintf("Insert %s with %s(%s, %s) -> %s(%s, %s, %s).",
+                             op_type,
+                             var_name,
+                             in_layout,
+                             DataTypeToString(in_dtype),
+                             *new_var_name,
+                             out_layout,
+                             DataTypeToString(out_dtype),
+                             dst_place);
+  return op;
+}
+
 void ApplyDataTransform(const OpKernelType& expected_kernel_key,
                         const phi::Place& place,
                         VariableValueMap* ins_map_temp,
@@ -453,7 +611,8 @@ void ApplyDataTransform(const OpKernelType& expected_kernel_key,
                         OpFuncNode* op_func_node,
                         std::vector<OpFuncNode>* new_op_func_nodes,
                         bool use_local_scope,
-                        bool static_build) {
+                        bool static_build,
+                        bool cache_persistable) {
   Scope* local_scope = use_local_scope ? var_scope->GetMutableLocalScope()
                                        : var_scope->GetMutableScope();
 
@@ -477,7 +636,8 @@ void ApplyDataTransform(const OpKernelType& expected_kernel_key,
   }
 
   bool transfered = false;
-  DataTransferHelper data_transfer_helper(place, var_scope, local_scope);
+  DataTransferHelper data_transfer_helper(
+      place, var_scope, local_scope, cache_persistable);
   phi::Kernel* phi_kernel = op_func_node->phi_kernel_;
   auto has_infer_varkernel_fn =
       (phi_kernel && phi_kernel->get_kerneltype_forvar_fn_ != nullptr);
@@ -25,14 +25,21 @@ namespace interpreter {
 
 /*
  * A Helper class to implement data transform operation.
- * It will apply layout/dtype/device transfer by turns.
+ * It will apply layout/dtype/device transfer by turns, or all of them in one
+ * fused_data_transfer op on the GPU when more than one is needed. With
+ * cache_persistable, the fused transfer of a persistable var runs only once
+ * and its result is kept for the following runs.
  */
 class DataTransferHelper {
  public:
   DataTransferHelper(const phi::Place& place,
                      VariableScope* var_scope,
-                     Scope* local_scope)
-      : place_(place), var_scope_(var_scope), scope_(local_scope) {}
+                     Scope* local_scope,
+                     bool cache_persistable = false)
+      : place_(place),
+        var_scope_(var_scope),
+        scope_(local_scope),
+        cache_persistable_(cache_persistable) {}
 
   bool apply(const phi::KernelKey& kernel_type_for_var,
              const phi::KernelKey& expected_kernel_key,
@@ -56,9 +63,17 @@ class DataTransferHelper {
                                  bool static_build = false);
 
  private:
+  bool CanFuse(const phi::KernelKey& kernel_type_for_var,
+               const phi::KernelKey& expected_kernel_key,
+               const phi::DenseTensor* tensor,
+               const std::string& var_name,
+               bool need_layout,
+               bool need_device) const;
+
   phi::Place place_;
   VariableScope* var_scope_;
   Scope* scope_;
+  bool cache_persistable_;
 };
 
 void ApplyDataTransform(const OpKernelType& expected_kernel_key,
@@ -69,7 +84,8 @@ void ApplyDataTransform(const OpKernelType& expected_kernel_key,
                         OpFuncNode* op_func_node,
                         std::vector<OpFuncNode>* op_func_nodes,
                         bool use_local_scope = true,
-                        bool static_build = false);
+                        bool static_build = false,
+                        bool cache_persistable = false);
 
 void HandleComplexGradToRealGrad(const OpFuncNode& op_func_node,
                                  const phi::Place& place,
@@ -131,6 +147,21 @@ std::shared_ptr<OperatorBase> TransferDevice(const std::string& var_name,
                                              VariableScope* var_scope,
                                              framework::Scope* local_scope);
 
+// Creates the fused_data_transfer op that copies var_name to dst_place and
+// transforms its layout and dtype at once. The new var is left out of the
+// DataTransferAddedVars when it is cached, so that it is neither freed after
+// the build nor collected by the gc.
+std::shared_ptr<OperatorBase> TransferFused(const std::string& var_name,
+                                            std::string* new_var_name,
+                                            DataLayout in_layout,
+                                            DataLayout out_layout,
+                                            proto::VarType::Type in_dtype,
+                                            proto::VarType::Type out_dtype,
+                                            const phi::Place& dst_place,
+                                            VariableScope* var_scope,
+                                            framework::Scope* local_scope,
+                                            bool cached);
+
 }  // namespace interpreter
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/new_executor/interpreter/dependency_builder.h"
 
+#include <algorithm>
 #include <queue>
 #include <sstream>
 #include <stack>
@@ -142,6 +143,16 @@ void DependencyBuilder::ShareDependencyFrom(const DependencyBuilder& src) {
   is_build_ = true;
 }
 
+void DependencyBuilder::LoadDependency(
+    std::map<size_t, std::set<size_t>> op_downstream_map,
+    std::vector<std::vector<bool>> op_happens_before) {
+  op_downstream_map_ = std::make_shared<std::map<size_t, std::set<size_t>>>(
+      std::move(op_downstream_map));
+  op_happens_before_ = std::make_shared<std::vector<std::vector<bool>>>(
+      std::move(op_happens_before));
+  is_build_ = true;
+}
+
 const std::string& DependencyBuilder::GetInstructionName(size_t op_idx) const {
   return (*instructions_)[op_idx].OpBase()->Type();
 }
@@ -156,6 +167,42 @@ const std::map<size_t, std::set<size_t>>& DependencyBuilder::OpDownstreamMap()
   return *op_downstream_map_;
 }
 
+std::vector<size_t> DependencyBuilder::CriticalPathLength(
+    size_t op_num) const {
+  const std::map<size_t, std::set<size_t>>& downstream_map = OpDownstreamMap();
+
+  // visit ops in reverse topological order, an op is visited after all of its
+  // downstream ops have been visited
+  std::vector<std::vector<size_t>> upstream_ops(op_num);
+  std::vector<size_t> unvisited_downstream_num(op_num, 0);
+  for (auto const& pair : downstream_map) {
+    for (size_t next_op : pair.second) {
+      upstream_ops[next_op].push_back(pair.first);
+    }
+    unvisited_downstream_num[pair.first] = pair.second.size();
+  }
+
+  std::vector<size_t> path_length(op_num, 1);
+  std::queue<size_t> visit_queue;
+  for (size_t op_idx = 0; op_idx < op_num; ++op_idx) {
+    if (unvisited_downstream_num[op_idx] == 0) {
+      visit_queue.push(op_idx);
+    }
+  }
+  while (!visit_queue.empty()) {
+    size_t cur_op = visit_queue.front();
+    visit_queue.pop();
+    for (size_t prev_op : upstream_ops[cur_op]) {
+      path_length[prev_op] =
+          std::max(path_length[prev_op], path_length[cur_op] + 1);
+      if (--unvisited_downstream_num[prev_op] == 0) {
+        visit_queue.push(prev_op);
+      }
+    }
+  }
+  return path_length;
+}
+
 void DependencyBuilder::AddDependencyForCoalesceTensorOp() {
   for (size_t op_idx = 0; op_idx < op_num_; ++op_idx) {
     if (instructions_->at(op_idx).OpBaseValid() &&
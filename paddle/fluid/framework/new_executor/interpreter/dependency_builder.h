@@ -48,6 +48,11 @@ class DependencyBuilder {
 
   const std::map<size_t, std::set<size_t>>& OpDownstreamMap() const;
 
+  // return the length of the longest dependency chain starting from each op
+  // (the op itself included), which is used as critical-path priority when
+  // scheduling ready ops
+  std::vector<size_t> CriticalPathLength(size_t op_num) const;
+
   bool OpHappensBefore(size_t prior_op_idx, size_t posterior_op_idx) const {
     PADDLE_ENFORCE_GE(
         op_happens_before_->size(),
@@ -58,6 +63,11 @@ class DependencyBuilder {
 
   void ShareDependencyFrom(const DependencyBuilder& src);
 
+  // load the dependency built by another process, e.g., from the execution
+  // plan cache, the builder is regarded as built after loading
+  void LoadDependency(std::map<size_t, std::set<size_t>> op_downstream_map,
+                      std::vector<std::vector<bool>> op_happens_before);
+
   bool IsSameDeviceContext(size_t op1, size_t op2) const {
     return &((*instructions_)[op1].DeviceContext()) ==
            &((*instructions_)[op2].DeviceContext());
@@ -0,0 +1,252 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/execution_plan_cache.h"
+
+#include <xxhash.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "glog/logging.h"
+#include "paddle/phi/common/port.h"
+#include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/operation.h"
+
+PHI_DEFINE_EXPORTED_string(
+    new_executor_plan_cache_dir,
+    "",
+    "The directory to save and load the execution plan of PirInterpreter, "
+    "such as the instruction dependencies and the trace execution order. "
+    "The plan cache is disabled if it is empty.");
+
+COMMON_DECLARE_bool(new_executor_serial_run);
+COMMON_DECLARE_bool(new_executor_sequential_run);
+COMMON_DECLARE_bool(add_dependency_for_communication_op);
+COMMON_DECLARE_bool(new_executor_critical_path_scheduling);
+
+namespace paddle::framework::interpreter {
+
+namespace {
+
+constexpr uint64_t kExecutionPlanMagic = 0x4E414C505845444EULL;
+constexpr uint32_t kExecutionPlanVersion = 1;
+
+template <typename T>
+void WritePod(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadPod(std::istream& is, T* value) {
+  is.read(reinterpret_cast<char*>(value), sizeof(T));
+  return static_cast<bool>(is);
+}
+
+void WriteString(std::ostream& os, const std::string& str) {
+  WritePod<uint64_t>(os, str.size());
+  os.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+bool ReadString(std::istream& is, std::string* str) {
+  uint64_t size = 0;
+  if (!ReadPod(is, &size)) {
+    return false;
+  }
+  str->resize(size);
+  is.read(&(*str)[0], static_cast<std::streamsize>(size));
+  return static_cast<bool>(is);
+}
+
+std::string ExecutionPlanPath(const std::string& key) {
+  return FLAGS_new_executor_plan_cache_dir + "/" + key + ".plan";
+}
+
+}  // namespace
+
+std::string ExecutionPlanCacheKey(const ::pir::Block& block,
+                                  const phi::Place& place) {
+  if (FLAGS_new_executor_plan_cache_dir.empty()) {
+    return "";
+  }
+  std::stringstream ss;
+  for (auto& op : block) {
+    const_cast<::pir::Operation&>(op).Print(ss);
+    ss << "\n";
+  }
+  ss << place << ";" << FLAGS_new_executor_serial_run << ";"
+     << FLAGS_new_executor_sequential_run << ";"
+     << FLAGS_add_dependency_for_communication_op << ";"
+     << FLAGS_new_executor_critical_path_scheduling;
+  std::string program_str = ss.str();
+  return std::to_string(
+      XXH64(program_str.data(), program_str.size(), kExecutionPlanVersion));
+}
+
+bool LoadExecutionPlan(const std::string& key, ExecutionPlanArtifact* plan) {
+  if (key.empty()) {
+    return false;
+  }
+  std::string path = ExecutionPlanPath(key);
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin.is_open()) {
+    VLOG(4) << "No execution plan found in " << path;
+    return false;
+  }
+
+  uint64_t magic = 0;
+  uint32_t version = 0;
+  if (!ReadPod(fin, &magic) || magic != kExecutionPlanMagic ||
+      !ReadPod(fin, &version) || version != kExecutionPlanVersion) {
+    LOG(WARNING) << "Ignore the execution plan " << path
+                 << " with unknown format.";
+    return false;
+  }
+
+  uint64_t instr_num = 0;
+  if (!ReadPod(fin, &instr_num)) {
+    return false;
+  }
+  plan->instruction_names.resize(instr_num);
+  for (auto& name : plan->instruction_names) {
+    if (!ReadString(fin, &name)) {
+      return false;
+    }
+  }
+
+  uint64_t downstream_num = 0;
+  if (!ReadPod(fin, &downstream_num)) {
+    return false;
+  }
+  plan->op_downstream_map.clear();
+  for (uint64_t i = 0; i < downstream_num; ++i) {
+    uint64_t op_idx = 0, next_num = 0;
+    if (!ReadPod(fin, &op_idx) || !ReadPod(fin, &next_num)) {
+      return false;
+    }
+    std::set<size_t>& next_ops = plan->op_downstream_map[op_idx];
+    for (uint64_t j = 0; j < next_num; ++j) {
+      uint64_t next_op = 0;
+      if (!ReadPod(fin, &next_op) || next_op >= instr_num) {
+        return false;
+      }
+      next_ops.insert(next_op);
+    }
+  }
+
+  // op_happens_before_ is stored as a bit matrix, row by row
+  plan->op_happens_before.assign(instr_num, std::vector<bool>(instr_num));
+  for (auto& row : plan->op_happens_before) {
+    for (uint64_t j = 0; j < instr_num; j += 8) {
+      uint8_t bits = 0;
+      if (!ReadPod(fin, &bits)) {
+        return false;
+      }
+      for (uint64_t k = 0; k < 8 && j + k < instr_num; ++k) {
+        row[j + k] = (bits >> k) & 1;
+      }
+    }
+  }
+
+  uint64_t order_num = 0;
+  if (!ReadPod(fin, &order_num) || order_num != instr_num) {
+    return false;
+  }
+  plan->trace_execute_order.resize(order_num);
+  for (auto& instr_id : plan->trace_execute_order) {
+    uint64_t id = 0;
+    if (!ReadPod(fin, &id) || id >= instr_num) {
+      return false;
+    }
+    instr_id = id;
+  }
+
+  VLOG(1) << "Load execution plan of " << instr_num << " instructions from "
+          << path;
+  return true;
+}
+
+void SaveExecutionPlan(const std::string& key,
+                       const ExecutionPlanArtifact& plan) {
+  if (key.empty()) {
+    return;
+  }
+  MkDirRecursively(FLAGS_new_executor_plan_cache_dir.c_str());
+  std::string path = ExecutionPlanPath(key);
+  // the temporary file name is unique among the processes writing the same
+  // plan, the last renamed one wins
+  std::string tmp_path =
+      path + ".tmp." +
+      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+      "." +
+      std::to_string(
+          std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream fout(tmp_path, std::ios::binary);
+    if (!fout.is_open()) {
+      LOG(WARNING) << "Cannot open " << tmp_path
+                   << " to save the execution plan.";
+      return;
+    }
+
+    const uint64_t instr_num = plan.instruction_names.size();
+    WritePod(fout, kExecutionPlanMagic);
+    WritePod(fout, kExecutionPlanVersion);
+    WritePod(fout, instr_num);
+    for (auto& name : plan.instruction_names) {
+      WriteString(fout, name);
+    }
+
+    WritePod<uint64_t>(fout, plan.op_downstream_map.size());
+    for (auto const& pair : plan.op_downstream_map) {
+      WritePod<uint64_t>(fout, pair.first);
+      WritePod<uint64_t>(fout, pair.second.size());
+      for (size_t next_op : pair.second) {
+        WritePod<uint64_t>(fout, next_op);
+      }
+    }
+
+    for (auto& row : plan.op_happens_before) {
+      for (uint64_t j = 0; j < instr_num; j += 8) {
+        uint8_t bits = 0;
+        for (uint64_t k = 0; k < 8 && j + k < instr_num; ++k) {
+          bits |= static_cast<uint8_t>(row[j + k]) << k;
+        }
+        WritePod(fout, bits);
+      }
+    }
+
+    WritePod<uint64_t>(fout, plan.trace_execute_order.size());
+    for (size_t instr_id : plan.trace_execute_order) {
+      WritePod<uint64_t>(fout, instr_id);
+    }
+    if (!fout) {
+      LOG(WARNING) << "Failed to write the execution plan to " << tmp_path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to rename " << tmp_path << " to " << path;
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  VLOG(1) << "Save execution plan of " << plan.instruction_names.size()
+          << " instructions to " << path;
+}
+
+}  // namespace paddle::framework::interpreter
@@ -0,0 +1,65 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/phi/common/place.h"
+
+COMMON_DECLARE_string(new_executor_plan_cache_dir);
+
+namespace pir {
+class Block;
+}  // namespace pir
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// ExecutionPlanArtifact holds the results of the instruction analysis of
+// PirInterpreter that only depend on the program, the place and the flag set,
+// so that it can be saved on disk and reloaded by other processes running the
+// same program to skip the dependency analysis.
+struct ExecutionPlanArtifact {
+  // instruction names, used to check that the artifact matches the
+  // instruction list built from the program
+  std::vector<std::string> instruction_names;
+  std::map<size_t, std::set<size_t>> op_downstream_map;
+  std::vector<std::vector<bool>> op_happens_before;
+  std::vector<size_t> trace_execute_order;
+};
+
+// Returns the key of the execution plan of the block, which is the hash of the
+// printed block combined with the place and the flags that affect the
+// analysis. Returns an empty string if the plan cache is disabled.
+std::string ExecutionPlanCacheKey(const ::pir::Block& block,
+                                  const phi::Place& place);
+
+// Load the execution plan saved with the key, returns false if the plan does
+// not exist or is broken.
+bool LoadExecutionPlan(const std::string& key, ExecutionPlanArtifact* plan);
+
+// Save the execution plan with the key, the file is written atomically so that
+// concurrent processes never read a partial plan.
+void SaveExecutionPlan(const std::string& key,
+                       const ExecutionPlanArtifact& plan);
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
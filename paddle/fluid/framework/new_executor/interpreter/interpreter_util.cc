@@ -27,6 +27,7 @@
 #include "paddle/fluid/framework/new_executor/interpreter/execution_config.h"
 #include "paddle/fluid/framework/new_executor/interpreter/static_build.h"
 #include "paddle/fluid/framework/new_executor/pir_adaptor/pir_adaptor_util.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 #include "paddle/fluid/memory/stats.h"
 #include "paddle/fluid/operators/controlflow/conditional_block_op_helper.h"
 #include "paddle/fluid/operators/controlflow/pylayer_op_helper.h"
@@ -49,6 +50,8 @@
 #endif
 
 COMMON_DECLARE_bool(use_mkldnn);
+COMMON_DECLARE_bool(new_executor_critical_path_scheduling);
+COMMON_DECLARE_bool(new_executor_numa_aware);
 COMMON_DECLARE_bool(check_nan_inf);
 COMMON_DECLARE_string(static_runtime_data_save_path);
 COMMON_DECLARE_bool(save_static_runtime_data);
@@ -108,6 +111,13 @@ const std::vector<WorkQueueOptions> ConstructWorkQueueOptions(
                              /*track_task*/ false,
                              /*detached*/ true,
                              /*events_waiter*/ waiter);
+  // the memory of cpu tensors is usually first touched by the thread creating
+  // the executor, so its NUMA node is regarded as the one owning the place
+  int numa_node = FLAGS_new_executor_numa_aware ? GetCurrentNumaNode() : -1;
+  for (auto& options : group_options) {
+    options.steal_half = FLAGS_new_executor_critical_path_scheduling;
+    options.numa_node = numa_node;
+  }
   return group_options;
 }
 
@@ -855,7 +865,8 @@ void BuildOpFuncList(const phi::Place& place,
                            &op_func_node,
                            vec_func_list,
                            use_local_scope,
-                           static_build);
+                           static_build,
+                           execution_config.used_for_inference);
         VLOG(4) << "apply data transform done. ";
 
         // step 4. infershape
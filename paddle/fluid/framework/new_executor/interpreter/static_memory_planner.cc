@@ -0,0 +1,185 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace paddle::framework::interpreter {
+
+namespace {
+
+size_t AlignedSize(size_t size) {
+  return (size + StaticMemoryPlanner::kAlignment - 1) /
+         StaticMemoryPlanner::kAlignment * StaticMemoryPlanner::kAlignment;
+}
+
+}  // namespace
+
+void StaticMemoryPlanner::AddBuffer(int var_id,
+                                    size_t size,
+                                    size_t first_use,
+                                    size_t last_use) {
+  auto iter = buffers_.find(var_id);
+  if (iter == buffers_.end()) {
+    buffers_.emplace(var_id,
+                     Buffer{size, first_use, std::max(first_use, last_use)});
+    return;
+  }
+  Buffer& buffer = iter->second;
+  buffer.size = std::max(buffer.size, size);
+  buffer.first_use = std::min(buffer.first_use, first_use);
+  buffer.last_use = std::max(buffer.last_use, last_use);
+}
+
+int StaticMemoryPlanner::FindRoot(int var_id) {
+  auto iter = alias_parent_.find(var_id);
+  if (iter == alias_parent_.end()) {
+    return var_id;
+  }
+  int root = var_id;
+  while (alias_parent_.at(root) != root) {
+    root = alias_parent_.at(root);
+  }
+  // path compression
+  while (alias_parent_.at(var_id) != root) {
+    int parent = alias_parent_.at(var_id);
+    alias_parent_[var_id] = root;
+    var_id = parent;
+  }
+  return root;
+}
+
+void StaticMemoryPlanner::AddAlias(int var_id, int alias_var_id) {
+  alias_parent_.emplace(var_id, var_id);
+  alias_parent_.emplace(alias_var_id, alias_var_id);
+  int root = FindRoot(var_id);
+  int alias_root = FindRoot(alias_var_id);
+  if (root != alias_root) {
+    alias_parent_[std::max(root, alias_root)] = std::min(root, alias_root);
+  }
+}
+
+void StaticMemoryPlanner::Exclude(int var_id) { excluded_vars_.insert(var_id); }
+
+void StaticMemoryPlanner::Plan() {
+  offsets_.clear();
+  sizes_.clear();
+  peak_size_ = 0;
+
+  std::unordered_set<int> excluded_roots;
+  for (int var_id : excluded_vars_) {
+    excluded_roots.insert(FindRoot(var_id));
+  }
+
+  // merge the buffers of each alias group, std::map keeps the plan result
+  // deterministic
+  std::map<int, Buffer> groups;
+  std::map<int, std::vector<int>> group_members;
+  for (auto const& pair : buffers_) {
+    int root = FindRoot(pair.first);
+    if (excluded_roots.count(root)) {
+      continue;
+    }
+    group_members[root].push_back(pair.first);
+    auto iter = groups.find(root);
+    if (iter == groups.end()) {
+      groups.emplace(root, pair.second);
+    } else {
+      iter->second.size = std::max(iter->second.size, pair.second.size);
+      iter->second.first_use =
+          std::min(iter->second.first_use, pair.second.first_use);
+      iter->second.last_use =
+          std::max(iter->second.last_use, pair.second.last_use);
+    }
+  }
+
+  std::vector<int> order;
+  order.reserve(groups.size());
+  for (auto const& pair : groups) {
+    order.push_back(pair.first);
+  }
+  std::sort(order.begin(), order.end(), [&groups](int lhs, int rhs) {
+    const Buffer& l = groups.at(lhs);
+    const Buffer& r = groups.at(rhs);
+    if (l.size != r.size) {
+      return l.size > r.size;
+    }
+    if (l.first_use != r.first_use) {
+      return l.first_use < r.first_use;
+    }
+    return lhs < rhs;
+  });
+
+  struct Placement {
+    size_t offset;
+    size_t size;
+    size_t first_use;
+    size_t last_use;
+  };
+  std::vector<Placement> placements;
+  placements.reserve(order.size());
+  std::vector<const Placement*> conflicts;
+  for (int root : order) {
+    const Buffer& buffer = groups.at(root);
+    size_t size = AlignedSize(buffer.size);
+
+    conflicts.clear();
+    for (const Placement& placed : placements) {
+      if (placed.first_use <= buffer.last_use &&
+          buffer.first_use <= placed.last_use) {
+        conflicts.push_back(&placed);
+      }
+    }
+    std::sort(conflicts.begin(),
+              conflicts.end(),
+              [](const Placement* lhs, const Placement* rhs) {
+                return lhs->offset < rhs->offset;
+              });
+
+    // find the lowest gap that is large enough
+    size_t offset = 0;
+    for (const Placement* placed : conflicts) {
+      if (offset + size <= placed->offset) {
+        break;
+      }
+      offset = std::max(offset, placed->offset + placed->size);
+    }
+
+    placements.push_back(
+        Placement{offset, size, buffer.first_use, buffer.last_use});
+    peak_size_ = std::max(peak_size_, offset + size);
+    for (int var_id : group_members.at(root)) {
+      offsets_[var_id] = offset;
+      sizes_[var_id] = size;
+    }
+  }
+  VLOG(4) << "Static memory plan: " << offsets_.size() << " buffers in "
+          << groups.size() << " groups, peak size " << peak_size_;
+}
+
+void StaticMemoryPlanner::Clear() {
+  buffers_.clear();
+  alias_parent_.clear();
+  excluded_vars_.clear();
+  offsets_.clear();
+  sizes_.clear();
+  peak_size_ = 0;
+}
+
+}  // namespace paddle::framework::interpreter
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+namespace interpreter {
+
+// StaticMemoryPlanner assigns every buffer a fixed offset inside one arena, so
+// that buffers whose lifetimes overlap never overlap in memory. The lifetime
+// of a buffer is the closed interval [first_use, last_use] of positions in the
+// execution order. Buffers sharing memory at runtime (e.g., the output of a
+// view op and its input) are planned as one buffer covering all lifetimes.
+class StaticMemoryPlanner {
+ public:
+  static constexpr size_t kAlignment = 256;
+
+  void AddBuffer(int var_id, size_t size, size_t first_use, size_t last_use);
+
+  void AddAlias(int var_id, int alias_var_id);
+
+  // the buffer and all buffers aliased with it are never planned
+  void Exclude(int var_id);
+
+  // assign offsets to all non-excluded buffers, the buffers are placed greedily
+  // from the largest one to the lowest offset that does not conflict
+  void Plan();
+
+  bool IsPlanned(int var_id) const { return offsets_.count(var_id) > 0; }
+
+  size_t Offset(int var_id) const { return offsets_.at(var_id); }
+
+  // the planned size of the buffer, which is the largest size of its alias
+  // group rounded up to kAlignment
+  size_t Size(int var_id) const { return sizes_.at(var_id); }
+
+  // the arena size needed to hold all planned buffers
+  size_t PeakSize() const { return peak_size_; }
+
+  size_t PlannedBufferNum() const { return offsets_.size(); }
+
+  void Clear();
+
+ private:
+  struct Buffer {
+    size_t size;
+    size_t first_use;
+    size_t last_use;
+  };
+
+  int FindRoot(int var_id);
+
+  std::unordered_map<int, Buffer> buffers_;
+  std::unordered_map<int, int> alias_parent_;
+  std::unordered_set<int> excluded_vars_;
+
+  std::unordered_map<int, size_t> offsets_;
+  std::unordered_map<int, size_t> sizes_;
+  size_t peak_size_{0};
+};
+
+}  // namespace interpreter
+}  // namespace framework
+}  // namespace paddle
@@ -14,20 +14,36 @@
 
 #include "paddle/fluid/framework/new_executor/interpreter/stream_analyzer.h"
 
+#include <algorithm>
 #include <future>
+#include <limits>
 #include <unordered_set>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_attribute.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_op.h"
+#include "paddle/fluid/pir/dialect/kernel/ir/kernel_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
 #if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
-#include "paddle/common/flags.h"
 #include "paddle/fluid/platform/collective_helper.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/distributed/nccl_comm_context.h"
 COMMON_DECLARE_bool(dynamic_static_unified_comm);
 #endif
 
+PHI_DEFINE_EXPORTED_int32(
+    pir_interpreter_auto_stream_num,
+    0,
+    "The number of extra GPU streams that PirInterpreter uses to overlap "
+    "independent compute branches. Communication ops are moved to a "
+    "dedicated stream as well. 0 means only the execution_stream attributes "
+    "set in the program are used.");
+
 namespace paddle::framework::interpreter {
 
 using DeviceContext = phi::DeviceContext;
@@ -333,7 +349,18 @@ DownstreamRunType analyse_run_type_for_two_instructions(T* cur_instr,
                                                         T* next_instr,
                                                         const Place& place) {
   // xpu&ipu memcpy kerenl is synchronous.
-  if (phi::is_ipu_place(place) || phi::is_xpu_place(place)) {
+  if (phi::is_ipu_place(place)) {
+    return DownstreamRunType::kDirectRun;
+  }
+
+  // xpu memcpy kernel waits for its stream on the host, so only the
+  // instructions on two different xpu streams need an event.
+  if (phi::is_xpu_place(place)) {
+    if (cur_instr->KernelType() == OpFuncType::kGpuAsync &&
+        (&cur_instr->DeviceContext() != &next_instr->DeviceContext()) &&
+        phi::is_xpu_place(next_instr->DeviceContext().GetPlace())) {
+      return DownstreamRunType::kEventRun;
+    }
     return DownstreamRunType::kDirectRun;
   }
 
@@ -821,6 +848,178 @@ void PirStreamAnalyzer::ConstructEvents(
   }
 }
 
+namespace {
+
+// The estimated cost of waiting an event recorded on another stream, in the
+// same unit as EstimateOpCost.
+constexpr double kCrossStreamEventCost = 4096.0;
+// The fixed cost of launching a kernel.
+constexpr double kKernelLaunchCost = 1024.0;
+
+double EstimateOpCost(const ::pir::Operation& op) {
+  auto TensorNumel = [](::pir::Value value) -> double {
+    if (!value || !value.type() ||
+        !value.type().isa<paddle::dialect::AllocatedDenseTensorType>()) {
+      return 0.0;
+    }
+    const phi::DDim& dims =
+        value.type().dyn_cast<paddle::dialect::AllocatedDenseTensorType>().dims();
+    double numel = 1.0;
+    for (int i = 0; i < dims.size(); ++i) {
+      // dynamic dims are regarded as 1, which underestimates their cost
+      numel *= dims[i] > 0 ? static_cast<double>(dims[i]) : 1.0;
+    }
+    return numel;
+  };
+
+  // NOTE: it is a memory-bound estimate, the kernel time is regarded as
+  // proportional to the number of elements it reads and writes
+  double cost = kKernelLaunchCost;
+  for (size_t i = 0; i < op.num_operands(); ++i) {
+    cost += TensorNumel(op.operand_source(i));
+  }
+  for (size_t i = 0; i < op.num_results(); ++i) {
+    cost += TensorNumel(op.result(i));
+  }
+  return cost;
+}
+
+bool IsGpuKernelOp(const ::pir::Operation& op) {
+  if (!op.isa<paddle::dialect::PhiKernelOp>() ||
+      !op.HasAttribute("kernel_key")) {
+    return false;
+  }
+  phi::KernelKey kernel_key = op.attribute("kernel_key")
+                                  .dyn_cast<paddle::dialect::KernelAttribute>()
+                                  .data();
+  return kernel_key.backend() == phi::Backend::GPU ||
+         kernel_key.backend() == phi::Backend::GPUDNN;
+}
+
+bool HasExplicitExecutionStream(const ::pir::Operation& op) {
+  return op.HasAttribute("execution_stream") &&
+         op.attribute("execution_stream")
+                 .dyn_cast<::pir::StrAttribute>()
+                 .AsString() != kDefaultStream;
+}
+
+}  // namespace
+
+void PirStreamAnalyzer::AssignExecutionStreams(const ::pir::Block& block) {
+  estimated_overlap_ratio_ = 0.0;
+  const int auto_stream_num = FLAGS_pir_interpreter_auto_stream_num;
+  if (auto_stream_num <= 0 || !phi::is_gpu_place(place_)) {
+    return;
+  }
+
+  // stream 0 is the default stream, stream [1, auto_stream_num] are the extra
+  // compute streams and the last one is for communication
+  const int stream_num = auto_stream_num + 2;
+  const int comm_stream = stream_num - 1;
+  auto StreamName = [comm_stream](int stream) -> std::string {
+    if (stream == 0) {
+      return kDefaultStream;
+    }
+    if (stream == comm_stream) {
+      return "auto_comm";
+    }
+    return "auto_compute_" + std::to_string(stream);
+  };
+
+  // list scheduling in program order: each op is placed on the stream where
+  // it is estimated to finish earliest, waiting events across streams costs
+  // kCrossStreamEventCost so that events are only added when they pay off
+  std::unordered_map<const ::pir::Operation*, double> finish_time;
+  std::unordered_map<const ::pir::Operation*, int> op_stream;
+  std::vector<double> stream_free_time(stream_num, 0.0);
+  double serial_time = 0.0;
+  double makespan = 0.0;
+  size_t reassigned_op_num = 0;
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+
+  for (auto& op : block) {
+    std::vector<std::pair<const ::pir::Operation*, double>> preds;
+    for (size_t i = 0; i < op.num_operands(); ++i) {
+      ::pir::Value value = op.operand_source(i);
+      if (!value || !value.defining_op()) {
+        continue;
+      }
+      auto iter = finish_time.find(value.defining_op());
+      if (iter != finish_time.end()) {
+        preds.emplace_back(iter->first, iter->second);
+      }
+    }
+
+    auto ReadyTime = [&](int stream) {
+      double ready = 0.0;
+      for (auto& pred : preds) {
+        int pred_stream = op_stream.count(pred.first) ? op_stream.at(pred.first)
+                                                      : -1;
+        double cost =
+            (pred_stream >= 0 && pred_stream != stream) ? kCrossStreamEventCost
+                                                        : 0.0;
+        ready = std::max(ready, pred.second + cost);
+      }
+      return ready;
+    };
+
+    if (!IsGpuKernelOp(op)) {
+      // host ops are synchronous with the host thread
+      finish_time[&op] = ReadyTime(-1);
+      continue;
+    }
+
+    const double cost = EstimateOpCost(op);
+    serial_time += cost;
+
+    std::string op_name = op.attributes().count("op_name")
+                              ? op.attribute("op_name")
+                                    .dyn_cast<::pir::StrAttribute>()
+                                    .AsString()
+                              : op.name();
+    int stream = 0;
+    if (HasExplicitExecutionStream(op) ||
+        op_name == paddle::dialect::MemcpyD2hOp::name() ||
+        op_name == paddle::dialect::MemcpyH2dOp::name()) {
+      // keep the streams chosen by users and by ParseDeviceContext, and model
+      // them as the default stream for simplicity
+      stream = 0;
+    } else if (IsCommunicationOp(&op)) {
+      stream = comm_stream;
+    } else {
+      double best_finish = std::numeric_limits<double>::max();
+      for (int candidate = 0; candidate < comm_stream; ++candidate) {
+        double start =
+            std::max(stream_free_time[candidate], ReadyTime(candidate));
+        // ties go to the lower stream, which prefers the default stream
+        if (start + cost < best_finish) {
+          best_finish = start + cost;
+          stream = candidate;
+        }
+      }
+    }
+
+    double start = std::max(stream_free_time[stream], ReadyTime(stream));
+    finish_time[&op] = start + cost;
+    op_stream[&op] = stream;
+    stream_free_time[stream] = start + cost;
+    makespan = std::max(makespan, start + cost);
+
+    if (stream != 0) {
+      const_cast<::pir::Operation&>(op).set_attribute(
+          "execution_stream", ::pir::StrAttribute::get(ctx, StreamName(stream)));
+      ++reassigned_op_num;
+    }
+  }
+
+  if (serial_time > 0.0) {
+    estimated_overlap_ratio_ = 1.0 - makespan / serial_time;
+  }
+  VLOG(1) << "PirStreamAnalyzer assigns " << reassigned_op_num
+          << " ops to extra streams, estimated overlap ratio: "
+          << estimated_overlap_ratio_;
+}
+
 void PirStreamAnalyzer::AnalyseAllRunType(
     const std::vector<paddle::framework::InstructionBase*>& instructions,
     const std::map<size_t, std::set<size_t>>& downstream_map,
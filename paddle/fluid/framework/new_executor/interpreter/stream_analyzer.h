@@ -22,6 +22,12 @@
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/device_event.h"
 
+COMMON_DECLARE_int32(pir_interpreter_auto_stream_num);
+
+namespace pir {
+class Block;
+}  // namespace pir
+
 namespace paddle {
 namespace framework {
 namespace interpreter {
@@ -135,6 +141,15 @@ class PirStreamAnalyzer {
 
   ~PirStreamAnalyzer() {}
 
+  // Assign the execution_stream attribute of the GPU kernel ops in the block
+  // without an explicit one, see FLAGS_pir_interpreter_auto_stream_num. It
+  // must be called before the instructions are built.
+  void AssignExecutionStreams(const ::pir::Block& block);
+
+  // the ratio of the estimated kernel time hidden by multi-stream overlap,
+  // that is 1 - makespan / serial_time of the last stream assignment
+  double EstimatedOverlapRatio() const { return estimated_overlap_ratio_; }
+
   void ConstructEvents(
       const std::vector<std::unique_ptr<paddle::framework::InstructionBase>>&
           instructions);
@@ -178,6 +193,7 @@ class PirStreamAnalyzer {
       event_info_;
   std::unordered_map<std::string, std::shared_ptr<EventInter>>*
       program_force_events_to_wait_;  // not owned
+  double estimated_overlap_ratio_{0.0};
 };
 
 }  // namespace interpreter
@@ -38,6 +38,7 @@
 #include "paddle/phi/backends/device_manager.h"
 
 COMMON_DECLARE_bool(new_executor_serial_run);
+COMMON_DECLARE_bool(new_executor_critical_path_scheduling);
 PD_DECLARE_bool(new_executor_static_build);
 PD_DECLARE_bool(new_executor_use_inplace);
 PD_DECLARE_bool(new_executor_use_local_scope);
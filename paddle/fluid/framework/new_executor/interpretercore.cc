@@ -23,6 +23,16 @@ PHI_DEFINE_EXPORTED_bool(
     new_executor_serial_run,
     false,
     "Enable serial execution for standalone executor, used for debug.");
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_critical_path_scheduling,
+    false,
+    "Dispatch ready instructions by the length of their longest downstream "
+    "dependency chain, and let idle workers steal half of a victim queue.");
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_numa_aware,
+    false,
+    "Pin the worker threads of standalone executor to the cpus of the NUMA "
+    "node the executor is created on, and steal within the node first.");
 PHI_DEFINE_EXPORTED_bool(
     new_executor_static_build,
     false,
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/new_executor/pir_interpreter.h"
 
+#include <algorithm>
 #include <chrono>
 #include <unordered_set>
 
@@ -21,11 +22,15 @@
 
 #include "paddle/fluid/framework/details/nan_inf_utils.h"
 #include "paddle/fluid/framework/details/share_tensor_buffer_functor.h"
+#include "paddle/fluid/framework/new_executor/interpreter/execution_plan_cache.h"
 #include "paddle/fluid/framework/new_executor/interpreter/interpreter_util.h"
 #include "paddle/fluid/framework/new_executor/interpreter/static_build.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/memory/allocation/allocation_trace.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
+#include "paddle/fluid/platform/profiler/mem_tracing.h"
 #include "paddle/fluid/platform/profiler/supplement_tracing.h"
 #include "paddle/phi/common/place.h"
 #include "paddle/phi/core/kernel_context.h"
@@ -40,14 +45,18 @@
 #include "paddle/fluid/platform/onednn_helper.h"
 #endif
 
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/platform/cuda_graph_with_memory_pool.h"
 #include "paddle/phi/backends/device_manager.h"
 
 #ifdef PADDLE_WITH_CINN
 #include "paddle/fluid/framework/new_executor/instruction/cinn_jit_instruction.h"
+PD_DECLARE_bool(cinn_jit_cuda_graph);
+PD_DECLARE_int32(cinn_jit_cuda_graph_max_group_size);
 #endif
 
 #include "paddle/fluid/framework/new_executor/instruction/builtin_combine_instruction.h"
+#include "paddle/fluid/framework/new_executor/instruction/instruction_profiler.h"
 #include "paddle/fluid/framework/new_executor/instruction/control_flow/assert_instruction.h"
 #include "paddle/fluid/framework/new_executor/instruction/control_flow/has_elements_instruction.h"
 #include "paddle/fluid/framework/new_executor/instruction/control_flow/if_instruction.h"
@@ -88,6 +97,9 @@ COMMON_DECLARE_bool(dynamic_static_unified_comm);
 COMMON_DECLARE_bool(enable_pir_in_executor);
 COMMON_DECLARE_bool(enable_pir_in_executor_trace_run);
 COMMON_DECLARE_bool(enable_collect_shape);
+COMMON_DECLARE_bool(pir_interpreter_static_memory_plan);
+COMMON_DECLARE_int32(pir_interpreter_cuda_graph_pool_size);
+COMMON_DECLARE_string(pir_instruction_profiler_path);
 COMMON_DECLARE_int32(low_precision_op_list);
 
 #define CREATE_INSTR(instr_name)                                   \
@@ -96,6 +108,26 @@ COMMON_DECLARE_int32(low_precision_op_list);
 
 namespace paddle::framework {
 
+namespace {
+
+// A view of the static memory arena. It keeps the arena alive, so the tensors
+// still holding it remain valid after the arena is replanned.
+class StaticMemoryArenaAllocation : public phi::Allocation {
+ public:
+  StaticMemoryArenaAllocation(std::shared_ptr<phi::Allocation> arena,
+                              size_t offset,
+                              size_t size)
+      : phi::Allocation(static_cast<uint8_t*>(arena->ptr()) + offset,
+                        size,
+                        arena->place()),
+        arena_(std::move(arena)) {}
+
+ private:
+  std::shared_ptr<phi::Allocation> arena_;
+};
+
+}  // namespace
+
 void RecordLowPrecisionOp(const InstructionBase* instr_node) {
   if (FLAGS_low_precision_op_list) {
     std::string op_name = instr_node->Name();
@@ -187,6 +219,12 @@ PirInterpreter::PirInterpreter(const phi::Place& place,
     SchedulingPriority rhs_scheduling_priority =
         vec_instruction_base_[rhs]->GetSchedulingPriority();
     if (lhs_scheduling_priority == rhs_scheduling_priority) {
+      if (!instruction_critical_path_length_.empty() &&
+          instruction_critical_path_length_[lhs] !=
+              instruction_critical_path_length_[rhs]) {
+        return instruction_critical_path_length_[lhs] <
+               instruction_critical_path_length_[rhs];
+      }
       return lhs > rhs;
     }
     return lhs_scheduling_priority > rhs_scheduling_priority;
@@ -278,6 +316,12 @@ PirInterpreter::PirInterpreter(
     SchedulingPriority rhs_scheduling_priority =
         vec_instruction_base_[rhs]->GetSchedulingPriority();
     if (lhs_scheduling_priority == rhs_scheduling_priority) {
+      if (!instruction_critical_path_length_.empty() &&
+          instruction_critical_path_length_[lhs] !=
+              instruction_critical_path_length_[rhs]) {
+        return instruction_critical_path_length_[lhs] <
+               instruction_critical_path_length_[rhs];
+      }
       return lhs > rhs;
     }
     return lhs_scheduling_priority > rhs_scheduling_priority;
@@ -297,6 +341,17 @@ PirInterpreter::~PirInterpreter() {
   async_work_queue_.reset();
   VLOG(4) << "~PirInterpreter(): " << this << " on " << place_;
 
+  // the sub-block interpreters share the records with their parents
+  if (InstructionProfiler::Enabled() && value_exe_info_ &&
+      value_exe_info_->Parent() == nullptr) {
+    auto& profiler = InstructionProfiler::Instance();
+    LOG(INFO) << "Top host-bound instructions (us per sample):\n"
+              << profiler.Report(/*top_n=*/20);
+    if (!FLAGS_pir_instruction_profiler_path.empty()) {
+      profiler.ExportChromeTracing(FLAGS_pir_instruction_profiler_path);
+    }
+  }
+
 #ifdef PADDLE_WITH_DNNL
   // Clear mkl-dnn cache,
   // this is needed to have mkl-dnn unit tests working
@@ -469,6 +524,121 @@ void PirInterpreter::CheckCUDAGraphBeforeRun(
 #endif
 }
 
+bool PirInterpreter::RunByCUDAGraphPool(
+    const std::vector<std::string>& feed_names,
+    const std::vector<phi::DenseTensor>& feed_tensors) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (FLAGS_pir_interpreter_cuda_graph_pool_size <= 0 ||
+      cuda_graph_pool_disabled_ || !phi::is_gpu_place(place_) ||
+      platform::IsCUDAGraphCapturing() || feed_names.empty()) {
+    return false;
+  }
+  bool is_trace_run =
+      FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
+      execution_config_.used_for_inference ||
+      ((execution_config_.used_for_jit || execution_config_.used_for_cinn) &&
+       (sync_op_num_ == 0));
+  if (!is_trace_run) {
+    return false;
+  }
+
+  auto* dev_ctx = phi::DeviceContextPool::Instance().Get(place_);
+  if (cuda_graph_pool_.empty()) {
+    // the capture is on the stream of the default device context, and the
+    // synchronization with host is not allowed while capturing
+    bool capturable = sync_op_num_ == 0;
+    for (auto& instr : vec_instruction_base_) {
+      capturable = capturable && &instr->DeviceContext() == dev_ctx;
+    }
+    if (!capturable) {
+      VLOG(1) << "Disable CUDA Graph pool since the program has sync ops or "
+                 "runs on multiple device contexts.";
+      cuda_graph_pool_disabled_ = true;
+      return false;
+    }
+  }
+
+  std::stringstream ss;
+  for (auto& feed_tensor : feed_tensors) {
+    if (!feed_tensor.initialized() || !feed_tensor.lod().empty()) {
+      return false;
+    }
+    ss << feed_tensor.dims() << ":" << feed_tensor.dtype() << ":"
+       << feed_tensor.place() << ";";
+  }
+  std::string key = ss.str();
+
+  auto iter = cuda_graph_pool_.find(key);
+  if (iter == cuda_graph_pool_.end()) {
+    // run eagerly the first time to warm up the lazy initialization, such as
+    // the allocator and the kernel autotune, which can not be captured
+    if (cuda_graph_pool_.size() >=
+        static_cast<size_t>(FLAGS_pir_interpreter_cuda_graph_pool_size)) {
+      VLOG(4) << "Evict CUDA Graph for feed shapes " << cuda_graph_lru_.back();
+      ReleaseCUDAGraphPoolVars(feed_names);
+      cuda_graph_pool_.erase(cuda_graph_lru_.back());
+      cuda_graph_lru_.pop_back();
+    }
+    cuda_graph_lru_.push_front(key);
+    cuda_graph_pool_[key].lru_iter = cuda_graph_lru_.begin();
+    return false;
+  }
+
+  CUDAGraphPoolEntry& entry = iter->second;
+  cuda_graph_lru_.splice(
+      cuda_graph_lru_.begin(), cuda_graph_lru_, entry.lru_iter);
+
+  if (entry.graph == nullptr) {
+    entry.static_feeds.resize(feed_tensors.size());
+    for (size_t i = 0; i < feed_tensors.size(); ++i) {
+      framework::TensorCopy(
+          feed_tensors[i], place_, *dev_ctx, &entry.static_feeds[i]);
+    }
+  } else {
+    for (size_t i = 0; i < feed_tensors.size(); ++i) {
+      if (feed_tensors[i].Holder() != entry.static_feeds[i].Holder()) {
+        framework::TensorCopy(
+            feed_tensors[i], place_, *dev_ctx, &entry.static_feeds[i]);
+      }
+    }
+  }
+  for (size_t i = 0; i < feed_names.size(); ++i) {
+    auto* feed_tensor =
+        InnerScope()->FindVar(feed_names[i])->GetMutable<phi::DenseTensor>();
+    feed_tensor->ShareDataWith(entry.static_feeds[i]);
+  }
+
+  if (entry.graph == nullptr) {
+    VLOG(4) << "Capture CUDA Graph for feed shapes " << key;
+    platform::BeginCUDAGraphCapture(place_,
+                                    phi::gpuStreamCaptureModeThreadLocal);
+    TraceRunImpl();
+    entry.graph = platform::EndCUDAGraphCapture();
+  }
+  entry.graph->Replay();
+  return true;
+#else
+  return false;
+#endif
+}
+
+void PirInterpreter::ReleaseCUDAGraphPoolVars(
+    const std::vector<std::string>& feed_names) {
+  // the intermediate tensors may be allocated in the memory pool of a graph,
+  // release them before the pool is removed together with the graph
+  std::unordered_set<std::string> skip_var_names(feed_names.begin(),
+                                                 feed_names.end());
+  skip_var_names.insert(parameter_var_names_.begin(),
+                        parameter_var_names_.end());
+  for (Variable* var : value_exe_info_->GetVarList()) {
+    if (var == nullptr || !var->IsType<phi::DenseTensor>() ||
+        skip_var_names.count(value_exe_info_->GetVarName(var))) {
+      continue;
+    }
+    var->GetMutable<phi::DenseTensor>()->clear();
+  }
+}
+
 void PirInterpreter::ClearLoDTensorArrayInLocalScope() {
   auto vars = local_scope_->LocalVars();
   for (auto var : vars) {
@@ -769,6 +939,10 @@ void PirInterpreter::AnalyseExecuteOrderForTrace(
 void PirInterpreter::BuildInstruction() {
   VLOG(6) << "Build Instructions for pir ... ";
   vec_instruction_base_.clear();
+  if (FLAGS_pir_interpreter_auto_stream_num > 0) {
+    // the execution streams are parsed when constructing instructions
+    ir_stream_analyzer_.AssignExecutionStreams(*ir_block_);
+  }
   size_t op_idx = 0;
   for (auto& op : *ir_block_) {
     VLOG(6) << "Build Instruction for op: " << op_idx;
@@ -1051,7 +1225,14 @@ void PirInterpreter::BuildInstructionDependences() {
   for (auto& instr : vec_instruction_base_) {
     instructions_ptr.push_back(instr.get());
   }
+  if (!is_shared_results_build_) {
+    LoadExecutionPlan();
+  }
   auto downstream_map = ir_dependency_builder_.Build(instructions_ptr);
+  if (FLAGS_new_executor_critical_path_scheduling) {
+    instruction_critical_path_length_ =
+        ir_dependency_builder_.CriticalPathLength(instr_num);
+  }
 
   for (size_t instr_id = 0; instr_id < instr_num; ++instr_id) {
     InstructionBase* cur_instr = vec_instruction_base_[instr_id].get();
@@ -1280,6 +1461,57 @@ void PirInterpreter::CheckGC(InstructionBase* instr) {
   instr->ClearEagerGCVars();
 }
 
+void PirInterpreter::BuildCinnLaunchGroups() {
+#if defined(PADDLE_WITH_CINN) && defined(PADDLE_WITH_CUDA)
+  if (!FLAGS_cinn_jit_cuda_graph) {
+    return;
+  }
+  size_t instr_num = vec_instruction_base_.size();
+  std::vector<std::vector<size_t>> upstream_ids(instr_num);
+  for (const auto& [id, next_ids] : ir_dependency_builder_.OpDownstreamMap()) {
+    for (size_t next_id : next_ids) {
+      upstream_ids[next_id].push_back(id);
+    }
+  }
+
+  // A group is a run of consecutive cinn jit instructions, launched all by
+  // its leader. So an instruction joins the group only when it runs after
+  // the last one of the group, waits for no event, and the inputs of it
+  // come from the group or from the instructions before the leader.
+  CinnJitInstruction* leader = nullptr;
+  size_t leader_id = 0;
+  size_t last_id = 0;
+  int group_size = 0;
+  for (size_t instr_id = 0; instr_id < instr_num; ++instr_id) {
+    auto* instr = dynamic_cast<CinnJitInstruction*>(
+        vec_instruction_base_[instr_id].get());
+    bool can_join =
+        instr != nullptr && leader != nullptr && last_id + 1 == instr_id &&
+        group_size < FLAGS_cinn_jit_cuda_graph_max_group_size &&
+        instr->EventsToWait().empty() && leader->CanLaunchWith(*instr) &&
+        ir_dependency_builder_.OpHappensBefore(last_id, instr_id) &&
+        std::all_of(upstream_ids[instr_id].begin(),
+                    upstream_ids[instr_id].end(),
+                    [&](size_t upstream_id) {
+                      return upstream_id >= leader_id ||
+                             ir_dependency_builder_.OpHappensBefore(
+                                 upstream_id, leader_id);
+                    });
+    if (can_join) {
+      VLOG(4) << "Cinn jit instruction " << instr_id
+              << " joins the launch group of " << leader_id;
+      instr->JoinLaunchGroup(leader);
+      last_id = instr_id;
+      ++group_size;
+      continue;
+    }
+    leader = instr;
+    leader_id = last_id = instr_id;
+    group_size = 1;
+  }
+#endif
+}
+
 void PirInterpreter::CalculateLastLiveOps() {
   VLOG(4) << "PirInterpreter(): " << this << " start CalculateLastLiveOps";
   // calculate last_live_ops_
@@ -1451,6 +1683,7 @@ paddle::framework::FetchList PirInterpreter::Run(
 
   FeedInput();
 
+  bool run_by_cuda_graph = false;
   if (!is_build_ || switch_stream) {
     LOG_FIRST_N(INFO, 1) << "New Executor is Running ...";
     VLOG(4) << DebugValueInfo();
@@ -1485,6 +1718,8 @@ paddle::framework::FetchList PirInterpreter::Run(
 
     is_build_ = true;
     is_shared_results_build_ = true;
+  } else if (RunByCUDAGraphPool(feed_names, feed_tensors)) {
+    run_by_cuda_graph = true;
   } else {
     if (FLAGS_enable_pir_in_executor_trace_run || onednn_op_num_ ||
         execution_config_.used_for_inference ||
@@ -1507,7 +1742,17 @@ paddle::framework::FetchList PirInterpreter::Run(
     for (auto& var_name : fetch_var_names_) {
       auto* var = inner_scope->FindVar(var_name);
       VLOG(4) << "fetch " << var_name << "[" << var << "]";
-      fetch_res.push_back(var->Get<phi::DenseTensor>());
+      if (run_by_cuda_graph) {
+        // the fetched tensor is overwritten by the next replay
+        phi::DenseTensor fetch_tensor;
+        framework::TensorCopy(var->Get<phi::DenseTensor>(),
+                              place_,
+                              *phi::DeviceContextPool::Instance().Get(place_),
+                              &fetch_tensor);
+        fetch_res.push_back(fetch_tensor);
+      } else {
+        fetch_res.push_back(var->Get<phi::DenseTensor>());
+      }
     }
   }
 
@@ -1628,6 +1873,10 @@ void PirInterpreter::MultiThreadRunImpl() {
   interpreter::ResetAtomicGuard guard(&deps_, &refs_);
   VLOG(4) << "Multi Thread Run Instruction List";
 
+  // the static memory plan relies on the fixed order of trace mode
+  static_memory_observing_ = false;
+  static_memory_binding_ = false;
+
   async_work_queue_ = GetWorkQueue();
   MultiThreadRunInstructionList(vec_instruction_base_);
   VLOG(4) << "Done MultiThreadRunInstructionList";
@@ -1669,10 +1918,16 @@ void PirInterpreter::TraceRunInstructionList(
     }
   }
 
+  PrepareStaticMemoryPlan();
+
   for (size_t idx = 0; idx < trace_execute_order_.size(); idx++) {
     auto instr_id = trace_execute_order_[idx];
     InstructionBase* instr_node = vec_instruction_base_.at(instr_id).get();
 
+    if (static_memory_binding_) {
+      BindStaticMemory(instr_node);
+    }
+
     VLOG(6) << "Run InstructionBase " << instr_node->Name() << "[" << instr_id
             << "]";
     RunInstructionBase(instr_node);
@@ -1835,8 +2090,30 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
     return deps_[next_id]->CheckAndDecrease();
   };
 
-  for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
-    if (IsReady(next_instr_id)) {
+  if (instruction_critical_path_length_.empty()) {
+    for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
+      if (IsReady(next_instr_id)) {
+        async_work_queue_->AddTask(
+            vec_instruction_base_[next_instr_id]->KernelType(),
+            [this, next_instr_id]() {
+              RunInstructionBaseAsync(next_instr_id);
+            });
+      }
+    }
+  } else {
+    // NOTE: tasks pushed by a worker go to the front of its own LIFO queue, so
+    // the instruction with the longest dependency chain is pushed last to be
+    // picked up first, while thieves take the shorter chains from the back.
+    std::vector<size_t> ready_instr_ids;
+    for (size_t next_instr_id : instr->NextInstrsInDifferenceThread()) {
+      if (IsReady(next_instr_id)) {
+        ready_instr_ids.push_back(next_instr_id);
+      }
+    }
+    std::sort(ready_instr_ids.begin(),
+              ready_instr_ids.end(),
+              ir_instruction_scheduling_priority_less);
+    for (size_t next_instr_id : ready_instr_ids) {
       async_work_queue_->AddTask(
           vec_instruction_base_[next_instr_id]->KernelType(),
           [this, next_instr_id]() { RunInstructionBaseAsync(next_instr_id); });
@@ -1853,12 +2130,18 @@ void PirInterpreter::RunNextInstructions(InstructionBase* instr,
 void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
   platform::RecordEvent instruction_event(
       instr_node->Name(), platform::TracerEventType::Operator, 1);
+  InstructionProfiler::RunScope profiler_scope(instr_node);
+  memory::allocation::AllocationTraceTagGuard trace_tag_guard(
+      instr_node->Name());
 
   auto cur_place = instr_node->DeviceContext().GetPlace();
   SetDeviceId(cur_place);
 
   try {
-    instr_node->WaitEvent(cur_place);
+    {
+      InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kWaitEvent);
+      instr_node->WaitEvent(cur_place);
+    }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
     if (enable_job_schedule_profiler_) {
       std::string op_name = instr_node->Name();
@@ -1913,6 +2196,9 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
       if (FLAGS_check_nan_inf) {
         CheckTensorHasNanOrInf(instr_node, scope_, value_exe_info_.get());
       }
+      if (UNLIKELY(platform::RecordMemEvent::IsEnabled())) {
+        RecordMemTensorNames(instr_node);
+      }
       VLOG(2) << "\ndone: " << __func__ << " OP id:" << instr_node->Id()
               << " name:" << instr_node->Name() << " type:"
               << (instr_node->KernelType() == OpFuncType::kCpuSync
@@ -1923,7 +2209,13 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
               << " runs on " << phi::GetCurrentThreadName() << "\n"
               << "After: " << cur_place << " "
               << instr_node->DebugStringEx(scope_, value_exe_info_.get());
-      CheckGC(instr_node);
+      if (static_memory_observing_) {
+        ObserveStaticMemory(instr_node);
+      }
+      {
+        InstructionProfiler::PhaseGuard phase_guard(InstructionPhase::kGC);
+        CheckGC(instr_node);
+      }
       VLOG(4) << "done CheckGC";
       memory::LogDeviceMemoryStats(cur_place, instr_node->Name());
     }
@@ -1935,7 +2227,11 @@ void PirInterpreter::RunInstructionBase(InstructionBase* instr_node) {
     }
 
     VLOG(5) << "after run kernel";
-    instr_node->RecordEvent(cur_place);
+    {
+      InstructionProfiler::PhaseGuard phase_guard(
+          InstructionPhase::kRecordEvent);
+      instr_node->RecordEvent(cur_place);
+    }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
     if (enable_job_schedule_profiler_) {
       if (instr_node->Id() == last_calculate_instr_id_ &&
@@ -1980,6 +2276,9 @@ void PirInterpreter::PreAnalysis() {
   ConstructEventForJitInput();
   VLOG(4) << "AddEventToWait for JitInputVars";
 
+  BuildCinnLaunchGroups();
+  VLOG(4) << "Done BuildCinnLaunchGroups";
+
   CalculateLastLiveOps();
   VLOG(4) << "Done CalculateLastLiveOps";
 
@@ -1990,9 +2289,12 @@ void PirInterpreter::PreAnalysis() {
     }
   }
 
-  AnalyseExecuteOrderForTrace(ir_dependency_builder_.OpDownstreamMap(),
-                              ir_instruction_scheduling_priority_less);
-  VLOG(4) << "Done AnalyseExecuteOrderForTrace";
+  if (!execution_plan_loaded_) {
+    AnalyseExecuteOrderForTrace(ir_dependency_builder_.OpDownstreamMap(),
+                                ir_instruction_scheduling_priority_less);
+    VLOG(4) << "Done AnalyseExecuteOrderForTrace";
+    SaveExecutionPlan();
+  }
 
   UpdateSyncOpNum();
   VLOG(4) << "Done UpdateSyncOpNum";
@@ -2004,6 +2306,283 @@ void PirInterpreter::PreAnalysis() {
   VLOG(4) << "Done UpdateOneDNNOpNum";
 }
 
+void PirInterpreter::LoadExecutionPlan() {
+  execution_plan_key_ = interpreter::ExecutionPlanCacheKey(*ir_block_, place_);
+  interpreter::ExecutionPlanArtifact plan;
+  if (!interpreter::LoadExecutionPlan(execution_plan_key_, &plan)) {
+    return;
+  }
+  if (plan.instruction_names.size() != vec_instruction_base_.size()) {
+    LOG(WARNING) << "Ignore the execution plan " << execution_plan_key_
+                 << " since the instruction number mismatches.";
+    return;
+  }
+  for (size_t i = 0; i < vec_instruction_base_.size(); ++i) {
+    if (plan.instruction_names[i] != vec_instruction_base_[i]->Name()) {
+      LOG(WARNING) << "Ignore the execution plan " << execution_plan_key_
+                   << " since the instruction " << i << " mismatches.";
+      return;
+    }
+  }
+  ir_dependency_builder_.LoadDependency(std::move(plan.op_downstream_map),
+                                        std::move(plan.op_happens_before));
+  trace_execute_order_ = std::move(plan.trace_execute_order);
+  execution_plan_loaded_ = true;
+}
+
+void PirInterpreter::SaveExecutionPlan() {
+  if (execution_plan_key_.empty()) {
+    return;
+  }
+  interpreter::ExecutionPlanArtifact plan;
+  for (auto& instr : vec_instruction_base_) {
+    plan.instruction_names.push_back(instr->Name());
+  }
+  auto dependency = ir_dependency_builder_.GetDependency();
+  plan.op_downstream_map = *std::get<0>(dependency);
+  plan.op_happens_before = *std::get<1>(dependency);
+  plan.trace_execute_order = trace_execute_order_;
+  interpreter::SaveExecutionPlan(execution_plan_key_, plan);
+}
+
+std::unordered_map<phi::Allocation*, std::pair<size_t, size_t>>
+PirInterpreter::HolderLiveRanges() const {
+  std::unordered_map<phi::Allocation*, std::pair<size_t, size_t>> live_ranges;
+  const std::vector<Variable*>& var_list = value_exe_info_->GetVarList();
+  for (size_t pos = 0; pos < trace_execute_order_.size(); ++pos) {
+    InstructionBase* instr =
+        vec_instruction_base_.at(trace_execute_order_[pos]).get();
+    for (auto* vars : {&instr->Inputs(), &instr->Outputs()}) {
+      for (auto& item : *vars) {
+        for (int var_id : item.second) {
+          Variable* var = var_list[var_id];
+          if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+            continue;
+          }
+          auto& holder = var->Get<phi::DenseTensor>().Holder();
+          if (holder == nullptr) {
+            continue;
+          }
+          auto iter =
+              live_ranges.emplace(holder.get(), std::make_pair(pos, pos)).first;
+          iter->second.first = std::min(iter->second.first, pos);
+          iter->second.second = std::max(iter->second.second, pos);
+        }
+      }
+    }
+  }
+  return live_ranges;
+}
+
+void PirInterpreter::PrepareStaticMemoryPlan() {
+  static_memory_observing_ = false;
+  static_memory_binding_ = false;
+  if (!FLAGS_pir_interpreter_static_memory_plan ||
+      static_memory_plan_disabled_ || vec_instruction_base_.empty()) {
+    return;
+  }
+
+  if (static_memory_outputs_.empty()) {
+    // the arena is reused in the launch order of instructions, which is only
+    // safe when all of them are launched on the same stream
+    const phi::DeviceContext* dev_ctx =
+        &vec_instruction_base_[0]->DeviceContext();
+    for (auto& instr : vec_instruction_base_) {
+      if (&instr->DeviceContext() != dev_ctx) {
+        VLOG(1) << "Disable static memory plan since the instructions run on "
+                   "multiple device contexts.";
+        static_memory_plan_disabled_ = true;
+        return;
+      }
+    }
+
+    std::vector<size_t> trace_position(vec_instruction_base_.size(), 0);
+    for (size_t pos = 0; pos < trace_execute_order_.size(); ++pos) {
+      trace_position[trace_execute_order_[pos]] = pos;
+    }
+
+    const std::vector<Variable*>& var_list = value_exe_info_->GetVarList();
+    static_memory_outputs_.resize(vec_instruction_base_.size());
+    for (size_t instr_id = 0; instr_id < vec_instruction_base_.size();
+         ++instr_id) {
+      InstructionBase* instr = vec_instruction_base_[instr_id].get();
+      std::unordered_set<int> input_vars;
+      for (auto& item : instr->Inputs()) {
+        input_vars.insert(item.second.begin(), item.second.end());
+      }
+      for (auto& item : instr->Outputs()) {
+        for (int var_id : item.second) {
+          // only the intermediate tensors freed by gc in each step are planned,
+          // and the inplace outputs are planned with their inputs
+          auto live_iter = last_live_ops_.find(var_id);
+          if (input_vars.count(var_id) || live_iter == last_live_ops_.end() ||
+              live_iter->second.empty() ||
+              parameter_var_names_.count(
+                  value_exe_info_->GetNameById(var_id)) ||
+              !var_list[var_id]->IsType<phi::DenseTensor>()) {
+            continue;
+          }
+          size_t first_use = trace_position[instr_id];
+          size_t last_use = first_use;
+          for (size_t last_live_op : live_iter->second) {
+            last_use = std::max(last_use, trace_position[last_live_op]);
+          }
+          auto iter = static_memory_lifetime_.find(var_id);
+          if (iter == static_memory_lifetime_.end()) {
+            static_memory_lifetime_.emplace(var_id,
+                                            std::make_pair(first_use, last_use));
+          } else {
+            iter->second.first = std::min(iter->second.first, first_use);
+            iter->second.second = std::max(iter->second.second, last_use);
+          }
+          static_memory_outputs_[instr_id].push_back(var_id);
+        }
+      }
+    }
+  }
+
+  if (static_memory_plan_stale_) {
+    static_memory_planner_.Plan();
+    // always use a new arena, the old one is released once no tensor holds it
+    static_memory_arena_.reset();
+    if (static_memory_planner_.PeakSize() > 0) {
+      static_memory_arena_ =
+          memory::AllocShared(place_, static_memory_planner_.PeakSize());
+      VLOG(1) << "Static memory plan of PirInterpreter " << this << ": "
+              << static_memory_planner_.PlannedBufferNum()
+              << " tensors are placed in an arena of "
+              << static_memory_planner_.PeakSize() << " bytes on " << place_;
+    }
+    static_memory_plan_stale_ = false;
+  }
+  static_memory_observing_ = true;
+  static_memory_binding_ = static_memory_arena_ != nullptr;
+}
+
+void PirInterpreter::BindStaticMemory(InstructionBase* instr) {
+  const std::vector<Variable*>& var_list = value_exe_info_->GetVarList();
+  for (int var_id : static_memory_outputs_[instr->Id()]) {
+    if (!static_memory_planner_.IsPlanned(var_id)) {
+      continue;
+    }
+    auto* tensor = var_list[var_id]->GetMutable<phi::DenseTensor>();
+    // never replace the memory that is still held by the tensor
+    if (tensor->Holder()) {
+      continue;
+    }
+    tensor->ResetHolder(std::make_shared<StaticMemoryArenaAllocation>(
+        static_memory_arena_,
+        static_memory_planner_.Offset(var_id),
+        static_memory_planner_.Size(var_id)));
+  }
+}
+
+void PirInterpreter::RecordMemTensorNames(InstructionBase* instr) {
+  const std::vector<Variable*>& var_list = value_exe_info_->GetVarList();
+  for (auto& item : instr->Outputs()) {
+    for (int var_id : item.second) {
+      if (!var_list[var_id]->IsType<phi::DenseTensor>()) {
+        continue;
+      }
+      const auto& holder = var_list[var_id]->Get<phi::DenseTensor>().Holder();
+      if (holder) {
+        platform::RecordMemTensorName(holder->ptr(),
+                                      value_exe_info_->GetVarName(item.first));
+      }
+    }
+  }
+}
+
+void PirInterpreter::ObserveStaticMemory(InstructionBase* instr) {
+  const std::vector<Variable*>& var_list = value_exe_info_->GetVarList();
+
+  auto Exclude = [this](int var_id) {
+    if (!static_memory_excluded_vars_.insert(var_id).second) {
+      return;
+    }
+    static_memory_planner_.Exclude(var_id);
+    if (static_memory_planner_.IsPlanned(var_id)) {
+      // the planned memory may be held by a tensor out of the plan from now
+      // on, stop placing tensors in the arena until it is replanned
+      static_memory_binding_ = false;
+      static_memory_plan_stale_ = true;
+    }
+  };
+
+  // find the outputs sharing memory with inputs, such as the view ops
+  std::unordered_map<const phi::Allocation*, int> input_holders;
+  for (auto& item : instr->Inputs()) {
+    for (int var_id : item.second) {
+      if (var_list[var_id]->IsType<phi::DenseTensor>()) {
+        const auto& holder =
+            var_list[var_id]->Get<phi::DenseTensor>().Holder();
+        if (holder) {
+          input_holders[holder.get()] = var_id;
+        }
+      }
+    }
+  }
+
+  const uint8_t* arena_begin =
+      static_memory_arena_
+          ? static_cast<const uint8_t*>(static_memory_arena_->ptr())
+          : nullptr;
+  const uint8_t* arena_end =
+      arena_begin ? arena_begin + static_memory_arena_->size() : nullptr;
+
+  for (auto& item : instr->Outputs()) {
+    for (int var_id : item.second) {
+      if (!var_list[var_id]->IsType<phi::DenseTensor>()) {
+        continue;
+      }
+      const auto& holder = var_list[var_id]->Get<phi::DenseTensor>().Holder();
+      if (!holder) {
+        continue;
+      }
+      bool is_planned_var = static_memory_lifetime_.count(var_id) > 0;
+
+      auto input_iter = input_holders.find(holder.get());
+      if (input_iter != input_holders.end() && input_iter->second != var_id) {
+        int input_var_id = input_iter->second;
+        if (is_planned_var && static_memory_lifetime_.count(input_var_id)) {
+          if (static_memory_aliases_.emplace(input_var_id, var_id).second) {
+            static_memory_planner_.AddAlias(input_var_id, var_id);
+            static_memory_plan_stale_ = true;
+          }
+        } else {
+          // the memory is shared with a tensor living out of the plan
+          Exclude(input_var_id);
+          Exclude(var_id);
+        }
+        continue;
+      }
+
+      if (!is_planned_var || static_memory_excluded_vars_.count(var_id)) {
+        continue;
+      }
+      const uint8_t* ptr = static_cast<const uint8_t*>(holder->ptr());
+      if (arena_begin && ptr >= arena_begin && ptr < arena_end) {
+        continue;
+      }
+      if (holder->place() != place_ ||
+          (static_memory_planner_.IsPlanned(var_id) &&
+           holder->size() <= static_memory_planner_.Size(var_id))) {
+        // the kernel does not write into the memory given to it
+        Exclude(var_id);
+        continue;
+      }
+      size_t& size = static_memory_sizes_[var_id];
+      if (holder->size() > size) {
+        size = holder->size();
+        const auto& lifetime = static_memory_lifetime_.at(var_id);
+        static_memory_planner_.AddBuffer(
+            var_id, size, lifetime.first, lifetime.second);
+        static_memory_plan_stale_ = true;
+      }
+    }
+  }
+}
+
 ::pir::Value PirInterpreter::GetValueByName(const std::string& var_name) {
   for (auto kv : value_exe_info_->GetValue2VarName()) {
     if (kv.second == var_name) {
@@ -13,12 +13,15 @@
 // limitations under the License.
 
 #pragma once
+#include <list>
 #include <memory>
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
 #include "paddle/fluid/framework/new_executor/interpreter_base_impl.h"
 #include "paddle/pir/include/core/value.h"
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/fluid/platform/cuda_graph_with_memory_pool.h"
 #include "paddle/phi/kernels/autotune/gpu_timer.h"
 #endif
 
@@ -110,6 +113,12 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   std::string GetNameByValue(::pir::Value value) const;
 
+  // The [first, last] positions in trace_execute_order_ of the instructions
+  // accessing the dense tensors of each holder, empty if the instructions
+  // are not run in the trace order.
+  std::unordered_map<phi::Allocation*, std::pair<size_t, size_t>>
+  HolderLiveRanges() const;
+
   // Only for debug
   Variable* DebugVar(const std::string& name) const override;
 
@@ -133,6 +142,7 @@ class PirInterpreter : public InterpreterBaseImpl {
       std::map<size_t, std::set<size_t>> op_downstream_map,
       InstructionSchedulingPriorityLess compare);
   void ConstructEventForJitInput();
+  void BuildCinnLaunchGroups();
   void CalculateLastLiveOps();
 
   // gc
@@ -141,6 +151,12 @@ class PirInterpreter : public InterpreterBaseImpl {
   // cuda graph
   void CheckCUDAGraphBeforeRun(const std::vector<std::string>& feed_names);
   void PrepareForCUDAGraphCapture();
+  // run the program by replaying the CUDA Graph captured for the shapes of
+  // feed_tensors, return false if it should be run eagerly, see
+  // FLAGS_pir_interpreter_cuda_graph_pool_size
+  bool RunByCUDAGraphPool(const std::vector<std::string>& feed_names,
+                          const std::vector<phi::DenseTensor>& feed_tensors);
+  void ReleaseCUDAGraphPoolVars(const std::vector<std::string>& feed_names);
 
   void Build(const std::vector<std::string>& feed_names,
              std::vector<paddle::framework::OpFuncNode>* op_func_nodes,
@@ -204,6 +220,43 @@ class PirInterpreter : public InterpreterBaseImpl {
   int64_t onednn_op_num_{-1};
   std::vector<size_t> trace_execute_order_;
 
+  // execution plan cache, see FLAGS_new_executor_plan_cache_dir
+  std::string execution_plan_key_;
+  bool execution_plan_loaded_{false};
+
+  // static memory plan, the sizes and the aliases of buffers are observed in
+  // the steps running without the arena, and the plan are rebuilt at the
+  // beginning of a step once it becomes stale
+  interpreter::StaticMemoryPlanner static_memory_planner_;
+  std::shared_ptr<phi::Allocation> static_memory_arena_;
+  // the output vars of each instruction that can be placed in the arena
+  std::vector<std::vector<int>> static_memory_outputs_;
+  // var id -> [first_use, last_use] in trace_execute_order_
+  std::unordered_map<int, std::pair<size_t, size_t>> static_memory_lifetime_;
+  std::unordered_map<int, size_t> static_memory_sizes_;
+  std::set<std::pair<int, int>> static_memory_aliases_;
+  std::unordered_set<int> static_memory_excluded_vars_;
+  bool static_memory_observing_{false};
+  bool static_memory_binding_{false};
+  bool static_memory_plan_stale_{true};
+  bool static_memory_plan_disabled_{false};
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // CUDA Graph pool keyed by the shape signature of the feed tensors, the
+  // graph is nullptr before the signature is seen for the second time
+  struct CUDAGraphPoolEntry {
+    std::unique_ptr<platform::CUDAGraph> graph;
+    // the feed vars share these tensors when capturing, and the feed tensors
+    // are copied into them before each replay
+    std::vector<phi::DenseTensor> static_feeds;
+    std::list<std::string>::iterator lru_iter;
+  };
+  std::unordered_map<std::string, CUDAGraphPoolEntry> cuda_graph_pool_;
+  // the most recently used signature is at the front
+  std::list<std::string> cuda_graph_lru_;
+  bool cuda_graph_pool_disabled_{false};
+#endif
+
   std::vector<PirHookFunc> pir_output_hookfuncs_;
   std::vector<PirHookFunc> pir_input_hookfuncs_;
 
@@ -220,6 +273,21 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   void PreAnalysis();
 
+  void LoadExecutionPlan();
+
+  void SaveExecutionPlan();
+
+  // static memory plan, see FLAGS_pir_interpreter_static_memory_plan
+  void PrepareStaticMemoryPlan();
+
+  void BindStaticMemory(InstructionBase* instr);
+
+  void ObserveStaticMemory(InstructionBase* instr);
+
+  // names the allocations of the outputs for the memory timeline of the
+  // profiler
+  void RecordMemTensorNames(InstructionBase* instr);
+
   void BuildInstruction();
 
   void BuildInstructionDependences();
@@ -257,6 +325,10 @@ class PirInterpreter : public InterpreterBaseImpl {
 
   InstructionSchedulingPriorityLess ir_instruction_scheduling_priority_less;
 
+  // length of the longest dependency chain starting from each instruction,
+  // only built when FLAGS_new_executor_critical_path_scheduling is set
+  std::vector<size_t> instruction_critical_path_length_;
+
   const ::pir::Block* ir_block_{nullptr};
 
   std::unordered_map<::pir::Block*, PirInterpreter*> sub_blocks_;  // Not owned
@@ -17,6 +17,7 @@
 #include "paddle/fluid/framework/new_executor/workqueue/event_count.h"
 #include "paddle/fluid/framework/new_executor/workqueue/run_queue.h"
 #include "paddle/fluid/framework/new_executor/workqueue/thread_environment.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/phi/core/os_info.h"
 
@@ -33,10 +34,14 @@ class ThreadPoolTempl {
                   int num_threads,
                   bool allow_spinning,
                   bool always_spinning,
+                  bool steal_half = false,
+                  const std::vector<int>& thread_cpus = {},
                   Environment env = Environment())
       : env_(env),
         allow_spinning_(allow_spinning),
         always_spinning_(always_spinning),
+        steal_half_(steal_half),
+        thread_cpus_(thread_cpus),
         global_steal_partition_(EncodePartition(0, num_threads)),
         blocked_(0),
         done_(false),
@@ -235,6 +240,11 @@ class ThreadPoolTempl {
   Environment env_;
   const bool allow_spinning_;
   const bool always_spinning_;
+  // Thieves take half of the victim queue instead of a single task, so a
+  // burst of work pushed onto one thread is spread with few steal rounds.
+  const bool steal_half_;
+  // The cpu each worker thread is pinned to, empty if not pinned.
+  const std::vector<int> thread_cpus_;
   std::vector<std::vector<unsigned>> all_coprimes_;
   unsigned global_steal_partition_;
   std::atomic<unsigned> blocked_;
@@ -250,6 +260,11 @@ class ThreadPoolTempl {
     std::string thr_name = name_ + "_thread_" + std::to_string(thread_id);
     VLOG(1) << thr_name << " started ";
     phi::SetCurrentThreadName(thr_name);
+    if (static_cast<size_t>(thread_id) < thread_cpus_.size() &&
+        !PinCurrentThreadToCpu(thread_cpus_[thread_id])) {
+      VLOG(1) << thr_name << " failed to pin to cpu "
+              << thread_cpus_[thread_id];
+    }
     PerThread* pt = GetPerThread();
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
@@ -333,7 +348,8 @@ class ThreadPoolTempl {
 
     for (unsigned i = 0; i < size; i++) {
       assert(start + victim < limit);
-      Task t = thread_data_[start + victim].queue.PopBack();
+      Task t = steal_half_ ? StealHalf(&thread_data_[start + victim].queue)
+                           : thread_data_[start + victim].queue.PopBack();
       if (t.f) {
         return t;
       }
@@ -345,6 +361,35 @@ class ThreadPoolTempl {
     return Task();
   }
 
+  // StealHalf moves the older half of the victim queue to the current thread.
+  // The oldest task is returned to be executed immediately, the others are
+  // pushed onto the front of the thief's own queue keeping their relative
+  // order, so the owner-side LIFO order is preserved after the steal.
+  Task StealHalf(Queue* victim) {
+    std::vector<Task> stolen;
+    if (victim->PopBackHalf(&stolen) == 0) {
+      return Task();
+    }
+    Task t = std::move(stolen.back());
+    stolen.pop_back();
+    PerThread* pt = GetPerThread();
+    if (pt->pool == this && !stolen.empty()) {
+      Queue& q = thread_data_[pt->thread_id].queue;
+      for (auto it = stolen.rbegin(); it != stolen.rend(); ++it) {
+        Task rest = q.PushFront(std::move(*it));
+        if (rest.f) {
+          // Own queue is full, run it inline rather than dropping it.
+          env_.ExecuteTask(rest);
+        }
+      }
+    } else {
+      for (auto& rest : stolen) {
+        env_.ExecuteTask(rest);
+      }
+    }
+    return t;
+  }
+
   // Steals work within threads belonging to the partition.
   Task LocalSteal() {
     PerThread* pt = GetPerThread();
@@ -12,9 +12,11 @@
 // operations on back of the queue can be done by multiple threads concurrently.
 //
 // Algorithm outline:
-// All remote threads operating on the queue back are serialized by a mutex.
-// This ensures that at most two threads access state: owner and one remote
-// thread (Size aside). The algorithm ensures that the occupied region of the
+// Remote threads popping from the queue back are serialized by a mutex, while
+// remote threads pushing to the queue back are lock-free. A remote thread
+// first claims the element next to back_ and then publishes the new back_ by
+// a CAS, and releases the element again if its CAS fails. So back_ only
+// moves over claimed elements and at most one thread owns an element. The algorithm ensures that the occupied region of the
 // underlying array is logically continuous (can wraparound, but no stray
 // occupied elements). Owner operates on one end of this region, remote thread
 // operates on the other end. Synchronization between these threads
@@ -34,6 +36,7 @@
 //   1. Use paddle::memory::SpinLock instead of std::mutex to protect back_.
 //   2. Make front_/back_ aligned to get better performance.
 //   3. Replace Eigen utils with std utils.
+//   4. Make PushBack lock-free, PopBack/PopBackHalf publish back_ by CAS.
 
 #pragma once
 
@@ -106,20 +109,32 @@ class RunQueue {
 
   // PushBack adds w at the end of the queue.
   // If queue is full returns w, otherwise returns default-constructed Work.
+  // Can be called by any thread concurrently, without the mutex.
   Work PushBack(Work w) {
-    std::unique_lock<paddle::memory::SpinLock> lock(mutex_);
-    unsigned back = back_.load(std::memory_order_relaxed);
-    Elem* e = &array_[(back - 1) & kMask];
-    uint8_t s = e->state.load(std::memory_order_relaxed);
-    if (s != kEmpty || !e->state.compare_exchange_strong(
-                           s, kBusy, std::memory_order_acquire)) {
-      return w;
+    for (;;) {
+      unsigned back = back_.load(std::memory_order_acquire);
+      Elem* e = &array_[(back - 1) & kMask];
+      uint8_t s = e->state.load(std::memory_order_relaxed);
+      if (s == kReady) {
+        return w;
+      }
+      if (s != kEmpty || !e->state.compare_exchange_strong(
+                             s, kBusy, std::memory_order_acquire)) {
+        // the element is transiently owned by another thread, retry
+        paddle::memory::CpuRelax();
+        continue;
+      }
+      unsigned new_back = ((back - 1) & kMask2) | (back & ~kMask2);
+      if (!back_.compare_exchange_strong(
+              back, new_back, std::memory_order_acq_rel)) {
+        e->state.store(kEmpty, std::memory_order_release);
+        paddle::memory::CpuRelax();
+        continue;
+      }
+      e->w = std::move(w);
+      e->state.store(kReady, std::memory_order_release);
+      return Work();
     }
-    back = ((back - 1) & kMask2) | (back & ~kMask2);
-    back_.store(back, std::memory_order_relaxed);
-    e->w = std::move(w);
-    e->state.store(kReady, std::memory_order_release);
-    return Work();
   }
 
   // PopBack removes and returns the last elements in the queue.
@@ -129,17 +144,26 @@ class RunQueue {
     }
 
     std::unique_lock<paddle::memory::SpinLock> lock(mutex_);
-    unsigned back = back_.load(std::memory_order_relaxed);
-    Elem* e = &array_[back & kMask];
-    uint8_t s = e->state.load(std::memory_order_relaxed);
-    if (s != kReady || !e->state.compare_exchange_strong(
-                           s, kBusy, std::memory_order_acquire)) {
-      return Work();
+    for (;;) {
+      unsigned back = back_.load(std::memory_order_acquire);
+      Elem* e = &array_[back & kMask];
+      uint8_t s = e->state.load(std::memory_order_relaxed);
+      if (s != kReady || !e->state.compare_exchange_strong(
+                             s, kBusy, std::memory_order_acquire)) {
+        return Work();
+      }
+      // back_ may be moved by a concurrent PushBack, release the element and
+      // retry in that case
+      if (!back_.compare_exchange_strong(back,
+                                         back + 1 + (kSize << 1),
+                                         std::memory_order_acq_rel)) {
+        e->state.store(kReady, std::memory_order_release);
+        continue;
+      }
+      Work w = std::move(e->w);
+      e->state.store(kEmpty, std::memory_order_release);
+      return w;
     }
-    Work w = std::move(e->w);
-    e->state.store(kEmpty, std::memory_order_release);
-    back_.store(back + 1 + (kSize << 1), std::memory_order_relaxed);
-    return w;
   }
 
   // PopBackHalf removes and returns half last elements in the queue.
@@ -150,33 +174,51 @@ class RunQueue {
     }
 
     std::unique_lock<paddle::memory::SpinLock> lock(mutex_);
-    unsigned back = back_.load(std::memory_order_relaxed);
-    unsigned size = Size();
-    unsigned mid = back;
-    if (size > 1) mid = back + (size - 1) / 2;
-    unsigned n = 0;
-    unsigned start = 0;
-    for (; static_cast<int>(mid - back) >= 0; mid--) {
-      Elem* e = &array_[mid & kMask];
-      uint8_t s = e->state.load(std::memory_order_relaxed);
+    for (;;) {
+      unsigned back = back_.load(std::memory_order_acquire);
+      unsigned size = Size();
+      unsigned mid = back;
+      if (size > 1) mid = back + (size - 1) / 2;
+      unsigned n = 0;
+      unsigned start = 0;
+      for (; static_cast<int>(mid - back) >= 0; mid--) {
+        Elem* e = &array_[mid & kMask];
+        // acquire since the elements may be pushed by a lock-free PushBack
+        uint8_t s = e->state.load(std::memory_order_acquire);
+        if (n == 0) {
+          if (s != kReady || !e->state.compare_exchange_strong(
+                                 s, kBusy, std::memory_order_acquire))
+            continue;
+          start = mid;
+        } else {
+          // Note: the owner can not pass the claimed element, but the
+          // elements are still marked kBusy so that a concurrent PushBack
+          // waits for them instead of regarding the queue as full.
+          assert(s == kReady);
+          e->state.store(kBusy, std::memory_order_relaxed);
+        }
+        n++;
+      }
       if (n == 0) {
-        if (s != kReady || !e->state.compare_exchange_strong(
-                               s, kBusy, std::memory_order_acquire))
-          continue;
-        start = mid;
-      } else {
-        // Note: no need to store temporal kBusy, we exclusively own these
-        // elements.
-        assert(s == kReady);
+        return 0;
       }
-      result->push_back(std::move(e->w));
-      e->state.store(kEmpty, std::memory_order_release);
-      n++;
-    }
-    if (n != 0) {
-      back_.store(start + 1 + (kSize << 1), std::memory_order_relaxed);
+      if (!back_.compare_exchange_strong(back,
+                                         start + 1 + (kSize << 1),
+                                         std::memory_order_acq_rel)) {
+        // a concurrent PushBack moved back_, release the elements and retry
+        for (unsigned i = 0; i < n; ++i) {
+          array_[(start - i) & kMask].state.store(kReady,
+                                                  std::memory_order_release);
+        }
+        continue;
+      }
+      for (unsigned i = 0; i < n; ++i) {
+        Elem* e = &array_[(start - i) & kMask];
+        result->push_back(std::move(e->w));
+        e->state.store(kEmpty, std::memory_order_release);
+      }
+      return n;
     }
-    return n;
   }
 
   // Size returns current queue size.
@@ -35,6 +35,21 @@ namespace {
 
 using TaskTracker = TaskTracker<EventsWaiter::EventNotifier>;
 
+std::vector<int> ThreadCpus(
+    const WorkQueueOptions& options,
+    std::vector<std::pair<unsigned, unsigned>>* steal_partitions) {
+  if (options.numa_node < 0) {
+    return {};
+  }
+  std::vector<int> thread_cpus = AssignNumaThreadCpus(
+      options.num_threads, options.numa_node, steal_partitions);
+  if (thread_cpus.empty()) {
+    VLOG(1) << "Unknown NUMA topology, the threads of " << options.name
+            << " are not pinned.";
+  }
+  return thread_cpus;
+}
+
 class WorkQueueImpl : public WorkQueue {
  public:
   explicit WorkQueueImpl(const WorkQueueOptions& options) : WorkQueue(options) {
@@ -47,10 +62,17 @@ class WorkQueueImpl : public WorkQueue {
       destruct_notifier_ =
           options.events_waiter->RegisterEvent(kQueueDestructEvent);
     }
+    std::vector<std::pair<unsigned, unsigned>> steal_partitions;
+    std::vector<int> thread_cpus = ThreadCpus(options_, &steal_partitions);
     queue_ = new NonblockingThreadPool(options_.name,
                                        static_cast<int>(options_.num_threads),
                                        options_.allow_spinning,
-                                       options_.always_spinning);
+                                       options_.always_spinning,
+                                       options_.steal_half,
+                                       thread_cpus);
+    if (!thread_cpus.empty()) {
+      queue_->SetStealPartitions(steal_partitions);
+    }
   }
 
   ~WorkQueueImpl() override {
@@ -139,11 +161,18 @@ WorkQueueGroupImpl::WorkQueueGroupImpl(
       destruct_notifier_ =
           options.events_waiter->RegisterEvent(kQueueDestructEvent);
     }
+    std::vector<std::pair<unsigned, unsigned>> steal_partitions;
+    std::vector<int> thread_cpus = ThreadCpus(options, &steal_partitions);
     queues_[idx] = new (&queues_storage_[idx])
         NonblockingThreadPool(options.name,
                               static_cast<int>(options.num_threads),
                               options.allow_spinning,
-                              options.always_spinning);
+                              options.always_spinning,
+                              options.steal_half,
+                              thread_cpus);
+    if (!thread_cpus.empty()) {
+      queues_[idx]->SetStealPartitions(steal_partitions);
+    }
   }
 }
 
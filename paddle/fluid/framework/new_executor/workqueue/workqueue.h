@@ -93,6 +93,11 @@ struct WorkQueueOptions {
   // Worker threads will never sleep if this flag is set.
   // Better performance vs. higher CPU utilization.
   bool always_spinning{false};
+  // Idle worker threads steal half of a victim's queue instead of one task.
+  bool steal_half{false};
+  // Worker threads are pinned to the cpus of this NUMA node first, and steal
+  // from the threads on the same node before the others. -1 means not pinned.
+  int numa_node{-1};
   // If you need to blocking the calling  thread to wait "queue empty", set
   // track_task = true and set events_waiter. EventsWaiter::WaitEvent will
   // block the calling thread until any of events (including "queue empty")
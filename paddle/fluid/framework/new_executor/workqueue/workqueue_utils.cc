@@ -16,6 +16,13 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace paddle::framework {
 
@@ -55,4 +62,120 @@ void AlignedFree(void* mem_ptr) {
 #endif
 }
 
+std::vector<std::vector<int>> GetNumaNodeCpus() {
+  std::vector<std::vector<int>> node_cpus;
+#ifdef __linux__
+  // the cpulist is like "0-15,32-47"
+  for (int node = 0;; ++node) {
+    std::ifstream fin("/sys/devices/system/node/node" + std::to_string(node) +
+                      "/cpulist");
+    if (!fin.is_open()) {
+      break;
+    }
+    std::vector<int> cpus;
+    std::string range;
+    while (std::getline(fin, range, ',')) {
+      int first = -1;
+      int last = -1;
+      char dash = 0;
+      std::istringstream iss(range);
+      iss >> first;
+      if (iss >> dash >> last) {
+        for (int cpu = first; cpu <= last; ++cpu) {
+          cpus.push_back(cpu);
+        }
+      } else if (first >= 0) {
+        cpus.push_back(first);
+      }
+    }
+    node_cpus.emplace_back(std::move(cpus));
+  }
+#endif
+  return node_cpus;
+}
+
+int GetCurrentNumaNode() {
+#ifdef __linux__
+  int cpu = sched_getcpu();
+  if (cpu < 0) {
+    return -1;
+  }
+  std::vector<std::vector<int>> node_cpus = GetNumaNodeCpus();
+  for (size_t node = 0; node < node_cpus.size(); ++node) {
+    for (int node_cpu : node_cpus[node]) {
+      if (node_cpu == cpu) {
+        return static_cast<int>(node);
+      }
+    }
+  }
+#endif
+  return -1;
+}
+
+bool PinCurrentThreadToCpu(int cpu) {
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) ==
+         0;
+#else
+  return false;
+#endif
+}
+
+std::vector<int> AssignNumaThreadCpus(
+    size_t num_threads,
+    int numa_node,
+    std::vector<std::pair<unsigned, unsigned>>* steal_partitions) {
+  std::vector<std::vector<int>> node_cpus = GetNumaNodeCpus();
+  if (node_cpus.empty() || numa_node < 0 ||
+      numa_node >= static_cast<int>(node_cpus.size()) ||
+      node_cpus[numa_node].empty()) {
+    return {};
+  }
+
+  std::vector<int> nodes;
+  nodes.push_back(numa_node);
+  for (int node = 0; node < static_cast<int>(node_cpus.size()); ++node) {
+    if (node != numa_node && !node_cpus[node].empty()) {
+      nodes.push_back(node);
+    }
+  }
+
+  // the threads more than the cpus are placed on numa_node round-robin
+  std::vector<int> thread_cpus;
+  std::vector<int> thread_nodes;
+  for (size_t i = 0; i < num_threads; ++i) {
+    size_t rank = i;
+    int node = -1;
+    for (int candidate : nodes) {
+      if (rank < node_cpus[candidate].size()) {
+        node = candidate;
+        break;
+      }
+      rank -= node_cpus[candidate].size();
+    }
+    if (node < 0) {
+      node = numa_node;
+      rank = i % node_cpus[numa_node].size();
+    }
+    thread_cpus.push_back(node_cpus[node][rank]);
+    thread_nodes.push_back(node);
+  }
+
+  steal_partitions->assign(num_threads, {0, 0});
+  for (size_t i = 0; i < num_threads; ++i) {
+    size_t start = i;
+    size_t limit = i;
+    while (start > 0 && thread_nodes[start - 1] == thread_nodes[i]) --start;
+    while (limit < num_threads && thread_nodes[limit] == thread_nodes[i]) {
+      ++limit;
+    }
+    (*steal_partitions)[i] = {static_cast<unsigned>(start),
+                              static_cast<unsigned>(limit)};
+  }
+  return thread_cpus;
+}
+
 }  // namespace paddle::framework
@@ -21,6 +21,8 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "paddle/fluid/framework/new_executor/workqueue/events_waiter.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -69,6 +71,24 @@ void* AlignedMalloc(size_t size, size_t alignment);
 
 void AlignedFree(void* memory_ptr);
 
+// Returns the cpus of each NUMA node, empty if the topology is unknown.
+std::vector<std::vector<int>> GetNumaNodeCpus();
+
+// Returns the NUMA node of the calling thread, -1 if it is unknown.
+int GetCurrentNumaNode();
+
+// Pins the calling thread to the cpu, returns false if it is not supported.
+bool PinCurrentThreadToCpu(int cpu);
+
+// Assigns a cpu to each of num_threads threads, the cpus of numa_node are used
+// first and then the other nodes. The threads on the same node are contiguous
+// and their [start, limit) range is returned in steal_partitions. Returns
+// empty if the topology is unknown.
+std::vector<int> AssignNumaThreadCpus(
+    size_t num_threads,
+    int numa_node,
+    std::vector<std::pair<unsigned, unsigned>>* steal_partitions);
+
 template <typename Notifier>
 class TaskTracker {
  public:
@@ -1730,12 +1730,8 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   if (!enable_cache_runtime_context_) {
     RuntimeContext ctx(Inputs(), Outputs(), scope);
     RunImpl(scope, place, &ctx);
-  } else if (run_phi_kernel_ && impl_ != nullptr && !need_prepare_data_ &&
-             !need_prepare_phi_data_) {
-    if (!all_kernels_must_compute_runtime_shape_ && impl_->NeedInferShape()) {
-      this->Info().infer_shape_(impl_->getRuntimeInferShapeContext());
-    }
-    (*phi_kernel_)(impl_->getKernelContext());
+  } else if (HasCachedKernelContext()) {
+    RunCachedKernel();
   } else {
     if (runtime_ctx_.get() == nullptr || pre_scope_ != cur_scope) {
       std::lock_guard<std::mutex> lock(cache_update_mutex_);
@@ -1749,6 +1745,18 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 }
 
+bool OperatorWithKernel::HasCachedKernelContext() const {
+  return run_phi_kernel_ && phi_kernel_ != nullptr && impl_ != nullptr &&
+         !need_prepare_data_ && !need_prepare_phi_data_;
+}
+
+void OperatorWithKernel::RunCachedKernel() const {
+  if (!all_kernels_must_compute_runtime_shape_ && impl_->NeedInferShape()) {
+    this->Info().infer_shape_(impl_->getRuntimeInferShapeContext());
+  }
+  (*phi_kernel_)(impl_->getKernelContext());
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const phi::Place& place,
                                  RuntimeContext* runtime_ctx) const {
@@ -859,6 +859,21 @@ class OperatorWithKernel : public OperatorBase {
 
   void SetDnnFallback(bool dnn_fallback) const { dnn_fallback_ = dnn_fallback; }
 
+  // Caches the RuntimeContext and the phi KernelContext on the first run, as
+  // the attribute kEnableCacheRuntimeContext does.
+  void EnableCacheRuntimeContext() const {
+    enable_cache_runtime_context_ = true;
+  }
+
+  // Whether the phi kernel and its KernelContext are cached by the runs
+  // before, then RunCachedKernel runs the op on the same scope without
+  // selecting the kernel or building the contexts again.
+  bool HasCachedKernelContext() const;
+
+  // Runs the cached phi kernel, the shapes are inferred again only if the
+  // dims of the inputs change.
+  void RunCachedKernel() const;
+
  private:
   void RunImpl(const Scope& scope, const phi::Place& place) const final;
   void RunImpl(const Scope& scope,
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace paddle {
+namespace framework {
+
+// The scanners of the slot format "num v1 ... vnum" used by the
+// SlotRecordInMemoryDataFeed. They work on the [p, end) range of a line, which
+// may point into the read buffer and is not nul terminated, and return the
+// position after the parsed token, or nullptr if there is no valid token.
+
+inline bool IsSlotSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline bool IsSlotDigit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline const char* SkipSlotSpaces(const char* p, const char* end) {
+  while (p < end && IsSlotSpace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+// Skips n tokens, memchr scans for the delimiters with the vector units.
+inline const char* SkipSlotTokens(const char* p, const char* end, uint64_t n) {
+  for (uint64_t i = 0; i < n; ++i) {
+    p = SkipSlotSpaces(p, end);
+    if (p == end) {
+      return nullptr;
+    }
+    const char* space = reinterpret_cast<const char*>(memchr(p, ' ', end - p));
+    p = space == nullptr ? end : space;
+  }
+  return p;
+}
+
+inline const char* ParseSlotUint64(const char* p,
+                                   const char* end,
+                                   uint64_t* value) {
+  p = SkipSlotSpaces(p, end);
+  const char* start = p;
+  uint64_t result = 0;
+  while (p < end && IsSlotDigit(*p)) {
+    result = result * 10 + (*p - '0');
+    ++p;
+  }
+  if (p == start || (p < end && !IsSlotSpace(*p))) {
+    return nullptr;
+  }
+  *value = result;
+  return p;
+}
+
+// The decimals of at most 15 significant digits are exact in a double and
+// divided by an exact power of ten, the others fall back to strtof.
+inline const char* ParseSlotFloat(const char* p,
+                                  const char* end,
+                                  float* value) {
+  static const double kPow10[] = {1e0,
+                                  1e1,
+                                  1e2,
+                                  1e3,
+                                  1e4,
+                                  1e5,
+                                  1e6,
+                                  1e7,
+                                  1e8,
+                                  1e9,
+                                  1e10,
+                                  1e11,
+                                  1e12,
+                                  1e13,
+                                  1e14,
+                                  1e15};
+  p = SkipSlotSpaces(p, end);
+  if (p == end) {
+    return nullptr;
+  }
+  const char* start = p;
+  bool negative = (*p == '-');
+  if (*p == '-' || *p == '+') {
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0, scale = 0;
+  while (p < end && IsSlotDigit(*p)) {
+    mantissa = mantissa * 10 + (*p - '0');
+    ++digits;
+    ++p;
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    while (p < end && IsSlotDigit(*p)) {
+      mantissa = mantissa * 10 + (*p - '0');
+      ++digits;
+      ++scale;
+      ++p;
+    }
+  }
+  if (digits == 0 || digits > 15 || (p < end && !IsSlotSpace(*p))) {
+    // the exponents, inf, nan and the long mantissas
+    char* endptr = nullptr;
+    float result = strtof(start, &endptr);
+    if (endptr == start || endptr > end) {
+      return nullptr;
+    }
+    *value = result;
+    return endptr;
+  }
+  double result = static_cast<double>(mantissa) / kPow10[scale];
+  *value = static_cast<float>(negative ? -result : result);
+  return p;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -445,9 +445,39 @@ void TensorCopySync(const phi::DenseTensor& src,
   dst->set_strides(src.strides());
 }
 
+namespace {
+
+// The field of TensorDesc holding the padding before the data, which is not
+// defined in framework.proto so that it is skipped by the parsers.
+constexpr uint32_t kTensorDescPaddingField = 1000;
+
+// Appends a length delimited field to the serialized desc, making its size
+// at least min_size. Its tag takes 2 bytes, and its length takes 1 byte.
+void PadTensorDesc(size_t min_size, std::string* desc) {
+  constexpr size_t kFieldHeaderSize = 3;
+  size_t padding = min_size > desc->size() ? min_size - desc->size() : 0;
+  if (padding == 0) {
+    return;
+  }
+  constexpr uint32_t tag = (kTensorDescPaddingField << 3) | 2;
+  desc->push_back(static_cast<char>((tag & 0x7F) | 0x80));
+  desc->push_back(static_cast<char>(tag >> 7));
+  desc->push_back(static_cast<char>(padding - kFieldHeaderSize));
+  desc->append(padding - kFieldHeaderSize, '\0');
+}
+
+}  // namespace
+
 void TensorToStream(std::ostream& os,
                     const phi::DenseTensor& tensor,
-                    const phi::DeviceContext& dev_ctx) {
+                    const phi::DeviceContext& dev_ctx,
+                    size_t data_alignment) {
+  PADDLE_ENFORCE_LE(data_alignment,
+                    128,
+                    common::errors::InvalidArgument(
+                        "The data alignment of the serialized tensor should "
+                        "be no more than 128, but received %d.",
+                        data_alignment));
   const auto ensure_contiguous = [](const phi::DenseTensor& tensor) {
     if (tensor.meta().is_contiguous()) {
       return tensor;
@@ -469,9 +499,21 @@ void TensorToStream(std::ostream& os,
     auto* pb_dims = desc.mutable_dims();
     pb_dims->Resize(static_cast<int>(dims.size()), 0);
     std::copy(dims.begin(), dims.end(), pb_dims->begin());
-    int32_t size = desc.ByteSize();
-    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
     auto out = desc.SerializeAsString();
+    std::streamoff pos = data_alignment > 0 ? os.tellp() : std::streamoff(-1);
+    if (pos >= 0) {
+      // the data starts after the size and the desc
+      size_t data_offset = pos + sizeof(int32_t) + out.size();
+      size_t padding =
+          (data_alignment - data_offset % data_alignment) % data_alignment;
+      // the padding field takes 3 bytes at least
+      while (padding > 0 && padding < 3) {
+        padding += data_alignment;
+      }
+      PadTensorDesc(out.size() + padding, &out);
+    }
+    int32_t size = static_cast<int32_t>(out.size());
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
     os.write(out.data(), size);
   }
   {  // the 3rd field, tensor data
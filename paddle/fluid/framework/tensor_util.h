@@ -53,9 +53,13 @@ class PrintOptions {
   PrintOptions() {}
 };
 
+// With data_alignment, the tensor desc is padded by a field unknown to the
+// readers, so that the data starts at a multiple of data_alignment in os and
+// can be used in place once os is mapped, see DeserializeFromMappedFile.
 TEST_API void TensorToStream(std::ostream& os,
                              const phi::DenseTensor& tensor,
-                             const phi::DeviceContext& dev_ctx);
+                             const phi::DeviceContext& dev_ctx,
+                             size_t data_alignment = 0);
 TEST_API void TensorFromStream(std::istream& is,
                                phi::DenseTensor* tensor,
                                const phi::DeviceContext& dev_ctx);
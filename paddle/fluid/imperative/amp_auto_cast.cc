@@ -14,15 +14,22 @@
 
 #include "paddle/fluid/imperative/amp_auto_cast.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/eager/eager_tensor.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 #include "paddle/fluid/imperative/var_helper.h"
 
+PHI_DEFINE_EXPORTED_bool(eager_amp_cast_cache,
+                         true,
+                         "Whether the parameters casted by the auto cast of "
+                         "AMP and not traced for backward are cached.");
+
 namespace paddle::imperative {
 
 class VarBase;
@@ -87,7 +94,7 @@ OpSupportedInfos(const std::string& place,
     }
   }
 
-  auto phi_kernels = phi::KernelFactory::Instance().kernels();
+  const auto& phi_kernels = phi::KernelFactory::Instance().kernels();
   for (auto& kernel_pair : phi_kernels) {
     auto op_type = phi::TransToFluidOpName(kernel_pair.first);
     for (auto& info_pair : kernel_pair.second) {
@@ -242,7 +249,12 @@ void AmpAttrs::SetUsePromote(bool use_promote) { use_promote_ = use_promote; }
 
 AmpLevel AmpAttrs::GetAmpLevel() const { return amp_level_; }
 
-void AmpAttrs::SetAmpLevel(AmpLevel level) { amp_level_ = level; }
+void AmpAttrs::SetAmpLevel(AmpLevel level) {
+  if (level != amp_level_) {
+    AmpCastCache::Instance().Clear();
+  }
+  amp_level_ = level;
+}
 
 std::string AmpAttrs::GetAmpDtype() const {
   if (amp_dtype_ == phi::DataType::FLOAT16) {
@@ -266,6 +278,92 @@ void AmpAttrs::SetAmpDtype(std::string amp_dtype) {
 
 phi::DataType AmpAttrs::GetAmpPhiDtype() const { return amp_dtype_; }
 
+static uint32_t InplaceVersionOf(const paddle::Tensor& tensor) {
+  return static_cast<phi::DenseTensor*>(tensor.impl().get())
+      ->InplaceVersionCounter()
+      .CurrentVersion();
+}
+
+AmpCastCache& AmpCastCache::Instance() {
+  static thread_local AmpCastCache cache;
+  return cache;
+}
+
+bool AmpCastCache::Enabled() const { return FLAGS_eager_amp_cast_cache; }
+
+paddle::Tensor AmpCastCache::Get(const paddle::Tensor& tensor,
+                                 phi::DataType dst_dtype) const {
+  auto iter = casted_tensors_.find(tensor.impl().get());
+  if (iter == casted_tensors_.end()) {
+    return paddle::Tensor();
+  }
+  for (const auto& item : iter->second) {
+    if (item.dtype == dst_dtype && item.tensor.lock() == tensor.impl() &&
+        item.version == InplaceVersionOf(tensor) &&
+        item.casted_version == InplaceVersionOf(item.casted)) {
+      VLOG(6) << "AMP cast of " << tensor.name() << " to " << dst_dtype
+              << " is cached";
+      return item.casted;
+    }
+  }
+  return paddle::Tensor();
+}
+
+void AmpCastCache::Insert(const paddle::Tensor& tensor,
+                          phi::DataType dst_dtype,
+                          const paddle::Tensor& casted) {
+  if (!casted.is_dense_tensor()) {
+    return;
+  }
+  auto& items = casted_tensors_[tensor.impl().get()];
+  // The stale copies of the parameter and dtype are replaced.
+  items.erase(std::remove_if(items.begin(),
+                             items.end(),
+                             [&](const CastedTensor& item) {
+                               return item.dtype == dst_dtype ||
+                                      item.tensor.lock() != tensor.impl();
+                             }),
+              items.end());
+  items.push_back(CastedTensor{tensor.impl(),
+                               InplaceVersionOf(tensor),
+                               dst_dtype,
+                               casted,
+                               InplaceVersionOf(casted)});
+  if (casted_tensors_.size() >= prune_size_) {
+    Prune();
+  }
+}
+
+void AmpCastCache::Prune() {
+  for (auto iter = casted_tensors_.begin(); iter != casted_tensors_.end();) {
+    auto& items = iter->second;
+    items.erase(std::remove_if(items.begin(),
+                               items.end(),
+                               [](const CastedTensor& item) {
+                                 return item.tensor.expired();
+                               }),
+                items.end());
+    iter = items.empty() ? casted_tensors_.erase(iter) : std::next(iter);
+  }
+  prune_size_ = std::max(kMinPruneSize, 2 * casted_tensors_.size());
+}
+
+void AmpCastCache::Clear() {
+  if (!casted_tensors_.empty()) {
+    VLOG(6) << "Clear " << casted_tensors_.size() << " AMP casted tensors";
+    casted_tensors_.clear();
+  }
+  prune_size_ = kMinPruneSize;
+}
+
+size_t AmpCastCache::size() const {
+  size_t size = 0;
+  for (const auto& iter : casted_tensors_) {
+    size += iter.second.size();
+  }
+  return size;
+}
+
 template <typename VarType>
 inline std::string GetDtypeStr(const std::shared_ptr<VarType>& var) {
   return framework::DataTypeToString(GetDataType<VarType>(var));
@@ -17,10 +17,13 @@
 #include <set>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/phi/api/include/tensor.h"
 
 namespace paddle {
 namespace imperative {
@@ -102,6 +105,54 @@ class AmpAttrs {
   static thread_local phi::DataType amp_dtype_;
 };
 
+// AmpCastCache keeps the low precision copies of the parameters made by the
+// auto cast of the ops, so a parameter read by many ops or steps is cast once
+// instead of once per op. The caller only keeps the casts not traced for
+// backward, e.g. of the frozen parameters or under no_grad, because the grad
+// node of a traced cast can't be shared by the backward passes.
+//
+// A copy is dropped once the inplace version of the parameter or of the copy
+// changes, and all of them are dropped when a backward pass starts, before
+// the optimizer updates the parameters, or the AMP level changes. It is one
+// cache per thread, like the AMP attrs.
+class AmpCastCache {
+ public:
+  static AmpCastCache& Instance();
+
+  // FLAGS_eager_amp_cast_cache
+  bool Enabled() const;
+
+  // The casted copy of tensor, or an undefined Tensor if there is none.
+  paddle::Tensor Get(const paddle::Tensor& tensor,
+                     phi::DataType dst_dtype) const;
+  void Insert(const paddle::Tensor& tensor,
+              phi::DataType dst_dtype,
+              const paddle::Tensor& casted);
+  void Clear();
+  size_t size() const;
+
+ private:
+  AmpCastCache() = default;
+
+  struct CastedTensor {
+    std::weak_ptr<phi::TensorBase> tensor;
+    uint32_t version;
+    phi::DataType dtype;
+    paddle::Tensor casted;
+    uint32_t casted_version;
+  };
+
+  // The copies whose parameter is released are removed when the cache grows
+  // to prune_size_.
+  void Prune();
+
+  static constexpr size_t kMinPruneSize = 64;
+
+  std::unordered_map<const phi::TensorBase*, std::vector<CastedTensor>>
+      casted_tensors_;
+  size_t prune_size_{kMinPruneSize};
+};
+
 // NOTE(zhiqiu): AutoCastGuard is used for RAII.
 class AutoCastGuard {
  public:
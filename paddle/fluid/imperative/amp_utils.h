@@ -17,6 +17,7 @@
 
 #if !(defined(PADDLE_NO_PYTHON) && defined(PADDLE_ON_INFERENCE))
 #include "paddle/fluid/eager/api/generated/eager_generated/forwards/dygraph_functions.h"
+#include "paddle/fluid/eager/utils.h"
 #endif
 #include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/eager/type_defs.h"
@@ -242,6 +243,36 @@ static inline paddle::Tensor Cast(const paddle::Tensor& input,
     }
   }
 }
+
+// Only the parameters whose cast is not traced for backward are cached.
+static inline bool IsAmpCastCacheable(const paddle::Tensor& input,
+                                      const bool trace_backward) {
+  if (!AmpCastCache::Instance().Enabled() || !input.is_dense_tensor() ||
+      !input.initialized()) {
+    return false;
+  }
+  auto* meta = egr::EagerUtils::nullable_autograd_meta(input);
+  if (meta == nullptr || !meta->Persistable()) {
+    return false;
+  }
+  return !trace_backward || !egr::Controller::Instance().HasGrad() ||
+         meta->StopGradient();
+}
+
+static inline paddle::Tensor AmpCast(const paddle::Tensor& input,
+                                     const phi::DataType& dst_dtype,
+                                     const bool trace_backward = true) {
+  if (!IsAmpCastCacheable(input, trace_backward)) {
+    return Cast(input, dst_dtype, trace_backward);
+  }
+  auto& cache = AmpCastCache::Instance();
+  auto casted = cache.Get(input, dst_dtype);
+  if (!casted.defined()) {
+    casted = Cast(input, dst_dtype, trace_backward);
+    cache.Insert(input, dst_dtype, casted);
+  }
+  return casted;
+}
 #endif
 
 static inline pir::Value Cast(const pir::Value& input,
@@ -253,6 +284,12 @@ static inline pir::Value Cast(const pir::Value& input,
   return paddle::dialect::cast(input, dst_dtype);
 }
 
+static inline pir::Value AmpCast(const pir::Value& input,
+                                 const phi::DataType& dst_dtype,
+                                 const bool trace_backward = true) {
+  return Cast(input, dst_dtype, trace_backward);
+}
+
 template <class T>
 inline std::vector<T> AmpAutoCasts(const std::string& inputs_name,
                                    const std::vector<T>& inputs,
@@ -265,7 +302,7 @@ inline std::vector<T> AmpAutoCasts(const std::string& inputs_name,
   std::vector<T> inputs_casted;
   for (auto& input : inputs) {
     if (NeedCast(input, dst_dtype)) {
-      inputs_casted.emplace_back(std::move(Cast(input, dst_dtype)));
+      inputs_casted.emplace_back(std::move(AmpCast(input, dst_dtype)));
     } else {
       inputs_casted.emplace_back(input);
     }
@@ -287,6 +324,11 @@ inline T AmpAutoCast(const std::string& input_name,
       input_name != "x") {
     return input;
   }
+  // The scales of fp8 are kept in float32, and the bias is in the output
+  // dtype given by the attribute.
+  if (op_name == "fp8_scaled_gemm" && input_name != "x" && input_name != "y") {
+    return input;
+  }
 
   if (dst_dtype == phi::DataType::FLOAT16) {
     if (op_name == "run_program") {
@@ -308,7 +350,7 @@ inline T AmpAutoCast(const std::string& input_name,
   }
   if (NeedCast(input, dst_dtype)) {
     VLOG(6) << "Input : " << input.impl() << "NeedCast";
-    return Cast(input, dst_dtype, trace_backward);
+    return AmpCast(input, dst_dtype, trace_backward);
   }
   return input;
 }
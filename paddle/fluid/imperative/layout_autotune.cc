@@ -20,6 +20,14 @@
 #include "paddle/fluid/imperative/layout_transformer.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/core/enforce.h"
+#include "paddle/phi/kernels/autotune/cache.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/kernels/autotune/gpu_timer.h"
+#endif
+
+COMMON_DECLARE_bool(layout_autotune_by_cost);
+COMMON_DECLARE_int32(layout_autotune_cost_window);
+
 namespace paddle::imperative {
 
 LayoutAutoTune::LayoutAutoTune() {
@@ -87,6 +95,83 @@ LayoutAutoTune::LayoutAutoTune() {
           << lightly_layout_sensitive_ops_.size();
 }
 
+bool LayoutAutoTune::UseCostModel() const {
+  return FLAGS_layout_autotune_by_cost;
+}
+
+void LayoutAutoTune::StartObserving(const DataLayout& default_layout,
+                                    const DataLayout& candidate_layout) {
+  VLOG(3) << "Observe the cost of the layout "
+          << common::DataLayoutToString(candidate_layout) << " against "
+          << common::DataLayoutToString(default_layout);
+  observing_ = true;
+  observed_default_layout_ = default_layout;
+  candidate_layout_ = candidate_layout;
+  candidate_tensors_.clear();
+  observed_convs_ = 0;
+  conv_saved_us_ = 0.;
+  transpose_us_ = 0.;
+}
+
+void LayoutAutoTune::AddConvTime(float default_us, float candidate_us) {
+  conv_saved_us_ += default_us - candidate_us;
+  if (++observed_convs_ >= FLAGS_layout_autotune_cost_window) {
+    FinishObserving();
+  }
+}
+
+void LayoutAutoTune::FinishObserving() {
+  observing_ = false;
+  candidate_tensors_.clear();
+  VLOG(3) << "In " << observed_convs_ << " conv2d calls, the layout "
+          << common::DataLayoutToString(candidate_layout_) << " saves "
+          << conv_saved_us_ << " us in the convs and costs " << transpose_us_
+          << " us in the transposes";
+  if (conv_saved_us_ > transpose_us_) {
+    SetDesiredLayout(candidate_layout_);
+    SetDefaultLayout(observed_default_layout_);
+  } else {
+    egr::Controller::Instance().DisableLayoutAutoTune();
+  }
+}
+
+bool LayoutAutoTune::FindKernelTime(size_t key, float* us) const {
+  auto& cache = phi::autotune::AutoTuneCache::Instance().Get(
+      phi::autotune::AlgorithmType::kLayoutCost);
+  if (!cache.Find(key)) {
+    return false;
+  }
+  *us = static_cast<float>(cache.Get(key)) / 1000.f;
+  return true;
+}
+
+float LayoutAutoTune::MeasureKernelTime(size_t key,
+                                        const phi::Place& place,
+                                        const std::function<void()>& fn) {
+  float us = 0.f;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (phi::is_gpu_place(place)) {
+    auto stream = static_cast<phi::GPUContext*>(
+                      phi::DeviceContextPool::Instance().Get(place))
+                      ->stream();
+    // The first run may search the algorithms of the kernel.
+    fn();
+    constexpr int kRepeats = 3;
+    phi::GpuTimer timer;
+    timer.Start(stream);
+    for (int i = 0; i < kRepeats; ++i) {
+      fn();
+    }
+    timer.Stop(stream);
+    us = timer.ElapsedTime() * 1000.f / kRepeats;
+  }
+#endif
+  phi::autotune::AutoTuneCache::Instance()
+      .Get(phi::autotune::AlgorithmType::kLayoutCost)
+      .Set(key, static_cast<int64_t>(us * 1000.f));
+  return us;
+}
+
 template <typename VarType>
 paddle::imperative::NameVarMap<VarType> DealHeavilyLayoutSensitive(
     const std::string& op_type,
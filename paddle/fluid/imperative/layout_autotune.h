@@ -15,12 +15,19 @@
 #pragma once
 #include <glog/logging.h>
 
+#include <functional>
 #include <memory>
 #include <unordered_set>
 
 #include "paddle/common/layout.h"
 #include "paddle/fluid/framework/type_defs.h"
 #include "paddle/fluid/imperative/tracer.h"
+#include "paddle/phi/common/place.h"
+
+namespace phi {
+class TensorBase;
+}  // namespace phi
+
 namespace paddle {
 namespace imperative {
 
@@ -55,9 +62,51 @@ class LayoutAutoTune {
 
   void SetDefaultLayout(const DataLayout& layout) { default_layout_ = layout; }
 
+  // The cost based tuning of the eager mode, see FLAGS_layout_autotune_by_cost.
+  // It starts at the first conv2d and observes the ops without transforming
+  // any tensor: it follows which tensors would be in the candidate layout,
+  // and sums the time the convs save in it and the time of the transposes it
+  // needs where those tensors enter and leave the propagating ops. After the
+  // window the candidate becomes the desired layout only if it saves time.
+  bool UseCostModel() const;
+
+  bool IsObserving() const { return observing_; }
+
+  void StartObserving(const DataLayout& default_layout,
+                      const DataLayout& candidate_layout);
+
+  DataLayout CandidateLayout() const { return candidate_layout_; }
+
+  // Whether the tensor would be in the candidate layout. The tensors are
+  // followed by their address, which may be reused by a later tensor, so
+  // this is an estimate.
+  bool IsCandidate(const phi::TensorBase* tensor) const {
+    return candidate_tensors_.count(tensor) != 0;
+  }
+
+  void MarkCandidate(const phi::TensorBase* tensor) {
+    candidate_tensors_.insert(tensor);
+  }
+
+  // Counts a conv2d call with its time in us in both layouts, and picks the
+  // layout at the end of the window.
+  void AddConvTime(float default_us, float candidate_us);
+
+  void AddTransposeTime(float us) { transpose_us_ += us; }
+
+  // The kernel time in us cached in the AutoTuneCache under key.
+  bool FindKernelTime(size_t key, float* us) const;
+
+  // Measures the time in us of fn on the stream of place and caches it.
+  float MeasureKernelTime(size_t key,
+                          const phi::Place& place,
+                          const std::function<void()>& fn);
+
  private:
   LayoutAutoTune();
 
+  void FinishObserving();
+
   std::unordered_set<std::string> layout_agnostic_ops_{};
 
   std::unordered_set<std::string> heavily_layout_sensitive_ops_{"batch_norm"};
@@ -70,6 +119,14 @@ class LayoutAutoTune {
 
   // Default Layout in this model
   DataLayout default_layout_{DataLayout::UNDEFINED};
+
+  bool observing_{false};
+  DataLayout observed_default_layout_{DataLayout::UNDEFINED};
+  DataLayout candidate_layout_{DataLayout::UNDEFINED};
+  std::unordered_set<const phi::TensorBase*> candidate_tensors_;
+  int observed_convs_{0};
+  double conv_saved_us_{0.};
+  double transpose_us_{0.};
 };
 
 // LayoutAutotuneGuard is used for RAII.
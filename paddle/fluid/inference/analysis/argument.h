@@ -252,6 +252,7 @@ struct Argument {
                       TRTExcludeVarNames,
                       std::vector<std::string>);
   DECL_ARGUMENT_FIELD(trt_forbid_dynamic_op, TRTForbidDynamicOp, bool);
+  DECL_ARGUMENT_FIELD(trt_cost_based_partition, TRTCostBasedPartition, bool);
 
   DECL_ARGUMENT_FIELD(tensorrt_disabled_ops,
                       TensorRtDisabledOPs,
@@ -288,6 +289,9 @@ struct Argument {
   DECL_ARGUMENT_FIELD(tensorrt_allow_build_at_runtime,
                       TensorRtAllowBuildAtRuntime,
                       bool);
+  DECL_ARGUMENT_FIELD(tensorrt_background_build,
+                      TensorRtBackgroundBuild,
+                      bool);
   DECL_ARGUMENT_FIELD(tensorrt_use_inspector, TensorRtUseInspector, bool);
   DECL_ARGUMENT_FIELD(tensorrt_inspector_serialize,
                       TensorRtInspectorSerialize,
@@ -182,6 +182,8 @@ void IRPassManager::CreatePasses(Argument *argument,
           new std::vector<std::string>(argument->trt_parameter_run_bfp16()));
       pass->Set("forbid_dynamic_op",
                 new bool(argument->trt_forbid_dynamic_op()));
+      pass->Set("cost_based_partition",
+                new bool(argument->trt_cost_based_partition()));
 
       pass->Set("program",
                 new framework::ProgramDesc *(&argument->main_program()));
@@ -254,6 +256,8 @@ void IRPassManager::CreatePasses(Argument *argument,
                 new std::string(argument->tensorrt_shape_range_info_path()));
       pass->Set("trt_allow_build_at_runtime",
                 new bool(argument->tensorrt_allow_build_at_runtime()));
+      pass->Set("trt_background_build",
+                new bool(argument->tensorrt_background_build()));
       pass->Set(
           "trt_disabled_ops",
           new std::vector<std::string>(argument->tensorrt_disabled_ops()));
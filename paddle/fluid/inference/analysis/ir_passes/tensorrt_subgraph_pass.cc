@@ -28,6 +28,7 @@
 #include "paddle/fluid/framework/op_version_registry.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/analysis/ir_passes/subgraph_util.h"
+#include "paddle/fluid/inference/analysis/ir_passes/trt_subgraph_partitioner.h"
 #include "paddle/fluid/inference/analysis/passes/convert_to_mixed_precision.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
@@ -189,6 +190,15 @@ void analysis::TensorRtSubgraphPass::ApplyImpl(
       Get<int>("min_subgraph_size") /*min subgraph size*/,
       Get<std::vector<std::string>>("trt_exclude_var_names"),
       "tensorrt_engine");
+  if (Has("cost_based_partition") && Get<bool>("cost_based_partition")) {
+    // the precision the engines will be built in, see CreateTensorRTOp
+    auto precision_mode =
+        static_cast<phi::DataType>(Get<int>("trt_precision_mode"));
+    if (model_precision == phi::DataType::FLOAT16) {
+      precision_mode = phi::DataType::FLOAT16;
+    }
+    fuser.SetPartitioner(TrtSubgraphPartitioner(precision_mode));
+  }
   fuser();
 
   std::vector<std::string> graph_param_names =
@@ -533,6 +543,7 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
       Get<std::map<std::string, std::vector<int>>>("optim_shape_tensor");
 
   auto allow_build_at_runtime = Get<bool>("trt_allow_build_at_runtime");
+  auto background_build = Get<bool>("trt_background_build");
   auto with_dynamic_shape = Get<bool>("with_dynamic_shape");
   auto shape_range_info_path = Get<std::string>("trt_shape_range_info_path");
   auto trt_tuned_dynamic_shape = Get<bool>("trt_tuned_dynamic_shape");
@@ -675,6 +686,7 @@ std::string TensorRtSubgraphPass::CreateTensorRTOp(
   op_desc->SetAttr("origin_output_rank", renamed_output_rank);
   op_desc->SetAttr("parameters", parameters);
   op_desc->SetAttr("allow_build_at_runtime", allow_build_at_runtime);
+  op_desc->SetAttr("background_build", background_build);
   op_desc->SetAttr("shape_range_info_path", shape_range_info_path);
   op_desc->SetAttr("with_dynamic_shape", with_dynamic_shape);
   op_desc->SetAttr("enable_low_precision_io", enable_low_precision_io);
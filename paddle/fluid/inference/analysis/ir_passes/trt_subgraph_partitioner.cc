@@ -0,0 +1,262 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/ir_passes/trt_subgraph_partitioner.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/op_desc.h"
+#include "paddle/fluid/framework/var_desc.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+using framework::ir::Node;
+
+namespace {
+
+// A device of about 10 TFLOPS and 500 GB/s in float32.
+constexpr double kFlopsPerUs = 1e7;
+constexpr double kBytesPerUs = 5e5;
+// the dispatch of a native op and its kernel launch, and what is left of it
+// for an op fused into an engine
+constexpr double kNativeOpUs = 8.0;
+constexpr double kTrtOpUs = 1.0;
+// the enqueue of an engine with its shape and input checks, the binding of
+// one of its inputs or outputs, and the launch of a format conversion
+constexpr double kEngineUs = 30.0;
+constexpr double kBindingUs = 1.5;
+constexpr double kReformatUs = 3.0;
+
+const std::unordered_set<std::string> kConvOps = {"conv2d",
+                                                  "depthwise_conv2d",
+                                                  "conv3d",
+                                                  "fused_conv2d_add_act"};
+const std::unordered_set<std::string> kConvTransposeOps = {
+    "conv2d_transpose", "depthwise_conv2d_transpose", "conv3d_transpose"};
+const std::unordered_set<std::string> kMatmulOps = {"matmul", "matmul_v2"};
+const std::unordered_set<std::string> kFcOps = {"mul", "fc"};
+
+bool IsFloat(framework::proto::VarType::Type type) {
+  return type == framework::proto::VarType::FP32 ||
+         type == framework::proto::VarType::FP16 ||
+         type == framework::proto::VarType::BF16 ||
+         type == framework::proto::VarType::FP64;
+}
+
+size_t ElementSize(framework::proto::VarType::Type type) {
+  switch (type) {
+    case framework::proto::VarType::FP16:
+    case framework::proto::VarType::BF16:
+    case framework::proto::VarType::INT16:
+      return 2;
+    case framework::proto::VarType::INT8:
+    case framework::proto::VarType::UINT8:
+    case framework::proto::VarType::BOOL:
+      return 1;
+    case framework::proto::VarType::FP64:
+    case framework::proto::VarType::INT64:
+      return 8;
+    default:
+      return 4;
+  }
+}
+
+bool IsTensorVar(const Node *var) {
+  return var->IsVar() && var->Var() != nullptr &&
+         var->Var()->GetType() == framework::proto::VarType::LOD_TENSOR;
+}
+
+// The unknown dims, the batch ones of most models, are taken as 1.
+double Numel(const Node *var) {
+  double numel = 1;
+  for (auto dim : var->Var()->GetShape()) {
+    numel *= dim > 0 ? static_cast<double>(dim) : 1.0;
+  }
+  return numel;
+}
+
+double Bytes(const Node *var) {
+  return Numel(var) * ElementSize(var->Var()->GetDataType());
+}
+
+const Node *FindVar(const std::vector<Node *> &vars, const std::string &name) {
+  for (auto *var : vars) {
+    if (IsTensorVar(var) && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+std::vector<int64_t> InputShape(const Node *op, const std::string &slot) {
+  auto *desc = op->Op();
+  if (!desc->HasInput(slot) || desc->Input(slot).empty()) return {};
+  auto *var = FindVar(op->inputs, desc->Input(slot)[0]);
+  return var == nullptr ? std::vector<int64_t>{} : var->Var()->GetShape();
+}
+
+double Dim(const std::vector<int64_t> &shape, int index) {
+  if (index < 0) index += static_cast<int>(shape.size());
+  if (index < 0 || index >= static_cast<int>(shape.size())) return 1;
+  return shape[index] > 0 ? static_cast<double>(shape[index]) : 1.0;
+}
+
+double FilterVolume(const std::vector<int64_t> &filter) {
+  double volume = 1;
+  for (size_t i = 1; i < filter.size(); ++i) {
+    volume *= Dim(filter, static_cast<int>(i));
+  }
+  return volume;
+}
+
+// The flops of the ops bound by compute, 0 for the others.
+double Flops(const Node *op) {
+  auto *desc = op->Op();
+  const auto &type = desc->Type();
+  double out_numel = 0;
+  for (auto *var : op->outputs) {
+    if (IsTensorVar(var)) out_numel = std::max(out_numel, Numel(var));
+  }
+  if (kConvOps.count(type)) {
+    // filter: [out_channels, in_channels / groups, kernel dims...]
+    return 2 * out_numel * FilterVolume(InputShape(op, "Filter"));
+  }
+  if (kConvTransposeOps.count(type)) {
+    double in_numel = 1;
+    for (auto dim : InputShape(op, "Input")) {
+      in_numel *= dim > 0 ? static_cast<double>(dim) : 1.0;
+    }
+    return 2 * in_numel * FilterVolume(InputShape(op, "Filter"));
+  }
+  if (kMatmulOps.count(type)) {
+    // trans_x of matmul_v2, transpose_X of matmul
+    const char *trans_attr = type == "matmul" ? "transpose_X" : "trans_x";
+    bool trans_x = desc->HasAttr(trans_attr) &&
+                   PADDLE_GET_CONST(bool, desc->GetAttr(trans_attr));
+    auto x = InputShape(op, "X");
+    return 2 * out_numel * Dim(x, trans_x ? -2 : -1);
+  }
+  if (kFcOps.count(type)) {
+    auto w = InputShape(op, type == "fc" ? "W" : "Y");
+    return 2 * out_numel * Dim(w, 0);
+  }
+  return 0;
+}
+
+double OpBytes(const Node *op) {
+  double bytes = 0;
+  for (auto *var : op->inputs) {
+    if (IsTensorVar(var)) bytes += Bytes(var);
+  }
+  for (auto *var : op->outputs) {
+    if (IsTensorVar(var)) bytes += Bytes(var);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+TrtSubgraphCost TrtSubgraphPartitioner::Estimate(
+    const std::vector<Node *> &subgraph) const {
+  // The speedups of tensorrt over the native float32 kernels: its tactics
+  // alone, and the tensor cores in reduced precision. Its fusions take most
+  // of the memory traffic of the ops bound by memory away.
+  double compute_speedup = 1.3;
+  double byte_ratio = 0.5;
+  if (precision_ == phi::DataType::FLOAT16 ||
+      precision_ == phi::DataType::BFLOAT16) {
+    compute_speedup = 4.0;
+    byte_ratio = 0.25;
+  } else if (precision_ == phi::DataType::INT8) {
+    compute_speedup = 6.0;
+    byte_ratio = 0.125;
+  }
+  bool reformat = precision_ != phi::DataType::FLOAT32;
+
+  TrtSubgraphCost cost;
+  std::unordered_set<const Node *> ops;
+  for (auto *node : subgraph) {
+    if (node->IsOp() && node->Op() != nullptr) ops.insert(node);
+  }
+  cost.num_ops = ops.size();
+
+  std::unordered_set<const Node *> boundaries;
+  for (auto *op : ops) {
+    double flops = Flops(op);
+    double bytes = OpBytes(op);
+    cost.native_us += kNativeOpUs + flops / kFlopsPerUs + bytes / kBytesPerUs;
+    cost.trt_us += kTrtOpUs + flops / (kFlopsPerUs * compute_speedup) +
+                   bytes * byte_ratio / kBytesPerUs;
+
+    for (auto *var : op->inputs) {
+      if (!IsTensorVar(var) || var->Var()->Persistable()) continue;
+      bool produced_inside = false;
+      for (auto *producer : var->inputs) {
+        produced_inside |= ops.count(producer) > 0;
+      }
+      if (!produced_inside) boundaries.insert(var);
+    }
+    for (auto *var : op->outputs) {
+      if (!IsTensorVar(var)) continue;
+      bool used_outside = var->outputs.empty();
+      for (auto *consumer : var->outputs) {
+        used_outside |= ops.count(consumer) == 0;
+      }
+      if (used_outside) boundaries.insert(var);
+    }
+  }
+
+  cost.num_boundaries = boundaries.size();
+  cost.boundary_us = kEngineUs;
+  for (auto *var : boundaries) {
+    cost.boundary_us += kBindingUs;
+    if (reformat && IsFloat(var->Var()->GetDataType())) {
+      cost.boundary_us += kReformatUs + 2 * Bytes(var) / kBytesPerUs;
+    }
+  }
+  cost.keep = cost.native_us - cost.trt_us > cost.boundary_us;
+  return cost;
+}
+
+std::vector<std::vector<Node *>> TrtSubgraphPartitioner::operator()(
+    std::vector<std::vector<Node *>> subgraphs) {
+  costs_.clear();
+  std::vector<std::vector<Node *>> kept;
+  double native_us = 0, partitioned_us = 0;
+  for (size_t i = 0; i < subgraphs.size(); ++i) {
+    auto cost = Estimate(subgraphs[i]);
+    native_us += cost.native_us;
+    partitioned_us +=
+        cost.keep ? cost.trt_us + cost.boundary_us : cost.native_us;
+    LOG(INFO) << "TensorRT subgraph candidate " << i << ": " << cost.num_ops
+              << " ops, " << cost.num_boundaries << " inputs and outputs, "
+              << "native " << cost.native_us << " us, engine " << cost.trt_us
+              << " us + " << cost.boundary_us << " us overhead, "
+              << (cost.keep ? "kept" : "dropped");
+    if (cost.keep) kept.push_back(std::move(subgraphs[i]));
+    costs_.push_back(cost);
+  }
+  LOG(INFO) << "TensorRT cost based partition keeps " << kept.size() << " of "
+            << subgraphs.size() << " subgraphs, estimated " << partitioned_us
+            << " us against " << native_us << " us for their ops natively";
+  return kept;
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
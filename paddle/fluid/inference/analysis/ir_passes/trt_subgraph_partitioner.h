@@ -0,0 +1,66 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "paddle/fluid/framework/ir/node.h"
+#include "paddle/phi/common/data_type.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+// The estimated latencies of a candidate subgraph, in microseconds.
+struct TrtSubgraphCost {
+  size_t num_ops{0};
+  size_t num_boundaries{0};
+  double native_us{0};  // its ops run one by one by paddle
+  double trt_us{0};     // its ops run by an engine
+  // the engine launch, the bindings and the format conversions of its inputs
+  // and outputs
+  double boundary_us{0};
+  bool keep{false};
+};
+
+// Chooses the subgraphs of the tensorrt_subgraph_pass worth an engine: the
+// ones whose estimated saving over the native ops outweighs the overhead of
+// the engine and of its boundaries. The costs come from the shapes of the
+// vars with the unknown dims taken as 1, the flops of the convs and the
+// matmuls, and the bytes moved by the other ops, and only rank the
+// candidates coarsely.
+class TrtSubgraphPartitioner {
+ public:
+  explicit TrtSubgraphPartitioner(phi::DataType precision)
+      : precision_(precision) {}
+
+  std::vector<std::vector<framework::ir::Node *>> operator()(
+      std::vector<std::vector<framework::ir::Node *>> subgraphs);
+
+  // The costs of the candidates of the last call, in their order.
+  const std::vector<TrtSubgraphCost> &costs() const { return costs_; }
+
+  TrtSubgraphCost Estimate(
+      const std::vector<framework::ir::Node *> &subgraph) const;
+
+ private:
+  phi::DataType precision_;
+  std::vector<TrtSubgraphCost> costs_;
+};
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -199,6 +199,34 @@ bool AnalysisConfig::external_stream_enabled() const {
   return use_external_stream_;
 }
 
+void AnalysisConfig::SetStreamPriority(int priority) {
+  PADDLE_ENFORCE_GE(priority,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The stream priority should be non-negative, but "
+                        "received %d.",
+                        priority));
+  stream_priority_ = priority;
+}
+
+void AnalysisConfig::EnablePackedSequence(const std::string &cu_seqlens_name,
+                                          int max_seqlen) {
+  PADDLE_ENFORCE_EQ(cu_seqlens_name.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The name of the cu_seqlens input should not be "
+                        "empty."));
+  PADDLE_ENFORCE_GT(max_seqlen,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The max length of the packed sequences should be "
+                        "positive, but received %d.",
+                        max_seqlen));
+  packed_cu_seqlens_name_ = cu_seqlens_name;
+  packed_max_seqlen_ = max_seqlen;
+  Update();
+}
+
 void AnalysisConfig::DisableGpu() {
   use_gpu_ = false;
 
@@ -475,6 +503,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
                                   // params_file_ fields.
   CP_MEMBER(save_optimized_model_);
   CP_MEMBER(opt_cache_dir_);
+  CP_MEMBER(optim_model_cache_);
   CP_MEMBER(prog_file_);
   CP_MEMBER(params_file_);
 
@@ -482,8 +511,13 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   // GPU related.
   CP_MEMBER(use_gpu_);
   CP_MEMBER(use_cutlass_);
+  CP_MEMBER(weight_only_algo_);
+  CP_MEMBER(weight_only_group_size_);
   CP_MEMBER(use_external_stream_);
   CP_MEMBER(exec_stream_);
+  CP_MEMBER(stream_priority_);
+  CP_MEMBER(packed_cu_seqlens_name_);
+  CP_MEMBER(packed_max_seqlen_);
   CP_MEMBER(use_cudnn_);
   CP_MEMBER(gpu_device_id_);
   CP_MEMBER(memory_pool_init_size_mb_);
@@ -507,6 +541,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(trt_parameters_run_int8_);
   CP_MEMBER(trt_parameters_run_bfp16_);
   CP_MEMBER(trt_forbid_dynamic_op_)
+  CP_MEMBER(trt_cost_based_partition_);
   CP_MEMBER(trt_output_tensor_names_);
   CP_MEMBER(trt_disabled_ops_);
   CP_MEMBER(trt_use_dla_);
@@ -520,6 +555,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(tensorrt_transformer_maskid_);
   CP_MEMBER(trt_tuned_dynamic_shape_);
   CP_MEMBER(trt_allow_build_at_runtime_);
+  CP_MEMBER(trt_background_build_);
   CP_MEMBER(collect_shape_range_info_);
   CP_MEMBER(shape_range_info_path_);
   CP_MEMBER(trt_use_inspector_);
@@ -534,6 +570,9 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(use_mkldnn_);
   CP_MEMBER(mkldnn_enabled_op_types_);
   CP_MEMBER(mkldnn_cache_capacity_);
+  CP_MEMBER(onednn_primitive_cache_capacity_);
+  CP_MEMBER(onednn_warmup_shape_file_);
+  CP_MEMBER(onednn_warmup_max_shapes_);
   // Bfloat16 related.
   CP_MEMBER(use_mkldnn_bfloat16_);
   CP_MEMBER(bfloat16_enabled_op_types_);
@@ -554,6 +593,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
 
   // profile related.
   CP_MEMBER(with_profile_);
+  CP_MEMBER(with_latency_stats_);
 
   // cinn compiler related.
   CP_MEMBER(use_cinn_);
@@ -685,6 +725,40 @@ void AnalysisConfig::SetMkldnnCacheCapacity(int capacity) {
 #endif
 }
 
+void AnalysisConfig::SetOnednnPrimitiveCacheCapacity(int capacity) {
+  PADDLE_ENFORCE_GE(capacity,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The capacity of the oneDNN primitive cache should be "
+                        "non-negative, but received %d.",
+                        capacity));
+#ifdef PADDLE_WITH_DNNL
+  onednn_primitive_cache_capacity_ = capacity;
+#else
+  LOG(ERROR) << "Please compile with MKLDNN first to set the capacity of the "
+                "oneDNN primitive cache";
+  onednn_primitive_cache_capacity_ = 0;
+#endif
+}
+
+void AnalysisConfig::SetOnednnWarmupShapeFile(const std::string &shape_file,
+                                              int max_shapes) {
+  PADDLE_ENFORCE_GT(max_shapes,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The max number of the input shapes of the oneDNN "
+                        "warm-up should be positive, but received %d.",
+                        max_shapes));
+#ifdef PADDLE_WITH_DNNL
+  onednn_warmup_shape_file_ = shape_file;
+  onednn_warmup_max_shapes_ = max_shapes;
+#else
+  LOG(ERROR) << "Please compile with MKLDNN first to enable the oneDNN "
+                "warm-up";
+  onednn_warmup_shape_file_.clear();
+#endif
+}
+
 void AnalysisConfig::EnableMkldnnQuantizer() {
 #ifdef PADDLE_WITH_DNNL
   if (!mkldnn_quantizer_config_)
@@ -795,6 +869,11 @@ void AnalysisConfig::Exp_DisableTensorRTDynamicShapeOPs(
   trt_forbid_dynamic_op_ = trt_forbid_dynamic_op;
 }
 
+void AnalysisConfig::Exp_EnableTensorRTCostBasedPartition(
+    bool trt_cost_based_partition) {
+  trt_cost_based_partition_ = trt_cost_based_partition;
+}
+
 void AnalysisConfig::EnableTensorRTMemoryOptim(bool engine_memory_sharing,
                                                int sharing_identifier) {
   PADDLE_ENFORCE_EQ(
@@ -1108,9 +1187,14 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << save_optimized_model_;
 
   ss << use_gpu_;
+  ss << weight_only_algo_;
+  ss << weight_only_group_size_;
   ss << enable_gpu_mixed_;
   ss << use_external_stream_;
   ss << exec_stream_;
+  ss << stream_priority_;
+  ss << packed_cu_seqlens_name_;
+  ss << packed_max_seqlen_;
   ss << use_fc_padding_;
   ss << gpu_device_id_;
   ss << memory_pool_init_size_mb_;
@@ -1127,6 +1211,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   for (auto &name : trt_parameters_run_bfp16_) ss << name.c_str();
   ss << ";";
   ss << trt_forbid_dynamic_op_;
+  ss << trt_cost_based_partition_;
 
   for (auto &op : trt_disabled_ops_) ss << op.c_str();
   ss << ";";
@@ -1139,9 +1224,13 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << enable_memory_optim_;
   ss << trt_engine_memory_sharing_;
+  ss << trt_background_build_;
 
   ss << use_mkldnn_;
   ss << mkldnn_cache_capacity_;
+  ss << onednn_primitive_cache_capacity_;
+  ss << onednn_warmup_shape_file_;
+  ss << onednn_warmup_max_shapes_;
   for (auto &item : mkldnn_enabled_op_types_) ss << item;
   ss << ";";
 
@@ -1286,6 +1375,8 @@ void AnalysisConfig::EnableProfile() {
   Update();
 }
 
+void AnalysisConfig::EnableLatencyStats(bool x) { with_latency_stats_ = x; }
+
 void AnalysisConfig::DisableGlogInfo() {
   with_glog_info_ = false;
   Update();
@@ -1316,12 +1407,25 @@ std::string AnalysisConfig::Summary() {
   os.InsertRow({"enable_mkldnn", use_mkldnn_ ? "true" : "false"});
   os.InsertRow(
       {"mkldnn_cache_capacity", std::to_string(mkldnn_cache_capacity_)});
+  if (use_mkldnn_) {
+    os.InsertRow({"onednn_primitive_cache_capacity",
+                  std::to_string(onednn_primitive_cache_capacity_)});
+    if (!onednn_warmup_shape_file_.empty()) {
+      os.InsertRow({"onednn_warmup_shape_file", onednn_warmup_shape_file_});
+    }
+  }
   os.InsetDivider();
 
   // gpu info
   os.InsertRow({"use_gpu", use_gpu_ ? "true" : "false"});
   if (use_gpu_) {
     os.InsertRow({"use_cutlass", use_cutlass_ ? "true" : "false"});
+    os.InsertRow({"weight_only_quantization",
+                  weight_only_algo_.empty() ? "false" : weight_only_algo_});
+    if (!weight_only_algo_.empty()) {
+      os.InsertRow({"weight_only_group_size",
+                    std::to_string(weight_only_group_size_)});
+    }
     os.InsertRow({"gpu_device_id", std::to_string(gpu_device_id_)});
     os.InsertRow({"enable_gpu_mixed", std::to_string(enable_gpu_mixed_)});
     os.InsertRow({"mixed_precision_mode",
@@ -1330,6 +1434,11 @@ std::string AnalysisConfig::Summary() {
                   std::to_string(memory_pool_init_size_mb_) + "MB"});
     os.InsertRow(
         {"use_external_stream", use_external_stream_ ? "true" : "false"});
+    os.InsertRow({"stream_priority", std::to_string(stream_priority_)});
+    if (packed_sequence_enabled()) {
+      os.InsertRow({"packed_cu_seqlens_name", packed_cu_seqlens_name_});
+      os.InsertRow({"packed_max_seqlen", std::to_string(packed_max_seqlen_)});
+    }
     os.InsertRow(
         {"thread_local_stream", thread_local_stream_ ? "true" : "false"});
 
@@ -1372,6 +1481,10 @@ std::string AnalysisConfig::Summary() {
       os.InsertRow(
           {"tensorrt_tuned_dynamic_shape",
            trt_tuned_dynamic_shape_ ? shape_range_info_path_ : "false"});
+      if (trt_tuned_dynamic_shape_) {
+        os.InsertRow({"tensorrt_background_build",
+                      trt_background_build_ ? "true" : "false"});
+      }
 
       os.InsertRow(
           {"tensorrt_use_varseqlen", trt_use_varseqlen_ ? "true" : "false"});
@@ -1389,6 +1502,8 @@ std::string AnalysisConfig::Summary() {
       os.InsertRow({"trt_mark_output", trt_mark_output_ ? "true" : "false"});
       os.InsertRow(
           {"trt_forbid_dynamic_op", trt_forbid_dynamic_op_ ? "true" : "false"});
+      os.InsertRow({"trt_cost_based_partition",
+                    trt_cost_based_partition_ ? "true" : "false"});
 #endif
     }
   }
@@ -1458,8 +1573,12 @@ std::string AnalysisConfig::Summary() {
   os.InsertRow({"ir_debug", ir_debug_ ? "true" : "false"});
   os.InsertRow(
       {"use_optimized_model", use_optimized_model_ ? "true" : "false"});
+  os.InsertRow(
+      {"optim_model_cache", optim_model_cache_ ? "true" : "false"});
   os.InsertRow({"memory_optim", enable_memory_optim_ ? "true" : "false"});
   os.InsertRow({"enable_profile", with_profile_ ? "true" : "false"});
+  os.InsertRow(
+      {"enable_latency_stats", with_latency_stats_ ? "true" : "false"});
   os.InsertRow({"enable_log", with_glog_info_ ? "true" : "false"});
   os.InsertRow({"collect_shape_range_info",
                 collect_shape_range_info_ ? shape_range_info_path_ : "false"});
@@ -1505,6 +1624,14 @@ bool AnalysisConfig::trt_allow_build_at_runtime() const {
   return trt_allow_build_at_runtime_;
 }
 
+void AnalysisConfig::EnableTensorRtBackgroundBuild(bool enable) {
+  trt_background_build_ = enable;
+}
+
+bool AnalysisConfig::trt_background_build_enabled() const {
+  return trt_background_build_;
+}
+
 void AnalysisConfig::Exp_DisableMixedPrecisionOps(
     const std::unordered_set<std::string> &black_list) {
   mixed_black_list_ = black_list;
@@ -1540,6 +1667,26 @@ void AnalysisConfig::EnableCustomPasses(const std::vector<std::string> &passes,
   custom_pass_only_ = custom_pass_only;
 }
 
+void AnalysisConfig::EnableWeightOnlyQuantization(const std::string &algo,
+                                                  int group_size) {
+  PADDLE_ENFORCE_EQ(
+      algo == "weight_only_int8" || algo == "weight_only_int4",
+      true,
+      common::errors::InvalidArgument(
+          "The weight only quantization only supports weight_only_int8 or "
+          "weight_only_int4, but got %s.",
+          algo));
+  PADDLE_ENFORCE_EQ(
+      group_size == -1 || group_size == 64 || group_size == 128,
+      true,
+      common::errors::InvalidArgument(
+          "The group_size of the weight only quantization only supports -1, "
+          "64 or 128, but got %d.",
+          group_size));
+  weight_only_algo_ = algo;
+  weight_only_group_size_ = group_size;
+}
+
 void AnalysisConfig::DeletePass(const std::string &pass_name) {
   deleted_passes_.push_back(pass_name);
 }
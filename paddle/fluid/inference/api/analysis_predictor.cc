@@ -17,11 +17,19 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -37,6 +45,7 @@
 #include "paddle/fluid/framework/op_proto_maker.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/framework/version.h"
@@ -50,6 +59,7 @@
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
 #include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/inference/io.h"
 #include "paddle/fluid/inference/utils/io_utils.h"
 #include "paddle/fluid/inference/utils/model_utils.h"
 #include "paddle/fluid/inference/utils/singleton.h"
@@ -93,6 +103,7 @@
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #include "paddle/fluid/inference/tensorrt/helper.h"
 #include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
+#include "paddle/fluid/platform/tensorrt/engine.h"
 #endif
 
 #ifdef PADDLE_WITH_IPU
@@ -216,6 +227,31 @@ bool IsPersistable(const framework::VarDesc *var) {
   return false;
 }
 
+// The bytes of the dense tensors of the params and the constants used by the
+// program.
+size_t GetPirParamsBytes(pir::Program *program, framework::Scope *scope) {
+  size_t bytes = 0;
+  for (auto op : program->block()->ops()) {
+    std::string name;
+    if (op->isa<::pir::ParameterOp>()) {
+      name = op->attribute<pir::StrAttribute>("parameter_name").AsString();
+    } else if (op->isa<::pir::ConstantTensorOp>()) {
+      name = op->dyn_cast<::pir::ConstantTensorOp>().tensor_name();
+    } else {
+      continue;
+    }
+    auto *var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<phi::DenseTensor>()) {
+      continue;
+    }
+    const auto &tensor = var->Get<phi::DenseTensor>();
+    if (tensor.initialized()) {
+      bytes += tensor.numel() * phi::SizeOf(tensor.dtype());
+    }
+  }
+  return bytes;
+}
+
 phi::DataType ConvertPrecision(AnalysisConfig::Precision precision) {
   switch (precision) {
     case AnalysisConfig::Precision::kFloat32:
@@ -369,6 +405,26 @@ bool PaddleTensorToDenseTensor(const PaddleTensor &pt,
   t->set_lod(lod);
   return true;
 }
+
+#ifdef PADDLE_WITH_XPU
+// Lets the intermediate tensors which are not live at the same time share the
+// L3 of XPU. The outputs are read after the run, so they are kept live during
+// the whole run.
+void RecordXPUHolderLiveRanges(framework::NaiveExecutor *executor,
+                               const std::vector<std::string> &output_names,
+                               InferXPUContext *infer_xpu_ctx) {
+  if (!infer_xpu_ctx->NeedHolderLiveRanges()) return;
+  auto live_ranges = executor->GetHolderLiveRanges();
+  if (live_ranges.empty()) return;
+  for (auto &name : output_names) {
+    auto *var = executor->GetScope()->FindVar(name);
+    if (var != nullptr && var->IsType<phi::DenseTensor>()) {
+      live_ranges.erase(var->Get<phi::DenseTensor>().Holder().get());
+    }
+  }
+  infer_xpu_ctx->RecordHolderLiveRanges(live_ranges);
+}
+#endif
 }  // namespace
 
 AnalysisPredictor::AnalysisPredictor(const AnalysisConfig &config)
@@ -459,6 +515,12 @@ bool AnalysisPredictor::Init(
             "config.EnableNewExecutor(true)) and config.EnableNewIR(true)"));
   }
 
+  // Use the optimized model cached by the key, or save it on the first start
+  std::string optim_model_cache_key;
+  if (config_.optim_model_cache_enabled() && !status_is_cloned_) {
+    optim_model_cache_key = PrepareOptimModelCache();
+  }
+
   // Use Optimized model to inference
   if (config_.use_optimized_model_) {
     std::string optimized_model_path = GetOptimizedModelPath();
@@ -511,6 +573,19 @@ bool AnalysisPredictor::Init(
 
   PrepareFeedFetch();
 
+  if (!optim_model_cache_key.empty() && config_.save_optimized_model_) {
+    // The key is written after the optimized model, so a cache interrupted
+    // while saving is never loaded.
+    std::string key_path = GetOptimizedModelPath() + "/" + "_optim_cache.key";
+    std::ofstream key_file(key_path, std::ios::out | std::ios::binary);
+    key_file << optim_model_cache_key;
+    key_file.close();
+    if (!key_file) {
+      LOG(WARNING) << "Fail to write the optimized model cache key to "
+                   << key_path;
+    }
+  }
+
   // Prepare executor, create local variables.
   if (!PrepareExecutor()) {
     return true;
@@ -519,11 +594,13 @@ bool AnalysisPredictor::Init(
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // TODO(inference): Now only gpu with external stream support private
   // device_context.
-  if (config_.use_gpu_ && config_.use_external_stream_) {
+  // The predictors of a stream priority run on the streams of their own.
+  if (config_.use_gpu_ &&
+      (config_.use_external_stream_ || config_.stream_priority() > 0)) {
     private_context_ = true;
   }
   if (private_context_) {
-    if (!status_is_cloned_) {
+    if (!status_is_cloned_ && config_.use_external_stream_) {
       predictor_stream_ = config_.GetExecStream();
     }
     // NOTE: If the external_stream equals to global_device_contexts's stream,
@@ -552,6 +629,25 @@ bool AnalysisPredictor::Init(
   }
 #endif
 
+#ifdef PADDLE_WITH_DNNL
+  if (config_.use_mkldnn_ && place_.GetType() == phi::AllocationType::CPU) {
+    // The primitive cache of oneDNN is process-wide, the clones share the
+    // primitives created by the warm-up of the first predictor.
+    if (config_.onednn_primitive_cache_capacity() > 0) {
+      dnnl::set_primitive_cache_capacity(
+          config_.onednn_primitive_cache_capacity());
+    }
+    if (!config_.onednn_warmup_shape_file().empty()) {
+      OnednnWarmup();
+    }
+  }
+#endif
+
+  // The runs of the warm-up are not accounted.
+  if (config_.latency_stats_enabled()) {
+    latency_recorder_ = std::make_unique<details::LatencyRecorder>();
+  }
+
   TryShrinkMemory();
 
   inference::DisplayMemoryInfo(place_, "Init predictor");
@@ -625,6 +721,141 @@ std::string AnalysisPredictor::GetOptimizedModelPath() {
   return model_opt_cache_dir;
 }
 
+namespace {
+
+// Feeds the content of the file into the hash, returns false if the file can
+// not be read.
+bool HashFileContent(const std::string &path, XXH64_state_t *state) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  if (!fin.is_open()) {
+    return false;
+  }
+  std::vector<char> buffer(4 << 20);
+  while (fin) {
+    fin.read(buffer.data(), buffer.size());
+    XXH64_update(state, buffer.data(), fin.gcount());
+  }
+  return fin.eof();
+}
+
+std::string FileContentHash(const std::string &path) {
+  XXH64_state_t *state = XXH64_createState();
+  XXH64_reset(state, 0);
+  bool ok = HashFileContent(path, state);
+  uint64_t hash = XXH64_digest(state);
+  XXH64_freeState(state);
+  if (!ok) {
+    return "";
+  }
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return ss.str();
+}
+
+}  // namespace
+
+std::string AnalysisPredictor::GetOptimModelCacheKey() {
+  std::string model_hash = FileContentHash(config_.prog_file());
+  std::string params_hash = FileContentHash(config_.params_file());
+  if (model_hash.empty() || params_hash.empty()) {
+    return "";
+  }
+  std::stringstream ss;
+  ss << "model:" << model_hash << ";params:" << params_hash << ";";
+
+  // The paths, the cache switches and the runtime handles do not change the
+  // optimized program.
+  AnalysisConfig config(config_);
+  config.model_dir_.clear();
+  config.prog_file_.clear();
+  config.params_file_.clear();
+  config.opt_cache_dir_.clear();
+  config.save_optimized_model_ = false;
+  config.use_optimized_model_ = false;
+  config.exec_stream_ = nullptr;
+  config.xpu_config_.l3_ptr = nullptr;
+  config.xpu_config_.context = nullptr;
+  config.xpu_config_.stream = nullptr;
+  ss << "config:" << config.SerializeInfoCache() << ";";
+  ss << "pir:" << config_.new_ir_enabled() << FLAGS_enable_pir_api << ";";
+  ss << "passes:";
+  for (const auto &pass : config_.pass_builder()->AllPasses()) {
+    ss << pass << ",";
+  }
+  for (const auto &pass : config_.deleted_passes_) {
+    ss << "-" << pass << ",";
+  }
+  ss << ";";
+
+  ss << "version:" << paddle::get_version() << ";";
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (config_.use_gpu()) {
+    int device_id = config_.gpu_device_id();
+    ss << "gpu:" << platform::GetGPUComputeCapability(device_id) << ","
+       << platform::GetGPURuntimeVersion(device_id) << ";";
+  }
+#endif
+#ifdef PADDLE_WITH_TENSORRT
+  if (config_.tensorrt_engine_enabled()) {
+    auto version = inference::tensorrt::GetTrtRuntimeVersion();
+    ss << "trt:" << std::get<0>(version) << "." << std::get<1>(version) << "."
+       << std::get<2>(version) << ";";
+  }
+#endif
+  return ss.str();
+}
+
+std::string AnalysisPredictor::PrepareOptimModelCache() {
+  if (config_.model_from_memory() || config_.prog_file().empty() ||
+      config_.params_file().empty()) {
+    LOG(WARNING) << "The optimized model cache only supports the combined "
+                    "models loaded from files, it is disabled.";
+    return "";
+  }
+  std::string key = GetOptimModelCacheKey();
+  if (key.empty()) {
+    LOG(WARNING) << "Fail to read the model files, the optimized model cache "
+                    "is disabled.";
+    return "";
+  }
+  uint64_t key_hash = XXH64(key.data(), key.size(), 0);
+  std::stringstream dir_name;
+  dir_name << "_optim_cache_" << std::hex << std::setw(16)
+           << std::setfill('0') << key_hash;
+  // The serialized TensorRT engines and the shape range info are saved into
+  // the optimization cache directory, so they are cached by the key too.
+  config_.SetOptimCacheDir(GetOptimizedModelPath() + "/" + dir_name.str());
+  std::string cache_dir = GetOptimizedModelPath();
+#ifdef PADDLE_WITH_XPU
+  if (config_.xpu_config_.conv_autotune_level > 0 &&
+      config_.xpu_config_.conv_autotune_file.empty()) {
+    config_.xpu_config_.conv_autotune_file = cache_dir + "/conv_autotune.txt";
+    config_.xpu_config_.conv_autotune_file_writeback = true;
+  }
+  if (config_.xpu_config_.fc_autotune_level > 0 &&
+      config_.xpu_config_.fc_autotune_file.empty()) {
+    config_.xpu_config_.fc_autotune_file = cache_dir + "/fc_autotune.txt";
+    config_.xpu_config_.fc_autotune_file_writeback = true;
+  }
+#endif
+
+  std::ifstream key_file(cache_dir + "/" + "_optim_cache.key",
+                         std::ios::in | std::ios::binary);
+  std::string cached_key((std::istreambuf_iterator<char>(key_file)),
+                         std::istreambuf_iterator<char>());
+  if (key_file.is_open() && cached_key == key) {
+    LOG(INFO) << "Hit the optimized model cache " << cache_dir;
+    config_.UseOptimizedModel(true);
+    config_.EnableSaveOptimModel(false);
+  } else {
+    LOG(INFO) << "Miss the optimized model cache " << cache_dir
+              << ", the optimized model will be saved into it.";
+    config_.UseOptimizedModel(false);
+    config_.EnableSaveOptimModel(true);
+  }
+  return key;
+}
+
 void AnalysisPredictor::ClearExtraParams() {
   auto var_names = scope_->LocalVarNames();
   std::vector<std::string> trt_repetitive_params;
@@ -659,6 +890,11 @@ void AnalysisPredictor::ClearExtraParams() {
     }
   }
 
+  // The engines built in the background and the paddle runs out of their
+  // shape range need the params.
+  if (config_.trt_background_build_) {
+    return;
+  }
   std::vector<std::string> extra_params;
   for (auto &var_desc : inference_program_->Block(0).AllVars()) {
     if (var_desc->Persistable()) {
@@ -678,8 +914,8 @@ void AnalysisPredictor::ClearExtraParams() {
 
 void AnalysisPredictor::InitResourceManager(void *stream) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  predictor_stream_ =
-      ResourceManager::Instance().InitGPUResource(place_, stream);
+  predictor_stream_ = ResourceManager::Instance().InitGPUResource(
+      place_, stream, config_.stream_priority());
 #endif
 }
 
@@ -772,6 +1008,101 @@ void *AnalysisPredictor::GetExecStream() const {
   return nullptr;
 }
 
+void AnalysisPredictor::BeginGpuTimer() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // only the predictors running on the streams of their own are timed
+  if (private_context_ && place_.GetType() == phi::AllocationType::GPU &&
+      ResourceManager::Instance().RefCount(predictor_stream_) > 0) {
+    ResourceManager::Instance()
+        .GetGPUResource(predictor_stream_)
+        ->BeginGpuTimer();
+  }
+#endif
+}
+
+void AnalysisPredictor::EndGpuTimer() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (private_context_ && place_.GetType() == phi::AllocationType::GPU &&
+      ResourceManager::Instance().RefCount(predictor_stream_) > 0) {
+    ResourceManager::Instance()
+        .GetGPUResource(predictor_stream_)
+        ->EndGpuTimer();
+  }
+#endif
+}
+
+double AnalysisPredictor::GetGpuTime() const {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (private_context_ && place_.GetType() == phi::AllocationType::GPU) {
+    return ResourceManager::Instance().GpuTime(predictor_stream_);
+  }
+#endif
+  return 0.;
+}
+
+std::map<std::string, paddle_infer::LatencyStats>
+AnalysisPredictor::GetLatencyStats() const {
+  if (latency_recorder_ == nullptr) {
+    return {};
+  }
+  return latency_recorder_->Snapshot();
+}
+
+void AnalysisPredictor::UpdateParams(
+    const std::map<std::string, paddle::Tensor> &params) {
+  framework::Scope *scope = executor_->GetScope();
+  std::unordered_map<std::string, const phi::DenseTensor *> weights;
+  std::unordered_set<std::string> updated;
+  for (const auto &item : params) {
+    auto *src =
+        dynamic_cast<const phi::DenseTensor *>(item.second.impl().get());
+    PADDLE_ENFORCE_NOT_NULL(
+        src,
+        common::errors::InvalidArgument(
+            "The new value of the parameter %s should be a DenseTensor.",
+            item.first));
+    weights[item.first] = src;
+    auto *var = scope->FindVar(item.first);
+    if (var == nullptr || !var->IsType<phi::DenseTensor>() ||
+        !var->Get<phi::DenseTensor>().initialized()) {
+      continue;
+    }
+    auto *dst = var->GetMutable<phi::DenseTensor>();
+    PADDLE_ENFORCE_EQ(dst->dims(),
+                      src->dims(),
+                      common::errors::InvalidArgument(
+                          "The shape of the parameter %s is [%s], but the new "
+                          "value is of the shape [%s].",
+                          item.first,
+                          dst->dims(),
+                          src->dims()));
+    PADDLE_ENFORCE_EQ(dst->dtype(),
+                      src->dtype(),
+                      common::errors::InvalidArgument(
+                          "The data type of the parameter %s is %s, but the "
+                          "new value is of the data type %s.",
+                          item.first,
+                          dst->dtype(),
+                          src->dtype()));
+    framework::TensorCopySync(*src, dst->place(), dst);
+    updated.insert(item.first);
+  }
+#ifdef PADDLE_WITH_TENSORRT
+  int num = paddle::inference::Singleton<platform::TRTRefitManager>::Global()
+                .Refit(scope, weights, &updated);
+  VLOG(3) << num << " TensorRT engines are refitted by the new parameters.";
+#endif
+  for (const auto &item : params) {
+    PADDLE_ENFORCE_EQ(
+        updated.count(item.first),
+        1UL,
+        common::errors::NotFound(
+            "The parameter %s is neither in the scope of the predictor nor "
+            "a refittable weight of the TensorRT engines.",
+            item.first));
+  }
+}
+
 const void *AnalysisPredictor::GetDeviceContexts() const {
   if (private_context_) {
     return &device_contexts_;
@@ -819,6 +1150,15 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
                      pass->name()) != this->config_.ir_debug_passes_.end();
   };
 
+  size_t params_bytes = 0;
+  if (config_.weight_only_quantization_enabled()) {
+    if (!config_.use_gpu()) {
+      LOG(WARNING) << "The weight only quantization only runs on gpu, it is "
+                      "ignored.";
+    }
+    params_bytes = GetPirParamsBytes(pir_program_.get(), sub_scope_);
+  }
+
   if (!config_.use_optimized_model_) {
 #ifdef PADDLE_WITH_CINN
     auto CreatePassMgr = [&] {
@@ -922,6 +1262,19 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
           pass->name() == "conv2d_add_fuse_pass") {
         pass->Set("use_cutlass", new bool(config_.use_cutlass_));
       }
+      if (pass->name() == "fused_weight_only_linear_pass" &&
+          config_.weight_only_quantization_enabled()) {
+        pass->Set("weight_only_algo",
+                  new std::string(config_.weight_only_algo_));
+        pass->Set("weight_only_group_size",
+                  new int(config_.weight_only_group_size_));
+      }
+      if (pass->name() == "flash_attn_varlen_pass" &&
+          config_.packed_sequence_enabled()) {
+        pass->Set("cu_seqlens_name",
+                  new std::string(config_.packed_cu_seqlens_name()));
+        pass->Set("max_seqlen", new int(config_.packed_max_seqlen()));
+      }
     }
 
     if (!config_.glog_info_disabled()) {
@@ -1016,6 +1369,19 @@ void AnalysisPredictor::OptimizeInferencePirProgram() {
   }
   lowered_pm.Run(pir_program_.get());
 
+  if (config_.weight_only_quantization_enabled()) {
+    // The weights are quantized by the constant folding of weight_quantize.
+    size_t quantized_params_bytes =
+        GetPirParamsBytes(pir_program_.get(), sub_scope_);
+    size_t saved_bytes =
+        params_bytes - std::min(params_bytes, quantized_params_bytes);
+    LOG(INFO) << "The params take "
+              << inference::ToMegaBytes(quantized_params_bytes) << " MB with "
+              << config_.weight_only_algo_ << ", "
+              << inference::ToMegaBytes(params_bytes) << " MB before, "
+              << inference::ToMegaBytes(saved_bytes) << " MB saved.";
+  }
+
   LOG(INFO) << "======= pir optimization completed =======";
 }
 
@@ -1649,9 +2015,136 @@ void AnalysisPredictor::MkldnnPostReset() {
 #endif
 }
 
+#ifdef PADDLE_WITH_DNNL
+namespace {
+
+// The input shapes in the oneDNN warm-up shape files, shared by the
+// predictors and their clones recording to the same file. Returns false if
+// the shapes are in the file or the file is full.
+bool InsertOnednnShapes(const std::string &file,
+                        const std::string &shapes,
+                        int max_shapes,
+                        bool record) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::unordered_set<std::string>>
+      file_shapes;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &recorded = file_shapes[file];
+  if (recorded.count(shapes) ||
+      recorded.size() >= static_cast<size_t>(max_shapes)) {
+    return false;
+  }
+  recorded.insert(shapes);
+  if (record) {
+    std::ofstream fout(file, std::ios::out | std::ios::app);
+    fout << shapes << "\n";
+    if (!fout) {
+      LOG(WARNING) << "Fail to record the input shapes to " << file;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+#endif
+
+void AnalysisPredictor::RecordOnednnShapes() {
+#ifdef PADDLE_WITH_DNNL
+  // Each input is recorded as "dtype:d0,d1,...", separated by spaces.
+  framework::Scope *scope = executor_->GetScope();
+  std::stringstream ss;
+  for (const auto &name : GetInputNames()) {
+    auto *var = scope->FindVar(name);
+    if (var == nullptr || !var->IsType<phi::DenseTensor>() ||
+        !var->Get<phi::DenseTensor>().initialized()) {
+      return;
+    }
+    const auto &tensor = var->Get<phi::DenseTensor>();
+    ss << static_cast<int>(tensor.dtype()) << ":";
+    for (int i = 0; i < tensor.dims().size(); ++i) {
+      ss << (i > 0 ? "," : "") << tensor.dims()[i];
+    }
+    ss << " ";
+  }
+  std::string shapes = ss.str();
+  if (shapes == last_onednn_shapes_) {
+    return;
+  }
+  last_onednn_shapes_ = shapes;
+  InsertOnednnShapes(config_.onednn_warmup_shape_file(),
+                     shapes,
+                     config_.onednn_warmup_max_shapes(),
+                     true);
+#endif
+}
+
+void AnalysisPredictor::OnednnWarmup() {
+#ifdef PADDLE_WITH_DNNL
+  const std::string &file = config_.onednn_warmup_shape_file();
+  std::ifstream fin(file);
+  if (!fin.is_open()) {
+    return;
+  }
+  framework::Scope *scope = executor_->GetScope();
+  std::vector<std::string> names = GetInputNames();
+  std::unordered_set<std::string> warmed_shapes;
+  std::string shapes;
+  while (std::getline(fin, shapes) &&
+         warmed_shapes.size() <
+             static_cast<size_t>(config_.onednn_warmup_max_shapes())) {
+    if (shapes.empty() || !warmed_shapes.insert(shapes).second) {
+      continue;
+    }
+    InsertOnednnShapes(
+        file, shapes, config_.onednn_warmup_max_shapes(), false);
+    try {
+      std::istringstream iss(shapes);
+      std::string input;
+      size_t num_inputs = 0;
+      while (iss >> input) {
+        auto pos = input.find(':');
+        PADDLE_ENFORCE_LT(
+            num_inputs,
+            names.size(),
+            common::errors::InvalidArgument("Too many inputs are recorded."));
+        PADDLE_ENFORCE_NE(pos,
+                          std::string::npos,
+                          common::errors::InvalidArgument(
+                              "The data type of the input is not recorded."));
+        auto dtype =
+            static_cast<phi::DataType>(std::stoi(input.substr(0, pos)));
+        std::vector<int64_t> dims;
+        std::stringstream dims_ss(input.substr(pos + 1));
+        std::string dim;
+        while (std::getline(dims_ss, dim, ',')) {
+          dims.push_back(std::stoll(dim));
+        }
+        auto *tensor = scope->Var(names[num_inputs++])
+                           ->GetMutable<phi::DenseTensor>();
+        tensor->Resize(common::make_ddim(dims));
+        void *data = tensor->mutable_data(phi::CPUPlace(), dtype);
+        std::memset(data, 0, tensor->numel() * phi::SizeOf(dtype));
+      }
+      PADDLE_ENFORCE_EQ(
+          num_inputs,
+          names.size(),
+          common::errors::InvalidArgument("Too few inputs are recorded."));
+      ZeroCopyRun();
+    } catch (const std::exception &e) {
+      LOG(WARNING) << "Skip the oneDNN warm-up of the input shapes [" << shapes
+                   << "] in " << file << ": " << e.what();
+    }
+  }
+  VLOG(1) << "The predictor is warmed up by " << warmed_shapes.size()
+          << " input shapes in " << file;
+#endif
+}
+
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
+  using Clock = details::LatencyRecorder::Clock;
+  auto run_begin = Clock::now();
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
@@ -1662,10 +2155,12 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   PADDLE_ENFORCE_NOT_NULL(
       scope,
       common::errors::PreconditionNotMet("The scope should not be nullptr."));
+  auto feed_begin = Clock::now();
   if (!SetFeed(inputs, scope)) {
     LOG(ERROR) << "fail to set feed";
     return false;
   }
+  auto feed_end = Clock::now();
 #ifdef PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled()) {
     inference::tensorrt::TensorRTEngine::predictor_id_per_thread =
@@ -1691,10 +2186,22 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   }
 
   // get fetch variable
+  auto fetch_begin = Clock::now();
   if (!GetFetch(output_data, scope)) {
     LOG(ERROR) << "fail to get fetches";
     return false;
   }
+  if (latency_recorder_ != nullptr) {
+    auto fetch_end = Clock::now();
+    latency_recorder_->Record(
+        details::LatencyRecorder::kH2D, feed_begin, feed_end);
+    latency_recorder_->Record(
+        details::LatencyRecorder::kCompute, feed_end, fetch_begin);
+    latency_recorder_->Record(
+        details::LatencyRecorder::kD2H, fetch_begin, fetch_end);
+    latency_recorder_->Record(
+        details::LatencyRecorder::kE2E, run_begin, fetch_end);
+  }
 
   // All the containers in the scope will be hold in inference, but the
   // operators assume that the container will be reset after each batch.
@@ -1723,12 +2230,15 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
 
 bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
                             std::vector<paddle::Tensor> *outputs) {
+  using Clock = details::LatencyRecorder::Clock;
+  auto run_begin = Clock::now();
   inference::DisplayMemoryInfo(place_, "before run");
   if (private_context_) {
     phi::DeviceContextPool::SetDeviceContexts(&device_contexts_);
     auto &pool = paddle::experimental::DeviceContextPool::Instance();
     pool.SyncDeviceContext(place_);
   }
+  BeginGpuTimer();
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
@@ -1739,10 +2249,12 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   PADDLE_ENFORCE_NOT_NULL(
       scope,
       common::errors::PreconditionNotMet("The scope should not be nullptr."));
+  auto feed_begin = Clock::now();
   if (!SetFeed(inputs, scope)) {
     LOG(ERROR) << "fail to set feed";
     return false;
   }
+  auto feed_end = Clock::now();
 #ifdef PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled()) {
     inference::tensorrt::TensorRTEngine::predictor_id_per_thread =
@@ -1794,14 +2306,28 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   inference::DisplayMemoryInfo(place_, "after run");
 #ifdef PADDLE_WITH_XPU
   if (config_.use_xpu_ && infer_xpu_ctx != nullptr) {
+    RecordXPUHolderLiveRanges(
+        executor_.get(), GetOutputNames(), infer_xpu_ctx);
     infer_xpu_ctx->L3CacheAutotune();
   }
 #endif
   // get fetch variable
+  auto fetch_begin = Clock::now();
   if (!GetFetch(outputs, scope)) {
     LOG(ERROR) << "fail to get fetches";
     return false;
   }
+  if (latency_recorder_ != nullptr) {
+    auto fetch_end = Clock::now();
+    latency_recorder_->Record(
+        details::LatencyRecorder::kH2D, feed_begin, feed_end);
+    latency_recorder_->Record(
+        details::LatencyRecorder::kCompute, feed_end, fetch_begin);
+    latency_recorder_->Record(
+        details::LatencyRecorder::kD2H, fetch_begin, fetch_end);
+    latency_recorder_->Record(
+        details::LatencyRecorder::kE2E, run_begin, fetch_end);
+  }
 
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
@@ -1810,6 +2336,7 @@ bool AnalysisPredictor::Run(const std::vector<paddle::Tensor> &inputs,
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
+  EndGpuTimer();
   if (private_context_) {
     phi::DeviceContextPool::SetDeviceContexts(nullptr);
   }
@@ -2055,6 +2582,7 @@ void AnalysisPredictor::PrepareArgument() {
     argument_->SetTensorRtDisabledOPs(config_.trt_disabled_ops_);
     argument_->SetTRTExcludeVarNames(config_.trt_exclude_var_names_);
     argument_->SetTRTForbidDynamicOp(config_.trt_forbid_dynamic_op_);
+    argument_->SetTRTCostBasedPartition(config_.trt_cost_based_partition_);
 
     argument_->SetTensorRtUseDLA(config_.trt_use_dla_);
     argument_->SetTensorRtDLACore(config_.trt_dla_core_);
@@ -2065,6 +2593,7 @@ void AnalysisPredictor::PrepareArgument() {
     argument_->SetTensorRtShapeRangeInfoPath(config_.shape_range_info_path());
     argument_->SetTensorRtAllowBuildAtRuntime(
         config_.trt_allow_build_at_runtime());
+    argument_->SetTensorRtBackgroundBuild(config_.trt_background_build_);
     argument_->SetTensorRtUseInspector(config_.trt_use_inspector_);
     argument_->SetTensorRtInspectorSerialize(config_.trt_inspector_serialize_);
     argument_->SetTensorRtUseExplicitQuantization(
@@ -2615,6 +3144,7 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetInputTensor(
   std::unique_ptr<ZeroCopyTensor> res(new ZeroCopyTensor(
       static_cast<void *>(scope), this->GetDeviceContexts()));
   res->input_or_output_ = true;
+  res->latency_recorder_ = latency_recorder_.get();
   res->SetName(name);
   if (phi::is_cpu_place(place_)) {  // NOLINT
     res->SetPlace(PaddlePlace::kCPU);
@@ -2657,6 +3187,7 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
   std::unique_ptr<ZeroCopyTensor> res(new ZeroCopyTensor(
       static_cast<void *>(scope), this->GetDeviceContexts()));
   res->input_or_output_ = false;
+  res->latency_recorder_ = latency_recorder_.get();
   res->SetName(name);
   if (phi::is_cpu_place(place_)) {  // NOLINT
     res->SetPlace(PaddlePlace::kCPU);
@@ -2688,11 +3219,13 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
     return true;
   }
 #endif
+  auto run_begin = details::LatencyRecorder::Clock::now();
   if (private_context_) {
     phi::DeviceContextPool::SetDeviceContexts(&device_contexts_);
     auto &pool = paddle::experimental::DeviceContextPool::Instance();
     pool.SyncDeviceContext(place_);
   }
+  BeginGpuTimer();
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_DNNL
   if (config_.use_mkldnn_) {
@@ -2703,6 +3236,9 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
       shape_vector.emplace_back(in_tensor->shape());
     }
     MkldnnPreSet(shape_vector);
+    if (!config_.onednn_warmup_shape_file().empty()) {
+      RecordOnednnShapes();
+    }
   }
 #endif
 
@@ -2771,6 +3307,8 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
         infer_xpu_ctx->SetOutHolder(holder);
       }
     });
+    RecordXPUHolderLiveRanges(
+        executor_.get(), GetOutputNames(), infer_xpu_ctx);
     infer_xpu_ctx->L3CacheAutotune();
   }
 #endif
@@ -2782,6 +3320,7 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
   paddle::platform::SetNumThreads(1);
+  EndGpuTimer();
   if (private_context_) {
     phi::DeviceContextPool::SetDeviceContexts(nullptr);
   }
@@ -2794,6 +3333,10 @@ bool AnalysisPredictor::ZeroCopyRun(bool switch_stream) {
   // https://software.intel.com/en-us/mkl-developer-reference-c-mkl-free-buffers
   phi::dynload::MKL_Free_Buffers();
 #endif
+  if (latency_recorder_ != nullptr) {
+    latency_recorder_->RecordRun(run_begin,
+                                 details::LatencyRecorder::Clock::now());
+  }
   return true;
 }
 
@@ -2961,6 +3504,110 @@ bool AnalysisPredictor::ExpRunWithRuntimeConfig(void *config) {
   return false;
 }
 
+class AnalysisPredictor::AsyncRunner {
+ public:
+  AsyncRunner() : thread_([this] { Loop(); }) {}
+
+  // Waits for the runs launched and in flight.
+  ~AsyncRunner() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      stop_ = true;
+      cv_.notify_all();
+    }
+    thread_.join();
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return in_flight_ == 0; });
+  }
+
+  void Launch(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++in_flight_;
+    tasks_.push_back(std::move(task));
+    cv_.notify_all();
+  }
+
+  // Called by every launched task when its run completes.
+  void Complete() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --in_flight_;
+    cv_.notify_all();
+  }
+
+ private:
+  void Loop() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  int in_flight_{0};
+  bool stop_{false};
+  std::thread thread_;
+};
+
+std::future<bool> AnalysisPredictor::RunAsync(
+    std::function<void(bool)> callback) {
+  AsyncRunner *runner = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(async_runner_mutex_);
+    if (!async_runner_) {
+      async_runner_ = std::make_unique<AsyncRunner>();
+    }
+    runner = async_runner_.get();
+  }
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  runner->Launch([this, runner, promise, callback] {
+    auto complete = [runner, promise, callback](bool success) {
+      if (callback) {
+        callback(success);
+      }
+      promise->set_value(success);
+      runner->Complete();
+    };
+    bool success = false;
+    try {
+      success = ZeroCopyRun();
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "RunAsync fails: " << e.what();
+    }
+    phi::DeviceContext *dev_ctx = nullptr;
+    if (success) {
+      dev_ctx = private_context_
+                    ? device_contexts_.at(place_).get().get()
+                    : phi::DeviceContextPool::Instance().Get(place_);
+    }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    if (dev_ctx != nullptr && place_.GetType() == phi::AllocationType::GPU) {
+      // completes on a host thread of the stream callbacks, the kernels of
+      // the next run can be launched in the meantime
+      static_cast<phi::GPUContext *>(dev_ctx)->AddStreamCallback(
+          [complete] { complete(true); });
+      return;
+    }
+#endif
+    if (dev_ctx != nullptr) {
+      dev_ctx->Wait();
+    }
+    complete(success);
+  });
+  return future;
+}
+
 void AnalysisPredictor::StatisticShapeRangeInfo() {
   std::map<std::string, std::vector<int32_t>> min_shapes;
   std::map<std::string, std::vector<int32_t>> max_shapes;
@@ -3109,7 +3756,10 @@ bool AnalysisPredictor::LoadParameters() {
     }
   }
 
-  if (!config_.params_file().empty()) {
+  bool mmap_params = !config_.params_file().empty() &&
+                     !config_.model_from_memory() &&
+                     inference::IsMmapParamsFile(config_.params_file());
+  if (!config_.params_file().empty() && !mmap_params) {
     // sort paramlist to have consistent ordering
     std::sort(params.begin(), params.end());
     // append just the load_combine op
@@ -3124,6 +3774,10 @@ bool AnalysisPredictor::LoadParameters() {
   framework::NaiveExecutor e(place_);
   e.Prepare(scope_.get(), *load_program, 0);
   e.Run();
+  if (mmap_params) {
+    inference::LoadMmapParams(
+        scope_.get(), params, config_.params_file(), place_);
+  }
   VLOG(3) << "get " << scope_->LocalVarNames().size() << " vars after load";
 
   return true;
@@ -3214,6 +3868,7 @@ bool AnalysisPredictor::SaveTrtCalibToDisk() {
 #endif
 
 AnalysisPredictor::~AnalysisPredictor() {  // NOLINT
+  async_runner_.reset();
 #ifdef PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled() &&
       config_.tensorrt_precision_mode_ == AnalysisConfig::Precision::kInt8 &&
@@ -3713,6 +4368,21 @@ bool Predictor::Run(const std::vector<paddle::Tensor> &inputs,
   return predictor_->Run(inputs, outputs);
 }
 
+std::future<bool> Predictor::RunAsync(std::function<void(bool)> callback) {
+  auto *pred = dynamic_cast<paddle::AnalysisPredictor *>(predictor_.get());
+  if (pred != nullptr) {
+    return pred->RunAsync(std::move(callback));
+  }
+  // the other engines run synchronously
+  bool success = predictor_->ZeroCopyRun();
+  if (callback) {
+    callback(success);
+  }
+  std::promise<bool> promise;
+  promise.set_value(success);
+  return promise.get_future();
+}
+
 std::unique_ptr<Predictor> Predictor::Clone(void *stream) {
   auto analysis_pred = predictor_->Clone(stream);
   std::unique_ptr<Predictor> pred(new Predictor(std::move(analysis_pred)));
@@ -3734,6 +4404,27 @@ void Predictor::RegisterInputHook(const InputTensorHookFunc &hookfunc) {
 
 void *Predictor::GetExecStream() const { return predictor_->GetExecStream(); }
 
+double Predictor::GetGpuTime() const {
+  auto *pred = dynamic_cast<paddle::AnalysisPredictor *>(predictor_.get());
+  return pred != nullptr ? pred->GetGpuTime() : 0.;
+}
+
+void Predictor::UpdateParams(
+    const std::map<std::string, paddle::Tensor> &params) {
+  auto *pred = dynamic_cast<paddle::AnalysisPredictor *>(predictor_.get());
+  PADDLE_ENFORCE_NOT_NULL(pred,
+                          common::errors::Unimplemented(
+                              "UpdateParams is only supported by the "
+                              "AnalysisPredictor."));
+  pred->UpdateParams(params);
+}
+
+std::map<std::string, LatencyStats> Predictor::GetLatencyStats() const {
+  auto *pred = dynamic_cast<paddle::AnalysisPredictor *>(predictor_.get());
+  return pred != nullptr ? pred->GetLatencyStats()
+                         : std::map<std::string, LatencyStats>();
+}
+
 int GetNumBytesOfDataType(DataType dtype) {
   switch (dtype) {
     case DataType::FLOAT32:
@@ -3794,6 +4485,70 @@ void ConvertToMixedPrecision(const std::string &model_file,
                                                        white_list);
 }
 
+void ConvertToMmapParams(const std::string &model_file,
+                         const std::string &params_file,
+                         const std::string &mmap_params_file) {
+  paddle::framework::Scope scope;
+  paddle::framework::Executor executor(phi::CPUPlace());
+  auto program =
+      paddle::inference::Load(&executor, &scope, model_file, params_file);
+  std::vector<std::string> params;
+  for (auto *var : program->Block(0).AllVars()) {
+    if (paddle::IsPersistable(var)) {
+      params.push_back(var->Name());
+    }
+  }
+  std::sort(params.begin(), params.end());
+  paddle::inference::SaveMmapParams(scope, params, mmap_params_file);
+}
+
+namespace {
+
+std::string EscapeLabelValue(const std::string &value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+std::string ExportLatencyMetrics(
+    const std::map<std::string, const Predictor *> &predictors) {
+  const char *name = "paddle_inference_latency_microseconds";
+  std::ostringstream os;
+  os << "# HELP " << name << " The latency of the runs of the predictors.\n";
+  os << "# TYPE " << name << " summary\n";
+  for (auto &predictor : predictors) {
+    if (predictor.second == nullptr) {
+      continue;
+    }
+    std::string predictor_label = EscapeLabelValue(predictor.first);
+    for (auto &item : predictor.second->GetLatencyStats()) {
+      std::string labels = "predictor=\"" + predictor_label + "\",stage=\"" +
+                           item.first + "\"";
+      const LatencyStats &stats = item.second;
+      std::pair<const char *, double> quantiles[] = {
+          {"0.5", stats.p50}, {"0.99", stats.p99}, {"0.999", stats.p999}};
+      for (auto &quantile : quantiles) {
+        os << name << "{" << labels << ",quantile=\"" << quantile.first
+           << "\"} " << quantile.second << "\n";
+      }
+      os << name << "_sum{" << labels << "} " << stats.sum << "\n";
+      os << name << "_count{" << labels << "} " << stats.count << "\n";
+    }
+  }
+  return os.str();
+}
+
 }  // namespace paddle_infer
 
 namespace paddle_infer {
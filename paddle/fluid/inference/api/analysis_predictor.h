@@ -15,6 +15,8 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -24,6 +26,7 @@
 #include "paddle/fluid/framework/op_compatible_info.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
+#include "paddle/fluid/inference/api/details/latency_histogram.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
@@ -225,6 +228,17 @@ class AnalysisPredictor : public PaddlePredictor {
   // Note: Can only be used under thread_local semantics.
   bool ExpRunWithRuntimeConfig(void *config);
 
+  ///
+  /// \brief Run the prediction engine without blocking the caller. The run is
+  /// launched by a thread of the predictor, in the order of the calls, and
+  /// completes when the device finishes its work on the stream.
+  ///
+  /// \param callback Called with whether the run is successful when it
+  /// completes, not on the thread of the caller.
+  /// \return The future of whether the run is successful
+  ///
+  std::future<bool> RunAsync(std::function<void(bool)> callback = nullptr);
+
   ///
   /// \brief Get the execution stream on devices with a concept of stream,
   /// otherwise returns nullptr.
@@ -233,6 +247,34 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   void *GetExecStream() const override;
 
+  ///
+  /// \brief Get the GPU time of the runs of the predictor, accounted when it
+  /// runs on a stream of its own, by the execution stream or the stream
+  /// priority.
+  ///
+  /// \return The GPU time in ms, or 0 if it is not accounted.
+  ///
+  double GetGpuTime() const;
+
+  ///
+  /// \brief Update the values of the parameters without recreating the
+  /// predictor. The parameters in the scope are overwritten, and the new
+  /// values are pushed into the refittable TensorRT engines of the PIR
+  /// program, which are kept without rebuilding. It should not be called
+  /// while the predictor runs.
+  ///
+  /// \param[in] params The new values of the parameters, keyed by the names
+  ///
+  void UpdateParams(const std::map<std::string, paddle::Tensor> &params);
+
+  ///
+  /// \brief Get the latency statistics of the runs of the predictor, if they
+  /// are enabled by the config.
+  ///
+  /// \return The statistics keyed by the stages, e2e, h2d, compute and d2h.
+  ///
+  std::map<std::string, paddle_infer::LatencyStats> GetLatencyStats() const;
+
   ///
   /// \brief Create feed fetch variables
   ///
@@ -482,6 +524,19 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   void MkldnnPostReset();
 
+  ///
+  /// \brief Run the predictor with zero inputs of the shapes recorded in the
+  /// oneDNN warm-up shape file, to create the oneDNN primitives before the
+  /// first requests.
+  ///
+  void OnednnWarmup();
+
+  ///
+  /// \brief Record the shapes and the data types of the inputs in the scope
+  /// to the oneDNN warm-up shape file.
+  ///
+  void RecordOnednnShapes();
+
 #ifdef PADDLE_WITH_TENSORRT
   ///
   /// \brief save calibration table
@@ -517,7 +572,16 @@ class AnalysisPredictor : public PaddlePredictor {
   void InitPlace();
   void InitDeviceContexts();
   void InitResourceManager(void *stream);
+  void BeginGpuTimer();
+  void EndGpuTimer();
   std::string GetOptimizedModelPath();
+  // The key of the optimized model cache, or "" if the model files can not be
+  // read.
+  std::string GetOptimModelCacheKey();
+  // Points the optimization cache directory to the one of the key, and loads
+  // the optimized model from it if it is complete, otherwise saves into it.
+  // Returns the key, or "" if the cache is not used.
+  std::string PrepareOptimModelCache();
   void ClearExtraParams();
 
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
@@ -623,11 +687,22 @@ class AnalysisPredictor : public PaddlePredictor {
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_info_;
   std::map<std::string, std::vector<std::vector<int32_t>>> shape_tensor_value_;
 
+  // The input shapes of the last run, which are not recorded again.
+  std::string last_onednn_shapes_;
+
+  // The latency statistics of the runs, if they are enabled.
+  std::unique_ptr<details::LatencyRecorder> latency_recorder_;
+
   bool private_context_{false};
   void *predictor_stream_{nullptr};
   std::map<phi::Place, std::shared_future<std::unique_ptr<phi::DeviceContext>>>
       device_contexts_;
 
+  // The thread launching the runs of RunAsync, created by the first one.
+  class AsyncRunner;
+  std::unique_ptr<AsyncRunner> async_runner_;
+  std::mutex async_runner_mutex_;
+
 #if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_PSCORE)
   // fleet executor related
   distributed::FleetExecutorDesc executor_desc_;
@@ -0,0 +1,550 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+using paddle::PaddleBuf;
+using paddle::PaddleTensor;
+
+size_t ElementSize(DataType dtype) {
+  switch (dtype) {
+    case DataType::FLOAT64:
+    case DataType::INT64:
+      return 8;
+    case DataType::FLOAT32:
+    case DataType::INT32:
+      return 4;
+    case DataType::FLOAT16:
+    case DataType::BFLOAT16:
+      return 2;
+    case DataType::UINT8:
+    case DataType::INT8:
+    case DataType::BOOL:
+      return 1;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Unsupported data type (%d) in BatchingPredictorPool.",
+          static_cast<int>(dtype)));
+  }
+  return 0;
+}
+
+int64_t Numel(const std::vector<int>& shape, size_t begin = 0) {
+  int64_t numel = 1;
+  for (size_t i = begin; i < shape.size(); ++i) {
+    numel *= shape[i];
+  }
+  return numel;
+}
+
+template <typename T>
+void FillValue(void* data, int64_t numel, T value) {
+  std::fill_n(static_cast<T*>(data), numel, value);
+}
+
+void FillPadding(void* data, int64_t numel, DataType dtype, float value) {
+  if (value == 0.f) {
+    memset(data, 0, numel * ElementSize(dtype));
+    return;
+  }
+  switch (dtype) {
+    case DataType::FLOAT32:
+      return FillValue<float>(data, numel, value);
+    case DataType::FLOAT64:
+      return FillValue<double>(data, numel, value);
+    case DataType::INT64:
+      return FillValue<int64_t>(data, numel, value);
+    case DataType::INT32:
+      return FillValue<int32_t>(data, numel, value);
+    case DataType::UINT8:
+      return FillValue<uint8_t>(data, numel, value);
+    case DataType::INT8:
+      return FillValue<int8_t>(data, numel, value);
+    case DataType::BOOL:
+      return FillValue<bool>(data, numel, value != 0.f);
+    case DataType::FLOAT16:
+      return FillValue<phi::dtype::float16>(
+          data, numel, phi::dtype::float16(value));
+    case DataType::BFLOAT16:
+      return FillValue<phi::dtype::bfloat16>(
+          data, numel, phi::dtype::bfloat16(value));
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Unsupported data type (%d) in BatchingPredictorPool.",
+          static_cast<int>(dtype)));
+  }
+}
+
+// Copies src of src_shape into the same indices of dst of dst_shape, which is
+// at least as large in every dim.
+void CopyPadded(const char* src,
+                const std::vector<int>& src_shape,
+                char* dst,
+                const std::vector<int>& dst_shape,
+                size_t element_size) {
+  size_t rank = src_shape.size();
+  size_t row_bytes = src_shape[rank - 1] * element_size;
+  std::vector<int64_t> dst_strides(rank, 1);
+  for (size_t i = rank - 1; i > 0; --i) {
+    dst_strides[i - 1] = dst_strides[i] * dst_shape[i];
+  }
+  int64_t rows = Numel(src_shape) / std::max(src_shape[rank - 1], 1);
+  std::vector<int> index(rank, 0);
+  for (int64_t row = 0; row < rows; ++row) {
+    int64_t offset = 0;
+    for (size_t i = 0; i + 1 < rank; ++i) {
+      offset += index[i] * dst_strides[i];
+    }
+    memcpy(dst + offset * element_size, src + row * row_bytes, row_bytes);
+    for (size_t i = rank - 1; i > 0; --i) {
+      if (++index[i - 1] < src_shape[i - 1]) {
+        break;
+      }
+      index[i - 1] = 0;
+    }
+  }
+}
+
+template <typename T>
+void CopyHandleFromCpu(Tensor* tensor, const void* data) {
+  tensor->CopyFromCpu(static_cast<const T*>(data));
+}
+
+template <typename T>
+void CopyHandleToCpu(const Tensor* tensor, void* data) {
+  tensor->CopyToCpu(static_cast<T*>(data));
+}
+
+#define PD_BATCHING_VISIT_TYPE(dtype, func, ...)                \
+  switch (dtype) {                                              \
+    case DataType::FLOAT32:                                     \
+      return func<float>(__VA_ARGS__);                          \
+    case DataType::FLOAT64:                                     \
+      return func<double>(__VA_ARGS__);                         \
+    case DataType::INT64:                                       \
+      return func<int64_t>(__VA_ARGS__);                        \
+    case DataType::INT32:                                       \
+      return func<int32_t>(__VA_ARGS__);                        \
+    case DataType::UINT8:                                       \
+      return func<uint8_t>(__VA_ARGS__);                        \
+    case DataType::INT8:                                        \
+      return func<int8_t>(__VA_ARGS__);                         \
+    case DataType::BOOL:                                        \
+      return func<bool>(__VA_ARGS__);                           \
+    case DataType::FLOAT16:                                     \
+      return func<phi::dtype::float16>(__VA_ARGS__);            \
+    case DataType::BFLOAT16:                                    \
+      return func<phi::dtype::bfloat16>(__VA_ARGS__);           \
+    default:                                                    \
+      PADDLE_THROW(common::errors::Unimplemented(               \
+          "Unsupported data type (%d) in BatchingPredictorPool.", \
+          static_cast<int>(dtype)));                            \
+  }
+
+void CopyFromCpu(Tensor* tensor, DataType dtype, const void* data) {
+  PD_BATCHING_VISIT_TYPE(dtype, CopyHandleFromCpu, tensor, data);
+}
+
+void CopyToCpu(const Tensor* tensor, DataType dtype, void* data) {
+  PD_BATCHING_VISIT_TYPE(dtype, CopyHandleToCpu, tensor, data);
+}
+
+#undef PD_BATCHING_VISIT_TYPE
+
+// The rows of a tensor in the batch, the sequences if it has lod.
+int GetRows(const PaddleTensor& tensor) {
+  if (!tensor.lod.empty()) {
+    return static_cast<int>(tensor.lod[0].size()) - 1;
+  }
+  return tensor.shape.empty() ? 0 : tensor.shape[0];
+}
+
+}  // namespace
+
+class BatchingPredictorPool::Impl {
+ public:
+  Impl(const Config& config, size_t size, const BatchingOptions& options)
+      : options_(options), pool_(config, size) {
+    PADDLE_ENFORCE_GT(options.max_batch_size,
+                      0,
+                      common::errors::InvalidArgument(
+                          "The max_batch_size should be greater than 0, but "
+                          "it's (%d)",
+                          options.max_batch_size));
+    input_names_ = pool_.Retrieve(0)->GetInputNames();
+    output_names_ = pool_.Retrieve(0)->GetOutputNames();
+    for (size_t i = 0; i < size; ++i) {
+      workers_.emplace_back(&Impl::Work, this, pool_.Retrieve(i));
+    }
+  }
+
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  std::future<std::vector<PaddleTensor>> Submit(
+      std::vector<PaddleTensor> inputs) {
+    auto request = std::make_unique<Request>();
+    auto future = request->promise.get_future();
+    try {
+      request->inputs = SortInputs(std::move(inputs));
+      request->rows = GetRows(request->inputs[0]);
+      for (auto& input : request->inputs) {
+        PADDLE_ENFORCE_EQ(GetRows(input),
+                          request->rows,
+                          common::errors::InvalidArgument(
+                              "The input (%s) has (%d) rows, but the input "
+                              "(%s) has (%d).",
+                              input.name,
+                              GetRows(input),
+                              request->inputs[0].name,
+                              request->rows));
+        PADDLE_ENFORCE_EQ(
+            input.data.length(),
+            Numel(input.shape) * ElementSize(input.dtype),
+            common::errors::InvalidArgument(
+                "The data of the input (%s) does not match its shape.",
+                input.name));
+      }
+      PADDLE_ENFORCE_GT(
+          request->rows,
+          0,
+          common::errors::InvalidArgument("The request has no rows."));
+    } catch (...) {
+      request->promise.set_exception(std::current_exception());
+      return future;
+    }
+    request->deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(options_.max_latency_us);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(std::move(request));
+    }
+    cond_.notify_one();
+    return future;
+  }
+
+ private:
+  struct Request {
+    // in the order of input_names_
+    std::vector<PaddleTensor> inputs;
+    int rows = 0;
+    std::chrono::steady_clock::time_point deadline;
+    std::promise<std::vector<PaddleTensor>> promise;
+  };
+  using RequestPtr = std::unique_ptr<Request>;
+
+  std::vector<PaddleTensor> SortInputs(std::vector<PaddleTensor> inputs) {
+    PADDLE_ENFORCE_EQ(inputs.size(),
+                      input_names_.size(),
+                      common::errors::InvalidArgument(
+                          "The model has (%d) inputs, but the request has "
+                          "(%d).",
+                          input_names_.size(),
+                          inputs.size()));
+    std::vector<PaddleTensor> sorted(input_names_.size());
+    for (size_t i = 0; i < input_names_.size(); ++i) {
+      auto iter = std::find_if(
+          inputs.begin(), inputs.end(), [&](const PaddleTensor& input) {
+            return input.name == input_names_[i];
+          });
+      PADDLE_ENFORCE_NE(iter,
+                        inputs.end(),
+                        common::errors::InvalidArgument(
+                            "The request has no input (%s).", input_names_[i]));
+      sorted[i] = std::move(*iter);
+    }
+    return sorted;
+  }
+
+  // Whether the requests can be merged into a batch.
+  bool Compatible(const Request& a, const Request& b) const {
+    for (size_t i = 0; i < a.inputs.size(); ++i) {
+      const PaddleTensor& x = a.inputs[i];
+      const PaddleTensor& y = b.inputs[i];
+      if (x.dtype != y.dtype || x.lod.size() != y.lod.size() ||
+          x.shape.size() != y.shape.size()) {
+        return false;
+      }
+      bool same_shape =
+          std::equal(x.shape.begin() + 1, x.shape.end(), y.shape.begin() + 1);
+      if (!same_shape && (!x.lod.empty() || !options_.enable_padding)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Only one worker forms a batch at a time, it takes the compatible requests
+  // until the batch is full or the first one is due.
+  std::vector<RequestPtr> NextBatch() {
+    std::lock_guard<std::mutex> batching_lock(batching_mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    std::vector<RequestPtr> batch;
+    if (queue_.empty()) {
+      return batch;
+    }
+    auto deadline = queue_.front()->deadline;
+    int rows = 0;
+    while (true) {
+      while (!queue_.empty() && rows < options_.max_batch_size) {
+        RequestPtr& request = queue_.front();
+        if (!batch.empty() &&
+            (rows + request->rows > options_.max_batch_size ||
+             !Compatible(*batch[0], *request))) {
+          return batch;
+        }
+        rows += request->rows;
+        batch.push_back(std::move(request));
+        queue_.pop_front();
+      }
+      if (rows >= options_.max_batch_size || stop_ ||
+          !cond_.wait_until(lock, deadline, [this] {
+            return stop_ || !queue_.empty();
+          })) {
+        return batch;
+      }
+    }
+  }
+
+  void Work(Predictor* predictor) {
+    while (true) {
+      std::vector<RequestPtr> batch = NextBatch();
+      if (batch.empty()) {
+        return;
+      }
+      try {
+        RunBatch(predictor, &batch);
+      } catch (...) {
+        for (auto& request : batch) {
+          request->promise.set_exception(std::current_exception());
+        }
+      }
+    }
+  }
+
+  PaddleTensor MergeInput(const std::vector<RequestPtr>& batch, size_t idx) {
+    const PaddleTensor& first = batch[0]->inputs[idx];
+    size_t element_size = ElementSize(first.dtype);
+    PaddleTensor merged;
+    merged.name = first.name;
+    merged.dtype = first.dtype;
+    merged.shape = first.shape;
+    merged.shape[0] = 0;
+    for (auto& request : batch) {
+      const PaddleTensor& input = request->inputs[idx];
+      merged.shape[0] += input.shape[0];
+      for (size_t i = 1; i < input.shape.size(); ++i) {
+        merged.shape[i] = std::max(merged.shape[i], input.shape[i]);
+      }
+    }
+    merged.data.Resize(Numel(merged.shape) * element_size);
+    char* dst = static_cast<char*>(merged.data.data());
+    if (!first.lod.empty()) {
+      // the lod of every request starts from 0, the levels are shifted by the
+      // sizes of their next levels before
+      merged.lod.assign(first.lod.size(), std::vector<size_t>(1, 0));
+      for (auto& request : batch) {
+        const PaddleTensor& input = request->inputs[idx];
+        for (size_t level = 0; level < input.lod.size(); ++level) {
+          size_t base = merged.lod[level].back();
+          for (size_t i = 1; i < input.lod[level].size(); ++i) {
+            merged.lod[level].push_back(base + input.lod[level][i]);
+          }
+        }
+      }
+    }
+    int64_t row_numel = Numel(merged.shape, 1);
+    if (Numel(merged.shape) != 0 && first.shape.size() > 1) {
+      bool padded = false;
+      for (auto& request : batch) {
+        padded |= Numel(request->inputs[idx].shape, 1) != row_numel;
+      }
+      if (padded) {
+        FillPadding(dst,
+                    Numel(merged.shape),
+                    merged.dtype,
+                    options_.padding_value);
+      }
+    }
+    for (auto& request : batch) {
+      const PaddleTensor& input = request->inputs[idx];
+      std::vector<int> dst_shape = merged.shape;
+      dst_shape[0] = input.shape[0];
+      if (Numel(input.shape, 1) == row_numel) {
+        memcpy(dst, input.data.data(), input.data.length());
+      } else if (Numel(input.shape) != 0) {
+        CopyPadded(static_cast<const char*>(input.data.data()),
+                   input.shape,
+                   dst,
+                   dst_shape,
+                   element_size);
+      }
+      dst += Numel(dst_shape) * element_size;
+    }
+    return merged;
+  }
+
+  // Splits the output of the batch by the lod or the rows of the requests,
+  // the outputs of the other shapes are given to every request.
+  void SplitOutput(const PaddleTensor& output,
+                   const std::vector<RequestPtr>& batch,
+                   int rows,
+                   std::vector<std::vector<PaddleTensor>>* outputs) {
+    size_t element_size = ElementSize(output.dtype);
+    bool by_lod = !output.lod.empty() &&
+                  static_cast<int>(output.lod[0].size()) - 1 == rows;
+    bool by_rows = !by_lod && !output.shape.empty() && output.shape[0] == rows;
+    if (!by_lod && !by_rows) {
+      for (auto& request_outputs : *outputs) {
+        request_outputs.push_back(output);
+      }
+      return;
+    }
+    int64_t row_bytes = Numel(output.shape, 1) * element_size;
+    size_t begin = 0;
+    for (size_t r = 0; r < batch.size(); ++r) {
+      size_t end = begin + batch[r]->rows;
+      PaddleTensor split;
+      split.name = output.name;
+      split.dtype = output.dtype;
+      split.shape = output.shape;
+      size_t row_begin = begin, row_end = end;
+      if (by_lod) {
+        // the offsets of the top level are mapped down to the rows
+        split.lod.resize(output.lod.size());
+        for (size_t level = 0; level < output.lod.size(); ++level) {
+          const auto& offsets = output.lod[level];
+          for (size_t i = row_begin; i <= row_end; ++i) {
+            split.lod[level].push_back(offsets[i] - offsets[row_begin]);
+          }
+          size_t next_begin = offsets[row_begin];
+          row_end = offsets[row_end];
+          row_begin = next_begin;
+        }
+      }
+      split.shape[0] = row_end - row_begin;
+      split.data.Resize(split.shape[0] * row_bytes);
+      memcpy(split.data.data(),
+             static_cast<const char*>(output.data.data()) +
+                 row_begin * row_bytes,
+             split.shape[0] * row_bytes);
+      (*outputs)[r].push_back(std::move(split));
+      begin = end;
+    }
+  }
+
+  void RunBatch(Predictor* predictor, std::vector<RequestPtr>* batch) {
+    int rows = 0;
+    for (auto& request : *batch) {
+      rows += request->rows;
+    }
+    for (size_t i = 0; i < input_names_.size(); ++i) {
+      PaddleTensor merged = MergeInput(*batch, i);
+      auto handle = predictor->GetInputHandle(input_names_[i]);
+      handle->Reshape(merged.shape);
+      CopyFromCpu(handle.get(), merged.dtype, merged.data.data());
+      if (!merged.lod.empty()) {
+        handle->SetLoD(merged.lod);
+      }
+    }
+    PADDLE_ENFORCE_EQ(
+        predictor->Run(),
+        true,
+        common::errors::PreconditionNotMet("Fail to run the batch."));
+    std::vector<std::vector<PaddleTensor>> outputs(batch->size());
+    for (auto& name : output_names_) {
+      auto handle = predictor->GetOutputHandle(name);
+      PaddleTensor output;
+      output.name = name;
+      output.dtype = handle->type();
+      output.shape = handle->shape();
+      output.lod = handle->lod();
+      output.data.Resize(Numel(output.shape) * ElementSize(output.dtype));
+      CopyToCpu(handle.get(), output.dtype, output.data.data());
+      SplitOutput(output, *batch, rows, &outputs);
+    }
+    for (size_t r = 0; r < batch->size(); ++r) {
+      (*batch)[r]->promise.set_value(std::move(outputs[r]));
+    }
+  }
+
+  BatchingOptions options_;
+  PredictorPool pool_;
+  std::vector<std::string> input_names_;
+  std::vector<std::string> output_names_;
+  std::mutex mutex_;
+  std::mutex batching_mutex_;
+  std::condition_variable cond_;
+  std::deque<RequestPtr> queue_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+BatchingPredictorPool::BatchingPredictorPool(const Config& config,
+                                             size_t size,
+                                             const BatchingOptions& options)
+    : impl_(new Impl(config, size, options)) {}
+
+BatchingPredictorPool::~BatchingPredictorPool() = default;
+
+std::future<std::vector<paddle::PaddleTensor>> BatchingPredictorPool::Submit(
+    std::vector<paddle::PaddleTensor> inputs) {
+  return impl_->Submit(std::move(inputs));
+}
+
+bool BatchingPredictorPool::Run(std::vector<paddle::PaddleTensor> inputs,
+                                std::vector<paddle::PaddleTensor>* outputs) {
+  try {
+    *outputs = Submit(std::move(inputs)).get();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "BatchingPredictorPool fails to run the request: "
+               << e.what();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace services
+}  // namespace paddle_infer
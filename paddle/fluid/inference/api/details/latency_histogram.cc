@@ -0,0 +1,165 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace paddle {
+namespace details {
+
+namespace {
+
+int HighestBit(uint64_t x) {
+#ifdef _MSC_VER
+  unsigned long index;  // NOLINT
+  _BitScanReverse64(&index, x);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(x);
+#endif
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+int LatencyHistogram::BucketIndex(uint64_t ns) {
+  if (ns < 2 * kSubBuckets) {
+    return static_cast<int>(ns);
+  }
+  int e = HighestBit(ns);
+  return (e - 4) * kSubBuckets + static_cast<int>(ns >> (e - 5)) - kSubBuckets;
+}
+
+uint64_t LatencyHistogram::BucketValue(int index) {
+  if (index < 2 * kSubBuckets) {
+    return index;
+  }
+  int shift = index / kSubBuckets - 1;
+  uint64_t low = static_cast<uint64_t>(index % kSubBuckets + kSubBuckets)
+                 << shift;
+  return low + (uint64_t{1} << (shift - 1));
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+  buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (ns > max &&
+         !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+paddle_infer::LatencyStats LatencyHistogram::Snapshot() const {
+  std::vector<uint64_t> counts(kNumBuckets);
+  uint64_t count = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    count += counts[i];
+  }
+  paddle_infer::LatencyStats stats;
+  if (count == 0) {
+    return stats;
+  }
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  auto percentile = [&](double q) {
+    uint64_t rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(BucketValue(i), max) / 1000.;
+      }
+    }
+    return max / 1000.;
+  };
+  stats.count = count;
+  stats.sum = sum_.load(std::memory_order_relaxed) / 1000.;
+  stats.mean = stats.sum / count;
+  stats.p50 = percentile(0.5);
+  stats.p99 = percentile(0.99);
+  stats.p999 = percentile(0.999);
+  stats.max = max / 1000.;
+  return stats;
+}
+
+const char* LatencyRecorder::StageName(Stage stage) {
+  static const char* names[kNumStages] = {"e2e", "h2d", "compute", "d2h"};
+  return names[stage];
+}
+
+void LatencyRecorder::Record(Stage stage,
+                             Clock::time_point begin,
+                             Clock::time_point end) {
+  auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+  histograms_[stage].Record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+}
+
+void LatencyRecorder::BeginRequest(Clock::time_point begin) {
+  if (in_request_ && !ran_) {
+    return;
+  }
+  if (in_request_) {
+    Record(kE2E, request_begin_, request_end_);
+  }
+  in_request_ = true;
+  ran_ = false;
+  request_begin_ = begin;
+}
+
+void LatencyRecorder::RecordCopyFromCpu(Clock::time_point begin,
+                                        Clock::time_point end) {
+  BeginRequest(begin);
+  Record(kH2D, begin, end);
+}
+
+void LatencyRecorder::RecordRun(Clock::time_point begin,
+                                Clock::time_point end) {
+  BeginRequest(begin);
+  Record(kCompute, begin, end);
+  ran_ = true;
+  request_end_ = end;
+}
+
+void LatencyRecorder::RecordCopyToCpu(Clock::time_point begin,
+                                      Clock::time_point end) {
+  Record(kD2H, begin, end);
+  if (ran_) {
+    request_end_ = end;
+  }
+}
+
+std::map<std::string, paddle_infer::LatencyStats> LatencyRecorder::Snapshot()
+    const {
+  std::map<std::string, paddle_infer::LatencyStats> stats;
+  for (int i = 0; i < kNumStages; ++i) {
+    stats[StageName(static_cast<Stage>(i))] = histograms_[i].Snapshot();
+  }
+  return stats;
+}
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+namespace details {
+
+// A log-linear histogram of the latencies in ns, 32 buckets per power of two,
+// so the percentiles are within 3% of the real ones. The records are lock
+// free, a snapshot may be taken while the predictor runs.
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBuckets = 32;
+  static constexpr int kNumBuckets = (64 - 4) * kSubBuckets;
+
+  LatencyHistogram();
+
+  void Record(uint64_t ns);
+
+  paddle_infer::LatencyStats Snapshot() const;
+
+  static int BucketIndex(uint64_t ns);
+  // the value of the middle of a bucket
+  static uint64_t BucketValue(int index);
+
+ private:
+  std::array<std::atomic<uint64_t>, kNumBuckets> buckets_;
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+// The latencies of the stages of the runs of a predictor. The runs on the
+// zero copy tensors are split by the copies: a request begins with its first
+// copy to the device, or with the run if there is none, and ends with the last
+// copy to the host after the run. It is accounted when the next one begins.
+class LatencyRecorder {
+ public:
+  enum Stage { kE2E = 0, kH2D, kCompute, kD2H, kNumStages };
+
+  using Clock = std::chrono::steady_clock;
+
+  static const char* StageName(Stage stage);
+
+  void Record(Stage stage, Clock::time_point begin, Clock::time_point end);
+
+  // the stages of a zero copy run
+  void RecordCopyFromCpu(Clock::time_point begin, Clock::time_point end);
+  void RecordRun(Clock::time_point begin, Clock::time_point end);
+  void RecordCopyToCpu(Clock::time_point begin, Clock::time_point end);
+
+  std::map<std::string, paddle_infer::LatencyStats> Snapshot() const;
+
+ private:
+  void BeginRequest(Clock::time_point begin);
+
+  std::array<LatencyHistogram, kNumStages> histograms_;
+
+  // a predictor is run by one thread at a time
+  bool in_request_{false};
+  bool ran_{false};
+  Clock::time_point request_begin_;
+  Clock::time_point request_end_;
+};
+
+}  // namespace details
+}  // namespace paddle
@@ -14,9 +14,11 @@
 
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_layout_transform.h"
+#include "paddle/fluid/framework/dlpack_tensor.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/string_array.h"
+#include "paddle/fluid/inference/api/details/latency_histogram.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
@@ -24,6 +26,12 @@
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/allocator.h"
+#include "paddle/phi/core/compat/convert_utils.h"
+#include "paddle/phi/core/kernel_factory.h"
+#include "paddle/phi/core/visit_type.h"
+#ifdef PADDLE_WITH_XPU
+#include "paddle/phi/backends/xpu/xpu_context.h"
+#endif
 #ifdef PADDLE_WITH_ONNXRUNTIME
 #include "onnxruntime_c_api.h"    // NOLINT
 #include "onnxruntime_cxx_api.h"  // NOLINT
@@ -34,6 +42,51 @@ namespace paddle_infer {
 using float16 = phi::dtype::float16;
 using bfloat16 = phi::dtype::bfloat16;
 
+namespace {
+
+// Times a copy of a tensor for the latency statistics of its predictor.
+class CopyTimer {
+ public:
+  CopyTimer(void *recorder, bool to_cpu)
+      : recorder_(static_cast<paddle::details::LatencyRecorder *>(recorder)),
+        to_cpu_(to_cpu) {
+    if (recorder_ != nullptr) {
+      begin_ = paddle::details::LatencyRecorder::Clock::now();
+    }
+  }
+
+  ~CopyTimer() {
+    if (recorder_ == nullptr) {
+      return;
+    }
+    auto end = paddle::details::LatencyRecorder::Clock::now();
+    if (to_cpu_) {
+      recorder_->RecordCopyToCpu(begin_, end);
+    } else {
+      recorder_->RecordCopyFromCpu(begin_, end);
+    }
+  }
+
+ private:
+  paddle::details::LatencyRecorder *recorder_;
+  bool to_cpu_;
+  paddle::details::LatencyRecorder::Clock::time_point begin_;
+};
+
+const phi::DeviceContext *GetDeviceContext(const void *device_contexts,
+                                           const phi::Place &place) {
+  auto *dev_ctxs = reinterpret_cast<const std::map<
+      phi::Place,
+      std::shared_future<std::unique_ptr<phi::DeviceContext>>> *>(
+      device_contexts);
+  if (dev_ctxs != nullptr && dev_ctxs->count(place)) {
+    return dev_ctxs->at(place).get().get();
+  }
+  return phi::DeviceContextPool::Instance().Get(place);
+}
+
+}  // namespace
+
 void Tensor::Reshape(const std::vector<int> &shape) {
 #ifdef PADDLE_WITH_ONNXRUNTIME
   if (is_ort_tensor_) {
@@ -202,6 +255,7 @@ void Tensor::CopyFromCpu(const T *data) {
                         "std::vector<int> &shape)"
                         "function before copying data from cpu."));
   size_t ele_size = tensor->numel() * sizeof(T);
+  CopyTimer timer(latency_recorder_, false);
 
   if (place_ == PlaceType::kCPU) {
     auto *t_data = tensor->mutable_data<T>(phi::CPUPlace());
@@ -233,11 +287,10 @@ void Tensor::CopyFromCpu(const T *data) {
 #ifdef PADDLE_WITH_XPU
     phi::XPUPlace xpu_place(device_);
     auto *t_data = tensor->mutable_data<T>(xpu_place);
-    paddle::memory::Copy(xpu_place,
-                         static_cast<void *>(t_data),
-                         phi::CPUPlace(),
-                         data,
-                         ele_size);
+    // on the copy-in stream, without waiting for the previous run
+    auto *dev_ctx = static_cast<const phi::XPUContext *>(
+        GetDeviceContext(device_contexts_, xpu_place));
+    dev_ctx->MemcpyH2DAsync(static_cast<void *>(t_data), data, ele_size);
 #else
     PADDLE_THROW(common::errors::Unavailable(
         "Can not create tensor with XPU place because paddle is not compiled "
@@ -367,6 +420,234 @@ void Tensor::ShareExternalData(const T *data,
   }
 }
 
+namespace {
+
+phi::DataType ToPhiDataType(DataType dtype) {
+  switch (dtype) {
+    case DataType::FLOAT32:
+      return phi::DataType::FLOAT32;
+    case DataType::INT64:
+      return phi::DataType::INT64;
+    case DataType::INT32:
+      return phi::DataType::INT32;
+    case DataType::UINT8:
+      return phi::DataType::UINT8;
+    case DataType::INT8:
+      return phi::DataType::INT8;
+    case DataType::FLOAT16:
+      return phi::DataType::FLOAT16;
+    case DataType::BOOL:
+      return phi::DataType::BOOL;
+    case DataType::FLOAT64:
+      return phi::DataType::FLOAT64;
+    case DataType::BFLOAT16:
+      return phi::DataType::BFLOAT16;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Unsupported data type %d.", static_cast<int>(dtype)));
+  }
+}
+
+DataType FromDLDataType(const ::DLDataType &type) {
+  PADDLE_ENFORCE_EQ(
+      type.lanes,
+      1,
+      common::errors::Unimplemented("The vectorized DLPack data types are not "
+                                    "supported, but received %d lanes.",
+                                    type.lanes));
+  if (type.code == kDLFloat && type.bits == 32) {
+    return DataType::FLOAT32;
+  } else if (type.code == kDLFloat && type.bits == 16) {
+    return DataType::FLOAT16;
+  } else if (type.code == kDLFloat && type.bits == 64) {
+    return DataType::FLOAT64;
+  } else if (type.code == kDLBfloat && type.bits == 16) {
+    return DataType::BFLOAT16;
+  } else if (type.code == kDLInt && type.bits == 64) {
+    return DataType::INT64;
+  } else if (type.code == kDLInt && type.bits == 32) {
+    return DataType::INT32;
+  } else if (type.code == kDLInt && type.bits == 8) {
+    return DataType::INT8;
+  } else if (type.code == kDLUInt && type.bits == 8) {
+    return DataType::UINT8;
+  }
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Unsupported DLPack data type, code %d and bits %d.",
+      type.code,
+      type.bits));
+}
+
+// Calls the deleter of the external data when paddle no longer uses it.
+class ExternalAllocation : public phi::Allocation {
+ public:
+  ExternalAllocation(void *data,
+                     size_t size,
+                     const phi::Place &place,
+                     std::function<void()> release)
+      : phi::Allocation(data, size, place), release_(std::move(release)) {}
+
+  ~ExternalAllocation() override {
+    if (release_) {
+      release_();
+    }
+  }
+
+ private:
+  std::function<void()> release_;
+};
+
+}  // namespace
+
+void Tensor::ShareExternalData(const void *data,
+                               const std::vector<int64_t> &shape,
+                               const std::vector<int64_t> &strides,
+                               DataType dtype,
+                               DataType input_dtype,
+                               PlaceType place,
+                               std::function<void()> deleter) {
+  EAGER_GET_TENSOR(phi::DenseTensor)
+  PADDLE_ENFORCE_EQ(
+      strides.empty() || strides.size() == shape.size(),
+      true,
+      common::errors::InvalidArgument(
+          "The rank of the strides (%d) should be the same as the one of the "
+          "shape (%d).",
+          strides.size(),
+          shape.size()));
+  phi::Place data_place;
+  if (place == PlaceType::kCPU) {
+    data_place = phi::CPUPlace();
+  } else if (place == PlaceType::kGPU) {
+    data_place = phi::GPUPlace(device_);
+  } else if (place == PlaceType::kXPU) {
+    data_place = phi::XPUPlace(device_);
+  } else if (place == PlaceType::kCUSTOM) {
+    data_place = phi::CustomPlace(device_type_, device_);
+  } else {
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "PlaceType must be one of [PlaceType::kCPU, PlaceType::kGPU, "
+        "PlaceType::kXPU]."));
+  }
+  phi::DDim dims = common::make_ddim(shape);
+  phi::DDim data_strides = strides.empty()
+                               ? phi::DenseTensorMeta::calc_strides(dims)
+                               : common::make_ddim(strides);
+  // the elements spanned by the strides
+  int64_t span = 1;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    PADDLE_ENFORCE_GE(data_strides[i],
+                      0,
+                      common::errors::InvalidArgument(
+                          "The negative strides are not supported."));
+    if (shape[i] == 0) {
+      span = 0;
+      break;
+    }
+    span += (shape[i] - 1) * data_strides[i];
+  }
+  phi::DenseTensorMeta meta(ToPhiDataType(dtype), dims, data_strides);
+  size_t size = span * phi::SizeOf(meta.dtype);
+  phi::DenseTensor src(
+      std::make_shared<ExternalAllocation>(
+          const_cast<void *>(data), size, data_place, std::move(deleter)),
+      meta);
+  phi::DataType target_dtype = ToPhiDataType(input_dtype);
+  if (src.meta().is_contiguous() && src.dtype() == target_dtype) {
+    *tensor = std::move(src);
+    return;
+  }
+
+  auto *dev_ctx = GetDeviceContext(device_contexts_, data_place);
+  phi::DenseTensor out = src;
+  if (!out.meta().is_contiguous()) {
+    using contiguous_signature = void (*)(const phi::DeviceContext &,
+                                          const phi::DenseTensor &,
+                                          phi::DenseTensor *);
+    phi::DenseTensor contiguous;
+    PD_VISIT_KERNEL("contiguous",
+                    phi::KernelKey(phi::TransToPhiBackend(data_place),
+                                   phi::DataLayout::ALL_LAYOUT,
+                                   out.dtype()),
+                    contiguous_signature,
+                    false,
+                    *dev_ctx,
+                    out,
+                    &contiguous);
+    out = std::move(contiguous);
+  }
+  if (out.dtype() != target_dtype) {
+    using cast_signature = void (*)(const phi::DeviceContext &,
+                                    const phi::DenseTensor &,
+                                    phi::DataType,
+                                    phi::DenseTensor *);
+    phi::DenseTensor cast;
+    cast.Resize(out.dims());
+    PD_VISIT_KERNEL("cast",
+                    phi::KernelKey(phi::TransToPhiBackend(data_place),
+                                   phi::DataLayout::ALL_LAYOUT,
+                                   out.dtype()),
+                    cast_signature,
+                    false,
+                    *dev_ctx,
+                    out,
+                    target_dtype,
+                    &cast);
+    out = std::move(cast);
+  }
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (data_place.GetType() == phi::AllocationType::GPU) {
+    // the data is released when the kernels reading it complete
+    static_cast<const phi::GPUContext *>(dev_ctx)->AddStreamCallback(
+        [holder = src.Holder()] {});
+  }
+#endif
+  *tensor = std::move(out);
+}
+
+void Tensor::ShareDLPack(void *dl_managed_tensor, DataType input_dtype) {
+  auto *dl_managed = static_cast<::DLManagedTensor *>(dl_managed_tensor);
+  PADDLE_ENFORCE_NOT_NULL(
+      dl_managed,
+      common::errors::InvalidArgument("The DLPack tensor should not be null."));
+  const ::DLTensor &dl_tensor = dl_managed->dl_tensor;
+  PlaceType place = PlaceType::kUNK;
+  if (dl_tensor.device.device_type == kDLCPU) {
+    place = PlaceType::kCPU;
+  } else if (dl_tensor.device.device_type == kDLGPU) {
+    PADDLE_ENFORCE_EQ(dl_tensor.device.device_id,
+                      device_,
+                      common::errors::InvalidArgument(
+                          "The DLPack tensor is on the GPU %d, but the "
+                          "predictor runs on the GPU %d.",
+                          dl_tensor.device.device_id,
+                          device_));
+    place = PlaceType::kGPU;
+  } else {
+    PADDLE_THROW(common::errors::Unimplemented(
+        "Only the DLPack tensors on CPU and GPU are supported, but received "
+        "the device type %d.",
+        dl_tensor.device.device_type));
+  }
+  std::vector<int64_t> shape(dl_tensor.shape, dl_tensor.shape + dl_tensor.ndim);
+  std::vector<int64_t> strides;
+  if (dl_tensor.strides != nullptr) {
+    strides.assign(dl_tensor.strides, dl_tensor.strides + dl_tensor.ndim);
+  }
+  ShareExternalData(
+      static_cast<const char *>(dl_tensor.data) + dl_tensor.byte_offset,
+      shape,
+      strides,
+      FromDLDataType(dl_tensor.dtype),
+      input_dtype,
+      place,
+      [dl_managed] {
+        if (dl_managed->deleter != nullptr) {
+          dl_managed->deleter(dl_managed);
+        }
+      });
+}
+
 void Tensor::CopyStringsFromCpu(const paddle_infer::Strings *data) {
   EAGER_GET_TENSOR(paddle::framework::Strings);
   PADDLE_ENFORCE_GE(tensor->size(),
@@ -453,12 +734,19 @@ void Tensor::CopyToCpuImpl(T *data,
 #endif
   } else if (place_ == PlaceType::kXPU) {
 #ifdef PADDLE_WITH_XPU
-    auto xpu_place = t_place;
-    paddle::memory::Copy(phi::CPUPlace(),
-                         static_cast<void *>(data),
-                         xpu_place,
-                         t_data,
-                         ele_num * sizeof(T));
+    auto *dev_ctx = static_cast<const phi::XPUContext *>(
+        GetDeviceContext(device_contexts_, t_place));
+    dev_ctx->MemcpyD2HAsync(
+        static_cast<void *>(data), t_data, ele_num * sizeof(T));
+    // async, return the copy-out stream
+    if (nullptr != exec_stream) {
+      *(static_cast<XPUStream *>(exec_stream)) = dev_ctx->d2h_stream();
+    } else {
+      dev_ctx->WaitD2H();
+      if (cb) {
+        cb(cb_params);
+      }
+    }
 #else
     PADDLE_THROW(common::errors::Unavailable(
         "Can not create tensor with XPU place because paddle is not compiled "
@@ -493,6 +781,7 @@ void Tensor::CopyToCpu(T *data) const {
   }
 #endif
 
+  CopyTimer timer(latency_recorder_, true);
   CopyToCpuImpl<T>(data, nullptr, nullptr, nullptr);
 }
 
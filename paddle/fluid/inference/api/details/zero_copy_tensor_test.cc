@@ -20,6 +20,7 @@
 #include <limits>
 #include <memory>
 #include <random>
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/scope.h"
@@ -152,4 +153,45 @@ TEST(Tensor, FillRandomDataAndCheck) {
 #endif
 }
 
+TEST(Tensor, ShareExternalDataWithStrides) {
+  paddle::framework::Scope scope;
+  const std::string name{"name"};
+  scope.Var(name);
+  auto tensor = CreateTensor(PlaceType::kCPU, &scope, name);
+
+  // contiguous and of the input data type, shared without copy
+  std::vector<float> data{0, 1, 2, 3, 4, 5};
+  bool data_released = false;
+  tensor->ShareExternalData(data.data(),
+                            {2, 3},
+                            {},
+                            DataType::FLOAT32,
+                            DataType::FLOAT32,
+                            PlaceType::kCPU,
+                            [&data_released] { data_released = true; });
+  PlaceType place{PlaceType::kUNK};
+  int size{-1};
+  ASSERT_EQ(tensor->data<float>(&place, &size), data.data());
+  ASSERT_EQ(size, 6);
+  ASSERT_FALSE(data_released);
+
+  // a 1x2 HWC uint8 image bound to a CHW float input
+  std::vector<uint8_t> image{0, 1, 2, 3, 4, 5};
+  bool image_released = false;
+  tensor->ShareExternalData(image.data(),
+                            {3, 1, 2},
+                            {1, 6, 3},
+                            DataType::UINT8,
+                            DataType::FLOAT32,
+                            PlaceType::kCPU,
+                            [&image_released] { image_released = true; });
+  ASSERT_TRUE(data_released);
+  ASSERT_TRUE(image_released);
+  ASSERT_EQ(tensor->shape(), (std::vector<int>{3, 1, 2}));
+  ASSERT_EQ(tensor->type(), DataType::FLOAT32);
+  std::vector<float> out(6);
+  tensor->CopyToCpu<float>(out.data());
+  ASSERT_EQ(out, (std::vector<float>{0, 3, 1, 4, 2, 5}));
+}
+
 }  // namespace paddle_infer
@@ -242,10 +242,14 @@ void InferXPUContext::L3CacheAutotune() {
       return;
     }
     auto* plan = l3_plan_.plan();
+    auto* offsets = l3_plan_.offsets();
     int8_t* cur_l3_ptr = reinterpret_cast<int8_t*>(l3_ptr_);
     for (size_t i = 0; i < l3_blocks_.size(); i++) {
       size_t block_size = plan->at(i);
       if (block_size > 0) {
+        if (!offsets->empty()) {
+          cur_l3_ptr = reinterpret_cast<int8_t*>(l3_ptr_) + offsets->at(i);
+        }
         l3_blocks_[i]->Set(cur_l3_ptr, block_size);
         cur_l3_ptr += block_size;
       }
@@ -282,6 +286,21 @@ void InferXPUContext::L3CacheAutotune() {
   }
 }
 
+void InferXPUContext::RecordHolderLiveRanges(
+    const std::unordered_map<phi::Allocation*, std::pair<size_t, size_t>>&
+        live_ranges) {
+  if (!NeedHolderLiveRanges()) return;
+  for (auto& holder_l3_block : holder_l3_blocks_) {
+    // the outputs are read after the run
+    if (output_holder_set_.count(holder_l3_block.first)) continue;
+    auto it = live_ranges.find(holder_l3_block.first);
+    if (it != live_ranges.end()) {
+      holder_l3_block.second->RecordLiveRange(it->second.first,
+                                              it->second.second);
+    }
+  }
+}
+
 void InferXPUContext::SetOutHolder(phi::Allocation* holder) {
   output_holder_set_.insert(holder);
 }
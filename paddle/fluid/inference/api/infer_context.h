@@ -70,6 +70,18 @@ class InferXPUContext : public phi::XPUContext {
 
   void L3CacheAutotune();
 
+  // Records the [first, last] positions in the execution order of the
+  // instructions accessing each holder, so that the L3 space is shared by
+  // the blocks that are not live at the same time. It only takes effect
+  // before the L3 is planned.
+  void RecordHolderLiveRanges(
+      const std::unordered_map<phi::Allocation*, std::pair<size_t, size_t>>&
+          live_ranges);
+
+  bool NeedHolderLiveRanges() const {
+    return l3_autotune_size_ > 0 && holder_map_.empty();
+  }
+
   void SetConvAutotuneInfo(std::string conv_autotune_file,
                            int conv_autotune_level,
                            bool conv_autotune_file_writeback,
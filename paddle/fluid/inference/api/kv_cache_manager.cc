@@ -0,0 +1,470 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/common/place.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+uint64_t HashBlock(uint64_t parent_hash, const int64_t* tokens, int size) {
+  // the hash of a block covers all the tokens of the prefix before it
+  uint64_t hash = parent_hash ^ 0x9e3779b97f4a7c15ULL;
+  for (int i = 0; i < size; ++i) {
+    hash ^= static_cast<uint64_t>(tokens[i]) + 0x9e3779b97f4a7c15ULL +
+            (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+}  // namespace
+
+class KVCacheManager::Impl {
+ public:
+  explicit Impl(const KVCacheOptions& options)
+      : options_(options), blocks_(options.num_blocks) {
+    PADDLE_ENFORCE_GT(
+        options_.num_blocks,
+        0,
+        common::errors::InvalidArgument(
+            "The num_blocks of KVCacheManager should be positive."));
+    PADDLE_ENFORCE_GT(
+        options_.block_size,
+        0,
+        common::errors::InvalidArgument(
+            "The block_size of KVCacheManager should be positive."));
+    if (options_.place == PlaceType::kGPU) {
+      place_ = phi::GPUPlace(options_.device_id);
+    } else {
+      PADDLE_ENFORCE_EQ(options_.place,
+                        PlaceType::kCPU,
+                        common::errors::InvalidArgument(
+                            "KVCacheManager only supports the gpu and the "
+                            "cpu places."));
+      place_ = phi::CPUPlace();
+    }
+    block_bytes_ = static_cast<size_t>(options_.num_heads) *
+                   options_.block_size * options_.head_dim *
+                   GetNumBytesOfDataType(options_.dtype);
+    for (int i = 0; i < 2 * options_.num_layers; ++i) {
+      caches_.push_back(
+          paddle::memory::Alloc(place_, block_bytes_ * options_.num_blocks));
+    }
+    for (int i = 0; i < options_.num_blocks; ++i) {
+      free_.push_back(i);
+    }
+    VLOG(3) << "KVCacheManager allocates " << options_.num_blocks
+            << " blocks of " << block_bytes_ << " bytes for "
+            << options_.num_layers << " layers";
+  }
+
+  int AddSequence(int64_t seq_id, const std::vector<int64_t>& prompt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE_EQ(seqs_.count(seq_id),
+                      0,
+                      common::errors::AlreadyExists(
+                          "The sequence %d is already added.", seq_id));
+    int block_size = options_.block_size;
+    int num_tokens = prompt.size();
+    int num_blocks = (num_tokens + block_size - 1) / block_size;
+    int num_full_blocks = num_tokens / block_size;
+    if (num_blocks > options_.max_blocks_per_seq) {
+      return -1;
+    }
+    Sequence seq;
+    // The last prompt token is always computed for its logits, so the block
+    // holding it is never shared.
+    int max_shared = num_tokens > 0 ? (num_tokens - 1) / block_size : 0;
+    uint64_t hash = 0;
+    std::vector<uint64_t> hashes(num_full_blocks);
+    for (int i = 0; i < num_full_blocks; ++i) {
+      hash = HashBlock(hash, prompt.data() + i * block_size, block_size);
+      hashes[i] = hash;
+    }
+    for (int i = 0; i < max_shared; ++i) {
+      auto iter = prefix_.find(hashes[i]);
+      if (iter == prefix_.end() || !blocks_[iter->second].ready) {
+        break;
+      }
+      Acquire(iter->second);
+      seq.blocks.push_back(iter->second);
+    }
+    int num_shared = seq.blocks.size();
+    if (NumFree() < static_cast<size_t>(num_blocks - num_shared)) {
+      for (int block : seq.blocks) {
+        Release(block);
+      }
+      return -1;
+    }
+    for (int i = num_shared; i < num_blocks; ++i) {
+      int block = Allocate();
+      seq.blocks.push_back(block);
+      if (i < num_full_blocks && prefix_.count(hashes[i]) == 0) {
+        // shared once a run writes it
+        blocks_[block].hash = hashes[i];
+        blocks_[block].cached = true;
+        prefix_[hashes[i]] = block;
+        seq.pending.push_back(block);
+      }
+    }
+    seq.num_tokens = num_tokens;
+    seqs_[seq_id] = std::move(seq);
+    return num_shared * block_size;
+  }
+
+  bool ForkSequence(int64_t parent_id, int64_t seq_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE_EQ(seqs_.count(seq_id),
+                      0,
+                      common::errors::AlreadyExists(
+                          "The sequence %d is already added.", seq_id));
+    auto iter = seqs_.find(parent_id);
+    if (iter == seqs_.end()) {
+      return false;
+    }
+    Sequence seq;
+    seq.blocks = iter->second.blocks;
+    seq.num_tokens = iter->second.num_tokens;
+    for (int block : seq.blocks) {
+      Acquire(block);
+    }
+    seqs_[seq_id] = std::move(seq);
+    return true;
+  }
+
+  bool Append(int64_t seq_id, int num_tokens) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sequence& seq = GetSequence(seq_id);
+    int block_size = options_.block_size;
+    int new_num_tokens = seq.num_tokens + num_tokens;
+    int num_blocks = (new_num_tokens + block_size - 1) / block_size;
+    if (num_blocks > options_.max_blocks_per_seq) {
+      return false;
+    }
+    // the next token is written into the last block if it is not full
+    bool copy_last = seq.num_tokens % block_size != 0 &&
+                     blocks_[seq.blocks.back()].ref > 1;
+    size_t needed = num_blocks - seq.blocks.size() + (copy_last ? 1 : 0);
+    if (NumFree() < needed) {
+      return false;
+    }
+    if (copy_last) {
+      int block = Allocate();
+      CopyBlock(seq.blocks.back(), block);
+      Release(seq.blocks.back());
+      seq.blocks.back() = block;
+    }
+    while (seq.blocks.size() < static_cast<size_t>(num_blocks)) {
+      seq.blocks.push_back(Allocate());
+    }
+    seq.num_tokens = new_num_tokens;
+    return true;
+  }
+
+  void Truncate(int64_t seq_id, int num_tokens) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Sequence& seq = GetSequence(seq_id);
+    PADDLE_ENFORCE_EQ(
+        num_tokens >= 0 && num_tokens <= seq.num_tokens,
+        true,
+        common::errors::InvalidArgument(
+            "The sequence %d of %d tokens can not be truncated to %d tokens.",
+            seq_id,
+            seq.num_tokens,
+            num_tokens));
+    int block_size = options_.block_size;
+    size_t num_blocks = (num_tokens + block_size - 1) / block_size;
+    while (seq.blocks.size() > num_blocks) {
+      int block = seq.blocks.back();
+      seq.blocks.pop_back();
+      seq.pending.erase(
+          std::remove(seq.pending.begin(), seq.pending.end(), block),
+          seq.pending.end());
+      Release(block);
+    }
+    // The tokens after num_tokens in the last block are overwritten later, so
+    // it can not stay a cached prefix block. A shared one is copied before the
+    // write by Append.
+    if (num_tokens % block_size != 0) {
+      int block = seq.blocks.back();
+      Block& b = blocks_[block];
+      if (b.cached && b.ref == 1) {
+        prefix_.erase(b.hash);
+        b.cached = false;
+        b.ready = false;
+        seq.pending.erase(
+            std::remove(seq.pending.begin(), seq.pending.end(), block),
+            seq.pending.end());
+      }
+    }
+    seq.num_tokens = num_tokens;
+  }
+
+  void FreeSequence(int64_t seq_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = seqs_.find(seq_id);
+    if (iter == seqs_.end()) {
+      return;
+    }
+    for (int block : iter->second.blocks) {
+      Release(block);
+    }
+    seqs_.erase(iter);
+  }
+
+  int NumTokens(int64_t seq_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetSequence(seq_id).num_tokens;
+  }
+
+  int NumFreeBlocks() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return NumFree();
+  }
+
+  std::vector<int> BlockTable(int64_t seq_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return GetSequence(seq_id).blocks;
+  }
+
+  bool Run(Predictor* predictor, const std::vector<int64_t>& seq_ids) {
+    std::vector<int> block_tables(seq_ids.size() * options_.max_blocks_per_seq,
+                                  -1);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < seq_ids.size(); ++i) {
+        const Sequence& seq = GetSequence(seq_ids[i]);
+        std::copy(seq.blocks.begin(),
+                  seq.blocks.end(),
+                  block_tables.begin() + i * options_.max_blocks_per_seq);
+      }
+    }
+    auto block_tables_t = predictor->GetInputHandle(options_.block_tables_name);
+    block_tables_t->Reshape({static_cast<int>(seq_ids.size()),
+                             options_.max_blocks_per_seq});
+    block_tables_t->CopyFromCpu(block_tables.data());
+    std::vector<int> shape = {options_.num_blocks,
+                              options_.num_heads,
+                              options_.block_size,
+                              options_.head_dim};
+    for (int i = 0; i < options_.num_layers; ++i) {
+      ShareCache(predictor->GetInputHandle(options_.key_cache_prefix +
+                                           std::to_string(i)),
+                 caches_[2 * i]->ptr(),
+                 shape);
+      ShareCache(predictor->GetInputHandle(options_.value_cache_prefix +
+                                           std::to_string(i)),
+                 caches_[2 * i + 1]->ptr(),
+                 shape);
+    }
+    if (!predictor->Run()) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int64_t seq_id : seq_ids) {
+      Sequence& seq = GetSequence(seq_id);
+      for (int block : seq.pending) {
+        blocks_[block].ready = true;
+      }
+      seq.pending.clear();
+    }
+    return true;
+  }
+
+ private:
+  struct Block {
+    int ref{0};
+    // Whether the block is in the prefix_, and whether it is written.
+    bool cached{false};
+    bool ready{false};
+    uint64_t hash{0};
+    std::list<int>::iterator lru;
+  };
+
+  struct Sequence {
+    std::vector<int> blocks;
+    int num_tokens{0};
+    // The prompt blocks shared after the next run.
+    std::vector<int> pending;
+  };
+
+  Sequence& GetSequence(int64_t seq_id) {
+    auto iter = seqs_.find(seq_id);
+    PADDLE_ENFORCE_NE(
+        iter,
+        seqs_.end(),
+        common::errors::NotFound("The sequence %d is not found.", seq_id));
+    return iter->second;
+  }
+
+  size_t NumFree() const { return free_.size() + evictable_.size(); }
+
+  // Takes a free block, or evicts the least recently used cached one.
+  int Allocate() {
+    int block;
+    if (!free_.empty()) {
+      block = free_.front();
+      free_.pop_front();
+    } else {
+      block = evictable_.front();
+      evictable_.pop_front();
+      prefix_.erase(blocks_[block].hash);
+      blocks_[block] = Block();
+    }
+    blocks_[block].ref = 1;
+    return block;
+  }
+
+  void Acquire(int block) {
+    if (blocks_[block].ref == 0) {
+      evictable_.erase(blocks_[block].lru);
+    }
+    ++blocks_[block].ref;
+  }
+
+  void Release(int block) {
+    Block& b = blocks_[block];
+    if (--b.ref > 0) {
+      return;
+    }
+    if (b.cached && b.ready) {
+      b.lru = evictable_.insert(evictable_.end(), block);
+      return;
+    }
+    if (b.cached) {
+      prefix_.erase(b.hash);
+    }
+    b = Block();
+    free_.push_back(block);
+  }
+
+  void CopyBlock(int src, int dst) {
+    for (auto& cache : caches_) {
+      char* base = static_cast<char*>(cache->ptr());
+      paddle::memory::Copy(place_,
+                           base + dst * block_bytes_,
+                           place_,
+                           base + src * block_bytes_,
+                           block_bytes_);
+    }
+  }
+
+  void ShareCache(std::unique_ptr<Tensor> tensor,
+                  void* data,
+                  const std::vector<int>& shape) {
+    switch (options_.dtype) {
+      case DataType::FLOAT32:
+        tensor->ShareExternalData(
+            static_cast<float*>(data), shape, options_.place);
+        break;
+      case DataType::FLOAT16:
+        tensor->ShareExternalData(
+            static_cast<phi::dtype::float16*>(data), shape, options_.place);
+        break;
+      case DataType::BFLOAT16:
+        tensor->ShareExternalData(
+            static_cast<phi::dtype::bfloat16*>(data), shape, options_.place);
+        break;
+      case DataType::INT8:
+        tensor->ShareExternalData(
+            static_cast<int8_t*>(data), shape, options_.place);
+        break;
+      case DataType::UINT8:
+        tensor->ShareExternalData(
+            static_cast<uint8_t*>(data), shape, options_.place);
+        break;
+      default:
+        PADDLE_THROW(common::errors::Unimplemented(
+            "Unsupported data type (%d) of the kv cache.",
+            static_cast<int>(options_.dtype)));
+    }
+  }
+
+  KVCacheOptions options_;
+  phi::Place place_;
+  size_t block_bytes_{0};
+  // The key and the value caches of every layer.
+  std::vector<paddle::memory::AllocationPtr> caches_;
+
+  std::mutex mutex_;
+  std::vector<Block> blocks_;
+  std::deque<int> free_;
+  // The cached blocks not used by any sequence, the least recently freed
+  // first.
+  std::list<int> evictable_;
+  std::unordered_map<uint64_t, int> prefix_;
+  std::unordered_map<int64_t, Sequence> seqs_;
+};
+
+KVCacheManager::KVCacheManager(const KVCacheOptions& options)
+    : impl_(new Impl(options)) {}
+
+KVCacheManager::~KVCacheManager() = default;
+
+int KVCacheManager::AddSequence(int64_t seq_id,
+                                const std::vector<int64_t>& prompt) {
+  return impl_->AddSequence(seq_id, prompt);
+}
+
+bool KVCacheManager::ForkSequence(int64_t parent_id, int64_t seq_id) {
+  return impl_->ForkSequence(parent_id, seq_id);
+}
+
+bool KVCacheManager::Append(int64_t seq_id, int num_tokens) {
+  return impl_->Append(seq_id, num_tokens);
+}
+
+void KVCacheManager::Truncate(int64_t seq_id, int num_tokens) {
+  impl_->Truncate(seq_id, num_tokens);
+}
+
+void KVCacheManager::FreeSequence(int64_t seq_id) {
+  impl_->FreeSequence(seq_id);
+}
+
+int KVCacheManager::NumTokens(int64_t seq_id) const {
+  return impl_->NumTokens(seq_id);
+}
+
+int KVCacheManager::NumFreeBlocks() const { return impl_->NumFreeBlocks(); }
+
+std::vector<int> KVCacheManager::BlockTable(int64_t seq_id) const {
+  return impl_->BlockTable(seq_id);
+}
+
+bool KVCacheManager::Run(Predictor* predictor,
+                         const std::vector<int64_t>& seq_ids) {
+  return impl_->Run(predictor, seq_ids);
+}
+
+}  // namespace services
+}  // namespace paddle_infer
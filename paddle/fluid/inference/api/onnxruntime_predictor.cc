@@ -36,6 +36,7 @@
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/phi/common/data_type.h"
 #include "paddle/phi/common/place.h"
 
 namespace paddle {
@@ -60,6 +61,29 @@ paddle_infer::DataType ConvertONNXType(ONNXTensorElementDataType type) {
   }
 }
 
+phi::DataType ConvertONNXTypeToPhi(ONNXTensorElementDataType type) {
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+      return phi::DataType::FLOAT32;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+      return phi::DataType::FLOAT16;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+      return phi::DataType::FLOAT64;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+      return phi::DataType::INT8;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+      return phi::DataType::INT32;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+      return phi::DataType::INT64;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+      return phi::DataType::UINT8;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+      return phi::DataType::BOOL;
+    default:
+      return phi::DataType::UNDEFINED;
+  }
+}
+
 bool CheckConvertToONNX(const AnalysisConfig &config) {
   if (!config.model_dir().empty()) {
     LOG(ERROR) << "Paddle2ONNX not support model_dir config";
@@ -118,6 +142,7 @@ bool ONNXRuntimePredictor::InitBinding() {
 
     allocator.Free(input_name);
   }
+  bound_inputs_.assign(n_inputs, ONNXBoundInput());
 
   size_t n_outputs = session_->GetOutputCount();
   for (size_t i = 0; i < n_outputs; ++i) {
@@ -133,7 +158,30 @@ bool ONNXRuntimePredictor::InitBinding() {
                                     OrtDeviceAllocator,
                                     place_.GetDeviceId(),
                                     OrtMemTypeDefault);
-    binding_->BindOutput(output_name, out_memory_info);
+    phi::DataType dtype = ConvertONNXTypeToPhi(data_type);
+    bool in_scope =
+        dtype != phi::DataType::UNDEFINED &&
+        std::all_of(shape.begin(), shape.end(), [](int64_t dim) {
+          return dim > 0;
+        });
+    if (in_scope) {
+      auto *ptr = scope_->Var(output_name);
+      framework::InitializeVariable(ptr, proto_type);
+      auto *tensor = ptr->GetMutable<phi::DenseTensor>();
+      tensor->Resize(common::make_ddim(shape));
+      void *data = tensor->mutable_data(place_, dtype);
+      size_t size = tensor->numel() * phi::SizeOf(dtype);
+      binding_->BindOutput(output_name,
+                           Ort::Value::CreateTensor(out_memory_info,
+                                                    data,
+                                                    size,
+                                                    shape.data(),
+                                                    shape.size(),
+                                                    data_type));
+    } else {
+      binding_->BindOutput(output_name, out_memory_info);
+    }
+    output_in_scope_.push_back(in_scope);
 
     allocator.Free(output_name);
   }
@@ -287,7 +335,12 @@ std::unique_ptr<ZeroCopyTensor> ONNXRuntimePredictor::GetOutputTensor(
                         "The out variable named %s is not found in the "
                         "ONNXPredictor.",
                         name));
-  std::unique_ptr<ZeroCopyTensor> res(new ZeroCopyTensor(nullptr, this));
+  int idx = 0;
+  while (output_desc_[idx].name != name) ++idx;
+  // the outputs written into scope_ are read like the ones of the analysis
+  // predictor, without going through the binding
+  void *scope = output_in_scope_[idx] ? scope_.get() : nullptr;
+  std::unique_ptr<ZeroCopyTensor> res(new ZeroCopyTensor(scope, this));
   res->input_or_output_ = false;
   res->SetName(name);
   if (phi::is_cpu_place(place_)) {
@@ -296,15 +349,12 @@ std::unique_ptr<ZeroCopyTensor> ONNXRuntimePredictor::GetOutputTensor(
     auto gpu_place = place_;
     res->SetPlace(PaddlePlace::kGPU, gpu_place.GetDeviceId());
   }
-  res->SetOrtMark(true);
-  res->SetOrtBinding(binding_);
-  int size = output_desc_.size();
-  for (int i = 0; i < size; ++i)
-    if (output_desc_[i].name == name) {
-      res->idx_ = i;
-      res->dtype_ = ConvertONNXType(output_desc_[i].dtype);
-      break;
-    }
+  if (!output_in_scope_[idx]) {
+    res->SetOrtMark(true);
+    res->SetOrtBinding(binding_);
+    res->idx_ = idx;
+    res->dtype_ = ConvertONNXType(output_desc_[idx].dtype);
+  }
   return res;
 }
 
@@ -326,6 +376,23 @@ Ort::Value ONNXRuntimePredictor::GetOrtValue(const ONNXDesc &desc,
                                   desc.dtype);
 }
 
+void ONNXRuntimePredictor::BindInputs(const char *device_name) {
+  for (size_t i = 0; i < input_desc_.size(); ++i) {
+    const auto &desc = input_desc_[i];
+    auto *tensor = scope_->FindVar(desc.name)->GetMutable<phi::DenseTensor>();
+    std::vector<int64_t> shape = common::vectorize<int64_t>(tensor->dims());
+    auto &bound = bound_inputs_[i];
+    if (bound.data != nullptr && bound.data == tensor->data() &&
+        bound.shape == shape) {
+      continue;
+    }
+    // the binding keeps the value, which points to the memory of the tensor
+    binding_->BindInput(desc.name.c_str(), GetOrtValue(desc, device_name));
+    bound.data = tensor->data();
+    bound.shape = std::move(shape);
+  }
+}
+
 bool ONNXRuntimePredictor::Run(const std::vector<PaddleTensor> &inputs,
                                std::vector<PaddleTensor> *output_data,
                                int batch_size) {
@@ -336,18 +403,14 @@ bool ONNXRuntimePredictor::Run(const std::vector<PaddleTensor> &inputs,
 bool ONNXRuntimePredictor::ZeroCopyRun(bool switch_stream) {
   try {
     const char *device_name = phi::is_cpu_place(place_) ? "Cpu" : "Cuda";
-    std::vector<Ort::Value> inputs;
-    inputs.reserve(input_desc_.size());
-    for (auto desc : input_desc_) {
-      inputs.push_back(GetOrtValue(desc, device_name));
-      binding_->BindInput(desc.name.c_str(), inputs.back());
-    }
-    for (auto output : output_desc_) {
+    BindInputs(device_name);
+    for (size_t i = 0; i < output_desc_.size(); ++i) {
+      if (output_in_scope_[i]) continue;
       Ort::MemoryInfo out_memory_info(device_name,
                                       OrtDeviceAllocator,
                                       place_.GetDeviceId(),
                                       OrtMemTypeDefault);
-      binding_->BindOutput(output.name.c_str(), out_memory_info);
+      binding_->BindOutput(output_desc_[i].name.c_str(), out_memory_info);
     }
     session_->Run({}, *(binding_.get()));
   } catch (const std::exception &e) {
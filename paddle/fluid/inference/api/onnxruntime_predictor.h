@@ -55,6 +55,13 @@ struct ONNXDesc {
   ONNXTensorElementDataType dtype;
 };
 
+// The memory and the shape of an input in its binding, which is kept for the
+// following runs as long as neither of them changes.
+struct ONNXBoundInput {
+  const void *data{nullptr};
+  std::vector<int64_t> shape;
+};
+
 ///
 /// \class ONNXRuntimePredictor
 ///
@@ -224,6 +231,9 @@ class ONNXRuntimePredictor : public PaddlePredictor {
   ///
   Ort::Value GetOrtValue(const ONNXDesc &desc, const char *device_name);
 
+  // Binds the inputs whose memory or shape changed since the last run.
+  void BindInputs(const char *device_name);
+
  private:
   // ONNXRuntime
   std::shared_ptr<Ort::Env> env_;
@@ -235,6 +245,12 @@ class ONNXRuntimePredictor : public PaddlePredictor {
   phi::Place place_;
   std::vector<ONNXDesc> input_desc_;
   std::vector<ONNXDesc> output_desc_;
+  std::vector<ONNXBoundInput> bound_inputs_;
+  // Whether an output has a fixed shape, in which case it is written by the
+  // session straight into its tensor in scope_, allocated once by paddle, and
+  // stays bound across the runs. The other outputs are allocated by the
+  // session in each run.
+  std::vector<bool> output_in_scope_;
   int predictor_id_;
 
 // Some more detailed tests, they are made the friends of the predictor, so that
@@ -75,6 +75,15 @@ TEST(ONNXRuntimePredictor, onnxruntime_on) {
   ASSERT_TRUE(predictor->ZeroCopyRun());
   output_tensor->CopyToCpu(out_data.data());
 
+  // The second run keeps the bindings of the first one.
+  std::vector<float> rerun_data(out_data.size());
+  input_tensor->CopyFromCpu(input_data.data());
+  ASSERT_TRUE(predictor->ZeroCopyRun());
+  output_tensor->CopyToCpu(rerun_data.data());
+  for (size_t i = 0; i < out_data.size(); ++i) {
+    EXPECT_NEAR(out_data[i], rerun_data[i], 1e-6);
+  }
+
   predictor->TryShrinkMemory();
 }
 
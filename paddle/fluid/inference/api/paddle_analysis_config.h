@@ -268,6 +268,26 @@ struct PD_INFER_DECL AnalysisConfig {
     opt_cache_dir_ = opt_cache_dir;
   }
   ///
+  /// \brief Cache the optimized model by its key, which is made of the model
+  /// and params contents, the config, the device arch and the library
+  /// versions. The first start saves the optimized model, the serialized
+  /// TensorRT engines and the autotune results into a sub directory of the
+  /// optimization cache directory named by the key, and the later starts with
+  /// the same key load them instead of optimizing again. A changed model,
+  /// config or library gets a new key, so the stale caches are never used.
+  /// Only the combined models loaded from files are cached.
+  ///
+  /// \param x whether to enable the optimized model cache.
+  ///
+  void EnableOptimModelCache(bool x = true) { optim_model_cache_ = x; }
+  ///
+  /// \brief A boolean state telling whether the optimized model cache is
+  /// enabled.
+  ///
+  /// \return bool Whether the optimized model cache is enabled.
+  ///
+  bool optim_model_cache_enabled() const { return optim_model_cache_; }
+  ///
   /// \brief Get the model directory path.
   ///
   /// \return const std::string& The model directory path.
@@ -735,6 +755,23 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool trt_allow_build_at_runtime() const;
 
+  ///
+  /// \brief Build the TensorRT engines in the background when the inputs go
+  /// out of their shape range, with the tuned dynamic shape and
+  /// allow_build_at_runtime. The runs out of the range are run by Paddle
+  /// until the engine of the wider range is built and swapped in, instead of
+  /// waiting for the build.
+  ///
+  /// \param enable Whether to build the engines in the background.
+  ///
+  void EnableTensorRtBackgroundBuild(bool enable = true);
+
+  ///
+  /// \brief A boolean state telling whether the TensorRT engines are built in
+  /// the background at runtime.
+  ///
+  bool trt_background_build_enabled() const;
+
   ///
   /// \brief Set execution stream. If not set a stream will be created
   /// internally.
@@ -754,6 +791,63 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool external_stream_enabled() const;
 
+  ///
+  /// \brief Run the predictor on a stream of its own with the priority. The
+  /// GPU schedules the blocks of the streams of the greater priorities first,
+  /// so a latency critical model is not starved by the others on the GPU.
+  /// 0 is the priority of the streams created by paddle, which is the lowest,
+  /// and the greater ones are clamped to the range of the device. It is
+  /// ignored if the execution stream is set.
+  ///
+  /// \param priority the priority of the stream.
+  ///
+  void SetStreamPriority(int priority);
+
+  ///
+  /// \brief Get the priority of the stream of the predictor.
+  ///
+  /// \return int The priority of the stream.
+  ///
+  int stream_priority() const { return stream_priority_; }
+
+  ///
+  /// \brief Run the transformers on the packed sequences, without padding, in
+  /// the PIR program on GPU. The tokens of the sequences are concatenated as
+  /// [1, total_tokens, ...], and the int32 input cu_seqlens of [batch + 1]
+  /// holds the offsets of the sequences. The flash attentions are bound
+  /// within the sequences, so nothing is computed for the padding.
+  ///
+  /// \param cu_seqlens_name the name of the input of the offsets.
+  /// \param max_seqlen the max length of the sequences.
+  ///
+  void EnablePackedSequence(const std::string& cu_seqlens_name,
+                            int max_seqlen);
+
+  ///
+  /// \brief A boolean state telling whether the sequences are packed.
+  ///
+  /// \return bool Whether the sequences are packed.
+  ///
+  bool packed_sequence_enabled() const {
+    return !packed_cu_seqlens_name_.empty();
+  }
+
+  ///
+  /// \brief Get the name of the input of the offsets of the packed sequences.
+  ///
+  /// \return const std::string& The name of the input.
+  ///
+  const std::string& packed_cu_seqlens_name() const {
+    return packed_cu_seqlens_name_;
+  }
+
+  ///
+  /// \brief Get the max length of the packed sequences.
+  ///
+  /// \return int The max length of the sequences.
+  ///
+  int packed_max_seqlen() const { return packed_max_seqlen_; }
+
   ///
   /// \brief Collect shape info of all tensors in compute graph.
   ///
@@ -804,6 +898,15 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   void Exp_DisableTensorRTDynamicShapeOPs(bool trt_forbid_dynamic_op);
 
+  ///
+  /// \brief Choose the TensorRT subgraphs by their estimated latencies, the
+  /// saving of an engine over the native ops against the cost of its launch
+  /// and of the bindings and format conversions of its inputs and outputs,
+  /// out of those larger than min_subgraph_size.
+  /// NOTE: just experimental, not an official stable API, easy to be broken.
+  ///
+  void Exp_EnableTensorRTCostBasedPartition(bool trt_cost_based_partition);
+
   ///
   /// \brief Replace some TensorRT plugins to TensorRT OSS(
   /// https://github.com/NVIDIA/TensorRT), with which some models's inference
@@ -923,6 +1026,49 @@ struct PD_INFER_DECL AnalysisConfig {
   /// \param capacity The cache capacity.
   ///
   void SetMkldnnCacheCapacity(int capacity);
+
+  ///
+  /// \brief Set the capacity of the oneDNN primitive cache. The cache is
+  /// process-wide and keyed by the primitive descriptors, including the
+  /// shapes, so the predictors and their clones share the compiled
+  /// primitives. Default value 0 keeps the capacity of oneDNN.
+  ///
+  /// \param capacity The max number of the cached primitives.
+  ///
+  void SetOnednnPrimitiveCacheCapacity(int capacity);
+  ///
+  /// \brief Get the capacity of the oneDNN primitive cache.
+  ///
+  /// \return int The capacity, 0 means the capacity of oneDNN.
+  ///
+  int onednn_primitive_cache_capacity() const {
+    return onednn_primitive_cache_capacity_;
+  }
+
+  ///
+  /// \brief Record the input shapes the predictor runs with to a file, and
+  /// run the predictor with the recorded shapes when it is created, so the
+  /// first requests do not create the oneDNN primitives.
+  ///
+  /// \param shape_file The file of the recorded input shapes.
+  /// \param max_shapes The max number of the recorded input shapes.
+  ///
+  void SetOnednnWarmupShapeFile(const std::string& shape_file,
+                                int max_shapes = 16);
+  ///
+  /// \brief Get the file of the input shapes of the oneDNN warm-up.
+  ///
+  /// \return string The file, empty if the warm-up is disabled.
+  ///
+  const std::string& onednn_warmup_shape_file() const {
+    return onednn_warmup_shape_file_;
+  }
+  ///
+  /// \brief Get the max number of the input shapes of the oneDNN warm-up.
+  ///
+  /// \return int The max number of the input shapes.
+  ///
+  int onednn_warmup_max_shapes() const { return onednn_warmup_max_shapes_; }
   ///
   /// \brief A boolean state telling whether to use the OneDNN.
   ///
@@ -1085,6 +1231,20 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool profile_enabled() const { return with_profile_; }
 
+  ///
+  /// \brief Turn on the latency statistics of the runs, returned by
+  /// Predictor::GetLatencyStats.
+  ///
+  /// \param x Whether the latency statistics are enabled.
+  ///
+  void EnableLatencyStats(bool x = true);
+  ///
+  /// \brief A boolean state telling whether the latency statistics are on.
+  ///
+  /// \return bool Whether the latency statistics are on.
+  ///
+  bool latency_stats_enabled() const { return with_latency_stats_; }
+
   ///
   /// \brief Mute all logs in Paddle inference.
   ///
@@ -1179,6 +1339,30 @@ struct PD_INFER_DECL AnalysisConfig {
   void EnableCustomPasses(const std::vector<std::string>& passes,
                           bool custom_pass_only = false);
 
+  ///
+  /// \brief Quantize the fp16 and bf16 weights of the matmuls at load time and
+  /// run them by the weight only linear kernels on gpu. The weights are
+  /// converted by the fused_weight_only_linear_pass of the pir program, and
+  /// the memory of the params before and after is logged.
+  ///
+  /// \param algo The weight only algorithm, "weight_only_int8" or
+  /// "weight_only_int4".
+  /// \param group_size The number of the weights sharing one scale along the
+  /// input dimension, -1 means one scale per output channel, or 64 and 128.
+  ///
+  void EnableWeightOnlyQuantization(
+      const std::string& algo = "weight_only_int8", int group_size = -1);
+
+  ///
+  /// \brief A boolean state telling whether the weight only quantization is
+  /// turned on.
+  ///
+  /// \return bool Whether the weight only quantization is turned on.
+  ///
+  bool weight_only_quantization_enabled() const {
+    return !weight_only_algo_.empty();
+  }
+
   ///
   /// \brief Delete a pass to prevent it to optimizing the model.
   ///
@@ -1221,6 +1405,9 @@ struct PD_INFER_DECL AnalysisConfig {
   // GPU related.
   bool use_gpu_{false};
   bool use_cutlass_{false};
+  // The weight only quantization, disabled if the algo is empty.
+  std::string weight_only_algo_;
+  int weight_only_group_size_{-1};
   int gpu_device_id_{0};
   uint64_t memory_pool_init_size_mb_{100};  // initial size is 100MB.
   bool enable_gpu_mixed_{false};
@@ -1229,6 +1416,10 @@ struct PD_INFER_DECL AnalysisConfig {
   bool use_cudnn_{false};
   bool use_external_stream_{false};
   void* exec_stream_{nullptr};
+  int stream_priority_{0};
+  // The packed sequences, disabled if the name is empty.
+  std::string packed_cu_seqlens_name_;
+  int packed_max_seqlen_{0};
 
   // CustomDevice related
   bool use_custom_device_{false};
@@ -1266,6 +1457,7 @@ struct PD_INFER_DECL AnalysisConfig {
   bool trt_with_interleaved_{false};
   bool trt_mark_output_{false};
   bool trt_forbid_dynamic_op_{false};
+  bool trt_cost_based_partition_{false};
 
   std::vector<std::string> trt_output_tensor_names_{};
   std::vector<std::string> trt_exclude_var_names_{};
@@ -1283,6 +1475,7 @@ struct PD_INFER_DECL AnalysisConfig {
   std::vector<std::string> trt_disabled_ops_{};
   bool disable_trt_plugin_fp16_{false};
   bool trt_allow_build_at_runtime_{false};
+  bool trt_background_build_{false};
   // tune to get dynamic_shape info.
   bool trt_tuned_dynamic_shape_{false};
   bool trt_use_inspector_{false};
@@ -1325,6 +1518,8 @@ struct PD_INFER_DECL AnalysisConfig {
 
   bool with_profile_{false};
 
+  bool with_latency_stats_{false};
+
   bool with_glog_info_{true};
 
   // A runtime cache, shouldn't be transferred to others.
@@ -1341,6 +1536,9 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // onednn related.
   int mkldnn_cache_capacity_{10};
+  int onednn_primitive_cache_capacity_{0};
+  std::string onednn_warmup_shape_file_;
+  int onednn_warmup_max_shapes_{16};
   bool use_mkldnn_quantizer_{false};
   std::shared_ptr<MkldnnQuantizerConfig> mkldnn_quantizer_config_;
   bool use_mkldnn_bfloat16_{false};
@@ -1389,6 +1587,7 @@ struct PD_INFER_DECL AnalysisConfig {
   mutable bool is_valid_{true};
   bool save_optimized_model_{false};
   std::string opt_cache_dir_;
+  bool optim_model_cache_{false};
   friend class paddle_infer::experimental::InternalUtils;
 
   // fleet exe related
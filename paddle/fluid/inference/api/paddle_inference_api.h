@@ -22,6 +22,8 @@ limitations under the License. */
 #pragma once
 
 #include <cassert>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -49,6 +51,20 @@ using Config = paddle::AnalysisConfig;
 using DistConfig = paddle::DistConfig;
 using XpuConfig = paddle::XpuConfig;
 
+///
+/// \brief The latency statistics of a stage of the runs of a predictor, in
+/// microseconds. They are enabled by Config::EnableLatencyStats.
+///
+struct PD_INFER_DECL LatencyStats {
+  uint64_t count{0};
+  double sum{0.};
+  double mean{0.};
+  double p50{0.};
+  double p99{0.};
+  double p999{0.};
+  double max{0.};
+};
+
 ///
 /// \class Predictor
 ///
@@ -140,6 +156,16 @@ class PD_INFER_DECL Predictor {
   bool Run(const std::vector<paddle::Tensor>& inputs,
            std::vector<paddle::Tensor>* outputs);
 
+  ///
+  /// \brief Run the prediction engine without blocking the caller. The inputs
+  /// should not be changed, nor the outputs read, until the run completes.
+  ///
+  /// \param[in] callback Called with whether the run is successful when the
+  /// device finishes the run, on another thread.
+  /// \return The future of whether the run is successful
+  ///
+  std::future<bool> RunAsync(std::function<void(bool)> callback = nullptr);
+
   ///
   /// \brief Get the output names
   ///
@@ -211,6 +237,32 @@ class PD_INFER_DECL Predictor {
   ///
   void* GetExecStream() const;
 
+  ///
+  /// \brief Get the GPU time of the runs of the predictor, accounted when it
+  /// runs on a stream of its own, by Config::SetExecStream or
+  /// Config::SetStreamPriority.
+  ///
+  /// \return The GPU time in ms, or 0 if it is not accounted.
+  ///
+  double GetGpuTime() const;
+
+  ///
+  /// \brief Update the values of the parameters, e.g. by an online training.
+  /// The refittable TensorRT engines are refitted instead of rebuilt.
+  ///
+  /// \param[in] params The new values of the parameters, keyed by the names
+  ///
+  void UpdateParams(const std::map<std::string, paddle::Tensor>& params);
+
+  ///
+  /// \brief Get the latency statistics of the runs of the predictor, keyed by
+  /// the stages "e2e", "h2d", "compute" and "d2h". The zero copy requests are
+  /// accounted to "e2e" when the next one begins.
+  ///
+  /// \return The statistics, or empty if they are not enabled.
+  ///
+  std::map<std::string, LatencyStats> GetLatencyStats() const;
+
  private:
   std::unique_ptr<paddle::PaddlePredictor> predictor_;
   friend class paddle_infer::experimental::InternalUtils;
@@ -248,6 +300,31 @@ PD_INFER_DECL void ConvertToMixedPrecision(
     std::unordered_set<std::string> black_list = {},
     std::unordered_set<std::string> white_list = {});
 
+///
+/// \brief Convert the params of a combined model to the memory mapped format,
+/// whose tensors are page aligned. The predictors load such a params file by
+/// mapping it, so the processes of the same model on a host share one host
+/// copy of the params through the page cache.
+///
+/// \param[in] model_file The model file.
+/// \param[in] params_file The combined params file.
+/// \param[in] mmap_params_file The params file of the memory mapped format.
+///
+PD_INFER_DECL void ConvertToMmapParams(const std::string& model_file,
+                                       const std::string& params_file,
+                                       const std::string& mmap_params_file);
+
+///
+/// \brief Export the latency statistics of the predictors in the Prometheus
+/// text format, as the summary paddle_inference_latency_microseconds labeled
+/// by the predictor and the stage.
+///
+/// \param[in] predictors The predictors, keyed by the label values.
+/// \return The metrics text.
+///
+PD_INFER_DECL std::string ExportLatencyMetrics(
+    const std::map<std::string, const Predictor*>& predictors);
+
 namespace services {
 ///
 /// \class PredictorPool
@@ -273,6 +350,299 @@ class PD_INFER_DECL PredictorPool {
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
 };
+
+///
+/// \brief The options of the request batching of BatchingPredictorPool.
+///
+struct PD_INFER_DECL BatchingOptions {
+  /// The max rows in dim 0 of the requests merged into a batch, a larger
+  /// request is run alone.
+  int max_batch_size{32};
+  /// The max microseconds the first request of a batch waits for the others.
+  int64_t max_latency_us{1000};
+  /// Whether to pad the inputs without lod to the largest shape in a batch,
+  /// otherwise the requests of the different shapes beyond dim 0 are run in
+  /// different batches. The inputs with lod are always packed by merging
+  /// their lod.
+  bool enable_padding{false};
+  /// The value of the padded elements.
+  float padding_value{0.f};
+};
+
+///
+/// \class BatchingPredictorPool
+///
+/// \brief BatchingPredictorPool serves the requests of many threads by the
+/// predictors of a PredictorPool. The requests are merged along dim 0 into
+/// batches of at most max_batch_size rows, or the ones arrived within
+/// max_latency_us, and every predictor runs the batches in a thread of its
+/// own. The outputs are split back by the rows or the lod of the requests.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// services::BatchingPredictorPool pool(config, 4);
+/// // in any thread
+/// std::vector<paddle::PaddleTensor> outputs;
+/// pool.Run(inputs, &outputs);
+/// \endcode
+///
+class PD_INFER_DECL BatchingPredictorPool {
+ public:
+  BatchingPredictorPool() = delete;
+  BatchingPredictorPool(const BatchingPredictorPool&) = delete;
+  BatchingPredictorPool& operator=(const BatchingPredictorPool&) = delete;
+
+  /// \brief Construct the pool with \param size predictor instances.
+  explicit BatchingPredictorPool(
+      const Config& config,
+      size_t size = 1,
+      const BatchingOptions& options = BatchingOptions());
+  ~BatchingPredictorPool();
+
+  ///
+  /// \brief Submit a request, thread safe.
+  ///
+  /// \param[in] inputs The cpu tensors of all the inputs of the model, named
+  /// by the input names, with the same rows in dim 0, or the same sequences in
+  /// the lod.
+  /// \return The future of the outputs of the request, in the order of the
+  /// output names.
+  ///
+  std::future<std::vector<paddle::PaddleTensor>> Submit(
+      std::vector<paddle::PaddleTensor> inputs);
+
+  ///
+  /// \brief Submit a request and wait for its outputs, thread safe.
+  ///
+  /// \return Whether the run is successful
+  ///
+  bool Run(std::vector<paddle::PaddleTensor> inputs,
+           std::vector<paddle::PaddleTensor>* outputs);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+///
+/// \brief The options of the paged kv cache of KVCacheManager.
+///
+struct PD_INFER_DECL KVCacheOptions {
+  /// The number of the attention layers, each has a key and a value cache.
+  int num_layers{1};
+  /// The number of the key and value heads.
+  int num_heads{1};
+  int head_dim{128};
+  /// The number of the tokens in a block.
+  int block_size{64};
+  /// The number of the blocks in the pool of every cache.
+  int num_blocks{1024};
+  /// The number of the columns of the block tables.
+  int max_blocks_per_seq{128};
+  DataType dtype{DataType::FLOAT16};
+  PlaceType place{PlaceType::kGPU};
+  int device_id{0};
+  /// The inputs of the model bound to the caches are key_cache_prefix +
+  /// layer and value_cache_prefix + layer, and block_tables_name.
+  std::string key_cache_prefix{"key_caches_"};
+  std::string value_cache_prefix{"value_caches_"};
+  std::string block_tables_name{"block_tables"};
+};
+
+///
+/// \class KVCacheManager
+///
+/// \brief KVCacheManager owns the paged key and value caches of the models
+/// of block_multi_head_attention, and allocates their blocks to the sequences
+/// of the continuous batching. The full blocks of the prompts are shared by
+/// the sequences of the same prefix, a shared block is copied before it is
+/// written, and the freed blocks of a prefix stay cached until their space is
+/// needed, the least recently used first.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// services::KVCacheManager kv_cache(options);
+/// int cached = kv_cache.AddSequence(seq_id, prompt);
+/// // set the other inputs, the prompt tokens after the cached ones
+/// kv_cache.Run(predictor.get(), {seq_id});
+/// // every decoding step
+/// kv_cache.Append(seq_id, 1);
+/// kv_cache.Run(predictor.get(), {seq_id});
+/// kv_cache.FreeSequence(seq_id);
+/// \endcode
+///
+class PD_INFER_DECL KVCacheManager {
+ public:
+  KVCacheManager() = delete;
+  KVCacheManager(const KVCacheManager&) = delete;
+  KVCacheManager& operator=(const KVCacheManager&) = delete;
+
+  explicit KVCacheManager(const KVCacheOptions& options);
+  ~KVCacheManager();
+
+  ///
+  /// \brief Add a sequence and allocate the blocks of its prompt.
+  ///
+  /// \param[in] seq_id The id of the new sequence.
+  /// \param[in] prompt The token ids of the prompt.
+  /// \return The number of the prompt tokens whose keys and values are
+  /// already cached and shared, or -1 if there are not enough blocks.
+  ///
+  int AddSequence(int64_t seq_id, const std::vector<int64_t>& prompt);
+
+  ///
+  /// \brief Add a sequence sharing all the blocks of the parent, e.g. a beam.
+  ///
+  /// \return Whether the parent exists.
+  ///
+  bool ForkSequence(int64_t parent_id, int64_t seq_id);
+
+  ///
+  /// \brief Grow the sequence by num_tokens generated tokens.
+  ///
+  /// \return Whether there are enough blocks.
+  ///
+  bool Append(int64_t seq_id, int num_tokens = 1);
+
+  ///
+  /// \brief Shrink the sequence to its first num_tokens tokens, e.g. to roll
+  /// back the rejected draft tokens of the speculative decoding. The blocks
+  /// after them are freed.
+  ///
+  void Truncate(int64_t seq_id, int num_tokens);
+
+  ///
+  /// \brief Free the blocks of the sequence, the full prompt blocks stay
+  /// cached for the later sequences of the same prefix.
+  ///
+  void FreeSequence(int64_t seq_id);
+
+  ///
+  /// \brief The number of the tokens of the sequence.
+  ///
+  int NumTokens(int64_t seq_id) const;
+
+  ///
+  /// \brief The number of the blocks free or evictable.
+  ///
+  int NumFreeBlocks() const;
+
+  ///
+  /// \brief The block table of the sequence.
+  ///
+  std::vector<int> BlockTable(int64_t seq_id) const;
+
+  ///
+  /// \brief Bind the caches and the block tables of the sequences, in the
+  /// order of the batch, to the inputs of the predictor and run it. The other
+  /// inputs, e.g. the tokens and the sequence lengths, are set by the caller.
+  /// The prompt blocks written by the run are shared from then on.
+  ///
+  /// \return Whether the run is successful.
+  ///
+  bool Run(Predictor* predictor, const std::vector<int64_t>& seq_ids);
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+struct PD_INFER_DECL SpeculativeOptions {
+  /// The number of the tokens proposed by the draft model every step.
+  int num_draft_tokens{4};
+  /// The draft tokens are accepted if they are the argmax of the target when
+  /// the temperature is not positive, otherwise by the rejection sampling of
+  /// the softmax at the temperature, which keeps the distribution of the
+  /// target.
+  float temperature{0.f};
+  uint64_t seed{0};
+  /// The inputs of both models. input_ids holds the int64 tokens of the batch
+  /// packed as [token_num], and the seq_lens are int32 [batch_size, 1].
+  std::string input_ids_name{"input_ids"};
+  std::string seq_lens_this_time_name{"seq_lens_this_time"};
+  std::string seq_lens_encoder_name{"seq_lens_encoder"};
+  std::string seq_lens_decoder_name{"seq_lens_decoder"};
+  /// The float32 logits of every input token, [token_num, vocab_size]. The
+  /// first output is used if it is empty.
+  std::string logits_name;
+};
+
+///
+/// \class SpeculativeDecoder
+///
+/// \brief SpeculativeDecoder generates the tokens of a target model with a
+/// small draft model of the same vocabulary. Every step the draft model
+/// proposes num_draft_tokens tokens one by one, the target model checks them
+/// all in one run, and the tokens are accepted up to the first rejected one,
+/// followed by a token of the target. The keys and the values of the rejected
+/// tokens are rolled back in both caches.
+///
+/// Both models take the inputs of SpeculativeOptions and keep their caches
+/// in their KVCacheManager. The target model gets the num_draft_tokens + 1
+/// tokens of a sequence in one step, with seq_lens_decoder tokens cached
+/// before them. It is not thread safe.
+///
+/// Usage:
+///
+/// \code{.cpp}
+/// services::SpeculativeDecoder decoder(target.get(), &target_cache,
+///                                      draft.get(), &draft_cache, options);
+/// int64_t token = decoder.AddSequence(seq_id, prompt);
+/// std::vector<std::vector<int64_t>> tokens;
+/// while (decoder.Step({seq_id}, &tokens)) {
+///   // 1 to num_draft_tokens + 1 new tokens in tokens[0]
+/// }
+/// decoder.FreeSequence(seq_id);
+/// \endcode
+///
+class PD_INFER_DECL SpeculativeDecoder {
+ public:
+  SpeculativeDecoder() = delete;
+  SpeculativeDecoder(const SpeculativeDecoder&) = delete;
+  SpeculativeDecoder& operator=(const SpeculativeDecoder&) = delete;
+
+  SpeculativeDecoder(Predictor* target,
+                     KVCacheManager* target_cache,
+                     Predictor* draft,
+                     KVCacheManager* draft_cache,
+                     const SpeculativeOptions& options);
+  ~SpeculativeDecoder();
+
+  ///
+  /// \brief Add a sequence and run its prompt through both models.
+  ///
+  /// \return The first generated token, or -1 if there are not enough blocks
+  /// or a run fails.
+  ///
+  int64_t AddSequence(int64_t seq_id, const std::vector<int64_t>& prompt);
+
+  ///
+  /// \brief Run a step of the sequences as a batch.
+  ///
+  /// \param[in] seq_ids The sequences of the batch.
+  /// \param[out] tokens The new tokens of every sequence.
+  /// \return Whether the step is successful. The caches are rolled back to
+  /// the state before the step if there are not enough blocks.
+  ///
+  bool Step(const std::vector<int64_t>& seq_ids,
+            std::vector<std::vector<int64_t>>* tokens);
+
+  ///
+  /// \brief Free the sequence in both caches.
+  ///
+  void FreeSequence(int64_t seq_id);
+
+  ///
+  /// \brief The ratio of the draft tokens accepted so far.
+  ///
+  double AcceptanceRate() const;
+
+ private:
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
 }  // namespace services
 
 }  // namespace paddle_infer
@@ -592,6 +592,7 @@ IpuPassStrategy::IpuPassStrategy() : PassStrategy({}) {
 
 const std::vector<std::string> kPirGpuPasses{
     // Functional pass
+    "quant_linear_fuse_pass",
     "delete_quant_dequant_linear_op_pass",
     "delete_weight_dequant_linear_op_pass",
     "map_op_to_another_pass",
@@ -602,8 +603,10 @@ const std::vector<std::string> kPirGpuPasses{
     "conv2d_add_act_fuse_pass",
     "conv2d_add_fuse_pass",
     "embedding_eltwise_layernorm_fuse_pass",
+    "embedding_seqpool_fuse_pass",
     "fused_rotary_position_embedding_pass",
     "fused_flash_attn_pass",
+    "flash_attn_varlen_pass",
     "multihead_matmul_fuse_pass",
     "fused_weight_only_linear_pass",
     "matmul_add_act_fuse_pass",
@@ -615,6 +618,9 @@ const std::vector<std::string> kPirGpuPasses{
     "transpose_flatten_concat_fuse_pass",
     "remove_redundant_transpose_pass",
     "transfer_layout_pass",
+    // fold the transposes inserted at the layout boundaries with the ones
+    // of the model
+    "remove_redundant_transpose_pass",
 };
 
 const std::vector<std::string> kPirXpuPasses{
@@ -672,7 +678,9 @@ const std::vector<std::string> kPirMkldnnPasses {
 };
 
 const std::vector<std::string> kPirCpuPasses{
+    "quant_linear_fuse_pass",
     "delete_quant_dequant_linear_op_pass",
-    "delete_weight_dequant_linear_op_pass"};
+    "delete_weight_dequant_linear_op_pass",
+    "embedding_seqpool_fuse_pass"};
 
 }  // namespace paddle
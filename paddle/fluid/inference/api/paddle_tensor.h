@@ -129,6 +129,36 @@ class PD_INFER_DECL Tensor {
                          PlaceType place,
                          DataLayout layout = DataLayout::kNCHW);
 
+  /// \brief Share the data of a buffer described by the strides and the data
+  /// type, e.g. the output of a preprocessing library on the device.
+  /// The data is shared without copy if it is contiguous and of the data type
+  /// of the input, otherwise it is converted on its device by the contiguous
+  /// and the cast kernels, never copied through the host. An NHWC buffer is
+  /// bound to an NCHW input by the NCHW shape and the NHWC strides.
+  /// \param data The pointer of the data.
+  /// \param shape The shape of data.
+  /// \param strides The strides of data in elements, empty if contiguous.
+  /// \param dtype The data type of data.
+  /// \param input_dtype The data type of the input, to which data is cast.
+  /// \param place The place of data.
+  /// \param deleter Called when paddle no longer uses the data, maybe on
+  /// another thread.
+  void ShareExternalData(const void* data,
+                         const std::vector<int64_t>& shape,
+                         const std::vector<int64_t>& strides,
+                         DataType dtype,
+                         DataType input_dtype,
+                         PlaceType place,
+                         std::function<void()> deleter = nullptr);
+
+  /// \brief Share the data of a DLPack tensor, the same as ShareExternalData
+  /// with the strides. Its deleter is called when paddle no longer uses the
+  /// data.
+  /// \param dl_managed_tensor The pointer of the DLManagedTensor, void* to
+  /// keep dlpack.h out of the api.
+  /// \param input_dtype The data type of the input, to which data is cast.
+  void ShareDLPack(void* dl_managed_tensor, DataType input_dtype);
+
   /// \brief Experimental interface.
   /// It's usually used to set the input tensor data with Strings data type.
   /// \param data The pointer of the data, from which the tensor will copy.
@@ -205,6 +235,8 @@ class PD_INFER_DECL Tensor {
   PlaceType place_;
   int device_;
   std::string device_type_;
+  // The latency recorder of the predictor, which times the copies.
+  void* latency_recorder_{nullptr};
 
 #ifdef PADDLE_WITH_ONNXRUNTIME
   bool is_ort_tensor_{false};
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/inference/api/resource_manager.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -140,7 +141,9 @@ CPUContextResource::CPUContextResource() : cpu_eigen_device_(nullptr) {
 }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-GPUContextResource::GPUContextResource(const phi::Place& place, void* stream)
+GPUContextResource::GPUContextResource(const phi::Place& place,
+                                       void* stream,
+                                       int priority)
     : place_(place),
       compute_capability_(0),
       runtime_version_(0),
@@ -151,14 +154,29 @@ GPUContextResource::GPUContextResource(const phi::Place& place, void* stream)
       stream_(nullptr),
       gpu_eigen_device_(nullptr),
       eigen_stream_(nullptr) {
-  InitGPUResource(stream);
+  InitGPUResource(stream, priority);
 }
 
 GPUContextResource::~GPUContextResource() { DestroyGPUResource(); }  // NOLINT
 
-void GPUContextResource::InitGPUResource(void* stream) {
+void GPUContextResource::InitGPUResource(void* stream, int priority) {
   phi::backends::gpu::GPUDeviceGuard guard(place_.device);
-  if (stream == nullptr) {
+  if (stream == nullptr && priority > 0) {
+    owned_stream_ = true;
+    // the greater priorities are the smaller numbers on the device
+    int greatest_priority =
+        phi::backends::gpu::GetGpuStreamPriorityRange().second;
+    int stream_priority = std::max(-priority, greatest_priority);
+#ifdef PADDLE_WITH_HIP
+    PADDLE_ENFORCE_GPU_SUCCESS(hipStreamCreateWithPriority(
+        &stream_, hipStreamDefault, stream_priority));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamCreateWithPriority(
+        &stream_, cudaStreamDefault, stream_priority));
+#endif
+    VLOG(3) << "Create the stream " << stream_ << " with priority "
+            << stream_priority;
+  } else if (stream == nullptr) {
     owned_stream_ = true;
     phi::InitStream(&stream_);
   } else {
@@ -171,6 +189,7 @@ void GPUContextResource::InitGPUResource(void* stream) {
 }
 
 void GPUContextResource::DestroyGPUResource() {
+  DestroyGpuTimers();
   if (owned_stream_) {
 #ifdef PADDLE_WITH_HIP
     PADDLE_ENFORCE_GPU_SUCCESS(hipStreamDestroy(stream_));
@@ -375,6 +394,105 @@ std::array<unsigned int, 3> GPUContextResource::GetGpuMaxGridDimSize() const {
   return max_grid_dim_size_;
 }
 
+void GPUContextResource::BeginGpuTimer() {
+  std::lock_guard<std::mutex> lock(timer_mutex_);
+  // the timer of a failed run is not ended
+  if (!timers_.empty() && timers_.back().second == nullptr) {
+    free_events_.push_back(timers_.back().first);
+    timers_.pop_back();
+  }
+  PollGpuTimers();
+  gpuEvent_t begin = nullptr;
+  if (free_events_.empty()) {
+#ifdef PADDLE_WITH_HIP
+    PADDLE_ENFORCE_GPU_SUCCESS(hipEventCreate(&begin));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventCreate(&begin));
+#endif
+  } else {
+    begin = free_events_.back();
+    free_events_.pop_back();
+  }
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventRecord(begin, stream_));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventRecord(begin, stream_));
+#endif
+  timers_.emplace_back(begin, nullptr);
+}
+
+void GPUContextResource::EndGpuTimer() {
+  std::lock_guard<std::mutex> lock(timer_mutex_);
+  if (timers_.empty() || timers_.back().second != nullptr) {
+    return;
+  }
+  gpuEvent_t end = nullptr;
+  if (free_events_.empty()) {
+#ifdef PADDLE_WITH_HIP
+    PADDLE_ENFORCE_GPU_SUCCESS(hipEventCreate(&end));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventCreate(&end));
+#endif
+  } else {
+    end = free_events_.back();
+    free_events_.pop_back();
+  }
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipEventRecord(end, stream_));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaEventRecord(end, stream_));
+#endif
+  timers_.back().second = end;
+}
+
+double GPUContextResource::GpuTime() {
+  std::lock_guard<std::mutex> lock(timer_mutex_);
+  PollGpuTimers();
+  return gpu_time_;
+}
+
+void GPUContextResource::PollGpuTimers() {
+  while (!timers_.empty() && timers_.front().second != nullptr) {
+    auto [begin, end] = timers_.front();
+#ifdef PADDLE_WITH_HIP
+    if (hipEventQuery(end) == hipErrorNotReady) {
+      break;
+    }
+    float ms = 0.f;
+    PADDLE_ENFORCE_GPU_SUCCESS(hipEventElapsedTime(&ms, begin, end));
+#else
+    if (cudaEventQuery(end) == cudaErrorNotReady) {
+      break;
+    }
+    float ms = 0.f;
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventElapsedTime(&ms, begin, end));
+#endif
+    gpu_time_ += ms;
+    free_events_.push_back(begin);
+    free_events_.push_back(end);
+    timers_.pop_front();
+  }
+}
+
+void GPUContextResource::DestroyGpuTimers() {
+  std::lock_guard<std::mutex> lock(timer_mutex_);
+  for (auto& timer : timers_) {
+    free_events_.push_back(timer.first);
+    if (timer.second != nullptr) {
+      free_events_.push_back(timer.second);
+    }
+  }
+  timers_.clear();
+  for (auto event : free_events_) {
+#ifdef PADDLE_WITH_HIP
+    PADDLE_ENFORCE_GPU_SUCCESS(hipEventDestroy(event));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventDestroy(event));
+#endif
+  }
+  free_events_.clear();
+}
+
 #endif
 
 ResourceManager& ResourceManager::Instance() {
@@ -397,14 +515,16 @@ CPUContextResource* ResourceManager::GetCPUResource() const {
 }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-void* ResourceManager::InitGPUResource(const phi::Place& place, void* stream) {
+void* ResourceManager::InitGPUResource(const phi::Place& place,
+                                       void* stream,
+                                       int priority) {
   std::lock_guard<std::mutex> lock_guard(gpu_mutex_);
   if (gpu_resources_.count(stream)) {
     Increase(stream);
     return stream;
   } else {
     std::unique_ptr<GPUContextResource> resource{
-        new GPUContextResource(place, stream)};
+        new GPUContextResource(place, stream, priority)};
     gpuStream_t s = resource->GetStream();
     ref_count_[s] = 1;
     gpu_resources_.emplace(s, std::move(resource));
@@ -465,6 +585,12 @@ void ResourceManager::GpuResourceSwitchStream(void* old_stream,
   Increase(new_stream);
 }
 
+double ResourceManager::GpuTime(void* stream) {
+  std::lock_guard<std::mutex> lock_guard(gpu_mutex_);
+  if (gpu_resources_.count(stream) == 0) return 0.;
+  return gpu_resources_.at(stream)->GpuTime();
+}
+
 int ResourceManager::RefCount(void* stream) const {
   if (ref_count_.count(stream) == 0) return 0;
   return ref_count_.at(stream);
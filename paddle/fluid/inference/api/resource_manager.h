@@ -14,10 +14,13 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "paddle/common/macros.h"
 #include "paddle/phi/api/include/tensor.h"
@@ -53,7 +56,11 @@ class CPUContextResource {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 class GPUContextResource {
  public:
-  explicit GPUContextResource(const phi::Place& place, void* stream);
+  // The stream is created with the priority if it is nullptr, see
+  // ResourceManager::InitGPUResource.
+  explicit GPUContextResource(const phi::Place& place,
+                              void* stream,
+                              int priority = 0);
   TEST_API ~GPUContextResource();
   phi::Place Place() const;
 
@@ -83,8 +90,15 @@ class GPUContextResource {
   int GetGpuMaxThreadsPerBlock() const;
   std::array<unsigned int, 3> GetGpuMaxGridDimSize() const;
 
+  // Accounts the GPU time of the work enqueued on the stream between the
+  // begin and the end of the timer, the events are polled without blocking.
+  void BeginGpuTimer();
+  void EndGpuTimer();
+  // The GPU time in ms of the timed work completed.
+  TEST_API double GpuTime();
+
  private:
-  void InitGPUResource(void* stream);
+  void InitGPUResource(void* stream, int priority);
   void DestroyGPUResource();
   void InitGpuProperties();
   void InitGpuEigenDevice();
@@ -97,6 +111,8 @@ class GPUContextResource {
   void DestroySolverHandle();
   void InitSparseHandle();
   void DestroySparseHandle();
+  void PollGpuTimers();
+  void DestroyGpuTimers();
 
  private:
   phi::Place place_;
@@ -122,6 +138,12 @@ class GPUContextResource {
   phi::solverHandle_t solver_handle_{nullptr};
   phi::sparseHandle_t sparse_handle_{nullptr};
   // DnnWorkspaceHandle
+
+  std::mutex timer_mutex_;
+  // the begin and end events of the timed work in flight
+  std::deque<std::pair<gpuEvent_t, gpuEvent_t>> timers_;
+  std::vector<gpuEvent_t> free_events_;
+  double gpu_time_{0.};
 };
 #endif
 
@@ -142,11 +164,20 @@ class ResourceManager {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // GPU Resource
  public:
-  void* InitGPUResource(const phi::Place& place, void* stream);
+  // The priority is of the stream created if the stream is nullptr, 0 is the
+  // one of the streams created by paddle, which is the lowest, and a greater
+  // one is scheduled first by the GPU, so the latency critical models are
+  // not starved by the others sharing the GPU. It is clamped to the range of
+  // the device.
+  void* InitGPUResource(const phi::Place& place,
+                        void* stream,
+                        int priority = 0);
   void DestroyGPUResource(void* stream);
   TEST_API GPUContextResource* GetGPUResource(void* stream) const;
   TEST_API int RefCount(void* stream) const;
   void GpuResourceSwitchStream(void* old_stream, void* new_stream);
+  // The GPU time in ms of the runs timed on the stream.
+  TEST_API double GpuTime(void* stream);
 
  private:
   void Decrease(void* stream);
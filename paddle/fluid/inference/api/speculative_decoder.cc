@@ -0,0 +1,430 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/common/enforce.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle_infer {
+namespace services {
+
+class SpeculativeDecoder::Impl {
+ public:
+  Impl(Predictor* target,
+       KVCacheManager* target_cache,
+       Predictor* draft,
+       KVCacheManager* draft_cache,
+       const SpeculativeOptions& options)
+      : target_(target),
+        target_cache_(target_cache),
+        draft_(draft),
+        draft_cache_(draft_cache),
+        options_(options),
+        rng_(options.seed) {
+    PADDLE_ENFORCE_EQ(
+        target_ && target_cache_ && draft_ && draft_cache_,
+        true,
+        common::errors::InvalidArgument(
+            "The predictors and the kv caches of SpeculativeDecoder should "
+            "not be null."));
+    PADDLE_ENFORCE_GT(
+        options_.num_draft_tokens,
+        0,
+        common::errors::InvalidArgument(
+            "The num_draft_tokens of SpeculativeDecoder should be positive."));
+  }
+
+  int64_t AddSequence(int64_t seq_id, const std::vector<int64_t>& prompt) {
+    PADDLE_ENFORCE_EQ(seqs_.count(seq_id),
+                      0,
+                      common::errors::AlreadyExists(
+                          "The sequence %d is already added.", seq_id));
+    PADDLE_ENFORCE_EQ(prompt.empty(),
+                      false,
+                      common::errors::InvalidArgument(
+                          "The prompt of the sequence %d is empty.", seq_id));
+    int num_tokens = prompt.size();
+    int target_cached = target_cache_->AddSequence(seq_id, prompt);
+    if (target_cached < 0) {
+      return -1;
+    }
+    int draft_cached = draft_cache_->AddSequence(seq_id, prompt);
+    if (draft_cached < 0) {
+      target_cache_->FreeSequence(seq_id);
+      return -1;
+    }
+    std::vector<float> logits;
+    int vocab_size = 0;
+    bool ok =
+        RunModel(draft_,
+                 draft_cache_,
+                 {seq_id},
+                 {{prompt.begin() + draft_cached, prompt.end()}},
+                 {draft_cached},
+                 true,
+                 &logits,
+                 &vocab_size) &&
+        RunModel(target_,
+                 target_cache_,
+                 {seq_id},
+                 {{prompt.begin() + target_cached, prompt.end()}},
+                 {target_cached},
+                 true,
+                 &logits,
+                 &vocab_size);
+    if (!ok) {
+      target_cache_->FreeSequence(seq_id);
+      draft_cache_->FreeSequence(seq_id);
+      return -1;
+    }
+    int64_t token =
+        Pick(logits.data() + (num_tokens - target_cached - 1) * vocab_size,
+             vocab_size,
+             nullptr);
+    Sequence& seq = seqs_[seq_id];
+    seq.target_len = num_tokens;
+    seq.draft_len = num_tokens;
+    seq.target_pending = {token};
+    seq.draft_pending = {token};
+    return token;
+  }
+
+  bool Step(const std::vector<int64_t>& seq_ids,
+            std::vector<std::vector<int64_t>>* tokens) {
+    int batch_size = seq_ids.size();
+    int k = options_.num_draft_tokens;
+    bool sampling = options_.temperature > 0.f;
+    std::vector<Sequence*> seqs;
+    for (int64_t seq_id : seq_ids) {
+      seqs.push_back(&GetSequence(seq_id));
+    }
+    std::vector<Sequence> backup;
+    for (Sequence* seq : seqs) {
+      backup.push_back(*seq);
+    }
+    auto rollback = [&]() {
+      for (int i = 0; i < batch_size; ++i) {
+        target_cache_->Truncate(seq_ids[i], backup[i].target_len);
+        draft_cache_->Truncate(seq_ids[i], backup[i].draft_len);
+        *seqs[i] = backup[i];
+      }
+      return false;
+    };
+
+    // the draft model proposes the tokens one by one
+    std::vector<std::vector<int64_t>> drafts(batch_size);
+    // the draft probabilities of the proposed tokens for the rejection
+    std::vector<std::vector<std::vector<float>>> draft_probs(batch_size);
+    std::vector<float> logits;
+    int vocab_size = 0;
+    for (int j = 0; j < k; ++j) {
+      std::vector<std::vector<int64_t>> feeds(batch_size);
+      std::vector<int> cached(batch_size);
+      for (int i = 0; i < batch_size; ++i) {
+        feeds[i] = j == 0 ? seqs[i]->draft_pending
+                          : std::vector<int64_t>{drafts[i].back()};
+        cached[i] = seqs[i]->draft_len;
+        if (!draft_cache_->Append(seq_ids[i], feeds[i].size())) {
+          return rollback();
+        }
+        seqs[i]->draft_len += feeds[i].size();
+      }
+      if (!RunModel(draft_,
+                    draft_cache_,
+                    seq_ids,
+                    feeds,
+                    cached,
+                    false,
+                    &logits,
+                    &vocab_size)) {
+        return rollback();
+      }
+      int row = -1;
+      for (int i = 0; i < batch_size; ++i) {
+        row += feeds[i].size();
+        std::vector<float> probs;
+        drafts[i].push_back(Pick(logits.data() + row * vocab_size,
+                                 vocab_size,
+                                 sampling ? &probs : nullptr));
+        draft_probs[i].push_back(std::move(probs));
+      }
+    }
+
+    // the target model checks all the proposed tokens in one run
+    std::vector<std::vector<int64_t>> feeds(batch_size);
+    std::vector<int> cached(batch_size);
+    for (int i = 0; i < batch_size; ++i) {
+      feeds[i] = seqs[i]->target_pending;
+      feeds[i].insert(feeds[i].end(), drafts[i].begin(), drafts[i].end());
+      cached[i] = seqs[i]->target_len;
+      if (!target_cache_->Append(seq_ids[i], feeds[i].size())) {
+        return rollback();
+      }
+    }
+    if (!RunModel(target_,
+                  target_cache_,
+                  seq_ids,
+                  feeds,
+                  cached,
+                  false,
+                  &logits,
+                  &vocab_size)) {
+      return rollback();
+    }
+
+    tokens->assign(batch_size, {});
+    int offset = 0;
+    for (int i = 0; i < batch_size; ++i) {
+      Sequence* seq = seqs[i];
+      // the row of the target predicting the token after the pending ones
+      int first_row = offset + seq->target_pending.size() - 1;
+      const float* rows = logits.data() + first_row * vocab_size;
+      offset += feeds[i].size();
+      int accepted = 0;
+      int64_t token = -1;
+      for (; accepted < k; ++accepted) {
+        const float* row = rows + accepted * vocab_size;
+        token = Verify(row,
+                       vocab_size,
+                       drafts[i][accepted],
+                       sampling ? &draft_probs[i][accepted] : nullptr);
+        if (token != drafts[i][accepted]) {
+          break;
+        }
+      }
+      if (accepted == k) {
+        token = Pick(rows + k * vocab_size, vocab_size, nullptr);
+      }
+      proposed_ += k;
+      accepted_ += accepted;
+
+      std::vector<int64_t>& out = (*tokens)[i];
+      out.assign(drafts[i].begin(), drafts[i].begin() + accepted);
+      out.push_back(token);
+      // The rejected tokens are dropped from both caches. The draft model has
+      // not seen its last proposal, which is fed next step if it is accepted.
+      seq->target_len += seq->target_pending.size() + accepted;
+      target_cache_->Truncate(seq_ids[i], seq->target_len);
+      seq->target_pending = {token};
+      seq->draft_len -= k - 1 - std::min(accepted, k - 1);
+      draft_cache_->Truncate(seq_ids[i], seq->draft_len);
+      seq->draft_pending = {token};
+      if (accepted == k) {
+        seq->draft_pending.insert(seq->draft_pending.begin(), drafts[i][k - 1]);
+      }
+    }
+    VLOG(3) << "SpeculativeDecoder accepts " << accepted_ << " of "
+            << proposed_ << " draft tokens";
+    return true;
+  }
+
+  void FreeSequence(int64_t seq_id) {
+    target_cache_->FreeSequence(seq_id);
+    draft_cache_->FreeSequence(seq_id);
+    seqs_.erase(seq_id);
+  }
+
+  double AcceptanceRate() const {
+    return proposed_ > 0 ? static_cast<double>(accepted_) / proposed_ : 0.;
+  }
+
+ private:
+  struct Sequence {
+    // The number of the tokens in the caches.
+    int target_len{0};
+    int draft_len{0};
+    // The generated tokens not yet run by the models.
+    std::vector<int64_t> target_pending;
+    std::vector<int64_t> draft_pending;
+  };
+
+  Sequence& GetSequence(int64_t seq_id) {
+    auto iter = seqs_.find(seq_id);
+    PADDLE_ENFORCE_NE(
+        iter,
+        seqs_.end(),
+        common::errors::NotFound("The sequence %d is not found.", seq_id));
+    return iter->second;
+  }
+
+  // Runs the tokens of the sequences after the cached ones, and gets the
+  // logits of all the tokens.
+  bool RunModel(Predictor* predictor,
+                KVCacheManager* cache,
+                const std::vector<int64_t>& seq_ids,
+                const std::vector<std::vector<int64_t>>& feeds,
+                const std::vector<int>& cached,
+                bool prefill,
+                std::vector<float>* logits,
+                int* vocab_size) {
+    int batch_size = seq_ids.size();
+    std::vector<int64_t> input_ids;
+    std::vector<int> seq_lens_this_time;
+    std::vector<int> seq_lens_encoder;
+    for (const auto& feed : feeds) {
+      input_ids.insert(input_ids.end(), feed.begin(), feed.end());
+      seq_lens_this_time.push_back(feed.size());
+      seq_lens_encoder.push_back(prefill ? feed.size() : 0);
+    }
+    int token_num = input_ids.size();
+    auto input_ids_t = predictor->GetInputHandle(options_.input_ids_name);
+    input_ids_t->Reshape({token_num});
+    input_ids_t->CopyFromCpu(input_ids.data());
+    auto set_seq_lens = [&](const std::string& name,
+                            const std::vector<int>& data) {
+      auto tensor = predictor->GetInputHandle(name);
+      tensor->Reshape({batch_size, 1});
+      tensor->CopyFromCpu(data.data());
+    };
+    set_seq_lens(options_.seq_lens_this_time_name, seq_lens_this_time);
+    set_seq_lens(options_.seq_lens_encoder_name, seq_lens_encoder);
+    set_seq_lens(options_.seq_lens_decoder_name, cached);
+    if (!cache->Run(predictor, seq_ids)) {
+      return false;
+    }
+
+    auto logits_t = predictor->GetOutputHandle(
+        options_.logits_name.empty() ? predictor->GetOutputNames()[0]
+                                     : options_.logits_name);
+    PADDLE_ENFORCE_EQ(
+        logits_t->type(),
+        DataType::FLOAT32,
+        common::errors::InvalidArgument(
+            "The logits of SpeculativeDecoder should be float32."));
+    std::vector<int> shape = logits_t->shape();
+    *vocab_size = shape.back();
+    int64_t numel = std::accumulate(
+        shape.begin(), shape.end(), 1LL, std::multiplies<int64_t>());
+    PADDLE_ENFORCE_EQ(numel,
+                      static_cast<int64_t>(token_num) * *vocab_size,
+                      common::errors::InvalidArgument(
+                          "SpeculativeDecoder needs the logits of all the %d "
+                          "input tokens, but the logits have %d elements of a "
+                          "vocabulary of %d.",
+                          token_num,
+                          numel,
+                          *vocab_size));
+    logits->resize(numel);
+    logits_t->CopyToCpu(logits->data());
+    return true;
+  }
+
+  // The softmax of the logits at the temperature.
+  void Softmax(const float* logits, int size, std::vector<float>* probs) {
+    probs->resize(size);
+    float max_logit = *std::max_element(logits, logits + size);
+    float sum = 0.f;
+    for (int i = 0; i < size; ++i) {
+      (*probs)[i] = std::exp((logits[i] - max_logit) / options_.temperature);
+      sum += (*probs)[i];
+    }
+    for (float& p : *probs) {
+      p /= sum;
+    }
+  }
+
+  int64_t Sample(const std::vector<float>& weights) {
+    std::discrete_distribution<int64_t> dist(weights.begin(), weights.end());
+    return dist(rng_);
+  }
+
+  // Picks the next token of the logits, and keeps the probabilities of the
+  // sampling in probs if it is not null.
+  int64_t Pick(const float* logits, int size, std::vector<float>* probs) {
+    if (options_.temperature <= 0.f) {
+      return std::max_element(logits, logits + size) - logits;
+    }
+    std::vector<float> local;
+    std::vector<float>* p = probs ? probs : &local;
+    Softmax(logits, size, p);
+    return Sample(*p);
+  }
+
+  // Returns the draft token if the target accepts it, or the token of the
+  // target in its place.
+  int64_t Verify(const float* logits,
+                 int size,
+                 int64_t draft,
+                 const std::vector<float>* draft_probs) {
+    if (options_.temperature <= 0.f) {
+      return std::max_element(logits, logits + size) - logits;
+    }
+    std::vector<float> probs;
+    Softmax(logits, size, &probs);
+    const std::vector<float>& q = *draft_probs;
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    if (uniform(rng_) * q[draft] < probs[draft]) {
+      return draft;
+    }
+    // resample from the part of the target above the draft
+    std::vector<float> residual(size);
+    float sum = 0.f;
+    for (int i = 0; i < size; ++i) {
+      residual[i] = std::max(probs[i] - q[i], 0.f);
+      sum += residual[i];
+    }
+    return Sample(sum > 0.f ? residual : probs);
+  }
+
+  Predictor* target_;
+  KVCacheManager* target_cache_;
+  Predictor* draft_;
+  KVCacheManager* draft_cache_;
+  SpeculativeOptions options_;
+  std::mt19937_64 rng_;
+  std::unordered_map<int64_t, Sequence> seqs_;
+  int64_t proposed_{0};
+  int64_t accepted_{0};
+};
+
+SpeculativeDecoder::SpeculativeDecoder(Predictor* target,
+                                       KVCacheManager* target_cache,
+                                       Predictor* draft,
+                                       KVCacheManager* draft_cache,
+                                       const SpeculativeOptions& options)
+    : impl_(new Impl(target, target_cache, draft, draft_cache, options)) {}
+
+SpeculativeDecoder::~SpeculativeDecoder() = default;
+
+int64_t SpeculativeDecoder::AddSequence(int64_t seq_id,
+                                        const std::vector<int64_t>& prompt) {
+  return impl_->AddSequence(seq_id, prompt);
+}
+
+bool SpeculativeDecoder::Step(const std::vector<int64_t>& seq_ids,
+                              std::vector<std::vector<int64_t>>* tokens) {
+  return impl_->Step(seq_ids, tokens);
+}
+
+void SpeculativeDecoder::FreeSequence(int64_t seq_id) {
+  impl_->FreeSequence(seq_id);
+}
+
+double SpeculativeDecoder::AcceptanceRate() const {
+  return impl_->AcceptanceRate();
+}
+
+}  // namespace services
+}  // namespace paddle_infer
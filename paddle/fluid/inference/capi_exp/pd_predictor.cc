@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/inference/capi_exp/pd_predictor.h"
 
+#include <algorithm>
+
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/capi_exp/pd_config.h"
 #include "paddle/fluid/inference/capi_exp/pd_types.h"
@@ -29,6 +31,129 @@
           "The pointer of paddle predictor shouldn't be nullptr")); \
   auto& predictor = pd_predictor->predictor
 
+namespace {
+
+void ResolveHandles(PD_Predictor* pd_predictor) {
+  if (!pd_predictor->input_names.empty() ||
+      !pd_predictor->output_names.empty()) {
+    return;
+  }
+  auto& predictor = pd_predictor->predictor;
+  pd_predictor->input_names = predictor->GetInputNames();
+  pd_predictor->output_names = predictor->GetOutputNames();
+  for (const auto& name : pd_predictor->input_names) {
+    pd_predictor->input_handles.push_back(predictor->GetInputHandle(name));
+  }
+  for (const auto& name : pd_predictor->output_names) {
+    pd_predictor->output_handles.push_back(predictor->GetOutputHandle(name));
+  }
+}
+
+int32_t FindIndex(const std::vector<std::string>& names, const char* name) {
+  auto iter = std::find(names.begin(), names.end(), name);
+  return iter == names.end() ? -1 : static_cast<int32_t>(iter - names.begin());
+}
+
+paddle_infer::Tensor* GetHandle(
+    const std::vector<std::unique_ptr<paddle_infer::Tensor>>& handles,
+    int32_t index) {
+  PADDLE_ENFORCE_EQ(
+      index >= 0 && static_cast<size_t>(index) < handles.size(),
+      true,
+      common::errors::InvalidArgument(
+          "The index %d is out of the range [0, %d).", index, handles.size()));
+  return handles[index].get();
+}
+
+size_t NumBytes(PD_DataType dtype, const std::vector<int>& shape) {
+  size_t numel = 1;
+  for (int dim : shape) {
+    numel *= dim;
+  }
+  return numel * paddle_infer::GetNumBytesOfDataType(
+                     paddle_infer::CvtToCxxDatatype(dtype));
+}
+
+void CopyFromBuffer(const PD_TensorBuffer& buffer,
+                    paddle_infer::Tensor* tensor) {
+  PADDLE_ENFORCE_LE(buffer.shape_size,
+                    static_cast<size_t>(PD_MAX_TENSOR_RANK),
+                    common::errors::InvalidArgument(
+                        "The rank of the input %s should be at most %d, but "
+                        "received %d.",
+                        tensor->name(),
+                        PD_MAX_TENSOR_RANK,
+                        buffer.shape_size));
+  std::vector<int> shape(buffer.shape, buffer.shape + buffer.shape_size);
+  PADDLE_ENFORCE_GE(buffer.capacity,
+                    NumBytes(buffer.dtype, shape),
+                    common::errors::InvalidArgument(
+                        "The buffer of the input %s is smaller than its shape.",
+                        tensor->name()));
+  tensor->Reshape(shape);
+  switch (buffer.dtype) {
+    case PD_DATA_FLOAT32:
+      tensor->CopyFromCpu(static_cast<const float*>(buffer.data));
+      break;
+    case PD_DATA_INT32:
+      tensor->CopyFromCpu(static_cast<const int32_t*>(buffer.data));
+      break;
+    case PD_DATA_INT64:
+      tensor->CopyFromCpu(static_cast<const int64_t*>(buffer.data));
+      break;
+    case PD_DATA_UINT8:
+      tensor->CopyFromCpu(static_cast<const uint8_t*>(buffer.data));
+      break;
+    case PD_DATA_INT8:
+      tensor->CopyFromCpu(static_cast<const int8_t*>(buffer.data));
+      break;
+    default:
+      PADDLE_THROW(common::errors::InvalidArgument(
+          "Unsupport paddle data type %d.", buffer.dtype));
+  }
+}
+
+bool CopyToBuffer(const paddle_infer::Tensor& tensor,
+                  PD_TensorBuffer* buffer) {
+  std::vector<int> shape = tensor.shape();
+  PADDLE_ENFORCE_LE(shape.size(),
+                    static_cast<size_t>(PD_MAX_TENSOR_RANK),
+                    common::errors::InvalidArgument(
+                        "The rank of the output %s should be at most %d, but "
+                        "received %d.",
+                        tensor.name(),
+                        PD_MAX_TENSOR_RANK,
+                        shape.size()));
+  buffer->dtype = paddle_infer::CvtFromCxxDatatype(tensor.type());
+  buffer->shape_size = shape.size();
+  std::copy(shape.begin(), shape.end(), buffer->shape);
+  if (buffer->capacity < NumBytes(buffer->dtype, shape)) {
+    return false;
+  }
+  switch (buffer->dtype) {
+    case PD_DATA_FLOAT32:
+      tensor.CopyToCpu(static_cast<float*>(buffer->data));
+      break;
+    case PD_DATA_INT32:
+      tensor.CopyToCpu(static_cast<int32_t*>(buffer->data));
+      break;
+    case PD_DATA_INT64:
+      tensor.CopyToCpu(static_cast<int64_t*>(buffer->data));
+      break;
+    case PD_DATA_UINT8:
+      tensor.CopyToCpu(static_cast<uint8_t*>(buffer->data));
+      break;
+    case PD_DATA_INT8:
+      tensor.CopyToCpu(static_cast<int8_t*>(buffer->data));
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+}  // namespace
+
 extern "C" {
 __pd_give PD_Predictor* PD_PredictorCreate(__pd_take PD_Config* pd_config) {
   PADDLE_ENFORCE_NOT_NULL(
@@ -143,6 +268,45 @@ PD_Bool PD_PredictorRun(__pd_keep PD_Predictor* pd_predictor) {
   return predictor->Run();  // NOLINT
 }
 
+int32_t PD_PredictorGetInputIndex(__pd_keep PD_Predictor* pd_predictor,
+                                  const char* name) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  ResolveHandles(pd_predictor);
+  return FindIndex(pd_predictor->input_names, name);
+}
+
+int32_t PD_PredictorGetOutputIndex(__pd_keep PD_Predictor* pd_predictor,
+                                   const char* name) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  ResolveHandles(pd_predictor);
+  return FindIndex(pd_predictor->output_names, name);
+}
+
+PD_Bool PD_PredictorRunBatch(__pd_keep PD_Predictor* pd_predictor,
+                             size_t input_num,
+                             const int32_t* input_indices,
+                             const PD_TensorBuffer* inputs,
+                             size_t output_num,
+                             const int32_t* output_indices,
+                             PD_TensorBuffer* outputs) {
+  CHECK_AND_CONVERT_PD_PREDICTOR;
+  ResolveHandles(pd_predictor);
+  for (size_t i = 0; i < input_num; ++i) {
+    CopyFromBuffer(inputs[i],
+                   GetHandle(pd_predictor->input_handles, input_indices[i]));
+  }
+  if (!predictor->Run()) {
+    return FALSE;
+  }
+  bool written = true;
+  for (size_t i = 0; i < output_num; ++i) {
+    written &= CopyToBuffer(
+        *GetHandle(pd_predictor->output_handles, output_indices[i]),
+        &outputs[i]);
+  }
+  return written;  // NOLINT
+}
+
 void PD_PredictorClearIntermediateTensor(__pd_keep PD_Predictor* pd_predictor) {
   CHECK_AND_CONVERT_PD_PREDICTOR;
   predictor->ClearIntermediateTensor();
@@ -131,6 +131,52 @@ PADDLE_CAPI_EXPORT extern __pd_give PD_Tensor* PD_PredictorGetOutputHandle(
 PADDLE_CAPI_EXPORT extern PD_Bool PD_PredictorRun(
     __pd_keep PD_Predictor* pd_predictor);
 
+///
+/// \brief Get the index of the input for PD_PredictorRunBatch, resolved once
+/// so that the runs do not look up the names.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] name input name
+/// \return The index of the input, or -1 if not found
+///
+PADDLE_CAPI_EXPORT extern int32_t PD_PredictorGetInputIndex(
+    __pd_keep PD_Predictor* pd_predictor, const char* name);
+
+///
+/// \brief Get the index of the output for PD_PredictorRunBatch.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] name output name
+/// \return The index of the output, or -1 if not found
+///
+PADDLE_CAPI_EXPORT extern int32_t PD_PredictorGetOutputIndex(
+    __pd_keep PD_Predictor* pd_predictor, const char* name);
+
+///
+/// \brief Copy the inputs from the buffers, run, and copy the outputs to the
+/// buffers, in one call without any allocation of the C api objects.
+/// The shape and the dtype of each output buffer are set, and its data is
+/// written if the capacity is enough, otherwise FALSE is returned, so that
+/// the caller can grow the buffer by the shape and call again.
+///
+/// \param[in] pd_predictor predictor
+/// \param[in] input_num the number of the inputs
+/// \param[in] input_indices the indices of the inputs
+/// \param[in] inputs the buffers of the inputs on the host
+/// \param[in] output_num the number of the outputs
+/// \param[in] output_indices the indices of the outputs
+/// \param[out] outputs the buffers of the outputs on the host
+/// \return Whether the run is successful and all the outputs are written
+///
+PADDLE_CAPI_EXPORT extern PD_Bool PD_PredictorRunBatch(
+    __pd_keep PD_Predictor* pd_predictor,
+    size_t input_num,
+    const int32_t* input_indices,
+    const PD_TensorBuffer* inputs,
+    size_t output_num,
+    const int32_t* output_indices,
+    PD_TensorBuffer* outputs);
+
 /// \brief Clear the intermediate tensors of the predictor
 ///
 /// \param[in] pd_predictor predictor
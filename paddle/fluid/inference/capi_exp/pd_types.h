@@ -59,3 +59,13 @@ typedef struct PD_IOInfos {
   size_t size;
   PD_IOInfo** io_info;
 } PD_IOInfos;  // inputs or outputs info
+
+#define PD_MAX_TENSOR_RANK 9
+
+typedef struct PD_TensorBuffer {
+  void* data;        // the host memory of the caller
+  size_t capacity;   // the bytes of data
+  PD_DataType dtype;
+  size_t shape_size;
+  int32_t shape[PD_MAX_TENSOR_RANK];
+} PD_TensorBuffer;  // the data of an input or output in PD_PredictorRunBatch
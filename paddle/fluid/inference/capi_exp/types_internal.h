@@ -16,6 +16,9 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/capi_exp/pd_common.h"
@@ -26,4 +29,9 @@ typedef struct PD_Tensor {
 
 typedef struct PD_Predictor {
   std::shared_ptr<paddle_infer::Predictor> predictor;
+  // the handles of PD_PredictorRunBatch, resolved by the first index lookup
+  std::vector<std::string> input_names;
+  std::vector<std::string> output_names;
+  std::vector<std::unique_ptr<paddle_infer::Tensor>> input_handles;
+  std::vector<std::unique_ptr<paddle_infer::Tensor>> output_handles;
 } PD_Predictor;
@@ -14,17 +14,31 @@ limitations under the License. */
 
 #include "paddle/fluid/inference/io.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/pybind/pybind.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/allocator.h"
+#include "paddle/phi/core/utils/data_type.h"
 
 // phi
 #include "paddle/phi/kernels/declarations.h"
@@ -76,6 +90,281 @@ bool IsPersistable(const framework::VarDesc* var) {
   return false;
 }
 
+namespace {
+
+// The memory mapped parameter file is
+//   magic | header_size | header | data
+// The header is the number of the tensors followed by them, each is
+//   name_size | name | dtype | rank | dims | lod_level | (lod_size | lod)... |
+//   offset | size
+// and the data of every tensor starts at a page aligned offset of the file.
+constexpr char kMmapParamsMagic[8] = {'P', 'D', 'M', 'M', 'A', 'P', '0', '1'};
+constexpr uint64_t kMmapParamsAlignment = 4096;
+
+template <typename T>
+void AppendPod(std::string* buffer, const T& value) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Reads the header fields, fails the load if the header is truncated.
+class MmapParamsHeaderReader {
+ public:
+  MmapParamsHeaderReader(const char* p,
+                         const char* end,
+                         const std::string& filename)
+      : p_(p), end_(end), filename_(filename) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    memcpy(&value, Advance(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString(uint64_t size) {
+    const char* p = Advance(size);
+    return std::string(p, size);
+  }
+
+ private:
+  const char* Advance(uint64_t size) {
+    PADDLE_ENFORCE_LE(
+        size,
+        static_cast<uint64_t>(end_ - p_),
+        common::errors::InvalidArgument(
+            "The header of the memory mapped params file %s is truncated.",
+            filename_));
+    const char* p = p_;
+    p_ += size;
+    return p;
+  }
+
+  const char* p_;
+  const char* end_;
+  const std::string& filename_;
+};
+
+#ifndef _WIN32
+// Keeps the mapping alive while any tensor of the file uses it.
+class MmapParamsAllocation : public phi::Allocation {
+ public:
+  MmapParamsAllocation(void* ptr, size_t size, std::shared_ptr<void> mapping)
+      : phi::Allocation(ptr, size, phi::CPUPlace()),
+        mapping_(std::move(mapping)) {}
+
+ private:
+  std::shared_ptr<void> mapping_;
+};
+#endif
+
+}  // namespace
+
+bool IsMmapParamsFile(const std::string& filename) {
+#ifdef _WIN32
+  return false;
+#else
+  std::ifstream fin(filename, std::ios::in | std::ios::binary);
+  char magic[sizeof(kMmapParamsMagic)];
+  fin.read(magic, sizeof(magic));
+  return fin.gcount() == sizeof(magic) &&
+         memcmp(magic, kMmapParamsMagic, sizeof(magic)) == 0;
+#endif
+}
+
+void LoadMmapParams(framework::Scope* scope,
+                    const std::vector<std::string>& names,
+                    const std::string& filename,
+                    const phi::Place& place) {
+#ifdef _WIN32
+  PADDLE_THROW(common::errors::Unimplemented(
+      "The memory mapped params file is not supported on windows."));
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_GE(
+      fd,
+      0,
+      common::errors::Unavailable("Failed to open file %s.", filename));
+  struct stat st;
+  PADDLE_ENFORCE_EQ(
+      fstat(fd, &st),
+      0,
+      common::errors::Unavailable("Failed to stat file %s.", filename));
+  size_t file_size = st.st_size;
+  // The private mapping shares the clean pages with the other processes
+  // through the page cache, a written page is copied for this process only.
+  void* data = mmap(
+      nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(
+      data,
+      MAP_FAILED,
+      common::errors::Unavailable("Failed to mmap file %s.", filename));
+  std::shared_ptr<void> mapping(
+      data, [file_size](void* data) { munmap(data, file_size); });
+
+  const char* base = static_cast<const char*>(data);
+  MmapParamsHeaderReader reader(base, base + file_size, filename);
+  std::string magic = reader.ReadString(sizeof(kMmapParamsMagic));
+  PADDLE_ENFORCE_EQ(
+      memcmp(magic.data(), kMmapParamsMagic, sizeof(kMmapParamsMagic)),
+      0,
+      common::errors::InvalidArgument(
+          "%s is not a memory mapped params file.", filename));
+  uint64_t header_size = reader.Read<uint64_t>();
+  PADDLE_ENFORCE_LE(
+      header_size,
+      file_size - sizeof(kMmapParamsMagic) - sizeof(uint64_t),
+      common::errors::InvalidArgument(
+          "The header of the memory mapped params file %s is truncated.",
+          filename));
+  uint64_t num = reader.Read<uint64_t>();
+  std::unordered_map<std::string, phi::DenseTensor*> tensors;
+  for (auto& name : names) {
+    tensors[name] = scope->Var(name)->GetMutable<phi::DenseTensor>();
+  }
+  size_t loaded = 0;
+  for (uint64_t i = 0; i < num; ++i) {
+    std::string name = reader.ReadString(reader.Read<uint64_t>());
+    auto dtype = phi::TransToPhiDataType(reader.Read<int32_t>());
+    std::vector<int64_t> dims(reader.Read<uint64_t>());
+    for (auto& dim : dims) {
+      dim = reader.Read<int64_t>();
+    }
+    phi::LoD lod(reader.Read<uint64_t>());
+    for (auto& level : lod) {
+      level.resize(reader.Read<uint64_t>());
+      for (auto& offset : level) {
+        offset = reader.Read<uint64_t>();
+      }
+    }
+    uint64_t offset = reader.Read<uint64_t>();
+    uint64_t size = reader.Read<uint64_t>();
+    PADDLE_ENFORCE_LE(
+        offset + size,
+        file_size,
+        common::errors::InvalidArgument(
+            "The data of %s is out of the memory mapped params file %s.",
+            name,
+            filename));
+    auto iter = tensors.find(name);
+    if (iter == tensors.end()) {
+      continue;
+    }
+    phi::DenseTensor* tensor = iter->second;
+    tensor->Resize(common::make_ddim(dims));
+    tensor->set_lod(lod);
+    PADDLE_ENFORCE_EQ(
+        tensor->numel() * phi::SizeOf(dtype),
+        size,
+        common::errors::InvalidArgument(
+            "The size of %s in the memory mapped params file %s does not "
+            "match its shape.",
+            name,
+            filename));
+    tensor->ResetHolderWithType(
+        std::make_shared<MmapParamsAllocation>(
+            const_cast<char*>(base) + offset, size, mapping),
+        dtype);
+    if (!phi::is_cpu_place(place)) {
+      phi::DenseTensor cpu_tensor;
+      cpu_tensor.ShareDataWith(*tensor);
+      framework::TensorCopySync(cpu_tensor, place, tensor);
+    }
+    ++loaded;
+  }
+  PADDLE_ENFORCE_EQ(
+      loaded,
+      names.size(),
+      common::errors::NotFound(
+          "Only %d of the %d params are found in the memory mapped params "
+          "file %s.",
+          loaded,
+          names.size(),
+          filename));
+  VLOG(3) << "mapped " << loaded << " params from " << filename;
+#endif
+}
+
+void SaveMmapParams(const framework::Scope& scope,
+                    const std::vector<std::string>& names,
+                    const std::string& filename) {
+  std::vector<phi::DenseTensor> tensors(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto* var = scope.FindVar(names[i]);
+    PADDLE_ENFORCE_NOT_NULL(
+        var,
+        common::errors::NotFound("The param %s is not found.", names[i]));
+    const auto& tensor = var->Get<phi::DenseTensor>();
+    if (phi::is_cpu_place(tensor.place())) {
+      tensors[i].ShareDataWith(tensor);
+    } else {
+      framework::TensorCopySync(tensor, phi::CPUPlace(), &tensors[i]);
+    }
+  }
+
+  std::string header;
+  AppendPod(&header, static_cast<uint64_t>(names.size()));
+  // the offsets are fixed up once the header size is known
+  std::vector<size_t> offset_pos(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    const auto& tensor = tensors[i];
+    AppendPod(&header, static_cast<uint64_t>(names[i].size()));
+    header.append(names[i]);
+    AppendPod(&header,
+              static_cast<int32_t>(phi::TransToProtoVarType(tensor.dtype())));
+    auto dims = common::vectorize(tensor.dims());
+    AppendPod(&header, static_cast<uint64_t>(dims.size()));
+    for (auto dim : dims) {
+      AppendPod(&header, static_cast<int64_t>(dim));
+    }
+    AppendPod(&header, static_cast<uint64_t>(tensor.lod().size()));
+    for (auto& level : tensor.lod()) {
+      AppendPod(&header, static_cast<uint64_t>(level.size()));
+      for (auto offset : level) {
+        AppendPod(&header, static_cast<uint64_t>(offset));
+      }
+    }
+    offset_pos[i] = header.size();
+    AppendPod(&header, static_cast<uint64_t>(0));
+    AppendPod(&header, static_cast<uint64_t>(tensor.memory_size()));
+  }
+  auto align = [](uint64_t offset) {
+    return (offset + kMmapParamsAlignment - 1) / kMmapParamsAlignment *
+           kMmapParamsAlignment;
+  };
+  uint64_t prefix_size = sizeof(kMmapParamsMagic) + sizeof(uint64_t);
+  std::vector<uint64_t> offsets(names.size());
+  uint64_t offset = align(prefix_size + header.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    offsets[i] = offset;
+    memcpy(&header[offset_pos[i]], &offset, sizeof(uint64_t));
+    offset = align(offset + tensors[i].memory_size());
+  }
+
+  std::ofstream fout(filename, std::ios::out | std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      fout.is_open(),
+      true,
+      common::errors::Unavailable("Failed to open file %s.", filename));
+  uint64_t header_size = header.size();
+  fout.write(kMmapParamsMagic, sizeof(kMmapParamsMagic));
+  fout.write(reinterpret_cast<const char*>(&header_size), sizeof(uint64_t));
+  fout.write(header.data(), header.size());
+  uint64_t pos = prefix_size + header.size();
+  std::string padding(kMmapParamsAlignment, '\0');
+  for (size_t i = 0; i < names.size(); ++i) {
+    fout.write(padding.data(), offsets[i] - pos);
+    fout.write(static_cast<const char*>(tensors[i].data()),
+               tensors[i].memory_size());
+    pos = offsets[i] + tensors[i].memory_size();
+  }
+  fout.close();
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fout),
+      true,
+      common::errors::Unavailable("Failed to write file %s.", filename));
+}
+
 void LoadPersistables(framework::Executor* executor,
                       framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
@@ -119,7 +408,9 @@ void LoadPersistables(framework::Executor* executor,
     }
   }
 
-  if (!param_filename.empty()) {
+  bool mmap_params = !param_filename.empty() && !model_from_memory &&
+                     IsMmapParamsFile(param_filename);
+  if (!param_filename.empty() && !mmap_params) {
     // sort param_list to have consistent ordering
     std::sort(param_list.begin(), param_list.end());
     // append just the load_combine op
@@ -132,6 +423,9 @@ void LoadPersistables(framework::Executor* executor,
   }
 
   executor->Run(*load_program, scope, 0, true, true);
+  if (mmap_params) {
+    LoadMmapParams(scope, param_list, param_filename, executor->GetPlace());
+  }
 
   delete load_program;
 }
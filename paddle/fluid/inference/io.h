@@ -28,6 +28,26 @@ namespace inference {
 
 void Init(const std::vector<std::string> argv);
 
+// The params file of the memory mapped format has the data of every tensor at
+// a page aligned offset, the loaders map it instead of reading it, so the
+// processes loading the same file share its host copy through the page cache.
+// The combined params files of this format are detected by their magic.
+bool IsMmapParamsFile(const std::string& filename);
+
+// Maps the tensors of the names from the file into the scope, and copies them
+// to the place if it is not the cpu. The mapping is copy on write, a tensor
+// written in place gets its private pages.
+void LoadMmapParams(framework::Scope* scope,
+                    const std::vector<std::string>& names,
+                    const std::string& filename,
+                    const phi::Place& place);
+
+// Save the dense tensors of the names from a scope to a params file of the
+// memory mapped format.
+void SaveMmapParams(const framework::Scope& scope,
+                    const std::vector<std::string>& names,
+                    const std::string& filename);
+
 void LoadPersistables(framework::Executor* executor,
                       framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
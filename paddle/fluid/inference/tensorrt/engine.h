@@ -383,6 +383,7 @@ class TensorRTEngine {
   ShapeMapType& min_shape_tensor() { return params_.min_shape_tensor; }
   ShapeMapType& max_shape_tensor() { return params_.max_shape_tensor; }
   ShapeMapType& optim_shape_tensor() { return params_.optim_shape_tensor; }
+  const ConstructionParams& params() const { return params_; }
 
   bool AdjustDynamicShapeRange(const ShapeMapType& runtime_input_shape,
                                const ShapeMapType& runtime_shape_tensor,
@@ -668,6 +669,14 @@ class TRTEngineManager {
     return engines_[name].get();
   }
 
+  // Replaces the engine of the name, the old one is deleted.
+  TensorRTEngine* Replace(const std::string& name,
+                          std::unique_ptr<TensorRTEngine> engine) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    engines_[name] = std::move(engine);
+    return engines_[name].get();
+  }
+
   void DeleteAll() {
     std::lock_guard<std::mutex> lock(mutex_);
     for (auto& item : engines_) {
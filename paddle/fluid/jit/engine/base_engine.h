@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <future>
+
 #include "paddle/phi/api/include/tensor.h"
 
 namespace paddle {
@@ -31,6 +33,19 @@ class BaseEngine {
 
   virtual std::unique_ptr<BaseEngine> Clone(void *stream = nullptr) = 0;
 
+  // Runs the function asynchronously, the engines which can not run the
+  // requests concurrently run it in place and return a ready future.
+  virtual std::future<std::vector<Tensor>> RunAsync(
+      const std::vector<Tensor> &inputs) {
+    std::promise<std::vector<Tensor>> promise;
+    try {
+      promise.set_value(this->operator()(inputs));
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+  }
+
   virtual ~BaseEngine() {}
 };
 
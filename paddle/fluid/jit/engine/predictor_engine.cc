@@ -25,7 +25,8 @@ namespace jit {
 PredictorEngine::PredictorEngine(
     const std::shared_ptr<FunctionInfo> &info,
     const std::shared_ptr<VariableMap> &params_dict,
-    const phi::Place &place)
+    const phi::Place &place,
+    void *stream)
     : info_(info),
       params_dict_(params_dict),
       scope_(new framework::Scope()),
@@ -38,6 +39,9 @@ PredictorEngine::PredictorEngine(
   config.SetProgFile(info->ProgramFilePath());
   if (phi::is_gpu_place(place_)) {
     config.EnableUseGpu(100, place_.GetDeviceId());
+    if (stream != nullptr) {
+      config.SetExecStream(stream);
+    }
   } else if (phi::is_cpu_place(place_)) {
     config.DisableGpu();
     config.EnableMKLDNN();
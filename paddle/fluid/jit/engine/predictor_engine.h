@@ -30,9 +30,12 @@ namespace jit {
 
 class PredictorEngine : public BaseEngine {
  public:
+  // The predictor runs on stream if it is given, which is required to clone
+  // the predictor on the other streams.
   PredictorEngine(const std::shared_ptr<FunctionInfo> &info,
                   const std::shared_ptr<VariableMap> &params_dict,
-                  const phi::Place &place);
+                  const phi::Place &place,
+                  void *stream = nullptr);
 
   PredictorEngine(const std::shared_ptr<FunctionInfo> &info,
                   const std::shared_ptr<framework::Scope> &scope,
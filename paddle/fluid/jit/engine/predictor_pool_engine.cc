@@ -0,0 +1,163 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/jit/engine/predictor_pool_engine.h"
+
+#include "paddle/fluid/inference/api/resource_manager.h"
+#include "paddle/fluid/jit/engine/predictor_engine.h"
+#include "paddle/fluid/jit/function_utils.h"
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+
+namespace paddle {
+namespace jit {
+
+PredictorPoolEngine::PredictorPoolEngine(
+    const std::shared_ptr<FunctionInfo> &info,
+    const std::shared_ptr<VariableMap> &params_dict,
+    const phi::Place &place,
+    int pool_size)
+    : info_(info), params_dict_(params_dict), place_(place) {
+  PADDLE_ENFORCE_GT(pool_size,
+                    0,
+                    phi::errors::InvalidArgument(
+                        "The size of the predictor pool should be positive, "
+                        "but received %d.",
+                        pool_size));
+  void *stream = NewStream();
+  InitSlots(
+      std::make_unique<PredictorEngine>(info, params_dict, place, stream),
+      stream,
+      pool_size);
+}
+
+PredictorPoolEngine::PredictorPoolEngine(const PredictorPoolEngine &other)
+    : info_(other.info_),
+      params_dict_(other.params_dict_),
+      place_(other.place_) {
+  void *stream = NewStream();
+  InitSlots(
+      other.slots_[0]->engine->Clone(stream), stream, other.slots_.size());
+}
+
+PredictorPoolEngine::~PredictorPoolEngine() noexcept {
+  // waits for the queued requests before the predictors are destroyed
+  thread_pool_.reset();
+  std::vector<void *> streams;
+  for (auto &slot : slots_) {
+    streams.push_back(slot->stream);
+  }
+  idle_slots_.clear();
+  slots_.clear();
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  for (void *stream : streams) {
+    if (stream != nullptr) {
+      ResourceManager::Instance().DestroyGPUResource(stream);
+    }
+  }
+#endif
+}
+
+void *PredictorPoolEngine::NewStream() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (phi::is_gpu_place(place_)) {
+    return ResourceManager::Instance().InitGPUResource(place_, nullptr, 0);
+  }
+#endif
+  return nullptr;
+}
+
+void PredictorPoolEngine::InitSlots(std::unique_ptr<BaseEngine> engine,
+                                    void *stream,
+                                    size_t pool_size) {
+  slots_.emplace_back(new Slot{std::move(engine), stream});
+  for (size_t i = 1; i < pool_size; ++i) {
+    void *clone_stream = NewStream();
+    slots_.emplace_back(
+        new Slot{slots_[0]->engine->Clone(clone_stream), clone_stream});
+  }
+  for (auto &slot : slots_) {
+    idle_slots_.push_back(slot.get());
+  }
+  thread_pool_ = std::make_unique<phi::ThreadPool>(pool_size);
+  VLOG(3) << "Create a pool of " << pool_size << " predictors for function "
+          << info_->FunctionName();
+}
+
+PredictorPoolEngine::Slot *PredictorPoolEngine::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return !idle_slots_.empty(); });
+  Slot *slot = idle_slots_.back();
+  idle_slots_.pop_back();
+  return slot;
+}
+
+void PredictorPoolEngine::Release(Slot *slot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_slots_.push_back(slot);
+  }
+  idle_cv_.notify_one();
+}
+
+std::vector<Tensor> PredictorPoolEngine::operator()(
+    const std::vector<Tensor> &inputs) {
+  Slot *slot = Acquire();
+  std::vector<Tensor> outputs;
+  try {
+    outputs = (*slot->engine)(inputs);
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    // the outputs are used on the other streams once they are returned
+    if (slot->stream != nullptr) {
+      platform::GpuStreamSync(static_cast<gpuStream_t>(slot->stream));
+    }
+#endif
+  } catch (...) {
+    Release(slot);
+    throw;
+  }
+  Release(slot);
+  return outputs;
+}
+
+std::vector<DenseTensor> PredictorPoolEngine::operator()(
+    const std::vector<DenseTensor> &inputs) {
+  return utils::ToDenseTensors(this->operator()(utils::ToTensors(inputs)));
+}
+
+std::future<std::vector<Tensor>> PredictorPoolEngine::RunAsync(
+    const std::vector<Tensor> &inputs) {
+  auto promise = std::make_shared<std::promise<std::vector<Tensor>>>();
+  auto future = promise->get_future();
+  thread_pool_->RunAndGetException([this, promise, inputs] {
+    try {
+      promise->set_value(this->operator()(inputs));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+  return future;
+}
+
+std::unique_ptr<BaseEngine> PredictorPoolEngine::Clone(void *stream) {
+  PADDLE_ENFORCE_EQ(
+      stream == nullptr,
+      true,
+      phi::errors::InvalidArgument(
+          "The predictors of a pool run on the streams of their own, cloning "
+          "the pool on a given stream is not supported."));
+  return std::unique_ptr<BaseEngine>(new PredictorPoolEngine(*this));
+}
+
+}  // namespace jit
+}  // namespace paddle
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "paddle/fluid/jit/engine/base_engine.h"
+#include "paddle/fluid/jit/function_schema.h"
+#include "paddle/fluid/jit/function_utils.h"
+#include "paddle/phi/core/threadpool.h"
+
+namespace paddle {
+namespace jit {
+
+// Runs a function on a pool of predictors, so that the requests of many
+// threads run concurrently instead of one after another on one predictor.
+// The predictors are cloned from the first one and share its optimized
+// program and parameters. On GPU each of them runs on a stream of its own,
+// so that the kernels of the concurrent requests overlap on the device.
+class PredictorPoolEngine : public BaseEngine {
+ public:
+  PredictorPoolEngine(const std::shared_ptr<FunctionInfo> &info,
+                      const std::shared_ptr<VariableMap> &params_dict,
+                      const phi::Place &place,
+                      int pool_size);
+
+  ~PredictorPoolEngine() noexcept;
+
+  // Blocks until a predictor of the pool is idle and runs the inputs on it.
+  std::vector<Tensor> operator()(const std::vector<Tensor> &inputs) override;
+
+  std::vector<DenseTensor> operator()(
+      const std::vector<DenseTensor> &inputs) override;
+
+  // Runs the inputs on the threads of the pool, at most pool_size requests
+  // run at the same time and the others wait in the queue.
+  std::future<std::vector<Tensor>> RunAsync(
+      const std::vector<Tensor> &inputs) override;
+
+  // Clones a pool of the same size, whose predictors are cloned from this
+  // one on the streams of their own.
+  std::unique_ptr<BaseEngine> Clone(void *stream = nullptr) override;
+
+ private:
+  struct Slot {
+    std::unique_ptr<BaseEngine> engine;
+    void *stream;
+  };
+
+  explicit PredictorPoolEngine(const PredictorPoolEngine &other);
+
+  void *NewStream();
+
+  void InitSlots(std::unique_ptr<BaseEngine> engine,
+                 void *stream,
+                 size_t pool_size);
+
+  Slot *Acquire();
+
+  void Release(Slot *slot);
+
+  std::shared_ptr<FunctionInfo> info_;
+  std::shared_ptr<VariableMap> params_dict_;
+  phi::Place place_;
+
+  std::vector<std::unique_ptr<Slot>> slots_;
+  std::mutex mutex_;
+  std::condition_variable idle_cv_;
+  std::vector<Slot *> idle_slots_;
+  std::unique_ptr<phi::ThreadPool> thread_pool_;
+};
+
+}  // namespace jit
+}  // namespace paddle
@@ -47,5 +47,14 @@ std::vector<DenseTensor> Function::operator()(
   return (*engine_)(inputs);
 }
 
+std::future<std::vector<Tensor>> Function::RunAsync(
+    const std::vector<Tensor>& inputs) const {
+  PADDLE_ENFORCE_EQ(IsValid(),
+                    true,
+                    phi::errors::PreconditionNotMet(
+                        "Function engine ptr is nullptr, please check it."));
+  return engine_->RunAsync(inputs);
+}
+
 }  // namespace jit
 }  // namespace paddle
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <future>
 #include <string>
 #include <vector>
 
@@ -35,6 +36,11 @@ class Function {
   std::vector<DenseTensor> operator()(
       const std::vector<DenseTensor>& inputs) const;
 
+  // Runs the function without waiting for it, the requests run concurrently
+  // if the function runs on a pool of predictors.
+  std::future<std::vector<Tensor>> RunAsync(
+      const std::vector<Tensor>& inputs) const;
+
   bool IsValid() const { return engine_ != nullptr; }
 
   ~Function() = default;
@@ -51,6 +51,12 @@ std::vector<DenseTensor> Layer::forward(
   return func(inputs);
 }
 
+std::future<std::vector<Tensor>> Layer::ForwardAsync(
+    const std::vector<Tensor>& inputs) {
+  auto func = this->Function("forward");
+  return func.RunAsync(inputs);
+}
+
 void Layer::to(const phi::Place& place) {}
 
 void Layer::SetEngine(const std::string& name,
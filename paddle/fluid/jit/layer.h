@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -57,6 +58,9 @@ class Layer {
 
   std::vector<DenseTensor> forward(const std::vector<DenseTensor>& inputs);
 
+  std::future<std::vector<Tensor>> ForwardAsync(
+      const std::vector<Tensor>& inputs);
+
   void to(const phi::Place& place);
 
   void SetEngine(const std::string& name,
@@ -23,11 +23,13 @@
 #include "paddle/common/flags.h"
 #include "paddle/fluid/jit/engine/interpreter_engine.h"
 #include "paddle/fluid/jit/engine/predictor_engine.h"
+#include "paddle/fluid/jit/engine/predictor_pool_engine.h"
 #include "paddle/fluid/jit/layer.h"
 #include "paddle/fluid/jit/property.h"
 #include "paddle/fluid/jit/serializer_utils.h"
 
 COMMON_DECLARE_string(jit_engine_type);
+COMMON_DECLARE_int32(jit_predictor_pool_size);
 
 namespace paddle {
 namespace jit {
@@ -79,6 +81,14 @@ Layer Deserializer::operator()(const std::string& path,
       layer.SetEngine(
           func_name,
           utils::MakeEngine<InterpreterEngine>(info, params_dict, place));
+    } else if (FLAGS_jit_engine_type == "Predictor" &&
+               FLAGS_jit_predictor_pool_size > 0) {
+      layer.SetEngine(info->FunctionName(),
+                      std::make_shared<PredictorPoolEngine>(
+                          info,
+                          params_dict,
+                          place,
+                          FLAGS_jit_predictor_pool_size));
     } else if (FLAGS_jit_engine_type == "Predictor") {
       layer.SetEngine(
           info->FunctionName(),
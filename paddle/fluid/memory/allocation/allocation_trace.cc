@@ -0,0 +1,238 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocation_trace.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/platform/enforce.h"
+
+PHI_DEFINE_EXPORTED_string(
+    allocation_trace_file,
+    "",
+    "The file to record the trace of all the Allocate and Free of the "
+    "allocators, which can be replayed by allocation_trace_replay to "
+    "compare the allocator strategies offline. Empty means no trace. It is "
+    "read at the first allocation.");
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+constexpr char kTraceMagic[8] = {'P', 'D', 'A', 'L', 'T', 'R', 'C', '\0'};
+constexpr uint32_t kTraceVersion = 1;
+// the records are written to the file when the buffer is full
+constexpr size_t kTraceBufferSize = 1 << 20;
+
+struct AllocationTraceHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+};
+
+thread_local uint32_t current_tag = 0;
+
+void WriteHeader(FILE* file) {
+  AllocationTraceHeader header;
+  std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+  header.version = kTraceVersion;
+  header.record_size = sizeof(AllocationTraceRecord);
+  PADDLE_ENFORCE_EQ(
+      fwrite(&header, sizeof(header), 1, file),
+      1,
+      common::errors::Unavailable("Failed to write the allocation trace."));
+}
+
+}  // namespace
+
+bool AllocationTraceRecorder::IsEnabled() {
+  static const bool enabled = !FLAGS_allocation_trace_file.empty();
+  return enabled;
+}
+
+AllocationTraceRecorder& AllocationTraceRecorder::Instance() {
+  // leaked, so that the allocations freed by the static objects can still be
+  // recorded
+  static auto* recorder =
+      new AllocationTraceRecorder(FLAGS_allocation_trace_file);
+  return *recorder;
+}
+
+AllocationTraceRecorder::AllocationTraceRecorder(const std::string& path)
+    : start_(std::chrono::steady_clock::now()) {
+  file_ = fopen(path.c_str(), "wb");
+  PADDLE_ENFORCE_NOT_NULL(
+      file_,
+      common::errors::Unavailable("Cannot open the allocation trace file %s.",
+                                  path));
+  WriteHeader(file_);
+  buffer_.reserve(kTraceBufferSize);
+  std::atexit([] { AllocationTraceRecorder::Instance().Flush(); });
+  VLOG(1) << "Record the allocation trace into " << path;
+}
+
+void AllocationTraceRecorder::RecordAllocate(const phi::Allocation& allocation,
+                                             uint64_t stream) {
+  Record(allocation, stream, AllocationTraceEventType::kAllocate);
+}
+
+void AllocationTraceRecorder::RecordFree(const phi::Allocation& allocation,
+                                         uint64_t stream) {
+  Record(allocation, stream, AllocationTraceEventType::kFree);
+}
+
+void AllocationTraceRecorder::Record(const phi::Allocation& allocation,
+                                     uint64_t stream,
+                                     AllocationTraceEventType type) {
+  AllocationTraceRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - start_)
+                         .count();
+  record.ptr = reinterpret_cast<uint64_t>(allocation.ptr());
+  record.size = allocation.size();
+  record.stream = stream;
+  record.tag = current_tag;
+  record.device_id = static_cast<int16_t>(allocation.place().GetDeviceId());
+  record.place_type = static_cast<uint8_t>(allocation.place().GetType());
+  record.type = static_cast<uint8_t>(type);
+  std::lock_guard<std::mutex> guard(mutex_);
+  Append(&record, sizeof(record));
+}
+
+uint32_t AllocationTraceRecorder::TagId(const std::string& tag) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = tag_ids_.find(tag);
+  if (iter != tag_ids_.end()) {
+    return iter->second;
+  }
+  uint32_t id = static_cast<uint32_t>(tag_ids_.size() + 1);
+  tag_ids_.emplace(tag, id);
+
+  AllocationTraceRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.size = tag.size();
+  record.tag = id;
+  record.type = static_cast<uint8_t>(AllocationTraceEventType::kTag);
+  Append(&record, sizeof(record));
+  Append(tag.data(), tag.size());
+  return id;
+}
+
+void AllocationTraceRecorder::Append(const void* data, size_t size) {
+  const char* begin = static_cast<const char*>(data);
+  buffer_.insert(buffer_.end(), begin, begin + size);
+  if (buffer_.size() >= kTraceBufferSize) {
+    fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    buffer_.clear();
+  }
+}
+
+void AllocationTraceRecorder::Flush() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!buffer_.empty()) {
+    fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    buffer_.clear();
+  }
+  fflush(file_);
+}
+
+uint32_t AllocationTraceRecorder::CurrentTag() { return current_tag; }
+
+void AllocationTraceRecorder::SetCurrentTag(uint32_t tag) {
+  current_tag = tag;
+}
+
+AllocationTraceTagGuard::AllocationTraceTagGuard(const std::string& tag)
+    : enabled_(AllocationTraceRecorder::IsEnabled()) {
+  if (enabled_) {
+    prev_tag_ = AllocationTraceRecorder::CurrentTag();
+    AllocationTraceRecorder::SetCurrentTag(
+        AllocationTraceRecorder::Instance().TagId(tag));
+  }
+}
+
+AllocationTraceTagGuard::~AllocationTraceTagGuard() {
+  if (enabled_) {
+    AllocationTraceRecorder::SetCurrentTag(prev_tag_);
+  }
+}
+
+AllocationTrace LoadAllocationTrace(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  PADDLE_ENFORCE_NOT_NULL(
+      file,
+      common::errors::NotFound("Cannot open the allocation trace file %s.",
+                               path));
+
+  AllocationTraceHeader header;
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+               std::memcmp(header.magic, kTraceMagic, sizeof(kTraceMagic)) ==
+                   0 &&
+               header.version == kTraceVersion &&
+               header.record_size == sizeof(AllocationTraceRecord);
+  if (!valid) {
+    fclose(file);
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "%s is not an allocation trace file of version %d.",
+        path,
+        kTraceVersion));
+  }
+
+  AllocationTrace trace;
+  AllocationTraceRecord record;
+  while (fread(&record, sizeof(record), 1, file) == 1) {
+    if (record.type == static_cast<uint8_t>(AllocationTraceEventType::kTag)) {
+      std::string tag(record.size, '\0');
+      if (record.size > 0 && fread(&tag[0], record.size, 1, file) != 1) {
+        break;
+      }
+      trace.tags[record.tag] = std::move(tag);
+    } else {
+      trace.records.push_back(record);
+    }
+  }
+  fclose(file);
+  VLOG(1) << "Load " << trace.records.size() << " records and "
+          << trace.tags.size() << " tags from " << path;
+  return trace;
+}
+
+void SaveAllocationTrace(const AllocationTrace& trace,
+                         const std::string& path) {
+  FILE* file = fopen(path.c_str(), "wb");
+  PADDLE_ENFORCE_NOT_NULL(
+      file,
+      common::errors::Unavailable("Cannot open the allocation trace file %s.",
+                                  path));
+  WriteHeader(file);
+  for (auto& [id, tag] : trace.tags) {
+    AllocationTraceRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.size = tag.size();
+    record.tag = id;
+    record.type = static_cast<uint8_t>(AllocationTraceEventType::kTag);
+    fwrite(&record, sizeof(record), 1, file);
+    fwrite(tag.data(), 1, tag.size(), file);
+  }
+  fwrite(trace.records.data(),
+         sizeof(AllocationTraceRecord),
+         trace.records.size(),
+         file);
+  fclose(file);
+}
+
+}  // namespace paddle::memory::allocation
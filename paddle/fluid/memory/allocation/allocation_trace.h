@@ -0,0 +1,122 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/core/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The trace file consists of a header and a sequence of fixed-size records.
+// A kTag record defines the name of a call-site tag, whose size bytes follow
+// the record; the other records refer to the tags by their ids, and 0 means
+// no tag.
+enum class AllocationTraceEventType : uint8_t {
+  kAllocate = 0,
+  kFree = 1,
+  kTag = 2,
+};
+
+struct AllocationTraceRecord {
+  // nanoseconds since the recorder is created
+  uint64_t timestamp;
+  uint64_t ptr;
+  uint64_t size;
+  uint64_t stream;
+  uint32_t tag;
+  int16_t device_id;
+  // phi::AllocationType
+  uint8_t place_type;
+  // AllocationTraceEventType
+  uint8_t type;
+};
+
+static_assert(sizeof(AllocationTraceRecord) == 40,
+              "The layout of AllocationTraceRecord is part of the trace file "
+              "format and should not be changed.");
+
+struct AllocationTrace {
+  std::vector<AllocationTraceRecord> records;
+  std::unordered_map<uint32_t, std::string> tags;
+};
+
+// Records the Allocate and Free of StatAllocator into the file of
+// FLAGS_allocation_trace_file, which can be replayed offline by
+// allocation_trace_replay against the different allocator strategies.
+class AllocationTraceRecorder {
+ public:
+  static bool IsEnabled();
+
+  static AllocationTraceRecorder& Instance();
+
+  void RecordAllocate(const phi::Allocation& allocation, uint64_t stream);
+
+  void RecordFree(const phi::Allocation& allocation, uint64_t stream);
+
+  // Returns the id of the tag, and records its name if it is new.
+  uint32_t TagId(const std::string& tag);
+
+  void Flush();
+
+  static uint32_t CurrentTag();
+
+  static void SetCurrentTag(uint32_t tag);
+
+ private:
+  explicit AllocationTraceRecorder(const std::string& path);
+
+  void Record(const phi::Allocation& allocation,
+              uint64_t stream,
+              AllocationTraceEventType type);
+
+  // REQUIRES: mutex_ is held
+  void Append(const void* data, size_t size);
+
+  std::mutex mutex_;
+  FILE* file_{nullptr};
+  std::vector<char> buffer_;
+  std::unordered_map<std::string, uint32_t> tag_ids_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Sets the call-site tag of the allocations on the current thread in its
+// scope. It does nothing if the trace is not enabled.
+class AllocationTraceTagGuard {
+ public:
+  explicit AllocationTraceTagGuard(const std::string& tag);
+
+  ~AllocationTraceTagGuard();
+
+ private:
+  bool enabled_;
+  uint32_t prev_tag_{0};
+};
+
+AllocationTrace LoadAllocationTrace(const std::string& path);
+
+void SaveAllocationTrace(const AllocationTrace& trace, const std::string& path);
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
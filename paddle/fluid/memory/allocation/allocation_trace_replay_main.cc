@@ -0,0 +1,139 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays an allocation trace recorded with FLAGS_allocation_trace_file
+// against the allocator strategies, e.g.
+//
+//   allocation_trace_replay trace.bin --place=gpu:0 \
+//       --strategies=auto_growth,naive_best_fit
+//
+// and prints the peak reserved memory, the fragmentation and the allocator
+// time of each strategy.
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocation_trace_replayer.h"
+#include "paddle/utils/string/printf.h"
+
+namespace {
+
+using paddle::memory::allocation::AllocationTraceReplayOptions;
+
+void PrintUsage(const char* name) {
+  std::cerr << "Usage: " << name << " <trace file> [options]\n"
+            << "  --place=gpu:0|cpu|gpu_pinned|xpu:0  the place to replay\n"
+            << "  --strategies=s1,s2,...  default all of";
+  for (auto& strategy :
+       paddle::memory::allocation::AllocationTraceReplayStrategies()) {
+    std::cerr << " " << strategy;
+  }
+  std::cerr << "\n"
+            << "  --alignment=256\n"
+            << "  --auto_growth_chunk_size_in_mb=0\n"
+            << "  --naive_best_fit_chunk_size_in_mb=1024\n"
+            << "  --allow_free_idle_chunk=1\n";
+}
+
+std::vector<std::string> Split(const std::string& str) {
+  std::vector<std::string> items;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+bool ParsePlace(const std::string& place,
+                AllocationTraceReplayOptions* options) {
+  std::string type = place.substr(0, place.find(':'));
+  options->device_id =
+      place.find(':') == std::string::npos
+          ? 0
+          : std::stoi(place.substr(place.find(':') + 1));
+  if (type == "gpu") {
+    options->place_type = phi::AllocationType::GPU;
+  } else if (type == "cpu") {
+    options->place_type = phi::AllocationType::CPU;
+  } else if (type == "gpu_pinned") {
+    options->place_type = phi::AllocationType::GPUPINNED;
+  } else if (type == "xpu") {
+    options->place_type = phi::AllocationType::XPU;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  AllocationTraceReplayOptions options;
+  std::vector<std::string> strategies =
+      paddle::memory::allocation::AllocationTraceReplayStrategies();
+  for (int i = 2; i < argc; ++i) {
+    std::string arg(argv[i]);
+    size_t pos = arg.find('=');
+    std::string key = arg.substr(0, pos);
+    std::string value = pos == std::string::npos ? "" : arg.substr(pos + 1);
+    if (key == "--place") {
+      if (!ParsePlace(value, &options)) {
+        PrintUsage(argv[0]);
+        return 1;
+      }
+    } else if (key == "--strategies") {
+      strategies = Split(value);
+    } else if (key == "--alignment") {
+      options.alignment = std::stoull(value);
+    } else if (key == "--auto_growth_chunk_size_in_mb") {
+      options.auto_growth_chunk_size = std::stoull(value) << 20;
+    } else if (key == "--naive_best_fit_chunk_size_in_mb") {
+      options.naive_best_fit_chunk_size = std::stoull(value) << 20;
+    } else if (key == "--allow_free_idle_chunk") {
+      options.allow_free_idle_chunk = value != "0" && value != "false";
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  auto trace = paddle::memory::allocation::LoadAllocationTrace(argv[1]);
+  std::cout << std::left << std::setw(20) << "strategy" << std::setw(14)
+            << "allocations" << std::setw(16) << "peak_allocated"
+            << std::setw(16) << "peak_reserved" << std::setw(16)
+            << "fragmentation" << "allocator_time_ms" << std::endl;
+  for (auto& strategy : strategies) {
+    auto result = paddle::memory::allocation::ReplayAllocationTrace(
+        trace, strategy, options);
+    std::cout << std::left << std::setw(20) << result.strategy
+              << std::setw(14) << result.num_allocations << std::setw(16)
+              << paddle::string::HumanReadableSize(result.peak_allocated)
+              << std::setw(16)
+              << paddle::string::HumanReadableSize(result.peak_reserved)
+              << std::setw(16) << std::fixed << std::setprecision(4)
+              << result.fragmentation << std::setprecision(3)
+              << result.allocator_time_ms << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,337 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocation_trace_replayer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/buddy_allocator.h"
+#include "paddle/fluid/memory/allocation/system_allocator.h"
+#include "paddle/fluid/platform/enforce.h"
+
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/cuda_malloc_async_allocator.h"
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#endif
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+// Counts the bytes reserved from the system by the replayed allocators.
+class ReplayReservedCounter {
+ public:
+  void* Allocate(size_t size) {
+    void* ptr = std::malloc(size);  // NOLINT
+    if (ptr == nullptr) {
+      PADDLE_THROW_BAD_ALLOC(common::errors::ResourceExhausted(
+          "Cannot allocate %d bytes of host memory to replay the trace.",
+          size));
+    }
+    reserved_ += size;
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t size) {
+    std::free(ptr);  // NOLINT
+    reserved_ -= size;
+  }
+
+  uint64_t Reserved() const { return reserved_; }
+
+ private:
+  uint64_t reserved_{0};
+};
+
+class ReplayUnderlyingAllocator : public Allocator {
+ public:
+  ReplayUnderlyingAllocator(ReplayReservedCounter* counter, phi::Place place)
+      : counter_(counter), place_(place) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override {
+    return new Allocation(counter_->Allocate(size), size, place_);
+  }
+
+  void FreeImpl(phi::Allocation* allocation) override {
+    counter_->Free(allocation->ptr(), allocation->size());
+    delete allocation;
+  }
+
+ private:
+  ReplayReservedCounter* counter_;
+  phi::Place place_;
+};
+
+class ReplaySystemAllocator : public detail::SystemAllocator {
+ public:
+  explicit ReplaySystemAllocator(ReplayReservedCounter* counter)
+      : counter_(counter) {}
+
+  void* Alloc(size_t* index, size_t size) override {
+    *index = 0;
+    return counter_->Allocate(size);
+  }
+
+  void Free(void* p, size_t size, size_t index) override {
+    counter_->Free(p, size);
+  }
+
+  // the metadata of BuddyAllocator is kept in the host memory
+  bool UseGpu() const override { return false; }
+
+ private:
+  ReplayReservedCounter* counter_;
+};
+
+// The allocations are identified by their pointers in the trace.
+class ReplayStrategy {
+ public:
+  virtual ~ReplayStrategy() = default;
+
+  virtual void Allocate(uint64_t id, size_t size, uint64_t stream) = 0;
+
+  virtual void Free(uint64_t id) = 0;
+
+  virtual uint64_t Reserved() = 0;
+};
+
+class AutoGrowthReplayStrategy : public ReplayStrategy {
+ public:
+  explicit AutoGrowthReplayStrategy(const AllocationTraceReplayOptions& options)
+      : options_(options),
+        underlying_allocator_(std::make_shared<ReplayUnderlyingAllocator>(
+            &counter_, phi::CPUPlace())) {}
+
+  void Allocate(uint64_t id, size_t size, uint64_t stream) override {
+    // one allocator for each stream, the same as AllocatorFacade
+    auto& allocator = allocators_[stream];
+    if (allocator == nullptr) {
+      allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+          underlying_allocator_,
+          options_.alignment,
+          options_.auto_growth_chunk_size,
+          options_.allow_free_idle_chunk);
+    }
+    allocations_[id] = allocator->Allocate(size);
+  }
+
+  void Free(uint64_t id) override { allocations_.erase(id); }
+
+  uint64_t Reserved() override { return counter_.Reserved(); }
+
+ private:
+  AllocationTraceReplayOptions options_;
+  ReplayReservedCounter counter_;
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::unordered_map<uint64_t, std::shared_ptr<Allocator>> allocators_;
+  std::unordered_map<uint64_t, AllocationPtr> allocations_;
+};
+
+class NaiveBestFitReplayStrategy : public ReplayStrategy {
+ public:
+  explicit NaiveBestFitReplayStrategy(
+      const AllocationTraceReplayOptions& options)
+      : allocator_(std::make_unique<detail::BuddyAllocator>(
+            std::make_unique<ReplaySystemAllocator>(&counter_),
+            options.alignment,
+            options.naive_best_fit_chunk_size)) {}
+
+  ~NaiveBestFitReplayStrategy() override {
+    for (auto& [id, ptr] : ptrs_) {
+      allocator_->Free(ptr);
+    }
+  }
+
+  void Allocate(uint64_t id, size_t size, uint64_t stream) override {
+    void* ptr = allocator_->Alloc(size);
+    PADDLE_ENFORCE_NOT_NULL(ptr,
+                            common::errors::ResourceExhausted(
+                                "BuddyAllocator failed to allocate %d bytes "
+                                "when replaying the trace.",
+                                size));
+    ptrs_[id] = ptr;
+  }
+
+  void Free(uint64_t id) override {
+    auto iter = ptrs_.find(id);
+    if (iter != ptrs_.end()) {
+      allocator_->Free(iter->second);
+      ptrs_.erase(iter);
+    }
+  }
+
+  uint64_t Reserved() override { return counter_.Reserved(); }
+
+ private:
+  ReplayReservedCounter counter_;
+  std::unique_ptr<detail::BuddyAllocator> allocator_;
+  std::unordered_map<uint64_t, void*> ptrs_;
+};
+
+#ifdef PADDLE_WITH_CUDA
+// Replays against the real cudaMallocAsync pool of the device, and the streams
+// of the trace are mapped to the new streams.
+class CUDAMallocAsyncReplayStrategy : public ReplayStrategy {
+ public:
+  explicit CUDAMallocAsyncReplayStrategy(
+      const AllocationTraceReplayOptions& options)
+      : place_(options.device_id) {
+    platform::SetDeviceId(place_.device);
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaDeviceGetDefaultMemPool(&mempool_, place_.device));
+    base_reserved_ = PoolReserved();
+  }
+
+  ~CUDAMallocAsyncReplayStrategy() override {
+    allocations_.clear();
+    for (auto& [stream, allocator] : allocators_) {
+      allocator->ClearFreeStream(true);
+      PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(streams_[stream]));
+    }
+    allocators_.clear();
+    for (auto& [id, stream] : streams_) {
+      PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamDestroy(stream));
+    }
+  }
+
+  void Allocate(uint64_t id, size_t size, uint64_t stream) override {
+    auto& allocator = allocators_[stream];
+    if (allocator == nullptr) {
+      gpuStream_t cuda_stream = nullptr;
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          cudaStreamCreateWithFlags(&cuda_stream, cudaStreamNonBlocking));
+      streams_[stream] = cuda_stream;
+      allocator = std::make_shared<CUDAMallocAsyncAllocator>(
+          nullptr, place_, cuda_stream);
+    }
+    allocations_[id] = allocator->Allocate(size);
+  }
+
+  void Free(uint64_t id) override { allocations_.erase(id); }
+
+  uint64_t Reserved() override {
+    uint64_t reserved = PoolReserved();
+    return reserved > base_reserved_ ? reserved - base_reserved_ : 0;
+  }
+
+ private:
+  uint64_t PoolReserved() {
+    cuuint64_t reserved = 0;
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaMemPoolGetAttribute(
+        mempool_, cudaMemPoolAttrReservedMemCurrent, &reserved));
+    return reserved;
+  }
+
+  phi::GPUPlace place_;
+  cudaMemPool_t mempool_;
+  uint64_t base_reserved_{0};
+  std::unordered_map<uint64_t, gpuStream_t> streams_;
+  std::unordered_map<uint64_t, std::shared_ptr<CUDAMallocAsyncAllocator>>
+      allocators_;
+  std::unordered_map<uint64_t, AllocationPtr> allocations_;
+};
+#endif
+
+std::unique_ptr<ReplayStrategy> CreateReplayStrategy(
+    const std::string& strategy, const AllocationTraceReplayOptions& options) {
+  if (strategy == "auto_growth") {
+    return std::make_unique<AutoGrowthReplayStrategy>(options);
+  } else if (strategy == "naive_best_fit") {
+    return std::make_unique<NaiveBestFitReplayStrategy>(options);
+#ifdef PADDLE_WITH_CUDA
+  } else if (strategy == "cuda_malloc_async") {
+    return std::make_unique<CUDAMallocAsyncReplayStrategy>(options);
+#endif
+  }
+  PADDLE_THROW(common::errors::InvalidArgument(
+      "Unsupported allocator strategy %s to replay the trace.", strategy));
+}
+
+}  // namespace
+
+std::vector<std::string> AllocationTraceReplayStrategies() {
+  std::vector<std::string> strategies = {"auto_growth", "naive_best_fit"};
+#ifdef PADDLE_WITH_CUDA
+  strategies.emplace_back("cuda_malloc_async");
+#endif
+  return strategies;
+}
+
+AllocationTraceReplayResult ReplayAllocationTrace(
+    const AllocationTrace& trace,
+    const std::string& strategy,
+    const AllocationTraceReplayOptions& options) {
+  auto replay_strategy = CreateReplayStrategy(strategy, options);
+  AllocationTraceReplayResult result;
+  result.strategy = strategy;
+
+  // the requested sizes of the allocations in use
+  std::unordered_map<uint64_t, uint64_t> sizes;
+  uint64_t allocated = 0;
+  std::chrono::steady_clock::duration allocator_time{0};
+  for (auto& record : trace.records) {
+    if (record.place_type != static_cast<uint8_t>(options.place_type) ||
+        record.device_id != options.device_id) {
+      continue;
+    }
+    auto start = std::chrono::steady_clock::now();
+    if (record.type ==
+        static_cast<uint8_t>(AllocationTraceEventType::kAllocate)) {
+      if (sizes.count(record.ptr) != 0) {
+        // the free of the previous allocation of this ptr is not recorded
+        replay_strategy->Free(record.ptr);
+        allocated -= sizes[record.ptr];
+      }
+      replay_strategy->Allocate(record.ptr, record.size, record.stream);
+      allocator_time += std::chrono::steady_clock::now() - start;
+      sizes[record.ptr] = record.size;
+      allocated += record.size;
+      ++result.num_allocations;
+      result.peak_allocated = std::max(result.peak_allocated, allocated);
+    } else if (record.type ==
+               static_cast<uint8_t>(AllocationTraceEventType::kFree)) {
+      auto iter = sizes.find(record.ptr);
+      if (iter == sizes.end()) {
+        continue;
+      }
+      replay_strategy->Free(record.ptr);
+      allocator_time += std::chrono::steady_clock::now() - start;
+      allocated -= iter->second;
+      sizes.erase(iter);
+    }
+
+    uint64_t reserved = replay_strategy->Reserved();
+    if (reserved > result.peak_reserved) {
+      result.peak_reserved = reserved;
+      result.fragmentation =
+          1.0 - static_cast<double>(allocated) / static_cast<double>(reserved);
+    }
+  }
+  result.allocator_time_ms =
+      std::chrono::duration<double, std::milli>(allocator_time).count();
+  VLOG(1) << "Replay " << result.num_allocations << " allocations by "
+          << strategy << ", peak reserved " << result.peak_reserved;
+  return result;
+}
+
+}  // namespace paddle::memory::allocation
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocation_trace.h"
+#include "paddle/phi/common/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+struct AllocationTraceReplayOptions {
+  // only the records of this place are replayed
+  phi::AllocationType place_type{phi::AllocationType::GPU};
+  int device_id{0};
+  size_t alignment{256};
+  // the chunk size of auto_growth, 0 means the size of each allocation
+  size_t auto_growth_chunk_size{0};
+  // the size of the chunks allocated from the system by naive_best_fit
+  size_t naive_best_fit_chunk_size{static_cast<size_t>(1) << 30};
+  bool allow_free_idle_chunk{true};
+};
+
+struct AllocationTraceReplayResult {
+  std::string strategy;
+  size_t num_allocations{0};
+  // the peak of the bytes requested by the allocations in use
+  uint64_t peak_allocated{0};
+  uint64_t peak_reserved{0};
+  // 1 - allocated / reserved when the reserved bytes reach their peak
+  double fragmentation{0};
+  // the time spent in Allocate and Free
+  double allocator_time_ms{0};
+};
+
+// Returns the strategies which can be replayed in this build.
+std::vector<std::string> AllocationTraceReplayStrategies();
+
+// Replays the Allocate and Free of the trace in order against the allocator
+// strategy. The memory of auto_growth and naive_best_fit is simulated by the
+// host memory, which is not touched except by the allocators' metadata.
+AllocationTraceReplayResult ReplayAllocationTrace(
+    const AllocationTrace& trace,
+    const std::string& strategy,
+    const AllocationTraceReplayOptions& options);
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
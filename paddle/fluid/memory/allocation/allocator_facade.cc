@@ -24,6 +24,7 @@
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/slab_cache_allocator.h"
 #include "paddle/fluid/memory/allocation/stat_allocator.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -35,6 +36,7 @@
 
 #include "paddle/fluid/memory/allocation/cuda_allocator.h"
 #include "paddle/fluid/memory/allocation/cuda_managed_allocator.h"
+#include "paddle/fluid/memory/allocation/numa_pinned_allocator.h"
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
 #include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
 #include "paddle/fluid/memory/allocation/thread_local_allocator.h"
@@ -113,7 +115,11 @@ PHI_DEFINE_EXPORTED_bool(
 
 COMMON_DECLARE_string(allocator_strategy);
 COMMON_DECLARE_uint64(auto_growth_chunk_size_in_mb);
+COMMON_DECLARE_uint64(auto_growth_slab_max_size_in_kb);
+COMMON_DECLARE_uint64(auto_growth_slab_thread_cache_size_in_mb);
 COMMON_DECLARE_bool(use_auto_growth_pinned_allocator);
+COMMON_DECLARE_bool(use_numa_pinned_allocator);
+COMMON_DECLARE_uint64(numa_pinned_pool_size_in_mb);
 COMMON_DECLARE_bool(use_cuda_malloc_async_allocator);
 COMMON_DECLARE_bool(auto_free_cudagraph_allocations_on_launch);
 
@@ -395,6 +401,29 @@ class AllocatorFacadePrivate {
   }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  uint64_t CompactGPUMemory(const phi::GPUPlace& place) {
+    uint64_t remapped_size = 0;
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 10020
+    std::shared_lock<std::shared_timed_mutex> lock_guard(cuda_allocator_mutex_);
+    auto iter = virtual_memory_allocators_.find(place);
+    if (iter == virtual_memory_allocators_.end()) {
+      VLOG(6) << "Warning: VirtualMemoryAutoGrowthBestFitAllocator is not "
+              << "used on " << place;
+      return 0;
+    }
+    for (auto& allocator : iter->second) {
+      CompactionResult result = allocator->Compact();
+      remapped_size += result.remapped_size;
+      VLOG(1) << "Compact GPU memory on " << place << ", free size "
+              << string::HumanReadableSize(result.before.free_size)
+              << ", fragmentation ratio " << result.before.Ratio() << " -> "
+              << result.after.Ratio() << ", remapped "
+              << string::HumanReadableSize(result.remapped_size);
+    }
+#endif
+    return remapped_size;
+  }
+
   bool HasCUDAAllocator(const phi::GPUPlace& place, gpuStream_t stream) {
     auto it = cuda_allocators_.find(place);
     if (it == cuda_allocators_.end()) {
@@ -828,7 +857,13 @@ class AllocatorFacadePrivate {
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
-    if (FLAGS_use_auto_growth_pinned_allocator) {
+    if (FLAGS_use_numa_pinned_allocator) {
+      VLOG(4) << "FLAGS_numa_pinned_pool_size_in_mb is "
+              << FLAGS_numa_pinned_pool_size_in_mb;
+      allocators_[phi::GPUPinnedPlace()] =
+          std::make_shared<NumaPinnedAllocator>(
+              FLAGS_numa_pinned_pool_size_in_mb << 20);
+    } else if (FLAGS_use_auto_growth_pinned_allocator) {
       auto chunk_size = FLAGS_auto_growth_chunk_size_in_mb << 20;
       VLOG(4) << "FLAGS_auto_growth_chunk_size_in_mb is "
               << FLAGS_auto_growth_chunk_size_in_mb;
@@ -920,6 +955,21 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  // Caches the small allocations of the auto_growth allocator per thread,
+  // see FLAGS_auto_growth_slab_max_size_in_kb
+  void WrapSlabCacheAllocator(std::shared_ptr<Allocator>* allocator) {
+    if (FLAGS_auto_growth_slab_max_size_in_kb == 0) {
+      return;
+    }
+    VLOG(4) << "FLAGS_auto_growth_slab_max_size_in_kb is "
+            << FLAGS_auto_growth_slab_max_size_in_kb;
+    *allocator = std::make_shared<SlabCacheAllocator>(
+        *allocator,
+        platform::GpuMinChunkSize(),
+        FLAGS_auto_growth_slab_max_size_in_kb << 10,
+        FLAGS_auto_growth_slab_thread_cache_size_in_mb << 20);
+  }
+
   void InitAutoGrowthCUDAAllocator(phi::GPUPlace p, gpuStream_t stream) {
     auto chunk_size = FLAGS_auto_growth_chunk_size_in_mb << 20;
     VLOG(4) << "FLAGS_auto_growth_chunk_size_in_mb is "
@@ -962,9 +1012,11 @@ class AllocatorFacadePrivate {
 
     if (val > 0 && FLAGS_use_virtual_memory_auto_growth) {
       auto cuda_allocator = std::make_shared<CUDAVirtualMemAllocator>(p);
-      cuda_allocators_[p][stream] =
+      auto vmm_allocator =
           std::make_shared<VirtualMemoryAutoGrowthBestFitAllocator>(
               cuda_allocator, platform::GpuMinChunkSize(), p);
+      virtual_memory_allocators_[p].push_back(vmm_allocator);
+      cuda_allocators_[p][stream] = vmm_allocator;
     } else {
       auto cuda_allocator = CreateCUDAAllocator(p);
       if (FLAGS_use_auto_growth_v2) {
@@ -1034,6 +1086,7 @@ class AllocatorFacadePrivate {
     }
 #endif
 #endif
+    WrapSlabCacheAllocator(&cuda_allocators_[p][stream]);
   }
 
   // NOTE(Ruibiao): Old single-stream version, will be removed later
@@ -1078,9 +1131,11 @@ class AllocatorFacadePrivate {
 
     if (val > 0 && FLAGS_use_virtual_memory_auto_growth) {
       auto cuda_allocator = std::make_shared<CUDAVirtualMemAllocator>(p);
-      allocators_[p] =
+      auto vmm_allocator =
           std::make_shared<VirtualMemoryAutoGrowthBestFitAllocator>(
               cuda_allocator, platform::GpuMinChunkSize(), p);
+      virtual_memory_allocators_[p].push_back(vmm_allocator);
+      allocators_[p] = vmm_allocator;
     } else {
       auto cuda_allocator = CreateCUDAAllocator(p);
       if (FLAGS_use_auto_growth_v2) {
@@ -1145,6 +1200,7 @@ class AllocatorFacadePrivate {
     }
 #endif
 #endif
+    WrapSlabCacheAllocator(&allocators_[p]);
   }
 
   void InitThreadLocalCUDAAllocator(phi::GPUPlace p) {
@@ -1225,7 +1281,8 @@ class AllocatorFacadePrivate {
 
   void WrapStatAllocator(phi::GPUPlace p, gpuStream_t stream) {
     std::shared_ptr<Allocator>& allocator = cuda_allocators_[p][stream];
-    allocator = std::make_shared<StatAllocator>(allocator);
+    allocator = std::make_shared<StatAllocator>(
+        allocator, reinterpret_cast<uint64_t>(stream));
   }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -1347,7 +1404,8 @@ class AllocatorFacadePrivate {
 
   void WrapStatAllocator(phi::XPUPlace p, XPUStream stream) {
     std::shared_ptr<Allocator>& allocator = xpu_allocators_[p][stream];
-    allocator = std::make_shared<StatAllocator>(allocator);
+    allocator = std::make_shared<StatAllocator>(
+        allocator, reinterpret_cast<uint64_t>(stream));
   }
 
 #endif
@@ -1572,6 +1630,14 @@ class AllocatorFacadePrivate {
   std::shared_timed_mutex cuda_allocator_mutex_;
 #endif
 
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 10020
+  // the allocators that can be compacted by CompactGPUMemory
+  std::map<phi::GPUPlace,
+           std::vector<
+               std::shared_ptr<VirtualMemoryAutoGrowthBestFitAllocator>>>
+      virtual_memory_allocators_;
+#endif
+
 #if defined(PADDLE_WITH_CUDA)
   std::map<phi::Place, std::shared_ptr<CUDAMallocAsyncAllocator>>
       default_cuda_malloc_async_allocators_;
@@ -1778,6 +1844,10 @@ uint64_t AllocatorFacade::Release(const phi::GPUPlace& place,
   return m->GetAllocator(place, stream)->Release(place);
 }
 
+uint64_t AllocatorFacade::CompactGPUMemory(const phi::GPUPlace& place) {
+  return GetPrivate()->CompactGPUMemory(place);
+}
+
 void AllocatorFacade::RecordStream(std::shared_ptr<phi::Allocation> allocation,
                                    gpuStream_t stream) {
   GetPrivate()->RecordStream(allocation, stream);
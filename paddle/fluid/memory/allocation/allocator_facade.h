@@ -84,6 +84,9 @@ class AllocatorFacade {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // TODO(zhiqiu): change gpuStream_t to phi::Stream if needed.
   uint64_t Release(const phi::GPUPlace& place, gpuStream_t stream);
+  // Coalesce the free GPU memory of VirtualMemoryAutoGrowthBestFitAllocator by
+  // remapping, returns the size of the remapped memory.
+  uint64_t CompactGPUMemory(const phi::GPUPlace& place);
   void RecordStream(std::shared_ptr<Allocation> allocation, gpuStream_t stream);
   void EraseStream(std::shared_ptr<Allocation> allocation, gpuStream_t stream);
 
@@ -83,13 +83,12 @@ CUDAVirtualMemAllocator::CUDAVirtualMemAllocator(const phi::GPUPlace& place)
   paddle::platform::CUDADeviceGuard guard(place.device);
   PADDLE_ENFORCE_GPU_SUCCESS(cudaMemGetInfo(&actual_avail, &actual_total));
 
-  virtual_mem_size_ = AlignedSize(actual_total, granularity_);
-
   // Reserve the required contiguous virtual address space for the allocations
   // The maximum video memory size we can apply for is the video memory size of
-  // GPU,
-  // so the virtual address space size we reserve is equal to the GPU video
-  // memory size
+  // GPU, and the same size is reserved again for the physical memory moved by
+  // Remap, so the virtual address space size we reserve is twice the GPU
+  // video memory size
+  virtual_mem_size_ = AlignedSize(actual_total, granularity_) * 2;
   PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::cuMemAddressReserve(
       &virtual_mem_base_, virtual_mem_size_, 0, 0, 0));
 
@@ -105,9 +104,17 @@ void CUDAVirtualMemAllocator::FreeImpl(phi::Allocation* allocation) {
       common::errors::PermissionDenied(
           "GPU memory is freed in incorrect device. This may be a bug"));
 
-  auto iter = virtual_2_physical_map_.find(
-      reinterpret_cast<CUdeviceptr>(allocation->ptr()));
-  if (iter == virtual_2_physical_map_.end()) {
+  auto ptr = reinterpret_cast<CUdeviceptr>(allocation->ptr());
+  if (remapped_ptrs_.erase(ptr)) {
+    // the physical memory has been moved by Remap
+    delete allocation;
+    return;
+  }
+
+  // an allocation returned by Remap is backed by several physical handles
+  auto begin = virtual_2_physical_map_.lower_bound(ptr);
+  auto end = virtual_2_physical_map_.lower_bound(ptr + allocation->size());
+  if (begin == end || begin->first != ptr) {
     PADDLE_THROW(common::errors::InvalidArgument(
         "Can not find virtual memory address at %s", allocation->ptr()));
   }
@@ -118,26 +125,106 @@ void CUDAVirtualMemAllocator::FreeImpl(phi::Allocation* allocation) {
     cudaSetDevice(place_.device);
   }
 
-  auto result = phi::dynload::cuMemUnmap(iter->first, iter->second.second);
-  if (result != CUDA_ERROR_DEINITIALIZED) {
-    PADDLE_ENFORCE_GPU_SUCCESS(result);
-  }
+  for (auto iter = begin; iter != end; ++iter) {
+    auto result = phi::dynload::cuMemUnmap(iter->first, iter->second.second);
+    if (result != CUDA_ERROR_DEINITIALIZED) {
+      PADDLE_ENFORCE_GPU_SUCCESS(result);
+    }
 
-  if (result != CUDA_ERROR_DEINITIALIZED) {
-    PADDLE_ENFORCE_GPU_SUCCESS(platform::RecordedGpuMemRelease(
-        iter->second.first, iter->second.second, place_.device));
+    if (result != CUDA_ERROR_DEINITIALIZED) {
+      PADDLE_ENFORCE_GPU_SUCCESS(platform::RecordedGpuMemRelease(
+          iter->second.first, iter->second.second, place_.device));
+    }
   }
 
   if (prev_id != place_.device) {
     cudaSetDevice(prev_id);
   }
 
-  virtual_2_physical_map_.erase(iter);
+  virtual_2_physical_map_.erase(begin, end);
 
   delete allocation;
 }
 
+bool CUDAVirtualMemAllocator::CanRemap(
+    const std::vector<phi::Allocation*>& allocations) const {
+  size_t size = 0;
+  for (auto* allocation : allocations) {
+    size += allocation->size();
+  }
+  return virtual_mem_alloced_offset_ + size <= virtual_mem_size_;
+}
+
+AllocationPtr CUDAVirtualMemAllocator::Remap(
+    const std::vector<phi::Allocation*>& allocations) {
+  PADDLE_ENFORCE_EQ(
+      CanRemap(allocations),
+      true,
+      common::errors::ResourceExhausted(
+          "The reserved virtual address space of GPU %d is not enough to "
+          "remap %d allocations.",
+          place_.device,
+          allocations.size()));
+  // go through Allocate so that the returned allocation is freed by this
+  // allocator, see RemapImpl
+  pending_remap_allocations_ = allocations;
+  size_t size = 0;
+  for (auto* allocation : allocations) {
+    size += allocation->size();
+  }
+  auto result = Allocate(size);
+  pending_remap_allocations_.clear();
+  return result;
+}
+
+phi::Allocation* CUDAVirtualMemAllocator::RemapImpl() {
+  paddle::platform::CUDADeviceGuard guard(place_.device);
+
+  CUdeviceptr base = virtual_mem_base_ + virtual_mem_alloced_offset_;
+  size_t offset = 0;
+  for (auto* allocation : pending_remap_allocations_) {
+    auto ptr = reinterpret_cast<CUdeviceptr>(allocation->ptr());
+    auto begin = virtual_2_physical_map_.lower_bound(ptr);
+    auto end = virtual_2_physical_map_.lower_bound(ptr + allocation->size());
+    PADDLE_ENFORCE_EQ(begin != end && begin->first == ptr,
+                      true,
+                      common::errors::InvalidArgument(
+                          "Can not find virtual memory address at %s",
+                          allocation->ptr()));
+    std::vector<std::pair<CUmemGenericAllocationHandle, size_t>> handles;
+    for (auto iter = begin; iter != end; ++iter) {
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          phi::dynload::cuMemUnmap(iter->first, iter->second.second));
+      handles.push_back(iter->second);
+    }
+    virtual_2_physical_map_.erase(begin, end);
+
+    for (auto& handle : handles) {
+      CUdeviceptr new_ptr = base + offset;
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          phi::dynload::cuMemMap(new_ptr, handle.second, 0, handle.first, 0));
+      PADDLE_ENFORCE_GPU_SUCCESS(phi::dynload::cuMemSetAccess(
+          new_ptr, handle.second, access_desc_.data(), access_desc_.size()));
+      virtual_2_physical_map_.emplace(new_ptr, handle);
+      offset += handle.second;
+    }
+    remapped_ptrs_.insert(ptr);
+  }
+  virtual_mem_alloced_offset_ += offset;
+
+  VLOG(1) << "Remap " << pending_remap_allocations_.size()
+          << " allocations of " << string::HumanReadableSize(offset)
+          << " to " << reinterpret_cast<void*>(base) << " on GPU "
+          << place_.device;
+  return new Allocation(
+      reinterpret_cast<void*>(base), offset, phi::Place(place_));  // NOLINT
+}
+
 phi::Allocation* CUDAVirtualMemAllocator::AllocateImpl(size_t size) {
+  if (!pending_remap_allocations_.empty()) {
+    return RemapImpl();
+  }
+
   size = AlignedSize(size, granularity_);
 
   CUdeviceptr ptr = virtual_mem_base_ + virtual_mem_alloced_offset_;
@@ -20,7 +20,10 @@
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #endif
 
+#include <map>
 #include <mutex>  // NOLINT
+#include <set>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/phi/common/place.h"
@@ -38,11 +41,23 @@ class CUDAVirtualMemAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override;
 
+  // Returns whether the allocations can be remapped, i.e. there is enough
+  // reserved virtual address space left for them.
+  bool CanRemap(const std::vector<phi::Allocation*>& allocations) const;
+
+  // Moves the physical memory of the allocations, which must not be used any
+  // more, to a new contiguous virtual address range, and returns an
+  // allocation covering the range. The moved allocations have no physical
+  // memory afterwards and freeing them releases nothing.
+  AllocationPtr Remap(const std::vector<phi::Allocation*>& allocations);
+
  protected:
   void FreeImpl(phi::Allocation* allocation) override;
   phi::Allocation* AllocateImpl(size_t size) override;
 
  private:
+  phi::Allocation* RemapImpl();
+
   phi::GPUPlace place_;
 
   CUdeviceptr virtual_mem_base_;
@@ -55,6 +70,11 @@ class CUDAVirtualMemAllocator : public Allocator {
 
   std::map<CUdeviceptr, std::pair<CUmemGenericAllocationHandle, size_t>>
       virtual_2_physical_map_;
+
+  // the addresses of the allocations whose physical memory has been moved
+  std::set<CUdeviceptr> remapped_ptrs_;
+  // the allocations to be moved by the current Remap
+  std::vector<phi::Allocation*> pending_remap_allocations_;
 };
 
 }  // namespace allocation
@@ -0,0 +1,79 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/memory_offload.h"
+
+#include <iterator>
+
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+
+namespace paddle::memory::allocation {
+
+MemoryOffloadRegistry& MemoryOffloadRegistry::Instance() {
+  static auto* instance = new MemoryOffloadRegistry();
+  return *instance;
+}
+
+void MemoryOffloadRegistry::Register(const phi::Place& place,
+                                     Offloadable* offloadable) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  PADDLE_ENFORCE_EQ(positions_.count(offloadable),
+                    0,
+                    common::errors::AlreadyExists(
+                        "The offloadable memory is already registered."));
+  auto& offloadables = offloadables_[place];
+  offloadables.push_back(offloadable);
+  positions_.emplace(offloadable,
+                     std::make_pair(place, std::prev(offloadables.end())));
+}
+
+void MemoryOffloadRegistry::Unregister(Offloadable* offloadable) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = positions_.find(offloadable);
+  if (iter == positions_.end()) {
+    return;
+  }
+  offloadables_[iter->second.first].erase(iter->second.second);
+  positions_.erase(iter);
+}
+
+size_t MemoryOffloadRegistry::Spill(const phi::Place& place, size_t size) {
+  platform::RecordEvent record("MemoryOffloadRegistry::Spill",
+                               platform::TracerEventType::UserDefined,
+                               1 /*level*/);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto place_iter = offloadables_.find(place);
+  if (place_iter == offloadables_.end()) {
+    return 0;
+  }
+  auto& offloadables = place_iter->second;
+  size_t freed_size = 0;
+  for (auto iter = offloadables.begin();
+       iter != offloadables.end() && freed_size < size;) {
+    size_t offloaded_size = (*iter)->Offload();
+    if (offloaded_size == 0) {
+      ++iter;
+      continue;
+    }
+    freed_size += offloaded_size;
+    positions_.erase(*iter);
+    iter = offloadables.erase(iter);
+  }
+  VLOG(1) << "Spill " << freed_size << " bytes of " << place
+          << " to the host to allocate " << size << " bytes";
+  return freed_size;
+}
+
+}  // namespace paddle::memory::allocation
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+
+#include "paddle/phi/common/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The device memory which can be moved to the host when the device is out of
+// memory, e.g. the tensors saved for backward.
+class Offloadable {
+ public:
+  virtual ~Offloadable() = default;
+
+  // Moves the device memory to the host, and returns the bytes of the device
+  // memory freed, 0 if it can not be offloaded now.
+  virtual size_t Offload() = 0;
+};
+
+// The registry of the offloadable memory of each device. When an allocation
+// fails, the allocator spills the registered memory in the order of the
+// registration, the first registered first, to the host and retries.
+//
+// NOTE: The memory is offloaded on the thread whose allocation fails, so an
+// Offloadable should not be used by the other threads while registered.
+class MemoryOffloadRegistry {
+ public:
+  static MemoryOffloadRegistry& Instance();
+
+  void Register(const phi::Place& place, Offloadable* offloadable);
+
+  // It blocks until the offloadable is not being offloaded.
+  void Unregister(Offloadable* offloadable);
+
+  // Offloads the registered memory of place until size bytes are freed, and
+  // returns the bytes freed. The offloaded memory is unregistered.
+  size_t Spill(const phi::Place& place, size_t size);
+
+ private:
+  MemoryOffloadRegistry() = default;
+
+  std::mutex mutex_;
+  std::map<phi::Place, std::list<Offloadable*>> offloadables_;
+  std::unordered_map<Offloadable*,
+                     std::pair<phi::Place, std::list<Offloadable*>::iterator>>
+      positions_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
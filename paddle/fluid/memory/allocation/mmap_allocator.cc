@@ -18,6 +18,8 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstdlib>
 
 #include <atomic>
@@ -325,6 +327,184 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+MappedFileAllocation::~MappedFileAllocation() {
+  if (munmap(this->ptr(), this->size()) == -1) {
+    LOG(WARNING) << "Could not unmap the file " << file_path_;
+  }
+}
+
+std::shared_ptr<MappedFileAllocation> AllocateMappedFileAllocation(
+    const std::string &file_path) {
+  int fd = open(file_path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(
+      fd,
+      -1,
+      common::errors::Unavailable("Failed to open file %s to map it, please "
+                                  "check whether the file exists.",
+                                  file_path));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    PADDLE_THROW(common::errors::Unavailable(
+        "Failed to get the size of file %s to map it.", file_path));
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  PADDLE_ENFORCE_GT(
+      size,
+      0,
+      common::errors::InvalidArgument("Can not map the empty file %s.",
+                                      file_path));
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // the mapping is kept after the fd is closed
+  close(fd);
+  PADDLE_ENFORCE_NE(
+      ptr,
+      MAP_FAILED,
+      common::errors::Unavailable("Memory map failed for file %s.", file_path));
+  return std::make_shared<MappedFileAllocation>(ptr, size, file_path);
+}
+
+namespace {
+
+enum BatchRingSlotState : int32_t { kSlotFree = 0, kSlotUsed = 1 };
+
+class SharedMemorySlotAllocation : public Allocation {
+ public:
+  SharedMemorySlotAllocation(void *ptr,
+                             size_t size,
+                             std::shared_ptr<void> lease)
+      : Allocation(ptr, size, phi::CPUPlace()), lease_(std::move(lease)) {}
+
+ private:
+  std::shared_ptr<void> lease_;
+};
+
+size_t BatchRingDataOffset(size_t slot_num) {
+  size_t page_size = static_cast<size_t>(getpagesize());
+  size_t states_size = slot_num * sizeof(std::atomic<int32_t>);
+  return (states_size + page_size - 1) / page_size * page_size;
+}
+
+size_t BatchRingSlotSize(size_t slot_size) {
+  return (slot_size + mmap_alignment - 1) / mmap_alignment * mmap_alignment;
+}
+
+}  // namespace
+
+SharedMemoryBatchRing::SharedMemoryBatchRing(std::string ipc_name,
+                                             void *map_ptr,
+                                             size_t map_size,
+                                             size_t slot_num,
+                                             size_t slot_size)
+    : ipc_name_(std::move(ipc_name)),
+      map_ptr_(map_ptr),
+      map_size_(map_size),
+      slot_num_(slot_num),
+      slot_size_(slot_size),
+      data_offset_(BatchRingDataOffset(slot_num)) {}
+
+std::shared_ptr<SharedMemoryBatchRing> SharedMemoryBatchRing::Create(
+    size_t slot_num, size_t slot_size) {
+  PADDLE_ENFORCE_GT(slot_num,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The slot number of the batch ring should be "
+                        "positive."));
+  slot_size = BatchRingSlotSize(slot_size);
+  size_t map_size = BatchRingDataOffset(slot_num) + slot_num * slot_size;
+  std::string ipc_name = GetIPCName();
+  int fd = -1;
+  void *map_ptr = nullptr;
+  // the file is zeroed by ftruncate, so all slots are free
+  AllocateMemoryMap(
+      ipc_name, &fd, MAPPED_SHAREDMEM | MAPPED_EXCLUSIVE, map_size, &map_ptr);
+  VLOG(4) << "Create the batch ring " << ipc_name << " of " << slot_num
+          << " slots of " << slot_size << " bytes";
+  return std::shared_ptr<SharedMemoryBatchRing>(new SharedMemoryBatchRing(
+      ipc_name, map_ptr, map_size, slot_num, slot_size));
+}
+
+std::shared_ptr<SharedMemoryBatchRing> SharedMemoryBatchRing::Open(
+    const std::string &ipc_name, size_t slot_num, size_t slot_size) {
+  slot_size = BatchRingSlotSize(slot_size);
+  size_t map_size = BatchRingDataOffset(slot_num) + slot_num * slot_size;
+  int fd = -1;
+  void *map_ptr = nullptr;
+  AllocateMemoryMap(ipc_name,
+                    &fd,
+                    MAPPED_SHAREDMEM | MAPPED_NOCREATE | MAPPED_UNLINK,
+                    map_size,
+                    &map_ptr);
+  MemoryMapFdSet::Instance().Remove(ipc_name);
+  return std::shared_ptr<SharedMemoryBatchRing>(new SharedMemoryBatchRing(
+      ipc_name, map_ptr, map_size, slot_num, slot_size));
+}
+
+SharedMemoryBatchRing::~SharedMemoryBatchRing() {
+  if (munmap(map_ptr_, map_size_) == -1) {
+    LOG(WARNING) << "Could not unmap the batch ring " << ipc_name_;
+  }
+}
+
+std::atomic<int32_t> *SharedMemoryBatchRing::SlotState(int slot) const {
+  PADDLE_ENFORCE_EQ(
+      slot >= 0 && static_cast<size_t>(slot) < slot_num_,
+      true,
+      common::errors::OutOfRange(
+          "The slot %d is out of the %d slots of the batch ring.",
+          slot,
+          slot_num_));
+  return reinterpret_cast<std::atomic<int32_t> *>(map_ptr_) + slot;
+}
+
+int SharedMemoryBatchRing::Acquire() {
+  for (size_t i = 0; i < slot_num_; ++i) {
+    int32_t expected = kSlotFree;
+    if (SlotState(static_cast<int>(i))->compare_exchange_strong(
+            expected, kSlotUsed, std::memory_order_acquire)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void SharedMemoryBatchRing::Release(int slot) {
+  SlotState(slot)->store(kSlotFree, std::memory_order_release);
+}
+
+bool SharedMemoryBatchRing::IsFree(int slot) const {
+  return SlotState(slot)->load(std::memory_order_acquire) == kSlotFree;
+}
+
+void *SharedMemoryBatchRing::SlotData(int slot) const {
+  SlotState(slot);
+  return reinterpret_cast<char *>(map_ptr_) + data_offset_ + slot * slot_size_;
+}
+
+std::shared_ptr<Allocation> SharedMemoryBatchRing::SlotAllocation(
+    const std::shared_ptr<void> &lease,
+    int slot,
+    size_t offset,
+    size_t size) const {
+  PADDLE_ENFORCE_LE(
+      offset + size,
+      slot_size_,
+      common::errors::OutOfRange("The data of %d bytes at %d is out of the "
+                                 "slot of %d bytes.",
+                                 size,
+                                 offset,
+                                 slot_size_));
+  return std::make_shared<SharedMemorySlotAllocation>(
+      reinterpret_cast<char *>(SlotData(slot)) + offset, size, lease);
+}
+
+std::shared_ptr<void> SharedMemoryBatchRing::Lease(int slot) {
+  // the lease keeps the ring mapped until the slot is released
+  auto ring = shared_from_this();
+  return std::shared_ptr<void>(SlotData(slot),
+                               [ring, slot](void *) { ring->Release(slot); });
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
@@ -154,6 +154,81 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+// The private mapping of a whole file, e.g. the model parameters, which is
+// copy-on-write and unmapped when released. The file should not be truncated
+// while the mapping is used.
+class MappedFileAllocation : public Allocation {
+ public:
+  explicit MappedFileAllocation(void *ptr, size_t size, std::string file_path)
+      : Allocation(ptr, size, phi::CPUPlace()),
+        file_path_(std::move(file_path)) {}
+
+  inline const std::string &file_path() const { return file_path_; }
+
+  ~MappedFileAllocation() override;
+
+ private:
+  std::string file_path_;
+};
+
+std::shared_ptr<MappedFileAllocation> AllocateMappedFileAllocation(
+    const std::string &file_path);
+
+// The ring of the slots of slot_size bytes in one shared memory file, which a
+// DataLoader worker writes its batches into, and the main process maps as
+// tensors without copies. The states of the slots are kept in the file, the
+// main process marks a slot free when all the tensors of it are released, so
+// that the worker reuses the slots without creating and mapping the shared
+// memory of each batch.
+class SharedMemoryBatchRing
+    : public std::enable_shared_from_this<SharedMemoryBatchRing> {
+ public:
+  // Creates the ring in the worker.
+  static std::shared_ptr<SharedMemoryBatchRing> Create(size_t slot_num,
+                                                       size_t slot_size);
+  // Maps the ring created by the worker, and unlinks its file, which is
+  // removed once both processes unmap it.
+  static std::shared_ptr<SharedMemoryBatchRing> Open(
+      const std::string &ipc_name, size_t slot_num, size_t slot_size);
+
+  ~SharedMemoryBatchRing();
+
+  inline const std::string &ipc_name() const { return ipc_name_; }
+  inline size_t slot_num() const { return slot_num_; }
+  inline size_t slot_size() const { return slot_size_; }
+
+  // Returns a free slot which is marked used, or -1 if all slots are used.
+  int Acquire();
+  void Release(int slot);
+  bool IsFree(int slot) const;
+
+  void *SlotData(int slot) const;
+  // Returns the allocation of size bytes at offset in the slot. The slot is
+  // released when all the allocations sharing the lease are freed.
+  std::shared_ptr<Allocation> SlotAllocation(const std::shared_ptr<void> &lease,
+                                             int slot,
+                                             size_t offset,
+                                             size_t size) const;
+  std::shared_ptr<void> Lease(int slot);
+
+ private:
+  SharedMemoryBatchRing(std::string ipc_name,
+                        void *map_ptr,
+                        size_t map_size,
+                        size_t slot_num,
+                        size_t slot_size);
+
+  std::atomic<int32_t> *SlotState(int slot) const;
+
+  std::string ipc_name_;
+  void *map_ptr_ = nullptr;
+  size_t map_size_ = 0;
+  size_t slot_num_ = 0;
+  size_t slot_size_ = 0;
+  // the slots follow the states
+  size_t data_offset_ = 0;
+};
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
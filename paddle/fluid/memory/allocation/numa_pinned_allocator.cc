@@ -0,0 +1,286 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/numa_pinned_allocator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/profiler/mem_tracing.h"
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+// the smallest size class is a page, and the allocations larger than the
+// largest class, 256MB, are not pooled
+constexpr size_t kMinClassLog2 = 12;
+constexpr size_t kMaxClassLog2 = 28;
+constexpr size_t kClassNum = kMaxClassLog2 - kMinClassLog2 + 1;
+// the same as MPOL_BIND in numaif.h
+constexpr int kMpolBind = 2;
+
+size_t ClassIndex(size_t size) {
+  size_t log2 = kMinClassLog2;
+  while (log2 <= kMaxClassLog2 && (static_cast<size_t>(1) << log2) < size) {
+    ++log2;
+  }
+  return log2 - kMinClassLog2;
+}
+
+class NumaPinnedAllocation : public Allocation {
+ public:
+  NumaPinnedAllocation(void* ptr, size_t size, int numa_node, bool registered)
+      : Allocation(ptr, size, phi::GPUPinnedPlace()),
+        numa_node_(numa_node),
+        registered_(registered) {}
+
+  int numa_node() const { return numa_node_; }
+  // whether the memory is mapped by mmap and registered to CUDA, otherwise it
+  // is allocated by cudaHostAlloc
+  bool registered() const { return registered_; }
+
+ private:
+  int numa_node_;
+  bool registered_;
+};
+
+}  // namespace
+
+NumaPinnedAllocator::NumaPinnedAllocator(size_t max_pooled_size)
+    : max_pooled_size_(max_pooled_size) {
+  int max_node = -1;
+  int device_count = platform::GetGPUDeviceCount();
+  for (int device = 0; device < device_count; ++device) {
+    device_numa_nodes_.push_back(GpuNumaNode(device));
+    max_node = std::max(max_node, device_numa_nodes_.back());
+    VLOG(4) << "GPU " << device << " is on NUMA node "
+            << device_numa_nodes_.back();
+  }
+  for (int node = -1; node <= max_node; ++node) {
+    pools_.emplace_back(std::make_unique<Pool>());
+    pools_.back()->free_lists.resize(kClassNum);
+  }
+}
+
+NumaPinnedAllocator::~NumaPinnedAllocator() {
+  ReleaseImpl(phi::GPUPinnedPlace());
+}
+
+int NumaPinnedAllocator::GpuNumaNode(int device) {
+#ifdef __linux__
+  char bus_id[32] = {0};
+#ifdef PADDLE_WITH_HIP
+  if (hipDeviceGetPCIBusId(bus_id, sizeof(bus_id), device) != hipSuccess) {
+    return -1;
+  }
+#else
+  if (cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device) != cudaSuccess) {
+    return -1;
+  }
+#endif
+  // the bus id is like "0000:3B:00.0", and sysfs uses the lower case
+  std::string path(bus_id);
+  std::transform(path.begin(), path.end(), path.begin(), [](char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  std::ifstream fin("/sys/bus/pci/devices/" + path + "/numa_node");
+  int numa_node = -1;
+  if (fin.is_open() && (fin >> numa_node)) {
+    return numa_node;
+  }
+#endif
+  return -1;
+}
+
+NumaPinnedAllocator::Pool* NumaPinnedAllocator::PoolOf(int numa_node) {
+  size_t index = static_cast<size_t>(numa_node + 1);
+  return index < pools_.size() ? pools_[index].get() : pools_[0].get();
+}
+
+phi::Allocation* NumaPinnedAllocator::SystemAllocate(size_t size,
+                                                     int numa_node) {
+  void* ptr = nullptr;
+#ifdef __linux__
+  if (numa_node >= 0) {
+    // bind the pages to the node before they are touched by the register
+    ptr = mmap(nullptr,
+               size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS,
+               -1,
+               0);
+    if (ptr != MAP_FAILED) {
+      std::vector<unsigned long> node_mask(  // NOLINT
+          numa_node / (8 * sizeof(unsigned long)) + 1,  // NOLINT
+          0);
+      node_mask[numa_node / (8 * sizeof(unsigned long))] |=  // NOLINT
+          1UL << (numa_node % (8 * sizeof(unsigned long)));  // NOLINT
+      if (syscall(SYS_mbind,
+                  ptr,
+                  size,
+                  kMpolBind,
+                  node_mask.data(),
+                  node_mask.size() * 8 * sizeof(unsigned long) + 1,  // NOLINT
+                  0) != 0) {
+        VLOG(4) << "Failed to bind pinned memory to NUMA node " << numa_node;
+      }
+#ifdef PADDLE_WITH_HIP
+      auto result = hipHostRegister(ptr, size, hipHostRegisterPortable);
+      bool registered = result == hipSuccess;
+#else
+      auto result = cudaHostRegister(ptr, size, cudaHostRegisterPortable);
+      bool registered = result == cudaSuccess;
+#endif
+      if (registered) {
+        VLOG(10) << "Register pinned memory " << size << " " << ptr
+                 << " on NUMA node " << numa_node;
+        HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+        platform::RecordMemEvent(
+            ptr,
+            phi::GPUPinnedPlace(),
+            size,
+            platform::TracerMemEventType::ReservedAllocate);
+        return new NumaPinnedAllocation(ptr, size, numa_node, true);
+      }
+      munmap(ptr, size);
+      VLOG(4) << "Failed to register pinned memory of " << size
+              << " bytes, fall back to cudaHostAlloc";
+    }
+  }
+#endif
+
+#ifdef PADDLE_WITH_HIP
+  PADDLE_ENFORCE_GPU_SUCCESS(hipHostMalloc(&ptr, size, hipHostMallocPortable));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaHostAlloc(&ptr, size, cudaHostAllocPortable));
+#endif
+  VLOG(10) << "cudaHostAlloc " << size << " " << ptr;
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, size);
+  platform::RecordMemEvent(ptr,
+                           phi::GPUPinnedPlace(),
+                           size,
+                           platform::TracerMemEventType::ReservedAllocate);
+  return new NumaPinnedAllocation(ptr, size, numa_node, false);
+}
+
+void NumaPinnedAllocator::SystemFree(phi::Allocation* allocation) {
+  auto* numa_allocation = static_cast<NumaPinnedAllocation*>(allocation);
+  if (numa_allocation->registered()) {
+#ifdef PADDLE_WITH_HIP
+    PADDLE_ENFORCE_GPU_SUCCESS(hipHostUnregister(allocation->ptr()));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaHostUnregister(allocation->ptr()));
+#endif
+#ifdef __linux__
+    munmap(allocation->ptr(), allocation->size());
+#endif
+  } else {
+#ifdef PADDLE_WITH_HIP
+    PADDLE_ENFORCE_GPU_SUCCESS(hipHostFree(allocation->ptr()));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaFreeHost(allocation->ptr()));
+#endif
+  }
+  VLOG(10) << "Free pinned memory " << allocation->ptr();
+  HOST_MEMORY_STAT_UPDATE(Reserved, 0, -allocation->size());
+  platform::RecordMemEvent(allocation->ptr(),
+                           allocation->place(),
+                           allocation->size(),
+                           platform::TracerMemEventType::ReservedFree);
+  delete allocation;
+}
+
+uint64_t NumaPinnedAllocator::FreePending(Pool* pool) {
+  std::vector<phi::Allocation*> pending_frees;
+  {
+    std::lock_guard<std::mutex> guard(pool->mutex);
+    pending_frees.swap(pool->pending_frees);
+  }
+  uint64_t bytes = 0;
+  for (auto* allocation : pending_frees) {
+    bytes += allocation->size();
+    SystemFree(allocation);
+  }
+  return bytes;
+}
+
+phi::Allocation* NumaPinnedAllocator::AllocateImpl(size_t size) {
+  int device = platform::GetCurrentDeviceId();
+  int numa_node = device < static_cast<int>(device_numa_nodes_.size())
+                      ? device_numa_nodes_[device]
+                      : -1;
+  Pool* pool = PoolOf(numa_node);
+  FreePending(pool);
+
+  size_t index = ClassIndex(size);
+  if (index < kClassNum) {
+    std::lock_guard<std::mutex> guard(pool->mutex);
+    auto& free_list = pool->free_lists[index];
+    if (!free_list.empty()) {
+      phi::Allocation* allocation = free_list.back();
+      free_list.pop_back();
+      pool->pooled_size -= allocation->size();
+      return allocation;
+    }
+  }
+  size_t class_size = index < kClassNum
+                          ? static_cast<size_t>(1) << (index + kMinClassLog2)
+                          : size;
+  return SystemAllocate(class_size, numa_node);
+}
+
+void NumaPinnedAllocator::FreeImpl(phi::Allocation* allocation) {
+  auto* numa_allocation = static_cast<NumaPinnedAllocation*>(allocation);
+  Pool* pool = PoolOf(numa_allocation->numa_node());
+  size_t index = ClassIndex(allocation->size());
+  std::lock_guard<std::mutex> guard(pool->mutex);
+  if (index < kClassNum &&
+      pool->pooled_size + allocation->size() <= max_pooled_size_) {
+    pool->free_lists[index].push_back(allocation);
+    pool->pooled_size += allocation->size();
+  } else {
+    pool->pending_frees.push_back(allocation);
+  }
+}
+
+uint64_t NumaPinnedAllocator::ReleaseImpl(const phi::Place& place) {
+  uint64_t bytes = 0;
+  for (auto& pool : pools_) {
+    {
+      std::lock_guard<std::mutex> guard(pool->mutex);
+      for (auto& free_list : pool->free_lists) {
+        pool->pending_frees.insert(
+            pool->pending_frees.end(), free_list.begin(), free_list.end());
+        free_list.clear();
+      }
+      pool->pooled_size = 0;
+    }
+    bytes += FreePending(pool.get());
+  }
+  return bytes;
+}
+
+}  // namespace paddle::memory::allocation
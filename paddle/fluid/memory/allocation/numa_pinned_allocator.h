@@ -0,0 +1,79 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// A pool of pinned host memory for each NUMA node. The memory is allocated on
+// the NUMA node of the current GPU, so that the copies between the host and
+// the GPU do not cross the inter-socket link. The sizes up to 256MB are
+// rounded up to powers of two and the freed allocations are kept in the free
+// lists of their nodes, at most max_pooled_size bytes per node.
+//
+// NOTE: FreeImpl never calls CUDA APIs, so the allocations can be freed in the
+// host functions launched into CUDA streams. The memory beyond the pool size
+// is returned to the system on the next Allocate or Release.
+class NumaPinnedAllocator : public Allocator {
+ public:
+  explicit NumaPinnedAllocator(size_t max_pooled_size);
+
+  ~NumaPinnedAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Returns the NUMA node close to the GPU, -1 if unknown.
+  static int GpuNumaNode(int device);
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+
+  void FreeImpl(phi::Allocation* allocation) override;
+
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  struct Pool {
+    std::mutex mutex;
+    std::vector<std::vector<phi::Allocation*>> free_lists;
+    size_t pooled_size{0};
+    // the allocations to be returned to the system
+    std::vector<phi::Allocation*> pending_frees;
+  };
+
+  Pool* PoolOf(int numa_node);
+
+  phi::Allocation* SystemAllocate(size_t size, int numa_node);
+
+  void SystemFree(phi::Allocation* allocation);
+
+  uint64_t FreePending(Pool* pool);
+
+  size_t max_pooled_size_;
+  // the pool of node i is pools_[i + 1], and pools_[0] is for the unknown node
+  std::vector<std::unique_ptr<Pool>> pools_;
+  std::vector<int> device_numa_nodes_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,252 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_cache_allocator.h"
+
+#include <unordered_map>
+#include <utility>
+
+#include "paddle/fluid/memory/allocation/aligned_allocator.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+// the number of size classes per power of two
+constexpr size_t kClassesPerPow2 = 4;
+constexpr size_t kClassesPerPow2Log2 = 2;
+
+size_t FloorLog2(size_t x) {
+  size_t log2 = 0;
+  while (x >>= 1) {
+    ++log2;
+  }
+  return log2;
+}
+
+void UpdateSlabCachedStat(const phi::Place& place, int64_t increment) {
+  if (phi::is_cpu_place(place) || phi::is_cuda_pinned_place(place)) {
+    HOST_MEMORY_STAT_UPDATE(SlabCached, place.GetDeviceId(), increment);
+  } else {
+    DEVICE_MEMORY_STAT_UPDATE(SlabCached, place.GetDeviceId(), increment);
+  }
+}
+
+}  // namespace
+
+// The states shared by the allocator and the caches of the threads, which
+// outlive the allocator until all the threads have flushed their caches.
+struct SlabCacheAllocator::Shared {
+  std::shared_ptr<Allocator> underlying_allocator;
+  size_t alignment;
+  size_t max_slab_size;
+  size_t max_thread_cached_size;
+  size_t num_classes;
+  uint64_t id;
+  std::atomic<uint64_t> release_epoch{0};
+  std::atomic<bool> destroyed{false};
+};
+
+struct SlabCacheAllocator::ThreadCache {
+  explicit ThreadCache(std::shared_ptr<Shared> shared)
+      : shared(std::move(shared)),
+        release_epoch(this->shared->release_epoch.load()),
+        free_lists(this->shared->num_classes) {}
+
+  ~ThreadCache() { Flush(); }
+
+  void Flush() {
+    for (auto& free_list : free_lists) {
+      for (phi::Allocation* allocation : free_list) {
+        UpdateSlabCachedStat(allocation->place(),
+                             -static_cast<int64_t>(allocation->size()));
+        shared->underlying_allocator->Free(allocation);
+      }
+      free_list.clear();
+    }
+    cached_size = 0;
+  }
+
+  // flushes the cache if Release is called since the last check
+  void CheckReleaseEpoch() {
+    uint64_t epoch = shared->release_epoch.load(std::memory_order_relaxed);
+    if (epoch != release_epoch) {
+      release_epoch = epoch;
+      Flush();
+    }
+  }
+
+  std::shared_ptr<Shared> shared;
+  uint64_t release_epoch;
+  std::vector<std::vector<phi::Allocation*>> free_lists;
+  size_t cached_size{0};
+};
+
+SlabCacheAllocator::ThreadCacheMap&
+SlabCacheAllocator::CurrentThreadCacheMap() {
+  thread_local ThreadCacheMap caches;
+  return caches;
+}
+
+SlabCacheAllocator::SlabCacheAllocator(
+    std::shared_ptr<Allocator> underlying_allocator,
+    size_t alignment,
+    size_t max_slab_size,
+    size_t max_thread_cached_size)
+    : shared_(std::make_shared<Shared>()) {
+  static std::atomic<uint64_t> next_id{0};
+  PADDLE_ENFORCE_GT(
+      alignment,
+      0,
+      common::errors::InvalidArgument(
+          "The alignment of SlabCacheAllocator should be larger than 0."));
+  shared_->underlying_allocator = std::move(underlying_allocator);
+  shared_->alignment = alignment;
+  shared_->max_slab_size = AlignedSize(max_slab_size, alignment);
+  shared_->max_thread_cached_size = max_thread_cached_size;
+  shared_->id = next_id++;
+  shared_->num_classes = 0;
+  SizeClass(shared_->max_slab_size, &shared_->num_classes);
+  ++shared_->num_classes;
+  VLOG(4) << "SlabCacheAllocator with max_slab_size " << shared_->max_slab_size
+          << ", max_thread_cached_size " << max_thread_cached_size << ", "
+          << shared_->num_classes << " size classes";
+}
+
+SlabCacheAllocator::~SlabCacheAllocator() {
+  // the caches of the other threads are flushed when the threads exit or
+  // create new caches
+  shared_->destroyed = true;
+  CurrentThreadCacheMap().erase(shared_->id);
+}
+
+size_t SlabCacheAllocator::SizeClass(size_t size, size_t* index) const {
+  if (size == 0 || size > shared_->max_slab_size) {
+    return 0;
+  }
+  // the classes are 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 14, 16, 20, ... units of
+  // alignment
+  size_t units = (size + shared_->alignment - 1) / shared_->alignment;
+  if (units <= kClassesPerPow2) {
+    *index = units - 1;
+    return units * shared_->alignment;
+  }
+  size_t log2 = FloorLog2(units - 1);
+  size_t shift = log2 - kClassesPerPow2Log2;
+  size_t class_units = (((units - 1) >> shift) + 1) << shift;
+  *index = kClassesPerPow2 * (shift + 1) + ((units - 1) >> shift) -
+           kClassesPerPow2;
+  return class_units * shared_->alignment;
+}
+
+size_t SlabCacheAllocator::ClassSize(size_t index) const {
+  if (index < kClassesPerPow2) {
+    return (index + 1) * shared_->alignment;
+  }
+  size_t shift = index / kClassesPerPow2 - 1;
+  size_t units = (index % kClassesPerPow2 + kClassesPerPow2 + 1) << shift;
+  return units * shared_->alignment;
+}
+
+SlabCacheAllocator::ThreadCache* SlabCacheAllocator::CurrentThreadCache() {
+  thread_local uint64_t last_id = UINT64_MAX;
+  thread_local ThreadCache* last_cache = nullptr;
+  if (last_id == shared_->id) {
+    return last_cache;
+  }
+
+  ThreadCacheMap& caches = CurrentThreadCacheMap();
+  auto iter = caches.find(shared_->id);
+  if (iter == caches.end()) {
+    for (auto it = caches.begin(); it != caches.end();) {
+      if (it->second->shared->destroyed) {
+        it = caches.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    iter = caches.emplace(shared_->id, std::make_unique<ThreadCache>(shared_))
+               .first;
+  }
+  last_id = shared_->id;
+  last_cache = iter->second.get();
+  return last_cache;
+}
+
+phi::Allocation* SlabCacheAllocator::AllocateImpl(size_t size) {
+  size_t index = 0;
+  size_t class_size = SizeClass(size, &index);
+  if (class_size == 0) {
+    return shared_->underlying_allocator->Allocate(size).release();
+  }
+
+  ThreadCache* cache = CurrentThreadCache();
+  cache->CheckReleaseEpoch();
+  auto& free_list = cache->free_lists[index];
+  if (!free_list.empty()) {
+    phi::Allocation* allocation = free_list.back();
+    free_list.pop_back();
+    cache->cached_size -= allocation->size();
+    UpdateSlabCachedStat(allocation->place(),
+                         -static_cast<int64_t>(allocation->size()));
+    VLOG(10) << "Allocate " << size << " bytes from slab of size class "
+             << class_size << ", ptr = " << allocation->ptr();
+    return allocation;
+  }
+
+  platform::RecordEvent record("SlabCacheAllocator::AllocateUnderlying",
+                               platform::TracerEventType::UserDefined,
+                               9 /*level*/);
+  return shared_->underlying_allocator->Allocate(class_size).release();
+}
+
+void SlabCacheAllocator::FreeImpl(phi::Allocation* allocation) {
+  // the allocations of a size class may be larger than the class size, so
+  // they are cached into the largest class not larger than their sizes
+  size_t index = 0;
+  size_t class_size = SizeClass(allocation->size(), &index);
+  if (class_size > allocation->size()) {
+    class_size = index > 0 ? ClassSize(--index) : 0;
+  }
+  if (class_size == 0 || allocation->ptr() == nullptr) {
+    shared_->underlying_allocator->Free(allocation);
+    return;
+  }
+
+  ThreadCache* cache = CurrentThreadCache();
+  cache->CheckReleaseEpoch();
+  if (cache->cached_size + allocation->size() >
+      shared_->max_thread_cached_size) {
+    VLOG(10) << "Slab cache of " << cache->cached_size
+             << " bytes is full, free to the underlying allocator";
+    shared_->underlying_allocator->Free(allocation);
+    return;
+  }
+  cache->free_lists[index].push_back(allocation);
+  cache->cached_size += allocation->size();
+  UpdateSlabCachedStat(allocation->place(),
+                       static_cast<int64_t>(allocation->size()));
+}
+
+uint64_t SlabCacheAllocator::ReleaseImpl(const phi::Place& place) {
+  // the other threads flush their caches on their next Allocate or Free
+  ++shared_->release_epoch;
+  ThreadCache* cache = CurrentThreadCache();
+  cache->CheckReleaseEpoch();
+  return shared_->underlying_allocator->Release(place);
+}
+
+}  // namespace paddle::memory::allocation
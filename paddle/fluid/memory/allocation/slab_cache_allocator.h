@@ -0,0 +1,78 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// A per-thread cache of small allocations in front of a thread-safe
+// allocator, e.g. AutoGrowthBestFitAllocator, whose Allocate and Free are
+// serialized by a lock. The small sizes are rounded up to size classes, 4
+// classes per power of two, and the freed allocations are kept in the free
+// list of their size class of the freeing thread, so that the next allocation
+// of the same class on that thread takes no lock.
+//
+// The allocations cached by a thread are returned to the underlying allocator
+// when the thread exits, when its cache exceeds max_thread_cached_size, or on
+// its next Allocate or Free after Release is called.
+class SlabCacheAllocator : public Allocator {
+ public:
+  SlabCacheAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                     size_t alignment,
+                     size_t max_slab_size,
+                     size_t max_thread_cached_size);
+
+  ~SlabCacheAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Returns the size class of size, whose index is set to *index; returns 0
+  // if size is not cached.
+  size_t SizeClass(size_t size, size_t* index) const;
+
+  size_t ClassSize(size_t index) const;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+
+  void FreeImpl(phi::Allocation* allocation) override;
+
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  struct Shared;
+  struct ThreadCache;
+
+  using ThreadCacheMap =
+      std::unordered_map<uint64_t, std::unique_ptr<ThreadCache>>;
+
+  static ThreadCacheMap& CurrentThreadCacheMap();
+
+  ThreadCache* CurrentThreadCache();
+
+  std::shared_ptr<Shared> shared_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "paddle/fluid/memory/allocation/allocation_trace.h"
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/memory/stats.h"
 #include "paddle/fluid/platform/profiler/mem_tracing.h"
@@ -24,8 +25,12 @@ namespace allocation {
 
 class StatAllocator : public Allocator {
  public:
-  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator)
-      : underlying_allocator_(std::move(underlying_allocator)) {}
+  // stream is only recorded into the allocation trace
+  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                         uint64_t stream = 0)
+      : underlying_allocator_(std::move(underlying_allocator)),
+        stream_(stream),
+        trace_enabled_(AllocationTraceRecorder::IsEnabled()) {}
 
   bool IsAllocThreadSafe() const override { return true; }
 
@@ -43,6 +48,9 @@ class StatAllocator : public Allocator {
                              allocation->place(),
                              allocation->size(),
                              platform::TracerMemEventType::Free);
+    if (UNLIKELY(trace_enabled_)) {
+      AllocationTraceRecorder::Instance().RecordFree(*allocation, stream_);
+    }
     underlying_allocator_->Free(allocation);
   }
 
@@ -62,6 +70,9 @@ class StatAllocator : public Allocator {
                              allocation->place(),
                              allocation->size(),
                              platform::TracerMemEventType::Allocate);
+    if (UNLIKELY(trace_enabled_)) {
+      AllocationTraceRecorder::Instance().RecordAllocate(*allocation, stream_);
+    }
     return allocation.release();
   }
 
@@ -71,6 +82,8 @@ class StatAllocator : public Allocator {
 
  private:
   std::shared_ptr<Allocator> underlying_allocator_;
+  uint64_t stream_;
+  bool trace_enabled_;
 };
 
 }  // namespace allocation
@@ -15,6 +15,8 @@
 #include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
 #include <thread>
 
+#include "paddle/common/flags.h"
+#include "paddle/fluid/memory/allocation/memory_offload.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 
@@ -24,6 +26,16 @@
 #include "paddle/phi/backends/gpu/rocm/hip_graph.h"
 #endif
 
+PHI_DEFINE_EXPORTED_bool(
+    stream_safe_cuda_allocator_wait_on_free,
+    false,
+    "Whether to make the owning stream of an allocation wait for the events "
+    "of its recorded streams when it is freed, so that the allocation can be "
+    "reused by the owning stream immediately instead of being freed after "
+    "the events are completed. It lowers the peak memory and the overhead of "
+    "querying the events, at the cost of the dependency of the later work on "
+    "the owning stream on the recorded streams.");
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -120,6 +132,34 @@ bool StreamSafeCUDAAllocation::CanBeFreed() {
   return true;
 }
 
+bool StreamSafeCUDAAllocation::WaitRecordedStreams() {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (UNLIKELY(phi::backends::gpu::CUDAGraph::IsThisThreadCapturing())) {
+    return false;
+  }
+#endif
+
+  std::call_once(once_flag_,
+                 [this] { phi::backends::gpu::SetDeviceId(place_.device); });
+
+  std::lock_guard<SpinLock> lock_guard(outstanding_event_map_lock_);
+  RecordGraphCapturingStreams();
+  for (auto& [stream, event] : outstanding_event_map_) {
+    // the event can be destroyed once the wait is enqueued
+#ifdef PADDLE_WITH_CUDA
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamWaitEvent(owning_stream_, event, 0));
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaEventDestroy(event));
+#else
+    PADDLE_ENFORCE_GPU_SUCCESS(hipStreamWaitEvent(owning_stream_, event, 0));
+    PADDLE_ENFORCE_GPU_SUCCESS(hipEventDestroy(event));
+#endif
+    VLOG(8) << "Stream " << owning_stream_ << " waits for event " << event
+            << " of stream " << stream << " to free " << ptr();
+  }
+  outstanding_event_map_.clear();
+  return true;
+}
+
 gpuStream_t StreamSafeCUDAAllocation::GetOwningStream() const {
   return owning_stream_;
 }
@@ -208,6 +248,15 @@ phi::Allocation* StreamSafeCUDAAllocator::AllocateImpl(size_t size) {
     ReleaseImpl(place_);
     try {
       underlying_allocation = underlying_allocator_->Allocate(size);
+    } catch (BadAlloc&) {
+      // spill the offloadable memory to the host as the last resort
+      if (MemoryOffloadRegistry::Instance().Spill(place_, size) == 0) {
+        VLOG(3)
+            << "Still allocation failed after release memory from all streams";
+        throw;
+      }
+      ReleaseImpl(place_);
+      underlying_allocation = underlying_allocator_->Allocate(size);
     } catch (...) {
       VLOG(3)
           << "Still allocation failed after release memory from all streams";
@@ -234,7 +283,11 @@ void StreamSafeCUDAAllocator::FreeImpl(phi::Allocation* allocation) {
       static_cast<StreamSafeCUDAAllocation*>(allocation);
 
   VLOG(8) << "Try free allocation " << stream_safe_cuda_allocation->ptr();
-  if (stream_safe_cuda_allocation->CanBeFreed()) {
+  if (FLAGS_stream_safe_cuda_allocator_wait_on_free &&
+      stream_safe_cuda_allocation->WaitRecordedStreams()) {
+    VLOG(9) << "Delete allocation after waiting for the recorded streams";
+    delete stream_safe_cuda_allocation;
+  } else if (stream_safe_cuda_allocation->CanBeFreed()) {
     VLOG(9) << "Directly delete allocation";
     delete stream_safe_cuda_allocation;
   } else {
@@ -270,7 +323,9 @@ void StreamSafeCUDAAllocator::ProcessUnfreedAllocations() {
   std::lock_guard<SpinLock> lock_guard(unfreed_allocation_lock_);
   for (auto it = unfreed_allocations_.begin();
        it != unfreed_allocations_.end();) {
-    if ((*it)->CanBeFreed()) {
+    if ((FLAGS_stream_safe_cuda_allocator_wait_on_free &&
+         (*it)->WaitRecordedStreams()) ||
+        (*it)->CanBeFreed()) {
       delete *it;
       it = unfreed_allocations_.erase(it);
     } else {
@@ -43,6 +43,10 @@ class StreamSafeCUDAAllocation : public Allocation {
   void RecordStream(gpuStream_t stream);
   void EraseStream(gpuStream_t stream);
   bool CanBeFreed();
+  // Makes the owning stream wait for the events of the recorded streams, so
+  // that the allocation can be reused by the owning stream immediately.
+  // Returns false if it is not supported, e.g. during CUDA Graph capturing.
+  bool WaitRecordedStreams();
   gpuStream_t GetOwningStream() const;
 
  private:
@@ -15,9 +15,17 @@
 #include "paddle/fluid/memory/allocation/stream_safe_custom_device_allocator.h"
 #include <thread>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/phi/backends/context_pool.h"
 
+PHI_DEFINE_EXPORTED_bool(
+    stream_safe_custom_device_allocator_wait_on_free,
+    false,
+    "Whether to make the owning stream of a custom device allocation wait for "
+    "the events of its recorded streams when it is freed, the same as "
+    "FLAGS_stream_safe_cuda_allocator_wait_on_free.");
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -46,10 +54,9 @@ void StreamSafeCustomDeviceAllocation::RecordStream(
   auto it = outstanding_event_map_.find(stream);
   if (it == outstanding_event_map_.end()) {
     outstanding_event_map_.insert(
-        {stream, std::make_shared<phi::event::Event>()});
-    outstanding_event_map_[stream]->Init(place());
-    VLOG(9) << "Create a new event "
-            << outstanding_event_map_[stream]->raw_event();
+        {stream, phi::event::EventPool::Instance().Get(place())});
+    VLOG(9) << "Get an event " << outstanding_event_map_[stream]->raw_event()
+            << " from the pool";
   }
   auto stream_wrapper = phi::stream::Stream(place(), stream);
   VLOG(8) << "Record event " << outstanding_event_map_[stream]->raw_event()
@@ -71,14 +78,31 @@ bool StreamSafeCustomDeviceAllocation::CanBeFreed() {
               << " is not completed";
       return false;
     }
-    VLOG(8) << "Destroy event " << event->raw_event();
-    event->Destroy();
+    VLOG(8) << "Put event " << event->raw_event() << " back to the pool";
     it = outstanding_event_map_.erase(it);
   }
   outstanding_event_map_.clear();
   return true;
 }
 
+void StreamSafeCustomDeviceAllocation::WaitRecordedStreams() {
+  std::lock_guard<SpinLock> lock_guard(outstanding_event_map_lock_);
+  if (outstanding_event_map_.empty() ||
+      !phi::DeviceManager::HasDeviceType(place_.GetDeviceType())) {
+    return;
+  }
+  std::call_once(once_flag_, [this] { phi::DeviceManager::SetDevice(place_); });
+  auto owning_stream = phi::stream::Stream(place(), owning_stream_);
+  for (auto& [stream, event] : outstanding_event_map_) {
+    // the event goes back to the pool once the wait is enqueued
+    owning_stream.WaitEvent(event.get());
+    VLOG(8) << "Stream " << owning_stream_ << " waits for event "
+            << event->raw_event() << " of stream " << stream << " to free "
+            << ptr();
+  }
+  outstanding_event_map_.clear();
+}
+
 phi::stream::stream_t StreamSafeCustomDeviceAllocation::GetOwningStream()
     const {
   return owning_stream_;
@@ -166,6 +190,9 @@ void StreamSafeCustomDeviceAllocator::FreeImpl(phi::Allocation* allocation) {
                               phi::DeviceContextPool::Instance().Get(place_))
                               ->stream());
   }
+  if (FLAGS_stream_safe_custom_device_allocator_wait_on_free) {
+    stream_safe_cuda_allocation->WaitRecordedStreams();
+  }
   if (stream_safe_cuda_allocation->CanBeFreed()) {
     VLOG(9) << "Directly delete allocation";
     delete stream_safe_cuda_allocation;
@@ -37,6 +37,9 @@ class StreamSafeCustomDeviceAllocation : public Allocation {
 
   void RecordStream(phi::stream::stream_t stream);
   bool CanBeFreed();
+  // Makes the owning stream wait for the recorded streams, so that the
+  // allocation can be reused in the order of the owning stream.
+  void WaitRecordedStreams();
   phi::stream::stream_t GetOwningStream() const;
   void SetOwningStream(phi::stream::stream_t s);
 
@@ -14,9 +14,24 @@
 
 #include "paddle/fluid/memory/allocation/virtual_memory_auto_growth_best_fit_allocator.h"
 
+#include <algorithm>
 #include <mutex>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
+#include "paddle/utils/string/printf.h"
+
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/cuda_virtual_mem_allocator.h"
+#endif
+
+PHI_DEFINE_EXPORTED_double(
+    virtual_memory_compaction_threshold,
+    0.0,
+    "If larger than 0, VirtualMemoryAutoGrowthBestFitAllocator compacts the "
+    "free memory when an allocation can not be served by the free blocks and "
+    "the fragmentation ratio, i.e. 1 - largest free block / total free size, "
+    "is not less than it. 0 disables the automatic compaction.");
 
 namespace paddle {
 namespace memory {
@@ -34,7 +49,12 @@ VirtualMemoryAutoGrowthBestFitAllocator::
     : underlying_allocator_(
           std::make_shared<AlignedAllocator>(underlying_allocator, alignment)),
       alignment_(alignment),
-      place_(place) {}
+      place_(place) {
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 10020
+  cuda_virtual_mem_allocator_ =
+      dynamic_cast<CUDAVirtualMemAllocator *>(underlying_allocator.get());
+#endif
+}
 
 phi::Allocation *VirtualMemoryAutoGrowthBestFitAllocator::AllocateImpl(
     size_t size) {
@@ -42,6 +62,15 @@ phi::Allocation *VirtualMemoryAutoGrowthBestFitAllocator::AllocateImpl(
   size = AlignedSize(size, alignment_);
   auto result = AllocFromFreeBlocks(size);
 
+  if (!result && FLAGS_virtual_memory_compaction_threshold > 0) {
+    auto stats = GetFragmentationStatsImpl();
+    if (stats.free_size >= size &&
+        stats.Ratio() >= FLAGS_virtual_memory_compaction_threshold) {
+      CompactImpl();
+      result = AllocFromFreeBlocks(size);
+    }
+  }
+
   if (!result) {
     ExtendAndMerge(size);
     result = AllocFromFreeBlocks(size);
@@ -144,6 +173,11 @@ void VirtualMemoryAutoGrowthBestFitAllocator::ExtendAndMerge(size_t size) {
   size = allocateptr->size();
   allocations_.push_back(std::move(allocateptr));  // hold allocation
 
+  InsertChunk(ptr, size);
+}
+
+void VirtualMemoryAutoGrowthBestFitAllocator::InsertChunk(void *ptr,
+                                                          size_t size) {
   if (all_blocks_.empty()) {
     all_blocks_.emplace_back(ptr, size, true);
     free_blocks_.emplace(std::make_pair(size, ptr), all_blocks_.begin());
@@ -164,7 +198,7 @@ void VirtualMemoryAutoGrowthBestFitAllocator::ExtendAndMerge(size_t size) {
                                block_it);
         } else {
           // do not merge
-          all_blocks_.emplace_back(ptr, size, true);
+          all_blocks_.emplace_front(ptr, size, true);
           free_blocks_.emplace(std::make_pair(size, ptr), all_blocks_.begin());
         }
       } else {
@@ -252,6 +286,141 @@ phi::Allocation *VirtualMemoryAutoGrowthBestFitAllocator::AllocFromFreeBlocks(
   return nullptr;
 }
 
+FragmentationStats
+VirtualMemoryAutoGrowthBestFitAllocator::GetFragmentationStats() {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  return GetFragmentationStatsImpl();
+}
+
+CompactionResult VirtualMemoryAutoGrowthBestFitAllocator::Compact() {
+  std::lock_guard<SpinLock> guard(spinlock_);
+  return CompactImpl();
+}
+
+FragmentationStats
+VirtualMemoryAutoGrowthBestFitAllocator::GetFragmentationStatsImpl() const {
+  FragmentationStats stats;
+  for (auto &item : free_blocks_) {
+    stats.free_size += item.first.first;
+  }
+  if (!free_blocks_.empty()) {
+    stats.largest_free_block_size = free_blocks_.rbegin()->first.first;
+  }
+  stats.free_block_num = free_blocks_.size();
+  return stats;
+}
+
+CompactionResult VirtualMemoryAutoGrowthBestFitAllocator::CompactImpl() {
+  CompactionResult result;
+  result.before = GetFragmentationStatsImpl();
+  result.after = result.before;
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 10020
+  if (cuda_virtual_mem_allocator_ == nullptr ||
+      result.before.free_block_num < 2) {
+    return result;
+  }
+
+  // the chunks entirely in free blocks are idle, both the chunks and the
+  // blocks are sorted by address
+  using ChunkIt = std::list<AllocationPtr>::iterator;
+  std::vector<ChunkIt> chunks;
+  for (auto it = allocations_.begin(); it != allocations_.end(); ++it) {
+    chunks.push_back(it);
+  }
+  std::sort(chunks.begin(), chunks.end(), [](ChunkIt a, ChunkIt b) {
+    return (*a)->ptr() < (*b)->ptr();
+  });
+
+  std::vector<std::pair<std::list<Block>::iterator, std::vector<ChunkIt>>>
+      carved_blocks;
+  std::vector<phi::Allocation *> idle_chunks;
+  size_t idle_size = 0;
+  auto chunk = chunks.begin();
+  for (auto block_it = all_blocks_.begin(); block_it != all_blocks_.end();
+       ++block_it) {
+    if (!block_it->is_free_) {
+      continue;
+    }
+    auto *block_begin = reinterpret_cast<uint8_t *>(block_it->ptr_);
+    auto *block_end = block_begin + block_it->size_;
+    while (chunk != chunks.end() &&
+           reinterpret_cast<uint8_t *>((**chunk)->ptr()) < block_begin) {
+      ++chunk;
+    }
+    std::vector<ChunkIt> block_chunks;
+    while (chunk != chunks.end() &&
+           reinterpret_cast<uint8_t *>((**chunk)->ptr()) + (**chunk)->size() <=
+               block_end) {
+      block_chunks.push_back(*chunk);
+      idle_chunks.push_back((**chunk).get());
+      idle_size += (**chunk)->size();
+      ++chunk;
+    }
+    if (!block_chunks.empty()) {
+      carved_blocks.emplace_back(block_it, std::move(block_chunks));
+    }
+  }
+
+  // remapping is useless if it does not make a larger free block
+  if (idle_chunks.size() < 2 ||
+      idle_size <= result.before.largest_free_block_size ||
+      !cuda_virtual_mem_allocator_->CanRemap(idle_chunks)) {
+    VLOG(1) << "Skip compaction of " << idle_chunks.size()
+            << " idle chunks of " << string::HumanReadableSize(idle_size)
+            << " on " << place_;
+    return result;
+  }
+
+  // the parts of the free blocks not in the idle chunks are kept
+  for (auto &item : carved_blocks) {
+    auto block_it = item.first;
+    auto next = std::next(block_it);
+    auto *piece_begin = reinterpret_cast<uint8_t *>(block_it->ptr_);
+    auto *block_end = piece_begin + block_it->size_;
+    for (auto &chunk_it : item.second) {
+      auto *chunk_begin = reinterpret_cast<uint8_t *>((*chunk_it)->ptr());
+      if (chunk_begin > piece_begin) {
+        size_t piece_size = chunk_begin - piece_begin;
+        auto piece =
+            all_blocks_.insert(next, Block(piece_begin, piece_size, true));
+        free_blocks_.emplace(std::make_pair(piece_size, piece->ptr_), piece);
+      }
+      piece_begin = chunk_begin + (*chunk_it)->size();
+    }
+    if (block_end > piece_begin) {
+      size_t piece_size = block_end - piece_begin;
+      auto piece =
+          all_blocks_.insert(next, Block(piece_begin, piece_size, true));
+      free_blocks_.emplace(std::make_pair(piece_size, piece->ptr_), piece);
+    }
+    free_blocks_.erase(std::make_pair(block_it->size_, block_it->ptr_));
+    all_blocks_.erase(block_it);
+  }
+
+  auto remapped = cuda_virtual_mem_allocator_->Remap(idle_chunks);
+  for (auto &item : carved_blocks) {
+    for (auto &chunk_it : item.second) {
+      allocations_.erase(chunk_it);
+    }
+  }
+  void *ptr = remapped->ptr();
+  size_t size = remapped->size();
+  allocations_.push_back(std::move(remapped));
+  InsertChunk(ptr, size);
+
+  result.remapped_size = size;
+  result.after = GetFragmentationStatsImpl();
+  VLOG(1) << "Compact " << idle_chunks.size() << " idle chunks of "
+          << string::HumanReadableSize(size) << " on " << place_
+          << ", fragmentation ratio " << result.before.Ratio() << " -> "
+          << result.after.Ratio() << ", largest free block "
+          << string::HumanReadableSize(result.before.largest_free_block_size)
+          << " -> "
+          << string::HumanReadableSize(result.after.largest_free_block_size);
+#endif
+  return result;
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
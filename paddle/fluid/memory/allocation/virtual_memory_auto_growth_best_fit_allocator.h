@@ -17,6 +17,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/memory/allocation/spin_lock.h"
@@ -42,6 +43,28 @@ struct BlockAllocation : public Allocation {
   std::list<Block>::iterator block_it_;
 };
 
+struct FragmentationStats {
+  size_t free_size{0};
+  size_t largest_free_block_size{0};
+  size_t free_block_num{0};
+
+  // 0 if all the free memory is contiguous, and close to 1 if it is split
+  // into many small blocks
+  double Ratio() const {
+    return free_size == 0 ? 0.0
+                          : 1.0 - static_cast<double>(largest_free_block_size) /
+                                      static_cast<double>(free_size);
+  }
+};
+
+struct CompactionResult {
+  FragmentationStats before;
+  FragmentationStats after;
+  size_t remapped_size{0};
+};
+
+class CUDAVirtualMemAllocator;
+
 /**
  * Like AutoGrowthBestFitAllocator, VirtualMemoryAutoGrowthBestFitAllocator will
  * gradually apply to GPU for video memory as the model uses more video memory.
@@ -50,6 +73,13 @@ struct BlockAllocation : public Allocation {
  * address. If the video memory applied for twice is continuous, we can combine
  * the two video memories later. This combination can greatly reduce
  * fragmentation.
+ *
+ * Besides, the free memory can be compacted: the physical memory of the
+ * chunks that are entirely free is remapped to a new contiguous virtual
+ * address range, so that the free blocks scattered between the used ones are
+ * coalesced into a large one. It is done by Compact, or when an allocation
+ * can not be served by the free blocks and the fragmentation ratio exceeds
+ * FLAGS_virtual_memory_compaction_threshold.
  */
 class VirtualMemoryAutoGrowthBestFitAllocator : public Allocator {
  public:
@@ -60,6 +90,10 @@ class VirtualMemoryAutoGrowthBestFitAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  FragmentationStats GetFragmentationStats();
+
+  CompactionResult Compact();
+
  protected:
   phi::Allocation *AllocateImpl(size_t size) override;
 
@@ -69,8 +103,13 @@ class VirtualMemoryAutoGrowthBestFitAllocator : public Allocator {
   phi::Allocation *AllocFromFreeBlocks(size_t size);
   void ExtendAndMerge(size_t size);
   void TryMergeBlock2Blocks(std::list<Block>::iterator iter);
+  void InsertChunk(void *ptr, size_t size);
+  FragmentationStats GetFragmentationStatsImpl() const;
+  CompactionResult CompactImpl();
 
   std::shared_ptr<Allocator> underlying_allocator_;
+  // nullptr if the underlying allocator can not remap physical memory
+  CUDAVirtualMemAllocator *cuda_virtual_mem_allocator_{nullptr};
   size_t alignment_;
 
   std::map<std::pair<size_t, void *>, std::list<Block>::iterator> free_blocks_;
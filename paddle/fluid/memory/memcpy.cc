@@ -14,6 +14,10 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/memcpy.h"
 
+#include <cstring>
+
+#include "paddle/common/flags.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/device/device_wrapper.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
@@ -24,6 +28,10 @@ limitations under the License. */
 #include "paddle/phi/backends/xpu/xpu_header.h"
 #endif
 
+#ifdef PADDLE_WITH_CUDA
+COMMON_DECLARE_bool(use_numa_pinned_allocator);
+#endif
+
 namespace paddle {
 namespace memory {
 
@@ -280,6 +288,19 @@ inline void SyncCUDAStream() {
 }
 #endif
 
+#ifdef PADDLE_WITH_CUDA
+// The large async copies between the pageable host memory and the GPU are
+// staged by the pooled NUMA-local pinned memory, since the driver copies the
+// pageable memory by its own small pinned buffers synchronously.
+static bool UsePinnedStaging(size_t num) {
+  return FLAGS_use_numa_pinned_allocator && num > kMaxGpuAsyncCopyBytes;
+}
+
+static void CUDART_CB FreeStagingAllocation(void* allocation) {
+  delete static_cast<AllocationPtr*>(allocation);
+}
+#endif
+
 // NOTE(zcd): Do not use GpuMemcpySync as much as possible.
 // because GpuMemcpySync issues the copying command to the default stream,
 // which will make two commands from different streams cannot run concurrently.
@@ -308,6 +329,18 @@ TEST_API void Copy<phi::CPUPlace, phi::GPUPlace>(phi::CPUPlace dst_place,
                              hipMemcpyDeviceToHost,
                              reinterpret_cast<gpuStream_t>(stream));
 #else
+    if (UsePinnedStaging(num)) {
+      // the same as the pageable copy, dst is ready when Copy returns
+      auto staging = memory::Alloc(phi::GPUPinnedPlace(), num);
+      platform::GpuMemcpyAsync(staging->ptr(),
+                               src,
+                               num,
+                               cudaMemcpyDeviceToHost,
+                               reinterpret_cast<gpuStream_t>(stream));
+      platform::GpuStreamSync(reinterpret_cast<gpuStream_t>(stream));
+      std::memcpy(dst, staging->ptr(), num);
+      return;
+    }
     platform::GpuMemcpyAsync(dst,
                              src,
                              num,
@@ -351,6 +384,22 @@ TEST_API void Copy<phi::GPUPlace, phi::CPUPlace>(phi::GPUPlace dst_place,
                              hipMemcpyHostToDevice,
                              reinterpret_cast<gpuStream_t>(stream));
 #else
+    if (UsePinnedStaging(num)) {
+      // src can be reused when Copy returns, and the staging memory is freed
+      // on the stream after the copy is done
+      auto staging = memory::Alloc(phi::GPUPinnedPlace(), num);
+      std::memcpy(staging->ptr(), src, num);
+      platform::GpuMemcpyAsync(dst,
+                               staging->ptr(),
+                               num,
+                               cudaMemcpyHostToDevice,
+                               reinterpret_cast<gpuStream_t>(stream));
+      PADDLE_ENFORCE_GPU_SUCCESS(
+          cudaLaunchHostFunc(reinterpret_cast<gpuStream_t>(stream),
+                             FreeStagingAllocation,
+                             new AllocationPtr(std::move(staging))));
+      return;
+    }
     platform::GpuMemcpyAsync(dst,
                              src,
                              num,
@@ -163,9 +163,11 @@ void LogDeviceMemoryStats(const phi::Place& place, const std::string& op_name) {
 int RegisterAllStats() {
   DEVICE_MEMORY_STAT_REGISTER(Allocated);
   DEVICE_MEMORY_STAT_REGISTER(Reserved);
+  DEVICE_MEMORY_STAT_REGISTER(SlabCached);
 
   HOST_MEMORY_STAT_REGISTER(Allocated);
   HOST_MEMORY_STAT_REGISTER(Reserved);
+  HOST_MEMORY_STAT_REGISTER(SlabCached);
   return 0;
 }
 
@@ -226,9 +226,11 @@ void LogDeviceMemoryStats(const phi::Place& place, const std::string& op_name);
 // To add a new STAT type, declare here and register in stats.cc
 DEVICE_MEMORY_STAT_DECLARE(Allocated);
 DEVICE_MEMORY_STAT_DECLARE(Reserved);
+DEVICE_MEMORY_STAT_DECLARE(SlabCached);
 
 HOST_MEMORY_STAT_DECLARE(Allocated);
 HOST_MEMORY_STAT_DECLARE(Reserved);
+HOST_MEMORY_STAT_DECLARE(SlabCached);
 
 }  // namespace memory
 }  // namespace paddle
@@ -68,6 +68,10 @@ class FusedAdamOpMaker : public framework::OpProtoAndCheckerMaker {
         .AsDuplicable();
     AddInput("SkipUpdate", "(Tensor<bool>, optional), Skip the update or not.")
         .AsDispensable();
+    AddInput("LossScaling",
+             "(Tensor<float>, optional), The loss scaling of AMP, the grads "
+             "are unscaled by it.")
+        .AsDispensable();
 
     AddOutput("ParamsOut", "(Tensor) Output parameters").AsDuplicable();
     AddOutput("Moments1Out", "(Tensor) Output first moments").AsDuplicable();
@@ -81,6 +85,10 @@ class FusedAdamOpMaker : public framework::OpProtoAndCheckerMaker {
               "It shared memory with Input(MasterParams).")
         .AsDispensable()
         .AsDuplicable();
+    AddOutput("FoundInf",
+              "(Tensor<bool>) Whether there is inf or nan in the grads, the "
+              "update is skipped if so.")
+        .AsDispensable();
 
     AddAttr<float>("beta1",
                    "(float, default 0.9) "
@@ -122,6 +130,11 @@ class FusedAdamOpMaker : public framework::OpProtoAndCheckerMaker {
                   "Whether to use global beta_pow for whole model instead of "
                   "creating beta_pow for each parameter.")
         .SetDefault(false);
+    AddAttr<float>("clip_norm",
+                   "(float, default 0) "
+                   "Clip the grads by their global norm before the update, "
+                   "0 disables it.")
+        .SetDefault(0.0f);
 
     AddComment(R"DOC(
 Adam Optimizer.
@@ -0,0 +1,109 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle::operators {
+
+class FusedDataTransferOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    OP_INOUT_CHECK(ctx->HasInput("X"), "Input", "X", "fused_data_transfer");
+    OP_INOUT_CHECK(
+        ctx->HasOutput("Out"), "Output", "Out", "fused_data_transfer");
+    auto dims = ctx->GetInputDim("X");
+    auto src_layout =
+        static_cast<phi::DataLayout>(ctx->Attrs().Get<int>("src_layout"));
+    auto dst_layout =
+        static_cast<phi::DataLayout>(ctx->Attrs().Get<int>("dst_layout"));
+    if (src_layout != dst_layout) {
+      PADDLE_ENFORCE_EQ(
+          dims.size(),
+          4,
+          common::errors::InvalidArgument(
+              "The fused_data_transfer op only transforms the layout of 4-D "
+              "tensors, but received a tensor of %d dims.",
+              dims.size()));
+      if (dst_layout == phi::DataLayout::kNHWC) {
+        dims = common::make_ddim({dims[0], dims[2], dims[3], dims[1]});
+      } else {
+        dims = common::make_ddim({dims[0], dims[3], dims[1], dims[2]});
+      }
+    }
+    ctx->SetOutputDim("Out", dims);
+  }
+
+ protected:
+  phi::KernelKey GetKernelTypeForVar(
+      const std::string &var_name,
+      const phi::DenseTensor &tensor,
+      const phi::KernelKey &expected_kernel_type) const override {
+    return phi::KernelKey(phi::Backend::ALL_BACKEND,
+                          tensor.layout(),
+                          expected_kernel_type.dtype());
+  }
+
+  phi::KernelKey GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    return phi::KernelKey(OperatorWithKernel::IndicateVarDataType(ctx, "X"),
+                          ctx.GetPlace());
+  }
+};
+
+class FusedDataTransferInferVarType : public framework::VarTypeInference {
+ public:
+  void operator()(framework::InferVarTypeContext *ctx) const override {
+    ctx->SetOutputType("Out", framework::proto::VarType::LOD_TENSOR);
+    ctx->SetOutputDataType(
+        "Out",
+        static_cast<framework::proto::VarType::Type>(
+            PADDLE_GET_CONST(int, ctx->GetAttr("out_dtype"))));
+  }
+};
+
+class FusedDataTransferOpProtoMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(phi::DenseTensor) The input tensor, on the CPU or GPU.");
+    AddOutput("Out",
+              "(phi::DenseTensor) The input tensor on the GPU of the op, in "
+              "dst_layout and out_dtype.");
+    AddAttr<int>("src_layout", "The layout of X, kNCHW or kNHWC.");
+    AddAttr<int>("dst_layout", "The layout of Out, kNCHW or kNHWC.");
+    AddAttr<int>("out_dtype", "The proto data type of Out.");
+    AddComment(R"DOC(
+    FusedDataTransfer Operator.
+    Inserted by the new executor in place of a chain of memcpy_h2d,
+    transfer_layout and cast ops: copies X to the GPU, through a pinned
+    staging buffer when X is in pageable memory, and transforms its layout and
+    casts it in a single kernel.
+)DOC");
+  }
+};
+
+}  // namespace paddle::operators
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(
+    fused_data_transfer,
+    ops::FusedDataTransferOp,
+    ops::FusedDataTransferOpProtoMaker,
+    ops::FusedDataTransferInferVarType,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
@@ -0,0 +1,189 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <cstring>
+#include <memory>
+
+#include "paddle/fluid/framework/convert_utils.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+#include "paddle/phi/common/memory_utils.h"
+
+namespace paddle {
+namespace operators {
+
+// The layout transforms of a 4-D tensor: none, NCHW -> NHWC and NHWC -> NCHW.
+enum class TransferLayoutMode { kNone, kToNHWC, kToNCHW };
+
+template <typename InT, typename OutT, TransferLayoutMode Mode>
+__global__ void FusedDataTransferCUDAKernel(const InT *in,
+                                            OutT *out,
+                                            int64_t numel,
+                                            int64_t channels,
+                                            int64_t spatial) {
+  CUDA_KERNEL_LOOP_TYPE(i, numel, int64_t) {
+    int64_t src = i;
+    if (Mode == TransferLayoutMode::kToNHWC) {
+      // out: [N, HW, C], in: [N, C, HW]
+      int64_t c = i % channels;
+      int64_t hw = (i / channels) % spatial;
+      int64_t n = i / (channels * spatial);
+      src = (n * channels + c) * spatial + hw;
+    } else if (Mode == TransferLayoutMode::kToNCHW) {
+      // out: [N, C, HW], in: [N, HW, C]
+      int64_t hw = i % spatial;
+      int64_t c = (i / spatial) % channels;
+      int64_t n = i / (channels * spatial);
+      src = (n * spatial + hw) * channels + c;
+    }
+    out[i] = static_cast<OutT>(in[src]);
+  }
+}
+
+template <typename InT, typename OutT>
+void LaunchFusedDataTransfer(const phi::GPUContext &dev_ctx,
+                             const InT *in,
+                             TransferLayoutMode mode,
+                             int64_t channels,
+                             int64_t spatial,
+                             phi::DenseTensor *out) {
+  int64_t numel = out->numel();
+  OutT *out_data = dev_ctx.Alloc<OutT>(out);
+  if (numel == 0) return;
+  auto config = phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, numel);
+  auto stream = dev_ctx.stream();
+  if (mode == TransferLayoutMode::kToNHWC) {
+    FusedDataTransferCUDAKernel<InT, OutT, TransferLayoutMode::kToNHWC>
+        <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+            in, out_data, numel, channels, spatial);
+  } else if (mode == TransferLayoutMode::kToNCHW) {
+    FusedDataTransferCUDAKernel<InT, OutT, TransferLayoutMode::kToNCHW>
+        <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+            in, out_data, numel, channels, spatial);
+  } else {
+    FusedDataTransferCUDAKernel<InT, OutT, TransferLayoutMode::kNone>
+        <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+            in, out_data, numel, channels, spatial);
+  }
+}
+
+template <typename T, typename DeviceContext>
+class FusedDataTransferKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *x = ctx.Input<phi::DenseTensor>("X");
+    auto *out = ctx.Output<phi::DenseTensor>("Out");
+    auto &dev_ctx = ctx.template device_context<phi::GPUContext>();
+    auto src_layout = static_cast<phi::DataLayout>(ctx.Attr<int>("src_layout"));
+    auto dst_layout = static_cast<phi::DataLayout>(ctx.Attr<int>("dst_layout"));
+    auto out_dtype = framework::TransToPhiDataType(
+        static_cast<framework::proto::VarType::Type>(
+            ctx.Attr<int>("out_dtype")));
+
+    const T *in = x->data<T>();
+    size_t bytes = x->numel() * sizeof(T);
+    phi::DenseTensor staged;
+    if (!phi::is_gpu_place(x->place())) {
+      // A copy from the pageable memory is staged in the driver and blocks
+      // the host anyway, so it goes through a pinned buffer of our own, which
+      // lives until the copy on the stream is done.
+      const void *host = in;
+      std::shared_ptr<phi::Allocation> pinned;
+      if (!phi::is_cuda_pinned_place(x->place()) && bytes > 0) {
+        pinned = phi::memory_utils::Alloc(phi::GPUPinnedPlace(), bytes);
+        std::memcpy(pinned->ptr(), in, bytes);
+        host = pinned->ptr();
+      }
+      staged.Resize(x->dims());
+      T *staged_data = dev_ctx.Alloc<T>(&staged);
+      phi::memory_utils::Copy(dev_ctx.GetPlace(),
+                              staged_data,
+                              phi::GPUPinnedPlace(),
+                              host,
+                              bytes,
+                              dev_ctx.stream());
+      if (pinned) {
+        dev_ctx.AddStreamCallback([pinned] {});
+      }
+      in = staged_data;
+    }
+
+    TransferLayoutMode mode = TransferLayoutMode::kNone;
+    int64_t channels = 1, spatial = 1;
+    const auto &dims = x->dims();
+    if (src_layout != dst_layout) {
+      if (dst_layout == phi::DataLayout::kNHWC) {
+        mode = TransferLayoutMode::kToNHWC;
+        channels = dims[1];
+        spatial = dims[2] * dims[3];
+      } else {
+        mode = TransferLayoutMode::kToNCHW;
+        channels = dims[3];
+        spatial = dims[1] * dims[2];
+      }
+    }
+    out->set_layout(dst_layout);
+
+    switch (out_dtype) {
+      case phi::DataType::FLOAT32:
+        LaunchFusedDataTransfer<T, float>(
+            dev_ctx, in, mode, channels, spatial, out);
+        break;
+      case phi::DataType::FLOAT64:
+        LaunchFusedDataTransfer<T, double>(
+            dev_ctx, in, mode, channels, spatial, out);
+        break;
+      case phi::DataType::FLOAT16:
+        LaunchFusedDataTransfer<T, phi::dtype::float16>(
+            dev_ctx, in, mode, channels, spatial, out);
+        break;
+      case phi::DataType::BFLOAT16:
+        LaunchFusedDataTransfer<T, phi::dtype::bfloat16>(
+            dev_ctx, in, mode, channels, spatial, out);
+        break;
+      case phi::DataType::INT32:
+        LaunchFusedDataTransfer<T, int>(
+            dev_ctx, in, mode, channels, spatial, out);
+        break;
+      case phi::DataType::INT64:
+        LaunchFusedDataTransfer<T, int64_t>(
+            dev_ctx, in, mode, channels, spatial, out);
+        break;
+      default:
+        PADDLE_THROW(common::errors::Unimplemented(
+            "The fused_data_transfer op does not support casting to %s.",
+            phi::DataTypeToString(out_dtype)));
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+PD_REGISTER_STRUCT_KERNEL(fused_data_transfer,
+                          GPU,
+                          ALL_LAYOUT,
+                          ops::FusedDataTransferKernel,
+                          float,
+                          double,
+                          int,
+                          int64_t,
+                          phi::dtype::float16,
+                          phi::dtype::bfloat16) {}
@@ -14,10 +14,12 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <vector>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
@@ -26,6 +28,8 @@ limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/platform/device_context.h"
 
+COMMON_DECLARE_bool(load_combine_use_mmap);
+
 namespace paddle {
 namespace operators {
 template <typename T, typename DeviceContext>
@@ -44,7 +48,14 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "The number of variables to be loaded is %d, expect "
                           "it to be greater than 0.",
                           out_var_names.size()));
-    if (!model_from_memory) {
+    auto out_vars = ctx.MultiOutputVar("Out");
+    bool all_dense = std::none_of(
+        out_vars.begin(), out_vars.end(), [](const framework::Variable *var) {
+          return var != nullptr && var->IsType<framework::Vocab>();
+        });
+    if (!model_from_memory && FLAGS_load_combine_use_mmap && all_dense) {
+      LoadParamsFromMappedFile(ctx, place, filename, load_as_fp16);
+    } else if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin),
@@ -67,6 +78,57 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     }
   }
 
+  void LoadParamsFromMappedFile(const framework::ExecutionContext &context,
+                                const phi::Place &place,
+                                const std::string &filename,
+                                bool load_as_fp16) const {
+    phi::DeviceContextPool &pool = phi::DeviceContextPool::Instance();
+    auto &dev_ctx = *pool.Get(place);
+    auto out_var_names = context.OutputNames("Out");
+    auto out_vars = context.MultiOutputVar("Out");
+    std::vector<phi::DenseTensor *> tensors;
+    for (size_t i = 0; i < out_vars.size(); i++) {
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i],
+          phi::errors::InvalidArgument(
+              "The variable %s to be loaded cannot be found.",
+              out_var_names[i]));
+      tensors.push_back(out_vars[i]->GetMutable<phi::DenseTensor>());
+    }
+    framework::DeserializeFromMappedFile(filename, tensors, dev_ctx);
+    for (auto *out_var : out_vars) {
+      CastTensor(place, load_as_fp16, out_var);
+    }
+  }
+
+  // Converts the loaded tensor to float16 if load_as_fp16.
+  void CastTensor(const phi::Place &place,
+                  bool load_as_fp16,
+                  framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<phi::DenseTensor>();
+    auto in_dtype = tensor->dtype();
+    auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
+      auto out_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
+      phi::DenseTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(
+          in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<phi::DenseTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
+
   void LoadParamsFromBuffer(
       const framework::ExecutionContext &context,
       const phi::Place &place,
@@ -115,28 +177,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
 
         // Get data from fin to tensor
         paddle::framework::DeserializeFromStream(*buffer, tensor, dev_ctx);
-
-        auto in_dtype = tensor->dtype();
-        auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
-
-        if (in_dtype != out_dtype) {
-          // convert to float16 tensor
-          auto in_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
-          auto out_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
-          phi::DenseTensor fp16_tensor;
-          // copy LoD info to the new tensor
-          fp16_tensor.set_lod(tensor->lod());
-          framework::TransDataType(
-              in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
-
-          // reset output tensor
-          out_vars[i]->Clear();
-          tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
-          tensor->set_lod(fp16_tensor.lod());
-          tensor->ShareDataWith(fp16_tensor);
-        }
+        CastTensor(place, load_as_fp16, out_vars[i]);
       }
     }
     buffer->peek();
@@ -28,13 +28,15 @@ KernelSignature FusedAdamOpArgumentMapping(
                                                 "Beta1Pows",
                                                 "Beta2Pows",
                                                 "MasterParams",
-                                                "SkipUpdate"};
+                                                "SkipUpdate",
+                                                "LossScaling"};
   paddle::small_vector<const char*> out_names = {"ParamsOut",
                                                  "Moments1Out",
                                                  "Moments2Out",
                                                  "Beta1PowsOut",
                                                  "Beta2PowsOut",
-                                                 "MasterParamsOut"};
+                                                 "MasterParamsOut",
+                                                 "FoundInf"};
   paddle::small_vector<const char*> attr_names = {"beta1",
                                                   "beta2",
                                                   "epsilon",
@@ -42,7 +44,8 @@ KernelSignature FusedAdamOpArgumentMapping(
                                                   "weight_decay",
                                                   "use_adamw",
                                                   "multi_precision",
-                                                  "use_global_beta_pow"};
+                                                  "use_global_beta_pow",
+                                                  "clip_norm"};
 
   return KernelSignature("fused_adam",
                          std::move(in_names),
@@ -22,6 +22,7 @@ limitations under the License. */
 #include <string>
 #include <unordered_map>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
@@ -33,6 +34,8 @@ limitations under the License. */
 #include "paddle/phi/common/port.h"
 #include "paddle/phi/core/dense_tensor.h"
 
+COMMON_DECLARE_int32(save_combine_data_alignment);
+
 namespace paddle {
 namespace operators {
 
@@ -110,9 +113,11 @@ void SaveCombineTensorKernel(const Context& dev_ctx,
       framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
       // copy LoD info to the new tensor
       out.set_lod(tensor.lod());
-      framework::SerializeToStream(ss, out, dev_ctx);
+      framework::SerializeToStream(
+          ss, out, dev_ctx, FLAGS_save_combine_data_alignment);
     } else {
-      framework::SerializeToStream(ss, tensor, dev_ctx);
+      framework::SerializeToStream(
+          ss, tensor, dev_ctx, FLAGS_save_combine_data_alignment);
     }
   }
 
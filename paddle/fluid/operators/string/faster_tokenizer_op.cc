@@ -14,10 +14,14 @@ limitations under the License. */
 #include <utf8proc.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <codecvt>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -76,6 +80,46 @@ inline bool IsPunctuation(const wchar_t& ch) {
   return false;
 }
 
+enum AsciiClass : uint8_t { kAsciiSkip, kAsciiSpace, kAsciiSplit, kAsciiWord };
+
+// The classes the checks above give the ascii chars, so that the ascii chars
+// are split without a utf8proc lookup per char.
+const std::array<uint8_t, 128>& AsciiClasses() {
+  static const std::array<uint8_t, 128> classes = [] {
+    std::array<uint8_t, 128> res{};
+    for (wchar_t ch = 0; ch < 128; ++ch) {
+      if (ch == 0 || IsControl(ch)) {
+        res[ch] = kAsciiSkip;
+      } else if (IsPunctuation(ch)) {
+        res[ch] = kAsciiSplit;
+      } else if (IsWhiteSpace(ch)) {
+        res[ch] = kAsciiSpace;
+      } else {
+        res[ch] = kAsciiWord;
+      }
+    }
+    return res;
+  }();
+  return classes;
+}
+
+// Scans a word of 8 chars at a time.
+inline bool IsAscii(const string& text) {
+  const char* data = text.data();
+  const size_t size = text.size();
+  uint64_t bits = 0;
+  size_t i = 0;
+  for (; i + sizeof(bits) <= size; i += sizeof(bits)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    bits |= word;
+  }
+  for (; i < size; ++i) {
+    bits |= static_cast<unsigned char>(data[i]);
+  }
+  return (bits & 0x8080808080808080ULL) == 0;
+}
+
 BasicTokenizer::BasicTokenizer(bool do_lower_case /* = true */)
     : do_lower_case_(do_lower_case) {}
 
@@ -86,19 +130,42 @@ wchar_t BasicTokenizer::do_lower_case(wchar_t ch) const {
 
 void BasicTokenizer::Tokenize(const string& text, vector<wstring>* res) const {
   std::wstring unicode_text;
-  bool status = framework::ConvertStrToWstr(text, &unicode_text);
-  if (!status) {
-    // String is converted into wstring failedly.
-    return;
+  if (IsAscii(text)) {
+    unicode_text.assign(text.begin(), text.end());
+  } else {
+    bool status = framework::ConvertStrToWstr(text, &unicode_text);
+    if (!status) {
+      // String is converted into wstring failedly.
+      return;
+    }
   }
   std::wstring cache_text = L"";
   auto PushCacheText = [&]() {
     if (!cache_text.empty()) {
       res->emplace_back(cache_text);
-      cache_text = L"";
+      cache_text.clear();
     }
   };
+  const auto& ascii_classes = AsciiClasses();
   for (auto& ch : unicode_text) {
+    if (static_cast<uint32_t>(ch) < ascii_classes.size()) {
+      const uint8_t ascii_class = ascii_classes[ch];
+      if (ascii_class == kAsciiSkip) {
+        continue;
+      }
+      if (do_lower_case_ && ch >= L'A' && ch <= L'Z') {
+        ch += L'a' - L'A';
+      }
+      if (ascii_class == kAsciiSplit) {
+        PushCacheText();
+        res->emplace_back(std::wstring{ch});
+      } else if (ascii_class == kAsciiSpace) {
+        PushCacheText();
+      } else {
+        cache_text += ch;
+      }
+      continue;
+    }
     if (ch == 0 || ch == 0xfffd || IsControl(ch)) {
       continue;
     }
@@ -117,11 +184,87 @@ void BasicTokenizer::Tokenize(const string& text, vector<wstring>* res) const {
   PushCacheText();
 }
 
+WordPieceTrie::WordPieceTrie(const framework::Vocab& vocab) {
+  // the edges are collected in maps, and packed once all the pieces are in
+  vector<std::map<wchar_t, int>> children(1);
+  ids_.assign(1, -1);
+  for (const auto& item : vocab) {
+    int node = 0;
+    for (wchar_t ch : item.first) {
+      auto iter = children[node].find(ch);
+      if (iter != children[node].end()) {
+        node = iter->second;
+        continue;
+      }
+      const int child = static_cast<int>(children.size());
+      children[node].emplace(ch, child);
+      children.emplace_back();
+      ids_.push_back(-1);
+      node = child;
+    }
+    ids_[node] = item.second;
+  }
+
+  edge_begins_.reserve(children.size() + 1);
+  for (const auto& edges : children) {
+    edge_begins_.push_back(edges_.size());
+    for (const auto& edge : edges) {
+      edges_.push_back({edge.first, edge.second});
+    }
+  }
+  edge_begins_.push_back(edges_.size());
+  continuation_root_ = Child(Child(0, L'#'), L'#');
+}
+
+int WordPieceTrie::Child(int node, wchar_t ch) const {
+  if (node < 0) {
+    return -1;
+  }
+  auto begin = edges_.begin() + edge_begins_[node];
+  auto end = edges_.begin() + edge_begins_[node + 1];
+  auto iter = std::lower_bound(
+      begin, end, ch, [](const Edge& edge, wchar_t c) { return edge.ch < c; });
+  return iter != end && iter->ch == ch ? iter->node : -1;
+}
+
+int64_t WordPieceTrie::LongestPiece(const wstring& text,
+                                    size_t start,
+                                    bool is_continuation,
+                                    size_t* end) const {
+  int node = is_continuation ? continuation_root_ : 0;
+  int64_t id = -1;
+  for (size_t i = start; node >= 0 && i < text.size(); ++i) {
+    node = Child(node, text[i]);
+    if (node >= 0 && ids_[node] >= 0) {
+      id = ids_[node];
+      *end = i + 1;
+    }
+  }
+  return id;
+}
+
+// The vocabs are persistable vars, loaded once, so the tries are kept by the
+// vocabs, and only rebuilt when the size of a vocab changes.
+std::shared_ptr<const WordPieceTrie> GetWordPieceTrie(
+    const framework::Vocab* vocab) {
+  static std::mutex mutex;
+  static unordered_map<const framework::Vocab*,
+                       std::pair<size_t, std::shared_ptr<const WordPieceTrie>>>
+      tries;
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& trie = tries[vocab];
+  if (trie.second == nullptr || trie.first != vocab->size()) {
+    trie = {vocab->size(), std::make_shared<WordPieceTrie>(*vocab)};
+  }
+  return trie.second;
+}
+
 WordPieceTokenizer::WordPieceTokenizer(
     const framework::Vocab* vocab,
     const wstring& unk_token /* = L"[UNK]"*/,
     const size_t max_input_chars_per_word /* = 100 */)
     : vocab_(vocab),
+      trie_(GetWordPieceTrie(vocab)),
       unk_token_(unk_token),
       max_input_chars_per_word_(max_input_chars_per_word) {
   unk_token_id_ = vocab_->at(unk_token_);
@@ -135,42 +278,20 @@ void WordPieceTokenizer::Tokenize(const wstring& text,
     return;
   }
 
-  auto it = vocab_->find(text);
-  if (it != vocab_->end()) {
-    token_ids->emplace_back(it->second);
-    return;
-  }
-
+  // the greedy longest pieces, the word is unknown if a part of it is not
+  // the start of any piece
+  const size_t num_token_ids = token_ids->size();
   size_t start = 0;
-  vector<int64_t> wordpiece_ids;
   while (start < len) {
-    size_t end = len;
-    std::wstring cur_substr;
-    int64_t cur_substr_id = 0;
-    while (start < end) {
-      std::wstring sub = text.substr(start, end - start);
-      if (start > 0) {
-        sub.insert(0, L"##");
-      }
-      auto it = vocab_->find(sub);
-      if (it != vocab_->end()) {
-        cur_substr = sub;
-        cur_substr_id = it->second;
-        break;
-      }
-      end -= 1;
-    }
-
-    if (cur_substr.empty()) {
+    size_t end = start;
+    int64_t id = trie_->LongestPiece(text, start, start > 0, &end);
+    if (id < 0) {
+      token_ids->resize(num_token_ids);
       token_ids->emplace_back(unk_token_id_);
       return;
-    } else {
-      start = end;
-      wordpiece_ids.emplace_back(cur_substr_id);
     }
-  }
-  for (auto& token_id : wordpiece_ids) {
-    token_ids->emplace_back(token_id);
+    token_ids->emplace_back(id);
+    start = end;
   }
 }
 
@@ -412,7 +533,8 @@ void BertTokenizer::BatchEncode(
 
   size_t batch_size = batch_text.size();
 #ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
+// the texts are of different lengths
+#pragma omp parallel for schedule(dynamic, 16)
 #endif
   for (size_t i = 0; i < batch_size; i++) {
     unordered_map<string, vector<int64_t>> res;
@@ -13,6 +13,8 @@ limitations under the License. */
 
 #include <utf8proc.h>
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -53,6 +55,39 @@ class BasicTokenizer {
   bool do_lower_case_;
 };
 
+// The pieces of a vocab in a trie, the continuation pieces are the ones under
+// "##", so that the longest piece at a position of a word is found in one walk
+// down the trie instead of a lookup of every shorter substring.
+class WordPieceTrie {
+ public:
+  explicit WordPieceTrie(const framework::Vocab& vocab);
+
+  // Returns the id of the longest piece of text at start, -1 if there is
+  // none, and sets *end to the end of the piece.
+  int64_t LongestPiece(const wstring& text,
+                       size_t start,
+                       bool is_continuation,
+                       size_t* end) const;
+
+ private:
+  struct Edge {
+    wchar_t ch;
+    int node;
+  };
+
+  int Child(int node, wchar_t ch) const;
+
+  vector<int64_t> ids_;  // the id of the piece ending at a node, or -1
+  // the edges of a node, sorted by the chars
+  vector<size_t> edge_begins_;
+  vector<Edge> edges_;
+  int continuation_root_ = -1;
+};
+
+// The trie of a vocab is built at the first run with it and kept.
+std::shared_ptr<const WordPieceTrie> GetWordPieceTrie(
+    const framework::Vocab* vocab);
+
 class WordPieceTokenizer {
  public:
   explicit WordPieceTokenizer(const framework::Vocab* vocab,
@@ -62,6 +97,7 @@ class WordPieceTokenizer {
 
  private:
   const framework::Vocab* vocab_;
+  std::shared_ptr<const WordPieceTrie> trie_;
   wstring unk_token_{L"[UNK]"};
   int64_t unk_token_id_;
   size_t max_input_chars_per_word_;
@@ -196,12 +232,12 @@ class FasterTokenizerKernel : public framework::OpKernel<T> {
       std::memcpy(seg_ids_data + i * batch_max_seq_len,
                   encoder_seg_ids.data(),
                   seq_len * sizeof(T));
-      std::memset(input_ids_data + i * batch_max_seq_len + seq_len,
-                  pad_token_id,
-                  (batch_max_seq_len - seq_len) * sizeof(T));
-      std::memset(seg_ids_data + i * batch_max_seq_len + seq_len,
-                  pad_token_id,
-                  (batch_max_seq_len - seq_len) * sizeof(T));
+      std::fill_n(input_ids_data + i * batch_max_seq_len + seq_len,
+                  batch_max_seq_len - seq_len,
+                  static_cast<T>(pad_token_id));
+      std::fill_n(seg_ids_data + i * batch_max_seq_len + seq_len,
+                  batch_max_seq_len - seq_len,
+                  static_cast<T>(pad_token_id));
     }
   }
 };
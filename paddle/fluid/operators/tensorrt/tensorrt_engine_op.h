@@ -16,7 +16,9 @@
 
 #ifdef PADDLE_WITH_CUDA
 #include <cstdint>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -29,6 +31,7 @@
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #include "paddle/fluid/inference/tensorrt/engine.h"
@@ -170,12 +173,23 @@ class TensorRTEngineOp : public framework::OperatorBase {
   int predictor_id_;
   int device_id_;
   bool allow_build_at_runtime_{false};
+  bool background_build_{false};
   bool with_dynamic_shape_{false};
   std::string shape_range_info_path_;
   std::string model_opt_cache_dir_;
   bool use_static_engine_;
   phi::DataType precision_mode_;
 
+  // For the background build, the engine being built, and the one collecting
+  // the shapes out of its range in the meantime.
+  mutable std::mutex build_mutex_;
+  mutable std::unique_ptr<TensorRTEngine> building_engine_;
+  mutable std::unique_ptr<TensorRTEngine> next_engine_;
+  mutable std::vector<std::string> next_changed_names_;
+  mutable std::vector<std::string> next_changed_tensor_names_;
+  mutable std::future<bool> build_future_;
+  mutable std::unique_ptr<framework::ExecutorPrepareContext> native_ctx_;
+
  public:
   TensorRTEngineOp(const std::string &type,
                    const framework::VariableNameMap &inputs,
@@ -195,6 +209,9 @@ class TensorRTEngineOp : public framework::OperatorBase {
     predictor_id_ = Attr<int>("predictor_id");
     shape_range_info_path_ = Attr<std::string>("shape_range_info_path");
     allow_build_at_runtime_ = Attr<bool>("allow_build_at_runtime");
+    if (HasAttr("background_build")) {
+      background_build_ = Attr<bool>("background_build");
+    }
     with_dynamic_shape_ = Attr<bool>("with_dynamic_shape");
     use_static_engine_ = Attr<bool>("use_static_engine");
     if (use_static_engine_) {
@@ -236,6 +253,12 @@ class TensorRTEngineOp : public framework::OperatorBase {
     }
   }
 
+  ~TensorRTEngineOp() override {
+    if (build_future_.valid()) {
+      build_future_.wait();
+    }
+  }
+
   void PrepareTRTEngine(const framework::Scope &scope,
                         TensorRTEngine *engine) const {
     LOG(INFO) << "Prepare TRT engine (Optimize model structure, Select OP "
@@ -271,6 +294,9 @@ class TensorRTEngineOp : public framework::OperatorBase {
       return;
     }
     auto *trt_engine = GetEngine(scope, dev_place);
+    if (allow_build_at_runtime_ && background_build_) {
+      trt_engine = TakeBuiltEngine();
+    }
     if (trt_engine->with_dynamic_shape()) {
       // get runtime input shapes and shape tensors.
       std::map<std::string, std::vector<int32_t>> runtime_input_shape;
@@ -377,6 +403,16 @@ class TensorRTEngineOp : public framework::OperatorBase {
                                    min_input_shape[x],
                                    max_input_shape[x]);
         }
+      } else if (background_build_) {
+        if (!InShapeRange(
+                trt_engine, runtime_input_shape, runtime_shape_tensor)) {
+          BuildInBackground(
+              scope, trt_engine, runtime_input_shape, runtime_shape_tensor);
+          // Paddle runs the subgraph until the engine of the wider range is
+          // built.
+          RunNativeFallback(scope, dev_place);
+          return;
+        }
       } else {
         // compare runtime_input_shape and trt_engine dynamic shapes.
         std::vector<std::string> shape_changed_name;
@@ -433,6 +469,189 @@ class TensorRTEngineOp : public framework::OperatorBase {
     RunTrt(scope, dev_place, trt_engine);
   }
 
+  // Whether the shapes are in the optimization profile of the engine.
+  bool InShapeRange(
+      TensorRTEngine *engine,
+      const std::map<std::string, std::vector<int32_t>> &runtime_input_shape,
+      const std::map<std::string, std::vector<int32_t>> &runtime_shape_tensor)
+      const {
+    auto in_range = [](const std::map<std::string, std::vector<int>> &mins,
+                       const std::map<std::string, std::vector<int>> &maxs,
+                       const std::string &name,
+                       std::vector<int32_t> shape) {
+      // the 0-D tensors are 1-D in the engine
+      if (shape.empty()) {
+        shape.push_back(1);
+      }
+      auto min_iter = mins.find(name);
+      auto max_iter = maxs.find(name);
+      if (min_iter == mins.end() || max_iter == maxs.end() ||
+          min_iter->second.size() != shape.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < shape.size(); ++i) {
+        if (shape[i] < min_iter->second[i] || shape[i] > max_iter->second[i]) {
+          return false;
+        }
+      }
+      return true;
+    };
+    for (auto &item : runtime_input_shape) {
+      if (!in_range(engine->min_input_shape(),
+                    engine->max_input_shape(),
+                    item.first,
+                    item.second)) {
+        return false;
+      }
+    }
+    for (auto &item : runtime_shape_tensor) {
+      if (!in_range(engine->min_shape_tensor(),
+                    engine->max_shape_tensor(),
+                    item.first,
+                    item.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Widens the shape range of the next engine to the runtime shapes, and
+  // starts building it if no engine is being built.
+  void BuildInBackground(
+      const framework::Scope &scope,
+      TensorRTEngine *trt_engine,
+      const std::map<std::string, std::vector<int32_t>> &runtime_input_shape,
+      const std::map<std::string, std::vector<int32_t>> &runtime_shape_tensor)
+      const {
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    if (!next_engine_) {
+      // the range covers the one of the engine being built
+      const TensorRTEngine *base =
+          building_engine_ ? building_engine_.get() : trt_engine;
+      next_engine_ = std::make_unique<TensorRTEngine>(base->params());
+    }
+    std::vector<std::string> changed_names;
+    std::vector<std::string> changed_tensor_names;
+    if (next_engine_->AdjustDynamicShapeRange(runtime_input_shape,
+                                              runtime_shape_tensor,
+                                              &changed_names,
+                                              &changed_tensor_names)) {
+      next_changed_names_.insert(next_changed_names_.end(),
+                                 changed_names.begin(),
+                                 changed_names.end());
+      next_changed_tensor_names_.insert(next_changed_tensor_names_.end(),
+                                        changed_tensor_names.begin(),
+                                        changed_tensor_names.end());
+    }
+    if (build_future_.valid()) {
+      return;
+    }
+    LOG(INFO) << "Build the trt engine of the wider dynamic shape range in the "
+                 "background.";
+    building_engine_ = std::move(next_engine_);
+    auto *anc = &scope;
+    while (anc->parent()) {
+      anc = anc->parent();
+    }
+    build_future_ = std::async(std::launch::async,
+                               [this,
+                                anc,
+                                engine = building_engine_.get(),
+                                changed_names = std::move(next_changed_names_),
+                                changed_tensor_names =
+                                    std::move(next_changed_tensor_names_)] {
+                                 return BuildEngine(*anc,
+                                                    engine,
+                                                    changed_names,
+                                                    changed_tensor_names);
+                               });
+    next_changed_names_.clear();
+    next_changed_tensor_names_.clear();
+  }
+
+  bool BuildEngine(const framework::Scope &scope,
+                   TensorRTEngine *engine,
+                   const std::vector<std::string> &changed_names,
+                   const std::vector<std::string> &changed_tensor_names) const {
+    // The context memory of the predictor is in use by the running engines,
+    // it is resized when the engine is swapped in.
+    TensorRTEngine::predictor_id_per_thread = -1 - predictor_id_;
+    try {
+      PrepareTRTEngine(scope, engine);
+    } catch (const std::exception &e) {
+      LOG(WARNING) << "Fail to build the trt engine in the background: "
+                   << e.what();
+      return false;
+    }
+    if (!shape_range_info_path_.empty()) {
+      inference::UpdateShapeRangeInfo(shape_range_info_path_,
+                                      engine->min_input_shape(),
+                                      engine->max_input_shape(),
+                                      engine->optim_input_shape(),
+                                      engine->min_shape_tensor(),
+                                      engine->max_shape_tensor(),
+                                      engine->optim_shape_tensor(),
+                                      changed_names,
+                                      changed_tensor_names);
+    }
+    if (use_static_engine_) {
+      nvinfer1::IHostMemory *serialized_engine_data = engine->Serialize();
+      inference::analysis::SaveTrtEngineSerializedDataToFile(
+          inference::analysis::GetTrtEngineSerializedPath(model_opt_cache_dir_,
+                                                          engine_key_),
+          std::string((const char *)serialized_engine_data->data(),
+                      serialized_engine_data->size()));
+    }
+    return true;
+  }
+
+  // Swaps in the engine built in the background if it is ready, the runs
+  // of the predictor are not concurrent so the old engine is not in use.
+  TensorRTEngine *TakeBuiltEngine() const {
+    std::lock_guard<std::mutex> lock(build_mutex_);
+    if (!build_future_.valid() ||
+        build_future_.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      return trt_engine_;
+    }
+    if (!build_future_.get()) {
+      building_engine_.reset();
+      return trt_engine_;
+    }
+    bool context_memory_sharing =
+        building_engine_->params().context_memory_sharing;
+    auto &manager =
+        inference::Singleton<inference::tensorrt::TRTEngineManager>::Global();
+    trt_engine_ = manager.Replace(engine_key_ + std::to_string(predictor_id_),
+                                  std::move(building_engine_));
+    if (context_memory_sharing) {
+      manager.ReleaseContextMemory(predictor_id_);
+    }
+    LOG(INFO) << "Swap in the trt engine of the wider dynamic shape range.";
+    return trt_engine_;
+  }
+
+  // Runs the subgraph by paddle in the scope, the variables inside the
+  // subgraph are local.
+  void RunNativeFallback(const framework::Scope &scope,
+                         const phi::Place &dev_place) const {
+    framework::Executor executor(dev_place);
+    auto *block = Attr<framework::BlockDesc *>("sub_block");
+    if (!native_ctx_) {
+      native_ctx_ = executor.Prepare(*block->Program(), block->ID());
+    }
+    auto &local_scope = scope.NewScope();
+    for (auto *var : block->AllVars()) {
+      if (scope.FindVar(var->Name()) == nullptr) {
+        framework::InitializeVariable(local_scope.Var(var->Name()),
+                                      var->GetType());
+      }
+    }
+    executor.RunPreparedContext(
+        native_ctx_.get(), &local_scope, false, false, true);
+    scope.DeleteScope(&local_scope);
+  }
+
   void RunCalibration(const framework::Scope &scope,
                       const phi::Place &dev_place) const {
     // This process will builds a 32-bit trt engine, runs it on the calibration
@@ -22,6 +22,7 @@ CPP_FILE_TEMPLATE = """
 
 #include "paddle/fluid/eager/api/utils/global_utils.h"
 #include "paddle/fluid/pybind/eager_op_function.h"
+#include "paddle/fluid/pybind/lazy_op_function.h"
 #include "paddle/fluid/pybind/manual_static_op_function.h"
 #include "paddle/fluid/pybind/static_op_function.h"
 #include "paddle/phi/core/enforce.h"
@@ -38,6 +39,11 @@ static PyMethodDef OpsAPI[] = {{
 {{nullptr, nullptr, 0, nullptr}}
 }};
 
+static const LazyStaticAPI LazyStaticAPIs[] = {{
+{lazy_static_apis}
+{{nullptr, nullptr}}
+}};
+
 void BindOpsAPI(pybind11::module *module) {{
   if (PyModule_AddFunctions(module->ptr(), OpsAPI) < 0) {{
     PADDLE_THROW(phi::errors::Fatal("Add C++ api to core.ops failed!"));
@@ -45,6 +51,7 @@ void BindOpsAPI(pybind11::module *module) {{
   if (PyModule_AddFunctions(module->ptr(), ManualOpsAPI) < 0) {{
     PADDLE_THROW(phi::errors::Fatal("Add C++ api to core.ops failed!"));
   }}
+  RegisterLazyStaticAPIs(LazyStaticAPIs);
 }}
 """
 
@@ -86,6 +93,9 @@ static PyObject *sparse_{name}(PyObject *self, PyObject *args, PyObject *kwargs)
 OPS_API_TEMPLATE = """
 {{"{name}", (PyCFunction)(void (*)(void)){name}, METH_VARARGS | METH_KEYWORDS, "C++ interface function for {name}."}},"""
 
+LAZY_STATIC_API_TEMPLATE = """
+{{"{name}", static_api_{name}}},"""
+
 SPARSE_OPS_API_TEMPLATE = """
 {{"sparse_{name}", (PyCFunction)(void (*)(void))sparse_{name}, METH_VARARGS | METH_KEYWORDS, "C++ interface function for sparse_{name}."}},"""
 
@@ -278,6 +288,12 @@ class OpsAPIGen(CodeGen):
     def _gen_sparse_one_ops_api(self, name):
         return SPARSE_OPS_API_TEMPLATE.format(name=name)
 
+    def _gen_one_lazy_static_api(self, name):
+        # The inplace ops are not recorded in the lazy mode
+        if name in NEED_GEN_STATIC_ONLY_APIS or name.endswith('_'):
+            return ''
+        return LAZY_STATIC_API_TEMPLATE.format(name=name)
+
     def gen_cpp_file(
         self, op_yaml_files, op_compat_yaml_file, namespaces, cpp_file_path
     ):
@@ -286,6 +302,7 @@ class OpsAPIGen(CodeGen):
         op_info_items = self._parse_yaml(op_yaml_files, op_compat_yaml_file)
         function_impl_str = ''
         ops_api_str = ''
+        lazy_static_api_str = ''
         for op_info in op_info_items:
             for op_name in op_info.op_phi_name:
                 if self._need_skip(op_info, op_name):
@@ -299,9 +316,14 @@ class OpsAPIGen(CodeGen):
                 else:
                     function_impl_str += self._gen_one_function_impl(op_name)
                     ops_api_str += self._gen_one_ops_api(op_name)
+                    lazy_static_api_str += self._gen_one_lazy_static_api(
+                        op_name
+                    )
 
         inner_body = NAMESPACE_INNER_TEMPLATE.format(
-            function_impl=function_impl_str, ops_api=ops_api_str
+            function_impl=function_impl_str,
+            ops_api=ops_api_str,
+            lazy_static_apis=lazy_static_api_str,
         )
 
         body = inner_body
@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <vector>
 #include "paddle/common/enforce.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_deserialize.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/ir_serialize.h"
@@ -26,12 +29,62 @@ namespace pir {
 #define PIRVERSION "version"
 #define TRAINABLE "trainable"
 #define PIR "pir"
+
+namespace {
+// The binary format starts with the magic bytes and the version of the binary
+// layout in little endian, followed by the same json as the text format but
+// encoded in MessagePack, so it is read in one pass without parsing any text.
+constexpr char kBinaryMagic[] = "\x89PIRBIN\n";
+constexpr size_t kBinaryMagicSize = sizeof(kBinaryMagic) - 1;
+constexpr size_t kBinaryHeaderSize = kBinaryMagicSize + sizeof(uint32_t);
+constexpr uint32_t kBinaryFormatVersion = 1;
+
+std::string ReadFile(const std::string& file_path) {
+  std::ifstream fin(file_path, std::ios::binary | std::ios::ate);
+  PADDLE_ENFORCE_EQ(
+      static_cast<bool>(fin),
+      true,
+      common::errors::Unavailable("Cannot open %s to load the program.",
+                                  file_path));
+  std::string content(static_cast<size_t>(fin.tellg()), '\0');
+  fin.seekg(0);
+  fin.read(content.data(), content.size());
+  return content;
+}
+
+Json ParseModule(const std::string& content) {
+  if (content.compare(0, kBinaryMagicSize, kBinaryMagic) != 0) {
+    return Json::parse(content);
+  }
+  PADDLE_ENFORCE_GE(content.size(),
+                    kBinaryHeaderSize,
+                    common::errors::InvalidArgument(
+                        "Invalid binary model file, the header is truncated."));
+  uint32_t format_version = 0;
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    format_version |= static_cast<uint32_t>(static_cast<unsigned char>(
+                          content[kBinaryMagicSize + i]))
+                      << (8 * i);
+  }
+  PADDLE_ENFORCE_LE(format_version,
+                    kBinaryFormatVersion,
+                    common::errors::InvalidArgument(
+                        "The binary model file is of the format version %d, "
+                        "which is newer than the supported version %d.",
+                        format_version,
+                        kBinaryFormatVersion));
+  return Json::from_msgpack(content.begin() + kBinaryHeaderSize,
+                            content.end());
+}
+}  // namespace
+
 void WriteModule(const pir::Program& program,
                  const std::string& file_path,
                  const uint64_t& pir_version,
                  bool overwrite,
                  bool readable,
-                 bool trainable) {
+                 bool trainable,
+                 bool binary) {
   PADDLE_ENFORCE_EQ(
       FileExists(file_path) && !overwrite,
       false,
@@ -49,12 +102,6 @@ void WriteModule(const pir::Program& program,
   ProgramWriter writer(pir_version, trainable);
   // write program
   total[PROGRAM] = writer.GetProgramJson(&program);
-  std::string total_str;
-  if (readable) {
-    total_str = total.dump(4);
-  } else {
-    total_str = total.dump();
-  }
 
   MkDirRecursively(DirName(file_path).c_str());
   std::ofstream fout(file_path, std::ios::binary);
@@ -62,15 +109,29 @@ void WriteModule(const pir::Program& program,
                     true,
                     common::errors::Unavailable(
                         "Cannot open %s to save variables.", file_path));
-  fout << total_str;
+  if (binary) {
+    std::vector<uint8_t> total_bytes = Json::to_msgpack(total);
+    char header[kBinaryHeaderSize];
+    std::copy(kBinaryMagic, kBinaryMagic + kBinaryMagicSize, header);
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+      header[kBinaryMagicSize + i] =
+          static_cast<char>((kBinaryFormatVersion >> (8 * i)) & 0xff);
+    }
+    fout.write(header, kBinaryHeaderSize);
+    fout.write(reinterpret_cast<const char*>(total_bytes.data()),
+               total_bytes.size());
+  } else if (readable) {
+    fout << total.dump(4);
+  } else {
+    fout << total.dump();
+  }
   fout.close();
 }
 
 bool ReadModule(const std::string& file_path,
                 pir::Program* program,
                 const uint64_t& pir_version) {
-  std::ifstream f(file_path);
-  Json data = Json::parse(f);
+  Json data = ParseModule(ReadFile(file_path));
   PatchBuilder builder(pir_version);
 
   if (data.contains(BASE_CODE) && data[BASE_CODE].contains(MAGIC) &&
@@ -14,11 +14,15 @@ limitations under the License. */
 #include <numeric>
 
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include "paddle/phi/common/port.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
 
+COMMON_DECLARE_int32(save_combine_data_alignment);
+COMMON_DECLARE_bool(load_combine_use_mmap);
+
 namespace pir {
 
 const phi::DeviceContext* GetDeviceContext(
@@ -134,9 +138,11 @@ void SaveCombineFunction(const std::vector<const phi::DenseTensor*>& x,
     auto out_dtype = save_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
     if (in_dtype != out_dtype) {
       auto out = CastTensorType(dev_ctx, tensor, out_dtype);
-      paddle::framework::SerializeToStream(ss, out, *dev_ctx);
+      paddle::framework::SerializeToStream(
+          ss, out, *dev_ctx, FLAGS_save_combine_data_alignment);
     } else {
-      paddle::framework::SerializeToStream(ss, tensor, *dev_ctx);
+      paddle::framework::SerializeToStream(
+          ss, tensor, *dev_ctx, FLAGS_save_combine_data_alignment);
     }
   }
   MkDirRecursively(DirName(file_path).c_str());
@@ -191,14 +197,6 @@ void LoadCombineFunction(const std::string& file_path,
                          std::vector<phi::DenseTensor*>* out,
                          bool load_as_fp16,
                          phi::Place place) {
-  std::ifstream fin(file_path, std::ios::binary);
-  PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
-                    true,
-                    phi::errors::Unavailable(
-                        "Load operator fail to open file %s, please check "
-                        "whether the model file is complete or damaged.",
-                        file_path));
-
   PADDLE_ENFORCE_GT(out->size(),
                     0UL,
                     phi::errors::InvalidArgument(
@@ -206,23 +204,38 @@ void LoadCombineFunction(const std::string& file_path,
                         "it to be greater than 0.",
                         out->size()));
   const phi::DeviceContext* dev_ctx = GetDeviceContext(*(out->at(0)), place);
-  for (size_t i = 0; i < names.size(); i++) {
-    auto tensor = out->at(i);
-    paddle::framework::DeserializeFromStream(fin, tensor, *dev_ctx);
-
+  auto cast_tensor = [&](phi::DenseTensor* tensor) {
     auto in_dtype = tensor->dtype();
     auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
     if (in_dtype != out_dtype) {
       auto cast_in = *tensor;
       *tensor = CastTensorType(dev_ctx, cast_in, out_dtype);
     }
+  };
+  if (FLAGS_load_combine_use_mmap) {
+    paddle::framework::DeserializeFromMappedFile(file_path, *out, *dev_ctx);
+    for (auto* tensor : *out) {
+      cast_tensor(tensor);
+    }
+  } else {
+    std::ifstream fin(file_path, std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
+                      true,
+                      phi::errors::Unavailable(
+                          "Load operator fail to open file %s, please check "
+                          "whether the model file is complete or damaged.",
+                          file_path));
+    for (size_t i = 0; i < names.size(); i++) {
+      paddle::framework::DeserializeFromStream(fin, out->at(i), *dev_ctx);
+      cast_tensor(out->at(i));
+    }
+    fin.peek();
+    PADDLE_ENFORCE_EQ(fin.eof(),
+                      true,
+                      phi::errors::Unavailable(
+                          "Not allowed to load partial data via "
+                          "load_combine_op, please use load_op instead."));
   }
-  fin.peek();
-  PADDLE_ENFORCE_EQ(
-      fin.eof(),
-      true,
-      phi::errors::Unavailable("Not allowed to load partial data via "
-                               "load_combine_op, please use load_op instead."));
 }
 
 }  // namespace pir
@@ -277,8 +277,7 @@ class AutoMixedPrecisionPass : public pir::Pass {
       phi::Backend backend,
       phi::DataType data_type,
       phi::DataLayout layout = phi::DataLayout::ALL_LAYOUT) const {
-    const auto& kernels = phi::KernelFactory::Instance().kernels();
-    if (kernels.count(op_type) == 0) {
+    if (phi::KernelFactory::Instance().FindKernels(op_type) == nullptr) {
       return false;
     }
     phi::KernelKey kernel_key(backend, layout, data_type);
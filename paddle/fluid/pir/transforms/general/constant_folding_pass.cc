@@ -14,8 +14,11 @@
 
 #include "paddle/fluid/pir/transforms/general/constant_folding_pass.h"
 
+#include <map>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +29,7 @@
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/dialect/operator/trait/inplace.h"
 #include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
 #include "paddle/fluid/pir/utils/general_functions.h"
 
@@ -44,6 +48,7 @@
 #include "paddle/pir/include/core/parameter.h"
 #include "paddle/pir/include/core/program.h"
 #include "paddle/pir/include/core/region.h"
+#include "paddle/pir/include/core/utils.h"
 #include "paddle/pir/include/core/value.h"
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pattern_rewrite/frozen_rewrite_pattern_set.h"
@@ -52,11 +57,68 @@
 
 namespace {
 
+// The folded results shared by the rewrites of a pass run. The same op on
+// the same weights, e.g. the transposes of a weight shared by several
+// matmuls, is folded once, and the results of the same content are kept
+// once in the scope.
+struct FoldedResultCache {
+  // the signature of a folded op -> the names of its results
+  std::unordered_map<std::string, std::vector<std::string>> op_results;
+  // the hash of the content -> the names of the folded results
+  std::unordered_map<size_t, std::vector<std::string>> content_results;
+  // the number of ParameterOps and ConstantTensorOps of each var, a var is
+  // erased from the scope with the last of them
+  std::unordered_map<std::string, int> var_refs;
+
+  void Reset(pir::Operation* module_op) {
+    op_results.clear();
+    content_results.clear();
+    var_refs.clear();
+    for (auto& block : module_op->region(0)) {
+      for (auto& op : block) {
+        if (op.isa<pir::ParameterOp>()) {
+          ++var_refs[op.dyn_cast<pir::ParameterOp>().param_name()];
+        } else if (op.isa<pir::ConstantTensorOp>()) {
+          ++var_refs[op.dyn_cast<pir::ConstantTensorOp>().tensor_name()];
+        }
+      }
+    }
+  }
+};
+
+const phi::DenseTensor& TensorOnCpu(const phi::DenseTensor& tensor,
+                                    phi::DenseTensor* cpu_tensor) {
+  if (tensor.place().GetType() == phi::AllocationType::CPU) {
+    return tensor;
+  }
+  paddle::framework::TensorCopySync(tensor, phi::CPUPlace{}, cpu_tensor);
+  return *cpu_tensor;
+}
+
+std::string_view TensorData(const phi::DenseTensor& tensor) {
+  return std::string_view(static_cast<const char*>(tensor.data()),
+                          tensor.numel() * phi::SizeOf(tensor.dtype()));
+}
+
+size_t HashTensor(const phi::DenseTensor& tensor) {
+  size_t hash = std::hash<std::string_view>()(TensorData(tensor));
+  hash = pir::detail::hash_combine(
+      hash, std::hash<std::string>()(tensor.dims().to_str()));
+  return pir::detail::hash_combine(hash,
+                                   static_cast<size_t>(tensor.dtype()));
+}
+
+bool IsSameTensor(const phi::DenseTensor& lhs, const phi::DenseTensor& rhs) {
+  return lhs.dims() == rhs.dims() && lhs.dtype() == rhs.dtype() &&
+         TensorData(lhs) == TensorData(rhs);
+}
+
 class ConstantFoldingPattern : public pir::RewritePattern {
  public:
   ConstantFoldingPattern(
       pir::IrContext* context,
       size_t* suffix,
+      FoldedResultCache* cache,
       const phi::Place& place,
       paddle::framework::Scope* scope,
       paddle::framework::interpreter::ExecutionConfig* exe_config)
@@ -65,6 +127,7 @@ class ConstantFoldingPattern : public pir::RewritePattern {
                        context,
                        {} /*generated_names*/),
         suffix_(suffix),
+        cache_(cache),
         place_(place),
         scope_(scope),
         exe_config_(exe_config) {
@@ -162,14 +225,30 @@ class ConstantFoldingPattern : public pir::RewritePattern {
                pir::PatternRewriter& rewriter) const override {  // NOLINT
     VLOG(4) << "constant_folding_pass applies rewrite on [" << op->name()
             << "] op";
-    auto output_var_names = RunOp(op, rewriter);
+    bool use_parameter_op = ReplaceResultByParameterOp(op);
+
+    // the same op on the same weights has been folded, reuse its results
+    bool is_shareable = IsResultShareable(op);
+    std::string signature =
+        is_shareable ? FoldingSignature(op, use_parameter_op) : "";
+    std::vector<std::string> output_var_names;
+    bool is_folded = false;
+    if (auto it = cache_->op_results.find(signature);
+        is_shareable && it != cache_->op_results.end() &&
+        AllVarsInScope(it->second)) {
+      VLOG(4) << "constant_folding_pass reuses the folded results of ["
+              << op->name() << "] op";
+      output_var_names = it->second;
+      ReleaseInputs(op);
+      is_folded = true;
+    } else {
+      output_var_names = RunOp(op, rewriter);
+    }
 
     // ParameterOp and ConstantTensorOp should be created in the top-level block
     rewriter.SetInsertionPointToStart(
         rewriter.block()->parent_program()->block());
 
-    bool use_parameter_op = ReplaceResultByParameterOp(op);
-
     for (uint32_t i = 0; i < op->num_results(); i++) {
       if (!op->result(i) || !op->result(i).type()) {
         continue;
@@ -196,11 +275,16 @@ class ConstantFoldingPattern : public pir::RewritePattern {
           }
         }
 
+        if (is_shareable && !is_folded) {
+          output_var_name = DeduplicateFoldedResult(output_var_name, true);
+          output_var_names[i] = output_var_name;
+        }
         auto parameter_op = rewriter.Build<pir::ParameterOp>(
             output_var_name, op->result(i).type());
         parameter_op->set_attribute(
             kAttrIsPersistable,
             rewriter.array_attr({rewriter.bool_attr(true)}));
+        ++cache_->var_refs[output_var_name];
 
         rewriter.ReplaceAllUsesWith(op->result(i), parameter_op->result(0));
 
@@ -218,15 +302,23 @@ class ConstantFoldingPattern : public pir::RewritePattern {
           }
         }
 
+        if (is_shareable && !is_folded) {
+          output_var_name = DeduplicateFoldedResult(output_var_name, false);
+          output_var_names[i] = output_var_name;
+        }
         auto constant_op = rewriter.Build<pir::ConstantTensorOp>(
             output_var_name, op->result(i).type());
         constant_op->set_attribute(
             kAttrIsPersistable,
             rewriter.array_attr({rewriter.bool_attr(true)}));
+        ++cache_->var_refs[output_var_name];
 
         rewriter.ReplaceAllUsesWith(op->result(i), constant_op->result(0));
       }
     }
+    if (is_shareable && !is_folded) {
+      cache_->op_results[signature] = output_var_names;
+    }
     rewriter.EraseOp(op);
 
     // NOTE(liuyuanle): Here, we release one useless variable after another to
@@ -240,6 +332,118 @@ class ConstantFoldingPattern : public pir::RewritePattern {
   }
 
  private:
+  // The op and the vars it folds, the ops of the same signature fold to the
+  // same results.
+  std::string FoldingSignature(pir::Operation* op,
+                               bool use_parameter_op) const {
+    std::ostringstream ss;
+    ss << op->name() << (use_parameter_op ? "@parameter" : "@constant");
+    // the attributes are uniqued by the context
+    std::map<std::string, pir::Attribute> attributes(op->attributes().begin(),
+                                                     op->attributes().end());
+    for (const auto& [name, attribute] : attributes) {
+      ss << ";" << name << "=" << attribute.storage();
+    }
+    for (uint32_t i = 0; i < op->num_operands(); i++) {
+      ss << ";";
+      if (!op->operand_source(i)) continue;
+      auto* prev_op = pir::GetDefiningOpForInput(op, i);
+      if (prev_op->isa<pir::CombineOp>()) {
+        for (uint32_t j = 0; j < prev_op->num_operands(); j++) {
+          ss << pir::GetParameterNameFromValue(prev_op->operand_source(j))
+             << ",";
+        }
+      } else {
+        ss << pir::GetParameterNameFromValue(op->operand_source(i));
+      }
+    }
+    for (uint32_t i = 0; i < op->num_results(); i++) {
+      ss << ";" << op->result(i).type().storage();
+    }
+    return ss.str();
+  }
+
+  // The results written in place by their users can't be shared.
+  bool IsResultShareable(pir::Operation* op) const {
+    for (uint32_t i = 0; i < op->num_results(); i++) {
+      for (auto it = op->result(i).use_begin(); it != op->result(i).use_end();
+           ++it) {
+        if (it->owner()->HasTrait<paddle::dialect::InplaceTrait>()) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool AllVarsInScope(const std::vector<std::string>& var_names) const {
+    for (const auto& var_name : var_names) {
+      if (scope_->FindVar(var_name) == nullptr) return false;
+    }
+    return true;
+  }
+
+  // Returns the name of a folded result of the same content as the var and
+  // erases the var, or the name of the var if it is the first of its content.
+  std::string DeduplicateFoldedResult(const std::string& var_name,
+                                      bool use_parameter_op) const {
+    auto* var = scope_->FindVar(var_name);
+    if (!var->IsType<phi::DenseTensor>()) return var_name;
+    const auto& tensor = var->Get<phi::DenseTensor>();
+    if (!tensor.IsInitialized()) return var_name;
+
+    phi::DenseTensor cpu_tensor;
+    const auto& content = TensorOnCpu(tensor, &cpu_tensor);
+    // the parameters and the constants are on different places
+    size_t hash = pir::detail::hash_combine(HashTensor(content),
+                                            use_parameter_op ? 1 : 0);
+    auto& same_hash_var_names = cache_->content_results[hash];
+    for (const auto& same_hash_var_name : same_hash_var_names) {
+      auto* same_hash_var = scope_->FindVar(same_hash_var_name);
+      if (same_hash_var == nullptr) continue;
+      phi::DenseTensor same_hash_cpu_tensor;
+      if (IsSameTensor(content,
+                       TensorOnCpu(same_hash_var->Get<phi::DenseTensor>(),
+                                   &same_hash_cpu_tensor))) {
+        VLOG(4) << "constant_folding_pass reuses the folded result ["
+                << same_hash_var_name << "] for [" << var_name << "]";
+        scope_->EraseVars({var_name});
+        return same_hash_var_name;
+      }
+    }
+    same_hash_var_names.push_back(var_name);
+    return var_name;
+  }
+
+  // Drops the reference of the op on the var of a weight it folds, returns
+  // whether it was the last one and the var is to be erased.
+  bool ReleaseVar(const std::string& var_name) const {
+    auto it = cache_->var_refs.find(var_name);
+    if (it != cache_->var_refs.end() && --(it->second) > 0) {
+      return false;
+    }
+    deleted_vars_.push_back(var_name);
+    return true;
+  }
+
+  void ReleaseInputs(pir::Operation* op) const {
+    for (uint32_t i = 0; i < op->num_operands(); i++) {
+      pir::Value input = op->operand_source(i);
+      if (!input) continue;
+      auto* prev_op = pir::GetDefiningOpForInput(op, i);
+      if (prev_op->isa<pir::CombineOp>()) {
+        for (uint32_t j = 0; j < prev_op->num_operands(); j++) {
+          if (prev_op->operand_source(j).use_count() == 1) {
+            ReleaseVar(
+                pir::GetParameterNameFromValue(prev_op->operand_source(j)));
+          }
+        }
+      } else if (input.use_count() == 1) {
+        ReleaseVar(pir::GetParameterNameFromValue(input));
+      }
+    }
+  }
+
   bool CheckUseOps(
       const std::vector<std::pair<pir::Operation*, int32_t>>& use_ops) const {
     for (auto [use_op, idx] : use_ops) {
@@ -311,11 +515,10 @@ class ConstantFoldingPattern : public pir::RewritePattern {
                                      var_name));
     auto from_op =
         builder.Build<Op>(var_name, op->operand_source(index).type());
-    if (op->operand_source(index).use_count() > 1) {
+    // the var is shared with the other ops of the program
+    if (op->operand_source(index).use_count() > 1 || !ReleaseVar(var_name)) {
       from_op->set_attribute(kAttrIsPersistable,
                              rewriter.array_attr({rewriter.bool_attr(true)}));
-    } else {
-      deleted_vars_.push_back(var_name);
     }
     return from_op;
   }
@@ -404,6 +607,7 @@ class ConstantFoldingPattern : public pir::RewritePattern {
 
  protected:
   size_t* suffix_;
+  FoldedResultCache* cache_;
   phi::Place place_;
   paddle::framework::Scope* scope_;
   paddle::framework::interpreter::ExecutionConfig* exe_config_;
@@ -415,10 +619,12 @@ class ConstantFoldingPatternForTrain : public ConstantFoldingPattern {
   ConstantFoldingPatternForTrain(
       pir::IrContext* context,
       size_t* suffix,
+      FoldedResultCache* cache,
       const phi::Place& place,
       paddle::framework::Scope* scope,
       paddle::framework::interpreter::ExecutionConfig* exe_config)
-      : ConstantFoldingPattern(context, suffix, place, scope, exe_config) {}
+      : ConstantFoldingPattern(
+            context, suffix, cache, place, scope, exe_config) {}
 
   bool Match(pir::Operation* op) const override {
     VLOG(4) << "constant_folding_pass applies match on [" << op->name()
@@ -461,6 +667,7 @@ class ConstantFoldingPatternForTrain : public ConstantFoldingPattern {
           output_var_name, op->result(i).type());
       constant_op->set_attribute(
           kAttrIsPersistable, rewriter.array_attr({rewriter.bool_attr(true)}));
+      ++cache_->var_refs[output_var_name];
 
       rewriter.ReplaceAllUsesWith(op->result(i), constant_op->result(0));
     }
@@ -501,10 +708,10 @@ class ConstantFoldingPass : public pir::Pass {
 
     if (Has("train_mode") && Get<bool>("train_mode")) {
       ps.Add<ConstantFoldingPatternForTrain>(
-          context, &suffix_, phi::CPUPlace{}, scope_, &exe_config_);
+          context, &suffix_, &cache_, phi::CPUPlace{}, scope_, &exe_config_);
     } else {
       ps.Add<ConstantFoldingPattern>(
-          context, &suffix_, place_, scope_, &exe_config_);
+          context, &suffix_, &cache_, place_, scope_, &exe_config_);
     }
     patterns_ = pir::FrozenRewritePatternSet(std::move(ps));
     return true;
@@ -518,6 +725,7 @@ class ConstantFoldingPass : public pir::Pass {
         num_ops += block.size();
       }
     }
+    cache_.Reset(op);
     pir::GreedyRewriteConfig cfg;
     cfg.use_top_down_traversal = true;
     cfg.max_iterations = 10;
@@ -527,6 +735,7 @@ class ConstantFoldingPass : public pir::Pass {
 
  private:
   size_t suffix_{0};
+  FoldedResultCache cache_;
   phi::Place place_{phi::CPUPlace{}};
   paddle::framework::Scope* scope_{nullptr};
   paddle::framework::interpreter::ExecutionConfig exe_config_{};
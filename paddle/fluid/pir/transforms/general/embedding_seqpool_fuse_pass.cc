@@ -0,0 +1,215 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/embedding_seqpool_fuse_pass.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+// An embedding whose output is only pooled by a sequence_pool, i.e. one
+// sparse slot of the CTR models.
+struct EmbeddingSeqpool {
+  pir::Operation* embedding;
+  pir::Operation* seqpool;
+};
+
+// The slots pooled from the same table with the same attributes, which are
+// fused into one fused_embedding_seqpool.
+struct EmbeddingSeqpoolGroup {
+  pir::Value weight;
+  std::string pooltype;
+  int64_t padding_idx;
+  float pad_value;
+  std::vector<EmbeddingSeqpool> slots;
+  // The first position the outputs of the slots are used at, the fused op is
+  // built before the last sequence_pool of the slots, which should be before
+  // it.
+  size_t first_use;
+};
+
+class EmbeddingSeqpoolFusePass : public pir::Pass {
+ public:
+  EmbeddingSeqpoolFusePass() : pir::Pass("embedding_seqpool_fuse_pass", 2) {}
+
+  void Run(pir::Operation* op) override {
+    int64_t num_fused = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto& block : op->region(i)) {
+        num_fused += FuseBlock(&block);
+      }
+    }
+    AddStatistics(num_fused);
+  }
+
+ private:
+  int64_t FuseBlock(pir::Block* block) {
+    int64_t num_fused = 0;
+    std::unordered_map<pir::Operation*, size_t> positions;
+    size_t position = 0;
+    for (auto& op : *block) {
+      positions[&op] = position++;
+      for (size_t i = 0; i < op.num_regions(); ++i) {
+        for (auto& inner_block : op.region(i)) {
+          num_fused += FuseBlock(&inner_block);
+        }
+      }
+    }
+
+    std::vector<EmbeddingSeqpoolGroup> groups;
+    // The indices of the groups of each table which slots can still join.
+    std::unordered_map<pir::Value, std::vector<size_t>> open_groups;
+    for (auto& op : *block) {
+      if (!op.isa<paddle::dialect::SequencePoolOp>()) {
+        continue;
+      }
+      EmbeddingSeqpool slot{nullptr, &op};
+      if (!Match(&slot)) {
+        continue;
+      }
+      size_t seqpool_position = positions.at(slot.seqpool);
+      size_t first_use = FirstUse(slot.seqpool->result(0), block, positions);
+      pir::Value weight = slot.embedding->operand_source(1);
+      auto pooltype = op.attribute<pir::StrAttribute>("pooltype").AsString();
+      auto padding_idx =
+          slot.embedding->attribute<pir::Int64Attribute>("padding_idx").data();
+      auto pad_value = op.attribute<pir::FloatAttribute>("pad_value").data();
+
+      auto& indices = open_groups[weight];
+      auto it = std::find_if(indices.begin(), indices.end(), [&](size_t i) {
+        return groups[i].pooltype == pooltype &&
+               groups[i].padding_idx == padding_idx &&
+               groups[i].pad_value == pad_value;
+      });
+      // The fused op is built before the sequence_pool of the last slot, so
+      // the slot can not join the group if some outputs of the group are used
+      // before it.
+      if (it != indices.end() && groups[*it].first_use <= seqpool_position) {
+        indices.erase(it);
+        it = indices.end();
+      }
+      size_t index = it != indices.end() ? *it : groups.size();
+      if (index == groups.size()) {
+        indices.push_back(index);
+        groups.push_back(EmbeddingSeqpoolGroup{
+            weight, pooltype, padding_idx, pad_value, {}, first_use});
+      }
+      auto* group = &groups[index];
+      group->slots.push_back(slot);
+      group->first_use = std::min(group->first_use, first_use);
+    }
+
+    for (auto& group : groups) {
+      Fuse(group, block);
+      num_fused += static_cast<int64_t>(group.slots.size());
+    }
+    return num_fused;
+  }
+
+  // Fills the embedding of the slot if the input of its sequence_pool is the
+  // output of an embedding which is used only by it.
+  bool Match(EmbeddingSeqpool* slot) const {
+    auto* seqpool = slot->seqpool;
+    auto pooltype =
+        seqpool->attribute<pir::StrAttribute>("pooltype").AsString();
+    if (pooltype != "SUM" && pooltype != "AVERAGE" && pooltype != "SQRT") {
+      return false;
+    }
+    if (!seqpool->result(1).use_empty()) {
+      return false;
+    }
+    auto x = seqpool->operand_source(0);
+    if (!x || x.use_count() != 1 || !x.defining_op() ||
+        !x.defining_op()->isa<paddle::dialect::EmbeddingOp>() ||
+        x.defining_op()->GetParent() != seqpool->GetParent()) {
+      return false;
+    }
+    auto* embedding = x.defining_op();
+    if (embedding->attribute<pir::BoolAttribute>("sparse").data()) {
+      return false;
+    }
+    slot->embedding = embedding;
+    return true;
+  }
+
+  // The position of the first op in block which uses value, or contains an
+  // op using it.
+  size_t FirstUse(
+      pir::Value value,
+      pir::Block* block,
+      const std::unordered_map<pir::Operation*, size_t>& positions) const {
+    size_t first_use = std::numeric_limits<size_t>::max();
+    for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+      auto* user = it->owner();
+      while (user != nullptr && user->GetParent() != block) {
+        user = user->GetParentOp();
+      }
+      if (user != nullptr) {
+        first_use = std::min(first_use, positions.at(user));
+      }
+    }
+    return first_use;
+  }
+
+  void Fuse(const EmbeddingSeqpoolGroup& group, pir::Block* block) {
+    pir::Builder builder(pir::IrContext::Instance(), block);
+    builder.set_insertion_point(group.slots.back().seqpool);
+    std::vector<pir::Value> ids;
+    ids.reserve(group.slots.size());
+    for (const auto& slot : group.slots) {
+      ids.push_back(slot.embedding->operand_source(0));
+    }
+    auto combine_op = builder.Build<pir::CombineOp>(ids);
+    auto fused_op = builder.Build<paddle::dialect::FusedEmbeddingSeqpoolOp>(
+        combine_op.out(),
+        group.weight,
+        group.pooltype,
+        group.padding_idx,
+        group.pad_value);
+    auto split_op = builder.Build<pir::SplitOp>(fused_op.result(0));
+    for (size_t i = 0; i < group.slots.size(); ++i) {
+      const auto& slot = group.slots[i];
+      slot.seqpool->result(0).ReplaceAllUsesWith(split_op.result(i));
+      slot.seqpool->Erase();
+      slot.embedding->Erase();
+    }
+    VLOG(4) << "Fuse " << group.slots.size()
+            << " embedding and sequence_pool into fused_embedding_seqpool";
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<Pass> CreateEmbeddingSeqpoolFusePass() {
+  return std::make_unique<EmbeddingSeqpoolFusePass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(embedding_seqpool_fuse_pass, EmbeddingSeqpoolFusePass);
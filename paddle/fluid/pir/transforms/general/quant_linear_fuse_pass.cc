@@ -0,0 +1,294 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/general/quant_linear_fuse_pass.h"
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/drr/include/drr_pattern_base.h"
+#include "paddle/fluid/pir/utils/general_functions.h"
+
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+// Reads the scales of a quantize_linear or dequantize_linear op, which are
+// the absolute max values of the quantized ranges.
+std::vector<float> GetScales(paddle::framework::Scope* scope,
+                             const pir::Value& value) {
+  auto name = pir::GetParameterNameFromValue(value);
+  auto* var = scope->FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(
+      var,
+      phi::errors::InvalidArgument("Persistable var [%s] not in scope.", name));
+  const auto& tensor = var->Get<phi::DenseTensor>();
+  phi::DenseTensor cpu_tensor;
+  const phi::DenseTensor* scale_tensor = &tensor;
+  if (tensor.place().GetType() != phi::AllocationType::CPU) {
+    paddle::framework::TensorCopySync(tensor, phi::CPUPlace{}, &cpu_tensor);
+    scale_tensor = &cpu_tensor;
+  }
+  std::vector<float> scales(scale_tensor->numel());
+  for (int64_t i = 0; i < scale_tensor->numel(); ++i) {
+    scales[i] =
+        scale_tensor->dtype() == phi::DataType::FLOAT16
+            ? static_cast<float>(scale_tensor->data<phi::dtype::float16>()[i])
+            : scale_tensor->data<float>()[i];
+  }
+  return scales;
+}
+
+bool IsScale(paddle::framework::Scope* scope, const pir::Value& value) {
+  if (!pir::ValueIsPersistable(value)) {
+    return false;
+  }
+  auto dtype = pir::GetDataTypeFromValue(value);
+  if (!dtype.isa<pir::Float16Type>() && !dtype.isa<pir::Float32Type>()) {
+    return false;
+  }
+  return scope->FindVar(pir::GetParameterNameFromValue(value)) != nullptr;
+}
+
+// Fuses the matmul of a per-tensor quantized activation and a per-channel
+// quantized int8 weight, together with the bias add and the relu after it,
+// into a quant_linear op, which runs the matmul in int8 on CPU and GPU.
+//
+//     quantize_linear(x) -> dequantize_linear  dequantize_linear(w)
+//                          \                  /
+//                               matmul
+//                                 |
+//                            add(bias), relu
+class QuantLinearFusePattern : public paddle::drr::DrrPatternBase {
+ public:
+  QuantLinearFusePattern(paddle::framework::Scope* scope,
+                         bool with_bias,
+                         bool with_relu)
+      : scope_(scope), with_bias_(with_bias), with_relu_(with_relu) {}
+
+  std::string name() const override { return "QuantLinearFusePattern"; }
+
+  uint32_t benefit() const override { return 1 + with_bias_ + with_relu_; }
+
+  void operator()(paddle::drr::DrrPatternContext* ctx) const override {
+    paddle::drr::SourcePattern pat = ctx->SourcePattern();
+    const auto& quantize_linear =
+        pat.Op(paddle::dialect::QuantizeLinearOp::name(),
+               {{"quant_axis", pat.Attr("x_quant_axis")},
+                {"qmax", pat.Attr("x_qmax")},
+                {"round_type", pat.Attr("round_type")}});
+    const auto& dequantize_linear =
+        pat.Op(paddle::dialect::DequantizeLinearOp::name(),
+               {{"quant_axis", pat.Attr("x_dequant_axis")},
+                {"qmax", pat.Attr("x_deqmax")}});
+    const auto& weight_dequantize_linear =
+        pat.Op(paddle::dialect::DequantizeLinearOp::name(),
+               {{"quant_axis", pat.Attr("w_quant_axis")},
+                {"qmax", pat.Attr("w_qmax")}});
+    quantize_linear({&pat.Tensor("x"),
+                     &pat.Tensor("x_scale"),
+                     &pat.Tensor("x_zero_point"),
+                     &pat.InputNoneTensor(),
+                     &pat.InputNoneTensor()},
+                    {&pat.Tensor("quantize_out"),
+                     &pat.OutputNoneTensor(),
+                     &pat.OutputNoneTensor(),
+                     &pat.OutputNoneTensor()});
+    dequantize_linear({&pat.Tensor("quantize_out"),
+                       &pat.Tensor("x_descale"),
+                       &pat.Tensor("x_dezero_point"),
+                       &pat.InputNoneTensor(),
+                       &pat.InputNoneTensor()},
+                      {&pat.Tensor("dequantize_out"),
+                       &pat.OutputNoneTensor(),
+                       &pat.OutputNoneTensor(),
+                       &pat.OutputNoneTensor()});
+    weight_dequantize_linear({&pat.Tensor("w"),
+                              &pat.Tensor("w_scale"),
+                              &pat.Tensor("w_zero_point"),
+                              &pat.InputNoneTensor(),
+                              &pat.InputNoneTensor()},
+                             {&pat.Tensor("w_dequantize_out"),
+                              &pat.OutputNoneTensor(),
+                              &pat.OutputNoneTensor(),
+                              &pat.OutputNoneTensor()});
+    const auto& matmul = pat.Op(paddle::dialect::MatmulOp::name(),
+                                {{"transpose_x", pat.Attr("transpose_x")},
+                                 {"transpose_y", pat.Attr("transpose_y")}});
+    pat.Tensor("matmul_out") =
+        matmul(pat.Tensor("dequantize_out"), pat.Tensor("w_dequantize_out"));
+    std::string out_name = "matmul_out";
+    if (with_bias_) {
+      const auto& add = pat.Op(paddle::dialect::AddOp::name());
+      pat.Tensor("add_out") = add(pat.Tensor("matmul_out"), pat.Tensor("bias"));
+      out_name = "add_out";
+    }
+    if (with_relu_) {
+      const auto& relu = pat.Op(paddle::dialect::ReluOp::name());
+      pat.Tensor("relu_out") = relu(pat.Tensor(out_name));
+      out_name = "relu_out";
+    }
+
+    pat.AddConstraint([this](const paddle::drr::MatchContext& match_ctx) {
+      if (match_ctx.Attr<bool>("transpose_x") ||
+          match_ctx.Attr<bool>("transpose_y")) {
+        return false;
+      }
+      // the activation is quantized per tensor, the weight per output channel
+      // or per tensor, both into int8
+      if (match_ctx.Attr<int>("x_quant_axis") != -1 ||
+          match_ctx.Attr<int>("x_dequant_axis") != -1) {
+        return false;
+      }
+      int w_quant_axis = match_ctx.Attr<int>("w_quant_axis");
+      if (w_quant_axis != -1 && w_quant_axis != 1) {
+        return false;
+      }
+      if (match_ctx.Attr<int>("x_qmax") != 127 ||
+          match_ctx.Attr<int>("x_deqmax") != 127 ||
+          match_ctx.Attr<int>("w_qmax") != 127) {
+        return false;
+      }
+      if (!IsScale(scope_, match_ctx.Tensor("x_scale")) ||
+          !IsScale(scope_, match_ctx.Tensor("w_scale"))) {
+        return false;
+      }
+
+      const auto& w = match_ctx.Tensor("w");
+      if (!pir::ValueIsPersistable(w) ||
+          !pir::GetDataTypeFromValue(w).isa<pir::Int8Type>()) {
+        return false;
+      }
+      auto w_dims = pir::GetShapeFromValue(w);
+      auto x_dims = pir::GetShapeFromValue(match_ctx.Tensor("x"));
+      if (w_dims.size() != 2 || x_dims.size() < 2 ||
+          x_dims.back() != w_dims[0]) {
+        return false;
+      }
+      // the float kernels of quant_linear are float and double
+      auto x_dtype = pir::GetDataTypeFromValue(match_ctx.Tensor("x"));
+      if (!x_dtype.isa<pir::Float32Type>()) {
+        return false;
+      }
+      auto w_scale_size =
+          GetScales(scope_, match_ctx.Tensor("w_scale")).size();
+      if (w_scale_size != 1 &&
+          w_scale_size != static_cast<size_t>(w_dims[1])) {
+        return false;
+      }
+      if (with_bias_) {
+        auto bias_dims = pir::GetShapeFromValue(match_ctx.Tensor("bias"));
+        if (bias_dims.size() != 1 || bias_dims[0] != w_dims[1]) {
+          return false;
+        }
+      }
+      return true;
+    });
+
+    paddle::drr::ResultPattern res = pat.ResultPattern();
+    const auto& in_num_col_dims =
+        res.ComputeAttr([](const paddle::drr::MatchContext& match_ctx) -> int {
+          return pir::GetShapeFromValue(match_ctx.Tensor("x")).size() - 1;
+        });
+    const auto& scale_in = res.ComputeAttr(
+        [this](const paddle::drr::MatchContext& match_ctx) -> float {
+          return 1.0f / GetScales(scope_, match_ctx.Tensor("x_scale"))[0];
+        });
+    const auto& scale_weights = res.ComputeAttr(
+        [this](const paddle::drr::MatchContext& match_ctx)
+            -> std::vector<float> {
+          auto scales = GetScales(scope_, match_ctx.Tensor("w_scale"));
+          auto channels = pir::GetShapeFromValue(match_ctx.Tensor("w"))[1];
+          std::vector<float> scale_weights(channels);
+          for (int64_t i = 0; i < channels; ++i) {
+            scale_weights[i] = 1.0f / scales[scales.size() == 1 ? 0 : i];
+          }
+          return scale_weights;
+        });
+    const auto& quant_max_bound = res.ComputeAttr(
+        [](const paddle::drr::MatchContext& match_ctx) -> float {
+          return match_ctx.Attr<int>("x_qmax");
+        });
+    const auto& quant_min_bound = res.ComputeAttr(
+        [](const paddle::drr::MatchContext& match_ctx) -> float {
+          return -match_ctx.Attr<int>("x_qmax");
+        });
+    const auto& quant_linear =
+        res.Op(paddle::dialect::QuantLinearOp::name(),
+               {{"in_num_col_dims", in_num_col_dims},
+                {"activation_type", res.StrAttr(with_relu_ ? "relu" : "")},
+                {"padding_weights", res.BoolAttr(false)},
+                {"scale_in", scale_in},
+                {"scale_weights", scale_weights},
+                {"quant_round_type", pat.Attr("round_type")},
+                {"quant_max_bound", quant_max_bound},
+                {"quant_min_bound", quant_min_bound}});
+    quant_linear({&res.Tensor("x"),
+                  &res.Tensor("w"),
+                  with_bias_ ? &res.Tensor("bias") : &res.InputNoneTensor()},
+                 {&res.Tensor(out_name)});
+  }
+
+ private:
+  paddle::framework::Scope* scope_{nullptr};
+  bool with_bias_;
+  bool with_relu_;
+};
+
+class QuantLinearFusePass : public pir::PatternRewritePass {
+ public:
+  QuantLinearFusePass()
+      : pir::PatternRewritePass("quant_linear_fuse_pass", 2) {}
+
+  pir::RewritePatternSet InitializePatterns(pir::IrContext* context) override {
+    PADDLE_ENFORCE_EQ(Has(pir::Pass::kParamScopeAttr),
+                      true,
+                      phi::errors::InvalidArgument(
+                          "Pass initialize failed."
+                          "When using QuantLinearFusePass, scope "
+                          "attribute is required!"
+                          "Use Set method to set the scope attribute."));
+    scope_ = &Get<paddle::framework::Scope>(pir::Pass::kParamScopeAttr);
+    PADDLE_ENFORCE_NOT_NULL(
+        scope_, phi::errors::InvalidArgument("scope can not be nullptr"));
+    pir::RewritePatternSet ps(context);
+    ps.Add(paddle::drr::Create<QuantLinearFusePattern>(
+        context, scope_, true, true));
+    ps.Add(paddle::drr::Create<QuantLinearFusePattern>(
+        context, scope_, true, false));
+    ps.Add(paddle::drr::Create<QuantLinearFusePattern>(
+        context, scope_, false, false));
+    return ps;
+  }
+
+ private:
+  paddle::framework::Scope* scope_{nullptr};
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<Pass> CreateQuantLinearFusePass() {
+  return std::make_unique<QuantLinearFusePass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(quant_linear_fuse_pass, QuantLinearFusePass);
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/pir/transforms/general/transfer_layout_pass.h"
 
+#include <algorithm>
 #include <deque>
 #include <fstream>
 #include <iomanip>
@@ -189,10 +190,43 @@ struct FlowGraph {
     adjs[dst].push_back(edges.size() - 1);
   }
 
+  // The elements moved by a transpose of the value, the dynamic dims are
+  // counted as 1.
+  static float TransposeNumel(pir::Value value) {
+    auto t = value.type().dyn_cast<paddle::dialect::DenseTensorType>();
+    if (!t) return 0.0f;
+    float numel = 1.0f;
+    for (int i = 0; i < t.dims().size(); ++i) {
+      numel *= static_cast<float>(std::max<int64_t>(t.dims()[i], 1));
+    }
+    return numel;
+  }
+
+  // The capacity of cutting an edge is the cost of the transpose it
+  // inserts, relative to the largest transpose in the program so that the
+  // flows stay in the precision the max flow works with.
+  float TransposeCost(pir::Value value) const {
+    if (max_transpose_numel <= 0.0f) return 1.0f;
+    return std::max(TransposeNumel(value) / max_transpose_numel,
+                    kMinTransposeCost);
+  }
+
+  static constexpr float kMinTransposeCost = 1e-4f;
+  float max_transpose_numel{0.0f};
+
   explicit FlowGraph(const pir::Program& program) : program(program) {
     // We assume by default that the program is topologically sorted;
     // otherwise, it will fail during destruction.
 
+    for (auto& op : *(program.block())) {
+      for (const auto& op_result : op.results()) {
+        if (op_result && op_result.type()) {
+          max_transpose_numel =
+              std::max(max_transpose_numel, TransposeNumel(op_result));
+        }
+      }
+    }
+
     for (auto& op : *(program.block())) {
       Node op_node(&op);
       auto layout_transform_iface =
@@ -212,7 +246,7 @@ struct FlowGraph {
         // the capacity should be set as the out_degree of operand node
         float weight = 1.0f;
         if (operand && operand.type()) {
-          weight = 1.0f / (operand.use_count());
+          weight = TransposeCost(operand) / (operand.use_count());
           if (auto t = operand.type().dyn_cast<pir::VectorType>()) {
             weight = INF;
           }
@@ -226,6 +260,7 @@ struct FlowGraph {
 
         float weight = 1.0f;
         if (op_result && op_result.type()) {
+          weight = TransposeCost(op_result);
           if (auto t = op_result.type().dyn_cast<pir::VectorType>()) {
             weight = INF;
           }
@@ -15,6 +15,8 @@
 #include "paddle/fluid/pir/transforms/gpu/add_norm_fuse_pass.h"
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/drr/include/drr_pattern_base.h"
@@ -398,6 +400,221 @@ class AddGroupNormWithActPattern : public paddle::drr::DrrPatternBase {
   }
 };
 
+// The attributes and the outputs of rms_norm and
+// fused_bias_residual_layernorm, which take the same inputs of
+// (x, bias, residual, norm_weight, norm_bias).
+std::unordered_map<std::string, paddle::drr::Attribute> NormAttrs(
+    const paddle::drr::SourcePattern &pat, bool is_rms_norm) {
+  std::unordered_map<std::string, paddle::drr::Attribute> attrs{
+      {"epsilon", pat.Attr("epsilon")},
+      {"begin_norm_axis", pat.Attr("begin_norm_axis")},
+      {"quant_scale", pat.Attr("quant_scale")},
+      {"quant_round_type", pat.Attr("quant_round_type")},
+      {"quant_max_bound", pat.Attr("quant_max_bound")},
+      {"quant_min_bound", pat.Attr("quant_min_bound")},
+  };
+  if (!is_rms_norm) {
+    attrs.emplace("residual_alpha", pat.Attr("residual_alpha"));
+  }
+  return attrs;
+}
+
+template <typename Pattern>
+std::vector<const paddle::drr::Tensor *> NormOutputs(
+    Pattern *pat,
+    bool is_rms_norm,
+    const std::string &out,
+    const std::string &suffix) {
+  if (is_rms_norm) {
+    return {&pat->Tensor(out),
+            &pat->Tensor("residual_out" + suffix),
+            &pat->Tensor("inv_var" + suffix)};
+  }
+  return {&pat->Tensor(out),
+          &pat->Tensor("residual_out" + suffix),
+          &pat->Tensor("mean_out" + suffix),
+          &pat->Tensor("variance_out" + suffix)};
+}
+
+// Folds the bias add of the GEMM before the residual add, which is usually
+// not fused by the GEMM, into the bias of the fused norm, whose residual_out
+// is the sum of x, bias and residual.
+class AddBiasNormFusePattern : public paddle::drr::DrrPatternBase {
+ private:
+  const bool is_rms_norm_;
+  const bool bias_on_residual_;
+
+ public:
+  AddBiasNormFusePattern(bool is_rms_norm, bool bias_on_residual)
+      : is_rms_norm_(is_rms_norm), bias_on_residual_(bias_on_residual) {}
+
+  uint32_t benefit() const override { return 2; }
+
+  std::string name() const override { return "AddBiasNormFusePattern"; }
+
+  void operator()(paddle::drr::DrrPatternContext *ctx) const override {
+    paddle::drr::SourcePattern pat = ctx->SourcePattern();
+    const std::string norm_name =
+        is_rms_norm_ ? paddle::dialect::RmsNormOp::name()
+                     : paddle::dialect::FusedBiasResidualLayernormOp::name();
+    const auto &add = pat.Op(paddle::dialect::AddOp::name());
+    const auto &pat_norm = pat.Op(norm_name, NormAttrs(pat, is_rms_norm_));
+    const std::string biased = bias_on_residual_ ? "residual" : "x";
+    const std::string other = bias_on_residual_ ? "x" : "residual";
+    pat.Tensor("add_out") = add(pat.Tensor(biased), pat.Tensor("bias"));
+    pat_norm({bias_on_residual_ ? &pat.Tensor(other) : &pat.Tensor("add_out"),
+              &pat.InputNoneTensor(),
+              bias_on_residual_ ? &pat.Tensor("add_out") : &pat.Tensor(other),
+              &pat.Tensor("w"),
+              &pat.Tensor("norm_bias")},
+             NormOutputs(&pat, is_rms_norm_, "norm_out", ""));
+    pat.AddConstraint([this](const paddle::drr::MatchContext &match_ctx) {
+      if (!match_ctx.Tensor(this->bias_on_residual_ ? "x" : "residual")) {
+        return false;
+      }
+      // The residual is scaled by residual_alpha in the layer_norm.
+      if (!this->is_rms_norm_ && this->bias_on_residual_ &&
+          match_ctx.Attr<float>("residual_alpha") != 1.0f) {
+        return false;
+      }
+      auto add_in_shape = pir::GetShapeFromValue(
+          match_ctx.Tensor(this->bias_on_residual_ ? "residual" : "x"));
+      auto bias_shape = pir::GetShapeFromValue(match_ctx.Tensor("bias"));
+      auto begin_norm_axis = match_ctx.Attr<int>("begin_norm_axis");
+      if (begin_norm_axis != static_cast<int>(add_in_shape.size()) - 1 ||
+          bias_shape.size() != 1 || bias_shape[0] != add_in_shape.back()) {
+        return false;
+      }
+      return pir::GetDataTypeFromValue(match_ctx.Tensor("bias")) ==
+             pir::GetDataTypeFromValue(match_ctx.Tensor("add_out"));
+    });
+
+    paddle::drr::ResultPattern res = pat.ResultPattern();
+    const auto &res_norm = res.Op(norm_name, NormAttrs(pat, is_rms_norm_));
+    res_norm({&res.Tensor("x"),
+              &res.Tensor("bias"),
+              &res.Tensor("residual"),
+              &res.Tensor("w"),
+              &res.Tensor("norm_bias")},
+             NormOutputs(&res, is_rms_norm_, "norm_out", ""));
+  }
+};
+
+// Quantizes the output of the fused norm for the int8 or fp8 GEMM after it:
+//   int8: cast(clip(round(scale(norm_out)), min, max), int8)
+//   fp8:  cast(clip(scale(norm_out), min, max), float8_e4m3fn)
+// so the normalized output is written only once in the quantized type.
+class NormQuantFusePattern : public paddle::drr::DrrPatternBase {
+ private:
+  const bool is_rms_norm_;
+  const bool is_int8_;
+
+ public:
+  NormQuantFusePattern(bool is_rms_norm, bool is_int8)
+      : is_rms_norm_(is_rms_norm), is_int8_(is_int8) {}
+
+  uint32_t benefit() const override { return 5; }
+
+  std::string name() const override { return "NormQuantFusePattern"; }
+
+  void operator()(paddle::drr::DrrPatternContext *ctx) const override {
+    paddle::drr::SourcePattern pat = ctx->SourcePattern();
+    const std::string norm_name =
+        is_rms_norm_ ? paddle::dialect::RmsNormOp::name()
+                     : paddle::dialect::FusedBiasResidualLayernormOp::name();
+    const auto &pat_norm = pat.Op(norm_name, NormAttrs(pat, is_rms_norm_));
+    const auto &full_scale = pat.Op(paddle::dialect::FullOp::name(),
+                                    {{"value", pat.Attr("scale_value")}});
+    const auto &scale = pat.Op(paddle::dialect::ScaleOp::name(),
+                               {{"bias", pat.Attr("scale_bias")}});
+    const auto &full_min = pat.Op(paddle::dialect::FullOp::name(),
+                                  {{"value", pat.Attr("min_value")}});
+    const auto &full_max = pat.Op(paddle::dialect::FullOp::name(),
+                                  {{"value", pat.Attr("max_value")}});
+    const auto &clip = pat.Op(paddle::dialect::ClipOp::name());
+    const auto &cast = pat.Op(paddle::dialect::CastOp::name(),
+                              {{"dtype", pat.Attr("quant_dtype")}});
+    pat_norm({&pat.Tensor("x"),
+              &pat.Tensor("bias"),
+              &pat.Tensor("residual"),
+              &pat.Tensor("w"),
+              &pat.Tensor("norm_bias")},
+             NormOutputs(&pat, is_rms_norm_, "norm_out", "_0"));
+    pat.Tensor("scale_out") = scale(pat.Tensor("norm_out"), full_scale());
+    if (is_int8_) {
+      const auto &round = pat.Op(paddle::dialect::RoundOp::name(),
+                                 {{"decimals", pat.Attr("decimals")}});
+      pat.Tensor("round_out") = round(pat.Tensor("scale_out"));
+      pat.Tensor("clip_out") =
+          clip(pat.Tensor("round_out"), full_min(), full_max());
+    } else {
+      pat.Tensor("clip_out") =
+          clip(pat.Tensor("scale_out"), full_min(), full_max());
+    }
+    pat.Tensor("quant_out") = cast(pat.Tensor("clip_out"));
+    pat.AddConstraint([this](const paddle::drr::MatchContext &match_ctx) {
+      // The norm is not quantized yet.
+      if (match_ctx.Attr<float>("quant_scale") > 0.0f) {
+        return false;
+      }
+      if (match_ctx.Attr<float>("scale_bias") != 0.0f ||
+          match_ctx.Attr<double>("scale_value") <= 0.0) {
+        return false;
+      }
+      // The output data type of the norm is deduced by quant_max_bound.
+      auto quant_dtype = match_ctx.Attr<phi::DataType>("quant_dtype");
+      auto max_value = match_ctx.Attr<double>("max_value");
+      auto min_value = match_ctx.Attr<double>("min_value");
+      if (min_value >= 0.0) {
+        return false;
+      }
+      if (this->is_int8_) {
+        return quant_dtype == phi::DataType::INT8 && max_value == 127.0 &&
+               match_ctx.Attr<int>("decimals") == 0;
+      }
+      return quant_dtype == phi::DataType::FLOAT8_E4M3FN && max_value == 448.0;
+    });
+
+    paddle::drr::ResultPattern res = pat.ResultPattern();
+    // The norm computes max_bound * quant_scale * x.
+    const auto &quant_scale =
+        res.ComputeAttr(
+            [](const paddle::drr::MatchContext &match_ctx) -> float {
+              return match_ctx.Attr<double>("scale_value") /
+                     match_ctx.Attr<double>("max_value");
+            });
+    const auto &quant_max_bound =
+        res.ComputeAttr(
+            [](const paddle::drr::MatchContext &match_ctx) -> float {
+              return match_ctx.Attr<double>("max_value");
+            });
+    const auto &quant_min_bound =
+        res.ComputeAttr(
+            [](const paddle::drr::MatchContext &match_ctx) -> float {
+              return match_ctx.Attr<double>("min_value");
+            });
+    std::unordered_map<std::string, paddle::drr::Attribute> attrs{
+        {"epsilon", pat.Attr("epsilon")},
+        {"begin_norm_axis", pat.Attr("begin_norm_axis")},
+        {"quant_scale", quant_scale},
+        // round() of paddle.round rounds half away from zero.
+        {"quant_round_type", res.Int32Attr(1)},
+        {"quant_max_bound", quant_max_bound},
+        {"quant_min_bound", quant_min_bound},
+    };
+    if (!is_rms_norm_) {
+      attrs.emplace("residual_alpha", pat.Attr("residual_alpha"));
+    }
+    const auto &res_norm = res.Op(norm_name, attrs);
+    res_norm({&res.Tensor("x"),
+              &res.Tensor("bias"),
+              &res.Tensor("residual"),
+              &res.Tensor("w"),
+              &res.Tensor("norm_bias")},
+             NormOutputs(&res, is_rms_norm_, "quant_out", "_0"));
+  }
+};
+
 class AddNormFusePass : public pir::PatternRewritePass {
  public:
   AddNormFusePass() : pir::PatternRewritePass("add_norm_fuse_pass", 2) {}
@@ -443,6 +660,32 @@ class AddNormFusePass : public pir::PatternRewritePass {
     ps.Add(paddle::drr::Create<AddGroupNormFusePattern>(
         context, extra_add, false));
 
+    bool is_rms_norm = true;
+    bool bias_on_residual = true;
+    // x----add-----
+    // bias-         rms_norm ---> rms_norm
+    // residual-----
+    ps.Add(paddle::drr::Create<AddBiasNormFusePattern>(
+        context, is_rms_norm, !bias_on_residual));
+    ps.Add(paddle::drr::Create<AddBiasNormFusePattern>(
+        context, is_rms_norm, bias_on_residual));
+    ps.Add(paddle::drr::Create<AddBiasNormFusePattern>(
+        context, !is_rms_norm, !bias_on_residual));
+    ps.Add(paddle::drr::Create<AddBiasNormFusePattern>(
+        context, !is_rms_norm, bias_on_residual));
+
+    // rms_norm-scale-round-clip-cast(int8) ---> rms_norm
+    // rms_norm-scale-clip-cast(float8_e4m3fn) ---> rms_norm
+    bool is_int8 = true;
+    ps.Add(paddle::drr::Create<NormQuantFusePattern>(
+        context, is_rms_norm, is_int8));
+    ps.Add(paddle::drr::Create<NormQuantFusePattern>(
+        context, is_rms_norm, !is_int8));
+    ps.Add(paddle::drr::Create<NormQuantFusePattern>(
+        context, !is_rms_norm, is_int8));
+    ps.Add(paddle::drr::Create<NormQuantFusePattern>(
+        context, !is_rms_norm, !is_int8));
+
     // add_group_norm_silu-silu --->add_group_norm_silu
     ps.Add(paddle::drr::Create<AddGroupNormWithActPattern>(context));
     // group-silu->add_group_norm_silu moved to group_norm_silu_fuse_pass
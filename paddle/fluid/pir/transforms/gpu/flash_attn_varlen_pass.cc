@@ -0,0 +1,167 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/gpu/flash_attn_varlen_pass.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/utils/general_functions.h"
+
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+
+namespace {
+
+// The packed sequences, e.g. the tokens of a batch concatenated without
+// padding, are fed as [1, total_tokens, ...] with the int32 cu_seqlens
+// [batch + 1] of their offsets. The layer norms, the FFNs and their fusions
+// work token by token, so only the attention has to be bound within the
+// sequences:
+//
+//   q[1, total, head, head_dim]   k   v   mask
+//                |                |   |    |
+//                 ---------flash_attn-------
+//
+// is rewritten as
+//
+//   q[total, head, head_dim]   k   v   cu_seqlens
+//                |             |   |       |
+//                 -----flash_attn_unpadded--
+//
+// and the padding mask, which is of no use with the packed sequences, is
+// dropped.
+class FlashAttnVarlenPattern
+    : public pir::OpRewritePattern<paddle::dialect::FlashAttnOp> {
+ public:
+  FlashAttnVarlenPattern(pir::IrContext *context,
+                         const std::string &cu_seqlens_name,
+                         int64_t max_seqlen)
+      : pir::OpRewritePattern<paddle::dialect::FlashAttnOp>(context),
+        cu_seqlens_name_(cu_seqlens_name),
+        max_seqlen_(max_seqlen) {}
+
+  bool MatchAndRewrite(
+      paddle::dialect::FlashAttnOp op,
+      pir::PatternRewriter &rewriter) const override {  // NOLINT
+    if (op->operand_source(3)) return false;
+    for (uint32_t i = 1; i < op->num_results(); ++i) {
+      if (!op->result(i).use_empty()) return false;
+    }
+    if (!op.attribute<pir::BoolAttribute>("is_test").data()) return false;
+
+    pir::Value q = op->operand_source(0);
+    pir::Value k = op->operand_source(1);
+    pir::Value v = op->operand_source(2);
+    auto q_shape = pir::GetShapeFromValue(q);
+    auto k_shape = pir::GetShapeFromValue(k);
+    if (q_shape.size() != 4 || k_shape.size() != 4) return false;
+    int64_t num_heads = q_shape[2];
+    int64_t head_dim = q_shape[3];
+    if (num_heads <= 0 || head_dim <= 0 || k_shape[2] <= 0 ||
+        k_shape[3] != head_dim || pir::GetShapeFromValue(v) != k_shape) {
+      return false;
+    }
+
+    pir::Value cu_seqlens = FindCuSeqlens(op);
+    if (!cu_seqlens) return false;
+
+    auto q_packed = rewriter.Build<paddle::dialect::ReshapeOp>(
+        q, std::vector<int64_t>{-1, num_heads, head_dim});
+    auto k_packed = rewriter.Build<paddle::dialect::ReshapeOp>(
+        k, std::vector<int64_t>{-1, k_shape[2], head_dim});
+    auto v_packed = rewriter.Build<paddle::dialect::ReshapeOp>(
+        v, std::vector<int64_t>{-1, k_shape[2], head_dim});
+    float scale = 1.f / std::sqrt(static_cast<float>(head_dim));
+    auto flash_attn_unpadded =
+        rewriter.Build<paddle::dialect::FlashAttnUnpaddedOp>(
+            q_packed.out(),
+            k_packed.out(),
+            v_packed.out(),
+            cu_seqlens,
+            cu_seqlens,
+            pir::Value(),
+            pir::Value(),
+            max_seqlen_,
+            max_seqlen_,
+            scale,
+            op.attribute<pir::FloatAttribute>("dropout").data(),
+            op.attribute<pir::BoolAttribute>("causal").data(),
+            false,
+            true,
+            "");
+    auto q_shape_op = rewriter.Build<paddle::dialect::ShapeOp>(q);
+    auto out = rewriter.Build<paddle::dialect::ReshapeOp>(
+        flash_attn_unpadded->result(0), q_shape_op.out());
+    rewriter.ReplaceAllUsesWith(op->result(0), out.out());
+    rewriter.EraseOp(op);
+    return true;
+  }
+
+ private:
+  pir::Value FindCuSeqlens(pir::Operation *op) const {
+    pir::Program *program = op->GetParentProgram();
+    if (program == nullptr) return pir::Value();
+    for (auto &block_op : *program->block()) {
+      if (block_op.isa<paddle::dialect::DataOp>() &&
+          block_op.attribute<pir::StrAttribute>("name").AsString() ==
+              cu_seqlens_name_) {
+        return block_op.result(0);
+      }
+    }
+    return pir::Value();
+  }
+
+  std::string cu_seqlens_name_;
+  int64_t max_seqlen_;
+};
+
+class FlashAttnVarlenPass : public pir::PatternRewritePass {
+ public:
+  FlashAttnVarlenPass()
+      : pir::PatternRewritePass("flash_attn_varlen_pass", 2) {}
+
+  pir::RewritePatternSet InitializePatterns(pir::IrContext *context) override {
+    pir::RewritePatternSet ps(context);
+    if (Has(std::string("cu_seqlens_name")) &&
+        Has(std::string("max_seqlen"))) {
+      ps.Add<FlashAttnVarlenPattern>(
+          context,
+          Get<std::string>(std::string("cu_seqlens_name")),
+          Get<int>(std::string("max_seqlen")));
+    }
+    return ps;
+  }
+
+  bool CanApplyOn(pir::Operation *op) const override {
+#ifdef PADDLE_WITH_FLASHATTN
+    return Has(std::string("cu_seqlens_name")) && op->num_regions() > 0;
+#else
+    return false;
+#endif
+  }
+};
+
+}  // namespace
+
+namespace pir {
+std::unique_ptr<Pass> CreateFlashAttnVarlenPass() {
+  return std::make_unique<FlashAttnVarlenPass>();
+}
+}  // namespace pir
+
+REGISTER_IR_PASS(flash_attn_varlen_pass, FlashAttnVarlenPass);
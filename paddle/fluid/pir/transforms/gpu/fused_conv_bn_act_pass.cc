@@ -0,0 +1,562 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pir/transforms/gpu/fused_conv_bn_act_pass.h"
+
+#include <unordered_set>
+
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/utils/general_functions.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#endif
+
+#include "paddle/pir/include/core/builtin_attribute.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/pass/pass.h"
+#include "paddle/pir/include/pass/pass_registry.h"
+#include "paddle/pir/include/pattern_rewrite/pattern_match.h"
+
+// The pass fuses the conv2d + batch_norm_ + relu chains of the NHWC fp16
+// training programs, as the residual units of ResNet, into the ops of the
+// cuDNN frontend runtime fusion, as fuse_resunit_pass does for the old IR:
+//   fused_scale_bias_relu_conv_bn: [scale + bias + relu of the input] +
+//     conv2d + the statistics of batch_norm_
+//   fused_scale_bias_add_relu: the normalization of batch_norm_ + add of the
+//     shortcut or of another normalized conv + relu
+//   fused_dconv_drelu_dbn: conv2d_grad of the conv after a relu + relu_grad
+//     [+ add_grad] + batch_norm_grad
+// A unit is fused with all its backward ops, or only when it has none.
+
+namespace {
+
+bool IsFloat16(pir::Value value) {
+  return pir::GetDataTypeFromValue(value).isa<pir::Float16Type>();
+}
+
+// The conv2d or conv2d_grad is supported by the fused convs.
+bool IsFusibleConv(pir::Operation *op) {
+  return op->attribute<pir::StrAttribute>("data_format").AsString() ==
+             "NHWC" &&
+         op->attribute<pir::Int32Attribute>("groups").data() == 1;
+}
+
+bool UsersIn(pir::Value value,
+             const std::unordered_set<pir::Operation *> &ops) {
+  for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+    if (!ops.count(it->owner())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The only user of the value of OpTy taking it as the operand index, or a null
+// op if there is none or more than one.
+template <typename OpTy>
+OpTy UniqueUser(pir::Value value, uint32_t index) {
+  pir::Operation *user = nullptr;
+  for (auto it = value.use_begin(); it != value.use_end(); ++it) {
+    if (!it->owner()->isa<OpTy>() || it->index() != index) {
+      continue;
+    }
+    if (user != nullptr) {
+      return OpTy::dyn_cast(nullptr);
+    }
+    user = it->owner();
+  }
+  return OpTy::dyn_cast(user);
+}
+
+// A conv2d + batch_norm_ in training, with the batch_norm_grad of the
+// batch_norm_ if the program has the backward of it.
+struct ConvBn {
+  paddle::dialect::Conv2dOp conv;
+  paddle::dialect::BatchNorm_Op bn;
+  paddle::dialect::BatchNormGradOp bn_grad;
+};
+
+bool MatchConvBn(pir::Value bn_out, ConvBn *unit) {
+  auto bn = bn_out.defining_op<paddle::dialect::BatchNorm_Op>();
+  if (!bn || bn.out() != bn_out) {
+    return false;
+  }
+  if (bn->attribute<pir::BoolAttribute>("is_test").data() ||
+      bn->attribute<pir::BoolAttribute>("use_global_stats").data() ||
+      bn->attribute<pir::BoolAttribute>("trainable_statistics").data() ||
+      bn->attribute<pir::StrAttribute>("data_format").AsString() != "NHWC") {
+    return false;
+  }
+  auto conv = bn.x().defining_op<paddle::dialect::Conv2dOp>();
+  if (!conv || !IsFusibleConv(conv) || !IsFloat16(conv.input())) {
+    return false;
+  }
+  // saved_mean is the operand 5 of batch_norm_grad
+  auto bn_grad =
+      UniqueUser<paddle::dialect::BatchNormGradOp>(bn.saved_mean(), 5);
+  std::unordered_set<pir::Operation *> conv_out_users = {bn};
+  std::unordered_set<pir::Operation *> bn_grad_users;
+  if (bn_grad) {
+    if (bn_grad.x() != conv.out()) {
+      return false;
+    }
+    conv_out_users.insert(bn_grad);
+    bn_grad_users.insert(bn_grad);
+  }
+  if (!UsersIn(conv.out(), conv_out_users) ||
+      !UsersIn(bn.saved_mean(), bn_grad_users) ||
+      !UsersIn(bn.saved_variance(), bn_grad_users) ||
+      !UsersIn(bn.reserve_space(), bn_grad_users)) {
+    return false;
+  }
+  unit->conv = conv;
+  unit->bn = bn;
+  unit->bn_grad = bn_grad;
+  return true;
+}
+
+// The backward of the conv after a relu: relu_grad, whose out_grad is the
+// input_grad of the conv2d_grad, or its sum with the grad of another user of
+// the relu output by add_n.
+struct ReluConvGrad {
+  paddle::dialect::ReluGradOp relu_grad;
+  paddle::dialect::Conv2dGradOp conv_grad;
+  paddle::dialect::AddNOp add_n;
+  pir::CombineOp combine;
+  pir::Value grad_add;
+};
+
+// Returns false if the relu output has a relu_grad but not the backward of a
+// fusible conv, and leaves grads->relu_grad null if it has no relu_grad.
+bool MatchReluConvGrad(pir::Value relu_out,
+                       bool with_sum,
+                       ReluConvGrad *grads) {
+  grads->relu_grad = UniqueUser<paddle::dialect::ReluGradOp>(relu_out, 0);
+  if (!grads->relu_grad) {
+    return true;
+  }
+  pir::Value out_grad = grads->relu_grad.out_grad();
+  if (!out_grad.HasOneUse()) {
+    return false;
+  }
+  std::vector<pir::Value> input_grads = {out_grad};
+  grads->add_n = out_grad.defining_op<paddle::dialect::AddNOp>();
+  if (grads->add_n) {
+    grads->combine = grads->add_n.inputs().defining_op<pir::CombineOp>();
+    if (!with_sum || !grads->combine ||
+        !grads->combine.out().HasOneUse() ||
+        grads->combine.inputs().size() != 2) {
+      return false;
+    }
+    input_grads = grads->combine.inputs();
+  }
+  for (size_t i = 0; i < input_grads.size(); ++i) {
+    auto conv_grad =
+        input_grads[i].defining_op<paddle::dialect::Conv2dGradOp>();
+    if (conv_grad && conv_grad.input() == relu_out &&
+        conv_grad.input_grad() == input_grads[i] &&
+        input_grads[i].HasOneUse() && IsFusibleConv(conv_grad)) {
+      grads->conv_grad = conv_grad;
+      if (grads->add_n) {
+        grads->grad_add = input_grads[1 - i];
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+// The conv2d + batch_norm_ as a fused_scale_bias_relu_conv_bn without
+// prologue.
+paddle::dialect::FusedScaleBiasReluConvBnOp BuildConvBnStats(
+    pir::PatternRewriter &rewriter,  // NOLINT
+    ConvBn unit) {
+  auto conv_attributes = unit.conv->attributes();
+  pir::AttributeMap attributes = {
+      {"paddings", conv_attributes.at("paddings")},
+      {"dilations", conv_attributes.at("dilations")},
+      {"strides", conv_attributes.at("strides")},
+      {"padding_algorithm", conv_attributes.at("padding_algorithm")},
+      {"groups", conv_attributes.at("groups")},
+      {"data_format", conv_attributes.at("data_format")},
+      {"momentum", unit.bn->attribute("momentum")},
+      {"epsilon", unit.bn->attribute("epsilon")},
+      {"fuse_prologue", rewriter.bool_attr(false)},
+      {"exhaustive_search", rewriter.bool_attr(false)},
+      {"accumulation_count", rewriter.int64_attr(0)}};
+  return rewriter.Build<paddle::dialect::FusedScaleBiasReluConvBnOp>(
+      unit.conv.input(),
+      unit.conv.filter(),
+      pir::Value(),
+      pir::Value(),
+      unit.bn.scale(),
+      unit.bn.bias(),
+      unit.bn.mean(),
+      unit.bn.variance(),
+      attributes);
+}
+
+pir::AttributeMap DconvDreluDbnAttributes(
+    pir::PatternRewriter &rewriter,  // NOLINT
+    paddle::dialect::Conv2dGradOp conv_grad,
+    bool fuse_shortcut,
+    bool fuse_dual,
+    bool fuse_add) {
+  auto conv_attributes = conv_grad->attributes();
+  return {{"paddings", conv_attributes.at("paddings")},
+          {"dilations", conv_attributes.at("dilations")},
+          {"strides", conv_attributes.at("strides")},
+          {"padding_algorithm", conv_attributes.at("padding_algorithm")},
+          {"groups", conv_attributes.at("groups")},
+          {"data_format", conv_attributes.at("data_format")},
+          {"fuse_shortcut", rewriter.bool_attr(fuse_shortcut)},
+          {"fuse_dual", rewriter.bool_attr(fuse_dual)},
+          {"fuse_add", rewriter.bool_attr(fuse_add)},
+          {"exhaustive_search", rewriter.bool_attr(false)}};
+}
+
+// Replaces the outputs of the conv2d and batch_norm_ but the normalized one.
+void ReplaceConvBn(pir::PatternRewriter &rewriter,  // NOLINT
+                   ConvBn unit,
+                   paddle::dialect::FusedScaleBiasReluConvBnOp fused) {
+  rewriter.ReplaceAllUsesWith(unit.conv.out(), fused.out());
+  rewriter.ReplaceAllUsesWith(unit.bn.mean_out(), fused.out_running_mean());
+  rewriter.ReplaceAllUsesWith(unit.bn.variance_out(), fused.out_running_var());
+  rewriter.ReplaceAllUsesWith(unit.bn.saved_mean(), fused.saved_mean());
+  rewriter.ReplaceAllUsesWith(unit.bn.saved_variance(), fused.saved_var());
+}
+
+void ReplaceBnGrad(pir::PatternRewriter &rewriter,  // NOLINT
+                   ConvBn unit,
+                   pir::Value x_grad,
+                   pir::Value scale_grad,
+                   pir::Value bias_grad) {
+  rewriter.ReplaceAllUsesWith(unit.bn_grad.x_grad(), x_grad);
+  rewriter.ReplaceAllUsesWith(unit.bn_grad.scale_grad(), scale_grad);
+  rewriter.ReplaceAllUsesWith(unit.bn_grad.bias_grad(), bias_grad);
+}
+
+void EraseReluConvGrad(pir::PatternRewriter &rewriter,  // NOLINT
+                       ReluConvGrad grads) {
+  rewriter.EraseOp(grads.relu_grad);
+  if (grads.add_n) {
+    rewriter.EraseOp(grads.add_n);
+    rewriter.EraseOp(grads.combine);
+  }
+  rewriter.EraseOp(grads.conv_grad);
+}
+
+// conv2d + batch_norm_ + add + relu, the last unit of a residual block, where
+// the other input of add is the shortcut, or another conv2d + batch_norm_.
+// The forward are fused into fused_scale_bias_relu_conv_bn(s) without
+// prologue and a fused_scale_bias_add_relu. The backward, with the
+// conv2d_grad of a user of the relu output, are fused into a
+// fused_dconv_drelu_dbn with fuse_shortcut or fuse_dual, and fuse_add if the
+// grad of the relu output is summed with the one of another user.
+class ConvBnAddReluPattern
+    : public pir::OpRewritePattern<paddle::dialect::ReluOp> {
+ public:
+  using pir::OpRewritePattern<paddle::dialect::ReluOp>::OpRewritePattern;
+
+  bool MatchAndRewrite(
+      paddle::dialect::ReluOp relu,
+      pir::PatternRewriter &rewriter) const override {  // NOLINT
+    auto add = relu.x().defining_op<paddle::dialect::AddOp>();
+    if (!add || !UsersIn(add.out(), {relu})) {
+      return false;
+    }
+    ConvBn unit1;
+    uint32_t bn_index = 0;
+    if (!MatchConvBn(add.x(), &unit1)) {
+      if (!MatchConvBn(add.y(), &unit1)) {
+        return false;
+      }
+      bn_index = 1;
+    }
+    pir::Value z = add->operand_source(1 - bn_index);
+    if (!IsFloat16(z) ||
+        pir::GetShapeFromValue(z) != pir::GetShapeFromValue(add.out())) {
+      return false;
+    }
+    ConvBn unit2;
+    bool fuse_dual = MatchConvBn(z, &unit2);
+
+    ReluConvGrad grads;
+    if (!MatchReluConvGrad(relu.out(), true, &grads)) {
+      return false;
+    }
+    // x is the operand 0 of add_grad
+    auto add_grad = UniqueUser<paddle::dialect::AddGradOp>(add.x(), 0);
+    std::unordered_set<pir::Operation *> bn_out_users = {add};
+    if (grads.relu_grad) {
+      pir::Value add_out_grad = grads.relu_grad.x_grad();
+      if (!add_grad || add_grad.y() != add.y() ||
+          add_grad.out_grad() != add_out_grad || !add_out_grad.HasOneUse()) {
+        return false;
+      }
+      pir::Value bn1_out_grad = add_grad->result(bn_index);
+      if (!unit1.bn_grad || unit1.bn_grad.out_grad() != bn1_out_grad ||
+          !bn1_out_grad.HasOneUse()) {
+        return false;
+      }
+      if (fuse_dual) {
+        pir::Value bn2_out_grad = add_grad->result(1 - bn_index);
+        if (!unit2.bn_grad || unit2.bn_grad.out_grad() != bn2_out_grad ||
+            !bn2_out_grad.HasOneUse()) {
+          return false;
+        }
+      }
+      bn_out_users.insert(add_grad);
+    } else if (add_grad || unit1.bn_grad || (fuse_dual && unit2.bn_grad)) {
+      return false;
+    }
+    if (!UsersIn(unit1.bn.out(), bn_out_users) ||
+        (fuse_dual && !UsersIn(unit2.bn.out(), bn_out_users))) {
+      return false;
+    }
+
+    auto fused1 = BuildConvBnStats(rewriter, unit1);
+    pir::Value x2 = z;
+    pir::Value scale2, bias2;
+    pir::Value bn2_mean, bn2_inv_std, bn2_gamma, bn2_beta, bn2_input;
+    if (fuse_dual) {
+      auto fused2 = BuildConvBnStats(rewriter, unit2);
+      x2 = fused2.out();
+      scale2 = fused2.eq_scale();
+      bias2 = fused2.eq_bias();
+      bn2_mean = fused2.saved_mean();
+      bn2_inv_std = fused2.saved_var();
+      bn2_gamma = unit2.bn.scale();
+      bn2_beta = unit2.bn.bias();
+      bn2_input = fused2.out();
+      ReplaceConvBn(rewriter, unit2, fused2);
+    }
+    auto sbar = rewriter.Build<paddle::dialect::FusedScaleBiasAddReluOp>(
+        fused1.out(),
+        fused1.eq_scale(),
+        fused1.eq_bias(),
+        x2,
+        scale2,
+        bias2,
+        pir::AttributeMap{{"fuse_dual", rewriter.bool_attr(fuse_dual)},
+                          {"exhaustive_search", rewriter.bool_attr(false)}});
+    rewriter.ReplaceAllUsesWith(relu.out(), sbar.out());
+
+    if (grads.relu_grad) {
+      // after the grad summed for the relu output
+      rewriter.set_insertion_point(grads.relu_grad);
+      auto dconv = rewriter.Build<paddle::dialect::FusedDconvDreluDbnOp>(
+          grads.conv_grad.out_grad(),
+          grads.conv_grad.filter(),
+          grads.grad_add,
+          fuse_dual ? pir::Value() : z,
+          pir::Value(),
+          pir::Value(),
+          sbar.out(),
+          fused1.saved_mean(),
+          fused1.saved_var(),
+          unit1.bn.scale(),
+          unit1.bn.bias(),
+          fused1.out(),
+          bn2_mean,
+          bn2_inv_std,
+          bn2_gamma,
+          bn2_beta,
+          bn2_input,
+          DconvDreluDbnAttributes(rewriter,
+                                  grads.conv_grad,
+                                  !fuse_dual,
+                                  fuse_dual,
+                                  static_cast<bool>(grads.grad_add)));
+      rewriter.ReplaceAllUsesWith(grads.conv_grad.filter_grad(),
+                                  dconv.grad_weight());
+      ReplaceBnGrad(rewriter,
+                    unit1,
+                    dconv.grad_bn1_input(),
+                    dconv.grad_bn1_gamma(),
+                    dconv.grad_bn1_beta());
+      rewriter.EraseOp(unit1.bn_grad);
+      if (fuse_dual) {
+        ReplaceBnGrad(rewriter,
+                      unit2,
+                      dconv.grad_bn2_input(),
+                      dconv.grad_bn2_gamma(),
+                      dconv.grad_bn2_beta());
+        rewriter.EraseOp(unit2.bn_grad);
+      } else {
+        rewriter.ReplaceAllUsesWith(add_grad->result(1 - bn_index),
+                                    dconv.grad_bn2_input());
+      }
+      rewriter.EraseOp(add_grad);
+      EraseReluConvGrad(rewriter, grads);
+    }
+
+    ReplaceConvBn(rewriter, unit1, fused1);
+    rewriter.EraseOp(relu);
+    rewriter.EraseOp(add);
+    rewriter.EraseOp(unit1.bn);
+    rewriter.EraseOp(unit1.conv);
+    if (fuse_dual) {
+      rewriter.EraseOp(unit2.bn);
+      rewriter.EraseOp(unit2.conv);
+    }
+    return true;
+  }
+};
+
+// conv2d + batch_norm_ + relu, whose output is only the input of a
+// fused_scale_bias_relu_conv_bn without prologue. The forward are fused into
+// a fused_scale_bias_relu_conv_bn, whose normalization and relu become the
+// prologue of the one after it. The backward, with the conv2d_grad of the one
+// after it, are fused into a fused_dconv_drelu_dbn. Applied repeatedly it
+// fuses the chains ending in the units of ConvBnAddReluPattern.
+class ConvBnReluConvBnStatsPattern
+    : public pir::OpRewritePattern<paddle::dialect::ReluOp> {
+ public:
+  using pir::OpRewritePattern<paddle::dialect::ReluOp>::OpRewritePattern;
+
+  bool MatchAndRewrite(
+      paddle::dialect::ReluOp relu,
+      pir::PatternRewriter &rewriter) const override {  // NOLINT
+    ConvBn unit;
+    if (!MatchConvBn(relu.x(), &unit) || !UsersIn(unit.bn.out(), {relu})) {
+      return false;
+    }
+    pir::Value relu_out = relu.out();
+    auto next =
+        UniqueUser<paddle::dialect::FusedScaleBiasReluConvBnOp>(relu_out, 0);
+    if (!next || next->attribute<pir::BoolAttribute>("fuse_prologue").data()) {
+      return false;
+    }
+    ReluConvGrad grads;
+    if (!MatchReluConvGrad(relu_out, false, &grads)) {
+      return false;
+    }
+    std::unordered_set<pir::Operation *> relu_out_users = {next};
+    if (grads.relu_grad) {
+      pir::Value bn_out_grad = grads.relu_grad.x_grad();
+      if (!unit.bn_grad || grads.conv_grad.filter() != next.w() ||
+          unit.bn_grad.out_grad() != bn_out_grad ||
+          !bn_out_grad.HasOneUse()) {
+        return false;
+      }
+      relu_out_users.insert(grads.relu_grad);
+      relu_out_users.insert(grads.conv_grad);
+    } else if (unit.bn_grad) {
+      return false;
+    }
+    if (!UsersIn(relu_out, relu_out_users)) {
+      return false;
+    }
+
+    auto fused = BuildConvBnStats(rewriter, unit);
+    rewriter.set_insertion_point(next);
+    auto next_attributes = next->attributes();
+    next_attributes["fuse_prologue"] = rewriter.bool_attr(true);
+    rewriter.ReplaceOpWithNewOp<paddle::dialect::FusedScaleBiasReluConvBnOp>(
+        next,
+        fused.out(),
+        next.w(),
+        fused.eq_scale(),
+        fused.eq_bias(),
+        next.bn_scale(),
+        next.bn_bias(),
+        next.input_running_mean(),
+        next.input_running_var(),
+        next_attributes);
+
+    if (grads.relu_grad) {
+      rewriter.set_insertion_point(grads.relu_grad);
+      auto dconv = rewriter.Build<paddle::dialect::FusedDconvDreluDbnOp>(
+          grads.conv_grad.out_grad(),
+          grads.conv_grad.filter(),
+          pir::Value(),
+          pir::Value(),
+          fused.eq_scale(),
+          fused.eq_bias(),
+          pir::Value(),
+          fused.saved_mean(),
+          fused.saved_var(),
+          unit.bn.scale(),
+          unit.bn.bias(),
+          fused.out(),
+          pir::Value(),
+          pir::Value(),
+          pir::Value(),
+          pir::Value(),
+          pir::Value(),
+          DconvDreluDbnAttributes(
+              rewriter, grads.conv_grad, false, false, false));
+      rewriter.ReplaceAllUsesWith(grads.conv_grad.filter_grad(),
+                                  dconv.grad_weight());
+      ReplaceBnGrad(rewriter,
+                    unit,
+                    dconv.grad_bn1_input(),
+                    dconv.grad_bn1_gamma(),
+                    dconv.grad_bn1_beta());
+      rewriter.EraseOp(unit.bn_grad);
+      EraseReluConvGrad(rewriter, grads);
+    }
+
+    ReplaceConvBn(rewriter, unit, fused);
+    rewriter.EraseOp(relu);
+    rewriter.EraseOp(unit.bn);
+    rewriter.EraseOp(unit.conv);
+    return true;
+  }
+};
+
+class FusedConvBnActPass : public pir::PatternRewritePass {
+ public:
+  FusedConvBnActPass() : pir::PatternRewritePass("fused_conv_bn_act_pass", 2) {}
+
+  pir::RewritePatternSet InitializePatterns(pir::IrContext *context) override {
+    pir::RewritePatternSet ps(context);
+    const std::vector<std::string> generated_names = {
+        paddle::dialect::FusedScaleBiasReluConvBnOp::name(),
+        paddle::dialect::FusedScaleBiasAddReluOp::name(),
+        paddle::dialect::FusedDconvDreluDbnOp::name()};
+    // the last units first, from which the chains are fused back
+    ps.Add(std::make_unique<ConvBnAddReluPattern>(context, 2, generated_names));
+    ps.Add(std::make_unique<ConvBnReluConvBnStatsPattern>(
+        context, 1, generated_names));
+    return ps;
+  }
+
+  bool CanApplyOn(pir::Operation *op) const override {
+#ifdef PADDLE_WITH_CUDA
+    // the fused kernels need cuDNN 8.9 and Ampere or later
+    int sm_version = paddle::platform::GetGPUComputeCapability(
+        paddle::platform::GetCurrentDeviceId());
+    if (sm_version < 80 || paddle::platform::DnnVersion() < 8900) {
+      return false;
+    }
+    return op->num_regions() > 0;
+#else
+    return false;
+#endif
+  }
+};
+
+}  // namespace
+
+namespace pir {
+
+std::unique_ptr<Pass> CreateFusedConvBnActPass() {
+  return std::make_unique<FusedConvBnActPass>();
+}
+
+}  // namespace pir
+
+REGISTER_IR_PASS(fused_conv_bn_act_pass, FusedConvBnActPass);
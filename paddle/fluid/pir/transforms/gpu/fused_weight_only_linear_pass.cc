@@ -42,14 +42,17 @@ class FusedWeightOnlyLinearWithBiasPattern
   bool reverse_add_;
   std::string algo_;
   int sm_version_;
+  int group_size_;
 
  public:
   FusedWeightOnlyLinearWithBiasPattern(bool reverse_add,
                                        std::string algo,
-                                       int sm_version)
+                                       int sm_version,
+                                       int group_size)
       : reverse_add_(reverse_add),
         algo_(std::move(algo)),
-        sm_version_(sm_version) {}
+        sm_version_(sm_version),
+        group_size_(group_size) {}
 
   std::string name() const override {
     return "FusedWeightOnlyLinearWithBiasPattern";
@@ -119,7 +122,7 @@ class FusedWeightOnlyLinearWithBiasPattern
           res.Op(paddle::dialect::WeightQuantizeOp::name(),
                  {{"algo", res.StrAttr(algo_)},
                   {"arch", res.Int32Attr(sm_version_)},
-                  {"group_size", res.Int32Attr(-1)}});
+                  {"group_size", res.Int32Attr(group_size_)}});
       weight_quantize({&res.Tensor("w_cpu")},
                       {&res.Tensor("quanted_weight_tensor_cpu"),
                        &res.Tensor("weight_scale_tensor_cpu")});
@@ -139,7 +142,7 @@ class FusedWeightOnlyLinearWithBiasPattern
           res.Op(paddle::dialect::WeightQuantizeOp::name(),
                  {{"algo", res.StrAttr(algo_)},
                   {"arch", res.Int32Attr(sm_version_)},
-                  {"group_size", res.Int32Attr(-1)}});
+                  {"group_size", res.Int32Attr(group_size_)}});
 
       weight_quantize({&res.Tensor("w")},
                       {&res.Tensor("quanted_weight_tensor"),
@@ -151,7 +154,7 @@ class FusedWeightOnlyLinearWithBiasPattern
                {{"weight_dtype",
                  res.StrAttr(algo_ == "weight_only_int8" ? "int8" : "int4")},
                 {"arch", res.Int32Attr(sm_version_)},
-                {"group_size", res.Int32Attr(-1)}});
+                {"group_size", res.Int32Attr(group_size_)}});
     weight_only_linear({&res.Tensor("x"),
                         &res.Tensor("quanted_weight_tensor"),
                         &res.Tensor("bias"),
@@ -164,10 +167,15 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
  private:
   std::string algo_;
   int sm_version_;
+  int group_size_;
 
  public:
-  FusedWeightOnlyLinearNoBiasPattern(std::string algo, int sm_version)
-      : algo_(std::move(algo)), sm_version_(sm_version) {}
+  FusedWeightOnlyLinearNoBiasPattern(std::string algo,
+                                     int sm_version,
+                                     int group_size)
+      : algo_(std::move(algo)),
+        sm_version_(sm_version),
+        group_size_(group_size) {}
 
  public:
   std::string name() const override {
@@ -230,7 +238,7 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
           res.Op(paddle::dialect::WeightQuantizeOp::name(),
                  {{"algo", res.StrAttr(algo_)},
                   {"arch", res.Int32Attr(sm_version_)},
-                  {"group_size", res.Int32Attr(-1)}});
+                  {"group_size", res.Int32Attr(group_size_)}});
       weight_quantize({&res.Tensor("w_cpu")},
                       {&res.Tensor("quanted_weight_tensor_cpu"),
                        &res.Tensor("weight_scale_tensor_cpu")});
@@ -250,7 +258,7 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
           res.Op(paddle::dialect::WeightQuantizeOp::name(),
                  {{"algo", res.StrAttr(algo_)},
                   {"arch", res.Int32Attr(sm_version_)},
-                  {"group_size", res.Int32Attr(-1)}});
+                  {"group_size", res.Int32Attr(group_size_)}});
 
       weight_quantize({&res.Tensor("w")},
                       {&res.Tensor("quanted_weight_tensor"),
@@ -261,7 +269,7 @@ class FusedWeightOnlyLinearNoBiasPattern : public paddle::drr::DrrPatternBase {
                {{"weight_dtype",
                  res.StrAttr(algo_ == "weight_only_int8" ? "int8" : "int4")},
                 {"arch", res.Int32Attr(sm_version_)},
-                {"group_size", res.Int32Attr(-1)}});
+                {"group_size", res.Int32Attr(group_size_)}});
     weight_only_linear({&res.Tensor("x"),
                         &res.Tensor("quanted_weight_tensor"),
                         &res.InputNoneTensor(),
@@ -287,14 +295,24 @@ class FusedWeightOnlyLinearPass : public pir::PatternRewritePass {
                           "fused_weight_only_linear_pass only support "
                           "weight_only_int8 or weight_only_int4, but get %s.",
                           algo));
+    int group_size = -1;
+    if (Has("weight_only_group_size")) {
+      group_size = Get<int>("weight_only_group_size");
+    }
+    PADDLE_ENFORCE_EQ(group_size == -1 || group_size == 64 || group_size == 128,
+                      true,
+                      common::errors::InvalidArgument(
+                          "fused_weight_only_linear_pass only support "
+                          "group_size -1, 64 or 128, but get %d.",
+                          group_size));
 
     pir::RewritePatternSet ps(context);
     ps.Add(paddle::drr::Create<FusedWeightOnlyLinearWithBiasPattern>(
-        context, true, algo, sm_version_));
+        context, true, algo, sm_version_, group_size));
     ps.Add(paddle::drr::Create<FusedWeightOnlyLinearWithBiasPattern>(
-        context, false, algo, sm_version_));
+        context, false, algo, sm_version_, group_size));
     ps.Add(paddle::drr::Create<FusedWeightOnlyLinearNoBiasPattern>(
-        context, algo, sm_version_));
+        context, algo, sm_version_, group_size));
     return ps;
   }
 
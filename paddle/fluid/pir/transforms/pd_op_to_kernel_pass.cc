@@ -261,12 +261,12 @@ static bool NeedFallBackFromGPUDNN2GPU(pir::Operation* op,
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   if (kernel_key.backend() == phi::Backend::GPUDNN) {
-    auto iter = phi::KernelFactory::Instance().kernels().find(kernel_name);
-    if (iter != phi::KernelFactory::Instance().kernels().end()) {
-      auto kernel_iter = iter->second.find({phi::Backend::GPUDNN,
-                                            phi::DataLayout::ALL_LAYOUT,
-                                            kernel_key.dtype()});
-      if (kernel_iter == iter->second.end()) {
+    auto* kernels = phi::KernelFactory::Instance().FindKernels(kernel_name);
+    if (kernels != nullptr) {
+      auto kernel_iter = kernels->find({phi::Backend::GPUDNN,
+                                        phi::DataLayout::ALL_LAYOUT,
+                                        kernel_key.dtype()});
+      if (kernel_iter == kernels->end()) {
         return true;
       }
     }
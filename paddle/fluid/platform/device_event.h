@@ -37,6 +37,12 @@ USE_EVENT_WAIT(kCUDA, kCUDA)
 USE_EVENT_WAIT(kCPU, kCUDA)
 #endif
 
+#ifdef PADDLE_WITH_XPU
+USE_EVENT(kXPU);
+USE_EVENT_WAIT(kXPU, kXPU)
+USE_EVENT_WAIT(kCPU, kXPU)
+#endif
+
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
 USE_EVENT(kCUSTOM_DEVICE);
 USE_EVENT_WAIT(kCUSTOM_DEVICE, kCUSTOM_DEVICE)
@@ -145,3 +145,42 @@ TEST(DeviceEvent, CPU) {
   event.Reset();
   ASSERT_EQ(status, false);  // INITIALIZED
 }
+
+#ifdef PADDLE_WITH_XPU
+#include <vector>
+
+#include "paddle/phi/backends/xpu/xpu_context.h"
+#include "paddle/phi/common/memory_utils.h"
+
+TEST(DeviceEvent, XPU) {
+  using ::paddle::platform::kXPU;
+  using phi::XPUPlace;
+
+  auto& pool = DeviceContextPool::Instance();
+  auto place = XPUPlace(0);
+  auto* context = static_cast<phi::XPUContext*>(pool.Get(place));
+  ASSERT_NE(context, nullptr);
+
+  DeviceEvent event(place, paddle::platform::GenerateDeviceEventFlag());
+  ASSERT_NE(event.GetEvent().get(), nullptr);
+  // an event not recorded yet is done
+  ASSERT_EQ(event.Query(), true);
+
+  // a round trip through the copy streams, ordered by the compute stream
+  size_t numel = 1000000;
+  size_t size = numel * sizeof(float);
+  std::vector<float> src(numel, 1.5f), dst(numel, 0.f);
+  auto buf = phi::memory_utils::Alloc(place, size);
+  context->MemcpyH2DAsync(buf->ptr(), src.data(), size);
+  event.Record(context);
+  event.Wait(kXPU, context);
+  context->MemcpyD2HAsync(dst.data(), buf->ptr(), size);
+  context->WaitD2H();
+  event.Wait(kCPU, context);
+  ASSERT_EQ(event.Query(), true);
+  for (size_t i = 0; i < numel; i += 1000) {
+    ASSERT_EQ(dst[i], 1.5f);
+  }
+  context->Wait();
+}
+#endif
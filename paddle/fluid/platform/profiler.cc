@@ -470,6 +470,33 @@ RecordMemEvent::RecordMemEvent(const void *ptr,
   }
 }
 
+static std::mutex mem_tensor_names_mutex;
+static std::vector<MemTensorNameRecord> mem_tensor_names;
+
+void RecordMemTensorName(const void *ptr, const std::string &name) {
+  if (phi::ProfilerHelper::g_state == ProfilerState::kDisabled &&
+      FLAGS_enable_host_event_recorder_hook == false) {
+    return;
+  }
+  if (RecordMemEvent::IsEnabled() == false) {
+    return;
+  }
+  uint64_t timestamp_ns = phi::PosixInNsec();
+  std::lock_guard<std::mutex> guard(mem_tensor_names_mutex);
+  mem_tensor_names.push_back(
+      {timestamp_ns, reinterpret_cast<uint64_t>(ptr), name});
+}
+
+std::vector<MemTensorNameRecord> GetMemTensorNames() {
+  std::lock_guard<std::mutex> guard(mem_tensor_names_mutex);
+  return mem_tensor_names;
+}
+
+void ClearMemTensorNames() {
+  std::lock_guard<std::mutex> guard(mem_tensor_names_mutex);
+  mem_tensor_names.clear();
+}
+
 void MemEventRecorder::PushMemRecord(const void *ptr,
                                      const Place &place,
                                      size_t size) {
@@ -0,0 +1,155 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/profiler/continuous_tracing.h"
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <thread>
+
+#ifndef _WIN32
+#include <semaphore.h>
+#include <signal.h>
+#endif
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/profiler/chrometracing_logger.h"
+#include "paddle/fluid/platform/profiler/event_node.h"
+#include "paddle/fluid/platform/profiler/trace_event.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace paddle {
+namespace platform {
+
+size_t DumpContinuousTracing(const std::string& path, double last_seconds) {
+  PADDLE_ENFORCE_GT(
+      last_seconds,
+      0,
+      phi::errors::InvalidArgument(
+          "The seconds to dump should be positive, but received %f.",
+          last_seconds));
+  uint64_t now_ns = phi::PosixInNsec();
+  uint64_t last_ns = static_cast<uint64_t>(last_seconds * 1e9);
+  uint64_t since_ns = now_ns > last_ns ? now_ns - last_ns : 0;
+
+  const ContinuousTracer& tracer = ContinuousTracer::Instance();
+  uint64_t process_id = phi::GetProcessId();
+  std::list<HostTraceEvent> host_events;
+  for (auto& thread_records : tracer.Snapshot(since_ns)) {
+    for (auto& record : thread_records.records) {
+      host_events.emplace_back(tracer.Name(record.name_id),
+                               record.type,
+                               record.start_ns,
+                               record.end_ns,
+                               process_id,
+                               thread_records.thread_id);
+    }
+  }
+
+  ChromeTracingLogger logger(path);
+  logger.LogMetaInfo(std::string("1.0.2"), 0);
+  NodeTrees tree(host_events, {}, {}, {}, {});
+  tree.LogMe(&logger);
+  VLOG(1) << "Dump " << host_events.size()
+          << " continuous tracing events to " << path;
+  return host_events.size();
+}
+
+#ifndef _WIN32
+namespace {
+
+struct DumpSignalState {
+  std::once_flag once;
+  sem_t dump_requests;
+  std::mutex mutex;
+  std::string path_prefix;
+  double last_seconds{0};
+};
+
+DumpSignalState& GetDumpSignalState() {
+  static DumpSignalState* state = new DumpSignalState();
+  return *state;
+}
+
+void HandleDumpSignal(int signum) {
+  // sem_post is async-signal-safe
+  sem_post(&GetDumpSignalState().dump_requests);
+}
+
+void DumpOnRequests() {
+  DumpSignalState& state = GetDumpSignalState();
+  for (size_t dump_id = 0;; ++dump_id) {
+    while (sem_wait(&state.dump_requests) != 0) {
+    }
+    std::string path_prefix;
+    double last_seconds = 0;
+    {
+      std::lock_guard<std::mutex> guard(state.mutex);
+      path_prefix = state.path_prefix;
+      last_seconds = state.last_seconds;
+    }
+    std::string path = path_prefix + "." +
+                       std::to_string(phi::GetProcessId()) + "." +
+                       std::to_string(dump_id) + ".json";
+    size_t num_events = DumpContinuousTracing(path, last_seconds);
+    LOG(INFO) << "Dump " << num_events << " continuous tracing events of the "
+              << "last " << last_seconds << " seconds to " << path;
+  }
+}
+
+}  // namespace
+#endif
+
+void InstallContinuousTracingDumpSignal(int signum,
+                                        const std::string& path_prefix,
+                                        double last_seconds) {
+#ifdef _WIN32
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "Dumping the continuous tracing by signals is not supported on "
+      "Windows, please call DumpContinuousTracing instead."));
+#else
+  PADDLE_ENFORCE_GT(
+      last_seconds,
+      0,
+      phi::errors::InvalidArgument(
+          "The seconds to dump should be positive, but received %f.",
+          last_seconds));
+  DumpSignalState& state = GetDumpSignalState();
+  {
+    std::lock_guard<std::mutex> guard(state.mutex);
+    state.path_prefix = path_prefix;
+    state.last_seconds = last_seconds;
+  }
+  std::call_once(state.once, [&state] {
+    sem_init(&state.dump_requests, 0, 0);
+    std::thread(DumpOnRequests).detach();
+  });
+
+  struct sigaction action = {};
+  action.sa_handler = HandleDumpSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  PADDLE_ENFORCE_EQ(
+      sigaction(signum, &action, nullptr),
+      0,
+      phi::errors::InvalidArgument(
+          "Failed to install the handler of signal %d to dump the continuous "
+          "tracing.",
+          signum));
+#endif
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,40 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+#include "paddle/phi/api/profiler/continuous_tracer.h"
+
+namespace paddle {
+namespace platform {
+
+using ContinuousTracer = phi::ContinuousTracer;
+
+// Writes the host events of the last last_seconds traced by the
+// ContinuousTracer into a chrome tracing file, returns the number of the
+// events written.
+size_t DumpContinuousTracing(const std::string& path, double last_seconds);
+
+// Dumps the host events of the last last_seconds into
+// "<path_prefix>.<pid>.<n>.json" each time the process receives signum, e.g.
+// SIGUSR2. The dump is written by a background thread, since the signal
+// handler can only do async-signal-safe calls.
+void InstallContinuousTracingDumpSignal(int signum,
+                                        const std::string& path_prefix,
+                                        double last_seconds);
+
+}  // namespace platform
+}  // namespace paddle
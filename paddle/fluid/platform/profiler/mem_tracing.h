@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/platform/profiler/trace_event.h"
 #include "paddle/phi/common/place.h"
@@ -52,5 +53,21 @@ class RecordMemEvent {
   static std::map<const char*, std::map<uint64_t, bool>> has_initialized;
 };
 
+struct MemTensorNameRecord {
+  uint64_t timestamp_ns;
+  uint64_t addr;
+  std::string name;
+};
+
+// Names the allocation at ptr by the tensor holding it, so that the memory
+// timeline of the profiler can attribute the live bytes to the tensors. An
+// allocation is named by the first record at its addr after it is allocated.
+// It does nothing if the memory is not being profiled.
+void RecordMemTensorName(const void* ptr, const std::string& name);
+
+std::vector<MemTensorNameRecord> GetMemTensorNames();
+
+void ClearMemTensorNames();
+
 }  // namespace platform
 }  // namespace paddle
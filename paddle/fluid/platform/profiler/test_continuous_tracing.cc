@@ -0,0 +1,101 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/profiler/continuous_tracing.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+
+using paddle::platform::ContinuousTracer;
+using paddle::platform::RecordEvent;
+using paddle::platform::TracerEventType;
+
+namespace {
+
+size_t CountEvents(const std::string& name) {
+  const ContinuousTracer& tracer = ContinuousTracer::Instance();
+  size_t count = 0;
+  for (auto& thread_records : tracer.Snapshot(0)) {
+    for (auto& record : thread_records.records) {
+      if (tracer.Name(record.name_id) == name) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(ContinuousTracingTest, SampleAndDump) {
+  ContinuousTracer& tracer = ContinuousTracer::Instance();
+  tracer.Clear();
+  tracer.Enable(2);
+  tracer.SetSampleInterval(TracerEventType::OperatorInner, 4);
+
+  auto run = [] {
+    for (int i = 0; i < 8; ++i) {
+      RecordEvent op("continuous_op", TracerEventType::Operator, 1);
+      RecordEvent inner(std::string("continuous_inner"),
+                        TracerEventType::OperatorInner,
+                        2);
+      // the events above the level are not traced
+      RecordEvent verbose(
+          "continuous_verbose", TracerEventType::UserDefined, 3);
+    }
+  };
+  std::thread other(run);
+  run();
+  other.join();
+  tracer.Disable();
+  {
+    RecordEvent disabled("continuous_op", TracerEventType::Operator, 1);
+  }
+
+  EXPECT_EQ(CountEvents("continuous_op"), 16u);
+  EXPECT_EQ(CountEvents("continuous_inner"), 4u);
+  EXPECT_EQ(CountEvents("continuous_verbose"), 0u);
+
+  std::string path = "test_continuous_tracing.json";
+  EXPECT_EQ(paddle::platform::DumpContinuousTracing(path, 60), 20u);
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_NE(content.str().find("continuous_inner"), std::string::npos);
+
+  tracer.Clear();
+  EXPECT_EQ(CountEvents("continuous_op"), 0u);
+  tracer.SetSampleInterval(TracerEventType::OperatorInner, 1);
+}
+
+TEST(ContinuousTracingTest, RingBuffer) {
+  ContinuousTracer& tracer = ContinuousTracer::Instance();
+  tracer.Clear();
+  tracer.Enable(1);
+  // the buffer of a new thread keeps the last
+  // FLAGS_continuous_tracing_buffer_size events
+  std::thread writer([] {
+    for (int i = 0; i < FLAGS_continuous_tracing_buffer_size + 10; ++i) {
+      RecordEvent op("continuous_ring", TracerEventType::Operator, 1);
+    }
+  });
+  writer.join();
+  tracer.Disable();
+  EXPECT_EQ(CountEvents("continuous_ring"),
+            static_cast<size_t>(FLAGS_continuous_tracing_buffer_size));
+  tracer.Clear();
+}
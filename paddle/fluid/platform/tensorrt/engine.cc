@@ -21,6 +21,7 @@ limitations under the License. */
 #include "cuda_runtime_api.h"  // NOLINT
 
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
+#include "paddle/utils/string/string_helper.h"
 
 namespace paddle {
 namespace platform {
@@ -390,6 +391,9 @@ void TensorRTEngine::FreezeNetwork() {
         nvinfer1::BuilderFlag::kPREFER_PRECISION_CONSTRAINTS);
   }
 #endif
+  if (params_.refittable) {
+    infer_builder_config_->setFlag(nvinfer1::BuilderFlag::kREFIT);
+  }
 #if IS_TRT_VERSION_LT(8000)
   infer_engine_.reset(infer_builder_->buildEngineWithConfig(
       *network(), *infer_builder_config_));
@@ -573,6 +577,12 @@ nvinfer1::ITensor *TensorRTEngine::ConvertWeight2ITensor(
   }
   nvinfer1::ILayer *layer =
       TRT_ENGINE_ADD_LAYER(this, Constant, trt_in_shape, weight.get());
+#if IS_TRT_VERSION_GE(8500)
+  // The weight is refitted by the name of the variable.
+  if (params_.refittable) {
+    network()->setWeightsName(weight.get(), name.c_str());
+  }
+#endif
   if (!scalar) {
     this->SetITensor(name, layer->getOutput(0));
   }
@@ -866,6 +876,141 @@ nvinfer1::IPluginV2Layer *TensorRTEngine::AddPluginV2IOExt(
   return network()->addPluginV2(inputs, num_inputs, *plugin);
 }
 
+bool TensorRTEngine::IsRefittable() {
+  return infer_engine_ != nullptr && infer_engine_->isRefittable();
+}
+
+const std::vector<std::string> &TensorRTEngine::RefittableWeightNames() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  InitRefitter();
+  return refittable_weight_names_;
+}
+
+void TensorRTEngine::InitRefitter() {
+  if (refittable_weight_names_inited_) {
+    return;
+  }
+  PADDLE_ENFORCE_EQ(IsRefittable(),
+                    true,
+                    common::errors::PreconditionNotMet(
+                        "The TensorRT engine is not built with the "
+                        "refittable weights."));
+  infer_refitter_.reset(createInferRefitter(infer_engine_.get(), &logger_));
+  PADDLE_ENFORCE_NOT_NULL(
+      infer_refitter_,
+      common::errors::Unavailable("Fail to create the TensorRT refitter."));
+#if IS_TRT_VERSION_GE(8500)
+  int num = infer_refitter_->getAllWeights(0, nullptr);
+  std::vector<const char *> names(num);
+  infer_refitter_->getAllWeights(num, names.data());
+  for (auto *name : names) {
+    refittable_weight_names_.emplace_back(name);
+  }
+#endif
+  refittable_weight_names_inited_ = true;
+}
+
+bool TensorRTEngine::Refit(
+    const std::unordered_map<std::string, const phi::DenseTensor *> &weights,
+    cudaStream_t stream) {
+#if IS_TRT_VERSION_GE(8500)
+  FreshDeviceId();
+  std::unique_lock<std::mutex> lock(mutex_);
+  InitRefitter();
+  // The host copies of the weights live in a weight map of their own until
+  // the refitter has copied them into the engine.
+  auto converted_weight_map = std::move(weight_map);
+  weight_map.clear();
+  bool found = false;
+  std::string failed_name;
+  for (const auto &name : refittable_weight_names_) {
+    auto iter = weights.find(name);
+    if (iter == weights.end()) {
+      continue;
+    }
+    auto weight = GetTrtWeight(name, *iter->second);
+    if (!infer_refitter_->setNamedWeights(name.c_str(), weight.get())) {
+      failed_name = name;
+      break;
+    }
+    found = true;
+  }
+  bool refitted = true;
+  std::vector<std::string> missing_names;
+  if (found && failed_name.empty()) {
+    // The weights can not be rewritten while the engine runs on the stream.
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
+    refitted = infer_refitter_->refitCudaEngine();
+    if (!refitted) {
+      int num = infer_refitter_->getMissingWeights(0, nullptr);
+      std::vector<const char *> names(num);
+      infer_refitter_->getMissingWeights(num, names.data());
+      missing_names.assign(names.begin(), names.end());
+    }
+  }
+  weight_map = std::move(converted_weight_map);
+
+  PADDLE_ENFORCE_EQ(failed_name.empty(),
+                    true,
+                    common::errors::InvalidArgument(
+                        "Fail to refit the weight %s of the TensorRT engine, "
+                        "its data type and number of elements should be the "
+                        "same as the ones the engine is built with.",
+                        failed_name));
+  PADDLE_ENFORCE_EQ(refitted,
+                    true,
+                    common::errors::InvalidArgument(
+                        "Fail to refit the TensorRT engine, the weights [%s] "
+                        "should be refitted together with the given ones.",
+                        string::join_strings(missing_names, ',')));
+  if (found) {
+    VLOG(3) << "The TensorRT engine is refitted without rebuilding.";
+  }
+  return found;
+#else
+  PADDLE_THROW(common::errors::Unimplemented(
+      "Refitting the TensorRT engine by the names of the weights needs "
+      "TensorRT 8.5 and after."));
+#endif
+}
+
+void TRTRefitManager::Register(TensorRTEngine *engine,
+                               const framework::Scope *scope,
+                               cudaStream_t stream) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  engines_[engine] = Entry{scope, stream};
+}
+
+void TRTRefitManager::Unregister(TensorRTEngine *engine) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  engines_.erase(engine);
+}
+
+int TRTRefitManager::Refit(
+    const framework::Scope *scope,
+    const std::unordered_map<std::string, const phi::DenseTensor *> &weights,
+    std::unordered_set<std::string> *refitted) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int num = 0;
+  for (auto &item : engines_) {
+    const framework::Scope *engine_scope = item.second.scope;
+    while (engine_scope != nullptr && engine_scope != scope) {
+      engine_scope = engine_scope->parent();
+    }
+    if (engine_scope == nullptr ||
+        !item.first->Refit(weights, item.second.stream)) {
+      continue;
+    }
+    ++num;
+    for (const auto &name : item.first->RefittableWeightNames()) {
+      if (weights.count(name)) {
+        refitted->insert(name);
+      }
+    }
+  }
+  return num;
+}
+
 void TensorRTEngine::FreshDeviceId() {
   int count;
   cudaGetDeviceCount(&count);
@@ -458,6 +458,22 @@ class TensorRTEngine {
     return params_.use_explicit_quantization;
   }
 
+  // Whether the weights of the built engine can be refitted.
+  bool IsRefittable();
+
+  // The names of the refittable weights, which are the names of the
+  // parameters they are converted from.
+  const std::vector<std::string>& RefittableWeightNames();
+
+  // Push the new values of the weights into the engine without rebuilding it,
+  // the weights not refittable in the engine are skipped. The execution
+  // contexts and the cuda graph are kept, since the weights are rewritten in
+  // place in the device memory of the engine. Returns false if none of the
+  // weights is in the engine.
+  bool Refit(
+      const std::unordered_map<std::string, const phi::DenseTensor*>& weights,
+      cudaStream_t stream);
+
  private:
   // Each ICudaEngine object is bound to a specific GPU when it is instantiated,
   // ensure that the thread is associated with the correct device by calling
@@ -466,6 +482,10 @@ class TensorRTEngine {
 
   void GetEngineInfo(const std::string& engine_info_path);
 
+  // Create the refitter and collect the names of the refittable weights, the
+  // mutex_ should be held.
+  void InitRefitter();
+
   int device_id() { return params_.device_id; }
 
   int GetProfileIndex() {
@@ -509,6 +529,11 @@ class TensorRTEngine {
   infer_ptr<nvinfer1::IHostMemory> ihost_memory_;
   std::unordered_map<nvinfer1::ITensor*, float> quant_dynamic_range_;
 
+  // refit related
+  infer_ptr<nvinfer1::IRefitter> infer_refitter_;
+  std::vector<std::string> refittable_weight_names_;
+  bool refittable_weight_names_inited_{false};
+
   // cudagraph related
   TrtCudaGraph cuda_graph_;
   bool cudagraph_inited_{false};
@@ -657,5 +682,34 @@ class TRTEngineManager {
   infer_ptr<nvinfer1::IBuilder> holder_;
 };
 
+// The refittable engines of the tensorrt_engine instructions, the new values
+// of the parameters are pushed into the engines running in a scope or in its
+// sub scopes.
+class TRTRefitManager {
+ public:
+  void Register(TensorRTEngine* engine,
+                const framework::Scope* scope,
+                cudaStream_t stream);
+
+  void Unregister(TensorRTEngine* engine);
+
+  // Refit the engines running in the scope, the names of the weights found in
+  // the engines are inserted into refitted. Returns the number of the
+  // refitted engines.
+  int Refit(
+      const framework::Scope* scope,
+      const std::unordered_map<std::string, const phi::DenseTensor*>& weights,
+      std::unordered_set<std::string>* refitted);
+
+ private:
+  struct Entry {
+    const framework::Scope* scope;
+    cudaStream_t stream;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<TensorRTEngine*, Entry> engines_;
+};
+
 }  // namespace platform
 }  // namespace paddle
@@ -66,6 +66,9 @@ struct EngineParams {
   int optimization_level{3};
   bool use_explicit_quantization{false};
   bool allow_build_at_runtime{false};
+  // Build the engine with the refittable weights, the weights of the
+  // persistable variables are named after the variables.
+  bool refittable{false};
 };
 
 }  // namespace platform
@@ -0,0 +1,202 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pybind/async_host_copy.h"
+
+#include <mutex>
+#include <unordered_map>
+
+#include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/pybind/eager_utils.h"
+#include "paddle/fluid/pybind/tensor_py.h"
+#include "paddle/phi/api/lib/data_transform.h"
+#include "paddle/phi/common/memory_utils.h"
+#include "paddle/phi/core/tensor_utils.h"
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#endif
+
+namespace paddle {
+namespace pybind {
+
+namespace {
+
+// The copies into the staging buffer start at the multiples of it.
+constexpr size_t kHostCopyAlignment = 256;
+
+size_t AlignedSize(size_t size) {
+  return (size + kHostCopyAlignment - 1) / kHostCopyAlignment *
+         kHostCopyAlignment;
+}
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+// The context of the D2H stream of place, shared by all the copies to it.
+phi::GPUContext* GetHostCopyContext(const phi::Place& place) {
+  static std::mutex mutex;
+  static std::unordered_map<int, std::unique_ptr<phi::GPUContext>> contexts;
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& context = contexts[place.GetDeviceId()];
+  if (!context) {
+    context = std::make_unique<phi::GPUContext>(
+        phi::GPUPlace(place.GetDeviceId()));
+  }
+  return context.get();
+}
+#endif
+
+phi::DenseTensor ContiguousDenseTensor(const paddle::Tensor& tensor) {
+  PADDLE_ENFORCE_EQ(
+      tensor.is_dense_tensor() && tensor.initialized(),
+      true,
+      phi::errors::InvalidArgument("AsyncHostCopy only supports the "
+                                   "initialized DenseTensors, but Tensor %s "
+                                   "is not.",
+                                   tensor.name()));
+  auto dense_tensor =
+      *std::dynamic_pointer_cast<phi::DenseTensor>(tensor.impl());
+  if (!dense_tensor.meta().is_contiguous()) {
+    dense_tensor = paddle::experimental::Trans2Contiguous(dense_tensor);
+  }
+  return dense_tensor;
+}
+
+}  // namespace
+
+AsyncHostCopy::AsyncHostCopy(const std::vector<paddle::Tensor>& tensors,
+                             bool guard_writes) {
+  egr::Controller::Instance().FlushLazySegment();
+  std::vector<phi::DenseTensor> src_tensors;
+  src_tensors.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    src_tensors.emplace_back(ContiguousDenseTensor(tensor));
+  }
+  host_tensors_.resize(src_tensors.size());
+
+  phi::Place gpu_place;
+  size_t staging_size = 0;
+  std::vector<size_t> offsets(src_tensors.size(), 0);
+  for (size_t i = 0; i < src_tensors.size(); ++i) {
+    const auto& src = src_tensors[i];
+    if (phi::is_gpu_place(src.place()) && src.numel() > 0) {
+      if (staging_size == 0) {
+        gpu_place = src.place();
+      }
+      PADDLE_ENFORCE_EQ(src.place(),
+                        gpu_place,
+                        phi::errors::InvalidArgument(
+                            "The GPU tensors copied by one AsyncHostCopy "
+                            "should be on the same place, but got %s and %s.",
+                            gpu_place,
+                            src.place()));
+      offsets[i] = staging_size;
+      staging_size += AlignedSize(src.numel() * phi::SizeOf(src.dtype()));
+    } else {
+      const auto* dev_ctx =
+          phi::DeviceContextPool::Instance().Get(src.place());
+      phi::Copy(*dev_ctx, src, phi::CPUPlace(), true, &host_tensors_[i]);
+    }
+  }
+  if (staging_size == 0) {
+    return;
+  }
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  // The copies wait for the kernels which write the tensors.
+  const auto* calc_ctx = phi::DeviceContextPool::Instance().Get(gpu_place);
+  auto* copy_ctx = GetHostCopyContext(gpu_place);
+  platform::DeviceEvent calc_event(gpu_place,
+                                   platform::GenerateDeviceEventFlag());
+  calc_event.Record(calc_ctx);
+  calc_event.Wait(platform::Place2DeviceType(gpu_place), copy_ctx);
+
+  auto staging = memory::AllocShared(phi::GPUPinnedPlace(), staging_size);
+  for (size_t i = 0; i < src_tensors.size(); ++i) {
+    const auto& src = src_tensors[i];
+    if (!phi::is_gpu_place(src.place()) || src.numel() == 0) {
+      continue;
+    }
+    phi::DenseTensorMeta meta(src.dtype(), src.dims());
+    meta.offset = offsets[i];
+    host_tensors_[i] = phi::DenseTensor(staging, meta);
+    phi::memory_utils::Copy(staging->place(),
+                            host_tensors_[i].data(),
+                            src.place(),
+                            src.data(),
+                            src.numel() * phi::SizeOf(src.dtype()),
+                            copy_ctx->stream());
+    src_holders_.emplace_back(src.Holder());
+  }
+  copy_event_ = std::make_unique<platform::DeviceEvent>(
+      gpu_place, platform::GenerateDeviceEventFlag());
+  copy_event_->Record(copy_ctx);
+  if (guard_writes) {
+    copy_event_->Wait(platform::Place2DeviceType(gpu_place), calc_ctx);
+  }
+#endif
+}
+
+AsyncHostCopy::~AsyncHostCopy() {
+  if (!src_holders_.empty()) {
+    Synchronize();
+  }
+}
+
+bool AsyncHostCopy::IsCompleted() {
+  if (copy_event_ == nullptr || src_holders_.empty()) {
+    return true;
+  }
+  if (!copy_event_->Query()) {
+    return false;
+  }
+  src_holders_.clear();
+  return true;
+}
+
+void AsyncHostCopy::Synchronize() {
+  if (copy_event_ != nullptr) {
+    copy_event_->Finish();
+  }
+  src_holders_.clear();
+}
+
+void BindAsyncHostCopy(py::module* m) {
+  py::class_<AsyncHostCopy, std::shared_ptr<AsyncHostCopy>>(*m,
+                                                            "AsyncHostCopy")
+      .def(py::init([](py::handle py_tensors, bool guard_writes) {
+             auto tensors = CastPyArg2VectorOfTensor(py_tensors.ptr(), 0);
+             return std::make_shared<AsyncHostCopy>(tensors, guard_writes);
+           }),
+           py::arg("tensors"),
+           py::arg("guard_writes") = false)
+      .def("is_completed", &AsyncHostCopy::IsCompleted)
+      .def("wait",
+           &AsyncHostCopy::Synchronize,
+           py::call_guard<py::gil_scoped_release>())
+      .def("numpy", [](AsyncHostCopy& self) {
+        {
+          py::gil_scoped_release release;
+          self.Synchronize();
+        }
+        py::list arrays;
+        for (const auto& host_tensor : self.HostTensors()) {
+          arrays.append(TensorToPyArray(host_tensor));
+        }
+        return arrays;
+      });
+}
+
+}  // namespace pybind
+}  // namespace paddle
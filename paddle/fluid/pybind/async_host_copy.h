@@ -0,0 +1,72 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/platform/device_event_base.h"
+#include "paddle/phi/api/include/tensor.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "pybind11/pybind11.h"
+
+namespace py = pybind11;
+
+namespace paddle {
+namespace pybind {
+
+/**
+ * AsyncHostCopy copies some tensors to the host without blocking it, e.g. the
+ * metrics logged every N steps.
+ *
+ * The data of the GPU tensors is copied into one pinned staging buffer on a
+ * D2H stream of their place, after the kernels enqueued on the calculation
+ * stream so far, and an event is recorded once all the copies are enqueued.
+ * The tensors of the other places are copied to the host at once.
+ *
+ * With guard_writes, the kernels enqueued on the calculation stream later
+ * wait for the copies too, so that the tensors can be updated in place right
+ * after the copy is created, e.g. by the optimizer after a checkpoint
+ * snapshot, without blocking the host.
+ **/
+class AsyncHostCopy {
+ public:
+  explicit AsyncHostCopy(const std::vector<paddle::Tensor>& tensors,
+                         bool guard_writes = false);
+
+  // Waits for the copies, so the tensors copied from may be freed.
+  ~AsyncHostCopy();
+
+  bool IsCompleted();
+
+  // Blocks the host until all the copies are done.
+  void Synchronize();
+
+  // The host tensors copied to, which are valid after Synchronize.
+  const std::vector<phi::DenseTensor>& HostTensors() const {
+    return host_tensors_;
+  }
+
+ private:
+  std::vector<phi::DenseTensor> host_tensors_;
+  // Keeps the data copied from alive until the copies are done.
+  std::vector<std::shared_ptr<phi::Allocation>> src_holders_;
+  std::unique_ptr<platform::DeviceEvent> copy_event_;
+};
+
+void BindAsyncHostCopy(py::module* m);
+
+}  // namespace pybind
+}  // namespace paddle
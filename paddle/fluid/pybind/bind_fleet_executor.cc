@@ -182,6 +182,7 @@ void BindFleetExecutor(py::module* m) {
       .def("add_downstream_task", &TaskNode::AddDownstreamTask)
       .def("set_run_pre_steps", &TaskNode::SetRunPerSteps)
       .def("set_run_at_offset", &TaskNode::SetRunAtOffset)
+      .def("set_pipeline_stage", &TaskNode::SetPipelineStage)
       .def("set_type", &TaskNode::SetType)
       .def("set_cond_var_name", &TaskNode::SetCondVarName)
       .def("set_vars_to_shape", &TaskNode::SetVarsToShape)
@@ -29,6 +29,7 @@ limitations under the License. */
 #include <string>
 
 #include "paddle/phi/core/distributed/comm_context_manager.h"
+#include "paddle/phi/core/distributed/comm_task_manager.h"
 #include "paddle/phi/core/distributed/store/store_utils.h"
 #include "paddle/phi/core/distributed/store/tcp_store.h"
 
@@ -85,6 +86,23 @@ void BindCommContextManager(py::module *m) {
               py::call_guard<py::gil_scoped_release>())
 #endif
           .def("set_store", &phi::distributed::CommContextManager::SetStore);
+
+#if defined(PADDLE_WITH_RCCL) || defined(PADDLE_WITH_NCCL)
+  m->def(
+      "dump_comm_flight_record",
+      []() {
+        return phi::distributed::CommTaskManager::GetInstance()
+            .DumpFlightRecord();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m->def(
+      "aggregate_comm_flight_record",
+      []() {
+        return phi::distributed::CommTaskManager::GetInstance()
+            .AggregateFlightRecord();
+      },
+      py::call_guard<py::gil_scoped_release>());
+#endif
 }
 
 using TCPStore = phi::distributed::TCPStore;
@@ -115,6 +133,36 @@ void BindTCPStore(py::module *m) {
                        },
                        py::arg("key"),
                        py::call_guard<py::gil_scoped_release>())
+                   .def(
+                       "multi_set",
+                       [](phi::distributed::Store &self,
+                          const std::vector<std::string> &keys,
+                          const std::vector<std::string> &values) {
+                         std::vector<std::vector<uint8_t>> data;
+                         data.reserve(values.size());
+                         for (const auto &value : values) {
+                           data.emplace_back(value.begin(), value.end());
+                         }
+                         self.multi_set(keys, data);
+                       },
+                       py::arg("keys"),
+                       py::arg("values"),
+                       py::call_guard<py::gil_scoped_release>())
+                   .def(
+                       "multi_get",
+                       [](phi::distributed::Store &self,
+                          const std::vector<std::string> &keys) {
+                         auto data = self.multi_get(keys);
+                         py::gil_scoped_acquire acquire;
+                         py::list values;
+                         for (const auto &value : data) {
+                           values.append(py::bytes(
+                               std::string(value.begin(), value.end())));
+                         }
+                         return values;
+                       },
+                       py::arg("keys"),
+                       py::call_guard<py::gil_scoped_release>())
                    .def("add",
                         &phi::distributed::Store::add,
                         py::call_guard<py::gil_scoped_release>())
@@ -281,6 +281,9 @@ void BindDataset(py::module *m) {
       .def("release_memory",
            &framework::Dataset::ReleaseMemory,
            py::call_guard<py::gil_scoped_release>())
+      .def("dump_into_binary",
+           &framework::Dataset::DumpIntoBinary,
+           py::call_guard<py::gil_scoped_release>())
       .def("local_shuffle",
            &framework::Dataset::LocalShuffle,
            py::call_guard<py::gil_scoped_release>())
@@ -369,6 +372,12 @@ void BindDataset(py::module *m) {
       .def("set_fleet_send_sleep_seconds",
            &framework::Dataset::SetFleetSendSleepSeconds,
            py::call_guard<py::gil_scoped_release>())
+      .def("set_fleet_send_bytes_per_second",
+           &framework::Dataset::SetFleetSendBytesPerSecond,
+           py::call_guard<py::gil_scoped_release>())
+      .def("set_streaming_shuffle",
+           &framework::Dataset::SetStreamingShuffle,
+           py::call_guard<py::gil_scoped_release>())
       .def("enable_pv_merge",
            &framework::Dataset::EnablePvMerge,
            py::call_guard<py::gil_scoped_release>())
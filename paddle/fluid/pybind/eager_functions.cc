@@ -37,6 +37,7 @@ typedef SSIZE_T ssize_t;
 #include "paddle/fluid/framework/phi_utils.h"
 #include "paddle/fluid/framework/python_headers.h"
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -526,6 +527,73 @@ static Tensor InitializedEmptyTensor() {
   return tensor;
 }
 
+// The arguments of a custom op, parsed from the names in its OpMetaInfo on the
+// first run of the op, like the CustomEdgesSlotMap, so that the later runs do
+// not parse the names again.
+struct CustomOpArgLayout {
+  enum class AttrType {
+    kBool,
+    kInt,
+    kFloat,
+    kInt64,
+    kString,
+    kInts,
+    kFloats,
+    kInt64s,
+    kStrings,
+    kUnsupported,
+  };
+
+  std::vector<bool> duplicable_inputs;
+  std::vector<bool> duplicable_outputs;
+  std::vector<bool> optional_outputs;
+  std::vector<AttrType> attr_types;
+  std::vector<std::string> attr_type_strs;
+};
+
+static const CustomOpArgLayout& GetCustomOpArgLayout(
+    const std::string& op_type, const paddle::OpMetaInfo& op_info) {
+  using AttrType = CustomOpArgLayout::AttrType;
+  static std::unordered_map<std::string, CustomOpArgLayout> layouts;
+  auto iter = layouts.find(op_type);
+  if (iter != layouts.end()) {
+    return iter->second;
+  }
+
+  static const std::unordered_map<std::string, AttrType> kAttrTypes = {
+      {"bool", AttrType::kBool},
+      {"int", AttrType::kInt},
+      {"float", AttrType::kFloat},
+      {"int64_t", AttrType::kInt64},
+      {"std::string", AttrType::kString},
+      {"std::vector<int>", AttrType::kInts},
+      {"std::vector<float>", AttrType::kFloats},
+      {"std::vector<int64_t>", AttrType::kInt64s},
+      {"std::vector<std::string>", AttrType::kStrings},
+  };
+  CustomOpArgLayout layout;
+  for (const auto& input : paddle::OpMetaInfoHelper::GetInputs(op_info)) {
+    layout.duplicable_inputs.push_back(
+        paddle::framework::detail::IsDuplicableVar(input));
+  }
+  for (const auto& output : paddle::OpMetaInfoHelper::GetOutputs(op_info)) {
+    layout.duplicable_outputs.push_back(
+        paddle::framework::detail::IsDuplicableVar(output));
+    layout.optional_outputs.push_back(
+        paddle::framework::detail::IsOptionalVar(output));
+  }
+  for (const auto& attr : paddle::OpMetaInfoHelper::GetAttrs(op_info)) {
+    auto attr_type_str = paddle::ParseAttrStr(attr)[1];
+    auto type_iter = kAttrTypes.find(attr_type_str);
+    layout.attr_types.push_back(type_iter == kAttrTypes.end()
+                                    ? AttrType::kUnsupported
+                                    : type_iter->second);
+    layout.attr_type_strs.push_back(std::move(attr_type_str));
+  }
+  VLOG(6) << "Construct CustomOpArgLayout of Custom Op: " << op_type;
+  return layouts.emplace(op_type, std::move(layout)).first->second;
+}
+
 PyObject* eager_api_run_custom_op(PyObject* self,
                                   PyObject* args,
                                   PyObject* kwargs) {
@@ -540,15 +608,17 @@ PyObject* eager_api_run_custom_op(PyObject* self,
   std::string op_type = CastPyArg2AttrString(PyTuple_GET_ITEM(args, 0), 0);
   VLOG(7) << "Get things from python for Custom Op: " << op_type;
   paddle::CustomOpKernelContext ctx;
-  auto meta_info_map = egr::Controller::Instance().GetOpMetaInfoMap();
-  PADDLE_ENFORCE_NE(meta_info_map.find(op_type),
+  const auto& meta_info_map = egr::Controller::Instance().GetOpMetaInfoMap();
+  auto meta_info_iter = meta_info_map.find(op_type);
+  PADDLE_ENFORCE_NE(meta_info_iter,
                     meta_info_map.end(),
                     phi::errors::NotFound(
                         "Can't find %s in Eager OpMetaInfoMap which should be "
                         "created by LoadOpMetaInfoAndRegisterOp, please make "
                         "sure you registered your op first and try again. ",
                         op_type));
-  const auto& vec_map = meta_info_map.at(op_type);
+  const auto& vec_map = meta_info_iter->second;
+  const auto& layout = GetCustomOpArgLayout(op_type, vec_map[0]);
   const auto& inputs = paddle::OpMetaInfoHelper::GetInputs(vec_map[0]);
   const auto& attrs = paddle::OpMetaInfoHelper::GetAttrs(vec_map[0]);
   const auto& outputs = paddle::OpMetaInfoHelper::GetOutputs(vec_map[0]);
@@ -568,7 +638,7 @@ PyObject* eager_api_run_custom_op(PyObject* self,
       ctx.EmplaceBackInput(paddle::Tensor());
       continue;
     }
-    if (paddle::framework::detail::IsDuplicableVar(input)) {
+    if (layout.duplicable_inputs[i]) {
       std::vector<paddle::Tensor> tensors =
           CastPyArg2VectorOfTensor(obj, i + 1);
       ctx.EmplaceBackInputs(std::move(tensors));
@@ -601,7 +671,7 @@ PyObject* eager_api_run_custom_op(PyObject* self,
         ctx.EmplaceBackInput(paddle::Tensor());
         continue;
       }
-      if (paddle::framework::detail::IsDuplicableVar(input)) {
+      if (layout.duplicable_inputs[i]) {
         std::vector<paddle::Tensor> tensors =
             CastPyArg2VectorOfTensor(obj, i + 1, mesh);
         ctx.EmplaceBackInputs(std::move(tensors));
@@ -621,46 +691,53 @@ PyObject* eager_api_run_custom_op(PyObject* self,
   // Parse op_type and inputs first, so that use 1 + inputs.size() + i
   int attr_start_idx = static_cast<int>(1 + inputs.size());
   for (size_t i = 0; i < attrs.size(); ++i) {
-    const auto& attr = attrs.at(i);
-    std::vector<std::string> attr_name_and_type = paddle::ParseAttrStr(attr);
-    auto attr_type_str = attr_name_and_type[1];
-    VLOG(7) << "Custom operator add attrs " << attr_name_and_type[0]
-            << " to CustomOpKernelContext. Attribute type = " << attr_type_str;
+    VLOG(7) << "Custom operator add attrs " << attrs[i]
+            << " to CustomOpKernelContext.";
     PyObject* obj = PyTuple_GET_ITEM(args, attr_start_idx + i);
-    if (attr_type_str == "bool") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2AttrBoolean(obj, attr_start_idx + i));  // NOLINT
-    } else if (attr_type_str == "int") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2AttrInt(obj, attr_start_idx + i));  // NOLINT
-    } else if (attr_type_str == "float") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2AttrFloat(obj, attr_start_idx + i));  // NOLINT
-    } else if (attr_type_str == "int64_t") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2Long(obj, op_type, attr_start_idx + i));  // NOLINT
-    } else if (attr_type_str == "std::string") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2AttrString(obj, attr_start_idx + i));  // NOLINT
-    } else if (attr_type_str == "std::vector<int>") {      // NOLINT
-      ctx.EmplaceBackAttr(CastPyArg2VectorOfInt(obj, attr_start_idx + i));
-    } else if (attr_type_str == "std::vector<float>") {
-      ctx.EmplaceBackAttr(CastPyArg2VectorOfFloat(obj, attr_start_idx + i));
-    } else if (attr_type_str == "std::vector<int64_t>") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2Longs(obj, op_type, attr_start_idx + i));  // NOLINT
-    } else if (attr_type_str == "std::vector<std::string>") {
-      ctx.EmplaceBackAttr(
-          CastPyArg2VectorOfString(obj, attr_start_idx + i));  // NOLINT
-    } else {
-      PADDLE_THROW(phi::errors::Unimplemented(
-          "Unsupported `%s` type value as custom attribute now. "
-          "Supported data types include `bool`, `int`, `float`, "
-          "`int64_t`, `std::string`, `std::vector<int>`, "
-          "`std::vector<float>`, `std::vector<int64_t>`, "
-          "`std::vector<std::string>`, Please check whether "
-          "the attribute data type and data type string are matched.",
-          attr_type_str));
+    switch (layout.attr_types[i]) {
+      case CustomOpArgLayout::AttrType::kBool:
+        ctx.EmplaceBackAttr(
+            CastPyArg2AttrBoolean(obj, attr_start_idx + i));  // NOLINT
+        break;
+      case CustomOpArgLayout::AttrType::kInt:
+        ctx.EmplaceBackAttr(
+            CastPyArg2AttrInt(obj, attr_start_idx + i));  // NOLINT
+        break;
+      case CustomOpArgLayout::AttrType::kFloat:
+        ctx.EmplaceBackAttr(
+            CastPyArg2AttrFloat(obj, attr_start_idx + i));  // NOLINT
+        break;
+      case CustomOpArgLayout::AttrType::kInt64:
+        ctx.EmplaceBackAttr(
+            CastPyArg2Long(obj, op_type, attr_start_idx + i));  // NOLINT
+        break;
+      case CustomOpArgLayout::AttrType::kString:
+        ctx.EmplaceBackAttr(
+            CastPyArg2AttrString(obj, attr_start_idx + i));  // NOLINT
+        break;
+      case CustomOpArgLayout::AttrType::kInts:
+        ctx.EmplaceBackAttr(CastPyArg2VectorOfInt(obj, attr_start_idx + i));
+        break;
+      case CustomOpArgLayout::AttrType::kFloats:
+        ctx.EmplaceBackAttr(CastPyArg2VectorOfFloat(obj, attr_start_idx + i));
+        break;
+      case CustomOpArgLayout::AttrType::kInt64s:
+        ctx.EmplaceBackAttr(
+            CastPyArg2Longs(obj, op_type, attr_start_idx + i));  // NOLINT
+        break;
+      case CustomOpArgLayout::AttrType::kStrings:
+        ctx.EmplaceBackAttr(
+            CastPyArg2VectorOfString(obj, attr_start_idx + i));  // NOLINT
+        break;
+      default:
+        PADDLE_THROW(phi::errors::Unimplemented(
+            "Unsupported `%s` type value as custom attribute now. "
+            "Supported data types include `bool`, `int`, `float`, "
+            "`int64_t`, `std::string`, `std::vector<int>`, "
+            "`std::vector<float>`, `std::vector<int64_t>`, "
+            "`std::vector<std::string>`, Please check whether "
+            "the attribute data type and data type string are matched.",
+            layout.attr_type_strs[i]));
     }
   }
 
@@ -677,8 +754,7 @@ PyObject* eager_api_run_custom_op(PyObject* self,
         const auto& input_range = ctx.InputRangeAt(in_idx);
         const auto& input_tensor = ctx.InputAt(input_range.first);
         // inplace optional [Tensor or vector<Tensor>], un-initialized tensor.
-        if (paddle::framework::detail::IsOptionalVar(output) &&
-            !input_tensor.initialized()) {
+        if (layout.optional_outputs[out_idx] && !input_tensor.initialized()) {
           VLOG(7) << "Custom operator add output " << output
                   << " to CustomOpKernelContext. Add un-initialized tensor "
                      "because the inplace optional input is None";
@@ -686,7 +762,7 @@ PyObject* eager_api_run_custom_op(PyObject* self,
           continue;
         }
         /// inplace vector<Tensor>, initialized tensor.
-        if (paddle::framework::detail::IsDuplicableVar(output)) {
+        if (layout.duplicable_outputs[out_idx]) {
           std::vector<paddle::Tensor> empty_tensors;
           size_t vector_size = input_range.second - input_range.first;
           empty_tensors.resize(vector_size);
@@ -717,8 +793,7 @@ PyObject* eager_api_run_custom_op(PyObject* self,
             ctx.MutableOutputAt(ctx.OutputRangeAt(i).first);
         if (!out_tensor->initialized()) {
           PADDLE_ENFORCE(
-              paddle::framework::detail::IsOptionalVar(outputs.at(i)) ||
-                  out_tensor->is_dist_tensor(),
+              layout.optional_outputs[i] || out_tensor->is_dist_tensor(),
               phi::errors::InvalidArgument(
                   "Custom operator's %d-th output is not initialized. "
                   "Please check your implementation again. If you are "
@@ -1305,6 +1380,29 @@ static PyObject* eager_api_to_uva_tensor(PyObject* self,
   return ToPyObject(*(new_tensor.get()));
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
+
+static PyObject* eager_api_record_stream(PyObject* self,
+                                         PyObject* args,
+                                         PyObject* kwargs) {
+  EAGER_TRY
+  // The GPU tensors produced on another stream are used on the current
+  // stream from now on, so their memory is not reused by the other stream
+  // before the current stream is done with them.
+  auto tensor_list = CastPyArg2VectorOfTensor(PyTuple_GET_ITEM(args, 0), 0);
+  for (auto& tensor : tensor_list) {
+    if (!tensor.initialized() || !tensor.is_dense_tensor() ||
+        !phi::is_gpu_place(tensor.place())) {
+      continue;
+    }
+    auto* dense_tensor = static_cast<phi::DenseTensor*>(tensor.impl().get());
+    auto stream =
+        paddle::platform::get_current_stream(tensor.place().GetDeviceId())
+            ->raw_stream();
+    paddle::memory::RecordStream(dense_tensor->Holder(), stream);
+  }
+  RETURN_PY_NONE
+  EAGER_CATCH_AND_THROW_RETURN_NULL
+}
 #endif
 
 static PyObject* eager_api__add_backward_final_hook(PyObject* self,
@@ -1450,6 +1548,10 @@ PyMethodDef variable_functions[] = {  // NOLINT
      (PyCFunction)(void (*)())eager_api_to_uva_tensor,
      METH_VARARGS | METH_KEYWORDS,
      nullptr},
+    {"record_stream",
+     (PyCFunction)(void (*)())eager_api_record_stream,
+     METH_VARARGS | METH_KEYWORDS,
+     nullptr},
 #endif
     {nullptr, nullptr, 0, nullptr}};
 
@@ -152,6 +152,7 @@ static PyObject* tensor_method_numpy(TensorObject* self,
                                      PyObject* args,
                                      PyObject* kwargs) {
   EAGER_TRY
+  egr::Controller::Instance().FlushLazySegment();
   auto& api = pybind11::detail::npy_api::get();
   if (!self->tensor.impl()) {
     Py_intptr_t py_dims[phi::DDim::kMaxRank];     // NOLINT
@@ -557,6 +558,7 @@ static PyObject* tensor_method__is_initialized(TensorObject* self,
                                                PyObject* args,
                                                PyObject* kwargs) {
   EAGER_TRY
+  egr::Controller::Instance().FlushLazySegment();
   return ToPyObject(self->tensor.initialized());
   EAGER_CATCH_AND_THROW_RETURN_NULL
 }
@@ -611,6 +613,7 @@ static PyObject* tensor_method__copy_to(TensorObject* self,
                                         PyObject* args,
                                         PyObject* kwargs) {
   EAGER_TRY
+  egr::Controller::Instance().FlushLazySegment();
   auto place = CastPyArg2Place(PyTuple_GET_ITEM(args, 0), 0);
   bool blocking = CastPyArg2AttrBoolean(PyTuple_GET_ITEM(args, 1), 1);
   paddle::Tensor cp_tensor;
@@ -34,6 +34,7 @@ limitations under the License. */
 #include "paddle/fluid/distributed/ps/wrapper/fleet.h"
 #include "paddle/fluid/framework/fleet/heter_ps/graph_gpu_wrapper.h"
 #include "paddle/fluid/pybind/fleet_py.h"
+#include "pybind11/numpy.h"
 
 namespace py = pybind11;
 using paddle::distributed::CommContext;
@@ -64,6 +65,8 @@ void BindDistFleetWrapper(py::module* m) {
       .def("save_one_model", &FleetWrapper::SaveModelOneTable)
       .def("recv_and_save_model", &FleetWrapper::RecvAndSaveTable)
       .def("sparse_table_stat", &FleetWrapper::PrintTableStat)
+      .def("rebalance_sparse_table", &FleetWrapper::RebalanceSparseTable)
+      .def("pull_sparse_shard_route", &FleetWrapper::PullSparseShardRoute)
       .def("save_cache_table", &FleetWrapper::SaveCacheTable)
       .def("stop_server", &FleetWrapper::StopServer)
       .def("stop_worker", &FleetWrapper::FinalizeWorker)
@@ -321,6 +324,31 @@ void BindTreeIndex(py::module* m) {
       .def("get_travel_codes",
            [](TreeIndex& self, uint64_t id, int start_level) {
              return self.GetTravelCodes(id, start_level);
+           })
+      .def("beam_search",
+           [](TreeIndex& self,
+              int query_num,
+              int beam_size,
+              int topk,
+              const py::function& score_func) {
+             // score_func(level, queries, node_ids) returns the scores of
+             // the candidates of the level as an array
+             return self.BeamSearch(
+                 query_num,
+                 beam_size,
+                 topk,
+                 [&score_func](int level,
+                               const std::vector<int>& queries,
+                               const std::vector<uint64_t>& node_ids,
+                               std::vector<float>* scores) {
+                   auto out = py::array_t<float, py::array::forcecast>(
+                       score_func(level,
+                                  py::array_t<int>(queries.size(),
+                                                   queries.data()),
+                                  py::array_t<uint64_t>(node_ids.size(),
+                                                        node_ids.data())));
+                   scores->assign(out.data(), out.data() + out.size());
+                 });
            });
 }
 
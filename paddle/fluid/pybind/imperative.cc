@@ -475,6 +475,38 @@ static void VarBaseCopy(std::shared_ptr<imperative::VarBase> &src,  // NOLINT
 }
 
 // Bind Methods
+#ifndef _WIN32
+// Returns false if obj can not be written into the batch ring of DataLoader,
+// which takes the CPU tensors without LoD and the numeric numpy arrays.
+static bool ToBatchRingTensor(const py::handle &obj, phi::DenseTensor *t) {
+  if (py::isinstance<phi::DenseTensor>(obj)) {
+    *t = obj.cast<phi::DenseTensor>();
+    return t->initialized() && t->lod().empty() &&
+           t->place().GetType() == phi::AllocationType::CPU;
+  }
+  if (!py::isinstance<py::array>(obj)) {
+    return false;
+  }
+  auto array = py::array::ensure(obj, py::array::c_style);
+  // the same dtypes as DenseTensor.set, where uint16 is taken as bfloat16
+  char kind = array.dtype().kind();
+  if (kind != 'b' && kind != 'i' && kind != 'f' && kind != 'c' &&
+      !(kind == 'u' && array.itemsize() <= 2)) {
+    return false;
+  }
+  // shares the data of the array, which is copied into the ring then
+  SetTensorFromPyArray<phi::CPUPlace>(t, array, phi::CPUPlace(), true);
+  return true;
+}
+
+static size_t BatchRingTensorBytes(const phi::DenseTensor &t) {
+  size_t size = t.numel() * phi::SizeOf(t.dtype());
+  return (size + memory::allocation::mmap_alignment - 1) /
+         memory::allocation::mmap_alignment *
+         memory::allocation::mmap_alignment;
+}
+#endif
+
 void BindImperative(py::module *m_ptr) {
   auto &m = *m_ptr;
 
@@ -611,6 +643,104 @@ void BindImperative(py::module *m_ptr) {
     memory::allocation::MemoryMapAllocationPool::Instance().SetMaxPoolSize(
         size);
   });
+
+  py::class_<memory::allocation::SharedMemoryBatchRing,
+             std::shared_ptr<memory::allocation::SharedMemoryBatchRing>>(
+      m, "SharedMemoryBatchRing")
+      .def(py::init(&memory::allocation::SharedMemoryBatchRing::Create),
+           py::arg("slot_num"),
+           py::arg("slot_size"))
+      .def_static("open",
+                  &memory::allocation::SharedMemoryBatchRing::Open,
+                  py::arg("ipc_name"),
+                  py::arg("slot_num"),
+                  py::arg("slot_size"))
+      .def_static("nbytes",
+                  [](const py::list &items) -> int64_t {
+                    // -1 means some item can not be written into the ring
+                    int64_t nbytes = 0;
+                    for (auto &&item : items) {
+                      phi::DenseTensor t;
+                      if (!ToBatchRingTensor(item, &t)) {
+                        return -1;
+                      }
+                      nbytes += static_cast<int64_t>(BatchRingTensorBytes(t));
+                    }
+                    return nbytes;
+                  })
+      .def_property_readonly(
+          "ipc_name", &memory::allocation::SharedMemoryBatchRing::ipc_name)
+      .def_property_readonly(
+          "slot_num", &memory::allocation::SharedMemoryBatchRing::slot_num)
+      .def_property_readonly(
+          "slot_size", &memory::allocation::SharedMemoryBatchRing::slot_size)
+      .def("acquire", &memory::allocation::SharedMemoryBatchRing::Acquire)
+      .def("release", &memory::allocation::SharedMemoryBatchRing::Release)
+      .def("is_free", &memory::allocation::SharedMemoryBatchRing::IsFree)
+      .def(
+          "write",
+          [](memory::allocation::SharedMemoryBatchRing &self,
+             int slot,
+             const py::list &items) {
+            // copies the items into the slot, and returns the (offset, dtype,
+            // dims) of each item to map them in the main process
+            std::vector<phi::DenseTensor> tensors(items.size());
+            size_t nbytes = 0;
+            for (size_t i = 0; i < items.size(); ++i) {
+              PADDLE_ENFORCE_EQ(
+                  ToBatchRingTensor(items[i], &tensors[i]),
+                  true,
+                  phi::errors::InvalidArgument(
+                      "The item %d of the batch should be a numeric ndarray "
+                      "or a CPU Tensor without LoD.",
+                      i));
+              nbytes += BatchRingTensorBytes(tensors[i]);
+            }
+            PADDLE_ENFORCE_LE(
+                nbytes,
+                self.slot_size(),
+                phi::errors::InvalidArgument(
+                    "The batch of %d bytes is larger than the slot of %d "
+                    "bytes.",
+                    nbytes,
+                    self.slot_size()));
+            char *slot_data = reinterpret_cast<char *>(self.SlotData(slot));
+            py::list metas;
+            size_t offset = 0;
+            for (auto &t : tensors) {
+              size_t size = t.numel() * phi::SizeOf(t.dtype());
+              if (size > 0) {
+                std::memcpy(slot_data + offset, t.data(), size);
+              }
+              metas.append(py::make_tuple(offset,
+                                          static_cast<int>(t.dtype()),
+                                          common::vectorize(t.dims())));
+              offset += BatchRingTensorBytes(t);
+            }
+            return metas;
+          })
+      .def(
+          "wrap",
+          [](memory::allocation::SharedMemoryBatchRing &self,
+             int slot,
+             const py::list &metas) {
+            // the tensors share the slot, which is released when all of them
+            // are freed
+            auto lease = self.Lease(slot);
+            py::list tensors;
+            for (auto &&meta : metas) {
+              auto item = meta.cast<py::tuple>();
+              auto offset = item[0].cast<size_t>();
+              auto dtype = static_cast<phi::DataType>(item[1].cast<int>());
+              auto dims =
+                  common::make_ddim(item[2].cast<std::vector<int64_t>>());
+              size_t size = common::product(dims) * phi::SizeOf(dtype);
+              tensors.append(phi::DenseTensor(
+                  self.SlotAllocation(lease, slot, offset, size),
+                  phi::DenseTensorMeta(dtype, dims)));
+            }
+            return tensors;
+          });
 #endif
 
   m.def("start_imperative_gperf_profiler",
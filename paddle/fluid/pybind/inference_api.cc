@@ -564,6 +564,19 @@ void BindInferenceApi(py::module *m) {
          py::arg("keep_io_types") = true,
          py::arg("black_list") = std::unordered_set<std::string>(),
          py::arg("white_list") = std::unordered_set<std::string>());
+  m->def("convert_to_mmap_params",
+         &paddle_infer::ConvertToMmapParams,
+         py::arg("model_file"),
+         py::arg("params_file"),
+         py::arg("mmap_params_file"));
+  m->def(
+      "export_latency_metrics",
+      [](const std::map<std::string, paddle_infer::Predictor *> &predictors) {
+        std::map<std::string, const paddle_infer::Predictor *> items(
+            predictors.begin(), predictors.end());
+        return paddle_infer::ExportLatencyMetrics(items);
+      },
+      py::arg("predictors"));
 }
 
 namespace {
@@ -809,6 +822,17 @@ void BindAnalysisConfig(py::module *m) {
              self.SetExecStream(stream.raw_stream());
            })
 #endif
+      .def("set_stream_priority",
+           &AnalysisConfig::SetStreamPriority,
+           py::arg("priority"))
+      .def("stream_priority", &AnalysisConfig::stream_priority)
+      .def("enable_packed_sequence",
+           &AnalysisConfig::EnablePackedSequence,
+           py::arg("cu_seqlens_name"),
+           py::arg("max_seqlen"))
+      .def("packed_sequence_enabled", &AnalysisConfig::packed_sequence_enabled)
+      .def("packed_cu_seqlens_name", &AnalysisConfig::packed_cu_seqlens_name)
+      .def("packed_max_seqlen", &AnalysisConfig::packed_max_seqlen)
       .def("enable_xpu",
            &AnalysisConfig::EnableXpu,
            py::arg("l3_size") = 16 * 1024 * 1024,
@@ -881,12 +905,27 @@ void BindAnalysisConfig(py::module *m) {
       .def("enable_new_ir", &AnalysisConfig::EnableNewIR, py::arg("x") = true)
       .def("new_ir_enabled", &AnalysisConfig::new_ir_enabled)
       .def("enable_profile", &AnalysisConfig::EnableProfile)
+      .def("enable_latency_stats",
+           &AnalysisConfig::EnableLatencyStats,
+           py::arg("x") = true)
+      .def("latency_stats_enabled", &AnalysisConfig::latency_stats_enabled)
       .def("disable_glog_info", &AnalysisConfig::DisableGlogInfo)
       .def("glog_info_disabled", &AnalysisConfig::glog_info_disabled)
       .def("enable_save_optim_model",
            &AnalysisConfig::EnableSaveOptimModel,
            py::arg("save_optimized_model") = false)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
+      .def("enable_weight_only_quantization",
+           &AnalysisConfig::EnableWeightOnlyQuantization,
+           py::arg("algo") = "weight_only_int8",
+           py::arg("group_size") = -1)
+      .def("weight_only_quantization_enabled",
+           &AnalysisConfig::weight_only_quantization_enabled)
+      .def("enable_optim_model_cache",
+           &AnalysisConfig::EnableOptimModelCache,
+           py::arg("x") = true)
+      .def("optim_model_cache_enabled",
+           &AnalysisConfig::optim_model_cache_enabled)
       .def("switch_use_feed_fetch_ops",
            &AnalysisConfig::SwitchUseFeedFetchOps,
            py::arg("x") = true)
@@ -943,6 +982,11 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::tuned_tensorrt_dynamic_shape)
       .def("trt_allow_build_at_runtime",
            &AnalysisConfig::trt_allow_build_at_runtime)
+      .def("enable_tensorrt_background_build",
+           &AnalysisConfig::EnableTensorRtBackgroundBuild,
+           py::arg("enable") = true)
+      .def("trt_background_build_enabled",
+           &AnalysisConfig::trt_background_build_enabled)
       .def("exp_disable_tensorrt_ops", &AnalysisConfig::Exp_DisableTensorRtOPs)
       .def("exp_disable_tensorrt_subgraph",
            &AnalysisConfig::Exp_DisableTensorRtSubgraph)
@@ -950,6 +994,8 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::Exp_SpecifyTensorRTSubgraphPrecision)
       .def("exp_disable_tensorrt_dynamic_shape_ops",
            &AnalysisConfig::Exp_DisableTensorRTDynamicShapeOPs)
+      .def("exp_enable_tensorrt_cost_based_partition",
+           &AnalysisConfig::Exp_EnableTensorRTCostBasedPartition)
       .def("enable_tensorrt_dla",
            &AnalysisConfig::EnableTensorRtDLA,
            py::arg("dla_core") = 0)
@@ -990,6 +1036,17 @@ void BindAnalysisConfig(py::module *m) {
       .def("set_mkldnn_cache_capacity",
            &AnalysisConfig::SetMkldnnCacheCapacity,
            py::arg("capacity") = 0)
+      .def("set_onednn_primitive_cache_capacity",
+           &AnalysisConfig::SetOnednnPrimitiveCacheCapacity,
+           py::arg("capacity") = 0)
+      .def("onednn_primitive_cache_capacity",
+           &AnalysisConfig::onednn_primitive_cache_capacity)
+      .def("set_onednn_warmup_shape_file",
+           &AnalysisConfig::SetOnednnWarmupShapeFile,
+           py::arg("shape_file"),
+           py::arg("max_shapes") = 16)
+      .def("onednn_warmup_shape_file",
+           &AnalysisConfig::onednn_warmup_shape_file)
       .def("set_bfloat16_op", &AnalysisConfig::SetBfloat16Op)
       .def("enable_mkldnn_int8",
            &AnalysisConfig::EnableMkldnnInt8,
@@ -1127,6 +1184,7 @@ void BindAnalysisPredictor(py::module *m) {
       .def("clear_intermediate_tensor",
            &AnalysisPredictor::ClearIntermediateTensor)
       .def("try_shrink_memory", &AnalysisPredictor::TryShrinkMemory)
+      .def("get_gpu_time", &AnalysisPredictor::GetGpuTime)
       .def("create_feed_fetch_var", &AnalysisPredictor::CreateFeedFetchVar)
       .def("prepare_feed_fetch", &AnalysisPredictor::PrepareFeedFetch)
       .def("prepare_argument", &AnalysisPredictor::PrepareArgument)
@@ -1190,6 +1248,41 @@ void BindPaddleInferPredictor(py::module *m) {
            })
 #endif
       .def("try_shrink_memory", &paddle_infer::Predictor::TryShrinkMemory)
+      .def("get_gpu_time", &paddle_infer::Predictor::GetGpuTime)
+      .def("get_latency_stats",
+           [](paddle_infer::Predictor &self) {
+             py::dict py_stats;
+             for (auto &item : self.GetLatencyStats()) {
+               py::dict stats;
+               stats["count"] = item.second.count;
+               stats["sum"] = item.second.sum;
+               stats["mean"] = item.second.mean;
+               stats["p50"] = item.second.p50;
+               stats["p99"] = item.second.p99;
+               stats["p999"] = item.second.p999;
+               stats["max"] = item.second.max;
+               py_stats[py::str(item.first)] = stats;
+             }
+             return py_stats;
+           })
+      .def(
+          "update_params",
+          [](paddle_infer::Predictor &self, const py::dict &py_params) {
+            py::list py_tensor_list;
+            std::vector<std::string> names;
+            for (auto item : py_params) {
+              names.push_back(item.first.cast<std::string>());
+              py_tensor_list.append(item.second);
+            }
+            auto tensor_list =
+                CastPyArg2VectorOfTensor(py_tensor_list.ptr(), 0);
+            std::map<std::string, paddle::Tensor> params;
+            for (size_t i = 0; i < names.size(); ++i) {
+              params[names[i]] = tensor_list[i];
+            }
+            self.UpdateParams(params);
+          },
+          py::arg("params"))
       .def("clear_intermediate_tensor",
            &paddle_infer::Predictor::ClearIntermediateTensor)
       .def("register_output_hook", &paddle_infer::Predictor::RegisterOutputHook)
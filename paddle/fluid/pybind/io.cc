@@ -168,7 +168,8 @@ void BindIO(pybind11::module *m) {
          py::arg("pir_version"),
          py::arg("overwrite") = true,
          py::arg("readable") = false,
-         py::arg("trainable") = true);
+         py::arg("trainable") = true,
+         py::arg("binary") = false);
   m->def("deserialize_pir_program", &pir::ReadModule);
 }
 }  // namespace pybind
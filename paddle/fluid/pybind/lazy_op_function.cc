@@ -0,0 +1,203 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/pybind/lazy_op_function.h"
+
+#include <string>
+#include <unordered_map>
+
+#include "paddle/common/ddim.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/eager/api/utils/global_utils.h"
+#include "paddle/fluid/eager/lazy_tracer.h"
+#include "paddle/fluid/eager/utils.h"
+#include "paddle/fluid/pir/dialect/operator/ir/api_builder.h"
+#include "paddle/fluid/pybind/eager_utils.h"
+#include "paddle/fluid/pybind/exception.h"
+#include "paddle/pir/include/core/builtin_type.h"
+
+COMMON_DECLARE_bool(eager_lazy_mode);
+
+namespace paddle {
+namespace pybind {
+
+extern PyTypeObject *p_tensor_type;
+
+namespace {
+
+std::unordered_map<std::string, OpFunction> &LazyStaticAPIMap() {
+  static std::unordered_map<std::string, OpFunction> apis;
+  return apis;
+}
+
+bool IsTensor(PyObject *obj) { return PyObject_TypeCheck(obj, p_tensor_type); }
+
+const paddle::Tensor &GetTensor(PyObject *obj) {
+  return reinterpret_cast<TensorObject *>(obj)->tensor;
+}
+
+// Whether the tensors in obj, nested in lists and tuples, can be the inputs
+// of a recorded op.
+bool CanRecordInputs(PyObject *obj, const egr::LazyTracer &tracer) {
+  if (IsTensor(obj)) {
+    const auto &tensor = GetTensor(obj);
+    if (!tensor.defined() || !tensor.is_dense_tensor()) {
+      return false;
+    }
+    if (!tensor.initialized() && !tracer.IsPlaceholder(tensor)) {
+      return false;
+    }
+    // The recorded ops create no grad nodes.
+    auto *meta = egr::EagerUtils::nullable_autograd_meta(tensor);
+    return meta == nullptr || meta->StopGradient() ||
+           !egr::Controller::Instance().HasGrad();
+  }
+  if (PyList_Check(obj) || PyTuple_Check(obj)) {
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(obj); ++i) {
+      if (!CanRecordInputs(PySequence_Fast_GET_ITEM(obj, i), tracer)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Whether the values in obj can be the outputs of a recorded op, the
+// placeholders need static shapes.
+bool CanRecordOutputs(PyObject *obj) {
+  if (PyObject_CheckIRValue(obj)) {
+    pir::Value value = CastPyArg2Value(obj, "lazy", 0, false);
+    if (!value || !value.type().isa<pir::DenseTensorType>()) {
+      return false;
+    }
+    return !common::contain_unknown_dim(
+        value.type().dyn_cast<pir::DenseTensorType>().dims());
+  }
+  if (PyList_Check(obj) || PyTuple_Check(obj)) {
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(obj); ++i) {
+      if (!CanRecordOutputs(PySequence_Fast_GET_ITEM(obj, i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return obj == Py_None;
+}
+
+// Returns a new reference of obj with the tensors replaced by their values in
+// the segment, or the values replaced by their placeholders if to_values is
+// false.
+PyObject *ReplaceArgs(PyObject *obj, egr::LazyTracer *tracer, bool to_values) {
+  if (to_values && IsTensor(obj)) {
+    return ToPyObject(tracer->GetValue(GetTensor(obj)));
+  }
+  if (!to_values && PyObject_CheckIRValue(obj)) {
+    return ToPyObject(
+        tracer->AddOutput(CastPyArg2Value(obj, "lazy", 0, false)));
+  }
+  if (PyList_Check(obj)) {
+    Py_ssize_t size = PyList_Size(obj);
+    PyObject *list = PyList_New(size);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      PyList_SET_ITEM(
+          list, i, ReplaceArgs(PyList_GET_ITEM(obj, i), tracer, to_values));
+    }
+    return list;
+  }
+  if (PyTuple_Check(obj)) {
+    Py_ssize_t size = PyTuple_Size(obj);
+    PyObject *tuple = PyTuple_New(size);
+    for (Py_ssize_t i = 0; i < size; ++i) {
+      PyTuple_SET_ITEM(
+          tuple, i, ReplaceArgs(PyTuple_GET_ITEM(obj, i), tracer, to_values));
+    }
+    return tuple;
+  }
+  Py_INCREF(obj);
+  return obj;
+}
+
+// Returns nullptr, with the segment unchanged but its inputs, if the op is
+// not recorded.
+PyObject *RecordOp(const char *name,
+                   OpFunction static_api,
+                   PyObject *self,
+                   PyObject *args,
+                   PyObject *kwargs,
+                   egr::LazyTracer *tracer) {
+  PyObject *segment_args = ReplaceArgs(args, tracer, /*to_values=*/true);
+  size_t num_ops = tracer->program()->block()->size();
+
+  auto &builder = paddle::dialect::ApiBuilder::Instance();
+  builder.PushInsertionPoint();
+  builder.SetProgram(tracer->program());
+  PyObject *values = static_api(self, segment_args, kwargs);
+  builder.LoadInsertionPoint();
+  Py_DECREF(segment_args);
+
+  if (values == nullptr || !CanRecordOutputs(values)) {
+    VLOG(6) << "The op " << name << " is not recorded in the lazy segment";
+    if (values == nullptr) {
+      PyErr_Clear();
+    }
+    Py_XDECREF(values);
+    tracer->Rollback(num_ops);
+    return nullptr;
+  }
+  PyObject *outputs = ReplaceArgs(values, tracer, /*to_values=*/false);
+  Py_DECREF(values);
+  tracer->OnOpRecorded();
+  return outputs;
+}
+
+}  // namespace
+
+void RegisterLazyStaticAPIs(const LazyStaticAPI *apis) {
+  for (; apis->name != nullptr; ++apis) {
+    LazyStaticAPIMap()[apis->name] = apis->static_api;
+  }
+}
+
+bool InLazyMode() {
+  return FLAGS_eager_lazy_mode || egr::Controller::Instance().HasLazySegment();
+}
+
+bool RecordLazyOp(const char *name,
+                  PyObject *self,
+                  PyObject *args,
+                  PyObject *kwargs,
+                  PyObject **outputs) {
+  *outputs = nullptr;
+  try {
+    auto &tracer = egr::LazyTracer::Instance();
+    auto static_api = LazyStaticAPIMap().find(name);
+    bool has_kwargs = kwargs != nullptr && PyDict_Size(kwargs) > 0;
+    if (FLAGS_eager_lazy_mode && static_api != LazyStaticAPIMap().end() &&
+        !has_kwargs && CanRecordInputs(args, tracer)) {
+      *outputs =
+          RecordOp(name, static_api->second, self, args, kwargs, &tracer);
+      if (*outputs != nullptr) {
+        return true;
+      }
+    }
+    tracer.Flush();
+  } catch (...) {
+    ThrowExceptionToPython(std::current_exception());
+    return true;
+  }
+  return false;
+}
+
+}  // namespace pybind
+}  // namespace paddle
@@ -0,0 +1,51 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <Python.h>
+
+namespace paddle {
+namespace pybind {
+
+using OpFunction = PyObject *(*)(PyObject *, PyObject *, PyObject *);
+
+struct LazyStaticAPI {
+  const char *name;
+  OpFunction static_api;
+};
+
+// Registers the static_api functions the ops are recorded by, apis ends with
+// a nullptr name.
+void RegisterLazyStaticAPIs(const LazyStaticAPI *apis);
+
+// Whether the dygraph ops try RecordLazyOp, i.e. FLAGS_eager_lazy_mode is on
+// or a lazy segment is not flushed yet.
+bool InLazyMode();
+
+// Records the op into the segment of egr::LazyTracer by its static_api, with
+// the tensors of args replaced by their values in the segment, and sets
+// outputs to the placeholders of its outputs. Returns false if the op is not
+// recorded, the segment is flushed then and the op runs eagerly: an op
+// without static_api, an op which requires grad, an op whose outputs have
+// dynamic shapes, etc. Returns true with outputs nullptr if a Python error
+// is raised.
+bool RecordLazyOp(const char *name,
+                  PyObject *self,
+                  PyObject *args,
+                  PyObject *kwargs,
+                  PyObject **outputs);
+
+}  // namespace pybind
+}  // namespace paddle
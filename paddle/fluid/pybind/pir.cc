@@ -51,6 +51,7 @@
 #include "paddle/fluid/pir/dialect/operator/utils/utils.h"
 #include "paddle/fluid/pir/transforms/general/common_subexpression_elimination_pass.h"
 #include "paddle/fluid/pir/transforms/gpu/fused_bn_add_act_pass.h"
+#include "paddle/fluid/pir/transforms/gpu/fused_conv_bn_act_pass.h"
 #include "paddle/fluid/pir/transforms/passes.h"
 #include "paddle/fluid/pir/utils/general_functions.h"
 #include "paddle/fluid/pir/utils/name_analysis.h"
@@ -128,6 +129,7 @@ using pybind11::return_value_policy;
 namespace name_analysis = pir::utils::name_analysis;
 
 COMMON_DECLARE_bool(print_ir);
+COMMON_DECLARE_bool(enable_fused_conv_bn_act_pass);
 COMMON_DECLARE_bool(pir_apply_shape_optimization_pass);
 
 namespace paddle {
@@ -2353,6 +2355,11 @@ std::shared_ptr<Program> ApplyCommonSubexpressionEliminationPass(
 std::shared_ptr<Program> ApplyFusedBnAddActPass(
     std::shared_ptr<Program> program) {
   pir::PassManager pm(pir::IrContext::Instance(), 3);
+  // before fused_bn_add_act_pass, which fuses the batch_norm + add + relu of
+  // the residual units too
+  if (FLAGS_enable_fused_conv_bn_act_pass) {
+    pm.AddPass(pir::CreateFusedConvBnActPass());
+  }
   pm.AddPass(pir::CreateFusedBnAddActPass());
   pm.Run(program.get());
   if (FLAGS_print_ir) {
@@ -2411,6 +2418,10 @@ void BindPassManager(pybind11::module *m) {
                  pass->Set(attr.first, new int(attr.second.cast<int>()));
                } else if (py::isinstance<py::float_>(attr.second)) {
                  pass->Set(attr.first, new float(attr.second.cast<float>()));
+               } else if (py::isinstance<framework::Scope>(attr.second)) {
+                 // the scope of the parameters is owned by the caller
+                 pass->SetNotOwned(attr.first,
+                                   attr.second.cast<framework::Scope *>());
                } else {
                  PADDLE_THROW(phi::errors::InvalidArgument(
                      "The pass attr is not supported this type."));
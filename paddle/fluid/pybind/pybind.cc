@@ -95,10 +95,12 @@ limitations under the License. */
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/monitor.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/profiler/continuous_tracing.h"
 #include "paddle/fluid/platform/profiler/event_python.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 #include "paddle/fluid/platform/profiler/profiler.h"
 #include "paddle/fluid/platform/tensorrt/engine_params.h"
+#include "paddle/fluid/pybind/async_host_copy.h"
 #include "paddle/fluid/pybind/auto_parallel_py.h"
 #include "paddle/fluid/pybind/bind_cost_model.h"
 #include "paddle/fluid/pybind/bind_fleet_executor.h"
@@ -220,6 +222,7 @@ limitations under the License. */
 #include "paddle/phi/api/ext/op_meta_info.h"
 #include "paddle/phi/api/include/operants_manager.h"
 #include "paddle/phi/api/include/tensor_operants.h"
+#include "paddle/phi/api/lib/data_transform.h"
 #include "paddle/phi/common/type_promotion.h"
 #include "paddle/phi/kernels/autotune/cache.h"
 #include "paddle/phi/kernels/autotune/switch_autotune.h"
@@ -1093,6 +1096,7 @@ PYBIND11_MODULE(libpaddle, m) {
   BindEager(&m);
   BindEagerStringTensor(&m);
   BindCudaStream(&m);
+  BindAsyncHostCopy(&m);
   BindXpuStream(&m);
   BindJit(&m);
   BindEvalFrame(&m);
@@ -1251,6 +1255,8 @@ PYBIND11_MODULE(libpaddle, m) {
                   &phi::backends::gpu::CUDAGraph::UniqueMemoryPoolID)
       .def("replay", &phi::backends::gpu::CUDAGraph::Replay)
       .def("reset", &phi::backends::gpu::CUDAGraph::Reset)
+      .def("has_fixed_random_state",
+           &phi::backends::gpu::CUDAGraph::HasFixedRandomState)
       .def("print_to_dot_files",
            &phi::backends::gpu::CUDAGraph::PrintToDotFiles);
 #endif
@@ -1453,7 +1459,7 @@ PYBIND11_MODULE(libpaddle, m) {
   // unloaded. We need manually clear symbols(may contain plugins' symbols)
   // stored in this static instance to avoid illegal memory access.
   m.def("clear_kernel_factory",
-        []() { phi::KernelFactory::Instance().kernels().clear(); });
+        []() { phi::KernelFactory::Instance().mutable_kernels().clear(); });
   m.def("clear_device_manager", []() {
 #ifdef PADDLE_WITH_CUSTOM_DEVICE
     platform::XCCLCommContext::Release();
@@ -2699,6 +2705,15 @@ All parameter, weight, gradient are variables in Paddle.
       .def_property_readonly(
           "is_integrated",
           [](const gpuDeviceProp &prop) { return prop.integrated; })
+      .def_property_readonly(
+          "clock_rate",
+          [](const gpuDeviceProp &prop) { return prop.clockRate; })
+      .def_property_readonly(
+          "memory_clock_rate",
+          [](const gpuDeviceProp &prop) { return prop.memoryClockRate; })
+      .def_property_readonly(
+          "memory_bus_width",
+          [](const gpuDeviceProp &prop) { return prop.memoryBusWidth; })
       .def("__repr__", [](const gpuDeviceProp &prop) {
         std::stringstream ostr;
         ostr << "_gpuDeviceProperties(name='" << prop.name
@@ -2944,8 +2959,42 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("load_profiler_result", &paddle::platform::LoadProfilerResult);
   m.def("enable_memory_recorder", &paddle::platform::EnableMemoryRecorder);
   m.def("disable_memory_recorder", &paddle::platform::DisableMemoryRecorder);
+  m.def("get_mem_tensor_names", [] {
+    py::list records;
+    for (auto &record : paddle::platform::GetMemTensorNames()) {
+      records.append(
+          py::make_tuple(record.timestamp_ns, record.addr, record.name));
+    }
+    return records;
+  });
+  m.def("clear_mem_tensor_names", &paddle::platform::ClearMemTensorNames);
   m.def("enable_op_info_recorder", &phi::EnableOpInfoRecorder);
   m.def("disable_op_info_recorder", &phi::DisableOpInfoRecorder);
+  m.def(
+      "enable_continuous_tracing",
+      [](uint32_t level) {
+        paddle::platform::ContinuousTracer::Instance().Enable(level);
+      },
+      py::arg("level") = 1);
+  m.def("disable_continuous_tracing",
+        [] { paddle::platform::ContinuousTracer::Instance().Disable(); });
+  m.def("clear_continuous_tracing",
+        [] { paddle::platform::ContinuousTracer::Instance().Clear(); });
+  m.def("set_continuous_tracing_sample_interval",
+        [](paddle::platform::TracerEventType type, uint32_t interval) {
+          paddle::platform::ContinuousTracer::Instance().SetSampleInterval(
+              type, interval);
+        });
+  m.def("dump_continuous_tracing",
+        &paddle::platform::DumpContinuousTracing,
+        py::arg("path"),
+        py::arg("last_seconds"),
+        py::call_guard<py::gil_scoped_release>());
+  m.def("install_continuous_tracing_dump_signal",
+        &paddle::platform::InstallContinuousTracingDumpSignal,
+        py::arg("signum"),
+        py::arg("path_prefix"),
+        py::arg("last_seconds"));
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   m.def("set_cublas_switch", phi::SetAllowTF32Cublas);
@@ -3144,6 +3193,18 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("clear_low_precision_op_list",
         [] { phi::KernelFactory::Instance().ClearLowPrecisionKernelList(); });
 
+  m.def("get_contiguous_copy_stats", [] {
+    py::dict stats;
+    for (auto &item : paddle::experimental::GetContiguousCopyStats()) {
+      stats[item.first.c_str()] =
+          py::make_tuple(item.second.count, item.second.bytes);
+    }
+    return stats;
+  });
+
+  m.def("clear_contiguous_copy_stats",
+        [] { paddle::experimental::ClearContiguousCopyStats(); });
+
   m.def("enable_autotune", [] {
     return phi::autotune::AutoTuneStatus::Instance().EnableAutoTune();
   });
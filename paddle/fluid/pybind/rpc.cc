@@ -55,14 +55,18 @@ void InitAndSetAgentInstance(py::module* m) {
 void InvokeRpc(py::module* m) {
   m->def(
       "invoke_rpc",
-      [](const std::string& name, const std::string& py_func, int timeout_ms) {
+      [](const std::string& name,
+         const std::string& py_func,
+         const std::vector<phi::DenseTensor>& tensors,
+         int timeout_ms) {
         auto instance = RpcAgent::RpcAgentInstance();
         return std::make_shared<FutureWrapper>(
-            instance->InvokeRpc(py_func, name, timeout_ms));
+            instance->InvokeRpc(py_func, tensors, name, timeout_ms));
       },
       py::call_guard<py::gil_scoped_release>(),
       py::arg("to"),
       py::arg("py_func"),
+      py::arg("tensors"),
       py::arg("timeout_ms"));
 }
 void StartWorker(py::module* m) {
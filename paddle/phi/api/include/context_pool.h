@@ -72,6 +72,14 @@ class PADDLE_API DeviceContextPool {
 
   void SyncDeviceContext(const Place& place);
 
+  using DeviceContextMap =
+      paddle::flat_hash_map<Place, const phi::DeviceContext*, Place::Hash>;
+
+  // The calling thread gets the device contexts in contexts instead of the
+  // global ones, e.g. the parallel backward threads which launch the kernels
+  // on their own streams. The map is not owned, nullptr to reset.
+  static void SetThreadLocalContexts(const DeviceContextMap* contexts);
+
   template <AllocationType T>
   const typename DefaultDeviceContextType<T>::TYPE* Get(const Place& place) {
     return reinterpret_cast<const typename DefaultDeviceContextType<T>::TYPE*>(
@@ -81,8 +89,7 @@ class PADDLE_API DeviceContextPool {
  private:
   DeviceContextPool() = default;
 
-  paddle::flat_hash_map<Place, const phi::DeviceContext*, Place::Hash>
-      context_map_;
+  DeviceContextMap context_map_;
   std::mutex mutex_;
 
   DISABLE_COPY_AND_ASSIGN(DeviceContextPool);
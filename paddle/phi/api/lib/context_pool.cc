@@ -25,6 +25,13 @@ limitations under the License. */
 
 namespace paddle::experimental {
 
+namespace {
+
+thread_local const DeviceContextPool::DeviceContextMap*
+    thread_local_contexts = nullptr;  // not owned
+
+}  // namespace
+
 void DeviceContextPool::SyncDeviceContext(const Place& place) {
   if (!phi::DeviceContextPool::IsInitialized()) {
     phi::memory_utils::InitDevices();
@@ -37,12 +44,23 @@ void DeviceContextPool::SyncDeviceContext(const Place& place) {
   }
 }
 
+void DeviceContextPool::SetThreadLocalContexts(
+    const DeviceContextMap* contexts) {
+  thread_local_contexts = contexts;
+}
+
 DeviceContextPool& DeviceContextPool::Instance() {
   static DeviceContextPool g_device_context_pool;
   return g_device_context_pool;
 }
 
 const phi::DeviceContext* DeviceContextPool::Get(const Place& place) {
+  if (thread_local_contexts != nullptr) {
+    auto it = thread_local_contexts->find(place);
+    if (it != thread_local_contexts->end()) {
+      return it->second;
+    }
+  }
   auto it = context_map_.find(place);
   if (it == context_map_.end()) {
     if (!phi::DeviceContextPool::IsInitialized()) {
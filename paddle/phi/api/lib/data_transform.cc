@@ -14,12 +14,14 @@ limitations under the License. */
 
 #include "paddle/phi/api/lib/data_transform.h"
 
+#include <mutex>
 #include <sstream>
 
 #include "glog/logging.h"
 
 #include "paddle/common/flags.h"
 #include "paddle/phi/api/lib/kernel_dispatch.h"
+#include "paddle/phi/api/profiler/event_tracing.h"
 #include "paddle/phi/api/lib/utils/allocator.h"
 #include "paddle/phi/backends/context_pool.h"
 #include "paddle/phi/core/distributed/auto_parallel/dist_tensor.h"
@@ -69,6 +71,65 @@ inline bool NeedTransform2Contiguous(bool is_stride_kernel,
   return FLAGS_use_stride_kernel && !is_stride_kernel && !is_contiguous;
 }
 
+namespace {
+
+thread_local const char* contiguous_copy_op_name = nullptr;
+
+std::mutex& ContiguousCopyStatsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::map<std::string, ContiguousCopyStat>& ContiguousCopyStats() {
+  static std::map<std::string, ContiguousCopyStat> stats;
+  return stats;
+}
+
+// Counts the contiguous copy of tensor, and traces it in the profiler.
+std::unique_ptr<phi::RecordEvent> RecordContiguousCopy(
+    const phi::DenseTensor& tensor) {
+  const char* op_name =
+      contiguous_copy_op_name ? contiguous_copy_op_name : "unknown";
+  const int64_t bytes =
+      tensor.numel() * static_cast<int64_t>(phi::SizeOf(tensor.dtype()));
+  VLOG(3) << "Contiguous copy of " << bytes << " bytes for " << op_name;
+  {
+    std::lock_guard<std::mutex> guard(ContiguousCopyStatsMutex());
+    auto& stat = ContiguousCopyStats()[op_name];
+    ++stat.count;
+    stat.bytes += bytes;
+  }
+  if (!phi::RecordEvent::IsEnabled()) {
+    return nullptr;
+  }
+  return std::make_unique<phi::RecordEvent>(
+      std::string(op_name) + " contiguous_copy",
+      "bytes: " + std::to_string(bytes),
+      phi::TracerEventType::OperatorInner,
+      1);
+}
+
+}  // namespace
+
+std::map<std::string, ContiguousCopyStat> GetContiguousCopyStats() {
+  std::lock_guard<std::mutex> guard(ContiguousCopyStatsMutex());
+  return ContiguousCopyStats();
+}
+
+void ClearContiguousCopyStats() {
+  std::lock_guard<std::mutex> guard(ContiguousCopyStatsMutex());
+  ContiguousCopyStats().clear();
+}
+
+ContiguousCopyOpGuard::ContiguousCopyOpGuard(const char* op_name)
+    : prev_op_name_(contiguous_copy_op_name) {
+  contiguous_copy_op_name = op_name;
+}
+
+ContiguousCopyOpGuard::~ContiguousCopyOpGuard() {
+  contiguous_copy_op_name = prev_op_name_;
+}
+
 inline phi::DenseTensor TransDataLayout(const phi::DenseTensor& tensor,
                                         DataLayout layout) {
   auto& pool = phi::DeviceContextPool::Instance();
@@ -241,6 +302,7 @@ phi::DenseTensor Trans2Contiguous(const phi::DenseTensor& tensor) {
   auto& pool = phi::DeviceContextPool::Instance();
 
   VLOG(3) << "Trans2Contiguous...";
+  auto record_event = RecordContiguousCopy(tensor);
 
   if (tensor.place().GetType() == phi::AllocationType::CPU) {
     auto* dev_ctx = static_cast<phi::CPUContext*>(pool.Get(tensor.place()));
@@ -316,6 +378,7 @@ phi::DenseTensor TransformData(const phi::DenseTensor& tensor,
   phi::DenseTensor out = tensor;
   bool trans_layout = false;
   bool trans_dtype = false;
+  is_stride_kernel |= target_args_def.stride_supported;
 
   if (NeedTransform2Contiguous(is_stride_kernel, out.meta().is_contiguous())) {
     out = Trans2Contiguous(out);
@@ -365,6 +428,7 @@ std::shared_ptr<phi::DenseTensor> PrepareData(
     const TransformFlag& transform_flag,
     bool is_stride_kernel) {
   const auto& tensor_in = input.impl();
+  is_stride_kernel |= target_args_def.stride_supported;
   if (tensor_in) {
     phi::DenseTensor& dense_tensor =
         *static_cast<phi::DenseTensor*>(tensor_in.get());
@@ -414,6 +478,7 @@ std::unique_ptr<std::vector<phi::DenseTensor>> PrepareData(
     bool is_stride_kernel) {
   auto pt_tensors = std::make_unique<std::vector<phi::DenseTensor>>();
   pt_tensors->reserve(inputs.size());
+  is_stride_kernel |= target_args_def.stride_supported;
 
   for (const auto& input : inputs) {
     const auto& tensor_in = input.impl();
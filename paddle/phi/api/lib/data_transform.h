@@ -14,6 +14,9 @@ limitations under the License. */
 
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "paddle/phi/api/include/tensor.h"
 #include "paddle/phi/core/distributed/type_defs.h"
 #include "paddle/phi/core/kernel_factory.h"
@@ -73,6 +76,29 @@ class TransformFlag {
   bool trans_layout_ = true;
 };
 
+// The contiguous copies which PrepareData inserts before the kernels whose
+// inputs are not stride supported, see TensorArgDef::SetStrideSupported.
+struct ContiguousCopyStat {
+  int64_t count{0};
+  int64_t bytes{0};
+};
+
+// The contiguous copies of each API since the last clear.
+std::map<std::string, ContiguousCopyStat> GetContiguousCopyStats();
+
+void ClearContiguousCopyStats();
+
+// Names the API whose inputs are prepared in the scope, which the contiguous
+// copies are counted for.
+class ContiguousCopyOpGuard {
+ public:
+  explicit ContiguousCopyOpGuard(const char* op_name);
+  ~ContiguousCopyOpGuard();
+
+ private:
+  const char* prev_op_name_;
+};
+
 static inline phi::TensorArgDef GetKernelInputArgDef(
     const phi::TensorArgDef& input_def, phi::Backend kernel_backend) {
   phi::TensorArgDef input_actual_def = input_def;
@@ -0,0 +1,221 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/api/profiler/continuous_tracer.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "paddle/phi/core/os_info.h"
+
+namespace phi {
+
+namespace {
+
+constexpr size_t kTypeNum = static_cast<size_t>(TracerEventType::NumTypes);
+
+// the number of events of each type seen by the current thread
+thread_local std::array<uint32_t, kTypeNum> type_counters{};
+
+uint64_t RoundUpToPowerOfTwo(uint64_t n) {
+  uint64_t capacity = 1;
+  while (capacity < n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+std::atomic<bool> ContinuousTracer::enabled_{false};
+
+ContinuousTracer& ContinuousTracer::Instance() {
+  static ContinuousTracer tracer;
+  return tracer;
+}
+
+ContinuousTracer::ContinuousTracer() {
+  for (auto& interval : intervals_) {
+    interval.store(1, std::memory_order_relaxed);
+  }
+}
+
+void ContinuousTracer::Enable(uint32_t level) {
+  level_.store(level, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_relaxed);
+  VLOG(1) << "Enable the continuous tracing of level " << level;
+}
+
+void ContinuousTracer::Disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void ContinuousTracer::SetSampleInterval(TracerEventType type,
+                                         uint32_t interval) {
+  intervals_[static_cast<size_t>(type)].store(interval,
+                                              std::memory_order_relaxed);
+}
+
+bool ContinuousTracer::SampleType(TracerEventType type, uint32_t level) {
+  if (level > level_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  size_t index = static_cast<size_t>(type);
+  uint32_t interval = intervals_[index].load(std::memory_order_relaxed);
+  return interval > 0 && (type_counters[index]++ % interval) == 0;
+}
+
+uint32_t ContinuousTracer::Sample(const char* name,
+                                  TracerEventType type,
+                                  uint32_t level) {
+  if (!SampleType(type, level)) {
+    return kNotSampled;
+  }
+  // the names passed by pointers outlive the events, so they are cached by
+  // their addresses to avoid hashing the strings
+  thread_local std::unordered_map<const char*, uint32_t> name_id_cache;
+  auto iter = name_id_cache.find(name);
+  if (iter != name_id_cache.end()) {
+    return iter->second;
+  }
+  uint32_t name_id = NameId(name);
+  name_id_cache.emplace(name, name_id);
+  return name_id;
+}
+
+uint32_t ContinuousTracer::Sample(const std::string& name,
+                                  TracerEventType type,
+                                  uint32_t level) {
+  if (!SampleType(type, level)) {
+    return kNotSampled;
+  }
+  thread_local std::unordered_map<std::string, uint32_t> name_id_cache;
+  auto iter = name_id_cache.find(name);
+  if (iter != name_id_cache.end()) {
+    return iter->second;
+  }
+  uint32_t name_id = NameId(name);
+  name_id_cache.emplace(name, name_id);
+  return name_id;
+}
+
+uint32_t ContinuousTracer::NameId(const std::string& name) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = name_ids_.find(name);
+  if (iter != name_ids_.end()) {
+    return iter->second;
+  }
+  uint32_t name_id = static_cast<uint32_t>(names_.size());
+  names_.push_back(name);
+  name_ids_.emplace(name, name_id);
+  return name_id;
+}
+
+const std::string& ContinuousTracer::Name(uint32_t name_id) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return names_.at(name_id);
+}
+
+ContinuousTracer::ThreadBuffer* ContinuousTracer::CurrentThreadBuffer() {
+  // the buffer is shared with the tracer so that its records outlive the
+  // thread
+  thread_local std::shared_ptr<ThreadBuffer> buffer = [this] {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->thread_id = GetCurrentThreadSysId();
+    uint64_t capacity = RoundUpToPowerOfTwo(
+        std::max<int64_t>(FLAGS_continuous_tracing_buffer_size, 1));
+    buffer->mask = capacity - 1;
+    buffer->records.resize(capacity);
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers_.push_back(buffer);
+    return buffer;
+  }();
+  return buffer.get();
+}
+
+void ContinuousTracer::Record(uint32_t name_id,
+                              TracerEventType type,
+                              uint64_t start_ns,
+                              uint64_t end_ns) {
+  ThreadBuffer* buffer = CurrentThreadBuffer();
+  uint64_t written = buffer->written.load(std::memory_order_relaxed);
+  ContinuousTraceRecord& record = buffer->records[written & buffer->mask];
+  record.name_id = name_id;
+  record.type = type;
+  record.start_ns = start_ns;
+  record.end_ns = end_ns;
+  buffer->written.store(written + 1, std::memory_order_release);
+}
+
+std::vector<ContinuousTraceThreadRecords> ContinuousTracer::Snapshot(
+    uint64_t since_ns) const {
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    buffers = buffers_;
+  }
+  uint64_t cleared_ns = cleared_ns_.load(std::memory_order_relaxed);
+  std::vector<ContinuousTraceThreadRecords> snapshot;
+  for (auto& buffer : buffers) {
+    uint64_t capacity = buffer->mask + 1;
+    uint64_t written = buffer->written.load(std::memory_order_acquire);
+    uint64_t begin = written > capacity ? written - capacity : 0;
+    std::vector<ContinuousTraceRecord> records;
+    records.reserve(written - begin);
+    for (uint64_t i = begin; i < written; ++i) {
+      records.push_back(buffer->records[i & buffer->mask]);
+    }
+    // the writer overwrites the record i when it writes the record
+    // i + capacity, so the records copied before the writer reaches there
+    // are intact
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t written_after = buffer->written.load(std::memory_order_relaxed);
+    uint64_t intact_begin =
+        written_after >= capacity ? written_after - capacity + 1 : 0;
+
+    ContinuousTraceThreadRecords thread_records;
+    thread_records.thread_id = buffer->thread_id;
+    for (uint64_t i = std::max(begin, intact_begin); i < written; ++i) {
+      const ContinuousTraceRecord& record = records[i - begin];
+      if (record.end_ns >= since_ns && record.start_ns >= cleared_ns) {
+        thread_records.records.push_back(record);
+      }
+    }
+    if (!thread_records.records.empty()) {
+      snapshot.push_back(std::move(thread_records));
+    }
+  }
+  return snapshot;
+}
+
+void ContinuousTracer::Clear() {
+  cleared_ns_.store(PosixInNsec(), std::memory_order_relaxed);
+}
+
+void ContinuousTraceEvent::BeginSampled(uint32_t name_id,
+                                        TracerEventType type) {
+  name_id_ = name_id;
+  if (name_id_ != ContinuousTracer::kNotSampled) {
+    type_ = type;
+    start_ns_ = PosixInNsec();
+  }
+}
+
+void ContinuousTraceEvent::EndSampled() {
+  ContinuousTracer::Instance().Record(
+      name_id_, type_, start_ns_, PosixInNsec());
+  name_id_ = ContinuousTracer::kNotSampled;
+}
+
+}  // namespace phi
@@ -0,0 +1,154 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/flags.h"
+#include "paddle/common/macros.h"
+#include "paddle/phi/api/profiler/trace_event.h"
+#include "paddle/utils/test_macros.h"
+
+COMMON_DECLARE_int32(continuous_tracing_buffer_size);
+
+namespace phi {
+
+struct ContinuousTraceRecord {
+  uint32_t name_id{0};
+  TracerEventType type{TracerEventType::UserDefined};
+  uint64_t start_ns{0};
+  uint64_t end_ns{0};
+};
+
+struct ContinuousTraceThreadRecords {
+  uint64_t thread_id{0};
+  std::vector<ContinuousTraceRecord> records;
+};
+
+// A tracer of the host events which is cheap enough to be always on. The
+// events of RecordEvent are sampled per category, one in every N events of
+// each thread, and recorded with the compact ids of their names into a ring
+// buffer owned by the thread, so that recording needs neither locks nor
+// allocations. The events of the last seconds can be dumped at any time,
+// e.g. when a job hangs or slows down, without restarting it with the
+// profiler.
+class TEST_API ContinuousTracer {
+ public:
+  static constexpr uint32_t kNotSampled = UINT32_MAX;
+
+  static ContinuousTracer& Instance();
+
+  static bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Traces the events whose level is not greater than level.
+  void Enable(uint32_t level);
+
+  void Disable();
+
+  // Samples one in every interval events of the type on each thread, 0 means
+  // the events of the type are not traced. All types are traced by default.
+  void SetSampleInterval(TracerEventType type, uint32_t interval);
+
+  // Returns the name id of the event if it is sampled, otherwise kNotSampled.
+  uint32_t Sample(const char* name, TracerEventType type, uint32_t level);
+  uint32_t Sample(const std::string& name,
+                  TracerEventType type,
+                  uint32_t level);
+
+  void Record(uint32_t name_id,
+              TracerEventType type,
+              uint64_t start_ns,
+              uint64_t end_ns);
+
+  // Returns the records of each thread which end after since_ns. The ring
+  // buffers are read while they are written, and the records which may be
+  // overwritten during the read are dropped.
+  std::vector<ContinuousTraceThreadRecords> Snapshot(uint64_t since_ns) const;
+
+  const std::string& Name(uint32_t name_id) const;
+
+  // Drops the records so far.
+  void Clear();
+
+ private:
+  struct ThreadBuffer {
+    uint64_t thread_id{0};
+    uint64_t mask{0};
+    std::vector<ContinuousTraceRecord> records;
+    // the number of records ever written, only the last mask + 1 of them are
+    // kept
+    std::atomic<uint64_t> written{0};
+  };
+
+  ContinuousTracer();
+
+  bool SampleType(TracerEventType type, uint32_t level);
+
+  uint32_t NameId(const std::string& name);
+
+  ThreadBuffer* CurrentThreadBuffer();
+
+  static std::atomic<bool> enabled_;
+
+  std::atomic<uint32_t> level_{0};
+  std::array<std::atomic<uint32_t>,
+             static_cast<size_t>(TracerEventType::NumTypes)>
+      intervals_;
+  std::atomic<uint64_t> cleared_ns_{0};
+
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  std::unordered_map<std::string, uint32_t> name_ids_;
+  std::deque<std::string> names_;
+
+  DISABLE_COPY_AND_ASSIGN(ContinuousTracer);
+};
+
+// The continuous tracing state of one RecordEvent.
+class TEST_API ContinuousTraceEvent {
+ public:
+  template <typename NameType>
+  void Begin(const NameType& name, TracerEventType type, uint32_t level) {
+    if (UNLIKELY(ContinuousTracer::Enabled())) {
+      BeginSampled(ContinuousTracer::Instance().Sample(name, type, level),
+                   type);
+    }
+  }
+
+  void End() {
+    if (UNLIKELY(name_id_ != ContinuousTracer::kNotSampled)) {
+      EndSampled();
+    }
+  }
+
+ private:
+  void BeginSampled(uint32_t name_id, TracerEventType type);
+
+  void EndSampled();
+
+  uint32_t name_id_{ContinuousTracer::kNotSampled};
+  TracerEventType type_{TracerEventType::UserDefined};
+  uint64_t start_ns_{0};
+};
+
+}  // namespace phi
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <string>
 
+#include "paddle/phi/api/profiler/continuous_tracer.h"
 #include "paddle/phi/api/profiler/event.h"
 #include "paddle/phi/api/profiler/trace_event.h"
 #include "paddle/utils/test_macros.h"
@@ -92,6 +93,7 @@ class TEST_API RecordEvent {
   TracerEventType type_{TracerEventType::UserDefined};
   std::string* attr_{nullptr};
   bool finished_{false};
+  ContinuousTraceEvent continuous_event_;
 };
 
 }  // namespace phi
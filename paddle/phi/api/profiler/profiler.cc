@@ -108,6 +108,7 @@ RecordEvent::RecordEvent(const char *name,
   }
 #endif
 #endif
+  continuous_event_.Begin(name, type, level);
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
     return;
   }
@@ -142,6 +143,7 @@ RecordEvent::RecordEvent(const std::string &name,
   }
 #endif
 #endif
+  continuous_event_.Begin(name, type, level);
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
     return;
   }
@@ -175,6 +177,7 @@ RecordEvent::RecordEvent(const std::string &name,
   }
 #endif
 #endif
+  continuous_event_.Begin(name, type, level);
 
   if (UNLIKELY(HostTraceLevel::GetInstance().NeedTrace(level) == false)) {
     return;
@@ -224,6 +227,7 @@ void RecordEvent::End() {
   }
 #endif
 #endif
+  continuous_event_.End();
   if (LIKELY(FLAGS_enable_host_event_recorder_hook && is_enabled_)) {
     uint64_t end_ns = PosixInNsec();
     if (LIKELY(shallow_copy_name_ != nullptr)) {
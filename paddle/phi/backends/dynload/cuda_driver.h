@@ -59,7 +59,8 @@ extern bool HasCUDADriver();
   __macro(cuDeviceGetCount);                            \
   __macro(cuDevicePrimaryCtxGetState);                  \
   __macro(cuDeviceGetAttribute);                        \
-  __macro(cuDeviceGet)
+  __macro(cuDeviceGet);                                 \
+  __macro(cuMemsetD32Async)
 
 #if CUDA_VERSION >= 10020
 #define CUDA_ROUTINE_EACH_VVM(__macro)    \
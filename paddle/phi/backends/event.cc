@@ -109,4 +109,58 @@ void Event::Synchronize() const {
 
 const Place& Event::GetPlace() const { return place_; }
 
+EventPool& EventPool::Instance() {
+  // never destroyed, the events may be released after the static objects
+  static EventPool* pool = new EventPool();
+  return *pool;
+}
+
+std::shared_ptr<Event> EventPool::Get(const Place& place) {
+  std::unique_ptr<Event> event;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& cached_events = cached_events_[place];
+    while (!cached_events.empty() && event == nullptr) {
+      event = std::move(cached_events.back());
+      cached_events.pop_back();
+      // the events are destroyed by Event::ReleaseAll when the device is
+      // finalized
+      if (!event->IsInitialized()) {
+        event.reset();
+      }
+    }
+  }
+  if (event == nullptr) {
+    event = std::make_unique<Event>();
+    event->Init(place, Event::Flag::DisableTiming);
+    VLOG(4) << "Create a new event " << event->raw_event() << " in pool of "
+            << place;
+  }
+  return std::shared_ptr<Event>(event.release(),
+                                [this](Event* event) { Put(event); });
+}
+
+void EventPool::Put(Event* event) {
+  std::unique_ptr<Event> holder(event);
+  if (!event->IsInitialized()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  cached_events_[event->GetPlace()].push_back(std::move(holder));
+}
+
+void EventPool::Clear() {
+  std::map<Place, std::vector<std::unique_ptr<Event>>> cached_events;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cached_events.swap(cached_events_);
+  }
+}
+
+size_t EventPool::CachedNum(const Place& place) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cached_events_.find(place);
+  return it == cached_events_.end() ? 0 : it->second.size();
+}
+
 }  // namespace phi::event
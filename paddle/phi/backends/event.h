@@ -13,6 +13,11 @@
 // limitations under the License.
 
 #pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "paddle/common/macros.h"
 #include "paddle/phi/common/place.h"
 
@@ -48,6 +53,7 @@ class Event {
   bool Query() const;
   void Synchronize() const;
   const Place& GetPlace() const;
+  bool IsInitialized() const { return device_ != nullptr; }
 
   static void ReleaseAll();
 
@@ -59,6 +65,34 @@ class Event {
   bool own_data_ = true;
   mutable bool is_recorded_ = false;
 };
+
+// Caches the events of each place, so that the events used for a short while,
+// e.g. the ones recorded by the stream safe allocators, are not created and
+// destroyed by the device runtime each time. The events are created with
+// Flag::DisableTiming and are only used to synchronize the streams.
+class EventPool {
+ public:
+  static EventPool& Instance();
+
+  // Returns an event of the place, which goes back to the pool once the last
+  // reference is released. The event may be recorded again right after it is
+  // waited by a stream.
+  std::shared_ptr<Event> Get(const Place& place);
+
+  // Destroys the cached events of all places.
+  void Clear();
+
+  size_t CachedNum(const Place& place);
+
+ private:
+  EventPool() = default;
+  DISABLE_COPY_AND_ASSIGN(EventPool);
+
+  void Put(Event* event);
+
+  std::mutex mutex_;
+  std::map<Place, std::vector<std::unique_ptr<Event>>> cached_events_;
+};
 }  // namespace event
 
 }  // namespace phi
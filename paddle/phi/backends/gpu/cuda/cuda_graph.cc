@@ -110,6 +110,10 @@ void CUDAGraph::Reset() {
   }
   exec_graphs_.clear();
 #endif
+  for (auto &item : random_seed_offsets_) {
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaFree(item.second.device_ptr));
+  }
+  random_seed_offsets_.clear();
   // callback should be called in reverse order because the latter added
   // callback may rely on the former added callback.
   for (auto iter = cudagraph_post_reset_callbacks_.rbegin();
@@ -128,6 +132,20 @@ void CUDAGraph::Replay() {
                     false,
                     phi::errors::PermissionDenied(
                         "Cannot replay the CUDA Graph after reset is called."));
+  // writes the seeds and the base offsets of the random kernels by memsets,
+  // whose values are passed by arguments, so that the host does not wait for
+  // the copies of the former replay to reuse a host buffer
+  for (auto &item : random_seed_offsets_) {
+    auto &seed_offset = item.second;
+    auto seed_base = seed_offset.refresh(seed_offset.span);
+    const uint64_t values[2] = {seed_base.first, seed_base.second};
+    const auto *words = reinterpret_cast<const uint32_t *>(values);
+    auto dst = reinterpret_cast<CUdeviceptr>(seed_offset.device_ptr);
+    for (int j = 0; j < 4; ++j) {
+      PADDLE_ENFORCE_GPU_SUCCESS(dynload::cuMemsetD32Async(
+          dst + j * sizeof(uint32_t), words[j], 1, stream_));
+    }
+  }
   size_t n = exec_graphs_.size();
   for (size_t i = 0; i < n; ++i) {
     if (!is_first_run_) {
@@ -141,6 +159,32 @@ void CUDAGraph::Replay() {
 #endif
 }
 
+std::pair<const uint64_t *, uint64_t> CUDAGraph::CapturingRandomSeedOffset(
+    const void *generator,
+    uint64_t state_index,
+    uint64_t offset,
+    uint64_t increment,
+    RefreshSeedOffsetFunc refresh) {
+  std::lock_guard<std::mutex> guard(capturing_graph_->func_mtx_);
+  auto &seed_offset = capturing_graph_->random_seed_offsets_[std::make_pair(
+      generator, state_index)];
+  if (seed_offset.device_ptr == nullptr) {
+    // cudaMalloc is only allowed in the relaxed capture mode
+    CUDAGraphCaptureModeGuard mode_guard;
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cudaMalloc(&seed_offset.device_ptr, 2 * sizeof(uint64_t)));
+    seed_offset.capture_base = offset;
+    seed_offset.refresh = std::move(refresh);
+  }
+  // an offset restored to before the base wraps around, which still adds up
+  // to the same offset on the device
+  uint64_t relative_offset = offset - seed_offset.capture_base;
+  if (offset >= seed_offset.capture_base) {
+    seed_offset.span = std::max(seed_offset.span, relative_offset + increment);
+  }
+  return std::make_pair(seed_offset.device_ptr, relative_offset);
+}
+
 void CUDAGraph::BeginSegmentCapture() {
   ThrowErrorIfNotSupportCUDAGraph();
 #if CUDA_VERSION >= 10010
@@ -290,6 +334,33 @@ bool CUDAGraph::IsValidCapturing() {
 #endif
 }
 
+void CUDAGraph::EnforceNotWaitingForCapturing(cudaStream_t stream,
+                                              const char *what) {
+#if CUDA_VERSION >= 10010
+  if (LIKELY(!IsThisThreadCapturing())) return;
+  bool waiting_for_capturing = false;
+  if (stream == nullptr) {
+    waiting_for_capturing = IsValidCapturing();
+  } else {
+    cudaStreamCaptureStatus status;
+    PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamIsCapturing(stream, &status));
+    waiting_for_capturing = status == cudaStreamCaptureStatusActive;
+  }
+  if (UNLIKELY(waiting_for_capturing)) {
+    PADDLE_THROW(phi::errors::PreconditionNotMet(
+        "%s is called while capturing CUDA Graph %d. The host cannot wait "
+        "for the kernels being captured, and the outputs of the step would be "
+        "baked into the graph. It is usually caused by copying a GPU tensor "
+        "to the host, e.g. Tensor.numpy(), Tensor.item(), float(tensor) or "
+        "print(tensor), or by an op whose output shape depends on the input "
+        "data, e.g. nonzero or masked_select. Please move it out of the "
+        "captured step.",
+        what,
+        capturing_graph_->id_));
+  }
+#endif
+}
+
 static std::string ConcatPath(const std::string &dirname,
                               const std::string &filename) {
 #ifdef _WIN32
@@ -331,6 +402,7 @@ void CUDAGraphNodeLauncher::KernelNodeLaunch(
     auto cudaFunc = cudakernelCallback(id);
 
     parameterSetters[cudaFunc][id] = parameterSetter;
+    phi::backends::gpu::CUDAGraph::RecordReplayedRandomOffset();
     VLOG(10) << "[KernelNodeLaunch] Launch kernel with cudaFunc = " << cudaFunc
              << " id = " << id;
   } else {
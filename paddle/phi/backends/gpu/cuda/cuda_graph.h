@@ -18,6 +18,7 @@
 #include <atomic>
 #include <functional>
 #include <future>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -329,6 +330,46 @@ class CUDAGraph {
     capturing_graph_->set_seed_funcs_.emplace_back(std::move(set_seed_func));
   }
 
+  // A random kernel takes its seed and offset from the generator when it is
+  // captured, so it replays the same random numbers, unless the offset is set
+  // again at each replay by CUDAGraphNodeLauncher, e.g. dropout.
+  static void RecordRandomOffsetIncrement() {
+    if (UNLIKELY(IsThisThreadCapturing())) {
+      std::lock_guard<std::mutex> guard(capturing_graph_->func_mtx_);
+      ++capturing_graph_->random_offset_increments_;
+    }
+  }
+
+  static void RecordReplayedRandomOffset() {
+    std::lock_guard<std::mutex> guard(capturing_graph_->func_mtx_);
+    ++capturing_graph_->replayed_random_offsets_;
+  }
+
+  // Random kernels captured by IncrementPhiloxOffset read the seed and the
+  // base offset of the state_index-th state of generator from a buffer on the
+  // device, which the graph writes before each replay from the seed and the
+  // base returned by refresh, called with the span of the offsets used by the
+  // graph. Returns the buffer and offset relative to the base of the capture.
+  using RefreshSeedOffsetFunc =
+      std::function<std::pair<uint64_t, uint64_t>(uint64_t)>;
+  static std::pair<const uint64_t *, uint64_t> CapturingRandomSeedOffset(
+      const void *generator,
+      uint64_t state_index,
+      uint64_t offset,
+      uint64_t increment,
+      RefreshSeedOffsetFunc refresh);
+
+  // Whether some random kernels in the graph replay the same random numbers.
+  bool HasFixedRandomState() const {
+    return random_offset_increments_ > replayed_random_offsets_;
+  }
+
+  // Throws if the host is going to wait for stream, or for the whole device
+  // when stream is nullptr, while this thread captures a CUDA Graph on it,
+  // which fails the capture. what names the wait in the error.
+  static void EnforceNotWaitingForCapturing(cudaStream_t stream,
+                                            const char *what);
+
   static int64_t UniqueMemoryPoolID();
 
  private:
@@ -350,6 +391,19 @@ class CUDAGraph {
 
   std::vector<SetSeedFunc> set_seed_funcs_;
 
+  struct RandomSeedOffset {
+    uint64_t *device_ptr{nullptr};
+    uint64_t capture_base{0};
+    uint64_t span{0};
+    RefreshSeedOffsetFunc refresh;
+  };
+  // by the generator and the index of its state
+  std::map<std::pair<const void *, uint64_t>, RandomSeedOffset>
+      random_seed_offsets_;
+
+  size_t random_offset_increments_{0};
+  size_t replayed_random_offsets_{0};
+
   std::unordered_set<cudaStream_t> streams_to_join_;
 
   // Holds callbacks that are triggered after the CUDA graph is reset. These
@@ -16,6 +16,7 @@
 
 #include "glog/logging.h"
 
+#include "paddle/phi/backends/gpu/cuda/cuda_graph.h"
 #include "paddle/phi/core/enforce.h"
 
 static std::once_flag g_device_props_size_init_flag;
@@ -269,6 +270,7 @@ void GpuMemcpySync(void *dst,
                    const void *src,
                    size_t count,
                    gpuMemcpyKind kind) {
+  CUDAGraph::EnforceNotWaitingForCapturing(nullptr, "GpuMemcpySync");
   PADDLE_ENFORCE_GPU_SUCCESS(cudaMemcpy(dst, src, count, kind));
 }
 
@@ -293,6 +295,7 @@ void GpuMemsetAsync(void *dst, int value, size_t count, gpuStream_t stream) {
 }
 
 void GpuStreamSync(gpuStream_t stream) {
+  CUDAGraph::EnforceNotWaitingForCapturing(stream, "GpuStreamSync");
   PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(stream));
 }
 
@@ -38,6 +38,7 @@ limitations under the License. */
 #include "paddle/phi/backends/dynload/cudnn.h"
 #include "paddle/phi/backends/dynload/cusolver.h"
 #include "paddle/phi/backends/dynload/cusparse.h"
+#include "paddle/phi/backends/gpu/cuda/cuda_graph.h"
 #if !defined(__APPLE__) && defined(PADDLE_WITH_NCCL)
 #include "paddle/phi/backends/dynload/nccl.h"
 #endif  // !defined(__APPLE__) && defined(PADDLE_WITH_NCCL)
@@ -46,6 +47,7 @@ limitations under the License. */
 #ifdef PADDLE_WITH_HIP
 #include "paddle/phi/backends/dynload/miopen.h"
 #include "paddle/phi/backends/dynload/rocblas.h"
+#include "paddle/phi/backends/gpu/rocm/hip_graph.h"
 #if !defined(__APPLE__) && defined(PADDLE_WITH_RCCL)
 #include "paddle/phi/backends/dynload/rccl.h"
 #endif  // !defined(__APPLE__) && defined(PADDLE_WITH_RCCL)
@@ -525,6 +527,8 @@ struct GPUContext::Impl {
   }
 
   void Wait() const {
+    backends::gpu::CUDAGraph::EnforceNotWaitingForCapturing(
+        stream(), "GPUContext::Wait");
 #ifdef PADDLE_WITH_HIP
     hipError_t e_sync = hipSuccess;
 #if !defined(_WIN32)
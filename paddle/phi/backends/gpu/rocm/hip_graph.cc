@@ -263,6 +263,33 @@ bool CUDAGraph::IsValidCapturing() {
 #endif
 }
 
+void CUDAGraph::EnforceNotWaitingForCapturing(hipStream_t stream,
+                                              const char *what) {
+#if defined(PADDLE_WITH_HIP)
+  if (LIKELY(!IsThisThreadCapturing())) return;
+  bool waiting_for_capturing = false;
+  if (stream == nullptr) {
+    waiting_for_capturing = IsValidCapturing();
+  } else {
+    hipStreamCaptureStatus status;
+    PADDLE_ENFORCE_GPU_SUCCESS(hipStreamIsCapturing(stream, &status));
+    waiting_for_capturing = status == hipStreamCaptureStatusActive;
+  }
+  if (UNLIKELY(waiting_for_capturing)) {
+    PADDLE_THROW(phi::errors::PreconditionNotMet(
+        "%s is called while capturing CUDA Graph %d. The host cannot wait "
+        "for the kernels being captured, and the outputs of the step would be "
+        "baked into the graph. It is usually caused by copying a GPU tensor "
+        "to the host, e.g. Tensor.numpy(), Tensor.item(), float(tensor) or "
+        "print(tensor), or by an op whose output shape depends on the input "
+        "data, e.g. nonzero or masked_select. Please move it out of the "
+        "captured step.",
+        what,
+        capturing_graph_->id_));
+  }
+#endif
+}
+
 static std::string ConcatPath(const std::string &dirname,
                               const std::string &filename) {
 #ifdef _WIN32
@@ -292,6 +319,7 @@ void CUDAGraphNodeLauncher::KernelNodeLaunch(
     auto cudaFunc = cudakernelCallback(id);
 
     parameterSetters[cudaFunc][id] = parameterSetter;
+    phi::backends::gpu::CUDAGraph::RecordReplayedRandomOffset();
     VLOG(10) << "[KernelNodeLaunch] Launch kernel with cudaFunc = " << cudaFunc
              << " id = " << id;
   } else {
@@ -309,6 +309,32 @@ class CUDAGraph {
     capturing_graph_->set_seed_funcs_.emplace_back(std::move(set_seed_func));
   }
 
+  // A random kernel takes its seed and offset from the generator when it is
+  // captured, so it replays the same random numbers, unless the offset is set
+  // again at each replay by CUDAGraphNodeLauncher, e.g. dropout.
+  static void RecordRandomOffsetIncrement() {
+    if (UNLIKELY(IsThisThreadCapturing())) {
+      std::lock_guard<std::mutex> guard(capturing_graph_->func_mtx_);
+      ++capturing_graph_->random_offset_increments_;
+    }
+  }
+
+  static void RecordReplayedRandomOffset() {
+    std::lock_guard<std::mutex> guard(capturing_graph_->func_mtx_);
+    ++capturing_graph_->replayed_random_offsets_;
+  }
+
+  // Whether some random kernels in the graph replay the same random numbers.
+  bool HasFixedRandomState() const {
+    return random_offset_increments_ > replayed_random_offsets_;
+  }
+
+  // Throws if the host is going to wait for stream, or for the whole device
+  // when stream is nullptr, while this thread captures a CUDA Graph on it,
+  // which fails the capture. what names the wait in the error.
+  static void EnforceNotWaitingForCapturing(hipStream_t stream,
+                                            const char *what);
+
   static int64_t UniqueMemoryPoolID();
 
  private:
@@ -328,6 +354,8 @@ class CUDAGraph {
   std::mutex mtx_;
 
   std::vector<SetSeedFunc> set_seed_funcs_;
+  size_t random_offset_increments_{0};
+  size_t replayed_random_offsets_{0};
 
   // Holds callbacks that are triggered after the CUDA graph is reset. These
   // callbacks are used for operations that need to be performed following the
@@ -16,6 +16,7 @@
 
 #include "paddle/phi/backends/gpu/gpu_info.h"
 
+#include "paddle/phi/backends/gpu/rocm/hip_graph.h"
 #include "paddle/phi/core/enforce.h"
 
 static std::once_flag g_device_props_size_init_flag;
@@ -264,6 +265,7 @@ void GpuMemcpySync(void *dst,
                    const void *src,
                    size_t count,
                    gpuMemcpyKind kind) {
+  CUDAGraph::EnforceNotWaitingForCapturing(nullptr, "GpuMemcpySync");
   PADDLE_ENFORCE_GPU_SUCCESS(hipMemcpy(dst, src, count, kind));
 }
 
@@ -288,6 +290,7 @@ void GpuMemsetAsync(void *dst, int value, size_t count, gpuStream_t stream) {
 }
 
 void GpuStreamSync(gpuStream_t stream) {
+  CUDAGraph::EnforceNotWaitingForCapturing(stream, "GpuStreamSync");
   PADDLE_ENFORCE_GPU_SUCCESS(hipStreamSynchronize(stream));
 }
 
@@ -14,7 +14,9 @@
 
 #include "paddle/phi/backends/xpu/xpu_context.h"
 
+#include <cstring>
 #include <memory>
+#include <mutex>
 
 #include "glog/logging.h"
 
@@ -33,6 +35,27 @@ namespace xpu = baidu::xpu::api;
 
 namespace phi {
 
+namespace {
+
+// Queues a copy on the stream. XPU1 and XPU2 have no async copies, so there
+// it waits for the work queued on the stream and copies synchronously.
+void QueueMemcpy(void* dst,
+                 const void* src,
+                 size_t count,
+                 XPUMemcpyKind kind,
+                 XPUStream stream,
+                 backends::xpu::XPUVersion version) {
+  if (version == backends::xpu::XPU3) {
+    PADDLE_ENFORCE_XPU_SUCCESS(
+        xpu_memcpy_async(dst, src, count, kind, stream));
+  } else {
+    PADDLE_ENFORCE_XPU_SUCCESS(xpu_wait(stream));
+    PADDLE_ENFORCE_XPU_SUCCESS(xpu_memcpy(dst, src, count, kind));
+  }
+}
+
+}  // namespace
+
 struct XPUContext::Impl {
   void SetL3Cache(int64_t l3_size = 1024) {
     PADDLE_ENFORCE_XPU_SUCCESS(xpu_wait(context_->xpu_stream));
@@ -52,6 +75,7 @@ struct XPUContext::Impl {
   explicit Impl(const Place& place) : place_(place) {}
 
   ~Impl() {
+    DestroyCopyStreams();
     for (auto& ctx_it : context_map_) {
       auto& ctx = ctx_it.second;
       if (ctx != nullptr) {
@@ -96,6 +120,82 @@ struct XPUContext::Impl {
     }
     stream_owned_ = false;
     context_->set_stream(static_cast<XPUStream>(stream));
+    // the copies to the device queued before the switch
+    if (h2d_event_ != nullptr) {
+      PADDLE_ENFORCE_XRE_SUCCESS(
+          xpu_stream_wait_event(context_->xpu_stream, h2d_event_));
+    }
+  }
+
+  XPUStream CopyStream(bool to_device) {
+    std::call_once(copy_streams_once_, [this] {
+      backends::xpu::XPUDeviceGuard guard(place_.GetDeviceId());
+      PADDLE_ENFORCE_XPU_SUCCESS(xpu_stream_create(&h2d_stream_));
+      PADDLE_ENFORCE_XPU_SUCCESS(xpu_stream_create(&d2h_stream_));
+      PADDLE_ENFORCE_XRE_SUCCESS(xpu_event_create(&h2d_event_));
+      PADDLE_ENFORCE_XRE_SUCCESS(xpu_event_create(&d2h_event_));
+    });
+    return to_device ? h2d_stream_ : d2h_stream_;
+  }
+
+  void MemcpyH2DAsync(void* dst, const void* src, size_t count) {
+    XPUStream copy_stream = CopyStream(true);
+    backends::xpu::XPUDeviceGuard guard(place_.GetDeviceId());
+    auto staged = memory_utils::Alloc(CPUPlace(), count);
+    std::memcpy(staged->ptr(), src, count);
+    // after the work queued on the compute stream, which may still read dst,
+    // but without blocking the host for it
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_event_record(h2d_event_, stream()));
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_stream_wait_event(copy_stream, h2d_event_));
+    QueueMemcpy(dst,
+                staged->ptr(),
+                count,
+                XPUMemcpyKind::XPU_HOST_TO_DEVICE,
+                copy_stream,
+                xpu_version_);
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_event_record(h2d_event_, copy_stream));
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_stream_wait_event(stream(), h2d_event_));
+    // freed by the next Wait, after the compute stream caught up with the copy
+    std::lock_guard<std::mutex> lock(copy_mtx_);
+    staged_mem_for_free_.emplace_back(std::move(staged));
+  }
+
+  void MemcpyD2HAsync(void* dst, const void* src, size_t count) {
+    XPUStream copy_stream = CopyStream(false);
+    backends::xpu::XPUDeviceGuard guard(place_.GetDeviceId());
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_event_record(d2h_event_, stream()));
+    PADDLE_ENFORCE_XRE_SUCCESS(xpu_stream_wait_event(copy_stream, d2h_event_));
+    QueueMemcpy(dst,
+                src,
+                count,
+                XPUMemcpyKind::XPU_DEVICE_TO_HOST,
+                copy_stream,
+                xpu_version_);
+  }
+
+  void MemcpyOnStream(void* dst,
+                      const void* src,
+                      size_t count,
+                      XPUMemcpyKind kind) {
+    backends::xpu::XPUDeviceGuard guard(place_.GetDeviceId());
+    XPUStream s = stream();
+    QueueMemcpy(dst, src, count, kind, s, xpu_version_);
+    PADDLE_ENFORCE_XPU_SUCCESS(xpu_wait(s));
+  }
+
+  void DestroyCopyStreams() {
+    if (h2d_stream_ == nullptr) {
+      return;
+    }
+    backends::xpu::XPUDeviceGuard guard(place_.GetDeviceId());
+    xpu_wait(h2d_stream_);
+    xpu_wait(d2h_stream_);
+    xpu_stream_destroy(h2d_stream_);
+    xpu_stream_destroy(d2h_stream_);
+    xpu_event_destroy(h2d_event_);
+    xpu_event_destroy(d2h_event_);
+    h2d_stream_ = nullptr;
+    d2h_stream_ = nullptr;
   }
 
   xpu::Context* GetXContext() const {
@@ -133,6 +233,8 @@ struct XPUContext::Impl {
     }
 
     ClearStashedMemory();
+    std::lock_guard<std::mutex> lock(copy_mtx_);
+    staged_mem_for_free_.clear();
   }
 
   class XHPCBufferManager {
@@ -293,6 +395,16 @@ struct XPUContext::Impl {
   xpu::BKCLContext_t bkcl_context_{nullptr};
   XHPCBufferManager xhpc_buf_mgr_;
   std::vector<std::shared_ptr<Allocation>> stashed_mem_for_free_;
+
+  // the copy-in and copy-out streams, and the host buffers staging the
+  // copies to the device until the compute stream is waited for
+  std::once_flag copy_streams_once_;
+  XPUStream h2d_stream_{nullptr};
+  XPUStream d2h_stream_{nullptr};
+  XPUEvent h2d_event_{nullptr};
+  XPUEvent d2h_event_{nullptr};
+  std::mutex copy_mtx_;
+  std::vector<Allocator::AllocationPtr> staged_mem_for_free_;
 };
 
 static int64_t get_gm_size(int i) {
@@ -372,6 +484,53 @@ void XPUContext::SetStream(void* stream, int i) {
   impls_[i]->SetStream(stream);
 }
 
+XPUStream XPUContext::h2d_stream(int i) const {
+  CheckValidStreamId(i);
+  return impls_[i]->CopyStream(true);
+}
+
+XPUStream XPUContext::d2h_stream(int i) const {
+  CheckValidStreamId(i);
+  return impls_[i]->CopyStream(false);
+}
+
+void XPUContext::MemcpyH2DAsync(void* dst,
+                                const void* src,
+                                size_t count,
+                                int i) const {
+  CheckValidStreamId(i);
+  if (count == 0) return;
+  impls_[i]->MemcpyH2DAsync(dst, src, count);
+}
+
+void XPUContext::MemcpyD2HAsync(void* dst,
+                                const void* src,
+                                size_t count,
+                                int i) const {
+  CheckValidStreamId(i);
+  if (count == 0) return;
+  impls_[i]->MemcpyD2HAsync(dst, src, count);
+}
+
+void XPUContext::WaitD2H(int i) const {
+  CheckValidStreamId(i);
+  PADDLE_ENFORCE_XPU_SUCCESS(xpu_wait(impls_[i]->CopyStream(false)));
+}
+
+void XPUContext::MemcpyOnStream(void* dst,
+                                const void* src,
+                                size_t count,
+                                XPUMemcpyKind kind,
+                                int i) const {
+  CheckValidStreamId(i);
+  if (count == 0) return;
+  // the streams of XPU_CDNN_CLUSTER_PARALLEL share their tensors
+  if (GetStreamNum() > 1) {
+    Wait();
+  }
+  impls_[i]->MemcpyOnStream(dst, src, count, kind);
+}
+
 void XPUContext::CheckValidStreamId(int i) const {
   PADDLE_ENFORCE_GE(
       i,
@@ -63,6 +63,34 @@ class XPUContext : public DeviceContext,
   // For share external stream.
   void SetStream(void* stream, int i = 0);
 
+  // The copy-in and copy-out streams of the stream i, created on their first
+  // use, so that the copies between the host and the device overlap with the
+  // compute of the stream i.
+  XPUStream h2d_stream(int i = 0) const;
+  XPUStream d2h_stream(int i = 0) const;
+
+  // Copies count bytes from the host to the device on the copy-in stream, and
+  // makes the stream i wait for it. src is staged in a host buffer of the
+  // context, so it can be reused as soon as the call returns.
+  void MemcpyH2DAsync(void* dst,
+                      const void* src,
+                      size_t count,
+                      int i = 0) const;
+  // Copies count bytes from the device to the host on the copy-out stream,
+  // after the work queued on the stream i. dst is valid after WaitD2H.
+  void MemcpyD2HAsync(void* dst,
+                      const void* src,
+                      size_t count,
+                      int i = 0) const;
+  void WaitD2H(int i = 0) const;
+  // Copies count bytes on the stream i and waits for it, but not for the
+  // other streams of the device.
+  void MemcpyOnStream(void* dst,
+                      const void* src,
+                      size_t count,
+                      XPUMemcpyKind kind,
+                      int i = 0) const;
+
   // Wait for all operations completion in the stream.
   void Wait() const override;
 
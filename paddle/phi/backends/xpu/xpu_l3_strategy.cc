@@ -27,12 +27,28 @@ void XPUL3CacheBlock::Set(void* addr, size_t size) {
   size_ = size;
 }
 
+void XPUL3CacheBlock::RecordLiveRange(size_t first_use, size_t last_use) {
+  if (!has_live_range_) {
+    first_use_ = first_use;
+    last_use_ = last_use;
+    has_live_range_ = true;
+    return;
+  }
+  first_use_ = std::min(first_use_, first_use);
+  last_use_ = std::max(last_use_, last_use);
+}
+
 // return true means success, false means Autotune L3 fail
 bool XPUL3Planner::RunAutotune(
     const std::vector<XPUL3CacheBlock*>& l3_block_dict, size_t l3_size) {
   if (l3_block_dict.size() == 0 || l3_size <= 0 || !plan_.empty()) {
     return false;
   }
+  for (auto* block : l3_block_dict) {
+    if (block->has_live_range()) {
+      return RunLivenessAutotune(l3_block_dict, l3_size);
+    }
+  }
   VLOG(3) << "AutoTune XPU L3 Cache Block Start.";
   struct node {
     size_t weights = 0;
@@ -155,4 +171,123 @@ bool XPUL3Planner::RunAutotune(
   return true;
 }
 
+// Places the blocks by interval coloring: the blocks are visited by the
+// bytes they reuse per byte of L3, each one is given the largest size of its
+// history that fits at the lowest offset not used by the placed blocks whose
+// live ranges overlap its own. The blocks without live ranges are live
+// during the whole run and overlap all the others.
+bool XPUL3Planner::RunLivenessAutotune(
+    const std::vector<XPUL3CacheBlock*>& l3_block_dict, size_t l3_size) {
+  VLOG(3) << "AutoTune XPU L3 Cache Block by Liveness Start.";
+  auto aligned = [](size_t size) {
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+  };
+  struct Choice {
+    size_t size;
+    size_t score;
+  };
+  struct Candidate {
+    size_t block_idx;
+    // in descending order of the sizes
+    std::vector<Choice> choices;
+  };
+  std::vector<Candidate> candidates;
+  size_t total_scores = 0;
+  for (size_t block_idx = 0; block_idx < l3_block_dict.size(); block_idx++) {
+    std::vector<size_t>& history = l3_block_dict[block_idx]->history_;
+    if (history.size() <= 1) {
+      continue;
+    }
+    std::sort(history.begin(), history.end());
+    Candidate candidate{block_idx, {}};
+    size_t score = 0;
+    for (size_t i = 0; i < history.size(); i++) {
+      score += history[i];
+      if (aligned(history[i]) > l3_size) {
+        continue;
+      }
+      if (i == history.size() - 1 || history[i + 1] != history[i]) {
+        candidate.choices.push_back({history[i], score});
+      }
+    }
+    total_scores += score;
+    if (!candidate.choices.empty()) {
+      std::reverse(candidate.choices.begin(), candidate.choices.end());
+      candidates.push_back(std::move(candidate));
+    }
+  }
+  if (candidates.empty()) {
+    VLOG(3) << "No blocks to reuse!";
+    return false;
+  }
+  std::stable_sort(candidates.begin(),
+                   candidates.end(),
+                   [](const Candidate& a, const Candidate& b) {
+                     const Choice& x = a.choices.front();
+                     const Choice& y = b.choices.front();
+                     return static_cast<double>(x.score) / x.size >
+                            static_cast<double>(y.score) / y.size;
+                   });
+
+  struct Placement {
+    size_t offset;
+    size_t size;
+    size_t first_use;
+    size_t last_use;
+  };
+  std::vector<Placement> placements;
+  plan_.assign(l3_block_dict.size() + 1, 0);
+  offsets_.assign(l3_block_dict.size(), 0);
+  size_t peak = 0;
+  size_t l3_scores = 0;
+  for (auto& candidate : candidates) {
+    XPUL3CacheBlock* block = l3_block_dict[candidate.block_idx];
+    std::vector<const Placement*> conflicts;
+    for (auto& placement : placements) {
+      if (placement.first_use <= block->last_use() &&
+          block->first_use() <= placement.last_use) {
+        conflicts.push_back(&placement);
+      }
+    }
+    std::sort(conflicts.begin(),
+              conflicts.end(),
+              [](const Placement* a, const Placement* b) {
+                return a->offset < b->offset;
+              });
+    for (auto& choice : candidate.choices) {
+      size_t size = aligned(choice.size);
+      size_t offset = 0;
+      for (auto* conflict : conflicts) {
+        if (offset + size <= conflict->offset) {
+          break;
+        }
+        offset = std::max(offset, conflict->offset + conflict->size);
+      }
+      if (offset + size > l3_size) {
+        continue;
+      }
+      placements.push_back(
+          {offset, size, block->first_use(), block->last_use()});
+      plan_[candidate.block_idx] = choice.size;
+      offsets_[candidate.block_idx] = offset;
+      peak = std::max(peak, offset + size);
+      l3_scores += choice.score;
+      VLOG(3) << "BLOCK IDX is " << candidate.block_idx
+              << ", Acquired L3 Size is " << choice.size << " at offset "
+              << offset << ", live in [" << block->first_use() << ", "
+              << block->last_use() << "]";
+      break;
+    }
+  }
+  VLOG(3) << "Tensor Space in L3 / Tensor Space in Global :"
+          << static_cast<double>(l3_scores) / total_scores * 100 << " %";
+
+  size_t xdnn_ctx_l3_size = (l3_size - peak) / kAlignment * kAlignment;
+  VLOG(3) << "Block L3 Size : " << peak
+          << ", XDNN Ctx L3 Size : " << xdnn_ctx_l3_size;
+  plan_[l3_block_dict.size()] = xdnn_ctx_l3_size;
+  VLOG(3) << "AutoTune XPU L3 Cache Block by Liveness End.";
+  return true;
+}
+
 }  // namespace phi
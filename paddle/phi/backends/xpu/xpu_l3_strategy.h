@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 #include <algorithm>
+#include <limits>
 #include <numeric>
 #include <vector>
 
@@ -25,15 +26,28 @@ struct XPUL3CacheBlock {
     addr_ = nullptr;
     size_ = 0;
     history_.clear();
+    first_use_ = 0;
+    last_use_ = std::numeric_limits<size_t>::max();
+    has_live_range_ = false;
   }
   void Set(void* addr, size_t size);
   void Record(size_t size) { history_.push_back(size); }
+  // Records that the block is accessed by the instructions in [first_use,
+  // last_use] of the execution order. A block without any recorded range is
+  // live during the whole run.
+  void RecordLiveRange(size_t first_use, size_t last_use);
   void* data() { return addr_; }
   size_t size() { return size_; }
+  bool has_live_range() const { return has_live_range_; }
+  size_t first_use() const { return first_use_; }
+  size_t last_use() const { return last_use_; }
 
  private:
   void* addr_{nullptr};
   size_t size_{0};
+  size_t first_use_{0};
+  size_t last_use_{std::numeric_limits<size_t>::max()};
+  bool has_live_range_{false};
 
  public:
   std::vector<size_t> history_;
@@ -41,13 +55,26 @@ struct XPUL3CacheBlock {
 
 class XPUL3Planner {
  public:
+  static constexpr size_t kAlignment = 64;
+
+  // plans the L3 sizes of the blocks, the blocks whose live ranges are known
+  // share the L3 space when their live ranges do not overlap
   bool RunAutotune(const std::vector<XPUL3CacheBlock*>& l3_block_dict,
                    size_t l3_size);
 
+  // the L3 sizes of the blocks, followed by the L3 size left to xdnn
   std::vector<size_t>* plan() { return &plan_; }
 
+  // the offsets of the blocks in L3, empty when the blocks are placed one
+  // after another
+  std::vector<size_t>* offsets() { return &offsets_; }
+
  private:
+  bool RunLivenessAutotune(const std::vector<XPUL3CacheBlock*>& l3_block_dict,
+                           size_t l3_size);
+
   std::vector<size_t> plan_;
+  std::vector<size_t> offsets_;
 };
 
 }  // namespace phi
@@ -94,6 +94,14 @@ DenseTensor& ShareDataNoCheckWith(const DenseTensor& src);
 /*! The internal of two tensors share the same inplace version counter. */
 DenseTensor& ShareInplaceVersionCounterWith(const DenseTensor& src);
 
+/*! Makes the tensor a view of src with the dims, strides and offset, which
+ * shares the memory block and the inplace version counter of src. The rest
+ * of the meta, e.g. the dtype set by InferMeta, is kept. */
+DenseTensor& ShareStridedViewWith(const DenseTensor& src,
+                                  const DDim& dims,
+                                  const DDim& strides,
+                                  size_t offset);
+
 DenseTensor Slice(int64_t begin_idx, int64_t end_idx) const;
 
 std::vector<DenseTensor> Split(int64_t split_size, int64_t axis) const;
@@ -440,4 +440,15 @@ DenseTensor& DenseTensor::ShareInplaceVersionCounterWith(
   inplace_version_counter_ = src.inplace_version_counter_;
   return *this;
 }
+
+DenseTensor& DenseTensor::ShareStridedViewWith(const DenseTensor& src,
+                                               const DDim& dims,
+                                               const DDim& strides,
+                                               size_t offset) {
+  meta_.dims = dims;
+  meta_.strides = strides;
+  meta_.offset = offset;
+  holder_ = src.holder_;
+  return ShareInplaceVersionCounterWith(src);
+}
 }  // namespace phi
@@ -15,6 +15,7 @@
 #include "paddle/phi/core/distributed/auto_parallel/reshard/nd_mesh_reshard_function.h"
 
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
 #include "paddle/phi/common/int_array.h"
 #include "paddle/phi/core/distributed/auto_parallel/dist_attr.h"
 #include "paddle/phi/core/distributed/auto_parallel/dist_tensor.h"
@@ -22,11 +23,15 @@
 #include "paddle/phi/core/distributed/auto_parallel/reshard/p_to_s_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/r_to_p_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/r_to_s_reshard_function.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_planner.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_utils.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/s_to_r_reshard_function.h"
+#include "paddle/phi/core/distributed/auto_parallel/reshard/s_to_s_reshard_function.h"
 #include "paddle/phi/core/distributed/auto_parallel/reshard/same_status_reshard_function.h"
 #include "paddle/phi/core/distributed/store/store_utils.h"
 
+COMMON_DECLARE_bool(reshard_use_planner);
+
 namespace phi::distributed {
 
 namespace {
@@ -73,6 +78,48 @@ int64_t FindFirstDiffShardAxis(const TensorDistAttr& in_dist_attr,
   return axis;
 }
 
+// The 1-D dist attr of the placement of dist_attr on the mesh axis, for the
+// dims of the tensor seen by the sub mesh of that axis.
+TensorDistAttr GetOneDimDistAttr(const TensorDistAttr& dist_attr,
+                                 int64_t mesh_axis,
+                                 const std::vector<int64_t>& dims,
+                                 const ProcessMesh& sub_mesh) {
+  TensorDistAttr one_dim_dist_attr(dims);
+  one_dim_dist_attr.set_process_mesh(sub_mesh);
+  std::vector<int64_t> dims_mapping = one_dim_dist_attr.dims_mapping();
+  for (size_t i = 0; i < dims_mapping.size(); ++i) {
+    if (dist_attr.dims_mapping()[i] == mesh_axis) {
+      dims_mapping[i] = 0;
+    }
+  }
+  one_dim_dist_attr.set_dims_mapping(dims_mapping);
+  if (dist_attr.is_partial(mesh_axis)) {
+    one_dim_dist_attr.set_partial_status(
+        std::vector<int64_t>{0}, dist_attr.partial_status().at(mesh_axis));
+  }
+  return one_dim_dist_attr;
+}
+
+std::unique_ptr<ReshardFunction> GetStepReshardFunction(
+    ReshardStep::Kind kind) {
+  switch (kind) {
+    case ReshardStep::kPToR:
+      return std::make_unique<PToRReshardFunction>();
+    case ReshardStep::kPToS:
+      return std::make_unique<PToSReshardFunction>();
+    case ReshardStep::kSToR:
+      return std::make_unique<SToRReshardFunction>();
+    case ReshardStep::kSToS:
+      return std::make_unique<SToSReshardFunction>();
+    case ReshardStep::kRToS:
+      return std::make_unique<RToSReshardFunction>();
+    case ReshardStep::kRToP:
+      return std::make_unique<RToPReshardFunction>();
+  }
+  PADDLE_THROW(phi::errors::InvalidArgument(
+      "Unknown reshard step %d.", static_cast<int>(kind)));
+}
+
 }  // namespace
 
 bool SameNdMeshReshardFunction::IsSuitable(
@@ -95,6 +142,15 @@ void SameNdMeshReshardFunction::Eval(phi::DeviceContext* dev_ctx,
   const auto& in_dist_attr = in.dist_attr();
   const auto& process_mesh = out_dist_attr.process_mesh();
 
+  if (FLAGS_reshard_use_planner) {
+    const ReshardPlan* plan = ReshardPlanner::Instance().GetPlan(
+        in.dims(), in.dtype(), in_dist_attr, out_dist_attr);
+    if (plan != nullptr) {
+      EvalPlan(dev_ctx, *plan, in, out);
+      return;
+    }
+  }
+
   int64_t first_diff_axis = FindFirstDiffShardAxis(in_dist_attr, out_dist_attr);
 
   // Backup out_dist_attr to to avoid overwriting the out's dist attr
@@ -272,6 +328,48 @@ void SameNdMeshReshardFunction::Eval(phi::DeviceContext* dev_ctx,
   }
 }
 
+void SameNdMeshReshardFunction::EvalPlan(DeviceContext* dev_ctx,
+                                         const ReshardPlan& plan,
+                                         const DistTensor& in,
+                                         DistTensor* out) {
+  const auto& process_mesh = in.dist_attr().process_mesh();
+
+  SetValue(out, in.value());
+  SetDistProps(out, in.dims(), in.dist_attr());
+
+  for (const auto& step : plan.steps) {
+    VLOG(3) << "Plan step: " << ReshardStepName(step.kind) << " on mesh axis "
+            << step.mesh_axis;
+    // Copy the dist attr of out, which is reset below
+    const TensorDistAttr cur_dist_attr(out->dist_attr());
+
+    // 1. Calculate the dims of the tensor seen by the sub mesh, the dims
+    // sharded on the other mesh axes are local
+    std::vector<int64_t> sub_dims = common::vectorize(in.dims());
+    const auto& dims_mapping = cur_dist_attr.dims_mapping();
+    for (size_t i = 0; i < dims_mapping.size(); ++i) {
+      if (dims_mapping[i] != -1 && dims_mapping[i] != step.mesh_axis) {
+        sub_dims[i] /= process_mesh.dim_size(dims_mapping[i]);
+      }
+    }
+
+    // 2. Calculate the input and output one dim dist attr on the sub mesh
+    ProcessMesh sub_mesh = GetSubProcessMesh(process_mesh, step.mesh_axis);
+    TensorDistAttr in_one_dim_dist_attr =
+        GetOneDimDistAttr(cur_dist_attr, step.mesh_axis, sub_dims, sub_mesh);
+    TensorDistAttr out_one_dim_dist_attr =
+        GetOneDimDistAttr(step.dist_attr, step.mesh_axis, sub_dims, sub_mesh);
+
+    // 3. Run the step and reset to the right dist attr
+    SetDistProps(out, common::make_ddim(sub_dims), in_one_dim_dist_attr);
+    DistTensor tmp_result;
+    GetStepReshardFunction(step.kind)
+        ->Eval(dev_ctx, *out, out_one_dim_dist_attr, &tmp_result);
+    SetValue(out, tmp_result.value());
+    SetDistProps(out, in.dims(), step.dist_attr);
+  }
+}
+
 bool CrossNdMeshReshardFunction::IsSuitable(
     const DistTensor& in, const TensorDistAttr& out_dist_attr) {
   const ProcessMesh& in_process_mesh = in.dist_attr().process_mesh();
@@ -19,6 +19,8 @@
 namespace phi {
 namespace distributed {
 
+struct ReshardPlan;
+
 class SameNdMeshReshardFunction final : public ReshardFunction {
  public:
   bool IsSuitable(const DistTensor& in,
@@ -30,6 +32,12 @@ class SameNdMeshReshardFunction final : public ReshardFunction {
             DistTensor* out) override;
 
   std::string Name() override { return "SameNdMeshReshard"; }
+
+ private:
+  void EvalPlan(DeviceContext* dev_ctx,
+                const ReshardPlan& plan,
+                const DistTensor& in,
+                DistTensor* out);
 };
 
 class CrossNdMeshReshardFunction final : public ReshardFunction {
@@ -0,0 +1,379 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_planner.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+
+COMMON_DECLARE_string(reshard_mesh_bandwidth);
+
+namespace phi::distributed {
+
+using phi::distributed::auto_parallel::str_join;
+
+namespace {
+
+// The placement of a tensor on each axis of its mesh: kReplicated, the tensor
+// dim it is sharded on, or kPartial - reduce type.
+using AxisStates = std::vector<int64_t>;
+
+constexpr int64_t kReplicated = -1;
+constexpr int64_t kPartial = -2;
+
+bool IsShard(int64_t state) { return state >= 0; }
+
+bool IsPartial(int64_t state) { return state <= kPartial; }
+
+int64_t PartialState(ReduceType type) {
+  return kPartial - static_cast<int64_t>(type);
+}
+
+ReduceType PartialType(int64_t state) {
+  return static_cast<ReduceType>(kPartial - state);
+}
+
+AxisStates GetAxisStates(const TensorDistAttr& dist_attr) {
+  AxisStates states(dist_attr.process_mesh().ndim(), kReplicated);
+  const auto& dims_mapping = dist_attr.dims_mapping();
+  for (size_t i = 0; i < dims_mapping.size(); ++i) {
+    if (dims_mapping[i] != -1) {
+      states[dims_mapping[i]] = static_cast<int64_t>(i);
+    }
+  }
+  for (const auto& kv : dist_attr.partial_status()) {
+    states[kv.first] = PartialState(kv.second);
+  }
+  return states;
+}
+
+TensorDistAttr GetDistAttr(const AxisStates& states,
+                           const TensorDistAttr& like) {
+  TensorDistAttr dist_attr(like);
+  std::vector<int64_t> dims_mapping(like.dims_mapping().size(), -1);
+  for (size_t axis = 0; axis < states.size(); ++axis) {
+    if (IsShard(states[axis])) {
+      dims_mapping[states[axis]] = static_cast<int64_t>(axis);
+    }
+  }
+  dist_attr.set_dims_mapping(dims_mapping);
+  dist_attr.clean_partial_status();
+  for (size_t axis = 0; axis < states.size(); ++axis) {
+    if (IsPartial(states[axis])) {
+      dist_attr.set_partial_status(
+          std::vector<int64_t>{static_cast<int64_t>(axis)},
+          PartialType(states[axis]));
+    }
+  }
+  return dist_attr;
+}
+
+class CostModel {
+ public:
+  CostModel(const std::vector<int64_t>& dims,
+            int64_t dtype_size,
+            const std::vector<int64_t>& mesh_shape,
+            const std::vector<double>& bandwidths)
+      : mesh_shape_(mesh_shape), bandwidths_(bandwidths) {
+    bytes_ = static_cast<double>(dtype_size);
+    for (int64_t dim : dims) {
+      bytes_ *= static_cast<double>(dim);
+    }
+  }
+
+  // the bytes of the local tensor of each rank
+  double LocalBytes(const AxisStates& states) const {
+    double bytes = bytes_;
+    for (size_t axis = 0; axis < states.size(); ++axis) {
+      if (IsShard(states[axis])) {
+        bytes /= static_cast<double>(mesh_shape_[axis]);
+      }
+    }
+    return bytes;
+  }
+
+  // the bytes each rank sends in the step over the bandwidth of its axis
+  double StepCost(const AxisStates& states,
+                  ReshardStep::Kind kind,
+                  int64_t mesh_axis) const {
+    double local_bytes = LocalBytes(states);
+    double n = static_cast<double>(mesh_shape_[mesh_axis]);
+    double bytes = 0.;
+    switch (kind) {
+      case ReshardStep::kSToR:
+        bytes = local_bytes * (n - 1);
+        break;
+      case ReshardStep::kPToR:
+        bytes = 2 * local_bytes * (n - 1) / n;
+        break;
+      case ReshardStep::kPToS:
+      case ReshardStep::kSToS:
+        bytes = local_bytes * (n - 1) / n;
+        break;
+      case ReshardStep::kRToS:
+      case ReshardStep::kRToP:
+        break;
+    }
+    return bytes / bandwidths_[mesh_axis];
+  }
+
+ private:
+  double bytes_;
+  std::vector<int64_t> mesh_shape_;
+  std::vector<double> bandwidths_;
+};
+
+// The cost of the steps SameNdMeshReshardFunction runs: the partial axes,
+// then the sharded dims up to the last different one, are all reduced and
+// all gathered to replicated, and then partial and sliced again.
+double GetSameNdMeshCost(const TensorDistAttr& in_dist_attr,
+                         const TensorDistAttr& out_dist_attr,
+                         const CostModel& cost_model) {
+  const auto& in_dims_mapping = in_dist_attr.dims_mapping();
+  const auto& out_dims_mapping = out_dist_attr.dims_mapping();
+  AxisStates states = GetAxisStates(in_dist_attr);
+  AxisStates out_states = GetAxisStates(out_dist_attr);
+  int64_t first_diff_axis = -1;
+  for (int64_t i = static_cast<int64_t>(in_dims_mapping.size()) - 1; i >= 0;
+       --i) {
+    if (in_dims_mapping[i] != out_dims_mapping[i]) {
+      first_diff_axis = i;
+      break;
+    }
+  }
+
+  double cost = 0.;
+  for (size_t axis = 0; axis < states.size(); ++axis) {
+    if (IsPartial(states[axis]) && !IsPartial(out_states[axis]) &&
+        !IsShard(out_states[axis])) {
+      cost += cost_model.StepCost(states, ReshardStep::kPToR, axis);
+      states[axis] = kReplicated;
+    }
+  }
+  for (int64_t i = first_diff_axis; i >= 0; --i) {
+    if (in_dims_mapping[i] != -1) {
+      cost += cost_model.StepCost(
+          states, ReshardStep::kSToR, in_dims_mapping[i]);
+      states[in_dims_mapping[i]] = kReplicated;
+    }
+  }
+  for (int64_t i = first_diff_axis; i >= 0; --i) {
+    int64_t axis = out_dims_mapping[i];
+    if (axis != -1 && IsPartial(states[axis])) {
+      cost += cost_model.StepCost(states, ReshardStep::kPToS, axis);
+    }
+    if (axis != -1) {
+      states[axis] = i;
+    }
+  }
+  return cost;
+}
+
+}  // namespace
+
+const char* ReshardStepName(ReshardStep::Kind kind) {
+  static const char* names[] = {"p_to_r", "p_to_s", "s_to_r", "s_to_s",
+                                "r_to_s", "r_to_p"};
+  return names[kind];
+}
+
+std::shared_ptr<ReshardPlan> SearchReshardPlan(
+    const std::vector<int64_t>& dims,
+    int64_t dtype_size,
+    const TensorDistAttr& in_dist_attr,
+    const TensorDistAttr& out_dist_attr,
+    const std::vector<double>& bandwidths) {
+  const auto& mesh_shape = in_dist_attr.process_mesh().shape();
+  const AxisStates in_states = GetAxisStates(in_dist_attr);
+  const AxisStates out_states = GetAxisStates(out_dist_attr);
+  if (in_states == out_states ||
+      std::any_of(dims.begin(), dims.end(), [](int64_t dim) {
+        return dim < 0;
+      })) {
+    return nullptr;
+  }
+
+  // The 1-D reshard functions see the dims of the local tensor on the other
+  // mesh axes, which are exact only for the balanced shards.
+  auto is_balanced = [&](int64_t dim, int64_t mesh_axis) {
+    return dims[dim] % mesh_shape[mesh_axis] == 0;
+  };
+  for (size_t axis = 0; axis < mesh_shape.size(); ++axis) {
+    if ((IsShard(in_states[axis]) && !is_balanced(in_states[axis], axis)) ||
+        (IsShard(out_states[axis]) && !is_balanced(out_states[axis], axis))) {
+      return nullptr;
+    }
+  }
+
+  CostModel cost_model(dims, dtype_size, mesh_shape, bandwidths);
+  auto for_each_step = [&](const AxisStates& states,
+                           const std::function<void(ReshardStep::Kind,
+                                                    int64_t,
+                                                    const AxisStates&)>& fn) {
+    std::vector<bool> is_sharded(dims.size(), false);
+    for (int64_t state : states) {
+      if (IsShard(state)) {
+        is_sharded[state] = true;
+      }
+    }
+    for (int64_t axis = 0; axis < static_cast<int64_t>(states.size());
+         ++axis) {
+      AxisStates next = states;
+      int64_t state = states[axis];
+      auto for_each_free_dim = [&](ReshardStep::Kind kind) {
+        for (int64_t dim = 0; dim < static_cast<int64_t>(dims.size()); ++dim) {
+          if (!is_sharded[dim] && is_balanced(dim, axis)) {
+            next[axis] = dim;
+            fn(kind, axis, next);
+          }
+        }
+      };
+      if (IsPartial(state)) {
+        next[axis] = kReplicated;
+        fn(ReshardStep::kPToR, axis, next);
+        for_each_free_dim(ReshardStep::kPToS);
+      } else if (IsShard(state)) {
+        next[axis] = kReplicated;
+        fn(ReshardStep::kSToR, axis, next);
+        for_each_free_dim(ReshardStep::kSToS);
+      } else {
+        for_each_free_dim(ReshardStep::kRToS);
+        if (IsPartial(out_states[axis])) {
+          next[axis] = out_states[axis];
+          fn(ReshardStep::kRToP, axis, next);
+        }
+      }
+    }
+  };
+
+  // Dijkstra on the placements, the fewer steps win the ties.
+  using Distance = std::pair<double, size_t>;
+  using Node = std::pair<Distance, AxisStates>;
+  struct Hop {
+    AxisStates from;
+    ReshardStep::Kind kind;
+    int64_t mesh_axis;
+  };
+  std::map<AxisStates, Distance> distances;
+  std::map<AxisStates, Hop> hops;
+  std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+  distances[in_states] = Distance(0., 0);
+  queue.emplace(Distance(0., 0), in_states);
+  while (!queue.empty()) {
+    auto [distance, states] = queue.top();
+    queue.pop();
+    if (states == out_states) {
+      break;
+    }
+    if (distances[states] < distance) {
+      continue;
+    }
+    auto relax = [&](ReshardStep::Kind kind,
+                     int64_t mesh_axis,
+                     const AxisStates& next) {
+      Distance next_distance(
+          distance.first + cost_model.StepCost(states, kind, mesh_axis),
+          distance.second + 1);
+      auto iter = distances.find(next);
+      if (iter == distances.end() || next_distance < iter->second) {
+        distances[next] = next_distance;
+        hops[next] = Hop{states, kind, mesh_axis};
+        queue.emplace(next_distance, next);
+      }
+    };
+    for_each_step(states, relax);
+  }
+
+  auto iter = distances.find(out_states);
+  if (iter == distances.end()) {
+    return nullptr;
+  }
+  double same_nd_mesh_cost =
+      GetSameNdMeshCost(in_dist_attr, out_dist_attr, cost_model);
+  VLOG(4) << "Reshard from " << in_dist_attr << " to " << out_dist_attr
+          << ", cost of the plan: " << iter->second.first
+          << ", cost of the same nd mesh reshard: " << same_nd_mesh_cost;
+  if (iter->second.first >= same_nd_mesh_cost) {
+    return nullptr;
+  }
+
+  auto plan = std::make_shared<ReshardPlan>();
+  plan->cost = iter->second.first;
+  for (AxisStates states = out_states; states != in_states;) {
+    const Hop& hop = hops.at(states);
+    plan->steps.push_back(ReshardStep{
+        hop.kind, hop.mesh_axis, GetDistAttr(states, in_dist_attr)});
+    states = hop.from;
+  }
+  std::reverse(plan->steps.begin(), plan->steps.end());
+  plan->steps.back().dist_attr = out_dist_attr;
+  return plan;
+}
+
+ReshardPlanner& ReshardPlanner::Instance() {
+  static ReshardPlanner planner;
+  return planner;
+}
+
+const ReshardPlan* ReshardPlanner::GetPlan(
+    const DDim& dims,
+    DataType dtype,
+    const TensorDistAttr& in_dist_attr,
+    const TensorDistAttr& out_dist_attr) {
+  const std::vector<int64_t> dims_vec = common::vectorize(dims);
+  std::string key = in_dist_attr.process_mesh().to_string() + "/" +
+                    str_join(dims_vec) + "/" +
+                    std::to_string(static_cast<int>(dtype)) + "/" +
+                    str_join(GetAxisStates(in_dist_attr)) + "/" +
+                    str_join(GetAxisStates(out_dist_attr)) + "/" +
+                    FLAGS_reshard_mesh_bandwidth;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = plans_.find(key);
+  if (iter != plans_.end()) {
+    return iter->second.get();
+  }
+
+  // The bandwidths of the mesh axes, the axes after the last given one have
+  // its bandwidth.
+  std::vector<double> bandwidths;
+  std::stringstream ss(FLAGS_reshard_mesh_bandwidth);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    bandwidths.push_back(std::stod(item));
+    PADDLE_ENFORCE_GT(bandwidths.back(),
+                      0.,
+                      phi::errors::InvalidArgument(
+                          "The bandwidths of FLAGS_reshard_mesh_bandwidth "
+                          "should be positive, but got %s.",
+                          FLAGS_reshard_mesh_bandwidth));
+  }
+  bandwidths.resize(in_dist_attr.process_mesh().ndim(),
+                    bandwidths.empty() ? 1. : bandwidths.back());
+
+  auto plan = SearchReshardPlan(dims_vec,
+                                static_cast<int64_t>(phi::SizeOf(dtype)),
+                                in_dist_attr,
+                                out_dist_attr,
+                                bandwidths);
+  return plans_.emplace(key, plan).first->second.get();
+}
+
+}  // namespace phi::distributed
@@ -0,0 +1,84 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/ddim.h"
+#include "paddle/phi/core/distributed/auto_parallel/dist_attr.h"
+#include "paddle/utils/test_macros.h"
+
+namespace phi {
+namespace distributed {
+
+// A step of a reshard plan changes the placement of a tensor on one axis of
+// its nd mesh, by the 1-D reshard function on the sub mesh of that axis.
+struct ReshardStep {
+  enum Kind { kPToR, kPToS, kSToR, kSToS, kRToS, kRToP };
+
+  Kind kind;
+  int64_t mesh_axis;
+  // the nd dist attr of the tensor after this step
+  TensorDistAttr dist_attr;
+};
+
+const char* ReshardStepName(ReshardStep::Kind kind);
+
+struct ReshardPlan {
+  std::vector<ReshardStep> steps;
+  // the estimated time of the communications, in bytes / bandwidth
+  double cost{0.};
+};
+
+// The cheapest sequence of the steps from in_dist_attr to out_dist_attr on the
+// same nd mesh, for a tensor of the global dims and the dtype size, with the
+// bandwidths of the mesh axes. A step costs the bytes its collective sends per
+// rank over the bandwidth of its axis, so the plans slice the tensor before
+// gathering it, use an all_to_all rather than an all_gather and a slice, etc.
+// Returns nullptr if the shards are unbalanced, which the steps don't handle,
+// or if no plan is cheaper than the one of SameNdMeshReshardFunction.
+TEST_API std::shared_ptr<ReshardPlan> SearchReshardPlan(
+    const std::vector<int64_t>& dims,
+    int64_t dtype_size,
+    const TensorDistAttr& in_dist_attr,
+    const TensorDistAttr& out_dist_attr,
+    const std::vector<double>& bandwidths);
+
+// The plans are searched once per (in_dist_attr, out_dist_attr, dims, dtype),
+// the bandwidths are set by FLAGS_reshard_mesh_bandwidth.
+class ReshardPlanner {
+ public:
+  static ReshardPlanner& Instance();
+
+  const ReshardPlan* GetPlan(const DDim& dims,
+                             DataType dtype,
+                             const TensorDistAttr& in_dist_attr,
+                             const TensorDistAttr& out_dist_attr);
+
+ private:
+  ReshardPlanner() = default;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<ReshardPlan>> plans_;
+};
+
+}  // namespace distributed
+}  // namespace phi
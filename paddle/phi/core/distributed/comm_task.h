@@ -149,6 +149,12 @@ class CommTask {
         phi::errors::Unimplemented("%s is not implemented.", __func__));
     return;
   }
+  // the time of the completed task on the device, negative if not timed
+  virtual float GetElapsedMillis() {
+    PADDLE_THROW(
+        phi::errors::Unimplemented("%s is not implemented.", __func__));
+    return -1;
+  }
 
  protected:
   std::string backend_;
@@ -22,12 +22,19 @@
 
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <future>
+#include <map>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "gflags/gflags.h"
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/core/distributed/store/store.h"
 #include "paddle/phi/core/enforce.h"
@@ -37,6 +44,8 @@
 #include "paddle/phi/core/distributed/nccl_comm_context.h"
 #endif
 
+COMMON_DECLARE_int32(comm_flight_recorder_size);
+
 namespace phi {
 namespace distributed {
 
@@ -162,6 +171,9 @@ void CommTaskManager::CommTaskLoop() {
           LogLongStr("Find last group comm task:", iter.second->GetTraceMsg());
         }
       }
+      if (FLAGS_comm_flight_recorder_size > 0) {
+        LogLongStr("Comm flight record:", DumpFlightRecord());
+      }
       logged_ = true;
     }
     for (auto iter = comm_task_list_.begin(); iter != comm_task_list_.end();) {
@@ -182,6 +194,7 @@ void CommTaskManager::CommTaskLoop() {
       } else {
         if (task->IsStarted()) {
           if (task->IsCompleted()) {
+            RecordFlight(task);
             CommTaskClearEnqueue(task);
             iter = comm_task_list_.erase(iter);
           } else {
@@ -211,6 +224,7 @@ void CommTaskManager::CommTaskLoop() {
          iter != start_comm_task_map_.end();) {
       auto task = iter->second;
       if (task->IsCompleted()) {
+        RecordFlight(task);
         CommTaskClearEnqueue(task);
         UpdateLastCommTask(task);
         iter = start_comm_task_map_.erase(iter);
@@ -276,5 +290,187 @@ bool CommTaskManager::IsTimeout() {
   return std::chrono::duration_cast<std::chrono::milliseconds>(
              current_timepoint - last_update_time_) >= timeout_;
 }
+
+void CommTaskManager::RecordFlight(std::shared_ptr<CommTask> task) {
+  if (FLAGS_comm_flight_recorder_size <= 0) {
+    return;
+  }
+  auto enqueue_time =
+      std::chrono::system_clock::now() -
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::steady_clock::now() - task->GetStartTime());
+  CommFlightRecord record{
+      task->GroupKey(),
+      task->GetCommType(),
+      task->GetSeq(),
+      task->GetNumel(),
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          enqueue_time.time_since_epoch())
+          .count(),
+      task->GetElapsedMillis()};
+
+  std::lock_guard<std::mutex> lock(flight_record_mutex_);
+  if (store_ == nullptr) {
+    store_ = task->GetStore();
+  }
+  flight_record_.emplace_back(std::move(record));
+  while (flight_record_.size() >
+         static_cast<size_t>(FLAGS_comm_flight_recorder_size)) {
+    flight_record_.pop_front();
+  }
+}
+
+std::string CommTaskManager::DumpFlightRecord() {
+  std::lock_guard<std::mutex> lock(flight_record_mutex_);
+  std::stringstream ss;
+  for (const auto& record : flight_record_) {
+    ss << "group_key:" << record.group_key
+       << ",op:" << CommTypeToString(record.comm_type)
+       << ",comm_count:" << record.seq << ",numel:" << record.numel
+       << ",enqueue_time_us:" << record.enqueue_time_us
+       << ",elapsed_ms:" << record.elapsed_ms << "\n";
+  }
+  return ss.str();
+}
+
+std::string CommTaskManager::AggregateFlightRecord() {
+  std::vector<CommFlightRecord> records;
+  std::shared_ptr<Store> store;
+  int round = 0;
+  {
+    std::lock_guard<std::mutex> lock(flight_record_mutex_);
+    records.assign(flight_record_.begin(), flight_record_.end());
+    store = store_;
+    round = flight_record_round_++;
+  }
+  // the store is set by the first recorded task, a rank without it has no
+  // collective to report
+  if (store == nullptr) {
+    return "The comm flight record is empty.";
+  }
+  const char* global_rank = std::getenv("PADDLE_TRAINER_ID");
+  PADDLE_ENFORCE_NOT_NULL(
+      global_rank,
+      phi::errors::NotFound(
+          "The environment variable 'PADDLE_TRAINER_ID' cannot be found."));
+
+  // 1. Exchange the records with the ranks of the groups of this one
+  const std::string prefix =
+      "comm_flight_record/" + std::to_string(round) + "/";
+  std::stringstream local;
+  std::vector<int> ranks = {std::atoi(global_rank)};
+  for (const auto& record : records) {
+    local << record.group_key << "\t" << static_cast<int>(record.comm_type)
+          << "\t" << record.seq << "\t" << record.numel << "\t"
+          << record.elapsed_ms << "\n";
+    for (int rank :
+         CommContextManager::GetInstance().GetGroupRanks(record.group_key)) {
+      ranks.push_back(rank);
+    }
+  }
+  std::sort(ranks.begin(), ranks.end());
+  ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+  const std::string local_str = local.str();
+  store->set(prefix + global_rank,
+             std::vector<uint8_t>(local_str.begin(), local_str.end()));
+  std::vector<std::string> keys;
+  for (int rank : ranks) {
+    keys.push_back(prefix + std::to_string(rank));
+  }
+  const auto values = store->multi_get(keys);
+
+  // 2. Match the collectives of the ranks
+  struct Collective {
+    CommType comm_type;
+    int64_t numel;
+    std::vector<std::pair<int, float>> elapsed;
+  };
+  std::map<std::pair<std::string, uint64_t>, Collective> collectives;
+  for (size_t i = 0; i < ranks.size(); ++i) {
+    std::stringstream ss(std::string(values[i].begin(), values[i].end()));
+    std::string group_key;
+    int comm_type = 0;
+    uint64_t seq = 0;
+    int64_t numel = 0;
+    float elapsed_ms = 0;
+    while (std::getline(ss, group_key, '\t') && ss >> comm_type >> seq >>
+                                                      numel >> elapsed_ms) {
+      ss.ignore();
+      if (elapsed_ms < 0 || IsP2POP(static_cast<CommType>(comm_type))) {
+        continue;
+      }
+      auto& collective = collectives[std::make_pair(group_key, seq)];
+      collective.comm_type = static_cast<CommType>(comm_type);
+      collective.numel = numel;
+      collective.elapsed.emplace_back(ranks[i], elapsed_ms);
+    }
+  }
+
+  // 3. The last rank to arrive at a collective waits the least in it, the
+  // time of the collective is the one of that rank
+  std::map<int, std::pair<int, double>> late_ranks;  // count, lateness
+  std::map<CommType, std::tuple<int, double, double>> ops;  // count, ms, numel
+  int num_collectives = 0;
+  for (const auto& iter : collectives) {
+    const auto& elapsed = iter.second.elapsed;
+    if (elapsed.size() < 2) {
+      continue;
+    }
+    auto [min_iter, max_iter] = std::minmax_element(
+        elapsed.begin(), elapsed.end(), [](const auto& a, const auto& b) {
+          return a.second < b.second;
+        });
+    auto& late_rank = late_ranks[min_iter->first];
+    ++late_rank.first;
+    late_rank.second += max_iter->second - min_iter->second;
+    auto& op = ops[iter.second.comm_type];
+    ++std::get<0>(op);
+    std::get<1>(op) += min_iter->second;
+    std::get<2>(op) += static_cast<double>(iter.second.numel);
+    ++num_collectives;
+  }
+  if (num_collectives == 0) {
+    return "No collective of the comm flight record is matched.";
+  }
+
+  std::vector<std::pair<int, std::pair<int, double>>> sorted_ranks(
+      late_ranks.begin(), late_ranks.end());
+  std::sort(sorted_ranks.begin(),
+            sorted_ranks.end(),
+            [](const auto& a, const auto& b) {
+              return a.second.first > b.second.first;
+            });
+  std::vector<std::pair<CommType, std::tuple<int, double, double>>> sorted_ops(
+      ops.begin(), ops.end());
+  std::sort(
+      sorted_ops.begin(), sorted_ops.end(), [](const auto& a, const auto& b) {
+        return std::get<1>(a.second) / std::get<0>(a.second) >
+               std::get<1>(b.second) / std::get<0>(b.second);
+      });
+
+  std::stringstream report;
+  report << "Comm flight record of " << num_collectives
+         << " collectives on ranks " << VectorToString(ranks) << "\n";
+  const size_t kMaxReportedRanks = 5;
+  for (size_t i = 0; i < std::min(sorted_ranks.size(), kMaxReportedRanks);
+       ++i) {
+    const auto& late = sorted_ranks[i].second;
+    report << "rank " << sorted_ranks[i].first << " is the last to arrive at "
+           << late.first << " collectives, the others wait for it "
+           << late.second / late.first << " ms on average\n";
+  }
+  for (const auto& op : sorted_ops) {
+    int count = std::get<0>(op.second);
+    report << "op " << CommTypeToString(op.first) << ": " << count
+           << " collectives, " << std::get<1>(op.second) / count
+           << " ms and numel " << std::get<2>(op.second) / count
+           << " on average\n";
+  }
+  if (sorted_ranks.front().second.first * 2 > num_collectives) {
+    report << "rank " << sorted_ranks.front().first
+           << " is the straggler of the collectives\n";
+  }
+  return report.str();
+}
 }  // namespace distributed
 }  // namespace phi
@@ -16,6 +16,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <iostream>
 #include <list>
 #include <memory>
@@ -34,6 +35,19 @@ enum ErrorHandlingMode { NoHandling = 0, TearDown = 1 };
 
 class Store;
 
+// A collective of the comm flight record.
+struct CommFlightRecord {
+  std::string group_key;
+  CommType comm_type;
+  uint64_t seq;
+  int64_t numel;
+  // the time the task was enqueued, in microseconds since the epoch
+  int64_t enqueue_time_us;
+  // the time of the task on the device, which includes the wait for the
+  // other ranks, so the last rank to arrive has the shortest one
+  float elapsed_ms;
+};
+
 class CommTaskManager {
  public:
   CommTaskManager();
@@ -51,10 +65,19 @@ class CommTaskManager {
   void UpdateLastCommTask(std::shared_ptr<CommTask> comm_task);
   void SetTimeout(int64_t timeout);
 
+  // The recent collectives of this rank, one per line.
+  std::string DumpFlightRecord();
+  // Gather the flight records of the ranks of the groups of this one through
+  // the store, and report the ranks which are the last to arrive at the
+  // collectives and the slowest collective types. It must be called on all
+  // the ranks.
+  std::string AggregateFlightRecord();
+
  private:
   void CommTaskLoop();
   void CommTaskClearLoop();
   bool IsTimeout();
+  void RecordFlight(std::shared_ptr<CommTask> task);
 
   static std::thread comm_task_loop_thread_;
   static std::thread comm_task_clear_loop_thread_;
@@ -83,6 +106,10 @@ class CommTaskManager {
   static std::chrono::time_point<std::chrono::steady_clock> last_update_time_;
   std::chrono::milliseconds timeout_;
   bool logged_ = false;
+
+  std::mutex flight_record_mutex_;
+  std::deque<CommFlightRecord> flight_record_;
+  int flight_record_round_ = 0;
 };
 
 }  // namespace distributed
@@ -16,11 +16,14 @@
 
 #include "gflags/gflags.h"
 
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/core/distributed/comm_context_manager.h"
 #include "paddle/phi/core/distributed/nccl_tools.h"
 #include "paddle/phi/core/utils/data_type.h"
 
+COMMON_DECLARE_int32(comm_flight_recorder_size);
+
 namespace phi::distributed {
 
 NCCLCommTask::NCCLCommTask(const phi::Place& place,
@@ -56,6 +59,14 @@ NCCLCommTask::NCCLCommTask(const phi::Place& place,
   start_event_created_ = false;
   end_event_created_ = false;
   start_time_ = std::chrono::steady_clock::now();
+  // the flight record needs the time of the task on the device
+  if (FLAGS_comm_flight_recorder_size > 0) {
+#ifdef PADDLE_WITH_CUDA
+    cuda_event_flags_ = cudaEventDefault;
+#else  // PADDLE_WITH_HIP
+    hip_event_flags_ = hipEventDefault;
+#endif
+  }
 }
 
 void NCCLCommTask::StartRecord() {
@@ -249,6 +260,22 @@ void NCCLCommTask::AbortComm() {
   return;
 }
 
+float NCCLCommTask::GetElapsedMillis() {
+  if (FLAGS_comm_flight_recorder_size <= 0 || !start_event_created_ ||
+      !IsCompleted()) {
+    return -1;
+  }
+  float elapsed = 0;
+  backends::gpu::GPUDeviceGuard guard(place_.device);
+#ifdef PADDLE_WITH_CUDA
+  CUDA_CHECK(
+      cudaEventElapsedTime(&elapsed, nccl_start_event_, nccl_end_event_));
+#else  // PADDLE_WITH_HIP
+  HIP_CHECK(hipEventElapsedTime(&elapsed, nccl_start_event_, nccl_end_event_));
+#endif
+  return elapsed;
+}
+
 std::string NCCLCommTask::GetTraceMsg() {
   auto global_ranks =
       phi::distributed::CommContextManager::GetInstance().GetGroupRanks(
@@ -58,6 +58,7 @@ class NCCLCommTask : public CommTask {
   std::string GetTraceMsg() override;
   std::string GetCommErrors() override;
   void AbortComm() override;
+  float GetElapsedMillis() override;
 
   void StartRecord() override;
   void EndRecord() override;
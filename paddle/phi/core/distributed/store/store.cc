@@ -43,5 +43,29 @@ void Store::set(const std::string& key, const std::vector<uint8_t>& value) {
       errors::InvalidArgument("Implement the set method in the subclass."));
 }
 
+std::vector<std::vector<uint8_t>> Store::multi_get(
+    const std::vector<std::string>& keys) {
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (const auto& key : keys) {
+    values.emplace_back(get(key));
+  }
+  return values;
+}
+
+void Store::multi_set(const std::vector<std::string>& keys,
+                      const std::vector<std::vector<uint8_t>>& values) {
+  PADDLE_ENFORCE_EQ(
+      keys.size(),
+      values.size(),
+      errors::InvalidArgument("The number of keys (%d) and values (%d) to set "
+                              "should be the same.",
+                              keys.size(),
+                              values.size()));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    set(keys[i], values[i]);
+  }
+}
+
 }  // namespace distributed
 }  // namespace phi
@@ -33,6 +33,12 @@ class Store {
   virtual void wait(const std::string& key);
   virtual void set(const std::string& key, const std::vector<uint8_t>& value);
 
+  // Get or set the keys in one round trip if the store supports it.
+  virtual std::vector<std::vector<uint8_t>> multi_get(
+      const std::vector<std::string>& keys);
+  virtual void multi_set(const std::vector<std::string>& keys,
+                         const std::vector<std::vector<uint8_t>>& values);
+
   virtual int timeout() { return _timeout; }
 
  protected:
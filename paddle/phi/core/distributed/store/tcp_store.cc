@@ -82,6 +82,24 @@ void MasterDaemon::_do_set(SocketType socket) {
   _notify_waiting_sockets(key);
 }
 
+void MasterDaemon::_do_multi_set(SocketType socket) {
+  auto num_keys = tcputils::receive_value<size_t>(socket);
+  VLOG(8) << "MasterDaemon::_do_multi_set " << num_keys << " keys "
+          << GetSockName(socket);
+
+  std::vector<std::string> keys;
+  keys.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys.emplace_back(tcputils::receive_string(socket));
+  }
+  for (const auto& key : keys) {
+    _store[key] = tcputils::receive_vector<uint8_t>(socket);
+  }
+  for (const auto& key : keys) {
+    _notify_waiting_sockets(key);
+  }
+}
+
 void MasterDaemon::_notify_waiting_sockets(const std::string& key) {
   if (_waiting_sockets.find(key) != _waiting_sockets.end()) {
     for (auto waiting_socket : _waiting_sockets.at(key)) {
@@ -107,6 +125,33 @@ void MasterDaemon::_do_get(SocketType socket) {
   tcputils::send_vector<uint8_t>(socket, value);
 }
 
+void MasterDaemon::_do_multi_get(SocketType socket) {
+  auto num_keys = tcputils::receive_value<size_t>(socket);
+  VLOG(8) << "MasterDaemon::_do_multi_get " << num_keys << " keys "
+          << GetSockName(socket);
+
+  std::vector<std::string> keys;
+  keys.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys.emplace_back(tcputils::receive_string(socket));
+  }
+
+  // The values are sent as the ones of GET, in one buffer
+  std::vector<uint8_t> buffer;
+  for (const auto& key : keys) {
+    auto iter = _store.find(key);
+    PADDLE_ENFORCE_NE(
+        iter,
+        _store.end(),
+        phi::errors::InvalidArgument("Key %s not found in TCPStore.", key));
+    size_t size = iter->second.size();
+    const auto* size_ptr = reinterpret_cast<const uint8_t*>(&size);
+    buffer.insert(buffer.end(), size_ptr, size_ptr + sizeof(size));
+    buffer.insert(buffer.end(), iter->second.begin(), iter->second.end());
+  }
+  tcputils::send_bytes<uint8_t>(socket, buffer.data(), buffer.size());
+}
+
 void MasterDaemon::_do_check(SocketType socket) {
   std::string key = tcputils::receive_string(socket);
   VLOG(4) << "MasterDaemon::_do_check key(" << key << ") "
@@ -174,20 +219,22 @@ void MasterDaemon::_do_wait(SocketType socket) {
   }
 }
 
-void MasterDaemon::ProcessCommands(std::vector<struct pollfd>* p_fds) {
+void MasterDaemon::ProcessCommands(std::vector<struct pollfd>* p_fds,
+                                   int num_events) {
   std::vector<struct pollfd>& fds = *p_fds;
-  // FIXME(gongwb): Don't loop all fds of set just the fds who have event.
+  // Stop looping the fds when all the ones which have events are processed.
 #ifdef _WIN32
   // 0: listen socket, so loop from 1.
-  for (size_t i = 1; i < fds.size(); i++) {
+  for (size_t i = 1; i < fds.size() && num_events > 0; i++) {
 #else
   // 0: listen socket, 1:controller pipe, so loop from 2.
-  for (uint i = 2; i < fds.size(); i++) {
+  for (uint i = 2; i < fds.size() && num_events > 0; i++) {
 #endif
     try {
       if (fds[i].revents == 0) {
         continue;
       }
+      --num_events;
 
       VLOG(8) << "Plan to receive command from " << GetSockName(fds[i].fd);
       Command command = tcputils::receive_value<Command>(fds[i].fd);
@@ -209,6 +256,12 @@ void MasterDaemon::ProcessCommands(std::vector<struct pollfd>* p_fds) {
         case Command::WAIT:
           _do_wait(fds[i].fd);
           break;
+        case Command::MULTI_GET:
+          _do_multi_get(fds[i].fd);
+          break;
+        case Command::MULTI_SET:
+          _do_multi_set(fds[i].fd);
+          break;
         default:
           VLOG(8) << "Unknown command: " << static_cast<int>(command)
                   << " from addr info:" << GetSockName(fds[i].fd);
@@ -238,6 +291,8 @@ void MasterDaemon::ProcessCommands(std::vector<struct pollfd>* p_fds) {
 #else
       _sockets.erase(_sockets.begin() + i - 2);
 #endif
+      // the next fd is moved to i
+      --i;
       std::string s(ex.what());
       if (s.find("TCP connection reset by peer") != std::string::npos) {
         VLOG(5) << "TCP connection reset by peer";
@@ -267,8 +322,8 @@ void MasterDaemon::run() {
     VLOG(9) << "begin to poll fds_size:"
             << paddle::string::Sprintf("%d", fds.size());
 #ifdef _WIN32
-    int res = ::WSAPoll(fds.data(), fds.size(), INFTIME);
-    if (res == 0) {
+    int num_events = ::WSAPoll(fds.data(), fds.size(), INFTIME);
+    if (num_events == 0) {
       auto rv = WaitForSingleObject(ghStopEvent_, 0);
       if (rv != WAIT_TIMEOUT) {
         finished = true;
@@ -277,7 +332,7 @@ void MasterDaemon::run() {
       continue;
     }
 #else
-    ::poll(fds.data(), fds.size(), INFTIME);
+    int num_events = ::poll(fds.data(), fds.size(), INFTIME);
 
     VLOG(9) << "begin to fds[1].revents:"
             << paddle::string::Sprintf("%d", fds[1].revents);
@@ -296,6 +351,7 @@ void MasterDaemon::run() {
 
     // accept connect request.
     if (fds[0].revents != 0) {
+      --num_events;
       auto socket = tcputils::tcp_accept(_listen_socket);
       _sockets.emplace_back(socket);
 #ifdef _WIN32
@@ -305,7 +361,7 @@ void MasterDaemon::run() {
 #endif
     }
 
-    ProcessCommands(&fds);
+    ProcessCommands(&fds, num_events);
   }
 }
 
@@ -333,6 +389,15 @@ void TCPClient::send_command_for_key(Command type, const std::string& key) {
   tcputils::send_string(_socket, key);
 }
 
+void TCPClient::send_command_for_keys(Command type,
+                                      const std::vector<std::string>& keys) {
+  tcputils::send_value<Command>(_socket, type);
+  tcputils::send_value<size_t>(_socket, keys.size());
+  for (const auto& key : keys) {
+    tcputils::send_string(_socket, key);
+  }
+}
+
 template <typename T>
 void TCPClient::send_value(const T& value) {
   tcputils::send_bytes<T>(_socket, &value, 1);
@@ -438,6 +503,58 @@ std::vector<uint8_t> TCPStore::get(const std::string& key) {
   return _client->receive_vector<uint8_t>();
 }
 
+std::vector<std::vector<uint8_t>> TCPStore::multi_get(
+    const std::vector<std::string>& keys) {
+  VLOG(7) << "TCPStore multi_get.";
+  std::vector<std::string> prefixed_keys;
+  prefixed_keys.reserve(keys.size());
+  for (const auto& key : keys) {
+    prefixed_keys.emplace_back(_key_prefix + key);
+  }
+
+  // Send all the waits before receiving their replies, so that the keys are
+  // waited for in one round trip.
+  for (const auto& key : prefixed_keys) {
+    _client->send_command_for_key(Command::WAIT, key);
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto reply = _client->receive_value<ReplyType>();
+    PADDLE_ENFORCE_EQ(
+        reply == ReplyType::STOP_WAIT,
+        true,
+        phi::errors::InvalidArgument("Stop_waiting response is expected"));
+  }
+
+  _client->send_command_for_keys(Command::MULTI_GET, prefixed_keys);
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    values.emplace_back(_client->receive_vector<uint8_t>());
+  }
+  return values;
+}
+
+void TCPStore::multi_set(const std::vector<std::string>& keys,
+                         const std::vector<std::vector<uint8_t>>& values) {
+  VLOG(7) << "TCPStore multi_set.";
+  PADDLE_ENFORCE_EQ(
+      keys.size(),
+      values.size(),
+      phi::errors::InvalidArgument("The number of keys (%d) and values (%d) "
+                                   "to set should be the same.",
+                                   keys.size(),
+                                   values.size()));
+  std::vector<std::string> prefixed_keys;
+  prefixed_keys.reserve(keys.size());
+  for (const auto& key : keys) {
+    prefixed_keys.emplace_back(_key_prefix + key);
+  }
+  _client->send_command_for_keys(Command::MULTI_SET, prefixed_keys);
+  for (const auto& value : values) {
+    _client->send_vector<uint8_t>(value);
+  }
+}
+
 bool TCPStore::check(const std::string& key) {
   _client->send_command_for_key(Command::CHECK, _key_prefix + key);
   VLOG(3) << "TCPStore check.";
@@ -38,7 +38,16 @@ namespace phi {
 namespace distributed {
 
 enum class ReplyType { WAITING, STOP_WAIT, READY, NOT_READY };
-enum class Command { ADD, GET, CHECK, SET, WAIT, STOP };
+enum class Command {
+  ADD,
+  GET,
+  CHECK,
+  SET,
+  WAIT,
+  STOP,
+  MULTI_GET,
+  MULTI_SET
+};
 
 namespace detail {
 
@@ -55,12 +64,14 @@ class MasterDaemon {
 
  private:
   void run();
-  void ProcessCommands(std::vector<struct pollfd>* p_fds);
+  void ProcessCommands(std::vector<struct pollfd>* p_fds, int num_events);
   void _do_add(SocketType socket);
   void _do_wait(SocketType socket);
   void _do_get(SocketType socket);
   void _do_check(SocketType socket);
   void _do_set(SocketType socket);
+  void _do_multi_get(SocketType socket);
+  void _do_multi_set(SocketType socket);
   void _notify_waiting_sockets(const std::string&);
   SocketType _listen_socket;
   std::vector<SocketType> _sockets;
@@ -99,6 +110,9 @@ class TCPClient {
                                             uint16_t port);
   ~TCPClient() { tcputils::close_socket(_socket); }
   void send_command_for_key(Command type, const std::string& key);
+  // The keys of a batched command, which are sent before the values.
+  void send_command_for_keys(Command type,
+                             const std::vector<std::string>& keys);
 
   template <typename T>
   void send_value(const T& value);
@@ -135,6 +149,11 @@ class TCPStore : public Store {
   void wait(const std::string& key) override;
   void set(const std::string& key, const std::vector<uint8_t>& value) override;
 
+  std::vector<std::vector<uint8_t>> multi_get(
+      const std::vector<std::string>& keys) override;
+  void multi_set(const std::vector<std::string>& keys,
+                 const std::vector<std::vector<uint8_t>>& values) override;
+
  private:
   void waitWorkers();
   std::unique_ptr<detail::TCPServer> _server;
@@ -18,8 +18,14 @@ limitations under the License. */
 
 #include <cstdint>
 #include <memory>
+#include <tuple>
 #include <utility>
 
+#if defined(PADDLE_WITH_CUDA)
+#include "paddle/phi/backends/gpu/cuda/cuda_graph.h"
+#elif defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/rocm/hip_graph.h"
+#endif
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/backends/xpu/xpu_info.h"
 #include "paddle/phi/core/enforce.h"
@@ -277,6 +283,9 @@ std::pair<uint64_t, uint64_t> Generator::IncrementOffset(uint64_t increment) {
   uint64_t offset = state().offset;
   state().offset = offset + increment;
   print_state_info();
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  phi::backends::gpu::CUDAGraph::RecordRandomOffsetIncrement();
+#endif
   return std::make_pair(state().seed, offset);
 #else
   PADDLE_THROW(phi::errors::PermissionDenied(
@@ -284,4 +293,32 @@ std::pair<uint64_t, uint64_t> Generator::IncrementOffset(uint64_t increment) {
 #endif
 }
 
+PhiloxSeedOffset Generator::IncrementPhiloxOffset(uint64_t increment) {
+  PhiloxSeedOffset seed_offset;
+#if defined(PADDLE_WITH_CUDA)
+  if (UNLIKELY(phi::backends::gpu::CUDAGraph::IsThisThreadCapturing())) {
+    std::lock_guard<std::mutex> lock(mu_);
+    uint64_t offset = state().offset;
+    state().offset = offset + increment;
+    print_state_info();
+    uint64_t index = current_index;
+    // called before each replay to reserve the offsets used by the graph
+    auto refresh = [this, index](uint64_t span) {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto& replay_state = states_[index];
+      uint64_t base = replay_state.offset;
+      replay_state.offset = base + span;
+      return std::make_pair(replay_state.seed, base);
+    };
+    std::tie(seed_offset.seed_offset, seed_offset.offset) =
+        phi::backends::gpu::CUDAGraph::CapturingRandomSeedOffset(
+            this, index, offset, increment, refresh);
+    seed_offset.seed = state().seed;
+    return seed_offset;
+  }
+#endif
+  std::tie(seed_offset.seed, seed_offset.offset) = IncrementOffset(increment);
+  return seed_offset;
+}
+
 }  // namespace phi
@@ -29,6 +29,18 @@ limitations under the License. */
 namespace phi {
 
 #define MAGIC_RANDOM_SEED 34342423252
+
+// The seed and the offset of a counter-based Philox random kernel. While a
+// CUDA Graph is captured, seed_offset points to the seed and the base offset
+// of the generator on the device, which the graph writes before each replay,
+// and offset is relative to the base, so that each replay draws new random
+// numbers without updating the kernels of the graph.
+struct PhiloxSeedOffset {
+  uint64_t seed = 0;
+  uint64_t offset = 0;
+  const uint64_t* seed_offset = nullptr;
+};
+
 class Generator {
  public:
   struct GeneratorState {
@@ -125,6 +137,13 @@ class Generator {
   // and returns the new seed and offset.
   std::pair<uint64_t, uint64_t> IncrementOffset(uint64_t increment_offset);
 
+  // Same as IncrementOffset, but while this thread captures a CUDA Graph the
+  // seed and the base offset are read on the device, see PhiloxSeedOffset.
+  // The offset is still advanced on the host, so a random kernel recomputed
+  // after the state is restored, e.g. by recompute, gets the same relative
+  // offset and regenerates the same random numbers.
+  PhiloxSeedOffset IncrementPhiloxOffset(uint64_t increment_offset);
+
  private:
   // Accesses the current generator state by index.
   inline GeneratorState& state();
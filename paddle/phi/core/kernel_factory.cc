@@ -32,6 +32,11 @@ PHI_DEFINE_EXPORTED_bool(use_stride_kernel,
                          true,
                          "Whether to use stride kernel if op support stride.");
 
+PHI_DEFINE_EXPORTED_bool(enable_kernel_selection_cache,
+                         true,
+                         "Whether the generated APIs cache the selected "
+                         "kernels by the kernel keys.");
+
 COMMON_DECLARE_int32(low_precision_op_list);
 COMMON_DECLARE_bool(enable_api_kernel_fallback);
 PD_DECLARE_bool(run_kp_kernel);
@@ -60,6 +65,67 @@ KernelFactory& KernelFactory::Instance() {
   return g_op_kernel_factory;
 }
 
+void KernelFactory::AddLazyKernel(const std::string& kernel_name,
+                                  const KernelKey& kernel_key,
+                                  KernelArgsParseFn args_parse_fn,
+                                  KernelArgsDefFn args_def_fn,
+                                  KernelFn kernel_fn,
+                                  void* variadic_kernel_fn) {
+  std::lock_guard<std::mutex> guard(lazy_kernels_mutex_);
+  // the kernels loaded after the selections are cached may rehash the name
+  // map, which the cached selections point into
+  version_.fetch_add(1, std::memory_order_relaxed);
+  kernels_[kernel_name];
+  lazy_kernels_[kernel_name].push_back({kernel_key,
+                                        args_parse_fn,
+                                        args_def_fn,
+                                        std::move(kernel_fn),
+                                        variadic_kernel_fn});
+  num_lazy_kernels_.fetch_add(1, std::memory_order_release);
+}
+
+void KernelFactory::ConstructLazyKernels(
+    const std::string* kernel_name) const {
+  if (num_lazy_kernels_.load(std::memory_order_acquire) == 0) {
+    return;
+  }
+  auto construct = [this](const std::string& name,
+                          const std::vector<LazyKernel>& lazy_kernels) {
+    auto& kernel_key_map = kernels_[name];
+    for (const auto& lazy_kernel : lazy_kernels) {
+      Kernel kernel(lazy_kernel.kernel_fn, lazy_kernel.variadic_kernel_fn);
+      if (kernel.GetKernelRegisteredType() == KernelRegisteredType::FUNCTION) {
+        lazy_kernel.args_parse_fn(lazy_kernel.kernel_key,
+                                  kernel.mutable_args_def());
+      }
+      lazy_kernel.args_def_fn(lazy_kernel.kernel_key, &kernel);
+      kernel_key_map[lazy_kernel.kernel_key] = kernel;
+    }
+    num_lazy_kernels_.fetch_sub(lazy_kernels.size(),
+                                std::memory_order_release);
+  };
+  std::lock_guard<std::mutex> guard(lazy_kernels_mutex_);
+  if (kernel_name == nullptr) {
+    for (const auto& pair : lazy_kernels_) {
+      construct(pair.first, pair.second);
+    }
+    lazy_kernels_.clear();
+    return;
+  }
+  auto iter = lazy_kernels_.find(*kernel_name);
+  if (iter != lazy_kernels_.end()) {
+    construct(iter->first, iter->second);
+    lazy_kernels_.erase(iter);
+  }
+}
+
+const KernelKeyMap* KernelFactory::FindKernels(
+    const std::string& kernel_name) const {
+  ConstructLazyKernels(&kernel_name);
+  auto iter = kernels_.find(kernel_name);
+  return iter == kernels_.end() ? nullptr : &iter->second;
+}
+
 bool KernelFactory::HasCompatiblePhiKernel(const std::string& op_type) const {
   if (deprecated_op_names.find(op_type) == deprecated_op_names.end()) {
     if (phi::OpUtilsMap::Instance().Contains(op_type) ||
@@ -72,6 +138,7 @@ bool KernelFactory::HasCompatiblePhiKernel(const std::string& op_type) const {
 
 bool KernelFactory::HasStructuredKernel(const std::string& op_type) const {
   auto phi_kernel_name = phi::OpUtilsMap::Instance().GetBaseKernelName(op_type);
+  ConstructLazyKernels(&phi_kernel_name);
   auto kernel_iter = kernels_.find(phi_kernel_name);
   if (deprecated_op_names.find(op_type) == deprecated_op_names.end() &&
       kernel_iter != kernels_.end()) {
@@ -87,6 +154,7 @@ bool KernelFactory::HasStructuredKernel(const std::string& op_type) const {
 
 const Kernel& KernelFactory::SelectKernel(const std::string& kernel_name,
                                           const KernelKey& kernel_key) const {
+  ConstructLazyKernels(&kernel_name);
   auto iter = kernels_.find(kernel_name);
   if (iter == kernels_.end()) {
     return empty_kernel;
@@ -117,6 +185,7 @@ const Kernel& KernelFactory::SelectKernel(const std::string& kernel_name,
 
 const Kernel& KernelFactory::SelectKernelWithGPUDNN(
     const std::string& kernel_name, const KernelKey& const_kernel_key) const {
+  ConstructLazyKernels(&kernel_name);
   auto iter = kernels_.find(kernel_name);
   if (iter == kernels_.end()) {
     return empty_kernel;
@@ -160,6 +229,7 @@ const Kernel& KernelFactory::SelectKernelWithGPUDNN(
 
 KernelKeyMap KernelFactory::SelectKernelMap(
     const std::string& kernel_name) const {
+  ConstructLazyKernels(&kernel_name);
   auto iter = kernels_.find(kernel_name);
   if (iter == kernels_.end()) {
     return KernelKeyMap();
@@ -169,6 +239,7 @@ KernelKeyMap KernelFactory::SelectKernelMap(
 
 bool KernelFactory::HasKernel(const std::string& kernel_name,
                               const KernelKey& kernel_key) const {
+  ConstructLazyKernels(&kernel_name);
   auto iter = kernels_.find(kernel_name);
   PADDLE_ENFORCE_NE(
       iter,
@@ -231,6 +302,7 @@ KernelResult KernelFactory::SelectKernelOrThrowError(
     const std::string& kernel_name,
     const KernelKey& const_kernel_key,
     bool use_strided_kernel) const {
+  ConstructLazyKernels(&kernel_name);
   auto iter = kernels_.find(kernel_name);
 
   PADDLE_ENFORCE_NE(
@@ -368,8 +440,44 @@ KernelResult KernelFactory::SelectKernelOrThrowError(
   return {kernel_iter->second, false, false};
 }
 
+KernelResult KernelSelectionCache::Select(const KernelKey& kernel_key,
+                                          bool use_strided_kernel) {
+  auto& factory = KernelFactory::Instance();
+  if (!FLAGS_enable_kernel_selection_cache) {
+    return factory.SelectKernelOrThrowError(
+        kernel_name_, kernel_key, use_strided_kernel);
+  }
+  if (version_ != factory.version()) {
+    results_.clear();
+    version_ = factory.version();
+  }
+  // The flags read by SelectKernelOrThrowError are a part of the key.
+  uint64_t key = (static_cast<uint64_t>(kernel_key.hash_value()) << 3) |
+                 (static_cast<uint64_t>(use_strided_kernel) << 2) |
+                 (static_cast<uint64_t>(FLAGS_use_stride_kernel) << 1) |
+                 static_cast<uint64_t>(FLAGS_enable_api_kernel_fallback);
+#if defined(PADDLE_WITH_XPU_KP)
+  key = (key << 1) | static_cast<uint64_t>(FLAGS_run_kp_kernel);
+#endif
+  auto iter = results_.find(key);
+  if (iter == results_.end()) {
+    auto result = factory.SelectKernelOrThrowError(
+        kernel_name_, kernel_key, use_strided_kernel);
+    iter = results_
+               .emplace(key,
+                        CachedResult{&result.kernel,
+                                     result.has_fallback_cpu,
+                                     result.is_stride_kernel})
+               .first;
+  }
+  return {*iter->second.kernel,
+          iter->second.has_fallback_cpu,
+          iter->second.is_stride_kernel};
+}
+
 const KernelArgsDef& KernelFactory::GetFirstKernelArgsDef(
     const std::string& kernel_name) const {
+  ConstructLazyKernels(&kernel_name);
   auto iter = kernels_.find(kernel_name);
   PADDLE_ENFORCE_NE(
       iter,
@@ -551,7 +659,7 @@ std::string KernelSelectionErrorMessage(const std::string& kernel_name,
   std::unordered_set<std::string> dtype_set;
 
   // Record all kernel information of kernel_name
-  for (auto const& iter : KernelFactory::Instance().kernels()[kernel_name]) {
+  for (auto const& iter : KernelFactory::Instance().kernels().at(kernel_name)) {
     KernelKey kernel_key = iter.first;
     if (kernel_key.backend() == target_key.backend()) {
       support_backend = true;
@@ -14,10 +14,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <ostream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "paddle/common/layout.h"
 #include "paddle/phi/common/backend.h"
 #include "paddle/phi/common/data_type.h"
@@ -123,6 +127,10 @@ struct TensorArgDef {
   DataLayout layout;
   DataType dtype;
   std::type_index type_index;
+  // Set by the registration of the kernel which reads the strides of the
+  // input, so that PrepareData passes the non-contiguous input to it without
+  // the contiguous copy.
+  bool stride_supported{false};
 
   TensorArgDef(Backend in_backend,
                DataLayout in_layout,
@@ -147,6 +155,11 @@ struct TensorArgDef {
     dtype = in_dtype;
     return *this;
   }
+
+  TensorArgDef& SetStrideSupported(bool in_stride_supported = true) {
+    stride_supported = in_stride_supported;
+    return *this;
+  }
 };
 
 // Align the original fluid Attribute type with lower overhead
@@ -317,7 +330,43 @@ class KernelFactory {
  public:
   static KernelFactory& Instance();
 
-  KernelNameMap& kernels() { return kernels_; }
+  // All of the kernels, the lazy kernels are constructed first.
+  const KernelNameMap& kernels() const {
+    ConstructLazyKernels(nullptr);
+    return kernels_;
+  }
+
+  // For registering or removing the kernels only. The kernels may be changed
+  // by the caller, so the selections cached by KernelSelectionCache are
+  // invalidated.
+  KernelNameMap& mutable_kernels() {
+    ConstructLazyKernels(nullptr);
+    version_.fetch_add(1, std::memory_order_relaxed);
+    return kernels_;
+  }
+
+  // Records a kernel registered by PD_REGISTER_KERNEL and the like. Parsing
+  // the args of the kernel is deferred to the first lookup of kernel_name, so
+  // loading the library does not parse the kernels that are never used. The
+  // name is added to the kernels right away, which keeps HasKernel and the
+  // iterators of the kernels independent of the lookups.
+  void AddLazyKernel(const std::string& kernel_name,
+                     const KernelKey& kernel_key,
+                     KernelArgsParseFn args_parse_fn,
+                     KernelArgsDefFn args_def_fn,
+                     KernelFn kernel_fn,
+                     void* variadic_kernel_fn);
+
+  // The number of the kernels registered but not constructed yet.
+  size_t lazy_kernel_size() const {
+    return num_lazy_kernels_.load(std::memory_order_acquire);
+  }
+
+  // The kernels of kernel_name, or nullptr if it is not registered.
+  const KernelKeyMap* FindKernels(const std::string& kernel_name) const;
+
+  // Changed whenever the kernels may be changed.
+  uint64_t version() const { return version_.load(std::memory_order_relaxed); }
 
   bool HasCompatiblePhiKernel(const std::string& op_type) const;
 
@@ -351,12 +400,66 @@ class KernelFactory {
  private:
   KernelFactory() = default;
 
-  KernelNameMap kernels_;
+  struct LazyKernel {
+    KernelKey kernel_key;
+    KernelArgsParseFn args_parse_fn;
+    KernelArgsDefFn args_def_fn;
+    KernelFn kernel_fn;
+    void* variadic_kernel_fn;
+  };
+
+  // Constructs the lazy kernels of kernel_name, or all of them if
+  // kernel_name is nullptr.
+  void ConstructLazyKernels(const std::string* kernel_name) const;
+
+  // The lazy kernels are constructed in the const lookups. Only the kernel
+  // key maps of their names are written then, the name map is not rehashed.
+  mutable KernelNameMap kernels_;
+
+  mutable std::mutex lazy_kernels_mutex_;
+  mutable paddle::flat_hash_map<std::string, std::vector<LazyKernel>>
+      lazy_kernels_;
+  mutable std::atomic<size_t> num_lazy_kernels_{0};
+
+  std::atomic<uint64_t> version_{0};
 
   // Get the low precision kernel list of current module.
   std::map<const std::string, OpCount> low_precision_kernels_;
 };
 
+/**
+ * KernelSelectionCache memoizes SelectKernelOrThrowError of a kernel, which
+ * walks the stride, GPUDNN, custom device and CPU fallback keys (and the XPU
+ * op lists) on every call. The generated APIs keep a thread local one per
+ * kernel, so a repeated call with the same kernel key and flags costs a
+ * single lookup of a small map instead, without hashing the kernel name.
+ *
+ * The cache is dropped once KernelFactory::version() changes, i.e. after the
+ * kernels are registered or removed. It is disabled by
+ * FLAGS_enable_kernel_selection_cache=false.
+ **/
+class KernelSelectionCache {
+ public:
+  explicit KernelSelectionCache(const char* kernel_name)
+      : kernel_name_(kernel_name) {}
+
+  KernelResult Select(const KernelKey& kernel_key,
+                      bool use_strided_kernel = false);
+
+  size_t size() const { return results_.size(); }
+
+ private:
+  struct CachedResult {
+    const Kernel* kernel;
+    bool has_fallback_cpu;
+    bool is_stride_kernel;
+  };
+
+  std::string kernel_name_;
+  uint64_t version_{0};
+  paddle::flat_hash_map<uint64_t, CachedResult> results_;
+};
+
 inline std::ostream& operator<<(std::ostream& os, const KernelKey& kernel_key) {
   os << "(" << kernel_key.backend() << ", " << kernel_key.layout() << ", "
      << kernel_key.dtype() << ")";
@@ -139,17 +139,22 @@ struct KernelRegistrar {
     std::string kernel_name(kernel_name_cstr);
     KernelKey kernel_key(
         paddle::experimental::StringToBackend(backend_cstr), layout, dtype);
+    if (reg_type == RegType::INNER) {
+      KernelFactory::Instance().AddLazyKernel(kernel_name,
+                                              kernel_key,
+                                              args_parse_fn,
+                                              args_def_fn,
+                                              kernel_fn,
+                                              variadic_kernel_fn);
+      return;
+    }
     Kernel kernel(kernel_fn, variadic_kernel_fn);
     if (kernel.GetKernelRegisteredType() == KernelRegisteredType::FUNCTION) {
       args_parse_fn(kernel_key, kernel.mutable_args_def());
     }
     args_def_fn(kernel_key, &kernel);
-    if (reg_type == RegType::INNER) {
-      KernelFactory::Instance().kernels()[kernel_name][kernel_key] = kernel;
-    } else {
-      CustomKernelMap::Instance().RegisterCustomKernel(
-          kernel_name, kernel_key, kernel);
-    }
+    CustomKernelMap::Instance().RegisterCustomKernel(
+        kernel_name, kernel_key, kernel);
   }
 };
 
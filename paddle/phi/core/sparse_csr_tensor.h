@@ -29,6 +29,10 @@ class DenseTensorUtils;
 /// non_zero_cols_ represents the column index of non zero elements in original
 /// DenseTensor,
 /// non_zero_elements_ represents the non zero elements of original DenseTensor.
+/// A 2-D SparseCsrTensor can also be stored in blocks (BSR), where
+/// non_zero_crows_ and non_zero_cols_ index the blocks of block_size x
+/// block_size elements and non_zero_elements_ is of shape
+/// [number of the blocks, block_size, block_size].
 class SparseCsrTensor : public TensorBase,
                         public TypeInfoTraits<TensorBase, SparseCsrTensor> {
  public:
@@ -98,6 +102,15 @@ class SparseCsrTensor : public TensorBase,
   /// tensor.
   int64_t nnz() const { return non_zero_elements_.numel(); }
 
+  /// \brief Returns whether the tensor is stored in blocks.
+  bool is_blocked() const { return non_zero_elements_.dims().size() == 3; }
+
+  /// \brief Returns the size of the blocks, which is 1 if the tensor is not
+  /// stored in blocks.
+  int64_t block_size() const {
+    return is_blocked() ? non_zero_elements_.dims()[1] : 1;
+  }
+
   /// \brief Return the number of elements contained in original dense tensor
   /// \return The number of elements contained in original dense tensor
   int64_t numel() const override { return product(meta_.dims); }
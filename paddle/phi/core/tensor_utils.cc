@@ -220,10 +220,22 @@ void Copy(const Context& dev_ctx,
 #ifdef PADDLE_WITH_XPU
   } else if (src_place.GetType() == AllocationType::XPU &&  // NOLINT
              dst_place.GetType() == AllocationType::CPU) {
-    memory_utils::Copy(dst_place, dst_ptr, src_place, src_ptr, size);
+    // on the stream of the context, which is a copy stream of the executor
+    // or the compute one, rather than after all the streams of the device
+    if (dev_ctx.GetPlace() == src_place) {
+      reinterpret_cast<const phi::XPUContext&>(dev_ctx).MemcpyOnStream(
+          dst_ptr, src_ptr, size, XPUMemcpyKind::XPU_DEVICE_TO_HOST);
+    } else {
+      memory_utils::Copy(dst_place, dst_ptr, src_place, src_ptr, size);
+    }
   } else if (src_place.GetType() == AllocationType::CPU &&
              dst_place.GetType() == AllocationType::XPU) {
-    memory_utils::Copy(dst_place, dst_ptr, src_place, src_ptr, size);
+    if (dev_ctx.GetPlace() == dst_place) {
+      reinterpret_cast<const phi::XPUContext&>(dev_ctx).MemcpyOnStream(
+          dst_ptr, src_ptr, size, XPUMemcpyKind::XPU_HOST_TO_DEVICE);
+    } else {
+      memory_utils::Copy(dst_place, dst_ptr, src_place, src_ptr, size);
+    }
   } else if (src_place.GetType() == AllocationType::XPU &&
              dst_place.GetType() == AllocationType::XPU) {
     if (src_ptr == dst_ptr) {
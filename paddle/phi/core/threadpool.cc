@@ -14,6 +14,11 @@
 
 #include "paddle/phi/core/threadpool.h"
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include <thread>
 
 #include "glog/logging.h"
@@ -24,9 +29,41 @@ COMMON_DECLARE_int32(dist_threadpool_size);
 PD_DEFINE_int32(io_threadpool_size,
                 100,
                 "number of threads used for doing IO, default 100");
+PD_DEFINE_bool(threadpool_bind_cpu,
+               false,
+               "whether to bind the threads of the global thread pool to the "
+               "CPUs, default false");
 
 namespace phi {
 
+namespace {
+
+// the pool and the worker that the current thread runs for
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+void BindThreadToCpu(std::thread* thread, size_t worker_id) {
+#ifdef __linux__
+  unsigned num_cpus = std::thread::hardware_concurrency();
+  if (num_cpus == 0) {
+    return;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(worker_id % num_cpus, &cpu_set);
+  if (pthread_setaffinity_np(
+          thread->native_handle(), sizeof(cpu_set), &cpu_set) != 0) {
+    LOG(WARNING) << "Failed to bind the thread " << worker_id
+                 << " of the thread pool to CPU " << worker_id % num_cpus;
+  }
+#else
+  VLOG(1) << "Binding the threads of the thread pool to the CPUs is only "
+             "supported on Linux.";
+#endif
+}
+
+}  // namespace
+
 std::unique_ptr<ThreadPool> ThreadPool::threadpool_(nullptr);
 std::once_flag ThreadPool::init_flag_;
 
@@ -47,15 +84,24 @@ void ThreadPool::Init() {
         num_threads,
         0,
         phi::errors::InvalidArgument("The number of threads is 0."));
-    threadpool_ = std::make_unique<ThreadPool>(num_threads);
+    threadpool_ =
+        std::make_unique<ThreadPool>(num_threads, FLAGS_threadpool_bind_cpu);
   }
 }
 
-ThreadPool::ThreadPool(int num_threads) : running_(true) {
-  threads_.resize(num_threads);
-  for (auto& thread : threads_) {
-    // TODO(Yancey1989): binding the thread on the specify CPU number
-    thread = std::make_unique<std::thread>([this] { ThreadPool::TaskLoop(); });
+ThreadPool::ThreadPool(int num_threads, bool bind_cpu) : running_(true) {
+  pending_[0] = 0;
+  pending_[1] = 0;
+  workers_.resize(num_threads);
+  for (auto& worker : workers_) {
+    worker = std::make_unique<Worker>();
+  }
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    workers_[i]->thread =
+        std::make_unique<std::thread>([this, i] { ThreadPool::TaskLoop(i); });
+    if (bind_cpu) {
+      BindThreadToCpu(workers_[i]->thread.get(), i);
+    }
   }
 }
 
@@ -67,36 +113,91 @@ ThreadPool::~ThreadPool() {
   }
   scheduled_.notify_all();
 
-  for (auto& t : threads_) {
-    t->join();
-    t.reset(nullptr);
+  for (auto& worker : workers_) {
+    worker->thread->join();
+    worker->thread.reset(nullptr);
   }
 }
 
-void ThreadPool::TaskLoop() {
-  while (true) {
-    Task task;
-
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      scheduled_.wait(
-          lock, [this] { return !this->tasks_.empty() || !this->running_; });
+void ThreadPool::Schedule(Task task, Priority priority) {
+  if (!running_) {
+    PADDLE_THROW(
+        phi::errors::Unavailable("Task is enqueued into stopped ThreadPool."));
+  }
+  int p = static_cast<int>(priority);
+  if (current_pool == this) {
+    // the task enqueued by a task is likely to use the data of its parent,
+    // run it on the same thread next
+    Worker* worker = workers_[current_worker].get();
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->tasks[p].push_back(std::move(task));
+  } else {
+    Worker* worker =
+        workers_[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                 workers_.size()]
+            .get();
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->tasks[p].push_front(std::move(task));
+  }
+  // pairs with the idle workers which check pending_ after they increase
+  // idle_workers_, so that either the task is seen or the worker is woken
+  pending_[p].fetch_add(1);
+  if (idle_workers_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scheduled_.notify_one();
+  }
+}
 
-      if (!running_ && tasks_.empty()) {
-        return;
-      }
+bool ThreadPool::PopTask(size_t worker_id, Priority priority, Task* task) {
+  int p = static_cast<int>(priority);
+  if (pending_[p].load() == 0) {
+    return false;
+  }
+  // the newest task of the own queue, then the oldest task of the others
+  {
+    Worker* worker = workers_[worker_id].get();
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    if (!worker->tasks[p].empty()) {
+      *task = std::move(worker->tasks[p].back());
+      worker->tasks[p].pop_back();
+      pending_[p].fetch_sub(1);
+      return true;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker* victim = workers_[(worker_id + i) % workers_.size()].get();
+    std::unique_lock<std::mutex> lock(victim->mutex, std::try_to_lock);
+    if (lock.owns_lock() && !victim->tasks[p].empty()) {
+      *task = std::move(victim->tasks[p].front());
+      victim->tasks[p].pop_front();
+      pending_[p].fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
 
-      if (tasks_.empty()) {
-        PADDLE_THROW(
-            phi::errors::Unavailable("Current thread has no task to Run."));
-      }
+void ThreadPool::TaskLoop(size_t worker_id) {
+  current_pool = this;
+  current_worker = worker_id;
+  while (true) {
+    Task task;
+    if (PopTask(worker_id, Priority::kLatency, &task) ||
+        PopTask(worker_id, Priority::kBackground, &task)) {
+      // run the task
+      task();
+      continue;
+    }
 
-      // pop a task from the task queue
-      task = std::move(tasks_.front());
-      tasks_.pop();
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_workers_.fetch_add(1);
+    scheduled_.wait(lock, [this] {
+      return pending_[0].load() > 0 || pending_[1].load() > 0 || !running_;
+    });
+    idle_workers_.fetch_sub(1);
+    if (!running_ && pending_[0].load() == 0 && pending_[1].load() == 0) {
+      return;
     }
-    // run the task
-    task();
   }
 }
 
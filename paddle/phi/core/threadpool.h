@@ -14,12 +14,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>  // NOLINT
+#include <deque>
 #include <functional>
 #include <future>  // NOLINT
 #include <memory>
-#include <mutex>  // NOLINT
-#include <queue>
+#include <mutex>   // NOLINT
 #include <thread>  // NOLINT
 #include <utility>
 #include <vector>
@@ -46,11 +47,21 @@ struct ExceptionHandler {
   }
 };
 
-// ThreadPool maintains a queue of tasks, and runs them using a fixed
-// number of threads.
+// ThreadPool runs tasks using a fixed number of threads. Each thread owns a
+// queue of tasks: the tasks enqueued by a thread of the pool go to its own
+// queue and are run in LIFO order, the other tasks are distributed over the
+// queues, and an idle thread steals the oldest task of the other queues. So
+// the threads do not contend on one queue when many tasks are enqueued.
+//
+// The background tasks are only run when there is no latency task in any
+// queue of the pool.
 class ThreadPool {
  public:
-  explicit ThreadPool(int num_threads);
+  enum class Priority { kLatency = 0, kBackground = 1 };
+
+  // If bind_cpu is true, the i-th thread is bound to the CPU i modulo the
+  // number of the CPUs.
+  explicit ThreadPool(int num_threads, bool bind_cpu = false);
 
   using Task =
       std::packaged_task<std::unique_ptr<common::enforce::EnforceNotMet>()>;
@@ -64,14 +75,14 @@ class ThreadPool {
   // object. To wait for the completion of the task, call
   // std::future::wait().
   template <typename Callback>
-  std::future<void> Run(Callback fn) {
-    auto f = this->RunAndGetException(fn);
+  std::future<void> Run(Callback fn, Priority priority = Priority::kLatency) {
+    auto f = this->RunAndGetException(fn, priority);
     return std::async(std::launch::deferred, ExceptionHandler(std::move(f)));
   }
 
   template <typename Callback>
   std::future<std::unique_ptr<common::enforce::EnforceNotMet>>
-  RunAndGetException(Callback fn) {
+  RunAndGetException(Callback fn, Priority priority = Priority::kLatency) {
     Task task([fn]() -> std::unique_ptr<common::enforce::EnforceNotMet> {
       try {
         fn();
@@ -89,24 +100,29 @@ class ThreadPool {
     });
     std::future<std::unique_ptr<common::enforce::EnforceNotMet>> f =
         task.get_future();
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-      if (!running_) {
-        PADDLE_THROW(phi::errors::Unavailable(
-            "Task is enqueued into stopped ThreadPool."));
-      }
-      tasks_.push(std::move(task));
-    }
-    scheduled_.notify_one();
+    Schedule(std::move(task), priority);
     return f;
   }
 
  private:
   DISABLE_COPY_AND_ASSIGN(ThreadPool);
 
+  struct Worker {
+    std::mutex mutex;
+    // the queues of the latency and the background tasks
+    std::deque<Task> tasks[2];
+    std::unique_ptr<std::thread> thread;
+  };
+
+  void Schedule(Task task, Priority priority);
+
+  // Pops a task of the priority from the queue of the worker, or steals it
+  // from the other queues.
+  bool PopTask(size_t worker_id, Priority priority, Task* task);
+
   // The constructor starts threads to run TaskLoop, which retrieves
-  // and runs tasks from the queue.
-  void TaskLoop();
+  // and runs tasks from the queues.
+  void TaskLoop(size_t worker_id);
 
   // Init is called by GetInstance.
   static void Init();
@@ -115,11 +131,15 @@ class ThreadPool {
   static std::unique_ptr<ThreadPool> threadpool_;
   static std::once_flag init_flag_;
 
-  std::vector<std::unique_ptr<std::thread>> threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // the worker whose queue the next task from outside of the pool goes to
+  std::atomic<size_t> next_worker_{0};
+  // the number of the tasks in the queues of each priority
+  std::atomic<int64_t> pending_[2];
+  std::atomic<int> idle_workers_{0};
 
-  std::queue<Task> tasks_;
   std::mutex mutex_;
-  bool running_;
+  std::atomic<bool> running_;
   std::condition_variable scheduled_;
 };
 
@@ -1195,6 +1195,77 @@ void FusedAttentionGradInferMeta(const MetaTensor& out_grad,
   }
 }
 
+void FusedBeamSearchStepInferMeta(const MetaTensor& logits,
+                                  const MetaTensor& cum_scores,
+                                  const MetaTensor& finished,
+                                  const MetaTensor& seq_lens,
+                                  const MetaTensor& block_tables,
+                                  const MetaTensor& key_cache,
+                                  const MetaTensor& value_cache,
+                                  int beam_size,
+                                  int end_id,
+                                  float length_penalty,
+                                  MetaTensor* ids,
+                                  MetaTensor* parent_idx,
+                                  MetaTensor* cum_scores_out,
+                                  MetaTensor* finished_out,
+                                  MetaTensor* seq_lens_out,
+                                  MetaTensor* block_tables_out,
+                                  MetaTensor* key_cache_out,
+                                  MetaTensor* value_cache_out) {
+  const auto& logits_dims = logits.dims();
+  PADDLE_ENFORCE_EQ(logits_dims.size(),
+                    2,
+                    phi::errors::InvalidArgument(
+                        "The logits of fused_beam_search_step should be a 2-D "
+                        "tensor of [batch_size * beam_size, vocab_size], but "
+                        "received a %d-D tensor.",
+                        logits_dims.size()));
+  PADDLE_ENFORCE_EQ(
+      beam_size > 0 && beam_size <= 16,
+      true,
+      phi::errors::InvalidArgument(
+          "The beam_size of fused_beam_search_step should be in [1, 16], but "
+          "received %d.",
+          beam_size));
+  const int64_t rows = logits_dims[0];
+  if (rows > 0) {
+    PADDLE_ENFORCE_EQ(rows % beam_size,
+                      0,
+                      phi::errors::InvalidArgument(
+                          "The rows of the logits (%d) should be a multiple of "
+                          "the beam_size (%d).",
+                          rows,
+                          beam_size));
+    PADDLE_ENFORCE_EQ(cum_scores.numel(),
+                      rows,
+                      phi::errors::InvalidArgument(
+                          "The cum_scores should have a score for each of the "
+                          "%d beams, but has %d.",
+                          rows,
+                          cum_scores.numel()));
+  }
+
+  ids->set_dims({rows});
+  ids->set_dtype(phi::DataType::INT64);
+  parent_idx->set_dims({rows});
+  parent_idx->set_dtype(phi::DataType::INT32);
+  cum_scores_out->share_meta(cum_scores);
+  finished_out->share_meta(finished);
+  seq_lens_out->share_meta(seq_lens);
+  if (block_tables) {
+    PADDLE_ENFORCE_EQ(
+        key_cache && value_cache,
+        true,
+        phi::errors::InvalidArgument(
+            "The key_cache and the value_cache of fused_beam_search_step "
+            "should be given with the block_tables."));
+    block_tables_out->share_meta(block_tables);
+    key_cache_out->share_meta(key_cache);
+    value_cache_out->share_meta(value_cache);
+  }
+}
+
 void FusedBiasDropoutResidualLnInferMeta(
     const MetaTensor& x,
     const MetaTensor& residual,
@@ -2939,6 +3010,178 @@ void FusedEmbeddingEltWiseLayerNormInferMeta(
   out->set_dtype((*embs[0]).dtype());
 }
 
+void FusedEmbeddingSeqpoolInferMeta(const std::vector<const MetaTensor*>& ids,
+                                    const MetaTensor& weight,
+                                    const std::string& pooltype,
+                                    int64_t padding_idx,
+                                    float pad_value,
+                                    std::vector<MetaTensor*> out) {
+  PADDLE_ENFORCE_GE(ids.size(),
+                    1UL,
+                    phi::errors::InvalidArgument(
+                        "Input(ids) of FusedEmbeddingSeqpoolOp should not be "
+                        "empty."));
+  PADDLE_ENFORCE_EQ(ids.size(),
+                    out.size(),
+                    phi::errors::InvalidArgument(
+                        "The number of Output(out) of FusedEmbeddingSeqpoolOp "
+                        "should be equal to the number of Input(ids), but "
+                        "received %d and %d.",
+                        out.size(),
+                        ids.size()));
+  PADDLE_ENFORCE_EQ(
+      pooltype == "SUM" || pooltype == "AVERAGE" || pooltype == "SQRT",
+      true,
+      phi::errors::InvalidArgument("The pooltype of FusedEmbeddingSeqpoolOp "
+                                   "should be SUM, AVERAGE or SQRT, but "
+                                   "received %s.",
+                                   pooltype));
+  const auto& w_dims = weight.dims();
+  PADDLE_ENFORCE_EQ(
+      w_dims.size(),
+      2,
+      phi::errors::InvalidArgument("The rank of Input(weight) of "
+                                   "FusedEmbeddingSeqpoolOp should be 2, but "
+                                   "received %d.",
+                                   w_dims.size()));
+  for (size_t i = 0; i < ids.size(); ++i) {
+    PADDLE_ENFORCE_EQ(ids[i]->dtype(),
+                      ids[0]->dtype(),
+                      phi::errors::InvalidArgument(
+                          "All the Input(ids) of FusedEmbeddingSeqpoolOp "
+                          "should have the same dtype, but the %d-th is %s "
+                          "and the first is %s.",
+                          i,
+                          ids[i]->dtype(),
+                          ids[0]->dtype()));
+    // Same as the shape of sequence_pool(embedding(ids)), and the number of
+    // the sequences depends on the lod of ids, which is set in the kernel.
+    auto out_dims = common::vectorize(ids[i]->dims());
+    out_dims.push_back(w_dims[1]);
+    out_dims[0] = -1;
+    out[i]->set_dims(common::make_ddim(out_dims));
+    out[i]->set_dtype(weight.dtype());
+  }
+}
+
+void FusedSoftmaxCrossEntropyInferMeta(const MetaTensor& logits,
+                                       const MetaTensor& label,
+                                       int64_t ignore_index,
+                                       int ring_id,
+                                       int rank,
+                                       int nranks,
+                                       MetaTensor* loss,
+                                       MetaTensor* logsumexp,
+                                       MetaConfig config) {
+  auto logits_dims = logits.dims();
+  const auto& label_dims = label.dims();
+  const int logits_rank = logits_dims.size();
+  PADDLE_ENFORCE_EQ(
+      label_dims.size(),
+      logits_rank,
+      phi::errors::InvalidArgument(
+          "Input(label) of FusedSoftmaxCrossEntropyOp should have the same "
+          "rank as Input(logits), but received %d and %d.",
+          label_dims.size(),
+          logits_rank));
+  const int axis = logits_rank - 1;
+  for (int i = 0; i < axis; ++i) {
+    if (config.is_runtime || (logits_dims[i] > 0 && label_dims[i] > 0)) {
+      PADDLE_ENFORCE_EQ(logits_dims[i],
+                        label_dims[i],
+                        phi::errors::InvalidArgument(
+                            "Input(logits) and Input(label) of "
+                            "FusedSoftmaxCrossEntropyOp should have the same "
+                            "shape except the last dimension."));
+    }
+  }
+  PADDLE_ENFORCE_EQ(label_dims[axis],
+                    1,
+                    phi::errors::InvalidArgument(
+                        "The last dimension of Input(label) of "
+                        "FusedSoftmaxCrossEntropyOp should be 1, but "
+                        "received %d.",
+                        label_dims[axis]));
+  PADDLE_ENFORCE_EQ(
+      nranks >= 1 && rank >= 0 && rank < nranks,
+      true,
+      phi::errors::InvalidArgument(
+          "The rank of FusedSoftmaxCrossEntropyOp should be in [0, nranks), "
+          "but received rank %d and nranks %d.",
+          rank,
+          nranks));
+
+  logits_dims[axis] = 1;
+  loss->set_dims(logits_dims);
+  loss->set_dtype(logits.dtype());
+  loss->share_lod(logits);
+  logsumexp->set_dims(logits_dims);
+  logsumexp->set_dtype(phi::DataType::FLOAT32);
+}
+
+void MoeGroupedGemmInferMeta(const MetaTensor& x,
+                             const MetaTensor& expert_id,
+                             const MetaTensor& weight,
+                             MetaTensor* out,
+                             MetaConfig config) {
+  const auto& x_dims = x.dims();
+  const auto& expert_id_dims = expert_id.dims();
+  const auto& weight_dims = weight.dims();
+  PADDLE_ENFORCE_EQ(x_dims.size(),
+                    2,
+                    phi::errors::InvalidArgument(
+                        "Input(x) of MoeGroupedGemmOp should be 2-D "
+                        "[num_tokens, hidden_size], but received %d-D.",
+                        x_dims.size()));
+  PADDLE_ENFORCE_EQ(weight_dims.size(),
+                    3,
+                    phi::errors::InvalidArgument(
+                        "Input(weight) of MoeGroupedGemmOp should be 3-D "
+                        "[num_experts, hidden_size, out_size], but received "
+                        "%d-D.",
+                        weight_dims.size()));
+  PADDLE_ENFORCE_EQ(
+      expert_id_dims.size() == 1 || expert_id_dims.size() == 2,
+      true,
+      phi::errors::InvalidArgument(
+          "Input(expert_id) of MoeGroupedGemmOp should be 1-D [num_tokens] "
+          "or 2-D [num_tokens, topk], but received %d-D.",
+          expert_id_dims.size()));
+  PADDLE_ENFORCE_EQ(
+      expert_id.dtype() == phi::DataType::INT32 ||
+          expert_id.dtype() == phi::DataType::INT64,
+      true,
+      phi::errors::InvalidArgument(
+          "The data type of Input(expert_id) of MoeGroupedGemmOp should be "
+          "int32 or int64, but received %s.",
+          expert_id.dtype()));
+  if (config.is_runtime || (x_dims[0] > 0 && expert_id_dims[0] > 0)) {
+    PADDLE_ENFORCE_EQ(x_dims[0],
+                      expert_id_dims[0],
+                      phi::errors::InvalidArgument(
+                          "Input(x) and Input(expert_id) of MoeGroupedGemmOp "
+                          "should have the same number of tokens, but "
+                          "received %d and %d.",
+                          x_dims[0],
+                          expert_id_dims[0]));
+  }
+  if (config.is_runtime || (x_dims[1] > 0 && weight_dims[1] > 0)) {
+    PADDLE_ENFORCE_EQ(x_dims[1],
+                      weight_dims[1],
+                      phi::errors::InvalidArgument(
+                          "The hidden size of Input(x) and Input(weight) of "
+                          "MoeGroupedGemmOp should be the same, but received "
+                          "%d and %d.",
+                          x_dims[1],
+                          weight_dims[1]));
+  }
+
+  std::vector<int64_t> out_dims = common::vectorize(expert_id_dims);
+  out_dims.push_back(weight_dims[2]);
+  out->set_dims(common::make_ddim(out_dims));
+  out->set_dtype(x.dtype());
+}
+
 void FusionTransposeFlattenConcatInferMeta(
     const std::vector<const MetaTensor*>& x,
     const std::vector<int>& trans_axis,
@@ -4792,6 +5035,121 @@ void FP8OutHalfGemmFusedInferMeta(
   }
 }
 
+void Fp8CastTransposeInferMeta(const MetaTensor& x,
+                               const MetaTensor& scale,
+                               const MetaTensor& amax_history,
+                               const std::string& out_dtype,
+                               MetaTensor* out,
+                               MetaTensor* out_t,
+                               MetaTensor* amax_history_out) {
+  const auto& x_dims = x.dims();
+  PADDLE_ENFORCE_EQ(x_dims.size(),
+                    2,
+                    phi::errors::InvalidArgument(
+                        "Input(x) of Fp8CastTransposeOp should be 2-D, but "
+                        "received %d-D.",
+                        x_dims.size()));
+  PADDLE_ENFORCE_EQ(scale.dtype() == phi::DataType::FLOAT32 &&
+                        amax_history.dtype() == phi::DataType::FLOAT32,
+                    true,
+                    phi::errors::InvalidArgument(
+                        "Input(scale) and Input(amax_history) of "
+                        "Fp8CastTransposeOp should be float32."));
+  phi::DataType dtype;
+  if (out_dtype == "float8_e4m3fn") {
+    dtype = phi::DataType::FLOAT8_E4M3FN;
+  } else if (out_dtype == "float8_e5m2") {
+    dtype = phi::DataType::FLOAT8_E5M2;
+  } else {
+    PADDLE_THROW(phi::errors::InvalidArgument(
+        "The out_dtype of Fp8CastTransposeOp should be float8_e4m3fn or "
+        "float8_e5m2, but received %s.",
+        out_dtype));
+  }
+  out->set_dims(x_dims);
+  out->set_dtype(dtype);
+  out_t->set_dims({x_dims[1], x_dims[0]});
+  out_t->set_dtype(dtype);
+  amax_history_out->set_dims(amax_history.dims());
+  amax_history_out->set_dtype(amax_history.dtype());
+}
+
+void Fp8ScaledGemmInferMeta(const MetaTensor& x,
+                            const MetaTensor& y,
+                            const MetaTensor& x_scale_inv,
+                            const MetaTensor& y_scale_inv,
+                            const MetaTensor& bias,
+                            const std::string& output_dtype,
+                            MetaTensor* out,
+                            MetaConfig config) {
+  const auto& x_dims = x.dims();
+  const auto& y_dims = y.dims();
+  PADDLE_ENFORCE_EQ(x_dims.size() == 2 && y_dims.size() == 2,
+                    true,
+                    phi::errors::InvalidArgument(
+                        "Input(x) and Input(y) of Fp8ScaledGemmOp should be "
+                        "2-D, but received %d-D and %d-D.",
+                        x_dims.size(),
+                        y_dims.size()));
+  if (config.is_runtime || (x_dims[1] > 0 && y_dims[1] > 0)) {
+    PADDLE_ENFORCE_EQ(x_dims[1],
+                      y_dims[1],
+                      phi::errors::InvalidArgument(
+                          "Input(x) [m, k] and Input(y) [n, k] of "
+                          "Fp8ScaledGemmOp should have the same k, but "
+                          "received %d and %d.",
+                          x_dims[1],
+                          y_dims[1]));
+  }
+  if (bias.initialized()) {
+    PADDLE_ENFORCE_EQ(bias.dims().size(),
+                      1,
+                      phi::errors::InvalidArgument(
+                          "Input(bias) of Fp8ScaledGemmOp should be 1-D, but "
+                          "received %d-D.",
+                          bias.dims().size()));
+  }
+  out->set_dims({x_dims[0], y_dims[0]});
+  out->set_layout(x.layout());
+  if (output_dtype == "bfloat16") {
+    out->set_dtype(phi::DataType::BFLOAT16);
+  } else if (output_dtype == "float16") {
+    out->set_dtype(phi::DataType::FLOAT16);
+  } else {
+    PADDLE_THROW(phi::errors::InvalidArgument(
+        "fp8_scaled_gemm only support bfloat16 and float16 output, but "
+        "received %s.",
+        output_dtype));
+  }
+}
+
+void Fp8UpdateScaleInferMeta(const MetaTensor& amax_history,
+                             const MetaTensor& scale,
+                             float fp8_max,
+                             float margin,
+                             MetaTensor* amax_history_out,
+                             MetaTensor* scale_out,
+                             MetaTensor* scale_inv) {
+  PADDLE_ENFORCE_EQ(amax_history.dims().size(),
+                    1,
+                    phi::errors::InvalidArgument(
+                        "Input(amax_history) of Fp8UpdateScaleOp should be "
+                        "1-D, but received %d-D.",
+                        amax_history.dims().size()));
+  PADDLE_ENFORCE_GT(fp8_max,
+                    0.0f,
+                    phi::errors::InvalidArgument(
+                        "The fp8_max of Fp8UpdateScaleOp should be greater "
+                        "than 0, but received %f.",
+                        fp8_max));
+  amax_history_out->set_dims(amax_history.dims());
+  amax_history_out->set_dtype(amax_history.dtype());
+  scale_out->set_dims(scale.dims());
+  scale_out->set_dtype(scale.dtype());
+  scale_inv->set_dims(scale.dims());
+  scale_inv->set_dtype(scale.dtype());
+}
+
 void FusedEmbeddingFcLstmInferMeta(const MetaTensor& ids,
                                    const MetaTensor& embeddings,
                                    const MetaTensor& weight_h,
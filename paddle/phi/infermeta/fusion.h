@@ -767,6 +767,29 @@ void FusedEmbeddingEltWiseLayerNormInferMeta(
     const float epsilon,
     MetaTensor* out);
 
+void FusedEmbeddingSeqpoolInferMeta(const std::vector<const MetaTensor*>& ids,
+                                    const MetaTensor& weight,
+                                    const std::string& pooltype,
+                                    int64_t padding_idx,
+                                    float pad_value,
+                                    std::vector<MetaTensor*> out);
+
+void FusedSoftmaxCrossEntropyInferMeta(const MetaTensor& logits,
+                                       const MetaTensor& label,
+                                       int64_t ignore_index,
+                                       int ring_id,
+                                       int rank,
+                                       int nranks,
+                                       MetaTensor* loss,
+                                       MetaTensor* logsumexp,
+                                       MetaConfig config = MetaConfig());
+
+void MoeGroupedGemmInferMeta(const MetaTensor& x,
+                             const MetaTensor& expert_id,
+                             const MetaTensor& weight,
+                             MetaTensor* out,
+                             MetaConfig config = MetaConfig());
+
 void FusionTransposeFlattenConcatInferMeta(
     const std::vector<const MetaTensor*>& x,
     const std::vector<int>& trans_axis,
@@ -851,6 +874,25 @@ void FusionSeqExpandConcatFCInferMeta(const std::vector<const MetaTensor*>& x,
                                       MetaTensor* out,
                                       MetaTensor* fc_out);
 
+void FusedBeamSearchStepInferMeta(const MetaTensor& logits,
+                                  const MetaTensor& cum_scores,
+                                  const MetaTensor& finished,
+                                  const MetaTensor& seq_lens,
+                                  const MetaTensor& block_tables,
+                                  const MetaTensor& key_cache,
+                                  const MetaTensor& value_cache,
+                                  int beam_size,
+                                  int end_id,
+                                  float length_penalty,
+                                  MetaTensor* ids,
+                                  MetaTensor* parent_idx,
+                                  MetaTensor* cum_scores_out,
+                                  MetaTensor* finished_out,
+                                  MetaTensor* seq_lens_out,
+                                  MetaTensor* block_tables_out,
+                                  MetaTensor* key_cache_out,
+                                  MetaTensor* value_cache_out);
+
 void FusedBiasDropoutResidualLnInferMeta(
     const MetaTensor& x,
     const MetaTensor& residual,
@@ -1088,6 +1130,31 @@ void FP8OutHalfGemmFusedInferMeta(
     const std::string& activation_type,
     MetaTensor* out);
 
+void Fp8CastTransposeInferMeta(const MetaTensor& x,
+                               const MetaTensor& scale,
+                               const MetaTensor& amax_history,
+                               const std::string& out_dtype,
+                               MetaTensor* out,
+                               MetaTensor* out_t,
+                               MetaTensor* amax_history_out);
+
+void Fp8ScaledGemmInferMeta(const MetaTensor& x,
+                            const MetaTensor& y,
+                            const MetaTensor& x_scale_inv,
+                            const MetaTensor& y_scale_inv,
+                            const MetaTensor& bias,
+                            const std::string& output_dtype,
+                            MetaTensor* out,
+                            MetaConfig config = MetaConfig());
+
+void Fp8UpdateScaleInferMeta(const MetaTensor& amax_history,
+                             const MetaTensor& scale,
+                             float fp8_max,
+                             float margin,
+                             MetaTensor* amax_history_out,
+                             MetaTensor* scale_out,
+                             MetaTensor* scale_inv);
+
 void FusedEmbeddingFcLstmInferMeta(const MetaTensor& ids,
                                    const MetaTensor& embeddings,
                                    const MetaTensor& weight_h,
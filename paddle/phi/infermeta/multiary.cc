@@ -5788,6 +5788,7 @@ void FusedAdamInferMeta(
     const std::vector<const MetaTensor*>& beta2_pows,
     const paddle::optional<std::vector<const MetaTensor*>>& master_params,
     const MetaTensor& skip_update,
+    const MetaTensor& loss_scaling,
     const Scalar& beta1,
     const Scalar& beta2,
     const Scalar& epsilon,
@@ -5796,12 +5797,14 @@ void FusedAdamInferMeta(
     bool use_adamw,
     bool multi_precision,
     bool use_global_beta_pow,
+    float clip_norm,
     std::vector<MetaTensor*> params_out,
     std::vector<MetaTensor*> moments1_out,
     std::vector<MetaTensor*> moments2_out,
     std::vector<MetaTensor*> beta1_pows_out,
     std::vector<MetaTensor*> beta2_pows_out,
-    std::vector<MetaTensor*> master_params_out) {
+    std::vector<MetaTensor*> master_params_out,
+    MetaTensor* found_inf) {
   size_t in_size = params.size();
   for (size_t i = 0; i < in_size; i++) {
     params_out[i]->set_dims(params[i]->dims());
@@ -5819,6 +5822,10 @@ void FusedAdamInferMeta(
       master_params_out[i]->set_dtype(master_params.get()[i]->dtype());
     }
   }
+  if (found_inf != nullptr) {
+    found_inf->set_dims({1});
+    found_inf->set_dtype(DataType::BOOL);
+  }
 }
 
 void FusedConvInferMeta(const MetaTensor& input,
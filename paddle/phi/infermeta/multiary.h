@@ -1125,6 +1125,7 @@ void FusedAdamInferMeta(
     const std::vector<const MetaTensor*>& beta2_pows,
     const paddle::optional<std::vector<const MetaTensor*>>& master_params,
     const MetaTensor& skip_update,
+    const MetaTensor& loss_scaling,
     const Scalar& beta1,
     const Scalar& beta2,
     const Scalar& epsilon,
@@ -1133,12 +1134,14 @@ void FusedAdamInferMeta(
     bool use_adamw,
     bool multi_precision,
     bool use_global_beta_pow,
+    float clip_norm,
     std::vector<MetaTensor*> params_out,
     std::vector<MetaTensor*> moments1_out,
     std::vector<MetaTensor*> moments2_out,
     std::vector<MetaTensor*> beta1_pows_out,
     std::vector<MetaTensor*> beta2_pows_out,
-    std::vector<MetaTensor*> master_params_out);
+    std::vector<MetaTensor*> master_params_out,
+    MetaTensor* found_inf);
 
 void FusedConvInferMeta(const MetaTensor& input,
                         const MetaTensor& filter,
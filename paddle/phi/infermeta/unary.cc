@@ -3872,6 +3872,90 @@ void ReshapeWithXShapeInferMeta(const MetaTensor& x,
   ReshapeInferMeta(x, shape, out, config);
 }
 
+void ResizedCropNormalizeInferMeta(const MetaTensor& x,
+                                   const std::vector<int>& crop,
+                                   const std::vector<int>& size,
+                                   bool flip,
+                                   const std::vector<float>& mean,
+                                   const std::vector<float>& std,
+                                   MetaTensor* out) {
+  const auto& x_dims = x.dims();
+  int rank = x_dims.size();
+  PADDLE_ENFORCE_EQ(
+      rank == 3 || rank == 4,
+      true,
+      phi::errors::InvalidArgument("The images of resized_crop_normalize "
+                                   "should be [C, H, W] or [N, C, H, W], but "
+                                   "received the shape [%s].",
+                                   x_dims));
+  PADDLE_ENFORCE_EQ(
+      crop.size(),
+      4,
+      phi::errors::InvalidArgument("The crop should be [top, left, height, "
+                                   "width], but received %d values.",
+                                   crop.size()));
+  PADDLE_ENFORCE_EQ(
+      size.size(),
+      2,
+      phi::errors::InvalidArgument("The size should be [height, width], but "
+                                   "received %d values.",
+                                   size.size()));
+  PADDLE_ENFORCE_EQ(
+      crop[0] >= 0 && crop[1] >= 0 && crop[2] > 0 && crop[3] > 0,
+      true,
+      phi::errors::InvalidArgument("The crop [%d, %d, %d, %d] is invalid.",
+                                   crop[0],
+                                   crop[1],
+                                   crop[2],
+                                   crop[3]));
+  PADDLE_ENFORCE_EQ(
+      size[0] > 0 && size[1] > 0,
+      true,
+      phi::errors::InvalidArgument(
+          "The size [%d, %d] should be positive.", size[0], size[1]));
+  int64_t in_h = x_dims[rank - 2];
+  int64_t in_w = x_dims[rank - 1];
+  if (in_h >= 0 && in_w >= 0) {
+    PADDLE_ENFORCE_EQ(crop[0] + crop[2] <= in_h && crop[1] + crop[3] <= in_w,
+                      true,
+                      phi::errors::InvalidArgument(
+                          "The crop [%d, %d, %d, %d] is out of the images of "
+                          "%d x %d.",
+                          crop[0],
+                          crop[1],
+                          crop[2],
+                          crop[3],
+                          in_h,
+                          in_w));
+  }
+  int64_t channels = x_dims[rank - 3];
+  for (const auto* values : {&mean, &std}) {
+    PADDLE_ENFORCE_EQ(
+        values->size() <= 1 || channels < 0 ||
+            static_cast<int64_t>(values->size()) == channels,
+        true,
+        phi::errors::InvalidArgument(
+            "The mean and std should have 1 or %d values for the images of "
+            "%d channels, but received %d values.",
+            channels,
+            channels,
+            values->size()));
+  }
+  for (float s : std) {
+    PADDLE_ENFORCE_NE(
+        s,
+        0.0f,
+        phi::errors::InvalidArgument("The std should not be zero."));
+  }
+
+  auto out_dims = x_dims;
+  out_dims[rank - 2] = size[0];
+  out_dims[rank - 1] = size[1];
+  out->set_dims(out_dims);
+  out->set_dtype(DataType::FLOAT32);
+  out->set_layout(x.layout());
+}
+
 void ReverseInferMeta(const MetaTensor& x,
                       const IntArray& axis,
                       MetaTensor* out,
@@ -632,6 +632,14 @@ void ReshapeWithXShapeInferMeta(const MetaTensor& x,
                                 MetaTensor* xshape,
                                 MetaConfig config = MetaConfig());
 
+void ResizedCropNormalizeInferMeta(const MetaTensor& x,
+                                   const std::vector<int>& crop,
+                                   const std::vector<int>& size,
+                                   bool flip,
+                                   const std::vector<float>& mean,
+                                   const std::vector<float>& std,
+                                   MetaTensor* out);
+
 void ReverseInferMeta(const MetaTensor& x,
                       const IntArray& axis,
                       MetaTensor* out,
@@ -14,12 +14,202 @@
 
 #include "paddle/phi/kernels/autotune/cache.h"
 
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
+#include <map>
+#include <sstream>
 
 #include "glog/logging.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_string(autotune_cache_file);
 
 namespace phi::autotune {
 
+namespace {
+
+// The separator of the key and the algorithm of a line in the cache file.
+constexpr char kCacheFileSeparator[] = " = ";
+
+constexpr size_t kMaxCachedDimsSize = 64;
+
+std::string EnvKey() {
+  std::ostringstream os;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  int device_id = phi::backends::gpu::GetCurrentDeviceId();
+  os << "arch:" << phi::backends::gpu::GetGPUComputeCapability(device_id)
+     << ",driver:" << phi::backends::gpu::GetGPUDriverVersion(device_id)
+     << ",runtime:" << phi::backends::gpu::GetGPURuntimeVersion(device_id)
+     << ",dnn:" << phi::backends::gpu::DnnVersion();
+#else
+  os << "cpu";
+#endif
+  return os.str();
+}
+
+bool IsConvAlgorithmType(int64_t algo_type) {
+  return algo_type == static_cast<int64_t>(AlgorithmType::kConvForward) ||
+         algo_type == static_cast<int64_t>(AlgorithmType::kConvBackwardData) ||
+         algo_type == static_cast<int64_t>(AlgorithmType::kConvBackwardFilter);
+}
+
+template <typename T>
+void WriteVector(const std::vector<T>& values, std::ostream* os) {
+  *os << ' ' << values.size();
+  for (const auto& value : values) {
+    *os << ' ' << value;
+  }
+}
+
+template <typename T>
+bool ReadVector(std::istream* is, std::vector<T>* values) {
+  size_t size = 0;
+  if (!(*is >> size) || size > kMaxCachedDimsSize) {
+    return false;
+  }
+  values->resize(size);
+  for (auto& value : *values) {
+    if (!(*is >> value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The key of a conv algorithm in the cache file, e.g.
+// "arch:80,driver:12020,runtime:12010,dnn:8902 1 10 1 0 4 8 3 32 32 ...".
+std::string ConvEntryKey(const std::string& env_key,
+                         int64_t algo_type,
+                         const ConvCacheKey& key) {
+  std::ostringstream os;
+  os << env_key << ' ' << algo_type << ' ' << static_cast<int>(key.dtype)
+     << ' ' << key.groups << ' ' << key.data_layout;
+  WriteVector(key.x_dims, &os);
+  WriteVector(key.w_dims, &os);
+  WriteVector(key.strides, &os);
+  WriteVector(key.paddings, &os);
+  WriteVector(key.dilations, &os);
+  return os.str();
+}
+
+bool ParseConvEntryKey(const std::string& entry_key,
+                       std::string* env_key,
+                       int64_t* algo_type,
+                       ConvCacheKey* key) {
+  std::istringstream is(entry_key);
+  int dtype = 0;
+  if (!(is >> *env_key >> *algo_type >> dtype >> key->groups >>
+        key->data_layout)) {
+    return false;
+  }
+  key->dtype = static_cast<phi::DataType>(dtype);
+  return ReadVector(&is, &key->x_dims) && ReadVector(&is, &key->w_dims) &&
+         ReadVector(&is, &key->strides) && ReadVector(&is, &key->paddings) &&
+         ReadVector(&is, &key->dilations);
+}
+
+// Reads the lines of path as the map from the key to the algorithm.
+std::map<std::string, std::string> ReadCacheFile(const std::string& path) {
+  std::map<std::string, std::string> entries;
+  std::ifstream fin(path);
+  std::string line;
+  while (std::getline(fin, line)) {
+    auto pos = line.find(kCacheFileSeparator);
+    if (pos == std::string::npos) {
+      continue;
+    }
+    entries[line.substr(0, pos)] =
+        line.substr(pos + sizeof(kCacheFileSeparator) - 1);
+  }
+  return entries;
+}
+
+}  // namespace
+
+AutoTuneCache::AutoTuneCache() : autotune_cache_mutex_(new std::mutex()) {
+  for (int i = 1; i < static_cast<int>(AlgorithmType::kAlgorithmCount); ++i) {
+    Register(static_cast<AlgorithmType>(i));
+  }
+  if (!FLAGS_autotune_cache_file.empty()) {
+    LoadFromFile(FLAGS_autotune_cache_file);
+  }
+}
+
+AutoTuneCache::~AutoTuneCache() {
+  // The env key is set when the cache is loaded, since the device may not be
+  // queried at exit.
+  if (!FLAGS_autotune_cache_file.empty() && !env_key_.empty()) {
+    SaveToFile(FLAGS_autotune_cache_file);
+  }
+}
+
+int64_t AutoTuneCache::LoadFromFile(const std::string& path) {
+  if (env_key_.empty()) {
+    env_key_ = EnvKey();
+  }
+  int64_t num_loaded = 0;
+  for (const auto& entry : ReadCacheFile(path)) {
+    std::string env_key;
+    int64_t algo_type = 0;
+    ConvCacheKey key;
+    if (!ParseConvEntryKey(entry.first, &env_key, &algo_type, &key) ||
+        env_key != env_key_ || !IsConvAlgorithmType(algo_type)) {
+      continue;
+    }
+    std::istringstream is(entry.second);
+    ConvAutoTuneResult result;
+    if (!(is >> result.algo >> result.workspace_size)) {
+      continue;
+    }
+    result.exhaustive_search = true;
+    conv_auto_tune_map_[algo_type].Set(key, result);
+    ++num_loaded;
+  }
+  VLOG(3) << "Load " << num_loaded << " conv algorithms of " << env_key_
+          << " from the autotune cache file " << path;
+  return num_loaded;
+}
+
+void AutoTuneCache::SaveToFile(const std::string& path) {
+  if (env_key_.empty()) {
+    env_key_ = EnvKey();
+  }
+  // Keep the algorithms of the other environments and the other problems in
+  // the file, which may be saved by the other jobs.
+  auto entries = ReadCacheFile(path);
+  for (auto& v : conv_auto_tune_map_) {
+    v.second.ForEach(
+        [&](const ConvCacheKey& key, const ConvAutoTuneResult& result) {
+          if (result.exhaustive_search) {
+            entries[ConvEntryKey(env_key_, v.first, key)] =
+                std::to_string(result.algo) + " " +
+                std::to_string(result.workspace_size);
+          }
+        });
+  }
+
+  // Write to a temporary file first, so that the jobs loading the file never
+  // see a partial one.
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path);
+    for (const auto& entry : entries) {
+      fout << entry.first << kCacheFileSeparator << entry.second << '\n';
+    }
+    if (!fout) {
+      LOG(WARNING) << "Failed to write the autotune cache file " << tmp_path;
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to save the autotune cache file " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
+
 size_t TransposeKey(const std::vector<int64_t>& x_dims,
                     const std::vector<int32_t>& perm,
                     phi::DataType dtype) {
@@ -36,6 +226,8 @@ std::string AlgorithmTypeString(int64_t algo_type) {
   } else if (algo_type ==
              static_cast<int64_t>(AlgorithmType::kConvBackwardFilter)) {
     return "conv_backward_filter";
+  } else if (algo_type == static_cast<int64_t>(AlgorithmType::kReduce)) {
+    return "reduce";
   }
 #ifdef PADDLE_WITH_CUDNN_FRONTEND
   if (algo_type == static_cast<int64_t>(AlgorithmType::kConvForwardV8)) {
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <string>
 
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/kernels/autotune/cache_base.h"
@@ -49,21 +50,24 @@ enum class AlgorithmType {
   kGatherGemmScatterFP32NN = 7,
   kGatherGemmScatterFP32TN = 8,
   kGatherGemmScatterFP32NT = 9,
+  kReduce = 10,
+  // The kernel time in ns of the ops measured by the layout autotune.
+  kLayoutCost = 11,
 #if !defined(PADDLE_WITH_CUDNN_FRONTEND)
-  kAlgorithmCount = 10
+  kAlgorithmCount = 12
 #else
-  kConvForwardV8 = 10,
-  kConvBackwardDataV8 = 11,
-  kConvBackwardFilterV8 = 12,
-  kScaleBiasReluConvBNstats = 13,
-  kBNFinalize = 14,
-  kScaleBiasAddRelu = 15,
-  kDgradDreluBnBwdWeight = 16,
-  kDbnApply = 17,
-  kBnActWgrad = 18,
-  kPoolingForwardV8 = 19,
-  kPoolingBackwardV8 = 20,
-  kAlgorithmCount = 21
+  kConvForwardV8 = 12,
+  kConvBackwardDataV8 = 13,
+  kConvBackwardFilterV8 = 14,
+  kScaleBiasReluConvBNstats = 15,
+  kBNFinalize = 16,
+  kScaleBiasAddRelu = 17,
+  kDgradDreluBnBwdWeight = 18,
+  kDbnApply = 19,
+  kBnActWgrad = 20,
+  kPoolingForwardV8 = 21,
+  kPoolingBackwardV8 = 22,
+  kAlgorithmCount = 23
 #endif
 };
 
@@ -158,6 +162,15 @@ class AutoTuneCache {
 
   int64_t CacheMisses() const { return total_cache_misses_; }
 
+  // Loads the conv algorithms searched exhaustively from path, which are
+  // searched on the same device arch with the same driver, CUDA and cuDNN
+  // versions. Returns the number of the algorithms loaded.
+  int64_t LoadFromFile(const std::string& path);
+
+  // Saves the conv algorithms searched exhaustively to path, merged with the
+  // ones already in it.
+  void SaveToFile(const std::string& path);
+
   float CacheHitRate() const {
     float total_cache_hit_rate = 0.;
     int64_t total_num_accesses = total_cache_hits_ + total_cache_misses_;
@@ -169,11 +182,10 @@ class AutoTuneCache {
   }
 
  private:
-  AutoTuneCache() : autotune_cache_mutex_(new std::mutex()) {
-    for (int i = 1; i < static_cast<int>(AlgorithmType::kAlgorithmCount); ++i) {
-      Register(static_cast<AlgorithmType>(i));
-    }
-  }
+  AutoTuneCache();
+
+  // Saves the cache to FLAGS_autotune_cache_file if it is set.
+  ~AutoTuneCache();
 
   void Register(const AlgorithmType& algo_type) {
     std::lock_guard<std::mutex> lock(*autotune_cache_mutex_);
@@ -210,6 +222,9 @@ class AutoTuneCache {
   CudnnV8AlgorithmsTypeMap cudnn_v8_auto_tune_map_;
 #endif
   std::shared_ptr<std::mutex> autotune_cache_mutex_;
+  // The device arch and the library versions the algorithms are searched
+  // with, which keys the algorithms in the cache file.
+  std::string env_key_;
   int64_t total_cache_hits_{0};
   int64_t total_cache_misses_{0};
   int64_t total_size_{0};
@@ -153,6 +153,15 @@ class AlgorithmsCache {
 
   int64_t Size() const { return hash_.size(); }
 
+  // Calls fn(key, algo) for each algorithm cached.
+  template <typename FnT>
+  void ForEach(FnT&& fn) {
+    std::lock_guard<std::mutex> lock(*cache_mutex_);
+    for (const auto& item : hash_) {
+      fn(item.first, item.second);
+    }
+  }
+
  protected:
   std::unordered_map<KeyT, AlgorithmT, HashT, KeyEqualT> hash_;
   std::shared_ptr<std::mutex> cache_mutex_;
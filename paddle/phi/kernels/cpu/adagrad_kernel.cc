@@ -79,23 +79,19 @@ struct SparseAdagradFunctor<phi::CPUContext, T> {
     auto& merge_rows = grad_merge.rows();
     auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
 
-    // 2. m += g_m * g_m
-    auto grad_square =
-        SquareSelectedRows<phi::CPUContext, T>(context, grad_merge);
-
-    phi::funcs::SelectedRowsAddToTensor<phi::CPUContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
-    auto* lr = learning_rate.data<T>();
+    // 2. m += g_m * g_m, and update parameter in the same pass over the
+    // rows, so the moment of a row is still in cache when it is read again.
+    const T lr = learning_rate.data<T>()[0];
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
 
     for (size_t i = 0; i < merge_rows.size(); i++) {
+      const T* g = grad_merge_data + i * grad_width;
+      T* m = moment_data + merge_rows[i] * grad_width;
+      T* p = param_data + merge_rows[i] * grad_width;
       for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
+        m[j] += g[j] * g[j];
+        p[j] -= lr * g[j] / (std::sqrt(m[j]) + epsilon);
       }
     }
   }
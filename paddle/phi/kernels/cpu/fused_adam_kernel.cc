@@ -40,6 +40,7 @@ void FusedAdamKernel(
     const std::vector<const DenseTensor*>& beta2_pows,
     const paddle::optional<std::vector<const DenseTensor*>>& master_params,
     const paddle::optional<DenseTensor>& skip_update,
+    const paddle::optional<DenseTensor>& loss_scaling,
     const Scalar& beta1,
     const Scalar& beta2,
     const Scalar& epsilon,
@@ -48,12 +49,14 @@ void FusedAdamKernel(
     bool use_adamw,
     bool multi_precision,
     bool use_global_beta_pow,
+    float clip_norm,
     std::vector<DenseTensor*> params_out,
     std::vector<DenseTensor*> moments1_out,
     std::vector<DenseTensor*> moments2_out,
     std::vector<DenseTensor*> beta1_pows_out,
     std::vector<DenseTensor*> beta2_pows_out,
-    std::vector<DenseTensor*> master_params_out) {
+    std::vector<DenseTensor*> master_params_out,
+    DenseTensor* found_inf) {
   size_t params_num = params.size();
   PADDLE_ENFORCE_EQ(
       params_num,
@@ -95,6 +98,14 @@ void FusedAdamKernel(
                         "is %d, the size of Input(params) is %d.",
                         beta2_pows.size(),
                         params_num));
+  PADDLE_ENFORCE_EQ(
+      clip_norm <= 0.0f && !loss_scaling,
+      true,
+      errors::Unimplemented("The clip_norm and Input(loss_scaling) of "
+                            "fused_adam are only supported on GPU."));
+  if (found_inf != nullptr) {
+    dev_ctx.template Alloc<bool>(found_inf)[0] = false;
+  }
 
   for (size_t idx = 0; idx < params_num; idx++) {
     auto master_params_tmp = TensorPtrToOptionalTensor(master_params, idx);
@@ -164,4 +175,5 @@ PD_REGISTER_KERNEL(
   kernel->OutputAt(3).SetDataType(phi::DataType::UNDEFINED);
   kernel->OutputAt(4).SetDataType(phi::DataType::UNDEFINED);
   kernel->OutputAt(5).SetDataType(phi::DataType::UNDEFINED);
+  kernel->OutputAt(6).SetDataType(phi::DataType::BOOL);
 }
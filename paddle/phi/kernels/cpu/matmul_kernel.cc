@@ -28,7 +28,10 @@ PD_REGISTER_KERNEL(matmul,
                    int32_t,
                    int64_t,
                    phi::dtype::complex<float>,
-                   phi::dtype::complex<double>) {}
+                   phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
+}
 
 PD_REGISTER_KERNEL(matmul_with_flatten,
                    CPU,
@@ -496,6 +496,33 @@ class SparseAdamFunctor<T, CPUAdam, T> {
     param_out_[i] = p;
   }
 
+  // Updates the rows of param in the merged rows [begin, end) of grad, with
+  // the bias corrections computed once, which is used by the lazy mode.
+  inline void adam_update_rows(int64_t begin, int64_t end) const {
+    T beta1_pow = *beta1_pow_;
+    T beta2_pow = *beta2_pow_;
+    T lr = *lr_ * sqrt(1 - beta2_pow) / (1 - beta1_pow);
+    T epsilon = epsilon_ * sqrt(1 - beta2_pow);
+
+    for (int64_t j = begin; j < end; ++j) {
+      const int64_t offset = rows_[j] * row_numel_;
+      const T* g = grad_ + j * row_numel_;
+      const T* mom1_in = moment1_ + offset;
+      const T* mom2_in = moment2_ + offset;
+      const T* p_in = param_ + offset;
+      T* mom1_out = moment1_out_ + offset;
+      T* mom2_out = moment2_out_ + offset;
+      T* p_out = param_out_ + offset;
+      for (int64_t k = 0; k < row_numel_; ++k) {
+        T mom1 = beta1_ * mom1_in[k] + (1 - beta1_) * g[k];
+        T mom2 = beta2_ * mom2_in[k] + (1 - beta2_) * g[k] * g[k];
+        mom1_out[k] = mom1;
+        mom2_out[k] = mom2;
+        p_out[k] = p_in[k] - lr * (mom1 / (sqrt(mom2) + epsilon));
+      }
+    }
+  }
+
   inline void operator()(size_t numel) const {
     // lr could be reuse
     T lr = *lr_;
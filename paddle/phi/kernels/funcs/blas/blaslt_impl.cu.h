@@ -18,9 +18,12 @@ limitations under the License. */
 
 #include "glog/logging.h"
 
+#include <algorithm>
+
 #include <cuda_runtime_api.h>  // NOLINT
 #include "cuda.h"              // NOLINT
 #include "paddle/phi/backends/dynload/cublasLt.h"
+#include "paddle/phi/backends/gpu/cuda/cuda_graph.h"
 #include "paddle/phi/backends/gpu/cuda/cuda_helper.h"
 
 #include "paddle/common/flags.h"
@@ -32,6 +35,7 @@ limitations under the License. */
 
 COMMON_DECLARE_int64(cublaslt_exhaustive_search_times);
 COMMON_DECLARE_bool(enable_blaslt_global_search);
+COMMON_DECLARE_int64(cublaslt_skinny_gemm_max_m);
 #endif
 
 namespace phi {
@@ -469,6 +473,111 @@ struct MatmulGradDescriptor : MatmulDescriptor {
   }
 };
 
+// The times to run each algorithm while searching the skinny GEMMs, the
+// first of which is the warmup.
+constexpr int kSkinnyGemmSearchTimes = 5;
+
+// The default heuristic algorithm of the skinny GEMMs, such as the ones of
+// decoding with small batch sizes, launches too few tiles to occupy all the
+// SMs, so their split-K variants are searched on the first run of each shape.
+inline bool UseSkinnyGemmSearch(const MatmulDescriptor* desc,
+                                phi::funcs::MatmulPlanner* planner) {
+  // The timing runs would accumulate into the output when beta is 1, and can
+  // not wait for the stream while capturing a CUDA graph.
+  return desc->M_ > 0 && desc->M_ <= FLAGS_cublaslt_skinny_gemm_max_m &&
+         !planner->UseAddTo() &&
+         !phi::backends::gpu::CUDAGraph::IsThisThreadCapturing();
+}
+
+// Appends the split-K variants of the first heuristic algorithms supporting
+// split-K to results, skipping the ones which need a larger workspace.
+inline void AppendSplitKAlgos(
+    const cublasLtHandle_t& lt_handle,
+    const MatmulDescriptor* desc,
+    size_t workspace_size,
+    std::vector<cublasLtMatmulHeuristicResult_t>* results) {
+  constexpr int kMaxBaseAlgos = 2;
+  // Each split should still be deep enough to hide the latency of the loads.
+  constexpr int64_t kMinSplitKSize = 256;
+  constexpr uint32_t kSplitKNums[] = {2, 4, 8, 16, 32};
+
+  const size_t num_heuristic_results = results->size();
+  int num_base_algos = 0;
+  for (size_t i = 0;
+       i < num_heuristic_results && num_base_algos < kMaxBaseAlgos;
+       ++i) {
+    cublasLtMatmulAlgo_t algo = (*results)[i].algo;
+    size_t attr_size = 0;
+    int32_t split_k_support = 0;
+    PADDLE_ENFORCE_GPU_SUCCESS(dynload::cublasLtMatmulAlgoCapGetAttribute(
+        &algo,
+        CUBLASLT_ALGO_CAP_SPLITK_SUPPORT,
+        &split_k_support,
+        sizeof(split_k_support),
+        &attr_size));
+    uint32_t split_k_num = 1;
+    PADDLE_ENFORCE_GPU_SUCCESS(dynload::cublasLtMatmulAlgoConfigGetAttribute(
+        &algo,
+        CUBLASLT_ALGO_CONFIG_SPLITK_NUM,
+        &split_k_num,
+        sizeof(split_k_num),
+        &attr_size));
+    uint32_t reduction_mask = 0;
+    PADDLE_ENFORCE_GPU_SUCCESS(dynload::cublasLtMatmulAlgoCapGetAttribute(
+        &algo,
+        CUBLASLT_ALGO_CAP_REDUCTION_SCHEME_MASK,
+        &reduction_mask,
+        sizeof(reduction_mask),
+        &attr_size));
+    // Reducing the partial results in the compute type keeps the precision
+    // of the fp16 and bf16 outputs.
+    uint32_t reduction_scheme =
+        (reduction_mask & CUBLASLT_REDUCTION_SCHEME_COMPUTE_TYPE)
+            ? CUBLASLT_REDUCTION_SCHEME_COMPUTE_TYPE
+            : CUBLASLT_REDUCTION_SCHEME_INPLACE;
+    if (split_k_support == 0 || split_k_num > 1 ||
+        (reduction_mask & reduction_scheme) == 0) {
+      continue;
+    }
+    ++num_base_algos;
+
+    for (uint32_t split_k : kSplitKNums) {
+      if (static_cast<int64_t>(split_k) * kMinSplitKSize > desc->K_) {
+        break;
+      }
+      cublasLtMatmulAlgo_t split_k_algo = algo;
+      PADDLE_ENFORCE_GPU_SUCCESS(dynload::cublasLtMatmulAlgoConfigSetAttribute(
+          &split_k_algo,
+          CUBLASLT_ALGO_CONFIG_SPLITK_NUM,
+          &split_k,
+          sizeof(split_k)));
+      PADDLE_ENFORCE_GPU_SUCCESS(dynload::cublasLtMatmulAlgoConfigSetAttribute(
+          &split_k_algo,
+          CUBLASLT_ALGO_CONFIG_REDUCTION_SCHEME,
+          &reduction_scheme,
+          sizeof(reduction_scheme)));
+      // The variants unsupported by the shape fail the check.
+      cublasLtMatmulHeuristicResult_t result;
+      auto status = dynload::cublasLtMatmulAlgoCheck(lt_handle,
+                                                     desc->op_desc,
+                                                     desc->y_desc,
+                                                     desc->x_desc,
+                                                     desc->out_desc,
+                                                     desc->out_desc,
+                                                     &split_k_algo,
+                                                     &result);
+      if (status != CUBLAS_STATUS_SUCCESS ||
+          result.workspaceSize > workspace_size) {
+        continue;
+      }
+      result.algo = split_k_algo;
+      results->push_back(result);
+    }
+  }
+  VLOG(6) << "[MatmulWithCublaslt] append "
+          << results->size() - num_heuristic_results << " split-K algos";
+}
+
 template <typename T, typename OutT = T, class MatmulDescT = MatmulDescriptor>
 struct CublasLtBase {
  public:
@@ -499,7 +608,9 @@ struct CublasLtBase {
     phi::Allocator::AllocationPtr workspace = GetWorkspace(ctx, workspace_size);
 
     if (planner != nullptr) {
-      if (phi::autotune::AutoTuneStatus::Instance().UseAutoTune() &&
+      bool search_split_k = UseSkinnyGemmSearch(desc, planner);
+      if ((phi::autotune::AutoTuneStatus::Instance().UseAutoTune() ||
+           search_split_k) &&
           (!desc->is_cached)) {
         SearchBestAlgo(ctx,
                        cublaslt_handle,
@@ -510,7 +621,8 @@ struct CublasLtBase {
                        x_ptr,
                        out_ptr,
                        workspace->ptr(),
-                       workspace_size);
+                       workspace_size,
+                       search_split_k);
         MatmulDescT* best_desc = new MatmulDescT(*desc);
         VLOG(6) << best_desc->GetDescResultString(
             "[Searched CublasltDescriptor] ");
@@ -549,7 +661,8 @@ struct CublasLtBase {
                              const void* x_data,
                              void* out_data,
                              void* workspace_ptr,
-                             size_t workspace_size) {
+                             size_t workspace_size,
+                             bool search_split_k = false) {
     cublasLtMatmulPreference_t preference;
     PADDLE_ENFORCE_GPU_SUCCESS(
         dynload::cublasLtMatmulPreferenceCreate(&preference));
@@ -577,12 +690,19 @@ struct CublasLtBase {
     PADDLE_ENFORCE_GT(returned_results,
                       0,
                       phi::errors::Unavailable("No GEMM algorithm available."));
+    heuristic_results.resize(returned_results);
+    int repeats = FLAGS_cublaslt_exhaustive_search_times;
+    if (search_split_k) {
+      AppendSplitKAlgos(lt_handle, desc, workspace_size, &heuristic_results);
+      repeats = std::max(repeats, kSkinnyGemmSearchTimes);
+    }
+    const int num_algos = static_cast<int>(heuristic_results.size());
     int best_algo_idx = -1;
-    if (returned_results == 1 || FLAGS_cublaslt_exhaustive_search_times <= 0) {
+    if (num_algos == 1 || repeats <= 0) {
       best_algo_idx = 0;
     } else {
       float min_time_cost = std::numeric_limits<float>::max();
-      for (int algo_idx = 0; algo_idx < returned_results; ++algo_idx) {
+      for (int algo_idx = 0; algo_idx < num_algos; ++algo_idx) {
         float cur_time_cost =
             RunAndMeasureAlgo(ctx,
                               lt_handle,
@@ -594,7 +714,8 @@ struct CublasLtBase {
                               out_data,
                               workspace_ptr,
                               workspace_size,
-                              &(heuristic_results[algo_idx].algo));
+                              &(heuristic_results[algo_idx].algo),
+                              repeats);
         VLOG(6) << "[MatmulWithCublaslt] algo[" << algo_idx
                 << "] time: " << cur_time_cost << " s";
 
@@ -623,8 +744,8 @@ struct CublasLtBase {
                                  void* out_data,
                                  void* workspace_ptr,
                                  size_t workspace_size,
-                                 cublasLtMatmulAlgo_t* algo) {
-    int repeats = FLAGS_cublaslt_exhaustive_search_times;
+                                 cublasLtMatmulAlgo_t* algo,
+                                 int repeats) {
     if (repeats <= 0) {
       return std::numeric_limits<float>::max();
     }
@@ -712,7 +833,9 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
       cache.SetSubKey(sub_key, reinterpret_cast<void*>(best_desc));
     } else {
       workspace = GetWorkspace(ctx, workspace_size);
-      if (phi::autotune::AutoTuneStatus::Instance().UseAutoTune() &&
+      bool search_split_k = UseSkinnyGemmSearch(desc, planner);
+      if ((phi::autotune::AutoTuneStatus::Instance().UseAutoTune() ||
+           search_split_k) &&
           (!desc->is_cached)) {
         SearchBestAlgo(ctx,
                        cublaslt_handle,
@@ -723,7 +846,8 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
                        x_ptr,
                        out_ptr,
                        workspace->ptr(),
-                       workspace_size);
+                       workspace_size,
+                       search_split_k);
         MatmulDescriptor* best_desc = new MatmulDescriptor(*desc);
         VLOG(6) << best_desc->GetDescResultString(
             "[Searched CublasltDescriptor] ");
@@ -832,7 +956,8 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
                              const void* x_data,
                              void* out_data,
                              void* workspace_ptr,
-                             size_t workspace_size) {
+                             size_t workspace_size,
+                             bool search_split_k = false) {
     cublasLtMatmulPreference_t preference;
     PADDLE_ENFORCE_GPU_SUCCESS(
         dynload::cublasLtMatmulPreferenceCreate(&preference));
@@ -860,12 +985,19 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
     PADDLE_ENFORCE_GT(returned_results,
                       0,
                       phi::errors::Unavailable("No GEMM algorithm available."));
+    heuristic_results.resize(returned_results);
+    int repeats = FLAGS_cublaslt_exhaustive_search_times;
+    if (search_split_k) {
+      AppendSplitKAlgos(lt_handle, desc, workspace_size, &heuristic_results);
+      repeats = std::max(repeats, kSkinnyGemmSearchTimes);
+    }
+    const int num_algos = static_cast<int>(heuristic_results.size());
     int best_algo_idx = -1;
-    if (returned_results == 1 || FLAGS_cublaslt_exhaustive_search_times <= 0) {
+    if (num_algos == 1 || repeats <= 0) {
       best_algo_idx = 0;
     } else {
       float min_time_cost = std::numeric_limits<float>::max();
-      for (int algo_idx = 0; algo_idx < returned_results; ++algo_idx) {
+      for (int algo_idx = 0; algo_idx < num_algos; ++algo_idx) {
         float cur_time_cost =
             RunAndMeasureAlgo(ctx,
                               lt_handle,
@@ -877,7 +1009,8 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
                               out_data,
                               workspace_ptr,
                               workspace_size,
-                              &(heuristic_results[algo_idx].algo));
+                              &(heuristic_results[algo_idx].algo),
+                              repeats);
         VLOG(6) << "[MatmulWithCublaslt] algo[" << algo_idx
                 << "] time: " << cur_time_cost << " s";
 
@@ -906,8 +1039,8 @@ struct CublasLtBase<int8_t, int32_t, MatmulDescriptor> {
                                  void* out_data,
                                  void* workspace_ptr,
                                  size_t workspace_size,
-                                 cublasLtMatmulAlgo_t* algo) {
-    int repeats = FLAGS_cublaslt_exhaustive_search_times;
+                                 cublasLtMatmulAlgo_t* algo,
+                                 int repeats) {
     if (repeats <= 0) {
       return std::numeric_limits<float>::max();
     }
@@ -31,6 +31,18 @@ namespace funcs {
 
 enum BroadcastType { kMixed = 1, kBroadcast = 2, kElementwise = 3 };
 
+#ifndef PADDLE_WITH_XPU_KP
+// The patterns of the inputs once the dims are simplified to [rows, cols]:
+// the same shape as the output, a row of [1, cols], a column of [rows, 1],
+// or a scalar.
+enum RowColumnPattern {
+  kSamePattern = 0,
+  kRowPattern = 1,
+  kColumnPattern = 2,
+  kScalarPattern = 3
+};
+#endif
+
 template <typename OutT, typename Functor, int Arity, int NumOuts>
 struct BroadcastTypeClassifier {
   int64_t numel{0};
@@ -38,6 +50,16 @@ struct BroadcastTypeClassifier {
   bool all_elementwise{true};        // Not used for XPU
   Array<bool, Arity> use_broadcast;  // Not used for XPU
   Array<kps::details::BroadcastConfig, Arity> configs;
+#ifndef PADDLE_WITH_XPU_KP
+  // Set if each input is one of RowColumnPattern after the simplification,
+  // whose indices are computed by a single divmod of the cols.
+  bool row_column_broadcast{false};
+  int64_t cols{0};
+  Array<int, Arity> patterns;
+  kps::details::FastDivMod cols_divmoder;
+  // Set if any input is not contiguous, which is read by its strides.
+  bool has_strided_input{false};
+#endif
   Array<const _ptr_ char *__restrict__, Arity> ins_data;
   Array<_ptr_ OutT *, NumOuts> outs_data;
 
@@ -49,7 +71,10 @@ struct BroadcastTypeClassifier {
 
 #ifndef PADDLE_WITH_XPU_KP
     for (size_t i = 0; i < ins.size(); ++i) {
-      bool is_same_dim = ins[i]->numel() == numel;
+      // The strided input is indexed by its config as the broadcast ones.
+      bool is_strided = !ins[i]->meta().is_contiguous();
+      has_strided_input |= is_strided;
+      bool is_same_dim = ins[i]->numel() == numel && !is_strided;
       if (is_same_dim) {
         use_broadcast[i] = false;
       } else {
@@ -90,7 +115,9 @@ struct BroadcastTypeClassifier {
                                                dims_simplifier.in_dims[0],
                                                dims_simplifier.rank);
 #else
-    if (!all_elementwise) {
+    if (has_strided_input) {
+      InitStridedConfigs(ins, outs, axis);
+    } else if (!all_elementwise) {
       const auto dims_simplifier =
           BroadcastDimsSimplifier(ins, (*outs)[0]->dims(), axis);
       if (VLOG_IS_ON(6)) {
@@ -107,9 +134,74 @@ struct BroadcastTypeClassifier {
                                                      dims_simplifier.rank);
         }
       }
+      InitRowColumnPatterns(ins, dims_simplifier);
     }
 #endif
   }
+
+#ifndef PADDLE_WITH_XPU_KP
+  // The dims are not simplified with the strided inputs, so the configs are
+  // of the reversed dims of the output, with the strides of the strided
+  // inputs and the contiguous strides of the others.
+  void InitStridedConfigs(const std::vector<const DenseTensor *> &ins,
+                          std::vector<DenseTensor *> *outs,
+                          int axis) {
+    const auto &out_dims = (*outs)[0]->dims();
+    const int rank = out_dims.size();
+    for (int i = 0; i < Arity; ++i) {
+      const auto &in_dims = ins[i]->dims();
+      const auto &in_strides = ins[i]->strides();
+      const bool is_strided = !ins[i]->meta().is_contiguous();
+      const int in_rank = in_dims.size();
+      const int offset = in_rank == rank ? 0 : axis;
+      auto &config = configs[i];
+      config.rank = rank;
+      int64_t contiguous_stride = 1;
+      for (int d = rank - 1; d >= 0; --d) {
+        const int k = rank - 1 - d;
+        const int idx = d - offset;
+        config.divmoders[k] = kps::details::FastDivMod(out_dims[d]);
+        config.strides[k] = 0;
+        if (idx >= 0 && idx < in_rank && in_dims[idx] != 1) {
+          config.strides[k] = static_cast<uint32_t>(
+              is_strided ? in_strides[idx] : contiguous_stride);
+        }
+        if (idx >= 0 && idx < in_rank) {
+          contiguous_stride *= in_dims[idx];
+        }
+      }
+    }
+  }
+
+  void InitRowColumnPatterns(const std::vector<const DenseTensor *> &ins,
+                             const BroadcastDimsSimplifier &dims_simplifier) {
+    // The simplified dims are reversed, where out_dims[0] is the cols.
+    const int rank = dims_simplifier.rank;
+    if (rank > 2 || numel == 0) {
+      return;
+    }
+    const auto &out_dims = dims_simplifier.out_dims;
+    const int64_t rows = rank == 2 ? out_dims[1] : 1;
+    cols = out_dims[0];
+    for (int i = 0; i < Arity; ++i) {
+      const auto &in_dims = dims_simplifier.in_dims[i];
+      const int64_t in_rows = rank == 2 ? in_dims[1] : 1;
+      if (ins[i]->numel() == numel) {
+        patterns[i] = kSamePattern;
+      } else if (ins[i]->numel() == 1) {
+        patterns[i] = kScalarPattern;
+      } else if (in_dims[0] == cols && in_rows == 1) {
+        patterns[i] = kRowPattern;
+      } else if (in_dims[0] == 1 && in_rows == rows) {
+        patterns[i] = kColumnPattern;
+      } else {
+        return;
+      }
+    }
+    cols_divmoder = kps::details::FastDivMod(static_cast<uint32_t>(cols));
+    row_column_broadcast = true;
+  }
+#endif
 };
 
 // Common broadcast/elementwise Loader.
@@ -250,6 +342,39 @@ struct BroadcastDataSetter {
   }
 };
 
+// Loads VecSize elements of one row of the output, which are from one element
+// of the scalars and the columns, or the consecutive ones of the others.
+template <int Index, int VecSize>
+struct RowColumnBroadcastLoader {
+  template <typename Array1, typename Array2, typename ArgsT>
+  static __device__ __forceinline__ void Apply(const Array1 &ins,
+                                               const Array2 &patterns,
+                                               ArgsT *args,
+                                               uint32_t offset,
+                                               uint32_t row,
+                                               uint32_t col) {
+    using Type = std::tuple_element_t<Index, ArgsT>;
+    using VecType = phi::kps::details::VectorType<Type, VecSize>;
+    const auto *__restrict__ in =
+        reinterpret_cast<const _ptr_ Type *__restrict__>(ins[Index]);
+    const int pattern = patterns[Index];
+    if (pattern == kScalarPattern || pattern == kColumnPattern) {
+      const Type value = in[pattern == kScalarPattern ? 0 : row];
+#pragma unroll
+      for (int k = 0; k < VecSize; ++k) {
+        std::get<Index>(args[k]) = value;
+      }
+    } else {
+      const VecType vec_temp = *reinterpret_cast<const VecType *>(
+          in + (pattern == kRowPattern ? col : offset));
+#pragma unroll
+      for (int k = 0; k < VecSize; ++k) {
+        std::get<Index>(args[k]) = vec_temp.val[k];
+      }
+    }
+  }
+};
+
 #endif
 
 // static broadcast unroller
@@ -434,6 +559,44 @@ __global__ void VectorizedBroadcastKernel(
 #endif
 }
 
+#ifndef PADDLE_WITH_XPU_KP
+// The cols are a multiple of VecSize, so the VecSize outputs of a thread are
+// in one row, and both the output and the inputs are accessed by vectors.
+template <typename Functor,
+          typename OutT,
+          int Arity,
+          int NumOuts,
+          int VecSize>
+__global__ void VectorizedRowColumnBroadcastKernel(
+    Array<const _ptr_ char *__restrict__, Arity> ins,
+    Array<_ptr_ OutT *, NumOuts> outs,
+    Array<int, Arity> patterns,
+    uint32_t numel,
+    kps::details::FastDivMod cols_divmoder,
+    Functor func) {
+  using Traits = phi::funcs::FunctionTraits<Functor>;
+  using ArgsT = typename Traits::ArgsTuple;
+  ArgsT args[VecSize];
+  ConditionalT<OutT, NumOuts> result[VecSize];
+
+  uint32_t block_offset = BLOCK_ID_X * BLOCK_NUM_X * VecSize;
+  uint32_t offset = block_offset + THREAD_ID_X * VecSize;
+  if (offset >= numel) {
+    return;
+  }
+  auto row_col = cols_divmoder.Divmod(offset);
+  Unroller<RowColumnBroadcastLoader, VecSize, Arity>::step(
+      ins, patterns, args, offset, row_col.val[0], row_col.val[1]);
+  SameDimsElementwisePrimitiveCaller<ConditionalT<OutT, NumOuts>,
+                                     VecSize,
+                                     Functor,
+                                     ArgsT,
+                                     Arity>()(func, args, result, VecSize);
+  phi::funcs::ElementwiseWriteDataCallerBc<OutT, VecSize, false, NumOuts>()(
+      outs, result, block_offset, VecSize, VecSize);
+}
+#endif
+
 template <typename OutT, typename Functor, int Arity, int NumOuts, int VecSize>
 void LaunchBroadcastKernel(
     const KPDevice &ctx,
@@ -484,6 +647,19 @@ void LaunchBroadcastKernel(
                                          tail_tid,
                                          VecSize,
                                          func);
+  } else if (classifier.row_column_broadcast &&
+             classifier.cols % VecSize == 0) {
+    VectorizedRowColumnBroadcastKernel<Functor,
+                                       OutT,
+                                       Arity,
+                                       NumOuts,
+                                       VecSize>
+        <<<blocks, threads, 0, stream>>>(classifier.ins_data,
+                                         classifier.outs_data,
+                                         classifier.patterns,
+                                         numel,
+                                         classifier.cols_divmoder,
+                                         func);
   } else if (classifier.broadcast_num > (Arity >> 1)) {
     constexpr BroadcastType type_ = (Arity > 1) ? kBroadcast : kMixed;
     VectorizedBroadcastKernel<Functor, OutT, Arity, NumOuts, VecSize, type_>
@@ -755,6 +931,23 @@ void BroadcastKernelApply(const KPDevice &ctx,
       ctx, ins, outs, axis, func);
 }
 
+#ifndef PADDLE_WITH_XPU_KP
+// Whether the strided input can be read by the 32-bit offsets of the
+// broadcast configs, otherwise it should be made contiguous before
+// BroadcastKernel.
+static inline bool IsStridedInputIndexable(const DenseTensor &x,
+                                           int64_t out_numel) {
+  if (out_numel >= std::numeric_limits<int32_t>::max()) {
+    return false;
+  }
+  int64_t max_offset = 0;
+  for (int i = 0; i < x.dims().size(); ++i) {
+    max_offset += (x.dims()[i] - 1) * x.strides()[i];
+  }
+  return max_offset < std::numeric_limits<uint32_t>::max();
+}
+#endif
+
 template <typename OutT, typename Functor, int NumOuts = 1>
 void BroadcastKernel(const KPDevice &ctx,
                      const std::vector<const DenseTensor *> &ins,
@@ -253,11 +253,29 @@ struct normal_distribution<double> {
 };
 #endif
 
+// Initializes the Philox state of the subsequence, the seed and the base
+// offset are read on the device if the kernel is captured by a CUDA Graph.
+template <typename SType>
+__device__ __forceinline__ void PhiloxInit(const PhiloxSeedOffset &seed_offset,
+                                           uint64_t subsequence,
+                                           SType *state) {
+  uint64_t seed = seed_offset.seed;
+  uint64_t offset = seed_offset.offset;
+  if (seed_offset.seed_offset != nullptr) {
+    seed = seed_offset.seed_offset[0];
+    offset += seed_offset.seed_offset[1];
+  }
+#if defined(__NVCC__)
+  curand_init(seed, subsequence, offset, state);
+#else
+  hiprand_init(seed, subsequence, offset, state);
+#endif
+}
+
 /******** Launch GPU function of distribution and transformation *********/
 template <typename T, typename DistOp, typename TransformOp>
 __global__ void DistributionKernel(size_t size,
-                                   uint64_t seed,
-                                   uint64_t offset,
+                                   PhiloxSeedOffset seed_offset,
                                    DistOp dist,
                                    TransformOp trans,
                                    T *out_data,
@@ -266,13 +284,12 @@ __global__ void DistributionKernel(size_t size,
   static constexpr int kCount = DistOp::kReturnsCount;
 #if defined(__NVCC__)
   curandStatePhilox4_32_10_t state;
-  curand_init(seed, idx + THREAD_ID_X, offset, &state);
   using SType = curandStatePhilox4_32_10_t;
 #else
   hiprandStatePhilox4_32_10_t state;
-  hiprand_init(seed, idx + THREAD_ID_X, offset, &state);
   using SType = hiprandStatePhilox4_32_10_t;
 #endif
+  PhiloxInit(seed_offset, idx + THREAD_ID_X, &state);
   size_t total_thread = GRID_NUM_X * BLOCK_NUM_X;
   using MT = typename phi::dtype::MPTypeTrait<T>::Type;
   MT args[kCount];
@@ -314,13 +331,11 @@ void distribution_and_transform(const GPUContext &ctx,
   // 'increment' shoulde be multiple of 4
   uint64_t increment = curand4_loop_times * 4;
 
-  auto seed_offset = gen_cuda->IncrementOffset(increment);
-  uint64_t seed = seed_offset.first;
-  uint64_t offset = seed_offset.second;
+  auto seed_offset = gen_cuda->IncrementPhiloxOffset(increment);
 
   DistributionKernel<T, DistOp, TransformOp>
       <<<grid_size, block_size, 0, ctx.stream()>>>(
-          size, seed, offset, dist, trans, out_data, total_thread);
+          size, seed_offset, dist, trans, out_data, total_thread);
 }
 
 #endif
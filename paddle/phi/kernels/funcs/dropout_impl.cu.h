@@ -126,31 +126,26 @@ struct DstMaskFunctor {
 };
 
 template <typename T>
-__global__ void VectorizedRandomGenerator(
-    unsigned int
-        identifier, /* This is used to relate kernel to cudaGraph nodes*/
-    const size_t n,
-    uint64_t seed,
-    const float dropout_prob,
-    const T* src,
-    uint8_t* mask,
-    T* dst,
-    bool is_upscale_in_train,
-    uint64_t increment,
-    size_t main_offset) {
+__global__ void VectorizedRandomGenerator(const size_t n,
+                                          PhiloxSeedOffset seed_offset,
+                                          const float dropout_prob,
+                                          const T* src,
+                                          uint8_t* mask,
+                                          T* dst,
+                                          bool is_upscale_in_train,
+                                          size_t main_offset) {
   size_t idx = static_cast<size_t>(BLOCK_ID_X * BLOCK_NUM_X);
   static constexpr int kCount =
       phi::funcs::uniform_distribution<float>::kReturnsCount;
   size_t stride = BLOCK_NUM_X * GRID_NUM_X * kCount;
 #ifdef PADDLE_WITH_HIP
   hiprandStatePhilox4_32_10_t state;
-  hiprand_init(seed, idx + THREAD_ID_X, increment, &state);
   using SType = hiprandStatePhilox4_32_10_t;
 #else
   curandStatePhilox4_32_10_t state;
-  curand_init(seed, idx + THREAD_ID_X, increment, &state);
   using SType = curandStatePhilox4_32_10_t;
 #endif
+  PhiloxInit(seed_offset, idx + THREAD_ID_X, &state);
   T dst_mask[kCount *
              2];  // 0 ~ kCount - 1 : dst,  kCount ~ 2 * kCount - 1: mask
   float rands[kCount];
@@ -196,31 +191,29 @@ __global__ void VectorizedRandomGenerator(
 
 template <typename T>
 __global__ void VectorizedGeneratorMask(const size_t n,
-                                        uint64_t seed,
+                                        PhiloxSeedOffset seed_offset,
                                         const float dropout_prob,
                                         const T* src,
                                         uint8_t* mask,
-                                        uint64_t increment,
                                         size_t main_offset,
                                         MaskFunctor<T> mask_functor,
 
                                         const uint64_t* seed_ptr) {
   // Vectorized Generate Mask
   // kCount is 4 for curand_uniform4 is used
-  if (seed_ptr) seed = seed_ptr[0];
+  if (seed_ptr) seed_offset.seed = seed_ptr[0];
 
   constexpr int kCount = phi::funcs::uniform_distribution<float>::kReturnsCount;
   size_t idx = static_cast<size_t>(BLOCK_ID_X * BLOCK_NUM_X);
   size_t stride = BLOCK_NUM_X * GRID_NUM_X * kCount;
 #ifdef PADDLE_WITH_HIP
   hiprandStatePhilox4_32_10_t state;
-  hiprand_init(seed, idx + THREAD_ID_X, increment, &state);
   using SType = hiprandStatePhilox4_32_10_t;
 #else
   curandStatePhilox4_32_10_t state;
-  curand_init(seed, idx + THREAD_ID_X, increment, &state);
   using SType = curandStatePhilox4_32_10_t;
 #endif
+  PhiloxInit(seed_offset, idx + THREAD_ID_X, &state);
   T dst_mask[kCount];  // 0 ~ kCount - 1 : dst,  kCount ~ 2 * kCount - 1: mask
   float rands[kCount];
   uint8_t mask_result[kCount];
@@ -297,8 +290,7 @@ void DropoutFwGPUKernelDriver(
       return;
     }
 
-    uint64_t seed_data;
-    uint64_t increment;
+    PhiloxSeedOffset seed_offset;
     // VectorizedRandomGenerator use curand_uniform4, so kVecSize is 4;
     constexpr int kVecSize =
         phi::funcs::uniform_distribution<float>::kReturnsCount;
@@ -320,24 +312,17 @@ void DropoutFwGPUKernelDriver(
 
     if (is_dropout_nd) {
       auto mask_functor = MaskFunctor<T>(1.0f - dropout_prob);
-      bool copy_in_kernel = GetSeedDataAndIncrement(dev_ctx,
-                                                    seed,
-                                                    is_fix_seed,
-                                                    seed_val,
-                                                    offset,
-                                                    &seed_data,
-                                                    &increment,
-                                                    true);
+      bool copy_in_kernel = GetPhiloxSeedOffset(
+          dev_ctx, seed, is_fix_seed, seed_val, offset, &seed_offset, true);
       const uint64_t* seed_ptr =
           copy_in_kernel ? seed->data<uint64_t>() : nullptr;
 
       VectorizedGeneratorMask<T>
           <<<grid_size, block_size, 0, stream>>>(size,
-                                                 seed_data,
+                                                 seed_offset,
                                                  dropout_prob,
                                                  x_data,
                                                  mask_data,
-                                                 increment,
                                                  main_offset,
                                                  mask_functor,
                                                  seed_ptr);
@@ -347,69 +332,23 @@ void DropoutFwGPUKernelDriver(
       std::vector<phi::DenseTensor*> outs = {y};
       phi::funcs::BroadcastKernel<T>(dev_ctx, ins, &outs, dst_functor);
     } else {
-      bool copy_in_kernel = GetSeedDataAndIncrement(
-          dev_ctx, seed, is_fix_seed, seed_val, offset, &seed_data, &increment);
-      const phi::GPUContext* dev_ctx_p = &dev_ctx;
-      auto gen_cuda = dev_ctx.GetGenerator();
-      auto state_index = gen_cuda->GetStateIndex();
-
-      phi::backends::gpu::CUDAGraphNodeLauncher::parameterSetter_t
-          parameterSetter = [offset, dev_ctx_p, state_index, is_fix_seed](
-                                phi::backends::gpu::gpuKernelParams& params) {
-            if (!is_fix_seed) {
-          // we assume seed is null pointer
-          // seed copy to cpu is meaningless here
-#ifndef PADDLE_WITH_HIP
-              assert(seed_tensor_ptr == nullptr);
-#endif
-              auto gen_cuda = dev_ctx_p->GetGenerator();
-              // ensure the generator use correct state index
-              gen_cuda->SetStateIndex(state_index);
-
-              uint64_t seed, increment;
-              std::tie(seed, increment) = gen_cuda->IncrementOffset(offset);
-
-              params.As<uint64_t>(2) = seed;
-              params.As<uint64_t>(8) = increment;
-
-              VLOG(10) << "CUDA_GRAPH seed = " << seed
-                       << ", increment = " << increment;
-            }
-          };
-
-      phi::backends::gpu::CUDAGraphNodeLauncher::gpuKernelCallback_t
-          cudaKernelCallback = [=](unsigned int id) {
-            void* functionPtr =
-                reinterpret_cast<void*>(&(VectorizedRandomGenerator<T>));
-#ifdef PADDLE_WITH_HIP
-            hipFunction_t cudaFunc =
-                reinterpret_cast<hipFunction_t>(functionPtr);
-#else
-            cudaFunction_t cudaFunc;
-            PADDLE_ENFORCE_GPU_SUCCESS(
-                cudaGetFuncBySymbol(&cudaFunc, functionPtr));
-#endif
-            VLOG(10) << "[cudaKernelCallback] cudaFunc = " << cudaFunc
-                     << " functionPtr = " << functionPtr;
-
-            VectorizedRandomGenerator<T>
-                <<<grid_size, block_size, 0, stream>>>(id,
-                                                       size,
-                                                       seed_data,
-                                                       dropout_prob,
-                                                       x_data,
-                                                       mask_data,
-                                                       y_data,
-                                                       upscale_in_train,
-                                                       increment,
-                                                       main_offset);
-            return cudaFunc;
-          };
-      phi::backends::gpu::CUDAGraphNodeLauncher::Instance().KernelNodeLaunch(
-          parameterSetter, cudaKernelCallback);
-
-      VLOG(10) << "NON_CUDA_GRAPH seed = " << seed_data
-               << ", increment = " << increment;
+      // the seed and the offset are read on the device when the kernel is
+      // captured, so each replay of the CUDA Graph draws a new mask without
+      // updating the kernel node
+      GetPhiloxSeedOffset(
+          dev_ctx, seed, is_fix_seed, seed_val, offset, &seed_offset);
+      VectorizedRandomGenerator<T>
+          <<<grid_size, block_size, 0, stream>>>(size,
+                                                 seed_offset,
+                                                 dropout_prob,
+                                                 x_data,
+                                                 mask_data,
+                                                 y_data,
+                                                 upscale_in_train,
+                                                 main_offset);
+      VLOG(10) << "seed = " << seed_offset.seed
+               << ", offset = " << seed_offset.offset
+               << ", read on device = " << (seed_offset.seed_offset != nullptr);
     }
   } else {
     if (upscale_in_train) {
@@ -52,5 +52,30 @@ inline bool GetSeedDataAndIncrement(const phi::GPUContext& dev_ctx,
   }
 }
 
+// Same as GetSeedDataAndIncrement, but the seed and the offset drawn from the
+// generator are read on the device while a CUDA Graph is captured, so that
+// each replay draws a new mask, see PhiloxSeedOffset.
+inline bool GetPhiloxSeedOffset(const phi::GPUContext& dev_ctx,
+                                const phi::DenseTensor* seed,
+                                const bool is_fix_seed,
+                                const int seed_val,
+                                const int offset,
+                                phi::PhiloxSeedOffset* seed_offset,
+                                bool use_copy = true) {
+  if (seed == nullptr && !is_fix_seed) {
+    *seed_offset = dev_ctx.GetGenerator()->IncrementPhiloxOffset(offset);
+    return false;
+  }
+  *seed_offset = phi::PhiloxSeedOffset();
+  return GetSeedDataAndIncrement(dev_ctx,
+                                 seed,
+                                 is_fix_seed,
+                                 seed_val,
+                                 offset,
+                                 &seed_offset->seed,
+                                 &seed_offset->offset,
+                                 use_copy);
+}
+
 }  // namespace funcs
 }  // namespace phi
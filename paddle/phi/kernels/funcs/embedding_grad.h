@@ -14,8 +14,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <climits>
+
+#ifdef __NVCC__
+#include "cub/cub.cuh"
+#endif
+#ifdef __HIPCC__
+#include <hipcub/hipcub.hpp>
+namespace cub = hipcub;
+#endif
+
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/common/memory_utils.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/funcs/for_range.h"
 
 namespace phi {
 namespace funcs {
@@ -163,5 +177,217 @@ void LaunchEmbeddingGradDeterministicKernel(const GPUContext& ctx,
   }
 }
 
+// The ids of an embedding sorted by value, grouped into the segments of the
+// equal ids. The first num_unique elements of unique_ids, offsets and counts
+// are valid, and positions holds the indices of the sorted ids in the input.
+struct SortedEmbeddingIds {
+  DenseTensor sorted_ids;
+  DenseTensor positions;
+  DenseTensor unique_ids;
+  DenseTensor offsets;
+  DenseTensor counts;
+  DenseTensor num_unique;
+};
+
+struct EmbeddingIdsIotaFunctor {
+  int* out;
+  __device__ void operator()(size_t i) { out[i] = static_cast<int>(i); }
+};
+
+// Sorts the K ids, whose bits from end_bit are all zeros, with a stable radix
+// sort, and encodes the runs of the sorted ids.
+template <typename IdT>
+void SortEmbeddingIds(const GPUContext& ctx,
+                      const IdT* ids,
+                      int64_t K,
+                      int end_bit,
+                      SortedEmbeddingIds* sorted) {
+  PADDLE_ENFORCE_LE(
+      K,
+      INT_MAX,
+      phi::errors::InvalidArgument("The number of the ids of embedding sorted "
+                                   "should be less than %d, but got %d.",
+                                   INT_MAX,
+                                   K));
+  int num = static_cast<int>(K);
+  sorted->sorted_ids.Resize({K});
+  sorted->positions.Resize({K});
+  sorted->unique_ids.Resize({K});
+  sorted->offsets.Resize({K});
+  sorted->counts.Resize({K});
+  sorted->num_unique.Resize({1});
+  IdT* sorted_ids = ctx.Alloc<IdT>(&sorted->sorted_ids);
+  int* positions = ctx.Alloc<int>(&sorted->positions);
+  IdT* unique_ids = ctx.Alloc<IdT>(&sorted->unique_ids);
+  int* offsets = ctx.Alloc<int>(&sorted->offsets);
+  int* counts = ctx.Alloc<int>(&sorted->counts);
+  int* num_unique = ctx.Alloc<int>(&sorted->num_unique);
+
+  DenseTensor iota;
+  iota.Resize({K});
+  int* iota_data = ctx.Alloc<int>(&iota);
+  ForRange<GPUContext> for_range(ctx, K);
+  for_range(EmbeddingIdsIotaFunctor{iota_data});
+
+  size_t sort_bytes = 0;
+  size_t encode_bytes = 0;
+  size_t scan_bytes = 0;
+  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceRadixSort::SortPairs(nullptr,
+                                                             sort_bytes,
+                                                             ids,
+                                                             sorted_ids,
+                                                             iota_data,
+                                                             positions,
+                                                             num,
+                                                             0,
+                                                             end_bit,
+                                                             ctx.stream()));
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cub::DeviceRunLengthEncode::Encode(nullptr,
+                                         encode_bytes,
+                                         sorted_ids,
+                                         unique_ids,
+                                         counts,
+                                         num_unique,
+                                         num,
+                                         ctx.stream()));
+  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceScan::ExclusiveSum(
+      nullptr, scan_bytes, counts, offsets, num, ctx.stream()));
+  size_t temp_bytes = std::max(sort_bytes, std::max(encode_bytes, scan_bytes));
+  auto temp_storage = phi::memory_utils::Alloc(
+      ctx.GetPlace(),
+      temp_bytes,
+      phi::Stream(reinterpret_cast<phi::StreamId>(ctx.stream())));
+
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cub::DeviceRadixSort::SortPairs(temp_storage->ptr(),
+                                      temp_bytes,
+                                      ids,
+                                      sorted_ids,
+                                      iota_data,
+                                      positions,
+                                      num,
+                                      0,
+                                      end_bit,
+                                      ctx.stream()));
+  PADDLE_ENFORCE_GPU_SUCCESS(
+      cub::DeviceRunLengthEncode::Encode(temp_storage->ptr(),
+                                         temp_bytes,
+                                         sorted_ids,
+                                         unique_ids,
+                                         counts,
+                                         num_unique,
+                                         num,
+                                         ctx.stream()));
+  // The runs past num_unique are not written, their offsets are not used.
+  PADDLE_ENFORCE_GPU_SUCCESS(cub::DeviceScan::ExclusiveSum(
+      temp_storage->ptr(), temp_bytes, counts, offsets, num, ctx.stream()));
+}
+
+// Each row of threads sums the grads of one unique id in the order of the ids
+// in the input, and writes the sum to the row of the id in the table if
+// RowById, or to the row of the segment otherwise, so no atomics are needed.
+template <typename T, typename IdT, bool UseLimit, bool RowById>
+__global__ void EmbeddingGradSortedKernel(T* table,
+                                          const T* output,
+                                          const IdT* unique_ids,
+                                          const int* offsets,
+                                          const int* counts,
+                                          const int* num_unique,
+                                          const int* positions,
+                                          const int64_t D,
+                                          const int64_t start_idx,
+                                          const int64_t end_idx) {
+  using MT = typename dtype::MPTypeTrait<T>::Type;
+  const int num = *num_unique;
+  for (int seg = blockIdx.x * blockDim.y + threadIdx.y; seg < num;
+       seg += gridDim.x * blockDim.y) {
+    int64_t row = seg;
+    if (RowById) {
+      row = static_cast<int64_t>(unique_ids[seg]);
+      if (UseLimit) {
+        if (row < start_idx || row >= end_idx) {
+          continue;
+        }
+        row -= start_idx;
+      }
+    }
+    const int begin = offsets[seg];
+    const int end = begin + counts[seg];
+    for (int64_t feature = threadIdx.x; feature < D; feature += blockDim.x) {
+      MT sum = static_cast<MT>(0);
+      for (int i = begin; i < end; ++i) {
+        sum += static_cast<MT>(output[positions[i] * D + feature]);
+      }
+      table[row * D + feature] = static_cast<T>(sum);
+    }
+  }
+}
+
+template <typename T, typename IdT, bool UseLimit, bool RowById>
+void LaunchEmbeddingGradSortedKernel(const GPUContext& ctx,
+                                     const SortedEmbeddingIds& sorted,
+                                     const T* d_out,
+                                     T* out,
+                                     int64_t D,
+                                     int64_t K,
+                                     int64_t start_idx,
+                                     int64_t end_idx) {
+  constexpr int kBlockDimX = 32;
+  constexpr int kBlockDimY = 8;
+  dim3 threads(kBlockDimX, kBlockDimY);
+  dim3 grids(static_cast<unsigned int>(
+      std::min<int64_t>((K + kBlockDimY - 1) / kBlockDimY,
+                        ctx.GetCUDAMaxGridDimSize()[0])));
+  EmbeddingGradSortedKernel<T, IdT, UseLimit, RowById>
+      <<<grids, threads, 0, ctx.stream()>>>(out,
+                                            d_out,
+                                            sorted.unique_ids.data<IdT>(),
+                                            sorted.offsets.data<int>(),
+                                            sorted.counts.data<int>(),
+                                            sorted.num_unique.data<int>(),
+                                            sorted.positions.data<int>(),
+                                            D,
+                                            start_idx,
+                                            end_idx);
+}
+
+// The deterministic grad of embedding without atomics, which sorts the ids
+// and sums the grads of each unique id in one row of threads. It is faster
+// than the kernels with atomics when a few ids are hit many times. The rows
+// of d_table not hit are kept, which should be zeros.
+template <typename T, typename IdT>
+void LaunchEmbeddingGradSortedKernel(const GPUContext& ctx,
+                                     const IdT* ids,
+                                     const T* d_out,
+                                     T* d_table,
+                                     int64_t N,
+                                     int64_t D,
+                                     int64_t K,
+                                     int64_t start_idx = -1) {
+  if (K == 0) {
+    return;
+  }
+  // The ids are less than N without the limit, so only their low bits are
+  // sorted.
+  int end_bit = sizeof(IdT) * 8;
+  if (start_idx < 0) {
+    end_bit = 1;
+    while (end_bit < static_cast<int>(sizeof(IdT) * 8) &&
+           (static_cast<int64_t>(1) << end_bit) < N) {
+      ++end_bit;
+    }
+  }
+  SortedEmbeddingIds sorted;
+  SortEmbeddingIds<IdT>(ctx, ids, K, end_bit, &sorted);
+  if (start_idx < 0) {
+    LaunchEmbeddingGradSortedKernel<T, IdT, false, true>(
+        ctx, sorted, d_out, d_table, D, K, -1, -1);
+  } else {
+    LaunchEmbeddingGradSortedKernel<T, IdT, true, true>(
+        ctx, sorted, d_out, d_table, D, K, start_idx, start_idx + N);
+  }
+}
+
 }  // namespace funcs
 }  // namespace phi
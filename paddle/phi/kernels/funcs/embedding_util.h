@@ -14,7 +14,11 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
 
 namespace phi {
 constexpr int64_t kNoPadding = -1;
@@ -34,4 +38,54 @@ static std::vector<OutT> CopyIdsToVector(const DenseTensor &ids) {
   return ret;
 }
 
+enum class EmbeddingSeqpoolType { kSum = 0, kAverage = 1, kSqrt = 2 };
+
+inline EmbeddingSeqpoolType GetEmbeddingSeqpoolType(
+    const std::string &pooltype) {
+  if (pooltype == "SUM") {
+    return EmbeddingSeqpoolType::kSum;
+  } else if (pooltype == "AVERAGE") {
+    return EmbeddingSeqpoolType::kAverage;
+  } else if (pooltype == "SQRT") {
+    return EmbeddingSeqpoolType::kSqrt;
+  }
+  PADDLE_THROW(phi::errors::InvalidArgument(
+      "The pooltype of fused_embedding_seqpool should be SUM, AVERAGE or "
+      "SQRT, but received %s.",
+      pooltype));
+}
+
+// Resizes out to the shape of sequence_pool(embedding(ids)) with the width
+// of the table D, and returns the offsets of the sequences pooled, which are
+// the last level of the lod of ids.
+inline std::vector<size_t> ResizeEmbeddingSeqpoolOut(const DenseTensor &ids,
+                                                     int64_t D,
+                                                     DenseTensor *out) {
+  const auto &lod = ids.lod();
+  PADDLE_ENFORCE_EQ(
+      lod.empty() || lod.size() > 2UL,
+      false,
+      phi::errors::InvalidArgument("The lod level of the ids of "
+                                   "fused_embedding_seqpool should be 1 or "
+                                   "2, but received %d.",
+                                   lod.size()));
+  const auto &offsets = lod.back();
+  PADDLE_ENFORCE_EQ(
+      offsets.back(),
+      static_cast<size_t>(ids.dims()[0]),
+      phi::errors::InvalidArgument("The last offset of the lod of ids should "
+                                   "be equal to the first dim of ids %d, but "
+                                   "received %d.",
+                                   ids.dims()[0],
+                                   offsets.back()));
+  if (lod.size() > 1UL) {
+    out->set_lod({lod[0]});
+  }
+  auto out_dims = common::vectorize(ids.dims());
+  out_dims.push_back(D);
+  out_dims[0] = static_cast<int64_t>(offsets.size() - 1);
+  out->Resize(common::make_ddim(out_dims));
+  return offsets;
+}
+
 }  // namespace phi
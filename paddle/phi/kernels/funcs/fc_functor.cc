@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/funcs/fc_functor.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/jit/kernels.h"
@@ -100,5 +103,93 @@ void FCFunctor<DeviceContext, T>::operator()(const DeviceContext& context,
 template class FCFunctor<CPUContext, float>;
 template class FCFunctor<CPUContext, double>;
 
+template <typename DeviceContext, typename T>
+void FCInt8Functor<DeviceContext, T>::operator()(
+    const DeviceContext& context,
+    const int M,
+    const int N,
+    const int K,
+    const T* X,
+    const DenseTensor* w_tensor,
+    T* Y,
+    float scale_in,
+    std::vector<float> scale_weights,
+    int quant_round_type,
+    float quant_max_bound,
+    float quant_min_bound,
+    const T* B,
+    bool relu,
+    bool padding_weights) {
+  PADDLE_ENFORCE_EQ(padding_weights,
+                    false,
+                    errors::PermissionDenied(
+                        "Weight padding in fc can not be used with int8."));
+  PADDLE_ENFORCE_EQ(
+      scale_weights.size(),
+      static_cast<size_t>(N),
+      errors::InvalidArgument(
+          "The size of scale_weights (%d) should be equal to the width of "
+          "the weight (%d).",
+          scale_weights.size(),
+          N));
+  const int8_t* W = w_tensor->data<int8_t>();
+
+  DenseTensor quant_x_tensor, quant_y_tensor;
+  quant_x_tensor.Resize({M, K});
+  quant_y_tensor.Resize({M, N});
+  int8_t* quant_x = context.template Alloc<int8_t>(&quant_x_tensor);
+  int32_t* quant_y = context.template Alloc<int32_t>(&quant_y_tensor);
+
+  std::vector<float> dequant_scales(N);
+  for (int j = 0; j < N; ++j) {
+    dequant_scales[j] = 1.0f / (quant_max_bound * quant_max_bound * scale_in *
+                                scale_weights[j]);
+  }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < M; ++i) {
+    int8_t* x_row = quant_x + static_cast<int64_t>(i) * K;
+    for (int k = 0; k < K; ++k) {
+      float value =
+          quant_max_bound * scale_in * static_cast<float>(X[i * K + k]);
+      // 0 rounds half to even, 1 rounds half away from zero
+      value = quant_round_type == 0 ? std::nearbyint(value) : std::round(value);
+      value = std::min(std::max(value, quant_min_bound), quant_max_bound);
+      x_row[k] = static_cast<int8_t>(value);
+    }
+
+    // accumulates the rows of the weight, which are contiguous
+    int32_t* y_row = quant_y + static_cast<int64_t>(i) * N;
+    std::fill(y_row, y_row + N, 0);
+    for (int k = 0; k < K; ++k) {
+      const int32_t x_value = x_row[k];
+      if (x_value == 0) {
+        continue;
+      }
+      const int8_t* w_row = W + static_cast<int64_t>(k) * N;
+      for (int j = 0; j < N; ++j) {
+        y_row[j] += x_value * static_cast<int32_t>(w_row[j]);
+      }
+    }
+
+    T* out_row = Y + static_cast<int64_t>(i) * N;
+    for (int j = 0; j < N; ++j) {
+      float out = static_cast<float>(y_row[j]) * dequant_scales[j];
+      if (B != nullptr) {
+        out += static_cast<float>(B[j]);
+      }
+      if (relu) {
+        out = std::max(out, 0.0f);
+      }
+      out_row[j] = static_cast<T>(out);
+    }
+  }
+}
+
+template class FCInt8Functor<CPUContext, float>;
+template class FCInt8Functor<CPUContext, double>;
+
 }  // namespace funcs
 }  // namespace phi
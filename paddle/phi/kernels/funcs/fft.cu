@@ -174,30 +174,44 @@ void exec_fft(const phi::GPUContext& ctx,
   std::unique_ptr<FFTConfig> config_ = nullptr;
   bool using_cache = use_cache(key.sizes_);
 
+  // a cached plan is shared by all the streams of the device, so it is set to
+  // this stream and launched under the lock of the cache
+  std::unique_lock<std::mutex> guard;
+  DenseTensor workspace_tensor;
+  DenseTensor* workspace = &workspace_tensor;
   if (using_cache) {
     FFTConfigCache& plan_cache = get_fft_plan_cache(device_id);
-    std::unique_lock<std::mutex> guard(plan_cache.mutex, std::defer_lock);
-    guard.lock();
+    guard = std::unique_lock<std::mutex>(plan_cache.mutex);
     config = &(plan_cache.lookup(key));
+    workspace = plan_cache.workspace(ctx.stream());
   } else {
     config_ = std::make_unique<FFTConfig>(key);
     config = config_.get();
   }
 
-  const int64_t workspace_size = static_cast<int64_t>(config->workspace_size());
-  DenseTensor workspace_tensor = Empty<uint8_t>(ctx, {workspace_size});
+  const size_t workspace_size = config->workspace_size();
+  void* workspace_ptr = nullptr;
+  if (workspace_size > 0) {
+    // the workspace of the stream only grows, the allocations of the stream
+    // are reused in its order, so the old one is freed safely
+    if (!workspace->initialized() || workspace->capacity() < workspace_size) {
+      workspace->Resize({static_cast<int64_t>(workspace_size)});
+      ctx.Alloc<uint8_t>(workspace);
+    }
+    workspace_ptr = workspace->data();
+  }
 
   // prepare cufft for execution
 #if defined(PADDLE_WITH_CUDA)
   PADDLE_ENFORCE_GPU_SUCCESS(
       phi::dynload::cufftSetStream(config->plan(), ctx.stream()));
   PADDLE_ENFORCE_GPU_SUCCESS(
-      phi::dynload::cufftSetWorkArea(config->plan(), workspace_tensor.data()));
+      phi::dynload::cufftSetWorkArea(config->plan(), workspace_ptr));
 #elif defined(PADDLE_WITH_HIP)
   PADDLE_ENFORCE_GPU_SUCCESS(
       phi::dynload::hipfftSetStream(config->plan(), ctx.stream()));
   PADDLE_ENFORCE_GPU_SUCCESS(
-      phi::dynload::hipfftSetWorkArea(config->plan(), workspace_tensor.data()));
+      phi::dynload::hipfftSetWorkArea(config->plan(), workspace_ptr));
 #endif
 
   // execution of fft plan
@@ -212,6 +226,9 @@ void exec_fft(const phi::GPUContext& ctx,
     exec_plan(
         *config, collapsed_input.data(), collapsed_output.data(), forward);
   }
+  if (guard.owns_lock()) {
+    guard.unlock();
+  }
 
   // resize for the collapsed output
   collapsed_output.Resize(transposed_output_shape);
@@ -21,12 +21,17 @@
 #include <unordered_map>
 #include <utility>
 
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/dense_tensor.h"
+
 #if defined(PADDLE_WITH_CUDA)
 #include "paddle/phi/kernels/funcs/cufft_util.h"
 #elif defined(PADDLE_WITH_HIP)
 #include "paddle/phi/kernels/funcs/hipfft_util.h"
 #endif
 
+COMMON_DECLARE_uint64(fft_plan_cache_workspace_limit_in_mb);
+
 namespace phi {
 namespace funcs {
 namespace detail {
@@ -51,6 +56,11 @@ static_assert(CUFFT_DEFAULT_CACHE_SIZE >= 0 &&
                   CUFFT_DEFAULT_CACHE_SIZE <= CUFFT_MAX_PLAN_NUM,
               "CUFFT_DEFAULT_CACHE_SIZE not in [0, CUFFT_MAX_PLAN_NUM] range");
 
+// A LRU cache of the FFT plans of one device, bounded both by the number of
+// the plans and by the sum of their workspace sizes. The plans are not bound
+// to a stream: the caller sets the stream and the work area of a plan before
+// executing it, holding the mutex of the cache until the plan is launched, so
+// that the streams sharing a plan do not reset it or evict it in between.
 class FFTConfigCache {
  public:
   using kv_t = typename std::pair<FFTConfigKey, FFTConfig>;
@@ -61,9 +71,16 @@ class FFTConfigCache {
                                   KeyEqual<FFTConfigKey>>;
   using map_kkv_iter_t = typename map_t::iterator;
 
-  FFTConfigCache() : FFTConfigCache(CUFFT_DEFAULT_CACHE_SIZE) {}
+  FFTConfigCache()
+      : FFTConfigCache(
+            CUFFT_DEFAULT_CACHE_SIZE,
+            FLAGS_fft_plan_cache_workspace_limit_in_mb * 1024 * 1024) {}
 
-  explicit FFTConfigCache(int64_t max_size) { _set_max_size(max_size); }
+  // max_workspace_bytes of 0 means that the workspace sizes are not bounded
+  explicit FFTConfigCache(int64_t max_size, size_t max_workspace_bytes = 0)
+      : _max_workspace_bytes(max_workspace_bytes) {
+    _set_max_size(max_size);
+  }
 
   FFTConfigCache(const FFTConfigCache& other) = delete;
   FFTConfigCache& operator=(const FFTConfigCache& other) = delete;
@@ -71,12 +88,18 @@ class FFTConfigCache {
   FFTConfigCache(FFTConfigCache&& other) noexcept
       : _usage_list(std::move(other._usage_list)),
         _cache_map(std::move(other._cache_map)),
-        _max_size(other._max_size) {}
+        _workspaces(std::move(other._workspaces)),
+        _max_size(other._max_size),
+        _workspace_bytes(other._workspace_bytes),
+        _max_workspace_bytes(other._max_workspace_bytes) {}
 
   FFTConfigCache& operator=(FFTConfigCache&& other) noexcept {
     _usage_list = std::move(other._usage_list);
     _cache_map = std::move(other._cache_map);
+    _workspaces = std::move(other._workspaces);
     _max_size = other._max_size;
+    _workspace_bytes = other._workspace_bytes;
+    _max_workspace_bytes = other._max_workspace_bytes;
     return *this;
   }
 
@@ -99,11 +122,8 @@ class FFTConfigCache {
 
     // Miss
     // remove if needed
-    if (_usage_list.size() >= _max_size) {
-      auto last = _usage_list.end();
-      last--;
-      _cache_map.erase(last->first);
-      _usage_list.pop_back();
+    while (_usage_list.size() >= _max_size) {
+      _evict_last();
     }
 
     // construct new plan at list front, then insert into _cache_map
@@ -114,24 +134,38 @@ class FFTConfigCache {
     _cache_map.emplace(std::piecewise_construct,
                        std::forward_as_tuple(kv_it->first),
                        std::forward_as_tuple(kv_it));
+    _workspace_bytes += kv_it->second.workspace_size();
+
+    // the new plan is kept even if its workspace alone exceeds the limit
+    while (_usage_list.size() > 1 && _workspace_exceeded()) {
+      _evict_last();
+    }
     return kv_it->second;
   }
 
+  // The workspace shared by the plans executed on the stream. The plans of a
+  // stream run one after another, so the stream needs a single workspace of
+  // the largest size instead of one for each plan.
+  DenseTensor* workspace(void* stream) { return &_workspaces[stream]; }
+
   void clear() {
     _cache_map.clear();
     _usage_list.clear();
+    _workspaces.clear();
+    _workspace_bytes = 0;
   }
 
   void resize(int64_t new_size) {
     _set_max_size(new_size);
-    auto cur_size = _usage_list.size();
-    if (cur_size > _max_size) {
-      auto delete_it = _usage_list.end();
-      for (size_t i = 0; i < cur_size - _max_size; i++) {
-        delete_it--;
-        _cache_map.erase(delete_it->first);
-      }
-      _usage_list.erase(delete_it, _usage_list.end());
+    while (_usage_list.size() > _max_size) {
+      _evict_last();
+    }
+  }
+
+  void set_max_workspace_bytes(size_t max_workspace_bytes) {
+    _max_workspace_bytes = max_workspace_bytes;
+    while (!_usage_list.empty() && _workspace_exceeded()) {
+      _evict_last();
     }
   }
 
@@ -139,6 +173,10 @@ class FFTConfigCache {
 
   size_t max_size() const noexcept { return _max_size; }
 
+  size_t workspace_bytes() const noexcept { return _workspace_bytes; }
+
+  size_t max_workspace_bytes() const noexcept { return _max_workspace_bytes; }
+
   std::mutex mutex;
 
  private:
@@ -163,9 +201,24 @@ class FFTConfigCache {
     _max_size = static_cast<size_t>(new_size);
   }
 
+  bool _workspace_exceeded() const {
+    return _max_workspace_bytes > 0 && _workspace_bytes > _max_workspace_bytes;
+  }
+
+  void _evict_last() {
+    auto last = _usage_list.end();
+    last--;
+    _workspace_bytes -= last->second.workspace_size();
+    _cache_map.erase(last->first);
+    _usage_list.pop_back();
+  }
+
   std::list<kv_t> _usage_list;
   map_t _cache_map;
+  std::unordered_map<void*, DenseTensor> _workspaces;
   size_t _max_size;
+  size_t _workspace_bytes = 0;
+  size_t _max_workspace_bytes;
 };
 
 static std::vector<std::unique_ptr<FFTConfigCache>> plan_caches;
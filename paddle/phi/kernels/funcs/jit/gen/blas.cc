@@ -23,15 +23,54 @@ namespace phi::jit::gen {
 void VXXJitCode::genCode() {
   // do not need push stack, and do not need save avx512reg if do not use avx512
   int offset = 0;
-  if (with_relu_) {
-    vxorps(ymm_zero, ymm_zero, ymm_zero);
+  // The zmm registers are used for the blocks of 16 floats, whose lower ymm
+  // and xmm parts are then used for the rest.
+  const bool use_zmm =
+      phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f) &&
+      num_ >= ZMM_FLOAT_BLOCK;
+  if (use_zmm) {
+    if (with_relu_) {
+      vpxord(zmm_zero, zmm_zero, zmm_zero);
+    }
+    if (scalar_index_ == 1) {
+      vbroadcastss(zmm_src1, ptr[param1]);
+    } else if (scalar_index_ == 2) {
+      vbroadcastss(zmm_src2, ptr[param2]);
+    }
+  } else {
+    if (with_relu_) {
+      vxorps(ymm_zero, ymm_zero, ymm_zero);
+    }
+    if (scalar_index_ == 1) {
+      vbroadcastss(ymm_src1, ptr[param1]);
+    } else if (scalar_index_ == 2) {
+      vbroadcastss(ymm_src2, ptr[param2]);
+    }
   }
-  if (scalar_index_ == 1) {
-    vbroadcastss(ymm_src1, ptr[param1]);
-  } else if (scalar_index_ == 2) {
-    vbroadcastss(ymm_src2, ptr[param2]);
+  const int num_zmm_blocks = use_zmm ? num_ / ZMM_FLOAT_BLOCK : 0;
+  for (int i = 0; i < num_zmm_blocks; ++i) {
+    if (scalar_index_ != 1) {
+      vmovups(zmm_src1, ptr[param1 + offset]);
+    }
+    if (scalar_index_ != 2) {
+      vmovups(zmm_src2, ptr[param2 + offset]);
+    }
+    if (type_ == operand_type::MUL) {
+      vmulps(zmm_dst, zmm_src1, zmm_src2);
+    } else if (type_ == operand_type::ADD) {
+      vaddps(zmm_dst, zmm_src1, zmm_src2);
+    } else if (type_ == operand_type::SUB) {
+      vsubps(zmm_dst, zmm_src1, zmm_src2);
+    }
+    if (with_relu_) {
+      vmaxps(zmm_dst, zmm_zero, zmm_dst);
+    }
+    vmovups(ptr[param3 + offset], zmm_dst);
+    offset += sizeof(float) * ZMM_FLOAT_BLOCK;
   }
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
+  const int num_ymm_blocks =
+      (num_ - num_zmm_blocks * ZMM_FLOAT_BLOCK) / YMM_FLOAT_BLOCK;
+  for (int i = 0; i < num_ymm_blocks; ++i) {
     if (scalar_index_ != 1) {
       vmovups(ymm_src1, ptr[param1 + offset]);
     }
@@ -105,6 +144,9 @@ void VXXJitCode::genCode() {
     offset += sizeof(float) * block;  // NOLINT
     rest -= block;
   }
+  if (use_zmm) {
+    vzeroupper();
+  }
   ret();
 }
 
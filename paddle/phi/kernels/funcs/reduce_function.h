@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <numeric>
 #include <set>
 #include <vector>
@@ -37,6 +38,9 @@ namespace cub = hipcub;
 #include "paddle/phi/backends/gpu/gpu_device_function.h"
 #include "paddle/phi/backends/gpu/gpu_info.h"
 #include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/kernels/autotune/cache.h"
+#include "paddle/phi/kernels/autotune/gpu_timer.h"
+#include "paddle/phi/kernels/autotune/switch_autotune.h"
 #endif
 
 #include "paddle/phi/kernels/cast_kernel.h"
@@ -281,6 +285,46 @@ struct ReduceConfig {
                ? kps::details::kReduceMaxThread
                : details::GetLastPow2(block_dim);
   }
+
+  // Gets the candidates of the number of parts reduce_num is split into,
+  // whose results are reduced again if there are more than one, for the
+  // autotune. The first one is chosen by the heuristics.
+  std::vector<int> GetSplitNumCandidates() const {
+    // Each part should have a value for each thread reducing it.
+    int threads_per_part = 1;
+    if (reduce_type != ReduceType::kReduceHigherDim) {
+      threads_per_part = reduce_last_dim ? block.x : block.y;
+    }
+    int device_id = phi::backends::gpu::GetCurrentDeviceId();
+    int max_grid_y = phi::backends::gpu::GetGpuMaxGridDimSize(device_id)[1];
+    int max_split_num = std::min(
+        details::CeilingDiv(reduce_num, threads_per_part), max_grid_y);
+
+    int split_num = grid.y;
+    std::vector<int> candidates = {split_num};
+    for (int candidate : {1,
+                          split_num / 4,
+                          split_num / 2,
+                          split_num * 2,
+                          split_num * 4,
+                          split_num * 8}) {
+      if (candidate >= 1 && candidate <= max_split_num &&
+          std::find(candidates.begin(), candidates.end(), candidate) ==
+              candidates.end()) {
+        candidates.push_back(candidate);
+      }
+    }
+    return candidates;
+  }
+
+  void SetSplitNum(int split_num) {
+    if (reduce_type == ReduceType::kReduceHigherDim) {
+      blocking_size = details::CeilingDiv(reduce_num, split_num);
+      split_num = details::CeilingDiv(reduce_num, blocking_size);
+    }
+    grid.y = split_num;
+    should_reduce_again = split_num > 1;
+  }
 #endif  // PADDLE_WITH_XPU_KP
 
   // If should_reduce_again, we need malloc temp space for temp data
@@ -1038,71 +1082,24 @@ struct CubTensorReduce<Tx, Ty, ReduceOp, TransformOp, true> {
   }
 };
 
+// Launches the reduce kernels by config, with the temp space for the results
+// of the parts of reduce_num if it is split.
 template <typename Tx,
           typename Ty,
           template <typename>
           class ReduceOp,
           typename TransformOp,
           bool IsMean = false>
-void ReduceKernel(const KPDevice& dev_ctx,
-                  const phi::DenseTensor& x,
-                  phi::DenseTensor* y,
-                  const TransformOp& transform,
-                  const std::vector<int>& origin_reduce_dims) {
-  PADDLE_ENFORCE_GT(
-      x.numel(),
-      0,
-      phi::errors::InvalidArgument("Tensor need be reduced must not empty."));
-#ifdef PADDLE_WITH_XPU_KP
-  auto stream = dev_ctx.x_context()->xpu_stream;
-#else
-  auto stream = dev_ctx.stream();
-#endif
-  dev_ctx.Alloc<Ty>(y);
-
-  auto x_dim = common::vectorize<int>(x.dims());
-
-  if (x_dim.size() == 0) {
-    std::vector<const DenseTensor*> inputs = {&x};
-    std::vector<DenseTensor*> outputs = {y};
-    funcs::ElementwiseKernel<Ty>(dev_ctx, inputs, &outputs, transform);
-    return;
-  }
-
+void LaunchReduceByConfig(
+    const KPDevice& dev_ctx,
+    const Tx* x_data,
+    Ty* y_data,
+    const TransformOp& transform,
+    ReduceConfig<Ty, typename phi::dtype::MPTypeTrait<Ty>::Type> config,
+    KPStream stream) {
   using MPType = typename phi::dtype::MPTypeTrait<Ty>::Type;
-  auto config = ReduceConfig<Ty, MPType>(origin_reduce_dims, x_dim);
-  config.Run(dev_ctx);
-  int numel = x.numel();
-  // after config.run()
-  // SetOutputData for ReduceHigherDim when should_reduce_again is true,
-  // temp_output should be stored temp_data in output_data space or stored in
-  // y_data;
-
-  phi::DDim tmp_ddim;
   phi::DenseTensor tmp;
-
-  auto x_data = x.data<Tx>();
-  auto y_data = y->data<Ty>();
-
-  if (config.reduce_num == 1) {
-    std::vector<const DenseTensor*> inputs = {&x};
-    std::vector<DenseTensor*> outputs = {y};
-    funcs::ElementwiseKernel<Ty>(dev_ctx, inputs, &outputs, transform);
-    return;
-  }
-
   config.SetOutputData(y_data, dev_ctx, &tmp);
-  constexpr bool kIsTxFP16 = std::is_same<Tx, phi::dtype::float16>::value;
-  constexpr bool kIsTxBF16 = std::is_same<Tx, phi::dtype::bfloat16>::value;
-  bool use_cub_reduce = config.reduce_num == numel && !kIsTxFP16 && !kIsTxBF16;
-
-#ifndef PADDLE_WITH_XPU_KP
-  if (use_cub_reduce) {
-    CubTensorReduce<Tx, Ty, ReduceOp, TransformOp, IsMean>::apply(
-        x_data, y_data, transform, config.reduce_num, dev_ctx, stream);
-    return;
-  }
-#endif
 
   auto reducer = ReduceOp<MPType>();
   // launch ReduceHigherDimKernel
@@ -1197,6 +1194,130 @@ void ReduceKernel(const KPDevice& dev_ctx,
       IsMean);
 }
 
+#ifndef PADDLE_WITH_XPU_KP
+// Returns the number of parts reduce_num is split into which is the fastest
+// of the candidates of config.
+template <typename Tx,
+          typename Ty,
+          template <typename>
+          class ReduceOp,
+          typename TransformOp,
+          bool IsMean = false>
+int TuneReduceSplitNum(
+    const KPDevice& dev_ctx,
+    const Tx* x_data,
+    Ty* y_data,
+    const TransformOp& transform,
+    ReduceConfig<Ty, typename phi::dtype::MPTypeTrait<Ty>::Type> config,
+    KPStream stream) {
+  // Regard the 1st run as warmup.
+  constexpr int repeats = 4;
+  const auto candidates = config.GetSplitNumCandidates();
+  int best_split_num = candidates[0];
+  float min_time = std::numeric_limits<float>::max();
+  phi::GpuTimer timer;
+  dev_ctx.Wait();
+  for (int split_num : candidates) {
+    config.SetSplitNum(split_num);
+    float time_cost = 0;
+    for (int i = 0; i < repeats; ++i) {
+      timer.Start(stream);
+      LaunchReduceByConfig<Tx, Ty, ReduceOp, TransformOp, IsMean>(
+          dev_ctx, x_data, y_data, transform, config, stream);
+      timer.Stop(stream);
+      if (i > 0) {
+        time_cost += timer.ElapsedTime();
+      }
+    }
+    VLOG(3) << "reduce split_num " << split_num << " time cost " << time_cost;
+    if (time_cost < min_time) {
+      min_time = time_cost;
+      best_split_num = split_num;
+    }
+  }
+  VLOG(3) << "best reduce split_num is " << best_split_num;
+  return best_split_num;
+}
+#endif
+
+template <typename Tx,
+          typename Ty,
+          template <typename>
+          class ReduceOp,
+          typename TransformOp,
+          bool IsMean = false>
+void ReduceKernel(const KPDevice& dev_ctx,
+                  const phi::DenseTensor& x,
+                  phi::DenseTensor* y,
+                  const TransformOp& transform,
+                  const std::vector<int>& origin_reduce_dims) {
+  PADDLE_ENFORCE_GT(
+      x.numel(),
+      0,
+      phi::errors::InvalidArgument("Tensor need be reduced must not empty."));
+#ifdef PADDLE_WITH_XPU_KP
+  auto stream = dev_ctx.x_context()->xpu_stream;
+#else
+  auto stream = dev_ctx.stream();
+#endif
+  dev_ctx.Alloc<Ty>(y);
+
+  auto x_dim = common::vectorize<int>(x.dims());
+
+  if (x_dim.size() == 0) {
+    std::vector<const DenseTensor*> inputs = {&x};
+    std::vector<DenseTensor*> outputs = {y};
+    funcs::ElementwiseKernel<Ty>(dev_ctx, inputs, &outputs, transform);
+    return;
+  }
+
+  using MPType = typename phi::dtype::MPTypeTrait<Ty>::Type;
+  auto config = ReduceConfig<Ty, MPType>(origin_reduce_dims, x_dim);
+  config.Run(dev_ctx);
+  int numel = x.numel();
+  auto x_data = x.data<Tx>();
+  auto y_data = y->data<Ty>();
+
+  if (config.reduce_num == 1) {
+    std::vector<const DenseTensor*> inputs = {&x};
+    std::vector<DenseTensor*> outputs = {y};
+    funcs::ElementwiseKernel<Ty>(dev_ctx, inputs, &outputs, transform);
+    return;
+  }
+
+  constexpr bool kIsTxFP16 = std::is_same<Tx, phi::dtype::float16>::value;
+  constexpr bool kIsTxBF16 = std::is_same<Tx, phi::dtype::bfloat16>::value;
+  bool use_cub_reduce = config.reduce_num == numel && !kIsTxFP16 && !kIsTxBF16;
+
+#ifndef PADDLE_WITH_XPU_KP
+  if (use_cub_reduce) {
+    CubTensorReduce<Tx, Ty, ReduceOp, TransformOp, IsMean>::apply(
+        x_data, y_data, transform, config.reduce_num, dev_ctx, stream);
+    return;
+  }
+
+  auto& cache = phi::autotune::AutoTuneCache::Instance().Get(
+      phi::autotune::AlgorithmType::kReduce);
+  const size_t key = phi::autotune::GenKey(
+      x_dim,
+      origin_reduce_dims,
+      static_cast<int64_t>(phi::CppTypeToDataType<Tx>::Type()),
+      static_cast<int64_t>(phi::CppTypeToDataType<Ty>::Type()));
+  if (cache.Find(key)) {
+    config.SetSplitNum(static_cast<int>(cache.Get(key)));
+  } else if (phi::autotune::AutoTuneStatus::Instance().UseAutoTune()) {
+    int best_split_num =
+        TuneReduceSplitNum<Tx, Ty, ReduceOp, TransformOp, IsMean>(
+            dev_ctx, x_data, y_data, transform, config, stream);
+    config.SetSplitNum(best_split_num);
+    cache.Set(key, best_split_num);
+  }
+#endif
+
+  LaunchReduceByConfig<Tx, Ty, ReduceOp, TransformOp, IsMean>(
+      dev_ctx, x_data, y_data, transform, config, stream);
+}
+
 template <typename Tx,
           typename Ty,
           template <typename>
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <algorithm>
 #include <map>
+#include <numeric>
 #include <set>
 #include <vector>
 
@@ -438,13 +439,15 @@ typename std::enable_if<std::is_integral<T>::value>::type elementwise_add_to(
 template <typename T, typename DeviceContext>
 typename std::enable_if<std::is_same<T, phi::dtype::bfloat16>::value>::type
 add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
+                  const std::vector<size_t>& out_ids,
                   int64_t input_width,
                   const DeviceContext& context,
                   T* out_data) {
 #ifndef PADDLE_WITH_DNNL
   auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
 #endif
+  // The offset of the rows of input in the rows of all the inputs.
+  size_t offset = 0;
   for (auto* input : inputs) {
     if (input->rows().empty()) {
       continue;
@@ -457,31 +460,34 @@ add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
     funcs::OneDNNAXPYHandler<T> axpy_handler(
         input_width, T(1.f), onednn_context.GetEngine());
     for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
+      size_t out_i = out_ids[offset + i];
       axpy_handler(&input_data[i * input_width],
                    &out_data[out_i * input_width]);
     }
 #else
     for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
+      size_t out_i = out_ids[offset + i];
       elementwise_add_to<T, DeviceContext>(&blas,
                                            static_cast<size_t>(input_width),
                                            &input_data[i * input_width],
                                            &out_data[out_i * input_width]);
     }
 #endif
+    offset += input_rows.size();
   }
 }
 
 template <typename T, typename DeviceContext>
 typename std::enable_if<!std::is_same<T, phi::dtype::bfloat16>::value>::type
 add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
-                  const std::unordered_map<int64_t, size_t>& rows_to_id,
+                  const std::vector<size_t>& out_ids,
                   int64_t input_width,
                   const DeviceContext& context,
                   T* out_data) {
   VLOG(4) << "[CPU] add_sparse_inputs <" << typeid(T).name();
   auto blas = phi::funcs::GetBlas<DeviceContext, T>(context);
+  // The offset of the rows of input in the rows of all the inputs.
+  size_t offset = 0;
   for (auto* input : inputs) {
     if (input->rows().empty()) {
       continue;
@@ -490,12 +496,13 @@ add_sparse_inputs(const std::vector<const phi::SelectedRows*>& inputs,
     auto& input_rows = input->rows();
 
     for (size_t i = 0; i < input_rows.size(); i++) {
-      size_t out_i = rows_to_id.at(input_rows[i]);
+      size_t out_i = out_ids[offset + i];
       elementwise_add_to<T, DeviceContext>(&blas,
                                            static_cast<size_t>(input_width),
                                            &input_data[i * input_width],
                                            &out_data[out_i * input_width]);
     }
+    offset += input_rows.size();
   }
 }
 
@@ -540,8 +547,7 @@ struct MergeAddImpl {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     phi::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
-    size_t row_num = 0;
+    std::vector<int64_t> input_rows;
     for (auto* input : inputs) {
       if (input->rows().empty()) {
         continue;
@@ -555,26 +561,37 @@ struct MergeAddImpl {
           input_height,
           input->height(),
           phi::errors::InvalidArgument("All inputs should have same height."));
-      row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
+      input_rows.insert(
+          input_rows.end(), input->rows().begin(), input->rows().end());
+    }
+    size_t row_num = input_rows.size();
+
+    // Sorts the positions of the rows so that the duplicated rows are
+    // adjacent, and gets the merged row of each position from the segments,
+    // which saves the set and the hash map of the rows.
+    std::vector<size_t> order(row_num);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&input_rows](size_t a, size_t b) {
+      return input_rows[a] < input_rows[b];
+    });
+    std::vector<int64_t> merge_rows;
+    std::vector<size_t> out_ids(row_num);
+    for (size_t pos : order) {
+      if (merge_rows.empty() || merge_rows.back() != input_rows[pos]) {
+        merge_rows.push_back(input_rows[pos]);
+      }
+      out_ids[pos] = merge_rows.size() - 1;
     }
 
     out.set_height(input_height);
     DenseTensor* out_tensor = out.mutable_value();
     out_tensor->Resize(common::make_ddim(
-        {static_cast<int64_t>(merged_row_set.size()), input_width}));
+        {static_cast<int64_t>(merge_rows.size()), input_width}));
     auto* out_data = context.template Alloc<T>(out_tensor);
 
-    if (merged_row_set.size() == row_num && !sorted_result) {
+    if (merge_rows.size() == row_num && !sorted_result) {
       // no duplicated ids, just concat the result together
-      std::vector<int64_t> merge_rows;
-      merge_rows.reserve(row_num);
-      // concat rows
-      for (auto* in : inputs) {
-        merge_rows.insert(
-            merge_rows.end(), in->rows().begin(), in->rows().end());
-      }
-      out.set_rows(merge_rows);
+      out.set_rows(input_rows);
       auto in_place = inputs[0]->place();
       auto out_place = out.place();
       int64_t copied_numel = 0;
@@ -589,25 +606,13 @@ struct MergeAddImpl {
         copied_numel += static_cast<int64_t>(in_numel);
       }
     } else {
-      std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                      merged_row_set.end());
-
-      if (sorted_result) {
-        std::sort(merge_rows.begin(), merge_rows.end());
-      }
-
       out.set_rows(merge_rows);
 
       phi::funcs::SetConstant<DeviceContext, T> constant_functor;
       constant_functor(context, out.mutable_value(), static_cast<T>(0.f));
 
-      std::unordered_map<int64_t, size_t> rows_to_id;
-      for (size_t i = 0; i < merge_rows.size(); ++i) {
-        rows_to_id[merge_rows[i]] = i;
-      }
-
       add_sparse_inputs<T, DeviceContext>(
-          inputs, rows_to_id, input_width, context, out_data);
+          inputs, out_ids, input_width, context, out_data);
     }
   }
 };
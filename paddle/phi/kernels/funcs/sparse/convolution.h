@@ -14,6 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "paddle/common/ddim.h"
 #include "paddle/phi/core/kmap_cache.h"
 #include "paddle/phi/core/tensor_utils.h"
@@ -298,6 +303,75 @@ inline void SaveToTable(const Context& dev_ctx,
   }
 }
 
+// The prefix of the keys of the rulebooks which the subm convs without a key
+// save for the following subm convs over the same indices.
+static constexpr char kAutoSubmKeyPrefix[] = "@auto_subm@";
+
+// A subm rulebook only depends on the indices and the kernel sizes and the
+// dilations, so the key of these and the nnz identifies it in the indices
+// dict, which is passed along without the auto keys once the indices change.
+inline std::string GetAutoSubmKey(const DDim& kernel_dims,
+                                  const std::vector<int>& dilations,
+                                  const int64_t nnz) {
+  std::string key(kAutoSubmKeyPrefix);
+  for (int i = 0; i < kernel_dims.size() - 2; ++i) {
+    key += std::to_string(kernel_dims[i]) + "x";
+  }
+  for (int dilation : dilations) {
+    key += std::to_string(dilation) + "d";
+  }
+  return key + std::to_string(nnz);
+}
+
+inline std::shared_ptr<
+    std::map<std::string, std::pair<DenseTensor, DenseTensor>>>
+DropAutoSubmKeys(
+    const std::shared_ptr<
+        std::map<std::string, std::pair<DenseTensor, DenseTensor>>>&
+        indices_dict) {
+  auto is_auto_key = [](const std::string& key) {
+    return key.rfind(kAutoSubmKeyPrefix, 0) == 0;
+  };
+  if (indices_dict == nullptr) {
+    return nullptr;
+  }
+  // The auto keys are sorted together after the prefix.
+  auto iter = indices_dict->lower_bound(kAutoSubmKeyPrefix);
+  if (iter == indices_dict->end() || !is_auto_key(iter->first)) {
+    return indices_dict;
+  }
+  auto dict = std::make_shared<
+      std::map<std::string, std::pair<DenseTensor, DenseTensor>>>();
+  for (const auto& item : *indices_dict) {
+    if (!is_auto_key(item.first)) {
+      dict->insert(item);
+    }
+  }
+  return dict;
+}
+
+// Returns the rulebook and the counter of a subm conv without a key for its
+// backward, and saves them by the auto key if they were just produced.
+template <typename Context>
+inline void SaveToAutoTable(const Context& dev_ctx,
+                            const SparseCooTensor& x,
+                            const std::string& auto_key,
+                            const DenseTensor& in_rulebook,
+                            const DenseTensor& h_counter,
+                            const bool produced,
+                            SparseCooTensor* out,
+                            DenseTensor* out_rulebook,
+                            DenseTensor* counter) {
+  if (produced) {
+    out->SetIndicesDict(x.GetIndicesDict());
+    out->SaveIndicesPairs(auto_key, std::make_pair(in_rulebook, h_counter));
+  }
+  *out_rulebook = in_rulebook;
+  counter->Resize({h_counter.numel()});
+  int* counter_ptr = dev_ctx.template HostAlloc<int>(counter);
+  memcpy(counter_ptr, h_counter.data<int>(), h_counter.numel() * sizeof(int));
+}
+
 }  // namespace sparse
 }  // namespace funcs
 }  // namespace phi
@@ -912,6 +912,8 @@ void LaunchGatherKthValue(const phi::GPUContext& dev_ctx,
       input_data, k, num_rows, num_cols, out_data, indices_data);
 }
 
+// Selects the unsorted top k of the slice_num rows of input, each of which is
+// selected by a block.
 template <typename T, bool Largest>
 __global__ void RadixTopK(const T* input,
                           int k,
@@ -920,6 +922,10 @@ __global__ void RadixTopK(const T* input,
                           T* output,
                           int64_t* indices) {
   __shared__ int shared_mem[32];
+  const int64_t slice = blockIdx.x;
+  input += slice * slice_size;
+  output += slice * k;
+  indices += slice * k;
 
   // 1. Find the k-th value
   T kth_value = static_cast<T>(0);
@@ -983,6 +989,21 @@ __global__ void RadixTopK(const T* input,
     write_start += carry;
   }
 }
+
+// Permutes the indices of each row of the top k by the positions in the row
+// of sorting its values.
+template <typename IndexT>
+__global__ void PermuteTopKIndices(const IndexT* indices,
+                                   const IndexT* positions,
+                                   const int64_t num_rows,
+                                   const int k,
+                                   IndexT* out) {
+  for (int64_t row = blockIdx.x; row < num_rows; row += gridDim.x) {
+    for (int i = threadIdx.x; i < k; i += blockDim.x) {
+      out[row * k + i] = indices[row * k + positions[row * k + i]];
+    }
+  }
+}
 #endif
 /*---------------------------Radix TopK End------------------*/
 
@@ -31,6 +31,7 @@ void FusedAdamKernel(
     const std::vector<const DenseTensor *> &beta2_pows,
     const paddle::optional<std::vector<const DenseTensor *>> &master_params,
     const paddle::optional<DenseTensor> &skip_update,
+    const paddle::optional<DenseTensor> &loss_scaling,
     const Scalar &beta1,
     const Scalar &beta2,
     const Scalar &epsilon,
@@ -39,11 +40,13 @@ void FusedAdamKernel(
     bool use_adamw,
     bool multi_precision,
     bool use_global_beta_pow,
+    float clip_norm,
     std::vector<DenseTensor *> params_out,
     std::vector<DenseTensor *> moments1_out,
     std::vector<DenseTensor *> moments2_out,
     std::vector<DenseTensor *> beta1_pows_out,
     std::vector<DenseTensor *> beta2_pows_out,
-    std::vector<DenseTensor *> master_params_out);
+    std::vector<DenseTensor *> master_params_out,
+    DenseTensor *found_inf);
 
 }  // namespace phi
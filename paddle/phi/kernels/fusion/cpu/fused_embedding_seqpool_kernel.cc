@@ -0,0 +1,140 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/embedding_util.h"
+
+namespace phi {
+namespace fusion {
+
+// Pools the rows of table looked up by each sequence of ids into out, where
+// each position of a sequence has width ids, which are pooled separately.
+template <typename T, typename IdT>
+void EmbeddingSeqpool(const IdT* ids,
+                      const std::vector<size_t>& offsets,
+                      int64_t width,
+                      const T* table,
+                      int64_t N,
+                      int64_t D,
+                      EmbeddingSeqpoolType type,
+                      int64_t padding_idx,
+                      T pad_value,
+                      T* out) {
+  for (size_t seq = 0; seq + 1 < offsets.size(); ++seq) {
+    int64_t begin = static_cast<int64_t>(offsets[seq]);
+    int64_t end = static_cast<int64_t>(offsets[seq + 1]);
+    T* dst = out + seq * width * D;
+    if (begin == end) {
+      std::fill(dst, dst + width * D, pad_value);
+      continue;
+    }
+    std::fill(dst, dst + width * D, static_cast<T>(0));
+    for (int64_t i = begin; i < end; ++i) {
+      for (int64_t j = 0; j < width; ++j) {
+        auto id = static_cast<int64_t>(ids[i * width + j]);
+        // The rows of padding_idx are zeros in the output of embedding.
+        if (id == padding_idx) {
+          continue;
+        }
+        PADDLE_ENFORCE_EQ(
+            id >= 0 && id < N,
+            true,
+            phi::errors::InvalidArgument(
+                "The ids of fused_embedding_seqpool should be in [0, %d), "
+                "but received %d.",
+                N,
+                id));
+        const T* src = table + id * D;
+        T* dst_j = dst + j * D;
+        for (int64_t k = 0; k < D; ++k) {
+          dst_j[k] += src[k];
+        }
+      }
+    }
+    if (type != EmbeddingSeqpoolType::kSum) {
+      T len = static_cast<T>(end - begin);
+      T scale = static_cast<T>(1) / (type == EmbeddingSeqpoolType::kAverage
+                                         ? len
+                                         : static_cast<T>(std::sqrt(len)));
+      for (int64_t k = 0; k < width * D; ++k) {
+        dst[k] *= scale;
+      }
+    }
+  }
+}
+
+template <typename T, typename Context>
+void FusedEmbeddingSeqpoolKernel(const Context& dev_ctx,
+                                 const std::vector<const DenseTensor*>& ids,
+                                 const DenseTensor& weight,
+                                 const std::string& pooltype,
+                                 int64_t padding_idx,
+                                 float pad_value,
+                                 std::vector<DenseTensor*> out) {
+  auto type = GetEmbeddingSeqpoolType(pooltype);
+  int64_t N = weight.dims()[0];
+  int64_t D = weight.dims()[1];
+  const T* table = weight.data<T>();
+  for (size_t i = 0; i < ids.size(); ++i) {
+    auto offsets = ResizeEmbeddingSeqpoolOut(*ids[i], D, out[i]);
+    T* out_data = dev_ctx.template Alloc<T>(out[i]);
+    int64_t rows = ids[i]->dims()[0];
+    int64_t width = rows > 0 ? ids[i]->numel() / rows : 1;
+    if (ids[i]->dtype() == phi::DataType::INT64) {
+      EmbeddingSeqpool<T, int64_t>(ids[i]->data<int64_t>(),
+                                   offsets,
+                                   width,
+                                   table,
+                                   N,
+                                   D,
+                                   type,
+                                   padding_idx,
+                                   static_cast<T>(pad_value),
+                                   out_data);
+    } else if (ids[i]->dtype() == phi::DataType::INT32) {
+      EmbeddingSeqpool<T, int>(ids[i]->data<int>(),
+                               offsets,
+                               width,
+                               table,
+                               N,
+                               D,
+                               type,
+                               padding_idx,
+                               static_cast<T>(pad_value),
+                               out_data);
+    } else {
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "The ids of fused_embedding_seqpool only support int32 and int64, "
+          "but received %s.",
+          ids[i]->dtype()));
+    }
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_embedding_seqpool,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedEmbeddingSeqpoolKernel,
+                   float,
+                   double) {}
@@ -0,0 +1,223 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <limits>
+
+#include "cub/cub.cuh"
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+
+namespace phi {
+namespace fusion {
+
+template <typename IndexT>
+__global__ void MoeExpertKeysKernel(const IndexT* expert_id,
+                                    const int64_t num_rows,
+                                    const int num_experts,
+                                    int* keys,
+                                    int* rows) {
+  CUDA_KERNEL_LOOP_TYPE(i, num_rows, int64_t) {
+    auto expert = static_cast<int64_t>(expert_id[i]);
+    PADDLE_ENFORCE(expert >= 0 && expert < num_experts,
+                   "The expert_id of moe_grouped_gemm should be in [0, %d), "
+                   "but received %ld.",
+                   num_experts,
+                   expert);
+    keys[i] = static_cast<int>(expert);
+    rows[i] = static_cast<int>(i);
+  }
+}
+
+// The rows of expert e end at the upper bound of e in the sorted keys.
+template <typename KeyT>
+__global__ void MoeTotalRowsBeforeExpertKernel(
+    const KeyT* sorted_keys,
+    const int64_t num_rows,
+    const int num_experts,
+    int64_t* total_rows_before_expert) {
+  const int expert = blockIdx.x * blockDim.x + threadIdx.x;
+  if (expert >= num_experts) {
+    return;
+  }
+  int64_t low = 0;
+  int64_t high = num_rows;
+  while (low < high) {
+    int64_t mid = (low + high) / 2;
+    if (sorted_keys[mid] <= expert) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  total_rows_before_expert[expert] = low;
+}
+
+template <typename IndexT>
+__global__ void MoeInverseRowsKernel(const IndexT* permuted_rows,
+                                     const int64_t num_rows,
+                                     IndexT* source_to_dest) {
+  CUDA_KERNEL_LOOP_TYPE(i, num_rows, int64_t) {
+    source_to_dest[permuted_rows[i]] = static_cast<IndexT>(i);
+  }
+}
+
+// out[i] = sum(in[index[i * num_reduce + j] / index_div] for j < num_reduce),
+// which permutes the rows when num_reduce is 1 and sums up the rows of the
+// top k experts of a token when it is k.
+template <typename T>
+__global__ void MoeGatherRowsKernel(const T* in,
+                                    const int* index,
+                                    const int64_t num_rows,
+                                    const int64_t cols,
+                                    const int index_div,
+                                    const int num_reduce,
+                                    T* out) {
+  using MPType = typename phi::dtype::MPTypeTrait<T>::Type;
+  CUDA_KERNEL_LOOP_TYPE(i, num_rows * cols, int64_t) {
+    const int64_t row = i / cols;
+    const int64_t col = i - row * cols;
+    MPType sum = static_cast<MPType>(0);
+    for (int j = 0; j < num_reduce; ++j) {
+      const int64_t src = index[row * num_reduce + j] / index_div;
+      sum += static_cast<MPType>(in[src * cols + col]);
+    }
+    out[i] = static_cast<T>(sum);
+  }
+}
+
+template <typename T, typename Context>
+void MoeGatherRows(const Context& dev_ctx,
+                   const T* in,
+                   const int* index,
+                   int64_t num_rows,
+                   int64_t cols,
+                   int index_div,
+                   int num_reduce,
+                   T* out) {
+  if (num_rows * cols == 0) {
+    return;
+  }
+  auto config =
+      phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, num_rows * cols);
+  MoeGatherRowsKernel<T><<<config.block_per_grid,
+                           config.thread_per_block,
+                           0,
+                           dev_ctx.stream()>>>(
+      in, index, num_rows, cols, index_div, num_reduce, out);
+}
+
+// Sorts the rows of expert_id by expert stably, where permuted_rows[i] is the
+// row of the i-th sorted one and source_to_dest is its inverse, and gets the
+// end of the sorted rows of each expert in total_rows_before_expert, which is
+// what the grouped GEMM of the experts takes.
+template <typename Context>
+void MoePermuteRows(const Context& dev_ctx,
+                    const DenseTensor& expert_id,
+                    int num_experts,
+                    DenseTensor* permuted_rows,
+                    DenseTensor* source_to_dest,
+                    DenseTensor* total_rows_before_expert) {
+  const int64_t num_rows = expert_id.numel();
+  PADDLE_ENFORCE_LE(num_rows,
+                    std::numeric_limits<int>::max(),
+                    phi::errors::InvalidArgument(
+                        "The numel of expert_id of moe_grouped_gemm should be "
+                        "less than or equal to %d, but received %d.",
+                        std::numeric_limits<int>::max(),
+                        num_rows));
+  permuted_rows->Resize({num_rows});
+  source_to_dest->Resize({num_rows});
+  total_rows_before_expert->Resize({num_experts});
+  int* permuted_rows_data = dev_ctx.template Alloc<int>(permuted_rows);
+  int* source_to_dest_data = dev_ctx.template Alloc<int>(source_to_dest);
+  int64_t* total_rows_data =
+      dev_ctx.template Alloc<int64_t>(total_rows_before_expert);
+  auto stream = dev_ctx.stream();
+
+  DenseTensor keys = phi::Empty<int>(dev_ctx, {num_rows});
+  DenseTensor rows = phi::Empty<int>(dev_ctx, {num_rows});
+  DenseTensor sorted_keys = phi::Empty<int>(dev_ctx, {num_rows});
+  if (num_rows > 0) {
+    auto config = phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, num_rows);
+    if (expert_id.dtype() == phi::DataType::INT64) {
+      MoeExpertKeysKernel<int64_t>
+          <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+              expert_id.data<int64_t>(),
+              num_rows,
+              num_experts,
+              keys.data<int>(),
+              rows.data<int>());
+    } else if (expert_id.dtype() == phi::DataType::INT32) {
+      MoeExpertKeysKernel<int>
+          <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+              expert_id.data<int>(),
+              num_rows,
+              num_experts,
+              keys.data<int>(),
+              rows.data<int>());
+    } else {
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "The expert_id of moe_grouped_gemm only supports int32 and int64, "
+          "but received %s.",
+          expert_id.dtype()));
+    }
+
+    // Only the bits of the experts are sorted.
+    int end_bit = 1;
+    while ((1 << end_bit) < num_experts) {
+      ++end_bit;
+    }
+    size_t temp_bytes = 0;
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cub::DeviceRadixSort::SortPairs(nullptr,
+                                        temp_bytes,
+                                        keys.data<int>(),
+                                        sorted_keys.data<int>(),
+                                        rows.data<int>(),
+                                        permuted_rows_data,
+                                        static_cast<int>(num_rows),
+                                        0,
+                                        end_bit,
+                                        stream));
+    DenseTensor temp =
+        phi::Empty<uint8_t>(dev_ctx, {static_cast<int64_t>(temp_bytes)});
+    PADDLE_ENFORCE_GPU_SUCCESS(
+        cub::DeviceRadixSort::SortPairs(temp.data<uint8_t>(),
+                                        temp_bytes,
+                                        keys.data<int>(),
+                                        sorted_keys.data<int>(),
+                                        rows.data<int>(),
+                                        permuted_rows_data,
+                                        static_cast<int>(num_rows),
+                                        0,
+                                        end_bit,
+                                        stream));
+    MoeInverseRowsKernel<int>
+        <<<config.block_per_grid, config.thread_per_block, 0, stream>>>(
+            permuted_rows_data, num_rows, source_to_dest_data);
+  }
+
+  constexpr int kThreads = 256;
+  const int blocks = (num_experts + kThreads - 1) / kThreads;
+  MoeTotalRowsBeforeExpertKernel<int><<<blocks, kThreads, 0, stream>>>(
+      sorted_keys.data<int>(), num_rows, num_experts, total_rows_data);
+}
+
+}  // namespace fusion
+}  // namespace phi
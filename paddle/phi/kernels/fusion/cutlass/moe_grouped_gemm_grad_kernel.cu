@@ -0,0 +1,160 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/funcs/blas/blas.h"
+#include "paddle/phi/kernels/funcs/math_function.h"
+#include "paddle/phi/kernels/fusion/cutlass/moe/moe_gemm_launcher.h"
+#include "paddle/phi/kernels/fusion/cutlass/moe/moe_permute.h"
+#include "paddle/phi/kernels/transpose_kernel.h"
+
+namespace phi {
+namespace fusion {
+
+template <typename T, typename Context>
+void MoeGroupedGemmGradKernel(const Context& dev_ctx,
+                              const DenseTensor& x,
+                              const DenseTensor& expert_id,
+                              const DenseTensor& weight,
+                              const DenseTensor& out_grad,
+                              DenseTensor* x_grad,
+                              DenseTensor* weight_grad) {
+  const auto& weight_dims = weight.dims();
+  const int num_experts = weight_dims[0];
+  const int64_t hidden_size = weight_dims[1];
+  const int64_t out_size = weight_dims[2];
+  const int64_t num_tokens = x.dims()[0];
+  const int64_t num_rows = expert_id.numel();
+  const int topk = expert_id.dims().size() == 2 ? expert_id.dims()[1] : 1;
+  phi::funcs::SetConstant<Context, T> set_zero;
+  if (x_grad) {
+    dev_ctx.template Alloc<T>(x_grad);
+  }
+  if (weight_grad) {
+    dev_ctx.template Alloc<T>(weight_grad);
+  }
+  if (num_rows == 0) {
+    if (x_grad) {
+      set_zero(dev_ctx, x_grad, static_cast<T>(0));
+    }
+    if (weight_grad) {
+      set_zero(dev_ctx, weight_grad, static_cast<T>(0));
+    }
+    return;
+  }
+
+  DenseTensor permuted_rows, source_to_dest, total_rows_before_expert;
+  MoePermuteRows(dev_ctx,
+                 expert_id,
+                 num_experts,
+                 &permuted_rows,
+                 &source_to_dest,
+                 &total_rows_before_expert);
+  DenseTensor permuted_out_grad = phi::Empty<T>(dev_ctx, {num_rows, out_size});
+  MoeGatherRows<T>(dev_ctx,
+                   out_grad.data<T>(),
+                   permuted_rows.data<int>(),
+                   num_rows,
+                   out_size,
+                   1,
+                   1,
+                   permuted_out_grad.data<T>());
+
+  if (x_grad) {
+    // x_grad of the sorted rows is out_grad * weight^T of the expert, by the
+    // grouped GEMM with the transposed weights, and the ones of the top k
+    // experts of each token are summed up while permuting them back.
+    DenseTensor weight_t =
+        phi::Transpose<T, Context>(dev_ctx, weight, {0, 2, 1});
+    DenseTensor permuted_x_grad =
+        phi::Empty<T>(dev_ctx, {num_rows, hidden_size});
+    MoeGroupedGemm<T>(dev_ctx,
+                      permuted_out_grad.data<T>(),
+                      weight_t.data<T>(),
+                      permuted_x_grad.data<T>(),
+                      total_rows_before_expert.data<int64_t>(),
+                      hidden_size,
+                      out_size,
+                      num_experts);
+    MoeGatherRows<T>(dev_ctx,
+                     permuted_x_grad.data<T>(),
+                     source_to_dest.data<int>(),
+                     num_tokens,
+                     hidden_size,
+                     1,
+                     topk,
+                     x_grad->data<T>());
+  }
+
+  if (weight_grad) {
+    // weight_grad of an expert is x^T * out_grad of its rows, whose reduced
+    // dimension is the number of the rows of the expert, so the GEMMs are
+    // launched per expert with the rows copied to the host.
+    DenseTensor permuted_x = phi::Empty<T>(dev_ctx, {num_rows, hidden_size});
+    MoeGatherRows<T>(dev_ctx,
+                     x.data<T>(),
+                     permuted_rows.data<int>(),
+                     num_rows,
+                     hidden_size,
+                     topk,
+                     1,
+                     permuted_x.data<T>());
+    DenseTensor cpu_total_rows;
+    phi::Copy(dev_ctx,
+              total_rows_before_expert,
+              phi::CPUPlace(),
+              true,
+              &cpu_total_rows);
+    const int64_t* total_rows = cpu_total_rows.data<int64_t>();
+
+    auto blas = phi::funcs::GetBlas<Context, T>(dev_ctx);
+    const T* permuted_x_data = permuted_x.data<T>();
+    const T* permuted_out_grad_data = permuted_out_grad.data<T>();
+    T* weight_grad_data = weight_grad->data<T>();
+    int64_t start = 0;
+    for (int i = 0; i < num_experts; ++i) {
+      const int64_t end = total_rows[i];
+      if (end == start) {
+        DenseTensor expert_grad = weight_grad->Slice(i, i + 1);
+        set_zero(dev_ctx, &expert_grad, static_cast<T>(0));
+        continue;
+      }
+      blas.GEMM(CblasTrans,
+                CblasNoTrans,
+                hidden_size,
+                out_size,
+                end - start,
+                static_cast<T>(1),
+                permuted_x_data + start * hidden_size,
+                permuted_out_grad_data + start * out_size,
+                static_cast<T>(0),
+                weight_grad_data + i * hidden_size * out_size);
+      start = end;
+    }
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(moe_grouped_gemm_grad,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::MoeGroupedGemmGradKernel,
+                   float,
+                   phi::dtype::float16) {}
@@ -0,0 +1,90 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/empty_kernel.h"
+#include "paddle/phi/kernels/fusion/cutlass/moe/moe_gemm_launcher.h"
+#include "paddle/phi/kernels/fusion/cutlass/moe/moe_permute.h"
+
+namespace phi {
+namespace fusion {
+
+// out[i, j] = x[i] * weight[expert_id[i, j]] of the top k experts of each
+// token. The rows of x are permuted into the order of the experts, multiplied
+// by one grouped GEMM for all the experts however many tokens each one gets,
+// and permuted back.
+template <typename T, typename Context>
+void MoeGroupedGemmKernel(const Context& dev_ctx,
+                          const DenseTensor& x,
+                          const DenseTensor& expert_id,
+                          const DenseTensor& weight,
+                          DenseTensor* out) {
+  const auto& weight_dims = weight.dims();
+  const int num_experts = weight_dims[0];
+  const int64_t hidden_size = weight_dims[1];
+  const int64_t out_size = weight_dims[2];
+  const int64_t num_rows = expert_id.numel();
+  const int topk = expert_id.dims().size() == 2 ? expert_id.dims()[1] : 1;
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  if (num_rows == 0) {
+    return;
+  }
+
+  DenseTensor permuted_rows, source_to_dest, total_rows_before_expert;
+  MoePermuteRows(dev_ctx,
+                 expert_id,
+                 num_experts,
+                 &permuted_rows,
+                 &source_to_dest,
+                 &total_rows_before_expert);
+
+  DenseTensor permuted_x = phi::Empty<T>(dev_ctx, {num_rows, hidden_size});
+  MoeGatherRows<T>(dev_ctx,
+                   x.data<T>(),
+                   permuted_rows.data<int>(),
+                   num_rows,
+                   hidden_size,
+                   topk,
+                   1,
+                   permuted_x.data<T>());
+  DenseTensor permuted_out = phi::Empty<T>(dev_ctx, {num_rows, out_size});
+  MoeGroupedGemm<T>(dev_ctx,
+                    permuted_x.data<T>(),
+                    weight.data<T>(),
+                    permuted_out.data<T>(),
+                    total_rows_before_expert.data<int64_t>(),
+                    out_size,
+                    hidden_size,
+                    num_experts);
+  MoeGatherRows<T>(dev_ctx,
+                   permuted_out.data<T>(),
+                   source_to_dest.data<int>(),
+                   num_rows,
+                   out_size,
+                   1,
+                   1,
+                   out_data);
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(moe_grouped_gemm,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::MoeGroupedGemmKernel,
+                   float,
+                   phi::dtype::float16) {}
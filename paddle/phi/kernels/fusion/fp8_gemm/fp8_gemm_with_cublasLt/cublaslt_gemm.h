@@ -405,6 +405,159 @@ void cublaslt_fp8_fp8_bf16_gemm(
       ctx, batch_count, m, n, k, x, y, scale, bias, activation_type, out);
 }
 
+inline cudaDataType_t GetCublasLtFP8DataType(phi::DataType dtype) {
+  PADDLE_ENFORCE_EQ(
+      dtype == phi::DataType::FLOAT8_E4M3FN ||
+          dtype == phi::DataType::FLOAT8_E5M2,
+      true,
+      phi::errors::InvalidArgument(
+          "FP8 gemm only supports float8_e4m3fn and float8_e5m2, but "
+          "received %s.",
+          dtype));
+  return dtype == phi::DataType::FLOAT8_E4M3FN ? CUDA_R_8F_E4M3
+                                               : CUDA_R_8F_E5M2;
+}
+
+// out[m, n] = (mat_a[m, k] * a_scale_inv) * (mat_b[n, k] * b_scale_inv)^T +
+// bias[n], where the scales of the per-tensor quantization are read from the
+// device, so that the ones updated by the delayed scaling of the training are
+// used without copying them to the host. Either of mat_a and mat_b can be
+// float8_e5m2 for the gradients, but not both of them.
+template <typename T>
+void CublasLtMatmulScaledFP8(const phi::GPUContext& dev_ctx,
+                             const int m,
+                             const int n,
+                             const int k,
+                             const phi::DenseTensor& mat_a,
+                             const phi::DenseTensor& mat_b,
+                             const phi::DenseTensor& a_scale_inv,
+                             const phi::DenseTensor& b_scale_inv,
+                             const paddle::optional<DenseTensor>& bias,
+                             phi::DenseTensor* out) {
+  PADDLE_ENFORCE_EQ(
+      mat_a.dtype() == phi::DataType::FLOAT8_E5M2 &&
+          mat_b.dtype() == phi::DataType::FLOAT8_E5M2,
+      false,
+      phi::errors::InvalidArgument(
+          "FP8 gemm does not support both of the inputs in float8_e5m2."));
+  PADDLE_ENFORCE_EQ(
+      k % 16 == 0,
+      true,
+      phi::errors::InvalidArgument("FP8 gemm need k % 16 = 0, but k = %d", k));
+  cublasStatus_t status;
+  // The row major mat_a and mat_b are taken as the column major mat_a^T and
+  // mat_b^T, so mat_b is the A of cuBLAS, which should be transposed for fp8.
+  const cudaDataType_t A_type = GetCublasLtFP8DataType(mat_b.dtype());
+  const cudaDataType_t B_type = GetCublasLtFP8DataType(mat_a.dtype());
+  const cudaDataType_t C_type = GetCublasLtDataType<T>();
+  const float* A_scale = b_scale_inv.data<float>();
+  const float* B_scale = a_scale_inv.data<float>();
+  float alpha = 1.0f;
+  float beta = 0.0f;
+
+  cublasLtMatmulDesc_t matmul_desc;
+  cublasLtMatrixLayout_t A_desc, B_desc, C_desc;
+  status = dyl::cublasLtMatmulDescCreate(
+      &matmul_desc, CUBLAS_COMPUTE_32F, CUDA_R_32F);
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulDescCreate);
+  cublasOperation_t op_transpose = CUBLAS_OP_T;
+  status = dyl::cublasLtMatmulDescSetAttribute(matmul_desc,
+                                               CUBLASLT_MATMUL_DESC_TRANSA,
+                                               &op_transpose,
+                                               sizeof(op_transpose));
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulDescSetAttribute);
+  status =
+      dyl::cublasLtMatmulDescSetAttribute(matmul_desc,
+                                          CUBLASLT_MATMUL_DESC_A_SCALE_POINTER,
+                                          &A_scale,
+                                          sizeof(A_scale));
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulDescSetAttribute);
+  status =
+      dyl::cublasLtMatmulDescSetAttribute(matmul_desc,
+                                          CUBLASLT_MATMUL_DESC_B_SCALE_POINTER,
+                                          &B_scale,
+                                          sizeof(B_scale));
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulDescSetAttribute);
+  if (bias) {
+    cublasLtEpilogue_t epilogue = CUBLASLT_EPILOGUE_BIAS;
+    status = dyl::cublasLtMatmulDescSetAttribute(matmul_desc,
+                                                 CUBLASLT_MATMUL_DESC_EPILOGUE,
+                                                 &epilogue,
+                                                 sizeof(epilogue));
+    PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulDescSetAttribute);
+    const T* bias_ptr = bias->data<T>();
+    status = dyl::cublasLtMatmulDescSetAttribute(
+        matmul_desc,
+        CUBLASLT_MATMUL_DESC_BIAS_POINTER,
+        &bias_ptr,
+        sizeof(bias_ptr));
+    PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulDescSetAttribute);
+  }
+
+  status = dyl::cublasLtMatrixLayoutCreate(&A_desc, A_type, k, n, k);
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatrixLayoutCreate);
+  status = dyl::cublasLtMatrixLayoutCreate(&B_desc, B_type, k, m, k);
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatrixLayoutCreate);
+  status = dyl::cublasLtMatrixLayoutCreate(&C_desc, C_type, n, m, n);
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatrixLayoutCreate);
+
+  size_t workspace_size = 64 * 1024 * 1024;
+  int returned_results = 0;
+  cublasLtMatmulHeuristicResult_t heuristic_result = {};
+  cublasLtMatmulPreference_t preference;
+  status = dyl::cublasLtMatmulPreferenceCreate(&preference);
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulPreferenceCreate);
+  status = dyl::cublasLtMatmulPreferenceSetAttribute(
+      preference,
+      CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES,
+      &workspace_size,
+      sizeof(workspace_size));
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulPreferenceSetAttribute);
+  status = dyl::cublasLtMatmulAlgoGetHeuristic(dev_ctx.cublaslt_handle(),
+                                               matmul_desc,
+                                               A_desc,
+                                               B_desc,
+                                               C_desc,
+                                               C_desc,
+                                               preference,
+                                               1,
+                                               &heuristic_result,
+                                               &returned_results);
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmulAlgoGetHeuristic);
+  PADDLE_ENFORCE_NE(
+      returned_results,
+      0,
+      phi::errors::NotFound("Unable to find suitable cuBLAS GEMM algorithm"));
+
+  auto workspace = phi::memory_utils::Alloc(
+      phi::GPUPlace(backends::gpu::GetCurrentDeviceId()),
+      heuristic_result.workspaceSize);
+  T* out_data = out->data<T>();
+  status = dyl::cublasLtMatmul(dev_ctx.cublaslt_handle(),
+                               matmul_desc,
+                               &alpha,
+                               mat_b.data(),
+                               A_desc,
+                               mat_a.data(),
+                               B_desc,
+                               &beta,
+                               out_data,
+                               C_desc,
+                               out_data,
+                               C_desc,
+                               &heuristic_result.algo,
+                               workspace->ptr(),
+                               heuristic_result.workspaceSize,
+                               dev_ctx.stream());
+  PADDLE_CUBLASLT_STATUS_CHECK(cublasLtMatmul);
+
+  dyl::cublasLtMatmulPreferenceDestroy(preference);
+  dyl::cublasLtMatrixLayoutDestroy(A_desc);
+  dyl::cublasLtMatrixLayoutDestroy(B_desc);
+  dyl::cublasLtMatrixLayoutDestroy(C_desc);
+  dyl::cublasLtMatmulDescDestroy(matmul_desc);
+}
+
 }  // namespace cutlass_internal
 }  // namespace fusion
 }  // namespace phi
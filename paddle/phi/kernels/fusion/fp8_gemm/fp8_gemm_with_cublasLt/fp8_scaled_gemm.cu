@@ -0,0 +1,77 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/kernel_registry.h"
+#if CUDA_VERSION >= 12010
+#include "paddle/phi/kernels/fusion/fp8_gemm/fp8_gemm_with_cublasLt/cublaslt_gemm.h"
+#endif
+namespace phi {
+namespace fusion {
+namespace cutlass_internal {
+
+// out = (x * x_scale_inv) * (y * y_scale_inv)^T + bias, where x is [m, k] and
+// y is [n, k], which are what the fp8 training keeps for the forward and
+// backward GEMMs of a linear layer.
+template <typename InputType, typename Context>
+void Fp8ScaledGemmKernel(const Context& dev_ctx,
+                         const DenseTensor& x,
+                         const DenseTensor& y,
+                         const DenseTensor& x_scale_inv,
+                         const DenseTensor& y_scale_inv,
+                         const paddle::optional<DenseTensor>& bias,
+                         const std::string& output_dtype,
+                         DenseTensor* out) {
+#if CUDA_VERSION >= 12010
+  static_assert(std::is_same<Context, phi::GPUContext>::value,
+                "fp8_scaled_gemm must be in GPU");
+  const int m = x.dims()[0];
+  const int n = y.dims()[0];
+  const int k = x.dims()[1];
+  if (out->dtype() == phi::DataType::BFLOAT16) {
+    dev_ctx.template Alloc<phi::dtype::bfloat16>(out);
+    if (out->numel() == 0) {
+      return;
+    }
+    CublasLtMatmulScaledFP8<phi::dtype::bfloat16>(
+        dev_ctx, m, n, k, x, y, x_scale_inv, y_scale_inv, bias, out);
+  } else if (out->dtype() == phi::DataType::FLOAT16) {
+    dev_ctx.template Alloc<phi::dtype::float16>(out);
+    if (out->numel() == 0) {
+      return;
+    }
+    CublasLtMatmulScaledFP8<phi::dtype::float16>(
+        dev_ctx, m, n, k, x, y, x_scale_inv, y_scale_inv, bias, out);
+  } else {
+    PADDLE_THROW(phi::errors::Fatal(
+        "fp8_scaled_gemm only support bfloat16 and float16 output"));
+  }
+#else
+  PADDLE_THROW(
+      phi::errors::Fatal("fp8_scaled_gemm need CUDA 12.1+ and sm_89+"));
+#endif
+}
+
+}  // namespace cutlass_internal
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fp8_scaled_gemm,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::cutlass_internal::Fp8ScaledGemmKernel,
+                   phi::dtype::float8_e4m3fn,
+                   phi::dtype::float8_e5m2) {}
@@ -0,0 +1,159 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
+#include "paddle/phi/common/float8_e4m3fn.h"
+#include "paddle/phi/common/float8_e5m2.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/funcs/math_cuda_utils.h"
+
+namespace phi {
+namespace fusion {
+
+constexpr int kFp8TileDim = 32;
+constexpr int kFp8TileRows = 8;
+
+// Each block casts a 32 x 32 tile of x scaled by scale to fp8, writes it to
+// out and its transpose through the shared memory to out_t, and takes the
+// maximum of the absolute values of the tile into amax, so the tensor is
+// read only once for all the three.
+template <typename T, typename OutT>
+__global__ void Fp8CastTransposeCUDAKernel(const T* x,
+                                           const float* scale,
+                                           const int64_t rows,
+                                           const int64_t cols,
+                                           OutT* out,
+                                           OutT* out_t,
+                                           float* amax) {
+  __shared__ OutT tile[kFp8TileDim][kFp8TileDim + 1];
+  const float s = *scale;
+  const int64_t row_begin = static_cast<int64_t>(blockIdx.y) * kFp8TileDim;
+  const int64_t col_begin = static_cast<int64_t>(blockIdx.x) * kFp8TileDim;
+  const int tx = threadIdx.x % kFp8TileDim;
+  const int ty = threadIdx.x / kFp8TileDim;
+
+  float local_amax = 0.0f;
+#pragma unroll
+  for (int i = ty; i < kFp8TileDim; i += kFp8TileRows) {
+    const int64_t row = row_begin + i;
+    const int64_t col = col_begin + tx;
+    if (row < rows && col < cols) {
+      const float value = static_cast<float>(x[row * cols + col]);
+      local_amax = fmaxf(local_amax, fabsf(value));
+      const OutT casted = static_cast<OutT>(value * s);
+      out[row * cols + col] = casted;
+      tile[i][tx] = casted;
+    }
+  }
+  __syncthreads();
+#pragma unroll
+  for (int i = ty; i < kFp8TileDim; i += kFp8TileRows) {
+    const int64_t row = col_begin + i;
+    const int64_t col = row_begin + tx;
+    if (row < cols && col < rows) {
+      out_t[row * rows + col] = tile[tx][i];
+    }
+  }
+
+  local_amax = phi::funcs::BlockReduceMax<float>(local_amax, FINAL_MASK);
+  if (threadIdx.x == 0) {
+    phi::CudaAtomicMax(amax, local_amax);
+  }
+}
+
+template <typename T, typename OutT, typename Context>
+void LaunchFp8CastTranspose(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const DenseTensor& scale,
+                            DenseTensor* out,
+                            DenseTensor* out_t,
+                            float* amax) {
+  const int64_t rows = x.dims()[0];
+  const int64_t cols = x.dims()[1];
+  OutT* out_data = dev_ctx.template Alloc<OutT>(out);
+  OutT* out_t_data = dev_ctx.template Alloc<OutT>(out_t);
+  if (rows == 0 || cols == 0) {
+    return;
+  }
+  const int64_t row_tiles = (rows + kFp8TileDim - 1) / kFp8TileDim;
+  const int64_t col_tiles = (cols + kFp8TileDim - 1) / kFp8TileDim;
+  const int64_t max_grid_y = phi::backends::gpu::GetGpuMaxGridDimSize(
+      dev_ctx.GetPlace().GetDeviceId())[1];
+  PADDLE_ENFORCE_LE(row_tiles,
+                    max_grid_y,
+                    phi::errors::InvalidArgument(
+                        "The number of the rows of Input(x) of "
+                        "fp8_cast_transpose should be less than or equal to "
+                        "%d, but received %d.",
+                        max_grid_y * kFp8TileDim,
+                        rows));
+  dim3 grid(col_tiles, row_tiles);
+  Fp8CastTransposeCUDAKernel<T, OutT>
+      <<<grid, kFp8TileDim * kFp8TileRows, 0, dev_ctx.stream()>>>(
+          x.data<T>(),
+          scale.data<float>(),
+          rows,
+          cols,
+          out_data,
+          out_t_data,
+          amax);
+}
+
+// Casts x of [rows, cols] to fp8 by the scale computed from the previous
+// amax of the delayed scaling, fused with its transpose which the fp8 GEMMs
+// of the backward take, and records the amax of x into the slot 0 of the
+// amax history for the next scale.
+template <typename T, typename Context>
+void Fp8CastTransposeKernel(const Context& dev_ctx,
+                            const DenseTensor& x,
+                            const DenseTensor& scale,
+                            const DenseTensor& amax_history,
+                            const std::string& out_dtype,
+                            DenseTensor* out,
+                            DenseTensor* out_t,
+                            DenseTensor* amax_history_out) {
+  float* amax = dev_ctx.template Alloc<float>(amax_history_out);
+  if (amax != amax_history.data<float>()) {
+    phi::Copy(
+        dev_ctx, amax_history, dev_ctx.GetPlace(), false, amax_history_out);
+    amax = amax_history_out->data<float>();
+  }
+  if (out_dtype == "float8_e4m3fn") {
+    LaunchFp8CastTranspose<T, phi::dtype::float8_e4m3fn>(
+        dev_ctx, x, scale, out, out_t, amax);
+  } else if (out_dtype == "float8_e5m2") {
+    LaunchFp8CastTranspose<T, phi::dtype::float8_e5m2>(
+        dev_ctx, x, scale, out, out_t, amax);
+  } else {
+    PADDLE_THROW(phi::errors::InvalidArgument(
+        "The out_dtype of fp8_cast_transpose should be float8_e4m3fn or "
+        "float8_e5m2, but received %s.",
+        out_dtype));
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fp8_cast_transpose,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::Fp8CastTransposeKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {}
@@ -0,0 +1,102 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/math_cuda_utils.h"
+
+namespace phi {
+namespace fusion {
+
+constexpr int kFp8UpdateScaleThreads = 1024;
+constexpr int kFp8MaxAmaxHistoryLen = 8192;
+
+// Runs in one block. The history is staged in the shared memory first since
+// the outputs may share the memory of the inputs.
+__global__ void Fp8UpdateScaleCUDAKernel(const float* amax_history,
+                                         const float* scale,
+                                         const int history_len,
+                                         const float fp8_max,
+                                         const float margin,
+                                         float* amax_history_out,
+                                         float* scale_out,
+                                         float* scale_inv_out) {
+  extern __shared__ float history[];
+  float local_amax = 0.0f;
+  for (int i = threadIdx.x; i < history_len; i += blockDim.x) {
+    history[i] = amax_history[i];
+    local_amax = fmaxf(local_amax, history[i]);
+  }
+  const float amax = phi::funcs::BlockReduceMax<float>(local_amax, FINAL_MASK);
+  if (threadIdx.x == 0) {
+    // Keeps the previous scale until there is a valid amax, e.g. the first
+    // steps, or the ones whose tensors overflowed.
+    float new_scale = *scale;
+    if (amax > 0.0f && isfinite(amax)) {
+      new_scale = fp8_max / amax / exp2f(margin);
+    }
+    *scale_out = new_scale;
+    *scale_inv_out = 1.0f / new_scale;
+  }
+  for (int i = threadIdx.x; i < history_len; i += blockDim.x) {
+    amax_history_out[i] = i == 0 ? 0.0f : history[i - 1];
+  }
+}
+
+// The delayed scaling of fp8: the scale of a tensor is computed from the
+// maximum of its amax of the last history_len steps, instead of the amax of
+// the tensor itself which is not known until it has been read once. Then the
+// history is rolled, where the slot 0 is cleared to take the amax of the
+// next step.
+template <typename T, typename Context>
+void Fp8UpdateScaleKernel(const Context& dev_ctx,
+                          const DenseTensor& amax_history,
+                          const DenseTensor& scale,
+                          float fp8_max,
+                          float margin,
+                          DenseTensor* amax_history_out,
+                          DenseTensor* scale_out,
+                          DenseTensor* scale_inv) {
+  const int64_t history_len = amax_history.numel();
+  PADDLE_ENFORCE_LE(history_len,
+                    kFp8MaxAmaxHistoryLen,
+                    phi::errors::InvalidArgument(
+                        "The length of Input(amax_history) of "
+                        "fp8_update_scale should be less than or equal to "
+                        "%d, but received %d.",
+                        kFp8MaxAmaxHistoryLen,
+                        history_len));
+  Fp8UpdateScaleCUDAKernel<<<1,
+                             kFp8UpdateScaleThreads,
+                             history_len * sizeof(float),
+                             dev_ctx.stream()>>>(
+      amax_history.data<T>(),
+      scale.data<T>(),
+      static_cast<int>(history_len),
+      fp8_max,
+      margin,
+      dev_ctx.template Alloc<T>(amax_history_out),
+      dev_ctx.template Alloc<T>(scale_out),
+      dev_ctx.template Alloc<T>(scale_inv));
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fp8_update_scale,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::Fp8UpdateScaleKernel,
+                   float) {}
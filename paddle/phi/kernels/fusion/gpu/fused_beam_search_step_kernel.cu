@@ -0,0 +1,472 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __NVCC__
+#include "cub/cub.cuh"
+#endif
+#ifdef __HIPCC__
+#include <hipcub/hipcub.hpp>
+namespace cub = hipcub;
+#endif
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/common/data_type.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/tensor_utils.h"
+
+namespace phi {
+namespace fusion {
+
+namespace {
+
+constexpr int kMaxBeamSize = 16;
+constexpr int kTopKBlockSize = 256;
+// one thread for each of the beam_size x beam_size candidates of a batch
+constexpr int kSelectBlockSize = kMaxBeamSize * kMaxBeamSize;
+
+struct MaxSum {
+  float max;
+  float sum;
+};
+
+// Merges the running max and sum of exp(x - max) of two parts of a row.
+struct MaxSumOp {
+  __device__ __forceinline__ MaxSum operator()(const MaxSum& a,
+                                               const MaxSum& b) const {
+    float max = fmaxf(a.max, b.max);
+    if (max == -INFINITY) {
+      return {max, 0.f};
+    }
+    return {max, a.sum * __expf(a.max - max) + b.sum * __expf(b.max - max)};
+  }
+};
+
+// Picks the beam_size best tokens of each unfinished beam in one pass over
+// the vocabulary, which also sums up the log-softmax normalizer of the row.
+// A finished beam is only extended by end_id in BeamSelectKernel.
+template <typename T, int BlockSize>
+__global__ void BeamTopKKernel(const T* logits,
+                               const bool* finished,
+                               int vocab_size,
+                               int beam_size,
+                               float* topk_scores,
+                               int* topk_ids) {
+  const int row = blockIdx.x;
+  if (finished[row]) {
+    return;
+  }
+  const T* row_logits = logits + static_cast<int64_t>(row) * vocab_size;
+
+  float vals[kMaxBeamSize];
+  int ids[kMaxBeamSize];
+  for (int i = 0; i < beam_size; ++i) {
+    vals[i] = -INFINITY;
+    ids[i] = -1;
+  }
+  MaxSum stat{-INFINITY, 0.f};
+  for (int v = threadIdx.x; v < vocab_size; v += BlockSize) {
+    float x = static_cast<float>(row_logits[v]);
+    stat = MaxSumOp()(stat, MaxSum{x, 1.f});
+    if (x > vals[beam_size - 1]) {
+      int i = beam_size - 1;
+      for (; i > 0 && vals[i - 1] < x; --i) {
+        vals[i] = vals[i - 1];
+        ids[i] = ids[i - 1];
+      }
+      vals[i] = x;
+      ids[i] = v;
+    }
+  }
+
+  using StatReduce = cub::BlockReduce<MaxSum, BlockSize>;
+  using ArgMaxReduce =
+      cub::BlockReduce<cub::KeyValuePair<int, float>, BlockSize>;
+  __shared__ union {
+    typename StatReduce::TempStorage stat;
+    typename ArgMaxReduce::TempStorage argmax;
+  } temp_storage;
+  __shared__ float log_sum;
+  __shared__ int winner;
+
+  MaxSum total = StatReduce(temp_storage.stat).Reduce(stat, MaxSumOp());
+  if (threadIdx.x == 0) {
+    log_sum = total.max + __logf(total.sum);
+  }
+  __syncthreads();
+
+  // merges the sorted lists of the threads by beam_size rounds of argmax
+  int head = 0;
+  for (int k = 0; k < beam_size; ++k) {
+    cub::KeyValuePair<int, float> candidate(
+        threadIdx.x, head < beam_size ? vals[head] : -INFINITY);
+    auto best =
+        ArgMaxReduce(temp_storage.argmax).Reduce(candidate, cub::ArgMax());
+    if (threadIdx.x == 0) {
+      winner = best.key;
+      topk_scores[row * beam_size + k] = best.value - log_sum;
+    }
+    __syncthreads();
+    if (threadIdx.x == winner) {
+      topk_ids[row * beam_size + k] = head < beam_size ? ids[head] : -1;
+      ++head;
+    }
+    __syncthreads();
+  }
+}
+
+// Selects the beam_size best candidates of each batch among the top tokens of
+// its unfinished beams and its finished beams. The candidates are ranked by
+// their scores divided by the length penalty ((5 + length) / 6) ^ alpha, and a
+// beam keeps its normalized score once it finishes. One block handles all the
+// beams of a batch and reads them before writing, so the states are updated
+// in place.
+template <int BlockSize>
+__global__ void BeamSelectKernel(const float* topk_scores,
+                                 const int* topk_ids,
+                                 const float* cum_scores,
+                                 const bool* finished,
+                                 const int* seq_lens,
+                                 int beam_size,
+                                 int end_id,
+                                 float length_penalty,
+                                 int64_t* ids,
+                                 int* parent_idx,
+                                 float* cum_scores_out,
+                                 bool* finished_out,
+                                 int* seq_lens_out) {
+  const int base = blockIdx.x * beam_size;
+  __shared__ int parent_seq_lens[kMaxBeamSize];
+  if (threadIdx.x < beam_size) {
+    parent_seq_lens[threadIdx.x] = seq_lens[base + threadIdx.x];
+  }
+
+  // candidate i is the (i % beam_size)-th token of beam i / beam_size
+  float key = -INFINITY;
+  float score = -INFINITY;
+  int id = -1;
+  int parent = -1;
+  bool candidate_finished = false;
+  if (threadIdx.x < beam_size * beam_size) {
+    const int beam = threadIdx.x / beam_size;
+    const int rank = threadIdx.x % beam_size;
+    const int row = base + beam;
+    if (finished[row]) {
+      if (rank == 0) {
+        key = score = cum_scores[row];
+        id = end_id;
+        parent = beam;
+        candidate_finished = true;
+      }
+    } else if (topk_ids[row * beam_size + rank] >= 0) {
+      id = topk_ids[row * beam_size + rank];
+      parent = beam;
+      score = cum_scores[row] + topk_scores[row * beam_size + rank];
+      float penalty =
+          length_penalty == 0.f
+              ? 1.f
+              : powf((5.f + seq_lens[row] + 1.f) / 6.f, length_penalty);
+      key = score / penalty;
+      candidate_finished = id == end_id;
+      if (candidate_finished) {
+        score = key;
+      }
+    }
+  }
+  __syncthreads();
+
+  using ArgMaxReduce =
+      cub::BlockReduce<cub::KeyValuePair<int, float>, BlockSize>;
+  __shared__ typename ArgMaxReduce::TempStorage temp_storage;
+  __shared__ int winner;
+  for (int k = 0; k < beam_size; ++k) {
+    auto best = ArgMaxReduce(temp_storage)
+                    .Reduce(cub::KeyValuePair<int, float>(threadIdx.x, key),
+                            cub::ArgMax());
+    if (threadIdx.x == 0) {
+      winner = best.key;
+    }
+    __syncthreads();
+    if (threadIdx.x == winner) {
+      const int out = base + k;
+      if (parent >= 0) {
+        ids[out] = id;
+        parent_idx[out] = base + parent;
+        cum_scores_out[out] = score;
+        finished_out[out] = candidate_finished;
+        seq_lens_out[out] = parent_seq_lens[parent];
+      } else {
+        // fewer valid candidates than beams, e.g. a tiny vocabulary
+        ids[out] = end_id;
+        parent_idx[out] = base;
+        cum_scores_out[out] = -INFINITY;
+        finished_out[out] = true;
+        seq_lens_out[out] = parent_seq_lens[0];
+      }
+      key = -INFINITY;
+      parent = -1;
+    }
+    __syncthreads();
+  }
+}
+
+// A beam shares the full blocks of its parent and keeps its own last block,
+// into which BeamCopyTailKernel copies the tokens of the last block of the
+// parent.
+__global__ void BeamBlockTablesKernel(const int* tables,
+                                      const int* parent_idx,
+                                      const int* seq_lens,
+                                      int max_blocks,
+                                      int block_size,
+                                      int* tables_out) {
+  const int row = blockIdx.x;
+  const int parent = parent_idx[row];
+  const int full_blocks = seq_lens[row] / block_size;
+  for (int j = threadIdx.x; j < max_blocks; j += blockDim.x) {
+    tables_out[row * max_blocks + j] = j < full_blocks
+                                           ? tables[parent * max_blocks + j]
+                                           : tables[row * max_blocks + j];
+  }
+}
+
+// Copies the tokens of the last block of the parent of each moved beam into
+// tails when gather is true, and from tails into the last block of the beam
+// otherwise. The tails are staged since the last block of a parent may be
+// overwritten by the copy of another beam.
+template <typename VecT, bool Gather>
+__global__ void BeamCopyTailKernel(VecT* cache,
+                                   const int* tables,
+                                   const int* parent_idx,
+                                   const int* seq_lens,
+                                   int max_blocks,
+                                   int block_size,
+                                   int num_heads,
+                                   int token_vecs,
+                                   VecT* tails) {
+  const int row = blockIdx.x;
+  const int parent = parent_idx[row];
+  const int full_blocks = seq_lens[row] / block_size;
+  const int rest = seq_lens[row] % block_size;
+  if (parent == row || rest == 0 || full_blocks >= max_blocks) {
+    return;
+  }
+  const int64_t block_vecs =
+      static_cast<int64_t>(num_heads) * block_size * token_vecs;
+  const int src_row = Gather ? parent : row;
+  VecT* block = cache + tables[src_row * max_blocks + full_blocks] * block_vecs;
+  VecT* tail = tails + row * block_vecs;
+  const int head_vecs = rest * token_vecs;
+  for (int i = threadIdx.x; i < num_heads * head_vecs; i += blockDim.x) {
+    const int64_t offset = static_cast<int64_t>(i / head_vecs) * block_size *
+                               token_vecs +
+                           i % head_vecs;
+    if (Gather) {
+      tail[offset] = block[offset];
+    } else {
+      block[offset] = tail[offset];
+    }
+  }
+}
+
+template <typename VecT>
+void ReorderCacheTails(const phi::GPUContext& dev_ctx,
+                       DenseTensor* cache,
+                       const DenseTensor& tables,
+                       const DenseTensor& parent_idx,
+                       const DenseTensor& seq_lens,
+                       int max_blocks) {
+  const auto& dims = cache->dims();
+  const int num_heads = dims[1];
+  const int block_size = dims[2];
+  const int64_t token_bytes = dims[3] * phi::SizeOf(cache->dtype());
+  const int token_vecs = token_bytes / sizeof(VecT);
+  const int rows = parent_idx.numel();
+
+  DenseTensor tails;
+  tails.Resize({rows * num_heads * block_size * token_bytes});
+  auto* tails_data = reinterpret_cast<VecT*>(dev_ctx.Alloc<uint8_t>(&tails));
+  auto* cache_data = reinterpret_cast<VecT*>(cache->data());
+  BeamCopyTailKernel<VecT, true>
+      <<<rows, kTopKBlockSize, 0, dev_ctx.stream()>>>(cache_data,
+                                                       tables.data<int>(),
+                                                       parent_idx.data<int>(),
+                                                       seq_lens.data<int>(),
+                                                       max_blocks,
+                                                       block_size,
+                                                       num_heads,
+                                                       token_vecs,
+                                                       tails_data);
+  BeamCopyTailKernel<VecT, false>
+      <<<rows, kTopKBlockSize, 0, dev_ctx.stream()>>>(cache_data,
+                                                       tables.data<int>(),
+                                                       parent_idx.data<int>(),
+                                                       seq_lens.data<int>(),
+                                                       max_blocks,
+                                                       block_size,
+                                                       num_heads,
+                                                       token_vecs,
+                                                       tails_data);
+}
+
+void ReorderPagedCache(const phi::GPUContext& dev_ctx,
+                       const DenseTensor& cache,
+                       const DenseTensor& tables,
+                       const DenseTensor& parent_idx,
+                       const DenseTensor& seq_lens,
+                       int max_blocks,
+                       DenseTensor* cache_out) {
+  if (cache_out->data() != cache.data()) {
+    phi::Copy(dev_ctx, cache, dev_ctx.GetPlace(), false, cache_out);
+  }
+  const int64_t token_bytes =
+      cache.dims()[3] * phi::SizeOf(cache.dtype());
+  if (token_bytes % sizeof(int4) == 0) {
+    ReorderCacheTails<int4>(
+        dev_ctx, cache_out, tables, parent_idx, seq_lens, max_blocks);
+  } else {
+    ReorderCacheTails<uint8_t>(
+        dev_ctx, cache_out, tables, parent_idx, seq_lens, max_blocks);
+  }
+}
+
+}  // namespace
+
+template <typename T, typename Context>
+void FusedBeamSearchStepKernel(
+    const Context& dev_ctx,
+    const DenseTensor& logits,
+    const DenseTensor& cum_scores,
+    const DenseTensor& finished,
+    const DenseTensor& seq_lens,
+    const paddle::optional<DenseTensor>& block_tables,
+    const paddle::optional<DenseTensor>& key_cache,
+    const paddle::optional<DenseTensor>& value_cache,
+    int beam_size,
+    int end_id,
+    float length_penalty,
+    DenseTensor* ids,
+    DenseTensor* parent_idx,
+    DenseTensor* cum_scores_out,
+    DenseTensor* finished_out,
+    DenseTensor* seq_lens_out,
+    DenseTensor* block_tables_out,
+    DenseTensor* key_cache_out,
+    DenseTensor* value_cache_out) {
+  PADDLE_ENFORCE_EQ(
+      beam_size > 0 && beam_size <= kMaxBeamSize,
+      true,
+      common::errors::InvalidArgument(
+          "The beam_size of fused_beam_search_step should be in [1, %d], but "
+          "received %d.",
+          kMaxBeamSize,
+          beam_size));
+  const int rows = logits.dims()[0];
+  const int vocab_size = logits.dims()[1];
+  const int batch_size = rows / beam_size;
+
+  dev_ctx.template Alloc<int64_t>(ids);
+  dev_ctx.template Alloc<int>(parent_idx);
+  dev_ctx.template Alloc<float>(cum_scores_out);
+  dev_ctx.template Alloc<bool>(finished_out);
+  dev_ctx.template Alloc<int>(seq_lens_out);
+  if (rows == 0) {
+    return;
+  }
+
+  DenseTensor topk_scores, topk_ids;
+  topk_scores.Resize({rows * beam_size});
+  topk_ids.Resize({rows * beam_size});
+  dev_ctx.template Alloc<float>(&topk_scores);
+  dev_ctx.template Alloc<int>(&topk_ids);
+
+  auto stream = dev_ctx.stream();
+  BeamTopKKernel<T, kTopKBlockSize>
+      <<<rows, kTopKBlockSize, 0, stream>>>(logits.data<T>(),
+                                            finished.data<bool>(),
+                                            vocab_size,
+                                            beam_size,
+                                            topk_scores.data<float>(),
+                                            topk_ids.data<int>());
+  BeamSelectKernel<kSelectBlockSize>
+      <<<batch_size, kSelectBlockSize, 0, stream>>>(
+      topk_scores.data<float>(),
+      topk_ids.data<int>(),
+      cum_scores.data<float>(),
+      finished.data<bool>(),
+      seq_lens.data<int>(),
+      beam_size,
+      end_id,
+      length_penalty,
+      ids->data<int64_t>(),
+      parent_idx->data<int>(),
+      cum_scores_out->data<float>(),
+      finished_out->data<bool>(),
+      seq_lens_out->data<int>());
+
+  if (!block_tables) {
+    return;
+  }
+  PADDLE_ENFORCE_EQ(
+      key_cache && value_cache,
+      true,
+      common::errors::InvalidArgument(
+          "The key_cache and the value_cache of fused_beam_search_step should "
+          "be given with the block_tables."));
+  const int max_blocks = block_tables->dims()[1];
+  const int block_size = key_cache->dims()[2];
+  // the rows of a batch are reordered in place, so the old ones are kept
+  DenseTensor tables;
+  phi::Copy(dev_ctx, *block_tables, dev_ctx.GetPlace(), false, &tables);
+  ReorderPagedCache(dev_ctx,
+                    *key_cache,
+                    tables,
+                    *parent_idx,
+                    *seq_lens_out,
+                    max_blocks,
+                    key_cache_out);
+  ReorderPagedCache(dev_ctx,
+                    *value_cache,
+                    tables,
+                    *parent_idx,
+                    *seq_lens_out,
+                    max_blocks,
+                    value_cache_out);
+  dev_ctx.template Alloc<int>(block_tables_out);
+  BeamBlockTablesKernel<<<rows, kTopKBlockSize, 0, stream>>>(
+      tables.data<int>(),
+      parent_idx->data<int>(),
+      seq_lens_out->data<int>(),
+      max_blocks,
+      block_size,
+      block_tables_out->data<int>());
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_beam_search_step,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedBeamSearchStepKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->OutputAt(0).SetDataType(phi::DataType::INT64);
+  kernel->OutputAt(1).SetDataType(phi::DataType::INT32);
+  kernel->OutputAt(2).SetDataType(phi::DataType::FLOAT32);
+  kernel->OutputAt(3).SetDataType(phi::DataType::BOOL);
+  kernel->OutputAt(4).SetDataType(phi::DataType::INT32);
+  kernel->OutputAt(5).SetDataType(phi::DataType::INT32);
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/common/memory_utils.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/embedding_util.h"
+
+namespace phi {
+namespace fusion {
+
+// The layout of the int64 meta of all the slots copied to the device once:
+// [bag_offsets (S + 1)][widths (S)][lod_starts (S)][ids (S)][outs (S)][lods],
+// where a bag is the ids of one sequence at one position of the width, which
+// are pooled into one row of the output, and the lods of all the slots are
+// concatenated.
+struct EmbeddingSeqpoolMeta {
+  const int64_t* bag_offsets;
+  const int64_t* widths;
+  const int64_t* lod_starts;
+  const int64_t* ids;
+  const int64_t* outs;
+  const int64_t* lods;
+
+  __device__ EmbeddingSeqpoolMeta(const int64_t* meta, int num_slots)
+      : bag_offsets(meta),
+        widths(meta + num_slots + 1),
+        lod_starts(meta + 2 * num_slots + 1),
+        ids(meta + 3 * num_slots + 1),
+        outs(meta + 4 * num_slots + 1),
+        lods(meta + 5 * num_slots + 1) {}
+};
+
+template <typename T, typename IdT>
+__global__ void FusedEmbeddingSeqpoolKernelImpl(const T* table,
+                                                const int64_t* meta_data,
+                                                const int num_slots,
+                                                const int64_t N,
+                                                const int64_t D,
+                                                const int pool_type,
+                                                const int64_t padding_idx,
+                                                const T pad_value) {
+  using MT = typename phi::dtype::MPTypeTrait<T>::Type;
+  EmbeddingSeqpoolMeta meta(meta_data, num_slots);
+  const int64_t num_bags = meta.bag_offsets[num_slots];
+  for (int64_t bag = blockIdx.x * blockDim.y + threadIdx.y; bag < num_bags;
+       bag += static_cast<int64_t>(gridDim.x) * blockDim.y) {
+    // The last slot whose first bag is not after bag.
+    int lo = 0;
+    int hi = num_slots - 1;
+    while (lo < hi) {
+      int mid = (lo + hi + 1) / 2;
+      if (meta.bag_offsets[mid] <= bag) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    const int slot = lo;
+    const int64_t local = bag - meta.bag_offsets[slot];
+    const int64_t width = meta.widths[slot];
+    const int64_t seq = local / width;
+    const int64_t pos = local % width;
+    const int64_t* lod = meta.lods + meta.lod_starts[slot];
+    const int64_t begin = lod[seq];
+    const int64_t end = lod[seq + 1];
+    const IdT* ids = reinterpret_cast<const IdT*>(meta.ids[slot]);
+    T* out = reinterpret_cast<T*>(meta.outs[slot]) + local * D;
+
+    MT scale = static_cast<MT>(1);
+    if (pool_type == static_cast<int>(EmbeddingSeqpoolType::kAverage)) {
+      scale = static_cast<MT>(1) / static_cast<MT>(end - begin);
+    } else if (pool_type == static_cast<int>(EmbeddingSeqpoolType::kSqrt)) {
+      scale = static_cast<MT>(1 / sqrt(static_cast<double>(end - begin)));
+    }
+    for (int64_t k = threadIdx.x; k < D; k += blockDim.x) {
+      if (begin == end) {
+        out[k] = pad_value;
+        continue;
+      }
+      MT sum = static_cast<MT>(0);
+      for (int64_t i = begin; i < end; ++i) {
+        auto id = static_cast<int64_t>(ids[i * width + pos]);
+        if (id == padding_idx) {
+          continue;
+        }
+        PADDLE_ENFORCE(id >= 0 && id < N,
+                       "Id should be in [0, %lld) but received an id value: "
+                       "%lld.",
+                       N,
+                       id);
+        sum += static_cast<MT>(table[id * D + k]);
+      }
+      out[k] = static_cast<T>(sum * scale);
+    }
+  }
+}
+
+template <typename T, typename Context>
+void FusedEmbeddingSeqpoolKernel(const Context& dev_ctx,
+                                 const std::vector<const DenseTensor*>& ids,
+                                 const DenseTensor& weight,
+                                 const std::string& pooltype,
+                                 int64_t padding_idx,
+                                 float pad_value,
+                                 std::vector<DenseTensor*> out) {
+  auto type = GetEmbeddingSeqpoolType(pooltype);
+  const int num_slots = static_cast<int>(ids.size());
+  int64_t N = weight.dims()[0];
+  int64_t D = weight.dims()[1];
+
+  std::vector<int64_t> bag_offsets(num_slots + 1, 0);
+  std::vector<int64_t> widths(num_slots);
+  std::vector<int64_t> lod_starts(num_slots);
+  std::vector<int64_t> ids_ptrs(num_slots);
+  std::vector<int64_t> out_ptrs(num_slots);
+  std::vector<int64_t> lods;
+  for (int i = 0; i < num_slots; ++i) {
+    PADDLE_ENFORCE_EQ(
+        ids[i]->dtype(),
+        ids[0]->dtype(),
+        phi::errors::InvalidArgument("All the ids of fused_embedding_seqpool "
+                                     "should have the same dtype."));
+    auto offsets = ResizeEmbeddingSeqpoolOut(*ids[i], D, out[i]);
+    int64_t rows = ids[i]->dims()[0];
+    widths[i] = rows > 0 ? ids[i]->numel() / rows : 1;
+    bag_offsets[i + 1] =
+        bag_offsets[i] + static_cast<int64_t>(offsets.size() - 1) * widths[i];
+    lod_starts[i] = static_cast<int64_t>(lods.size());
+    lods.insert(lods.end(), offsets.begin(), offsets.end());
+    ids_ptrs[i] =
+        ids[i]->numel() > 0 ? reinterpret_cast<int64_t>(ids[i]->data()) : 0;
+    out_ptrs[i] = reinterpret_cast<int64_t>(dev_ctx.template Alloc<T>(out[i]));
+  }
+  if (bag_offsets[num_slots] == 0 || D == 0) {
+    return;
+  }
+
+  std::vector<int64_t> meta;
+  meta.reserve(5 * num_slots + 1 + lods.size());
+  for (const auto* part :
+       {&bag_offsets, &widths, &lod_starts, &ids_ptrs, &out_ptrs, &lods}) {
+    meta.insert(meta.end(), part->begin(), part->end());
+  }
+  auto meta_data = phi::memory_utils::Alloc(
+      dev_ctx.GetPlace(),
+      meta.size() * sizeof(int64_t),
+      phi::Stream(reinterpret_cast<phi::StreamId>(dev_ctx.stream())));
+  phi::memory_utils::Copy(dev_ctx.GetPlace(),
+                          meta_data->ptr(),
+                          phi::CPUPlace(),
+                          meta.data(),
+                          meta.size() * sizeof(int64_t),
+                          dev_ctx.stream());
+
+  constexpr int kBlockDimX = 32;
+  constexpr int kBlockDimY = 8;
+  dim3 threads(kBlockDimX, kBlockDimY);
+  dim3 grids(static_cast<unsigned int>(std::min<int64_t>(
+      (bag_offsets[num_slots] + kBlockDimY - 1) / kBlockDimY,
+      dev_ctx.GetCUDAMaxGridDimSize()[0])));
+  const auto* meta_ptr = reinterpret_cast<const int64_t*>(meta_data->ptr());
+  if (ids[0]->dtype() == phi::DataType::INT64) {
+    FusedEmbeddingSeqpoolKernelImpl<T, int64_t>
+        <<<grids, threads, 0, dev_ctx.stream()>>>(weight.data<T>(),
+                                                  meta_ptr,
+                                                  num_slots,
+                                                  N,
+                                                  D,
+                                                  static_cast<int>(type),
+                                                  padding_idx,
+                                                  static_cast<T>(pad_value));
+  } else if (ids[0]->dtype() == phi::DataType::INT32) {
+    FusedEmbeddingSeqpoolKernelImpl<T, int>
+        <<<grids, threads, 0, dev_ctx.stream()>>>(weight.data<T>(),
+                                                  meta_ptr,
+                                                  num_slots,
+                                                  N,
+                                                  D,
+                                                  static_cast<int>(type),
+                                                  padding_idx,
+                                                  static_cast<T>(pad_value));
+  } else {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "The ids of fused_embedding_seqpool only support int32 and int64, "
+        "but received %s.",
+        ids[0]->dtype()));
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_embedding_seqpool,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedEmbeddingSeqpoolKernel,
+                   float,
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {}
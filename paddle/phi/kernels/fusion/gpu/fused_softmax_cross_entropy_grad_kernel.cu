@@ -0,0 +1,167 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/aligned_vector.h"
+
+namespace phi {
+namespace fusion {
+
+// Recomputes the probabilities of a row from its logits and logsumexp while
+// writing the gradient, (softmax - onehot(label)) * loss_grad, so they are
+// never kept between the forward and the backward.
+template <typename T, typename IndexT, int VecSize, int BlockSize>
+__global__ void SoftmaxCrossEntropyGradKernel(const T* logits,
+                                              const IndexT* labels,
+                                              const float* logsumexp,
+                                              const T* loss_grad,
+                                              const int64_t ignore_index,
+                                              const int64_t start_index,
+                                              const int64_t N,
+                                              const int64_t D,
+                                              T* logits_grad) {
+  using VecT = phi::AlignedVector<T, VecSize>;
+  for (int64_t row = blockIdx.x; row < N; row += gridDim.x) {
+    const T* row_logits = logits + row * D;
+    T* row_grad = logits_grad + row * D;
+    const auto label = static_cast<int64_t>(labels[row]);
+    const bool ignored = label == ignore_index;
+    const int64_t local_label = label - start_index;
+    const float lse = logsumexp[row];
+    const float dloss = static_cast<float>(loss_grad[row]);
+    for (int64_t col = threadIdx.x * VecSize; col < D;
+         col += BlockSize * VecSize) {
+      VecT vec;
+      phi::Load<T, VecSize>(row_logits + col, &vec);
+#pragma unroll
+      for (int i = 0; i < VecSize; ++i) {
+        float grad = 0.f;
+        if (!ignored) {
+          grad = __expf(static_cast<float>(vec[i]) - lse);
+          if (col + i == local_label) {
+            grad -= 1.f;
+          }
+          grad *= dloss;
+        }
+        vec[i] = static_cast<T>(grad);
+      }
+      phi::Store<T, VecSize>(vec, row_grad + col);
+    }
+  }
+}
+
+template <typename T, typename IndexT, typename Context>
+void FusedSoftmaxCrossEntropyGradImpl(const Context& dev_ctx,
+                                      const DenseTensor& logits,
+                                      const DenseTensor& label,
+                                      const DenseTensor& logsumexp,
+                                      const DenseTensor& loss_grad,
+                                      int64_t ignore_index,
+                                      int rank,
+                                      DenseTensor* logits_grad) {
+  const auto& logits_dims = logits.dims();
+  const int64_t D = logits_dims[logits_dims.size() - 1];
+  const int64_t N = D > 0 ? logits.numel() / D : 0;
+  T* grad_data = dev_ctx.template Alloc<T>(logits_grad);
+  if (N == 0) {
+    return;
+  }
+
+  constexpr int kBlockSize = 512;
+  const T* logits_data = logits.data<T>();
+  int vec_size = std::min(phi::GetVectorizedSize<T>(logits_data),
+                          phi::GetVectorizedSize<T>(grad_data));
+  while (D % vec_size != 0) {
+    vec_size /= 2;
+  }
+  const int64_t grid =
+      std::min<int64_t>(N, dev_ctx.GetCUDAMaxGridDimSize()[0]);
+  switch (vec_size) {
+#define PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_GRAD(__vec_size)                      \
+  case __vec_size:                                                            \
+    SoftmaxCrossEntropyGradKernel<T, IndexT, __vec_size, kBlockSize>          \
+        <<<grid, kBlockSize, 0, dev_ctx.stream()>>>(logits_data,              \
+                                                    label.data<IndexT>(),     \
+                                                    logsumexp.data<float>(),  \
+                                                    loss_grad.data<T>(),      \
+                                                    ignore_index,             \
+                                                    rank * D,                 \
+                                                    N,                        \
+                                                    D,                        \
+                                                    grad_data);               \
+    break
+    PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_GRAD(4);
+    PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_GRAD(2);
+    PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_GRAD(1);
+#undef PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_GRAD
+    default:
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Unsupported vectorized size %d of fused_softmax_cross_entropy_grad.",
+          vec_size));
+  }
+}
+
+template <typename T, typename Context>
+void FusedSoftmaxCrossEntropyGradKernel(const Context& dev_ctx,
+                                        const DenseTensor& logits,
+                                        const DenseTensor& label,
+                                        const DenseTensor& logsumexp,
+                                        const DenseTensor& loss_grad,
+                                        int64_t ignore_index,
+                                        int ring_id,
+                                        int rank,
+                                        int nranks,
+                                        DenseTensor* logits_grad) {
+  if (label.dtype() == phi::DataType::INT64) {
+    FusedSoftmaxCrossEntropyGradImpl<T, int64_t>(dev_ctx,
+                                                 logits,
+                                                 label,
+                                                 logsumexp,
+                                                 loss_grad,
+                                                 ignore_index,
+                                                 rank,
+                                                 logits_grad);
+  } else if (label.dtype() == phi::DataType::INT32) {
+    FusedSoftmaxCrossEntropyGradImpl<T, int>(dev_ctx,
+                                             logits,
+                                             label,
+                                             logsumexp,
+                                             loss_grad,
+                                             ignore_index,
+                                             rank,
+                                             logits_grad);
+  } else {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "The label of fused_softmax_cross_entropy_grad only supports int32 "
+        "and int64, but received %s.",
+        label.dtype()));
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_softmax_cross_entropy_grad,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedSoftmaxCrossEntropyGradKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->InputAt(2).SetDataType(phi::DataType::FLOAT32);
+}
@@ -0,0 +1,316 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+
+#ifdef __NVCC__
+#include "cub/cub.cuh"
+#endif
+#ifdef __HIPCC__
+#include <hipcub/hipcub.hpp>
+namespace cub = hipcub;
+#endif
+
+#include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_helper.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/common/amp_type_traits.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/kernels/funcs/aligned_vector.h"
+
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+#include "paddle/phi/core/distributed/nccl_comm_context.h"
+#endif
+
+namespace phi {
+namespace fusion {
+
+// The max and the sum of exp(x - max) of a part of the logits of a row.
+struct SoftmaxStats {
+  float max;
+  float sum;
+};
+
+struct MergeSoftmaxStats {
+  __device__ __forceinline__ SoftmaxStats operator()(
+      const SoftmaxStats& a, const SoftmaxStats& b) const {
+    float max = a.max > b.max ? a.max : b.max;
+    if (max == -INFINITY) {
+      return {max, 0.f};
+    }
+    return {max, a.sum * __expf(a.max - max) + b.sum * __expf(b.max - max)};
+  }
+};
+
+__device__ __forceinline__ void UpdateSoftmaxStats(float x,
+                                                   SoftmaxStats* stats) {
+  if (x > stats->max) {
+    stats->sum = stats->sum * __expf(stats->max - x) + 1.f;
+    stats->max = x;
+  } else if (x != -INFINITY) {
+    stats->sum += __expf(x - stats->max);
+  }
+}
+
+// Each block reads the D logits of a row once, updating the running max and
+// sum of the online softmax, so the probabilities are never written. The
+// logits of a rank are the classes [start_index, start_index + D) of the
+// num_classes ones when the vocabulary is sharded.
+template <typename T, typename IndexT, int VecSize, int BlockSize>
+__global__ void SoftmaxCrossEntropyStatsKernel(const T* logits,
+                                               const IndexT* labels,
+                                               const int64_t ignore_index,
+                                               const int64_t start_index,
+                                               const int64_t num_classes,
+                                               const int64_t N,
+                                               const int64_t D,
+                                               float* max_out,
+                                               float* sum_out,
+                                               float* target_out) {
+  using VecT = phi::AlignedVector<T, VecSize>;
+  using BlockReduce = cub::BlockReduce<SoftmaxStats, BlockSize>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+
+  for (int64_t row = blockIdx.x; row < N; row += gridDim.x) {
+    const T* row_logits = logits + row * D;
+    SoftmaxStats stats{-INFINITY, 0.f};
+    for (int64_t col = threadIdx.x * VecSize; col < D;
+         col += BlockSize * VecSize) {
+      VecT vec;
+      phi::Load<T, VecSize>(row_logits + col, &vec);
+#pragma unroll
+      for (int i = 0; i < VecSize; ++i) {
+        UpdateSoftmaxStats(static_cast<float>(vec[i]), &stats);
+      }
+    }
+    stats = BlockReduce(temp_storage).Reduce(stats, MergeSoftmaxStats());
+
+    if (threadIdx.x == 0) {
+      auto label = static_cast<int64_t>(labels[row]);
+      PADDLE_ENFORCE((label >= 0 && label < num_classes) ||
+                         label == ignore_index,
+                     "The label of fused_softmax_cross_entropy should be in "
+                     "[0, %ld) or equal to ignore_index %ld, but received "
+                     "%ld.",
+                     num_classes,
+                     ignore_index,
+                     label);
+      float target = 0.f;
+      if (label >= start_index && label < start_index + D) {
+        target = static_cast<float>(row_logits[label - start_index]);
+      }
+      max_out[row] = stats.max;
+      sum_out[row] = stats.sum;
+      target_out[row] = target;
+    }
+    // The temp storage is reused by the next row.
+    __syncthreads();
+  }
+}
+
+// Scales the sums of the rank to the max of all the ranks, so that they can
+// be summed up.
+__global__ void RescaleSoftmaxSumKernel(const float* local_max,
+                                        const float* global_max,
+                                        const int64_t N,
+                                        float* sum) {
+  CUDA_KERNEL_LOOP_TYPE(i, N, int64_t) {
+    sum[i] = global_max[i] == -INFINITY
+                 ? 0.f
+                 : sum[i] * __expf(local_max[i] - global_max[i]);
+  }
+}
+
+template <typename T, typename IndexT>
+__global__ void SoftmaxCrossEntropyLossKernel(const IndexT* labels,
+                                              const int64_t ignore_index,
+                                              const float* max,
+                                              const float* sum,
+                                              const float* target,
+                                              const int64_t N,
+                                              T* loss,
+                                              float* logsumexp) {
+  CUDA_KERNEL_LOOP_TYPE(i, N, int64_t) {
+    float lse = __logf(sum[i]) + max[i];
+    logsumexp[i] = lse;
+    loss[i] = static_cast<int64_t>(labels[i]) == ignore_index
+                  ? static_cast<T>(0)
+                  : static_cast<T>(lse - target[i]);
+  }
+}
+
+template <typename T, typename IndexT, typename Context>
+void LaunchSoftmaxCrossEntropyStats(const Context& dev_ctx,
+                                    const DenseTensor& logits,
+                                    const DenseTensor& label,
+                                    int64_t ignore_index,
+                                    int64_t start_index,
+                                    int64_t num_classes,
+                                    int64_t N,
+                                    int64_t D,
+                                    float* max,
+                                    float* sum,
+                                    float* target) {
+  constexpr int kBlockSize = 512;
+  const T* logits_data = logits.data<T>();
+  int vec_size = phi::GetVectorizedSize<T>(logits_data);
+  while (D % vec_size != 0) {
+    vec_size /= 2;
+  }
+  const int64_t grid =
+      std::min<int64_t>(N, dev_ctx.GetCUDAMaxGridDimSize()[0]);
+  const IndexT* label_data = label.data<IndexT>();
+  switch (vec_size) {
+#define PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_STATS(__vec_size)                    \
+  case __vec_size:                                                           \
+    SoftmaxCrossEntropyStatsKernel<T, IndexT, __vec_size, kBlockSize>        \
+        <<<grid, kBlockSize, 0, dev_ctx.stream()>>>(logits_data,             \
+                                                    label_data,              \
+                                                    ignore_index,            \
+                                                    start_index,             \
+                                                    num_classes,             \
+                                                    N,                       \
+                                                    D,                       \
+                                                    max,                     \
+                                                    sum,                     \
+                                                    target);                 \
+    break
+    PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_STATS(4);
+    PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_STATS(2);
+    PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_STATS(1);
+#undef PD_LAUNCH_SOFTMAX_CROSS_ENTROPY_STATS
+    default:
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Unsupported vectorized size %d of fused_softmax_cross_entropy.",
+          vec_size));
+  }
+}
+
+template <typename T, typename IndexT, typename Context>
+void FusedSoftmaxCrossEntropyImpl(const Context& dev_ctx,
+                                  const DenseTensor& logits,
+                                  const DenseTensor& label,
+                                  int64_t ignore_index,
+                                  int rank,
+                                  int nranks,
+                                  DenseTensor* loss,
+                                  DenseTensor* logsumexp) {
+  const auto& logits_dims = logits.dims();
+  const int64_t D = logits_dims[logits_dims.size() - 1];
+  const int64_t N = D > 0 ? logits.numel() / D : 0;
+  T* loss_data = dev_ctx.template Alloc<T>(loss);
+  float* lse_data = dev_ctx.template Alloc<float>(logsumexp);
+  if (N == 0) {
+    return;
+  }
+
+  // The max of each row, followed by its sum and target logit, which are
+  // reduced across the ranks together.
+  DenseTensor max, sum_and_target;
+  max.Resize({N});
+  sum_and_target.Resize({2, N});
+  float* max_data = dev_ctx.template Alloc<float>(&max);
+  float* sum_data = dev_ctx.template Alloc<float>(&sum_and_target);
+  float* target_data = sum_data + N;
+  LaunchSoftmaxCrossEntropyStats<T, IndexT>(dev_ctx,
+                                            logits,
+                                            label,
+                                            ignore_index,
+                                            rank * D,
+                                            nranks * D,
+                                            N,
+                                            D,
+                                            max_data,
+                                            sum_data,
+                                            target_data);
+
+  auto config = phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, N);
+  if (nranks > 1) {
+#if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL)
+    auto* comm_ctx =
+        static_cast<distributed::NCCLCommContext*>(dev_ctx.GetCommContext());
+    PADDLE_ENFORCE_NE(comm_ctx,
+                      nullptr,
+                      phi::errors::Unavailable(
+                          "NCCLCommContext is nullptr, fused_softmax_cross_"
+                          "entropy with nranks > 1 should have the ring_id "
+                          "attr."));
+    DenseTensor global_max;
+    global_max.Resize({N});
+    float* global_max_data = dev_ctx.template Alloc<float>(&global_max);
+    comm_ctx->AllReduce(&global_max, max, ncclMax, dev_ctx.stream());
+    RescaleSoftmaxSumKernel<<<config.block_per_grid,
+                              config.thread_per_block,
+                              0,
+                              dev_ctx.stream()>>>(
+        max_data, global_max_data, N, sum_data);
+    comm_ctx->AllReduce(
+        &sum_and_target, sum_and_target, ncclSum, dev_ctx.stream());
+    max_data = global_max_data;
+#else
+    PADDLE_THROW(phi::errors::PreconditionNotMet(
+        "fused_softmax_cross_entropy with nranks > 1 requires PaddlePaddle "
+        "compiled with NCCL or RCCL."));
+#endif
+  }
+
+  SoftmaxCrossEntropyLossKernel<T, IndexT>
+      <<<config.block_per_grid, config.thread_per_block, 0, dev_ctx.stream()>>>(
+          label.data<IndexT>(),
+          ignore_index,
+          max_data,
+          sum_data,
+          target_data,
+          N,
+          loss_data,
+          lse_data);
+}
+
+template <typename T, typename Context>
+void FusedSoftmaxCrossEntropyKernel(const Context& dev_ctx,
+                                    const DenseTensor& logits,
+                                    const DenseTensor& label,
+                                    int64_t ignore_index,
+                                    int ring_id,
+                                    int rank,
+                                    int nranks,
+                                    DenseTensor* loss,
+                                    DenseTensor* logsumexp) {
+  if (label.dtype() == phi::DataType::INT64) {
+    FusedSoftmaxCrossEntropyImpl<T, int64_t>(
+        dev_ctx, logits, label, ignore_index, rank, nranks, loss, logsumexp);
+  } else if (label.dtype() == phi::DataType::INT32) {
+    FusedSoftmaxCrossEntropyImpl<T, int>(
+        dev_ctx, logits, label, ignore_index, rank, nranks, loss, logsumexp);
+  } else {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "The label of fused_softmax_cross_entropy only supports int32 and "
+        "int64, but received %s.",
+        label.dtype()));
+  }
+}
+
+}  // namespace fusion
+}  // namespace phi
+
+PD_REGISTER_KERNEL(fused_softmax_cross_entropy,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::fusion::FusedSoftmaxCrossEntropyKernel,
+                   float,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
+  kernel->OutputAt(1).SetDataType(phi::DataType::FLOAT32);
+}
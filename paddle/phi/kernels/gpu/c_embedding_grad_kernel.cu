@@ -102,6 +102,30 @@ void CEmbeddingGradKernel(const Context& dev_ctx,
           start_index);
       return;
     }
+  } else if (FLAGS_embedding_deterministic == 3) {
+    if (index_type == phi::DataType::INT32) {
+      phi::funcs::LaunchEmbeddingGradSortedKernel<T, int32_t>(
+          dev_ctx,
+          ids.data<int32_t>(),
+          d_output,
+          d_table,
+          N,
+          D,
+          K,
+          start_index);
+      return;
+    } else if (index_type == phi::DataType::INT64) {
+      phi::funcs::LaunchEmbeddingGradSortedKernel<T, int64_t>(
+          dev_ctx,
+          ids.data<int64_t>(),
+          d_output,
+          d_table,
+          N,
+          D,
+          K,
+          start_index);
+      return;
+    }
   } else {
     if (FLAGS_embedding_deterministic > 1) {
       VLOG(2) << "Run grad kernel of embedding with single thread.";
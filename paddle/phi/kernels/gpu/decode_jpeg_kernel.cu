@@ -16,6 +16,8 @@
 
 #include "paddle/phi/kernels/decode_jpeg_kernel.h"
 
+#include <unordered_map>
+
 #include "paddle/phi/backends/dynload/nvjpeg.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/backends/stream.h"
@@ -23,9 +25,28 @@
 
 namespace phi {
 
-static cudaStream_t nvjpeg_stream = nullptr;
 static nvjpegHandle_t nvjpeg_handle = nullptr;
 
+// The decoding state of each stream of the thread, which is reused by the
+// decodes on the stream since they run in order.
+nvjpegJpegState_t GetNvjpegState(gpuStream_t stream) {
+  thread_local std::unordered_map<gpuStream_t, nvjpegJpegState_t> states;
+  auto iter = states.find(stream);
+  if (iter != states.end()) {
+    return iter->second;
+  }
+  nvjpegJpegState_t nvjpeg_state;
+  nvjpegStatus_t state_status =
+      phi::dynload::nvjpegJpegStateCreate(nvjpeg_handle, &nvjpeg_state);
+
+  PADDLE_ENFORCE_EQ(
+      state_status,
+      NVJPEG_STATUS_SUCCESS,
+      errors::Fatal("nvjpegJpegStateCreate failed: ", state_status));
+  states.emplace(stream, nvjpeg_state);
+  return nvjpeg_state;
+}
+
 void InitNvjpegImage(nvjpegImage_t* img) {
   for (int c = 0; c < NVJPEG_MAX_COMPONENT; c++) {
     img->channel[c] = nullptr;
@@ -49,14 +70,7 @@ void DecodeJpegKernel(const Context& dev_ctx,
         errors::Fatal("nvjpegCreateSimple failed: ", create_status));
   }
 
-  nvjpegJpegState_t nvjpeg_state;
-  nvjpegStatus_t state_status =
-      phi::dynload::nvjpegJpegStateCreate(nvjpeg_handle, &nvjpeg_state);
-
-  PADDLE_ENFORCE_EQ(
-      state_status,
-      NVJPEG_STATUS_SUCCESS,
-      errors::Fatal("nvjpegJpegStateCreate failed: ", state_status));
+  nvjpegJpegState_t nvjpeg_state = GetNvjpegState(dev_ctx.stream());
 
   int components;
   nvjpegChromaSubsampling_t subsampling;
@@ -91,7 +105,6 @@ void DecodeJpegKernel(const Context& dev_ctx,
       output_format = NVJPEG_OUTPUT_RGB;
       output_components = 3;
     } else {
-      phi::dynload::nvjpegJpegStateDestroy(nvjpeg_state);
       PADDLE_THROW(errors::Fatal(
           "The provided mode is not supported for JPEG files on GPU"));
     }
@@ -102,7 +115,6 @@ void DecodeJpegKernel(const Context& dev_ctx,
     output_format = NVJPEG_OUTPUT_RGB;
     output_components = 3;
   } else {
-    phi::dynload::nvjpegJpegStateDestroy(nvjpeg_state);
     PADDLE_THROW(errors::Fatal(
         "The provided mode is not supported for JPEG files on GPU"));
   }
@@ -110,11 +122,6 @@ void DecodeJpegKernel(const Context& dev_ctx,
   nvjpegImage_t out_image;
   InitNvjpegImage(&out_image);
 
-  // create nvjpeg stream
-  if (nvjpeg_stream == nullptr) {
-    cudaStreamCreateWithFlags(&nvjpeg_stream, cudaStreamNonBlocking);
-  }
-
   int sz = widths[0] * heights[0];
 
   std::vector<int64_t> out_shape = {output_components, height, width};
@@ -127,13 +134,19 @@ void DecodeJpegKernel(const Context& dev_ctx,
     out_image.pitch[c] = width;
   }
 
+  // decodes on the stream of dev_ctx, so that the image is ordered with the
+  // kernels using it, e.g. on the stream of a data pipeline
   nvjpegStatus_t decode_status = phi::dynload::nvjpegDecode(nvjpeg_handle,
                                                             nvjpeg_state,
                                                             x_data,
                                                             x.numel(),
                                                             output_format,
                                                             &out_image,
-                                                            nvjpeg_stream);
+                                                            dev_ctx.stream());
+  PADDLE_ENFORCE_EQ(
+      decode_status,
+      NVJPEG_STATUS_SUCCESS,
+      errors::Fatal("nvjpegDecode failed: ", decode_status));
 }
 }  // namespace phi
 
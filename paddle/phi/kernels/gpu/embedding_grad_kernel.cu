@@ -107,6 +107,9 @@ struct EmbeddingGradCUDAFunctor {
       if (FLAGS_embedding_deterministic == 1) {
         phi::funcs::LaunchEmbeddingGradDeterministicKernel<T, IdT>(
             dev_ctx_, ids, d_output, d_table, N, D, K);
+      } else if (FLAGS_embedding_deterministic == 3) {
+        phi::funcs::LaunchEmbeddingGradSortedKernel<T, IdT>(
+            dev_ctx_, ids, d_output, d_table, N, D, K);
       } else {
         const int gridx = 2 * dev_ctx_.GetSMCount();
         dim3 threads(128, 8);
@@ -178,6 +181,10 @@ struct EmbeddingSparseGradCUDAFunctor {
     auto* table = &weight_;
     auto* d_output = &out_grad_;
     int64_t ids_num = input_.numel();
+    if (FLAGS_embedding_deterministic == 3 && ids_num > 0) {
+      ApplySorted<IdT>();
+      return;
+    }
     dim3 threads(128, 8);
     dim3 grids(8, 1);
     auto stream = dev_ctx_.stream();
@@ -228,6 +235,52 @@ struct EmbeddingSparseGradCUDAFunctor {
   }
 
  private:
+  // Merges the grads of the equal ids, so the rows of the SelectedRows are
+  // unique and sorted.
+  template <typename IdT>
+  void ApplySorted() {
+    const auto* ids_data = input_.template data<IdT>();
+    int64_t ids_num = input_.numel();
+    int64_t D = weight_.dims()[1];
+    auto gpu_place = dev_ctx_.GetPlace();
+    auto stream = dev_ctx_.stream();
+
+    phi::funcs::SortedEmbeddingIds sorted;
+    phi::funcs::SortEmbeddingIds<IdT>(
+        dev_ctx_, ids_data, ids_num, sizeof(IdT) * 8, &sorted);
+    int num_unique = 0;
+    memory_utils::Copy(phi::CPUPlace(),
+                       &num_unique,
+                       gpu_place,
+                       sorted.num_unique.template data<int>(),
+                       sizeof(int),
+                       stream);
+    dev_ctx_.Wait();
+    std::vector<IdT> unique_ids(num_unique);
+    memory_utils::Copy(phi::CPUPlace(),
+                       unique_ids.data(),
+                       gpu_place,
+                       sorted.unique_ids.template data<IdT>(),
+                       num_unique * sizeof(IdT),
+                       stream);
+
+    auto* d_table_value = weight_grad_->mutable_value();
+    d_table_value->Resize({num_unique, D});
+    auto* d_table_data = dev_ctx_.template Alloc<T>(d_table_value);
+    phi::funcs::LaunchEmbeddingGradSortedKernel<T, IdT, false, false>(
+        dev_ctx_,
+        sorted,
+        out_grad_.template data<T>(),
+        d_table_data,
+        D,
+        ids_num,
+        -1,
+        -1);
+    dev_ctx_.Wait();
+    weight_grad_->set_rows(
+        std::vector<int64_t>(unique_ids.begin(), unique_ids.end()));
+  }
+
   const phi::GPUContext& dev_ctx_;
   const DenseTensor& input_;
   const DenseTensor& weight_;
@@ -16,6 +16,7 @@
 #include <vector>
 #include "glog/logging.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
 #include "paddle/phi/common/amp_type_traits.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/common/scalar.h"
@@ -23,6 +24,8 @@
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/funcs/aligned_vector.h"
+#include "paddle/phi/kernels/funcs/math_cuda_utils.h"
+#include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/phi/kernels/funcs/multi_tensor_apply.h"
 
 namespace phi {
@@ -82,8 +85,14 @@ struct FusedAdamFunctor {
       FusedAdamBetaPowInfo<T, IsCPUBetaPow> beta_pow,
       MT epsilon,
       const MT* learning_rate,
-      MT decay) const {
+      MT decay,
+      const MT* grad_scale,
+      const bool* found_inf) const {
+    if (found_inf != nullptr && *found_inf) {
+      return;
+    }
     MT lr = *learning_rate;
+    MT g_scale = grad_scale != nullptr ? *grad_scale : static_cast<MT>(1.0);
     MT beta1_pow = beta_pow.GetBeta1PowValue();
     MT beta2_pow = beta_pow.GetBeta2PowValue();
     T* __restrict__ p_ptr;
@@ -158,7 +167,7 @@ struct FusedAdamFunctor {
         MT p = IsMultiPrecision ? mp_vec[j] : static_cast<MT>(p_vec[j]);
         UpdateMoments(&mom1_vec[j],
                       &mom2_vec[j],
-                      static_cast<MT>(g_vec[j]),
+                      static_cast<MT>(g_vec[j]) * g_scale,
                       beta1,
                       beta2);
         mp_vec[j] = UpdateParameter(p,
@@ -227,10 +236,68 @@ struct FusedAdamFunctor {
   }
 };
 
+// Sums the squares of the unscaled grads into square_sum, the tensor_addrs
+// are not used.
+template <typename T, typename MT, int N, int MaxTensorSize, int MaxBlockSize>
+struct FusedAdamSquaredL2NormFunctor {
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      const funcs::TensorAndBlockInfo<N, MaxTensorSize, MaxBlockSize>& t_info,
+      const float* loss_scaling,
+      MT* square_sum) const {
+    int chunk_id, tensor_id;
+    t_info.GetChunkIdAndTensorId(&chunk_id, &tensor_id);
+    int offset = chunk_id * chunk_size;
+    int n = min(t_info.sizes[tensor_id] - offset, chunk_size);
+    const T* __restrict__ g_ptr =
+        static_cast<const T*>(t_info.grads[tensor_id]) + offset;
+
+    MT inv_scale = loss_scaling != nullptr
+                       ? static_cast<MT>(1.0) / static_cast<MT>(*loss_scaling)
+                       : static_cast<MT>(1.0);
+    MT sum = static_cast<MT>(0.0);
+    for (int idx = threadIdx.x; idx < n; idx += blockDim.x) {
+      MT g = static_cast<MT>(g_ptr[idx]) * inv_scale;
+      sum += g * g;
+    }
+    sum = funcs::BlockReduceSum<MT>(sum, FINAL_MASK);
+    if (threadIdx.x == 0) {
+      phi::CudaAtomicAdd(square_sum, sum);
+    }
+  }
+};
+
+// The grads are multiplied by grad_scale in FusedAdamFunctor, which unscales
+// them and clips them by their global norm as ClipGradByGlobalNorm does. A
+// nan or inf norm means the grads overflowed, the update is skipped then.
+template <typename MT>
+__global__ void FusedAdamGradScaleKernel(const MT* square_sum,
+                                         const float* loss_scaling,
+                                         MT clip_norm,
+                                         MT* grad_scale,
+                                         bool* found_inf) {
+  MT norm = sqrt(*square_sum);
+  *found_inf = !isfinite(norm);
+  MT scale = loss_scaling != nullptr
+                 ? static_cast<MT>(1.0) / static_cast<MT>(*loss_scaling)
+                 : static_cast<MT>(1.0);
+  if (clip_norm > static_cast<MT>(0.0) && norm > clip_norm) {
+    scale *= clip_norm / norm;
+  }
+  *grad_scale = scale;
+}
+
 template <typename T, int N>
-__global__ void UpdateBetaPowGroup(
-    Array<T*, N> beta1_pow, Array<T*, N> beta2_pow, T beta1, T beta2, int n) {
+__global__ void UpdateBetaPowGroup(Array<T*, N> beta1_pow,
+                                   Array<T*, N> beta2_pow,
+                                   T beta1,
+                                   T beta2,
+                                   int n,
+                                   const bool* found_inf) {
   auto idx = threadIdx.x;
+  if (found_inf != nullptr && *found_inf) {
+    return;
+  }
   if (idx < n) {
     beta1_pow[idx][0] *= beta1;
     beta2_pow[idx][0] *= beta2;
@@ -272,6 +339,7 @@ void FusedAdamKernel(
     const std::vector<const DenseTensor*>& beta2_pows,
     const paddle::optional<std::vector<const DenseTensor*>>& master_params,
     const paddle::optional<DenseTensor>& skip_update,
+    const paddle::optional<DenseTensor>& loss_scaling,
     const Scalar& beta1,
     const Scalar& beta2,
     const Scalar& epsilon,
@@ -280,12 +348,14 @@ void FusedAdamKernel(
     bool use_adamw,
     bool multi_precision,
     bool use_global_beta_pow,
+    float clip_norm,
     std::vector<DenseTensor*> params_out,
     std::vector<DenseTensor*> moments1_out,
     std::vector<DenseTensor*> moments2_out,
     std::vector<DenseTensor*> beta1_pows_out,
     std::vector<DenseTensor*> beta2_pows_out,
-    std::vector<DenseTensor*> master_params_out) {
+    std::vector<DenseTensor*> master_params_out,
+    DenseTensor* found_inf) {
   using MPDType = typename phi::dtype::MPTypeTrait<T>::Type;
 
   auto n = params.size();
@@ -336,12 +406,71 @@ void FusedAdamKernel(
     VLOG(4) << "skip_update_value:" << skip_update_value;
   }
 
+  bool use_grad_scale = clip_norm > 0.0f || loss_scaling.is_initialized();
+  VLOG(4) << "clip_norm: " << clip_norm
+          << ", use loss_scaling: " << loss_scaling.is_initialized();
+  if (found_inf != nullptr && (skip_update_value || !use_grad_scale)) {
+    phi::funcs::SetConstant<Context, bool>()(dev_ctx, found_inf, false);
+  }
+
   // skip_update=true
   if (skip_update_value) {
     VLOG(4) << "Adam skip update";
     return;
   }
 
+  // One pass over the grads for their global norm before the update, instead
+  // of the unscale, the norm and the clip ops of the optimizer.
+  DenseTensor grad_scale_tensor;
+  DenseTensor found_inf_tensor;
+  const MPDType* grad_scale_ptr = nullptr;
+  const bool* found_inf_ptr = nullptr;
+  if (use_grad_scale) {
+    const float* loss_scaling_ptr = nullptr;
+    if (loss_scaling.is_initialized()) {
+      PADDLE_ENFORCE_EQ(loss_scaling->numel(),
+                        1,
+                        errors::InvalidArgument(
+                            "Input(LossScaling) size must be 1, but get %d",
+                            loss_scaling->numel()));
+      loss_scaling_ptr = loss_scaling->data<float>();
+    }
+    if (found_inf == nullptr) {
+      found_inf_tensor.Resize({1});
+      found_inf = &found_inf_tensor;
+    }
+    bool* found_inf_data = dev_ctx.template Alloc<bool>(found_inf);
+
+    // [square_sum, grad_scale]
+    grad_scale_tensor.Resize({2});
+    auto* square_sum = dev_ctx.template Alloc<MPDType>(&grad_scale_tensor);
+    phi::funcs::SetConstant<Context, MPDType>()(
+        dev_ctx, &grad_scale_tensor, static_cast<MPDType>(0));
+
+    constexpr int kMaxTensorSize = 110;
+    constexpr int kMaxBlockSize = 320;
+    constexpr int kBlockSize = 512;
+    FusedAdamSquaredL2NormFunctor<T, MPDType, 2, kMaxTensorSize, kMaxBlockSize>
+        norm_functor;
+    funcs::LaunchMultiTensorApplyKernel<2, kMaxTensorSize, kMaxBlockSize>(
+        dev_ctx,
+        kBlockSize,
+        chunk_size,
+        {params_out},
+        grads,
+        norm_functor,
+        loss_scaling_ptr,
+        square_sum);
+    FusedAdamGradScaleKernel<MPDType><<<1, 1, 0, dev_ctx.stream()>>>(
+        square_sum,
+        loss_scaling_ptr,
+        static_cast<MPDType>(clip_norm),
+        square_sum + 1,
+        found_inf_data);
+    grad_scale_ptr = square_sum + 1;
+    found_inf_ptr = found_inf_data;
+  }
+
   MPDType beta1_tmp = beta1.to<MPDType>();
   MPDType beta2_tmp = beta2.to<MPDType>();
 
@@ -391,7 +520,9 @@ void FusedAdamKernel(
         beta_pow_info,                                                       \
         epsilon.to<MPDType>(),                                               \
         learning_rate.data<MPDType>(),                                       \
-        static_cast<MPDType>(weight_decay));                                 \
+        static_cast<MPDType>(weight_decay),                                  \
+        grad_scale_ptr,                                                      \
+        found_inf_ptr);                                                      \
   } while (0)
 
 #define PD_LAUNCH_MULTI_TENSOR_APPLY_ADAM_KERNEL(__vec_size) \
@@ -454,6 +585,14 @@ void FusedAdamKernel(
 
   if (!use_global_beta_pow) {
     if (is_cpu_betapow) {
+      if (found_inf_ptr != nullptr) {
+        DenseTensor found_inf_cpu;
+        phi::Copy(dev_ctx, *found_inf, CPUPlace(), true, &found_inf_cpu);
+        if (found_inf_cpu.data<bool>()[0]) {
+          VLOG(4) << "Adam skip update for inf or nan grads";
+          return;
+        }
+      }
       for (size_t i = 0; i < n; i++) {
         VLOG(10) << "CPU Update BetaPow here...";
         auto* beta1_ptr =
@@ -479,7 +618,12 @@ void FusedAdamKernel(
         }
         UpdateBetaPowGroup<MPDType, kGroupSize>
             <<<1, kGroupSize, 0, dev_ctx.stream()>>>(
-                beta1_ptrs, beta2_ptrs, beta1_tmp, beta2_tmp, end - start);
+                beta1_ptrs,
+                beta2_ptrs,
+                beta1_tmp,
+                beta2_tmp,
+                end - start,
+                found_inf_ptr);
       }
     }
   }
@@ -504,4 +648,5 @@ PD_REGISTER_KERNEL(fused_adam,
   kernel->OutputAt(3).SetDataType(phi::DataType::UNDEFINED);
   kernel->OutputAt(4).SetDataType(phi::DataType::UNDEFINED);
   kernel->OutputAt(5).SetDataType(phi::DataType::UNDEFINED);
+  kernel->OutputAt(6).SetDataType(phi::DataType::BOOL);
 }
@@ -50,6 +50,8 @@ PD_REGISTER_KERNEL(matmul,
                    phi::dtype::complex<double>,
                    int8_t) {
 #endif
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
   if (kernel_key.dtype() == phi::DataType::INT8) {
     kernel->OutputAt(0).SetDataType(phi::DataType::INT32);
   }
@@ -70,6 +72,8 @@ PD_REGISTER_KERNEL(matmul,
                    phi::dtype::bfloat16,
                    phi::dtype::complex<float>,
                    phi::dtype::complex<double>) {
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
   if (kernel_key.dtype() == phi::DataType::INT8) {
     kernel->OutputAt(0).SetDataType(phi::DataType::INT32);
   }
@@ -20,7 +20,6 @@
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_utils.h"
-#include "paddle/phi/kernels/funcs/gather.cu.h"
 #include "paddle/phi/kernels/funcs/math_function.h"
 #include "paddle/phi/kernels/funcs/top_k_function_cuda.h"
 
@@ -53,6 +52,120 @@ namespace phi {
   FIXED_MAXLENGTH_BASE(4, ##__VA_ARGS__); \
   FIXED_MAXLENGTH_BASE(5, ##__VA_ARGS__)
 
+// The algorithms to get the top k of each row.
+enum class TopkAlgorithm {
+  // Sorts the rows by the segmented radix sort of cub.
+  kSort,
+  // Selects the k-th value of each row by radix select, which passes over
+  // the row a fixed number of times whatever k is.
+  kRadixSelect,
+  // Each block passes over its row once per value of the top k.
+  kMatrix,
+};
+
+// The conclusion is drawn from the data through multiple sets of statistics.
+// The radix select of the long rows is much faster than sorting them when k
+// is a small part of the row, and KeMatrixTopK is slower than sorting the
+// short rows for a large k, but faster than the radix select for a small k
+// unless there is only one row, which KeMatrixTopK gets by one block.
+inline TopkAlgorithm GetTopkAlgorithm(int64_t height,
+                                      int64_t width,
+                                      int64_t k,
+                                      double sort_ratio) {
+  constexpr int64_t kMaxMatrixTopkK = 64;
+  if (width >= 128 && k >= width * sort_ratio) {
+    return TopkAlgorithm::kSort;
+  }
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 9000
+  if (width >= 1024 && (height == 1 || k > kMaxMatrixTopkK)) {
+    return TopkAlgorithm::kRadixSelect;
+  }
+#endif
+  if (width >= 128 && k > kMaxMatrixTopkK) {
+    return TopkAlgorithm::kSort;
+  }
+  return TopkAlgorithm::kMatrix;
+}
+
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 9000
+// Gets the top k of each row by radix select and then sorts the k values if
+// needed. Returns false if the sorting fails.
+template <typename T, typename Context>
+bool RadixSelectTopk(const Context& dev_ctx,
+                     const T* input_data,
+                     int64_t input_height,
+                     int64_t input_width,
+                     int k,
+                     bool largest,
+                     bool sorted,
+                     DenseTensor* out,
+                     DenseTensor* indices) {
+  // The top k is selected into out and indices directly if it is unsorted.
+  DenseTensor selected_out;
+  DenseTensor selected_indices;
+  if (sorted) {
+    selected_out.Resize(out->dims());
+    selected_indices.Resize(indices->dims());
+    dev_ctx.template Alloc<T>(&selected_out);
+    dev_ctx.template Alloc<int64_t>(&selected_indices);
+  } else {
+    selected_out.ShareDataWith(*out);
+    selected_indices.ShareDataWith(*indices);
+  }
+
+  constexpr int max_num_threads = 1024;
+  if (largest) {
+    phi::funcs::RadixTopK<T, true>
+        <<<input_height, max_num_threads, 0, dev_ctx.stream()>>>(
+            input_data,
+            k,
+            input_height,
+            input_width,
+            selected_out.data<T>(),
+            selected_indices.data<int64_t>());
+  } else {
+    phi::funcs::RadixTopK<T, false>
+        <<<input_height, max_num_threads, 0, dev_ctx.stream()>>>(
+            input_data,
+            k,
+            input_height,
+            input_width,
+            selected_out.data<T>(),
+            selected_indices.data<int64_t>());
+  }
+  if (!sorted) {
+    return true;
+  }
+
+  // The positions in each row of sorting the selected values.
+  DenseTensor positions;
+  positions.Resize(indices->dims());
+  dev_ctx.template Alloc<int64_t>(&positions);
+  auto* ctx = reinterpret_cast<const phi::GPUContext*>(&dev_ctx);
+  if (!phi::funcs::SortTopk<T>(*ctx,
+                               &selected_out,
+                               k,
+                               input_height,
+                               k,
+                               out,
+                               &positions,
+                               largest)) {
+    return false;
+  }
+  constexpr int kPermuteThreads = 256;
+  const int64_t grid =
+      std::min<int64_t>(input_height, dev_ctx.GetCUDAMaxGridDimSize()[0]);
+  phi::funcs::PermuteTopKIndices<int64_t>
+      <<<grid, kPermuteThreads, 0, dev_ctx.stream()>>>(
+          selected_indices.data<int64_t>(),
+          positions.data<int64_t>(),
+          input_height,
+          k,
+          indices->data<int64_t>());
+  return true;
+}
+#endif
+
 template <typename T, typename Context>
 void TopkKernel(const Context& dev_ctx,
                 const DenseTensor& x,
@@ -105,9 +218,8 @@ void TopkKernel(const Context& dev_ctx,
       k = input_width;
     }
 
-    // The conclusion is drawn from the data through multiple sets of
-    // statistics
-    if (input_width >= 128 && k >= input_width * 0.25) {
+    auto algorithm = GetTopkAlgorithm(input_height, input_width, k, 0.25);
+    if (algorithm == TopkAlgorithm::kSort) {
       auto* ctx = reinterpret_cast<const phi::GPUContext*>(&dev_ctx);
       if (phi::funcs::SortTopk<T>(*ctx,
                                   input,
@@ -126,60 +238,20 @@ void TopkKernel(const Context& dev_ctx,
     }
 
 #if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 9000
-    if (input_width >= 1024 && in_dims.size() == 1) {
-      // 1. Gather TopK, but without sorting
-      constexpr int max_num_threads = 1024;
-      if (largest) {
-        phi::funcs::RadixTopK<T, true>
-            <<<input_height, max_num_threads, 0, dev_ctx.stream()>>>(
-                input_data,
-                k,
-                input_height,
-                input_width,
-                output_data,
-                indices_data);
-      } else {
-        phi::funcs::RadixTopK<T, false>
-            <<<input_height, max_num_threads, 0, dev_ctx.stream()>>>(
-                input_data,
-                k,
-                input_height,
-                input_width,
-                output_data,
-                indices_data);
-      }
-      // 2. Sort if needed
-      if (sorted) {
-        DenseTensor sorted_output;
-        DenseTensor sorted_indices;
-        DenseTensor gather_indices;
-        sorted_output.Resize(out->dims());
-        sorted_indices.Resize(indices->dims());
-        gather_indices.Resize(indices->dims());
-        dev_ctx.template Alloc<T>(&sorted_output);
-        dev_ctx.template Alloc<int64_t>(&sorted_indices);
-        dev_ctx.template Alloc<int64_t>(&gather_indices);
-        auto* ctx = reinterpret_cast<const phi::GPUContext*>(&dev_ctx);
-        if (phi::funcs::SortTopk<T>(*ctx,
-                                    out,
-                                    k,
-                                    input_height,
-                                    k,
-                                    &sorted_output,
-                                    &sorted_indices,
-                                    largest)) {
-          funcs::GPUGather<int64_t, int64_t>(
-              dev_ctx, *indices, sorted_indices, &gather_indices);
-          Copy(dev_ctx, gather_indices, indices->place(), false, indices);
-          Copy(dev_ctx, sorted_output, out->place(), false, out);
-          return;
-        } else {
-          VLOG(4) << "TopKOP: Some errors happened when use cub sorting, use "
-                     "default topk kernel.";
-        }
-      } else {
+    if (algorithm == TopkAlgorithm::kRadixSelect) {
+      if (RadixSelectTopk<T>(dev_ctx,
+                             input_data,
+                             input_height,
+                             input_width,
+                             k,
+                             largest,
+                             sorted,
+                             out,
+                             indices)) {
         return;
       }
+      VLOG(4) << "TopKOP: Some errors happened when use cub sorting, use "
+                 "default topk kernel.";
     }
 #endif
 
@@ -270,9 +342,8 @@ void TopkKernel(const Context& dev_ctx,
 
     if (k > input_width) k = input_width;
 
-    // The conclusion is drawn from the data through multiple sets of
-    // statistics
-    if (input_width >= 128 && k >= input_width * 0.75) {
+    auto algorithm = GetTopkAlgorithm(input_height, input_width, k, 0.75);
+    if (algorithm == TopkAlgorithm::kSort) {
       auto* ctx = reinterpret_cast<const phi::GPUContext*>(&dev_ctx);
       if (phi::funcs::SortTopk<T>(*ctx,
                                   &trans_input,
@@ -293,6 +364,27 @@ void TopkKernel(const Context& dev_ctx,
                    "default topk kernel.";
       }
     }
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 9000
+    if (algorithm == TopkAlgorithm::kRadixSelect) {
+      if (RadixSelectTopk<T>(dev_ctx,
+                             trans_input.data<T>(),
+                             input_height,
+                             input_width,
+                             k,
+                             largest,
+                             sorted,
+                             &trans_out,
+                             &trans_ind)) {
+        funcs::TransCompute<phi::GPUContext, int64_t>(
+            ndims, dev_ctx, trans_ind, indices, trans);
+        funcs::TransCompute<phi::GPUContext, T>(
+            ndims, dev_ctx, trans_out, out, trans);
+        return;
+      }
+      VLOG(4) << "TopKOP: Some errors happened when use cub sorting, use "
+                 "default topk kernel.";
+    }
+#endif
 
     const int kMaxHeight = 2048;
     int gridx = input_height < kMaxHeight ? input_height : kMaxHeight;
@@ -15,15 +15,22 @@
 #include "paddle/phi/kernels/unique_kernel.h"
 
 #include <thrust/adjacent_difference.h>
+#include <thrust/copy.h>
 #include <thrust/device_vector.h>
 #include <thrust/execution_policy.h>
 #include <thrust/functional.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/counting_iterator.h>
 #include <thrust/scatter.h>
 #include <thrust/sequence.h>
 #include <thrust/sort.h>
 #include <thrust/unique.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 
 #ifdef PADDLE_WITH_CUDA
@@ -32,13 +39,19 @@
 #include <hipcub/hipcub.hpp>
 namespace cub = hipcub;
 #endif
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
 #include "paddle/phi/common/memory_utils.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_utils.h"
 #include "paddle/phi/kernels/funcs/unique_functor.h"
 #include "paddle/phi/kernels/index_select_kernel.h"
 
+COMMON_DECLARE_int64(unique_hash_min_numel);
+COMMON_DECLARE_double(unique_hash_max_distinct_ratio);
+
 namespace phi {
 
 // Binary function 'less than'
@@ -510,6 +523,353 @@ static void UniqueDimsCUDATensor(const Context& context,
   }
 }
 
+// The hash path of the flattened unique of the integers, which gathers the
+// distinct values by an open addressing hash table instead of sorting the
+// whole input, and sorts only the distinct values. Every occupied slot of
+// the table keeps the first position of its value in the input.
+constexpr int64_t kUniqueEmptySlot = std::numeric_limits<int64_t>::max();
+constexpr int64_t kUniqueHashSampleNum = 16384;
+constexpr int64_t kUniqueHashMinCapacity = 4096;
+
+template <typename InT>
+__device__ __forceinline__ int64_t UniqueHashSlot(InT key, int64_t capacity) {
+  // the finalizer of splitmix64
+  uint64_t h = static_cast<uint64_t>(static_cast<int64_t>(key));
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return static_cast<int64_t>(h & (capacity - 1));
+}
+
+template <typename InT>
+__global__ void UniqueHashSample(const InT* in,
+                                 int64_t stride,
+                                 int64_t sample_num,
+                                 InT* sample) {
+  CUDA_KERNEL_LOOP_TYPE(i, sample_num, int64_t) { sample[i] = in[i * stride]; }
+}
+
+// stats[0] is the number of the distinct values, and stats[1] is set if the
+// table is full.
+template <typename InT>
+__global__ void UniqueHashInsert(const InT* in,
+                                 int64_t num_input,
+                                 int64_t capacity,
+                                 int64_t* slots,
+                                 int64_t* slot_counts,
+                                 int64_t* stats) {
+  CUDA_KERNEL_LOOP_TYPE(i, num_input, int64_t) {
+    const InT key = in[i];
+    int64_t slot = UniqueHashSlot(key, capacity);
+    int64_t probe = 0;
+    for (; probe < capacity; ++probe) {
+      int64_t pos = slots[slot];
+      if (pos == kUniqueEmptySlot) {
+        pos = static_cast<int64_t>(
+            atomicCAS(reinterpret_cast<unsigned long long*>(  // NOLINT
+                          slots + slot),
+                      static_cast<unsigned long long>(  // NOLINT
+                          kUniqueEmptySlot),
+                      static_cast<unsigned long long>(i)));  // NOLINT
+        if (pos == kUniqueEmptySlot) {
+          phi::CudaAtomicAdd(stats, static_cast<int64_t>(1));
+          break;
+        }
+      }
+      // any position of the key in the slot is valid while it goes down
+      if (in[pos] == key) {
+        if (i < pos) {
+          phi::CudaAtomicMin(slots + slot, i);
+        }
+        break;
+      }
+      slot = (slot + 1) & (capacity - 1);
+    }
+    if (probe == capacity) {
+      stats[1] = 1;
+    } else if (slot_counts != nullptr) {
+      phi::CudaAtomicAdd(slot_counts + slot, static_cast<int64_t>(1));
+    }
+  }
+}
+
+struct UniqueSlotOccupied {
+  __device__ bool operator()(int64_t pos) const {
+    return pos != kUniqueEmptySlot;
+  }
+};
+
+template <typename InT, typename IndexT>
+__global__ void UniqueHashGather(const InT* in,
+                                 const int64_t* unique_slots,
+                                 int64_t num_out,
+                                 const int64_t* slots,
+                                 const int64_t* slot_counts,
+                                 InT* out,
+                                 IndexT* indices,
+                                 IndexT* counts,
+                                 IndexT* slot_ids) {
+  CUDA_KERNEL_LOOP_TYPE(j, num_out, int64_t) {
+    const int64_t slot = unique_slots[j];
+    const int64_t pos = slots[slot];
+    out[j] = in[pos];
+    if (indices != nullptr) {
+      indices[j] = static_cast<IndexT>(pos);
+    }
+    if (counts != nullptr) {
+      counts[j] = static_cast<IndexT>(slot_counts[slot]);
+    }
+    if (slot_ids != nullptr) {
+      slot_ids[slot] = static_cast<IndexT>(j);
+    }
+  }
+}
+
+template <typename InT, typename IndexT>
+__global__ void UniqueHashInverse(const InT* in,
+                                  int64_t num_input,
+                                  int64_t capacity,
+                                  const int64_t* slots,
+                                  const IndexT* slot_ids,
+                                  IndexT* inverse) {
+  CUDA_KERNEL_LOOP_TYPE(i, num_input, int64_t) {
+    const InT key = in[i];
+    int64_t slot = UniqueHashSlot(key, capacity);
+    // every key is in the table
+    while (in[slots[slot]] != key) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    inverse[i] = slot_ids[slot];
+  }
+}
+
+// Estimates the number of the distinct values of the input from a strided
+// sample, by the Good-Turing coverage of the sample: the values seen once
+// in the sample stand for the ones it misses.
+template <typename Context, typename InT>
+static int64_t EstimateUniqueNum(const Context& context,
+                                 const InT* in_data,
+                                 int64_t num_input) {
+  const int64_t sample_num = std::min(num_input, kUniqueHashSampleNum);
+  const int64_t stride = num_input / sample_num;
+  DenseTensor sample;
+  sample.Resize(common::make_ddim({sample_num}));
+  auto* sample_data = context.template Alloc<InT>(&sample);
+  auto config = phi::backends::gpu::GetGpuLaunchConfig1D(context, sample_num);
+  UniqueHashSample<InT><<<config.block_per_grid,
+                          config.thread_per_block,
+                          0,
+                          context.stream()>>>(
+      in_data, stride, sample_num, sample_data);
+  std::vector<InT> host_sample(sample_num);
+  memory_utils::Copy(phi::CPUPlace(),
+                     host_sample.data(),
+                     context.GetPlace(),
+                     sample_data,
+                     sample_num * sizeof(InT),
+                     context.stream());
+  context.Wait();
+
+  std::unordered_map<InT, int64_t> freqs;
+  for (auto value : host_sample) {
+    ++freqs[value];
+  }
+  int64_t singletons = 0;
+  for (auto& freq : freqs) {
+    singletons += freq.second == 1;
+  }
+  if (singletons == sample_num) {
+    return num_input;
+  }
+  double coverage = 1.0 - static_cast<double>(singletons) / sample_num;
+  return std::min(
+      num_input,
+      static_cast<int64_t>(std::ceil(static_cast<double>(freqs.size()) /
+                                     coverage)));
+}
+
+// Returns false if the input is left to the sorting path, since it has too
+// many distinct values or is not an integer.
+template <typename Context, typename InT, typename IndexT>
+static typename std::enable_if<std::is_integral<InT>::value, bool>::type
+UniqueFlattendHashCUDATensor(const Context& context,
+                             const DenseTensor& in,
+                             DenseTensor* out,
+                             DenseTensor* indices,
+                             DenseTensor* index,
+                             DenseTensor* counts,
+                             bool return_index,
+                             bool return_inverse,
+                             bool return_counts,
+                             bool is_sorted,
+                             int64_t num_input) {
+  if (FLAGS_unique_hash_min_numel < 0 ||
+      num_input < FLAGS_unique_hash_min_numel || num_input == 0) {
+    return false;
+  }
+  const InT* in_data = in.data<InT>();
+  const int64_t estimated_num = EstimateUniqueNum(context, in_data, num_input);
+  if (estimated_num >
+      FLAGS_unique_hash_max_distinct_ratio * static_cast<double>(num_input)) {
+    return false;
+  }
+  // at most a quarter full at the estimate, so the probes stay short
+  int64_t capacity = kUniqueHashMinCapacity;
+  while (capacity < 4 * estimated_num) {
+    capacity <<= 1;
+  }
+  VLOG(4) << "The hash path of unique of " << num_input
+          << " elements, the estimated distinct values: " << estimated_num
+          << ", the capacity of the table: " << capacity;
+
+#ifdef PADDLE_WITH_CUDA
+  phi::memory_utils::ThrustAllocator<cudaStream_t> allocator(context.GetPlace(),
+                                                             context.stream());
+  const auto& exec_policy = thrust::cuda::par(allocator).on(context.stream());
+#else
+  const auto& exec_policy = thrust::hip::par.on(context.stream());
+#endif
+
+  // 1. Insert all the elements into the table
+  DenseTensor slots;
+  slots.Resize(common::make_ddim({capacity}));
+  auto* slots_data = context.template Alloc<int64_t>(&slots);
+  thrust::fill(
+      exec_policy, slots_data, slots_data + capacity, kUniqueEmptySlot);
+  DenseTensor slot_counts;
+  int64_t* slot_counts_data = nullptr;
+  if (return_counts) {
+    slot_counts.Resize(common::make_ddim({capacity}));
+    slot_counts_data = context.template Alloc<int64_t>(&slot_counts);
+    thrust::fill(exec_policy, slot_counts_data, slot_counts_data + capacity, 0);
+  }
+  DenseTensor stats;
+  stats.Resize(common::make_ddim({2}));
+  auto* stats_data = context.template Alloc<int64_t>(&stats);
+  thrust::fill(exec_policy, stats_data, stats_data + 2, 0);
+  auto config = phi::backends::gpu::GetGpuLaunchConfig1D(context, num_input);
+  UniqueHashInsert<InT><<<config.block_per_grid,
+                          config.thread_per_block,
+                          0,
+                          context.stream()>>>(in_data,
+                                              num_input,
+                                              capacity,
+                                              slots_data,
+                                              slot_counts_data,
+                                              stats_data);
+  int64_t host_stats[2];
+  memory_utils::Copy(phi::CPUPlace(),
+                     host_stats,
+                     context.GetPlace(),
+                     stats_data,
+                     sizeof(host_stats),
+                     context.stream());
+  context.Wait();
+  if (host_stats[1] != 0) {
+    VLOG(4) << "The hash table of unique is full, fall back to sorting.";
+    return false;
+  }
+  const int64_t num_out = host_stats[0];
+
+  // 2. Order the distinct values by the values, or by their first positions
+  DenseTensor unique_slots;
+  unique_slots.Resize(common::make_ddim({num_out}));
+  auto* unique_slots_data = context.template Alloc<int64_t>(&unique_slots);
+  thrust::copy_if(exec_policy,
+                  thrust::counting_iterator<int64_t>(0),
+                  thrust::counting_iterator<int64_t>(capacity),
+                  slots_data,
+                  unique_slots_data,
+                  UniqueSlotOccupied());
+  DenseTensor first_pos;
+  first_pos.Resize(common::make_ddim({num_out}));
+  auto* first_pos_data = context.template Alloc<int64_t>(&first_pos);
+  thrust::gather(exec_policy,
+                 unique_slots_data,
+                 unique_slots_data + num_out,
+                 slots_data,
+                 first_pos_data);
+  out->Resize(common::make_ddim({num_out}));
+  auto* out_data = context.template Alloc<InT>(out);
+  if (is_sorted) {
+    thrust::gather(exec_policy,
+                   first_pos_data,
+                   first_pos_data + num_out,
+                   in_data,
+                   out_data);
+    thrust::sort_by_key(
+        exec_policy, out_data, out_data + num_out, unique_slots_data);
+  } else {
+    thrust::sort_by_key(exec_policy,
+                        first_pos_data,
+                        first_pos_data + num_out,
+                        unique_slots_data);
+  }
+
+  // 3. Calculate 'out', 'indices' and 'counts'
+  IndexT* indices_data = nullptr;
+  if (return_index) {
+    indices->Resize(common::make_ddim({num_out}));
+    indices_data = context.template Alloc<IndexT>(indices);
+  }
+  IndexT* counts_data = nullptr;
+  if (return_counts) {
+    counts->Resize(common::make_ddim({num_out}));
+    counts_data = context.template Alloc<IndexT>(counts);
+  }
+  DenseTensor slot_ids;
+  IndexT* slot_ids_data = nullptr;
+  if (return_inverse) {
+    slot_ids.Resize(common::make_ddim({capacity}));
+    slot_ids_data = context.template Alloc<IndexT>(&slot_ids);
+  }
+  auto out_config = phi::backends::gpu::GetGpuLaunchConfig1D(context, num_out);
+  UniqueHashGather<InT, IndexT><<<out_config.block_per_grid,
+                                  out_config.thread_per_block,
+                                  0,
+                                  context.stream()>>>(in_data,
+                                                      unique_slots_data,
+                                                      num_out,
+                                                      slots_data,
+                                                      slot_counts_data,
+                                                      out_data,
+                                                      indices_data,
+                                                      counts_data,
+                                                      slot_ids_data);
+
+  // 4. Calculate inverse index: 'inverse'
+  if (return_inverse) {
+    index->Resize(common::make_ddim({num_input}));
+    auto* inverse_data = context.template Alloc<IndexT>(index);
+    UniqueHashInverse<InT, IndexT><<<config.block_per_grid,
+                                     config.thread_per_block,
+                                     0,
+                                     context.stream()>>>(in_data,
+                                                         num_input,
+                                                         capacity,
+                                                         slots_data,
+                                                         slot_ids_data,
+                                                         inverse_data);
+  }
+  return true;
+}
+
+template <typename Context, typename InT, typename IndexT>
+static typename std::enable_if<!std::is_integral<InT>::value, bool>::type
+UniqueFlattendHashCUDATensor(const Context& context,
+                             const DenseTensor& in,
+                             DenseTensor* out,
+                             DenseTensor* indices,
+                             DenseTensor* index,
+                             DenseTensor* counts,
+                             bool return_index,
+                             bool return_inverse,
+                             bool return_counts,
+                             bool is_sorted,
+                             int64_t num_input) {
+  return false;
+}
+
 // functor for processing a flattend DenseTensor
 template <typename Context, typename InT>
 struct UniqueFlattendCUDAFunctor {
@@ -522,6 +882,7 @@ struct UniqueFlattendCUDAFunctor {
   const bool return_index_;
   const bool return_inverse_;
   const bool return_counts_;
+  const bool is_sorted_;
 
   UniqueFlattendCUDAFunctor(const Context& context,
                             const DenseTensor& in,
@@ -531,7 +892,8 @@ struct UniqueFlattendCUDAFunctor {
                             DenseTensor* counts,
                             bool return_index,
                             bool return_inverse,
-                            bool return_counts)
+                            bool return_counts,
+                            bool is_sorted)
       : ctx_(context),
         in_(in),
         out_(out),
@@ -540,10 +902,24 @@ struct UniqueFlattendCUDAFunctor {
         counts_(counts),
         return_index_(return_index),
         return_inverse_(return_inverse),
-        return_counts_(return_counts) {}
+        return_counts_(return_counts),
+        is_sorted_(is_sorted) {}
 
   template <typename IndexT>
   void apply() const {
+    if (UniqueFlattendHashCUDATensor<Context, InT, IndexT>(ctx_,
+                                                           in_,
+                                                           out_,
+                                                           indices_,
+                                                           index_,
+                                                           counts_,
+                                                           return_index_,
+                                                           return_inverse_,
+                                                           return_counts_,
+                                                           is_sorted_,
+                                                           in_.numel())) {
+      return;
+    }
     UniqueFlattendCUDATensor<Context, InT, IndexT>(ctx_,
                                                    in_,
                                                    out_,
@@ -642,7 +1018,8 @@ void UniqueRawKernel(const Context& context,
                                               counts,
                                               return_index,
                                               return_inverse,
-                                              return_counts));
+                                              return_counts,
+                                              is_sorted));
   } else {
     // 'axis' is required.
     int axis_value = axis[0];
@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/kernels/autotune/cache_base.h"
 #include "paddle/phi/kernels/cast_kernel.h"
+#include "paddle/phi/kernels/contiguous_kernel.h"
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/funcs/blas/blaslt_impl.cu.h"
 #include "paddle/phi/kernels/funcs/complex_functors.h"
@@ -1970,6 +1971,33 @@ MatmulJudgeDtypeKernel(const Context& ctx,
       ctx, x, y, x_dims, y_dims, out, transpose_x, transpose_y);
 }
 
+// The input of matmul whose strides are supported, which is read by its
+// buffer when it is the transpose of the last two dims of a contiguous
+// tensor, e.g. the view of x.T, with the transpose flipped. The others are
+// copied to be contiguous.
+template <typename T, typename Context>
+DenseTensor MatmulStridedInput(const Context& ctx,
+                               const DenseTensor& x,
+                               bool* transpose) {
+  if (x.meta().is_contiguous()) {
+    return x;
+  }
+  const int rank = x.dims().size();
+  if (rank >= 2) {
+    DDim dims = x.dims();
+    DDim strides = x.strides();
+    std::swap(dims[rank - 1], dims[rank - 2]);
+    std::swap(strides[rank - 1], strides[rank - 2]);
+    if (strides == DenseTensorMeta::calc_strides(dims)) {
+      DenseTensor buffer = x;
+      buffer.ShareStridedViewWith(x, dims, strides, x.offset());
+      *transpose = !*transpose;
+      return buffer;
+    }
+  }
+  return phi::Contiguous<T, Context>(ctx, x);
+}
+
 template <typename T, typename Context>
 void MatmulKernel(const Context& ctx,
                   const DenseTensor& x,
@@ -1987,10 +2015,12 @@ void MatmulKernel(const Context& ctx,
       0,
       phi::errors::InvalidArgument("The Input(Y) dims size must not be equal "
                                    "0, but received dims size is 0."));
-  const std::vector<std::int64_t> x_dims = common::vectorize(x.dims());
-  const std::vector<std::int64_t> y_dims = common::vectorize(y.dims());
+  const DenseTensor x_in = MatmulStridedInput<T>(ctx, x, &transpose_x);
+  const DenseTensor y_in = MatmulStridedInput<T>(ctx, y, &transpose_y);
+  const std::vector<std::int64_t> x_dims = common::vectorize(x_in.dims());
+  const std::vector<std::int64_t> y_dims = common::vectorize(y_in.dims());
   MatmulJudgeDtypeKernel<Context, T>(
-      ctx, x, y, x_dims, y_dims, out, transpose_x, transpose_y);
+      ctx, x_in, y_in, x_dims, y_dims, out, transpose_x, transpose_y);
 }
 
 template <typename T, typename Context>
@@ -0,0 +1,133 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "paddle/common/array.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/hostdevice.h"
+#include "paddle/phi/kernels/funcs/for_range.h"
+#include "paddle/phi/kernels/resized_crop_normalize_kernel.h"
+
+namespace phi {
+
+// the normalization of each channel is passed to the kernels by value
+constexpr int kResizedCropMaxChannels = 16;
+
+template <typename T>
+struct ResizedCropNormalizeFunctor {
+  const T* x;
+  float* out;
+  int64_t channels;
+  int64_t in_h;
+  int64_t in_w;
+  int top;
+  int left;
+  int crop_h;
+  int crop_w;
+  int out_h;
+  int out_w;
+  bool flip;
+  float ratio_h;
+  float ratio_w;
+  Array<float, kResizedCropMaxChannels> scale;
+  Array<float, kResizedCropMaxChannels> shift;
+
+  // one output pixel of all channels for each index
+  HOSTDEVICE void operator()(int64_t index) const {
+    int64_t ow = index % out_w;
+    int64_t oh = index / out_w % out_h;
+    int64_t n = index / out_w / out_h;
+
+    float src_h = (oh + 0.5f) * ratio_h - 0.5f;
+    src_h = src_h > 0 ? src_h : 0;
+    int h0 = static_cast<int>(src_h);
+    int h1 = h0 + 1 < crop_h ? h0 + 1 : crop_h - 1;
+    float lh = src_h - h0;
+    float src_w = (ow + 0.5f) * ratio_w - 0.5f;
+    src_w = src_w > 0 ? src_w : 0;
+    int w0 = static_cast<int>(src_w);
+    int w1 = w0 + 1 < crop_w ? w0 + 1 : crop_w - 1;
+    float lw = src_w - w0;
+
+    int64_t row0 = (top + h0) * in_w;
+    int64_t row1 = (top + h1) * in_w;
+    int64_t col0 = left + w0;
+    int64_t col1 = left + w1;
+    int64_t out_col = flip ? out_w - 1 - ow : ow;
+    for (int64_t c = 0; c < channels; ++c) {
+      const T* plane = x + (n * channels + c) * in_h * in_w;
+      float v = (1 - lh) * ((1 - lw) * static_cast<float>(plane[row0 + col0]) +
+                            lw * static_cast<float>(plane[row0 + col1])) +
+                lh * ((1 - lw) * static_cast<float>(plane[row1 + col0]) +
+                      lw * static_cast<float>(plane[row1 + col1]));
+      out[((n * channels + c) * out_h + oh) * out_w + out_col] =
+          v * scale[c] + shift[c];
+    }
+  }
+};
+
+template <typename T, typename Context>
+void ResizedCropNormalizeKernel(const Context& dev_ctx,
+                                const DenseTensor& x,
+                                const std::vector<int>& crop,
+                                const std::vector<int>& size,
+                                bool flip,
+                                const std::vector<float>& mean,
+                                const std::vector<float>& std,
+                                DenseTensor* out) {
+  const auto& dims = x.dims();
+  int rank = dims.size();
+  int64_t channels = dims[rank - 3];
+  PADDLE_ENFORCE_LE(
+      channels,
+      kResizedCropMaxChannels,
+      errors::InvalidArgument("The images to resized_crop_normalize should "
+                              "have at most %d channels, but received %d.",
+                              kResizedCropMaxChannels,
+                              channels));
+
+  ResizedCropNormalizeFunctor<T> functor;
+  functor.x = x.data<T>();
+  functor.out = dev_ctx.template Alloc<float>(out);
+  functor.channels = channels;
+  functor.in_h = dims[rank - 2];
+  functor.in_w = dims[rank - 1];
+  functor.top = crop[0];
+  functor.left = crop[1];
+  functor.crop_h = crop[2];
+  functor.crop_w = crop[3];
+  functor.out_h = size[0];
+  functor.out_w = size[1];
+  functor.flip = flip;
+  functor.ratio_h = static_cast<float>(crop[2]) / size[0];
+  functor.ratio_w = static_cast<float>(crop[3]) / size[1];
+  for (int64_t c = 0; c < channels; ++c) {
+    float m = mean.empty() ? 0.0f : mean[mean.size() == 1 ? 0 : c];
+    float s = std.empty() ? 1.0f : std[std.size() == 1 ? 0 : c];
+    functor.scale[c] = 1.0f / s;
+    functor.shift[c] = -m / s;
+  }
+
+  int64_t num_pixels = out->numel() / channels;
+  if (num_pixels == 0) {
+    return;
+  }
+  funcs::ForRange<Context> for_range(dev_ctx, num_pixels);
+  for_range(functor);
+}
+
+}  // namespace phi
@@ -18,6 +18,8 @@
 #include "paddle/phi/common/float16.h"
 #endif
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/visit_type.h"
+#include "paddle/phi/kernels/contiguous_kernel.h"
 #include "paddle/phi/kernels/impl/elementwise_kernel_impl.h"
 #include "paddle/phi/kernels/legacy/elementwise_add_kernel.h"
 #include "paddle/phi/kernels/legacy/elementwise_divide_kernel.h"
@@ -27,12 +29,39 @@
 
 namespace phi {
 
+// The inputs of add, subtract, multiply and divide on GPU are stride
+// supported, which BroadcastKernel reads by their strides unless they exceed
+// its 32-bit offsets, then they are copied to be contiguous into dense_x.
+template <typename Context>
+const DenseTensor& ElementwiseStridedInput(const Context& dev_ctx,
+                                           const DenseTensor& x,
+                                           const DenseTensor& out,
+                                           DenseTensor* dense_x) {
+#ifndef PADDLE_WITH_XPU_KP
+  if (!x.meta().is_contiguous() &&
+      !funcs::IsStridedInputIndexable(x, out.numel())) {
+    PD_VISIT_ALL_TYPES(
+        x.dtype(), "ElementwiseStridedInput", ([&] {
+          *dense_x = phi::Contiguous<data_t, Context>(dev_ctx, x);
+        }));
+    return *dense_x;
+  }
+#endif
+  return x;
+}
+
 template <typename T, typename Context>
 void SubtractKernel(const Context& dev_ctx,
                     const DenseTensor& x,
                     const DenseTensor& y,
                     DenseTensor* out) {
-  phi::SubtractRawKernel<T, Context>(dev_ctx, x, y, -1, out);
+  DenseTensor dense_x, dense_y;
+  phi::SubtractRawKernel<T, Context>(
+      dev_ctx,
+      ElementwiseStridedInput(dev_ctx, x, *out, &dense_x),
+      ElementwiseStridedInput(dev_ctx, y, *out, &dense_y),
+      -1,
+      out);
 }
 
 template <typename T, typename Context>
@@ -40,7 +69,13 @@ void MultiplyKernel(const Context& dev_ctx,
                     const DenseTensor& x,
                     const DenseTensor& y,
                     DenseTensor* out) {
-  phi::MultiplyRawKernel<T, Context>(dev_ctx, x, y, -1, out);
+  DenseTensor dense_x, dense_y;
+  phi::MultiplyRawKernel<T, Context>(
+      dev_ctx,
+      ElementwiseStridedInput(dev_ctx, x, *out, &dense_x),
+      ElementwiseStridedInput(dev_ctx, y, *out, &dense_y),
+      -1,
+      out);
 }
 
 template <typename T, typename Context>
@@ -48,7 +83,13 @@ void DivideKernel(const Context& dev_ctx,
                   const DenseTensor& x,
                   const DenseTensor& y,
                   DenseTensor* out) {
-  phi::DivideRawKernel<T, Context>(dev_ctx, x, y, -1, out);
+  DenseTensor dense_x, dense_y;
+  phi::DivideRawKernel<T, Context>(
+      dev_ctx,
+      ElementwiseStridedInput(dev_ctx, x, *out, &dense_x),
+      ElementwiseStridedInput(dev_ctx, y, *out, &dense_y),
+      -1,
+      out);
 }
 
 template <typename T, typename Context>
@@ -85,14 +126,17 @@ void AddKernel(const Context& dev_ctx,
                const DenseTensor& x,
                const DenseTensor& y,
                DenseTensor* out) {
+  DenseTensor dense_x, dense_y;
+  const auto& x_in = ElementwiseStridedInput(dev_ctx, x, *out, &dense_x);
+  const auto& y_in = ElementwiseStridedInput(dev_ctx, y, *out, &dense_y);
 #ifdef PADDLE_WITH_CUDA
   if (x.dtype() == phi::DataType::FLOAT32 &&
       (y.dtype() == phi::DataType::BFLOAT16 ||
        y.dtype() == phi::DataType::FLOAT16)) {
-    MultiPrecisionAddKernelImpl<float, Context>(dev_ctx, x, y, out);
+    MultiPrecisionAddKernelImpl<float, Context>(dev_ctx, x_in, y_in, out);
   } else {
 #endif
-    phi::AddRawKernel<T, Context>(dev_ctx, x, y, -1, out);
+    phi::AddRawKernel<T, Context>(dev_ctx, x_in, y_in, -1, out);
 #ifdef PADDLE_WITH_CUDA
   }
 #endif
@@ -316,7 +360,10 @@ PD_REGISTER_KERNEL(add,
                    phi::dtype::float16,
                    phi::dtype::bfloat16,
                    complex64,
-                   complex128) {}
+                   complex128) {
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
+}
 
 PD_REGISTER_KERNEL(grad_add,
                    KPS,
@@ -350,7 +397,10 @@ PD_REGISTER_KERNEL(divide,
                    float16,
                    bfloat16,
                    complex64,
-                   complex128) {}
+                   complex128) {
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
+}
 
 PD_REGISTER_KERNEL(multiply,
                    KPS,
@@ -364,7 +414,10 @@ PD_REGISTER_KERNEL(multiply,
                    float16,
                    complex64,
                    complex128,
-                   bfloat16) {}
+                   bfloat16) {
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
+}
 
 PD_REGISTER_KERNEL(subtract,
                    KPS,
@@ -378,6 +431,9 @@ PD_REGISTER_KERNEL(subtract,
                    float16,
                    bfloat16,
                    complex64,
-                   complex128) {}
+                   complex128) {
+  kernel->InputAt(0).SetStrideSupported();
+  kernel->InputAt(1).SetStrideSupported();
+}
 
 #endif
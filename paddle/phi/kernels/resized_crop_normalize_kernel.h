@@ -0,0 +1,38 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace phi {
+
+// Crops the box crop = [top, left, height, width] of the images x of shape
+// [C, H, W] or [N, C, H, W], resizes it to size = [out_h, out_w] by the
+// bilinear interpolation of align_corners=False, optionally flips it
+// horizontally, and normalizes each channel by (v - mean[c]) / std[c], all in
+// one pass. The output is float32.
+template <typename T, typename Context>
+void ResizedCropNormalizeKernel(const Context& dev_ctx,
+                                const DenseTensor& x,
+                                const std::vector<int>& crop,
+                                const std::vector<int>& size,
+                                bool flip,
+                                const std::vector<float>& mean,
+                                const std::vector<float>& std,
+                                DenseTensor* out);
+
+}  // namespace phi
@@ -14,6 +14,8 @@
 
 #include "paddle/phi/kernels/selected_rows/adam_kernel.h"
 
+#include <algorithm>
+
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
 
@@ -164,14 +166,31 @@ void AdamDenseParamSparseGradKernel(
   }
   if (lazy_mode) {
     VLOG(3) << "run cpu lazy mode";
-    size_t row_count = grad_merge.rows().size();
-    std::vector<int64_t> cpu_rows(grad_merge.rows());
-    for (size_t row_index = 0; row_index < row_count; ++row_index) {
-      for (size_t offset = 0; offset < row_numel; ++offset) {
-        size_t i = cpu_rows[row_index] * row_numel + offset;
-        functor.adam_update(i, grad_data[row_index * row_numel + offset]);
+    auto row_count = static_cast<int64_t>(grad_merge.rows().size());
+#ifndef _WIN32
+    // The merged rows are unique, so the threads update disjoint rows.
+    if (FLAGS_inner_op_parallelism > 1 &&
+        min_row_size_to_use_multithread > 0 &&
+        row_count > min_row_size_to_use_multithread) {
+      VLOG(3) << "use multi thread in lazy mode, inner_op_parallelism="
+              << FLAGS_inner_op_parallelism;
+      std::vector<std::future<void>> fs;
+      int64_t rows_in_each_thread =
+          (row_count + FLAGS_inner_op_parallelism - 1) /
+          FLAGS_inner_op_parallelism;
+      for (int64_t start = 0; start < row_count; start += rows_in_each_thread) {
+        int64_t end = std::min(start + rows_in_each_thread, row_count);
+        fs.push_back(phi::Async([&functor, start, end]() {
+          functor.adam_update_rows(start, end);
+        }));
       }
+      for (auto& item : fs) item.wait();
+    } else {
+      functor.adam_update_rows(0, row_count);
     }
+#else
+    functor.adam_update_rows(0, row_count);
+#endif
   }
 #ifndef _WIN32
   else if (FLAGS_inner_op_parallelism > 1 &&  // NOLINT
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include "paddle/common/flags.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_meta.h"
 #include "paddle/phi/core/tensor_utils.h"
@@ -19,6 +20,8 @@ limitations under the License. */
 #include "paddle/phi/kernels/funcs/blas/blas.h"
 #include "paddle/phi/kernels/sparse/cpu/conv.h"
 
+COMMON_DECLARE_bool(sparse_conv_auto_cache_rulebook);
+
 namespace phi {
 namespace sparse {
 
@@ -88,17 +91,36 @@ void Conv3dCooCPUKernel(const CPUContext& dev_ctx,
   const IntT* rulebook_ptr = nullptr;
   int n = 0;
   bool need_product_rulebook = true;
-  if (subm && !key.empty()) {
+  // A subm conv without a key shares its rulebook with the following subm
+  // convs over the same indices by an auto key, and still returns it.
+  const bool auto_key =
+      subm && key.empty() && FLAGS_sparse_conv_auto_cache_rulebook;
+  const std::string table_key =
+      auto_key ? phi::funcs::sparse::GetAutoSubmKey(
+                     kernel_dims, dilations, x.nnz())
+               : key;
+  if (subm && !table_key.empty()) {
     rulebook_ptr = phi::funcs::sparse::PrepareSubm<T, IntT, CPUContext>(
         dev_ctx,
         x,
-        key,
+        table_key,
         out_dims,
         out,
         h_counter_ptr,
         h_offsets_ptr,
         &n,
         &need_product_rulebook);
+    if (auto_key && !need_product_rulebook) {
+      phi::funcs::sparse::SaveToAutoTable(dev_ctx,
+                                          x,
+                                          table_key,
+                                          x.IndicesPairs(table_key)->first,
+                                          h_counter,
+                                          false,
+                                          out,
+                                          rulebook,
+                                          counter);
+    }
   }
   if (need_product_rulebook) {
     DenseTensor tmp_rulebook;
@@ -118,8 +140,25 @@ void Conv3dCooCPUKernel(const CPUContext& dev_ctx,
     n = static_cast<int>(tmp_rulebook.dims()[1]);
     rulebook_ptr = tmp_rulebook.data<IntT>();
 
-    phi::funcs::sparse::SaveToTable(
-        dev_ctx, x, key, tmp_rulebook, h_counter, out, rulebook, counter);
+    if (auto_key) {
+      phi::funcs::sparse::SaveToAutoTable(dev_ctx,
+                                          x,
+                                          table_key,
+                                          tmp_rulebook,
+                                          h_counter,
+                                          true,
+                                          out,
+                                          rulebook,
+                                          counter);
+    } else {
+      phi::funcs::sparse::SaveToTable(
+          dev_ctx, x, key, tmp_rulebook, h_counter, out, rulebook, counter);
+    }
+    if (!subm) {
+      // The auto keys of x are for its indices.
+      out->SetIndicesDict(
+          phi::funcs::sparse::DropAutoSubmKeys(out->GetIndicesDict()));
+    }
   }
 
   // 2. gather
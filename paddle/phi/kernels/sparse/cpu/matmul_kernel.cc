@@ -14,19 +14,90 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/sparse/matmul_kernel.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/common/amp_type_traits.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/phi/core/meta_tensor.h"
+#include "paddle/phi/core/visit_type.h"
 
 namespace phi::sparse {
 
+template <typename T, typename IntT>
+void MatmulBsrDenseCPUKernel(const CPUContext& dev_ctx,
+                             const SparseCsrTensor& x,
+                             const DenseTensor& y,
+                             DenseTensor* out) {
+  using MT = typename phi::dtype::MPTypeTrait<T>::Type;
+  const auto& x_dims = x.dims();
+  const auto& y_dims = y.dims();
+  PADDLE_ENFORCE_EQ(
+      x_dims.size() == 2 && y_dims.size() == 2,
+      true,
+      phi::errors::InvalidArgument(
+          "The blocked SparseCsrTensor only supports 2-D matmul, but received "
+          "X's dimensions=%d, Y's dimensions=%d.",
+          x_dims.size(),
+          y_dims.size()));
+  PADDLE_ENFORCE_EQ(
+      x_dims[1],
+      y_dims[0],
+      phi::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, x_dim[-1] must be equal to y_dim[-2]."));
+
+  const int64_t block_size = x.block_size();
+  const int64_t block_rows = x_dims[0] / block_size;
+  const int64_t n = y_dims[1];
+  MetaTensor meta_out(out);
+  meta_out.set_dims(common::make_ddim({x_dims[0], n}));
+  meta_out.set_dtype(y.dtype());
+  T* out_data = dev_ctx.template Alloc<T>(out);
+
+  const IntT* crows_data = x.crows().data<IntT>();
+  const IntT* cols_data = x.cols().data<IntT>();
+  const T* values_data = x.values().data<T>();
+  const T* y_data = y.data<T>();
+  std::vector<MT> acc(n);
+  for (int64_t i = 0; i < block_rows; ++i) {
+    for (int64_t r = 0; r < block_size; ++r) {
+      std::fill(acc.begin(), acc.end(), static_cast<MT>(0));
+      for (IntT j = crows_data[i]; j < crows_data[i + 1]; ++j) {
+        const T* a = values_data + (j * block_size + r) * block_size;
+        const T* b = y_data + cols_data[j] * block_size * n;
+        for (int64_t k = 0; k < block_size; ++k) {
+          MT a_k = static_cast<MT>(a[k]);
+          for (int64_t c = 0; c < n; ++c) {
+            acc[c] += a_k * static_cast<MT>(b[k * n + c]);
+          }
+        }
+      }
+      T* dst = out_data + (i * block_size + r) * n;
+      for (int64_t c = 0; c < n; ++c) {
+        dst[c] = static_cast<T>(acc[c]);
+      }
+    }
+  }
+}
+
 // TODO(zhouwei25): implement CPU kernel of " CSR @ DENSE -> DENSE"
 template <typename T, typename Context>
-void MatmulCsrDenseKernel(const Context& dev_ctx UNUSED,
-                          const SparseCsrTensor& x UNUSED,
-                          const DenseTensor& y UNUSED,
-                          DenseTensor* out UNUSED) {
+void MatmulCsrDenseKernel(const Context& dev_ctx,
+                          const SparseCsrTensor& x,
+                          const DenseTensor& y,
+                          DenseTensor* out) {
+  if (x.is_blocked()) {
+    PD_VISIT_BASE_INTEGRAL_TYPES(
+        x.crows().dtype(), "MatmulBsrDenseCPUKernel", ([&] {
+          MatmulBsrDenseCPUKernel<T, data_t>(dev_ctx, x, y, out);
+        }));
+    return;
+  }
   PADDLE_THROW(phi::errors::Unimplemented(
-      "Not support CPU kernel of 'sparse.matmul' now."));
+      "Not support CPU kernel of 'sparse.matmul' now, except for the "
+      "SparseCsrTensor stored in blocks."));
 }
 
 // TODO(zhouwei25): implement CPU kernel of " DENSE @ DENSE * CSR_MASK -> CSR"
@@ -47,7 +118,9 @@ PD_REGISTER_KERNEL(matmul_csr_dense,
                    ALL_LAYOUT,
                    phi::sparse::MatmulCsrDenseKernel,
                    float,
-                   double) {
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
   kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_CSR);
 }
 
@@ -313,6 +313,115 @@ void CooToDenseKernel(const Context& dev_ctx,
       }));
 }
 
+template <typename T, typename IntT>
+void CooToBsrCPUKernel(const CPUContext& dev_ctx,
+                       const SparseCooTensor& x,
+                       int block_size,
+                       SparseCsrTensor* out) {
+  const auto& x_dims = x.dims();
+  CheckBsrShape(x_dims, block_size);
+  PADDLE_ENFORCE_EQ(x.dense_dim(),
+                    0,
+                    phi::errors::InvalidArgument(
+                        "The values of SparseCooTensor should be 1-D to be "
+                        "stored in blocks."));
+  const int64_t non_zero_num = x.nnz();
+  const int64_t block_rows = x_dims[0] / block_size;
+  const int64_t block_cols = x_dims[1] / block_size;
+  const int64_t block_numel = static_cast<int64_t>(block_size) * block_size;
+  const IntT* coo_rows_data = x.indices().data<IntT>();
+  const IntT* coo_cols_data = coo_rows_data + non_zero_num;
+  const T* coo_values_data = x.values().data<T>();
+
+  // the position of each non zero block in the blocks of the tensor, -1 for
+  // the zero blocks
+  std::vector<int64_t> block_pos(block_rows * block_cols, -1);
+  for (int64_t i = 0; i < non_zero_num; ++i) {
+    block_pos[coo_rows_data[i] / block_size * block_cols +
+              coo_cols_data[i] / block_size] = 0;
+  }
+  int64_t non_zero_blocks = 0;
+  for (auto& pos : block_pos) {
+    if (pos == 0) {
+      pos = non_zero_blocks++;
+    }
+  }
+
+  phi::DenseTensor crows = phi::Empty<IntT>(dev_ctx, {block_rows + 1});
+  phi::DenseTensor cols = phi::Empty<IntT>(dev_ctx, {non_zero_blocks});
+  phi::DenseTensor values =
+      phi::Empty<T>(dev_ctx, {non_zero_blocks, block_size, block_size});
+  IntT* crows_data = crows.data<IntT>();
+  IntT* cols_data = cols.data<IntT>();
+  T* values_data = values.data<T>();
+  memset(values_data, 0, sizeof(T) * values.numel());
+
+  crows_data[0] = 0;
+  for (int64_t i = 0; i < block_rows; ++i) {
+    IntT num = crows_data[i];
+    for (int64_t j = 0; j < block_cols; ++j) {
+      if (block_pos[i * block_cols + j] >= 0) {
+        cols_data[num++] = static_cast<IntT>(j);
+      }
+    }
+    crows_data[i + 1] = num;
+  }
+  for (int64_t i = 0; i < non_zero_num; ++i) {
+    int64_t pos = block_pos[coo_rows_data[i] / block_size * block_cols +
+                            coo_cols_data[i] / block_size];
+    values_data[pos * block_numel + coo_rows_data[i] % block_size * block_size +
+                coo_cols_data[i] % block_size] = coo_values_data[i];
+  }
+  out->SetMember(crows, cols, values, x_dims);
+}
+
+template <typename T, typename Context>
+void CooToBsrKernel(const Context& dev_ctx,
+                    const SparseCooTensor& x,
+                    int block_size,
+                    SparseCsrTensor* out) {
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      x.indices().dtype(), "CooToBsrCPUKernel", ([&] {
+        CooToBsrCPUKernel<T, data_t>(dev_ctx, x, block_size, out);
+      }));
+}
+
+template <typename T, typename IntT>
+void BsrToDenseCPUKernel(const CPUContext& dev_ctx,
+                         const SparseCsrTensor& x,
+                         DenseTensor* out) {
+  const auto& x_dims = x.dims();
+  const int64_t block_size = x.block_size();
+  const int64_t block_rows = x_dims[0] / block_size;
+  const int64_t cols = x_dims[1];
+  const IntT* crows_data = x.crows().data<IntT>();
+  const IntT* cols_data = x.cols().data<IntT>();
+  const T* values_data = x.values().data<T>();
+
+  dev_ctx.template Alloc<T>(out);
+  T* out_data = out->data<T>();
+  memset(out_data, 0, sizeof(T) * out->numel());
+  for (int64_t i = 0; i < block_rows; ++i) {
+    for (IntT j = crows_data[i]; j < crows_data[i + 1]; ++j) {
+      const T* block = values_data + j * block_size * block_size;
+      T* dst = out_data + i * block_size * cols + cols_data[j] * block_size;
+      for (int64_t r = 0; r < block_size; ++r) {
+        memcpy(dst + r * cols, block + r * block_size, sizeof(T) * block_size);
+      }
+    }
+  }
+}
+
+template <typename T, typename Context>
+void BsrToDenseKernel(const Context& dev_ctx,
+                      const SparseCsrTensor& x,
+                      DenseTensor* out) {
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      x.crows().dtype(), "BsrToDenseCPUKernel", ([&] {
+        BsrToDenseCPUKernel<T, data_t>(dev_ctx, x, out);
+      }));
+}
+
 }  // namespace phi::sparse
 
 PD_REGISTER_KERNEL(dense_to_coo,
@@ -400,6 +509,7 @@ PD_REGISTER_KERNEL(csr_to_dense,
                    float,
                    double,
                    phi::dtype::float16,
+                   phi::dtype::bfloat16,
                    uint8_t,
                    int8_t,
                    int16_t,
@@ -409,6 +519,36 @@ PD_REGISTER_KERNEL(csr_to_dense,
                    phi::dtype::complex<float>,
                    phi::dtype::complex<double>) {}
 
+PD_REGISTER_KERNEL(dense_to_bsr,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::sparse::DenseToBsrKernel,
+                   float,
+                   double,
+                   paddle::float16,
+                   phi::dtype::bfloat16,
+                   uint8_t,
+                   int8_t,
+                   int16_t,
+                   int,
+                   int64_t) {}
+
+PD_REGISTER_KERNEL(coo_to_bsr,
+                   CPU,
+                   ALL_LAYOUT,
+                   phi::sparse::CooToBsrKernel,
+                   float,
+                   double,
+                   paddle::float16,
+                   phi::dtype::bfloat16,
+                   uint8_t,
+                   int8_t,
+                   int16_t,
+                   int,
+                   int64_t) {
+  kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_COO);
+}
+
 PD_REGISTER_KERNEL(values_coo,
                    CPU,
                    ALL_LAYOUT,
@@ -22,6 +22,7 @@ limitations under the License. */
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/visit_type.h"
 #include "paddle/phi/kernels/funcs/index_impl.cu.h"
+#include "paddle/phi/kernels/funcs/sparse/convolution.h"
 #include "paddle/phi/kernels/funcs/sparse/flatten_indices.cu.h"
 #include "paddle/phi/kernels/funcs/sparse/scatter.cu.h"
 #include "paddle/phi/kernels/funcs/sparse/utils.cu.h"
@@ -170,7 +171,9 @@ void CoalesceCooGPUKernel(const GPUContext& dev_ctx,
       indexs_ptr, const_dims, out_nnz, sparse_dim, out_indices.data<IntT>());
 
   out->SetMember(out_indices, out_values, x.dims(), true);
-  out->SetIndicesDict(x.GetIndicesDict());
+  // The auto subm rulebooks of x are for its order of the indices.
+  out->SetIndicesDict(
+      phi::funcs::sparse::DropAutoSubmKeys(x.GetIndicesDict()));
   out->SetKmaps(x.GetKmaps());
 }
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/phi/kernels/sparse/conv_kernel.h"
 
+#include "paddle/common/flags.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_meta.h"
@@ -29,6 +30,8 @@ limitations under the License. */
 
 #include "glog/logging.h"
 
+COMMON_DECLARE_bool(sparse_conv_auto_cache_rulebook);
+
 namespace phi {
 namespace sparse {
 
@@ -135,17 +138,36 @@ void Conv3dCooGPUKernel(const GPUContext& dev_ctx,
   int rulebook_len = 0;
   const IntT* rulebook_ptr = nullptr;
   bool need_product_rulebook = true;
-  if (subm && !key.empty()) {
+  // A subm conv without a key shares its rulebook with the following subm
+  // convs over the same indices by an auto key, and still returns it.
+  const bool auto_key =
+      subm && key.empty() && FLAGS_sparse_conv_auto_cache_rulebook;
+  const std::string table_key =
+      auto_key ? phi::funcs::sparse::GetAutoSubmKey(
+                     kernel_dims, dilations, x.nnz())
+               : key;
+  if (subm && !table_key.empty()) {
     rulebook_ptr = phi::funcs::sparse::PrepareSubm<T, IntT, GPUContext>(
         dev_ctx,
         x,
-        key,
+        table_key,
         out_dims,
         out,
         h_counter.data<int>(),
         h_offsets.data<int>(),
         &rulebook_len,
         &need_product_rulebook);
+    if (auto_key && !need_product_rulebook) {
+      phi::funcs::sparse::SaveToAutoTable(dev_ctx,
+                                          x,
+                                          table_key,
+                                          x.IndicesPairs(table_key)->first,
+                                          h_counter,
+                                          false,
+                                          out,
+                                          rulebook,
+                                          counter);
+    }
   }
 
   if (need_product_rulebook) {
@@ -168,8 +190,25 @@ void Conv3dCooGPUKernel(const GPUContext& dev_ctx,
                                                         h_offsets_ptr);
     rulebook_ptr = tmp_rulebook.data<IntT>();
 
-    phi::funcs::sparse::SaveToTable(
-        dev_ctx, x, key, tmp_rulebook, h_counter, out, rulebook, counter);
+    if (auto_key) {
+      phi::funcs::sparse::SaveToAutoTable(dev_ctx,
+                                          x,
+                                          table_key,
+                                          tmp_rulebook,
+                                          h_counter,
+                                          true,
+                                          out,
+                                          rulebook,
+                                          counter);
+    } else {
+      phi::funcs::sparse::SaveToTable(
+          dev_ctx, x, key, tmp_rulebook, h_counter, out, rulebook, counter);
+    }
+    if (!subm) {
+      // The auto keys of x are for its indices.
+      out->SetIndicesDict(
+          phi::funcs::sparse::DropAutoSubmKeys(out->GetIndicesDict()));
+    }
   }
 
 #if defined(PADDLE_WITH_CUTLASS) && SPCONV_WITH_CUTLASS
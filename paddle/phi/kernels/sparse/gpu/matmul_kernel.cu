@@ -16,14 +16,20 @@ limitations under the License. */
 
 #include <vector>
 
+#ifdef PADDLE_WITH_CUDA
+#include <mma.h>
+#endif
+
 #include "paddle/common/ddim.h"
 #include "paddle/phi/backends/gpu/gpu_context.h"
+#include "paddle/phi/common/amp_type_traits.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/meta_tensor.h"
 #include "paddle/phi/core/sparse_coo_tensor.h"
 #include "paddle/phi/core/sparse_csr_tensor.h"
 #include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/core/visit_type.h"
 #include "paddle/phi/kernels/empty_kernel.h"
 #include "paddle/phi/kernels/funcs/math_function_impl.h"
 #include "paddle/phi/kernels/funcs/sparse/sparse_blas.h"
@@ -104,6 +110,218 @@ void MatmulKernelImpl(const Context& dev_ctx,
 #endif
 }
 
+// Each thread computes one column of a block row of the output, the rows of
+// the block row are strided over threadIdx.y.
+template <typename T, typename IntT>
+__global__ void BsrMatmulDenseKernel(const IntT* crows,
+                                     const IntT* cols,
+                                     const T* values,
+                                     const T* y,
+                                     const int64_t block_rows,
+                                     const int64_t n,
+                                     const int block_size,
+                                     T* out) {
+  using MT = typename phi::dtype::MPTypeTrait<T>::Type;
+  const int64_t block_row = blockIdx.x;
+  const int64_t col = blockIdx.y * blockDim.x + threadIdx.x;
+  if (block_row >= block_rows || col >= n) {
+    return;
+  }
+  const int64_t block_numel = static_cast<int64_t>(block_size) * block_size;
+  for (int r = threadIdx.y; r < block_size; r += blockDim.y) {
+    MT sum = static_cast<MT>(0);
+    for (IntT j = crows[block_row]; j < crows[block_row + 1]; ++j) {
+      const T* a = values + j * block_numel + r * block_size;
+      const T* b = y + static_cast<int64_t>(cols[j]) * block_size * n + col;
+      for (int k = 0; k < block_size; ++k) {
+        sum += static_cast<MT>(a[k]) * static_cast<MT>(b[k * n]);
+      }
+    }
+    out[(block_row * block_size + r) * n + col] = static_cast<T>(sum);
+  }
+}
+
+#ifdef PADDLE_WITH_CUDA
+// the number of the warps of a thread block of BsrMatmulDenseWmmaKernel, each
+// of which computes a 16x16 tile of the output
+constexpr int kBsrWmmaWarps = 4;
+constexpr int kWmmaSize = 16;
+
+template <typename WT, typename T, typename IntT>
+__device__ void BsrMatmulDenseWmmaTile(const IntT* crows,
+                                       const IntT* cols,
+                                       const T* values,
+                                       const T* y,
+                                       const int64_t n,
+                                       const int block_size,
+                                       float* tile,
+                                       T* out) {
+  namespace wmma = nvcuda::wmma;
+  const int warp = threadIdx.x / 32;
+  const int lane = threadIdx.x % 32;
+  const int64_t row0 = static_cast<int64_t>(blockIdx.x) * kWmmaSize;
+  const int64_t col0 =
+      (static_cast<int64_t>(blockIdx.y) * kBsrWmmaWarps + warp) * kWmmaSize;
+  if (col0 >= n) {
+    return;
+  }
+  const int64_t block_row = row0 / block_size;
+  const int64_t row_in_block = row0 % block_size;
+  const int64_t block_numel = static_cast<int64_t>(block_size) * block_size;
+
+  wmma::fragment<wmma::matrix_a,
+                 kWmmaSize,
+                 kWmmaSize,
+                 kWmmaSize,
+                 WT,
+                 wmma::row_major>
+      a_frag;
+  wmma::fragment<wmma::matrix_b,
+                 kWmmaSize,
+                 kWmmaSize,
+                 kWmmaSize,
+                 WT,
+                 wmma::row_major>
+      b_frag;
+  wmma::fragment<wmma::accumulator, kWmmaSize, kWmmaSize, kWmmaSize, float>
+      acc_frag;
+  wmma::fill_fragment(acc_frag, 0.0f);
+  for (IntT j = crows[block_row]; j < crows[block_row + 1]; ++j) {
+    const WT* a = reinterpret_cast<const WT*>(values + j * block_numel +
+                                              row_in_block * block_size);
+    const WT* b = reinterpret_cast<const WT*>(
+        y + static_cast<int64_t>(cols[j]) * block_size * n + col0);
+    for (int k = 0; k < block_size; k += kWmmaSize) {
+      wmma::load_matrix_sync(a_frag, a + k, block_size);
+      wmma::load_matrix_sync(b_frag, b + k * n, n);
+      wmma::mma_sync(acc_frag, a_frag, b_frag, acc_frag);
+    }
+  }
+  float* warp_tile = tile + warp * kWmmaSize * kWmmaSize;
+  wmma::store_matrix_sync(warp_tile, acc_frag, kWmmaSize, wmma::mem_row_major);
+  __syncwarp();
+  for (int i = lane; i < kWmmaSize * kWmmaSize; i += 32) {
+    out[(row0 + i / kWmmaSize) * n + col0 + i % kWmmaSize] =
+        static_cast<T>(warp_tile[i]);
+  }
+}
+
+// Multiplies the blocks with the tensor cores, the block size and n should
+// be multiples of 16.
+template <typename T, typename IntT>
+__global__ void BsrMatmulDenseWmmaKernel(const IntT* crows,
+                                         const IntT* cols,
+                                         const T* values,
+                                         const T* y,
+                                         const int64_t n,
+                                         const int block_size,
+                                         T* out) {
+  __shared__ float tile[kBsrWmmaWarps * kWmmaSize * kWmmaSize];
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 700
+  if constexpr (std::is_same<T, phi::dtype::float16>::value) {
+    BsrMatmulDenseWmmaTile<__half>(
+        crows, cols, values, y, n, block_size, tile, out);
+  }
+#endif
+#if defined(__CUDA_ARCH__) && __CUDA_ARCH__ >= 800
+  if constexpr (std::is_same<T, phi::dtype::bfloat16>::value) {
+    BsrMatmulDenseWmmaTile<__nv_bfloat16>(
+        crows, cols, values, y, n, block_size, tile, out);
+  }
+#endif
+}
+
+template <typename T>
+bool CanUseBsrWmma(const GPUContext& dev_ctx,
+                   const SparseCsrTensor& x,
+                   const DenseTensor& y,
+                   int64_t n) {
+  int min_capability = 0;
+  if (std::is_same<T, phi::dtype::float16>::value) {
+    min_capability = 70;
+  } else if (std::is_same<T, phi::dtype::bfloat16>::value) {
+    min_capability = 80;
+  } else {
+    return false;
+  }
+  // wmma::load_matrix_sync needs the pointers aligned to 256 bits
+  auto aligned = [](const void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % 32 == 0;
+  };
+  return dev_ctx.GetComputeCapability() >= min_capability &&
+         x.block_size() % kWmmaSize == 0 && n % kWmmaSize == 0 &&
+         aligned(x.values().data()) && aligned(y.data());
+}
+#endif
+
+template <typename T, typename IntT>
+void MatmulBsrDenseGPUKernel(const GPUContext& dev_ctx,
+                             const SparseCsrTensor& x,
+                             const DenseTensor& y,
+                             DenseTensor* out) {
+  const auto& x_dims = x.dims();
+  const auto& y_dims = y.dims();
+  PADDLE_ENFORCE_EQ(
+      x_dims.size() == 2 && y_dims.size() == 2,
+      true,
+      phi::errors::InvalidArgument(
+          "The blocked SparseCsrTensor only supports 2-D matmul, but received "
+          "X's dimensions=%d, Y's dimensions=%d.",
+          x_dims.size(),
+          y_dims.size()));
+  PADDLE_ENFORCE_EQ(
+      x_dims[1],
+      y_dims[0],
+      phi::errors::PreconditionNotMet(
+          "The shape of Input(x) and Input(y) is not suitable for matmul "
+          "opetation, x_dim[-1] must be equal to y_dim[-2]."));
+
+  const int block_size = static_cast<int>(x.block_size());
+  const int64_t block_rows = x_dims[0] / block_size;
+  const int64_t n = y_dims[1];
+  MetaTensor meta_out(out);
+  meta_out.set_dims(common::make_ddim({x_dims[0], n}));
+  meta_out.set_dtype(y.dtype());
+  T* out_data = dev_ctx.template Alloc<T>(out);
+  if (block_rows == 0 || n == 0) {
+    return;
+  }
+
+  const IntT* crows_data = x.crows().data<IntT>();
+  const IntT* cols_data = x.cols().data<IntT>();
+  const T* values_data = x.values().data<T>();
+  const T* y_data = y.data<T>();
+#ifdef PADDLE_WITH_CUDA
+  if (CanUseBsrWmma<T>(dev_ctx, x, y, n)) {
+    const int64_t col_tiles = n / kWmmaSize;
+    dim3 grid(x_dims[0] / kWmmaSize,
+              (col_tiles + kBsrWmmaWarps - 1) / kBsrWmmaWarps);
+    BsrMatmulDenseWmmaKernel<T, IntT>
+        <<<grid, kBsrWmmaWarps * 32, 0, dev_ctx.stream()>>>(crows_data,
+                                                             cols_data,
+                                                             values_data,
+                                                             y_data,
+                                                             n,
+                                                             block_size,
+                                                             out_data);
+    return;
+  }
+#endif
+  const int threads_x = 32;
+  const int threads_y = std::min(block_size, 8);
+  dim3 grid(block_rows, (n + threads_x - 1) / threads_x);
+  dim3 block(threads_x, threads_y);
+  BsrMatmulDenseKernel<T, IntT><<<grid, block, 0, dev_ctx.stream()>>>(
+      crows_data,
+      cols_data,
+      values_data,
+      y_data,
+      block_rows,
+      n,
+      block_size,
+      out_data);
+}
+
 template <typename T, typename Context>
 void MatmulCooDenseKernel(const Context& dev_ctx,
                           const SparseCooTensor& x,
@@ -117,7 +335,20 @@ void MatmulCsrDenseKernel(const Context& dev_ctx,
                           const SparseCsrTensor& x,
                           const DenseTensor& y,
                           DenseTensor* out) {
-  MatmulKernelImpl<T>(dev_ctx, x, y, out);
+  if (x.is_blocked()) {
+    PD_VISIT_BASE_INTEGRAL_TYPES(
+        x.crows().dtype(), "MatmulBsrDenseGPUKernel", ([&] {
+          MatmulBsrDenseGPUKernel<T, data_t>(dev_ctx, x, y, out);
+        }));
+    return;
+  }
+  if constexpr (std::is_same<T, phi::dtype::bfloat16>::value) {
+    PADDLE_THROW(phi::errors::Unimplemented(
+        "'sparse.matmul' of bfloat16 only supports the SparseCsrTensor "
+        "stored in blocks."));
+  } else {
+    MatmulKernelImpl<T>(dev_ctx, x, y, out);
+  }
 }
 
 template <typename T, typename Context>
@@ -277,7 +508,9 @@ PD_REGISTER_KERNEL(matmul_csr_dense,
                    ALL_LAYOUT,
                    phi::sparse::MatmulCsrDenseKernel,
                    float,
-                   double) {
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16) {
   kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_CSR);
 }
 
@@ -16,12 +16,14 @@ limitations under the License. */
 
 #include <thrust/execution_policy.h>
 #include <thrust/remove.h>
+#include <thrust/scan.h>
 
 #ifdef PADDLE_WITH_HIP
 #include "paddle/phi/backends/dynload/rocsparse.h"
 #endif
 #include "paddle/phi/backends/gpu/gpu_context.h"
 #include "paddle/phi/backends/gpu/gpu_launch_config.h"
+#include "paddle/phi/backends/gpu/gpu_primitives.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/core/tensor_meta.h"
@@ -575,6 +577,216 @@ void CooToDenseKernel(const Context& dev_ctx,
       }));
 }
 
+template <typename IntT>
+__global__ void MarkNonZeroBlocks(const IntT* rows,
+                                  const IntT* cols,
+                                  const int64_t non_zero_num,
+                                  const int block_size,
+                                  const int64_t block_cols,
+                                  IntT* block_mask) {
+  CUDA_KERNEL_LOOP_TYPE(i, non_zero_num, int64_t) {
+    block_mask[rows[i] / block_size * block_cols + cols[i] / block_size] = 1;
+  }
+}
+
+// block_pos is the exclusive prefix sum of the block mask, of which the
+// non zero blocks are the ones whose positions differ from the next one
+template <typename IntT>
+__global__ void GetBlockCrowsAndCols(const IntT* block_pos,
+                                     const int64_t block_rows,
+                                     const int64_t block_cols,
+                                     IntT* crows,
+                                     IntT* cols) {
+  CUDA_KERNEL_LOOP_TYPE(i, block_rows * block_cols, int64_t) {
+    if (i % block_cols == 0) {
+      crows[i / block_cols] = block_pos[i];
+    }
+    if (block_pos[i + 1] != block_pos[i]) {
+      cols[block_pos[i]] = static_cast<IntT>(i % block_cols);
+    }
+  }
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    crows[block_rows] = block_pos[block_rows * block_cols];
+  }
+}
+
+template <typename T, typename IntT>
+__global__ void ScatterBlockValues(const IntT* rows,
+                                   const IntT* cols,
+                                   const T* values,
+                                   const IntT* block_pos,
+                                   const int64_t non_zero_num,
+                                   const int block_size,
+                                   const int64_t block_cols,
+                                   T* block_values) {
+  CUDA_KERNEL_LOOP_TYPE(i, non_zero_num, int64_t) {
+    int64_t pos =
+        block_pos[rows[i] / block_size * block_cols + cols[i] / block_size];
+    block_values[(pos * block_size + rows[i] % block_size) * block_size +
+                 cols[i] % block_size] = values[i];
+  }
+}
+
+template <typename T, typename IntT>
+void CooToBsrGPUKernel(const GPUContext& dev_ctx,
+                       const SparseCooTensor& x,
+                       int block_size,
+                       SparseCsrTensor* out) {
+  const auto& x_dims = x.dims();
+  CheckBsrShape(x_dims, block_size);
+  PADDLE_ENFORCE_EQ(x.dense_dim(),
+                    0,
+                    phi::errors::InvalidArgument(
+                        "The values of SparseCooTensor should be 1-D to be "
+                        "stored in blocks."));
+  const int64_t non_zero_num = x.nnz();
+  const int64_t block_rows = x_dims[0] / block_size;
+  const int64_t block_cols = x_dims[1] / block_size;
+  const int64_t num_blocks = block_rows * block_cols;
+  const IntT* coo_rows_data = x.indices().data<IntT>();
+  const IntT* coo_cols_data = coo_rows_data + non_zero_num;
+
+  // 1. mark the non zero blocks and get their positions by the prefix sum
+  DenseTensor block_pos = phi::Empty<IntT>(dev_ctx, {num_blocks + 1});
+  IntT* block_pos_data = block_pos.data<IntT>();
+  phi::backends::gpu::GpuMemsetAsync(
+      block_pos_data, 0, sizeof(IntT) * (num_blocks + 1), dev_ctx.stream());
+  if (non_zero_num > 0) {
+    auto config =
+        phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, non_zero_num, 1);
+    MarkNonZeroBlocks<IntT><<<config.block_per_grid.x,
+                              config.thread_per_block.x,
+                              0,
+                              dev_ctx.stream()>>>(coo_rows_data,
+                                                  coo_cols_data,
+                                                  non_zero_num,
+                                                  block_size,
+                                                  block_cols,
+                                                  block_pos_data);
+  }
+#ifdef PADDLE_WITH_HIP
+  thrust::exclusive_scan(thrust::hip::par.on(dev_ctx.stream()),
+#else
+  thrust::exclusive_scan(thrust::cuda::par.on(dev_ctx.stream()),
+#endif
+                         block_pos_data,
+                         block_pos_data + num_blocks + 1,
+                         block_pos_data);
+
+  // 2. copy the number of the non zero blocks to host
+  IntT non_zero_blocks = 0;
+  phi::backends::gpu::GpuMemcpyAsync(&non_zero_blocks,
+                                     block_pos_data + num_blocks,
+                                     sizeof(IntT),
+                                     gpuMemcpyDeviceToHost,
+                                     dev_ctx.stream());
+  dev_ctx.Wait();  // wait the copy
+
+  // 3. fill the blocks
+  DenseTensor crows = phi::Empty<IntT>(dev_ctx, {block_rows + 1});
+  DenseTensor cols =
+      phi::Empty<IntT>(dev_ctx, {static_cast<int64_t>(non_zero_blocks)});
+  DenseTensor values = phi::Empty<T>(
+      dev_ctx,
+      {static_cast<int64_t>(non_zero_blocks), block_size, block_size});
+  phi::backends::gpu::GpuMemsetAsync(values.data<T>(),
+                                     0,
+                                     sizeof(T) * values.numel(),
+                                     dev_ctx.stream());
+  auto config = phi::backends::gpu::GetGpuLaunchConfig1D(
+      dev_ctx, std::max<int64_t>(num_blocks, 1), 1);
+  GetBlockCrowsAndCols<IntT><<<config.block_per_grid.x,
+                               config.thread_per_block.x,
+                               0,
+                               dev_ctx.stream()>>>(block_pos_data,
+                                                   block_rows,
+                                                   block_cols,
+                                                   crows.data<IntT>(),
+                                                   cols.data<IntT>());
+  if (non_zero_num > 0) {
+    config = phi::backends::gpu::GetGpuLaunchConfig1D(dev_ctx, non_zero_num, 1);
+    ScatterBlockValues<T, IntT><<<config.block_per_grid.x,
+                                  config.thread_per_block.x,
+                                  0,
+                                  dev_ctx.stream()>>>(coo_rows_data,
+                                                      coo_cols_data,
+                                                      x.values().data<T>(),
+                                                      block_pos_data,
+                                                      non_zero_num,
+                                                      block_size,
+                                                      block_cols,
+                                                      values.data<T>());
+  }
+  out->SetMember(crows, cols, values, x_dims);
+}
+
+template <typename T, typename Context>
+void CooToBsrKernel(const Context& dev_ctx,
+                    const SparseCooTensor& x,
+                    int block_size,
+                    SparseCsrTensor* out) {
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      x.indices().dtype(), "CooToBsrGPUKernel", ([&] {
+        CooToBsrGPUKernel<T, data_t>(dev_ctx, x, block_size, out);
+      }));
+}
+
+// each thread block copies the blocks of one block row
+template <typename T, typename IntT>
+__global__ void KernelBsrToDense(const IntT* crows,
+                                 const IntT* cols,
+                                 const T* values,
+                                 const int64_t block_size,
+                                 const int64_t dense_cols,
+                                 T* dense_data) {
+  const int64_t block_row = blockIdx.x;
+  const int64_t block_numel = block_size * block_size;
+  for (IntT j = crows[block_row]; j < crows[block_row + 1]; ++j) {
+    const T* block = values + j * block_numel;
+    T* dst = dense_data + block_row * block_size * dense_cols +
+             cols[j] * block_size;
+    for (int64_t i = threadIdx.x; i < block_numel; i += blockDim.x) {
+      dst[i / block_size * dense_cols + i % block_size] = block[i];
+    }
+  }
+}
+
+template <typename T, typename IntT>
+void BsrToDenseGPUKernel(const GPUContext& dev_ctx,
+                         const SparseCsrTensor& x,
+                         DenseTensor* out) {
+  const auto& x_dims = x.dims();
+  const int64_t block_size = x.block_size();
+  const int64_t block_rows = x_dims[0] / block_size;
+
+  dev_ctx.template Alloc<T>(out);
+  T* out_data = out->data<T>();
+  phi::backends::gpu::GpuMemsetAsync(
+      out_data, 0, sizeof(T) * out->numel(), dev_ctx.stream());
+  if (block_rows == 0) {
+    return;
+  }
+  int threads = static_cast<int>(
+      std::min<int64_t>(block_size * block_size, PADDLE_CUDA_NUM_THREADS));
+  KernelBsrToDense<T, IntT>
+      <<<block_rows, threads, 0, dev_ctx.stream()>>>(x.crows().data<IntT>(),
+                                                     x.cols().data<IntT>(),
+                                                     x.values().data<T>(),
+                                                     block_size,
+                                                     x_dims[1],
+                                                     out_data);
+}
+
+template <typename T, typename Context>
+void BsrToDenseKernel(const Context& dev_ctx,
+                      const SparseCsrTensor& x,
+                      DenseTensor* out) {
+  PD_VISIT_BASE_INTEGRAL_TYPES(
+      x.crows().dtype(), "BsrToDenseGPUKernel", ([&] {
+        BsrToDenseGPUKernel<T, data_t>(dev_ctx, x, out);
+      }));
+}
+
 }  // namespace sparse
 }  // namespace phi
 
@@ -663,6 +875,7 @@ PD_REGISTER_KERNEL(csr_to_dense,
                    float,
                    double,
                    phi::dtype::float16,
+                   phi::dtype::bfloat16,
                    uint8_t,
                    int8_t,
                    int16_t,
@@ -672,6 +885,36 @@ PD_REGISTER_KERNEL(csr_to_dense,
                    phi::dtype::complex<float>,
                    phi::dtype::complex<double>) {}
 
+PD_REGISTER_KERNEL(dense_to_bsr,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::sparse::DenseToBsrKernel,
+                   float,
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16,
+                   uint8_t,
+                   int8_t,
+                   int16_t,
+                   int,
+                   int64_t) {}
+
+PD_REGISTER_KERNEL(coo_to_bsr,
+                   GPU,
+                   ALL_LAYOUT,
+                   phi::sparse::CooToBsrKernel,
+                   float,
+                   double,
+                   phi::dtype::float16,
+                   phi::dtype::bfloat16,
+                   uint8_t,
+                   int8_t,
+                   int16_t,
+                   int,
+                   int64_t) {
+  kernel->InputAt(0).SetDataLayout(phi::DataLayout::SPARSE_COO);
+}
+
 PD_REGISTER_KERNEL(values_coo,
                    GPU,
                    ALL_LAYOUT,
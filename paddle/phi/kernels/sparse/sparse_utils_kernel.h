@@ -109,6 +109,58 @@ SparseCsrTensor DenseToCsr(const Context& dev_ctx, const DenseTensor& x) {
   return csr;
 }
 
+inline void CheckBsrShape(const DDim& dims, int block_size) {
+  PADDLE_ENFORCE_EQ(dims.size(),
+                    2,
+                    phi::errors::InvalidArgument(
+                        "SparseCsrTensor only support blocks of 2-D Tensor, "
+                        "but get %d-D Tensor.",
+                        dims.size()));
+  PADDLE_ENFORCE_GT(block_size,
+                    0,
+                    phi::errors::InvalidArgument(
+                        "The block size should be positive, but get %d.",
+                        block_size));
+  PADDLE_ENFORCE_EQ(
+      dims[0] % block_size == 0 && dims[1] % block_size == 0,
+      true,
+      phi::errors::InvalidArgument(
+          "The shape [%d, %d] should be divisible by the block size %d.",
+          dims[0],
+          dims[1],
+          block_size));
+}
+
+/* 2-D COO -> BSR, whose blocks are of block_size x block_size elements */
+template <typename T, typename Context>
+void CooToBsrKernel(const Context& dev_ctx,
+                    const SparseCooTensor& x,
+                    int block_size,
+                    SparseCsrTensor* out);
+
+template <typename T, typename Context>
+void DenseToBsrKernel(const Context& dev_ctx,
+                      const DenseTensor& x,
+                      int block_size,
+                      SparseCsrTensor* out) {
+  PADDLE_ENFORCE_EQ(x.dims().size(),
+                    2,
+                    phi::errors::InvalidArgument(
+                        "SparseCsrTensor only support blocks of 2-D Tensor."));
+  DenseTensor indices;
+  DenseTensor values;
+  SparseCooTensor coo(indices, values, x.dims());
+  MetaTensor meta_out(&coo);
+  phi::UnchangedInferMeta(x, &meta_out);
+  DenseToCooKernel<T, Context>(dev_ctx, x, 2, &coo);
+  CooToBsrKernel<T, Context>(dev_ctx, coo, block_size, out);
+}
+
+template <typename T, typename Context>
+void BsrToDenseKernel(const Context& dev_ctx,
+                      const SparseCsrTensor& x,
+                      DenseTensor* out);
+
 template <typename T, typename Context>
 void CooToDenseKernel(const Context& dev_ctx,
                       const SparseCooTensor& x,
@@ -126,6 +178,10 @@ template <typename T, typename Context>
 void CsrToDenseKernel(const Context& dev_ctx,
                       const SparseCsrTensor& x,
                       DenseTensor* out) {
+  if (x.is_blocked()) {
+    BsrToDenseKernel<T, Context>(dev_ctx, x, out);
+    return;
+  }
   DenseTensor indices;
   DenseTensor values;
   SparseCooTensor coo(indices, values, x.dims());
@@ -20,6 +20,7 @@
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/slice_utils.h"
+#include "paddle/utils/small_vector.h"
 
 COMMON_DECLARE_bool(use_stride_kernel);
 
@@ -53,9 +54,13 @@ void SliceStridedKernel(const Context& ctx,
   phi::funcs::CheckAndUpdateSliceAttrs<int64_t>(
       in_dims, new_axes, &starts, &ends, nullptr, nullptr);
 
-  std::vector<int64_t> output_dims = common::vectorize<int64_t>(input.dims());
-  std::vector<int64_t> output_stride =
-      common::vectorize<int64_t>(input.strides());
+  // The dims and strides are built in the inline storage of small_vector,
+  // so creating the view does not allocate.
+  const auto& in_stride = input.strides();
+  paddle::small_vector<int64_t, DDim::kMaxRank> output_dims(
+      in_dims.Get(), in_dims.Get() + in_dims.size());
+  paddle::small_vector<int64_t, DDim::kMaxRank> output_stride(
+      in_stride.Get(), in_stride.Get() + in_stride.size());
   int64_t output_offset = static_cast<int64_t>(input.offset());
 
   for (size_t i = 0; i < new_axes.size(); ++i) {
@@ -65,41 +70,31 @@ void SliceStridedKernel(const Context& ctx,
     output_dims[new_axes[i]] = ends[i] - starts[i];
   }
 
-  std::vector<uint8_t> decrease_flag(output_dims.size(), 0);
   if (!decrease_axis.empty()) {
+    paddle::small_vector<bool, DDim::kMaxRank> decrease_flag(
+        output_dims.size(), false);
     for (auto axis : decrease_axis) {
-      decrease_flag[axis] = 1;
+      decrease_flag[axis] = true;
     }
 
-    std::vector<int64_t> new_shape;
-    std::vector<int64_t> new_stride;
+    // Drops the decreased axes in place.
+    size_t rank = 0;
     for (size_t i = 0; i < output_dims.size(); ++i) {
-      if (decrease_flag[i] == 0) {
-        new_shape.push_back(output_dims[i]);
-        new_stride.push_back(output_stride[i]);
+      if (!decrease_flag[i]) {
+        output_dims[rank] = output_dims[i];
+        output_stride[rank] = output_stride[i];
+        ++rank;
       }
     }
-    output_dims = new_shape;
-    output_stride = new_stride;
+    output_dims.resize(rank);
+    output_stride.resize(rank);
   }
 
-  auto meta = out->meta();
-  meta.offset = output_offset;
-  auto tmp_dim = DDim(output_dims.data(), static_cast<int>(output_dims.size()));
-  // if (product(meta.dims) > 0 && meta.dims != tmp_dim) {
-  //   PADDLE_THROW(
-  //       phi::errors::Fatal("Slice kernel stride compute diff, infer shape is
-  //       "
-  //                          "%s, but compute is %s.",
-  //                          meta.dims,
-  //                          tmp_dim));
-  // }
-  meta.dims = tmp_dim;
-  meta.strides =
-      DDim(output_stride.data(), static_cast<int>(output_stride.size()));
-  out->set_meta(meta);
-  out->ResetHolder(input.Holder());
-  out->ShareInplaceVersionCounterWith(input);
+  out->ShareStridedViewWith(
+      input,
+      DDim(output_dims.data(), static_cast<int>(output_dims.size())),
+      DDim(output_stride.data(), static_cast<int>(output_stride.size())),
+      output_offset);
 }
 
 }  // namespace phi
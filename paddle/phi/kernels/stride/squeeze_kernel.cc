@@ -13,12 +13,11 @@
 // limitations under the License.
 #include "paddle/phi/kernels/squeeze_kernel.h"
 
-#include <set>
-
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/core/kernel_registry.h"
+#include "paddle/utils/small_vector.h"
 
 COMMON_DECLARE_bool(use_stride_kernel);
 
@@ -34,17 +33,21 @@ void SqueezeInferStridedKernel(const Context& dev_ctx,
         phi::errors::Fatal("FLAGS_use_stride_kernel is closed. Strided kernel "
                            "be called, something wrong has happened!"));
   }
-  std::vector<int64_t> axes = axes_arr.GetData();
-  std::vector<int64_t> output_dims;
-  std::vector<int64_t> output_stride;
-
-  std::set<int64_t> axes_set;
-
-  auto input_dims = input.dims();
-  auto input_stride = input.strides();
+  // The dims and strides are built in the inline storage of small_vector,
+  // so creating the view does not allocate.
+  paddle::small_vector<int64_t, DDim::kMaxRank> axes(
+      axes_arr.GetData().begin(), axes_arr.GetData().end());
+  paddle::small_vector<int64_t, DDim::kMaxRank> output_dims;
+  paddle::small_vector<int64_t, DDim::kMaxRank> output_stride;
+
+  const auto& input_dims = input.dims();
+  const auto& input_stride = input.strides();
+  paddle::small_vector<bool, DDim::kMaxRank> squeezed(input_dims.size(),
+                                                      false);
 
   if (input.Holder() == out->Holder() && input.meta() == out->meta()) {
-    output_dims = common::vectorize<int64_t>(out->dims());
+    const auto& out_dims = out->dims();
+    output_dims.append(out_dims.Get(), out_dims.Get() + out_dims.size());
     if (axes.empty()) {
       for (int i = input_stride.size() - 1; i > 0; --i) {
         if (input_stride[i] != input_stride[i - 1]) {
@@ -59,11 +62,11 @@ void SqueezeInferStridedKernel(const Context& dev_ctx,
         item = item < 0 ? item + input_stride.size() : item;
         if (item != 0 && input_stride[static_cast<int>(item)] ==
                              input_stride[static_cast<int>(item) - 1]) {
-          axes_set.insert(item);
+          squeezed[item] = true;
         }
       }
       for (int i = 0; i < input_stride.size(); i++) {
-        if (axes_set.count(i) == 0) {
+        if (!squeezed[i]) {
           output_stride.push_back(input_stride[i]);
         }
       }
@@ -91,35 +94,23 @@ void SqueezeInferStridedKernel(const Context& dev_ctx,
     for (auto item : axes) {
       auto axis = item < 0 ? item + input_dims.size() : item;
       if (input_dims[static_cast<int>(axis)] == 1) {
-        axes_set.insert(axis);
+        squeezed[axis] = true;
       }
     }
 
     for (int i = 0; i < input_dims.size(); i++) {
-      if (axes_set.count(i) == 0) {
+      if (!squeezed[i]) {
         output_dims.push_back(input_dims[i]);
         output_stride.push_back(input_stride[i]);
       }
     }
   }
 
-  auto meta = out->meta();
-  auto tmp_dim = DDim(output_dims.data(), static_cast<int>(output_dims.size()));
-  // if (product(meta.dims) > 0 && meta.dims != tmp_dim) {
-  //   PADDLE_THROW(
-  //       phi::errors::Fatal("Unsqueeze kernel stride compute diff, infer
-  //       shape"
-  //                          "is %s, but compute is %s.",
-  //                          meta.dims,
-  //                          tmp_dim));
-  // }
-  meta.dims = tmp_dim;
-  meta.strides =
-      DDim(output_stride.data(), static_cast<int>(output_stride.size()));
-  meta.offset = input.offset();
-  out->set_meta(meta);
-  out->ResetHolder(input.Holder());
-  out->ShareInplaceVersionCounterWith(input);
+  out->ShareStridedViewWith(
+      input,
+      DDim(output_dims.data(), static_cast<int>(output_dims.size())),
+      DDim(output_stride.data(), static_cast<int>(output_stride.size())),
+      input.offset());
 }
 
 template <typename Context>
@@ -31,25 +31,16 @@ void TransposeStridedKernel(const Context& ctx,
         phi::errors::Fatal("FLAGS_use_stride_kernel is closed. Strided kernel "
                            "be called, something wrong has happened!"));
   }
-  size_t x_rank = x.dims().size();
-  std::vector<int> formatted_axis = axis;
-  for (size_t i = 0; i < axis.size(); i++) {
-    if (axis[i] < 0) {
-      formatted_axis[i] = static_cast<int>(axis[i] + x_rank);
-    }
+  int x_rank = x.dims().size();
+  const auto& in_stride = x.strides();
+  // The strides are permuted in a DDim, which keeps them inline.
+  DDim out_stride = in_stride;
+  for (int i = 0; i < static_cast<int>(axis.size()); i++) {
+    int formatted_axis = axis[i] < 0 ? axis[i] + x_rank : axis[i];
+    out_stride[i] = in_stride[formatted_axis];
   }
 
-  auto meta = out->meta();
-  auto in_stride = x.strides();
-  meta.strides = in_stride;
-  for (int i = 0; i < static_cast<int>(formatted_axis.size()); i++) {
-    meta.strides[i] = in_stride[formatted_axis[i]];
-  }
-  meta.offset = x.offset();
-
-  out->set_meta(meta);
-  out->ResetHolder(x.Holder());
-  out->ShareInplaceVersionCounterWith(x);
+  out->ShareStridedViewWith(x, out->dims(), out_stride, x.offset());
 }
 
 }  // namespace phi
@@ -20,6 +20,7 @@
 #include "paddle/phi/backends/all_context.h"
 #include "paddle/phi/core/kernel_registry.h"
 #include "paddle/phi/kernels/funcs/unsqueeze.h"
+#include "paddle/utils/small_vector.h"
 
 COMMON_DECLARE_bool(use_stride_kernel);
 
@@ -35,13 +36,20 @@ void UnsqueezeInferStridedKernel(const Context& dev_ctx,
         phi::errors::Fatal("FLAGS_use_stride_kernel is closed. Strided kernel "
                            "be called, something wrong has happened!"));
   }
-  std::vector<int64_t> axes = axes_arr.GetData();
-  std::vector<int64_t> input_dims = common::vectorize<int64_t>(input.dims());
-  std::vector<int64_t> input_stride =
-      common::vectorize<int64_t>(input.strides());
+  // The dims and strides are built in the inline storage of small_vector,
+  // so creating the view does not allocate.
+  paddle::small_vector<int64_t, DDim::kMaxRank> axes(
+      axes_arr.GetData().begin(), axes_arr.GetData().end());
+  const auto& in_dims = input.dims();
+  const auto& in_stride = input.strides();
+  paddle::small_vector<int64_t, DDim::kMaxRank> input_dims(
+      in_dims.Get(), in_dims.Get() + in_dims.size());
+  paddle::small_vector<int64_t, DDim::kMaxRank> input_stride(
+      in_stride.Get(), in_stride.Get() + in_stride.size());
 
   if (input.Holder() == out->Holder() && input.meta() == out->meta()) {
-    input_dims = common::vectorize<int64_t>(out->dims());
+    const auto& out_dims = out->dims();
+    input_dims.assign(out_dims.Get(), out_dims.Get() + out_dims.size());
     for (int64_t i = static_cast<int64_t>(axes.size() - 1); i >= 0; --i) {
       axes[i] = static_cast<int64_t>(axes[i] < 0 ? axes[i] + input_dims.size()
                                                  : axes[i]);
@@ -50,8 +58,8 @@ void UnsqueezeInferStridedKernel(const Context& dev_ctx,
     }
   }
 
-  std::vector<int64_t> output_dims = input_dims;
-  std::vector<int64_t> output_stride = input_stride;
+  auto& output_dims = input_dims;
+  auto& output_stride = input_stride;
 
   for (int64_t item : axes) {
     item =
@@ -64,23 +72,11 @@ void UnsqueezeInferStridedKernel(const Context& dev_ctx,
     output_stride.insert(output_stride.begin() + item, stride);
   }
 
-  auto meta = out->meta();
-  auto tmp_dim = DDim(output_dims.data(), static_cast<int>(output_dims.size()));
-  // if (product(meta.dims) > 0 && meta.dims != tmp_dim) {
-  //   PADDLE_THROW(
-  //       phi::errors::Fatal("Unsqueeze kernel stride compute diff, infer
-  //       shape"
-  //                          "is %s, but compute is %s.",
-  //                          meta.dims,
-  //                          tmp_dim));
-  // }
-  meta.dims = tmp_dim;
-  meta.strides =
-      DDim(output_stride.data(), static_cast<int>(output_stride.size()));
-  meta.offset = input.offset();
-  out->set_meta(meta);
-  out->ResetHolder(input.Holder());
-  out->ShareInplaceVersionCounterWith(input);
+  out->ShareStridedViewWith(
+      input,
+      DDim(output_dims.data(), static_cast<int>(output_dims.size())),
+      DDim(output_stride.data(), static_cast<int>(output_stride.size())),
+      input.offset());
 }
 
 template <typename Context>
@@ -29,6 +29,9 @@
 namespace pir {
 
 class IrContext;
+namespace detail {
+class OperationArena;
+}  // namespace detail
 ///
 /// \brief Program is an abstraction of model structure, divided into
 /// computational graphs and weights. At the current stage, a computational
@@ -73,6 +76,10 @@ class IR_API Program {
 
   uint64_t id() const { return id_; }
 
+  /// The arena the operations built into this program are allocated from,
+  /// nullptr if they are allocated from the heap.
+  detail::OperationArena* arena() const { return arena_; }
+
  private:
   // computation graph
   ModuleOp module_;
@@ -80,6 +87,8 @@ class IR_API Program {
   uint64_t id_;
   // weight
   ParameterMap parameters_;
+  // memory of the operations
+  detail::OperationArena* arena_{nullptr};
 };
 
 IR_API std::ostream& operator<<(std::ostream& os, const Program& prog);
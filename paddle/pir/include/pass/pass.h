@@ -16,6 +16,7 @@
 
 #include <any>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -214,6 +215,33 @@ class IR_API PatternRewritePass : public Pass {
   FrozenRewritePatternSet patterns_;
 
   GreedyRewriteConfig config_;
+
+  friend class MergedPatternRewritePass;
+};
+
+/// Apply the patterns of several pattern rewrite passes in one traversal,
+/// with the config of the first pass. It is only legal for the passes whose
+/// rewrites do not depend on the order of the passes, e.g. the fusions of
+/// disjoint subgraphs. The passes that can not apply on all the same ops are
+/// run one by one, and none of them runs below the highest of their opt
+/// levels.
+class IR_API MergedPatternRewritePass : public Pass {
+ public:
+  MergedPatternRewritePass(
+      const std::string& name,
+      std::vector<std::unique_ptr<PatternRewritePass>> passes);
+
+ protected:
+  bool Initialize(IrContext* context) override;
+
+  void Run(Operation* op) override;
+
+  bool CanApplyOn(Operation* op) const override;
+
+ private:
+  std::vector<std::unique_ptr<PatternRewritePass>> passes_;
+
+  FrozenRewritePatternSet patterns_;
 };
 
 }  // namespace pir
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -115,6 +116,18 @@ class IR_API PassManager {
 
   void AddInstrumentation(std::unique_ptr<PassInstrumentation> pi);
 
+  ///
+  /// \brief Run the pipeline over the nested ops isolated from above, i.e. the
+  /// ops in their regions only use the values defined in them, by num_threads
+  /// threads. The passes are not thread safe, so each thread runs its own
+  /// pipeline added by pipeline_builder, which should add the same passes as
+  /// this pass manager. Those passes must only rewrite the IR nested in the op
+  /// they run on, and are run without instrumentation.
+  ///
+  void EnableParallelExecution(
+      int num_threads,
+      const std::function<void(PassManager *)> &pipeline_builder);
+
  private:
   bool Initialize(IrContext *context);
 
@@ -135,6 +148,10 @@ class IR_API PassManager {
 
   std::unique_ptr<PassInstrumentor> instrumentor_;
 
+  // The pipelines run by the threads of the parallel execution, one per
+  // thread.
+  std::vector<std::unique_ptr<PassManager>> parallel_pms_;
+
   // For access member of pass_adaptor_.
   friend class detail::PassAdaptor;
 };
@@ -31,6 +31,7 @@ class IR_API FrozenRewritePatternSet {
   using NativePatternListT = std::vector<std::unique_ptr<RewritePattern>>;
 
  public:
+  using NativePatternPtrListT = std::vector<RewritePattern*>;
   using OpSpecificNativePatternListT =
       std::unordered_map<OpInfo, std::vector<RewritePattern*>>;
 
@@ -49,14 +50,20 @@ class IR_API FrozenRewritePatternSet {
       const std::vector<std::string>& disabled_pattern_labels = {},
       const std::vector<std::string>& enabled_pattern_labels = {});
 
+  /// Merge the patterns of `pattern_sets` to apply them in one traversal, the
+  /// patterns of the same benefit are tried in the order of the sets. The
+  /// merged set shares the patterns with `pattern_sets`.
+  explicit FrozenRewritePatternSet(
+      const std::vector<FrozenRewritePatternSet>& pattern_sets);
+
   /// Return the op specific native patterns held by this list.
   const OpSpecificNativePatternListT& op_specific_native_patterns() const {
     return impl_->op_specific_native_pattern_map_;
   }
 
   /// Return the "match any" native patterns held by this list.
-  const NativePatternListT& match_any_op_native_patterns() const {
-    return impl_->match_any_op_native_patterns_;
+  const NativePatternPtrListT& match_any_op_native_patterns() const {
+    return impl_->match_any_op_native_pattern_list_;
   }
 
  private:
@@ -66,6 +73,11 @@ class IR_API FrozenRewritePatternSet {
     NativePatternListT op_specific_native_patterns_;
 
     NativePatternListT match_any_op_native_patterns_;
+
+    NativePatternPtrListT match_any_op_native_pattern_list_;
+
+    // The sets merged into this one, which own its patterns.
+    std::vector<std::shared_ptr<Impl>> merged_impls_;
   };
 
   std::shared_ptr<Impl> impl_;
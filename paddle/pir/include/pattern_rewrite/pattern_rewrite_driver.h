@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
 #include "paddle/pir/include/core/dll_decl.h"
 #include "paddle/pir/include/core/region.h"
 
@@ -32,6 +36,13 @@ enum class IR_API GreedyRewriteStrictness {
   ExistingOps
 };
 
+/// The matches and the time of the attempts of a pattern.
+struct IR_API PatternStatistics {
+  int64_t num_attempts = 0;
+  int64_t num_matches = 0;
+  double time_ms = 0.;
+};
+
 /// Control over how the GreedyPatternRewriteDriver works.
 class IR_API GreedyRewriteConfig {
  public:
@@ -57,6 +68,18 @@ class IR_API GreedyRewriteConfig {
   /// - ExistingOps: only pre-existing ops are added to the worklist.
   GreedyRewriteStrictness strict_mode = GreedyRewriteStrictness::AnyOp;
 
+  /// Only revisit the ops added to the worklist by the rewrites, i.e. the new
+  /// and the updated ops, their users and the producers of the operands of
+  /// the erased ops, instead of rescanning the whole region after each
+  /// iteration with rewrites. The patterns anchored more than one use away
+  /// from a rewrite are not revisited. The number of the rewrites is bounded
+  /// by `max_iterations` times the number of the ops in the region.
+  bool incremental = false;
+
+  /// If set, the statistics of the patterns are accumulated into it, keyed by
+  /// their debug names.
+  std::unordered_map<std::string, PatternStatistics>* statistics{nullptr};
+
   static constexpr int64_t kNoLimit = -1;
 };
 
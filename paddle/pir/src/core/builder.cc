@@ -18,11 +18,23 @@
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_type.h"
 #include "paddle/pir/include/core/region.h"
+#include "paddle/pir/include/core/program.h"
 #include "paddle/pir/include/core/value.h"
+#include "paddle/pir/src/core/operation_arena.h"
 
 namespace pir {
 /// Create an operation given the fields represented as an OperationState.
 Operation *Builder::Build(OperationArgument &&argument) {
+  // Allocate the operation from the arena of the program it is inserted into.
+  detail::OperationArena *arena = nullptr;
+  if (Block *block = insertion_point_.first) {
+    if (Operation *parent_op = block->GetParentOp()) {
+      if (Program *program = parent_op->GetParentProgram()) {
+        arena = program->arena();
+      }
+    }
+  }
+  detail::OperationArenaScope arena_scope(arena);
   return Insert(Operation::Create(std::move(argument)));
 }
 
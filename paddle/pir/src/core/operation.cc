@@ -26,6 +26,7 @@
 #include "paddle/pir/include/core/utils.h"
 #include "paddle/pir/src/core/block_operand_impl.h"
 #include "paddle/pir/src/core/op_result_impl.h"
+#include "paddle/pir/src/core/operation_arena.h"
 
 namespace pir {
 using detail::OpInlineResultImpl;
@@ -75,9 +76,9 @@ Operation *Operation::Create(const std::vector<Value> &inputs,
   size_t region_mem_size = num_regions * sizeof(Region);
   size_t base_size = result_mem_size + op_mem_size + operand_mem_size +
                      region_mem_size + block_operand_size;
-  // 2. Malloc memory.
+  // 2. Malloc memory, from the arena of the program if there is one.
   char *base_ptr =
-      reinterpret_cast<char *>(detail::aligned_malloc(base_size, 8));
+      reinterpret_cast<char *>(detail::AllocateOperationMemory(base_size));
 
   auto name = op_info ? op_info.name() : "";
   VLOG(10) << "Create Operation [" << name
@@ -238,7 +239,7 @@ void Operation::Destroy() {
 
   VLOG(10) << "Destroy Operation [" << name() << "]: {ptr = " << aligned_ptr
            << ", size = " << result_mem_size << "} done.";
-  detail::aligned_free(aligned_ptr);
+  detail::FreeOperationMemory(aligned_ptr);
 }
 
 IrContext *Operation::ir_context() const { return info_.ir_context(); }
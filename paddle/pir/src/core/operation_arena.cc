@@ -0,0 +1,119 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/pir/src/core/operation_arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#include "paddle/pir/include/core/utils.h"
+
+namespace pir {
+namespace detail {
+
+namespace {
+thread_local OperationArena *current_arena = nullptr;
+
+// Placed before the memory of each operation to find where it is from.
+struct alignas(8) OperationMemoryHeader {
+  OperationArena *arena;
+  size_t size;
+};
+}  // namespace
+
+OperationArena::~OperationArena() {
+  for (char *chunk : chunks_) {
+    std::free(chunk);
+  }
+}
+
+void OperationArena::Unref() {
+  if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+void *OperationArena::Allocate(size_t size) {
+  size = (size + kAlignment - 1) / kAlignment * kAlignment;
+  void *ptr = nullptr;
+  {
+    std::lock_guard<pir::SpinLock> guard(lock_);
+    void *&free_list = free_lists_[size / kAlignment];
+    if (free_list) {
+      ptr = free_list;
+      free_list = *reinterpret_cast<void **>(ptr);
+    } else {
+      if (remaining_ < size) {
+        // The tail of the last chunk is left unused.
+        size_t chunk_size = std::max(next_chunk_size_, size);
+        char *chunk = static_cast<char *>(std::malloc(chunk_size));
+        if (chunk == nullptr) throw std::bad_alloc();
+        chunks_.push_back(chunk);
+        cursor_ = chunk;
+        remaining_ = chunk_size;
+        next_chunk_size_ = std::min(next_chunk_size_ * 2, kMaxChunkSize);
+      }
+      ptr = cursor_;
+      cursor_ += size;
+      remaining_ -= size;
+    }
+  }
+  // Each operation keeps the arena alive.
+  ref_count_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void OperationArena::Deallocate(void *ptr, size_t size) {
+  size = (size + kAlignment - 1) / kAlignment * kAlignment;
+  {
+    std::lock_guard<pir::SpinLock> guard(lock_);
+    void *&free_list = free_lists_[size / kAlignment];
+    *reinterpret_cast<void **>(ptr) = free_list;
+    free_list = ptr;
+  }
+  Unref();
+}
+
+OperationArena *OperationArena::current() { return current_arena; }
+
+OperationArenaScope::OperationArenaScope(OperationArena *arena)
+    : prev_arena_(current_arena) {
+  current_arena = arena;
+}
+
+OperationArenaScope::~OperationArenaScope() { current_arena = prev_arena_; }
+
+void *AllocateOperationMemory(size_t size) {
+  size_t total_size = size + sizeof(OperationMemoryHeader);
+  OperationArena *arena = OperationArena::current();
+  if (total_size > OperationArena::kMaxAllocSize) arena = nullptr;
+  void *ptr = arena ? arena->Allocate(total_size)
+                    : aligned_malloc(total_size, alignof(OperationMemoryHeader));
+  auto *header = new (ptr) OperationMemoryHeader{arena, total_size};
+  return header + 1;
+}
+
+void FreeOperationMemory(void *ptr) {
+  auto *header = static_cast<OperationMemoryHeader *>(ptr) - 1;
+  if (header->arena) {
+    header->arena->Deallocate(header, header->size);
+  } else {
+    aligned_free(header);
+  }
+}
+
+}  // namespace detail
+}  // namespace pir
@@ -0,0 +1,95 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "paddle/pir/include/core/spin_lock.h"
+
+namespace pir {
+namespace detail {
+
+///
+/// \brief The memory of the operations of a program, together with their
+/// results, operands and regions. The memory is bumped from chunks, reused
+/// by size once an operation is destroyed, and freed in bulk. An operation
+/// may outlive its program, e.g. moved into another one, so the arena is
+/// only freed after the program and all the operations allocated from it
+/// are gone.
+///
+class OperationArena {
+ public:
+  static OperationArena *Create() { return new OperationArena(); }
+
+  /// Drop the reference of the program.
+  void Release() { Unref(); }
+
+  void *Allocate(size_t size);
+
+  void Deallocate(void *ptr, size_t size);
+
+  /// The arena of the operations created by the current thread, nullptr if
+  /// they are allocated from the heap.
+  static OperationArena *current();
+
+  static constexpr size_t kMaxAllocSize = 1024;
+
+ private:
+  OperationArena() = default;
+  ~OperationArena();
+
+  void Unref();
+
+  static constexpr size_t kAlignment = 8;
+  static constexpr size_t kMinChunkSize = 4096;
+  static constexpr size_t kMaxChunkSize = 1 << 20;
+
+  pir::SpinLock lock_;
+  std::atomic<int64_t> ref_count_{1};
+  std::vector<char *> chunks_;
+  char *cursor_{nullptr};
+  size_t remaining_{0};
+  size_t next_chunk_size_{kMinChunkSize};
+  // The freed memory of each size, linked through their first words.
+  std::array<void *, kMaxAllocSize / kAlignment + 1> free_lists_{};
+};
+
+///
+/// \brief Allocate the operations created by the current thread from the
+/// arena during the lifetime of the scope.
+///
+class OperationArenaScope {
+ public:
+  explicit OperationArenaScope(OperationArena *arena);
+  ~OperationArenaScope();
+
+ private:
+  OperationArenaScope(const OperationArenaScope &) = delete;
+  OperationArenaScope &operator=(const OperationArenaScope &) = delete;
+
+  OperationArena *prev_arena_;
+};
+
+/// Allocate the memory of an operation from the current arena, or from the
+/// heap if there is none or the operation is too large.
+void *AllocateOperationMemory(size_t size);
+
+void FreeOperationMemory(void *ptr);
+
+}  // namespace detail
+}  // namespace pir
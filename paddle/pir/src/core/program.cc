@@ -18,7 +18,11 @@
 #include <random>
 #include <unordered_set>
 #include "glog/logging.h"
+#include "paddle/common/flags.h"
 #include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/src/core/operation_arena.h"
+
+COMMON_DECLARE_bool(pir_use_operation_arena);
 
 namespace pir {
 
@@ -55,18 +59,25 @@ int64_t GetUniqueRandomId() {
 Program::Program(IrContext* context) {
   module_ = ModuleOp::Create(context, this);
   id_ = GetUniqueRandomId();
+  if (FLAGS_pir_use_operation_arena) {
+    arena_ = detail::OperationArena::Create();
+  }
 }
 
 Program::~Program() {
   if (module_) {
     module_.Destroy();
   }
+  if (arena_) {
+    arena_->Release();
+  }
 }
 
 std::shared_ptr<Program> Program::Clone(IrMapping& ir_mapping) const {
   pir::IrContext* ctx = pir::IrContext::Instance();
   auto new_program = std::make_shared<Program>(ctx);
   auto clone_options = CloneOptions::All();
+  detail::OperationArenaScope arena_scope(new_program->arena());
 
   // deal kwargs
   for (auto [key, value] : block()->kwargs()) {
@@ -87,6 +98,11 @@ std::shared_ptr<Program> Program::Clone(IrMapping& ir_mapping) const {
 
 void Program::CopyToBlock(IrMapping& ir_mapping, Block* insert_block) const {
   auto clone_options = CloneOptions::All();
+  Operation* parent_op = insert_block->GetParentOp();
+  Program* insert_program =
+      parent_op ? parent_op->GetParentProgram() : nullptr;
+  detail::OperationArenaScope arena_scope(
+      insert_program ? insert_program->arena() : nullptr);
   for (const auto& op : *block()) {
     bool skip_op = false;
     for (uint32_t i = 0; i < op.num_results(); i++) {
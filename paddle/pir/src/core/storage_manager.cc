@@ -15,14 +15,18 @@
 #include "paddle/pir/include/core/storage_manager.h"
 
 #include <glog/logging.h>
+#include <array>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "paddle/common/enforce.h"
 
 namespace pir {
 // This is a structure for creating, caching, and looking up Storage of
-// parametric types.
+// parametric types. The instances are sharded by their hash value, each shard
+// with its own lock, so the threads building programs concurrently rarely
+// contend on the same one.
 struct ParametricStorageManager {
   using StorageBase = StorageManager::StorageBase;
 
@@ -30,10 +34,12 @@ struct ParametricStorageManager {
       : destroy_(destroy) {}
 
   ~ParametricStorageManager() {  // NOLINT
-    for (const auto &instance : parametric_instances_) {
-      destroy_(instance.second);
+    for (auto &shard : shards_) {
+      for (const auto &instance : shard.parametric_instances) {
+        destroy_(instance.second);
+      }
+      shard.parametric_instances.clear();
     }
-    parametric_instances_.clear();
   }
 
   // Get the storage of parametric type, if not in the cache, create and
@@ -41,8 +47,11 @@ struct ParametricStorageManager {
   StorageBase *GetOrCreate(std::size_t hash_value,
                            std::function<bool(StorageBase *)> equal_func,
                            std::function<StorageBase *()> constructor) {
-    if (parametric_instances_.count(hash_value) != 0) {
-      auto pr = parametric_instances_.equal_range(hash_value);
+    Shard &shard = GetShard(hash_value);
+    std::lock_guard<pir::SpinLock> guard(shard.lock);
+    auto &parametric_instances = shard.parametric_instances;
+    if (parametric_instances.count(hash_value) != 0) {
+      auto pr = parametric_instances.equal_range(hash_value);
       while (pr.first != pr.second) {
         if (equal_func(pr.first->second)) {
           VLOG(10) << "Found a cached parametric storage of: [param_hash="
@@ -54,7 +63,7 @@ struct ParametricStorageManager {
       }
     }
     StorageBase *storage = constructor();
-    parametric_instances_.emplace(hash_value, storage);
+    parametric_instances.emplace(hash_value, storage);
     VLOG(10) << "No cache found, construct and cache a new parametric storage "
                 "of: [param_hash="
              << hash_value << ", storage_ptr=" << storage << "].";
@@ -62,9 +71,23 @@ struct ParametricStorageManager {
   }
 
  private:
-  // In order to prevent hash conflicts, the unordered_multimap data structure
-  // is used for storage.
-  std::unordered_multimap<size_t, StorageBase *> parametric_instances_;
+  static constexpr std::size_t kNumShards = 16;
+
+  // Each shard is on its own cache line to avoid the false sharing between
+  // the locks.
+  struct alignas(64) Shard {
+    pir::SpinLock lock;
+    // In order to prevent hash conflicts, the unordered_multimap data
+    // structure is used for storage.
+    std::unordered_multimap<size_t, StorageBase *> parametric_instances;
+  };
+
+  Shard &GetShard(std::size_t hash_value) {
+    // the low bits of the combined hashes are not well mixed
+    return shards_[(hash_value ^ (hash_value >> 17)) % kNumShards];
+  }
+
+  std::array<Shard, kNumShards> shards_;
   std::function<void(StorageBase *)> destroy_;
 };
 
@@ -77,31 +100,37 @@ StorageManager::StorageBase *StorageManager::GetParametricStorageImpl(
     std::size_t hash_value,
     std::function<bool(const StorageBase *)> equal_func,
     std::function<StorageBase *()> constructor) {
-  std::lock_guard<pir::SpinLock> guard(parametric_instance_lock_);
-  VLOG(10) << "Try to get a parametric storage of: [TypeId_hash="
-           << std::hash<pir::TypeId>()(type_id) << ", param_hash=" << hash_value
-           << "].";
-  if (parametric_instance_.find(type_id) == parametric_instance_.end()) {
-    IR_THROW("The input data pointer is null.");
+  ParametricStorageManager *parametric_storage = nullptr;
+  {
+    // The storage classes are registered with the dialects, afterwards the
+    // map is only read.
+    std::shared_lock<std::shared_mutex> guard(parametric_instance_lock_);
+    VLOG(10) << "Try to get a parametric storage of: [TypeId_hash="
+             << std::hash<pir::TypeId>()(type_id)
+             << ", param_hash=" << hash_value << "].";
+    auto iter = parametric_instance_.find(type_id);
+    if (iter == parametric_instance_.end()) {
+      IR_THROW("The input data pointer is null.");
+    }
+    parametric_storage = iter->second.get();
   }
-  ParametricStorageManager &parametric_storage = *parametric_instance_[type_id];
-  return parametric_storage.GetOrCreate(hash_value, equal_func, constructor);
+  return parametric_storage->GetOrCreate(hash_value, equal_func, constructor);
 }
 
 StorageManager::StorageBase *StorageManager::GetParameterlessStorageImpl(
     TypeId type_id) {
-  std::lock_guard<pir::SpinLock> guard(parameterless_instance_lock_);
+  std::shared_lock<std::shared_mutex> guard(parameterless_instance_lock_);
   VLOG(10) << "Try to get a parameterless storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << "].";
-  if (parameterless_instance_.find(type_id) == parameterless_instance_.end())
+  auto iter = parameterless_instance_.find(type_id);
+  if (iter == parameterless_instance_.end())
     IR_THROW("TypeId not found in IrContext.");
-  StorageBase *parameterless_instance = parameterless_instance_[type_id];
-  return parameterless_instance;
+  return iter->second;
 }
 
 void StorageManager::RegisterParametricStorageImpl(
     TypeId type_id, std::function<void(StorageBase *)> destroy) {
-  std::lock_guard<pir::SpinLock> guard(parametric_instance_lock_);
+  std::lock_guard<std::shared_mutex> guard(parametric_instance_lock_);
   VLOG(10) << "Register a parametric storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << "].";
   parametric_instance_.emplace(
@@ -110,7 +139,7 @@ void StorageManager::RegisterParametricStorageImpl(
 
 void StorageManager::RegisterParameterlessStorageImpl(
     TypeId type_id, std::function<StorageBase *()> constructor) {
-  std::lock_guard<pir::SpinLock> guard(parameterless_instance_lock_);
+  std::lock_guard<std::shared_mutex> guard(parameterless_instance_lock_);
   VLOG(10) << "Register a parameterless storage of: [TypeId_hash="
            << std::hash<pir::TypeId>()(type_id) << "].";
   if (parameterless_instance_.find(type_id) != parameterless_instance_.end())
@@ -13,6 +13,15 @@
 // limitations under the License.
 
 #include "paddle/pir/include/pass/pass.h"
+
+#include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/operation.h"
 #include "paddle/pir/include/core/program.h"
@@ -24,6 +33,10 @@
 #include "paddle/pir/src/pass/pass_adaptor.h"
 
 #include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+
+COMMON_DECLARE_bool(pir_incremental_pattern_rewrite);
+COMMON_DECLARE_bool(pir_pattern_rewrite_statistics);
 
 namespace pir {
 
@@ -85,12 +98,100 @@ GreedyRewriteConfig PatternRewritePass::InitializeConfig() {
   return config;
 }
 
+namespace {
+void LogPatternStatistics(
+    const std::string& pass_name,
+    const std::unordered_map<std::string, PatternStatistics>& statistics) {
+  std::vector<std::pair<std::string, PatternStatistics>> sorted(
+      statistics.begin(), statistics.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.second.time_ms > rhs.second.time_ms;
+  });
+  for (const auto& [pattern_name, pattern_statistics] : sorted) {
+    LOG(INFO) << "--- [" << pass_name << "] pattern [" << pattern_name
+              << "] matched " << pattern_statistics.num_matches << " of "
+              << pattern_statistics.num_attempts << " attempts in "
+              << pattern_statistics.time_ms << " ms";
+  }
+}
+
+int64_t ApplyPatternRewrite(Operation* op,
+                            const std::string& pass_name,
+                            const FrozenRewritePatternSet& patterns,
+                            GreedyRewriteConfig config) {
+  if (FLAGS_pir_incremental_pattern_rewrite) config.incremental = true;
+  std::unordered_map<std::string, PatternStatistics> statistics;
+  if (FLAGS_pir_pattern_rewrite_statistics) config.statistics = &statistics;
+  auto [_, num_rewrites] = ApplyPatternsGreedily(op, patterns, config);
+  if (config.statistics) LogPatternStatistics(pass_name, statistics);
+  return num_rewrites;
+}
+
+uint8_t MaxOptLevel(
+    const std::vector<std::unique_ptr<PatternRewritePass>>& passes) {
+  uint8_t opt_level = 0;
+  for (const auto& pass : passes) {
+    opt_level = std::max(opt_level, pass->pass_info().opt_level);
+  }
+  return opt_level;
+}
+}  // namespace
+
 void PatternRewritePass::Run(Operation* op) {
-  auto [_, num_rewrites] =
-      ApplyPatternsGreedily(op, patterns_, InitializeConfig());
+  AddStatistics(ApplyPatternRewrite(op, name(), patterns_, InitializeConfig()));
+}
+
+//===----------------------------------------------------------------------===//
+// MergedPatternRewritePass
+//===----------------------------------------------------------------------===//
+MergedPatternRewritePass::MergedPatternRewritePass(
+    const std::string& name,
+    std::vector<std::unique_ptr<PatternRewritePass>> passes)
+    : Pass(name, MaxOptLevel(passes)), passes_(std::move(passes)) {
+  PADDLE_ENFORCE_EQ(passes_.empty(),
+                    false,
+                    common::errors::InvalidArgument(
+                        "The merged pattern rewrite pass [%s] requires at "
+                        "least one pass.",
+                        name));
+}
+
+bool MergedPatternRewritePass::Initialize(IrContext* context) {
+  std::vector<FrozenRewritePatternSet> pattern_sets;
+  for (auto& pass : passes_) {
+    if (!pass->Initialize(context)) return false;
+    pattern_sets.push_back(pass->patterns_);
+  }
+  patterns_ = FrozenRewritePatternSet(pattern_sets);
+  return true;
+}
+
+void MergedPatternRewritePass::Run(Operation* op) {
+  bool can_merge = std::all_of(
+      passes_.begin(), passes_.end(), [op](const auto& pass) {
+        return pass->CanApplyOn(op);
+      });
+  int64_t num_rewrites = 0;
+  if (can_merge) {
+    num_rewrites = ApplyPatternRewrite(
+        op, name(), patterns_, passes_.front()->InitializeConfig());
+  } else {
+    for (auto& pass : passes_) {
+      if (!pass->CanApplyOn(op)) continue;
+      num_rewrites += ApplyPatternRewrite(
+          op, pass->name(), pass->patterns_, pass->InitializeConfig());
+    }
+  }
   AddStatistics(num_rewrites);
 }
 
+bool MergedPatternRewritePass::CanApplyOn(Operation* op) const {
+  return std::any_of(
+      passes_.begin(), passes_.end(), [op](const auto& pass) {
+        return pass->CanApplyOn(op);
+      });
+}
+
 //----------------------------------------------------------------------------------------------//
 // PassAdaptor
 //----------------------------------------------------------------------------------------------//
@@ -98,22 +199,118 @@ void detail::PassAdaptor::Run(Operation* op, uint8_t opt_level, bool verify) {
   RunImpl(op, opt_level, verify);
 }
 
+namespace {
+// Whether the ops nested in op only use the values defined in op, then the
+// IR in op can be rewritten without touching the use lists outside of it.
+bool IsIsolatedFromAbove(Operation* op) {
+  std::unordered_set<Value> defined_values;
+  op->Walk([&](Operation* nested_op) {
+    if (nested_op != op) {
+      for (auto result : nested_op->results()) {
+        defined_values.insert(result);
+      }
+    }
+    for (size_t i = 0; i < nested_op->num_regions(); ++i) {
+      for (auto& block : nested_op->region(i)) {
+        for (auto arg : block.args()) {
+          defined_values.insert(arg);
+        }
+        for (auto& [_, kwarg] : block.kwargs()) {
+          defined_values.insert(kwarg);
+        }
+      }
+    }
+  });
+  bool isolated = true;
+  op->Walk([&](Operation* nested_op) {
+    if (nested_op == op || !isolated) return;
+    for (uint32_t i = 0; i < nested_op->num_operands(); ++i) {
+      Value operand = nested_op->operand_source(i);
+      if (operand && defined_values.count(operand) == 0) {
+        isolated = false;
+        return;
+      }
+    }
+  });
+  return isolated;
+}
+}  // namespace
+
 void detail::PassAdaptor::RunImpl(Operation* op,
                                   uint8_t opt_level,
                                   bool verify) {
   auto last_am = analysis_manager();
 
+  if (pm_->parallel_pms_.empty()) {
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      auto& region = op->region(i);
+      for (auto& block : region) {
+        for (auto& op : block) {
+          AnalysisManagerHolder am(&op, last_am.GetPassInstrumentor());
+          if (!RunPipeline(*pm_, &op, am, opt_level, verify))
+            return SignalPassFailure();
+        }
+      }
+    }
+    return;
+  }
+
+  // The isolated ops are run in parallel, the others one by one in order as
+  // the rewrites of them may touch the IR outside.
+  std::vector<Operation*> isolated_ops;
+  std::vector<Operation*> other_ops;
   for (size_t i = 0; i < op->num_regions(); ++i) {
-    auto& region = op->region(i);
-    for (auto& block : region) {
-      for (auto& op : block) {
-        AnalysisManagerHolder am(&op, last_am.GetPassInstrumentor());
-        if (!RunPipeline(*pm_, &op, am, opt_level, verify))
-          return SignalPassFailure();
+    for (auto& block : op->region(i)) {
+      for (auto& nested_op : block) {
+        if (nested_op.num_regions() > 0 && IsIsolatedFromAbove(&nested_op)) {
+          isolated_ops.push_back(&nested_op);
+        } else {
+          other_ops.push_back(&nested_op);
+        }
       }
     }
   }
-  return;
+  if (!RunParallel(isolated_ops, opt_level, verify)) {
+    return SignalPassFailure();
+  }
+  for (auto* nested_op : other_ops) {
+    AnalysisManagerHolder am(nested_op, last_am.GetPassInstrumentor());
+    if (!RunPipeline(*pm_, nested_op, am, opt_level, verify))
+      return SignalPassFailure();
+  }
+}
+
+bool detail::PassAdaptor::RunParallel(const std::vector<Operation*>& ops,
+                                      uint8_t opt_level,
+                                      bool verify) {
+  size_t num_threads = std::min(ops.size(), pm_->parallel_pms_.size());
+  std::vector<char> succeeded(ops.size(), 0);
+  std::vector<std::exception_ptr> exceptions(ops.size());
+  std::atomic<size_t> next_op{0};
+  auto worker = [&](const PassManager& pm) {
+    for (size_t i = next_op++; i < ops.size(); i = next_op++) {
+      try {
+        AnalysisManagerHolder am(ops[i], nullptr);
+        succeeded[i] = RunPipeline(pm, ops[i], am, opt_level, verify);
+      } catch (...) {
+        exceptions[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back(worker, std::cref(*pm_->parallel_pms_[i]));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Report the failure of the first op as the serial run does, whichever
+  // thread fails first.
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (exceptions[i]) std::rethrow_exception(exceptions[i]);
+    if (!succeeded[i]) return false;
+  }
+  return true;
 }
 
 bool detail::PassAdaptor::RunPipeline(const PassManager& pm,
@@ -186,6 +383,9 @@ bool PassManager::Run(Program* program) {
   if (!Initialize(context_)) {
     return false;
   }
+  for (auto& pm : parallel_pms_) {
+    if (!pm->Initialize(context_)) return false;
+  }
   return Run(program->module_op());
 }
 
@@ -204,6 +404,25 @@ bool PassManager::Initialize(IrContext* context) {
   return true;
 }
 
+void PassManager::EnableParallelExecution(
+    int num_threads,
+    const std::function<void(PassManager*)>& pipeline_builder) {
+  PADDLE_ENFORCE_GT(num_threads,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The number of threads to run the passes should be "
+                        "greater than 0, but received %d.",
+                        num_threads));
+  parallel_pms_.clear();
+  if (num_threads == 1) return;
+  for (int i = 0; i < num_threads; ++i) {
+    auto pm = std::make_unique<PassManager>(context_, opt_level_);
+    pm->verify_ = verify_;
+    pipeline_builder(pm.get());
+    parallel_pms_.emplace_back(std::move(pm));
+  }
+}
+
 void PassManager::AddInstrumentation(std::unique_ptr<PassInstrumentation> pi) {
   if (!instrumentor_) instrumentor_ = std::make_unique<PassInstrumentor>();
 
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "paddle/pir/include/pass/pass.h"
 
 namespace pir {
@@ -34,6 +36,11 @@ class PassAdaptor final : public Pass {
  private:
   void RunImpl(Operation* op, uint8_t opt_level, bool verify);
 
+  // Run the pipelines of the parallel execution over the isolated ops.
+  bool RunParallel(const std::vector<Operation*>& ops,
+                   uint8_t opt_level,
+                   bool verify);
+
   static bool RunPass(Pass* pass,
                       Operation* op,
                       AnalysisManager am,
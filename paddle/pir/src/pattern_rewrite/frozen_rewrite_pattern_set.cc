@@ -93,8 +93,28 @@ FrozenRewritePatternSet::FrozenRewritePatternSet(
       continue;
     }
 
+    impl_->match_any_op_native_pattern_list_.push_back(pat.get());
     impl_->match_any_op_native_patterns_.push_back(std::move(pat));
   }
 }
 
+FrozenRewritePatternSet::FrozenRewritePatternSet(
+    const std::vector<FrozenRewritePatternSet>& pattern_sets)
+    : impl_(std::make_shared<Impl>()) {
+  for (const auto& pattern_set : pattern_sets) {
+    for (const auto& [op_info, patterns] :
+         pattern_set.op_specific_native_patterns()) {
+      auto& merged_patterns = impl_->op_specific_native_pattern_map_[op_info];
+      merged_patterns.insert(
+          merged_patterns.end(), patterns.begin(), patterns.end());
+    }
+    const auto& any_op_patterns = pattern_set.match_any_op_native_patterns();
+    impl_->match_any_op_native_pattern_list_.insert(
+        impl_->match_any_op_native_pattern_list_.end(),
+        any_op_patterns.begin(),
+        any_op_patterns.end());
+    impl_->merged_impls_.push_back(pattern_set.impl_);
+  }
+}
+
 }  // namespace pir
@@ -34,8 +34,8 @@ void PatternApplicator::ApplyCostModel(const CostModel& model) {
   }
 
   any_op_patterns_.clear();
-  for (auto& pattern : frozen_pattern_list_.match_any_op_native_patterns()) {
-    any_op_patterns_.push_back(pattern.get());
+  for (auto* pattern : frozen_pattern_list_.match_any_op_native_patterns()) {
+    any_op_patterns_.push_back(pattern);
   }
 
   // Sort by benefit based on the cost model.
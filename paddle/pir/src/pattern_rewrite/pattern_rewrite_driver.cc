@@ -16,6 +16,7 @@
 
 #include <glog/logging.h>
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
@@ -56,6 +57,7 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
   }
 
   std::pair<bool, int64_t> Simplify() {
+    if (config_.incremental) return SimplifyIncrementally();
     int64_t sum_num_rewrites = 0;
     int64_t num_rewrites = 0;
     int64_t iteration = 0;
@@ -65,24 +67,8 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
           config_.max_iterations != pir::GreedyRewriteConfig::kNoLimit)
         break;
       VLOG(6) << "Iteration[" << iteration << "] for PatternRewrite";
-      worklist_.clear();
-      worklist_map_.clear();
-
-      for (auto& block_item : region_) {
-        for (auto& op_item : block_item) {
-          worklist_.push_back(&op_item);
-        }
-      }
-      if (config_.use_top_down_traversal) {
-        // Reverse the list so out pop-back loop process them in-order.
-        std::reverse(worklist_.begin(), worklist_.end());
-      }
-      for (size_t i = 0; i < worklist_.size(); ++i) {
-        worklist_map_[worklist_[i]] = i;
-        VLOG(6) << "worklist[" << i << "] is " << worklist_[i]->name();
-      }
-
-      num_rewrites = ProcessWorklist();
+      PopulateWorklist();
+      num_rewrites = ProcessWorklist(config_.max_num_rewrites);
       sum_num_rewrites += num_rewrites;
     } while (num_rewrites != 0);
     bool converged = num_rewrites == 0;
@@ -90,13 +76,51 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
   }
 
  private:
-  /// Process ops until the worklist is empty or `config.max_num_rewrites`
-  /// is reached. Return `true` if any IR was changed.
-  int64_t ProcessWorklist() {
+  /// Scan the region once, then only process the ops added to the worklist by
+  /// the rewrites until it is empty.
+  std::pair<bool, int64_t> SimplifyIncrementally() {
+    PopulateWorklist();
+    int64_t max_num_rewrites = config_.max_num_rewrites;
+    if (config_.max_iterations != pir::GreedyRewriteConfig::kNoLimit) {
+      // Bound the rewrites as the rescans do, against the cyclic patterns.
+      int64_t bound = config_.max_iterations *
+                      std::max<int64_t>(worklist_.size(), int64_t{1});
+      if (max_num_rewrites == pir::GreedyRewriteConfig::kNoLimit ||
+          bound < max_num_rewrites) {
+        max_num_rewrites = bound;
+      }
+    }
+    int64_t num_rewrites = ProcessWorklist(max_num_rewrites);
+    bool converged = worklist_map_.empty();
+    return std::make_pair(converged, num_rewrites);
+  }
+
+  void PopulateWorklist() {
+    worklist_.clear();
+    worklist_map_.clear();
+
+    for (auto& block_item : region_) {
+      for (auto& op_item : block_item) {
+        worklist_.push_back(&op_item);
+      }
+    }
+    if (config_.use_top_down_traversal) {
+      // Reverse the list so out pop-back loop process them in-order.
+      std::reverse(worklist_.begin(), worklist_.end());
+    }
+    for (size_t i = 0; i < worklist_.size(); ++i) {
+      worklist_map_[worklist_[i]] = i;
+      VLOG(6) << "worklist[" << i << "] is " << worklist_[i]->name();
+    }
+  }
+
+  /// Process ops until the worklist is empty or `max_num_rewrites` is
+  /// reached. Return the number of the rewrites.
+  int64_t ProcessWorklist(int64_t max_num_rewrites) {
     int64_t num_rewrites = 0;
     while (!worklist_.empty() &&
-           (num_rewrites < config_.max_num_rewrites ||
-            config_.max_num_rewrites == pir::GreedyRewriteConfig::kNoLimit)) {
+           (num_rewrites < max_num_rewrites ||
+            max_num_rewrites == pir::GreedyRewriteConfig::kNoLimit)) {
       auto* op = PopFromWorklist();
       if (op == nullptr) continue;
       VLOG(6) << "PopFromWorklist, get op: " << op->name();
@@ -107,7 +131,9 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
       // TODO(wilber): fold logical.
       // ...
 
-      bool match_result = matcher_.MatchAndRewrite(op, *this);
+      bool match_result = config_.statistics
+                              ? MatchAndRewriteWithStatistics(op)
+                              : matcher_.MatchAndRewrite(op, *this);
       if (match_result) {
         ++num_rewrites;
       }
@@ -115,6 +141,31 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     return num_rewrites;
   }
 
+  bool MatchAndRewriteWithStatistics(pir::Operation* op) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point begin;
+    auto Record = [&](const pir::Pattern& pattern, bool matched) {
+      auto& statistics = (*config_.statistics)[pattern.debug_name()];
+      ++statistics.num_attempts;
+      if (matched) ++statistics.num_matches;
+      statistics.time_ms +=
+          std::chrono::duration<double, std::milli>(Clock::now() - begin)
+              .count();
+    };
+    return matcher_.MatchAndRewrite(
+        op,
+        *this,
+        [&](const pir::Pattern&) {
+          begin = Clock::now();
+          return true;
+        },
+        [&](const pir::Pattern& pattern) { Record(pattern, false); },
+        [&](const pir::Pattern& pattern) {
+          Record(pattern, true);
+          return true;
+        });
+  }
+
   void NotifyRootReplaced(pir::Operation* op,
                           const std::vector<pir::Value>& replacement) override {
     for (uint32_t i = 0; i < op->num_results(); ++i) {
@@ -125,7 +176,11 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     }
   }
 
-  void FinalizeRootUpdate(pir::Operation* op) override { AddToWorklist(op); }
+  void FinalizeRootUpdate(pir::Operation* op) override {
+    AddToWorklist(op);
+    // Without the rescans, the users may only be revisited from here.
+    if (config_.incremental) AddUsersToWorklist(op);
+  }
 
   void NotifyOperationRemoved(pir::Operation* op) override {
     for (uint32_t i = 0; i < op->num_operands(); ++i) {
@@ -154,6 +209,7 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     if (config_.strict_mode == pir::GreedyRewriteStrictness::ExistingAndNewOps)
       strict_mode_filtered_ops_.insert(op);
     AddToWorklist(op);
+    if (config_.incremental) AddUsersToWorklist(op);
   }
 
   /// Add the given operation to the worklist.
@@ -167,6 +223,15 @@ class GreedyPatternRewriteDriver : public pir::PatternRewriter {
     }
   }
 
+  void AddUsersToWorklist(pir::Operation* op) {
+    for (uint32_t i = 0; i < op->num_results(); ++i) {
+      auto result = op->result(i);
+      for (auto it = result.use_begin(); it != result.use_end(); ++it) {
+        AddToWorklist(it->owner());
+      }
+    }
+  }
+
   void AddOperandToWorklist(pir::Value operand) {
     // If the use count of this operand is now < 2, we re-add the defining
     // operation to the worklist.
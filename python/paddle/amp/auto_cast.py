@@ -406,6 +406,9 @@ def amp_initialize(
             ):
                 layer._amp_decorate(dtype=dtype)
                 continue
+            if isinstance(layer, paddle.incubate.nn.FP8Linear):
+                layer._amp_decorate(dtype=dtype)
+                continue
 
             if in_pir_mode():
                 _pir_to_impl(
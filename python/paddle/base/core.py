@@ -572,6 +572,15 @@ def _enable_auto_recompute():
         return False
 
 
+def _auto_recompute_memory_budget():
+    # the bytes of the forward values that the backward can hold
+    budget = os.getenv("FLAGS_auto_recompute_memory_budget")
+    if budget:
+        return int(budget)
+    else:
+        return None
+
+
 def _set_prim_forward_blacklist(*args):
     for item in args:
         if not isinstance(item, str):
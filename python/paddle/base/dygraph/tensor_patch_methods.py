@@ -1095,6 +1095,27 @@ def monkey_patch_tensor():
             res.persistable = self.persistable
             return res
 
+    def numpy_async(self: Tensor) -> paddle.device.HostCopyFuture:
+        """
+        Copies the Tensor to the host like ``Tensor.numpy()``, but does not
+        block the host until the result of the returned future is read.
+
+        Returns:
+            HostCopyFuture, whose ``result()`` is the numpy array and
+            ``item()`` is the Python scalar of a Tensor with one element.
+
+        Examples:
+            .. code-block:: python
+
+                >>> import paddle
+
+                >>> loss = paddle.to_tensor(1.5)
+                >>> future = loss.numpy_async()
+                >>> print(future.item())
+                1.5
+        """
+        return paddle.device.HostCopyFuture([self], single=True)
+
     @framework.dygraph_only
     def values(self: Tensor) -> Tensor:
         """
@@ -1270,6 +1291,7 @@ def monkey_patch_tensor():
         ("cpu", cpu),
         ("cuda", cuda),
         ("pin_memory", pin_memory),
+        ("numpy_async", numpy_async),
         ("_slice", _slice),
         ("_numel", _numel),
         ("_uva", _uva),
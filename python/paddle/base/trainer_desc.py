@@ -144,6 +144,13 @@ class TrainerDesc:
             scale_sparse_gradient_with_batch_size
         )
 
+    def _set_prefetch_next_batch_sparse(
+        self, prefetch_next_batch_sparse=False
+    ):
+        self.proto_desc.prefetch_next_batch_sparse = (
+            prefetch_next_batch_sparse
+        )
+
     def _set_scale_datanorm(self, scale_datanorm=-1):
         self.proto_desc.scale_datanorm = scale_datanorm
 
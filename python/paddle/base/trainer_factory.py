@@ -149,6 +149,10 @@ class TrainerFactory:
                     trainer._set_scale_sparse_grad_with_batch_size(
                         opt_info["scale_sparse_gradient_with_batch_size"]
                     )
+                if opt_info.get("prefetch_next_batch_sparse") is not None:
+                    trainer._set_prefetch_next_batch_sparse(
+                        opt_info["prefetch_next_batch_sparse"]
+                    )
                 if opt_info.get("scale_datanorm") is not None:
                     trainer._set_scale_datanorm(opt_info["scale_datanorm"])
                 if opt_info.get("adjust_ins_weight") is not None:
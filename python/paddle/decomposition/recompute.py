@@ -137,6 +137,10 @@ COMPUTE_INTENSIVE_OPS: List[str] = [
     "pd_op.softmax",
 ]
 
+# The recompute cost of an op is modeled by the bytes it reads and writes,
+# the compute intensive ops are weighted by their arithmetic intensity.
+COMPUTE_INTENSIVE_COST_FACTOR = 10
+
 
 AGGRESSIVE_RECOMPUTATION = False
 # Restricts the amount of computation recompute can do.
@@ -151,6 +155,7 @@ def auto_recompute(
     fwd_op_end_idx: int,
     backward_op_start_idx: int,
     recomputable_ops: Sequence[str] = None,
+    memory_budget: int = None,
 ) -> Tuple[paddle.static.Program, int]:
     '''
     Considering the compiler fuse strategy, we model the pir graph.
@@ -177,6 +182,12 @@ def auto_recompute(
         recomputable_ops(list[str]|tuple(str)|None): The op names that can
             be recomputed. If 'recompute_ops' is None, we will use the
             default recomputable_ops. Default None.
+        memory_budget(int|None): The bytes of the forward values that the
+            backward graph can hold. If the values saved by the min-cut do
+            not fit, the compute intensive ops are recomputed too. If there
+            is memory left, the values which are the most expensive to
+            recompute are saved instead. If 'memory_budget' is None, the
+            values found by the min-cut are saved. Default None.
     Returns:
         recomputed_program(Program): The recomputed program.
         fwd_op_end_idx(int): The index of the last forward op in recomputed program.
@@ -319,8 +330,8 @@ def auto_recompute(
         else:
             return mem_sz * 2
 
-    def _ban_recomputation(value_node):
-        if AGGRESSIVE_RECOMPUTATION:
+    def _ban_recomputation(value_node, aggressive):
+        if aggressive:
             return value_node.get_defining_op().name() in unrecomputable_ops
         else:
             if value_node.get_defining_op().name() not in recomputable_ops:
@@ -343,86 +354,109 @@ def auto_recompute(
             inputs_size = sum(cal_value_node_size(i) for i in inputs)
             return output_size * 4 < inputs_size
 
-    # 1.4  Model pir graph. Convert the pir calculation graph into a networkx calculation graph.
     outputs = backward_utils.ValueSet(outputs)
     inputs = backward_utils.ValueSet(inputs)
-    value_id_dict = {}
-    nx_graph = nx.DiGraph()
-    for value_node in (
-        required_fw_value_nodes
-        | required_bw_value_nodes
-        | unclaimed_value_nodes
-    ):
-        if value_node in outputs or not value_node.initialized():
-            continue
 
-        if value_node.get_defining_op().name() == "builtin.combine":
-            continue
-
-        if (
-            len(value_node.all_used_ops()) == 1
-            and value_node.all_used_ops()[0].name() == "builtin.split"
+    def _find_saved_values_by_min_cut(aggressive):
+        # 1.4  Model pir graph. Convert the pir calculation graph into a networkx calculation graph.
+        value_id_dict = {}
+        nx_graph = nx.DiGraph()
+        for value_node in (
+            required_fw_value_nodes
+            | required_bw_value_nodes
+            | unclaimed_value_nodes
         ):
-            continue
+            if value_node in outputs or not value_node.initialized():
+                continue
 
-        if value_node in required_bw_value_nodes:
-            nx_graph.add_edge(value_node.id + "_in", "sink", capacity=math.inf)
-            value_id_dict[value_node.id] = value_node
-            continue
+            if value_node.get_defining_op().name() == "builtin.combine":
+                continue
 
-        if value_node in inputs:
-            nx_graph.add_edge(
-                "source", value_node.id + "_in", capacity=math.inf
-            )
-            value_id_dict[value_node.id] = value_node
+            if (
+                len(value_node.all_used_ops()) == 1
+                and value_node.all_used_ops()[0].name() == "builtin.split"
+            ):
+                continue
 
-        # If a node can't be recomputed (too expensive or involves randomness),
-        # we prevent it from being recomputed by adding an inf edge to the source
-        # We only need to ban nodes in the fw pass, as those are the only ones that would be recomputed.
-        if (
-            _ban_recomputation(value_node)
-            and value_node in required_fw_value_nodes
-        ):
-            nx_graph.add_edge(
-                "source", value_node.id + "_in", capacity=math.inf
-            )
-            value_id_dict[value_node.id] = value_node
+            if value_node in required_bw_value_nodes:
+                nx_graph.add_edge(
+                    value_node.id + "_in", "sink", capacity=math.inf
+                )
+                value_id_dict[value_node.id] = value_node
+                continue
 
-        # todo(wanghao107) hack for dynamic shape
-        if is_dynamic_value_node(value_node):
-            weight = 1
-        else:
-            weight = _get_node_weight(
-                value_node, placeholder_value_nodes=inputs | outputs
-            )
+            if value_node in inputs:
+                nx_graph.add_edge(
+                    "source", value_node.id + "_in", capacity=math.inf
+                )
+                value_id_dict[value_node.id] = value_node
 
-        # Creates the weights on the "node" edge
-        nx_graph.add_edge(
-            value_node.id + "_in", value_node.id + "_out", capacity=weight
-        )
-        value_id_dict[value_node.id] = value_node
+            # If a node can't be recomputed (too expensive or involves randomness),
+            # we prevent it from being recomputed by adding an inf edge to the source
+            # We only need to ban nodes in the fw pass, as those are the only ones that would be recomputed.
+            if (
+                _ban_recomputation(value_node, aggressive)
+                and value_node in required_fw_value_nodes
+            ):
+                nx_graph.add_edge(
+                    "source", value_node.id + "_in", capacity=math.inf
+                )
+                value_id_dict[value_node.id] = value_node
 
-        users = find_value_node_users(value_node)
-        for user in users:
+            # todo(wanghao107) hack for dynamic shape
+            if is_dynamic_value_node(value_node):
+                weight = 1
+            else:
+                weight = _get_node_weight(
+                    value_node, placeholder_value_nodes=inputs | outputs
+                )
+
+            # Creates the weights on the "node" edge
             nx_graph.add_edge(
-                value_node.id + "_out", user.id + "_in", capacity=math.inf
+                value_node.id + "_in", value_node.id + "_out", capacity=weight
             )
-    # 1.5  find saved values by minimum cut.
-    _, partition = nx.minimum_cut(nx_graph, "source", "sink")
-    reachable, non_reachable = partition
-    cutset = set()
-    for u, nbrs in ((n, nx_graph[n]) for n in reachable):
-        cutset.update((u, v) for v in nbrs if v in non_reachable)
-
-    cut_value_nodes = backward_utils.ValueSet()
-    for value_node_in, value_node_out in cutset:
-        assert value_node_in[:-3] == value_node_out[:-4]
-        value_node = value_id_dict[value_node_in[:-3]]
-        cut_value_nodes.add(value_node)
-
-    saved_values = cut_value_nodes
-    # (TODO: wanghao107): remove it and fix model
-    saved_values = cut_value_nodes | inputs
+            value_id_dict[value_node.id] = value_node
+
+            users = find_value_node_users(value_node)
+            for user in users:
+                nx_graph.add_edge(
+                    value_node.id + "_out", user.id + "_in", capacity=math.inf
+                )
+        # 1.5  find saved values by minimum cut.
+        _, partition = nx.minimum_cut(nx_graph, "source", "sink")
+        reachable, non_reachable = partition
+        cutset = set()
+        for u, nbrs in ((n, nx_graph[n]) for n in reachable):
+            cutset.update((u, v) for v in nbrs if v in non_reachable)
+
+        cut_value_nodes = backward_utils.ValueSet()
+        for value_node_in, value_node_out in cutset:
+            assert value_node_in[:-3] == value_node_out[:-4]
+            value_node = value_id_dict[value_node_in[:-3]]
+            cut_value_nodes.add(value_node)
+        # (TODO: wanghao107): remove it and fix model
+        return cut_value_nodes | inputs
+
+    saved_values = _find_saved_values_by_min_cut(AGGRESSIVE_RECOMPUTATION)
+    # 1.6  fit the saved values into the memory budget. Recompute the
+    # expensive ops too if the cheap ones are not enough, and save back
+    # the values which are the most expensive to recompute per byte if
+    # there is memory left.
+    if memory_budget is not None:
+        saved_size = cal_saved_values_size(
+            program, saved_values, inputs, outputs, fwd_op_end_idx
+        )
+        if saved_size > memory_budget and not AGGRESSIVE_RECOMPUTATION:
+            saved_values = _find_saved_values_by_min_cut(True)
+        saved_values = select_saved_values_with_budget(
+            program,
+            saved_values,
+            inputs,
+            outputs,
+            fwd_op_end_idx,
+            backward_op_start_idx,
+            memory_budget,
+        )
     # 2.patition the joint graph by saved values.
     (
         program_after_recompute,
@@ -486,6 +520,11 @@ def partition_joint_graph(
         backward_op_start_idx,
     )
 
+    # 3. Remove the forward ops which are only recomputed for backward now
+    fwd_op_end_idx = eliminate_dead_forward_ops(
+        program, mid_hold_values, outputs, fwd_op_end_idx
+    )
+
     return program, fwd_op_end_idx
 
 
@@ -741,6 +780,141 @@ def analyze_mid_hold_values(
     return mid_hold_values
 
 
+def cal_saved_values_size(
+    program, saved_values, inputs, outputs, fwd_op_end_idx
+):
+    '''
+    Calculate the bytes of the forward values held by the backward graph.
+    The inputs and the outputs of the forward graph are not counted, they
+    are alive whether they are saved or not.
+    '''
+    forward_ops = set(program.global_block().ops[: fwd_op_end_idx + 1])
+    saved_size = 0
+    for value in saved_values:
+        if value in inputs or value in outputs:
+            continue
+        if value.get_defining_op() in forward_ops:
+            saved_size += cal_value_node_size(value)
+    return saved_size
+
+
+def cal_op_recompute_cost(op):
+    if op.name() in ["builtin.combine", "builtin.split"]:
+        return 0
+    cost = sum(cal_value_node_size(result) for result in op.results())
+    for op_input in op.operands_source():
+        if op_input.initialized():
+            cost += cal_value_node_size(op_input)
+    if op.name() in COMPUTE_INTENSIVE_OPS:
+        cost *= COMPUTE_INTENSIVE_COST_FACTOR
+    return cost
+
+
+def estimate_recompute_cost(value_node, saved_values):
+    '''
+    Estimate the cost to recompute the value from the saved values, that is
+    the sum of the costs of the forward ops between them.
+    '''
+    visited_ops = set()
+    cost = 0
+    stack = [value_node]
+    while len(stack) > 0:
+        value = stack.pop()
+        if value in saved_values or not value.initialized():
+            continue
+        define_op = value.get_defining_op()
+        if define_op is None or define_op in visited_ops:
+            continue
+        visited_ops.add(define_op)
+        cost += cal_op_recompute_cost(define_op)
+        stack.extend(define_op.operands_source())
+    return cost
+
+
+def select_saved_values_with_budget(
+    program,
+    saved_values,
+    inputs,
+    outputs,
+    fwd_op_end_idx,
+    backward_op_start_idx,
+    memory_budget,
+):
+    '''
+    Save the values which would be recomputed for the backward graph while
+    they fit into the memory budget, the ones with the highest recompute
+    cost per byte first. The costs are estimated once from the saved values
+    of the min-cut.
+    '''
+    saved_values = backward_utils.ValueSet(saved_values)
+    free_size = memory_budget - cal_saved_values_size(
+        program, saved_values, inputs, outputs, fwd_op_end_idx
+    )
+    if free_size <= 0:
+        return saved_values
+    mid_hold_values = analyze_mid_hold_values(
+        program,
+        saved_values,
+        inputs,
+        outputs,
+        fwd_op_end_idx,
+        backward_op_start_idx,
+    )
+    forward_ops = program.global_block().ops[: fwd_op_end_idx + 1]
+    op_index = {op: idx for idx, op in enumerate(forward_ops)}
+    candidates = []
+    for value in mid_hold_values:
+        if is_dynamic_value_node(value):
+            continue
+        size = cal_value_node_size(value)
+        if size == 0 or size > free_size:
+            continue
+        cost = estimate_recompute_cost(value, saved_values)
+        candidates.append(
+            (cost / size, op_index[value.get_defining_op()], size, value)
+        )
+    # keep the order of the program for the values of the same cost
+    candidates.sort(key=lambda candidate: (-candidate[0], candidate[1]))
+    for _, _, size, value in candidates:
+        if size <= free_size:
+            saved_values.add(value)
+            free_size -= size
+    return saved_values
+
+
+def eliminate_dead_forward_ops(program, mid_values, outputs, fwd_op_end_idx):
+    '''
+    Remove the forward ops whose results were only held for the backward
+    graph and are recomputed there now.
+    '''
+    pure_ops = set(DEFAULT_RECOMPUTABLE_OPS + COMPUTE_INTENSIVE_OPS)
+    block = program.global_block()
+    forward_ops = set(block.ops[: fwd_op_end_idx + 1])
+    dead_op_candidates = [value.get_defining_op() for value in mid_values]
+    removed_ops = set()
+    while len(dead_op_candidates) > 0:
+        op = dead_op_candidates.pop()
+        if (
+            op in removed_ops
+            or op not in forward_ops
+            or op.name() not in pure_ops
+        ):
+            continue
+        if any(
+            not result.use_empty() or result in outputs
+            for result in op.results()
+        ):
+            continue
+        op_inputs = op.operands_source()
+        block.remove_op(op)
+        removed_ops.add(op)
+        fwd_op_end_idx -= 1
+        for op_input in op_inputs:
+            if op_input.initialized():
+                dead_op_candidates.append(op_input.get_defining_op())
+    return fwd_op_end_idx
+
+
 def clone_graph(program, origin_ops, graph_inputs, clone_insertion_op):
     pir.set_insertion_point(clone_insertion_op)
     all_ops = program.global_block().ops
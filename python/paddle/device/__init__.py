@@ -18,7 +18,7 @@ from __future__ import annotations
 import ctypes
 import os
 import re
-from typing import TYPE_CHECKING, Union
+from typing import TYPE_CHECKING, Any, Union
 
 import paddle
 from paddle.base import core, framework
@@ -35,9 +35,12 @@ from . import (  # noqa: F401
 )
 
 if TYPE_CHECKING:
+    from collections.abc import Sequence
     from types import TracebackType
 
-    from paddle import IPUPlace as _IPUPlace, XPUPlace as _XPUPlace
+    import numpy.typing as npt
+
+    from paddle import IPUPlace as _IPUPlace, Tensor, XPUPlace as _XPUPlace
     from paddle._typing.device_like import PlaceLike
 
     _InitStreamBase = Union[core.CUDAStream, core.CustomDeviceStream]
@@ -66,6 +69,8 @@ __all__ = [
     'set_stream',
     'stream_guard',
     'synchronize',
+    'HostCopyFuture',
+    'numpy_async',
 ]
 
 _cudnn_version = None
@@ -1062,3 +1067,79 @@ def synchronize(device: PlaceLike | None = None) -> None:
                 ",".join(paddle.device.get_all_custom_device_type())
             )
         )
+
+
+class HostCopyFuture:
+    """
+
+    The handle of the tensors being copied to the host by
+    ``paddle.device.numpy_async`` or ``Tensor.numpy_async()``, which
+    does not block the host until the result is read.
+
+    """
+
+    def __init__(self, tensors: list[Tensor], single: bool = False) -> None:
+        self._copy = core.AsyncHostCopy(tensors)
+        self._single = single
+
+    def done(self) -> bool:
+        """
+        Whether the copies are done, without blocking the host.
+        """
+        return self._copy.is_completed()
+
+    def wait(self) -> None:
+        """
+        Blocks the host until the copies are done.
+        """
+        self._copy.wait()
+
+    def result(self) -> npt.NDArray[Any] | list[npt.NDArray[Any]]:
+        """
+        The numpy arrays copied, which blocks the host until the copies are
+        done. It is one array for ``Tensor.numpy_async()``.
+        """
+        arrays = self._copy.numpy()
+        return arrays[0] if self._single else arrays
+
+    def item(self) -> Any:
+        """
+        The Python scalar of the only element copied, like ``Tensor.item()``.
+        """
+        arrays = self._copy.numpy()
+        if len(arrays) != 1 or arrays[0].size != 1:
+            raise ValueError(
+                "item() only supports copying one tensor with one element."
+            )
+        return arrays[0].item()
+
+
+def numpy_async(tensors: Sequence[Tensor]) -> HostCopyFuture:
+    """
+
+    Copies the tensors to the host without blocking it. The GPU tensors are
+    copied into one pinned buffer on a device to host stream, after the kernels
+    enqueued so far, so the host only waits when the result is read, e.g. the
+    metrics logged every N steps.
+
+    Args:
+        tensors(list[Tensor]): The DenseTensors to copy. The GPU tensors should
+            be on one device.
+
+    Returns:
+        HostCopyFuture, whose ``result()`` is the list of the numpy arrays.
+
+    Examples:
+        .. code-block:: python
+
+            >>> import paddle
+
+            >>> loss = paddle.to_tensor(1.5)
+            >>> acc = paddle.to_tensor([0.5, 0.75])
+            >>> future = paddle.device.numpy_async([loss, acc])
+            >>> loss_np, acc_np = future.result()
+            >>> print(loss_np, acc_np)
+            1.5 [0.5  0.75]
+
+    """
+    return HostCopyFuture(list(tensors))
@@ -66,6 +66,9 @@ class CUDAGraph:
     def reset(self):
         self._graph.reset()
 
+    def has_fixed_random_state(self):
+        return self._graph.has_fixed_random_state()
+
     def print_to_dot_files(self, dirname, flags=None):
         if not isinstance(dirname, (str, bytes)):
             dirname = dirname.name
@@ -78,6 +81,171 @@ class CUDAGraph:
         self._graph.print_to_dot_files(dirname, flags)
 
 
+class CUDAGraphTrainStep:
+    """
+    Captures a whole dygraph training step, i.e. the forward, backward and
+    optimizer ops run by step_fn, into one CUDA Graph with a private memory
+    pool, and replays the graph for the later steps.
+
+    The first warmup_steps calls run step_fn eagerly, so that the lazily
+    created states, e.g. the moments of the optimizer, are ready before the
+    capture. The next call copies the inputs into static inputs and captures
+    step_fn on them, and each later call copies its inputs into the static
+    inputs and replays the graph. The outputs of step_fn are returned as the
+    same tensors in all the replays, and are overwritten by the next replay.
+
+    A step is captured only once, so it must not:
+
+    - wait for the GPU on the host, e.g. Tensor.numpy(), Tensor.item() or the
+      dynamic loss scaling of GradScaler;
+    - run the ops whose output shapes depend on the input data, e.g. nonzero;
+    - run the random ops which do not update their offsets in each replay,
+      only dropout does.
+
+    The first two fail the capture with an error naming the wait, and the
+    last fails it after capture. The host side values read by step_fn, e.g.
+    the learning rate of a LRScheduler stepped outside of it, are fixed in
+    the graph as well.
+
+    Parameters:
+        step_fn (callable): A training step, which takes the input tensors.
+        warmup_steps (int): The number of steps run eagerly before the
+            capture. Default is 2.
+        place (CUDAPlace, optional): The place to capture on. Default is the
+            GPU selected by FLAGS_selected_gpus.
+        mode (str): The capture mode, one of "global", "thread_local" and
+            "relaxed". Default is "thread_local".
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> from paddle.device.cuda.graphs import CUDAGraphTrainStep
+
+            >>> model = paddle.nn.Linear(8, 8)
+            >>> opt = paddle.optimizer.SGD(parameters=model.parameters())
+
+            >>> def train_step(x):
+            ...     loss = model(x).mean()
+            ...     loss.backward()
+            ...     opt.step()
+            ...     opt.clear_grad(set_to_zero=True)
+            ...     return loss
+
+            >>> step = CUDAGraphTrainStep(train_step)
+            >>> for _ in range(10):
+            ...     loss = step(paddle.randn([4, 8]))
+    """
+
+    def __init__(
+        self, step_fn, warmup_steps=2, place=None, mode="thread_local"
+    ):
+        assert (
+            CoreCUDAGraph is not None
+        ), "CUDA Graph is only supported on PaddlePaddle compiled with NVIDIA GPU."
+        assert (
+            paddle.in_dynamic_mode()
+        ), "CUDAGraphTrainStep is only supported in dynamic graph mode."
+        if warmup_steps < 1:
+            raise ValueError(
+                f"warmup_steps should be at least 1, but got {warmup_steps}."
+            )
+        self._step_fn = step_fn
+        self._warmup_steps = warmup_steps
+        self._place = place
+        self._mode = mode
+        self._num_steps = 0
+        self._graph = None
+        self._static_inputs = None
+        self._static_outputs = None
+
+    def __call__(self, *inputs):
+        for x in inputs:
+            if not isinstance(x, paddle.Tensor):
+                raise TypeError(
+                    f"The inputs of CUDAGraphTrainStep should be Tensors, but got {type(x)}."
+                )
+        if self._num_steps < self._warmup_steps:
+            outputs = self._step_fn(*inputs)
+        else:
+            if self._graph is None:
+                self._capture(inputs)
+            else:
+                self._copy_inputs(inputs)
+            self._graph.replay()
+            outputs = self._static_outputs
+        self._num_steps += 1
+        return outputs
+
+    def is_captured(self):
+        return self._graph is not None
+
+    def reset(self):
+        if self._graph is not None:
+            self._graph.reset()
+        self._graph = None
+        self._static_inputs = None
+        self._static_outputs = None
+        self._num_steps = 0
+
+    def _capture(self, inputs):
+        static_inputs = []
+        with paddle.no_grad():
+            for x in inputs:
+                if x.place.is_gpu_place():
+                    static_x = x.clone()
+                else:
+                    static_x = x.cuda()
+                static_x.stop_gradient = x.stop_gradient
+                static_inputs.append(static_x)
+        paddle.device.synchronize()
+
+        graph = CUDAGraph(self._place, self._mode)
+        graph.capture_begin()
+        try:
+            outputs = self._step_fn(*static_inputs)
+        except Exception as e:
+            try:
+                graph.capture_end()
+                graph.reset()
+            except Exception:
+                # the capture is invalidated by the failed step
+                pass
+            raise RuntimeError(
+                "Failed to capture the training step into a CUDA Graph, "
+                "please make sure it does not wait for the GPU on the host "
+                "or depend on the data of the tensors."
+            ) from e
+        graph.capture_end()
+
+        if graph.has_fixed_random_state():
+            graph.reset()
+            raise RuntimeError(
+                "The training step captured runs the random ops which would "
+                "generate the same random numbers in each replay, e.g. "
+                "paddle.rand or paddle.randn. Please generate the random "
+                "tensors out of the step and pass them in as inputs."
+            )
+        self._graph = graph
+        self._static_inputs = static_inputs
+        self._static_outputs = outputs
+
+    def _copy_inputs(self, inputs):
+        if len(inputs) != len(self._static_inputs):
+            raise ValueError(
+                f"The training step is captured with {len(self._static_inputs)} inputs, but got {len(inputs)}."
+            )
+        for i, (x, static_x) in enumerate(zip(inputs, self._static_inputs)):
+            if x.shape != static_x.shape or x.dtype != static_x.dtype:
+                raise ValueError(
+                    f"The training step is captured with the input {i} of "
+                    f"shape {static_x.shape} and dtype {static_x.dtype}, but "
+                    f"got shape {x.shape} and dtype {x.dtype}."
+                )
+            static_x.copy_(x, False)
+
+
 def wrap_cuda_graph(function, mode="thread_local", memory_pool="default"):
     assert mode in ALL_MODES
     if not paddle.in_dynamic_mode():
@@ -0,0 +1,495 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import itertools
+import logging
+import math
+
+from paddle.base import core
+from paddle.pir.core import datatype_to_vartype
+
+from ...utils.log_utils import get_logger
+from ..placement_type import to_placements
+from .dist_attribute import DistTensorSpec, TensorDistAttr
+
+_logger = get_logger(logging.INFO)
+
+# The pir ops whose SPMD rules are used in propagation, with the rule name,
+# the number of tensor operands passed to the rule and the attributes passed
+# after them. The other ops gather their operands to replicated.
+_ELEMENTWISE_UNARY_OPS = [
+    "relu",
+    "gelu",
+    "silu",
+    "swish",
+    "tanh",
+    "sigmoid",
+    "exp",
+    "sqrt",
+    "rsqrt",
+    "square",
+    "scale",
+    "dropout",
+    "cast",
+    "assign",
+]
+_ELEMENTWISE_BINARY_OPS = [
+    "add",
+    "subtract",
+    "multiply",
+    "divide",
+    "maximum",
+    "minimum",
+]
+_SPMD_RULE_ARGS = {
+    "matmul": ("matmul", 2, ["transpose_x", "transpose_y"]),
+    "softmax": ("softmax", 1, ["axis"]),
+    "log_softmax": ("log_softmax", 1, ["axis"]),
+    "layer_norm": ("layer_norm", 3, ["epsilon", "begin_norm_axis"]),
+    "transpose": ("transpose", 1, ["perm"]),
+    "embedding": ("embedding", 2, ["padding_idx", "sparse"]),
+}
+for _op in _ELEMENTWISE_UNARY_OPS:
+    _SPMD_RULE_ARGS[_op] = ("elementwise_unary", 1, [])
+for _op in _ELEMENTWISE_BINARY_OPS:
+    _SPMD_RULE_ARGS[_op] = (_op, 2, [])
+
+# The ops which define the values searched by the planner.
+_PARAMETER_OP = "builtin.parameter"
+_DATA_OP = "pd_op.data"
+_SKIPPED_OPS = [
+    "builtin.combine",
+    "builtin.split",
+    "pd_op.full",
+    "pd_op.full_int_array",
+    "pd_op.fetch",
+]
+
+
+def _is_tensor(value):
+    return value.initialized() and value.is_dense_tensor_type()
+
+
+def _dtype_bytes(dtype):
+    try:
+        return core.size_of_dtype(datatype_to_vartype[dtype])
+    except (KeyError, TypeError, ValueError):
+        return 4
+
+
+class SpmdCostModel:
+    """
+    The analytical cost, in seconds, of the computation, communication and
+    memory of a program distributed on a process mesh.
+
+    Args:
+        process_mesh(ProcessMesh): The mesh which the program is distributed on.
+        gflops(float): The dense computation throughput of a device.
+        memory_bandwidth(float): The memory bandwidth of a device in GB/s,
+            which bounds the ops without a matmul.
+        comm_bandwidth(float|list[float]): The bandwidth in GB/s of the
+            collectives along each dim of the mesh.
+        comm_latency(float): The latency of a collective in seconds.
+        memory_limit(float, optional): The memory of a device in bytes. The
+            plans which need more are infeasible. Default: None.
+        optimizer_state_factor(int): The optimizer states of a parameter in
+            times of its size, 2 for Adam.
+    """
+
+    def __init__(
+        self,
+        process_mesh,
+        gflops=100000.0,
+        memory_bandwidth=1500.0,
+        comm_bandwidth=100.0,
+        comm_latency=1e-5,
+        memory_limit=None,
+        optimizer_state_factor=2,
+    ):
+        self.mesh_shape = list(process_mesh.shape)
+        self.gflops = gflops
+        self.memory_bandwidth = memory_bandwidth
+        if not isinstance(comm_bandwidth, (list, tuple)):
+            comm_bandwidth = [comm_bandwidth] * len(self.mesh_shape)
+        assert len(comm_bandwidth) == len(
+            self.mesh_shape
+        ), "comm_bandwidth should have a value for every dim of the mesh."
+        self.comm_bandwidth = list(comm_bandwidth)
+        self.comm_latency = comm_latency
+        self.memory_limit = memory_limit
+        self.optimizer_state_factor = optimizer_state_factor
+
+    def local_numel(self, shape, dims_mapping):
+        numel = 1
+        for size, mesh_dim in zip(shape, dims_mapping):
+            if mesh_dim >= 0:
+                size = math.ceil(size / self.mesh_shape[mesh_dim])
+            numel *= size
+        return numel
+
+    def comm_time(self, kind, nbytes, mesh_dim):
+        """The ring time of a collective of nbytes per device."""
+        n = self.mesh_shape[mesh_dim]
+        if n <= 1 or nbytes == 0:
+            return 0.0
+        factor = {
+            "all_reduce": 2.0 * (n - 1) / n,
+            "all_gather": float(n - 1),
+            "reduce_scatter": (n - 1) / n,
+            "all_to_all": (n - 1) / n,
+        }[kind]
+        seconds = nbytes * factor / (self.comm_bandwidth[mesh_dim] * 1e9)
+        return self.comm_latency + seconds
+
+    def reshard_time(self, src, dst, shape, dtype_bytes):
+        """
+        The time to reshard a tensor from the placement src to dst, which
+        are tuples of (dims_mapping, partial_dims).
+        """
+        src_mapping, src_partial = src
+        dst_mapping, dst_partial = dst
+        nbytes = self.local_numel(shape, src_mapping) * dtype_bytes
+        seconds = 0.0
+        for mesh_dim in src_partial:
+            if mesh_dim in dst_partial:
+                continue
+            if mesh_dim in dst_mapping:
+                seconds += self.comm_time("reduce_scatter", nbytes, mesh_dim)
+            else:
+                seconds += self.comm_time("all_reduce", nbytes, mesh_dim)
+        for tensor_dim, mesh_dim in enumerate(src_mapping):
+            if mesh_dim < 0 or dst_mapping[tensor_dim] == mesh_dim:
+                continue
+            if mesh_dim in dst_mapping:
+                seconds += self.comm_time("all_to_all", nbytes, mesh_dim)
+            else:
+                seconds += self.comm_time("all_gather", nbytes, mesh_dim)
+                nbytes *= self.mesh_shape[mesh_dim]
+        # slicing a replicated tensor, or a partial one, is local
+        return seconds
+
+    def parallel_degree(self, placement):
+        dims_mapping, partial_dims = placement
+        mesh_dims = {d for d in dims_mapping if d >= 0} | set(partial_dims)
+        return math.prod(self.mesh_shape[d] for d in mesh_dims)
+
+    def compute_time(self, flops, nbytes, degree):
+        """The roofline time of an op which runs on degree shards."""
+        return max(
+            flops / (self.gflops * 1e9), nbytes / (self.memory_bandwidth * 1e9)
+        ) / max(degree, 1)
+
+
+class SpmdPlan:
+    """
+    The dist attrs chosen by SpmdPlanner for the parameters and the data of a
+    program, by their names, and the estimated cost of a step with them.
+    """
+
+    def __init__(self, process_mesh, dims_mappings, cost):
+        self.process_mesh = process_mesh
+        self.dims_mappings = dims_mappings
+        self.cost = cost
+
+    def dist_attr(self, name):
+        dist_attr = TensorDistAttr()
+        dist_attr.process_mesh = self.process_mesh
+        dist_attr.dims_mapping = list(self.dims_mappings[name])
+        return dist_attr
+
+    def placements(self, name):
+        """The placements of the value for paddle.distributed.shard_tensor."""
+        return to_placements(list(self.dims_mappings[name]), self.process_mesh)
+
+    def __str__(self):
+        lines = [f"SpmdPlan on mesh {list(self.process_mesh.shape)}:"]
+        for name, dims_mapping in self.dims_mappings.items():
+            lines.append(f"  {name}: {list(dims_mapping)}")
+        lines.append(
+            "  cost: "
+            + ", ".join(f"{k}={v:.6g}" for k, v in self.cost.items())
+        )
+        return "\n".join(lines)
+
+
+class SpmdPlanner:
+    """
+    Searches the placements of the parameters and the data of a dense pir
+    program on a process mesh. The placements of all the other values are
+    propagated through the ops by the SPMD rules, and every plan is scored by
+    SpmdCostModel by the computation, the reshards the rules ask for, the
+    synchronization of the gradients and the memory of a training step.
+
+    The search is a coordinate descent from the replicated plan: every value
+    in turn takes its best placement with the others fixed, until no value
+    changes or max_rounds.
+
+    Args:
+        program(pir.Program): The dense program to plan.
+        process_mesh(ProcessMesh): The mesh to distribute the program on.
+        cost_model(SpmdCostModel, optional): Default: the one of the mesh with
+            its default hardware.
+        dynamic_dim_size(int): The size of the dynamic dims, as the batch
+            dim, in the cost model.
+        max_rounds(int): The rounds of the coordinate descent.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +SKIP('requires a pir program')
+            >>> planner = SpmdPlanner(main_program, mesh)
+            >>> plan = planner.plan()
+            >>> w = dist.shard_tensor(w, mesh, plan.placements(w.name))
+    """
+
+    def __init__(
+        self,
+        program,
+        process_mesh,
+        cost_model=None,
+        dynamic_dim_size=1,
+        max_rounds=4,
+    ):
+        self._program = program
+        self._mesh = process_mesh
+        self._mesh_shape = list(process_mesh.shape)
+        self._cost_model = cost_model or SpmdCostModel(process_mesh)
+        self._dynamic_dim_size = dynamic_dim_size
+        self._max_rounds = max_rounds
+        self._rules = {}
+        self._ops = list(program.global_block().ops)
+        # name -> value of the searched values
+        self._searched = {}
+        self._parameters = set()
+        for op in self._ops:
+            if op.name() == _PARAMETER_OP:
+                name = op.str_attr("parameter_name")
+                self._parameters.add(name)
+            elif op.name() == _DATA_OP:
+                name = op.str_attr("name")
+            else:
+                continue
+            self._searched[name] = op.result(0)
+
+    def _shape(self, value):
+        return [
+            self._dynamic_dim_size if size < 0 else size
+            for size in value.shape
+        ]
+
+    def _rule(self, name):
+        if name not in self._rules:
+            self._rules[name] = core.get_phi_spmd_rule(name)
+        return self._rules[name]
+
+    def _candidates(self, value):
+        """The placements to try for a searched value, replicated first."""
+        shape = self._shape(value)
+        shardable = [
+            (tensor_dim, mesh_dim)
+            for tensor_dim, mesh_dim in itertools.product(
+                range(len(shape)), range(len(self._mesh_shape))
+            )
+            if self._mesh_shape[mesh_dim] > 1
+            and shape[tensor_dim] % self._mesh_shape[mesh_dim] == 0
+        ]
+        candidates = [tuple([-1] * len(shape))]
+        for num in range(1, len(self._mesh_shape) + 1):
+            for shards in itertools.combinations(shardable, num):
+                tensor_dims = [s[0] for s in shards]
+                mesh_dims = [s[1] for s in shards]
+                if len(set(tensor_dims)) < num or len(set(mesh_dims)) < num:
+                    continue
+                dims_mapping = [-1] * len(shape)
+                for tensor_dim, mesh_dim in shards:
+                    dims_mapping[tensor_dim] = mesh_dim
+                candidates.append(tuple(dims_mapping))
+        return candidates
+
+    def _spec(self, value, placement):
+        dist_attr = TensorDistAttr()
+        dist_attr.process_mesh = self._mesh
+        dist_attr.dims_mapping = list(placement[0])
+        if placement[1]:
+            dist_attr._set_partial_dims(sorted(placement[1]))
+        return DistTensorSpec(self._shape(value), dist_attr)
+
+    @staticmethod
+    def _placement(dist_attr):
+        return (
+            tuple(dist_attr.dims_mapping),
+            frozenset(dist_attr._partial_dims()),
+        )
+
+    def _infer(self, op, placements):
+        """
+        The placements the op wants for its operands and gives its results,
+        by the SPMD rule of the op, or replicated for the ops without one.
+        """
+        op_name = op.name().split(".")[-1]
+        operands = op.operands_source()
+        results = [v for v in op.results() if _is_tensor(v)]
+        rule_args = _SPMD_RULE_ARGS.get(op_name)
+        if rule_args is not None and all(
+            _is_tensor(v) and v.id in placements
+            for v in operands[: rule_args[1]]
+        ):
+            rule_name, num_operands, attr_names = rule_args
+            attrs = op.attrs()
+            try:
+                specs = [
+                    self._spec(v, placements[v.id])
+                    for v in operands[:num_operands]
+                ]
+                inputs, outputs = self._rule(rule_name).infer_forward(
+                    *specs, *[attrs[name] for name in attr_names]
+                )
+                return (
+                    list(zip(operands, map(self._placement, inputs))),
+                    list(zip(results, map(self._placement, outputs))),
+                )
+            except Exception as e:
+                _logger.debug(f"Fall back to replicated for {op_name}: {e}")
+        replicated = [
+            (v, (tuple([-1] * len(v.shape)), frozenset()))
+            for v in operands
+            if _is_tensor(v) and v.id in placements
+        ]
+        return replicated, [
+            (v, (tuple([-1] * len(v.shape)), frozenset())) for v in results
+        ]
+
+    def evaluate(self, dims_mappings):
+        """The cost breakdown in seconds of the plan of the searched values."""
+        model = self._cost_model
+        placements = {
+            self._searched[name].id: (tuple(dims_mapping), frozenset())
+            for name, dims_mapping in dims_mappings.items()
+        }
+        compute = comm = grad_sync = 0.0
+        memory = 0
+        for name, dims_mapping in dims_mappings.items():
+            value = self._searched[name]
+            nbytes = model.local_numel(
+                self._shape(value), dims_mapping
+            ) * _dtype_bytes(value.dtype)
+            if name in self._parameters:
+                memory += nbytes * (2 + model.optimizer_state_factor)
+            else:
+                memory += nbytes
+        parameter_ids = {self._searched[name].id for name in self._parameters}
+
+        for op in self._ops:
+            if op.name() in (_PARAMETER_OP, _DATA_OP, *_SKIPPED_OPS):
+                continue
+            inputs, outputs = self._infer(op, placements)
+            for value, placement in inputs:
+                src = placements[value.id]
+                if src != placement:
+                    comm += model.reshard_time(
+                        src,
+                        placement,
+                        self._shape(value),
+                        _dtype_bytes(value.dtype),
+                    )
+            degree = max(
+                [model.parallel_degree(p) for _, p in outputs] or [1]
+            )
+            flops, nbytes = self._flops_and_bytes(op, inputs, outputs)
+            compute += model.compute_time(flops, nbytes, degree)
+            for value, placement in outputs:
+                placements[value.id] = placement
+                # the activations are kept for the backward
+                memory += model.local_numel(
+                    self._shape(value), placement[0]
+                ) * _dtype_bytes(value.dtype)
+            # the gradient of a parameter replicated on a mesh dim the op runs
+            # in parallel on is partial there, and is reduced
+            for value, placement in inputs:
+                if value.id not in parameter_ids:
+                    continue
+                nbytes = model.local_numel(
+                    self._shape(value), placement[0]
+                ) * _dtype_bytes(value.dtype)
+                parallel_dims = set()
+                for _, out_placement in outputs:
+                    parallel_dims |= {d for d in out_placement[0] if d >= 0}
+                for mesh_dim in parallel_dims - set(placement[0]):
+                    grad_sync += model.comm_time("all_reduce", nbytes, mesh_dim)
+
+        # the backward computes about twice the forward, and mirrors its
+        # reshards
+        total = 3 * compute + 2 * comm + grad_sync
+        if model.memory_limit is not None and memory > model.memory_limit:
+            total = float("inf")
+        return {
+            "total": total,
+            "compute": 3 * compute,
+            "comm": 2 * comm,
+            "grad_sync": grad_sync,
+            "memory": memory,
+        }
+
+    def _flops_and_bytes(self, op, inputs, outputs):
+        """The global flops and bytes moved of an op."""
+        nbytes = sum(
+            math.prod(self._shape(v)) * _dtype_bytes(v.dtype)
+            for v, _ in inputs + outputs
+        )
+        if op.name() == "pd_op.matmul" and len(inputs) == 2 and outputs:
+            x = self._shape(inputs[0][0])
+            transpose_x = op.attrs().get("transpose_x", False)
+            k = x[-2] if transpose_x and len(x) > 1 else x[-1]
+            return 2 * math.prod(self._shape(outputs[0][0])) * k, nbytes
+        numel = sum(math.prod(self._shape(v)) for v, _ in outputs)
+        return numel, nbytes
+
+    @staticmethod
+    def _better(cost, best):
+        # the plans over the memory limit are ranked by their memory, so the
+        # search walks out of them
+        if cost["total"] == best["total"] == float("inf"):
+            return cost["memory"] < best["memory"]
+        return cost["total"] < best["total"]
+
+    def plan(self):
+        """Searches the placements, and returns the best SpmdPlan."""
+        dims_mappings = {
+            name: tuple([-1] * len(value.shape))
+            for name, value in self._searched.items()
+        }
+        best = self.evaluate(dims_mappings)
+        candidates = {
+            name: self._candidates(value)
+            for name, value in self._searched.items()
+        }
+        for round_id in range(self._max_rounds):
+            changed = False
+            for name in self._searched:
+                for dims_mapping in candidates[name]:
+                    if dims_mapping == dims_mappings[name]:
+                        continue
+                    trial = dict(dims_mappings)
+                    trial[name] = dims_mapping
+                    cost = self.evaluate(trial)
+                    if self._better(cost, best):
+                        best = cost
+                        dims_mappings = trial
+                        changed = True
+            _logger.debug(
+                f"SpmdPlanner round {round_id}, cost: {best['total']:.6g}"
+            )
+            if not changed:
+                break
+        return SpmdPlan(self._mesh, dims_mappings, best)
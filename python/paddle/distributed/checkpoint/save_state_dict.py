@@ -13,10 +13,13 @@
 # limitations under the License.
 
 import os
+import threading
+from concurrent.futures import ThreadPoolExecutor
 
 import paddle
 from paddle.distributed.communication.group import is_initialized
 from paddle.distributed.fleet.utils.log_util import logger
+from paddle.framework import core
 
 from .metadata import LocalTensorIndex, LocalTensorMetadata, Metadata
 from .utils import (
@@ -91,12 +94,128 @@ def dedup_tensor(
             local_state_dict.pop(tensor_index.tensor_key)
 
 
+def get_data_file_name(rank, unique_id, shard_id, num_shards):
+    if num_shards == 1:
+        return f"{rank}_{unique_id}.distcp"
+    return f"{rank}_{unique_id}_{shard_id}.distcp"
+
+
+def assign_shards(local_state_dict, num_shards):
+    """
+    Assign the local tensors to num_shards files of balanced sizes, the
+    largest tensor first to the smallest file.
+    """
+    sizes = {
+        key: val._numel() * val.element_size()
+        for key, val in local_state_dict.items()
+    }
+    shard_sizes = [0] * num_shards
+    shard_ids = {}
+    for key in sorted(sizes.keys(), key=lambda key: -sizes[key]):
+        shard_id = shard_sizes.index(min(shard_sizes))
+        shard_sizes[shard_id] += sizes[key]
+        shard_ids[key] = shard_id
+    return shard_ids
+
+
+class AsyncSaveHandle:
+    """
+    The handle of the state_dict being saved by
+    ``save_state_dict(..., async_save=True)``.
+    """
+
+    def __init__(self, futures):
+        self._futures = futures
+
+    def done(self):
+        """
+        Whether the files of current rank are all written, without blocking.
+        """
+        return all(future.done() for future in self._futures)
+
+    def wait(self):
+        """
+        Blocks until the files of current rank are all written, and raises
+        the error of writing them if any.
+        """
+        for future in self._futures:
+            future.result()
+
+
+_async_save_lock = threading.Lock()
+_async_save_executor = None
+_async_save_executor_workers = 0
+_pending_async_save = None
+
+
+def get_async_save_executor(num_workers):
+    global _async_save_executor, _async_save_executor_workers
+    if _async_save_executor_workers < num_workers:
+        if _async_save_executor is not None:
+            _async_save_executor.shutdown(wait=True)
+        _async_save_executor = ThreadPoolExecutor(
+            max_workers=num_workers, thread_name_prefix="async_save"
+        )
+        _async_save_executor_workers = num_workers
+    return _async_save_executor
+
+
+def write_shard(host_copy, keys, names, file_path):
+    arrays = host_copy.numpy()
+    # The same layout as paddle.save of a dict of tensors.
+    save_dict = dict(zip(keys, arrays))
+    save_dict["StructuredToParameterName@@"] = dict(zip(keys, names))
+    # Written to a temporary file first, so that a file with the final name
+    # is always complete.
+    tmp_path = file_path + ".tmp"
+    paddle.save(save_dict, tmp_path)
+    os.replace(tmp_path, file_path)
+
+
+def write_metadata(metadata, file_path, shard_futures):
+    # The metadata is written once the data files of the coordinator are,
+    # since the checkpoint is found by it.
+    for future in shard_futures:
+        future.result()
+    tmp_path = file_path + ".tmp"
+    paddle.save(metadata, tmp_path)
+    os.replace(tmp_path, file_path)
+
+
+def async_save_shards(shards, metadata, metadata_path, num_shards):
+    """
+    Snapshot the shards to the pinned host memory and write them in the
+    background. The kernels updating the tensors later wait for the
+    snapshot on the device, so training continues at once.
+    """
+    executor = get_async_save_executor(max(num_shards, 1))
+    futures = []
+    for file_path, shard in shards.items():
+        keys = list(shard.keys())
+        host_copy = core.AsyncHostCopy(
+            [shard[key] for key in keys], guard_writes=True
+        )
+        names = [shard[key].name for key in keys]
+        futures.append(
+            executor.submit(write_shard, host_copy, keys, names, file_path)
+        )
+    if metadata is not None:
+        futures.append(
+            executor.submit(
+                write_metadata, metadata, metadata_path, list(futures)
+            )
+        )
+    return AsyncSaveHandle(futures)
+
+
 def save_state_dict(
     state_dict,
     path,
     process_group=None,
     coordinator_rank=0,
-) -> None:
+    async_save=False,
+    num_shards=1,
+):
     """
     Save the state_dict of model to path.
 
@@ -105,6 +224,11 @@ def save_state_dict(
         path(str): The directory to save state_dict.
         process_group(paddle.distributed.collective.Group): ProcessGroup to be used for cross-rank synchronization. Use the default process group which contains all cards.
         coordinator_rank(int): The rank used to save non distributed values. Rank0 is used by default.
+        async_save(bool): Whether to return right after the local tensors are snapshotted to the pinned host memory on a device to host stream, and write the files in background threads. False by default.
+        num_shards(int): The number of the files each rank writes its tensors to, in parallel when async_save is True. 1 by default.
+
+    Returns:
+        AsyncSaveHandle, the handle to wait for the files of current rank when async_save is True, otherwise None. The checkpoint can be loaded after the handles of all the ranks are waited for, and it can be loaded onto a different parallel layout by ``load_state_dict``. A new save waits for the previous asynchronous one.
 
     Examples:
         .. code-block:: python
@@ -117,13 +241,29 @@ def save_state_dict(
             >>> sharded_w1 = dist.shard_tensor(w1, mesh, [dist.Shard(0), dist.Replicate()])
             >>> state_dict = {"w1": sharded_w1}
             >>> dist.save_state_dict(state_dict, "./checkpoint")
+            >>> # save without stalling the training
+            >>> handle = dist.save_state_dict(
+            ...     state_dict, "./checkpoint", async_save=True, num_shards=4
+            ... )
+            >>> # train the next steps, then wait before the next save or exit
+            >>> handle.wait()
             >>> # doctest: -SKIP
 
     """
+    global _pending_async_save
+    with _async_save_lock:
+        if _pending_async_save is not None:
+            # Bounds the pinned host memory, and the files of a unique_id
+            # are checked only once they are written.
+            _pending_async_save.wait()
+            _pending_async_save = None
     with paddle.base.dygraph.guard():
         assert isinstance(
             state_dict, dict
         ), "The state_dict should be a dictionary."
+        assert (
+            isinstance(num_shards, int) and num_shards > 0
+        ), f"The num_shards should be a positive int, but got {num_shards}."
         flat_state_dict, mapping = flatten_state_dict(state_dict)
         if len(flat_state_dict) > 0:
             for val in flat_state_dict.values():
@@ -140,10 +280,11 @@ def save_state_dict(
             # Init the default global process group
             paddle.distributed.init_parallel_env()
 
+        rank = paddle.distributed.get_rank()
         unique_id = 0
         file_name = ""
         while True:
-            file_name = f"{paddle.distributed.get_rank()}_{unique_id}.distcp"
+            file_name = get_data_file_name(rank, unique_id, 0, num_shards)
             if not os.path.exists(os.path.join(path, file_name)):
                 break
             unique_id += 1
@@ -191,9 +332,12 @@ def save_state_dict(
                 local_state_dict_metadata[key] = LocalTensorMetadata(
                     global_offset, local_shape, local_tenosr_dtype
                 )
-                local_storage_metadata[
-                    LocalTensorIndex(key, tuple(global_offset))
-                ] = file_name
+
+        shard_ids = assign_shards(local_state_dict, num_shards)
+        for key, val in local_state_dict_metadata.items():
+            local_storage_metadata[
+                LocalTensorIndex(key, tuple(val.global_offset))
+            ] = get_data_file_name(rank, unique_id, shard_ids[key], num_shards)
 
         global_state_dict_metadata = []
         global_storage_metadata = []
@@ -220,11 +364,37 @@ def save_state_dict(
         )
         metadata.storage_metadata = dedup_key_in_dict(global_storage_metadata)
         metadata.flat_mapping = dedup_key_in_dict(global_flatten_mapping)
-        if coordinator_rank == paddle.distributed.get_rank():
+        metadata_path = os.path.join(path, f"{unique_id}.metadata")
+        is_coordinator = coordinator_rank == rank
+        if is_coordinator:
             logger.debug(f"metadata:{metadata}")
-            paddle.save(metadata, os.path.join(path, f"{unique_id}.metadata"))
+            if not async_save:
+                paddle.save(metadata, metadata_path)
         logger.debug(f"local_state_dict:{local_state_dict}")
         dedup_tensor(
             local_state_dict, local_storage_metadata, metadata.storage_metadata
         )
-        paddle.save(local_state_dict, os.path.join(path, file_name))
+        # All the files are written even if empty, since the first one marks
+        # the unique_id used.
+        shard_paths = [
+            os.path.join(
+                path, get_data_file_name(rank, unique_id, i, num_shards)
+            )
+            for i in range(num_shards)
+        ]
+        shards = {shard_path: {} for shard_path in shard_paths}
+        for key, val in local_state_dict.items():
+            shards[shard_paths[shard_ids[key]]][key] = val
+        if not async_save:
+            for shard_path, shard in shards.items():
+                paddle.save(shard, shard_path)
+            return None
+        handle = async_save_shards(
+            shards,
+            metadata if is_coordinator else None,
+            metadata_path,
+            num_shards,
+        )
+        with _async_save_lock:
+            _pending_async_save = handle
+        return handle
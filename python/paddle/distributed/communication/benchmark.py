@@ -0,0 +1,394 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""
+Benchmarks the collectives through the ProcessGroup of the current backend
+(NCCL, BKCL, Gloo or a custom device), so that the stream and event logic of
+the ProcessGroup is measured together with the communication library, e.g.
+
+    python -m paddle.distributed.launch --devices=0,1,2,3 \\
+        python/paddle/distributed/communication/benchmark.py --max_bytes=1G
+
+The sizes follow nccl-tests: the size of all_reduce, alltoall and send_recv
+is the buffer of each rank, the one of all_gather is its output and the one
+of reduce_scatter is its input. The bus bandwidth scales the algorithm
+bandwidth by 2(n-1)/n for all_reduce, (n-1)/n for all_gather, reduce_scatter
+and alltoall, and 1 for send_recv, which exchanges the buffers between rank
+pairs 2i and 2i+1.
+"""
+
+from __future__ import annotations
+
+import argparse
+import time
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+from paddle import framework
+from paddle.distributed.communication.group import _get_global_group
+from paddle.distributed.communication.reduce import ReduceOp
+
+__all__ = []
+
+COLLECTIVES = (
+    "all_reduce",
+    "all_gather",
+    "reduce_scatter",
+    "alltoall",
+    "send_recv",
+)
+
+
+def _synchronize():
+    if not isinstance(framework._current_expected_place(), paddle.CPUPlace):
+        paddle.device.synchronize()
+
+
+def _bus_factor(collective, nranks):
+    if collective == "all_reduce":
+        return 2.0 * (nranks - 1) / nranks
+    if collective == "send_recv":
+        return 1.0
+    return (nranks - 1) / nranks
+
+
+class _Collective:
+    def __init__(self, collective, numel, dtype, group, use_calc_stream):
+        self.collective = collective
+        self.group = group
+        self.nranks = group.nranks
+        self.rank = group.rank
+        self.use_calc_stream = use_calc_stream
+        value = float(self.rank + 1)
+        chunk = numel // self.nranks
+        if collective == "all_gather":
+            self.input = paddle.full([chunk], value, dtype)
+            self.output = paddle.empty([chunk * self.nranks], dtype)
+        elif collective == "reduce_scatter":
+            self.input = paddle.full([chunk * self.nranks], value, dtype)
+            self.output = paddle.empty([chunk], dtype)
+        else:
+            self.input = paddle.full([numel], value, dtype)
+            self.output = paddle.empty([numel], dtype)
+        # the last rank has no peer in an odd group
+        self.peer = self.rank ^ 1
+        self.idle = collective == "send_recv" and self.peer >= self.nranks
+
+    def run(self):
+        sync_op = self.use_calc_stream
+        kwargs = {
+            "group": self.group,
+            "sync_op": sync_op,
+            "use_calc_stream": self.use_calc_stream,
+        }
+        if self.collective == "all_reduce":
+            return [dist.stream.all_reduce(self.input, **kwargs)]
+        if self.collective == "all_gather":
+            return [dist.stream.all_gather(self.output, self.input, **kwargs)]
+        if self.collective == "reduce_scatter":
+            return [
+                dist.stream.reduce_scatter(self.output, self.input, **kwargs)
+            ]
+        if self.collective == "alltoall":
+            return [dist.stream.alltoall(self.output, self.input, **kwargs)]
+        if self.idle:
+            return []
+        peer = self.group.ranks[self.peer]
+        # the lower rank of a pair sends first, so they never both wait
+        if self.rank < self.peer:
+            send = dist.stream.send(self.input, peer, **kwargs)
+            return [send, dist.stream.recv(self.output, peer, **kwargs)]
+        recv = dist.stream.recv(self.output, peer, **kwargs)
+        return [recv, dist.stream.send(self.input, peer, **kwargs)]
+
+    def check(self):
+        for task in self.run():
+            if task is not None:
+                task.wait()
+        _synchronize()
+        nranks = self.nranks
+        if self.collective == "all_reduce":
+            actual = self.input.numpy()
+            expect = np.full_like(actual, nranks * (nranks + 1) / 2)
+        elif self.collective == "reduce_scatter":
+            actual = self.output.numpy()
+            expect = np.full_like(actual, nranks * (nranks + 1) / 2)
+        elif self.collective in ("all_gather", "alltoall"):
+            actual = self.output.numpy().reshape([nranks, -1])
+            expect = np.repeat(
+                np.arange(1, nranks + 1, dtype=actual.dtype)[:, None],
+                actual.shape[1],
+                axis=1,
+            )
+        elif self.idle:
+            return True
+        else:
+            actual = self.output.numpy()
+            expect = np.full_like(actual, self.peer + 1)
+        return np.allclose(actual.astype("float32"), expect.astype("float32"))
+
+
+def _sizes(min_bytes, max_bytes, step_factor):
+    if min_bytes <= 0 or step_factor <= 1:
+        raise ValueError(
+            "min_bytes should be positive and step_factor larger than 1, "
+            f"but received {min_bytes} and {step_factor}."
+        )
+    sizes = []
+    size = min_bytes
+    while size <= max_bytes:
+        sizes.append(size)
+        size *= step_factor
+    return sizes
+
+
+def benchmark(
+    collectives=COLLECTIVES,
+    min_bytes=1024,
+    max_bytes=64 * 1024 * 1024,
+    step_factor=2,
+    dtype="float32",
+    warmup=5,
+    iters=20,
+    group=None,
+    use_calc_stream=False,
+    check=True,
+    verbose=True,
+):
+    """
+    Sweeps the message sizes of the collectives over the ProcessGroup of
+    ``group`` and measures the time of ``iters`` launches after ``warmup``
+    ones. The launches are asynchronous unless ``use_calc_stream`` is set,
+    and the tasks are waited after the last one, so the time covers the
+    streams and events of the ProcessGroup. The time of a size is the
+    slowest of the ranks.
+
+    Args:
+        collectives (list[str], optional): Some of all_reduce, all_gather,
+            reduce_scatter, alltoall and send_recv.
+        min_bytes (int, optional): The smallest message size in bytes.
+        max_bytes (int, optional): The largest message size in bytes.
+        step_factor (int, optional): The factor between the sizes.
+        dtype (str, optional): The data type of the messages.
+        warmup (int, optional): The untimed launches of each size.
+        iters (int, optional): The timed launches of each size.
+        group (Group, optional): The group to benchmark, the global group
+            by default.
+        use_calc_stream (bool, optional): Run the collectives synchronously
+            on the calculation stream.
+        check (bool, optional): Verify the result of each size before
+            timing it.
+        verbose (bool, optional): Print the results on the first rank.
+
+    Returns:
+        list[dict]: A result for each collective and size, with the keys
+        collective, bytes, time_us, algbw_gbps, busbw_gbps and correct,
+        where correct is None when the result was not checked.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env: DISTRIBUTED)
+            >>> import paddle.distributed as dist
+            >>> from paddle.distributed.communication.benchmark import benchmark
+
+            >>> dist.init_parallel_env()
+            >>> results = benchmark(["all_reduce"], max_bytes=1 << 20)
+    """
+    if not framework.in_dynamic_mode():
+        raise RuntimeError("The benchmark of the collectives runs in dygraph.")
+    for collective in collectives:
+        if collective not in COLLECTIVES:
+            raise ValueError(
+                f"Unsupported collective {collective}, expected one of "
+                f"{COLLECTIVES}."
+            )
+    group = _get_global_group() if group is None else group
+    nranks = group.nranks
+    itemsize = paddle.empty([1], dtype).element_size()
+
+    results = []
+    for collective in collectives:
+        if collective == "send_recv" and nranks < 2:
+            continue
+        for size in _sizes(min_bytes, max_bytes, step_factor):
+            numel = max(size // itemsize // nranks, 1) * nranks
+            op = _Collective(collective, numel, dtype, group, use_calc_stream)
+            correct = None
+            if check:
+                # a wrong result on any rank fails the size on all of them
+                flag = paddle.to_tensor([int(op.check())])
+                dist.all_reduce(flag, op=ReduceOp.MIN, group=group)
+                correct = bool(flag.item())
+            for _ in range(warmup):
+                op.run()
+            _synchronize()
+            dist.barrier(group)
+
+            start = time.perf_counter()
+            tasks = []
+            for _ in range(iters):
+                tasks += op.run()
+            for task in tasks:
+                if task is not None:
+                    task.wait()
+            _synchronize()
+            elapsed = paddle.to_tensor([time.perf_counter() - start])
+            dist.all_reduce(elapsed, op=ReduceOp.MAX, group=group)
+            seconds = float(elapsed.item()) / iters
+
+            nbytes = numel * itemsize
+            algbw = nbytes / seconds / 1e9
+            results.append(
+                {
+                    "collective": collective,
+                    "bytes": nbytes,
+                    "time_us": seconds * 1e6,
+                    "algbw_gbps": algbw,
+                    "busbw_gbps": algbw * _bus_factor(collective, nranks),
+                    "correct": correct,
+                }
+            )
+            if verbose and group.rank == 0:
+                print(_format(results[-1]), flush=True)
+    return results
+
+
+def _format(result):
+    correct = {True: "ok", False: "WRONG", None: "-"}[result["correct"]]
+    return (
+        f"{result['collective']:>15} {result['bytes']:>12} "
+        f"{result['time_us']:>12.2f} {result['algbw_gbps']:>10.2f} "
+        f"{result['busbw_gbps']:>10.2f} {correct:>6}"
+    )
+
+
+def health_check(
+    min_busbw_gbps=0.0,
+    collectives=("all_reduce", "all_gather", "reduce_scatter"),
+    max_bytes=16 * 1024 * 1024,
+    group=None,
+):
+    """
+    A quick run of :func:`benchmark` for the start of a job, which checks the
+    result of every size and the bus bandwidth of the largest one.
+
+    Args:
+        min_busbw_gbps (float, optional): The lowest bus bandwidth in GB/s
+            allowed at ``max_bytes``, 0 only checks the results.
+        collectives (list[str], optional): The collectives to check.
+        max_bytes (int, optional): The largest message size in bytes.
+        group (Group, optional): The group to check, the global group by
+            default.
+
+    Returns:
+        list[dict]: The results of :func:`benchmark`.
+
+    Raises:
+        RuntimeError: If a result is wrong or the bus bandwidth is too low.
+    """
+    results = benchmark(
+        collectives,
+        min_bytes=max_bytes // 64,
+        max_bytes=max_bytes,
+        step_factor=4,
+        warmup=2,
+        iters=5,
+        group=group,
+        verbose=False,
+    )
+    failures = [
+        f"{r['collective']} of {r['bytes']} bytes got a wrong result"
+        for r in results
+        if not r["correct"]
+    ]
+    largest = {}
+    for r in results:
+        largest[r["collective"]] = r
+    failures += [
+        f"{r['collective']} of {r['bytes']} bytes reached "
+        f"{r['busbw_gbps']:.2f} GB/s, below {min_busbw_gbps} GB/s"
+        for r in largest.values()
+        if r["busbw_gbps"] < min_busbw_gbps
+    ]
+    if failures:
+        raise RuntimeError(
+            f"The health check of the {dist.get_backend(group)} collectives "
+            "failed: " + "; ".join(failures)
+        )
+    return results
+
+
+def _parse_size(size):
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}
+    if size[-1].upper() in units:
+        return int(float(size[:-1]) * units[size[-1].upper()])
+    return int(size)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Benchmark the collectives of the ProcessGroup."
+    )
+    parser.add_argument(
+        "--collectives", default=",".join(COLLECTIVES), type=str
+    )
+    parser.add_argument("--min_bytes", default="1K", type=str)
+    parser.add_argument("--max_bytes", default="64M", type=str)
+    parser.add_argument("--step_factor", default=2, type=int)
+    parser.add_argument("--dtype", default="float32", type=str)
+    parser.add_argument("--warmup", default=5, type=int)
+    parser.add_argument("--iters", default=20, type=int)
+    parser.add_argument("--use_calc_stream", action="store_true")
+    parser.add_argument(
+        "--health_check",
+        default=None,
+        type=float,
+        help="Only run the health check with this lowest bus bandwidth.",
+    )
+    args = parser.parse_args()
+
+    dist.init_parallel_env()
+    group = _get_global_group()
+    if args.health_check is not None:
+        health_check(args.health_check, max_bytes=_parse_size(args.max_bytes))
+        if group.rank == 0:
+            print("The health check of the collectives passed.", flush=True)
+        return
+
+    if group.rank == 0:
+        print(
+            f"backend: {dist.get_backend()}, ranks: {group.nranks}, "
+            f"dtype: {args.dtype}"
+        )
+        print(
+            f"{'collective':>15} {'bytes':>12} {'time(us)':>12} "
+            f"{'algbw':>10} {'busbw':>10} {'check':>6}",
+            flush=True,
+        )
+    benchmark(
+        args.collectives.split(","),
+        min_bytes=_parse_size(args.min_bytes),
+        max_bytes=_parse_size(args.max_bytes),
+        step_factor=args.step_factor,
+        dtype=args.dtype,
+        warmup=args.warmup,
+        iters=args.iters,
+        use_calc_stream=args.use_calc_stream,
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -640,10 +640,13 @@ class DistributedStrategy:
             'sparse_save_filter_slots',
             'sparse_zero_init',
             'use_gpu_graph',
+            'sparse_embedx_storage_type',
+            'sparse_embedx_sgd_storage_type',
         ]
         support_sparse_table_class = [
             'DownpourSparseTable',
             'DownpourSparseSSDTable',
+            'DownpourSparseFlatTable',
         ]
         support_sparse_accessor_class = [
             'DownpourSparseValueAccessor',
@@ -781,10 +784,12 @@ class DistributedStrategy:
             )
             if table_class not in support_sparse_table_class:
                 raise ValueError(
-                    f"support sparse_table_class: ['DownpourSparseTable, DownpourSparseSSDTable'], but actual {table_class}"
+                    f"support sparse_table_class: ['DownpourSparseTable, DownpourSparseSSDTable, DownpourSparseFlatTable'], but actual {table_class}"
                 )
             if table_class == "DownpourSparseSSDTable":
                 table_data.table_class = 'SSDSparseTable'
+            elif table_class == "DownpourSparseFlatTable":
+                table_data.table_class = 'MemoryFlatSparseTable'
             else:
                 table_data.table_class = 'MemorySparseTable'
             table_data.shard_num = config.get('sparse_shard_num', 1000)
@@ -817,6 +822,42 @@ class DistributedStrategy:
             if not configs.get("use_cvm", True):
                 table_data.accessor.accessor_class = 'SparseAccessor'
 
+            storage_types = {
+                'fp32': 0,
+                'fp16': 1,
+                'bf16': 2,
+                'int8': 3,
+            }
+            embedx_storage_type = config.get(
+                'sparse_embedx_storage_type', 'fp32'
+            )
+            embedx_sgd_storage_type = config.get(
+                'sparse_embedx_sgd_storage_type', 'fp32'
+            )
+            if (
+                embedx_storage_type not in storage_types
+                or embedx_sgd_storage_type not in ['fp32', 'fp16', 'bf16']
+            ):
+                raise ValueError(
+                    f"support sparse_embedx_storage_type: {list(storage_types)} and sparse_embedx_sgd_storage_type: ['fp32', 'fp16', 'bf16'], but actual {embedx_storage_type} and {embedx_sgd_storage_type}"
+                )
+            if (
+                embedx_storage_type != 'fp32'
+                or embedx_sgd_storage_type != 'fp32'
+            ):
+                if table_data.accessor.accessor_class != 'CtrCommonAccessor':
+                    raise ValueError(
+                        f"the compressed embedx values are only supported by DownpourCtrAccessor and DownpourUnitAccessor, but actual {accessor_class}"
+                    )
+                table_data.accessor.accessor_class = 'CtrCompressedAccessor'
+                ctr_accessor_param = table_data.accessor.ctr_accessor_param
+                ctr_accessor_param.embedx_storage_type = storage_types[
+                    embedx_storage_type
+                ]
+                ctr_accessor_param.embedx_sgd_storage_type = storage_types[
+                    embedx_sgd_storage_type
+                ]
+
             table_data.accessor.embedx_dim = config.get('sparse_embedx_dim', 8)
             table_data.accessor.fea_dim = table_data.accessor.embedx_dim + 3
             table_data.accessor.embedx_threshold = config.get(
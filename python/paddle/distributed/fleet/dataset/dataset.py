@@ -376,6 +376,9 @@ class InMemoryDataset(DatasetBase):
         self.enable_pv_merge = False
         self.merge_by_lineid = False
         self.fleet_send_sleep_seconds = None
+        self.fleet_send_bytes_per_second = 0
+        self.streaming_shuffle = False
+        self.streaming_shuffle_fleet = None
 
     def _init_distributed_settings(self, **kwargs):
         """
@@ -676,6 +679,49 @@ class InMemoryDataset(DatasetBase):
         self.is_user_set_queue_num = True
         self.queue_num = queue_num
 
+    def _set_binary_format(self, binary_format):
+        """
+        Set if the files are the slot record blocks written by
+        _dump_into_binary, they are loaded without parsing. Only the
+        SlotRecordInMemoryDataFeed of use_ps_gpu supports it.
+
+        Args:
+            binary_format(bool): if the files are in the binary format or not
+
+        Examples:
+            .. code-block:: python
+
+                >>> import paddle
+                >>> paddle.enable_static()
+                >>> dataset = paddle.distributed.InMemoryDataset()
+                >>> dataset._set_binary_format(True)
+
+        """
+        self.proto_desc.binary_format = binary_format
+
+    def _dump_into_binary(self, path, file_num):
+        """
+        Dump the data in memory into file_num files under path in the binary
+        format, so that the later passes load them with _set_binary_format.
+        Only the SlotRecordInMemoryDataFeed of use_ps_gpu supports it.
+
+        Args:
+            path(str): the directory of the files, local or hdfs
+            file_num(int): the number of the files
+
+        Examples:
+            .. code-block:: python
+
+                >>> # doctest: +SKIP('No files to read')
+                >>> import paddle
+                >>> paddle.enable_static()
+                >>> dataset = paddle.distributed.InMemoryDataset()
+                >>> dataset.load_into_memory()
+                >>> dataset._dump_into_binary("./binary_data", 8)
+
+        """
+        self.dataset.dump_into_binary(path, file_num)
+
     def _set_parse_ins_id(self, parse_ins_id):
         """
         Set if Dataset need to parse insid
@@ -748,6 +794,73 @@ class InMemoryDataset(DatasetBase):
         """
         self.fleet_send_sleep_seconds = fleet_send_sleep_seconds
 
+    def _set_fleet_send_bytes_per_second(self, fleet_send_bytes_per_second=0):
+        """
+        Set the max bytes sent per second in global shuffle, default is 0,
+        which means no limit. The send threads share the limit.
+
+        Args:
+            fleet_send_bytes_per_second(int): max bytes sent per second
+
+        Examples:
+            .. code-block:: python
+
+                >>> import paddle
+                >>> paddle.enable_static()
+                >>> dataset = paddle.distributed.InMemoryDataset()
+                >>> dataset._set_fleet_send_bytes_per_second(100 * 1024 * 1024)
+
+        """
+        self.fleet_send_bytes_per_second = fleet_send_bytes_per_second
+
+    def _set_streaming_shuffle(self, streaming_shuffle, fleet=None):
+        """
+        Set if the records are sent to the other trainers while they are
+        being loaded by load_into_memory or preload_into_memory, default is
+        False. The records are released as soon as they are sent, so the
+        shuffle overlaps the loading and holds no second copy of the
+        dataset. global_shuffle should still be called after the loading,
+        it waits for the records of the other trainers.
+
+        Args:
+            streaming_shuffle(bool): if use streaming shuffle or not
+            fleet(Fleet): fleet singleton. Default None.
+
+        Examples:
+            .. code-block:: python
+
+                >>> import paddle
+                >>> paddle.enable_static()
+                >>> dataset = paddle.distributed.InMemoryDataset()
+                >>> dataset._set_streaming_shuffle(True)
+
+        """
+        self.streaming_shuffle = streaming_shuffle
+        self.streaming_shuffle_fleet = fleet
+
+    def _prepare_streaming_shuffle(self):
+        fleet = self.streaming_shuffle_fleet
+        self.dataset.set_streaming_shuffle(self.streaming_shuffle)
+        if not self.streaming_shuffle:
+            return
+        trainer_num = 1
+        if fleet is not None:
+            trainer_num = fleet.worker_num()
+        if self.fleet_send_batch_size is None:
+            self.fleet_send_batch_size = 1024
+        if self.fleet_send_sleep_seconds is None:
+            self.fleet_send_sleep_seconds = 0
+        self.dataset.register_client2client_msg_handler()
+        self.dataset.set_trainer_num(trainer_num)
+        self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
+        self.dataset.set_fleet_send_sleep_seconds(self.fleet_send_sleep_seconds)
+        self.dataset.set_fleet_send_bytes_per_second(
+            self.fleet_send_bytes_per_second
+        )
+        # the channels of all the trainers are created before any sending
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+
     def _set_merge_by_lineid(self, merge_size=2):
         """
         Set merge by line id, instances of same line id will be merged after
@@ -892,6 +1005,7 @@ class InMemoryDataset(DatasetBase):
         """
         self._prepare_to_run()
         if not self.use_ps_gpu:
+            self._prepare_streaming_shuffle()
             self.dataset.load_into_memory()
         elif core._is_compiled_with_heterps():
             self.psgpu.set_dataset(self.dataset)
@@ -937,6 +1051,7 @@ class InMemoryDataset(DatasetBase):
             thread_num = self.thread_num
         self.dataset.set_preload_thread_num(thread_num)
         self.dataset.create_preload_readers()
+        self._prepare_streaming_shuffle()
         self.dataset.preload_into_memory()
 
     def wait_preload_done(self):
@@ -1059,6 +1174,9 @@ class InMemoryDataset(DatasetBase):
         self.dataset.set_trainer_num(trainer_num)
         self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
         self.dataset.set_fleet_send_sleep_seconds(self.fleet_send_sleep_seconds)
+        self.dataset.set_fleet_send_bytes_per_second(
+            self.fleet_send_bytes_per_second
+        )
         if fleet is not None:
             fleet._role_maker.barrier_worker()
         self.dataset.global_shuffle(thread_num)
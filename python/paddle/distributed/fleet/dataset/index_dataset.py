@@ -63,6 +63,17 @@ class TreeIndex(Index):
     def get_children_codes(self, ancestor, level):
         return self._tree.get_children_codes(ancestor, level)
 
+    def beam_search(self, query_num, beam_size, topk, score_func):
+        """Searches the tree layer by layer for query_num queries in batch.
+
+        score_func(level, queries, node_ids) is called once for each level
+        with the candidates of all the queries, node_ids[i] being a child of
+        a node in the beam of the query queries[i], and returns their scores
+        as an array of the same length. It returns the ids and the scores of
+        the topk best leaves of each query.
+        """
+        return self._tree.beam_search(query_num, beam_size, topk, score_func)
+
     def get_travel_path(self, child, ancestor):
         res = []
         while child > ancestor:
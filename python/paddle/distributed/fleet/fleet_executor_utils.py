@@ -64,6 +64,7 @@ class TaskNode:
         self.vars_to_shape = vars_to_shape
         self.run_pre_steps = None
         self.run_at_offset = None
+        self.pipeline_stage = None
         self.node = None
         self.upstreams = []
         self.downstreams = []
@@ -103,6 +104,8 @@ class TaskNode:
                 self.node.set_run_pre_steps(self.run_pre_steps)
             if self.run_at_offset:
                 self.node.set_run_at_offset(self.run_at_offset)
+            if self.pipeline_stage:
+                self.node.set_pipeline_stage(*self.pipeline_stage)
             if self.cond_var_name:
                 self.node.set_cond_var_name(self.cond_var_name)
             if self.vars_to_shape:
@@ -140,6 +143,17 @@ class TaskNode:
         else:
             self.node.set_run_at_offset(offset)
 
+    def set_pipeline_stage(self, num_stages, stage, chunk=0):
+        """
+        Run the forward or backward task node in the interleaved 1F1B schedule
+        of the pipeline stage, every stage has the forward and backward task
+        nodes of its chunks (virtual stages) 0, 1, ...
+        """
+        if self.lazy_initialize:
+            self.pipeline_stage = (num_stages, stage, chunk)
+        else:
+            self.node.set_pipeline_stage(num_stages, stage, chunk)
+
     def add_upstream_task(
         self, upstream, buffer_size=2, depend_type=core.DependType.NORMAL
     ):
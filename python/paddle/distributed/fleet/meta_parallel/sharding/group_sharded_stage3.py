@@ -65,7 +65,8 @@ def _all_gather(tensor, buffer_size, group):
 
     assert group is not None
     if framework.in_dynamic_mode():
-        out = paddle.zeros([buffer_size], dtype=tensor.dtype)
+        # every element is written by the all_gather
+        out = paddle.empty([buffer_size], dtype=tensor.dtype)
         task = group.process_group.all_gather(tensor, out)
         return out, task
 
@@ -179,6 +180,9 @@ class GroupShardedStage3(nn.Layer):
         self._unslice_params = OrderedSet()  # param's numel <= segment_size
         self._unslice_params2align = {}  # {param.name: param's align}
         self._grad_storages = {}  # {param.dtype: GradStorage}
+        # {param.name: [(grad_slice, task)]}, the async reduce_scatter of the
+        # grads of the backward passes yet to be accumulated to bw_storage
+        self._reduce_scatter_tasks = {}
 
         assert not isinstance(
             optimizer, list
@@ -288,6 +292,8 @@ class GroupShardedStage3(nn.Layer):
                 param.fw_storage.main_grad = None
             else:
                 param.fw_storage.clear_gradient(False)
+            # the grads of a step which is not run are awaited and dropped
+            self._accumulate_grad_slices(param)
             param.bw_storage._clear()
             param.bw_storage = None
         # 2.Handle unslice param
@@ -653,6 +659,7 @@ class GroupShardedStage3(nn.Layer):
                 param, "fw_storage"
             ), f"Find {param.name} don't have fw_storage attribute"
 
+            self._accumulate_grad_slices(param)
             param.fw_storage = _TensorWrapper(param)
             if self.use_main_grad:
                 param.fw_storage.main_grad = param.bw_storage
@@ -746,34 +753,18 @@ class GroupShardedStage3(nn.Layer):
             ), "the param must be trainable for grad allreduced"
             if param.name in self._task_flow.full_grad.keys():
                 full_grad = self._task_flow.full_grad[param.name]
-                # Only support sync allreduce current rank's layer now
+                # The grad is reduce_scattered as soon as it is produced, the
+                # communication is overlapped with the rest of the backward.
+                # Each rank only receives its own slice.
                 full_grad.scale_(scale=self._world_size_scaling)
-                dist.all_reduce(tensor=full_grad, group=self._group)
-                if self._dp_group is not None and self._dp_group.nranks > 1:
-                    full_grad.scale_(scale=1.0 / self._dp_group.nranks)
-                    dist.all_reduce(tensor=full_grad, group=self._dp_group)
-
                 start, end = self._param2buffer[param.name][self._rank]
-                if param.bw_storage is None:
-                    param.bw_storage = (
-                        full_grad._slice(start, end).detach().clone()
-                    )
-                    if self._offload:
-                        param.bw_storage = _device2cpu(param.bw_storage, True)
-                else:
-                    if self._offload:
-                        cpu_grad = _device2cpu(
-                            full_grad._slice(start, end).detach().clone(), True
-                        )
-                        with device_guard():
-                            param.bw_storage = paddle.add(
-                                param.bw_storage, cpu_grad
-                            )
-                    else:
-                        param.bw_storage = paddle.add(
-                            param.bw_storage,
-                            full_grad._slice(start, end).detach().clone(),
-                        )
+                grad_slice = paddle.empty([end - start], dtype=full_grad.dtype)
+                task = dist.stream.reduce_scatter(
+                    grad_slice, full_grad, group=self._group, sync_op=False
+                )
+                self._reduce_scatter_tasks.setdefault(param.name, []).append(
+                    (grad_slice, task)
+                )
 
                 if self.use_main_grad:
                     param.main_grad = None
@@ -802,6 +793,28 @@ class GroupShardedStage3(nn.Layer):
 
         return allreduce_
 
+    @paddle.autograd.no_grad()
+    def _accumulate_grad_slices(self, param):
+        """
+        Wait for the reduce_scatter of the grads of the param, and accumulate
+        the slices to its bw_storage.
+        """
+        for grad_slice, task in self._reduce_scatter_tasks.pop(param.name, []):
+            task.wait()
+            if self._dp_group is not None and self._dp_group.nranks > 1:
+                grad_slice.scale_(scale=1.0 / self._dp_group.nranks)
+                dist.all_reduce(tensor=grad_slice, group=self._dp_group)
+
+            if self._offload:
+                grad_slice = _device2cpu(grad_slice, True)
+            if param.bw_storage is None:
+                param.bw_storage = grad_slice
+            elif self._offload:
+                with device_guard():
+                    param.bw_storage = paddle.add(param.bw_storage, grad_slice)
+            else:
+                param.bw_storage = paddle.add(param.bw_storage, grad_slice)
+
     def _param2align(self, param):
         # CUDA alignment 256 bytes
         size = param._numel() * align[param.dtype]
@@ -15,6 +15,7 @@
 import contextlib
 import copy
 import inspect
+import time
 import weakref
 
 import paddle
@@ -106,6 +107,230 @@ def switch_rng_state_tracker(rng_state, tracker):
         get_rng_state_tracker().set_states_tracker(orig_rng_tracker)
 
 
+# the scheduler the recompute segments of the current forward register with
+_recompute_scheduler = None
+
+
+class RecomputeScheduler:
+    """
+    Takes the recompute of the segments of a step off the critical path of the
+    backward. By default the backward of a segment re-runs its forward first,
+    and the backward waits for it. Under the scheduler, the recompute of the
+    previous segment, usually the next one in backward, starts on a secondary
+    stream while the backward of the current segment runs, and the checkpointed
+    inputs of the segments can be offloaded to the host in forward and copied
+    back right before their recompute.
+
+    The segments are the ones of ``recompute`` with ``use_reentrant=True``,
+    called in the forward under the scheduler. A prefetched segment holds its
+    activations until its backward, one segment more than without it.
+
+    Parameters:
+        prefetch(bool, optional): Whether to recompute the previous segment on
+            a secondary stream during the backward of a segment. It needs a
+            device with streams, the gpu or a custom device. Default: True.
+        offload(bool, optional): Whether to offload the tensor inputs of the
+            segments to the pinned host memory in forward. It needs a gpu.
+            Default: False.
+        report(bool, optional): Whether to measure the recompute time exposed
+            on the critical path of the backward. The streams are synchronized
+            around every recompute to measure it, so it is for profiling only.
+            Default: False.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> from paddle.distributed.fleet.recompute import (
+            ...     RecomputeScheduler,
+            ...     recompute,
+            ... )
+            >>> blocks = [paddle.nn.Linear(10, 10) for _ in range(4)]
+            >>> x = paddle.randn([8, 10])
+            >>> scheduler = RecomputeScheduler(prefetch=True, report=True)
+            >>> with scheduler:
+            ...     for block in blocks:
+            ...         x = recompute(block, x)
+            >>> x.mean().backward()
+            >>> print(scheduler.report()["segments"])
+            4
+    """
+
+    def __init__(self, prefetch=True, offload=False, report=False):
+        cur_device = paddle.get_device()
+        has_streams = 'gpu:' in cur_device or cur_device.split(':')[0] in (
+            paddle.device.get_all_custom_device_type() or []
+        )
+        if prefetch and not has_streams:
+            logger.warning(
+                f"[Recompute]: The prefetch needs a device with streams, "
+                f"the segments are recomputed in place on {cur_device}."
+            )
+            prefetch = False
+        if offload and 'gpu:' not in cur_device:
+            logger.warning(
+                f"[Recompute]: The offload needs a gpu, the inputs of the "
+                f"segments are kept on {cur_device}."
+            )
+            offload = False
+        self._stream = paddle.device.Stream() if prefetch else None
+        self._offload = offload
+        self._report = report
+        self._segments = []
+        self._stats = {}
+        self._prev_scheduler = None
+
+    def __enter__(self):
+        global _recompute_scheduler
+        self._prev_scheduler = _recompute_scheduler
+        _recompute_scheduler = self
+        # a new step
+        self._segments = []
+        self._stats = {
+            "segments": 0,
+            "prefetched": 0,
+            "offloaded": 0,
+            "exposed_recompute_ms": 0.0,
+        }
+        return self
+
+    def __exit__(self, *args):
+        global _recompute_scheduler
+        _recompute_scheduler = self._prev_scheduler
+        self._prev_scheduler = None
+
+    def report(self):
+        """
+        Returns the stats of the step: the numbers of the recomputed, the
+        prefetched and the offloaded segments, and with ``report=True``, the
+        milliseconds the backward waited for the recompute.
+        """
+        return dict(self._stats)
+
+    def _register(self, ctx, tensor_inputs):
+        ctx.recompute_scheduler = self
+        ctx.segment_index = len(self._segments)
+        ctx.offloaded = [False] * len(tensor_inputs)
+        ctx.prefetched = None
+        self._segments.append(ctx)
+        if not self._offload:
+            return tensor_inputs
+
+        saved_inputs = []
+        for i, tensor in enumerate(tensor_inputs):
+            # the parameters stay on the device anyway
+            if (
+                isinstance(tensor, core.eager.Tensor)
+                and not isinstance(tensor, EagerParamBase)
+                and tensor.place.is_gpu_place()
+            ):
+                host_tensor = tensor._copy_to(core.CUDAPinnedPlace(), False)
+                host_tensor.stop_gradient = tensor.stop_gradient
+                tensor = host_tensor
+                ctx.offloaded[i] = True
+            saved_inputs.append(tensor)
+        if any(ctx.offloaded):
+            self._stats["offloaded"] += 1
+        return saved_inputs
+
+    def _recompute(self, ctx):
+        if self._report:
+            paddle.device.current_stream().synchronize()
+            start = time.perf_counter()
+        if ctx.prefetched is not None:
+            result, event = ctx.prefetched
+            ctx.prefetched = None
+            if self._report:
+                event.synchronize()
+            paddle.device.current_stream().wait_event(event)
+        else:
+            result = _recompute_forward(ctx)
+        if self._report:
+            paddle.device.current_stream().synchronize()
+            self._stats["exposed_recompute_ms"] += (
+                time.perf_counter() - start
+            ) * 1000
+        self._stats["segments"] += 1
+        self._segments[ctx.segment_index] = None
+
+        prev_index = ctx.segment_index - 1
+        if self._stream is not None and prev_index >= 0:
+            prev_ctx = self._segments[prev_index]
+            if prev_ctx is not None and prev_ctx.prefetched is None:
+                # the secondary stream reuses the memory freed by the backward
+                # only after it, and the backward uses the activations of the
+                # previous segment only after the event
+                self._stream.wait_stream(paddle.device.current_stream())
+                with paddle.device.stream_guard(self._stream):
+                    prev_result = _recompute_forward(prev_ctx)
+                prev_ctx.prefetched = (
+                    prev_result,
+                    self._stream.record_event(),
+                )
+                self._stats["prefetched"] += 1
+
+        if self._report and ctx.segment_index == 0:
+            logger.info(
+                f"[Recompute]: {self._stats['segments']} segments "
+                f"recomputed, {self._stats['prefetched']} prefetched, "
+                f"{self._stats['exposed_recompute_ms']:.3f} ms exposed in "
+                f"the backward."
+            )
+        return result
+
+
+def _recompute_forward(ctx):
+    """
+    Re-runs the forward of the segment of ctx with grad, and returns its
+    detached inputs and its outputs.
+    """
+    # Restore inputs
+    inputs = list(ctx.inputs)
+    tensors = ctx.saved_tensor()
+    offloaded = getattr(ctx, "offloaded", None)
+    for i, idx in enumerate(ctx.tensor_indices):
+        tensor = tensors[i]
+        if offloaded is not None and offloaded[i]:
+            device_tensor = tensor._copy_to(
+                framework._current_expected_place(), False
+            )
+            device_tensor.stop_gradient = tensor.stop_gradient
+            tensor = device_tensor
+        inputs[idx] = tensor
+
+    # paddle.enable_grad()
+    tracer = framework._dygraph_tracer()
+    tracer._has_grad = True
+
+    # NOTE support AMP
+    # need restore auto_cast state as well as w/b list
+    if ctx.preserve_rng_state:
+        with switch_rng_state_tracker(
+            ctx.fw_rng_state, ctx.fwd_rng_state_tracker
+        ):
+            with paddle.amp.auto_cast(
+                enable=ctx.is_fw_autocast,
+                custom_white_list=ctx.amp_white_list,
+                custom_black_list=ctx.amp_black_list,
+                level=ctx.amp_level,
+                dtype=ctx.amp_dtype,
+            ):
+                detached_inputs = detach_variable(tuple(inputs))
+                outputs = ctx.run_function(*detached_inputs, **ctx.kwargs)
+    else:
+        with paddle.amp.auto_cast(
+            enable=ctx.is_fw_autocast,
+            custom_white_list=ctx.amp_white_list,
+            custom_black_list=ctx.amp_black_list,
+            level=ctx.amp_level,
+            dtype=ctx.amp_dtype,
+        ):
+            detached_inputs = detach_variable(tuple(inputs))
+            outputs = ctx.run_function(*detached_inputs, **ctx.kwargs)
+    return detached_inputs, outputs
+
+
 class RecomputeFunction(PyLayer):
     @staticmethod
     def forward(ctx, run_function, preserve_rng_state, *args, **kwargs):
@@ -154,6 +379,8 @@ class RecomputeFunction(PyLayer):
                     ctx.inputs.append(arg)
             else:
                 ctx.inputs.append(arg)
+        if _recompute_scheduler is not None:
+            tensor_inputs = _recompute_scheduler._register(ctx, tensor_inputs)
         ctx.save_for_backward(*tensor_inputs)
 
         # NOTE recompute with restore RNG only support one scenario where one process for one cuda gpu.
@@ -193,46 +420,12 @@ class RecomputeFunction(PyLayer):
     def backward(ctx, *args):
         with paddle.base.dygraph.guard():
             # TODO need to check the recompute calling is valid or not
-
-            # Restore inputs
-            inputs = list(ctx.inputs)
-            tensor_indices = ctx.tensor_indices
             duplicate_tensor = ctx.duplicate_tensor
-            tensors = ctx.saved_tensor()
-            for i, idx in enumerate(tensor_indices):
-                inputs[idx] = tensors[i]
-
-            # paddle.enable_grad()
-            tracer = framework._dygraph_tracer()
-            tracer._has_grad = True
-
-            # NOTE support AMP
-            # need restore auto_cast state as well as w/b list
-            if ctx.preserve_rng_state:
-                with switch_rng_state_tracker(
-                    ctx.fw_rng_state, ctx.fwd_rng_state_tracker
-                ):
-                    with paddle.amp.auto_cast(
-                        enable=ctx.is_fw_autocast,
-                        custom_white_list=ctx.amp_white_list,
-                        custom_black_list=ctx.amp_black_list,
-                        level=ctx.amp_level,
-                        dtype=ctx.amp_dtype,
-                    ):
-                        detached_inputs = detach_variable(tuple(inputs))
-                        outputs = ctx.run_function(
-                            *detached_inputs, **ctx.kwargs
-                        )
+            scheduler = getattr(ctx, "recompute_scheduler", None)
+            if scheduler is not None:
+                detached_inputs, outputs = scheduler._recompute(ctx)
             else:
-                with paddle.amp.auto_cast(
-                    enable=ctx.is_fw_autocast,
-                    custom_white_list=ctx.amp_white_list,
-                    custom_black_list=ctx.amp_black_list,
-                    level=ctx.amp_level,
-                    dtype=ctx.amp_dtype,
-                ):
-                    detached_inputs = detach_variable(tuple(inputs))
-                    outputs = ctx.run_function(*detached_inputs, **ctx.kwargs)
+                detached_inputs, outputs = _recompute_forward(ctx)
 
             if isinstance(outputs, core.eager.Tensor):
                 outputs = (outputs,)
@@ -242,7 +242,7 @@ def _check_environment_for_overlap():
         global _raise_cuda_env_unset_warning_for_sp
         if _raise_cuda_env_unset_warning_for_sp:
             logger.warning(
-                "You set mp_async_allreduce=True or recompute_allgather=True, but you forget to set environment "
+                "You set mp_async_allreduce=True, recompute_allgather=True or sp_overlap_chunks>1, but you forget to set environment "
                 "variable CUDA_DEVICE_MAX_CONNECTIONS=1, which may leads to performance "
                 "loss. Try to export CUDA_DEVICE_MAX_CONNECTIONS=1 for better performance."
             )
@@ -424,6 +424,168 @@ class SPInnerOverlapLinear(paddle.autograd.PyLayer):
                 return dx, dw, dbias
 
 
+def _can_split_chunks(seq_len, parallelism, num_chunks):
+    return num_chunks > 1 and seq_len % (parallelism * num_chunks) == 0
+
+
+def _merge_gathered_chunks(chunks, parallelism):
+    # The rows of a gathered chunk are the ones of the ranks in turn, [n * c],
+    # they are merged to the rows of all the chunks of the ranks in turn.
+    chunks = [
+        chunk.reshape([parallelism, -1, *chunk.shape[1:]]) for chunk in chunks
+    ]
+    merged = paddle.concat(chunks, axis=1)
+    return merged.reshape([-1, *merged.shape[2:]])
+
+
+def _all_gather_chunks_and_apply(x, fn, group, num_chunks):
+    # input shape: [s/n, b, h], the all_gather of a chunk of [s/(n*k), b, h]
+    # is overlapped with fn of the previous one.
+    parallelism = group.nranks
+    chunk_len = x.shape[0] // num_chunks
+    tasks = []
+    gathered = []
+    for i in range(num_chunks):
+        x_chunk = paddle.slice(
+            x, axes=[0], starts=[chunk_len * i], ends=[chunk_len * (i + 1)]
+        )
+        gathered_shape = x_chunk.shape
+        gathered_shape[0] = gathered_shape[0] * parallelism
+        x_gathered = paddle.empty(shape=gathered_shape, dtype=x.dtype)
+        tasks.append(
+            dist.stream.all_gather(
+                x_gathered, x_chunk, group=group, sync_op=False
+            )
+        )
+        gathered.append(x_gathered)
+
+    _check_environment_for_overlap()
+    outputs = []
+    for task, x_gathered in zip(tasks, gathered):
+        task.wait()
+        outputs.append(fn(x_gathered))
+    return (
+        _merge_gathered_chunks(outputs, parallelism),
+        _merge_gathered_chunks(gathered, parallelism),
+    )
+
+
+def _apply_chunks_and_reduce_scatter(x, fn, group, num_chunks):
+    # input shape: [s, b, h], the chunk i is made of the i-th [s/(n*k), b, h]
+    # of the rows of each rank, so its reduce_scatter gives the i-th rows of
+    # [s/n, b, h] on each rank. It is overlapped with fn of the next chunk.
+    parallelism = group.nranks
+    x = x.reshape([parallelism, num_chunks, -1, *x.shape[1:]])
+    tasks = []
+    outputs = []
+    _check_environment_for_overlap()
+    for i in range(num_chunks):
+        x_chunk = paddle.slice(x, axes=[1], starts=[i], ends=[i + 1])
+        y_chunk = fn(x_chunk.reshape([-1, *x_chunk.shape[3:]]))
+        out_shape = y_chunk.shape
+        out_shape[0] = out_shape[0] // parallelism
+        out = paddle.empty(shape=out_shape, dtype=y_chunk.dtype)
+        tasks.append(
+            dist.stream.reduce_scatter(
+                out, y_chunk, op=dist.ReduceOp.SUM, group=group, sync_op=False
+            )
+        )
+        outputs.append(out)
+    return outputs, tasks
+
+
+def _wait_and_concat(outputs, tasks):
+    for task in tasks:
+        task.wait()
+    return paddle.concat(outputs, axis=0)
+
+
+# The all_gather of ColumnSequenceParallelLinear, and the reduce_scatter of
+# its backward, are split in chunks pipelined with the matmuls of the chunks
+class AllGatherMatmulOverlap(PyLayer):
+    @staticmethod
+    def forward(ctx, x, weight, bias, model_parallel_group, num_chunks):
+        ctx.model_parallel_group = model_parallel_group
+        ctx.num_chunks = num_chunks
+        output, input_parallel = _all_gather_chunks_and_apply(
+            x,
+            lambda x_gathered: paddle._C_ops.linear(x_gathered, weight, bias),
+            model_parallel_group,
+            num_chunks,
+        )
+        ctx.save_for_backward(weight, bias, input_parallel)
+        return output
+
+    @staticmethod
+    def backward(ctx, dy):
+        weight, bias, input_parallel = ctx.saved_tensor()
+        weight_t = (
+            weight
+            if dy.dtype == weight.dtype
+            else paddle.cast(weight, dtype=dy.dtype)
+        )
+        dx_chunks, tasks = _apply_chunks_and_reduce_scatter(
+            dy,
+            lambda dy_chunk: paddle.matmul(
+                dy_chunk, weight_t, transpose_y=True
+            ),
+            ctx.model_parallel_group,
+            ctx.num_chunks,
+        )
+
+        # dw and dbias are overlapped with the last reduce_scatter
+        dy = dy.reshape([-1, dy.shape[-1]])
+        dw = paddle.matmul(
+            input_parallel.reshape([-1, input_parallel.shape[-1]]),
+            dy,
+            transpose_x=True,
+        )
+        dx = _wait_and_concat(dx_chunks, tasks)
+        if bias is None:
+            return dx, dw
+        return dx, dw, paddle.sum(dy, axis=0)
+
+
+# The reduce_scatter of RowSequenceParallelLinear, and the all_gather of its
+# backward, are split in chunks pipelined with the matmuls of the chunks
+class MatmulReduceScatterOverlap(PyLayer):
+    @staticmethod
+    def forward(ctx, x, weight, model_parallel_group, num_chunks):
+        ctx.model_parallel_group = model_parallel_group
+        ctx.num_chunks = num_chunks
+        ctx.save_for_backward(x, weight)
+        outputs, tasks = _apply_chunks_and_reduce_scatter(
+            x,
+            lambda x_chunk: paddle.matmul(x_chunk, weight),
+            model_parallel_group,
+            num_chunks,
+        )
+        return _wait_and_concat(outputs, tasks)
+
+    @staticmethod
+    def backward(ctx, dy):
+        x, weight = ctx.saved_tensor()
+        weight_t = (
+            weight
+            if dy.dtype == weight.dtype
+            else paddle.cast(weight, dtype=dy.dtype)
+        )
+        dx, dy_parallel = _all_gather_chunks_and_apply(
+            dy,
+            lambda dy_gathered: paddle.matmul(
+                dy_gathered, weight_t, transpose_y=True
+            ),
+            ctx.model_parallel_group,
+            ctx.num_chunks,
+        )
+        dw = paddle.matmul(
+            x.reshape([-1, x.shape[-1]]),
+            dy_parallel.reshape([-1, dy_parallel.shape[-1]]),
+            transpose_x=True,
+        )
+        return dx, dw
+
+
 class ColumnSequenceParallelLinear(Layer):
     def __init__(
         self,
@@ -519,6 +681,7 @@ class ColumnSequenceParallelLinear(Layer):
         self.mp_async_allreduce = mp_configs.mp_async_allreduce
         self.sp_async_reduce_scatter = mp_configs.sp_async_reduce_scatter
         self.recompute_allgather = mp_configs.recompute_allgather
+        self.sp_overlap_chunks = mp_configs.sp_overlap_chunks
 
         self.mp_fused_linear_param_grad_add = (
             self.mp_async_allreduce
@@ -527,7 +690,19 @@ class ColumnSequenceParallelLinear(Layer):
 
     def forward(self, x):
         # sequence parallel is same as tensor parallel, if sequence parallel is true, input shape is [s, b, h], else input shape is [b, s, h]
-        if self.sp_async_reduce_scatter:
+        if paddle.in_dynamic_mode() and _can_split_chunks(
+            x.shape[0] * self.world_size,
+            self.world_size,
+            self.sp_overlap_chunks,
+        ):
+            output = AllGatherMatmulOverlap.apply(
+                x,
+                self.weight,
+                self.bias,
+                self.model_parallel_group,
+                self.sp_overlap_chunks,
+            )
+        elif self.sp_async_reduce_scatter:
             output = SPInnerOverlapLinear.apply(
                 x,
                 self.weight,
@@ -657,9 +832,30 @@ class RowSequenceParallelLinear(Layer):
             if self.is_mp and has_bias:
                 self.mp_scale = MPScale.apply
 
+        mp_configs = fleet.fleet._user_defined_strategy.hybrid_configs[
+            "mp_configs"
+        ]
+        self.sp_overlap_chunks = mp_configs.sp_overlap_chunks
+
     def forward(self, x):
         input_parallel = x
-        if self.is_mp:
+        if (
+            self.is_mp
+            and paddle.in_dynamic_mode()
+            and _can_split_chunks(
+                x.shape[0], self.world_size, self.sp_overlap_chunks
+            )
+        ):
+            output = MatmulReduceScatterOverlap.apply(
+                input_parallel,
+                self.weight,
+                self.model_parallel_group,
+                self.sp_overlap_chunks,
+            )
+            # the bias is all_reduced by the hook of sequence parallel
+            if self.bias is not None:
+                output = output + self.bias
+        elif self.is_mp:
             if self.mp_scale is not None:
                 bias = self.mp_scale(self.bias, self.world_size)
             else:
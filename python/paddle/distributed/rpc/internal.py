@@ -12,9 +12,12 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import io
 import pickle
 from collections import namedtuple
 
+from paddle.base import core
+
 PythonFunc = namedtuple("PythonFunc", ["func", "args", "kwargs"])
 """Some Python code interfaces called in C++"""
 
@@ -27,6 +30,44 @@ def _deserialize(obj):
     return pickle.loads(obj)
 
 
+class _TensorPickler(pickle.Pickler):
+    """Takes the tensors out of the pickle, they are sent in the attachment
+    of the rpc message instead of being pickled."""
+
+    def __init__(self, file):
+        super().__init__(file)
+        self.tensors = []
+
+    def persistent_id(self, obj):
+        if isinstance(obj, core.eager.Tensor):
+            self.tensors.append(obj.value().get_tensor())
+            return ("tensor", len(self.tensors) - 1)
+        return None
+
+
+class _TensorUnpickler(pickle.Unpickler):
+    def __init__(self, file, tensors):
+        super().__init__(file)
+        self.tensors = tensors
+
+    def persistent_load(self, pid):
+        tag, index = pid
+        assert tag == "tensor", f"Unknown persistent id {pid} in rpc message"
+        tensor = self.tensors[index]
+        return core.eager.Tensor(value=tensor, place=tensor._place())
+
+
+def _serialize_with_tensors(obj):
+    buffer = io.BytesIO()
+    pickler = _TensorPickler(buffer)
+    pickler.dump(obj)
+    return buffer.getvalue(), pickler.tensors
+
+
+def _deserialize_with_tensors(obj, tensors):
+    return _TensorUnpickler(io.BytesIO(obj), tensors).load()
+
+
 def _run_py_func(python_func):
     result = python_func.func(*python_func.args, **python_func.kwargs)
     return result
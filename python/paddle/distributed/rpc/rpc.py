@@ -20,7 +20,7 @@ from collections import namedtuple
 
 from paddle.base import core
 from paddle.distributed.launch.context import Node
-from paddle.distributed.rpc.internal import PythonFunc, _serialize
+from paddle.distributed.rpc.internal import PythonFunc, _serialize_with_tensors
 from paddle.distributed.utils.launch_utils import logger
 
 WorkerInfo = namedtuple("WorkerInfo", ["name", "rank", "ip", "port"])
@@ -53,8 +53,9 @@ def _set_self_info(name, rank, ip, port):
 def _exchange_all_service_infos(world_size):
     all_infos = []
     s = set()
-    for rank in range(world_size):
-        info = pickle.loads(_barrier_store.get(str(rank)))
+    keys = [str(rank) for rank in range(world_size)]
+    for data in _barrier_store.multi_get(keys):
+        info = pickle.loads(data)
         assert (
             info.name not in s
         ), "The Worker name must be unique, but name `{}` is repeated."
@@ -227,10 +228,12 @@ def rpc_async(to, fn, args=None, kwargs=None, timeout=_DEFAULT_RPC_TIMEOUT):
 def _invoke_rpc(to, fn, args, kwargs, timeout):
     args = args if args else ()
     kwargs = kwargs if kwargs else {}
-    serial_obj = _serialize(PythonFunc(fn, args, kwargs))
+    serial_obj, tensors = _serialize_with_tensors(
+        PythonFunc(fn, args, kwargs)
+    )
     timeout_ms = timeout * 1000
     timeout_ms = _MAX_RPC_TIMEOUT_MS if timeout_ms <= 0 else timeout_ms
-    future = core.invoke_rpc(to, serial_obj, timeout_ms)
+    future = core.invoke_rpc(to, serial_obj, tensors, timeout_ms)
     return future
 
 
@@ -13,8 +13,13 @@
 # limitations under the License.
 
 from paddle.distributed.fleet.recompute import (
+    RecomputeScheduler,
     recompute_hybrid,
     recompute_sequential,
 )
 
-__all__ = ["recompute_sequential", "recompute_hybrid"]
+__all__ = [
+    "recompute_sequential",
+    "recompute_hybrid",
+    "RecomputeScheduler",
+]
@@ -1004,6 +1004,9 @@ class DistributedAdam(DistributedOptimizerImplBase):
         opt_info["scale_sparse_gradient_with_batch_size"] = strategy.get(
             "scale_sparse_gradient_with_batch_size", True
         )
+        opt_info["prefetch_next_batch_sparse"] = strategy.get(
+            "prefetch_next_batch_sparse", False
+        )
         opt_info["worker_class"] = strategy.get(
             "worker_class", "DownpourWorker"
         )
@@ -17,6 +17,8 @@ from .block_multihead_attention import (
     block_multihead_attention,
     block_multihead_attention_xpu,  # noqa: F401
 )
+from .fp8 import fp8_cast_transpose, fp8_scaled_gemm, fp8_update_scale
+from .fused_beam_search_step import fused_beam_search_step
 from .fused_dot_product_attention import (
     cudnn_flash_attention,  # noqa: F401
     fused_dot_product_attention,  # noqa: F401
@@ -32,6 +34,7 @@ from .fused_matmul_bias import (
 )
 from .fused_rms_norm import fused_rms_norm
 from .fused_rotary_position_embedding import fused_rotary_position_embedding
+from .fused_softmax_cross_entropy import fused_softmax_cross_entropy
 from .fused_transformer import (
     fused_bias_dropout_residual_layer_norm,
     fused_feedforward,
@@ -39,6 +42,7 @@ from .fused_transformer import (
     fused_multi_transformer,
 )
 from .masked_multihead_attention import masked_multihead_attention
+from .moe_grouped_gemm import moe_grouped_gemm
 from .swiglu import swiglu
 from .variable_length_memory_efficient_attention import (
     variable_length_memory_efficient_attention,
@@ -55,6 +59,12 @@ __all__ = [
     'fused_ec_moe',
     'fused_dropout_add',
     'fused_rotary_position_embedding',
+    'fused_beam_search_step',
+    'fused_softmax_cross_entropy',
+    'moe_grouped_gemm',
+    'fp8_cast_transpose',
+    'fp8_update_scale',
+    'fp8_scaled_gemm',
     'variable_length_memory_efficient_attention',
     "fused_rms_norm",
     "fused_layer_norm",
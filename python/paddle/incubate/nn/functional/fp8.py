@@ -0,0 +1,192 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from paddle import _C_ops
+from paddle.framework import in_dynamic_or_pir_mode
+
+# The largest finite values of the fp8 formats.
+FP8_MAX = {
+    'float8_e4m3fn': 448.0,
+    'float8_e5m2': 57344.0,
+}
+
+
+def fp8_cast_transpose(
+    x, scale, amax_history, out_dtype='float8_e4m3fn', name=None
+):
+    r"""
+    Casts x multiplied by scale to fp8, together with its transpose, and
+    records the maximum of the absolute values of x into amax_history[0]
+    in-place, all by reading x only once. With the delayed scaling, scale is
+    computed by :func:`fp8_update_scale` from the amax of the previous steps.
+
+    Args:
+        x (Tensor): The 2-D input, whose data type is float32, float16 or
+            bfloat16.
+        scale (Tensor): The scale of the quantization, whose shape is [1] and
+            data type is float32.
+        amax_history (Tensor): The amax history of x, whose shape is
+            [history_len] and data type is float32. It is updated in-place.
+        out_dtype (str, optional): float8_e4m3fn, which is for the forward, or
+            float8_e5m2, which has a wider range for the gradients. Default:
+            float8_e4m3fn.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        A tuple of the casted x and its transpose.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> import paddle.incubate.nn.functional as F
+            >>> paddle.device.set_device('gpu')
+            >>> x = paddle.randn([32, 64], dtype='bfloat16')
+            >>> scale = paddle.ones([1])
+            >>> amax_history = paddle.zeros([16])
+            >>> out, out_t = F.fp8_cast_transpose(x, scale, amax_history)
+            >>> print(out.shape, out_t.shape)
+            [32, 64] [64, 32]
+    """
+    if in_dynamic_or_pir_mode():
+        out, out_t, _ = _C_ops.fp8_cast_transpose_(
+            x, scale, amax_history, out_dtype
+        )
+        return out, out_t
+    raise NotImplementedError(
+        "fp8_cast_transpose is only supported in dynamic graph mode and PIR "
+        "mode."
+    )
+
+
+def fp8_update_scale(
+    amax_history, scale, fp8_dtype='float8_e4m3fn', margin=0, name=None
+):
+    r"""
+    Updates the scale of the delayed scaling in-place by the maximum of
+    amax_history, and rolls amax_history, where amax_history[0] is cleared
+    for the amax of the next step. The scale is kept if the history has no
+    valid amax.
+
+    .. math::
+
+        scale = \frac{fp8\_max}{max(amax\_history) \cdot 2^{margin}}
+
+    Args:
+        amax_history (Tensor): The amax history, whose shape is [history_len]
+            and data type is float32. It is updated in-place.
+        scale (Tensor): The scale, whose shape is [1] and data type is
+            float32. It is updated in-place.
+        fp8_dtype (str, optional): The fp8 data type the scale is for, which
+            is float8_e4m3fn or float8_e5m2. Default: float8_e4m3fn.
+        margin (float, optional): The margin of the scale in the power of 2.
+            Default: 0.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        Tensor, the reciprocal of the new scale, which dequantizes the fp8
+        tensors casted by it.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> import paddle.incubate.nn.functional as F
+            >>> paddle.device.set_device('gpu')
+            >>> amax_history = paddle.to_tensor([2.0, 4.0, 1.0])
+            >>> scale = paddle.ones([1])
+            >>> scale_inv = F.fp8_update_scale(amax_history, scale)
+            >>> print(scale.numpy(), amax_history.numpy())
+            [112.] [0. 2. 4.]
+    """
+    if fp8_dtype not in FP8_MAX:
+        raise ValueError(
+            "fp8_dtype should be float8_e4m3fn or float8_e5m2, but received "
+            f"{fp8_dtype}."
+        )
+    if in_dynamic_or_pir_mode():
+        _, _, scale_inv = _C_ops.fp8_update_scale_(
+            amax_history, scale, FP8_MAX[fp8_dtype], float(margin)
+        )
+        return scale_inv
+    raise NotImplementedError(
+        "fp8_update_scale is only supported in dynamic graph mode and PIR "
+        "mode."
+    )
+
+
+def fp8_scaled_gemm(
+    x,
+    y,
+    x_scale_inv,
+    y_scale_inv,
+    bias=None,
+    output_dtype='bfloat16',
+    name=None,
+):
+    r"""
+    The GEMM of the fp8 tensors, which are dequantized by the scales on the
+    device, so the scales updated by the delayed scaling are used without
+    synchronizing with the host.
+
+    .. math::
+
+        out = (x \cdot x\_scale\_inv) (y \cdot y\_scale\_inv)^T + bias
+
+    This method requires CUDA 12.1+ and sm_89+, and k should be a multiple
+    of 16.
+
+    Args:
+        x (Tensor): The input of shape [m, k], whose data type is
+            float8_e4m3fn or float8_e5m2.
+        y (Tensor): The input of shape [n, k], whose data type is
+            float8_e4m3fn or float8_e5m2. x and y can not be both
+            float8_e5m2.
+        x_scale_inv (Tensor): The dequantization scale of x, whose shape is
+            [1] and data type is float32.
+        y_scale_inv (Tensor): The dequantization scale of y, whose shape is
+            [1] and data type is float32.
+        bias (Tensor, optional): The bias of shape [n], whose data type is
+            output_dtype. Default: None.
+        output_dtype (str, optional): bfloat16 or float16. Default: bfloat16.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        Tensor, the output of shape [m, n].
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +SKIP('fp8_scaled_gemm is only supported on sm_89+ with CUDA 12.1+')
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> import paddle.incubate.nn.functional as F
+            >>> paddle.device.set_device('gpu')
+            >>> x = paddle.randn([32, 64]).astype('float8_e4m3fn')
+            >>> y = paddle.randn([16, 64]).astype('float8_e4m3fn')
+            >>> scale_inv = paddle.ones([1])
+            >>> out = F.fp8_scaled_gemm(x, y, scale_inv, scale_inv)
+            >>> print(out.shape)
+            [32, 16]
+    """
+    if in_dynamic_or_pir_mode():
+        return _C_ops.fp8_scaled_gemm(
+            x, y, x_scale_inv, y_scale_inv, bias, output_dtype
+        )
+    raise NotImplementedError(
+        "fp8_scaled_gemm is only supported in dynamic graph mode and PIR "
+        "mode."
+    )
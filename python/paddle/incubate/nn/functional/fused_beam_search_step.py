@@ -0,0 +1,102 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import annotations
+
+from typing import TYPE_CHECKING
+
+from paddle import _C_ops
+from paddle.framework import in_dynamic_or_pir_mode
+
+if TYPE_CHECKING:
+    from paddle import Tensor
+
+
+def fused_beam_search_step(
+    logits: Tensor,
+    cum_scores: Tensor,
+    finished: Tensor,
+    seq_lens: Tensor,
+    beam_size: int,
+    end_id: int,
+    length_penalty: float = 0.0,
+    block_tables: Tensor | None = None,
+    key_cache: Tensor | None = None,
+    value_cache: Tensor | None = None,
+) -> tuple[Tensor, Tensor]:
+    """
+    Runs one step of beam search on the GPU, without copying any state to the host.
+
+    The logits of each unfinished beam are normalized by log-softmax and its ``beam_size`` best tokens
+    are ranked among the other beams of the batch by their scores divided by the length penalty
+    ``((5 + seq_len + 1) / 6) ** length_penalty``. A finished beam only competes with its final score.
+    The ``beam_size`` best candidates of each batch become its new beams, and ``cum_scores``, ``finished``
+    and ``seq_lens`` are reordered by their parents in place. ``seq_lens`` holds the number of tokens in
+    the cache of a beam, which the next attention step increases.
+
+    If ``block_tables`` is given, the paged key and value caches of block_multihead_attention are
+    reordered in place too: a beam shares the full blocks of its parent and the tokens in the last block
+    of the parent are copied into the last block of the beam, so each beam should own a distinct last
+    block. The blocks no longer referenced by any beam are not released.
+
+    Args:
+        logits (Tensor): The logits of shape [batch_size * beam_size, vocab_size], the beams of a batch
+            are contiguous.
+        cum_scores (Tensor): The float32 scores of the beams, of shape [batch_size * beam_size].
+        finished (Tensor): The bool finished flags of the beams.
+        seq_lens (Tensor): The int32 sequence lengths of the beams.
+        beam_size (int): The beam size, at most 16.
+        end_id (int): The id of the end token.
+        length_penalty (float, optional): The exponent of the length penalty, 0 disables it. Default 0.0.
+        block_tables (Tensor, optional): The int32 block tables of shape [batch_size * beam_size, max_blocks].
+        key_cache (Tensor, optional): The key cache of shape [num_blocks, num_heads, block_size, head_dim].
+        value_cache (Tensor, optional): The value cache, of the shape of the key cache.
+
+    Returns:
+        tuple(Tensor, Tensor): The int64 selected token ids and the int32 parent rows of the new beams.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> from paddle.incubate.nn.functional import fused_beam_search_step
+            >>> paddle.device.set_device('gpu')
+
+            >>> batch_size, beam_size, vocab_size = 2, 4, 100
+            >>> logits = paddle.randn([batch_size * beam_size, vocab_size])
+            >>> cum_scores = paddle.zeros([batch_size * beam_size])
+            >>> finished = paddle.zeros([batch_size * beam_size], dtype='bool')
+            >>> seq_lens = paddle.ones([batch_size * beam_size], dtype='int32')
+            >>> ids, parent_idx = fused_beam_search_step(
+            ...     logits, cum_scores, finished, seq_lens, beam_size, end_id=0
+            ... )
+    """
+    if in_dynamic_or_pir_mode():
+        outs = _C_ops.fused_beam_search_step_(
+            logits,
+            cum_scores,
+            finished,
+            seq_lens,
+            block_tables,
+            key_cache,
+            value_cache,
+            beam_size,
+            end_id,
+            length_penalty,
+        )
+        return outs[0], outs[1]
+    raise NotImplementedError(
+        "fused_beam_search_step only supports the dynamic graph and the PIR mode."
+    )
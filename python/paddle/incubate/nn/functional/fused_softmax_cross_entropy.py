@@ -0,0 +1,86 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from paddle import _C_ops
+from paddle.framework import in_dynamic_mode, in_dynamic_or_pir_mode
+
+
+def fused_softmax_cross_entropy(
+    logits, label, ignore_index=-100, group=None, name=None
+):
+    r"""
+    Computes the softmax cross entropy loss of the logits with an online
+    softmax over the last dimension, without keeping the softmax of the
+    logits. The backward recomputes the softmax from the logits and the
+    logsumexp of each row, which saves the memory of a [tokens, vocab]
+    softmax for the large vocabularies.
+
+    .. math::
+
+        loss = \log\sum_{j}\exp(logits_{j}) - logits_{label}
+
+    Args:
+        logits (Tensor): The logits, whose last dimension is the classes of
+            the rank when the vocabulary is sharded. The data type is
+            float32, float16 or bfloat16.
+        label (Tensor): The labels, whose shape is the same as logits except
+            the last dimension, which is 1 or omitted. The data type is int32
+            or int64.
+        ignore_index (int, optional): The label whose loss and gradient are
+            zeros. Default: -100.
+        group (Group, optional): The model parallel group which shards the
+            classes of the logits in order of the ranks, only supported in
+            static graph mode. Default: None, means the classes are not
+            sharded.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        Tensor, the loss, whose shape is the same as label and data type is
+        the same as logits.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> import paddle.incubate.nn.functional as F
+            >>> paddle.device.set_device('gpu')
+            >>> logits = paddle.randn([4, 32000], dtype='float32')
+            >>> label = paddle.randint(0, 32000, [4, 1])
+            >>> loss = F.fused_softmax_cross_entropy(logits, label)
+            >>> print(loss.shape)
+            [4, 1]
+    """
+    if group is not None and not group.is_member():
+        return
+    ring_id = 0 if group is None else group.id
+    rank = 0 if group is None else group.rank
+    nranks = 1 if group is None else group.nranks
+    if nranks > 1 and in_dynamic_mode():
+        raise ValueError(
+            "fused_softmax_cross_entropy only supports sharding the classes "
+            "in static graph mode."
+        )
+
+    if len(label.shape) == len(logits.shape) - 1:
+        label = paddle.unsqueeze(label, axis=-1)
+    if in_dynamic_or_pir_mode():
+        return _C_ops.fused_softmax_cross_entropy(
+            logits, label, ignore_index, ring_id, rank, nranks
+        )
+    raise NotImplementedError(
+        "fused_softmax_cross_entropy is only supported in dynamic graph mode "
+        "and PIR mode."
+    )
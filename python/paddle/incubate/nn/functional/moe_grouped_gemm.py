@@ -0,0 +1,68 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from paddle import _C_ops
+from paddle.framework import in_dynamic_or_pir_mode
+
+
+def moe_grouped_gemm(x, expert_id, weight, name=None):
+    r"""
+    Multiplies each token by the weights of its experts, with one grouped
+    GEMM for all the experts instead of a matmul per expert. The tokens are
+    permuted into the order of the experts and permuted back inside the op,
+    so the numbers of the tokens of the experts can be any and are not
+    needed on the host in the forward.
+
+    .. math::
+
+        out[i, j] = x[i] * weight[expert\_id[i, j]]
+
+    This method requires SM_ARCH in sm70, sm75, sm80, sm86, and the
+    hidden_size and out_size should be multiples of 8 for float16.
+
+    Args:
+        x (Tensor): The tokens, whose shape is [num_tokens, hidden_size]. The
+            data type is float32 or float16.
+        expert_id (Tensor): The expert of each token, whose shape is
+            [num_tokens], or [num_tokens, topk] for the top k experts of each
+            token. The data type is int32 or int64.
+        weight (Tensor): The weights of the experts, whose shape is
+            [num_experts, hidden_size, out_size]. The data type is the same
+            as x.
+        name (str, optional): For details, please refer to :ref:`api_guide_Name`. Generally, no setting is required. Default: None.
+
+    Returns:
+        Tensor, the output, whose shape is the shape of expert_id followed
+        by out_size, and data type is the same as x.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> import paddle.incubate.nn.functional as F
+            >>> paddle.device.set_device('gpu')
+            >>> x = paddle.randn([16, 64], dtype='float16')
+            >>> expert_id = paddle.randint(0, 4, [16, 2])
+            >>> weight = paddle.randn([4, 64, 128], dtype='float16')
+            >>> out = F.moe_grouped_gemm(x, expert_id, weight)
+            >>> print(out.shape)
+            [16, 2, 128]
+    """
+    if in_dynamic_or_pir_mode():
+        return _C_ops.moe_grouped_gemm(x, expert_id, weight)
+    raise NotImplementedError(
+        "moe_grouped_gemm is only supported in dynamic graph mode and PIR "
+        "mode."
+    )
@@ -0,0 +1,229 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import paddle
+from paddle.autograd import PyLayer
+from paddle.base.dygraph import no_grad
+from paddle.incubate.nn import functional as F
+from paddle.nn import Layer
+
+from .fused_transformer import _to_dtype
+
+_FP8_FORWARD_DTYPE = 'float8_e4m3fn'
+_FP8_BACKWARD_DTYPE = 'float8_e5m2'
+
+
+class _FP8LinearFunction(PyLayer):
+    # x and weight are casted to e4m3 with their transposes, which the GEMMs
+    # of the backward take with the gradient casted to e5m2, so each tensor
+    # is casted only once:
+    #   out = x * weight = x_fp8 * (weight_t_fp8)^T
+    #   x_grad = out_grad * weight^T = out_grad_fp8 * (weight_fp8)^T
+    #   weight_grad = x^T * out_grad = x_t_fp8 * (out_grad_t_fp8)^T
+    @staticmethod
+    def forward(ctx, x, weight, bias, layer):
+        dtype = x.dtype
+        x_2d = x.reshape([-1, x.shape[-1]])
+        x_scale_inv = F.fp8_update_scale(
+            layer.x_amax_history,
+            layer.x_scale,
+            _FP8_FORWARD_DTYPE,
+            layer.margin,
+        )
+        x_fp8, x_t_fp8 = F.fp8_cast_transpose(
+            x_2d, layer.x_scale, layer.x_amax_history, _FP8_FORWARD_DTYPE
+        )
+        weight_scale_inv = F.fp8_update_scale(
+            layer.weight_amax_history,
+            layer.weight_scale,
+            _FP8_FORWARD_DTYPE,
+            layer.margin,
+        )
+        weight_fp8, weight_t_fp8 = F.fp8_cast_transpose(
+            weight,
+            layer.weight_scale,
+            layer.weight_amax_history,
+            _FP8_FORWARD_DTYPE,
+        )
+        out = F.fp8_scaled_gemm(
+            x_fp8,
+            weight_t_fp8,
+            x_scale_inv,
+            weight_scale_inv,
+            bias=None if bias is None else bias.astype(dtype),
+            output_dtype=_dtype_name(dtype),
+        )
+
+        ctx.save_for_backward(
+            x_t_fp8, weight_fp8, x_scale_inv, weight_scale_inv
+        )
+        ctx.layer = layer
+        ctx.x_shape = x.shape
+        ctx.x_dtype = dtype
+        ctx.weight_dtype = weight.dtype
+        ctx.bias_dtype = None if bias is None else bias.dtype
+        return out.reshape([*x.shape[:-1], out.shape[-1]])
+
+    @staticmethod
+    def backward(ctx, out_grad):
+        x_t_fp8, weight_fp8, x_scale_inv, weight_scale_inv = ctx.saved_tensor()
+        layer = ctx.layer
+        out_grad_2d = out_grad.reshape([-1, out_grad.shape[-1]])
+        grad_scale_inv = F.fp8_update_scale(
+            layer.grad_amax_history,
+            layer.grad_scale,
+            _FP8_BACKWARD_DTYPE,
+            layer.margin,
+        )
+        grad_fp8, grad_t_fp8 = F.fp8_cast_transpose(
+            out_grad_2d,
+            layer.grad_scale,
+            layer.grad_amax_history,
+            _FP8_BACKWARD_DTYPE,
+        )
+        x_grad = F.fp8_scaled_gemm(
+            grad_fp8,
+            weight_fp8,
+            grad_scale_inv,
+            weight_scale_inv,
+            output_dtype=_dtype_name(ctx.x_dtype),
+        ).reshape(ctx.x_shape)
+        weight_grad = F.fp8_scaled_gemm(
+            x_t_fp8,
+            grad_t_fp8,
+            x_scale_inv,
+            grad_scale_inv,
+            output_dtype=_dtype_name(ctx.x_dtype),
+        ).astype(ctx.weight_dtype)
+        if ctx.bias_dtype is None:
+            return x_grad, weight_grad
+        bias_grad = out_grad_2d.astype('float32').sum(axis=0)
+        return x_grad, weight_grad, bias_grad.astype(ctx.bias_dtype)
+
+
+def _dtype_name(dtype):
+    if dtype == paddle.bfloat16:
+        return 'bfloat16'
+    if dtype == paddle.float16:
+        return 'float16'
+    raise ValueError(
+        "The input of FP8Linear should be bfloat16 or float16, but received "
+        f"{dtype}."
+    )
+
+
+class FP8Linear(Layer):
+    r"""
+    Linear layer whose GEMMs of the forward and the backward are computed in
+    fp8, with the inputs and the weight casted to float8_e4m3fn and the
+    gradients of the output casted to float8_e5m2, whose range is wider.
+
+    Each of them is casted by a per-tensor scale of the delayed scaling, which
+    is computed from the maximum of its amax of the last amax_history_len
+    steps, instead of its own amax which needs one more pass over it. The amax
+    histories and the scales are kept on the device as the buffers of the
+    layer, so the training is not synchronized with the host.
+
+    The input should be bfloat16 or float16, e.g. under
+    :func:`paddle.amp.auto_cast`, and the output is in the same data type. The
+    weight is kept in the data type it is created in, and its fp8 buffers are
+    kept in float32 under :func:`paddle.amp.decorate`.
+
+    This layer requires CUDA 12.1+ and sm_89+, and in_features, out_features
+    and the number of the rows of the input should be multiples of 16.
+
+    Parameters:
+        in_features (int): The number of input units.
+        out_features (int): The number of output units.
+        weight_attr (ParamAttr, optional): The attribute for the learnable
+            weight of this layer. Default: None.
+        bias_attr (ParamAttr|bool, optional): The attribute for the learnable
+            bias of this layer. If it is set to False, no bias will be added
+            to the output. Default: None.
+        amax_history_len (int, optional): The number of the steps whose amax
+            are kept to compute the scales. Default: 16.
+        margin (float, optional): The scales are divided by 2^margin to keep
+            more room for the growing values. Default: 0.
+        name (str, optional): Normally there is no need for user to set this parameter.
+            For detailed information, please refer to :ref:`api_guide_Name` .
+
+    Attribute:
+        **weight** (Parameter): the learnable weight of shape
+        [in_features, out_features].
+
+        **bias** (Parameter): the learnable bias of shape [out_features].
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +SKIP('FP8Linear is only supported on sm_89+ with CUDA 12.1+')
+            >>> # doctest: +REQUIRES(env:GPU)
+            >>> import paddle
+            >>> paddle.device.set_device('gpu')
+            >>> from paddle.incubate.nn import FP8Linear
+
+            >>> x = paddle.randn([32, 64], dtype='bfloat16')
+            >>> linear = FP8Linear(64, 128)
+            >>> y = linear(x)
+            >>> print(y.shape)
+            [32, 128]
+    """
+
+    def __init__(
+        self,
+        in_features,
+        out_features,
+        weight_attr=None,
+        bias_attr=None,
+        amax_history_len=16,
+        margin=0,
+        name=None,
+    ):
+        super().__init__()
+        dtype = self._helper.get_default_dtype()
+        self.weight = self.create_parameter(
+            shape=[in_features, out_features],
+            attr=weight_attr,
+            dtype=dtype,
+            is_bias=False,
+        )
+        self.bias = self.create_parameter(
+            shape=[out_features], attr=bias_attr, dtype=dtype, is_bias=True
+        )
+        self.margin = margin
+        self.name = name
+        for tensor in ['x', 'weight', 'grad']:
+            self.register_buffer(
+                f'{tensor}_amax_history',
+                paddle.zeros([amax_history_len], dtype='float32'),
+            )
+            self.register_buffer(
+                f'{tensor}_scale', paddle.ones([1], dtype='float32')
+            )
+
+    def forward(self, input):
+        return _FP8LinearFunction.apply(input, self.weight, self.bias, self)
+
+    def _amp_decorate(self, dtype):
+        # The amax histories and the scales of fp8 should be kept in float32
+        # under amp.decorator(O2), so only the parameters are casted.
+        for param in self._parameters.values():
+            if param is not None:
+                with no_grad():
+                    _to_dtype(param, dtype)
+        self._dtype = dtype
+
+    def extra_repr(self):
+        name_str = f', name={self.name}' if self.name else ''
+        return f'in_features={self.weight.shape[0]}, out_features={self.weight.shape[1]}, dtype={self._dtype}{name_str}'
@@ -14,6 +14,9 @@
 
 import logging
 import os
+import shutil
+import tempfile
+import time
 from typing import Set
 
 import numpy as np
@@ -99,8 +102,28 @@ def convert_to_mixed_precision(
         backend: The backend, e.g. PlaceType.GPU.
         keep_io_types: Whether the model input and output dtype remains unchanged.
         black_list: Operators that do not convert precision.
-        kwargs: Supported keys including 'white_list'.
+        kwargs: Supported keys including 'white_list', 'calibration_data',
+            'accuracy_budget' and 'repeat'.
             - white_list: Operators that do convert precision.
+            - calibration_data: A list of the inputs of the model to profile,
+              each a dict of numpy arrays by input name, or a list of them in
+              the order of the inputs. With it, the op types to convert are
+              chosen by profiling on the GPU: every op type of the model is
+              converted alone to measure the error of the outputs, relative
+              to the fp32 ones, and the time it saves; then the op types are
+              added by their saving per unit of error as long as the error of
+              the model stays within accuracy_budget. The other op types go to
+              the black list.
+            - accuracy_budget: The largest relative L2 error of an output of
+              the mixed precision model over the calibration data, 1e-2 by
+              default.
+            - repeat: The number of timed runs of every calibration input, 10
+              by default.
+
+    Returns:
+        With calibration_data, a dict of the chosen 'black_list' and
+        'white_list', to pass to the later conversions of the model; None
+        otherwise.
     '''
     if backend is PlaceType.GPU and not core.is_compiled_with_cuda():
         _logger.error(
@@ -119,6 +142,24 @@ def convert_to_mixed_precision(
     if not os.path.exists(mixed_params_dirname):
         os.makedirs(mixed_params_dirname)
     white_list = kwargs.get('white_list', set())
+    calibration_data = kwargs.get('calibration_data', None)
+    if calibration_data is not None:
+        if backend is not PlaceType.GPU:
+            raise ValueError(
+                "The profiling of convert_to_mixed_precision only supports "
+                "PlaceType.GPU."
+            )
+        black_list = _profile_mixed_precision(
+            model_file,
+            params_file,
+            mixed_precision,
+            backend,
+            black_list,
+            white_list,
+            calibration_data,
+            kwargs.get('accuracy_budget', 1e-2),
+            kwargs.get('repeat', 10),
+        )
     convert_to_mixed_precision_bind(
         model_file,
         params_file,
@@ -130,6 +171,140 @@ def convert_to_mixed_precision(
         black_list,
         white_list,
     )
+    if calibration_data is not None:
+        return {'black_list': set(black_list), 'white_list': set(white_list)}
+
+
+def _model_op_types(model_file):
+    with open(model_file, 'rb') as f:
+        program = paddle.static.Program.parse_from_string(f.read())
+    op_types = set()
+    for block in program.blocks:
+        for op in block.ops:
+            if op.type not in ('feed', 'fetch'):
+                op_types.add(op.type)
+    return op_types
+
+
+def _run_calibration(model_file, params_file, calibration_data, repeat):
+    config = Config(model_file, params_file)
+    config.enable_use_gpu(256, 0)
+    config.disable_glog_info()
+    predictor = paddle.inference.create_predictor(config)
+    input_names = predictor.get_input_names()
+
+    def run(data):
+        if not isinstance(data, dict):
+            data = dict(zip(input_names, data))
+        for name in input_names:
+            predictor.get_input_handle(name).copy_from_cpu(
+                np.asarray(data[name])
+            )
+        predictor.run()
+        # copy_to_cpu waits for the outputs
+        return [
+            predictor.get_output_handle(name).copy_to_cpu()
+            for name in predictor.get_output_names()
+        ]
+
+    outputs = []
+    elapsed = 0.0
+    for data in calibration_data:
+        outputs.append(run(data))  # warmup
+        start = time.perf_counter()
+        for _ in range(repeat):
+            run(data)
+        elapsed += (time.perf_counter() - start) / repeat
+    return outputs, elapsed
+
+
+def _relative_error(outputs, ref_outputs):
+    error = 0.0
+    for outs, refs in zip(outputs, ref_outputs):
+        for out, ref in zip(outs, refs):
+            if not np.issubdtype(ref.dtype, np.floating):
+                # indices and masks need to match exactly
+                if np.any(out != ref):
+                    return np.inf
+                continue
+            out = out.astype(np.float64)
+            ref = ref.astype(np.float64)
+            if not np.all(np.isfinite(out)):
+                return np.inf
+            error = max(
+                error,
+                np.linalg.norm(out - ref) / (np.linalg.norm(ref) + 1e-12),
+            )
+    return error
+
+
+def _profile_mixed_precision(
+    model_file,
+    params_file,
+    mixed_precision,
+    backend,
+    black_list,
+    white_list,
+    calibration_data,
+    accuracy_budget,
+    repeat,
+):
+    ref_outputs, ref_time = _run_calibration(
+        model_file, params_file, calibration_data, repeat
+    )
+    op_types = _model_op_types(model_file)
+    candidates = sorted(op_types - set(black_list))
+    temp_dir = tempfile.mkdtemp()
+
+    def measure(converted, tag):
+        mixed_model_file = os.path.join(temp_dir, tag, 'inference.pdmodel')
+        mixed_params_file = os.path.join(temp_dir, tag, 'inference.pdiparams')
+        os.makedirs(os.path.dirname(mixed_model_file))
+        convert_to_mixed_precision_bind(
+            model_file,
+            params_file,
+            mixed_model_file,
+            mixed_params_file,
+            mixed_precision,
+            backend,
+            True,
+            op_types - set(converted),
+            set(white_list) & set(converted),
+        )
+        outputs, elapsed = _run_calibration(
+            mixed_model_file, mixed_params_file, calibration_data, repeat
+        )
+        return _relative_error(outputs, ref_outputs), elapsed
+
+    try:
+        profiles = []
+        for i, op_type in enumerate(candidates):
+            error, elapsed = measure([op_type], f'op_{i}')
+            saving = ref_time - elapsed
+            _logger.info(
+                f"convert_to_mixed_precision profiles {op_type}: error "
+                f"{error:.3e}, saves {saving * 1e3:.3f} ms"
+            )
+            if error <= accuracy_budget and saving > 0:
+                profiles.append((saving / max(error, 1e-12), op_type))
+
+        # greedily add the op types of the best saving per error, checking
+        # the whole model since the errors of the op types don't just add up
+        chosen = []
+        model_time = ref_time
+        for step, (_, op_type) in enumerate(sorted(profiles, reverse=True)):
+            error, elapsed = measure(chosen + [op_type], f'step_{step}')
+            if error <= accuracy_budget:
+                chosen.append(op_type)
+                model_time = elapsed
+        _logger.info(
+            f"convert_to_mixed_precision converts {sorted(chosen)}, "
+            f"estimated {model_time * 1e3:.3f} ms against "
+            f"{ref_time * 1e3:.3f} ms in fp32"
+        )
+    finally:
+        shutil.rmtree(temp_dir, ignore_errors=True)
+    return set(black_list) | (op_types - set(chosen))
 
 
 Tensor.copy_from_cpu = tensor_copy_from_cpu
@@ -20,6 +20,7 @@ from .dataloader import (
     ComposeDataset,
     ConcatDataset,
     Dataset,
+    DevicePipeline,
     DistributedBatchSampler,
     IterableDataset,
     RandomSampler,
@@ -43,6 +44,7 @@ __all__ = [
     'BatchSampler',
     'DistributedBatchSampler',
     'DataLoader',
+    'DevicePipeline',
     'get_worker_info',
     'Sampler',
     'SequenceSampler',
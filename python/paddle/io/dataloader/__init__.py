@@ -26,6 +26,7 @@ from .dataset import (  # noqa: F401
     TensorDataset,
     random_split,
 )
+from .device_pipeline import DevicePipeline  # noqa: F401
 from .sampler import (  # noqa: F401
     RandomSampler,
     Sampler,
@@ -41,6 +41,7 @@ from .batch_sampler import _InfiniteIterableSampler
 from .collate import default_collate_fn, default_convert_fn
 from .flat import _flatten_batch, _restore_batch
 from .worker import (
+    _BatchRingSlot,
     _DatasetKind,
     _IterableDatasetStopIteration,
     _ResumeIteration,
@@ -429,6 +430,22 @@ class _DataLoaderIterMultiProcess(_DataLoaderIterBase):
             (self._worker_shm_buffer_size) * 2 * self._num_workers
         )
 
+        # the workers write the batches into the slots of their shared memory
+        # rings, which are enough for the outstanding batches of each worker
+        # and the ones in use, see core.SharedMemoryBatchRing
+        self._batch_ring_slot_num = 0
+        self._batch_rings = {}
+        if (
+            self._use_shared_memory
+            and sys.platform != 'win32'
+            and paddle.get_flags('FLAGS_dataloader_use_shared_memory_ring')[
+                'FLAGS_dataloader_use_shared_memory_ring'
+            ]
+        ):
+            self._batch_ring_slot_num = (
+                -(-self._outstanding_capacity // self._num_workers) + 2
+            )
+
         # init workers and indices queues and put 2 indices in each indices queue
         self._init_workers()
         for _ in range(self._outstanding_capacity):
@@ -473,6 +490,7 @@ class _DataLoaderIterMultiProcess(_DataLoaderIterBase):
                     self._use_shared_memory,
                     self._base_seed,
                     self._worker_shm_buffer_size,
+                    self._batch_ring_slot_num,
                 ),
             )
             worker.daemon = True
@@ -629,7 +647,10 @@ class _DataLoaderIterMultiProcess(_DataLoaderIterBase):
                     try:
                         # pack as LoDTensorArray
                         array = core.LoDTensorArray()
-                        if self._use_shared_memory:
+                        if isinstance(batch, _BatchRingSlot):
+                            for tensor in self._wrap_batch_ring_slot(batch):
+                                array.append(tensor)
+                        elif self._use_shared_memory:
                             for tensor in batch:
                                 array.append(tensor)
                         else:
@@ -652,6 +673,17 @@ class _DataLoaderIterMultiProcess(_DataLoaderIterBase):
                     finally:
                         self._rcvd_idx += 1
 
+    def _wrap_batch_ring_slot(self, ring_slot):
+        ring = self._batch_rings.get(ring_slot.worker_id)
+        if ring is None or ring.ipc_name != ring_slot.ipc_name:
+            # the worker replaces its ring by a larger one, the tensors of
+            # the old ring keep it mapped until they are released
+            ring = core.SharedMemoryBatchRing.open(
+                ring_slot.ipc_name, ring_slot.slot_num, ring_slot.slot_size
+            )
+            self._batch_rings[ring_slot.worker_id] = ring
+        return ring.wrap(ring_slot.slot, ring_slot.metas)
+
     def _get_data(self):
         while not self._thread_done_event.is_set():
             # For IterableDataset, batch indices is generated infinitely
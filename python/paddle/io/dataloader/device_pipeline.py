@@ -0,0 +1,126 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import annotations
+
+from collections import deque
+from typing import TYPE_CHECKING, Any, Callable
+
+import paddle
+
+from ...framework import core
+
+if TYPE_CHECKING:
+    from collections.abc import Iterable, Iterator
+
+
+class DevicePipeline:
+    """
+    Runs the transform of the batches of a data loader on a dedicated device
+    stream, e.g. decoding the JPEG images with ``paddle.vision.ops.decode_jpeg``
+    and augmenting them with ``paddle.vision.ops.resized_crop_normalize`` on
+    GPU, instead of on the CPU workers.
+
+    The transform of the next ``prefetch`` batches is enqueued on the stream
+    before a batch is returned, so it overlaps with the training step of the
+    current batch on the default stream. The current stream waits for the
+    transform of a batch only when the batch is returned, and the memory of
+    the returned tensors is not reused by the pipeline stream until the
+    current stream is done with them.
+
+    Args:
+        loader (Iterable): The data loader, e.g. ``paddle.io.DataLoader``,
+            whose batches are transformed.
+        transform (Callable): The function from a batch of the loader to the
+            transformed batch, which runs the device kernels.
+        prefetch (int, optional): The number of the batches transformed ahead
+            of the one being used. Default: 1.
+
+    Examples:
+        .. code-block:: python
+
+            >>> import paddle
+            >>> from paddle.io import DataLoader, DevicePipeline, TensorDataset
+
+            >>> images = paddle.randint(0, 256, [8, 3, 64, 64]).astype('uint8')
+            >>> loader = DataLoader(TensorDataset([images]), batch_size=4)
+
+            >>> def augment(batch):
+            ...     return paddle.vision.ops.resized_crop_normalize(
+            ...         batch[0], [8, 8, 48, 48], [32, 32], [127.5], [127.5]
+            ...     )
+
+            >>> for image in DevicePipeline(loader, augment):
+            ...     print(image.shape)
+            [4, 3, 32, 32]
+            [4, 3, 32, 32]
+    """
+
+    def __init__(
+        self,
+        loader: Iterable[Any],
+        transform: Callable[[Any], Any],
+        prefetch: int = 1,
+    ) -> None:
+        if prefetch < 1:
+            raise ValueError(
+                f"prefetch should be at least 1, but received {prefetch}."
+            )
+        self._loader = loader
+        self._transform = transform
+        self._prefetch = prefetch
+
+    def __len__(self) -> int:
+        return len(self._loader)
+
+    def __iter__(self) -> Iterator[Any]:
+        place = paddle.framework._current_expected_place()
+        if not (
+            paddle.is_compiled_with_cuda()
+            and isinstance(place, paddle.CUDAPlace)
+        ):
+            for batch in self._loader:
+                yield self._transform(batch)
+            return
+
+        stream = paddle.device.Stream(place)
+        current_stream = paddle.device.current_stream(place)
+        batches = iter(self._loader)
+        pending = deque()
+
+        def enqueue():
+            try:
+                batch = next(batches)
+            except StopIteration:
+                return
+            # the batch may be produced by the kernels of the current stream
+            stream.wait_stream(current_stream)
+            with paddle.device.stream_guard(stream):
+                out = self._transform(batch)
+            pending.append((out, stream.record_event()))
+
+        for _ in range(self._prefetch):
+            enqueue()
+        while pending:
+            out, event = pending.popleft()
+            current_stream.wait_event(event)
+            core.eager.record_stream(
+                [
+                    t
+                    for t in paddle.utils.flatten(out)
+                    if isinstance(t, paddle.Tensor)
+                ]
+            )
+            enqueue()
+            yield out
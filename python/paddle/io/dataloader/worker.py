@@ -76,6 +76,53 @@ class ParentWatchDog:
         return self._parent_alive
 
 
+class _BatchRingSlot:
+    """
+    The batch written into a slot of the shared memory batch ring of a
+    worker, which is put into out_queue instead of the tensors, see
+    core.SharedMemoryBatchRing.
+    """
+
+    def __init__(self, worker_id, ring, slot, metas):
+        self.worker_id = worker_id
+        self.ipc_name = ring.ipc_name
+        self.slot_num = ring.slot_num
+        self.slot_size = ring.slot_size
+        self.slot = slot
+        self.metas = metas
+
+
+class _BatchRingWriter:
+    _MIN_SLOT_SIZE = 4 << 20
+
+    def __init__(self, worker_id, slot_num):
+        self._worker_id = worker_id
+        self._slot_num = slot_num
+        self._ring = None
+
+    def write(self, batch):
+        """
+        Returns the _BatchRingSlot of the batch, or None if the batch can not
+        be written into the ring, e.g. all slots are in use.
+        """
+        nbytes = core.SharedMemoryBatchRing.nbytes(batch)
+        if nbytes < 0:
+            return None
+        if self._ring is None or nbytes > self._ring.slot_size:
+            # the slots hold twice the batch, so that the batches of variable
+            # sizes mostly fit in them
+            # the slots in use of the old ring are released by the main
+            # process as usual, which unmaps it after that
+            self._ring = core.SharedMemoryBatchRing(
+                self._slot_num, max(2 * nbytes, self._MIN_SLOT_SIZE)
+            )
+        slot = self._ring.acquire()
+        if slot < 0:
+            return None
+        metas = self._ring.write(slot, batch)
+        return _BatchRingSlot(self._worker_id, self._ring, slot, metas)
+
+
 # worker information for each workers, used for splitting data copy
 # for IteratorDataset in worker processes.
 _worker_info = None
@@ -293,6 +340,7 @@ def _worker_loop(
     use_shared_memory,
     base_seed,
     shm_cache_size=0,
+    batch_ring_slot_num=0,
 ):
     try:
         # NOTE: [ mmap files clear ] When the child process exits unexpectedly,
@@ -339,6 +387,11 @@ def _worker_loop(
 
         iterator_drained = False
         parent_watch_dog = ParentWatchDog()
+        batch_ring_writer = (
+            _BatchRingWriter(worker_id, batch_ring_slot_num)
+            if use_shared_memory and batch_ring_slot_num > 0
+            else None
+        )
 
         while parent_watch_dog.is_alive():
             try:
@@ -391,7 +444,16 @@ def _worker_loop(
                 if isinstance(batch, _WorkerException):
                     out_queue.put((idx, batch, None))
                 batch, structure = _flatten_batch(batch)
-                if use_shared_memory:
+                ring_slot = None
+                if batch_ring_writer is not None:
+                    items = [
+                        b.get_tensor() if isinstance(b, paddle.Tensor) else b
+                        for b in batch
+                    ]
+                    ring_slot = batch_ring_writer.write(items)
+                if ring_slot is not None:
+                    out_queue.put((idx, ring_slot, structure))
+                elif use_shared_memory:
 
                     def numpy2lodtensor(arr):
                         lodtensor = core.Tensor()
@@ -206,6 +206,7 @@ def flash_attention(
     fixed_seed_offset: Tensor | None = ...,
     rng_name: str = ...,
     training: bool = ...,
+    window_size: int | None = ...,
     name: str | None = ...,
 ) -> tuple[Tensor, None]:
     ...
@@ -223,6 +224,7 @@ def flash_attention(
     fixed_seed_offset: Tensor | None = ...,
     rng_name: str = ...,
     training: bool = ...,
+    window_size: int | None = ...,
     name: str | None = ...,
 ) -> tuple[Tensor, Tensor]:
     ...
@@ -240,6 +242,7 @@ def flash_attention(
     fixed_seed_offset: Tensor | None = ...,
     rng_name: str = ...,
     training: bool = ...,
+    window_size: int | None = ...,
     name: str | None = ...,
 ) -> tuple[Tensor, Tensor | None]:
     ...
@@ -256,6 +259,7 @@ def flash_attention(
     fixed_seed_offset=None,
     rng_name="",
     training=True,
+    window_size=None,
     name=None,
 ):
     r"""
@@ -266,7 +270,9 @@ def flash_attention(
         result=softmax(\frac{ Q * K^T }{\sqrt{d}}) * V
 
     where : ``Q``, ``K``, and ``V`` represent the three input parameters of the attention module.
-    The dimensions of the three parameters are the same.
+    The dimensions of the three parameters are the same, except that the
+    number of the heads of ``K`` and ``V`` can be a divisor of the one of
+    ``Q`` for the grouped-query attention, without repeating them.
     ``d`` represents the size of the last dimension of the three parameters.
 
     Warning:
@@ -291,6 +297,13 @@ def flash_attention(
         fixed_seed_offset(Tensor|None, optional): With fixed seed, offset for dropout mask.
         training(bool): Whether it is in the training phase.
         rng_name(str): The name to select Generator.
+        window_size(int|None, optional): The size of the sliding window of
+                        the causal attention, where each query only attends
+                        to itself and the window_size - 1 keys before it.
+                        The window is passed to the kernel as the rows where
+                        the mask of each key starts, so no mask is built and
+                        the blocks out of the window are skipped. Default is
+                        None, means no window.
         name(str|None, optional): The default value is None. Normally there is no need for user
                         to set this property. For more information, please refer to
                         :ref:`api_guide_Name`.
@@ -326,6 +339,48 @@ def flash_attention(
     head_dim = query.shape[3]
     sdp_func_name = _select_sdp(head_dim)
 
+    if window_size is not None:
+        assert (
+            causal is True
+        ), f"causal must be True when window_size is set, but got {causal}"
+        assert (
+            isinstance(window_size, int) and window_size > 0
+        ), f"window_size must be a positive int, but got {window_size}"
+        if sdp_func_name != "flash_attn" or not in_dynamic_or_pir_mode():
+            raise NotImplementedError(
+                "window_size of flash_attention is only supported by the "
+                "flash_attn kernel in dynamic graph mode and PIR mode."
+            )
+        # Key j is masked from query j + window_size on.
+        batch_size, seq_len, num_heads = query.shape[:3]
+        start_row_indices = paddle.arange(
+            window_size, seq_len + window_size, dtype=paddle.int32
+        )
+        start_row_indices = paddle.clip(start_row_indices, max=seq_len)
+        start_row_indices = paddle.expand(
+            start_row_indices.reshape([1, 1, seq_len]),
+            [batch_size, num_heads, seq_len],
+        )
+        (
+            result_attention,
+            result_softmax,
+            _,
+            _,
+        ) = _C_ops.flash_attn_with_sparse_mask(
+            query,
+            key,
+            value,
+            start_row_indices,
+            fixed_seed_offset,
+            dropout,
+            causal,
+            0,
+            return_softmax,
+            not training,
+            rng_name,
+        )
+        return result_attention, result_softmax if return_softmax else None
+
     if sdp_func_name == "flash_attn":
         if in_dynamic_or_pir_mode():
             (result_attention, result_softmax, _, _) = _C_ops.flash_attn(
@@ -26,10 +26,12 @@ from paddle.base.core import (
     ProfilerOptions,
     TracerEventType,
     _Profiler,
+    clear_mem_tensor_names,
     disable_memory_recorder,
     disable_op_info_recorder,
     enable_memory_recorder,
     enable_op_info_recorder,
+    get_mem_tensor_names,
 )
 from paddle.profiler import utils
 
@@ -588,6 +590,7 @@ class Profiler:
         if self.record_shapes or self.with_flops:
             enable_op_info_recorder()
         if self.profile_memory:
+            clear_mem_tensor_names()
             enable_memory_recorder()
         # CLOSED -> self.current_state
         if self.current_state == ProfilerState.READY:
@@ -889,6 +892,7 @@ class Profiler:
             statistic_data = StatisticData(
                 self.profiler_result.get_data(),
                 self.profiler_result.get_extra_info(),
+                get_mem_tensor_names() if self.profile_memory else None,
             )
             print(
                 _build_table(
@@ -904,6 +908,40 @@ class Profiler:
         if self.with_flops:
             self._print_flops()
 
+    def export_memory_timeline(self, path, top_n=10):
+        r"""
+        Exports the timeline of the allocated memory of each place as the
+        counters of the chrome tracing, which requires profile_memory=True. At
+        the peak of each place, an instant event lists the top_n operators and
+        tensors holding the most memory.
+
+        Args:
+            path(str): file path of the output.
+            top_n(int, optional): the number of the contributors of the peak
+                to list, default value is 10.
+
+        Examples:
+            .. code-block:: python
+
+                >>> # doctest: +REQUIRES(env:GPU)
+                >>> import paddle
+                >>> paddle.device.set_device('gpu')
+                >>> import paddle.profiler as profiler
+                >>> prof = profiler.Profiler(profile_memory=True)
+                >>> prof.start()
+                >>> x = paddle.rand([1024, 1024])
+                >>> y = paddle.matmul(x, x)
+                >>> prof.stop()
+                >>> prof.export_memory_timeline("./memory_timeline.json")
+        """
+        if self.profiler_result:
+            statistic_data = StatisticData(
+                self.profiler_result.get_data(),
+                self.profiler_result.get_extra_info(),
+                get_mem_tensor_names(),
+            )
+            statistic_data.memory_timeline.export(path, top_n)
+
     def _print_flops(self, repeat=1):
         if not self.with_flops:
             print('ERROR: with_flops disabled.')
@@ -11,10 +11,14 @@
 # WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 # See the License for the specific language governing permissions and
 # limitations under the License.
+import bisect
 import collections
+import json
+import math
 import re
 from enum import Enum
 
+from paddle.base import core
 from paddle.base.core import TracerEventType, TracerMemEventType
 from paddle.utils.flops import flops
 
@@ -45,6 +49,96 @@ _AllTracerEventType = [
 
 _CommunicationOpName = ['allreduce', 'broadcast', 'rpc']
 
+# The sizes of the dtypes recorded with the input shapes of the operators.
+_DtypeBytes = {
+    'BOOL': 1,
+    'INT8': 1,
+    'UINT8': 1,
+    'INT16': 2,
+    'INT32': 4,
+    'INT64': 8,
+    'FP8_E4M3FN': 1,
+    'FP8_E5M2': 1,
+    'FP16': 2,
+    'BF16': 2,
+    'FP32': 4,
+    'FP64': 8,
+    'COMPLEX64': 8,
+    'COMPLEX128': 16,
+}
+
+# The dense FLOPs per clock of a SM, by the CUDA cores in FP32 and by the
+# tensor cores in FP16 and BF16, for the roofline of the kernels.
+_CudaCoreFlopsPerClock = {
+    (6, 0): 128,
+    (6, 1): 256,
+    (7, 0): 128,
+    (7, 2): 128,
+    (7, 5): 128,
+    (8, 0): 128,
+    (8, 6): 256,
+    (8, 7): 256,
+    (8, 9): 256,
+    (9, 0): 256,
+}
+_TensorCoreFlopsPerClock = {
+    (7, 0): 1024,
+    (7, 2): 1024,
+    (7, 5): 1024,
+    (8, 0): 2048,
+    (8, 6): 1024,
+    (8, 7): 1024,
+    (8, 9): 1024,
+    (9, 0): 4096,
+}
+
+_device_peaks = {}
+
+
+def _get_device_peaks(device_id):
+    r'''
+    Returns the peak FLOPS of the CUDA cores and the tensor cores, and the
+    peak DRAM bandwidth in bytes per second of the device, which are None if
+    they are unknown.
+    '''
+    if device_id in _device_peaks:
+        return _device_peaks[device_id]
+    peaks = (None, None, None)
+    if core.is_compiled_with_cuda() and not core.is_compiled_with_rocm():
+        try:
+            prop = core.get_device_properties(device_id)
+            arch = (prop.major, prop.minor)
+            clock = prop.clock_rate * 1e3 * prop.multi_processor_count
+            bandwidth = (
+                2 * prop.memory_clock_rate * 1e3 * prop.memory_bus_width / 8
+            )
+            peaks = (
+                clock * _CudaCoreFlopsPerClock.get(arch, 0) or None,
+                clock * _TensorCoreFlopsPerClock.get(arch, 0) or None,
+                bandwidth or None,
+            )
+        except Exception:
+            pass
+    _device_peaks[device_id] = peaks
+    return peaks
+
+
+def _get_input_bytes(hostnode):
+    r'''
+    Returns the bytes of the inputs of the operator, and whether any of them
+    is in FP16 or BF16.
+    '''
+    input_bytes = 0
+    is_half = False
+    for name, shapes in hostnode.input_shapes.items():
+        dtypes = hostnode.dtypes.get(name, [])
+        for shape, dtype in zip(shapes, dtypes):
+            input_bytes += math.prod(max(dim, 0) for dim in shape) * (
+                _DtypeBytes.get(dtype, 0)
+            )
+            is_half = is_half or dtype in ('FP16', 'BF16')
+    return input_bytes, is_half
+
 
 class SortedKeys(Enum):
     r"""
@@ -568,9 +662,61 @@ class EventSummary:
             raise NotImplementedError
 
     class DeviceItem(ItemBase):
+        def __init__(self, name):
+            super().__init__(name)
+            self.occupancy_time = 0
+            # the roofline is estimated by the FLOPs and the input bytes of
+            # the operators launching the kernel, over the time of the kernel
+            # calls which have the estimates
+            self.bytes = 0
+            self.estimated_gpu_time = 0
+            self.roofline_time = 0
+
+        @property
+        def avg_occupancy(self):
+            if self.gpu_time == 0:
+                return 0
+            return self.occupancy_time / self.gpu_time
+
+        @property
+        def arithmetic_intensity(self):
+            if self.bytes == 0:
+                return None
+            return self.flops / self.bytes
+
+        @property
+        def roofline_ratio(self):
+            if self.estimated_gpu_time == 0:
+                return None
+            return self.roofline_time / self.estimated_gpu_time
+
         def add_item(self, node):
             self.call += 1
             self.add_gpu_time(node.end_ns - node.start_ns)
+            if node.type == TracerEventType.Kernel:
+                self.occupancy_time += getattr(node, 'occupancy', 0) * (
+                    node.end_ns - node.start_ns
+                )
+
+        def add_estimate(self, node, flops, input_bytes, is_half):
+            self.add_flops(flops)
+            self.bytes += input_bytes
+            cuda_core_flops, tensor_core_flops, bandwidth = _get_device_peaks(
+                node.device_id
+            )
+            peak_flops = (
+                tensor_core_flops
+                if is_half and tensor_core_flops
+                else cuda_core_flops
+            )
+            if peak_flops is None or bandwidth is None:
+                return
+            # the time of the kernel at the roofline, which is bound by the
+            # compute or the memory
+            self.roofline_time += (
+                max(flops / peak_flops, input_bytes / bandwidth) * 1e9
+            )
+            self.estimated_gpu_time += node.end_ns - node.start_ns
 
     class OperatorItem(ItemBase):
         def add_item(self, node):
@@ -661,6 +807,8 @@ class EventSummary:
                         ):
                             self.add_userdefined_item(host_statistic_node)
             self.add_kernel_item(host_statistic_nodes[0])
+            for host_statistic_node in host_statistic_nodes[1:]:
+                self.add_kernel_estimate(host_statistic_node)
 
         for threadid, root_statistic_node in node_statistic_trees.items():
             deque = collections.deque()
@@ -755,6 +903,35 @@ class EventSummary:
                     self.kernel_items[name] = EventSummary.DeviceItem(name)
                 self.kernel_items[name].add_item(device_node)
 
+    def add_kernel_estimate(self, operator_node):
+        r'''
+        Shares the FLOPs and the input bytes of the innermost operators among
+        their kernels by the time of the kernels.
+        '''
+        if operator_node.type != TracerEventType.Operator:
+            return
+        if operator_node.flops == 0 or any(
+            child.type == TracerEventType.Operator
+            for child in operator_node.children_node
+        ):
+            return
+        input_bytes, is_half = _get_input_bytes(operator_node)
+        if input_bytes == 0:
+            return
+        kernel_nodes = [
+            device_node
+            for device_node in get_device_nodes(operator_node)
+            if device_node.type == TracerEventType.Kernel
+        ]
+        kernel_time = sum(node.end_ns - node.start_ns for node in kernel_nodes)
+        if kernel_time == 0:
+            return
+        for node in kernel_nodes:
+            share = (node.end_ns - node.start_ns) / kernel_time
+            self.kernel_items[node.name].add_estimate(
+                node, operator_node.flops * share, input_bytes * share, is_half
+            )
+
 
 class MemorySummary:
     r"""
@@ -852,22 +1029,180 @@ class MemorySummary:
                 self._analyse_node_memory(host_node.name, host_node)
 
 
+class MemoryTimeline:
+    r"""
+    Replays the allocations and the frees of each place in time order, to find
+    the peak of the allocated memory and the allocations live at the peak.
+    Each allocation is attributed to the innermost operator allocating it,
+    and to the tensor holding it if its name is recorded by the executor.
+    """
+
+    class Allocation:
+        def __init__(self, addr, size, op_name, start_ns):
+            self.addr = addr
+            self.size = size
+            self.op_name = op_name
+            self.tensor_name = '-'
+            self.start_ns = start_ns
+            self.end_ns = float('inf')
+
+    def __init__(self, tensor_names=None):
+        # place: [(timestamp_ns, allocated bytes)]
+        self.points = collections.defaultdict(list)
+        self.peak_values = collections.defaultdict(int)
+        self.peak_timestamps = {}
+        # place: the allocations live at the peak, the largest first
+        self.peak_allocations = {}
+        # addr: the sorted [(timestamp_ns, tensor name)]
+        self.tensor_names = collections.defaultdict(list)
+        for timestamp_ns, addr, name in tensor_names or []:
+            self.tensor_names[addr].append((timestamp_ns, name))
+        for records in self.tensor_names.values():
+            records.sort()
+
+    def _tensor_name(self, allocation):
+        records = self.tensor_names.get(allocation.addr)
+        if not records:
+            return '-'
+        index = bisect.bisect_left(records, (allocation.start_ns, ''))
+        if index < len(records) and records[index][0] <= allocation.end_ns:
+            return records[index][1]
+        return '-'
+
+    def parse(self, nodetrees):
+        events = collections.defaultdict(list)
+        for rootnode in nodetrees.values():
+            stack = [(rootnode, None)]
+            while stack:
+                node, op_name = stack.pop()
+                if node.type == TracerEventType.Operator:
+                    op_name = node.name
+                for memnode in node.mem_node:
+                    if memnode.type in (
+                        TracerMemEventType.Allocate,
+                        TracerMemEventType.Free,
+                    ):
+                        events[memnode.place].append(
+                            (memnode, op_name or node.name)
+                        )
+                for child in node.children_node:
+                    stack.append((child, op_name))
+
+        for place, place_events in events.items():
+            place_events.sort(key=lambda event: event[0].timestamp_ns)
+            live = {}
+            allocations = []
+            peak_index = -1
+            for index, (memnode, op_name) in enumerate(place_events):
+                if memnode.type == TracerMemEventType.Allocate:
+                    allocation = MemoryTimeline.Allocation(
+                        memnode.addr,
+                        memnode.increase_bytes,
+                        op_name,
+                        memnode.timestamp_ns,
+                    )
+                    live[memnode.addr] = allocation
+                    allocations.append(allocation)
+                elif memnode.addr in live:
+                    live.pop(memnode.addr).end_ns = memnode.timestamp_ns
+                self.points[place].append(
+                    (memnode.timestamp_ns, memnode.current_allocated)
+                )
+                if memnode.current_allocated > self.peak_values[place]:
+                    self.peak_values[place] = memnode.current_allocated
+                    peak_index = index
+            if peak_index < 0:
+                continue
+            peak_ns = place_events[peak_index][0].timestamp_ns
+            self.peak_timestamps[place] = peak_ns
+            peak_allocations = [
+                allocation
+                for allocation in allocations
+                if allocation.start_ns <= peak_ns < allocation.end_ns
+            ]
+            for allocation in peak_allocations:
+                allocation.tensor_name = self._tensor_name(allocation)
+            peak_allocations.sort(key=lambda x: x.size, reverse=True)
+            self.peak_allocations[place] = peak_allocations
+
+    def peak_contributors(self, place):
+        r"""
+        Returns [(op name, tensor name, count, bytes)] of the allocations live
+        at the peak of the place, the largest first. The bytes allocated
+        before the profiling are attributed to '-'.
+        """
+        contributors = collections.OrderedDict()
+        for allocation in self.peak_allocations.get(place, []):
+            key = (allocation.op_name, allocation.tensor_name)
+            count, size = contributors.get(key, (0, 0))
+            contributors[key] = (count + 1, size + allocation.size)
+        result = [
+            (op_name, tensor_name, count, size)
+            for (op_name, tensor_name), (count, size) in contributors.items()
+        ]
+        untracked = self.peak_values[place] - sum(x[3] for x in result)
+        if untracked > 0:
+            result.append(('-', '-', 0, untracked))
+        result.sort(key=lambda x: x[3], reverse=True)
+        return result
+
+    def export(self, path, top_n=10):
+        r"""
+        Exports the allocated memory of each place as the counters of the
+        chrome tracing, with an instant event at each peak whose args are the
+        top_n contributors of the peak.
+        """
+        trace_events = []
+        for place, points in self.points.items():
+            for timestamp_ns, allocated in points:
+                trace_events.append(
+                    {
+                        'name': f'Allocated Memory {place}',
+                        'ph': 'C',
+                        'ts': timestamp_ns / 1000,
+                        'pid': 'Memory',
+                        'args': {'allocated': allocated},
+                    }
+                )
+            if place not in self.peak_timestamps:
+                continue
+            trace_events.append(
+                {
+                    'name': f'Peak Allocated Memory {place}',
+                    'ph': 'i',
+                    's': 'g',
+                    'ts': self.peak_timestamps[place] / 1000,
+                    'pid': 'Memory',
+                    'args': {
+                        f'{op_name} / {tensor_name}': size
+                        for op_name, tensor_name, _, size in (
+                            self.peak_contributors(place)[:top_n]
+                        )
+                    },
+                }
+            )
+        with open(path, 'w') as f:
+            json.dump({'traceEvents': trace_events}, f)
+
+
 class StatisticData:
     r"""
     Hold all analysed results.
     """
 
-    def __init__(self, node_trees, extra_info):
+    def __init__(self, node_trees, extra_info, mem_tensor_names=None):
         self.node_trees = node_trees
         self.extra_info = extra_info
         self.time_range_summary = TimeRangeSummary()
         self.event_summary = EventSummary()
         self.distributed_summary = DistributedSummary()
         self.memory_summary = MemorySummary()
+        self.memory_timeline = MemoryTimeline(mem_tensor_names)
         self.time_range_summary.parse(node_trees)
         self.event_summary.parse(node_trees)
         self.distributed_summary.parse(node_trees)
         self.memory_summary.parse(node_trees)
+        self.memory_timeline.parse(node_trees)
 
 
 def _build_table(
@@ -1633,10 +1968,19 @@ def _build_table(
                     gpu_ratio = 0
                 else:
                     gpu_ratio = float(item.gpu_time) / total_kernel_gpu_time
+                intensity = item.arithmetic_intensity
+                roofline_ratio = item.roofline_ratio
                 row_values = [
                     name,
                     item.call,
                     f'{format_time(item.gpu_time, unit=time_unit)} / {format_time(item.avg_gpu_time, unit=time_unit)} / {format_time(item.max_gpu_time, unit=time_unit)} / {format_time(item.min_gpu_time, unit=time_unit)} / {format_ratio(gpu_ratio)}',
+                    format_ratio(item.avg_occupancy),
+                    '-' if intensity is None else f'{intensity:.2f}',
+                    (
+                        '-'
+                        if roofline_ratio is None
+                        else format_ratio(roofline_ratio)
+                    ),
                 ]
                 all_row_values.append(row_values)
 
@@ -1644,6 +1988,9 @@ def _build_table(
                 'Name',
                 'Calls',
                 'GPU Total / Avg / Max / Min / Ratio(%)',
+                'Occupancy(%)',
+                'FLOPs/Byte',
+                'Roofline(%)',
             ]
             # Calculate the column width
             name_column_width = 90
@@ -1664,6 +2011,9 @@ def _build_table(
             add_column(name_column_width)
             add_column(calltime_width)
             add_column(gpu_data_description_width)
+            add_column(12)
+            add_column(10)
+            add_column(11)
 
             row_format = row_format_list[0]
             header_sep = header_sep_list[0]
@@ -1672,6 +2022,12 @@ def _build_table(
             # construct table string
             append(add_title(line_length, "Kernel Summary"))
             append(f'Time unit: {time_unit}')
+            append(
+                'Occupancy is the theoretical occupancy of the launches. '
+                'FLOPs/Byte and Roofline are estimated by the FLOPs and the '
+                'input bytes of the operators, which are recorded with '
+                'record_shapes=True.'
+            )
             append(header_sep)
             append(row_format.format(*headers))
             append(header_sep)
@@ -2010,4 +2366,45 @@ def _build_table(
                 append('')
                 append('')
 
+        # ----- Print Memory Peak Attribution Report ----- #
+        memory_timeline = statistic_data.memory_timeline
+        for place in memory_timeline.peak_timestamps:
+            headers = ['Operator', 'Tensor', 'Allocations', 'Live Size']
+            row_format_list = [""]
+            header_sep_list = [""]
+            line_length_list = [-SPACING_SIZE]
+            add_column(50)
+            add_column(40)
+            add_column(12)
+            add_column(15)
+            row_format = row_format_list[0]
+            header_sep = header_sep_list[0]
+            line_length = line_length_list[0]
+
+            append(
+                add_title(line_length, f"Memory Peak Attribution - {place}")
+            )
+            append(
+                f'Peak Allocated Memory: {memory_timeline.peak_values[place]}'
+            )
+            append(
+                'The allocations live at the peak, by the operators allocating '
+                'them and the tensors holding them. "-" is for the memory '
+                'allocated before the profiling or out of the operators.'
+            )
+            append(header_sep)
+            append(row_format.format(*headers))
+            append(header_sep)
+            for op_name, tensor_name, count, size in (
+                memory_timeline.peak_contributors(place)[:row_limit]
+            ):
+                if len(op_name) > 50:
+                    op_name = op_name[:47] + '...'
+                if len(tensor_name) > 40:
+                    tensor_name = tensor_name[:37] + '...'
+                append(row_format.format(op_name, tensor_name, count, size))
+            append(header_sep)
+            append('')
+            append('')
+
     return ''.join(result)
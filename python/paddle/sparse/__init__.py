@@ -24,7 +24,7 @@ from .binary import (
     mv,
     subtract,
 )
-from .creation import sparse_coo_tensor, sparse_csr_tensor
+from .creation import sparse_coo_tensor, sparse_csr_tensor, to_sparse_bsr
 from .multiary import addmm
 from .unary import (
     abs,
@@ -57,6 +57,7 @@ from .unary import (
 __all__ = [
     'sparse_coo_tensor',
     'sparse_csr_tensor',
+    'to_sparse_bsr',
     'sin',
     'tan',
     'asin',
@@ -40,6 +40,7 @@ if TYPE_CHECKING:
 __all__ = [
     'sparse_coo_tensor',
     'sparse_csr_tensor',
+    'to_sparse_bsr',
 ]
 
 
@@ -313,3 +314,49 @@ def sparse_csr_tensor(
     return core.eager.sparse_csr_tensor(
         crows, cols, values, shape, stop_gradient
     )
+
+
+@dygraph_only
+def to_sparse_bsr(
+    x: Tensor, block_size: int, name: str | None = None
+) -> Tensor:
+    r"""
+    Converts a 2-D dense ``paddle.Tensor`` or a sparse ``paddle.Tensor`` in COO format
+    into a sparse ``paddle.Tensor`` in CSR format stored in blocks (BSR). The ``crows``
+    and ``cols`` of the result index the non-zero blocks of ``block_size`` x ``block_size``
+    elements, and its ``values`` are of shape [number of the non-zero blocks, block_size,
+    block_size]. A block is non-zero if any of its elements is non-zero.
+
+    The result can be multiplied with a dense ``paddle.Tensor`` by ``paddle.sparse.matmul``,
+    which runs on the tensor cores on GPU for float16 and bfloat16 when ``block_size`` and
+    the columns of the dense tensor are multiples of 16.
+
+    Args:
+        x(Tensor): The 2-D dense tensor or sparse tensor in COO format, whose shape should
+            be divisible by ``block_size``.
+        block_size(int): The number of the rows and the columns of each block.
+        name(str|None, optional): Name for the operation (optional, default is None).
+            For more information, please refer to :ref:`api_guide_Name`.
+
+    Returns:
+        Tensor: The sparse tensor in CSR format stored in blocks.
+
+    Examples:
+
+        .. code-block:: python
+
+            >>> import paddle
+
+            >>> x = paddle.to_tensor([[1., 2., 0., 0.],
+            ...                       [0., 3., 0., 0.],
+            ...                       [0., 0., 0., 0.],
+            ...                       [0., 0., 4., 0.]])
+            >>> bsr = paddle.sparse.to_sparse_bsr(x, 2)
+            >>> print(bsr.crows())
+            Tensor(shape=[3], dtype=int64, place=Place(cpu), stop_gradient=True,
+                   [0, 1, 2])
+            >>> print(bsr.cols())
+            Tensor(shape=[2], dtype=int64, place=Place(cpu), stop_gradient=True,
+                   [0, 1])
+    """
+    return _C_ops.sparse_to_sparse_bsr(x, block_size)
@@ -17,6 +17,9 @@ from .post_training_quantization import (  # noqa: F401
     PostTrainingQuantizationProgram,
     WeightQuantization,
 )
+from .pir_post_training_quantization import (  # noqa: F401
+    PirPostTrainingQuantization,
+)
 from .quant2_int8_onednn_pass import (  # noqa: F401
     Quant2Int8MkldnnPass,
 )
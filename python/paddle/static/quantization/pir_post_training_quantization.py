@@ -0,0 +1,416 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import logging
+
+import numpy as np
+
+import paddle
+from paddle.autograd.backward_utils import ValueDict
+from paddle.utils import unique_name
+
+from ...base.log_helper import get_logger
+from .cal_kl_threshold import cal_kl_threshold
+
+_logger = get_logger(
+    __name__, logging.INFO, fmt='%(asctime)s-%(levelname)s: %(message)s'
+)
+
+# the ops quantized by default and the axis of their weights along the
+# output channels
+_weight_quant_axis = {
+    "pd_op.matmul": 1,
+    "pd_op.conv2d": 0,
+    "pd_op.depthwise_conv2d": 0,
+}
+
+
+def _round(x, round_type):
+    # round_type 0 rounds half to even and 1 rounds half away from zero, as
+    # the quantize_linear op does
+    if round_type == 0:
+        return np.round(x)
+    return np.sign(x) * np.floor(np.abs(x) + 0.5)
+
+
+class PirPostTrainingQuantization:
+    """
+    Static int8 post training quantization of a PIR program.
+
+    It runs the sample data through the program to calibrate the thresholds
+    of the activations, quantizes the weights per output channel into int8
+    and inserts quantize_linear and dequantize_linear ops before the
+    quantized ops. The quantized program runs in float on any backend, and
+    `fuse` folds the quantized matmuls into the int8 quant_linear kernels of
+    CPU and GPU, which the inference passes also do.
+
+    Args:
+        executor(static.Executor): The executor to run the calibration.
+        program(paddle.static.Program): The PIR program to quantize, which is
+            modified in place.
+        feed_list(list[str]): The names of the data ops fed by data_loader.
+        data_loader(iterable|callable): The sample data. Each batch is a dict
+            from the feed names to the numpy arrays, or a list of the arrays
+            in the order of feed_list. A callable is called to get the
+            iterable once per calibration pass.
+        scope(Scope, optional): The scope of the parameters. Default is
+            paddle.static.global_scope().
+        batch_nums(int, optional): The number of the batches to calibrate,
+            None means all of the batches of data_loader.
+        algo(str, optional): The method to get the thresholds of the
+            activations. 'abs_max' takes the absolute max value, 'KL' takes
+            the threshold of the minimal KL divergence, 'hist' takes the
+            'hist_percent' quantile and 'mse' takes the threshold of the
+            minimal mean squared quantization error. Default is 'KL'.
+        hist_percent(float, optional): The quantile of the algo 'hist'.
+            Default is 0.99999.
+        bins(int, optional): The number of the histogram bins of the algos
+            'KL', 'hist' and 'mse'. Default is 2048.
+        quantizable_op_type(list[str], optional): The types of the ops to
+            quantize, of pd_op.matmul, pd_op.conv2d and
+            pd_op.depthwise_conv2d.
+        round_type(int, optional): 0 rounds half to even and 1 rounds half
+            away from zero. Default is 0.
+
+    Examples:
+        .. code-block:: python
+
+            >>> # doctest: +SKIP('need a PIR program and the sample data')
+            >>> from paddle.static.quantization import (
+            ...     PirPostTrainingQuantization,
+            ... )
+            >>> ptq = PirPostTrainingQuantization(
+            ...     exe, program, ['x'], data_loader, algo='KL'
+            ... )
+            >>> program = ptq.quantize()
+            >>> program = ptq.fuse()
+    """
+
+    def __init__(
+        self,
+        executor,
+        program,
+        feed_list,
+        data_loader,
+        scope=None,
+        batch_nums=None,
+        algo="KL",
+        hist_percent=0.99999,
+        bins=2048,
+        quantizable_op_type=(
+            "pd_op.matmul",
+            "pd_op.conv2d",
+            "pd_op.depthwise_conv2d",
+        ),
+        round_type=0,
+    ):
+        assert algo in [
+            "abs_max",
+            "KL",
+            "hist",
+            "mse",
+        ], f"The algo should be abs_max, KL, hist or mse, but got {algo}."
+        for op_type in quantizable_op_type:
+            assert (
+                op_type in _weight_quant_axis
+            ), f"The op type {op_type} is not supported to quantize."
+        assert round_type in [0, 1], "The round_type should be 0 or 1."
+        self._executor = executor
+        self._program = program
+        self._feed_list = list(feed_list)
+        self._data_loader = data_loader
+        self._scope = (
+            paddle.static.global_scope() if scope is None else scope
+        )
+        self._batch_nums = batch_nums
+        self._algo = algo
+        self._hist_percent = hist_percent
+        self._bins = bins
+        self._quantizable_op_type = list(quantizable_op_type)
+        self._round_type = round_type
+        self._qmax = 127
+
+        self._quant_ops = []
+        self._activations = ValueDict()
+        self._thresholds = ValueDict()
+
+    def quantize(self):
+        """
+        Calibrates the activations and quantizes the program.
+
+        Returns:
+            The quantized program.
+        """
+        self._collect_quant_ops()
+        if len(self._quant_ops) == 0:
+            _logger.warning("There is no op to quantize in the program.")
+            return self._program
+        self._calibrate()
+        self._insert_quant_dequant()
+        _logger.info(f"Quantized {len(self._quant_ops)} ops.")
+        return self._program
+
+    def fuse(self):
+        """
+        Folds the quantized matmuls into the int8 quant_linear ops.
+
+        Returns:
+            The fused program.
+        """
+        pm = paddle.pir.PassManager()
+        pm.add_pass("quant_linear_fuse_pass", {"__param_scope__": self._scope})
+        pm.run(self._program)
+        return self._program
+
+    def _is_float32_tensor(self, value):
+        # the scales are float32, so are the outputs of dequantize_linear
+        return value.initialized() and value.dtype == paddle.float32
+
+    def _collect_quant_ops(self):
+        for op in self._program.global_block().ops:
+            if op.name() not in self._quantizable_op_type:
+                continue
+            if op.name() == "pd_op.matmul":
+                attrs = op.attrs()
+                if attrs["transpose_x"] or attrs["transpose_y"]:
+                    continue
+            x = op.operand_source(0)
+            w = op.operand_source(1)
+            if not self._is_float32_tensor(x) or not self._is_float32_tensor(
+                w
+            ):
+                continue
+            if not w.persistable or w.get_defining_op().name() not in [
+                "builtin.parameter",
+                "builtin.constant",
+            ]:
+                continue
+            if op.name() == "pd_op.matmul" and len(w.shape) != 2:
+                continue
+            self._quant_ops.append(op)
+            self._activations[x] = None
+
+    def _batches(self):
+        data = self._data_loader
+        if callable(data):
+            data = data()
+        for i, batch in enumerate(data):
+            if self._batch_nums is not None and i >= self._batch_nums:
+                break
+            if not isinstance(batch, dict):
+                batch = dict(zip(self._feed_list, batch))
+            yield batch
+
+    def _run_calibration(self, fn):
+        # the executor inserts the fetch ops into the program it runs, so
+        # the calibration runs on a clone of the program
+        value_map = paddle.pir.IrMapping()
+        program = self._program.clone(value_map)
+        activations = list(self._activations.keys())
+        fetch_list = [value_map.look_up(v) for v in activations]
+        for batch in self._batches():
+            outs = self._executor.run(
+                program,
+                feed=batch,
+                fetch_list=fetch_list,
+                scope=self._scope,
+            )
+            for value, out in zip(activations, outs):
+                fn(value, np.abs(np.array(out, dtype=np.float32)))
+
+    def _calibrate(self):
+        _logger.info("Collecting the absolute max values ...")
+        abs_max = ValueDict()
+
+        def collect_abs_max(value, out):
+            if out.size == 0:
+                return
+            abs_max[value] = max(abs_max.get(value, 0.0), float(np.max(out)))
+
+        self._run_calibration(collect_abs_max)
+        for value in self._activations.keys():
+            # a zero threshold makes the scales of quant_linear infinite
+            abs_max[value] = max(abs_max.get(value, 0.0), 1e-8)
+
+        if self._algo == "abs_max":
+            self._thresholds = abs_max
+            return
+
+        _logger.info("Collecting the histograms ...")
+        hists = ValueDict()
+
+        def collect_hist(value, out):
+            hist, _ = np.histogram(
+                out, bins=self._bins, range=(0.0, abs_max[value])
+            )
+            if value in hists:
+                hists[value] += hist
+            else:
+                hists[value] = hist
+
+        self._run_calibration(collect_hist)
+        for value in self._activations.keys():
+            bin_width = abs_max[value] / self._bins
+            hist = hists.get(value)
+            if hist is None or hist.sum() == 0:
+                self._thresholds[value] = abs_max[value]
+            elif self._algo == "KL":
+                self._thresholds[value] = cal_kl_threshold(hist, bin_width, 8)
+            elif self._algo == "hist":
+                self._thresholds[value] = self._get_hist_threshold(
+                    hist, bin_width
+                )
+            else:
+                self._thresholds[value] = self._get_mse_threshold(
+                    hist, bin_width
+                )
+
+    def _get_hist_threshold(self, hist, bin_width):
+        cdf = np.cumsum(hist) / float(hist.sum())
+        hist_index = int(np.argmax(cdf >= self._hist_percent)) + 1
+        return (hist_index - 0.5) * bin_width
+
+    def _get_mse_threshold(self, hist, bin_width):
+        # the quantization error of the values in a bin is estimated by the
+        # error of its center
+        centers = (np.arange(len(hist)) + 0.5) * bin_width
+        best_threshold = bin_width * len(hist)
+        best_loss = float("inf")
+        for s in np.arange(0.3, 1.0 + 1e-6, 0.02):
+            threshold = s * bin_width * len(hist)
+            quant = np.clip(
+                _round(centers / threshold * self._qmax, self._round_type),
+                -self._qmax,
+                self._qmax,
+            )
+            loss = np.sum(
+                hist * (centers - quant * threshold / self._qmax) ** 2
+            )
+            if loss < best_loss:
+                best_loss = loss
+                best_threshold = threshold
+        return best_threshold
+
+    def _get_tensor(self, value):
+        var = self._scope.find_var(value.name)
+        assert var is not None, f"Can not find the var {value.name} in scope."
+        return np.array(var.get_tensor())
+
+    def _set_tensor(self, name, array):
+        self._scope.var(name).get_tensor().set(array, self._executor.place)
+
+    def _create_persistable(self, startup, name, array):
+        with paddle.static.program_guard(self._program, startup):
+            value = paddle.pir.core.create_parameter(
+                dtype=array.dtype,
+                shape=list(array.shape),
+                name=name,
+                initializer=paddle.nn.initializer.Constant(0.0),
+                trainable=False,
+            )
+        self._set_tensor(name, array)
+        return value
+
+    def _quantize_weight(self, op, w):
+        axis = _weight_quant_axis[op.name()]
+        weight = self._get_tensor(w).astype(np.float32)
+        reduce_axes = tuple(i for i in range(weight.ndim) if i != axis)
+        scales = np.max(np.abs(weight), axis=reduce_axes)
+        scales = np.maximum(scales, 1e-8).astype(np.float32)
+        shape = [1] * weight.ndim
+        shape[axis] = -1
+        quant_weight = np.clip(
+            _round(
+                weight / scales.reshape(shape) * self._qmax, self._round_type
+            ),
+            -self._qmax,
+            self._qmax,
+        ).astype(np.int8)
+        return quant_weight, scales, axis
+
+    def _append_linear_op(self, linear_op, x, scale, zero_point, quant_axis):
+        return linear_op(
+            x,
+            scale,
+            zero_point,
+            None,
+            None,
+            quant_axis,
+            8,
+            -self._qmax - 1,
+            self._qmax,
+            self._round_type,
+            True,
+            False,
+        )[0]
+
+    def _insert_quant_dequant(self):
+        startup = paddle.static.Program()
+        act_dequant = ValueDict()
+        weight_dequant = ValueDict()
+        for op in self._quant_ops:
+            x = op.operand_source(0)
+            w = op.operand_source(1)
+            if x not in act_dequant:
+                name = unique_name.generate("quant_activation")
+                threshold = np.array([self._thresholds[x]], dtype=np.float32)
+                scale = self._create_persistable(
+                    startup, f"{name}.quant_scale", threshold
+                )
+                zero_point = self._create_persistable(
+                    startup,
+                    f"{name}.quant_zero_point",
+                    np.zeros([1], dtype=np.float32),
+                )
+                paddle.pir.set_insertion_point(op)
+                quant = self._append_linear_op(
+                    paddle._pir_ops.quantize_linear, x, scale, zero_point, -1
+                )
+                act_dequant[x] = self._append_linear_op(
+                    paddle._pir_ops.dequantize_linear,
+                    quant,
+                    scale,
+                    zero_point,
+                    -1,
+                )
+            if w not in weight_dequant:
+                quant_weight, scales, axis = self._quantize_weight(op, w)
+                quant_w = self._create_persistable(
+                    startup, f"{w.name}.quantized", quant_weight
+                )
+                scale = self._create_persistable(
+                    startup, f"{w.name}.quant_scale", scales
+                )
+                zero_point = self._create_persistable(
+                    startup,
+                    f"{w.name}.quant_zero_point",
+                    np.zeros(scales.shape, dtype=np.float32),
+                )
+                paddle.pir.set_insertion_point(op)
+                weight_dequant[w] = self._append_linear_op(
+                    paddle._pir_ops.dequantize_linear,
+                    quant_w,
+                    scale,
+                    zero_point,
+                    axis,
+                )
+            op.operand(0).set_source(act_dequant[x])
+            op.operand(1).set_source(weight_dequant[w])
+
+        # the float weights are not used by the quantized program
+        block = self._program.global_block()
+        for w in weight_dequant.keys():
+            if w.use_empty():
+                block.remove_op(w.get_defining_op())
+        paddle.pir.reset_insertion_point_to_end()
@@ -53,6 +53,7 @@ __all__ = [
     'generate_proposals',
     'read_file',
     'decode_jpeg',
+    'resized_crop_normalize',
     'roi_pool',
     'RoIPool',
     'psroi_pool',
@@ -1437,6 +1438,90 @@ def decode_jpeg(
         return out
 
 
+def resized_crop_normalize(
+    x: Tensor,
+    crop: Sequence[int],
+    size: Sequence[int],
+    mean: Sequence[float] | None = None,
+    std: Sequence[float] | None = None,
+    flip: bool = False,
+    name: str | None = None,
+) -> Tensor:
+    """
+    Crops a box of the images, resizes it by the bilinear interpolation,
+    optionally flips it horizontally and normalizes each channel, in one
+    kernel. It is the usual augmentation of the training images, e.g. after
+    ``decode_jpeg`` on GPU, which saves the intermediate images of doing the
+    steps one by one.
+
+    The resizing is the same as ``paddle.nn.functional.interpolate`` of the
+    ``bilinear`` mode with ``align_corners=False`` and ``align_mode=0``.
+
+    Args:
+        x (Tensor): The uint8 or float32 images of shape [C, H, W] or
+            [N, C, H, W].
+        crop (list[int]): The box [top, left, height, width] to crop, which
+            should be inside the images.
+        size (list[int]): The [height, width] of the output images.
+        mean (list[float]|None, optional): The mean of each channel, or one
+            value for all channels, subtracted from the resized images.
+            Default: None, which subtracts nothing.
+        std (list[float]|None, optional): The standard deviation of each
+            channel, or one value for all channels, which the resized images
+            are divided by. Default: None, which divides nothing.
+        flip (bool, optional): Whether to flip the images horizontally.
+            Default: False.
+        name (str, optional): The default value is None. Normally there is no
+            need for user to set this property. For more information, please
+            refer to :ref:`api_guide_Name`.
+
+    Returns:
+        Tensor: The float32 images of shape [C, size[0], size[1]] or
+        [N, C, size[0], size[1]].
+
+    Examples:
+        .. code-block:: python
+
+            >>> import paddle
+            >>> img = paddle.randint(0, 256, [3, 400, 300]).astype('uint8')
+            >>> out = paddle.vision.ops.resized_crop_normalize(
+            ...     img,
+            ...     crop=[20, 10, 300, 200],
+            ...     size=[224, 224],
+            ...     mean=[123.675, 116.28, 103.53],
+            ...     std=[58.395, 57.12, 57.375],
+            ...     flip=True,
+            ... )
+            >>> print(out.shape)
+            [3, 224, 224]
+    """
+    crop = [int(v) for v in crop]
+    size = [int(v) for v in size]
+    mean = [float(v) for v in mean] if mean is not None else []
+    std = [float(v) for v in std] if std is not None else []
+    if in_dynamic_or_pir_mode():
+        return _C_ops.resized_crop_normalize(x, crop, size, flip, mean, std)
+    else:
+        check_variable_and_dtype(
+            x, 'x', ['uint8', 'float32'], 'resized_crop_normalize'
+        )
+        helper = LayerHelper("resized_crop_normalize", **locals())
+        out = helper.create_variable_for_type_inference('float32')
+        helper.append_op(
+            type="resized_crop_normalize",
+            inputs={'x': x},
+            attrs={
+                "crop": crop,
+                "size": size,
+                "flip": flip,
+                "mean": mean,
+                "std": std,
+            },
+            outputs={"out": out},
+        )
+        return out
+
+
 def psroi_pool(
     x: Tensor,
     boxes: Tensor,
@@ -0,0 +1,91 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import paddle
+import paddle.distributed as dist
+from paddle.distributed.auto_parallel.static.spmd_planner import (
+    SpmdCostModel,
+    SpmdPlanner,
+)
+
+paddle.enable_static()
+
+
+def build_mlp_program(batch_size, hidden_size, ffn_size):
+    main_program = paddle.base.Program()
+    with paddle.base.program_guard(main_program):
+        x = paddle.static.data(name='x', shape=[batch_size, hidden_size])
+        w0 = paddle.create_parameter(
+            shape=[hidden_size, ffn_size], dtype='float32', name='w0'
+        )
+        w1 = paddle.create_parameter(
+            shape=[ffn_size, hidden_size], dtype='float32', name='w1'
+        )
+        paddle.matmul(paddle.nn.functional.relu(paddle.matmul(x, w0)), w1)
+    return main_program
+
+
+class TestSpmdPlanner(unittest.TestCase):
+    def setUp(self):
+        self.mesh = dist.ProcessMesh([0, 1, 2, 3], dim_names=['x'])
+
+    def replicated_cost(self, planner):
+        return planner.evaluate(
+            {'x': (-1, -1), 'w0': (-1, -1), 'w1': (-1, -1)}
+        )['total']
+
+    def test_data_parallel(self):
+        # a large batch of a small mlp is split by the batch
+        planner = SpmdPlanner(build_mlp_program(8192, 1024, 4096), self.mesh)
+        plan = planner.plan()
+        self.assertEqual(plan.dims_mappings['x'], (0, -1))
+        self.assertEqual(plan.dims_mappings['w0'], (-1, -1))
+        self.assertEqual(plan.dims_mappings['w1'], (-1, -1))
+        self.assertLess(plan.cost['total'], self.replicated_cost(planner))
+        self.assertGreater(plan.cost['grad_sync'], 0)
+
+        placements = plan.placements('x')
+        self.assertEqual(len(placements), 1)
+        self.assertTrue(placements[0].is_shard(0))
+        self.assertEqual(plan.dist_attr('x').dims_mapping, [0, -1])
+
+    def test_tensor_parallel(self):
+        # a small batch of a wide mlp splits the weights
+        planner = SpmdPlanner(build_mlp_program(8, 8192, 32768), self.mesh)
+        plan = planner.plan()
+        self.assertNotEqual(plan.dims_mappings['w1'], (-1, -1))
+        self.assertLess(plan.cost['total'], self.replicated_cost(planner))
+        # the column then row split of the weights is a plan of the model
+        megatron = planner.evaluate(
+            {'x': (-1, -1), 'w0': (-1, 0), 'w1': (0, -1)}
+        )
+        self.assertEqual(megatron['comm'], 0)
+        self.assertLess(megatron['total'], self.replicated_cost(planner))
+
+    def test_memory_limit(self):
+        # the replicated weights do not fit, so they have to be split
+        program = build_mlp_program(8192, 1024, 4096)
+        cost_model = SpmdCostModel(self.mesh, memory_limit=128 * 1024 * 1024)
+        planner = SpmdPlanner(program, self.mesh, cost_model=cost_model)
+        self.assertEqual(self.replicated_cost(planner), float('inf'))
+        plan = planner.plan()
+        self.assertLess(plan.cost['total'], float('inf'))
+        self.assertNotEqual(plan.dims_mappings['w0'], (-1, -1))
+        self.assertLessEqual(plan.cost['memory'], 128 * 1024 * 1024)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,70 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+import numpy as np
+
+import paddle
+import paddle.distributed as dist
+
+
+class TestAsyncSaveStateDict:
+    def __init__(self):
+        self._ckpt_path = os.getenv("ckpt_path")
+
+    def test_async_save_reshard_load(self):
+        w1 = paddle.arange(64, dtype="float32").reshape([8, 8])
+        w2 = paddle.arange(64, 72, dtype="float32")
+        mesh = dist.ProcessMesh([0, 1])
+        state_dict = {
+            "w1": dist.shard_tensor(w1, mesh, [dist.Shard(0)]),
+            "w2": dist.shard_tensor(w2, mesh, [dist.Replicate()]),
+        }
+        handle = dist.save_state_dict(
+            state_dict, self._ckpt_path, async_save=True, num_shards=2
+        )
+        # The snapshot is not changed by the updates after the save.
+        state_dict["w1"].add_(paddle.ones_like(state_dict["w1"]))
+        handle.wait()
+        paddle.distributed.barrier()
+        rank = paddle.distributed.get_rank()
+        for shard_id in range(2):
+            assert os.path.exists(
+                os.path.join(self._ckpt_path, f"{rank}_0_{shard_id}.distcp")
+            )
+
+        # Loaded onto a different layout.
+        state_dict_to_load = {
+            "w1": dist.shard_tensor(
+                paddle.zeros([8, 8]), mesh, [dist.Shard(1)]
+            ),
+            "w2": dist.shard_tensor(paddle.zeros([8]), mesh, [dist.Shard(0)]),
+        }
+        dist.load_state_dict(state_dict_to_load, self._ckpt_path)
+        np.testing.assert_equal(
+            state_dict_to_load["w1"]._local_value().numpy(),
+            w1.numpy()[:, rank * 4 : (rank + 1) * 4],
+        )
+        np.testing.assert_equal(
+            state_dict_to_load["w2"]._local_value().numpy(),
+            w2.numpy()[rank * 4 : (rank + 1) * 4],
+        )
+
+    def run_test_case(self):
+        self.test_async_save_reshard_load()
+
+
+if __name__ == '__main__':
+    TestAsyncSaveStateDict().run_test_case()
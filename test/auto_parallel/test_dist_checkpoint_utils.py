@@ -12,6 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import os
 import tempfile
 import unittest
 
@@ -60,6 +61,20 @@ class TestDistCheckpointUtils(test_base.CommunicationTestDistBase):
             )
             ckpt_path_tmp.cleanup()
 
+    def test_async_save_reshard_load(self):
+        envs_list = test_base.gen_product_envs_list(
+            self._default_envs, self._changeable_envs
+        )
+        for envs in envs_list:
+            ckpt_path_tmp = tempfile.TemporaryDirectory()
+            ckpt_path = ckpt_path_tmp.name
+            envs["ckpt_path"] = ckpt_path
+            self.run_test_case(
+                "semi_auto_parallel_checkpoint_async_save.py",
+                user_defined_envs=envs,
+            )
+            ckpt_path_tmp.cleanup()
+
     def test_flatten_state_dict(self):
         state_dict = {
             "model": {
@@ -157,6 +172,49 @@ class TestDistCheckpointUtils(test_base.CommunicationTestDistBase):
 
         ckpt_dir_tmp.cleanup()
 
+    def test_async_save_shards(self):
+        ckpt_dir_tmp = tempfile.TemporaryDirectory()
+        ckpt_dir = ckpt_dir_tmp.name
+        state_dict = {
+            "w1": paddle.arange(16, dtype="float32").reshape([4, 4]),
+            "w2": paddle.arange(3, dtype="float32"),
+            "w3": paddle.arange(5, dtype="float32"),
+        }
+        expected = {k: v.numpy() for k, v in state_dict.items()}
+        handle = dist.save_state_dict(
+            state_dict, ckpt_dir, async_save=True, num_shards=2
+        )
+        state_dict["w1"].add_(paddle.ones_like(state_dict["w1"]))
+        handle.wait()
+        self.assertTrue(handle.done())
+        files = sorted(os.listdir(ckpt_dir))
+        self.assertEqual(
+            files, ["0.metadata", "0_0_0.distcp", "0_0_1.distcp"]
+        )
+        # w1 is the largest one, so it is in a file alone.
+        self.assertEqual(
+            list(paddle.load(os.path.join(ckpt_dir, "0_0_0.distcp")).keys()),
+            ["w1"],
+        )
+
+        new_state_dict = {
+            k: paddle.zeros_like(v) for k, v in state_dict.items()
+        }
+        dist.load_state_dict(new_state_dict, ckpt_dir)
+        for k, v in new_state_dict.items():
+            np.testing.assert_equal(v.numpy(), expected[k])
+
+        # The next save waits for the previous one and uses a new unique_id.
+        dist.save_state_dict(
+            state_dict, ckpt_dir, async_save=True, num_shards=2
+        )
+        handle = dist.save_state_dict(
+            state_dict, ckpt_dir, async_save=True, num_shards=2
+        )
+        handle.wait()
+        self.assertTrue(os.path.exists(os.path.join(ckpt_dir, "0_2_1.distcp")))
+        ckpt_dir_tmp.cleanup()
+
 
 if __name__ == "__main__":
     unittest.main()
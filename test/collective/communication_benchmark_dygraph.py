@@ -0,0 +1,54 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+import paddle.distributed as dist
+from paddle.distributed.communication.benchmark import (
+    COLLECTIVES,
+    benchmark,
+    health_check,
+)
+
+
+class CommunicationBenchmarkTestCase:
+    def __init__(self):
+        self._backend = os.getenv("backend")
+        self._use_calc_stream = eval(os.getenv("use_calc_stream"))
+        if self._backend != "nccl":
+            raise NotImplementedError("Only support nccl as the backend.")
+        os.environ["PADDLE_DISTRI_BACKEND"] = self._backend
+
+    def run_test_case(self):
+        dist.init_parallel_env()
+        results = benchmark(
+            COLLECTIVES,
+            min_bytes=1024,
+            max_bytes=64 * 1024,
+            step_factor=4,
+            warmup=1,
+            iters=3,
+            use_calc_stream=self._use_calc_stream,
+        )
+        # 1K, 4K, 16K and 64K of each collective
+        assert len(results) == 4 * len(COLLECTIVES), results
+        for result in results:
+            assert result["correct"], result
+            assert result["time_us"] > 0, result
+            assert result["busbw_gbps"] > 0, result
+        health_check(max_bytes=64 * 1024)
+
+
+if __name__ == "__main__":
+    CommunicationBenchmarkTestCase().run_test_case()
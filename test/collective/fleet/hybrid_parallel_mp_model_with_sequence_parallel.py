@@ -398,6 +398,8 @@ class TestDistSPSyncModelTraining(TestDistSPSyncTraining):
 
 
 class TestDistSPTrainingBase(unittest.TestCase):
+    sequence_length = seq_length
+
     def setUp(self):
         strategy = fleet.DistributedStrategy()
         self.model_parallel_size = 2
@@ -468,7 +470,7 @@ class TestDistSPTrainingBase(unittest.TestCase):
                 vocab_size,
                 (
                     batch_size,
-                    seq_length,
+                    self.sequence_length,
                 ),
             )
             batch = paddle.to_tensor(np_data)
@@ -498,6 +500,24 @@ class TestDistSPTrainingWithConfigs(TestDistSPTrainingBase):
         fleet.init(is_collective=True, strategy=strategy)
 
 
+class TestDistSPTrainingWithOverlapChunks(TestDistSPTrainingBase):
+    sequence_length = 8
+
+    def setUp(self):
+        strategy = fleet.DistributedStrategy()
+        self.model_parallel_size = 2
+        self.data_parallel_size = 1
+        strategy.hybrid_configs = {
+            "dp_degree": self.data_parallel_size,
+            "mp_degree": self.model_parallel_size,
+            "pp_degree": 1,
+            "mp_configs": {
+                "sp_overlap_chunks": 2,
+            },
+        }
+        fleet.init(is_collective=True, strategy=strategy)
+
+
 class TestDistSPTrainingAmpWithConfigs(TestDistSPTrainingBase):
     def setUp(self):
         strategy = fleet.DistributedStrategy()
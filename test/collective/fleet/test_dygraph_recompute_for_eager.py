@@ -20,6 +20,7 @@ import numpy as np
 
 import paddle
 from paddle.base.framework import EagerParamBase
+from paddle.distributed.fleet.recompute import RecomputeScheduler
 from paddle.distributed.fleet.utils import recompute
 
 
@@ -161,6 +162,7 @@ def run_model(
     enable_autocast=False,
     pure_fp16=False,
     recompute_use_kwargs_as_inputs=False,
+    recompute_scheduler=None,
 ):
     gen = paddle.seed(10)
     gen.manual_seed(10)
@@ -199,7 +201,11 @@ def run_model(
         x.stop_gradient = False
         level = 'O2' if pure_fp16 else 'O1'
         with paddle.amp.auto_cast(True, level=level):
-            y_pred = model(x)
+            if recompute_scheduler is not None:
+                with recompute_scheduler:
+                    y_pred = model(x)
+            else:
+                y_pred = model(x)
             loss = y_pred.mean()
         if enable_autocast:
             scaler.scale(loss).backward()
@@ -410,6 +416,24 @@ class TestRecompute(unittest.TestCase):
                 self.assertEqual(param_ref, param)
                 self.assertEqual(grad_ref, grad)
 
+    def test_recompute_scheduler(self):
+        loss_ref, param_ref, grad_ref = run_model(recompute_block=[])
+        for kwargs in [
+            {"prefetch": True},
+            {"prefetch": True, "offload": True},
+            {"prefetch": False, "offload": True, "report": True},
+        ]:
+            scheduler = RecomputeScheduler(**kwargs)
+            loss, param, grad = run_model(
+                recompute_block=[1, 2, 3],
+                recompute_kwargs={"use_reentrant": True},
+                recompute_scheduler=scheduler,
+            )
+            self.assertEqual(loss_ref, loss)
+            self.assertEqual(param_ref, param)
+            self.assertEqual(grad_ref, grad)
+            self.assertEqual(scheduler.report()["segments"], 3)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,82 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+
+
+class TestProcessGroupGlooShm(unittest.TestCase):
+    def setUp(self):
+        np.random.seed(2024)
+        # the tensors span several chunks of the shared memory
+        self.shape = (3, 1000)
+        paddle.set_flags({'FLAGS_gloo_shm_buffer_size': 4096})
+        paddle.device.set_device('cpu')
+
+    def create_groups(self):
+        nranks = paddle.distributed.ParallelEnv().nranks
+        rank = paddle.distributed.ParallelEnv().local_rank
+        store = paddle.base.core.TCPStore(
+            "127.0.0.1", 6273, rank == 0, nranks, 30
+        )
+        paddle.set_flags({'FLAGS_gloo_shm_collective': True})
+        shm_pg = core.ProcessGroupGloo.create(store, rank, nranks, 1)
+        paddle.set_flags({'FLAGS_gloo_shm_collective': False})
+        pg = core.ProcessGroupGloo.create(store, rank, nranks, 2)
+        return shm_pg, pg
+
+    def random_tensors(self, pg, dtype):
+        # the same random data on all the ranks, a tensor of every rank
+        xs = [
+            (np.random.random(self.shape).astype("float32") - 0.5) * 100
+            for _ in range(pg.size())
+        ]
+        return [paddle.to_tensor(x).astype(dtype) for x in xs]
+
+    def test_shm_collectives(self):
+        shm_pg, pg = self.create_groups()
+        rank = pg.rank()
+
+        for dtype in ["float32", "bfloat16"]:
+            for op in [core.ReduceOp.SUM, core.ReduceOp.MAX]:
+                xs = self.random_tensors(pg, dtype)
+                shm_out = paddle.assign(xs[rank])
+                out = paddle.assign(xs[rank])
+                shm_pg.allreduce(shm_out, op).wait()
+                pg.allreduce(out, op).wait()
+                np.testing.assert_array_equal(
+                    shm_out.astype("float32").numpy(),
+                    out.astype("float32").numpy(),
+                )
+
+        xs = self.random_tensors(pg, "float32")
+        root = pg.size() - 1
+        out = paddle.assign(xs[rank])
+        shm_pg.broadcast(out, root).wait()
+        np.testing.assert_array_equal(out.numpy(), xs[root].numpy())
+
+        xs = self.random_tensors(pg, "int64")
+        out_shape = list(self.shape)
+        out_shape[0] *= pg.size()
+        out = paddle.zeros(out_shape, dtype="int64")
+        shm_pg.all_gather(xs[rank], out).wait()
+        np.testing.assert_array_equal(out.numpy(), paddle.concat(xs).numpy())
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -26,6 +26,9 @@ class TestProcessGroup(TestMultipleAccelerators):
     def test_process_group_gloo(self):
         self.run_mnist_2accelerators('process_group_gloo.py')
 
+    def test_process_group_gloo_shm(self):
+        self.run_mnist_2accelerators('process_group_gloo_shm.py')
+
     def test_init_process_group(self):
         self.run_mnist_2accelerators('init_process_group.py')
 
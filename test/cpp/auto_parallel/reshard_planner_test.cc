@@ -0,0 +1,121 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/phi/core/distributed/auto_parallel/reshard/reshard_planner.h"
+
+#include "gtest/gtest.h"
+
+namespace phi {
+namespace distributed {
+namespace tests {
+
+TensorDistAttr MakeDistAttr(const std::vector<int64_t>& shape,
+                            const std::vector<int64_t>& mesh_shape,
+                            const std::vector<int64_t>& dims_mapping) {
+  std::vector<int64_t> process_ids;
+  int64_t size = 1;
+  for (int64_t dim : mesh_shape) {
+    size *= dim;
+  }
+  for (int64_t i = 0; i < size; ++i) {
+    process_ids.push_back(i);
+  }
+  std::vector<std::string> dim_names = {"x", "y"};
+  dim_names.resize(mesh_shape.size());
+  TensorDistAttr dist_attr(shape);
+  dist_attr.set_process_mesh(ProcessMesh(mesh_shape, process_ids, dim_names));
+  dist_attr.set_dims_mapping(dims_mapping);
+  return dist_attr;
+}
+
+TEST(reshard_planner, shard_to_shard) {
+  std::vector<int64_t> shape = {8, 8};
+  auto in = MakeDistAttr(shape, {2, 2}, {0, -1});
+  auto out = MakeDistAttr(shape, {2, 2}, {-1, 0});
+
+  // an all_to_all instead of an all_gather and a slice
+  auto plan = SearchReshardPlan(shape, 4, in, out, {1., 1.});
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(plan->steps.size(), 1UL);
+  EXPECT_EQ(plan->steps[0].kind, ReshardStep::kSToS);
+  EXPECT_EQ(plan->steps[0].mesh_axis, 0);
+  EXPECT_EQ(plan->steps[0].dist_attr, out);
+  EXPECT_DOUBLE_EQ(plan->cost, 64.);
+}
+
+TEST(reshard_planner, swap_mesh_axes) {
+  std::vector<int64_t> shape = {8, 8};
+  auto in = MakeDistAttr(shape, {2, 2}, {0, 1});
+  auto out = MakeDistAttr(shape, {2, 2}, {1, 0});
+
+  // gather one axis, all_to_all the other one and slice the first one, the
+  // same nd mesh reshard gathers both axes
+  auto plan = SearchReshardPlan(shape, 4, in, out, {1., 1.});
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(plan->steps.size(), 3UL);
+  EXPECT_EQ(plan->steps[0].kind, ReshardStep::kSToR);
+  EXPECT_EQ(plan->steps[1].kind, ReshardStep::kSToS);
+  EXPECT_EQ(plan->steps[2].kind, ReshardStep::kRToS);
+  EXPECT_EQ(plan->steps[2].dist_attr, out);
+  EXPECT_DOUBLE_EQ(plan->cost, 128.);
+
+  // the smaller axis is gathered, the larger one is all_to_all
+  in = MakeDistAttr(shape, {2, 4}, {0, 1});
+  out = MakeDistAttr(shape, {2, 4}, {1, 0});
+  plan = SearchReshardPlan(shape, 4, in, out, {1., 1.});
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(plan->steps.size(), 3UL);
+  EXPECT_EQ(plan->steps[0].mesh_axis, 0);
+  EXPECT_EQ(plan->steps[1].mesh_axis, 1);
+  EXPECT_DOUBLE_EQ(plan->cost, 32. + 48.);
+}
+
+TEST(reshard_planner, partial_to_shard) {
+  std::vector<int64_t> shape = {8, 8};
+  auto in = MakeDistAttr(shape, {2, 2}, {0, -1});
+  in.set_partial_status(std::vector<int64_t>{1});
+  auto out = MakeDistAttr(shape, {2, 2}, {0, 1});
+
+  // a reduce_scatter of the local shards
+  auto plan = SearchReshardPlan(shape, 4, in, out, {1., 1.});
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(plan->steps.size(), 1UL);
+  EXPECT_EQ(plan->steps[0].kind, ReshardStep::kPToS);
+  EXPECT_EQ(plan->steps[0].mesh_axis, 1);
+  EXPECT_DOUBLE_EQ(plan->cost, 64.);
+}
+
+TEST(reshard_planner, fallback) {
+  // the plan is the same as the one of the same nd mesh reshard
+  std::vector<int64_t> shape = {8, 8};
+  auto plan = SearchReshardPlan(shape,
+                                4,
+                                MakeDistAttr(shape, {2, 2}, {0, -1}),
+                                MakeDistAttr(shape, {2, 2}, {-1, -1}),
+                                {1., 1.});
+  EXPECT_EQ(plan, nullptr);
+
+  // unbalanced shards
+  shape = {6, 8};
+  plan = SearchReshardPlan(shape,
+                           4,
+                           MakeDistAttr(shape, {4, 2}, {0, -1}),
+                           MakeDistAttr(shape, {4, 2}, {-1, 0}),
+                           {1., 1.});
+  EXPECT_EQ(plan, nullptr);
+}
+
+}  // namespace tests
+}  // namespace distributed
+}  // namespace phi
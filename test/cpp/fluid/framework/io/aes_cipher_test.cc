@@ -21,8 +21,11 @@ limitations under the License. */
 #include <fstream>
 #include <string>
 
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/io/crypto/cipher_utils.h"
 
+COMMON_DECLARE_int32(cipher_decrypt_num_threads);
+
 namespace paddle {
 namespace framework {
 
@@ -115,5 +118,29 @@ TEST_F(AESTest, encrypt_to_file) {
   }
 }
 
+TEST_F(AESTest, decrypt_in_parallel) {
+  // longer than the chunks decrypted by each thread, and not a multiple of
+  // the blocks
+  std::string plaintext = CipherUtils::GenKey(8 * ((5 << 20) + 7));
+  std::string filename("aes_test.ciphertext");
+  for (auto& name : {"AES_CTR_NoPadding", "AES_GCM_NoPadding"}) {
+    AESTest::GenConfigFile(name);
+    auto cipher = CipherFactory::CreateCipher("aes_test.conf");
+    std::string ciphertext = cipher->Encrypt(plaintext, AESTest::key);
+    for (int num_threads : {1, 3}) {
+      FLAGS_cipher_decrypt_num_threads = num_threads;
+      EXPECT_EQ(cipher->Decrypt(ciphertext, AESTest::key), plaintext);
+      cipher->EncryptToFile(plaintext, AESTest::key, filename);
+      EXPECT_EQ(cipher->DecryptFromFile(AESTest::key, filename), plaintext);
+    }
+  }
+  FLAGS_cipher_decrypt_num_threads = 0;
+
+  auto cipher = CipherFactory::CreateCipher("aes_test.conf");
+  std::string ciphertext = cipher->Encrypt(plaintext, AESTest::key);
+  ciphertext[ciphertext.size() / 2] ^= 1;
+  EXPECT_ANY_THROW(cipher->Decrypt(ciphertext, AESTest::key));
+}
+
 }  // namespace framework
 }  // namespace paddle
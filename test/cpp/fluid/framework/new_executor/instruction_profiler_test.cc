@@ -0,0 +1,104 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/instruction/instruction_profiler.h"
+
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
+
+namespace paddle {
+namespace framework {
+
+class FakeInstruction : public InstructionBase {
+ public:
+  FakeInstruction(size_t id, const std::string& name)
+      : InstructionBase(id, phi::CPUPlace()), name_(name) {}
+
+  void Run() override {
+    InstructionProfiler::PhaseGuard infer_meta(InstructionPhase::kInferMeta);
+    InstructionProfiler::PhaseGuard kernel(InstructionPhase::kKernel);
+  }
+
+  const std::string& Name() const override { return name_; }
+
+  ::pir::Operation* Operation() const override { return nullptr; }
+
+ private:
+  std::string name_;
+};
+
+void RunSampled(InstructionBase* instr) {
+  InstructionProfiler::RunScope scope(instr);
+  instr->Run();
+}
+
+TEST(InstructionProfiler, TestSampling) {
+  auto& profiler = InstructionProfiler::Instance();
+  profiler.Clear();
+  FakeInstruction matmul(0, "pd_kernel.matmul");
+  FakeInstruction relu(1, "pd_kernel.relu");
+
+  FLAGS_pir_instruction_profiler_sample_interval = 0;
+  RunSampled(&matmul);
+  EXPECT_TRUE(profiler.Records().empty());
+
+  // the phases outside a sampled run are not recorded
+  FLAGS_pir_instruction_profiler_sample_interval = 1;
+  { InstructionProfiler::PhaseGuard gc(InstructionPhase::kGC); }
+  EXPECT_TRUE(profiler.Records().empty());
+
+  std::thread worker([&]() {
+    for (int i = 0; i < 10; ++i) {
+      RunSampled(&matmul);
+    }
+    RunSampled(&relu);
+  });
+  worker.join();
+  FLAGS_pir_instruction_profiler_sample_interval = 0;
+
+  // infer_meta, kernel and the instruction itself for each run
+  auto records = profiler.Records();
+  EXPECT_EQ(records.size(), 33u);
+  size_t matmul_runs = 0;
+  for (auto& record : records) {
+    EXPECT_LE(record.start_ns, record.end_ns);
+    if (record.phase == InstructionPhase::kInstruction &&
+        profiler.Name(record.name_id) == "pd_kernel.matmul") {
+      ++matmul_runs;
+    }
+  }
+  EXPECT_EQ(matmul_runs, 10u);
+
+  // matmul takes more host time in total, so it is reported first
+  std::string report = profiler.Report(/*top_n=*/1);
+  EXPECT_NE(report.find("pd_kernel.matmul"), std::string::npos);
+  EXPECT_EQ(report.find("pd_kernel.relu"), std::string::npos);
+  EXPECT_NE(report.find("infer_meta"), std::string::npos);
+
+  profiler.ExportChromeTracing("instruction_profiler_test.json");
+  std::ifstream fin("instruction_profiler_test.json");
+  std::string content((std::istreambuf_iterator<char>(fin)),
+                      std::istreambuf_iterator<char>());
+  EXPECT_NE(content.find("pd_kernel.relu"), std::string::npos);
+
+  profiler.Clear();
+  EXPECT_TRUE(profiler.Records().empty());
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,60 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/new_executor/interpreter/static_memory_planner.h"
+
+#include "gtest/gtest.h"
+
+using paddle::framework::interpreter::StaticMemoryPlanner;
+
+TEST(StaticMemoryPlanner, ReuseDisjointLifetime) {
+  StaticMemoryPlanner planner;
+  planner.AddBuffer(/*var_id*/ 0, /*size*/ 1024, /*first_use*/ 0, 1);
+  planner.AddBuffer(/*var_id*/ 1, /*size*/ 512, /*first_use*/ 1, 2);
+  planner.AddBuffer(/*var_id*/ 2, /*size*/ 1000, /*first_use*/ 2, 3);
+  planner.Plan();
+
+  EXPECT_EQ(planner.PlannedBufferNum(), 3u);
+  // var 0 and var 1 are alive at the same time
+  EXPECT_EQ(planner.Offset(0), 0u);
+  EXPECT_EQ(planner.Offset(1), 1024u);
+  // var 2 reuses the memory of var 0
+  EXPECT_EQ(planner.Offset(2), 0u);
+  EXPECT_EQ(planner.Size(2), 1024u);
+  EXPECT_EQ(planner.PeakSize(), 1536u);
+}
+
+TEST(StaticMemoryPlanner, AliasAndExclude) {
+  StaticMemoryPlanner planner;
+  planner.AddBuffer(0, 256, 0, 1);
+  // var 1 is a view of var 0, so var 0 must be kept until step 4
+  planner.AddBuffer(1, 256, 1, 4);
+  planner.AddAlias(0, 1);
+  planner.AddBuffer(2, 256, 2, 3);
+  planner.AddBuffer(3, 256, 0, 5);
+  planner.AddAlias(3, 4);
+  planner.Exclude(4);
+  planner.Plan();
+
+  EXPECT_TRUE(planner.IsPlanned(0));
+  EXPECT_TRUE(planner.IsPlanned(1));
+  EXPECT_FALSE(planner.IsPlanned(3));
+  EXPECT_EQ(planner.Offset(0), planner.Offset(1));
+  EXPECT_NE(planner.Offset(0), planner.Offset(2));
+  EXPECT_EQ(planner.PeakSize(), 512u);
+
+  planner.Clear();
+  EXPECT_EQ(planner.PlannedBufferNum(), 0u);
+  EXPECT_EQ(planner.PeakSize(), 0u);
+}
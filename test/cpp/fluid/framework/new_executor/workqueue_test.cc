@@ -15,10 +15,13 @@
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
 
 #include <atomic>
+#include <chrono>
 #include <thread>
+#include <vector>
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/framework/new_executor/workqueue/run_queue.h"
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 
 TEST(WorkQueueUtils, TestEventsWaiter) {
@@ -37,6 +40,142 @@ TEST(WorkQueueUtils, TestEventsWaiter) {
   notifier->CancelEvent();
 }
 
+TEST(WorkQueueUtils, TestRunQueueConcurrentPushBack) {
+  using Queue = paddle::framework::RunQueue<unsigned, 1024>;
+  constexpr unsigned kProducerNum = 4;
+  constexpr unsigned kItemNum = 100000;
+  Queue queue;
+  std::atomic<unsigned> popped_num{0};
+  std::atomic<uint64_t> popped_sum{0};
+  std::atomic<bool> done{false};
+
+  // the owner pops from the front while a thief pops from the back
+  auto Consume = [&](bool is_owner) {
+    std::vector<unsigned> items;
+    while (!done.load() || !queue.Empty()) {
+      items.clear();
+      if (is_owner) {
+        items.push_back(queue.PopFront());
+      } else {
+        queue.PopBackHalf(&items);
+      }
+      for (unsigned item : items) {
+        if (item != 0) {
+          popped_sum += item;
+          ++popped_num;
+        }
+      }
+    }
+  };
+  std::thread owner(Consume, true);
+  std::thread thief(Consume, false);
+
+  std::vector<std::thread> producers;
+  for (unsigned i = 0; i < kProducerNum; ++i) {
+    producers.emplace_back([&queue]() {
+      for (unsigned item = 1; item <= kItemNum; ++item) {
+        while (queue.PushBack(item) != 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  done = true;
+  owner.join();
+  thief.join();
+
+  EXPECT_EQ(popped_num.load(), kProducerNum * kItemNum);
+  EXPECT_EQ(popped_sum.load(),
+            static_cast<uint64_t>(kProducerNum) * kItemNum * (kItemNum + 1) /
+                2);
+}
+
+TEST(WorkQueueUtils, TestAssignNumaThreadCpus) {
+  using paddle::framework::AssignNumaThreadCpus;
+  using paddle::framework::GetNumaNodeCpus;
+  auto node_cpus = GetNumaNodeCpus();
+  std::vector<std::pair<unsigned, unsigned>> partitions;
+  if (node_cpus.empty() || node_cpus[0].empty()) {
+    EXPECT_TRUE(AssignNumaThreadCpus(4, 0, &partitions).empty());
+    return;
+  }
+  size_t num_threads = node_cpus[0].size();
+  auto thread_cpus = AssignNumaThreadCpus(num_threads, 0, &partitions);
+  ASSERT_EQ(thread_cpus.size(), num_threads);
+  ASSERT_EQ(partitions.size(), num_threads);
+  // the threads fill node 0 first
+  for (size_t i = 0; i < node_cpus[0].size(); ++i) {
+    EXPECT_EQ(thread_cpus[i], node_cpus[0][i]);
+    EXPECT_EQ(partitions[i].first, 0u);
+    EXPECT_EQ(partitions[i].second, node_cpus[0].size());
+  }
+  EXPECT_TRUE(AssignNumaThreadCpus(4, -1, &partitions).empty());
+}
+
+TEST(WorkQueue, TestNumaAwareWorkQueue) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueueOptions;
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kLoopNum = 10000;
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "NumaAwareWorkQueueForTesting",
+                           /*num_threads*/ 4,
+                           /*allow_spinning*/ true,
+                           /*always_spinning*/ false,
+                           /*track_task*/ true,
+                           /*detached*/ true,
+                           &events_waiter);
+  // -1 if the topology is unknown, then the threads are not pinned
+  options.numa_node = paddle::framework::GetCurrentNumaNode();
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  for (unsigned i = 0; i < kLoopNum; ++i) {
+    work_queue->AddTask([&counter]() { ++counter; });
+  }
+  EXPECT_EQ(events_waiter.WaitEvent(), paddle::framework::kQueueEmptyEvent);
+  EXPECT_EQ(counter.load(), kLoopNum);
+}
+
+// Not a strict test, it logs the throughput of tasks pushed from outside the
+// pool, which all go through the lock-free PushBack.
+TEST(WorkQueue, BenchmarkMultiThreadedWorkQueue) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueueOptions;
+  constexpr unsigned kTaskNum = 100000;
+  for (size_t num_threads = 1; num_threads <= 128; num_threads *= 2) {
+    for (bool numa_aware : {false, true}) {
+      std::atomic<unsigned> counter{0};
+      EventsWaiter events_waiter;
+      WorkQueueOptions options(/*name*/ "BenchmarkWorkQueue",
+                               /*num_threads*/ num_threads,
+                               /*allow_spinning*/ true,
+                               /*always_spinning*/ false,
+                               /*track_task*/ true,
+                               /*detached*/ true,
+                               &events_waiter);
+      options.numa_node =
+          numa_aware ? paddle::framework::GetCurrentNumaNode() : -1;
+      auto work_queue = CreateMultiThreadedWorkQueue(options);
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned i = 0; i < kTaskNum; ++i) {
+        work_queue->AddTask([&counter]() { ++counter; });
+      }
+      EXPECT_EQ(events_waiter.WaitEvent(),
+                paddle::framework::kQueueEmptyEvent);
+      double seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+      EXPECT_EQ(counter.load(), kTaskNum);
+      LOG(INFO) << "threads: " << num_threads << ", numa_aware: " << numa_aware
+                << ", throughput: " << kTaskNum / seconds << " tasks/s";
+    }
+  }
+}
+
 TEST(WorkQueue, TestSingleThreadedWorkQueue) {
   VLOG(1) << "In Test";
   using paddle::framework::CreateSingleThreadedWorkQueue;
@@ -142,6 +281,38 @@ TEST(WorkQueue, TestMultiThreadedWorkQueue) {
   EXPECT_EQ(handle.get(), 5678);
 }
 
+TEST(WorkQueue, TestMultiThreadedWorkQueueStealHalf) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueue;
+  using paddle::framework::WorkQueueOptions;
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kExternalLoopNum = 10;
+  constexpr unsigned kInternalLoopNum = 100;
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "StealHalfWorkQueueForTesting",
+                           /*num_threads*/ 4,
+                           /*allow_spinning*/ true,
+                           /*always_spinning*/ false,
+                           /*track_task*/ true,
+                           /*detached*/ true,
+                           &events_waiter);
+  options.steal_half = true;
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  WorkQueue* queue = work_queue.get();
+  // Tasks added by a worker thread go to its own queue, so the other workers
+  // have to steal them.
+  for (unsigned i = 0; i < kExternalLoopNum; ++i) {
+    work_queue->AddTask([=, &counter]() {
+      for (unsigned j = 0; j < kInternalLoopNum; ++j) {
+        queue->AddTask([&counter]() { ++counter; });
+      }
+    });
+  }
+  EXPECT_EQ(events_waiter.WaitEvent(), paddle::framework::kQueueEmptyEvent);
+  EXPECT_EQ(counter.load(), kExternalLoopNum * kInternalLoopNum);
+}
+
 TEST(WorkQueue, TestWorkQueueGroup) {
   using paddle::framework::CreateWorkQueueGroup;
   using paddle::framework::EventsWaiter;
@@ -0,0 +1,154 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/slot_parser.h"
+
+#include <chrono>  // NOLINT
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(SlotParser, ParseNumbers) {
+  // the line is followed by the next one in the buffer, not by a nul
+  std::string buffer =
+      "3 18446744073709551615 0 42 2 -0.25 1.5e-3 1 0.1234567890123456789\n7";
+  const char* p = buffer.data();
+  const char* end = p + buffer.find('\n');
+  uint64_t num = 0, value = 0;
+  p = ParseSlotUint64(p, end, &num);
+  ASSERT_EQ(num, 3UL);
+  std::vector<uint64_t> uint64_values;
+  for (uint64_t i = 0; i < num; ++i) {
+    p = ParseSlotUint64(p, end, &value);
+    ASSERT_NE(p, nullptr);
+    uint64_values.push_back(value);
+  }
+  ASSERT_EQ(uint64_values,
+            std::vector<uint64_t>({18446744073709551615ULL, 0, 42}));
+  float feasign = 0;
+  p = ParseSlotUint64(p, end, &num);
+  ASSERT_EQ(num, 2UL);
+  p = ParseSlotFloat(p, end, &feasign);
+  ASSERT_FLOAT_EQ(feasign, -0.25);
+  p = ParseSlotFloat(p, end, &feasign);
+  ASSERT_FLOAT_EQ(feasign, 1.5e-3);
+  // the slot of the long mantissa is skipped
+  p = ParseSlotUint64(p, end, &num);
+  p = SkipSlotTokens(p, end, num);
+  ASSERT_EQ(p, end);
+  ASSERT_EQ(ParseSlotUint64(p, end, &value), nullptr);
+  ASSERT_EQ(ParseSlotFloat(p, end, &feasign), nullptr);
+  ASSERT_EQ(SkipSlotTokens(p, end, 1), nullptr);
+
+  std::string bad = "12a -";
+  ASSERT_EQ(ParseSlotUint64(bad.data(), bad.data() + bad.size(), &value),
+            nullptr);
+  ASSERT_EQ(ParseSlotFloat(bad.data() + 3, bad.data() + bad.size(), &feasign),
+            nullptr);
+
+  std::mt19937_64 rng(0);
+  std::uniform_real_distribution<float> distrib(-100, 100);
+  char str[64];
+  for (int i = 0; i < 10000; ++i) {
+    float expected = distrib(rng);
+    int len = snprintf(str, sizeof(str), i % 2 ? "%.6f" : "%g", expected);
+    ASSERT_NE(ParseSlotFloat(str, str + len, &feasign), nullptr);
+    ASSERT_FLOAT_EQ(feasign, strtof(str, nullptr)) << str;
+  }
+}
+
+// Not a strict test, it logs the parse throughput of the lines in the slot
+// format against strtoull and strtof.
+TEST(SlotParser, BenchmarkParseSlots) {
+  constexpr int kLineNum = 5000;
+  constexpr int kSlotNum = 100;
+  std::mt19937_64 rng(0);
+  std::string data;
+  for (int i = 0; i < kLineNum; ++i) {
+    for (int slot = 0; slot < kSlotNum; ++slot) {
+      int num = 1 + rng() % 4;
+      data += std::to_string(num);
+      for (int j = 0; j < num; ++j) {
+        data += ' ';
+        data += slot == 0 ? std::to_string((rng() % 1000) / 1000.0)
+                          : std::to_string(rng());
+      }
+      data += ' ';
+    }
+    data.back() = '\n';
+  }
+
+  std::vector<uint64_t> expected, parsed;
+  std::vector<float> expected_floats, parsed_floats;
+  auto start = std::chrono::steady_clock::now();
+  const char* str = data.c_str();
+  char* endptr = const_cast<char*>(str);
+  for (int i = 0; i < kLineNum; ++i) {
+    for (int slot = 0; slot < kSlotNum; ++slot) {
+      int num = static_cast<int>(strtol(endptr, &endptr, 10));
+      for (int j = 0; j < num; ++j) {
+        if (slot == 0) {
+          expected_floats.push_back(strtof(endptr, &endptr));
+        } else {
+          expected.push_back(strtoull(endptr, &endptr, 10));
+        }
+      }
+    }
+  }
+  double strto_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+  start = std::chrono::steady_clock::now();
+  const char* p = data.data();
+  const char* data_end = p + data.size();
+  for (int i = 0; i < kLineNum; ++i) {
+    const char* end =
+        reinterpret_cast<const char*>(memchr(p, '\n', data_end - p));
+    for (int slot = 0; slot < kSlotNum; ++slot) {
+      uint64_t num = 0, value = 0;
+      float feasign = 0;
+      p = ParseSlotUint64(p, end, &num);
+      for (uint64_t j = 0; j < num; ++j) {
+        if (slot == 0) {
+          p = ParseSlotFloat(p, end, &feasign);
+          parsed_floats.push_back(feasign);
+        } else {
+          p = ParseSlotUint64(p, end, &value);
+          parsed.push_back(value);
+        }
+      }
+    }
+    ASSERT_EQ(p, end);
+    p = end + 1;
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  ASSERT_EQ(parsed, expected);
+  ASSERT_EQ(parsed_floats, expected_floats);
+  LOG(INFO) << "parse " << data.size() / 1024.0 / 1024.0
+            << "MB, strtoull: " << strto_seconds
+            << "s, slot parser: " << seconds << "s";
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/data_feed.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(SlotRecordBlock, WriteAndRead) {
+  std::vector<SlotRecord> records;
+  for (int i = 0; i < 5; ++i) {
+    SlotRecord rec = make_slotrecord();
+    std::vector<std::vector<uint64_t>> uint64_feasigns(3);
+    std::vector<std::vector<float>> float_feasigns(2);
+    for (int j = 0; j < 3; ++j) {
+      // the slot 0 of the record 0 is empty
+      for (int k = 0; k < i + j; ++k) {
+        uint64_feasigns[j].push_back(i * 100 + j * 10 + k);
+      }
+    }
+    float_feasigns[1].push_back(i * 0.5f);
+    rec->slot_uint64_feasigns_.add_slot_feasigns(uint64_feasigns, 0);
+    rec->slot_float_feasigns_.add_slot_feasigns(float_feasigns, 0);
+    rec->ins_id_ = "ins_" + std::to_string(i);
+    rec->search_id = i;
+    rec->rank = i + 1;
+    rec->cmatch = i + 2;
+    records.push_back(rec);
+  }
+
+  FILE* fp = tmpfile();
+  ASSERT_NE(fp, nullptr);
+  ASSERT_TRUE(WriteSlotRecordBlock(fp, &records[0], 3));
+  ASSERT_TRUE(WriteSlotRecordBlock(fp, &records[3], 2));
+  rewind(fp);
+
+  SlotRecordBlockHeader header;
+  size_t index = 0;
+  while (ReadSlotRecordBlockHeader(fp, &header)) {
+    std::vector<SlotRecord> block(header.record_num);
+    for (auto& rec : block) {
+      rec = make_slotrecord();
+    }
+    ASSERT_TRUE(ReadSlotRecordBlock(fp, header, &block[0]));
+    for (auto& rec : block) {
+      SlotRecord expected = records[index++];
+      ASSERT_EQ(rec->slot_uint64_feasigns_.slot_offsets,
+                expected->slot_uint64_feasigns_.slot_offsets);
+      ASSERT_EQ(rec->slot_uint64_feasigns_.slot_values,
+                expected->slot_uint64_feasigns_.slot_values);
+      ASSERT_EQ(rec->slot_float_feasigns_.slot_offsets,
+                expected->slot_float_feasigns_.slot_offsets);
+      ASSERT_EQ(rec->slot_float_feasigns_.slot_values,
+                expected->slot_float_feasigns_.slot_values);
+      ASSERT_EQ(rec->ins_id_, expected->ins_id_);
+      ASSERT_EQ(rec->search_id, expected->search_id);
+      ASSERT_EQ(rec->rank, expected->rank);
+      ASSERT_EQ(rec->cmatch, expected->cmatch);
+      free_slotrecord(rec);
+    }
+  }
+  ASSERT_EQ(index, records.size());
+
+  // a truncated block is rejected
+  rewind(fp);
+  ASSERT_TRUE(ReadSlotRecordBlockHeader(fp, &header));
+  header.uint64_value_num += 1;
+  std::vector<SlotRecord> block(header.record_num);
+  for (auto& rec : block) {
+    rec = make_slotrecord();
+  }
+  ASSERT_FALSE(ReadSlotRecordBlock(fp, header, &block[0]));
+  for (auto& rec : block) {
+    free_slotrecord(rec);
+  }
+  fclose(fp);
+
+  // the records of a block have the same slots
+  records[1]->slot_float_feasigns_.clear(false);
+  fp = tmpfile();
+  ASSERT_FALSE(WriteSlotRecordBlock(fp, &records[0], 2));
+  fclose(fp);
+  for (auto& rec : records) {
+    free_slotrecord(rec);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -62,3 +62,69 @@ TEST(ThreadPool, ConcurrentRun) {
   }
   EXPECT_EQ(sum, ((n + 1) * n) / 2);
 }
+
+TEST(ThreadPool, RunInsideThreadPool) {
+  framework::ThreadPool pool(4);
+  std::atomic<int> sum(0);
+  int n = 100;
+  // the tasks enqueued by a task go to the queue of its thread, the other
+  // threads have to steal them
+  pool.Run([&pool, &sum, n] {
+        std::vector<std::future<void>> fs;
+        for (int i = 0; i < n; ++i) {
+          fs.push_back(pool.Run([&sum] { sum.fetch_add(1); }));
+        }
+        for (auto& f : fs) {
+          f.wait();
+        }
+      })
+      .wait();
+  EXPECT_EQ(sum, n);
+}
+
+TEST(ThreadPool, Priority) {
+  framework::ThreadPool pool(1);
+  std::promise<void> started;
+  std::promise<void> blocker;
+  std::shared_future<void> blocked = blocker.get_future().share();
+  auto f = pool.Run([&started, blocked] {
+    started.set_value();
+    blocked.wait();
+  });
+  started.get_future().wait();
+
+  std::mutex mu;
+  std::vector<int> order;
+  std::vector<std::future<void>> fs;
+  for (int i = 0; i < 3; ++i) {
+    fs.push_back(pool.Run(
+        [&mu, &order] {
+          std::lock_guard<std::mutex> l(mu);
+          order.push_back(1);
+        },
+        framework::ThreadPool::Priority::kBackground));
+    fs.push_back(pool.Run([&mu, &order] {
+      std::lock_guard<std::mutex> l(mu);
+      order.push_back(0);
+    }));
+  }
+  blocker.set_value();
+  f.wait();
+  for (auto& t : fs) {
+    t.wait();
+  }
+  EXPECT_EQ(order, std::vector<int>({0, 0, 0, 1, 1, 1}));
+}
+
+TEST(ThreadPool, BindCpu) {
+  framework::ThreadPool pool(2, /*bind_cpu=*/true);
+  std::atomic<int> sum(0);
+  std::vector<std::future<void>> fs;
+  for (int i = 0; i < 10; ++i) {
+    fs.push_back(pool.Run([&sum] { sum.fetch_add(1); }));
+  }
+  for (auto& f : fs) {
+    f.wait();
+  }
+  EXPECT_EQ(sum, 10);
+}
@@ -431,6 +431,63 @@ TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_add_multi_sorted) {
+  phi::CPUPlace cpu_place;
+  phi::CPUContext ctx(cpu_place);
+  ctx.SetAllocator(paddle::memory::allocation::AllocatorFacade::Instance()
+                       .GetAllocator(cpu_place)
+                       .get());
+
+  int64_t height = 10;
+  int64_t row_numel = 8;
+
+  // The value of the i-th row of the inputs is i.
+  std::vector<int64_t> rows1{9, 1, 4, 1};
+  std::unique_ptr<phi::SelectedRows> selected_rows1{
+      new phi::SelectedRows(rows1, height)};
+  auto* in1_data = selected_rows1->mutable_value()->mutable_data<float>(
+      common::make_ddim({static_cast<int64_t>(rows1.size()), row_numel}),
+      cpu_place);
+  std::vector<int64_t> rows2{4, 0, 9};
+  std::unique_ptr<phi::SelectedRows> selected_rows2{
+      new phi::SelectedRows(rows2, height)};
+  auto* in2_data = selected_rows2->mutable_value()->mutable_data<float>(
+      common::make_ddim({static_cast<int64_t>(rows2.size()), row_numel}),
+      cpu_place);
+  for (size_t i = 0; i < rows1.size() + rows2.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      if (i < rows1.size()) {
+        in1_data[i * row_numel + j] = static_cast<float>(i);
+      } else {
+        in2_data[(i - rows1.size()) * row_numel + j] = static_cast<float>(i);
+      }
+    }
+  }
+
+  std::unique_ptr<phi::SelectedRows> output{new phi::SelectedRows()};
+  output->set_height(height);
+  phi::funcs::scatter::MergeAdd<phi::CPUContext, float> merge_add_functor;
+
+  std::vector<const phi::SelectedRows*> inputs;
+  inputs.push_back(selected_rows1.get());
+  inputs.push_back(selected_rows2.get());
+  merge_add_functor(ctx, inputs, output.get(), true);
+
+  EXPECT_EQ(output->height(), height);
+  EXPECT_EQ(output->value().dims(), common::make_ddim({4, row_numel}));
+
+  std::vector<int64_t> ret_rows{0, 1, 4, 9};
+  EXPECT_EQ(output->rows(), ret_rows);
+
+  std::vector<float> ret_values{5.0, 4.0, 6.0, 6.0};
+  auto* out_data = output->value().data<float>();
+  for (size_t i = 0; i < ret_rows.size(); ++i) {
+    for (size_t j = 0; j < static_cast<size_t>(row_numel); ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j], ret_values[i]);
+    }
+  }
+}
+
 TEST(selected_rows_functor, cpu_sum_to) {
   phi::CPUPlace cpu_place;
   phi::CPUContext ctx(cpu_place);
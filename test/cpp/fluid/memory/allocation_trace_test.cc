@@ -0,0 +1,120 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocation_trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/allocation_trace_replayer.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+static AllocationTraceRecord MakeRecord(AllocationTraceEventType type,
+                                        uint64_t ptr,
+                                        uint64_t size,
+                                        uint64_t stream = 0,
+                                        uint32_t tag = 0) {
+  AllocationTraceRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.ptr = ptr;
+  record.size = size;
+  record.stream = stream;
+  record.tag = tag;
+  record.device_id = 0;
+  record.place_type = static_cast<uint8_t>(phi::AllocationType::GPU);
+  record.type = static_cast<uint8_t>(type);
+  return record;
+}
+
+TEST(AllocationTrace, SaveAndLoad) {
+  AllocationTrace trace;
+  trace.tags[1] = "pd_op.matmul";
+  trace.tags[2] = "pd_op.add";
+  trace.records.push_back(
+      MakeRecord(AllocationTraceEventType::kAllocate, 0x1000, 256, 7, 1));
+  trace.records.push_back(
+      MakeRecord(AllocationTraceEventType::kFree, 0x1000, 256, 7, 2));
+
+  std::string path = "allocation_trace_test.bin";
+  SaveAllocationTrace(trace, path);
+  auto loaded = LoadAllocationTrace(path);
+  std::remove(path.c_str());
+
+  ASSERT_EQ(loaded.tags.size(), 2UL);
+  ASSERT_EQ(loaded.tags[1], "pd_op.matmul");
+  ASSERT_EQ(loaded.tags[2], "pd_op.add");
+  ASSERT_EQ(loaded.records.size(), 2UL);
+  ASSERT_EQ(loaded.records[0].ptr, 0x1000UL);
+  ASSERT_EQ(loaded.records[0].size, 256UL);
+  ASSERT_EQ(loaded.records[0].stream, 7UL);
+  ASSERT_EQ(loaded.records[0].tag, 1U);
+  ASSERT_EQ(loaded.records[1].type,
+            static_cast<uint8_t>(AllocationTraceEventType::kFree));
+}
+
+TEST(AllocationTrace, LoadInvalidFile) {
+  std::string path = "allocation_trace_invalid.bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  fputs("not a trace", file);
+  fclose(file);
+  ASSERT_ANY_THROW(LoadAllocationTrace(path));
+  std::remove(path.c_str());
+}
+
+TEST(AllocationTrace, Replay) {
+  // allocate 4 x 1MB, free the 1st and the 3rd, then allocate 2MB
+  AllocationTrace trace;
+  for (uint64_t i = 0; i < 4; ++i) {
+    trace.records.push_back(MakeRecord(
+        AllocationTraceEventType::kAllocate, 0x1000 * (i + 1), 1 << 20));
+  }
+  trace.records.push_back(
+      MakeRecord(AllocationTraceEventType::kFree, 0x1000, 1 << 20));
+  trace.records.push_back(
+      MakeRecord(AllocationTraceEventType::kFree, 0x3000, 1 << 20));
+  trace.records.push_back(
+      MakeRecord(AllocationTraceEventType::kAllocate, 0x5000, 2 << 20));
+  // the records of the other places are skipped
+  auto cpu_record =
+      MakeRecord(AllocationTraceEventType::kAllocate, 0x6000, 64 << 20);
+  cpu_record.place_type = static_cast<uint8_t>(phi::AllocationType::CPU);
+  trace.records.push_back(cpu_record);
+
+  AllocationTraceReplayOptions options;
+  options.naive_best_fit_chunk_size = 16 << 20;
+  for (auto& strategy : {"auto_growth", "naive_best_fit"}) {
+    auto result = ReplayAllocationTrace(trace, strategy, options);
+    ASSERT_EQ(result.strategy, strategy);
+    ASSERT_EQ(result.num_allocations, 5UL);
+    ASSERT_EQ(result.peak_allocated, 4UL << 20);
+    ASSERT_GE(result.peak_reserved, 4UL << 20);
+    ASSERT_GE(result.fragmentation, 0.0);
+    ASSERT_LT(result.fragmentation, 1.0);
+  }
+
+  // the freed blocks are not adjacent, so auto_growth has to reserve more
+  auto result = ReplayAllocationTrace(trace, "auto_growth", options);
+  ASSERT_EQ(result.peak_reserved, 6UL << 20);
+
+  ASSERT_ANY_THROW(ReplayAllocationTrace(trace, "unknown", options));
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/memory_offload.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class FakeOffloadable : public Offloadable {
+ public:
+  FakeOffloadable(size_t size, std::vector<FakeOffloadable*>* offloaded)
+      : size_(size), offloaded_(offloaded) {}
+
+  size_t Offload() override {
+    if (pinned_) {
+      return 0;
+    }
+    offloaded_->push_back(this);
+    return size_;
+  }
+
+  void Pin() { pinned_ = true; }
+
+ private:
+  size_t size_;
+  bool pinned_{false};
+  std::vector<FakeOffloadable*>* offloaded_;
+};
+
+TEST(MemoryOffloadRegistry, SpillInRegistrationOrder) {
+  auto& registry = MemoryOffloadRegistry::Instance();
+  phi::CPUPlace place;
+  std::vector<FakeOffloadable*> offloaded;
+  FakeOffloadable a(100, &offloaded), b(200, &offloaded), c(300, &offloaded),
+      d(400, &offloaded);
+  registry.Register(place, &a);
+  registry.Register(place, &b);
+  registry.Register(place, &c);
+  registry.Register(place, &d);
+  registry.Unregister(&a);
+  b.Pin();
+
+  ASSERT_EQ(registry.Spill(phi::GPUPlace(0), 100), 0UL);
+  // b can not be offloaded now, so c and d are offloaded
+  ASSERT_EQ(registry.Spill(place, 500), 700UL);
+  ASSERT_EQ(offloaded, (std::vector<FakeOffloadable*>{&c, &d}));
+
+  // the offloaded ones are unregistered
+  ASSERT_EQ(registry.Spill(place, 500), 0UL);
+  registry.Unregister(&b);
+  registry.Unregister(&c);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
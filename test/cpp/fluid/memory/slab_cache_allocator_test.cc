@@ -0,0 +1,144 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_cache_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountedAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t AllocatedSize() const { return allocated_size_; }
+  size_t AllocTimes() const { return alloc_times_; }
+
+ protected:
+  phi::Allocation *AllocateImpl(size_t size) override {
+    allocated_size_ += size;
+    ++alloc_times_;
+    return new Allocation(malloc(size), size, phi::CPUPlace());  // NOLINT
+  }
+
+  void FreeImpl(phi::Allocation *allocation) override {
+    allocated_size_ -= allocation->size();
+    free(allocation->ptr());  // NOLINT
+    delete allocation;
+  }
+
+ private:
+  std::atomic<size_t> allocated_size_{0};
+  std::atomic<size_t> alloc_times_{0};
+};
+
+TEST(SlabCacheAllocator, SizeClass) {
+  auto allocator = std::make_shared<SlabCacheAllocator>(
+      std::make_shared<CountedAllocator>(), 256, 1 << 20, 1 << 30);
+  size_t index = 0;
+  ASSERT_EQ(allocator->SizeClass(0, &index), 0UL);
+  ASSERT_EQ(allocator->SizeClass((1 << 20) + 1, &index), 0UL);
+
+  size_t prev_index = 0;
+  size_t prev_class_size = 0;
+  for (size_t size = 1; size <= (1 << 20); size += 97) {
+    size_t class_size = allocator->SizeClass(size, &index);
+    ASSERT_GE(class_size, size);
+    // at most 25% waste besides the alignment
+    ASSERT_LE(class_size, size + size / 4 + 512);
+    ASSERT_EQ(class_size % 256, 0UL);
+    ASSERT_EQ(allocator->ClassSize(index), class_size);
+    if (prev_class_size != 0) {
+      ASSERT_GE(index, prev_index);
+      ASSERT_LE(index, prev_index + 1);
+    }
+    prev_index = index;
+    prev_class_size = class_size;
+  }
+}
+
+TEST(SlabCacheAllocator, ReuseFreedAllocation) {
+  auto underlying_allocator = std::make_shared<CountedAllocator>();
+  auto allocator = std::make_shared<SlabCacheAllocator>(
+      underlying_allocator, 256, 1 << 20, 1 << 30);
+
+  void *ptr = nullptr;
+  {
+    auto allocation = allocator->Allocate(1000);
+    ASSERT_EQ(allocation->size(), 1024UL);
+    ptr = allocation->ptr();
+  }
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 1024UL);
+
+  for (size_t i = 0; i < 10; ++i) {
+    auto allocation = allocator->Allocate(900 + i);
+    ASSERT_EQ(allocation->ptr(), ptr);
+  }
+  ASSERT_EQ(underlying_allocator->AllocTimes(), 1UL);
+
+  // the large allocations are not cached
+  {
+    auto allocation = allocator->Allocate(2 << 20);
+    ASSERT_EQ(underlying_allocator->AllocatedSize(), 1024UL + (2 << 20));
+  }
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 1024UL);
+
+  allocator->Release(phi::CPUPlace());
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 0UL);
+}
+
+TEST(SlabCacheAllocator, MaxThreadCachedSize) {
+  auto underlying_allocator = std::make_shared<CountedAllocator>();
+  auto allocator = std::make_shared<SlabCacheAllocator>(
+      underlying_allocator, 256, 1 << 20, 4096);
+
+  std::vector<phi::Allocator::AllocationPtr> allocations;
+  for (size_t i = 0; i < 8; ++i) {
+    allocations.emplace_back(allocator->Allocate(1024));
+  }
+  allocations.clear();
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 4096UL);
+}
+
+TEST(SlabCacheAllocator, MultiThread) {
+  auto underlying_allocator = std::make_shared<CountedAllocator>();
+  auto allocator = std::make_shared<SlabCacheAllocator>(
+      underlying_allocator, 256, 1 << 20, 1 << 30);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 8; ++i) {
+    threads.emplace_back([&allocator, i] {
+      for (size_t j = 0; j < 1000; ++j) {
+        auto allocation = allocator->Allocate(256 * (j % 64 + 1) + i);
+        ASSERT_NE(allocation->ptr(), nullptr);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // the caches of the threads are flushed when the threads exit
+  ASSERT_EQ(underlying_allocator->AllocatedSize(), 0UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/memory/memory.h"
 #include "paddle/fluid/platform/device/gpu/gpu_info.h"
@@ -41,6 +42,8 @@
     }                                                    \
   }
 
+COMMON_DECLARE_bool(stream_safe_cuda_allocator_wait_on_free);
+
 namespace paddle {
 namespace memory {
 
@@ -192,6 +195,59 @@ TEST(StreamSafeCUDAAllocInterfaceTest, GetStreamInterfaceTest) {
   CheckMemLeak(place);
 }
 
+TEST(StreamSafeCUDAAllocInterfaceTest, WaitOnFreeTest) {
+  RETURN_IF_NOT_ENABLED;
+
+  FLAGS_stream_safe_cuda_allocator_wait_on_free = true;
+  phi::GPUPlace place = phi::GPUPlace();
+  size_t data_num = 1 << 20;
+  size_t alloc_size = data_num * sizeof(int);
+
+  gpuStream_t new_stream;
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamCreate(&new_stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamCreate(&new_stream));
+#endif
+
+  std::shared_ptr<Allocation> x = AllocShared(place, alloc_size);
+  std::shared_ptr<Allocation> y = AllocShared(place, alloc_size);
+  void *address = x->ptr();
+  RecordStream(x, new_stream);
+  RecordStream(y, new_stream);
+#ifdef PADDLE_WITH_CUDA
+  add_kernel<<<1, 64, 0, new_stream>>>(
+      static_cast<int *>(x->ptr()), static_cast<int *>(y->ptr()), data_num);
+#else
+  hipLaunchKernelGGL(add_kernel,
+                     dim3(1),
+                     dim3(64),
+                     0,
+                     new_stream,
+                     static_cast<int *>(x->ptr()),
+                     static_cast<int *>(y->ptr()),
+                     data_num);
+#endif
+
+  // x is reused by the default stream without waiting for the kernel
+  x.reset();
+  std::shared_ptr<Allocation> z = AllocShared(place, alloc_size);
+  EXPECT_EQ(z->ptr(), address);
+
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamSynchronize(new_stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(cudaStreamDestroy(new_stream));
+#else
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamSynchronize(new_stream));
+  PADDLE_ENFORCE_GPU_SUCCESS(hipStreamDestroy(new_stream));
+#endif
+  y.reset();
+  z.reset();
+  FLAGS_stream_safe_cuda_allocator_wait_on_free = false;
+  Release(place);
+  CheckMemLeak(place);
+}
+
 TEST(StreamSafeCUDAAllocRetryTest, RetryTest) {
   RETURN_IF_NOT_ENABLED;
 
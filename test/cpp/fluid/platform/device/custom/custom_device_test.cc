@@ -23,6 +23,7 @@
 #include "paddle/fluid/platform/init.h"
 #include "paddle/phi/backends/custom/fake_cpu_device.h"
 #include "paddle/phi/backends/device_manager.h"
+#include "paddle/phi/backends/event.h"
 #include "paddle/phi/common/memory_utils.h"
 
 void RegisterDevice() {
@@ -219,6 +220,29 @@ void TestCustomCCL(const phi::Place& place) {
       dev_type, nullptr, 0, phi::DataType::FLOAT32, 0, comm, stream);
 }
 
+void TestEventPool(const phi::Place& place) {
+  std::cout << "TestEventPool on " << place << std::endl;
+  auto& pool = phi::event::EventPool::Instance();
+  pool.Clear();
+  phi::event::Event* raw = nullptr;
+  {
+    auto event = pool.Get(place);
+    EXPECT_TRUE(event->IsInitialized());
+    raw = event.get();
+    EXPECT_EQ(pool.CachedNum(place), 0UL);
+  }
+  EXPECT_EQ(pool.CachedNum(place), 1UL);
+  {
+    auto event = pool.Get(place);
+    EXPECT_EQ(event.get(), raw);
+    auto other = pool.Get(place);
+    EXPECT_NE(other.get(), raw);
+  }
+  EXPECT_EQ(pool.CachedNum(place), 2UL);
+  pool.Clear();
+  EXPECT_EQ(pool.CachedNum(place), 0UL);
+}
+
 TEST(CustomDevice, Tensor) {
   paddle::framework::InitMemoryMethod();
   InitDevice();
@@ -234,6 +258,7 @@ TEST(CustomDevice, Tensor) {
     TestTensorShareDataWith(place);
     TestTensorUtils(place);
     TestCustomCCL(place);
+    TestEventPool(place);
   }
 }
 
@@ -17,11 +17,16 @@ limitations under the License. */
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/phi/common/bfloat16.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/kernel_registry.h"
 
+COMMON_DECLARE_bool(load_combine_use_mmap);
+COMMON_DECLARE_int32(save_combine_data_alignment);
+
 template <typename T, typename U>
 T* CreateForSaveCombineOp(int x,
                           int y,
@@ -368,3 +373,54 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+#ifndef _WIN32
+// Load the parameters by mapping the file, with and without the data aligned
+// by save_combine.
+TEST(SaveLoadCombineOpWithMmap, CPU) {
+  bool use_mmap = FLAGS_load_combine_use_mmap;
+  int32_t data_alignment = FLAGS_save_combine_data_alignment;
+  FLAGS_load_combine_use_mmap = true;
+  SaveLoadCombineOp<int, int>();
+
+  for (int32_t alignment : {64, 0}) {
+    FLAGS_save_combine_data_alignment = alignment;
+    paddle::framework::Scope scope;
+    phi::CPUPlace place;
+    paddle::framework::LoD expect_lod1, expect_lod2;
+    float* expect1 = CreateForSaveCombineOp<float, float>(
+        3, 5, {0, 1, 3}, "test_var1", place, &scope, &expect_lod1);
+    float* expect2 = CreateForSaveCombineOp<float, float>(
+        7, 9, {0, 7}, "test_var2", place, &scope, &expect_lod2);
+
+    paddle::framework::AttributeMap attrs;
+    attrs.insert({"file_path", std::string("check_tensor_mmap.ls")});
+    auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+    save_combine_op->Run(scope, place);
+
+    auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+    auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, attrs);
+    load_combine_op->Run(scope, place);
+
+    paddle::framework::LoD actual_lod1, actual_lod2;
+    float* actual1 =
+        GetValuesAfterLoadCombineOp<float>(target1, scope, &actual_lod1);
+    float* actual2 =
+        GetValuesAfterLoadCombineOp<float>(target2, scope, &actual_lod2);
+    CheckValues<float, float>(expect1, actual1, expect_lod1, actual_lod1, 15);
+    CheckValues<float, float>(expect2, actual2, expect_lod2, actual_lod2, 63);
+
+    // the aligned data is used in place
+    bool mapped = dynamic_cast<
+                      paddle::memory::allocation::MappedFileAllocation*>(
+                      target2->Holder().get()) != nullptr;
+    EXPECT_EQ(mapped, alignment > 0);
+  }
+
+  FLAGS_load_combine_use_mmap = use_mmap;
+  FLAGS_save_combine_data_alignment = data_alignment;
+}
+#endif
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <cstdint>
 #include <cstdio>
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -91,8 +92,75 @@ void predictor_run() {
   PD_PredictorDestroy(predictor);
 }
 
+void predictor_run_batch() {
+  std::string model_dir = FLAGS_infer_model;
+  PD_Config* config = PD_ConfigCreate();
+  PD_ConfigDisableGpu(config);
+  PD_ConfigSetModelDir(config, model_dir.c_str());
+  PD_Predictor* predictor = PD_PredictorCreate(config);
+  std::array<int32_t, 2> input_indices = {
+      PD_PredictorGetInputIndex(predictor, "image"),
+      PD_PredictorGetInputIndex(predictor, "label")};
+  EXPECT_GE(input_indices[0], 0);
+  EXPECT_GE(input_indices[1], 0);
+  EXPECT_EQ(PD_PredictorGetInputIndex(predictor, "not_exist"), -1);
+  PD_OneDimArrayCstr* output_names = PD_PredictorGetOutputNames(predictor);
+  int32_t output_index =
+      PD_PredictorGetOutputIndex(predictor, output_names->data[0]);
+  EXPECT_GE(output_index, 0);
+
+  std::vector<float> data_0(1 * 3 * 224 * 224, 0);
+  std::vector<int64_t> data_1(1, 0);
+  std::array<PD_TensorBuffer, 2> inputs = {};
+  inputs[0].data = data_0.data();
+  inputs[0].capacity = data_0.size() * sizeof(float);
+  inputs[0].dtype = PD_DATA_FLOAT32;
+  inputs[0].shape_size = 4;
+  inputs[0].shape[0] = 1;
+  inputs[0].shape[1] = 3;
+  inputs[0].shape[2] = 224;
+  inputs[0].shape[3] = 224;
+  inputs[1].data = data_1.data();
+  inputs[1].capacity = data_1.size() * sizeof(int64_t);
+  inputs[1].dtype = PD_DATA_INT64;
+  inputs[1].shape_size = 2;
+  inputs[1].shape[0] = 1;
+  inputs[1].shape[1] = 1;
+
+  // the shape of the output is returned if the buffer is too small
+  PD_TensorBuffer output = {};
+  EXPECT_FALSE(PD_PredictorRunBatch(predictor,
+                                    inputs.size(),
+                                    input_indices.data(),
+                                    inputs.data(),
+                                    1,
+                                    &output_index,
+                                    &output));
+  EXPECT_GT(output.shape_size, 0u);
+  size_t out_size = 1;
+  for (size_t i = 0; i < output.shape_size; ++i) {
+    out_size *= output.shape[i];
+  }
+  std::vector<float> out_data(out_size);
+  output.data = out_data.data();
+  output.capacity = out_size * sizeof(float);
+  EXPECT_TRUE(PD_PredictorRunBatch(predictor,
+                                   inputs.size(),
+                                   input_indices.data(),
+                                   inputs.data(),
+                                   1,
+                                   &output_index,
+                                   &output));
+  EXPECT_EQ(output.dtype, PD_DATA_FLOAT32);
+
+  PD_OneDimArrayCstrDestroy(output_names);
+  PD_PredictorDestroy(predictor);
+}
+
 #ifdef PADDLE_WITH_DNNL
 TEST(PD_PredictorRun, predictor_run) { predictor_run(); }
+
+TEST(PD_PredictorRunBatch, predictor_run_batch) { predictor_run_batch(); }
 #endif
 
 }  // namespace analysis
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle_infer {
+namespace services {
+
+KVCacheOptions CpuOptions(int num_blocks) {
+  KVCacheOptions options;
+  options.num_layers = 2;
+  options.num_heads = 2;
+  options.head_dim = 8;
+  options.block_size = 4;
+  options.num_blocks = num_blocks;
+  options.max_blocks_per_seq = 8;
+  options.dtype = DataType::FLOAT32;
+  options.place = PlaceType::kCPU;
+  return options;
+}
+
+TEST(KVCacheManager, allocate_and_free) {
+  KVCacheManager kv_cache(CpuOptions(8));
+  std::vector<int64_t> prompt(10);
+  std::iota(prompt.begin(), prompt.end(), 0);
+  ASSERT_EQ(kv_cache.AddSequence(0, prompt), 0);
+  ASSERT_EQ(kv_cache.BlockTable(0).size(), 3UL);
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 5);
+  ASSERT_TRUE(kv_cache.Append(0, 2));
+  ASSERT_EQ(kv_cache.NumTokens(0), 12);
+  ASSERT_EQ(kv_cache.BlockTable(0).size(), 3UL);
+  ASSERT_TRUE(kv_cache.Append(0));
+  ASSERT_EQ(kv_cache.BlockTable(0).size(), 4UL);
+  // the prompt blocks are never run, so they are not cached
+  kv_cache.FreeSequence(0);
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 8);
+  ASSERT_EQ(kv_cache.AddSequence(1, std::vector<int64_t>(40, 1)), -1);
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 8);
+}
+
+TEST(KVCacheManager, fork_copy_on_write) {
+  KVCacheManager kv_cache(CpuOptions(8));
+  ASSERT_EQ(kv_cache.AddSequence(0, std::vector<int64_t>(6, 1)), 0);
+  ASSERT_TRUE(kv_cache.ForkSequence(0, 1));
+  ASSERT_EQ(kv_cache.BlockTable(0), kv_cache.BlockTable(1));
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 6);
+  // the shared last block is copied before the new token is written
+  ASSERT_TRUE(kv_cache.Append(1));
+  std::vector<int> table0 = kv_cache.BlockTable(0);
+  std::vector<int> table1 = kv_cache.BlockTable(1);
+  ASSERT_EQ(table0[0], table1[0]);
+  ASSERT_NE(table0[1], table1[1]);
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 5);
+  kv_cache.FreeSequence(0);
+  kv_cache.FreeSequence(1);
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 8);
+  ASSERT_FALSE(kv_cache.ForkSequence(0, 2));
+}
+
+TEST(KVCacheManager, truncate) {
+  KVCacheManager kv_cache(CpuOptions(8));
+  ASSERT_EQ(kv_cache.AddSequence(0, std::vector<int64_t>(5, 1)), 0);
+  ASSERT_TRUE(kv_cache.Append(0, 6));
+  ASSERT_EQ(kv_cache.BlockTable(0).size(), 3UL);
+  // roll back the rejected tokens
+  kv_cache.Truncate(0, 7);
+  ASSERT_EQ(kv_cache.NumTokens(0), 7);
+  ASSERT_EQ(kv_cache.BlockTable(0).size(), 2UL);
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 6);
+  kv_cache.Truncate(0, 0);
+  ASSERT_TRUE(kv_cache.BlockTable(0).empty());
+  ASSERT_EQ(kv_cache.NumFreeBlocks(), 8);
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -93,4 +93,146 @@ TEST(PredictorPool, basic) {
   }
 }
 
+TEST(Predictor, optim_model_cache) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(3 * 318 * 318, 0.5);
+  // the first predictor saves the optimized model, the second loads it
+  std::vector<std::vector<float>> outputs(2);
+  for (auto& output : outputs) {
+    Config config;
+    config.SetModel(model_dir + "/model", model_dir + "/params");
+    config.SetOptimCacheDir(FLAGS_infer_model + "/OptimModelCache");
+    config.EnableOptimModelCache();
+    auto predictor = CreatePredictor(config);
+    auto input_t = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+    input_t->Reshape(in_shape);
+    input_t->CopyFromCpu(input.data());
+    predictor->Run();
+    auto output_t =
+        predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+    std::vector<int> out_shape = output_t->shape();
+    output.resize(std::accumulate(
+        out_shape.begin(), out_shape.end(), 1, std::multiplies<int>()));
+    output_t->CopyToCpu(output.data());
+  }
+  ASSERT_EQ(outputs[0].size(), outputs[1].size());
+  for (size_t i = 0; i < outputs[0].size(); i++) {
+    ASSERT_NEAR(outputs[0][i], outputs[1][i], 1e-5);
+  }
+}
+
+TEST(Predictor, mmap_params) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  std::string mmap_params = FLAGS_infer_model + "/mmap_params";
+  ConvertToMmapParams(model_dir + "/model", model_dir + "/params", mmap_params);
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(3 * 318 * 318, 0.5);
+  std::vector<std::vector<float>> outputs(2);
+  for (int i = 0; i < 2; i++) {
+    Config config;
+    config.SetModel(model_dir + "/model",
+                    i == 0 ? model_dir + "/params" : mmap_params);
+    auto predictor = CreatePredictor(config);
+    auto input_t = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+    input_t->Reshape(in_shape);
+    input_t->CopyFromCpu(input.data());
+    predictor->Run();
+    auto output_t =
+        predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+    std::vector<int> out_shape = output_t->shape();
+    outputs[i].resize(std::accumulate(
+        out_shape.begin(), out_shape.end(), 1, std::multiplies<int>()));
+    output_t->CopyToCpu(outputs[i].data());
+  }
+  ASSERT_EQ(outputs[0].size(), outputs[1].size());
+  for (size_t i = 0; i < outputs[0].size(); i++) {
+    ASSERT_NEAR(outputs[0][i], outputs[1][i], 1e-5);
+  }
+}
+
+TEST(BatchingPredictorPool, basic) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableUseGpu(100, 0);
+
+  services::BatchingOptions options;
+  options.max_batch_size = 4;
+  options.max_latency_us = 10000;
+  services::BatchingPredictorPool pool(config, 2, options);
+  auto pred = CreatePredictor(config);
+  std::string in_name = pred->GetInputNames()[0];
+
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  int in_num = 3 * 318 * 318;
+  std::vector<std::vector<float>> expected(8);
+  std::vector<std::future<std::vector<paddle::PaddleTensor>>> futures;
+  for (int i = 0; i < 8; i++) {
+    std::vector<float> input(in_num, i * 0.1);
+    auto input_t = pred->GetInputHandle(in_name);
+    input_t->Reshape(in_shape);
+    input_t->CopyFromCpu(input.data());
+    pred->Run();
+    auto output_t = pred->GetOutputHandle(pred->GetOutputNames()[0]);
+    std::vector<int> out_shape = output_t->shape();
+    expected[i].resize(std::accumulate(
+        out_shape.begin(), out_shape.end(), 1, std::multiplies<int>()));
+    output_t->CopyToCpu(expected[i].data());
+
+    paddle::PaddleTensor tensor;
+    tensor.name = in_name;
+    tensor.shape = in_shape;
+    tensor.dtype = DataType::FLOAT32;
+    tensor.data.Resize(in_num * sizeof(float));
+    std::copy(input.begin(),
+              input.end(),
+              static_cast<float*>(tensor.data.data()));
+    futures.push_back(pool.Submit({std::move(tensor)}));
+  }
+  for (int i = 0; i < 8; i++) {
+    std::vector<paddle::PaddleTensor> outputs = futures[i].get();
+    ASSERT_EQ(outputs[0].shape[0], 1);
+    ASSERT_EQ(outputs[0].data.length(), expected[i].size() * sizeof(float));
+    const float* out_data = static_cast<const float*>(outputs[0].data.data());
+    for (size_t j = 0; j < expected[i].size(); j++) {
+      ASSERT_NEAR(out_data[j], expected[i][j], 1e-3);
+    }
+  }
+}
+
+TEST(Predictor, run_async) {
+  std::string model_dir = FLAGS_infer_model + "/model";
+  Config config;
+  config.SetModel(model_dir + "/model", model_dir + "/params");
+  config.EnableUseGpu(100, 0);
+  auto predictor = CreatePredictor(config);
+  std::vector<int> in_shape = {1, 3, 318, 318};
+  std::vector<float> input(3 * 318 * 318, 0.5);
+  std::vector<std::vector<float>> outputs(2);
+  for (int i = 0; i < 2; i++) {
+    auto input_t = predictor->GetInputHandle(predictor->GetInputNames()[0]);
+    input_t->Reshape(in_shape);
+    input_t->CopyFromCpu(input.data());
+    if (i == 0) {
+      predictor->Run();
+    } else {
+      std::promise<bool> done;
+      auto future = predictor->RunAsync(
+          [&done](bool success) { done.set_value(success); });
+      ASSERT_TRUE(done.get_future().get());
+      ASSERT_TRUE(future.get());
+    }
+    auto output_t =
+        predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+    std::vector<int> out_shape = output_t->shape();
+    outputs[i].resize(std::accumulate(
+        out_shape.begin(), out_shape.end(), 1, std::multiplies<int>()));
+    output_t->CopyToCpu(outputs[i].data());
+  }
+  for (size_t i = 0; i < outputs[0].size(); i++) {
+    ASSERT_NEAR(outputs[0][i], outputs[1][i], 1e-5);
+  }
+}
+
 }  // namespace paddle_infer
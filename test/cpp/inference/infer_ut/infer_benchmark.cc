@@ -0,0 +1,390 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end inference benchmark of a set of models. Every model is run under
+// every config, batch size and thread number given, and the startup time,
+// the p50/p99 latency, the QPS and the peak host memory are written as JSON
+// lines, which can be compared to a baseline written by an earlier run:
+//
+//   ./infer_benchmark --models=resnet50:/data/resnet50,ernie:/data/ernie \
+//       --configs=cpu,onednn --batch_sizes=1,8 --threads=1,4 \
+//       --output=result.json --baseline=baseline.json
+//
+// The inputs are generated from the input shapes of the model, which are
+// the batch size and --seq_len for the unknown dimensions.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/include/paddle_inference_api.h"
+#include "test_helper.h"  // NOLINT
+
+DEFINE_string(models,
+              "",
+              "The models to run, as comma separated name:model_dir pairs. "
+              "model_dir holds inference.json or inference.pdmodel and "
+              "inference.pdiparams.");
+DEFINE_string(configs,
+              "cpu",
+              "The comma separated configs, of cpu, onednn, gpu, cinn, "
+              "trt_fp32 and trt_fp16.");
+DEFINE_string(batch_sizes, "1", "The comma separated batch sizes.");
+DEFINE_string(threads,
+              "1",
+              "The comma separated numbers of the CPU math library threads.");
+DEFINE_int32(seq_len, 128, "The unknown dimensions other than the batch.");
+DEFINE_int32(int_input_value,
+             1,
+             "The value of the integer inputs, e.g. the token ids.");
+DEFINE_int32(warmup, 10, "The runs before the timed ones.");
+DEFINE_int32(repeat, 100, "The timed runs.");
+DEFINE_int32(gpu_id, 0, "The GPU to run on.");
+DEFINE_string(output, "", "The file to write the results to.");
+DEFINE_string(baseline, "", "The results to compare with.");
+DEFINE_double(tolerance,
+              0.1,
+              "The relative regression of the latency, the QPS or the "
+              "startup time to report.");
+
+namespace paddle {
+namespace test {
+
+struct BenchmarkResult {
+  std::string name;
+  std::map<std::string, double> metrics;
+};
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// The peak resident memory of the process in MB, which never decreases, so
+// it is an upper bound of the memory of the model run last.
+double PeakHostMemoryMB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      std::stringstream ss(line.substr(6));
+      double kb = 0;
+      ss >> kb;
+      return kb / 1024.0;
+    }
+  }
+  return 0.;
+}
+
+double Percentile(std::vector<double> sorted, double ratio) {
+  std::sort(sorted.begin(), sorted.end());
+  size_t index = static_cast<size_t>(std::ceil(ratio * sorted.size()));
+  return sorted[std::min(sorted.size(), std::max<size_t>(index, 1)) - 1];
+}
+
+bool SetConfig(const std::string& model_dir,
+               const std::string& config_name,
+               int batch_size,
+               int threads,
+               paddle_infer::Config* config) {
+  std::ifstream json(model_dir + "/inference.json");
+  if (json.good()) {
+    config->SetModel(model_dir + "/inference.json",
+                     model_dir + "/inference.pdiparams");
+  } else {
+    config->SetModel(model_dir + "/inference.pdmodel",
+                     model_dir + "/inference.pdiparams");
+  }
+  config->SetCpuMathLibraryNumThreads(threads);
+  if (config_name == "cpu") {
+    config->DisableMKLDNN();
+  } else if (config_name == "onednn") {
+    config->EnableMKLDNN();
+  } else if (config_name == "gpu") {
+    config->EnableUseGpu(256, FLAGS_gpu_id);
+  } else if (config_name == "cinn") {
+    config->EnableUseGpu(256, FLAGS_gpu_id);
+    config->EnableCINN();
+  } else if (config_name == "trt_fp32" || config_name == "trt_fp16") {
+    config->EnableUseGpu(256, FLAGS_gpu_id);
+    config->EnableTensorRtEngine(1 << 30,
+                                 batch_size,
+                                 3,
+                                 config_name == "trt_fp32"
+                                     ? paddle_infer::PrecisionType::kFloat32
+                                     : paddle_infer::PrecisionType::kHalf,
+                                 false,
+                                 false);
+  } else {
+    LOG(ERROR) << "Unknown config " << config_name;
+    return false;
+  }
+  return true;
+}
+
+void PrepareInputs(paddle_infer::Predictor* predictor, int batch_size) {
+  auto shapes = predictor->GetInputTensorShape();
+  auto types = predictor->GetInputTypes();
+  for (auto& [name, model_shape] : shapes) {
+    std::vector<int> shape;
+    for (size_t i = 0; i < model_shape.size(); ++i) {
+      if (model_shape[i] >= 0) {
+        shape.push_back(static_cast<int>(model_shape[i]));
+      } else {
+        shape.push_back(i == 0 ? batch_size : FLAGS_seq_len);
+      }
+    }
+    int numel =
+        std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<int>());
+    auto input = predictor->GetInputHandle(name);
+    input->Reshape(shape);
+    switch (types[name]) {
+      case paddle_infer::DataType::INT64: {
+        std::vector<int64_t> data(numel, FLAGS_int_input_value);
+        input->CopyFromCpu(data.data());
+        break;
+      }
+      case paddle_infer::DataType::INT32: {
+        std::vector<int32_t> data(numel, FLAGS_int_input_value);
+        input->CopyFromCpu(data.data());
+        break;
+      }
+      default: {
+        std::vector<float> data(numel);
+        for (int i = 0; i < numel; ++i) {
+          data[i] = static_cast<float>(i % 255) / 255.f;
+        }
+        input->CopyFromCpu(data.data());
+        break;
+      }
+    }
+  }
+}
+
+// Runs the model and copies all of the outputs to the host, like a serving
+// request does.
+void RunOnce(paddle_infer::Predictor* predictor) {
+  CHECK(predictor->Run());
+  for (auto& name : predictor->GetOutputNames()) {
+    auto output = predictor->GetOutputHandle(name);
+    auto shape = output->shape();
+    int numel =
+        std::accumulate(shape.begin(), shape.end(), 1, std::multiplies<int>());
+    std::vector<char> data(numel * 8);
+    switch (output->type()) {
+      case paddle_infer::DataType::INT64:
+        output->CopyToCpu(reinterpret_cast<int64_t*>(data.data()));
+        break;
+      case paddle_infer::DataType::INT32:
+        output->CopyToCpu(reinterpret_cast<int32_t*>(data.data()));
+        break;
+      case paddle_infer::DataType::FLOAT32:
+        output->CopyToCpu(reinterpret_cast<float*>(data.data()));
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+bool Benchmark(const std::string& model_name,
+               const std::string& model_dir,
+               const std::string& config_name,
+               int batch_size,
+               int threads,
+               BenchmarkResult* result) {
+  std::stringstream name;
+  name << model_name << "/" << config_name << "/bs" << batch_size << "/t"
+       << threads;
+  result->name = name.str();
+
+  paddle_infer::Config config;
+  if (!SetConfig(model_dir, config_name, batch_size, threads, &config)) {
+    return false;
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto predictor = paddle_infer::CreatePredictor(config);
+  result->metrics["startup_ms"] = ElapsedMs(start);
+
+  PrepareInputs(predictor.get(), batch_size);
+  start = std::chrono::steady_clock::now();
+  RunOnce(predictor.get());
+  result->metrics["first_run_ms"] = ElapsedMs(start);
+  for (int i = 0; i < FLAGS_warmup; ++i) {
+    RunOnce(predictor.get());
+  }
+
+  std::vector<double> latencies;
+  latencies.reserve(FLAGS_repeat);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    // a request feeds the inputs, runs and fetches the outputs
+    auto run_start = std::chrono::steady_clock::now();
+    PrepareInputs(predictor.get(), batch_size);
+    RunOnce(predictor.get());
+    latencies.push_back(ElapsedMs(run_start));
+  }
+  double total_ms = ElapsedMs(start);
+
+  result->metrics["p50_ms"] = Percentile(latencies, 0.5);
+  result->metrics["p99_ms"] = Percentile(latencies, 0.99);
+  result->metrics["qps"] = batch_size * FLAGS_repeat / (total_ms / 1000.0);
+  result->metrics["peak_host_memory_mb"] = PeakHostMemoryMB();
+  return true;
+}
+
+std::string ToJson(const BenchmarkResult& result) {
+  std::stringstream ss;
+  ss << "{\"name\": \"" << result.name << "\"";
+  for (auto& [key, value] : result.metrics) {
+    ss << ", \"" << key << "\": " << value;
+  }
+  ss << "}";
+  return ss.str();
+}
+
+// Reads the JSON lines written by ToJson.
+std::map<std::string, BenchmarkResult> ReadResults(const std::string& path) {
+  std::map<std::string, BenchmarkResult> results;
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    BenchmarkResult result;
+    size_t pos = 0;
+    while ((pos = line.find('"', pos)) != std::string::npos) {
+      size_t end = line.find('"', pos + 1);
+      std::string key = line.substr(pos + 1, end - pos - 1);
+      size_t value_begin = line.find_first_not_of(": ", end + 1);
+      if (line[value_begin] == '"') {
+        pos = line.find('"', value_begin + 1);
+        result.name = line.substr(value_begin + 1, pos - value_begin - 1);
+        ++pos;
+        continue;
+      }
+      size_t value_end = line.find_first_of(",}", value_begin);
+      result.metrics[key] =
+          std::stod(line.substr(value_begin, value_end - value_begin));
+      pos = value_end;
+    }
+    if (!result.name.empty()) {
+      results[result.name] = result;
+    }
+  }
+  return results;
+}
+
+// Returns the number of the regressions from the baseline.
+int CompareWithBaseline(const std::vector<BenchmarkResult>& results,
+                        const std::string& baseline_path) {
+  auto baseline = ReadResults(baseline_path);
+  const std::vector<std::string> larger_is_better = {"qps"};
+  const std::vector<std::string> smaller_is_better = {
+      "startup_ms", "p50_ms", "p99_ms", "peak_host_memory_mb"};
+  int regressions = 0;
+  for (auto& result : results) {
+    auto iter = baseline.find(result.name);
+    if (iter == baseline.end()) {
+      LOG(WARNING) << result.name << " is not in the baseline.";
+      continue;
+    }
+    auto& base = iter->second.metrics;
+    auto report = [&](const std::string& key, double ratio) {
+      std::cout << "REGRESSION " << result.name << " " << key << ": "
+                << base.at(key) << " -> " << result.metrics.at(key) << " ("
+                << (ratio - 1.0) * 100 << "%)" << std::endl;
+      ++regressions;
+    };
+    for (auto& key : larger_is_better) {
+      if (base.count(key) && base.at(key) > 0 &&
+          result.metrics.at(key) < base.at(key) * (1.0 - FLAGS_tolerance)) {
+        report(key, result.metrics.at(key) / base.at(key));
+      }
+    }
+    for (auto& key : smaller_is_better) {
+      if (base.count(key) && base.at(key) > 0 &&
+          result.metrics.at(key) > base.at(key) * (1.0 + FLAGS_tolerance)) {
+        report(key, result.metrics.at(key) / base.at(key));
+      }
+    }
+  }
+  return regressions;
+}
+
+}  // namespace test
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::vector<std::string> models, configs;
+  std::vector<int> batch_sizes, threads;
+  paddle::test::Split(FLAGS_models, ',', &models);
+  paddle::test::Split(FLAGS_configs, ',', &configs);
+  paddle::test::Split(FLAGS_batch_sizes, ',', &batch_sizes);
+  paddle::test::Split(FLAGS_threads, ',', &threads);
+  if (models.empty()) {
+    LOG(ERROR) << "Please set the models to run by --models.";
+    return 1;
+  }
+
+  std::vector<paddle::test::BenchmarkResult> results;
+  for (auto& model : models) {
+    size_t pos = model.find(':');
+    if (pos == std::string::npos) {
+      LOG(ERROR) << "The model should be name:model_dir, but got " << model;
+      return 1;
+    }
+    std::string model_name = model.substr(0, pos);
+    std::string model_dir = model.substr(pos + 1);
+    for (auto& config : configs) {
+      for (int batch_size : batch_sizes) {
+        for (int thread : threads) {
+          paddle::test::BenchmarkResult result;
+          if (!paddle::test::Benchmark(
+                  model_name, model_dir, config, batch_size, thread, &result)) {
+            return 1;
+          }
+          std::cout << paddle::test::ToJson(result) << std::endl;
+          results.push_back(result);
+        }
+      }
+    }
+  }
+
+  if (!FLAGS_output.empty()) {
+    std::ofstream output(FLAGS_output);
+    for (auto& result : results) {
+      output << paddle::test::ToJson(result) << "\n";
+    }
+  }
+  if (!FLAGS_baseline.empty()) {
+    int regressions =
+        paddle::test::CompareWithBaseline(results, FLAGS_baseline);
+    if (regressions > 0) {
+      std::cout << regressions << " regressions from " << FLAGS_baseline
+                << std::endl;
+      return 2;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+#!/bin/bash
+
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Builds infer_benchmark and runs it on ResNet50, ERNIE and the models given
+# by $CTR_MODEL_DIR and $LLM_MODEL_DIR. The results are written to
+# ${log_dir}/benchmark.json and compared to $BASELINE if it is set.
+
+set -x
+PADDLE_ROOT=$1
+TURN_ON_MKL=$2 # use MKL or Openblas
+TEST_GPU_CPU=$3 # benchmark the GPU configs too or only the CPU ones
+DATA_DIR=$4 # dataset
+TENSORRT_ROOT_DIR=$5 # TensorRT ROOT dir, default to /usr/local/TensorRT
+inference_install_dir=${PADDLE_ROOT}/build/paddle_inference_install_dir
+
+cd `dirname $0`
+current_dir=`pwd`
+build_dir=${current_dir}/build_benchmark
+log_dir=${current_dir}/log
+
+configs=${BENCHMARK_CONFIGS:-"cpu"}
+if [ -z "${BENCHMARK_CONFIGS}" ]; then
+  if [ $2 == ON ]; then
+    configs="${configs},onednn"
+  fi
+  if [ $3 == ON ]; then
+    configs="${configs},gpu"
+  fi
+fi
+TENSORRT_COMPILED=$(cat "${inference_install_dir}/version.txt" | grep "WITH_TENSORRT")
+USE_TENSORRT=OFF
+if [ -d "$TENSORRT_ROOT_DIR" ] && [ ! -z "$TENSORRT_COMPILED" ]  ; then
+  USE_TENSORRT=ON
+  if [ -z "${BENCHMARK_CONFIGS}" ]; then
+    configs="${configs},trt_fp32,trt_fp16"
+  fi
+fi
+
+function download() {
+  url_prefix=$1
+  model_name=$2
+  mkdir -p $model_name
+  cd $model_name
+  if [[ -e "${model_name}.tgz" ]]; then
+    echo "${model_name}.tgz has been downloaded."
+  else
+    wget -q --no-proxy ${url_prefix}/${model_name}.tgz
+    tar xzf *.tgz
+  fi
+  cd ..
+}
+
+mkdir -p $DATA_DIR
+cd $DATA_DIR
+download https://paddle-inference-dist.bj.bcebos.com/Paddle-Inference-Demo resnet50
+download https://paddle-qa.bj.bcebos.com/inference_model/2.1.1/nlp ernie_text_cls
+models="resnet50:$DATA_DIR/resnet50/resnet50,ernie:$DATA_DIR/ernie_text_cls/ernie_text_cls"
+if [ ! -z "${CTR_MODEL_DIR}" ]; then
+  models="${models},ctr:${CTR_MODEL_DIR}"
+fi
+if [ ! -z "${LLM_MODEL_DIR}" ]; then
+  models="${models},llm:${LLM_MODEL_DIR}"
+fi
+
+mkdir -p ${build_dir} ${log_dir}
+cd ${build_dir}
+cmake .. -DPADDLE_LIB=${inference_install_dir} \
+         -DWITH_MKL=$TURN_ON_MKL \
+         -DDEMO_NAME=infer_benchmark \
+         -DWITH_GPU=$TEST_GPU_CPU \
+         -DWITH_STATIC_LIB=OFF \
+         -DUSE_TENSORRT=$USE_TENSORRT \
+         -DTENSORRT_ROOT=$TENSORRT_ROOT_DIR
+make -j$(nproc)
+
+baseline_flag=""
+if [ ! -z "${BASELINE}" ]; then
+  baseline_flag="--baseline=${BASELINE}"
+fi
+${build_dir}/infer_benchmark \
+    --models=${models} \
+    --configs=${configs} \
+    --batch_sizes=${BENCHMARK_BATCH_SIZES:-1,8} \
+    --threads=${BENCHMARK_THREADS:-1,4} \
+    --output=${log_dir}/benchmark.json \
+    ${baseline_flag}
+EXIT_CODE=$?
+if [ ${EXIT_CODE} -eq 2 ]; then
+  echo "infer_benchmark found regressions from ${BASELINE}"
+fi
+exit ${EXIT_CODE}
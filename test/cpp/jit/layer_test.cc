@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <cmath>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -56,6 +57,7 @@ PD_DECLARE_KERNEL(scale, GPU, ALL_LAYOUT);
 #endif
 
 COMMON_DECLARE_bool(enable_pir_api);
+COMMON_DECLARE_int32(jit_predictor_pool_size);
 
 namespace paddle {
 namespace jit {
@@ -167,6 +169,39 @@ TEST(CpuLayerTest, Clone) {
   EXPECT_NEAR(out_data[0], pow(1.41562390, 2.0), 1e-6);
 }
 
+TEST(CpuLayerTest, PredictorPool) {
+  if (FLAGS_enable_pir_api) {
+    return;
+  }
+  auto place = phi::CPUPlace();
+  std::string path = "./multi_program_load/export";
+  FLAGS_jit_predictor_pool_size = 2;
+  auto layer = jit::Load(path, place);
+  FLAGS_jit_predictor_pool_size = 0;
+
+  auto inputs = PrepareInputs(place);
+  std::vector<std::future<std::vector<Tensor>>> forward_outs;
+  std::vector<std::future<std::vector<Tensor>>> infer_outs;
+  auto func = layer.Function("infer");
+  for (int i = 0; i < 4; ++i) {
+    forward_outs.push_back(layer.ForwardAsync(inputs));
+    infer_outs.push_back(func.RunAsync(inputs));
+  }
+  for (auto& out : forward_outs) {
+    EXPECT_NEAR(out.get()[0].data<float>()[0], 0.02194316, 1e-6);
+  }
+  for (auto& out : infer_outs) {
+    EXPECT_NEAR(out.get()[0].data<float>()[0], 1.41562390, 1e-6);
+  }
+
+  auto outs = layer.forward(inputs);
+  EXPECT_NEAR(outs[0].data<float>()[0], 0.02194316, 1e-6);
+
+  auto layer2 = layer.Clone();
+  outs = layer2->ForwardAsync(inputs).get();
+  EXPECT_NEAR(outs[0].data<float>()[0], 0.02194316, 1e-6);
+}
+
 #if defined(PADDLE_WITH_CUDA)
 TEST(GpuLayerTest, Construct) {
   if (FLAGS_enable_pir_api) {
@@ -0,0 +1,458 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/cpp/phi/benchmark/kernel_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/layout.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/common/int_array.h"
+#include "paddle/phi/common/scalar.h"
+#include "paddle/phi/core/enforce.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/core/visit_type.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/kernels/autotune/gpu_timer.h"
+#endif
+
+PD_DEFINE_string(kernel_benchmark_cases,
+                 "",
+                 "Path of the yaml list of the kernel benchmark cases.");
+PD_DEFINE_int32(kernel_benchmark_case_id,
+                -1,
+                "Only run the case of this index in the yaml list.");
+
+namespace phi {
+namespace benchmark {
+
+namespace {
+
+bool ParseBackend(const std::string& name,
+                  int device_id,
+                  Backend* backend,
+                  Place* place) {
+  if (name == "CPU") {
+    *backend = Backend::CPU;
+    *place = CPUPlace();
+    return true;
+  }
+  if (name == "ONEDNN") {
+#ifdef PADDLE_WITH_DNNL
+    *backend = Backend::ONEDNN;
+    *place = CPUPlace();
+    return true;
+#else
+    LOG(WARNING) << "Paddle is not compiled with oneDNN, skip ONEDNN.";
+    return false;
+#endif
+  }
+  if (name == "GPU" || name == "GPUDNN") {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+    *backend = name == "GPU" ? Backend::GPU : Backend::GPUDNN;
+    *place = GPUPlace(device_id);
+    return true;
+#else
+    LOG(WARNING) << "Paddle is not compiled with GPU, skip " << name << ".";
+    return false;
+#endif
+  }
+  if (name == "CINN") {
+    // CINN compiles the whole subgraph instead of registering phi kernels.
+    LOG(WARNING) << "CINN has no phi kernel to select, benchmark it end to "
+                    "end with infer_benchmark --configs=cinn instead.";
+    return false;
+  }
+  PADDLE_THROW(common::errors::InvalidArgument(
+      "Unsupported backend %s of the kernel benchmark, expected one of GPU, "
+      "GPUDNN, CPU, ONEDNN and CINN.",
+      name));
+}
+
+template <typename T>
+std::vector<T> ParseList(const YAML::Node& node) {
+  return node.as<std::vector<T>>();
+}
+
+Attribute ParseAttribute(const YAML::Node& node,
+                         AttributeType type,
+                         const Place& place) {
+  switch (type) {
+    case AttributeType::BOOL:
+      return node.as<bool>();
+    case AttributeType::INT32:
+      return node.as<int>();
+    case AttributeType::INT64:
+      return node.as<int64_t>();
+    case AttributeType::FLOAT32:
+      return node.as<float>();
+    case AttributeType::FLOAT64:
+      return node.as<double>();
+    case AttributeType::STRING:
+      return node.as<std::string>();
+    case AttributeType::BOOLS:
+      return ParseList<bool>(node);
+    case AttributeType::INT32S:
+      return ParseList<int>(node);
+    case AttributeType::INT64S:
+      return ParseList<int64_t>(node);
+    case AttributeType::FLOAT32S:
+      return ParseList<float>(node);
+    case AttributeType::FLOAT64S:
+      return ParseList<double>(node);
+    case AttributeType::STRINGS:
+      return ParseList<std::string>(node);
+    case AttributeType::SCALAR:
+      return Scalar(node.as<double>());
+    case AttributeType::SCALARS: {
+      std::vector<Scalar> scalars;
+      for (auto value : ParseList<double>(node)) {
+        scalars.emplace_back(value);
+      }
+      return scalars;
+    }
+    case AttributeType::INT_ARRAY:
+      return IntArray(ParseList<int64_t>(node));
+    case AttributeType::DATA_TYPE:
+      return StringToDataType(node.as<std::string>());
+    case AttributeType::DATA_LAYOUT:
+      return common::StringToDataLayout(node.as<std::string>());
+    case AttributeType::PLACE:
+      // `null` places the result on the place of the backend.
+      return place;
+    default:
+      PADDLE_THROW(common::errors::Unimplemented(
+          "Unsupported attribute type %d of the kernel benchmark.",
+          static_cast<int>(type)));
+  }
+}
+
+}  // namespace
+
+DenseTensor* KernelBenchmark::CreateTensor(const TensorConfig& config,
+                                           DataType dtype,
+                                           const Place& place,
+                                           bool is_output) {
+  auto tensor = std::make_unique<DenseTensor>();
+  tensor->set_meta(
+      DenseTensorMeta(dtype, common::make_ddim(config.dims), DataLayout::NCHW));
+  DenseTensor* result = tensor.get();
+  if (is_output) {
+    outputs_.push_back(std::move(tensor));
+    return result;
+  }
+
+  const auto& init = config.initializer;
+  PADDLE_ENFORCE_EQ(
+      init == "random" || init == "zeros" || init == "ones" ||
+          init == "natural",
+      true,
+      common::errors::InvalidArgument("Unsupported initializer %s, expected "
+                                      "random, zeros, ones or natural.",
+                                      init));
+  auto& pool = DeviceContextPool::Instance();
+  auto* cpu_ctx = pool.Get(CPUPlace());
+  DenseTensor host;
+  host.set_meta(tensor->meta());
+  std::mt19937 engine(static_cast<unsigned int>(inputs_.size()));
+  std::uniform_real_distribution<double> dist(config.min, config.max);
+  PD_VISIT_ALL_TYPES(dtype, "KernelBenchmark::CreateTensor", ([&] {
+                       auto* data = cpu_ctx->Alloc<data_t>(&host);
+                       for (int64_t i = 0; i < host.numel(); ++i) {
+                         double value = 0;
+                         if (init == "random") {
+                           value = dist(engine);
+                         } else if (init == "ones") {
+                           value = 1;
+                         } else if (init == "natural") {
+                           value = static_cast<double>(i);
+                         }
+                         data[i] = static_cast<data_t>(
+                             static_cast<float>(value));
+                       }
+                     }));
+  if (place.GetType() == AllocationType::CPU) {
+    *result = host;
+  } else {
+    Copy(*pool.Get(place), host, place, true, result);
+  }
+  inputs_.push_back(std::move(tensor));
+  return result;
+}
+
+void KernelBenchmark::BuildContext(const Kernel& kernel,
+                                   const Place& place,
+                                   KernelContext* ctx) {
+  const auto& args_def = kernel.args_def();
+  const auto& input_defs = args_def.input_defs();
+  const auto& output_defs = args_def.output_defs();
+  const auto& attr_defs = args_def.attribute_defs();
+  PADDLE_ENFORCE_EQ(config_.inputs.size(),
+                    input_defs.size(),
+                    common::errors::InvalidArgument(
+                        "Kernel %s has %d inputs, but the case gives %d.",
+                        config_.kernel,
+                        input_defs.size(),
+                        config_.inputs.size()));
+  PADDLE_ENFORCE_EQ(config_.attrs.size(),
+                    attr_defs.size(),
+                    common::errors::InvalidArgument(
+                        "Kernel %s has %d attrs, but the case gives %d.",
+                        config_.kernel,
+                        attr_defs.size(),
+                        config_.attrs.size()));
+  PADDLE_ENFORCE_EQ(
+      config_.outputs.empty() || config_.outputs.size() == output_defs.size(),
+      true,
+      common::errors::InvalidArgument(
+          "Kernel %s has %d outputs, but the case gives %d.",
+          config_.kernel,
+          output_defs.size(),
+          config_.outputs.size()));
+
+  auto dtype_of = [&](const TensorConfig& tensor, const TensorArgDef& def) {
+    if (!tensor.dtype.empty()) {
+      return StringToDataType(tensor.dtype);
+    }
+    if (def.dtype != DataType::UNDEFINED) {
+      return def.dtype;
+    }
+    return StringToDataType(config_.dtype);
+  };
+
+  for (size_t i = 0; i < input_defs.size(); ++i) {
+    const auto& arg = config_.inputs[i];
+    const auto& def = input_defs[i];
+    // Some GPU kernels read the shape-like inputs on the host.
+    Place arg_place = def.backend == Backend::CPU ? Place(CPUPlace()) : place;
+    if (arg.is_none) {
+      ctx->EmplaceBackInput(nullptr);
+    } else if (arg.is_list) {
+      paddle::small_vector<const TensorBase*> tensors;
+      for (const auto& tensor : arg.tensors) {
+        tensors.push_back(
+            CreateTensor(tensor, dtype_of(tensor, def), arg_place, false));
+      }
+      ctx->EmplaceBackInputs(std::move(tensors));
+    } else {
+      const auto& tensor = arg.tensors[0];
+      ctx->EmplaceBackInput(
+          CreateTensor(tensor, dtype_of(tensor, def), arg_place, false));
+    }
+  }
+
+  for (size_t i = 0; i < output_defs.size(); ++i) {
+    const auto& def = output_defs[i];
+    if (config_.outputs.empty()) {
+      PADDLE_ENFORCE_EQ(
+          !config_.inputs.empty() && !config_.inputs[0].is_none,
+          true,
+          common::errors::InvalidArgument(
+              "The outputs of kernel %s should be given, since it has no "
+              "input to take the dims from.",
+              config_.kernel));
+      TensorConfig tensor = config_.inputs[0].tensors[0];
+      tensor.dtype.clear();
+      ctx->EmplaceBackOutput(
+          CreateTensor(tensor, dtype_of(tensor, def), place, true));
+      continue;
+    }
+    const auto& arg = config_.outputs[i];
+    if (arg.is_none) {
+      ctx->EmplaceBackOutput(nullptr);
+    } else if (arg.is_list) {
+      paddle::small_vector<TensorBase*> tensors;
+      for (const auto& tensor : arg.tensors) {
+        tensors.push_back(
+            CreateTensor(tensor, dtype_of(tensor, def), place, true));
+      }
+      ctx->EmplaceBackOutputs(std::move(tensors));
+    } else {
+      const auto& tensor = arg.tensors[0];
+      ctx->EmplaceBackOutput(
+          CreateTensor(tensor, dtype_of(tensor, def), place, true));
+    }
+  }
+
+  for (size_t i = 0; i < attr_defs.size(); ++i) {
+    ctx->EmplaceBackAttr(
+        ParseAttribute(config_.attrs[i], attr_defs[i].type_index, place));
+  }
+}
+
+double KernelBenchmark::BytesOfTensors() const {
+  double bytes = 0;
+  for (const auto& tensors : {&inputs_, &outputs_}) {
+    for (const auto& tensor : *tensors) {
+      bytes += static_cast<double>(tensor->numel()) * SizeOf(tensor->dtype());
+    }
+  }
+  return bytes;
+}
+
+KernelBenchmarkResult KernelBenchmark::RunBackend(
+    const std::string& backend_name) {
+  KernelBenchmarkResult result;
+  result.backend = backend_name;
+  Backend backend = Backend::UNDEFINED;
+  Place place;
+  if (!ParseBackend(backend_name, config_.device_id, &backend, &place)) {
+    return result;
+  }
+  KernelKey key(
+      backend, DataLayout::ALL_LAYOUT, StringToDataType(config_.dtype));
+  if (!KernelFactory::Instance().HasKernel(config_.kernel, key)) {
+    LOG(WARNING) << "Kernel " << config_.kernel << " is not registered for "
+                 << key << ", skip " << backend_name << ".";
+    return result;
+  }
+  const Kernel& kernel = KernelFactory::Instance().SelectKernel(config_.kernel,
+                                                                key);
+  inputs_.clear();
+  outputs_.clear();
+  auto* dev_ctx = DeviceContextPool::Instance().Get(place);
+  KernelContext ctx(dev_ctx);
+  BuildContext(kernel, place, &ctx);
+
+  // The first launch also sets the meta of the outputs, which is part of
+  // the bytes moved.
+  for (int i = 0; i < std::max(config_.warmup, 1); ++i) {
+    kernel(&ctx);
+  }
+  dev_ctx->Wait();
+
+  double elapsed_ms = 0;
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  if (place.GetType() == AllocationType::GPU) {
+    auto stream = static_cast<GPUContext*>(dev_ctx)->stream();
+    GpuTimer timer;
+    timer.Start(stream);
+    for (int i = 0; i < config_.repeat; ++i) {
+      kernel(&ctx);
+    }
+    timer.Stop(stream);
+    elapsed_ms = timer.ElapsedTime();
+  }
+#endif
+  if (place.GetType() == AllocationType::CPU) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < config_.repeat; ++i) {
+      kernel(&ctx);
+    }
+    dev_ctx->Wait();
+    elapsed_ms = std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  }
+
+  result.supported = true;
+  result.latency_ms = elapsed_ms / config_.repeat;
+  double bytes = config_.bytes > 0 ? config_.bytes : BytesOfTensors();
+  if (result.latency_ms > 0) {
+    result.bandwidth_gbps = bytes / result.latency_ms / 1e6;
+    result.gflops = config_.flops / result.latency_ms / 1e6;
+  }
+  return result;
+}
+
+std::vector<KernelBenchmarkResult> KernelBenchmark::Run() {
+  std::vector<KernelBenchmarkResult> results;
+  for (const auto& backend : config_.backends) {
+    results.push_back(RunBackend(backend));
+  }
+  inputs_.clear();
+  outputs_.clear();
+  return results;
+}
+
+std::string KernelBenchmark::Report(
+    const KernelBenchmarkConfig& config,
+    const std::vector<KernelBenchmarkResult>& results) {
+  std::ostringstream os;
+  os << "=== " << config.kernel << " [" << config.dtype << "], inputs:";
+  for (const auto& input : config.inputs) {
+    os << (input.is_list ? " [" : " ");
+    for (const auto& tensor : input.tensors) {
+      os << common::make_ddim(tensor.dims) << (input.is_list ? ";" : "");
+    }
+    os << (input.is_none ? "None" : "") << (input.is_list ? "]" : "");
+  }
+  os << ", repeat: " << config.repeat << " ===\n";
+  os << std::left << std::setw(10) << "backend" << std::setw(14)
+     << "latency(ms)" << std::setw(12) << "GB/s" << std::setw(12)
+     << "GFLOP/s"
+     << "speedup\n";
+  double base_ms = 0;
+  for (const auto& result : results) {
+    os << std::setw(10) << result.backend;
+    if (!result.supported) {
+      os << "unsupported\n";
+      continue;
+    }
+    if (base_ms == 0) {
+      base_ms = result.latency_ms;
+    }
+    os << std::setw(14) << result.latency_ms << std::setw(12)
+       << result.bandwidth_gbps << std::setw(12)
+       << (config.flops > 0 ? std::to_string(result.gflops) : "-")
+       << (result.latency_ms > 0 ? base_ms / result.latency_ms : 0) << "\n";
+  }
+  return os.str();
+}
+
+TEST(kernel_benchmark, base) {
+  std::vector<KernelBenchmarkConfig> configs;
+  if (!FLAGS_kernel_benchmark_cases.empty()) {
+    configs = KernelBenchmarkConfig::Load(FLAGS_kernel_benchmark_cases);
+    if (FLAGS_kernel_benchmark_case_id >= 0) {
+      PADDLE_ENFORCE_LT(
+          FLAGS_kernel_benchmark_case_id,
+          static_cast<int>(configs.size()),
+          common::errors::InvalidArgument(
+              "The case id %d is out of the %d kernel benchmark cases.",
+              FLAGS_kernel_benchmark_case_id,
+              configs.size()));
+      configs = {configs[FLAGS_kernel_benchmark_case_id]};
+    }
+  } else {
+    configs.emplace_back(YAML::Load(R"(
+      kernel: add
+      backends: [GPU, CPU, ONEDNN]
+      inputs:
+        - {dims: [1024, 1024]}
+        - {dims: [1024, 1024]}
+      flops: 1048576
+      repeat: 10
+    )"));
+  }
+
+  for (const auto& config : configs) {
+    auto results = KernelBenchmark(config).Run();
+    LOG(INFO) << KernelBenchmark::Report(config, results);
+    if (FLAGS_kernel_benchmark_cases.empty()) {
+      EXPECT_TRUE(results[1].supported);
+      EXPECT_GT(results[1].bandwidth_gbps, 0);
+    }
+  }
+}
+
+}  // namespace benchmark
+}  // namespace phi
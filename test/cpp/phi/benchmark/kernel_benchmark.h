@@ -0,0 +1,74 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/common/backend.h"
+#include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
+#include "paddle/phi/core/kernel_context.h"
+#include "paddle/phi/core/kernel_factory.h"
+#include "test/cpp/phi/benchmark/kernel_benchmark_config.h"
+
+namespace phi {
+namespace benchmark {
+
+struct KernelBenchmarkResult {
+  std::string backend;
+  bool supported{false};
+  double latency_ms{0};
+  double bandwidth_gbps{0};
+  double gflops{0};
+};
+
+// Runs one case on every backend in the config, which selects the kernel
+// from the KernelFactory, generates the inputs on the place of the backend,
+// and times `repeat` launches after `warmup` ones. GPU backends are timed
+// with the GpuTimer events on the stream of the context, the others with
+// the host clock.
+class KernelBenchmark {
+ public:
+  explicit KernelBenchmark(const KernelBenchmarkConfig& config)
+      : config_(config) {}
+
+  std::vector<KernelBenchmarkResult> Run();
+
+  static std::string Report(const KernelBenchmarkConfig& config,
+                            const std::vector<KernelBenchmarkResult>& results);
+
+ private:
+  KernelBenchmarkResult RunBackend(const std::string& backend_name);
+
+  void BuildContext(const Kernel& kernel,
+                    const Place& place,
+                    KernelContext* ctx);
+
+  DenseTensor* CreateTensor(const TensorConfig& config,
+                            DataType dtype,
+                            const Place& place,
+                            bool is_output);
+
+  double BytesOfTensors() const;
+
+  KernelBenchmarkConfig config_;
+  std::vector<std::unique_ptr<DenseTensor>> inputs_;
+  std::vector<std::unique_ptr<DenseTensor>> outputs_;
+};
+
+}  // namespace benchmark
+}  // namespace phi
@@ -0,0 +1,127 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test/cpp/phi/benchmark/kernel_benchmark_config.h"
+
+#include "paddle/common/enforce.h"
+#include "paddle/common/errors.h"
+
+namespace phi {
+namespace benchmark {
+
+TensorConfig::TensorConfig(const YAML::Node& node) {
+  PADDLE_ENFORCE_EQ(node.IsMap() && node["dims"],
+                    true,
+                    common::errors::InvalidArgument(
+                        "A tensor of the kernel benchmark should be a map "
+                        "with `dims`, but received %s.",
+                        YAML::Dump(node)));
+  dims = node["dims"].as<std::vector<int64_t>>();
+  if (node["dtype"]) {
+    dtype = node["dtype"].as<std::string>();
+  }
+  if (node["initializer"]) {
+    initializer = node["initializer"].as<std::string>();
+  }
+  if (node["min"]) {
+    min = node["min"].as<double>();
+  }
+  if (node["max"]) {
+    max = node["max"].as<double>();
+  }
+}
+
+ArgConfig::ArgConfig(const YAML::Node& node) {
+  if (node.IsNull()) {
+    is_none = true;
+  } else if (node.IsSequence()) {
+    is_list = true;
+    for (const auto& tensor : node) {
+      tensors.emplace_back(tensor);
+    }
+  } else {
+    tensors.emplace_back(node);
+  }
+}
+
+KernelBenchmarkConfig::KernelBenchmarkConfig(const YAML::Node& node) {
+  PADDLE_ENFORCE_EQ(
+      node.IsMap() && node["kernel"],
+      true,
+      common::errors::InvalidArgument(
+          "A case of the kernel benchmark should be a map with `kernel`, "
+          "but received %s.",
+          YAML::Dump(node)));
+  kernel = node["kernel"].as<std::string>();
+  if (node["dtype"]) {
+    dtype = node["dtype"].as<std::string>();
+  }
+  if (node["backends"]) {
+    backends = node["backends"].as<std::vector<std::string>>();
+  }
+  for (const auto& input : node["inputs"]) {
+    inputs.emplace_back(input);
+  }
+  for (const auto& output : node["outputs"]) {
+    outputs.emplace_back(output);
+  }
+  for (const auto& attr : node["attrs"]) {
+    attrs.push_back(attr);
+  }
+  if (node["device_id"]) {
+    device_id = node["device_id"].as<int>();
+  }
+  if (node["warmup"]) {
+    warmup = node["warmup"].as<int>();
+  }
+  if (node["repeat"]) {
+    repeat = node["repeat"].as<int>();
+  }
+  if (node["flops"]) {
+    flops = node["flops"].as<double>();
+  }
+  if (node["bytes"]) {
+    bytes = node["bytes"].as<double>();
+  }
+  PADDLE_ENFORCE_GT(repeat,
+                    0,
+                    common::errors::InvalidArgument(
+                        "The repeat of kernel %s should be positive.", kernel));
+}
+
+std::vector<KernelBenchmarkConfig> KernelBenchmarkConfig::Load(
+    const std::string& filename) {
+  YAML::Node root;
+  try {
+    root = YAML::LoadFile(filename);
+  } catch (const YAML::Exception& e) {
+    PADDLE_THROW(common::errors::InvalidArgument(
+        "Failed to load the kernel benchmark cases %s: %s.",
+        filename,
+        e.what()));
+  }
+  PADDLE_ENFORCE_EQ(root.IsSequence(),
+                    true,
+                    common::errors::InvalidArgument(
+                        "The kernel benchmark cases %s should be a list.",
+                        filename));
+  std::vector<KernelBenchmarkConfig> configs;
+  for (const auto& node : root) {
+    configs.emplace_back(node);
+  }
+  return configs;
+}
+
+}  // namespace benchmark
+}  // namespace phi
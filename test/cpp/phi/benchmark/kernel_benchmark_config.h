@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+namespace phi {
+namespace benchmark {
+
+// Describes how one DenseTensor argument of the kernel is generated.
+struct TensorConfig {
+  TensorConfig() {}
+  explicit TensorConfig(const YAML::Node& node);
+
+  std::vector<int64_t> dims;
+  std::string dtype;                  // empty: the dtype of the case
+  std::string initializer{"random"};  // random, zeros, ones, natural
+  double min{-1.0};
+  double max{1.0};
+};
+
+// One argument of the kernel. A `null` in the yaml is an empty optional
+// input, a sequence is a std::vector<DenseTensor> argument.
+struct ArgConfig {
+  ArgConfig() {}
+  explicit ArgConfig(const YAML::Node& node);
+
+  bool is_none{false};
+  bool is_list{false};
+  std::vector<TensorConfig> tensors;
+};
+
+// A case of the kernel benchmark, e.g.
+//
+//   - kernel: matmul
+//     dtype: float16
+//     backends: [GPU, CPU]
+//     inputs:
+//       - {dims: [4096, 4096]}
+//       - {dims: [4096, 4096]}
+//     attrs: [false, false]
+//     flops: 137438953472
+//
+// The inputs, outputs and attrs are listed in the order of the kernel's
+// arguments. The outputs default to the dims of the first input, and the
+// bytes moved default to the size of all the inputs and outputs.
+struct KernelBenchmarkConfig {
+  KernelBenchmarkConfig() {}
+  explicit KernelBenchmarkConfig(const YAML::Node& node);
+
+  static std::vector<KernelBenchmarkConfig> Load(const std::string& filename);
+
+  std::string kernel;
+  std::string dtype{"float32"};
+  std::vector<std::string> backends{"GPU", "CPU"};
+  std::vector<ArgConfig> inputs;
+  std::vector<ArgConfig> outputs;
+  std::vector<YAML::Node> attrs;
+  int device_id{0};
+  int warmup{10};
+  int repeat{100};
+  double flops{0};  // 0: GFLOP/s is not reported
+  double bytes{0};  // 0: computed from the tensors
+};
+
+}  // namespace benchmark
+}  // namespace phi
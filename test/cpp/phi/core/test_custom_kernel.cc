@@ -141,7 +141,7 @@ TEST(CustomKernel, custom_kernel_dot) {
               custom_fake_dot_kernels.end());
 
   // 3.before register
-  auto& kernels = phi::KernelFactory::Instance().kernels();
+  auto& kernels = phi::KernelFactory::Instance().mutable_kernels();
   EXPECT_TRUE(kernels.find(op_name) == kernels.end());
 
   // mock fake_dot is supported by phi for check while registering
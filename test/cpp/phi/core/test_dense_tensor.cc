@@ -129,6 +129,27 @@ TEST(dense_tensor, shallow_copy) {
   CHECK(tensor_0.meta() == tensor_1.meta());
 }
 
+TEST(dense_tensor, strided_view) {
+  const DDim dims({2, 3});
+  const DataType dtype{DataType::FLOAT32};
+  DenseTensorMeta meta(dtype, dims);
+
+  auto fancy_allocator = std::unique_ptr<Allocator>(new FancyAllocator);
+  DenseTensor tensor_0(fancy_allocator.get(), meta);
+
+  DenseTensor tensor_1;
+  tensor_1.set_meta(DenseTensorMeta(dtype, DDim({3, 2})));
+  tensor_1.ShareStridedViewWith(tensor_0, DDim({3, 2}), DDim({1, 3}), 4);
+  CHECK(tensor_1.Holder() == tensor_0.Holder());
+  CHECK(tensor_1.dims() == DDim({3, 2}));
+  CHECK(tensor_1.strides() == DDim({1, 3}));
+  CHECK_EQ(tensor_1.offset(), 4u);
+  CHECK(tensor_1.dtype() == dtype);
+
+  tensor_1.InplaceVersionCounter().Bump();
+  CHECK_EQ(tensor_0.InplaceVersionCounter().CurrentVersion(), 1u);
+}
+
 TEST(dense_tensor, storage_properties) {
   const DataType dtype{DataType::FLOAT32};
   const DDim dims({1, 2});
@@ -12,10 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <sstream>
 
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/phi/common/float16.h"
 #include "paddle/phi/core/dense_tensor.h"
 #include "paddle/phi/core/kernel_factory.h"
@@ -23,11 +26,51 @@ limitations under the License. */
 
 PD_DECLARE_KERNEL(scale, CPU, ALL_LAYOUT);
 
+COMMON_DECLARE_bool(enable_kernel_selection_cache);
+
 namespace phi {
 namespace tests {
 
 // TODO(chenweihang): add more unittests later
 
+// Runs before the tests below, which construct all of the lazy kernels.
+TEST(KernelFactory, LazyKernels) {
+  auto& factory = phi::KernelFactory::Instance();
+  size_t lazy_kernel_size = factory.lazy_kernel_size();
+  EXPECT_GT(lazy_kernel_size, 0UL);
+  // the names are known before the kernels are constructed
+  EXPECT_TRUE(factory.HasCompatiblePhiKernel("test"));
+  EXPECT_EQ(factory.lazy_kernel_size(), lazy_kernel_size);
+
+  auto* kernels = factory.FindKernels("test");
+  ASSERT_NE(kernels, nullptr);
+  EXPECT_EQ(kernels->size(), 3UL);
+  EXPECT_EQ(factory.lazy_kernel_size(), lazy_kernel_size - 3);
+  for (auto& pair : *kernels) {
+    EXPECT_EQ(pair.second.args_def().input_defs().size(), 2UL);
+  }
+  EXPECT_EQ(factory.FindKernels("test"), kernels);
+  EXPECT_EQ(factory.FindKernels("not_registered_kernel"), nullptr);
+}
+
+TEST(KernelFactory, LazyKernelsBenchmark) {
+  auto& factory = phi::KernelFactory::Instance();
+  auto ms = [](const std::function<void()>& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+  };
+  size_t lazy_kernel_size = factory.lazy_kernel_size();
+  double construct_one = ms([&]() { factory.FindKernels("scale"); });
+  double construct_all = ms([&]() { factory.kernels(); });
+  EXPECT_EQ(factory.lazy_kernel_size(), 0UL);
+  std::cout << "Constructing the kernels of scale: " << construct_one
+            << " ms, constructing the rest of the " << lazy_kernel_size
+            << " lazy kernels: " << construct_all << " ms"
+            << std::endl;
+}
+
 TEST(KernelKey, ConstructAndOStream) {
   phi::KernelKey key(
       phi::Backend::CPU, phi::DataLayout::NCHW, phi::DataType::FLOAT32);
@@ -133,6 +176,72 @@ TEST(AttributeType, OStream) {
   oss.str("");
 }
 
+TEST(KernelSelectionCache, SameAsKernelFactory) {
+  phi::KernelKey kernel_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  auto expected =
+      phi::KernelFactory::Instance().SelectKernelOrThrowError("scale",
+                                                              kernel_key);
+  phi::KernelSelectionCache cache("scale");
+  for (int i = 0; i < 2; ++i) {
+    auto result = cache.Select(kernel_key);
+    EXPECT_EQ(&result.kernel, &expected.kernel);
+    EXPECT_EQ(result.has_fallback_cpu, expected.has_fallback_cpu);
+    EXPECT_EQ(result.is_stride_kernel, expected.is_stride_kernel);
+  }
+  EXPECT_EQ(cache.size(), 1UL);
+
+  // Reading the kernels keeps the cache.
+  auto version = phi::KernelFactory::Instance().version();
+  phi::KernelFactory::Instance().kernels();
+  EXPECT_EQ(phi::KernelFactory::Instance().version(), version);
+  cache.Select(
+      {phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT64});
+  EXPECT_EQ(cache.size(), 2UL);
+
+  // The kernels may be changed through mutable_kernels(), the cache is
+  // dropped.
+  phi::KernelFactory::Instance().mutable_kernels();
+  cache.Select(
+      {phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT64});
+  EXPECT_EQ(cache.size(), 1UL);
+
+  EXPECT_ANY_THROW(cache.Select({phi::Backend::CPU,
+                                 phi::DataLayout::ALL_LAYOUT,
+                                 phi::DataType::PSTRING}));
+  EXPECT_EQ(cache.size(), 1UL);
+}
+
+TEST(KernelSelectionCache, Benchmark) {
+  constexpr int kRepeat = 100000;
+  phi::KernelKey kernel_key(
+      phi::Backend::CPU, phi::DataLayout::ALL_LAYOUT, phi::DataType::FLOAT32);
+  auto ns_per_select = [](const std::function<void()>& select) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRepeat; ++i) {
+      select();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           kRepeat;
+  };
+
+  double uncached = ns_per_select([&]() {
+    phi::KernelFactory::Instance().SelectKernelOrThrowError(
+        "scale", kernel_key, true);
+  });
+  phi::KernelSelectionCache cache("scale");
+  double cached = ns_per_select([&]() { cache.Select(kernel_key, true); });
+  FLAGS_enable_kernel_selection_cache = false;
+  double disabled = ns_per_select([&]() { cache.Select(kernel_key, true); });
+  FLAGS_enable_kernel_selection_cache = true;
+
+  std::cout << "SelectKernelOrThrowError: " << uncached << " ns/op, "
+            << "KernelSelectionCache: " << cached << " ns/op, "
+            << "KernelSelectionCache disabled: " << disabled << " ns/op"
+            << std::endl;
+}
+
 }  // namespace tests
 }  // namespace phi
 
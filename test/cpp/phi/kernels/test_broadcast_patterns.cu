@@ -0,0 +1,172 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+#include "paddle/phi/api/lib/utils/allocator.h"
+#include "paddle/phi/backends/context_pool.h"
+#include "paddle/phi/core/tensor_utils.h"
+#include "paddle/phi/kernels/autotune/gpu_timer.h"
+#include "paddle/phi/kernels/funcs/broadcast_function.h"
+
+template <typename T>
+struct AddBinary {
+  inline HOSTDEVICE T operator()(T a, T b) const { return a + b; }
+};
+
+template <typename T>
+struct AddTernary {
+  inline HOSTDEVICE T operator()(T a, T b, T c) const { return a + b + c; }
+};
+
+// The index of the input broadcast to the out_index-th element of the
+// output, whose dims have the same rank as the input's.
+int64_t BroadcastIndex(const phi::DDim& in_dim,
+                       const phi::DDim& out_dim,
+                       int64_t out_index) {
+  int64_t in_index = 0;
+  int64_t in_stride = 1;
+  for (int i = out_dim.size() - 1; i >= 0; --i) {
+    int64_t idx = out_index % out_dim[i];
+    out_index /= out_dim[i];
+    if (in_dim[i] != 1) {
+      in_index += idx * in_stride;
+    }
+    in_stride *= in_dim[i];
+  }
+  return in_index;
+}
+
+// Checks the broadcast of the inputs of in_dims against the reference on the
+// host, then reports the bandwidth of the kernel, which reads and writes each
+// element of the inputs and the output once.
+template <typename T, typename Functor>
+void TestPattern(const phi::GPUContext& dev_ctx,
+                 const std::string& pattern,
+                 const std::vector<phi::DDim>& in_dims,
+                 const phi::DDim& out_dim,
+                 Functor func) {
+  phi::DataType dtype = phi::CppTypeToDataType<T>::Type();
+  const auto alloc_cpu =
+      std::make_unique<paddle::experimental::DefaultAllocator>(phi::CPUPlace());
+  const auto alloc_gpu =
+      std::make_unique<paddle::experimental::DefaultAllocator>(phi::GPUPlace());
+
+  std::vector<std::shared_ptr<phi::DenseTensor>> h_ins;
+  std::vector<std::shared_ptr<phi::DenseTensor>> d_ins;
+  std::vector<const phi::DenseTensor*> inputs;
+  int64_t bytes = 0;
+  for (size_t i = 0; i < in_dims.size(); ++i) {
+    auto h_in = std::make_shared<phi::DenseTensor>(
+        alloc_cpu.get(),
+        phi::DenseTensorMeta(dtype, in_dims[i], phi::DataLayout::NCHW));
+    T* h_data = h_in->data<T>();
+    for (int64_t j = 0; j < h_in->numel(); ++j) {
+      h_data[j] = static_cast<T>((j + i) % 7);
+    }
+    auto d_in = std::make_shared<phi::DenseTensor>(
+        alloc_gpu.get(),
+        phi::DenseTensorMeta(dtype, in_dims[i], phi::DataLayout::NCHW));
+    phi::Copy(dev_ctx, *h_in.get(), phi::GPUPlace(), false, d_in.get());
+    bytes += h_in->numel() * sizeof(T);
+    inputs.push_back(d_in.get());
+    h_ins.push_back(h_in);
+    d_ins.push_back(d_in);
+  }
+  auto d_out = std::make_shared<phi::DenseTensor>(
+      alloc_gpu.get(),
+      phi::DenseTensorMeta(dtype, out_dim, phi::DataLayout::NCHW));
+  std::vector<phi::DenseTensor*> outputs{d_out.get()};
+  bytes += d_out->numel() * sizeof(T);
+
+  phi::funcs::BroadcastKernel<T>(dev_ctx, inputs, &outputs, func);
+  phi::DenseTensor h_out;
+  phi::Copy(dev_ctx, *d_out.get(), phi::CPUPlace(), true, &h_out);
+  const T* out_data = h_out.data<T>();
+  for (int64_t i = 0; i < h_out.numel(); ++i) {
+    T expected = static_cast<T>(0);
+    for (size_t j = 0; j < h_ins.size(); ++j) {
+      expected += h_ins[j]->data<T>()[BroadcastIndex(in_dims[j], out_dim, i)];
+    }
+    ASSERT_EQ(out_data[i], expected) << pattern << " at " << i;
+  }
+
+  const int times = 20;
+  phi::GpuTimer timer;
+  timer.Start(dev_ctx.stream());
+  for (int i = 0; i < times; ++i) {
+    phi::funcs::BroadcastKernel<T>(dev_ctx, inputs, &outputs, func);
+  }
+  timer.Stop(dev_ctx.stream());
+  float ms = timer.ElapsedTime() / times;
+  LOG(INFO) << pattern << ": " << ms << " ms, " << bytes / ms / 1e6 << " GB/s";
+}
+
+TEST(Broadcast, patterns) {
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  auto place = phi::GPUPlace();
+  phi::DeviceContextPool& pool = phi::DeviceContextPool::Instance();
+  auto* dev_ctx = static_cast<const phi::GPUContext*>(pool.GetByPlace(place));
+  auto out_dim = common::make_ddim({4096, 1024});
+
+  TestPattern<float>(*dev_ctx,
+                     "row",
+                     {out_dim, common::make_ddim({1, 1024})},
+                     out_dim,
+                     AddBinary<float>());
+  TestPattern<float>(*dev_ctx,
+                     "column",
+                     {out_dim, common::make_ddim({4096, 1})},
+                     out_dim,
+                     AddBinary<float>());
+  TestPattern<float>(*dev_ctx,
+                     "scalar",
+                     {out_dim, common::make_ddim({1, 1})},
+                     out_dim,
+                     AddBinary<float>());
+  TestPattern<float>(
+      *dev_ctx,
+      "row and column",
+      {out_dim, common::make_ddim({1, 1024}), common::make_ddim({4096, 1})},
+      out_dim,
+      AddTernary<float>());
+  TestPattern<phi::dtype::float16>(*dev_ctx,
+                                   "row float16",
+                                   {out_dim, common::make_ddim({1, 1024})},
+                                   out_dim,
+                                   AddBinary<phi::dtype::float16>());
+  TestPattern<phi::dtype::float16>(*dev_ctx,
+                                   "column float16",
+                                   {out_dim, common::make_ddim({4096, 1})},
+                                   out_dim,
+                                   AddBinary<phi::dtype::float16>());
+
+  // The cols which are not a multiple of the vector size, and the dims which
+  // can not be simplified to 2-D, are computed by the general path.
+  auto odd_dim = common::make_ddim({4096, 1023});
+  TestPattern<float>(*dev_ctx,
+                     "row of odd cols",
+                     {odd_dim, common::make_ddim({1, 1023})},
+                     odd_dim,
+                     AddBinary<float>());
+  auto out_dim_3d = common::make_ddim({64, 64, 256});
+  TestPattern<float>(*dev_ctx,
+                     "3-D",
+                     {out_dim_3d, common::make_ddim({64, 1, 256})},
+                     out_dim_3d,
+                     AddBinary<float>());
+#endif
+}
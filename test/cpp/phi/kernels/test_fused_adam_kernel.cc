@@ -246,6 +246,7 @@ struct AdamInfo {
                                  ToConstMetaTensorPtrVector(master_param_metas))
                            : paddle::none,
                        MetaTensor(),
+                       MetaTensor(),
                        beta1,
                        beta2,
                        epsilon,
@@ -254,12 +255,14 @@ struct AdamInfo {
                        use_adamw,
                        multi_precision,
                        false,
+                       0.0f,
                        ToMutableMetaTensorPtrVector(param_metas),
                        ToMutableMetaTensorPtrVector(moment1_metas),
                        ToMutableMetaTensorPtrVector(moment2_metas),
                        ToMutableMetaTensorPtrVector(beta1_pow_metas),
                        ToMutableMetaTensorPtrVector(beta2_pow_metas),
-                       ToMutableMetaTensorPtrVector(master_param_metas));
+                       ToMutableMetaTensorPtrVector(master_param_metas),
+                       nullptr);
 
     FusedAdamKernel<T, Context>(
         *ctx,
@@ -274,6 +277,7 @@ struct AdamInfo {
             ? paddle::make_optional(ToConstTensorPtrVector(master_params))
             : paddle::none,
         paddle::none,
+        paddle::none,
         beta1,
         beta2,
         epsilon,
@@ -282,12 +286,14 @@ struct AdamInfo {
         use_adamw,
         multi_precision,
         false,
+        0.0f,
         ToMutableTensorPtrVector(params),
         ToMutableTensorPtrVector(moment1s),
         ToMutableTensorPtrVector(moment2s),
         ToMutableTensorPtrVector(beta1_pows),
         ToMutableTensorPtrVector(beta2_pows),
-        ToMutableTensorPtrVector(master_params));
+        ToMutableTensorPtrVector(master_params),
+        nullptr);
   }
 
   void UpdateWithAdamWBaseline(const std::vector<DenseTensor> &grads,
@@ -370,3 +370,69 @@ TEST(ConfigSearcher, TestReduceDemo) {
   file_database.AddConfig(
       cinn::common::DefaultTarget(), bucket_info, tile_config, -1);
 }
+
+// Counts the candidates measured, scoring them by the cost model instead of
+// running them on the device.
+class CountingObjectiveFunc : public cinn::ir::search::BaseObjectiveFunc {
+ public:
+  CountingObjectiveFunc(const cinn::ir::BucketInfo& bucket_info, int* count)
+      : cost_model_(cinn::common::DefaultTarget(), bucket_info),
+        count_(count) {}
+
+  cinn::ir::search::ScoreType operator()(
+      const cinn::ir::search::CandidateType& candidate) override {
+    ++(*count_);
+    return cost_model_(candidate);
+  }
+
+ private:
+  cinn::ir::search::AnalyticalCostModelFunc cost_model_;
+  int* count_;
+};
+
+TEST(ConfigSearcher, TestCostModelTopK) {
+  constexpr int kThreadsPerWarp = 32;
+  constexpr int kTopK = 4;
+  cinn::ir::BucketInfo bucket_info(std::vector<cinn::ir::BucketInfo::Dimension>{
+      cinn::ir::BucketInfo::Dimension{1024, 1024, "S", false},
+      cinn::ir::BucketInfo::Dimension{4096, 4096, "R", false}});
+
+  // a long reduce is better split over the threads of a block
+  cinn::ir::search::AnalyticalCostModelFunc cost_model(
+      cinn::common::DefaultTarget(), bucket_info);
+  ASSERT_LT(cost_model({8, 256, 1}), cost_model({8, 1, 1}));
+
+  std::vector<std::pair<int, int>> candidate_range{{1, 8}, {1, 256}, {1, 2}};
+  std::vector<cinn::ir::search::ConstraintFunc> constraints;
+  constraints.emplace_back(
+      [](const cinn::ir::search::CandidateType& candidate) -> bool {
+        return candidate[1] % kThreadsPerWarp == 0 || candidate[1] == 1;
+      });
+  constraints.emplace_back(
+      [](const cinn::ir::search::CandidateType& candidate) -> bool {
+        return candidate[0] * kThreadsPerWarp % candidate[1] == 0;
+      });
+
+  std::vector<cinn::ir::search::CandidateType> candidates =
+      cinn::ir::search::CandidateGenerator(candidate_range, constraints)
+          .Candidates();
+  ASSERT_GT(candidates.size(), static_cast<size_t>(kTopK));
+  cinn::ir::search::ScoreType min_cost = cost_model(candidates[0]);
+  for (const auto& candidate : candidates) {
+    min_cost = std::min(min_cost, cost_model(candidate));
+  }
+
+  int measured = 0;
+  cinn::ir::search::ScheduleConfigSearcher searcher(
+      std::make_unique<CountingObjectiveFunc>(bucket_info, &measured),
+      candidate_range,
+      constraints,
+      std::make_unique<cinn::ir::search::AnalyticalCostModelFunc>(
+          cinn::common::DefaultTarget(), bucket_info),
+      kTopK);
+  auto search_res = searcher.Search();
+  ASSERT_EQ(measured, kTopK);
+  ASSERT_EQ(search_res.first, min_cost);
+  LOG(INFO) << "best candidate: "
+            << cinn::utils::Join<int64_t>(search_res.second, ", ");
+}
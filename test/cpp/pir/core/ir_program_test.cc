@@ -14,6 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <iostream>
+#include <memory>
 #include <sstream>
 
 #include "paddle/fluid/pir/dialect/operator/interface/op_yaml_info.h"
@@ -24,6 +27,7 @@
 #include "paddle/phi/infermeta/binary.h"
 #include "paddle/phi/kernels/elementwise_add_kernel.h"
 #include "paddle/pir/include/core/block.h"
+#include "paddle/pir/include/core/builder.h"
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_dialect.h"
 #include "paddle/pir/include/core/builtin_op.h"
@@ -33,6 +37,7 @@
 // NOTE(zhangbo9674): File pd_op.h is generated by op_gen.py, see details in
 // paddle/fluid/pir/dialect/CMakeLists.txt.
 #include "paddle/common/errors.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/dialect/operator/transforms/param_to_variable.h"
 #include "paddle/phi/core/enforce.h"
@@ -72,6 +77,8 @@ void AddOp::Build(pir::Builder &,
 IR_DECLARE_EXPLICIT_TEST_TYPE_ID(AddOp)
 IR_DEFINE_EXPLICIT_TYPE_ID(AddOp)
 
+COMMON_DECLARE_bool(pir_use_operation_arena);
+
 TEST(program_test, slice_combine_test) {
   // (1) Init environment.
   pir::IrContext *ctx = pir::IrContext::Instance();
@@ -128,3 +135,55 @@ TEST(program_test, slice_combine_test) {
   // (8) Traverse Program
   EXPECT_EQ(program.block()->size() == 4, true);
 }
+
+TEST(program_test, operation_arena) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  pir::Type fp32_dtype = pir::Float32Type::get(ctx);
+  bool use_operation_arena = FLAGS_pir_use_operation_arena;
+
+  // Build and clone a program with or without the arena.
+  constexpr int kNumOps = 20000;
+  for (bool use_arena : {false, true}) {
+    FLAGS_pir_use_operation_arena = use_arena;
+    auto begin = std::chrono::steady_clock::now();
+    pir::Program program(ctx);
+    EXPECT_EQ(program.arena() != nullptr, use_arena);
+    pir::Builder builder(ctx, program.block());
+    for (int i = 0; i < kNumOps / 2; ++i) {
+      auto constant_op = builder.Build<pir::ConstantOp>(
+          pir::FloatAttribute::get(ctx, 1.f), fp32_dtype);
+      builder.Build<pir::CombineOp>(
+          std::vector<pir::Value>{constant_op.out(), constant_op.out()});
+    }
+    auto built = std::chrono::steady_clock::now();
+    pir::IrMapping ir_mapping;
+    auto cloned_program = program.Clone(ir_mapping);
+    auto cloned = std::chrono::steady_clock::now();
+    EXPECT_EQ(cloned_program->block()->size(), program.block()->size());
+    EXPECT_EQ(cloned_program->arena() != nullptr, use_arena);
+    using us = std::chrono::microseconds;
+    std::cout << "Built " << kNumOps << " ops in "
+              << std::chrono::duration_cast<us>(built - begin).count()
+              << " us, cloned in "
+              << std::chrono::duration_cast<us>(cloned - built).count()
+              << " us " << (use_arena ? "with" : "without") << " the arena."
+              << std::endl;
+  }
+
+  // An operation may outlive the program it is allocated from.
+  FLAGS_pir_use_operation_arena = true;
+  auto program = std::make_unique<pir::Program>(ctx);
+  pir::Program other_program(ctx);
+  pir::Builder builder(ctx, program->block());
+  auto constant_op = builder.Build<pir::ConstantOp>(
+      pir::FloatAttribute::get(ctx, 2.f), fp32_dtype);
+  constant_op->MoveTo(other_program.block(), other_program.block()->end());
+  program.reset();
+  EXPECT_EQ(other_program.block()->size(), 1u);
+  EXPECT_EQ(other_program.block()->front().attribute<pir::FloatAttribute>(
+                "value"),
+            pir::FloatAttribute::get(ctx, 2.f));
+
+  FLAGS_pir_use_operation_arena = use_operation_arena;
+}
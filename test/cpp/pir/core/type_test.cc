@@ -13,7 +13,11 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
@@ -399,3 +403,43 @@ TEST(type_test, get_type_name) {
   auto name = pir::get_type_name<TestNamespace::TestClass>();
   EXPECT_EQ(name, "TestNamespace::TestClass");
 }
+
+TEST(type_test, concurrent_parametric_storage) {
+  // The threads intern the same types concurrently, each of them must get the
+  // same instance as the others.
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  constexpr int kNumThreads = 8;
+  constexpr int kNumTypes = 4096;
+  pir::Type fp32_dtype = pir::Float32Type::get(ctx);
+  std::vector<std::vector<pir::Type>> types(kNumThreads);
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumTypes; ++i) {
+        // each thread walks the types from a different one
+        int index = (i + t * kNumTypes / kNumThreads) % kNumTypes;
+        common::DDim dims = common::make_ddim({index / 64 + 1, index % 64 + 1});
+        types[t].push_back(pir::VectorType::get(
+            ctx,
+            {pir::DenseTensorType::get(
+                ctx, fp32_dtype, dims, common::DataLayout::NCHW, {}, 0)}));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - begin);
+  std::cout << "Interned " << kNumTypes << " types by " << kNumThreads
+            << " threads in " << elapsed.count() << " us." << std::endl;
+
+  for (int t = 1; t < kNumThreads; ++t) {
+    for (int i = 0; i < kNumTypes; ++i) {
+      int index = (i + t * kNumTypes / kNumThreads) % kNumTypes;
+      EXPECT_EQ(types[t][i], types[0][index]);
+    }
+  }
+  EXPECT_NE(types[0][0], types[0][1]);
+}
@@ -13,18 +13,21 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <thread>
 #include "glog/logging.h"
 
 // NOTE(zhangbo9674): File pd_op.h is generated by op_gen.py, see details in
 // paddle/fluid/pir/dialect/CMakeLists.txt.
 #include "paddle/common/errors.h"
 #include "paddle/fluid/pir/dialect/operator/interface/op_yaml_info.h"
+#include "paddle/fluid/pir/dialect/operator/ir/control_flow_op.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
 #include "paddle/fluid/pir/dialect/operator/utils/utils.h"
 #include "paddle/phi/core/enforce.h"
 #include "paddle/phi/kernels/elementwise_add_kernel.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_dialect.h"
 #include "paddle/pir/include/core/builtin_op.h"
 #include "paddle/pir/include/core/builtin_type.h"
@@ -32,6 +35,8 @@
 #include "paddle/pir/include/core/ir_context.h"
 #include "paddle/pir/include/core/op_base.h"
 #include "paddle/pir/include/core/operation.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_dialect.h"
+#include "paddle/pir/include/dialect/control_flow/ir/cf_op.h"
 #include "paddle/pir/include/pass/pass.h"
 #include "paddle/pir/include/pass/pass_manager.h"
 #include "test/cpp/pir/tools/macros_utils.h"
@@ -311,3 +316,91 @@ TEST(pass_manager, PassManager) {
       true,
       phi::errors::InvalidArgument("Program not run. Expected run."));
 }
+
+// Records the number of the ops nested in each if op, and whether it is run
+// by the thread of the pass manager.
+class CountNestedOpsPass : public pir::Pass {
+ public:
+  explicit CountNestedOpsPass(std::thread::id main_thread_id)
+      : pir::Pass("count_nested_ops_pass", 1),
+        main_thread_id_(main_thread_id) {}
+
+  void Run(pir::Operation *op) override {
+    int count = 0;
+    for (size_t i = 0; i < op->num_regions(); ++i) {
+      for (auto &block : op->region(i)) {
+        count += block.size();
+      }
+    }
+    pir::IrContext *ctx = pir::IrContext::Instance();
+    op->set_attribute("num_nested_ops", pir::Int32Attribute::get(ctx, count));
+    op->set_attribute(
+        "in_main_thread",
+        pir::BoolAttribute::get(
+            ctx, std::this_thread::get_id() == main_thread_id_));
+  }
+
+  bool CanApplyOn(pir::Operation *op) const override {
+    return op->isa<paddle::dialect::IfOp>();
+  }
+
+ private:
+  std::thread::id main_thread_id_;
+};
+
+TEST(pass_manager, ParallelExecution) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::ControlFlowDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  auto cond = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{1}, true, phi::DataType::BOOL);
+  auto outer = builder.Build<paddle::dialect::FullOp>(
+      std::vector<int64_t>{1}, true, phi::DataType::BOOL);
+  constexpr int kNumIfOps = 8;
+  std::vector<pir::Operation *> if_ops;
+  for (int i = 0; i < kNumIfOps; ++i) {
+    builder.SetInsertionPointToBlockEnd(program.block());
+    auto if_op = builder.Build<paddle::dialect::IfOp>(
+        cond.out(), std::vector<pir::Type>{builder.bool_type()});
+    // The last if op uses a value defined outside, so it is run serially.
+    builder.SetInsertionPointToStart(&if_op.true_block());
+    pir::Value true_out =
+        i + 1 == kNumIfOps
+            ? outer.out()
+            : builder
+                  .Build<paddle::dialect::FullOp>(
+                      std::vector<int64_t>{1}, true, phi::DataType::BOOL)
+                  .out();
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{true_out});
+    builder.SetInsertionPointToStart(&if_op.false_block());
+    for (int j = 0; j < i; ++j) {
+      builder.Build<paddle::dialect::FullOp>(
+          std::vector<int64_t>{1}, false, phi::DataType::BOOL);
+    }
+    auto false_out = builder.Build<paddle::dialect::FullOp>(
+        std::vector<int64_t>{1}, false, phi::DataType::BOOL);
+    builder.Build<pir::YieldOp>(std::vector<pir::Value>{false_out.out()});
+    if_ops.push_back(if_op.operation());
+  }
+
+  std::thread::id main_thread_id = std::this_thread::get_id();
+  pir::PassManager pm(ctx);
+  pm.AddPass(std::make_unique<CountNestedOpsPass>(main_thread_id));
+  pm.EnableParallelExecution(4, [&](pir::PassManager *worker_pm) {
+    worker_pm->AddPass(std::make_unique<CountNestedOpsPass>(main_thread_id));
+  });
+  EXPECT_TRUE(pm.Run(&program));
+
+  for (int i = 0; i < kNumIfOps; ++i) {
+    bool isolated = i + 1 != kNumIfOps;
+    EXPECT_EQ(
+        if_ops[i]->attribute<pir::Int32Attribute>("num_nested_ops").data(),
+        isolated ? i + 4 : i + 3);
+    EXPECT_EQ(
+        if_ops[i]->attribute<pir::BoolAttribute>("in_main_thread").data(),
+        !isolated);
+  }
+}
@@ -18,6 +18,8 @@
 #include <memory>
 #include <numeric>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/common/enforce.h"
@@ -206,6 +208,29 @@ TEST(PatternRewrite, FrozenRewritePatternSet) {
             2U);
 }
 
+TEST(PatternRewrite, MergedFrozenRewritePatternSet) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  auto *test_dialect = ctx->GetOrRegisterDialect<TestDialect>();
+  test_dialect->RegisterOp<Operation1>();
+  pir::RewritePatternSet ps1(ctx);
+  ps1.Add<TestPatternRewrite>(ctx, 1);
+  pir::RewritePatternSet ps2(ctx);
+  ps2.Add<TestPatternRewrite2>(ctx, 1);
+
+  pir::FrozenRewritePatternSet merged_set(
+      std::vector<pir::FrozenRewritePatternSet>{
+          pir::FrozenRewritePatternSet(std::move(ps1)),
+          pir::FrozenRewritePatternSet(std::move(ps2))});
+  EXPECT_TRUE(merged_set.match_any_op_native_patterns().empty());
+  const auto &patterns = merged_set.op_specific_native_patterns().at(
+      ctx->GetRegisteredOpInfo("test.Operation1"));
+  // The patterns outlive the merged sets, and keep the order of the sets.
+  ASSERT_EQ(patterns.size(), 2U);
+  EXPECT_NE(dynamic_cast<TestPatternRewrite *>(patterns[0]), nullptr);
+  EXPECT_NE(dynamic_cast<TestPatternRewrite2 *>(patterns[1]), nullptr);
+}
+
 class RedundantTransposeFusePattern
     : public pir::OpRewritePattern<paddle::dialect::TransposeOp> {
  public:
@@ -429,6 +454,58 @@ TEST(pattern_rewrite, Patterns) {
   EXPECT_EQ(program.block()->size(), 17u);
 }
 
+TEST(pattern_rewrite, IncrementalRewrite) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+
+  // Fuse a chain of transposes with the rescans or incrementally.
+  auto Rewrite = [&](bool incremental,
+                     std::unordered_map<std::string, pir::PatternStatistics>
+                         *statistics) {
+    pir::Program program(ctx);
+    pir::Builder builder = pir::Builder(ctx, program.block());
+    pir::Value out =
+        builder
+            .Build<paddle::dialect::FullOp>(std::vector<int64_t>{4, 3, 16, 16},
+                                            1.5,
+                                            phi::DataType::FLOAT32,
+                                            phi::CPUPlace())
+            .out();
+    for (int i = 0; i < 6; ++i) {
+      out = builder
+                .Build<paddle::dialect::TransposeOp>(
+                    out,
+                    i % 2 == 0 ? std::vector<int>{0, 2, 3, 1}
+                               : std::vector<int>{0, 3, 1, 2})
+                .out();
+    }
+    builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+
+    pir::RewritePatternSet ps(ctx);
+    ps.Add<RedundantTransposeFusePattern>(ctx);
+    pir::FrozenRewritePatternSet patterns(std::move(ps));
+    pir::GreedyRewriteConfig config;
+    config.use_top_down_traversal = true;
+    config.incremental = incremental;
+    config.statistics = statistics;
+    auto [converged, num_rewrites] =
+        pir::ApplyPatternsGreedily(program.module_op(), patterns, config);
+    EXPECT_TRUE(converged);
+    return std::make_pair(num_rewrites, program.block()->size());
+  };
+
+  std::unordered_map<std::string, pir::PatternStatistics> statistics;
+  auto rescan_result = Rewrite(false, nullptr);
+  auto incremental_result = Rewrite(true, &statistics);
+  EXPECT_EQ(incremental_result, rescan_result);
+  EXPECT_GT(incremental_result.first, 0);
+  ASSERT_EQ(statistics.size(), 1U);
+  const auto &pattern_statistics = statistics.begin()->second;
+  EXPECT_EQ(pattern_statistics.num_matches, incremental_result.first);
+  EXPECT_GE(pattern_statistics.num_attempts, pattern_statistics.num_matches);
+}
+
 void BuildConstantFoldingProgram(pir::Program *program,
                                  pir::IrContext *ctx,
                                  paddle::framework::Scope *scope) {
@@ -520,6 +597,71 @@ TEST(constant_folding, ConstantFolding_Train) {
   EXPECT_EQ(program.block()->size(), 4u);
 }
 
+TEST(constant_folding, ConstantFoldingDedup) {
+  pir::IrContext *ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+
+  pir::Program program(ctx);
+  paddle::framework::Scope scope;
+  pir::Builder builder = pir::Builder(ctx, program.block());
+
+  phi::DDim dims = {2, 4};
+  pir::Type dense_tensor_dtype =
+      paddle::dialect::DenseTensorType::get(ctx,
+                                            pir::Float32Type::get(ctx),
+                                            dims,
+                                            phi::DataLayout::NCHW,
+                                            phi::LoD(),
+                                            0);
+  phi::DeviceContext *dev_ctx =
+      phi::DeviceContextPool::Instance().Get(phi::CPUPlace());
+  // two weights of the same content
+  for (const auto &name : {"w1", "w2"}) {
+    auto *tensor = scope.Var(name)->GetMutable<phi::DenseTensor>();
+    tensor->Resize(dims);
+    float *data = dev_ctx->Alloc<float>(tensor);
+    std::iota(data, data + tensor->numel(), 0.f);
+  }
+
+  auto w1 = builder.Build<pir::ParameterOp>("w1", dense_tensor_dtype);
+  auto w2 = builder.Build<pir::ParameterOp>("w2", dense_tensor_dtype);
+  std::vector<pir::Value> weights = {w1.result(0), w1.result(0), w2.result(0)};
+  for (size_t i = 0; i < weights.size(); ++i) {
+    auto transpose_op = builder.Build<paddle::dialect::TransposeOp>(
+        weights[i], std::vector<int>{1, 0});
+    builder.Build<paddle::dialect::FetchOp>(
+        transpose_op.out(), "out" + std::to_string(i), static_cast<int>(i));
+  }
+
+  pir::PassManager pm(ctx);
+  std::unique_ptr<pir::Pass> constant_folding_pass =
+      pir::CreateConstantFoldingPass();
+  phi::Place place = phi::CPUPlace();
+  constant_folding_pass->SetNotOwned(pir::Pass::kPlaceAttr, &place);
+  constant_folding_pass->SetNotOwned(pir::Pass::kParamScopeAttr, &scope);
+  pm.AddPass(std::move(constant_folding_pass));
+  pm.AddPass(pir::CreateDeadCodeEliminationPass());
+
+  CHECK_EQ(pm.Run(&program), true);
+  EXPECT_EQ(program.block()->size(), 6u);
+  // the transposes are folded into one var, the weights are released
+  std::unordered_set<std::string> param_names;
+  for (auto &op : *program.block()) {
+    if (op.isa<pir::ParameterOp>()) {
+      param_names.insert(op.dyn_cast<pir::ParameterOp>().param_name());
+    }
+  }
+  EXPECT_EQ(param_names.size(), 1u);
+  EXPECT_EQ(scope.FindVar("w1"), nullptr);
+  EXPECT_EQ(scope.FindVar("w2"), nullptr);
+  size_t num_folded_vars = 0;
+  for (const auto &name : scope.LocalVarNames()) {
+    if (name.find("constant_folding@") == 0) ++num_folded_vars;
+  }
+  EXPECT_EQ(num_folded_vars, 1u);
+}
+
 void BuildConcatProgram(pir::Program *program, pir::IrContext *ctx) {
   pir::Builder builder = pir::Builder(ctx, program->block());
   auto x = builder
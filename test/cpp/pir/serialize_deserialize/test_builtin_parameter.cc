@@ -14,7 +14,9 @@
 
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <fstream>
 #include <memory>
+#include <sstream>
 
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
 #include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
@@ -60,3 +62,43 @@ TEST(SaveTest, uncompelteted_parameter) {
   EXPECT_EQ(new_op.attribute("stop_gradient").isa<pir::ArrayAttribute>(), true);
   EXPECT_EQ(new_op.attribute("trainable").isa<pir::ArrayAttribute>(), true);
 }
+
+TEST(SaveTest, binary_format) {
+  pir::IrContext* ctx = pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  ctx->GetOrRegisterDialect<pir::BuiltinDialect>();
+  pir::Program program(ctx);
+  pir::Builder builder = pir::Builder(ctx, program.block());
+  auto full_op1 =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{64, 64}, 1.5);
+  auto full_op2 =
+      builder.Build<paddle::dialect::FullOp>(std::vector<int64_t>{64, 64}, 2.5);
+  auto add_op =
+      builder.Build<paddle::dialect::AddOp>(full_op1.out(), full_op2.out());
+  builder.Build<paddle::dialect::FetchOp>(add_op.out(), "out", 0);
+
+  pir::WriteModule(program, "./test_json_program", /*pir_version*/ 0, true);
+  pir::WriteModule(program,
+                   "./test_binary_program",
+                   /*pir_version*/ 0,
+                   true,
+                   false,
+                   true,
+                   /*binary*/ true);
+  std::ifstream json_file("./test_json_program", std::ios::ate);
+  std::ifstream binary_file("./test_binary_program", std::ios::ate);
+  EXPECT_LT(binary_file.tellg(), json_file.tellg());
+
+  // The both formats are read into the same program.
+  pir::Program json_program(ctx);
+  EXPECT_TRUE(
+      pir::ReadModule("./test_json_program", &json_program, /*pir_version*/ 0));
+  pir::Program binary_program(ctx);
+  EXPECT_TRUE(pir::ReadModule(
+      "./test_binary_program", &binary_program, /*pir_version*/ 0));
+  std::ostringstream json_str, binary_str;
+  json_program.Print(json_str);
+  binary_program.Print(binary_str);
+  EXPECT_EQ(binary_program.block()->size(), 4u);
+  EXPECT_EQ(binary_str.str(), json_str.str());
+}
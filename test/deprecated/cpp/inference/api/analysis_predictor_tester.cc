@@ -20,6 +20,10 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <numeric>
 #include <thread>  // NOLINT
 
 #include "paddle/fluid/framework/ir/pass.h"
@@ -455,6 +459,110 @@ TEST(Predictor, Run) {
   predictor->TryShrinkMemory();
 }
 
+TEST(Predictor, UpdateParams) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  auto predictor = CreatePredictor(config);
+
+  auto bias = predictor->GetOutputHandle("fc_1.b_0");
+  std::vector<int> shape = bias->shape();
+  auto new_bias = std::make_shared<phi::DenseTensor>();
+  new_bias->Resize(common::make_ddim(shape));
+  auto* new_bias_data = new_bias->mutable_data<float>(phi::CPUPlace());
+  for (int64_t i = 0; i < new_bias->numel(); ++i) {
+    new_bias_data[i] = 0.5f;
+  }
+  predictor->UpdateParams({{"fc_1.b_0", paddle::Tensor(new_bias)}});
+
+  std::vector<float> bias_data(new_bias->numel());
+  bias->CopyToCpu(bias_data.data());
+  for (float value : bias_data) {
+    ASSERT_EQ(value, 0.5f);
+  }
+  ASSERT_ANY_THROW(
+      predictor->UpdateParams({{"not_a_param", paddle::Tensor(new_bias)}}));
+}
+
+TEST(Predictor, LatencyStats) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableLatencyStats();
+  auto predictor = CreatePredictor(config);
+  ASSERT_EQ(predictor->GetLatencyStats().at("e2e").count, 0UL);
+
+  for (int i = 0; i < 3; ++i) {
+    for (auto& name : predictor->GetInputNames()) {
+      auto input = predictor->GetInputHandle(name);
+      input->Reshape({4, 1});
+      std::vector<int64_t> data(4, 1);
+      input->CopyFromCpu(data.data());
+    }
+    ASSERT_TRUE(predictor->Run());
+    auto output = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+    std::vector<int> shape = output->shape();
+    std::vector<float> out_data(std::accumulate(
+        shape.begin(), shape.end(), 1, std::multiplies<int>()));
+    output->CopyToCpu(out_data.data());
+  }
+
+  auto stats = predictor->GetLatencyStats();
+  ASSERT_EQ(stats.at("h2d").count, 12UL);
+  ASSERT_EQ(stats.at("compute").count, 3UL);
+  ASSERT_EQ(stats.at("d2h").count, 3UL);
+  // the last request is accounted when the next one begins
+  ASSERT_EQ(stats.at("e2e").count, 2UL);
+  const LatencyStats& e2e = stats.at("e2e");
+  ASSERT_LE(e2e.p50, e2e.p99);
+  ASSERT_LE(e2e.p99, e2e.max);
+
+  std::string metrics = ExportLatencyMetrics({{"word2vec", predictor.get()}});
+  ASSERT_NE(metrics.find("paddle_inference_latency_microseconds{predictor="
+                         "\"word2vec\",stage=\"e2e\",quantile=\"0.99\"}"),
+            std::string::npos);
+  ASSERT_NE(metrics.find("paddle_inference_latency_microseconds_count{"
+                         "predictor=\"word2vec\",stage=\"compute\"} 3"),
+            std::string::npos);
+}
+
+#ifdef PADDLE_WITH_DNNL
+TEST(Predictor, OnednnWarmup) {
+  const std::string shape_file = "onednn_warmup_shapes.txt";
+  std::remove(shape_file.c_str());
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableMKLDNN();
+  config.SetOnednnPrimitiveCacheCapacity(256);
+  config.SetOnednnWarmupShapeFile(shape_file, 2);
+
+  {
+    auto predictor = CreatePredictor(config);
+    for (int batch : {4, 4, 2, 3}) {
+      for (auto& name : predictor->GetInputNames()) {
+        auto input = predictor->GetInputHandle(name);
+        input->Reshape({batch, 1});
+        std::vector<int64_t> data(batch, 1);
+        input->CopyFromCpu(data.data());
+      }
+      ASSERT_TRUE(predictor->Run());
+    }
+  }
+  // the third input shape is over the max number of the shapes
+  std::ifstream fin(shape_file);
+  std::string line;
+  int num_shapes = 0;
+  while (std::getline(fin, line)) {
+    ++num_shapes;
+  }
+  ASSERT_EQ(num_shapes, 2);
+
+  // warmed up by the recorded shapes
+  auto predictor = CreatePredictor(config);
+  auto clone = predictor->Clone();
+  ASSERT_NE(clone, nullptr);
+  std::remove(shape_file.c_str());
+}
+#endif
+
 TEST(Predictor, EnableONNXRuntime) {
   Config config;
   config.SetModel(FLAGS_dirname);
@@ -639,6 +747,28 @@ TEST(Predictor, Streams) {
 
     CHECK_NE(stream, stream2);
   }
+
+  // internal streams of a priority
+  {
+    Config config;
+    config.SetModel(FLAGS_dirname);
+    config.EnableUseGpu(100, 0);
+    config.SetStreamPriority(1);
+    auto predictor = CreatePredictor(config);
+    gpuStream_t stream =
+        reinterpret_cast<gpuStream_t>(predictor->GetExecStream());
+    CHECK_EQ(paddle::ResourceManager::Instance().RefCount(stream), 1);
+    int priority = 0;
+    cudaStreamGetPriority(stream, &priority);
+    CHECK_LT(priority, 0);
+
+    auto predictor2 = predictor->Clone();
+    gpuStream_t stream2 =
+        reinterpret_cast<gpuStream_t>(predictor2->GetExecStream());
+    CHECK_EQ(paddle::ResourceManager::Instance().RefCount(stream2), 1);
+    CHECK_NE(stream, stream2);
+    CHECK_EQ(predictor2->GetGpuTime(), 0.);
+  }
 }
 
 TEST(Tensor, RunWithExternalStream) {
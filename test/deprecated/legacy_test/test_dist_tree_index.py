@@ -16,6 +16,8 @@ import os
 import tempfile
 import unittest
 
+import numpy as np
+
 import paddle
 from paddle.dataset.common import download
 from paddle.distributed.fleet.dataset import TreeIndex
@@ -111,6 +113,42 @@ class TestTreeIndex(unittest.TestCase):
         children_ids = [node.id() for node in tree.get_nodes(children_codes)]
         self.assertIn(all_leaf_ids[0], children_ids)
 
+    def test_beam_search(self):
+        path = download(
+            "https://paddlerec.bj.bcebos.com/tree-based/data/mini_tree.pb",
+            "tree_index_unittest",
+            "e2ba4561c2e9432b532df40546390efa",
+        )
+        tree = TreeIndex("demo", path)
+        all_leaf_ids = [node.id() for node in tree.get_all_leafs()]
+        targets = np.array([0, 10, 20, 30], dtype='float32')
+        levels = []
+
+        def score_func(level, queries, node_ids):
+            levels.append(level)
+            self.assertEqual(len(queries), len(node_ids))
+            ids = node_ids.astype('float32')
+            return -np.abs(ids - targets[queries]) - ids * 1e-3
+
+        # the beam keeps all the nodes, so the search is exhaustive
+        topk = 3
+        ids, scores = tree.beam_search(len(targets), 32, topk, score_func)
+        self.assertEqual(levels, list(range(1, tree.height())))
+        for query, target in enumerate(targets):
+            expected = sorted(
+                all_leaf_ids, key=lambda id: abs(id - target) + id * 1e-3
+            )[:topk]
+            self.assertEqual(ids[query], expected)
+            self.assertEqual(len(scores[query]), topk)
+            self.assertEqual(scores[query], sorted(scores[query])[::-1])
+
+        # a small beam still returns the leaves with the best scores it found
+        ids, _ = tree.beam_search(len(targets), 2, 2, score_func)
+        for query in range(len(targets)):
+            self.assertEqual(len(ids[query]), 2)
+            for id in ids[query]:
+                self.assertIn(id, all_leaf_ids)
+
 
 class TestIndexSampler(unittest.TestCase):
     def setUp(self):
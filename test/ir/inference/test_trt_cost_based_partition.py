@@ -0,0 +1,104 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle import nn, static
+from paddle.inference import Config, PrecisionType, create_predictor
+
+paddle.enable_static()
+
+
+class SimpleNet(nn.Layer):
+    def __init__(self):
+        super().__init__()
+        self.conv1 = nn.Conv2D(4, 16, kernel_size=3, padding=1)
+        self.conv2 = nn.Conv2D(16, 16, kernel_size=3, padding=1)
+        self.conv3 = nn.Conv2D(16, 4, kernel_size=3, padding=1)
+        self.relu = nn.ReLU()
+
+    def forward(self, x):
+        x = self.relu(self.conv1(x))
+        x = self.relu(self.conv2(x))
+        x = self.relu(self.conv3(x))
+        return paddle.mean(x, axis=[2, 3])
+
+
+class TestTRTCostBasedPartition(unittest.TestCase):
+    def setUp(self):
+        self.temp_dir = tempfile.TemporaryDirectory()
+        self.model_prefix = os.path.join(
+            self.temp_dir.name, 'cost_based_partition', 'infer_model'
+        )
+
+    def tearDown(self):
+        self.temp_dir.cleanup()
+
+    def build_model(self):
+        image = static.data(
+            name='img', shape=[None, 4, 64, 64], dtype='float32'
+        )
+        predict = SimpleNet()(image)
+        exe = paddle.static.Executor(paddle.CUDAPlace(0))
+        exe.run(paddle.static.default_startup_program())
+        paddle.static.save_inference_model(
+            self.model_prefix, [image], [predict], exe
+        )
+
+    def init_predictor(self, use_trt):
+        config = Config(
+            self.model_prefix + '.pdmodel', self.model_prefix + '.pdiparams'
+        )
+        config.enable_use_gpu(256, 0)
+        if use_trt:
+            config.enable_tensorrt_engine(
+                workspace_size=1 << 30,
+                max_batch_size=1,
+                min_subgraph_size=0,
+                precision_mode=PrecisionType.Float32,
+                use_static=False,
+                use_calib_mode=False,
+            )
+            config.exp_enable_tensorrt_cost_based_partition(True)
+        config.disable_glog_info()
+        return create_predictor(config)
+
+    def infer(self, predictor, img):
+        input_tensor = predictor.get_input_handle(
+            predictor.get_input_names()[0]
+        )
+        input_tensor.reshape(img.shape)
+        input_tensor.copy_from_cpu(img.copy())
+        predictor.run()
+        output_tensor = predictor.get_output_handle(
+            predictor.get_output_names()[0]
+        )
+        return output_tensor.copy_to_cpu()
+
+    def test_cost_based_partition(self):
+        self.build_model()
+        img = np.random.random((1, 4, 64, 64)).astype(np.float32)
+        expected = self.infer(self.init_predictor(False), img)
+        # the convs are worth an engine, and give the same results in it
+        result = self.infer(self.init_predictor(True), img)
+        np.testing.assert_allclose(result, expected, rtol=1e-3, atol=1e-3)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,76 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import unittest
+
+import numpy
+
+os.environ['FLAGS_cinn_jit_cuda_graph'] = '1'
+os.environ['FLAGS_enable_pir_api'] = '1'
+os.environ['FLAGS_use_cinn'] = '1'
+
+import paddle
+
+build_strategy = paddle.static.BuildStrategy()
+build_strategy.build_cinn_pass = True
+
+
+def func(x, y):
+    # the reduces split the computation into several cinn groups
+    x = paddle.exp(x * 2)
+    s = x.sum(axis=-1, keepdim=True)
+    x = x / s
+    y = paddle.nn.functional.relu(y + x)
+    m = y.max(axis=1, keepdim=True)
+    return (y - m).mean(axis=0)
+
+
+class TestCinnJitCudaGraph(unittest.TestCase):
+    def check(self, input_spec, shapes):
+        static_func = paddle.jit.to_static(
+            full_graph=True,
+            build_strategy=build_strategy,
+            input_spec=input_spec,
+        )(func)
+        for shape in shapes:
+            # the graph is replayed for the same args and captured again for
+            # the new ones
+            for _ in range(3):
+                x = paddle.rand(shape)
+                y = paddle.rand(shape)
+                numpy.testing.assert_allclose(
+                    func(x, y).numpy(),
+                    static_func(x, y).numpy(),
+                    atol=1e-5,
+                    rtol=1e-5,
+                )
+
+    def test_static_shape(self):
+        input_spec = [
+            paddle.static.InputSpec(shape=[16, 64], dtype='float32'),
+            paddle.static.InputSpec(shape=[16, 64], dtype='float32'),
+        ]
+        self.check(input_spec, [[16, 64]])
+
+    def test_dynamic_shape(self):
+        input_spec = [
+            paddle.static.InputSpec(shape=[None, 64], dtype='float32'),
+            paddle.static.InputSpec(shape=[None, 64], dtype='float32'),
+        ]
+        self.check(input_spec, [[16, 64], [32, 64], [16, 64]])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,69 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+import unittest
+
+import numpy as np
+import utils
+
+import paddle
+
+
+class LinearReluSubGraph(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+        self.linear = paddle.nn.Linear(128, 256)
+
+    def forward(self, x):
+        return paddle.nn.functional.relu(self.linear(x))
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(), "fused_gemm_epilogue needs cuda"
+)
+class TestFuseGemmEpilogue(unittest.TestCase):
+    def setUp(self):
+        paddle.seed(2024)
+        self.x = paddle.randn([64, 128], dtype="float32")
+        self.x.stop_gradient = True
+
+    def tearDown(self):
+        paddle.set_flags({"FLAGS_enable_fuse_gemm_epilogue_in_cinn": False})
+
+    def eval(self, use_cinn):
+        paddle.seed(2024)
+        net = LinearReluSubGraph()
+        net.eval()
+        net = utils.apply_to_static(net, use_cinn)
+        out = net(self.x)
+        if use_cinn:
+            # the bias add and the relu are left in no jit kernel
+            utils.check_jit_kernel_number(net.forward, 0)
+            op_names = [
+                op.name()
+                for op in utils.get_pir_program(net.forward).global_block().ops
+            ]
+            self.assertIn("pd_op.fused_gemm_epilogue", op_names)
+        return out
+
+    def test_eval(self):
+        paddle.set_flags({"FLAGS_enable_fuse_gemm_epilogue_in_cinn": True})
+        cinn_out = self.eval(use_cinn=True)
+        dy_out = self.eval(use_cinn=False)
+        np.testing.assert_allclose(
+            cinn_out.numpy(), dy_out.numpy(), atol=1e-5, rtol=1e-5
+        )
+
+
+if __name__ == '__main__':
+    unittest.main()
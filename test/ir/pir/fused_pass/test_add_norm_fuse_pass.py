@@ -269,6 +269,86 @@ class TestAddRmsNormFusePatternWithResidual(TestRmsNormFusePattern):
                                 yield [main_prog, start_prog], False
 
 
+class TestAddBiasRmsNormQuantFusePattern(TestRmsNormFusePattern):
+    r"""
+        x     bias
+        |      |
+          add      residual
+           |          |
+                add
+                 |
+              rms_norm
+                 |
+        scale-round-clip-cast(int8)
+    """
+
+    def sample_program(self):
+        for x_shape in [[1, 1, 4096]]:
+            for w_shape in [[4096]]:
+                with paddle.pir_utils.IrGuard():
+                    start_prog = paddle.static.Program()
+                    main_prog = paddle.static.Program()
+                    with paddle.pir.core.program_guard(main_prog, start_prog):
+                        residual = paddle.static.data(
+                            name='residual', shape=x_shape, dtype='float32'
+                        )
+                        x = paddle.static.data(
+                            name='x', shape=x_shape, dtype='float32'
+                        )
+                        w = create_parameter(
+                            name="w",
+                            shape=w_shape,
+                            dtype='float32',
+                            initializer=paddle.nn.initializer.Assign(
+                                np.random.random(w_shape).astype('float32')
+                            ),
+                        )
+                        bias = create_parameter(
+                            name="bias",
+                            shape=w_shape,
+                            dtype='float32',
+                            initializer=paddle.nn.initializer.Assign(
+                                np.random.random(w_shape).astype('float32')
+                            ),
+                        )
+                        add_out = paddle.add(residual, paddle.add(x, bias))
+                        add_out_1 = add_out
+                        variance = add_out.pow(2).mean(-1, keepdim=True)
+                        add_out = paddle.rsqrt(variance + 1e-6) * add_out
+                        mul_out = add_out * w
+                        quant_out = paddle.scale(mul_out, scale=127.0 / 4.0)
+                        quant_out = paddle.clip(
+                            paddle.round(quant_out), -127.0, 127.0
+                        ).astype('int8')
+                        out = paddle.add(add_out_1, quant_out.astype('float32'))
+                        out = paddle.assign(out)
+                        self.pass_attr_list = [{'add_norm_fuse_pass': {}}]
+                        self.feeds = {
+                            "x": np.random.random(x_shape).astype("float32"),
+                            "residual": np.random.random(x_shape).astype(
+                                "float32"
+                            ),
+                        }
+                        self.fetch_list = [out]
+                        self.valid_op_map = {
+                            "pd_op.pow": 0,
+                            "pd_op.mean": 0,
+                            "pd_op.scale": 0,
+                            "pd_op.rsqrt": 0,
+                            "pd_op.multiply": 0,
+                            "pd_op.round": 0,
+                            "pd_op.clip": 0,
+                            "pd_op.add": 1,
+                            "pd_op.rms_norm": 1,
+                        }
+
+                        yield [main_prog, start_prog], False
+
+    def test_check_output(self):
+        # The quantized values may be rounded differently by 1.
+        self.check_pass_correct(atol=1.0, rtol=0)
+
+
 class TestAddLayerNormFusePattern(TestRmsNormFusePattern):
     r"""
     x         residual
@@ -0,0 +1,123 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import re
+import unittest
+
+import numpy as np
+from pass_test import PassTest
+
+import paddle
+from paddle.base import core
+from paddle.nn.functional.flash_attention import flash_attention
+
+np.random.seed(42)
+paddle.enable_static()
+
+
+def get_cuda_version():
+    result = os.popen("nvcc --version").read()
+    regex = r'release (\S+),'
+    match = re.search(regex, result)
+    if match:
+        num = str(match.group(1))
+        integer, decimal = num.split('.')
+        return int(integer) * 1000 + int(float(decimal) * 10)
+    else:
+        return -1
+
+
+def is_flashattn_supported():
+    if not core.is_compiled_with_cuda() or get_cuda_version() < 11040:
+        return False
+    return paddle.device.cuda.get_device_capability()[0] >= 8
+
+
+@unittest.skipIf(
+    not is_flashattn_supported(),
+    "core is not compiled with CUDA and cuda version need larger than or equal to 11.4"
+    "and device's compute capability must >= 8.x",
+)
+class TestFlashAttnVarlenPattern(PassTest):
+    r"""
+    Q[1, total, head, head_dim]   K   V
+                |                 |   |
+                 ----flash_attn----
+                         |
+                        out
+
+    Q[total, head, head_dim]   K   V   cu_seqlens
+                |              |   |       |
+                 --flash_attn_unpadded------
+                           |
+                        reshape
+                           |
+                          out
+    """
+
+    def is_program_valid(self, program=None):
+        return True
+
+    def build_ir_program(self):
+        total, num_heads, head_dim = 128, 8, 64
+        with paddle.pir_utils.IrGuard():
+            main_prog = paddle.static.Program()
+            start_prog = paddle.static.Program()
+            with paddle.pir.core.program_guard(main_prog, start_prog):
+                shape = [1, total, num_heads, head_dim]
+                Q = paddle.static.data(name='Q', shape=shape, dtype='float16')
+                K = paddle.static.data(name='K', shape=shape, dtype='float16')
+                V = paddle.static.data(name='V', shape=shape, dtype='float16')
+                paddle.static.data(
+                    name='cu_seqlens', shape=[2], dtype='int32'
+                )
+                attention_out, _ = flash_attention(Q, K, V, training=False)
+                out = paddle.assign(attention_out)
+                self.pass_attr_list = [
+                    {
+                        'flash_attn_varlen_pass': {
+                            'cu_seqlens_name': 'cu_seqlens',
+                            'max_seqlen': total,
+                        }
+                    }
+                ]
+                # one sequence, the packed attention is the same as the
+                # padded one
+                self.feeds = {
+                    "Q": np.random.random(shape).astype("float16"),
+                    "K": np.random.random(shape).astype("float16"),
+                    "V": np.random.random(shape).astype("float16"),
+                    "cu_seqlens": np.array([0, total]).astype("int32"),
+                }
+                self.fetch_list = [out]
+                self.valid_op_map = {
+                    "pd_op.flash_attn_unpadded": 1,
+                    "pd_op.flash_attn": 0,
+                }
+                return [main_prog, start_prog]
+
+    def sample_program(self):
+        yield self.build_ir_program(), False
+
+    def setUp(self):
+        if core.is_compiled_with_cuda():
+            self.places.append(paddle.CUDAPlace(0))
+
+    def test_check_output(self):
+        self.check_pass_correct(atol=1e-3, rtol=1e-3)
+
+
+if __name__ == "__main__":
+    unittest.main()
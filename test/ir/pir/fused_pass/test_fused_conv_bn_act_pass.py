@@ -0,0 +1,157 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.autograd.ir_backward import grad
+
+
+def skip_unit_test():
+    return (
+        not paddle.is_compiled_with_cuda()
+        or paddle.device.cuda.get_device_capability()[0] < 8
+        or paddle.get_cudnn_version() < 8900
+    )
+
+
+skip_msg = (
+    "only support with cuda and CUDNN 8.9 or later,"
+    " and only Ampere or later devices are supported"
+)
+
+
+class TestFusedConvBnActPass(unittest.TestCase):
+    def setUp(self):
+        np.random.seed(2024)
+        self.feed = {
+            "x": np.random.random([2, 8, 8, 32]).astype("float16") - 0.5
+        }
+        self.params = []
+
+    def conv_bn(self, x, num_channels, num_filters, filter_size):
+        i = len(self.params)
+        w = paddle.static.data(
+            name=f"w{i}",
+            shape=[num_filters, filter_size, filter_size, num_channels],
+            dtype="float16",
+        )
+        scale = paddle.static.data(
+            name=f"scale{i}", shape=[num_filters], dtype="float32"
+        )
+        bias = paddle.static.data(
+            name=f"bias{i}", shape=[num_filters], dtype="float32"
+        )
+        mean = paddle.static.data(
+            name=f"mean{i}", shape=[num_filters], dtype="float32"
+        )
+        variance = paddle.static.data(
+            name=f"variance{i}", shape=[num_filters], dtype="float32"
+        )
+        for param in [w, scale, bias]:
+            param.stop_gradient = False
+            self.params.append(param)
+        fan_in = num_channels * filter_size * filter_size
+        self.feed[f"w{i}"] = (
+            np.random.normal(0, fan_in**-0.5, w.shape).astype("float16")
+        )
+        self.feed[f"scale{i}"] = np.random.random(num_filters).astype(
+            "float32"
+        )
+        self.feed[f"bias{i}"] = np.random.random(num_filters).astype(
+            "float32"
+        )
+        self.feed[f"mean{i}"] = np.zeros(num_filters).astype("float32")
+        self.feed[f"variance{i}"] = np.ones(num_filters).astype("float32")
+        out = paddle.nn.functional.conv2d(
+            x,
+            w,
+            padding=(filter_size - 1) // 2,
+            data_format="NHWC",
+        )
+        return paddle.nn.functional.batch_norm(
+            out,
+            mean,
+            variance,
+            scale,
+            bias,
+            training=True,
+            data_format="NHWC",
+        )
+
+    def bottleneck(self, x):
+        y = paddle.nn.functional.relu(self.conv_bn(x, 32, 16, 1))
+        y = paddle.nn.functional.relu(self.conv_bn(y, 16, 16, 3))
+        y = self.conv_bn(y, 16, 32, 1)
+        return paddle.nn.functional.relu(paddle.add(y, x))
+
+    @unittest.skipIf(skip_unit_test(), skip_msg)
+    def test_fused_conv_bn_act(self):
+        with paddle.pir_utils.IrGuard():
+            main_program = paddle.static.Program()
+            with paddle.static.program_guard(main_program):
+                x = paddle.static.data(
+                    name="x", shape=[2, 8, 8, 32], dtype="float16"
+                )
+                h = paddle.nn.functional.relu(self.conv_bn(x, 32, 32, 1))
+                # the backward of the first bottleneck is fused with the
+                # conv of the second one
+                y = self.bottleneck(self.bottleneck(h))
+                loss = paddle.mean(paddle.cast(y, "float32"))
+                grads = grad(loss, self.params)
+                fetch_list = [loss] + [paddle.assign(g) for g in grads]
+
+                with paddle.static.scope_guard(paddle.static.Scope()):
+                    exe = paddle.base.Executor(paddle.base.CUDAPlace(0))
+                    fetches0 = exe.run(
+                        main_program,
+                        feed=self.feed,
+                        fetch_list=fetch_list,
+                    )
+
+                pm = paddle.pir.PassManager()
+                pm.add_pass('fused_conv_bn_act_pass', {})
+                pm.run(main_program)
+                op_names = [op.name() for op in main_program.global_block().ops]
+                self.assertEqual(
+                    op_names.count('pd_op.fused_scale_bias_relu_conv_bn'), 3
+                )
+                self.assertEqual(
+                    op_names.count('pd_op.fused_scale_bias_add_relu'), 1
+                )
+                self.assertEqual(
+                    op_names.count('pd_op.fused_dconv_drelu_dbn'), 3
+                )
+
+                with paddle.static.scope_guard(paddle.static.Scope()):
+                    exe = paddle.base.Executor(paddle.base.CUDAPlace(0))
+                    fetches1 = exe.run(
+                        main_program,
+                        feed=self.feed,
+                        fetch_list=fetch_list,
+                    )
+
+                for out0, out1 in zip(fetches0, fetches1):
+                    np.testing.assert_allclose(
+                        out1.astype("float32"),
+                        out0.astype("float32"),
+                        rtol=5e-2,
+                        atol=5e-2,
+                    )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,103 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import unittest
+
+import numpy as np
+from pass_test import PassTest
+
+import paddle
+from paddle.base import core
+
+paddle.enable_static()
+
+
+class TestEmbeddingSeqpoolFusePattern(PassTest):
+    r"""
+    ids_1   w    ids_2   w   ...
+      \    /       \    /
+    embedding    embedding
+        |            |
+    sequence_pool sequence_pool
+         \          /
+           concat
+    """
+
+    def is_program_valid(self, program=None):
+        return True
+
+    def build_ids(self, seq_lens, vocab_size):
+        ids = np.random.randint(0, vocab_size, [sum(seq_lens), 1]).astype(
+            "int64"
+        )
+        return paddle.base.create_lod_tensor(
+            ids, [seq_lens], paddle.CPUPlace()
+        )
+
+    def sample_program(self):
+        vocab_size = 64
+        hidden_size = 16
+        pooltypes = ["SUM", "SUM", "SUM", "AVERAGE"]
+        seq_lens = [[2, 3, 1], [1, 1, 4], [3, 0, 2], [2, 2, 2]]
+        with paddle.pir_utils.IrGuard():
+            main_prog = paddle.static.Program()
+            start_prog = paddle.static.Program()
+            with paddle.static.program_guard(main_prog, start_prog):
+                w = paddle.static.data(
+                    name='w', shape=[vocab_size, hidden_size], dtype='float32'
+                )
+                pooled = []
+                self.feeds = {
+                    "w": np.random.random([vocab_size, hidden_size]).astype(
+                        "float32"
+                    )
+                }
+                for i, pooltype in enumerate(pooltypes):
+                    ids = paddle.static.data(
+                        name=f'ids_{i}', shape=[-1, 1], dtype='int64'
+                    )
+                    emb = paddle.nn.functional.embedding(ids, w)
+                    pooled.append(
+                        paddle._C_ops.sequence_pool(emb, True, pooltype, 0.0)
+                    )
+                    self.feeds[f'ids_{i}'] = self.build_ids(
+                        seq_lens[i], vocab_size
+                    )
+                out = paddle.assign(paddle.concat(pooled, axis=-1))
+                self.pass_attr_list = [{'embedding_seqpool_fuse_pass': {}}]
+                self.fetch_list = [out]
+                self.valid_op_map = {
+                    "pd_op.fused_embedding_seqpool": 2,
+                    "pd_op.embedding": 0,
+                    "pd_op.sequence_pool": 0,
+                }
+                yield [main_prog, start_prog], False
+
+    def setUp(self):
+        if (
+            os.environ.get('FLAGS_CI_both_cpu_and_gpu', 'False').lower()
+            in ['1', 'true', 'on']
+            or not core.is_compiled_with_cuda()
+        ):
+            self.places.append(paddle.CPUPlace())
+        if core.is_compiled_with_cuda():
+            self.places.append(paddle.CUDAPlace(0))
+
+    def test_check_output(self):
+        self.check_pass_correct()
+
+
+if __name__ == "__main__":
+    unittest.main()
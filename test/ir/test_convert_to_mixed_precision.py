@@ -16,6 +16,8 @@ import os
 import tempfile
 import unittest
 
+import numpy as np
+
 import paddle
 from paddle.inference import (
     PlaceType,
@@ -87,5 +89,70 @@ class TestConvertToMixedPrecision(unittest.TestCase):
                 )
 
 
+class SimpleNet(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+        self.conv = paddle.nn.Conv2D(3, 8, kernel_size=3, padding=1)
+        self.fc = paddle.nn.Linear(8, 4)
+
+    def forward(self, x):
+        x = paddle.nn.functional.relu(self.conv(x))
+        x = paddle.mean(x, axis=[2, 3])
+        return paddle.nn.functional.softmax(self.fc(x))
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda() or paddle.get_cudnn_version() < 8000,
+    'should compile with cuda.',
+)
+class TestProfiledConvertToMixedPrecision(unittest.TestCase):
+    def setUp(self):
+        self.temp_dir = tempfile.TemporaryDirectory()
+        net = to_static(
+            SimpleNet(),
+            input_spec=[InputSpec(shape=[None, 3, 16, 16], name='x')],
+            full_graph=True,
+        )
+        paddle.jit.save(net, os.path.join(self.temp_dir.name, 'net/inference'))
+
+    def tearDown(self):
+        self.temp_dir.cleanup()
+
+    def test_profiled_convert_to_mixed_precision(self):
+        np.random.seed(2024)
+        calibration_data = [
+            {'x': np.random.random([2, 3, 16, 16]).astype('float32')}
+            for _ in range(2)
+        ]
+        lists = convert_to_mixed_precision(
+            os.path.join(self.temp_dir.name, 'net/inference.pdmodel'),
+            os.path.join(self.temp_dir.name, 'net/inference.pdiparams'),
+            os.path.join(self.temp_dir.name, 'mixed/inference.pdmodel'),
+            os.path.join(self.temp_dir.name, 'mixed/inference.pdiparams'),
+            backend=PlaceType.GPU,
+            mixed_precision=PrecisionType.Half,
+            black_list={'softmax'},
+            calibration_data=calibration_data,
+            accuracy_budget=1e-2,
+            repeat=2,
+        )
+        # the user black list is kept, and the lists can be reused as is
+        self.assertIn('softmax', lists['black_list'])
+        self.assertTrue(
+            os.path.exists(
+                os.path.join(self.temp_dir.name, 'mixed/inference.pdmodel')
+            )
+        )
+        convert_to_mixed_precision(
+            os.path.join(self.temp_dir.name, 'net/inference.pdmodel'),
+            os.path.join(self.temp_dir.name, 'net/inference.pdiparams'),
+            os.path.join(self.temp_dir.name, 'reused/inference.pdmodel'),
+            os.path.join(self.temp_dir.name, 'reused/inference.pdiparams'),
+            backend=PlaceType.GPU,
+            mixed_precision=PrecisionType.Half,
+            **lists,
+        )
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,97 @@
+#  Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import glob
+import json
+import os
+import signal
+import sys
+import tempfile
+import time
+import unittest
+
+import paddle
+from paddle.base import core
+
+
+class TestContinuousTracing(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        self.temp_dir = tempfile.TemporaryDirectory()
+        core.clear_continuous_tracing()
+        core.enable_continuous_tracing(1)
+
+    def tearDown(self):
+        core.disable_continuous_tracing()
+        core.set_continuous_tracing_sample_interval(
+            core.TracerEventType.Operator, 1
+        )
+        self.temp_dir.cleanup()
+
+    def run_ops(self):
+        x = paddle.rand([4, 4])
+        for _ in range(10):
+            x = paddle.add(x, x)
+
+    def event_names(self, path):
+        with open(path) as f:
+            events = json.load(f)['traceEvents']
+        return [event.get('name') for event in events]
+
+    def test_dump(self):
+        self.run_ops()
+        path = os.path.join(self.temp_dir.name, 'trace.json')
+        num_events = core.dump_continuous_tracing(path, 60.0)
+        self.assertGreater(num_events, 0)
+        self.assertIn('add dygraph', self.event_names(path))
+
+    def test_sample_interval(self):
+        core.set_continuous_tracing_sample_interval(
+            core.TracerEventType.Operator, 0
+        )
+        self.run_ops()
+        path = os.path.join(self.temp_dir.name, 'trace.json')
+        core.dump_continuous_tracing(path, 60.0)
+        self.assertNotIn('add dygraph', self.event_names(path))
+
+    @unittest.skipIf(
+        sys.platform == 'win32', "the signal dump is not supported on windows"
+    )
+    def test_dump_by_signal(self):
+        self.run_ops()
+        prefix = os.path.join(self.temp_dir.name, 'signal_trace')
+        core.install_continuous_tracing_dump_signal(
+            signal.SIGUSR2, prefix, 60.0
+        )
+        os.kill(os.getpid(), signal.SIGUSR2)
+        paths = []
+        for _ in range(100):
+            paths = glob.glob(prefix + '.*.json')
+            if paths:
+                break
+            time.sleep(0.1)
+        self.assertEqual(len(paths), 1)
+        names = []
+        # the dumper thread may be still writing the file
+        for _ in range(100):
+            try:
+                names = self.event_names(paths[0])
+                break
+            except ValueError:
+                time.sleep(0.1)
+        self.assertIn('add dygraph', names)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -167,6 +167,50 @@ class TestCUDAGraphInDygraphMode(unittest.TestCase):
         y = paddle.cast(x, dtype='float16')
         graph.capture_end()
 
+    def test_random_replay(self):
+        if not can_use_cuda_graph():
+            return
+
+        x = paddle.ones([1024, 16])
+        graph = CUDAGraph()
+        graph.capture_begin()
+        y = paddle.nn.functional.dropout(x, p=0.5)
+        z = paddle.uniform([1024, 16])
+        graph.capture_end()
+        self.assertFalse(graph.has_fixed_random_state())
+
+        outs = []
+        for _ in range(3):
+            graph.replay()
+            outs.append((y.numpy(), z.numpy()))
+        for i in range(1, len(outs)):
+            self.assertFalse((outs[i][0] == outs[i - 1][0]).all())
+            self.assertFalse((outs[i][1] == outs[i - 1][1]).all())
+        graph.reset()
+
+    def test_random_recompute(self):
+        if not can_use_cuda_graph():
+            return
+
+        x = paddle.ones([1024, 16])
+        graph = CUDAGraph()
+        graph.capture_begin()
+        state = paddle.get_cuda_rng_state()
+        y = paddle.nn.functional.dropout(x, p=0.5)
+        # the recomputed dropout regenerates the same mask at each replay
+        paddle.set_cuda_rng_state(state)
+        z = paddle.nn.functional.dropout(x, p=0.5)
+        graph.capture_end()
+
+        last_y = None
+        for _ in range(3):
+            graph.replay()
+            np.testing.assert_array_equal(y.numpy(), z.numpy())
+            if last_y is not None:
+                self.assertFalse((y.numpy() == last_y).all())
+            last_y = y.numpy()
+        graph.reset()
+
 
 if __name__ == "__main__":
     unittest.main()
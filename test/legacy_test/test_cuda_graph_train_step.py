@@ -0,0 +1,128 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.device.cuda.graphs import CUDAGraphTrainStep
+
+
+def can_use_cuda_graph():
+    return paddle.is_compiled_with_cuda() and not paddle.is_compiled_with_rocm()
+
+
+def build_train_step(seed):
+    paddle.seed(seed)
+    model = paddle.nn.Sequential(
+        paddle.nn.Linear(16, 32),
+        paddle.nn.ReLU(),
+        paddle.nn.Linear(32, 4),
+    )
+    opt = paddle.optimizer.Adam(
+        learning_rate=0.01, parameters=model.parameters()
+    )
+
+    def train_step(x, y):
+        loss = paddle.nn.functional.mse_loss(model(x), y)
+        loss.backward()
+        opt.step()
+        opt.clear_grad(set_to_zero=True)
+        return loss
+
+    return model, train_step
+
+
+@unittest.skipIf(
+    not can_use_cuda_graph() or float(paddle.version.cuda()) < 11.0,
+    "only support cuda >= 11.0",
+)
+class TestCUDAGraphTrainStep(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags(
+            {
+                'FLAGS_allocator_strategy': 'auto_growth',
+                'FLAGS_cudnn_deterministic': True,
+                'FLAGS_use_stream_safe_cuda_allocator': False,
+            }
+        )
+        np.random.seed(2024)
+        self.inputs = [
+            (
+                np.random.random([8, 16]).astype('float32'),
+                np.random.random([8, 4]).astype('float32'),
+            )
+            for _ in range(6)
+        ]
+
+    def test_same_as_eager(self):
+        model, train_step = build_train_step(seed=1)
+        graphed_model, graphed_step = build_train_step(seed=1)
+        step = CUDAGraphTrainStep(graphed_step, warmup_steps=2)
+        for x, y in self.inputs:
+            loss = train_step(paddle.to_tensor(x), paddle.to_tensor(y))
+            graphed_loss = step(paddle.to_tensor(x), paddle.to_tensor(y))
+            np.testing.assert_allclose(
+                graphed_loss.numpy(), loss.numpy(), rtol=1e-5
+            )
+        self.assertTrue(step.is_captured())
+        for p, graphed_p in zip(
+            model.parameters(), graphed_model.parameters()
+        ):
+            np.testing.assert_allclose(
+                graphed_p.numpy(), p.numpy(), rtol=1e-5, atol=1e-6
+            )
+        step.reset()
+
+    def test_host_sync_in_step(self):
+        _, train_step = build_train_step(seed=1)
+
+        def step_with_sync(x, y):
+            loss = train_step(x, y)
+            loss.numpy()
+            return loss
+
+        step = CUDAGraphTrainStep(step_with_sync, warmup_steps=1)
+        x, y = self.inputs[0]
+        step(paddle.to_tensor(x), paddle.to_tensor(y))
+        with self.assertRaises(RuntimeError):
+            step(paddle.to_tensor(x), paddle.to_tensor(y))
+        self.assertFalse(step.is_captured())
+
+    def test_fixed_random_state(self):
+        _, train_step = build_train_step(seed=1)
+
+        def step_with_noise(x, y):
+            return train_step(x + paddle.randn(x.shape), y)
+
+        step = CUDAGraphTrainStep(step_with_noise, warmup_steps=1)
+        x, y = self.inputs[0]
+        step(paddle.to_tensor(x), paddle.to_tensor(y))
+        with self.assertRaises(RuntimeError):
+            step(paddle.to_tensor(x), paddle.to_tensor(y))
+
+    def test_input_shape_changed(self):
+        _, train_step = build_train_step(seed=1)
+        step = CUDAGraphTrainStep(train_step, warmup_steps=1)
+        for x, y in self.inputs[:2]:
+            step(paddle.to_tensor(x), paddle.to_tensor(y))
+        x, y = self.inputs[2]
+        with self.assertRaises(ValueError):
+            step(paddle.to_tensor(x[:4]), paddle.to_tensor(y[:4]))
+        step.reset()
+
+
+if __name__ == '__main__':
+    unittest.main()
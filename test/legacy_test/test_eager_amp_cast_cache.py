@@ -0,0 +1,71 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(), "AMP casts the tensors on GPU only"
+)
+class TestEagerAmpCastCache(unittest.TestCase):
+    def setUp(self):
+        paddle.seed(2024)
+        self.linear = paddle.nn.Linear(16, 16)
+        self.x = paddle.rand([4, 16])
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_eager_amp_cast_cache': True})
+
+    def run_linear(self, cache):
+        paddle.set_flags({'FLAGS_eager_amp_cast_cache': cache})
+        with paddle.no_grad(), paddle.amp.auto_cast(level='O1'):
+            # the weight is cast once and read by both ops
+            out = self.linear(self.x) + self.linear(self.x * 2.0)
+        return out.astype('float32').numpy()
+
+    def test_same_results(self):
+        expected = self.run_linear(cache=False)
+        np.testing.assert_allclose(self.run_linear(cache=True), expected)
+
+    def test_inplace_update(self):
+        before = self.run_linear(cache=True)
+        with paddle.no_grad():
+            paddle.assign(self.linear.weight * 2.0, output=self.linear.weight)
+        after = self.run_linear(cache=True)
+        self.assertFalse(np.allclose(before, after))
+        np.testing.assert_allclose(after, self.run_linear(cache=False))
+
+    def test_trained_params(self):
+        # the casts traced for backward are not cached
+        paddle.set_flags({'FLAGS_eager_amp_cast_cache': True})
+        optimizer = paddle.optimizer.SGD(
+            learning_rate=0.1, parameters=self.linear.parameters()
+        )
+        for _ in range(2):
+            with paddle.amp.auto_cast(level='O1'):
+                loss = (self.linear(self.x) + self.linear(self.x)).mean()
+            loss.backward()
+            optimizer.step()
+            optimizer.clear_grad()
+        np.testing.assert_allclose(
+            self.run_linear(cache=True), self.run_linear(cache=False)
+        )
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,69 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+
+def small_ops(x, y):
+    z = paddle.matmul(x, y)
+    z = paddle.nn.functional.relu(z + 1.0)
+    return paddle.tanh(z) * 2.0, paddle.sum(z, axis=-1)
+
+
+class TestEagerLazyMode(unittest.TestCase):
+    def setUp(self):
+        self.x = np.random.random([4, 8]).astype('float32')
+        self.y = np.random.random([8, 4]).astype('float32')
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_eager_lazy_mode': False})
+
+    def run_ops(self, lazy):
+        paddle.set_flags({'FLAGS_eager_lazy_mode': lazy})
+        with paddle.no_grad():
+            x = paddle.to_tensor(self.x)
+            y = paddle.to_tensor(self.y)
+            outs = small_ops(x, y)
+        self.assertEqual(outs[0].shape, [4, 4])
+        return [out.numpy() for out in outs]
+
+    def test_same_results(self):
+        expected = self.run_ops(lazy=False)
+        # the second run reuses the compiled segment
+        for _ in range(2):
+            outs = self.run_ops(lazy=True)
+            for out, expected_out in zip(outs, expected):
+                np.testing.assert_allclose(out, expected_out, rtol=1e-6)
+
+    def test_flush_by_grad_op(self):
+        paddle.set_flags({'FLAGS_eager_lazy_mode': True})
+        with paddle.no_grad():
+            a = paddle.to_tensor(self.x) * 3.0
+        w = paddle.to_tensor(self.y, stop_gradient=False)
+        # the op requires grad, it flushes the segment and runs eagerly
+        out = paddle.matmul(a, w)
+        out.sum().backward()
+        np.testing.assert_allclose(
+            w.grad.numpy(),
+            np.matmul((self.x * 3.0).T, np.ones([4, 4], 'float32')),
+            rtol=1e-6,
+        )
+
+
+if __name__ == '__main__':
+    unittest.main()
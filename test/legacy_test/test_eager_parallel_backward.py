@@ -0,0 +1,73 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+
+class MultiTower(paddle.nn.Layer):
+    def __init__(self, num_towers=4):
+        super().__init__()
+        self.towers = paddle.nn.LayerList(
+            [
+                paddle.nn.Sequential(
+                    paddle.nn.Linear(16, 32),
+                    paddle.nn.ReLU(),
+                    paddle.nn.Linear(32, 8),
+                )
+                for _ in range(num_towers)
+            ]
+        )
+        self.head = paddle.nn.Linear(8, 1)
+
+    def forward(self, x):
+        out = paddle.add_n([tower(x) for tower in self.towers])
+        return self.head(paddle.tanh(out)).mean()
+
+
+class TestEagerParallelBackward(unittest.TestCase):
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_eager_backward_num_threads': 0})
+
+    def run_backward(self, num_threads):
+        paddle.seed(2024)
+        model = MultiTower()
+        x = paddle.to_tensor(np.random.RandomState(0).rand(4, 16), 'float32')
+        paddle.set_flags({'FLAGS_eager_backward_num_threads': num_threads})
+        model(x).backward()
+        return [p.grad.numpy() for p in model.parameters()]
+
+    def test_same_grads(self):
+        expected = self.run_backward(num_threads=0)
+        grads = self.run_backward(num_threads=4)
+        self.assertEqual(len(grads), len(expected))
+        for grad, expected_grad in zip(grads, expected):
+            np.testing.assert_allclose(grad, expected_grad, rtol=1e-5)
+
+    def test_accumulate_grads(self):
+        paddle.set_flags({'FLAGS_eager_backward_num_threads': 4})
+        x = paddle.to_tensor([1.0, 2.0, 3.0], stop_gradient=False)
+        # x feeds several branches, its grads are summed across threads
+        y = (x * 2.0).sum() + (x * x).sum() + paddle.exp(x).sum()
+        y.backward()
+        np.testing.assert_allclose(
+            x.grad.numpy(), 2.0 + 2.0 * x.numpy() + np.exp(x.numpy()), rtol=1e-6
+        )
+
+
+if __name__ == '__main__':
+    unittest.main()
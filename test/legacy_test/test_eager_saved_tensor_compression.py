@@ -0,0 +1,61 @@
+#   Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+
+class TestEagerSavedTensorCompression(unittest.TestCase):
+    def setUp(self):
+        self.x = np.random.RandomState(0).uniform(-1, 1, [8, 16])
+        self.x = self.x.astype('float32')
+        self.w = np.random.RandomState(1).uniform(-1, 1, [16, 4])
+        self.w = self.w.astype('float32')
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_eager_compress_saved_tensors': ''})
+
+    def run_backward(self, policy):
+        paddle.set_flags({'FLAGS_eager_compress_saved_tensors': policy})
+        x = paddle.to_tensor(self.x, stop_gradient=False)
+        w = paddle.to_tensor(self.w, stop_gradient=False)
+        out = paddle.tanh(paddle.matmul(paddle.nn.functional.relu(x), w))
+        out.sum().backward()
+        return x.grad.numpy(), w.grad.numpy()
+
+    def test_mask_is_lossless(self):
+        expected = self.run_backward('')
+        grads = self.run_backward('relu:mask')
+        for grad, expected_grad in zip(grads, expected):
+            np.testing.assert_array_equal(grad, expected_grad)
+
+    def test_lossy_methods(self):
+        expected = self.run_backward('')
+        for method, atol in [('bf16', 5e-2), ('fp16', 5e-3), ('fp8', 2e-1)]:
+            grads = self.run_backward(f'matmul:{method},tanh:{method}')
+            for grad, expected_grad in zip(grads, expected):
+                np.testing.assert_allclose(grad, expected_grad, atol=atol)
+
+    def test_invalid_method(self):
+        paddle.set_flags({'FLAGS_eager_compress_saved_tensors': 'relu:int4'})
+        x = paddle.to_tensor(self.x, stop_gradient=False)
+        with self.assertRaises(ValueError):
+            paddle.nn.functional.relu(x)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -180,7 +180,7 @@ class TestEmbeddingBase(unittest.TestCase):
     def test_main(self):
         weight_dtypes = get_all_dtypes()
         ids_dtypes = [paddle.int64, paddle.int32]
-        deterministic_levels = [0, 1]
+        deterministic_levels = [0, 1, 3]
         ranks = [None, 0, 2, 4, 8]
         allow_duplicate_ids = [False, True]
         allow_pure_randoms = [False, True]
@@ -223,6 +223,27 @@ class TestEmbeddingDeterministic(unittest.TestCase):
         self.vocab_size = 128
         self.hidden_size = 1024
 
+    def test_sorted_with_skewed_ids(self):
+        if not get_all_dtypes():
+            return
+        ids = np.random.randint(low=0, high=4, size=self.ids_shape)
+        ids[0] = self.vocab_size - 1
+        ids = paddle.to_tensor(ids).astype(paddle.int64)
+        weight = paddle.randn([self.vocab_size, self.hidden_size])
+        out_grad = paddle.randn(self.ids_shape + [self.hidden_size])
+        out_1, weight_grad_1 = embedding_ground_truth(ids, weight, out_grad)
+        out_2, weight_grad_2 = embedding(
+            ids, weight, out_grad, deterministic_level=3
+        )
+        _, weight_grad_3 = embedding(
+            ids, weight, out_grad, deterministic_level=3
+        )
+        np.testing.assert_equal(out_1, out_2)
+        np.testing.assert_equal(weight_grad_2, weight_grad_3)
+        np.testing.assert_allclose(
+            weight_grad_1, weight_grad_2, rtol=1e-5, atol=1e-5
+        )
+
 
 if __name__ == "__main__":
     unittest.main()
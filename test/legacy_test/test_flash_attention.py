@@ -959,6 +959,79 @@ class TestFlashAttenionWithSparseMaskBF16APITest(
         self.causal = True
 
 
+@unittest.skipIf(
+    not is_flashattn_supported(),
+    "core is not compiled with CUDA and cuda version need larger than or equal to 11.4"
+    "and device's compute capability must be 7.5 or 8.x",
+)
+class TestFlashAttentionSlidingWindowAPI(unittest.TestCase):
+    def setUp(self):
+        self.place = paddle.CUDAPlace(0)
+        self.shape = (2, 256, 8, 64)
+        self.num_heads_k = 8
+        self.window_size = 48
+        self.dtype = 'float16'
+        self.rtol = 5e-03
+        self.atol = 1e-03
+
+    def test_sliding_window(self):
+        paddle.disable_static()
+        bs, seq_len, num_heads, head_dim = self.shape
+        kv_shape = (bs, seq_len, self.num_heads_k, head_dim)
+        query = np.random.random(self.shape)
+        key = np.random.random(kv_shape)
+        value = np.random.random(kv_shape)
+
+        q = paddle.to_tensor(query, place=self.place, dtype=self.dtype)
+        k = paddle.to_tensor(key, place=self.place, dtype=self.dtype)
+        v = paddle.to_tensor(value, place=self.place, dtype=self.dtype)
+        out, _ = flash_attention(
+            q, k, v, causal=True, window_size=self.window_size
+        )
+
+        # The reference repeats the heads of k and v, and masks the keys out
+        # of the window.
+        repeats = num_heads // self.num_heads_k
+        k_ = paddle.to_tensor(
+            np.repeat(key, repeats, axis=2), place=self.place, dtype=self.dtype
+        )
+        v_ = paddle.to_tensor(
+            np.repeat(value, repeats, axis=2),
+            place=self.place,
+            dtype=self.dtype,
+        )
+        row = np.arange(seq_len)[:, None]
+        col = np.arange(seq_len)[None, :]
+        mask = np.where(
+            (col <= row) & (col > row - self.window_size), 0.0, -np.inf
+        )
+        m = paddle.to_tensor(
+            np.tile(mask, (bs, num_heads, 1, 1)),
+            place=self.place,
+            dtype=self.dtype,
+        )
+        out_ = attention_naive_with_mask(q, k_, v_, m)
+        np.testing.assert_allclose(
+            out.astype('float32').numpy(),
+            out_.astype('float32').numpy(),
+            rtol=self.rtol,
+            atol=self.atol,
+        )
+
+
+class TestFlashAttentionSlidingWindowGQAAPI(
+    TestFlashAttentionSlidingWindowAPI
+):
+    def setUp(self):
+        self.place = paddle.CUDAPlace(0)
+        self.shape = (2, 256, 8, 64)
+        self.num_heads_k = 2
+        self.window_size = 100
+        self.dtype = 'bfloat16'
+        self.rtol = 2e-02
+        self.atol = 1e-02
+
+
 class TestFlashAttentionVarlenQKVPackedGQA(TestFlashAttentionGQA):
     def gen_unpadded_data(self, dtype):
         seq_len_q = np.random.randint(
@@ -0,0 +1,160 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+from test_float8 import check_fp8_support
+
+import paddle
+import paddle.incubate.nn.functional as F
+from paddle.base import core
+from paddle.incubate.nn import FP8Linear
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(),
+    "core is not compiled with CUDA",
+)
+class TestFP8UpdateScale(unittest.TestCase):
+    def test_update_scale(self):
+        paddle.disable_static()
+        history = np.array([3.0, 0.5, 7.0, 1.0], dtype='float32')
+        amax_history = paddle.to_tensor(history)
+        scale = paddle.ones([1])
+        scale_inv = F.fp8_update_scale(
+            amax_history, scale, 'float8_e4m3fn', margin=1
+        )
+        np.testing.assert_allclose(scale.numpy(), [448.0 / 7.0 / 2.0])
+        np.testing.assert_allclose(scale_inv.numpy(), [7.0 * 2.0 / 448.0])
+        np.testing.assert_equal(amax_history.numpy(), [0.0, 3.0, 0.5, 7.0])
+
+    def test_keep_scale_without_amax(self):
+        paddle.disable_static()
+        amax_history = paddle.zeros([8])
+        scale = paddle.full([1], 4.0)
+        scale_inv = F.fp8_update_scale(amax_history, scale, 'float8_e5m2')
+        np.testing.assert_allclose(scale.numpy(), [4.0])
+        np.testing.assert_allclose(scale_inv.numpy(), [0.25])
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(),
+    "core is not compiled with CUDA",
+)
+class TestFP8CastTranspose(unittest.TestCase):
+    def setUp(self):
+        self.shape = [100, 77]
+        self.dtype = 'float32'
+        self.out_dtype = 'float8_e4m3fn'
+
+    def test_cast_transpose(self):
+        paddle.disable_static()
+        x_np = np.random.uniform(-3, 3, self.shape).astype('float32')
+        x = paddle.to_tensor(x_np).astype(self.dtype)
+        scale = paddle.full([1], 16.0)
+        amax_history = paddle.to_tensor([1.0, 5.0, 2.0])
+        out, out_t = F.fp8_cast_transpose(
+            x, scale, amax_history, self.out_dtype
+        )
+
+        ref = (x.astype('float32') * 16.0).astype(self.out_dtype)
+        np.testing.assert_equal(
+            out.astype('float32').numpy(), ref.astype('float32').numpy()
+        )
+        np.testing.assert_equal(
+            out_t.astype('float32').numpy(), ref.astype('float32').numpy().T
+        )
+        amax = np.abs(x.astype('float32').numpy()).max()
+        np.testing.assert_allclose(
+            amax_history.numpy(), [max(amax, 1.0), 5.0, 2.0]
+        )
+
+
+class TestFP8CastTransposeE5M2(TestFP8CastTranspose):
+    def setUp(self):
+        self.shape = [64, 130]
+        self.dtype = 'float16'
+        self.out_dtype = 'float8_e5m2'
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda()
+    or not core.is_bfloat16_supported(core.CUDAPlace(0)),
+    "core is not compiled with CUDA or not support bfloat16",
+)
+class TestFP8CastTransposeBF16(TestFP8CastTranspose):
+    def setUp(self):
+        self.shape = [33, 1000]
+        self.dtype = 'bfloat16'
+        self.out_dtype = 'float8_e4m3fn'
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda() or not check_fp8_support(),
+    "Fp8 matmul requires CUDA >= 12.1 on Ada arch or hopper arch",
+)
+class TestFP8Linear(unittest.TestCase):
+    def test_forward_backward(self):
+        paddle.disable_static()
+        paddle.seed(2024)
+        linear = FP8Linear(64, 128)
+        ref_linear = paddle.nn.Linear(64, 128)
+        ref_linear.weight.set_value(linear.weight)
+        ref_linear.bias.set_value(linear.bias)
+
+        # The scales of the delayed scaling come from the amax of the
+        # previous steps, so the first step is not checked.
+        for step in range(3):
+            x_np = np.random.uniform(-1, 1, [4, 32, 64]).astype('float32')
+            x = paddle.to_tensor(x_np).astype('bfloat16')
+            x.stop_gradient = False
+            out = linear(x)
+            out.astype('float32').sum().backward()
+
+            ref_x = paddle.to_tensor(x_np)
+            ref_x.stop_gradient = False
+            ref_out = ref_linear(ref_x)
+            ref_out.sum().backward()
+            if step > 0:
+                self.assertEqual(out.dtype, paddle.bfloat16)
+                np.testing.assert_allclose(
+                    out.astype('float32').numpy(),
+                    ref_out.numpy(),
+                    atol=0.1,
+                    rtol=0.1,
+                )
+                np.testing.assert_allclose(
+                    x.grad.astype('float32').numpy(),
+                    ref_x.grad.numpy(),
+                    atol=0.1,
+                    rtol=0.1,
+                )
+                np.testing.assert_allclose(
+                    linear.weight.grad.numpy(),
+                    ref_linear.weight.grad.numpy(),
+                    atol=0.5,
+                    rtol=0.1,
+                )
+                np.testing.assert_allclose(
+                    linear.bias.grad.numpy(),
+                    ref_linear.bias.grad.numpy(),
+                    rtol=1e-5,
+                )
+            linear.clear_gradients()
+            ref_linear.clear_gradients()
+
+
+if __name__ == '__main__':
+    unittest.main()
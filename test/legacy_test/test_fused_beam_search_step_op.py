@@ -0,0 +1,227 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+from paddle.incubate.nn.functional import fused_beam_search_step
+
+
+def ref_beam_search_step(
+    logits, cum_scores, finished, seq_lens, beam_size, end_id, alpha
+):
+    rows = logits.shape[0]
+    x = logits.astype('float64')
+    x = x - x.max(axis=1, keepdims=True)
+    logp = x - np.log(np.exp(x).sum(axis=1, keepdims=True))
+
+    ids = np.zeros([rows], 'int64')
+    parents = np.zeros([rows], 'int32')
+    scores = np.zeros([rows], 'float32')
+    finished_out = np.zeros([rows], 'bool')
+    for base in range(0, rows, beam_size):
+        candidates = []
+        for row in range(base, base + beam_size):
+            if finished[row]:
+                candidates.append(
+                    (cum_scores[row], cum_scores[row], end_id, row, True)
+                )
+                continue
+            penalty = ((5.0 + seq_lens[row] + 1.0) / 6.0) ** alpha
+            for token in np.argsort(-logp[row])[:beam_size]:
+                score = cum_scores[row] + logp[row][token]
+                key = score / penalty
+                if token == end_id:
+                    candidates.append((key, key, token, row, True))
+                else:
+                    candidates.append((key, score, token, row, False))
+        candidates.sort(key=lambda c: -c[0])
+        for k, (_, score, token, parent, done) in enumerate(
+            candidates[:beam_size]
+        ):
+            ids[base + k] = token
+            parents[base + k] = parent
+            scores[base + k] = score
+            finished_out[base + k] = done
+    return ids, parents, scores, finished_out, seq_lens[parents]
+
+
+def ref_reorder_cache(tables, cache, parents, seq_lens):
+    block_size = cache.shape[2]
+    new_tables = tables.copy()
+    new_cache = cache.copy()
+    for row, parent in enumerate(parents):
+        full = seq_lens[row] // block_size
+        rest = seq_lens[row] % block_size
+        new_tables[row, :full] = tables[parent, :full]
+        if parent != row and rest > 0 and full < tables.shape[1]:
+            new_cache[tables[row, full], :, :rest] = cache[
+                tables[parent, full], :, :rest
+            ]
+    return new_tables, new_cache
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "Only support GPU in CUDA mode."
+)
+class TestFusedBeamSearchStepOp(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        paddle.set_device('gpu')
+        np.random.seed(2024)
+        self.batch_size = 3
+        self.beam_size = 4
+        self.vocab_size = 1000
+        self.end_id = 2
+        self.alpha = 0.6
+        self.rows = self.batch_size * self.beam_size
+
+    def make_inputs(self, dtype='float32'):
+        # distinct logits, also in float16, so that the top tokens are unique
+        logits = np.stack(
+            [np.random.permutation(self.vocab_size) for _ in range(self.rows)]
+        ).astype('float32')
+        logits = logits / 100 - 5
+        # makes the end token one of the best tokens of some beams
+        logits[::3, self.end_id] = 10.0
+        cum_scores = -np.random.rand(self.rows).astype('float32') * 5
+        finished = np.random.rand(self.rows) < 0.25
+        seq_lens = np.random.randint(1, 12, [self.rows]).astype('int32')
+        if dtype != 'float32':
+            logits = logits.astype(dtype).astype('float32')
+        return logits, cum_scores, finished, seq_lens
+
+    def check(self, dtype, atol):
+        logits, cum_scores, finished, seq_lens = self.make_inputs(dtype)
+        expect = ref_beam_search_step(
+            logits,
+            cum_scores,
+            finished,
+            seq_lens,
+            self.beam_size,
+            self.end_id,
+            self.alpha,
+        )
+        cum_scores_t = paddle.to_tensor(cum_scores)
+        finished_t = paddle.to_tensor(finished)
+        seq_lens_t = paddle.to_tensor(seq_lens)
+        ids, parents = fused_beam_search_step(
+            paddle.to_tensor(logits).astype(dtype),
+            cum_scores_t,
+            finished_t,
+            seq_lens_t,
+            self.beam_size,
+            self.end_id,
+            self.alpha,
+        )
+        np.testing.assert_array_equal(ids.numpy(), expect[0])
+        np.testing.assert_array_equal(parents.numpy(), expect[1])
+        # the states are updated in place
+        np.testing.assert_allclose(
+            cum_scores_t.numpy(), expect[2], rtol=atol, atol=atol
+        )
+        np.testing.assert_array_equal(finished_t.numpy(), expect[3])
+        np.testing.assert_array_equal(seq_lens_t.numpy(), expect[4])
+
+    def test_float32(self):
+        self.check('float32', 1e-5)
+
+    def test_float16(self):
+        self.check('float16', 1e-3)
+
+    def test_no_length_penalty(self):
+        self.alpha = 0.0
+        self.check('float32', 1e-5)
+
+    def test_all_finished(self):
+        logits, cum_scores, _, seq_lens = self.make_inputs()
+        finished = paddle.ones([self.rows], dtype='bool')
+        cum_scores_t = paddle.to_tensor(cum_scores)
+        ids, parents = fused_beam_search_step(
+            paddle.to_tensor(logits),
+            cum_scores_t,
+            finished,
+            paddle.to_tensor(seq_lens),
+            self.beam_size,
+            self.end_id,
+        )
+        np.testing.assert_array_equal(ids.numpy(), self.end_id)
+        self.assertTrue(finished.numpy().all())
+        # a batch keeps its finished beams sorted by their scores
+        order = np.argsort(
+            -cum_scores.reshape([self.batch_size, self.beam_size]), axis=1
+        )
+        order += np.arange(0, self.rows, self.beam_size)[:, None]
+        np.testing.assert_array_equal(parents.numpy(), order.flatten())
+
+    def check_paged_cache(self, head_dim):
+        num_heads, block_size, max_blocks = 2, 4, 3
+        logits, cum_scores, finished, seq_lens = self.make_inputs()
+        # each beam owns its blocks before the step
+        tables = np.arange(self.rows * max_blocks, dtype='int32').reshape(
+            [self.rows, max_blocks]
+        )
+        shape = [self.rows * max_blocks, num_heads, block_size, head_dim]
+        key_cache = np.random.rand(*shape).astype('float32')
+        value_cache = np.random.rand(*shape).astype('float32')
+
+        _, parents, _, _, new_lens = ref_beam_search_step(
+            logits,
+            cum_scores,
+            finished,
+            seq_lens,
+            self.beam_size,
+            self.end_id,
+            self.alpha,
+        )
+        expect_tables, expect_key = ref_reorder_cache(
+            tables, key_cache, parents, new_lens
+        )
+        _, expect_value = ref_reorder_cache(
+            tables, value_cache, parents, new_lens
+        )
+
+        tables_t = paddle.to_tensor(tables)
+        key_cache_t = paddle.to_tensor(key_cache)
+        value_cache_t = paddle.to_tensor(value_cache)
+        _, parents_t = fused_beam_search_step(
+            paddle.to_tensor(logits),
+            paddle.to_tensor(cum_scores),
+            paddle.to_tensor(finished),
+            paddle.to_tensor(seq_lens),
+            self.beam_size,
+            self.end_id,
+            self.alpha,
+            block_tables=tables_t,
+            key_cache=key_cache_t,
+            value_cache=value_cache_t,
+        )
+        np.testing.assert_array_equal(parents_t.numpy(), parents)
+        np.testing.assert_array_equal(tables_t.numpy(), expect_tables)
+        np.testing.assert_array_equal(key_cache_t.numpy(), expect_key)
+        np.testing.assert_array_equal(value_cache_t.numpy(), expect_value)
+
+    def test_paged_cache(self):
+        # copies the tokens by 16 bytes
+        self.check_paged_cache(8)
+
+    def test_paged_cache_unaligned(self):
+        self.check_paged_cache(3)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,84 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+from op_test import OpTest
+
+import paddle
+from paddle.base import core
+
+# the values of phi::DataLayout
+kNHWC = 1
+kNCHW = 2
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "core is not compiled with CUDA"
+)
+class TestFusedDataTransferOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fused_data_transfer'
+        self.init_config()
+        x = np.random.random(size=self.shape).astype(self.in_dtype)
+        out = x.astype(self.out_dtype)
+        if self.src_layout != self.dst_layout:
+            perm = [0, 2, 3, 1] if self.dst_layout == kNHWC else [0, 3, 1, 2]
+            out = out.transpose(perm)
+        self.inputs = {'X': x}
+        self.outputs = {'Out': out}
+        self.attrs = {
+            'src_layout': self.src_layout,
+            'dst_layout': self.dst_layout,
+            'out_dtype': int(self.out_proto_dtype),
+        }
+
+    def init_config(self):
+        self.shape = [2, 3, 4, 5]
+        self.in_dtype = 'float32'
+        self.out_dtype = 'float16'
+        self.out_proto_dtype = core.VarDesc.VarType.FP16
+        self.src_layout = kNCHW
+        self.dst_layout = kNHWC
+
+    def test_check_output(self):
+        self.check_output_with_place(
+            core.CUDAPlace(0), atol=1e-3, check_dygraph=False
+        )
+
+
+class TestFusedDataTransferOpToNCHW(TestFusedDataTransferOp):
+    def init_config(self):
+        self.shape = [2, 4, 5, 3]
+        self.in_dtype = 'float32'
+        self.out_dtype = 'float64'
+        self.out_proto_dtype = core.VarDesc.VarType.FP64
+        self.src_layout = kNHWC
+        self.dst_layout = kNCHW
+
+
+class TestFusedDataTransferOpCastOnly(TestFusedDataTransferOp):
+    def init_config(self):
+        self.shape = [3, 7]
+        self.in_dtype = 'float64'
+        self.out_dtype = 'float32'
+        self.out_proto_dtype = core.VarDesc.VarType.FP32
+        self.src_layout = kNCHW
+        self.dst_layout = kNCHW
+
+
+if __name__ == '__main__':
+    paddle.enable_static()
+    unittest.main()
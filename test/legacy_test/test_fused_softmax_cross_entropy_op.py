@@ -0,0 +1,127 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+from paddle.incubate.nn.functional import fused_softmax_cross_entropy
+
+
+def softmax_cross_entropy_ref(logits, label, ignore_index):
+    logits = logits.astype('float64')
+    lse = np.log(np.sum(np.exp(logits - logits.max(-1, keepdims=True)), -1))
+    lse = lse + logits.max(-1)
+    label = label.squeeze(-1)
+    safe_label = np.where(label == ignore_index, 0, label)
+    target = np.take_along_axis(logits, safe_label[..., None], -1)[..., 0]
+    loss = np.where(label == ignore_index, 0.0, lse - target)
+    softmax = np.exp(logits - lse[..., None])
+    onehot = np.zeros_like(softmax)
+    np.put_along_axis(onehot, safe_label[..., None], 1.0, -1)
+    grad = np.where((label == ignore_index)[..., None], 0.0, softmax - onehot)
+    return loss[..., None], grad
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(),
+    "core is not compiled with CUDA",
+)
+class TestFusedSoftmaxCrossEntropy(unittest.TestCase):
+    def setUp(self):
+        self.shape = [2, 7, 1001]
+        self.dtype = 'float32'
+        self.label_dtype = 'int64'
+        self.ignore_index = -100
+        self.atol = 1e-5
+        self.rtol = 1e-5
+        np.random.seed(2024)
+
+    def get_inputs(self):
+        logits = (np.random.randn(*self.shape) * 4).astype('float32')
+        label = np.random.randint(
+            0, self.shape[-1], self.shape[:-1] + [1]
+        ).astype(self.label_dtype)
+        label.reshape(-1)[::5] = self.ignore_index
+        return logits, label
+
+    def test_forward_backward(self):
+        paddle.disable_static()
+        logits_np, label_np = self.get_inputs()
+        logits = paddle.to_tensor(logits_np).astype(self.dtype)
+        logits.stop_gradient = False
+        label = paddle.to_tensor(label_np)
+        loss = fused_softmax_cross_entropy(
+            logits, label, ignore_index=self.ignore_index
+        )
+        loss.sum().backward()
+
+        ref_loss, ref_grad = softmax_cross_entropy_ref(
+            logits.astype('float32').numpy(), label_np, self.ignore_index
+        )
+        self.assertEqual(loss.shape, self.shape[:-1] + [1])
+        np.testing.assert_allclose(
+            loss.astype('float32').numpy(),
+            ref_loss,
+            atol=self.atol,
+            rtol=self.rtol,
+        )
+        np.testing.assert_allclose(
+            logits.grad.astype('float32').numpy(),
+            ref_grad,
+            atol=self.atol,
+            rtol=self.rtol,
+        )
+
+
+class TestFusedSoftmaxCrossEntropyInt32(TestFusedSoftmaxCrossEntropy):
+    def setUp(self):
+        super().setUp()
+        self.shape = [16, 4096]
+        self.label_dtype = 'int32'
+        self.ignore_index = 0
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda()
+    or not core.is_float16_supported(core.CUDAPlace(0)),
+    "core is not compiled with CUDA or not support float16",
+)
+class TestFusedSoftmaxCrossEntropyFP16(TestFusedSoftmaxCrossEntropy):
+    def setUp(self):
+        super().setUp()
+        self.shape = [8, 32000]
+        self.dtype = 'float16'
+        self.atol = 1e-3
+        self.rtol = 1e-2
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda()
+    or not core.is_bfloat16_supported(core.CUDAPlace(0)),
+    "core is not compiled with CUDA or not support bfloat16",
+)
+class TestFusedSoftmaxCrossEntropyBF16(TestFusedSoftmaxCrossEntropy):
+    def setUp(self):
+        super().setUp()
+        self.shape = [8, 32000]
+        self.dtype = 'bfloat16'
+        self.atol = 1e-2
+        self.rtol = 1e-2
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,83 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+
+class SimpleNet(paddle.nn.Layer):
+    def __init__(self):
+        super().__init__()
+        self.conv1 = paddle.nn.Conv2D(3, 8, (3, 3), padding=1)
+        self.bn = paddle.nn.BatchNorm2D(8)
+        self.pool = paddle.nn.MaxPool2D(kernel_size=2, stride=2)
+        self.conv2 = paddle.nn.Conv2D(8, 8, (3, 3), padding=1)
+        self.flatten = paddle.nn.Flatten()
+        self.fc = paddle.nn.Linear(8 * 8 * 8, 2)
+
+    def forward(self, image, scale):
+        out = paddle.nn.functional.relu(self.bn(self.conv1(image)))
+        out = self.pool(out)
+        # a tensor of one element does not take the layout back
+        out = self.conv2(out) * scale
+        out = paddle.nn.functional.interpolate(out, scale_factor=0.5)
+        return self.fc(self.flatten(out))
+
+
+@unittest.skipIf(
+    not paddle.is_compiled_with_cuda(), "core is not compiled with CUDA"
+)
+class TestLayoutAutoTuneByCost(unittest.TestCase):
+    def setUp(self):
+        paddle.set_flags(
+            {
+                'FLAGS_layout_autotune_by_cost': True,
+                'FLAGS_layout_autotune_cost_window': 4,
+            }
+        )
+
+    def run_model(self, model, images, scale, use_autotune):
+        if use_autotune:
+            paddle.base.core.enable_layout_autotune()
+        else:
+            paddle.base.core.disable_layout_autotune()
+        outs = []
+        for image in images:
+            with paddle.amp.auto_cast(level="O2"):
+                out = model(image, scale)
+            outs.append(out.astype('float32').numpy())
+        paddle.base.core.disable_layout_autotune()
+        return outs
+
+    def test_same_result(self):
+        paddle.seed(2024)
+        model = SimpleNet()
+        model.eval()
+        model = paddle.amp.decorate(models=model, level="O2")
+        images = [paddle.rand([2, 3, 32, 32]) for _ in range(4)]
+        scale = paddle.to_tensor([0.5])
+        expected = self.run_model(model, images, scale, False)
+        # the layout is picked after the first two runs, the others run in
+        # the picked layout
+        outs = self.run_model(model, images, scale, True)
+        for out, expect in zip(outs, expected):
+            self.assertEqual(out.shape, (2, 2))
+            np.testing.assert_allclose(out, expect, rtol=1e-2, atol=1e-2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,125 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+from paddle.incubate.nn.functional import moe_grouped_gemm
+
+
+def moe_grouped_gemm_ref(x, expert_id, weight, out_grad):
+    expert_id = expert_id.reshape([x.shape[0], -1])
+    topk = expert_id.shape[1]
+    out = np.zeros([x.shape[0], topk, weight.shape[2]], dtype='float64')
+    x_grad = np.zeros_like(x, dtype='float64')
+    weight_grad = np.zeros_like(weight, dtype='float64')
+    out_grad = out_grad.reshape(out.shape)
+    for i in range(x.shape[0]):
+        for j in range(topk):
+            w = weight[expert_id[i, j]].astype('float64')
+            out[i, j] = x[i] @ w
+            x_grad[i] += out_grad[i, j] @ w.T
+            weight_grad[expert_id[i, j]] += np.outer(x[i], out_grad[i, j])
+    return out, x_grad, weight_grad
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(),
+    "core is not compiled with CUDA",
+)
+class TestMoeGroupedGemm(unittest.TestCase):
+    def setUp(self):
+        self.num_tokens = 37
+        self.topk = 1
+        self.num_experts = 6
+        self.hidden_size = 64
+        self.out_size = 128
+        self.dtype = 'float32'
+        self.id_dtype = 'int64'
+        self.atol = 1e-4
+        self.rtol = 1e-4
+        np.random.seed(2024)
+
+    def get_expert_id(self):
+        # The last expert gets no tokens.
+        shape = [self.num_tokens]
+        if self.topk > 1:
+            shape.append(self.topk)
+        return np.random.randint(0, self.num_experts - 1, shape).astype(
+            self.id_dtype
+        )
+
+    def test_forward_backward(self):
+        paddle.disable_static()
+        x_np = np.random.randn(self.num_tokens, self.hidden_size)
+        weight_np = np.random.randn(
+            self.num_experts, self.hidden_size, self.out_size
+        )
+        x_np = x_np.astype(self.dtype).astype('float64')
+        weight_np = weight_np.astype(self.dtype).astype('float64')
+        expert_id_np = self.get_expert_id()
+
+        x = paddle.to_tensor(x_np, dtype=self.dtype, stop_gradient=False)
+        weight = paddle.to_tensor(
+            weight_np, dtype=self.dtype, stop_gradient=False
+        )
+        expert_id = paddle.to_tensor(expert_id_np)
+        out = moe_grouped_gemm(x, expert_id, weight)
+        out_grad_np = np.random.randn(*out.shape)
+        out_grad_np = out_grad_np.astype(self.dtype).astype('float64')
+        out.backward(paddle.to_tensor(out_grad_np, dtype=self.dtype))
+
+        ref_out, ref_x_grad, ref_weight_grad = moe_grouped_gemm_ref(
+            x_np, expert_id_np, weight_np, out_grad_np
+        )
+        self.assertEqual(out.shape, [*expert_id_np.shape, self.out_size])
+        for actual, expect in [
+            (out, ref_out.reshape(out.shape)),
+            (x.grad, ref_x_grad),
+            (weight.grad, ref_weight_grad),
+        ]:
+            np.testing.assert_allclose(
+                actual.astype('float32').numpy(),
+                expect,
+                atol=self.atol,
+                rtol=self.rtol,
+            )
+
+
+class TestMoeGroupedGemmTopK(TestMoeGroupedGemm):
+    def setUp(self):
+        super().setUp()
+        self.topk = 2
+        self.id_dtype = 'int32'
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda()
+    or not core.is_float16_supported(core.CUDAPlace(0)),
+    "core is not compiled with CUDA or not support float16",
+)
+class TestMoeGroupedGemmFP16(TestMoeGroupedGemm):
+    def setUp(self):
+        super().setUp()
+        self.topk = 2
+        self.dtype = 'float16'
+        self.atol = 5e-2
+        self.rtol = 1e-2
+
+
+if __name__ == '__main__':
+    unittest.main()
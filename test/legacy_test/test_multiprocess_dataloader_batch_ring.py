@@ -0,0 +1,111 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+from paddle.io import DataLoader, Dataset
+
+
+class TestSharedMemoryBatchRing(unittest.TestCase):
+    def test_write_and_wrap(self):
+        ring = core.SharedMemoryBatchRing(2, 1 << 20)
+        self.assertEqual(ring.slot_num, 2)
+
+        image = np.random.random([4, 3, 8, 8]).astype('float32')
+        label = np.arange(4).astype('int64').reshape([4, 1])
+        mask = paddle.to_tensor([True, False, True]).get_tensor()
+        items = [image, label, mask]
+        self.assertGreater(core.SharedMemoryBatchRing.nbytes(items), 0)
+        self.assertEqual(
+            core.SharedMemoryBatchRing.nbytes([np.array(['a', 'b'])]), -1
+        )
+
+        slot = ring.acquire()
+        self.assertEqual(slot, 0)
+        metas = ring.write(slot, items)
+
+        reader = core.SharedMemoryBatchRing.open(
+            ring.ipc_name, ring.slot_num, ring.slot_size
+        )
+        tensors = reader.wrap(slot, metas)
+        np.testing.assert_array_equal(np.array(tensors[0]), image)
+        np.testing.assert_array_equal(np.array(tensors[1]), label)
+        np.testing.assert_array_equal(
+            np.array(tensors[2]), np.array([True, False, True])
+        )
+
+        # the slot is released with its last tensor
+        self.assertEqual(ring.acquire(), 1)
+        self.assertEqual(ring.acquire(), -1)
+        del tensors[0]
+        self.assertFalse(ring.is_free(slot))
+        del tensors
+        self.assertTrue(ring.is_free(slot))
+        self.assertEqual(ring.acquire(), slot)
+
+
+class RandomDataset(Dataset):
+    def __init__(self, sample_num, image_size):
+        self.sample_num = sample_num
+        self.image_size = image_size
+
+    def __getitem__(self, idx):
+        np.random.seed(idx)
+        image = np.random.random([self.image_size]).astype('float32')
+        label = np.array([idx]).astype('int64')
+        return image, label
+
+    def __len__(self):
+        return self.sample_num
+
+
+class TestDataLoaderWithBatchRing(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        paddle.set_flags({'FLAGS_dataloader_use_shared_memory_ring': True})
+
+    def tearDown(self):
+        paddle.set_flags({'FLAGS_dataloader_use_shared_memory_ring': False})
+
+    def run_loader(self, image_size):
+        dataset = RandomDataset(40, image_size)
+        loader = DataLoader(
+            dataset,
+            places=paddle.CPUPlace(),
+            batch_size=4,
+            num_workers=2,
+            use_shared_memory=True,
+        )
+        for epoch in range(2):
+            labels = []
+            for image, label in loader:
+                for i, idx in enumerate(label.numpy().flatten()):
+                    expected = dataset[int(idx)][0]
+                    np.testing.assert_array_equal(image.numpy()[i], expected)
+                labels.extend(label.numpy().flatten().tolist())
+            self.assertEqual(labels, list(range(40)))
+
+    def test_small_batches(self):
+        self.run_loader(784)
+
+    def test_large_batches(self):
+        self.run_loader(1 << 18)
+
+
+if __name__ == '__main__':
+    unittest.main()
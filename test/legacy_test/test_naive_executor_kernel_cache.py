@@ -0,0 +1,99 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle import inference as paddle_infer
+
+
+class TestNaiveExecutorKernelCache(unittest.TestCase):
+    def setUp(self):
+        self.temp_dir = tempfile.TemporaryDirectory()
+        self.save_path = os.path.join(self.temp_dir.name, 'branches')
+        with paddle.pir_utils.OldIrGuard():
+            paddle.enable_static()
+            main_prog = paddle.static.Program()
+            startup_prog = paddle.static.Program()
+            with paddle.static.program_guard(main_prog, startup_prog):
+                x = paddle.static.data(shape=[-1, 16], name='x')
+                # the independent branches
+                branches = []
+                for act in [paddle.nn.functional.relu, paddle.tanh]:
+                    out = paddle.nn.Linear(16, 8)(x)
+                    branches.append(act(out))
+                out = paddle.nn.Linear(8, 4)(branches[0] + branches[1])
+                exe = paddle.static.Executor(paddle.CPUPlace())
+                exe.run(startup_prog)
+                paddle.static.save_inference_model(
+                    self.save_path, [x], [out], exe
+                )
+            paddle.disable_static()
+
+    def tearDown(self):
+        paddle.set_flags(
+            {
+                'FLAGS_naive_executor_cache_kernel_context': False,
+                'FLAGS_naive_executor_num_threads': 1,
+            }
+        )
+        self.temp_dir.cleanup()
+
+    def run_predictor(self, inputs):
+        with paddle.pir_utils.OldIrGuard():
+            config = paddle_infer.Config(
+                self.save_path + '.pdmodel', self.save_path + '.pdiparams'
+            )
+            config.disable_gpu()
+            predictor = paddle_infer.create_predictor(config)
+            outputs = []
+            for x in inputs:
+                input_handle = predictor.get_input_handle(
+                    predictor.get_input_names()[0]
+                )
+                input_handle.reshape(x.shape)
+                input_handle.copy_from_cpu(x)
+                predictor.run()
+                output_handle = predictor.get_output_handle(
+                    predictor.get_output_names()[0]
+                )
+                outputs.append(output_handle.copy_to_cpu())
+            return outputs
+
+    def test_cached_kernels(self):
+        # the batch size changes to infer the shapes again
+        inputs = [
+            np.random.random([batch_size, 16]).astype('float32')
+            for batch_size in [2, 2, 5, 3, 3]
+        ]
+        expected = self.run_predictor(inputs)
+        for num_threads in [1, 3]:
+            paddle.set_flags(
+                {
+                    'FLAGS_naive_executor_cache_kernel_context': True,
+                    'FLAGS_naive_executor_num_threads': num_threads,
+                }
+            )
+            outputs = self.run_predictor(inputs)
+            for out, expected_out in zip(outputs, expected):
+                self.assertEqual(out.shape, expected_out.shape)
+                np.testing.assert_allclose(out, expected_out, rtol=1e-6)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -12,6 +12,9 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import json
+import os
+import tempfile
 import unittest
 
 from paddle import profiler
@@ -1044,6 +1047,173 @@ class TestProfilerStatistic(unittest.TestCase):
                 )
             )
 
+    def test_statistic_roofline(self):
+        root_node = HostPythonNode(
+            'Root Node',
+            profiler.TracerEventType.UserDefined,
+            0,
+            float('inf'),
+            1000,
+            1001,
+        )
+        profilerstep_node = HostPythonNode(
+            'ProfileStep#1',
+            profiler.TracerEventType.ProfileStep,
+            0,
+            4000,
+            1000,
+            1001,
+        )
+        matmul_node = HostPythonNode(
+            'matmul dygraph',
+            profiler.TracerEventType.Operator,
+            10,
+            100,
+            1000,
+            1001,
+        )
+        matmul_node.input_shapes = {'X': [[64, 128]], 'Y': [[128, 32]]}
+        matmul_node.dtypes = {'X': ['FP32'], 'Y': ['FP32']}
+        matmul_node.attributes = {}
+        matmul_launchkernel = HostPythonNode(
+            'cudalaunchkernel',
+            profiler.TracerEventType.CudaRuntime,
+            20,
+            30,
+            1000,
+            1001,
+        )
+        matmul_kernel = DevicePythonNode(
+            'gemm_kernel', profiler.TracerEventType.Kernel, 200, 1200, 0, 0, 0
+        )
+        matmul_kernel.occupancy = 0.5
+        root_node.children_node.append(profilerstep_node)
+        profilerstep_node.children_node.append(matmul_node)
+        matmul_node.runtime_node.append(matmul_launchkernel)
+        matmul_launchkernel.device_node.append(matmul_kernel)
+
+        # the peak FLOPS of the CUDA cores and the tensor cores, and the peak
+        # bandwidth of the device 0
+        profiler_statistic._device_peaks[0] = (1e12, 1e13, 1e11)
+        extra_info = {
+            'Process Cpu Utilization': '1.02',
+            'System Cpu Utilization': '0.68',
+        }
+        statistic_data = profiler.profiler_statistic.StatisticData(
+            {'thread1001': root_node}, extra_info
+        )
+        item = statistic_data.event_summary.kernel_items['gemm_kernel']
+        self.assertAlmostEqual(item.avg_occupancy, 0.5)
+        flops = 2 * 64 * 32 * 128
+        input_bytes = (64 * 128 + 128 * 32) * 4
+        self.assertEqual(item.flops, flops)
+        self.assertAlmostEqual(item.arithmetic_intensity, flops / input_bytes)
+        # the kernel is bound by the compute at the roofline
+        self.assertAlmostEqual(item.roofline_ratio, flops / 1e12 * 1e9 / 1000)
+        table = profiler.profiler_statistic._build_table(
+            statistic_data,
+            sorted_by=profiler.SortedKeys.GPUTotal,
+            op_detail=True,
+            thread_sep=False,
+            time_unit='ms',
+        )
+        self.assertIn('Roofline(%)', table)
+        del profiler_statistic._device_peaks[0]
+
+    def test_memory_timeline(self):
+        root_node = HostPythonNode(
+            'Root Node',
+            profiler.TracerEventType.UserDefined,
+            0,
+            float('inf'),
+            1000,
+            1001,
+        )
+        profilerstep_node = HostPythonNode(
+            'ProfileStep#1',
+            profiler.TracerEventType.ProfileStep,
+            0,
+            400,
+            1000,
+            1001,
+        )
+        matmul_node = HostPythonNode(
+            'matmul', profiler.TracerEventType.Operator, 10, 50, 1000, 1001
+        )
+        matmul_compute = HostPythonNode(
+            'matmul::compute',
+            profiler.TracerEventType.OperatorInner,
+            20,
+            40,
+            1000,
+            1001,
+        )
+        relu_node = HostPythonNode(
+            'relu', profiler.TracerEventType.Operator, 60, 100, 1000, 1001
+        )
+        add_node = HostPythonNode(
+            'add', profiler.TracerEventType.Operator, 110, 150, 1000, 1001
+        )
+
+        def mem_node(timestamp_ns, addr, type, increase_bytes, allocated):
+            return MemPythonNode(
+                timestamp_ns,
+                addr,
+                type,
+                1000,
+                1001,
+                increase_bytes,
+                'place(gpu:0)',
+                allocated,
+                1024,
+                allocated,
+                1024,
+            )
+
+        allocate = profiler_statistic.TracerMemEventType.Allocate
+        free = profiler_statistic.TracerMemEventType.Free
+        root_node.children_node.append(profilerstep_node)
+        profilerstep_node.children_node.extend(
+            [matmul_node, relu_node, add_node]
+        )
+        matmul_node.children_node.append(matmul_compute)
+        # 16 bytes are allocated before the profiling
+        matmul_compute.mem_node.append(mem_node(30, 1, allocate, 100, 116))
+        relu_node.mem_node.append(mem_node(70, 2, allocate, 50, 166))
+        relu_node.mem_node.append(mem_node(80, 3, allocate, 20, 186))
+        relu_node.mem_node.append(mem_node(90, 3, free, -20, 166))
+        add_node.mem_node.append(mem_node(120, 1, free, -100, 66))
+        add_node.mem_node.append(mem_node(130, 3, allocate, 30, 96))
+
+        # the tensor recorded at addr 3 after the peak names the allocation
+        # of add, not the one of relu freed before
+        tensor_names = [(35, 1, 'x'), (75, 2, 'y'), (135, 3, 'z')]
+        statistic_data = profiler.profiler_statistic.StatisticData(
+            {'thread1001': root_node}, {}, tensor_names
+        )
+        timeline = statistic_data.memory_timeline
+        self.assertEqual(timeline.peak_values['place(gpu:0)'], 186)
+        self.assertEqual(timeline.peak_timestamps['place(gpu:0)'], 80)
+        self.assertEqual(
+            timeline.peak_contributors('place(gpu:0)'),
+            [
+                ('matmul', 'x', 1, 100),
+                ('relu', 'y', 1, 50),
+                ('relu', '-', 1, 20),
+                ('-', '-', 0, 16),
+            ],
+        )
+
+        with tempfile.TemporaryDirectory() as temp_dir:
+            path = os.path.join(temp_dir, 'memory_timeline.json')
+            timeline.export(path)
+            with open(path) as f:
+                events = json.load(f)['traceEvents']
+        counters = [event for event in events if event['ph'] == 'C']
+        self.assertEqual(len(counters), 6)
+        peaks = [event for event in events if event['ph'] == 'i']
+        self.assertEqual(peaks[0]['args']['matmul / x'], 100)
+
 
 if __name__ == '__main__':
     unittest.main()
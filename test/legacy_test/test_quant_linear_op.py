@@ -351,6 +351,7 @@ class TestQuantLinearOp(OpTest):
         if core.is_compiled_with_cuda():
             place = core.CUDAPlace(0)
             self.check_output_with_place(place, check_dygraph=False)
+        self.check_output_with_place(core.CPUPlace(), check_dygraph=False)
 
 
 @unittest.skipIf(
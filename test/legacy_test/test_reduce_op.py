@@ -111,6 +111,21 @@ class TestSumOp5D(TestSumOp):
         self.attrs = {'dim': [0]}
 
 
+
+class TestAutoTuneSumOp5D(TestSumOp):
+    def init_input(self):
+        base.core.set_autotune_range(0, 3)
+        base.core.update_autotune_status()
+        base.core.enable_autotune()
+        self.x = np.random.random((3, 7, 5, 33, 9)).astype(self.dtype)
+
+    def init_attrs(self):
+        self.attrs = {'dim': [0, 2, 3]}
+
+    def test_check_output(self):
+        self.check_output(check_pir=True)
+        base.core.disable_autotune()
+
 class TestSumOp6D(TestSumOp):
     def init_input(self):
         self.x = np.random.random((1, 1, 2, 5, 6, 10)).astype(self.dtype)
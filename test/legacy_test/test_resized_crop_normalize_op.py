@@ -0,0 +1,118 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle import base
+from paddle.io import DataLoader, DevicePipeline, TensorDataset
+
+
+def resized_crop_normalize_ref(x, crop, size, mean, std, flip):
+    top, left, height, width = crop
+    image = paddle.to_tensor(x).astype('float32')
+    squeeze = image.ndim == 3
+    if squeeze:
+        image = image.unsqueeze(0)
+    image = image[:, :, top : top + height, left : left + width]
+    out = paddle.nn.functional.interpolate(
+        image, size=size, mode='bilinear', align_corners=False, align_mode=0
+    ).numpy()
+    if flip:
+        out = out[:, :, :, ::-1]
+    shape = [1, -1, 1, 1]
+    out = (out - np.array(mean).reshape(shape)) / np.array(std).reshape(shape)
+    return out[0] if squeeze else out
+
+
+class TestResizedCropNormalize(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        self.places = ['cpu']
+        if base.core.is_compiled_with_cuda():
+            self.places.append('gpu')
+
+    def check(self, x, crop, size, mean, std, flip):
+        expected = resized_crop_normalize_ref(x, crop, size, mean, std, flip)
+        for place in self.places:
+            paddle.set_device(place)
+            out = paddle.vision.ops.resized_crop_normalize(
+                paddle.to_tensor(x), crop, size, mean, std, flip
+            )
+            self.assertEqual(out.dtype, paddle.float32)
+            np.testing.assert_allclose(
+                out.numpy(), expected, rtol=1e-5, atol=1e-4
+            )
+
+    def test_uint8_image(self):
+        x = np.random.randint(0, 256, [3, 40, 30]).astype('uint8')
+        mean = [123.675, 116.28, 103.53]
+        std = [58.395, 57.12, 57.375]
+        self.check(x, [5, 3, 30, 20], [16, 16], mean, std, False)
+        self.check(x, [5, 3, 30, 20], [45, 37], mean, std, True)
+
+    def test_float_batch(self):
+        x = np.random.random([2, 4, 17, 23]).astype('float32')
+        self.check(x, [0, 0, 17, 23], [8, 11], [0.5], [0.25], True)
+        self.check(x, [3, 7, 9, 9], [9, 9], [0.0], [1.0], False)
+
+    def test_invalid_crop(self):
+        x = paddle.zeros([3, 10, 10], dtype='uint8')
+        with self.assertRaises(ValueError):
+            paddle.vision.ops.resized_crop_normalize(x, [5, 5, 6, 5], [4, 4])
+        with self.assertRaises(ValueError):
+            paddle.vision.ops.resized_crop_normalize(
+                x, [0, 0, 5, 5], [4, 4], mean=[1.0, 2.0]
+            )
+
+
+class TestDevicePipeline(unittest.TestCase):
+    def test_transform(self):
+        paddle.disable_static()
+        images = np.random.randint(0, 256, [10, 3, 20, 20]).astype('uint8')
+        loader = DataLoader(
+            TensorDataset([paddle.to_tensor(images)]), batch_size=4
+        )
+
+        def augment(batch):
+            return (
+                paddle.vision.ops.resized_crop_normalize(
+                    batch[0], [2, 2, 16, 16], [8, 8], [127.5], [127.5]
+                ),
+                batch[0].shape[0],
+            )
+
+        pipeline = DevicePipeline(loader, augment, prefetch=2)
+        self.assertEqual(len(pipeline), 3)
+        begin = 0
+        for out, batch_size in pipeline:
+            expected = resized_crop_normalize_ref(
+                images[begin : begin + batch_size],
+                [2, 2, 16, 16],
+                [8, 8],
+                [127.5],
+                [127.5],
+                False,
+            )
+            np.testing.assert_allclose(
+                out.numpy(), expected, rtol=1e-5, atol=1e-4
+            )
+            begin += batch_size
+        self.assertEqual(begin, 10)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,173 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import time
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+
+
+def get_places():
+    places = [paddle.CPUPlace()]
+    if core.is_compiled_with_cuda():
+        places.append(paddle.CUDAPlace(0))
+    return places
+
+
+def block_sparse(shape, block_size, sparsity, dtype='float32'):
+    block_mask = (
+        np.random.rand(shape[0] // block_size, shape[1] // block_size)
+        >= sparsity
+    )
+    mask = np.kron(block_mask, np.ones([block_size, block_size]))
+    return (np.random.rand(*shape) * mask).astype(dtype)
+
+
+def ref_bsr(x, block_size):
+    block_rows = x.shape[0] // block_size
+    block_cols = x.shape[1] // block_size
+    crows, cols, values = [0], [], []
+    for i in range(block_rows):
+        for j in range(block_cols):
+            block = x[
+                i * block_size : (i + 1) * block_size,
+                j * block_size : (j + 1) * block_size,
+            ]
+            if np.any(block != 0):
+                cols.append(j)
+                values.append(block)
+        crows.append(len(cols))
+    return np.array(crows), np.array(cols), np.array(values)
+
+
+class TestToSparseBsr(unittest.TestCase):
+    def check(self, shape, block_size, place):
+        np_x = block_sparse(shape, block_size, 0.5)
+        # a single non-zero element makes the whole block non-zero
+        np_x[0, block_size - 1] = 1.0
+        crows, cols, values = ref_bsr(np_x, block_size)
+        x = paddle.to_tensor(np_x, place=place)
+        for sp_input in [x, x.to_sparse_coo(2)]:
+            bsr = paddle.sparse.to_sparse_bsr(sp_input, block_size)
+            self.assertTrue(bsr.is_sparse_csr())
+            np.testing.assert_array_equal(bsr.crows().numpy(), crows)
+            np.testing.assert_array_equal(bsr.cols().numpy(), cols)
+            np.testing.assert_array_equal(
+                bsr.values().numpy().reshape(values.shape), values
+            )
+            np.testing.assert_array_equal(bsr.to_dense().numpy(), np_x)
+
+    def test_to_sparse_bsr(self):
+        for place in get_places():
+            self.check([8, 12], 2, place)
+            self.check([32, 64], 16, place)
+
+    def test_empty(self):
+        for place in get_places():
+            x = paddle.zeros([4, 4])
+            x = paddle.to_tensor(x, place=place)
+            bsr = paddle.sparse.to_sparse_bsr(x, 2)
+            np.testing.assert_array_equal(bsr.crows().numpy(), [0, 0, 0])
+            np.testing.assert_array_equal(bsr.to_dense().numpy(), x.numpy())
+
+    def test_indivisible_shape(self):
+        x = paddle.ones([6, 4])
+        with self.assertRaises(ValueError):
+            paddle.sparse.to_sparse_bsr(x, 4)
+
+
+class TestMatmulBsrDense(unittest.TestCase):
+    def check(self, m, k, n, block_size, dtype, place, rtol):
+        np_x = block_sparse([m, k], block_size, 0.5)
+        np_y = np.random.rand(k, n).astype('float32')
+        expect = np_x @ np_y
+
+        x = paddle.to_tensor(np_x, place=place).astype(dtype)
+        y = paddle.to_tensor(np_y, place=place).astype(dtype)
+        bsr = paddle.sparse.to_sparse_bsr(x, block_size)
+        out = paddle.sparse.matmul(bsr, y)
+        self.assertEqual(out.shape, [m, n])
+        np.testing.assert_allclose(
+            out.astype('float32').numpy(), expect, rtol=rtol, atol=rtol
+        )
+
+    def test_float32(self):
+        for place in get_places():
+            self.check(16, 24, 10, 4, 'float32', place, 1e-5)
+            self.check(64, 32, 48, 16, 'float32', place, 1e-5)
+
+    @unittest.skipIf(
+        not core.is_compiled_with_cuda(), "core is not compiled with CUDA"
+    )
+    def test_float16(self):
+        place = paddle.CUDAPlace(0)
+        # runs on the tensor cores
+        self.check(64, 64, 48, 16, 'float16', place, 1e-2)
+        self.check(64, 128, 32, 32, 'float16', place, 1e-2)
+        # the block size or n is not a multiple of 16
+        self.check(64, 64, 40, 16, 'float16', place, 1e-2)
+        self.check(24, 48, 32, 8, 'float16', place, 1e-2)
+
+    @unittest.skipIf(
+        not core.is_compiled_with_cuda()
+        or not core.is_bfloat16_supported(paddle.CUDAPlace(0)),
+        "core is not compiled with CUDA or not support bfloat16",
+    )
+    def test_bfloat16(self):
+        place = paddle.CUDAPlace(0)
+        self.check(64, 64, 48, 16, 'bfloat16', place, 5e-2)
+        self.check(24, 48, 32, 8, 'bfloat16', place, 5e-2)
+
+
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "core is not compiled with CUDA"
+)
+class TestMatmulBsrDenseBenchmark(unittest.TestCase):
+    def run_time(self, fn, repeat=10):
+        fn()
+        paddle.device.synchronize()
+        start = time.time()
+        for _ in range(repeat):
+            fn()
+        paddle.device.synchronize()
+        return (time.time() - start) / repeat * 1000
+
+    def test_benchmark(self):
+        m, k, n = 1024, 1024, 256
+        y = paddle.rand([k, n])
+        y_fp16 = y.astype('float16')
+        for block_size in [16, 32, 64]:
+            for sparsity in [0.5, 0.9, 0.98]:
+                x = paddle.to_tensor(block_sparse([m, k], block_size, sparsity))
+                x_fp16 = x.astype('float16')
+                bsr = paddle.sparse.to_sparse_bsr(x_fp16, block_size)
+                # cuSPARSE computes float16 in float16, compare with float32
+                csr = x.to_sparse_csr()
+                bsr_ms = self.run_time(
+                    lambda: paddle.sparse.matmul(bsr, y_fp16)
+                )
+                csr_ms = self.run_time(lambda: paddle.sparse.matmul(csr, y))
+                dense_ms = self.run_time(lambda: paddle.matmul(x_fp16, y_fp16))
+                print(
+                    f"block_size: {block_size}, sparsity: {sparsity}, "
+                    f"bsr fp16: {bsr_ms:.3f} ms, csr fp32: {csr_ms:.3f} ms, "
+                    f"dense fp16: {dense_ms:.3f} ms"
+                )
+
+
+if __name__ == "__main__":
+    unittest.main()
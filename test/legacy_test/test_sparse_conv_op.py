@@ -131,6 +131,36 @@ class TestSparseConv(unittest.TestCase):
             sparse_x.indices().numpy(), y.indices().numpy()
         )
 
+    def test_subm_conv3d_auto_key(self):
+        indices = [[0, 0, 0, 0], [0, 0, 0, 0], [0, 0, 1, 2], [1, 3, 2, 3]]
+        values = [[1], [2], [3], [4]]
+        dense_shape = [1, 1, 3, 4, 1]
+        weight1 = paddle.randn((1, 3, 3, 1, 2), dtype='float32')
+        weight2 = paddle.randn((1, 3, 3, 2, 1), dtype='float32')
+
+        def run(auto_cache):
+            paddle.set_flags(
+                {'FLAGS_sparse_conv_auto_cache_rulebook': auto_cache}
+            )
+            sparse_x = paddle.sparse.sparse_coo_tensor(
+                paddle.to_tensor(indices, dtype='int32'),
+                paddle.to_tensor(values, dtype='float32'),
+                dense_shape,
+                stop_gradient=False,
+            )
+            # The second subm conv reuses the rulebook of the first one.
+            y = paddle.sparse.nn.functional.subm_conv3d(sparse_x, weight1)
+            y = paddle.sparse.nn.functional.relu(y)
+            y = paddle.sparse.nn.functional.subm_conv3d(y, weight2)
+            y.backward(y)
+            return y.values().numpy(), sparse_x.grad.values().numpy()
+
+        out, grad = run(True)
+        ref_out, ref_grad = run(False)
+        paddle.set_flags({'FLAGS_sparse_conv_auto_cache_rulebook': True})
+        np.testing.assert_allclose(out, ref_out, rtol=1e-5, atol=1e-5)
+        np.testing.assert_allclose(grad, ref_grad, rtol=1e-5, atol=1e-5)
+
     def test_Conv2D(self):
         # (3, non_zero_num), 3-D:(N, H, W)
         indices = [[0, 0, 0, 0], [0, 0, 1, 2], [1, 3, 2, 3]]
@@ -0,0 +1,135 @@
+#  Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle import base
+
+
+class TestContiguousCopyStats(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        paddle.set_device('cpu')
+        base.core.clear_contiguous_copy_stats()
+
+    def test_copy_of_kernel_without_strides(self):
+        x = paddle.rand([6, 4])
+        x_t = paddle.transpose(x, [1, 0])
+        self.assertFalse(x_t.is_contiguous())
+        out = paddle.nn.functional.relu(x_t)
+        np.testing.assert_allclose(
+            out.numpy(), np.maximum(x.numpy().T, 0), rtol=1e-6
+        )
+        stats = base.core.get_contiguous_copy_stats()
+        self.assertEqual(stats['relu'], (1, 6 * 4 * 4))
+
+        base.core.clear_contiguous_copy_stats()
+        self.assertEqual(base.core.get_contiguous_copy_stats(), {})
+
+
+class TestMatmulStrided(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        self.places = ['cpu']
+        if base.core.is_compiled_with_cuda():
+            self.places.append('gpu')
+
+    def check_matmul(self, x, y, x_np, y_np):
+        base.core.clear_contiguous_copy_stats()
+        out = paddle.matmul(x, y)
+        np.testing.assert_allclose(
+            out.numpy(), np.matmul(x_np, y_np), rtol=1e-5, atol=1e-5
+        )
+        self.assertNotIn('matmul', base.core.get_contiguous_copy_stats())
+
+    def test_transposed_inputs(self):
+        for place in self.places:
+            paddle.set_device(place)
+            x = paddle.rand([6, 4])
+            y = paddle.rand([5, 6])
+            x_t = paddle.transpose(x, [1, 0])
+            y_t = paddle.transpose(y, [1, 0])
+            self.check_matmul(x_t, y_t, x.numpy().T, y.numpy().T)
+
+            batch_x = paddle.rand([3, 6, 4])
+            batch_x_t = paddle.transpose(batch_x, [0, 2, 1])
+            batch_y = paddle.rand([3, 6, 5])
+            self.check_matmul(
+                batch_x_t,
+                batch_y,
+                batch_x.numpy().transpose([0, 2, 1]),
+                batch_y.numpy(),
+            )
+
+    def test_sliced_input(self):
+        for place in self.places:
+            paddle.set_device(place)
+            x = paddle.rand([6, 8])
+            x_slice = x[:, 2:5]
+            self.assertFalse(x_slice.is_contiguous())
+            y = paddle.rand([3, 5])
+            self.check_matmul(x_slice, y, x.numpy()[:, 2:5], y.numpy())
+
+
+@unittest.skipIf(
+    not base.core.is_compiled_with_cuda(), "core is not compiled with CUDA"
+)
+class TestElementwiseStrided(unittest.TestCase):
+    def setUp(self):
+        paddle.disable_static()
+        paddle.set_device('gpu')
+
+    def check_ops(self, x, y, x_np, y_np):
+        base.core.clear_contiguous_copy_stats()
+        np.testing.assert_allclose(
+            paddle.add(x, y).numpy(), x_np + y_np, rtol=1e-6
+        )
+        np.testing.assert_allclose(
+            paddle.subtract(x, y).numpy(), x_np - y_np, rtol=1e-6
+        )
+        np.testing.assert_allclose(
+            paddle.multiply(x, y).numpy(), x_np * y_np, rtol=1e-6
+        )
+        np.testing.assert_allclose(
+            paddle.divide(x, y).numpy(), x_np / y_np, rtol=1e-6
+        )
+        stats = base.core.get_contiguous_copy_stats()
+        for op in ['add', 'subtract', 'multiply', 'divide']:
+            self.assertNotIn(op, stats)
+
+    def test_transposed_inputs(self):
+        x = paddle.rand([64, 32]) + 1.0
+        y = paddle.rand([32, 64]) + 1.0
+        x_t = paddle.transpose(x, [1, 0])
+        self.check_ops(x_t, y, x.numpy().T, y.numpy())
+        self.check_ops(y, x_t, y.numpy(), x.numpy().T)
+
+    def test_broadcast_sliced_inputs(self):
+        x = paddle.rand([16, 8, 32]) + 1.0
+        y = paddle.rand([8, 1]) + 1.0
+        x_slice = x[:, :, 3:20]
+        self.assertFalse(x_slice.is_contiguous())
+        self.check_ops(x_slice, y, x.numpy()[:, :, 3:20], y.numpy())
+
+        column = x[0, :, 5:6]
+        self.assertFalse(column.is_contiguous())
+        z = paddle.rand([4, 8, 17]) + 1.0
+        self.check_ops(z, column, z.numpy(), x.numpy()[0, :, 5:6])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,67 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+
+
+class TestTensorNumpyAsync(unittest.TestCase):
+    def setUp(self):
+        self.places = [paddle.CPUPlace()]
+        if paddle.is_compiled_with_cuda():
+            self.places.append(paddle.CUDAPlace(0))
+
+    def test_numpy_async(self):
+        x_np = np.random.random([4, 8]).astype('float32')
+        for place in self.places:
+            x = paddle.to_tensor(x_np, place=place)
+            # the copy waits for the kernel writing y
+            y = x * 2.0
+            future = y.numpy_async()
+            np.testing.assert_allclose(future.result(), x_np * 2.0)
+            self.assertTrue(future.done())
+
+    def test_item_async(self):
+        for place in self.places:
+            loss = paddle.to_tensor(1.5, place=place)
+            self.assertEqual(loss.numpy_async().item(), 1.5)
+            with self.assertRaises(ValueError):
+                paddle.to_tensor([1, 2], place=place).numpy_async().item()
+
+    def test_bulk(self):
+        arrays = [
+            np.random.random([3]).astype('float32'),
+            np.arange(5).astype('int64'),
+            np.random.random([2, 3]).astype('float64'),
+        ]
+        for place in self.places:
+            tensors = [paddle.to_tensor(a, place=place) for a in arrays]
+            # a strided view is copied as a contiguous one
+            tensors.append(tensors[2].transpose([1, 0]))
+            future = paddle.device.numpy_async(tensors)
+            del tensors
+            results = future.result()
+            self.assertEqual(len(results), 4)
+            for result, expected in zip(
+                results, [*arrays, arrays[2].transpose([1, 0])]
+            ):
+                self.assertEqual(result.dtype, expected.dtype)
+                np.testing.assert_array_equal(result, expected)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -440,6 +440,76 @@ class TestUniqueAPI(unittest.TestCase):
                 )
 
 
+@unittest.skipIf(
+    not core.is_compiled_with_cuda(), "core is not compiled with CUDA"
+)
+class TestUniqueHashGPU(unittest.TestCase):
+    # the hash path of the flattened unique of the integers on GPU, checked
+    # against numpy and the sorting path
+    def setUp(self):
+        paddle.disable_static()
+        self.flags = paddle.get_flags(
+            [
+                'FLAGS_unique_hash_min_numel',
+                'FLAGS_unique_hash_max_distinct_ratio',
+            ]
+        )
+        paddle.set_flags({'FLAGS_unique_hash_min_numel': 0})
+
+    def tearDown(self):
+        paddle.set_flags(self.flags)
+
+    def check_unique(self, x_data, dtype="int64"):
+        x = paddle.to_tensor(x_data, place=paddle.CUDAPlace(0))
+        out, indices, inverse, counts = paddle.unique(
+            x,
+            return_index=True,
+            return_inverse=True,
+            return_counts=True,
+            dtype=dtype,
+        )
+        np_out, np_indices, np_inverse, np_counts = np.unique(
+            x_data, return_index=True, return_inverse=True, return_counts=True
+        )
+        np.testing.assert_array_equal(out.numpy(), np_out)
+        np.testing.assert_array_equal(indices.numpy(), np_indices)
+        np.testing.assert_array_equal(inverse.numpy(), np_inverse.flatten())
+        np.testing.assert_array_equal(counts.numpy(), np_counts)
+
+        paddle.set_flags({'FLAGS_unique_hash_min_numel': -1})
+        sorted_outs = paddle.unique(
+            x,
+            return_index=True,
+            return_inverse=True,
+            return_counts=True,
+            dtype=dtype,
+        )
+        paddle.set_flags({'FLAGS_unique_hash_min_numel': 0})
+        for hash_out, sorted_out in zip(
+            [out, indices, inverse, counts], sorted_outs
+        ):
+            np.testing.assert_array_equal(hash_out.numpy(), sorted_out.numpy())
+
+    def test_few_distinct(self):
+        x_data = np.random.randint(-1000, 1000, (1 << 20)).astype("int64")
+        self.check_unique(x_data)
+        self.check_unique(x_data.astype("int32"), dtype="int32")
+
+    def test_skewed(self):
+        x_data = np.random.zipf(1.5, (1 << 20)).astype("int64")
+        self.check_unique(x_data)
+
+    def test_many_distinct(self):
+        # all the distinct values pass to the hash path too, with the ratio 1
+        paddle.set_flags({'FLAGS_unique_hash_max_distinct_ratio': 1.0})
+        x_data = np.random.permutation(1 << 16).astype("int64")
+        self.check_unique(x_data)
+
+    def test_multi_dims(self):
+        x_data = np.random.randint(0, 7, (64, 33, 5)).astype("int64")
+        self.check_unique(x_data)
+
+
 class TestUniqueError(unittest.TestCase):
     def test_input_dtype(self):
         def test_x_dtype():
@@ -116,7 +116,9 @@ class TestAutoRecomputeRmsNorm(unittest.TestCase):
             )
         return res, main_program
 
-    def cal_rms_norm_auto_recompute_decomp_res(self, place):
+    def cal_rms_norm_auto_recompute_decomp_res(
+        self, place, memory_budget=None
+    ):
         main_program = paddle.static.Program()
         with paddle.static.program_guard(main_program):
             weight, hidden = self.product_rms_norm_inputs()
@@ -133,6 +135,7 @@ class TestAutoRecomputeRmsNorm(unittest.TestCase):
                 grad_outputs=[out_grad],
                 fwd_op_end_idx=13,
                 backward_op_start_idx=15,
+                memory_budget=memory_budget,
             )
             exe = paddle.static.Executor(place)
             res = exe.run(
@@ -177,6 +180,36 @@ class TestAutoRecomputeRmsNorm(unittest.TestCase):
                         for used_op in all_used_ops:
                             self.assertTrue(used_op in forward_ops)
 
+    def test_auto_recompute_with_memory_budget(self):
+        size = np.prod(self.inputs[0].shape) * 4
+        for place in places:
+            res_desire, orig_program = self.cal_rms_norm_decomp_res(place)
+            # no memory for the backward, recompute as much as possible
+            (
+                res_min_cut,
+                min_cut_program,
+            ) = self.cal_rms_norm_auto_recompute_decomp_res(place, 0)
+            # enough memory to hold the forward values, nothing is recomputed
+            (
+                res_no_recompute,
+                no_recompute_program,
+            ) = self.cal_rms_norm_auto_recompute_decomp_res(place, size * 16)
+            for res in [res_min_cut, res_no_recompute]:
+                for desire, actual in zip(res_desire, res):
+                    np.testing.assert_allclose(
+                        desire,
+                        actual,
+                        atol=TOLERANCE[self.dtype]["atol"],
+                        rtol=TOLERANCE[self.dtype]["rtol"],
+                    )
+            num_ops = len(orig_program.global_block().ops)
+            self.assertGreater(
+                len(min_cut_program.global_block().ops), num_ops
+            )
+            self.assertEqual(
+                len(no_recompute_program.global_block().ops), num_ops
+            )
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,124 @@
+# Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+
+import numpy as np
+
+import paddle
+from paddle.base import core
+from paddle.static.quantization import PirPostTrainingQuantization
+
+paddle.enable_static()
+
+
+def get_places():
+    places = [paddle.CPUPlace()]
+    if core.is_compiled_with_cuda():
+        places.append(paddle.CUDAPlace(0))
+    return places
+
+
+class TestPirPostTrainingQuantization(unittest.TestCase):
+    def setUp(self):
+        np.random.seed(2024)
+        paddle.seed(2024)
+        self.batch_nums = 4
+        self.data = [
+            np.random.uniform(-1, 1, [8, 16, 32]).astype('float32')
+            for _ in range(self.batch_nums + 1)
+        ]
+
+    def build_program(self):
+        main = paddle.static.Program()
+        startup = paddle.static.Program()
+        with paddle.static.program_guard(main, startup):
+            x = paddle.static.data('x', [-1, 16, 32], 'float32')
+            out = paddle.nn.functional.relu(paddle.nn.Linear(32, 64)(x))
+            out = paddle.nn.Linear(64, 16, bias_attr=False)(out)
+            conv_in = paddle.reshape(out, [-1, 1, 16, 16])
+            out = paddle.nn.Conv2D(1, 4, 3, padding=1)(conv_in)
+        return main, startup, out
+
+    def data_loader(self):
+        for data in self.data[: self.batch_nums]:
+            yield {'x': data}
+
+    def count_ops(self, program, name):
+        return len(
+            [op for op in program.global_block().ops if op.name() == name]
+        )
+
+    def check(self, place, algo):
+        with paddle.pir_utils.IrGuard():
+            main, startup, out = self.build_program()
+            exe = paddle.static.Executor(place)
+            scope = paddle.static.Scope()
+            with paddle.static.scope_guard(scope):
+                exe.run(startup)
+                feed = {'x': self.data[-1]}
+                (expect,) = exe.run(main, feed=feed, fetch_list=[out])
+
+                ptq = PirPostTrainingQuantization(
+                    exe,
+                    main,
+                    ['x'],
+                    self.data_loader,
+                    scope=scope,
+                    algo=algo,
+                    bins=256,
+                )
+                main = ptq.quantize()
+                self.assertEqual(
+                    self.count_ops(main, 'pd_op.quantize_linear'), 3
+                )
+                self.assertEqual(
+                    self.count_ops(main, 'pd_op.dequantize_linear'), 6
+                )
+                (quant_out,) = exe.run(main, feed=feed, fetch_list=[out])
+                np.testing.assert_allclose(
+                    quant_out, expect, rtol=0.1, atol=0.05
+                )
+
+                main = ptq.fuse()
+                # both of the matmuls are fused, the conv stays quantized
+                self.assertEqual(self.count_ops(main, 'pd_op.quant_linear'), 2)
+                self.assertEqual(self.count_ops(main, 'pd_op.matmul'), 0)
+                self.assertEqual(
+                    self.count_ops(main, 'pd_op.quantize_linear'), 1
+                )
+                (fused_out,) = exe.run(main, feed=feed, fetch_list=[out])
+                np.testing.assert_allclose(
+                    fused_out, quant_out, rtol=1e-3, atol=1e-3
+                )
+
+    def test_abs_max(self):
+        for place in get_places():
+            self.check(place, 'abs_max')
+
+    def test_kl(self):
+        for place in get_places():
+            self.check(place, 'KL')
+
+    def test_hist(self):
+        for place in get_places():
+            self.check(place, 'hist')
+
+    def test_mse(self):
+        for place in get_places():
+            self.check(place, 'mse')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -35,6 +35,10 @@ def paddle_add(a, b):
     return res
 
 
+def paddle_add_tensors(inputs):
+    return {"out": paddle.add(inputs["a"], inputs["b"]), "x": inputs["a"]}
+
+
 class TestMultiProcessRpc(RpcTestBase):
     def test_one_server_sync_paddle_add(self):
         a = np.random.random((10, 100))
@@ -104,6 +108,18 @@ class TestSingleProcessRpc(RpcTestBase):
         out = dist.rpc.rpc_async(worker_name(0), paddle_add, args=args).wait()
         np.testing.assert_allclose(out, res, rtol=1e-05)
 
+    def test_sync_rpc_paddle_add_tensors(self):
+        a = paddle.rand((10, 100))
+        b = paddle.rand((10, 100))
+        res = np.add(a.numpy(), b.numpy())
+        inputs = {"a": a, "b": b}
+        out = dist.rpc.rpc_sync(
+            worker_name(0), paddle_add_tensors, args=(inputs,)
+        )
+        self.assertIsInstance(out["out"], paddle.Tensor)
+        np.testing.assert_allclose(out["out"].numpy(), res, rtol=1e-05)
+        np.testing.assert_array_equal(out["x"].numpy(), a.numpy())
+
     def test_get_worker_info(self):
         info = dist.rpc.get_worker_info(worker_name(0))
         self.assertEqual(info.name, worker_name(0))